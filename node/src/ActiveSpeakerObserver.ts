@@ -7,6 +7,20 @@ export interface ActiveSpeakerObserverOptions
 {
 	interval?: number;
 
+	/**
+	 * Compute speaker activity scores of all Producers at once with SIMD
+	 * kernels. Dominant speaker decisions are the same. Default false.
+	 */
+	useSimd?: boolean;
+
+	/**
+	 * If greater than zero, Consumers of the video Producers of the speakers
+	 * (see videoProducerIds in addProducer()) that are not among the last N
+	 * dominant speakers are paused within the worker, without notifying them
+	 * (PipeConsumers excluded). Default 0 (disabled).
+	 */
+	videoLastN?: number;
+
 	/**
 	 * Custom application data.
 	 */
@@ -21,6 +21,14 @@ export interface AudioLevelObserverOptions
 	 */
 	interval?: number;
 
+	/**
+	 * Keep the loudest Producers updated on every received packet instead of
+	 * computing them once per interval. A 'volumes' event is then also emitted
+	 * (at most once per interval) as soon as a new Producer enters them.
+	 * Default false.
+	 */
+	incremental?: boolean;
+
 	/**
 	 * Custom application data.
 	 */
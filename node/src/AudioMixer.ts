@@ -0,0 +1,48 @@
+import { RtpObserver, RtpObserverEvents, RtpObserverObserverEvents } from './RtpObserver';
+import { EnhancedEventEmitter } from './EnhancedEventEmitter';
+
+export interface AudioMixerOptions
+{
+	/**
+	 * Id of the audio Producer (usually produced on a DirectTransport with
+	 * Opus codec) the mixed audio is sent through. Listeners consume it.
+	 */
+	outputProducerId: string;
+
+	/**
+	 * Maximum number of loudest Producers (based on the audio level RTP header
+	 * extension) that are mixed. Default 3.
+	 */
+	maxSpeakers?: number;
+
+	/**
+	 * Bitrate (in bps) of the mixed Opus audio. Default 32000.
+	 */
+	bitrate?: number;
+
+	/**
+	 * Custom application data.
+	 */
+	appData?: Record<string, unknown>;
+}
+
+export type AudioMixerEvents = RtpObserverEvents;
+
+export type AudioMixerObserverEvents = RtpObserverObserverEvents;
+
+export class AudioMixer extends RtpObserver<AudioMixerEvents>
+{
+	/**
+	 * Observer.
+	 *
+	 * @emits close
+	 * @emits pause
+	 * @emits resume
+	 * @emits addproducer - (producer: Producer)
+	 * @emits removeproducer - (producer: Producer)
+	 */
+	get observer(): EnhancedEventEmitter<AudioMixerObserverEvents>
+	{
+		return super.observer;
+	}
+}
@@ -1,10 +1,10 @@
-import * as os from 'os';
 import { Duplex } from 'stream';
 import { Logger } from './Logger';
 import { EnhancedEventEmitter } from './EnhancedEventEmitter';
 import { InvalidStateError } from './errors';
+import { RecvBuffer } from './RecvBuffer';
+import * as msgpack from './msgpack';
 
-const littleEndian = os.endianness() == 'LE';
 const logger = new Logger('Channel');
 
 type Sent =
@@ -38,7 +38,10 @@ export class Channel extends EnhancedEventEmitter
 	readonly #sents: Map<number, Sent> = new Map();
 
 	// Buffer for reading messages from the worker.
-	#recvBuffer = Buffer.alloc(0);
+	readonly #recvBuffer = new RecvBuffer(PAYLOAD_MAX_LEN);
+
+	// Format of the messages sent to the worker process.
+	readonly #messageFormat: 'json' | 'msgpack';
 
 	/**
 	 * @private
@@ -47,12 +50,14 @@ export class Channel extends EnhancedEventEmitter
 		{
 			producerSocket,
 			consumerSocket,
-			pid
+			pid,
+			messageFormat = 'json'
 		}:
 		{
 			producerSocket: any;
 			consumerSocket: any;
 			pid: number;
+			messageFormat?: 'json' | 'msgpack';
 		})
 	{
 		super();
@@ -61,61 +66,17 @@ export class Channel extends EnhancedEventEmitter
 
 		this.#producerSocket = producerSocket as Duplex;
 		this.#consumerSocket = consumerSocket as Duplex;
+		this.#messageFormat = messageFormat;
 
 		// Read Channel responses/notifications from the worker.
 		this.#consumerSocket.on('data', (buffer: Buffer) =>
 		{
-			if (!this.#recvBuffer.length)
+			const ok = this.#recvBuffer.push(buffer, (payload: Buffer) =>
 			{
-				this.#recvBuffer = buffer;
-			}
-			else
-			{
-				this.#recvBuffer = Buffer.concat(
-					[ this.#recvBuffer, buffer ],
-					this.#recvBuffer.length + buffer.length);
-			}
-
-			if (this.#recvBuffer.length > PAYLOAD_MAX_LEN)
-			{
-				logger.error('receiving buffer is full, discarding all data in it');
-
-				// Reset the buffer and exit.
-				this.#recvBuffer = Buffer.alloc(0);
-
-				return;
-			}
-
-			let msgStart = 0;
-
-			while (true) // eslint-disable-line no-constant-condition
-			{
-				const readLen = this.#recvBuffer.length - msgStart;
-
-				if (readLen < 4)
-				{
-					// Incomplete data.
-					break;
-				}
-
-				const dataView = new DataView(
-					this.#recvBuffer.buffer,
-					this.#recvBuffer.byteOffset + msgStart);
-				const msgLen = dataView.getUint32(0, littleEndian);
-
-				if (readLen < 4 + msgLen)
-				{
-					// Incomplete data.
-					break;
-				}
-
-				const payload = this.#recvBuffer.subarray(msgStart + 4, msgStart + 4 + msgLen);
-
-				msgStart += 4 + msgLen;
-
 				try
 				{
-					// We can receive JSON messages (Channel messages) or log strings.
+					// We can receive JSON or MessagePack messages (Channel messages) or
+					// log strings.
 					switch (payload[0])
 					{
 						// 123 = '{' (a Channel JSON message).
@@ -145,6 +106,13 @@ export class Channel extends EnhancedEventEmitter
 							break;
 
 						default:
+							// A Channel MessagePack message.
+							if (msgpack.isMap(payload[0]))
+							{
+								this.processMessage(msgpack.decode(payload));
+								break;
+							}
+
 							// eslint-disable-next-line no-console
 							console.warn(
 								`worker[pid:${pid}] unexpected data: %s`,
@@ -157,12 +125,10 @@ export class Channel extends EnhancedEventEmitter
 						'received invalid message from the worker process: %s',
 						String(error));
 				}
-			}
+			});
 
-			if (msgStart != 0)
-			{
-				this.#recvBuffer = this.#recvBuffer.slice(msgStart);
-			}
+			if (!ok)
+				logger.error('received message is too big, discarding all data');
 		});
 
 		this.#consumerSocket.on('end', () => (
@@ -235,7 +201,9 @@ export class Channel extends EnhancedEventEmitter
 			throw new InvalidStateError('Channel closed');
 
 		const request = { id, method, internal, data };
-		const payload = JSON.stringify(request);
+		const payload = this.#messageFormat === 'msgpack'
+			? msgpack.encode(request)
+			: JSON.stringify(request);
 
 		if (Buffer.byteLength(payload) > MESSAGE_MAX_LEN)
 			throw new Error('Channel request too big');
@@ -332,6 +300,18 @@ export class Channel extends EnhancedEventEmitter
 			// See https://github.com/versatica/mediasoup/issues/510
 			setImmediate(() => this.emit(String(msg.targetId), msg.event, msg.data));
 		}
+		// If a batch of notifications (notificationBatchInterval setting) emit
+		// each one to the corresponding entity.
+		else if (Array.isArray(msg.batch))
+		{
+			setImmediate(() =>
+			{
+				for (const [ targetId, event, data ] of msg.batch)
+				{
+					this.emit(String(targetId), event, data);
+				}
+			});
+		}
 		// Otherwise unexpected message.
 		else
 		{
@@ -2,7 +2,9 @@ import { Logger } from './Logger';
 import { EnhancedEventEmitter } from './EnhancedEventEmitter';
 import { Channel } from './Channel';
 import { PayloadChannel } from './PayloadChannel';
-import { ProducerStat } from './Producer';
+import { ProducerLayerDemand, ProducerStat, StatsDelta, TraceEventOptions } from './Producer';
+import { TransportForwardingLatency } from './Transport';
+import * as utils from './utils';
 import {
 	MediaKind,
 	RtpCapabilities,
@@ -49,12 +51,43 @@ export type ConsumerOptions =
 	 */
 	preferredLayers?: ConsumerLayers;
 
+	/**
+	 * Whether this Consumer should drop Opus DTX packets instead of sending them
+	 * to the consuming endpoint. Just for audio Consumers with Opus codec.
+	 * Default false.
+	 */
+	ignoreDtx?: boolean;
+
+	/**
+	 * Frame rate (greater than 0 and up to 5) of a thumbnail of a simulcast
+	 * media source, below the one of its lowest temporal layer. Just key frames
+	 * of the selected spatial layer are sent, requested to the Producer at this
+	 * rate, so every frame sent is decodable. Default none (disabled).
+	 */
+	thumbnailFramerate?: number;
+
 	/**
 	 * Whether this Consumer should consume all RTP streams generated by the
 	 * Producer.
 	 */
 	pipe?: boolean;
 
+	/**
+	 * Send state exported by consumer.exportSendState() of a Consumer (of the
+	 * same Producer, piped into this Router) whose stream this Consumer must
+	 * continue. Its SSRCs, MID and layers are reused so the consuming endpoint
+	 * does not need to renegotiate.
+	 */
+	sendState?: ConsumerSendState;
+
+	/**
+	 * Key of the RTP parameters of the Consumer. Consumers of the same Producer
+	 * given the same key must get the same RTP parameters (i.e. they have the
+	 * same rtpCapabilities), so they are computed and parsed just once. Useful
+	 * when many endpoints consume the same Producer at once.
+	 */
+	rtpParametersKey?: string;
+
 	/**
 	 * Custom application data.
 	 */
@@ -72,9 +105,10 @@ export type ConsumerTraceEventType = 'rtp' | 'keyframe' | 'nack' | 'pli' | 'fir'
 export type ConsumerTraceEventData =
 {
 	/**
-	 * Trace type.
+	 * Trace type ('summary' events are given in 'summary' mode and their info
+	 * holds the number of events of each type).
 	 */
-	type: ConsumerTraceEventType;
+	type: ConsumerTraceEventType | 'summary';
 
 	/**
 	 * Event timestamp.
@@ -124,6 +158,53 @@ export type ConsumerLayers =
 	temporalLayer?: number;
 }
 
+/**
+ * State of the RTP stream sent by a Consumer, as exported by
+ * consumer.exportSendState().
+ */
+export type ConsumerSendState =
+{
+	/**
+	 * Consumer type.
+	 */
+	type: ConsumerType;
+
+	/**
+	 * Sequence number of the last sent RTP packet.
+	 */
+	rtpSeq: number;
+
+	/**
+	 * Sequence number of the last sent RTX packet (if RTX is used).
+	 */
+	rtxSeq?: number;
+
+	/**
+	 * Current spatial layer (simulcast and SVC).
+	 */
+	spatialLayer?: number;
+
+	/**
+	 * Current temporal layer (simulcast and SVC).
+	 */
+	temporalLayer?: number;
+
+	/**
+	 * Spatial layer RTP timestamps are referred to (simulcast).
+	 */
+	tsReferenceSpatialLayer?: number;
+
+	/**
+	 * Whether the last sent RTP packet had the marker bit (simulcast).
+	 */
+	lastSentPacketHasMarker?: boolean;
+
+	/**
+	 * RTP parameters of the Consumer.
+	 */
+	rtpParameters: RtpParameters;
+}
+
 export type ConsumerStat =
 {
 	// Common to all RtpStreams.
@@ -147,6 +228,47 @@ export type ConsumerStat =
 	byteCount: number;
 	bitrate: number;
 	roundTripTime?: number;
+	// Just for simulcast Consumers.
+	spatialLayerSwitchLatency?: ConsumerSpatialLayerSwitchLatency;
+	// Just for SVC Consumers.
+	keyFrameRequestsAvoided?: number;
+	// Time (ms) since the Consumer creation until its first RTP packet and its
+	// first key frame (just video) were sent.
+	joinLatency?:
+	{
+		firstRtpMs: number;
+		firstKeyFrameMs?: number;
+	};
+}
+
+/**
+ * Extra stats entry given when the forwardingLatency worker setting is
+ * enabled.
+ */
+export type ConsumerForwardingLatencyStat = TransportForwardingLatency &
+{
+	type: 'forwarding-latency';
+};
+
+/**
+ * Histogram of the time needed to switch to a new spatial layer.
+ */
+export type ConsumerSpatialLayerSwitchLatency =
+{
+	/**
+	 * Upper bound (in ms) of each bucket but the last one.
+	 */
+	bucketsMs: number[];
+
+	/**
+	 * Number of switches in each bucket.
+	 */
+	counts: number[];
+
+	/**
+	 * Number of switches done by sending the Producer key frame cache.
+	 */
+	keyFrameCacheSwitches: number;
 }
 
 /**
@@ -186,6 +308,7 @@ export class Consumer extends EnhancedEventEmitter<ConsumerEvents>
 		routerId: string;
 		transportId: string;
 		consumerId: string;
+		consumerHandle?: number;
 		producerId: string;
 	};
 
@@ -482,13 +605,28 @@ export class Consumer extends EnhancedEventEmitter<ConsumerEvents>
 	/**
 	 * Get Consumer stats.
 	 */
-	async getStats(): Promise<Array<ConsumerStat | ProducerStat>>
+	async getStats(): Promise<
+		Array<ConsumerStat | ProducerStat | ConsumerForwardingLatencyStat>
+	>
 	{
 		logger.debug('getStats()');
 
 		return this.#channel.request('consumer.getStats', this.#internal);
 	}
 
+	/**
+	 * Get Consumer stats changed since the call that returned the given cursor
+	 * (full stats if 0 or if it is not the last returned cursor).
+	 */
+	async getStatsDelta(cursor = 0): Promise<
+		StatsDelta<ConsumerStat | ProducerStat | ConsumerForwardingLatencyStat>
+	>
+	{
+		logger.debug('getStatsDelta()');
+
+		return this.#channel.request('consumer.getStats', this.#internal, { cursor });
+	}
+
 	/**
 	 * Pause the Consumer.
 	 */
@@ -545,6 +683,54 @@ export class Consumer extends EnhancedEventEmitter<ConsumerEvents>
 		this.#preferredLayers = data || undefined;
 	}
 
+	/**
+	 * Set the layers demanded by the remote Router of a pipe Consumer (see
+	 * layerDemand in Producer). Streams above them (or all of them if
+	 * undefined) are not sent until demanded again. Called by
+	 * router.pipeToRouter().
+	 */
+	async setLayerDemand(layerDemand?: ProducerLayerDemand): Promise<void>
+	{
+		logger.debug('setLayerDemand()');
+
+		if (this.#data.type !== 'pipe')
+			throw new TypeError('not a pipe Consumer');
+
+		const reqData = layerDemand
+			? { spatialLayer: layerDemand.spatialLayer, temporalLayer: layerDemand.temporalLayer }
+			: {};
+
+		await this.#channel.request('consumer.setLayerDemand', this.#internal, reqData);
+	}
+
+	/**
+	 * Consumer was paused or resumed by a batch request of its Transport.
+	 *
+	 * @private
+	 */
+	pausedByTransport(paused: boolean): void
+	{
+		const wasPaused = this.#paused || this.#producerPaused;
+
+		this.#paused = paused;
+
+		// Emit observer event.
+		if (paused && !wasPaused)
+			this.#observer.safeEmit('pause');
+		else if (!paused && wasPaused && !this.#producerPaused)
+			this.#observer.safeEmit('resume');
+	}
+
+	/**
+	 * Preferred video layers were set by a batch request of its Transport.
+	 *
+	 * @private
+	 */
+	preferredLayersSetByTransport(preferredLayers?: ConsumerLayers): void
+	{
+		this.#preferredLayers = preferredLayers || undefined;
+	}
+
 	/**
 	 * Set priority.
 	 */
@@ -575,6 +761,21 @@ export class Consumer extends EnhancedEventEmitter<ConsumerEvents>
 		this.#priority = data.priority;
 	}
 
+	/**
+	 * Export the state of the RTP stream sent by this Consumer so a Consumer of
+	 * the same Producer in another Router (given it in its sendState option)
+	 * continues it. Not valid for pipe Consumers.
+	 */
+	async exportSendState(): Promise<ConsumerSendState>
+	{
+		logger.debug('exportSendState()');
+
+		const data = await this.#channel.request(
+			'consumer.exportSendState', this.#internal);
+
+		return { ...data, rtpParameters: utils.clone(this.#data.rtpParameters) };
+	}
+
 	/**
 	 * Request a key frame to the Producer.
 	 */
@@ -588,11 +789,14 @@ export class Consumer extends EnhancedEventEmitter<ConsumerEvents>
 	/**
 	 * Enable 'trace' event.
 	 */
-	async enableTraceEvent(types: ConsumerTraceEventType[] = []): Promise<void>
+	async enableTraceEvent(
+		types: ConsumerTraceEventType[] = [],
+		options: TraceEventOptions = {}
+	): Promise<void>
 	{
 		logger.debug('enableTraceEvent()');
 
-		const reqData = { types };
+		const reqData = { types, ...options };
 
 		await this.#channel.request(
 			'consumer.enableTraceEvent', this.#internal, reqData);
@@ -35,12 +35,46 @@ export type DataConsumerOptions =
 	 */
 	maxRetransmits?: number;
 
+	/**
+	 * Just if consuming over SCTP.
+	 * Queue in the worker for messages that do not fit in the SCTP send buffer,
+	 * so they are sent once there is room instead of being discarded (with a
+	 * 'sctpsendbufferfull' event). Disabled by default.
+	 */
+	sendQueue?: DataConsumerSendQueue;
+
 	/**
 	 * Custom application data.
 	 */
 	appData?: Record<string, unknown>;
 }
 
+/**
+ * What to do with a message when the send queue is full. 'coalesce' makes a
+ * message replace the queued one with same key (its first coalesceKeyLength
+ * bytes) and otherwise drops the oldest one.
+ */
+export type DataConsumerQueueDropPolicy = 'drop-oldest' | 'drop-newest' | 'coalesce';
+
+export type DataConsumerSendQueue =
+{
+	/**
+	 * Maximum number of queued messages.
+	 */
+	maxMessages: number;
+
+	/**
+	 * Default 'drop-oldest'.
+	 */
+	dropPolicy?: DataConsumerQueueDropPolicy;
+
+	/**
+	 * Number of leading bytes of a message used as key. Required if dropPolicy
+	 * is 'coalesce'.
+	 */
+	coalesceKeyLength?: number;
+}
+
 export type DataConsumerStat =
 {
 	type: string;
@@ -50,6 +84,8 @@ export type DataConsumerStat =
 	messagesSent: number;
 	bytesSent: number;
 	bufferedAmount: number;
+	messagesQueued: number;
+	messagesDropped: number;
 }
 
 /**
@@ -1,6 +1,12 @@
 import { Logger } from './Logger';
 import { UnsupportedError } from './errors';
-import { Transport, TransportTraceEventData, TransportEvents, TransportObserverEvents } from './Transport';
+import {
+	Transport,
+	TransportForwardingLatency,
+	TransportTraceEventData,
+	TransportEvents,
+	TransportObserverEvents
+} from './Transport';
 
 export type DirectTransportOptions =
 {
@@ -10,6 +16,13 @@ export type DirectTransportOptions =
 	 */
 	maxMessageSize: number;
 
+	/**
+	 * If given, RTP and RTCP packets sent by the transport are written by the
+	 * worker into this file (in rtpdump format) instead of being emitted to
+	 * Node. RTCP packets are still emitted.
+	 */
+	recordPath?: string;
+
 	/**
 	 * Custom application data.
 	 */
@@ -39,6 +52,20 @@ export type DirectTransportStat =
 	availableOutgoingBitrate?: number;
 	availableIncomingBitrate?: number;
 	maxIncomingBitrate?: number;
+	ecnCePacketsReceived?: number;
+	ecnCePacketsSent?: number;
+	forwardingLatency?: TransportForwardingLatency;
+	cpuMsPerSecond: number;
+	recording?: DirectTransportRecordingStat;
+}
+
+export type DirectTransportRecordingStat =
+{
+	path: string;
+	packets: number;
+	droppedPackets: number;
+	bytes: number;
+	writeErrors: number;
 }
 
 export type DirectTransportEvents = TransportEvents &
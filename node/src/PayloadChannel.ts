@@ -1,10 +1,10 @@
-import * as os from 'os';
 import { Duplex } from 'stream';
 import { Logger } from './Logger';
 import { EnhancedEventEmitter } from './EnhancedEventEmitter';
 import { InvalidStateError } from './errors';
+import { RecvBuffer } from './RecvBuffer';
+import * as msgpack from './msgpack';
 
-const littleEndian = os.endianness() == 'LE';
 const logger = new Logger('PayloadChannel');
 
 type Sent =
@@ -20,6 +20,9 @@ type Sent =
 const MESSAGE_MAX_LEN = 4194308;
 const PAYLOAD_MAX_LEN = 4194304;
 
+// Max number of parsed notifications kept.
+const PARSED_NOTIFICATIONS_MAX_SIZE = 1000;
+
 export class PayloadChannel extends EnhancedEventEmitter
 {
 	// Closed flag.
@@ -38,22 +41,40 @@ export class PayloadChannel extends EnhancedEventEmitter
 	readonly #sents: Map<number, Sent> = new Map();
 
 	// Buffer for reading messages from the worker.
-	#recvBuffer = Buffer.alloc(0);
+	readonly #recvBuffer = new RecvBuffer(PAYLOAD_MAX_LEN);
+
+	// Format of the messages sent to the worker process.
+	readonly #messageFormat: 'json' | 'msgpack';
 
 	// Ongoing notification (waiting for its payload).
 	#ongoingNotification?: { targetId: string; event: string; data?: any };
 
+	// Serialized notifications without data, by internal and event (they are
+	// sent for every packet, i.e. 'producer.send').
+	readonly #serializedNotifications: WeakMap<object, Map<string, string | Buffer>> =
+		new WeakMap();
+
+	// Parsed notifications by their raw content (most of them are the same
+	// ones, i.e. 'rtp' of a given Consumer).
+	readonly #parsedNotifications:
+		Map<string, { targetId: string; event: string; data?: any }> = new Map();
+
+	// Whether writes to the worker are being buffered until next tick.
+	#corked = false;
+
 	/**
 	 * @private
 	 */
 	constructor(
 		{
 			producerSocket,
-			consumerSocket
+			consumerSocket,
+			messageFormat = 'json'
 		}:
 		{
 			producerSocket: any;
 			consumerSocket: any;
+			messageFormat?: 'json' | 'msgpack';
 		})
 	{
 		super();
@@ -62,65 +83,19 @@ export class PayloadChannel extends EnhancedEventEmitter
 
 		this.#producerSocket = producerSocket as Duplex;
 		this.#consumerSocket = consumerSocket as Duplex;
+		this.#messageFormat = messageFormat;
 
 		// Read PayloadChannel notifications from the worker.
 		this.#consumerSocket.on('data', (buffer: Buffer) =>
 		{
-			if (!this.#recvBuffer.length)
-			{
-				this.#recvBuffer = buffer;
-			}
-			else
-			{
-				this.#recvBuffer = Buffer.concat(
-					[ this.#recvBuffer, buffer ],
-					this.#recvBuffer.length + buffer.length);
-			}
-
-			if (this.#recvBuffer.length > PAYLOAD_MAX_LEN)
-			{
-				logger.error('receiving buffer is full, discarding all data in it');
-
-				// Reset the buffer and exit.
-				this.#recvBuffer = Buffer.alloc(0);
-
-				return;
-			}
-
-			let msgStart = 0;
-
-			while (true) // eslint-disable-line no-constant-condition
-			{
-				const readLen = this.#recvBuffer.length - msgStart;
-
-				if (readLen < 4)
-				{
-					// Incomplete data.
-					break;
-				}
-
-				const dataView = new DataView(
-					this.#recvBuffer.buffer,
-					this.#recvBuffer.byteOffset + msgStart);
-				const msgLen = dataView.getUint32(0, littleEndian);
-
-				if (readLen < 4 + msgLen)
-				{
-					// Incomplete data.
-					break;
-				}
-
-				const payload = this.#recvBuffer.subarray(msgStart + 4, msgStart + 4 + msgLen);
-
-				msgStart += 4 + msgLen;
-
-				this.processData(payload);
-			}
-
-			if (msgStart != 0)
-			{
-				this.#recvBuffer = this.#recvBuffer.slice(msgStart);
-			}
+			// NOTE: Payloads not in place are in a buffer reused for the next
+			// message, so they are copied.
+			const ok = this.#recvBuffer.push(buffer, (payload: Buffer, inPlace: boolean) => (
+				this.processData(inPlace ? payload : Buffer.from(payload))
+			));
+
+			if (!ok)
+				logger.error('received message is too big, discarding all data');
 		});
 
 		this.#consumerSocket.on('end', () => (
@@ -187,13 +162,17 @@ export class PayloadChannel extends EnhancedEventEmitter
 		if (this.#closed)
 			throw new InvalidStateError('PayloadChannel closed');
 
-		const notification = JSON.stringify({ event, internal, data });
+		const notification = data === undefined
+			? this.getSerializedNotification(event, internal)
+			: this.serialize({ event, internal, data });
 
 		if (Buffer.byteLength(notification) > MESSAGE_MAX_LEN)
 			throw new Error('PayloadChannel notification too big');
 		else if (Buffer.byteLength(payload) > MESSAGE_MAX_LEN)
 			throw new Error('PayloadChannel payload too big');
 
+		this.cork();
+
 		try
 		{
 			// This may throw if closed or remote side ended.
@@ -241,13 +220,15 @@ export class PayloadChannel extends EnhancedEventEmitter
 		if (this.#closed)
 			throw new InvalidStateError('Channel closed');
 
-		const request = JSON.stringify({ id, method, internal, data });
+		const request = this.serialize({ id, method, internal, data });
 
 		if (Buffer.byteLength(request) > MESSAGE_MAX_LEN)
 			throw new Error('Channel request too big');
 		else if (Buffer.byteLength(payload) > MESSAGE_MAX_LEN)
 			throw new Error('PayloadChannel payload too big');
 
+		this.cork();
+
 		// This may throw if closed or remote side ended.
 		this.#producerSocket.write(
 			Buffer.from(Uint32Array.of(Buffer.byteLength(request)).buffer));
@@ -287,15 +268,76 @@ export class PayloadChannel extends EnhancedEventEmitter
 		});
 	}
 
+	private serialize(message: object): string | Buffer
+	{
+		return this.#messageFormat === 'msgpack'
+			? msgpack.encode(message)
+			: JSON.stringify(message);
+	}
+
+	private getSerializedNotification(event: string, internal: object): string | Buffer
+	{
+		let notifications = this.#serializedNotifications.get(internal);
+
+		if (!notifications)
+		{
+			notifications = new Map();
+
+			this.#serializedNotifications.set(internal, notifications);
+		}
+
+		let notification = notifications.get(event);
+
+		if (notification === undefined)
+		{
+			notification = this.serialize({ event, internal });
+
+			notifications.set(event, notification);
+		}
+
+		return notification;
+	}
+
+	/**
+	 * Buffers writes to the worker until next tick so all the messages sent
+	 * meanwhile are written at once.
+	 */
+	private cork(): void
+	{
+		if (this.#corked)
+			return;
+
+		this.#corked = true;
+		this.#producerSocket.cork();
+
+		process.nextTick(() =>
+		{
+			this.#corked = false;
+			this.#producerSocket.uncork();
+		});
+	}
+
 	private processData(data: Buffer): void
 	{
 		if (!this.#ongoingNotification)
 		{
+			const key = data.toString('latin1');
+			const parsedNotification = this.#parsedNotifications.get(key);
+
+			if (parsedNotification)
+			{
+				this.#ongoingNotification = parsedNotification;
+
+				return;
+			}
+
 			let msg;
 
 			try
 			{
-				msg = JSON.parse(data.toString('utf8'));
+				msg = msgpack.isMap(data[0])
+					? msgpack.decode(data)
+					: JSON.parse(data.toString('utf8'));
 			}
 			catch (error)
 			{
@@ -358,6 +400,11 @@ export class PayloadChannel extends EnhancedEventEmitter
 						event    : msg.event,
 						data     : msg.data
 					};
+
+				if (this.#parsedNotifications.size >= PARSED_NOTIFICATIONS_MAX_SIZE)
+					this.#parsedNotifications.clear();
+
+				this.#parsedNotifications.set(key, this.#ongoingNotification);
 			}
 			else
 			{
@@ -369,13 +416,23 @@ export class PayloadChannel extends EnhancedEventEmitter
 		else
 		{
 			const payload = data as Buffer;
+			const { targetId, event, data: notificationData } = this.#ongoingNotification;
 
+			// A notification for many targets (i.e. a DataChannel message sent to
+			// all the data consumers of a direct transport) carries the payload
+			// once and it's shared by all of them.
+			if (Array.isArray(notificationData?.targetIds))
+			{
+				for (const id of notificationData.targetIds)
+				{
+					this.emit(String(id), event, notificationData, payload);
+				}
+			}
 			// Emit the corresponding event.
-			this.emit(
-				this.#ongoingNotification.targetId,
-				this.#ongoingNotification.event,
-				this.#ongoingNotification.data,
-				payload);
+			else
+			{
+				this.emit(targetId, event, notificationData, payload);
+			}
 
 			// Unset ongoing notification.
 			this.#ongoingNotification = undefined;
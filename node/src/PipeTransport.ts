@@ -1,6 +1,7 @@
 import { v4 as uuidv4 } from 'uuid';
 import { Logger } from './Logger';
 import * as ortc from './ortc';
+import { UnsupportedError } from './errors';
 import {
 	Transport,
 	TransportListenIp,
@@ -8,9 +9,12 @@ import {
 	TransportTraceEventData,
 	TransportEvents,
 	TransportObserverEvents,
-	SctpState
+	SctpState,
+	TransportForwardingLatency,
+	TransportUdpSocketStat,
+	TransportTcpConnectionStat
 } from './Transport';
-import { Consumer } from './Consumer';
+import { Consumer, ConsumerOptions } from './Consumer';
 import { SctpParameters, NumSctpStreams } from './SctpParameters';
 import { SrtpParameters } from './SrtpParameters';
 
@@ -63,6 +67,57 @@ export type PipeTransportOptions =
 	 */
 	enableSrtp?: boolean;
 
+	/**
+	 * Exchange packets with the paired PipeTransport through memory instead of
+	 * UDP. Only valid if both Routers belong to the same Worker, in which case
+	 * RTP and RTCP packets are directly handed to the paired PipeTransport. For
+	 * this to work, connect() must be called with the remote memoryPipeId.
+	 * Default false.
+	 */
+	inMemory?: boolean;
+
+	/**
+	 * Aggregate the RTP and RTCP packets sent to the remote PipeTransport into
+	 * frames of up to trunkMaxFrameSize bytes (one UDP datagram each). If SRTP
+	 * is enabled, a single AES-128-GCM operation protects each frame instead
+	 * of SRTP. For this to work, both PipeTransports must enable this setting.
+	 * Not valid along with inMemory. Default false.
+	 */
+	enableTrunk?: boolean;
+
+	/**
+	 * Max size (in bytes) of trunk frames. Values above the path MTU rely on
+	 * jumbo frames or IP fragmentation. Default 8192.
+	 */
+	trunkMaxFrameSize?: number;
+
+	/**
+	 * Exchange packets with the remote PipeTransport over a single TCP
+	 * connection (RFC 4571 framing) instead of UDP. Useful across lossy or
+	 * filtered inter-datacenter links. For this to work, both PipeTransports
+	 * must enable this setting and connect() must be called with opposite
+	 * tcpRole values. Not valid along with inMemory or enableTrunk. Default
+	 * false.
+	 */
+	enableTcp?: boolean;
+
+	/**
+	 * For PipeTransports within a host or a private network. RTP and RTCP are
+	 * not encrypted but carry a CRC32c checksum, and RTP packets also carry a
+	 * compact stream index so the receiver finds their Producer without
+	 * looking up their SSRC. For this to work, both PipeTransports must enable
+	 * this setting. Not valid along with enableSrtp, inMemory or enableTrunk.
+	 * Default false.
+	 */
+	trustedNetwork?: boolean;
+
+	/**
+	 * Max time (in ms) received media packets following a sequence number gap
+	 * are held waiting for the missing ones, so packets reordered by the
+	 * network are not NACKed. Up to 50. Default 0 (disabled).
+	 */
+	rtpReorderDelay?: number;
+
 	/**
 	 * Custom application data.
 	 */
@@ -93,8 +148,17 @@ export type PipeTransportStat =
 	availableOutgoingBitrate?: number;
 	availableIncomingBitrate?: number;
 	maxIncomingBitrate?: number;
+	ecnCePacketsReceived?: number;
+	ecnCePacketsSent?: number;
+	forwardingLatency?: TransportForwardingLatency;
+	cpuMsPerSecond: number;
 	// PipeTransport specific.
 	tuple: TransportTuple;
+	trunkSentFrames?: number;
+	trunkSentPackets?: number;
+	trustedChecksumErrors?: number;
+	udpSocket?: TransportUdpSocketStat;
+	tcpConnection?: TransportTcpConnectionStat;
 }
 
 export type PipeConsumerOptions =
@@ -133,6 +197,7 @@ export class PipeTransport
 		sctpState?: SctpState;
 		rtx: boolean;
 		srtpParameters?: SrtpParameters;
+		memoryPipeId?: string;
 	};
 
 	/**
@@ -154,7 +219,8 @@ export class PipeTransport
 			sctpParameters : data.sctpParameters,
 			sctpState      : data.sctpState,
 			rtx            : data.rtx,
-			srtpParameters : data.srtpParameters
+			srtpParameters : data.srtpParameters,
+			memoryPipeId   : data.memoryPipeId
 		};
 
 		this.handleWorkerNotifications();
@@ -192,6 +258,14 @@ export class PipeTransport
 		return this.#data.srtpParameters;
 	}
 
+	/**
+	 * Memory pipe id (if inMemory is enabled).
+	 */
+	get memoryPipeId(): string | undefined
+	{
+		return this.#data.memoryPipeId;
+	}
+
 	/**
 	 * Observer.
 	 *
@@ -260,18 +334,22 @@ export class PipeTransport
 		{
 			ip,
 			port,
-			srtpParameters
+			srtpParameters,
+			memoryPipeId,
+			tcpRole
 		}:
 		{
 			ip: string;
 			port: number;
 			srtpParameters?: SrtpParameters;
+			memoryPipeId?: string;
+			tcpRole?: 'client' | 'server';
 		}
 	): Promise<void>
 	{
 		logger.debug('connect()');
 
-		const reqData = { ip, port, srtpParameters };
+		const reqData = { ip, port, srtpParameters, memoryPipeId, tcpRole };
 
 		const data =
 			await this.channel.request('transport.connect', this.internal, reqData);
@@ -280,6 +358,15 @@ export class PipeTransport
 		this.#data.tuple = data.tuple;
 	}
 
+	/**
+	 * @override
+	 */
+	// eslint-disable-next-line @typescript-eslint/no-unused-vars
+	async consumeMany(optionsList: ConsumerOptions[]): Promise<(Consumer | Error)[]>
+	{
+		throw new UnsupportedError('consumeMany() not implemented in PipeTransport');
+	}
+
 	/**
 	 * Create a pipe Consumer.
 	 *
@@ -319,7 +406,7 @@ export class PipeTransport
 
 		const consumer = new Consumer(
 			{
-				internal,
+				internal : { ...internal, consumerHandle: status.handle },
 				data,
 				channel        : this.channel,
 				payloadChannel : this.payloadChannel,
@@ -6,7 +6,11 @@ import {
 	TransportTraceEventData,
 	TransportEvents,
 	TransportObserverEvents,
-	SctpState
+	SctpState,
+	TransportForwardingLatency,
+	TransportIngressPolicer,
+	TransportIngressDrops,
+	TransportUdpSocketStat
 } from './Transport';
 import { SctpParameters, NumSctpStreams } from './SctpParameters';
 import { SrtpParameters, SrtpCryptoSuite } from './SrtpParameters';
@@ -37,6 +41,15 @@ export type PlainTransportOptions =
 	 */
 	comedia?: boolean;
 
+	/**
+	 * Share the listening port (listenIp and port) with every other PlainTransport
+	 * in the same Worker created with this option. Packets are dispatched to the
+	 * transport connected to their source IP:port or, in comedia mode, to the
+	 * transport with a Producer matching their SSRC. Requires rtcpMux.
+	 * Default false.
+	 */
+	sharedPort?: boolean;
+
 	/**
 	 * Create a SCTP association. Default false.
 	 */
@@ -59,6 +72,14 @@ export type PlainTransportOptions =
 	 */
 	sctpSendBufferSize?: number;
 
+	/**
+	 * Share (between 0 and 1) of the estimated outgoing bitrate for SCTP
+	 * packets. If given, they are paced along with the media (once there is
+	 * bandwidth estimation), so large DataChannel transfers do not cause
+	 * queueing delay to the media. Default 0 (not paced).
+	 */
+	sctpBitrateShare?: number;
+
 	/**
 	 * Enable SRTP. For this to work, connect() must be called
 	 * with remote SRTP parameters. Default false.
@@ -71,6 +92,32 @@ export type PlainTransportOptions =
 	 */
 	srtpCryptoSuite?: SrtpCryptoSuite;
 
+	/**
+	 * Max time (in ms) received media packets following a sequence number gap
+	 * are held waiting for the missing ones, so packets reordered by the
+	 * network are not NACKed. Up to 50. Default 0 (disabled).
+	 */
+	rtpReorderDelay?: number;
+
+	/**
+	 * Limits of the received packets, applied before parsing them.
+	 */
+	ingressPolicer?: TransportIngressPolicer;
+
+	/**
+	 * TTL (between 1 and 255) of the packets sent to a multicast group given in
+	 * connect(), so several receivers get a single stream. Not valid with
+	 * comedia or sharedPort. Default none (system default of 1).
+	 */
+	multicastTtl?: number;
+
+	/**
+	 * Local IP of the interface used to send packets to a multicast group given
+	 * in connect(). Not valid with comedia or sharedPort. Default none (chosen
+	 * by the system).
+	 */
+	multicastInterface?: string;
+
 	/**
 	 * Custom application data.
 	 */
@@ -106,11 +153,18 @@ export type PlainTransportStat =
 	availableOutgoingBitrate?: number;
 	availableIncomingBitrate?: number;
 	maxIncomingBitrate?: number;
+	ecnCePacketsReceived?: number;
+	ecnCePacketsSent?: number;
+	forwardingLatency?: TransportForwardingLatency;
+	cpuMsPerSecond: number;
 	// PlainTransport specific.
 	rtcpMux: boolean;
 	comedia: boolean;
 	tuple: TransportTuple;
 	rtcpTuple?: TransportTuple;
+	udpSocket: TransportUdpSocketStat;
+	rtcpUdpSocket?: TransportUdpSocketStat;
+	ingressDrops: TransportIngressDrops;
 }
 
 /**
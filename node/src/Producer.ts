@@ -3,6 +3,7 @@ import { EnhancedEventEmitter } from './EnhancedEventEmitter';
 import { Channel } from './Channel';
 import { PayloadChannel } from './PayloadChannel';
 import { MediaKind, RtpParameters } from './RtpParameters';
+import { WorkerMetricsHistogram } from './Worker';
 
 export type ProducerOptions =
 {
@@ -32,6 +33,20 @@ export type ProducerOptions =
 	 */
 	keyFrameRequestDelay?: number;
 
+	/**
+	 * Just for video. Whether to cache the packets of the most recent key frame
+	 * (and the ones following it), so Consumers that need to sync are
+	 * bootstrapped from it instead of asking the endpoint for a new key frame.
+	 * Default false.
+	 */
+	enableKeyFrameCache?: boolean;
+
+	/**
+	 * Ids of the Routers the stream was relayed through (origin first). Set by
+	 * Router.pipeToRouter() so relaying it back into any of them fails.
+	 */
+	relayPath?: string[];
+
 	/**
 	 * Custom application data.
 	 */
@@ -43,15 +58,41 @@ export type ProducerOptions =
  */
 export type ProducerTraceEventType = 'rtp' | 'keyframe' | 'nack' | 'pli' | 'fir';
 
+/**
+ * Options of enableTraceEvent() in Transports, Producers and Consumers.
+ */
+export type TraceEventOptions =
+{
+	/**
+	 * Just 1 in N per packet events ('rtp', 'probation') is traced. Default 1.
+	 */
+	sampleRate?: number;
+
+	/**
+	 * 'event': traced events are emitted (default).
+	 * 'summary': no event is emitted but, every second, a 'summary' event with
+	 * the number of events of each type.
+	 * 'buffer': the last bufferSize traced events are kept and given in the
+	 * traceEvents field of dump().
+	 */
+	mode?: 'event' | 'summary' | 'buffer';
+
+	/**
+	 * Number of events kept in 'buffer' mode (up to 10000). Default 100.
+	 */
+	bufferSize?: number;
+};
+
 /**
  * 'trace' event data.
  */
 export type ProducerTraceEventData =
 {
 	/**
-	 * Trace type.
+	 * Trace type ('summary' events are given in 'summary' mode and their info
+	 * holds the number of events of each type).
 	 */
-	type: ProducerTraceEventType;
+	type: ProducerTraceEventType | 'summary';
 
 	/**
 	 * Event timestamp.
@@ -105,6 +146,22 @@ export type ProducerVideoOrientation =
 	rotation: number;
 }
 
+/**
+ * Max layers wanted by the Consumers (and RtpObservers) of a Producer.
+ */
+export type ProducerLayerDemand =
+{
+	/**
+	 * The max spatial layer wanted by any Consumer.
+	 */
+	spatialLayer: number;
+
+	/**
+	 * The max temporal layer wanted by any Consumer.
+	 */
+	temporalLayer: number;
+}
+
 export type ProducerStat =
 {
 	// Common to all RtpStreams.
@@ -133,6 +190,46 @@ export type ProducerStat =
 	// RtpStreamRecv specific.
 	jitter: number;
 	bitrateByLayer?: any;
+	// Time (ms) since media capture until the packet was received. Just if the
+	// Producer sends the abs-capture-time RTP header extension (and RTCP Sender
+	// Reports). It doesn't include the network delay if the round trip time is
+	// unknown.
+	captureLatency?: Omit<WorkerMetricsHistogram, 'buckets'>;
+	// Just if the Producer was relayed from another Router.
+	relayHops?: number;
+	hopLatency?: number;
+	// Just if the Transport has rtpReorderDelay.
+	reorderBuffer?:
+	{
+		reorderedPackets: number;
+		nacksAvoided: number;
+		skippedPackets: number;
+	};
+	// Time (ms) since the Producer creation until its first RTP packet was
+	// received.
+	joinLatency?:
+	{
+		firstRtpMs: number;
+	};
+}
+
+/**
+ * Result of getStatsDelta() in Transports, Producers and Consumers.
+ */
+export type StatsDelta<T> =
+{
+	/**
+	 * Cursor to give in the next getStatsDelta() call.
+	 */
+	cursor: number;
+
+	/**
+	 * Whether stats are full. Otherwise just the fields changed since the
+	 * previous call (plus type and ssrc) are given in each stats entry.
+	 */
+	full: boolean;
+
+	stats: Partial<T>[];
 }
 
 /**
@@ -145,6 +242,7 @@ export type ProducerEvents =
 	transportclose: [];
 	score: [ProducerScore[]];
 	videoorientationchange: [ProducerVideoOrientation];
+	layerdemandchange: [ProducerLayerDemand | undefined];
 	trace: [ProducerTraceEventData];
 }
 
@@ -155,6 +253,7 @@ export type ProducerObserverEvents =
 	resume: [];
 	score: [ProducerScore[]];
 	videoorientationchange: [ProducerVideoOrientation];
+	layerdemandchange: [ProducerLayerDemand | undefined];
 	trace: [ProducerTraceEventData];
 }
 
@@ -168,6 +267,7 @@ export class Producer extends EnhancedEventEmitter<ProducerEvents>
 		routerId: string;
 		transportId: string;
 		producerId: string;
+		producerHandle?: number;
 	};
 
 	// Producer data.
@@ -177,6 +277,7 @@ export class Producer extends EnhancedEventEmitter<ProducerEvents>
 		rtpParameters: RtpParameters;
 		type: ProducerType;
 		consumableRtpParameters: RtpParameters;
+		relayPath: string[];
 	};
 
 	// Channel instance.
@@ -197,6 +298,13 @@ export class Producer extends EnhancedEventEmitter<ProducerEvents>
 	// Current score.
 	#score: ProducerScore[] = [];
 
+	// Current layer demand.
+	#layerDemand?: ProducerLayerDemand;
+
+	// RTP parameters of Consumers (also kept in the worker) indexed by their
+	// rtpParametersKey.
+	readonly #consumerRtpParametersTemplates = new Map<string, RtpParameters>();
+
 	// Observer instance.
 	readonly #observer = new EnhancedEventEmitter<ProducerObserverEvents>();
 
@@ -205,6 +313,7 @@ export class Producer extends EnhancedEventEmitter<ProducerEvents>
 	 * @emits transportclose
 	 * @emits score - (score: ProducerScore[])
 	 * @emits videoorientationchange - (videoOrientation: ProducerVideoOrientation)
+	 * @emits layerdemandchange - (layerDemand: ProducerLayerDemand | undefined)
 	 * @emits trace - (trace: ProducerTraceEventData)
 	 * @emits @close
 	 */
@@ -291,6 +400,24 @@ export class Producer extends EnhancedEventEmitter<ProducerEvents>
 		return this.#data.consumableRtpParameters;
 	}
 
+	/**
+	 * RTP parameters of Consumers indexed by their rtpParametersKey.
+	 *
+	 * @private
+	 */
+	get consumerRtpParametersTemplates(): Map<string, RtpParameters>
+	{
+		return this.#consumerRtpParametersTemplates;
+	}
+
+	/**
+	 * Ids of the Routers the stream was relayed through (origin first).
+	 */
+	get relayPath(): string[]
+	{
+		return this.#data.relayPath;
+	}
+
 	/**
 	 * Whether the Producer is paused.
 	 */
@@ -307,6 +434,16 @@ export class Producer extends EnhancedEventEmitter<ProducerEvents>
 		return this.#score;
 	}
 
+	/**
+	 * Max layers wanted by the Consumers (and RtpObservers) of the Producer
+	 * (undefined if none wants any layer). Senders may stop encoding higher
+	 * layers.
+	 */
+	get layerDemand(): ProducerLayerDemand | undefined
+	{
+		return this.#layerDemand;
+	}
+
 	/**
 	 * App custom data.
 	 */
@@ -331,6 +468,7 @@ export class Producer extends EnhancedEventEmitter<ProducerEvents>
 	 * @emits resume
 	 * @emits score - (score: ProducerScore[])
 	 * @emits videoorientationchange - (videoOrientation: ProducerVideoOrientation)
+	 * @emits layerdemandchange - (layerDemand: ProducerLayerDemand | undefined)
 	 * @emits trace - (trace: ProducerTraceEventData)
 	 */
 	get observer(): EnhancedEventEmitter<ProducerObserverEvents>
@@ -416,6 +554,17 @@ export class Producer extends EnhancedEventEmitter<ProducerEvents>
 		return this.#channel.request('producer.getStats', this.#internal);
 	}
 
+	/**
+	 * Get Producer stats changed since the call that returned the given cursor
+	 * (full stats if 0 or if it is not the last returned cursor).
+	 */
+	async getStatsDelta(cursor = 0): Promise<StatsDelta<ProducerStat>>
+	{
+		logger.debug('getStatsDelta()');
+
+		return this.#channel.request('producer.getStats', this.#internal, { cursor });
+	}
+
 	/**
 	 * Pause the Producer.
 	 */
@@ -455,11 +604,14 @@ export class Producer extends EnhancedEventEmitter<ProducerEvents>
 	/**
 	 * Enable 'trace' event.
 	 */
-	async enableTraceEvent(types: ProducerTraceEventType[] = []): Promise<void>
+	async enableTraceEvent(
+		types: ProducerTraceEventType[] = [],
+		options: TraceEventOptions = {}
+	): Promise<void>
 	{
 		logger.debug('enableTraceEvent()');
 
-		const reqData = { types };
+		const reqData = { types, ...options };
 
 		await this.#channel.request(
 			'producer.enableTraceEvent', this.#internal, reqData);
@@ -511,6 +663,20 @@ export class Producer extends EnhancedEventEmitter<ProducerEvents>
 					break;
 				}
 
+				case 'layerdemandchange':
+				{
+					const layerDemand = (data ?? undefined) as ProducerLayerDemand | undefined;
+
+					this.#layerDemand = layerDemand;
+
+					this.safeEmit('layerdemandchange', layerDemand);
+
+					// Emit observer event.
+					this.#observer.safeEmit('layerdemandchange', layerDemand);
+
+					break;
+				}
+
 				case 'trace':
 				{
 					const trace = data as ProducerTraceEventData;
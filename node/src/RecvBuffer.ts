@@ -0,0 +1,138 @@
+import * as os from 'os';
+
+const littleEndian = os.endianness() == 'LE';
+
+const INITIAL_SIZE = 65536;
+
+/**
+ * Framing of the length prefixed messages received from the worker. Messages
+ * are parsed in place from each received chunk (with no copy), and just the
+ * bytes of a message split across chunks are copied (once) into a growable
+ * buffer that is reused for the next split message.
+ */
+export class RecvBuffer
+{
+	// Max payload length of a message.
+	readonly #maxPayloadLen: number;
+
+	// Buffer for a message split across chunks.
+	#buffer = Buffer.allocUnsafe(INITIAL_SIZE);
+
+	// Bytes of the split message (including its length prefix) stored so far.
+	#len = 0;
+
+	constructor(maxPayloadLen: number)
+	{
+		this.#maxPayloadLen = maxPayloadLen;
+	}
+
+	/**
+	 * Calls onMessage() with the payload of every complete message. The payload
+	 * is a view of the given chunk if inPlace is true. Otherwise it's a view of
+	 * the internal buffer, just valid until onMessage() returns.
+	 *
+	 * Returns false (and discards the pending data) if a message exceeds the max
+	 * payload length.
+	 */
+	push(
+		chunk: Buffer,
+		onMessage: (payload: Buffer, inPlace: boolean) => void
+	): boolean
+	{
+		let offset = 0;
+
+		// Complete the pending split message first.
+		if (this.#len > 0)
+		{
+			if (this.#len < 4)
+			{
+				const headerLen = Math.min(4 - this.#len, chunk.length);
+
+				chunk.copy(this.#buffer, this.#len, 0, headerLen);
+				this.#len += headerLen;
+				offset = headerLen;
+
+				if (this.#len < 4)
+					return true;
+			}
+
+			const msgLen = this.readLength(this.#buffer, 0);
+
+			if (msgLen > this.#maxPayloadLen)
+			{
+				this.#len = 0;
+
+				return false;
+			}
+
+			this.ensure(4 + msgLen);
+
+			const copyLen = Math.min(4 + msgLen - this.#len, chunk.length - offset);
+
+			chunk.copy(this.#buffer, this.#len, offset, offset + copyLen);
+			this.#len += copyLen;
+			offset += copyLen;
+
+			if (this.#len < 4 + msgLen)
+				return true;
+
+			this.#len = 0;
+
+			onMessage(this.#buffer.subarray(4, 4 + msgLen), false);
+		}
+
+		while (chunk.length - offset >= 4)
+		{
+			const msgLen = this.readLength(chunk, offset);
+
+			if (msgLen > this.#maxPayloadLen)
+				return false;
+
+			if (chunk.length - offset < 4 + msgLen)
+			{
+				// Incomplete data.
+				this.ensure(4 + msgLen);
+
+				break;
+			}
+
+			onMessage(chunk.subarray(offset + 4, offset + 4 + msgLen), true);
+
+			offset += 4 + msgLen;
+		}
+
+		// Keep the beginning of the next message.
+		if (offset < chunk.length)
+		{
+			chunk.copy(this.#buffer, 0, offset);
+			this.#len = chunk.length - offset;
+		}
+
+		return true;
+	}
+
+	private readLength(buffer: Buffer, offset: number): number
+	{
+		return littleEndian
+			? buffer.readUInt32LE(offset)
+			: buffer.readUInt32BE(offset);
+	}
+
+	private ensure(len: number): void
+	{
+		if (len <= this.#buffer.length)
+			return;
+
+		let size = this.#buffer.length * 2;
+
+		while (size < len)
+		{
+			size *= 2;
+		}
+
+		const buffer = Buffer.allocUnsafe(size);
+
+		this.#buffer.copy(buffer, 0, 0, this.#len);
+		this.#buffer = buffer;
+	}
+}
@@ -17,6 +17,7 @@ import { DataConsumer } from './DataConsumer';
 import { RtpObserver } from './RtpObserver';
 import { ActiveSpeakerObserver, ActiveSpeakerObserverOptions } from './ActiveSpeakerObserver';
 import { AudioLevelObserver, AudioLevelObserverOptions } from './AudioLevelObserver';
+import { AudioMixer, AudioMixerOptions } from './AudioMixer';
 import { RtpCapabilities, RtpCodecCapability } from './RtpParameters';
 import { NumSctpStreams } from './SctpParameters';
 
@@ -27,6 +28,21 @@ export type RouterOptions =
 	 */
 	mediaCodecs?: RtpCodecCapability[];
 
+	/**
+	 * If greater than zero, audio from Producers that are not among the N
+	 * loudest ones (according to the audio level RTP header extension) is not
+	 * sent to Consumers, except PipeConsumers. Default 0 (disabled).
+	 */
+	audioLastN?: number;
+
+	/**
+	 * If greater than zero, memory (in bytes) used by the Router media buffers
+	 * (given in router.dump() as memoryUsage) above which the retransmission
+	 * buffers of consumers are shrunk until the usage is back below half of it.
+	 * Default 0 (no limit).
+	 */
+	memorySoftLimit?: number;
+
 	/**
 	 * Custom application data.
 	 */
@@ -74,6 +90,30 @@ export type PipeToRouterOptions =
 	 * Enable SRTP.
 	 */
 	enableSrtp?: boolean;
+
+	/**
+	 * Exchange packets through memory instead of UDP. Only valid if both
+	 * Routers belong to the same Worker.
+	 */
+	inMemory?: boolean;
+
+	/**
+	 * Aggregate RTP and RTCP packets into bigger frames (see enableTrunk in
+	 * PipeTransportOptions).
+	 */
+	enableTrunk?: boolean;
+
+	/**
+	 * Exchange packets over TCP instead of UDP (see enableTcp in
+	 * PipeTransportOptions).
+	 */
+	enableTcp?: boolean;
+
+	/**
+	 * Skip SRTP and use lightweight integrity checks (see trustedNetwork in
+	 * PipeTransportOptions).
+	 */
+	trustedNetwork?: boolean;
 }
 
 export type PipeToRouterResult =
@@ -124,6 +164,7 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 	readonly #internal:
 	{
 		routerId: string;
+		routerHandle?: number;
 	};
 
 	// Router data.
@@ -331,13 +372,43 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 	}
 
 	/**
-	 * Dump Router.
+	 * Dump Router. If pageSize is given, each collection of the dump lists at
+	 * most pageSize entries starting at page * pageSize, and hasMore tells
+	 * whether there are more pages (for routers with many objects).
 	 */
-	async dump(): Promise<any>
+	async dump(
+		{ page, pageSize }: { page?: number; pageSize?: number } = {}
+	): Promise<any>
 	{
 		logger.debug('dump()');
 
-		return this.#channel.request('router.dump', this.#internal);
+		return this.#channel.request('router.dump', this.#internal, { page, pageSize });
+	}
+
+	/**
+	 * Close the given Transports with a single request. Much faster than
+	 * closing them one by one when there are many of them, since their
+	 * Consumers are not told about the closure of the Producers of the other
+	 * closing Transports.
+	 */
+	async closeTransports(transports: Transport[]): Promise<void>
+	{
+		logger.debug('closeTransports()');
+
+		const openTransports = transports.filter((transport) => !transport.closed);
+
+		if (openTransports.length === 0)
+			return;
+
+		for (const transport of openTransports)
+		{
+			transport.closeInBulk();
+		}
+
+		await this.#channel.request(
+			'router.closeTransports',
+			this.#internal,
+			{ transportIds: openTransports.map((transport) => transport.id) });
 	}
 
 	/**
@@ -345,6 +416,7 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 	 */
 	async createWebRtcTransport(
 		{
+			webRtcServer,
 			listenIps,
 			port,
 			enableUdp = true,
@@ -356,18 +428,22 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 			numSctpStreams = { OS: 1024, MIS: 1024 },
 			maxSctpMessageSize = 262144,
 			sctpSendBufferSize = 262144,
+			sctpBitrateShare,
+			ingressPolicer,
 			appData
 		}: WebRtcTransportOptions
 	): Promise<WebRtcTransport>
 	{
 		logger.debug('createWebRtcTransport()');
 
-		if (!Array.isArray(listenIps))
-			throw new TypeError('missing listenIps');
+		if (!webRtcServer && !Array.isArray(listenIps))
+			throw new TypeError('missing webRtcServer and listenIps (one of them is mandatory)');
+		else if (webRtcServer && listenIps)
+			throw new TypeError('only one of webRtcServer and listenIps must be given');
 		else if (appData && typeof appData !== 'object')
 			throw new TypeError('if given, appData must be an object');
 
-		listenIps = listenIps.map((listenIp) =>
+		listenIps = listenIps?.map((listenIp) =>
 		{
 			if (typeof listenIp === 'string' && listenIp)
 			{
@@ -389,6 +465,7 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 		const internal = { ...this.#internal, transportId: uuidv4() };
 		const reqData = {
 			listenIps,
+			webRtcServerId : webRtcServer ? webRtcServer.id : undefined,
 			port,
 			enableUdp,
 			enableTcp,
@@ -399,15 +476,21 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 			numSctpStreams,
 			maxSctpMessageSize,
 			sctpSendBufferSize,
-			isDataChannel : true
+			sctpBitrateShare,
+			isDataChannel : true,
+			ingressPolicer
 		};
 
-		const data =
-			await this.#channel.request('router.createWebRtcTransport', internal, reqData);
+		const data = await this.#channel.request(
+			webRtcServer
+				? 'router.createWebRtcTransportWithServer'
+				: 'router.createWebRtcTransport',
+			internal,
+			reqData);
 
 		const transport = new WebRtcTransport(
 			{
-				internal,
+				internal : { ...internal, transportHandle: data.handle },
 				data,
 				channel                  : this.#channel,
 				payloadChannel           : this.#payloadChannel,
@@ -431,10 +514,14 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 		transport.on('@dataproducerclose', (dataProducer: DataProducer) => (
 			this.#dataProducers.delete(dataProducer.id)
 		));
+		transport.on('@listenserverclose', () => this.#transports.delete(transport.id));
 
 		// Emit observer event.
 		this.#observer.safeEmit('newtransport', transport);
 
+		if (webRtcServer)
+			webRtcServer.handleWebRtcTransport(transport);
+
 		return transport;
 	}
 
@@ -447,12 +534,18 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 			port,
 			rtcpMux = true,
 			comedia = false,
+			sharedPort = false,
 			enableSctp = false,
 			numSctpStreams = { OS: 1024, MIS: 1024 },
 			maxSctpMessageSize = 262144,
 			sctpSendBufferSize = 262144,
+			sctpBitrateShare,
 			enableSrtp = false,
 			srtpCryptoSuite = 'AES_CM_128_HMAC_SHA1_80',
+			rtpReorderDelay,
+			ingressPolicer,
+			multicastTtl,
+			multicastInterface,
 			appData
 		}: PlainTransportOptions
 	): Promise<PlainTransport>
@@ -487,13 +580,19 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 			port,
 			rtcpMux,
 			comedia,
+			sharedPort,
 			enableSctp,
 			numSctpStreams,
 			maxSctpMessageSize,
 			sctpSendBufferSize,
+			sctpBitrateShare,
 			isDataChannel : false,
 			enableSrtp,
-			srtpCryptoSuite
+			srtpCryptoSuite,
+			rtpReorderDelay,
+			ingressPolicer,
+			multicastTtl,
+			multicastInterface
 		};
 
 		const data =
@@ -501,7 +600,7 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 
 		const transport = new PlainTransport(
 			{
-				internal,
+				internal : { ...internal, transportHandle: data.handle },
 				data,
 				channel                  : this.#channel,
 				payloadChannel           : this.#payloadChannel,
@@ -558,6 +657,12 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 			sctpSendBufferSize = 268435456,
 			enableRtx = false,
 			enableSrtp = false,
+			inMemory = false,
+			enableTrunk = false,
+			trunkMaxFrameSize,
+			enableTcp = false,
+			trustedNetwork = false,
+			rtpReorderDelay,
 			appData
 		}: PipeTransportOptions
 	): Promise<PipeTransport>
@@ -596,7 +701,13 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 			sctpSendBufferSize,
 			isDataChannel : false,
 			enableRtx,
-			enableSrtp
+			enableSrtp,
+			inMemory,
+			enableTrunk,
+			trunkMaxFrameSize,
+			enableTcp,
+			trustedNetwork,
+			rtpReorderDelay
 		};
 
 		const data =
@@ -604,7 +715,7 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 
 		const transport = new PipeTransport(
 			{
-				internal,
+				internal : { ...internal, transportHandle: data.handle },
 				data,
 				channel                  : this.#channel,
 				payloadChannel           : this.#payloadChannel,
@@ -641,6 +752,7 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 	async createDirectTransport(
 		{
 			maxMessageSize = 262144,
+			recordPath,
 			appData
 		}: DirectTransportOptions =
 		{
@@ -651,14 +763,14 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 		logger.debug('createDirectTransport()');
 
 		const internal = { ...this.#internal, transportId: uuidv4() };
-		const reqData = { direct: true, maxMessageSize };
+		const reqData = { direct: true, maxMessageSize, recordPath };
 
 		const data =
 			await this.#channel.request('router.createDirectTransport', internal, reqData);
 
 		const transport = new DirectTransport(
 			{
-				internal,
+				internal : { ...internal, transportHandle: data.handle },
 				data,
 				channel                  : this.#channel,
 				payloadChannel           : this.#payloadChannel,
@@ -701,7 +813,11 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 			enableSctp = true,
 			numSctpStreams = { OS: 1024, MIS: 1024 },
 			enableRtx = false,
-			enableSrtp = false
+			enableSrtp = false,
+			inMemory = false,
+			enableTrunk = false,
+			enableTcp = false,
+			trustedNetwork = false
 		}: PipeToRouterOptions
 	): Promise<PipeToRouterResult>
 	{
@@ -754,9 +870,29 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 				Promise.all(
 					[
 						this.createPipeTransport(
-							{ listenIp, enableSctp, numSctpStreams, enableRtx, enableSrtp }),
+							{
+								listenIp,
+								enableSctp,
+								numSctpStreams,
+								enableRtx,
+								enableSrtp,
+								inMemory,
+								enableTrunk,
+								enableTcp,
+								trustedNetwork
+							}),
 						router.createPipeTransport(
-							{ listenIp, enableSctp, numSctpStreams, enableRtx, enableSrtp })
+							{
+								listenIp,
+								enableSctp,
+								numSctpStreams,
+								enableRtx,
+								enableSrtp,
+								inMemory,
+								enableTrunk,
+								enableTcp,
+								trustedNetwork
+							})
 					])
 					.then((pipeTransports) =>
 					{
@@ -765,21 +901,27 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 					})
 					.then(() =>
 					{
-						return Promise.all(
-							[
-								localPipeTransport.connect(
-									{
-										ip             : remotePipeTransport.tuple.localIp,
-										port           : remotePipeTransport.tuple.localPort,
-										srtpParameters : remotePipeTransport.srtpParameters
-									}),
-								remotePipeTransport.connect(
-									{
-										ip             : localPipeTransport.tuple.localIp,
-										port           : localPipeTransport.tuple.localPort,
-										srtpParameters : localPipeTransport.srtpParameters
-									})
-							]);
+						// The remote PipeTransport is connected first so it's ready to adopt
+						// the TCP connection initiated by the local one.
+						return remotePipeTransport.connect(
+							{
+								ip             : localPipeTransport.tuple.localIp,
+								port           : localPipeTransport.tuple.localPort,
+								srtpParameters : localPipeTransport.srtpParameters,
+								memoryPipeId   : localPipeTransport.memoryPipeId,
+								tcpRole        : enableTcp ? 'server' : undefined
+							});
+					})
+					.then(() =>
+					{
+						return localPipeTransport.connect(
+							{
+								ip             : remotePipeTransport.tuple.localIp,
+								port           : remotePipeTransport.tuple.localPort,
+								srtpParameters : remotePipeTransport.srtpParameters,
+								memoryPipeId   : remotePipeTransport.memoryPipeId,
+								tcpRole        : enableTcp ? 'client' : undefined
+							});
 					})
 					.then(() =>
 					{
@@ -845,6 +987,7 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 						kind          : pipeConsumer!.kind,
 						rtpParameters : pipeConsumer!.rtpParameters,
 						paused        : pipeConsumer!.producerPaused,
+						relayPath     : [ ...producer.relayPath, this.id ],
 						appData       : producer.appData
 					});
 
@@ -870,6 +1013,15 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 				// Pipe events from the pipe Producer to the pipe Consumer.
 				pipeProducer.observer.on('close', () => pipeConsumer!.close());
 
+				// Don't send streams nobody consumes in the remote Router.
+				pipeProducer.observer.on('layerdemandchange', (layerDemand) =>
+				{
+					pipeConsumer!.setLayerDemand(layerDemand)
+						.catch(() => {});
+				});
+
+				await pipeConsumer.setLayerDemand(pipeProducer.layerDemand);
+
 				return { pipeConsumer, pipeProducer };
 			}
 			catch (error)
@@ -984,6 +1136,8 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 	async createActiveSpeakerObserver(
 		{
 			interval = 300,
+			useSimd = false,
+			videoLastN = 0,
 			appData
 		}: ActiveSpeakerObserverOptions = {}
 	): Promise<ActiveSpeakerObserver>
@@ -994,7 +1148,7 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 			throw new TypeError('if given, appData must be an object');
 		
 		const internal = { ...this.#internal, rtpObserverId: uuidv4() };
-		const reqData = { interval };
+		const reqData = { interval, useSimd, videoLastN };
 
 		await this.#channel.request('router.createActiveSpeakerObserver', internal, reqData);
 
@@ -1029,6 +1183,7 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 			maxEntries = 1,
 			threshold = -80,
 			interval = 1000,
+			incremental = false,
 			appData
 		}: AudioLevelObserverOptions = {}
 	): Promise<AudioLevelObserver>
@@ -1039,7 +1194,7 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 			throw new TypeError('if given, appData must be an object');
 
 		const internal = { ...this.#internal, rtpObserverId: uuidv4() };
-		const reqData = { maxEntries, threshold, interval };
+		const reqData = { maxEntries, threshold, interval, incremental };
 
 		await this.#channel.request('router.createAudioLevelObserver', internal, reqData);
 
@@ -1066,6 +1221,54 @@ export class Router extends EnhancedEventEmitter<RouterEvents>
 		return audioLevelObserver;
 	}
 
+	/**
+	 * Create an AudioMixer. It requires the worker to be built with the
+	 * ms_audio_mixer option.
+	 */
+	async createAudioMixer(
+		{
+			outputProducerId,
+			maxSpeakers = 3,
+			bitrate = 32000,
+			appData
+		}: AudioMixerOptions
+	): Promise<AudioMixer>
+	{
+		logger.debug('createAudioMixer()');
+
+		if (typeof outputProducerId !== 'string')
+			throw new TypeError('missing outputProducerId');
+		else if (appData && typeof appData !== 'object')
+			throw new TypeError('if given, appData must be an object');
+
+		const internal = { ...this.#internal, rtpObserverId: uuidv4() };
+		const reqData = { outputProducerId, maxSpeakers, bitrate };
+
+		await this.#channel.request('router.createAudioMixer', internal, reqData);
+
+		const audioMixer = new AudioMixer(
+			{
+				internal,
+				channel         : this.#channel,
+				payloadChannel  : this.#payloadChannel,
+				appData,
+				getProducerById : (producerId: string): Producer | undefined => (
+					this.#producers.get(producerId)
+				)
+			});
+
+		this.#rtpObservers.set(audioMixer.id, audioMixer);
+		audioMixer.on('@close', () =>
+		{
+			this.#rtpObservers.delete(audioMixer.id);
+		});
+
+		// Emit observer event.
+		this.#observer.safeEmit('newrtpobserver', audioMixer);
+
+		return audioMixer;
+	}
+
 	/**
 	 * Check whether the given RTP capabilities can consume the given Producer.
 	 */
@@ -26,6 +26,12 @@ export type RtpObserverAddRemoveProducerOptions =
 	 * The id of the Producer to be added or removed.
 	 */
 	producerId: string;
+
+	/**
+	 * Video Producers of the same participant, paused and resumed by the video
+	 * last N policy of an ActiveSpeakerObserver. Just for addProducer().
+	 */
+	videoProducerIds?: string[];
 }
 
 export class RtpObserver<E extends RtpObserverEvents = RtpObserverEvents>
@@ -235,12 +241,17 @@ export class RtpObserver<E extends RtpObserverEvents = RtpObserverEvents>
 	/**
 	 * Add a Producer to the RtpObserver.
 	 */
-	async addProducer({ producerId }: RtpObserverAddRemoveProducerOptions): Promise<void>
+	async addProducer(
+		{ producerId, videoProducerIds }: RtpObserverAddRemoveProducerOptions
+	): Promise<void>
 	{
 		logger.debug('addProducer()');
 
+		if (videoProducerIds && !Array.isArray(videoProducerIds))
+			throw new TypeError('if given, videoProducerIds must be an array');
+
 		const producer = this.getProducerById(producerId);
-		const reqData = { producerId };
+		const reqData = { producerId, videoProducerIds };
 
 		await this.channel.request('rtpObserver.addProducer', this.internal, reqData);
 
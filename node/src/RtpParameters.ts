@@ -272,6 +272,13 @@ export type RtpEncodingParameters =
 	 */
 	rtx?: { ssrc: number };
 
+	/**
+	 * FlexFEC stream information. It must contain a numeric ssrc field
+	 * indicating the FEC SSRC. Just for Consumers, whose RTP parameters must
+	 * also include a video/flexfec-03 codec.
+	 */
+	fec?: { ssrc: number };
+
 	/**
 	 * It indicates whether discontinuous RTP transmission will be used. Useful
 	 * for audio (if the codec supports it) and for video screen sharing (when
@@ -0,0 +1,286 @@
+import { Logger } from './Logger';
+import { Router, RouterOptions, PipeToRouterOptions } from './Router';
+import { Worker } from './Worker';
+import { Transport } from './Transport';
+import { WebRtcTransport, WebRtcTransportOptions } from './WebRtcTransport';
+import { PlainTransport, PlainTransportOptions } from './PlainTransport';
+import { Producer } from './Producer';
+import { Consumer, ConsumerOptions } from './Consumer';
+import { RtpCapabilities } from './RtpParameters';
+
+export type ShardedRouterOptions = RouterOptions &
+{
+	/**
+	 * Workers in which a Router (shard) is created. Each Worker runs its own
+	 * event loop, so Consumers spread across shards use several cores.
+	 */
+	workers: Worker[];
+
+	/**
+	 * Options of the PipeTransports that carry Producers to the shards of their
+	 * Consumers (see router.pipeToRouter()).
+	 */
+	pipeOptions?: Omit<PipeToRouterOptions, 'producerId' | 'dataProducerId' | 'router'>;
+}
+
+type Shard =
+{
+	router: Router;
+	consumerCount: number;
+}
+
+const logger = new Logger('ShardedRouter');
+
+/**
+ * A Router whose Transports (and their Consumers) are spread across several
+ * Routers in different Workers. A Producer is piped once into each shard that
+ * consumes it and each shard fans it out to its own Consumers.
+ */
+export class ShardedRouter
+{
+	// Shards.
+	readonly #shards: Shard[];
+
+	// Options of the PipeTransports.
+	readonly #pipeOptions: ShardedRouterOptions['pipeOptions'];
+
+	// Shard of each Transport created through this.
+	readonly #transportShards: Map<string, Shard> = new Map();
+
+	// Shard in which each Producer was produced.
+	readonly #producerShards: Map<string, Shard> = new Map();
+
+	// Shards in which each Producer is (being) piped.
+	readonly #producerPipes: Map<string, Map<Shard, Promise<void>>> = new Map();
+
+	// Closed flag.
+	#closed = false;
+
+	/**
+	 * @private
+	 */
+	constructor(
+		{
+			routers,
+			pipeOptions
+		}:
+		{
+			routers: Router[];
+			pipeOptions?: ShardedRouterOptions['pipeOptions'];
+		}
+	)
+	{
+		logger.debug('constructor()');
+
+		this.#shards = routers.map((router) => ({ router, consumerCount: 0 }));
+		this.#pipeOptions = pipeOptions;
+	}
+
+	/**
+	 * Id of the first shard.
+	 */
+	get id(): string
+	{
+		return this.#shards[0].router.id;
+	}
+
+	/**
+	 * Whether the ShardedRouter is closed.
+	 */
+	get closed(): boolean
+	{
+		return this.#closed;
+	}
+
+	/**
+	 * RTP capabilities (the same in every shard).
+	 */
+	get rtpCapabilities(): RtpCapabilities
+	{
+		return this.#shards[0].router.rtpCapabilities;
+	}
+
+	/**
+	 * Routers of the shards.
+	 */
+	get routers(): Router[]
+	{
+		return this.#shards.map((shard) => shard.router);
+	}
+
+	/**
+	 * Close the ShardedRouter (and the Routers of its shards).
+	 */
+	close(): void
+	{
+		if (this.#closed)
+			return;
+
+		logger.debug('close()');
+
+		this.#closed = true;
+
+		for (const shard of this.#shards)
+		{
+			shard.router.close();
+		}
+
+		this.#transportShards.clear();
+		this.#producerShards.clear();
+		this.#producerPipes.clear();
+	}
+
+	/**
+	 * Create a WebRtcTransport in the least loaded shard. A webRtcServer can
+	 * not be given since it belongs to a single Worker.
+	 */
+	async createWebRtcTransport(options: WebRtcTransportOptions): Promise<WebRtcTransport>
+	{
+		logger.debug('createWebRtcTransport()');
+
+		if (options.webRtcServer)
+			throw new TypeError('webRtcServer cannot be used in a ShardedRouter');
+
+		const shard = this.getLeastLoadedShard();
+		const transport = await shard.router.createWebRtcTransport(options);
+
+		this.addTransport(transport, shard);
+
+		return transport;
+	}
+
+	/**
+	 * Create a PlainTransport in the least loaded shard.
+	 */
+	async createPlainTransport(options: PlainTransportOptions): Promise<PlainTransport>
+	{
+		logger.debug('createPlainTransport()');
+
+		const shard = this.getLeastLoadedShard();
+		const transport = await shard.router.createPlainTransport(options);
+
+		this.addTransport(transport, shard);
+
+		return transport;
+	}
+
+	/**
+	 * Create a Consumer in the given Transport (created by this), piping the
+	 * Producer into its shard first if needed.
+	 */
+	async consume(transport: Transport, options: ConsumerOptions): Promise<Consumer>
+	{
+		logger.debug('consume()');
+
+		const shard = this.#transportShards.get(transport.id);
+
+		if (!shard)
+			throw new TypeError('Transport not found');
+
+		await this.pipeProducerToShard(options.producerId, shard);
+
+		const consumer = await transport.consume(options);
+
+		shard.consumerCount++;
+		consumer.observer.once('close', () => shard.consumerCount--);
+
+		return consumer;
+	}
+
+	/**
+	 * Check whether the given RTP capabilities can consume the given Producer.
+	 */
+	canConsume(
+		{
+			producerId,
+			rtpCapabilities
+		}:
+		{
+			producerId: string;
+			rtpCapabilities: RtpCapabilities;
+		}
+	): boolean
+	{
+		const shard = this.#producerShards.get(producerId);
+
+		if (!shard)
+		{
+			logger.error(
+				'canConsume() | Producer with id "%s" not found', producerId);
+
+			return false;
+		}
+
+		return shard.router.canConsume({ producerId, rtpCapabilities });
+	}
+
+	private getLeastLoadedShard(): Shard
+	{
+		if (this.#closed)
+			throw new Error('ShardedRouter closed');
+
+		return this.#shards.reduce((leastLoaded, shard) => (
+			shard.consumerCount < leastLoaded.consumerCount ? shard : leastLoaded
+		));
+	}
+
+	private addTransport(transport: Transport, shard: Shard): void
+	{
+		this.#transportShards.set(transport.id, shard);
+
+		transport.observer.once('close', () =>
+		{
+			this.#transportShards.delete(transport.id);
+		});
+
+		transport.observer.on('newproducer', (producer: Producer) =>
+		{
+			this.#producerShards.set(producer.id, shard);
+
+			// Producers piped into other shards are closed along with it.
+			producer.observer.once('close', () =>
+			{
+				this.#producerShards.delete(producer.id);
+				this.#producerPipes.delete(producer.id);
+			});
+		});
+	}
+
+	private async pipeProducerToShard(producerId: string, shard: Shard): Promise<void>
+	{
+		const producerShard = this.#producerShards.get(producerId);
+
+		if (!producerShard)
+			throw new TypeError('Producer not found');
+		else if (producerShard === shard)
+			return;
+
+		let pipes = this.#producerPipes.get(producerId);
+
+		if (!pipes)
+		{
+			pipes = new Map();
+			this.#producerPipes.set(producerId, pipes);
+		}
+
+		let pipePromise = pipes.get(shard);
+
+		if (!pipePromise)
+		{
+			pipePromise = producerShard.router.pipeToRouter(
+				{
+					...this.#pipeOptions,
+					producerId,
+					router : shard.router
+				})
+				.then(() => undefined);
+
+			pipes.set(shard, pipePromise);
+
+			// Allow retrying it.
+			pipePromise.catch(() => pipes!.delete(shard));
+		}
+
+		await pipePromise;
+	}
+}
@@ -5,8 +5,8 @@ import * as utils from './utils';
 import * as ortc from './ortc';
 import { Channel } from './Channel';
 import { PayloadChannel } from './PayloadChannel';
-import { Producer, ProducerOptions } from './Producer';
-import { Consumer, ConsumerOptions } from './Consumer';
+import { Producer, ProducerOptions, StatsDelta, TraceEventOptions } from './Producer';
+import { Consumer, ConsumerLayers, ConsumerOptions } from './Consumer';
 import {
 	DataProducer,
 	DataProducerOptions,
@@ -17,8 +17,9 @@ import {
 	DataConsumerOptions,
 	DataConsumerType
 } from './DataConsumer';
-import { RtpCapabilities } from './RtpParameters';
+import { RtpCapabilities, RtpParameters } from './RtpParameters';
 import { SctpParameters, SctpStreamParameters } from './SctpParameters';
+import { WorkerMetricsHistogram } from './Worker';
 
 export interface TransportListenIp
 {
@@ -59,9 +60,10 @@ export type TransportTraceEventType = 'probation' | 'bwe';
 export interface TransportTraceEventData
 {
 	/**
-	 * Trace type.
+	 * Trace type ('summary' events are given in 'summary' mode and their info
+	 * holds the number of events of each type).
 	 */
-	type: TransportTraceEventType;
+	type: TransportTraceEventType | 'summary';
 
 	/**
 	 * Event timestamp.
@@ -79,11 +81,162 @@ export interface TransportTraceEventData
 	info: any;
 }
 
+/**
+ * Time (in ns) RTP packets spend in the worker since they are read from the
+ * socket until they are handed to the sending socket, given in stats when the
+ * forwardingLatency worker setting is enabled. Retransmissions are not
+ * included.
+ */
+export type TransportForwardingLatency =
+{
+	/**
+	 * Until the packet reaches the sending transport.
+	 */
+	routing: Omit<WorkerMetricsHistogram, 'buckets'>;
+
+	/**
+	 * Time queued in the pacer.
+	 */
+	pacing: Omit<WorkerMetricsHistogram, 'buckets'>;
+
+	/**
+	 * Until the packet is handed to the socket (SRTP included).
+	 */
+	send: Omit<WorkerMetricsHistogram, 'buckets'>;
+
+	total: Omit<WorkerMetricsHistogram, 'buckets'>;
+};
+
+/**
+ * Stats of the UDP socket of a transport.
+ */
+export type TransportUdpSocketStat =
+{
+	recvBytes: number;
+	sentBytes: number;
+
+	/**
+	 * Size of the kernel buffers (Linux reports twice the requested ones).
+	 */
+	recvBufferSize?: number;
+	sendBufferSize?: number;
+
+	/**
+	 * Datagrams dropped by the kernel because the receive buffer was full
+	 * (Linux >= 4.6 only).
+	 */
+	recvDrops?: number;
+};
+
+/**
+ * Stats of the TCP connection of a transport.
+ */
+export type TransportTcpConnectionStat =
+{
+	recvBytes: number;
+	sentBytes: number;
+
+	/**
+	 * Bytes waiting to be written into the kernel.
+	 */
+	writeQueueSize: number;
+
+	/**
+	 * RTP packets dropped because they waited too long to be written.
+	 */
+	droppedMediaPackets: number;
+	droppedMediaBytes: number;
+};
+
+/**
+ * Limits of the packets received by a WebRtcTransport or PlainTransport,
+ * applied before parsing or decrypting them. Packets over them are dropped.
+ */
+export type TransportIngressPolicer =
+{
+	/**
+	 * Max bitrate (in bps) received by the transport. 0 means unlimited.
+	 */
+	bitrate?: number;
+
+	/**
+	 * Max bitrate (in bps) received from each remote tuple. 0 means unlimited.
+	 */
+	tupleBitrate?: number;
+
+	/**
+	 * Duration (in ms) of the bursts allowed over the bitrates. Default 500.
+	 */
+	burstMs?: number;
+};
+
+/**
+ * Packets (and bytes) received by a transport and dropped before parsing
+ * them.
+ */
+export type TransportIngressDrops =
+{
+	/**
+	 * Over ingressPolicer.bitrate.
+	 */
+	transportBitrate: { packets: number; bytes: number };
+
+	/**
+	 * Over ingressPolicer.tupleBitrate.
+	 */
+	tupleBitrate: { packets: number; bytes: number };
+
+	/**
+	 * Coming from a tuple not validated by ICE (or other than the connected
+	 * one in a PlainTransport).
+	 */
+	unknownTuple: { packets: number; bytes: number };
+
+	/**
+	 * STUN packets over the rate allowed from a tuple not validated by ICE.
+	 */
+	stunRate: { packets: number; bytes: number };
+};
+
+/**
+ * Options of transport.enablePacketCapture().
+ */
+export type TransportPacketCaptureOptions =
+{
+	/**
+	 * Number of packets kept (the oldest ones are overwritten). Default 4096.
+	 */
+	maxPackets?: number;
+
+	/**
+	 * Whether just the first 256 bytes of every packet (RTP header and
+	 * extensions) are kept. Default false.
+	 */
+	headersOnly?: boolean;
+};
+
+/**
+ * Result of transport.dumpPacketCapture().
+ */
+export type TransportPacketCaptureDump =
+{
+	/**
+	 * Number of packets in the capture.
+	 */
+	packetCount: number;
+
+	/**
+	 * Capture in pcap format (unless written into a file).
+	 */
+	pcap?: Buffer;
+};
+
 export type SctpState = 'new' | 'connecting' | 'connected' | 'failed' | 'closed';
 
 export type TransportEvents = 
 { 
 	routerclose: []; 
+	listenserverclose: [];
 	trace: [TransportTraceEventData];
 }
 
@@ -99,6 +252,16 @@ export type TransportObserverEvents =
 
 const logger = new Logger('Transport');
 
+/**
+ * Error of an item in the response to a batch request.
+ */
+function batchResponseToError(response: any): Error
+{
+	return response.error === 'TypeError'
+		? new TypeError(response.reason)
+		: new Error(response.reason);
+}
+
 export class Transport<Events extends TransportEvents = TransportEvents,
 	ObserverEvents extends TransportObserverEvents = TransportObserverEvents>
 	extends EnhancedEventEmitter<Events>
@@ -107,7 +270,9 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 	protected readonly internal:
 	{
 		routerId: string;
+		routerHandle?: number;
 		transportId: string;
+		transportHandle?: number;
 	};
 
 	// Transport data. This is set by the subclass.
@@ -126,6 +291,10 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 	// Close flag.
 	#closed = false;
 
+	// Whether it's being closed by Router.closeTransports() (so close() must
+	// not send its own request).
+	#closedInBulk = false;
+
 	// Custom app data.
 	readonly #appData: Record<string, unknown>;
 
@@ -169,7 +338,9 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 	 * @private
 	 * @interface
 	 * @emits routerclose
+	 * @emits listenserverclose
 	 * @emits @close
+	 * @emits @listenserverclose
 	 * @emits @newproducer - (producer: Producer)
 	 * @emits @producerclose - (producer: Producer)
 	 * @emits @newdataproducer - (dataProducer: DataProducer)
@@ -283,8 +454,11 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 		this.channel.removeAllListeners(this.internal.transportId);
 		this.payloadChannel.removeAllListeners(this.internal.transportId);
 
-		this.channel.request('transport.close', this.internal)
-			.catch(() => {});
+		if (!this.#closedInBulk)
+		{
+			this.channel.request('transport.close', this.internal)
+				.catch(() => {});
+		}
 
 		// Close every Producer.
 		for (const producer of this.#producers.values())
@@ -326,6 +500,18 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 		this.#observer.safeEmit('close');
 	}
 
+	/**
+	 * Closed along with other Transports by Router.closeTransports().
+	 *
+	 * @private
+	 */
+	closeInBulk(): void
+	{
+		this.#closedInBulk = true;
+
+		this.close();
+	}
+
 	/**
 	 * Router was closed.
 	 *
@@ -385,6 +571,71 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 		this.#observer.safeEmit('close');
 	}
 
+	/**
+	 * Listen server was closed (this just happens in WebRtcTransports when their
+	 * associated WebRtcServer is closed).
+	 *
+	 * @private
+	 * @virtual
+	 */
+	listenServerClosed(): void
+	{
+		if (this.#closed)
+			return;
+
+		logger.debug('listenServerClosed()');
+
+		this.#closed = true;
+
+		// Remove notification subscriptions.
+		this.channel.removeAllListeners(this.internal.transportId);
+		this.payloadChannel.removeAllListeners(this.internal.transportId);
+
+		// Close every Producer.
+		for (const producer of this.#producers.values())
+		{
+			producer.transportClosed();
+
+			// Must tell the Router.
+			this.emit('@producerclose', producer);
+		}
+		this.#producers.clear();
+
+		// Close every Consumer.
+		for (const consumer of this.consumers.values())
+		{
+			consumer.transportClosed();
+		}
+		this.consumers.clear();
+
+		// Close every DataProducer.
+		for (const dataProducer of this.dataProducers.values())
+		{
+			dataProducer.transportClosed();
+
+			// Must tell the Router.
+			this.emit('@dataproducerclose', dataProducer);
+		}
+		this.dataProducers.clear();
+
+		// Close every DataConsumer.
+		for (const dataConsumer of this.dataConsumers.values())
+		{
+			dataConsumer.transportClosed();
+		}
+		this.dataConsumers.clear();
+
+		// Need to emit this event to let the parent Router know since
+		// transport.listenServerClosed() is called by the listen server.
+		// NOTE: Currently there is just WebRtcServer for WebRtcTransports.
+		this.emit('@listenserverclose');
+
+		this.safeEmit('listenserverclose');
+
+		// Emit observer event.
+		this.#observer.safeEmit('close');
+	}
+
 	/**
 	 * Dump Transport.
 	 */
@@ -406,6 +657,17 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 		throw new Error('method not implemented in the subclass');
 	}
 
+	/**
+	 * Get Transport stats changed since the call that returned the given cursor
+	 * (full stats if 0 or if it is not the last returned cursor).
+	 */
+	async getStatsDelta(cursor = 0): Promise<StatsDelta<any>>
+	{
+		logger.debug('getStatsDelta()');
+
+		return this.channel.request('transport.getStats', this.internal, { cursor });
+	}
+
 	/**
 	 * Provide the Transport remote parameters.
 	 *
@@ -444,6 +706,23 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 			'transport.setMaxOutgoingBitrate', this.internal, reqData);
 	}
 
+	/**
+	 * Start the outgoing bandwidth estimation from the given bitrate (f.e. the
+	 * availableOutgoingBitrate of a previous transport of the same client)
+	 * instead of initialAvailableOutgoingBitrate or the last estimate of the
+	 * remote endpoint kept by the worker. It has no effect once the estimation
+	 * started.
+	 */
+	async setBweHint(bitrate: number): Promise<void>
+	{
+		logger.debug('setBweHint() [bitrate:%s]', bitrate);
+
+		const reqData = { bitrate };
+
+		await this.channel.request(
+			'transport.setBweHint', this.internal, reqData);
+	}
+
 	/**
 	 * Create a Producer.
 	 */
@@ -454,6 +733,8 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 			rtpParameters,
 			paused = false,
 			keyFrameRequestDelay,
+			enableKeyFrameCache = false,
+			relayPath = [],
 			appData
 		}: ProducerOptions
 	): Promise<Producer>
@@ -513,7 +794,16 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 			kind, rtpParameters, routerRtpCapabilities, rtpMapping);
 
 		const internal = { ...this.internal, producerId: id || uuidv4() };
-		const reqData = { kind, rtpParameters, rtpMapping, keyFrameRequestDelay, paused };
+		const reqData =
+		{
+			kind,
+			rtpParameters,
+			rtpMapping,
+			keyFrameRequestDelay,
+			enableKeyFrameCache,
+			paused,
+			relayPath
+		};
 
 		const status =
 			await this.channel.request('transport.produce', internal, reqData);
@@ -523,12 +813,13 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 			kind,
 			rtpParameters,
 			type : status.type,
-			consumableRtpParameters
+			consumableRtpParameters,
+			relayPath
 		};
 
 		const producer = new Producer(
 			{
-				internal,
+				internal : { ...internal, producerHandle: status.handle },
 				data,
 				channel        : this.channel,
 				payloadChannel : this.payloadChannel,
@@ -556,103 +847,181 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 	 *
 	 * @virtual
 	 */
-	async consume(
-		{
-			producerId,
-			rtpCapabilities,
-			paused = false,
-			mid,
-			preferredLayers,
-			pipe = false,
-			appData
-		}: ConsumerOptions
-	): Promise<Consumer>
+	async consume(options: ConsumerOptions): Promise<Consumer>
 	{
 		logger.debug('consume()');
 
-		if (!producerId || typeof producerId !== 'string')
-			throw new TypeError('missing producerId');
-		else if (appData && typeof appData !== 'object')
-			throw new TypeError('if given, appData must be an object');
-		else if (mid && (typeof mid !== 'string' || mid.length === 0))
-			throw new TypeError('if given, mid must be non empty string');
-
 		// This may throw.
-		ortc.validateRtpCapabilities(rtpCapabilities!);
+		const { internal, reqData, data, appData, newTemplateKey } =
+			this.prepareConsume(options);
 
-		const producer = this.getProducerById(producerId);
+		const status =
+			await this.channel.request('transport.consume', internal, reqData);
 
-		if (!producer)
-			throw Error(`Producer with id "${producerId}" not found`);
+		return this.createConsumer(internal, data, appData, status, newTemplateKey);
+	}
 
-		// This may throw.
-		const rtpParameters = ortc.getConsumerRtpParameters(
-			producer.consumableRtpParameters, rtpCapabilities!, pipe);
+	/**
+	 * Create many Consumers with a single request to the worker. Returns, in the
+	 * same order as the given options, each created Consumer or the Error that
+	 * prevented its creation.
+	 *
+	 * @virtual
+	 */
+	async consumeMany(optionsList: ConsumerOptions[]): Promise<(Consumer | Error)[]>
+	{
+		logger.debug('consumeMany()');
 
-		// Set MID.
-		if (!pipe)
+		if (!Array.isArray(optionsList))
+			throw new TypeError('optionsList must be an array');
+
+		const results: (Consumer | Error)[] = new Array(optionsList.length);
+		const prepared:
 		{
-			if (mid)
+			idx: number;
+			internal: any;
+			reqData: any;
+			data: any;
+			appData?: Record<string, unknown>;
+			newTemplateKey?: string;
+		}[] = [];
+
+		for (let idx = 0; idx < optionsList.length; ++idx)
+		{
+			try
 			{
-				rtpParameters.mid = mid;
+				prepared.push({ idx, ...this.prepareConsume(optionsList[idx]) });
 			}
-			else
+			catch (error)
 			{
-				rtpParameters.mid = `${this.#nextMidForConsumers++}`;
-
-				// We use up to 8 bytes for MID (string).
-				if (this.#nextMidForConsumers === 100000000)
-				{
-					logger.error(
-						`consume() | reaching max MID value "${this.#nextMidForConsumers}"`);
-	
-					this.#nextMidForConsumers = 0;
-				}
+				results[idx] = error as Error;
 			}
 		}
 
-		const internal = { ...this.internal, consumerId: uuidv4(), producerId };
-		const reqData =
+		if (prepared.length === 0)
+			return results;
+
+		const items = prepared.map(({ internal, reqData }) =>
 		{
-			kind                   : producer.kind,
-			rtpParameters,
-			type                   : pipe ? 'pipe' : producer.type,
-			consumableRtpEncodings : producer.consumableRtpParameters.encodings,
-			paused,
-			preferredLayers
-		};
+			return {
+				internal : { consumerId: internal.consumerId, producerId: internal.producerId },
+				data     : reqData
+			};
+		});
 
-		const status =
-			await this.channel.request('transport.consume', internal, reqData);
+		const { results: responses } = await this.channel.request(
+			'transport.consumeMany', this.internal, { items });
 
-		const data =
+		for (let i = 0; i < prepared.length; ++i)
 		{
-			kind : producer.kind,
-			rtpParameters,
-			type : pipe ? 'pipe' : producer.type
-		};
+			const { idx, internal, data, appData, newTemplateKey } = prepared[i];
+			const response = responses[i];
 
-		const consumer = new Consumer(
+			if (response.accepted)
 			{
-				internal,
-				data,
-				channel         : this.channel,
-				payloadChannel  : this.payloadChannel,
-				appData,
-				paused          : status.paused,
-				producerPaused  : status.producerPaused,
-				score           : status.score,
-				preferredLayers : status.preferredLayers
-			});
+				results[idx] =
+					this.createConsumer(internal, data, appData, response.data, newTemplateKey);
+			}
+			else
+				results[idx] = batchResponseToError(response);
+		}
 
-		this.consumers.set(consumer.id, consumer);
-		consumer.on('@close', () => this.consumers.delete(consumer.id));
-		consumer.on('@producerclose', () => this.consumers.delete(consumer.id));
+		return results;
+	}
 
-		// Emit observer event.
-		this.#observer.safeEmit('newconsumer', consumer);
+	/**
+	 * Pause many Consumers of this Transport with a single request to the
+	 * worker. Returns, in the same order, undefined or the Error of each one.
+	 */
+	async pauseConsumers(consumers: Consumer[]): Promise<(Error | undefined)[]>
+	{
+		logger.debug('pauseConsumers()');
 
-		return consumer;
+		const items = consumers.map((consumer) =>
+		{
+			return { internal: { consumerId: consumer.id } };
+		});
+
+		const { results: responses } = await this.channel.request(
+			'transport.pauseConsumers', this.internal, { items });
+
+		return consumers.map((consumer, idx) =>
+		{
+			const response = responses[idx];
+
+			if (!response.accepted)
+				return batchResponseToError(response);
+
+			consumer.pausedByTransport(true);
+
+			return undefined;
+		});
+	}
+
+	/**
+	 * Resume many Consumers of this Transport with a single request to the
+	 * worker. Returns, in the same order, undefined or the Error of each one.
+	 */
+	async resumeConsumers(consumers: Consumer[]): Promise<(Error | undefined)[]>
+	{
+		logger.debug('resumeConsumers()');
+
+		const items = consumers.map((consumer) =>
+		{
+			return { internal: { consumerId: consumer.id } };
+		});
+
+		const { results: responses } = await this.channel.request(
+			'transport.resumeConsumers', this.internal, { items });
+
+		return consumers.map((consumer, idx) =>
+		{
+			const response = responses[idx];
+
+			if (!response.accepted)
+				return batchResponseToError(response);
+
+			consumer.pausedByTransport(false);
+
+			return undefined;
+		});
+	}
+
+	/**
+	 * Set preferred video layers of many Consumers of this Transport with a
+	 * single request to the worker. Returns, in the same order, undefined or
+	 * the Error of each one.
+	 */
+	async setConsumersPreferredLayers(
+		entries: { consumer: Consumer; preferredLayers: ConsumerLayers }[]
+	): Promise<(Error | undefined)[]>
+	{
+		logger.debug('setConsumersPreferredLayers()');
+
+		const items = entries.map(({ consumer, preferredLayers }) =>
+		{
+			const { spatialLayer, temporalLayer } = preferredLayers;
+
+			return {
+				internal : { consumerId: consumer.id },
+				data     : { spatialLayer, temporalLayer }
+			};
+		});
+
+		const { results: responses } = await this.channel.request(
+			'transport.setConsumersPreferredLayers', this.internal, { items });
+
+		return entries.map(({ consumer }, idx) =>
+		{
+			const response = responses[idx];
+
+			if (!response.accepted)
+				return batchResponseToError(response);
+
+			consumer.preferredLayersSetByTransport(response.data);
+
+			return undefined;
+		});
 	}
 
 	/**
@@ -742,6 +1111,7 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 			ordered,
 			maxPacketLifeTime,
 			maxRetransmits,
+			sendQueue,
 			appData
 		}: DataConsumerOptions
 	): Promise<DataConsumer>
@@ -752,6 +1122,8 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 			throw new TypeError('missing dataProducerId');
 		else if (appData && typeof appData !== 'object')
 			throw new TypeError('if given, appData must be an object');
+		else if (sendQueue && typeof sendQueue.maxMessages !== 'number')
+			throw new TypeError('if given, sendQueue.maxMessages must be a number');
 
 		const dataProducer = this.getDataProducerById(dataProducerId);
 
@@ -794,11 +1166,12 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 			if (
 				ordered !== undefined ||
 				maxPacketLifeTime !== undefined ||
-				maxRetransmits !== undefined
+				maxRetransmits !== undefined ||
+				sendQueue !== undefined
 			)
 			{
 				logger.warn(
-					'consumeData() | ordered, maxPacketLifeTime and maxRetransmits are ignored when consuming data on a DirectTransport');
+					'consumeData() | ordered, maxPacketLifeTime, maxRetransmits and sendQueue are ignored when consuming data on a DirectTransport');
 			}
 		}
 
@@ -810,7 +1183,10 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 			type,
 			sctpStreamParameters,
 			label,
-			protocol
+			protocol,
+			maxQueuedMessages : type === 'sctp' ? sendQueue?.maxMessages : undefined,
+			queueDropPolicy   : type === 'sctp' ? sendQueue?.dropPolicy : undefined,
+			coalesceKeyLength : type === 'sctp' ? sendQueue?.coalesceKeyLength : undefined
 		};
 
 		const data =
@@ -850,16 +1226,263 @@ export class Transport<Events extends TransportEvents = TransportEvents,
 	/**
 	 * Enable 'trace' event.
 	 */
-	async enableTraceEvent(types: TransportTraceEventType[] = []): Promise<void>
+	async enableTraceEvent(
+		types: TransportTraceEventType[] = [],
+		options: TraceEventOptions = {}
+	): Promise<void>
 	{
 		logger.debug('pause()');
 
-		const reqData = { types };
+		const reqData = { types, ...options };
 
 		await this.channel.request(
 			'transport.enableTraceEvent', this.internal, reqData);
 	}
 
+	/**
+	 * Capture the RTP and RTCP packets received (once decrypted) and sent
+	 * (before being encrypted) by the transport. Packets captured so far are
+	 * discarded.
+	 */
+	async enablePacketCapture(
+		{
+			maxPackets,
+			headersOnly = false
+		}: TransportPacketCaptureOptions = {}
+	): Promise<void>
+	{
+		logger.debug('enablePacketCapture()');
+
+		const reqData = { maxPackets, headersOnly };
+
+		await this.channel.request(
+			'transport.enablePacketCapture', this.internal, reqData);
+	}
+
+	/**
+	 * Stop capturing packets and discard the captured ones.
+	 */
+	async disablePacketCapture(): Promise<void>
+	{
+		logger.debug('disablePacketCapture()');
+
+		await this.channel.request('transport.disablePacketCapture', this.internal);
+	}
+
+	/**
+	 * Get the captured packets in pcap format or, if a path is given, write
+	 * them into that file (in the worker host).
+	 */
+	async dumpPacketCapture(path?: string): Promise<TransportPacketCaptureDump>
+	{
+		logger.debug('dumpPacketCapture()');
+
+		const reqData = { path };
+
+		const data =
+			await this.channel.request('transport.dumpPacketCapture', this.internal, reqData);
+
+		return {
+			packetCount : data.packetCount,
+			pcap        : data.pcap ? Buffer.from(data.pcap, 'base64') : undefined
+		};
+	}
+
+	/**
+	 * Validate the options of a Consumer and compute its RTP parameters and the
+	 * data of the request to the worker.
+	 */
+	private prepareConsume(
+		{
+			producerId,
+			rtpCapabilities,
+			paused = false,
+			mid,
+			preferredLayers,
+			ignoreDtx = false,
+			thumbnailFramerate,
+			pipe = false,
+			sendState,
+			rtpParametersKey,
+			appData
+		}: ConsumerOptions
+	)
+	{
+		if (!producerId || typeof producerId !== 'string')
+			throw new TypeError('missing producerId');
+		else if (appData && typeof appData !== 'object')
+			throw new TypeError('if given, appData must be an object');
+		else if (mid && (typeof mid !== 'string' || mid.length === 0))
+			throw new TypeError('if given, mid must be non empty string');
+		else if (sendState && (typeof sendState !== 'object' || pipe))
+			throw new TypeError('if given, sendState must be an object and pipe must be false');
+		else if (
+			rtpParametersKey !== undefined &&
+			(typeof rtpParametersKey !== 'string' || rtpParametersKey.length === 0)
+		)
+		{
+			throw new TypeError('if given, rtpParametersKey must be non empty string');
+		}
+
+		// This may throw.
+		ortc.validateRtpCapabilities(rtpCapabilities!);
+
+		const producer = this.getProducerById(producerId);
+
+		if (!producer)
+			throw Error(`Producer with id "${producerId}" not found`);
+
+		// Pipe Consumers get other RTP parameters.
+		const templateKey = rtpParametersKey !== undefined
+			? `${pipe ? 'pipe:' : ''}${rtpParametersKey}`
+			: undefined;
+		const rtpParametersTemplate = templateKey !== undefined
+			? producer.consumerRtpParametersTemplates.get(templateKey)
+			: undefined;
+
+		// This may throw.
+		const rtpParameters = rtpParametersTemplate
+			? ortc.cloneConsumerRtpParameters(rtpParametersTemplate, pipe)
+			: ortc.getConsumerRtpParameters(
+				producer.consumableRtpParameters, rtpCapabilities!, pipe);
+
+		// A migrated Consumer keeps its MID.
+		if (!mid && sendState)
+			mid = sendState.rtpParameters.mid;
+
+		// Set MID.
+		if (!pipe)
+		{
+			if (mid)
+			{
+				rtpParameters.mid = mid;
+			}
+			else
+			{
+				rtpParameters.mid = `${this.#nextMidForConsumers++}`;
+
+				// We use up to 8 bytes for MID (string).
+				if (this.#nextMidForConsumers === 100000000)
+				{
+					logger.error(
+						`consume() | reaching max MID value "${this.#nextMidForConsumers}"`);
+	
+					this.#nextMidForConsumers = 0;
+				}
+			}
+		}
+
+		let workerSendState;
+
+		// Continue the stream of a migrated Consumer, so reuse its SSRCs.
+		if (sendState)
+		{
+			const { rtpParameters: sentRtpParameters, ...rest } = sendState;
+			const sentEncoding = sentRtpParameters.encodings![0];
+
+			rtpParameters.encodings![0].ssrc = sentEncoding.ssrc;
+
+			if (rtpParameters.encodings![0].rtx && sentEncoding.rtx)
+				rtpParameters.encodings![0].rtx = { ...sentEncoding.rtx };
+
+			const { spatialLayer, temporalLayer } = sendState;
+
+			// Keep the layers being sent.
+			if (!preferredLayers && typeof spatialLayer === 'number' && spatialLayer >= 0)
+			{
+				preferredLayers =
+				{
+					spatialLayer,
+					temporalLayer :
+						typeof temporalLayer === 'number' && temporalLayer >= 0
+							? temporalLayer
+							: undefined
+				};
+			}
+
+			workerSendState = rest;
+		}
+
+		const internal = { ...this.internal, consumerId: uuidv4(), producerId };
+		const reqData: any =
+		{
+			kind             : producer.kind,
+			rtpParametersKey : templateKey,
+			type             : pipe ? 'pipe' : producer.type,
+			paused,
+			preferredLayers,
+			ignoreDtx,
+			thumbnailFramerate,
+			sendState        : workerSendState
+		};
+
+		// The worker already has the rest of the RTP parameters.
+		if (rtpParametersTemplate)
+		{
+			reqData.mid = rtpParameters.mid;
+			reqData.encodings = rtpParameters.encodings!.map(({ ssrc, rtx }) => ({ ssrc, rtx }));
+		}
+		else
+		{
+			reqData.rtpParameters = rtpParameters;
+			reqData.consumableRtpEncodings = producer.consumableRtpParameters.encodings;
+		}
+
+		const data =
+		{
+			kind : producer.kind,
+			rtpParameters,
+			type : pipe ? 'pipe' : producer.type
+		};
+
+		// Keep the RTP parameters once the worker does.
+		const newTemplateKey = !rtpParametersTemplate ? templateKey : undefined;
+
+		return { internal, reqData, data, appData, newTemplateKey };
+	}
+
+	/**
+	 * Create a Consumer once the worker has accepted it.
+	 */
+	private createConsumer(
+		internal: any,
+		data: any,
+		appData: Record<string, unknown> | undefined,
+		status: any,
+		newTemplateKey?: string
+	): Consumer
+	{
+		if (newTemplateKey !== undefined)
+		{
+			const producer = this.getProducerById(internal.producerId);
+
+			producer?.consumerRtpParametersTemplates.set(
+				newTemplateKey, utils.clone(data.rtpParameters) as RtpParameters);
+		}
+
+		const consumer = new Consumer(
+			{
+				internal : { ...internal, consumerHandle: status.handle },
+				data,
+				channel         : this.channel,
+				payloadChannel  : this.payloadChannel,
+				appData,
+				paused          : status.paused,
+				producerPaused  : status.producerPaused,
+				score           : status.score,
+				preferredLayers : status.preferredLayers
+			});
+
+		this.consumers.set(consumer.id, consumer);
+		consumer.on('@close', () => this.consumers.delete(consumer.id));
+		consumer.on('@producerclose', () => this.consumers.delete(consumer.id));
+
+		// Emit observer event.
+		this.#observer.safeEmit('newconsumer', consumer);
+
+		return consumer;
+	}
+
 	private getNextSctpStreamId(): number
 	{
 		if (
@@ -7,17 +7,28 @@ import {
 	TransportTraceEventData,
 	TransportEvents,
 	TransportObserverEvents,
-	SctpState
+	SctpState,
+	TransportForwardingLatency,
+	TransportIngressPolicer,
+	TransportIngressDrops,
+	TransportUdpSocketStat,
+	TransportTcpConnectionStat
 } from './Transport';
+import { WebRtcServer } from './WebRtcServer';
 import { SctpParameters, NumSctpStreams } from './SctpParameters';
 
 export type WebRtcTransportOptions =
 {
+	/**
+	 * Instance of WebRtcServer. Mandatory unless listenIps is given.
+	 */
+	webRtcServer?: WebRtcServer;
+
 	/**
 	 * Listening IP address or addresses in order of preference (first one is the
-	 * preferred one).
+	 * preferred one). Mandatory unless webRtcServer is given.
 	 */
-	listenIps: (TransportListenIp | string)[];
+	listenIps?: (TransportListenIp | string)[];
 
 	/**
 	 * Fixed port to listen on instead of selecting automatically from Worker's port
@@ -72,6 +83,20 @@ export type WebRtcTransportOptions =
 	 */
 	sctpSendBufferSize?: number;
 
+	/**
+	 * Share (between 0 and 1) of the estimated outgoing bitrate for SCTP
+	 * packets. If given, they are paced along with the media (once there is
+	 * bandwidth estimation), so large DataChannel transfers do not cause
+	 * queueing delay to the media. Default 0 (not paced).
+	 */
+	sctpBitrateShare?: number;
+
+	/**
+	 * Limits of the received packets, applied before parsing them. STUN packets
+	 * from tuples not validated by ICE are always rate limited.
+	 */
+	ingressPolicer?: TransportIngressPolicer;
+
 	/**
 	 * Custom application data.
 	 */
@@ -144,11 +169,42 @@ export type WebRtcTransportStat =
 	availableOutgoingBitrate?: number;
 	availableIncomingBitrate?: number;
 	maxIncomingBitrate?: number;
+	ecnCePacketsReceived?: number;
+	ecnCePacketsSent?: number;
+	forwardingLatency?: TransportForwardingLatency;
+	cpuMsPerSecond: number;
 	// WebRtcTransport specific.
 	iceRole: string;
 	iceState: IceState;
 	iceSelectedTuple?: TransportTuple;
+	iceTupleCount: number;
 	dtlsState: DtlsState;
+	udpSocket?: TransportUdpSocketStat;
+	tcpConnection?: TransportTcpConnectionStat;
+	ingressDrops: TransportIngressDrops;
+	joinLatency?: WebRtcTransportJoinLatency;
+}
+
+/**
+ * Duration (ms) of the phases done so far until the WebRtcTransport got
+ * connected.
+ */
+export type WebRtcTransportJoinLatency =
+{
+	/**
+	 * Since the transport creation until the first ICE Binding request.
+	 */
+	iceBindingMs: number;
+
+	/**
+	 * Since the first ICE Binding request until ICE connected.
+	 */
+	iceConnectMs?: number;
+
+	/**
+	 * Since ICE connected until DTLS connected.
+	 */
+	dtlsConnectMs?: number;
 }
 
 export type WebRtcTransportEvents = TransportEvents &
@@ -358,6 +414,27 @@ export class WebRtcTransport extends
 		super.routerClosed();
 	}
 
+	/**
+	 * Called when closing the associated WebRtcServer.
+	 *
+	 * @private
+	 * @override
+	 */
+	listenServerClosed(): void
+	{
+		if (this.closed)
+			return;
+
+		this.#data.iceState = 'closed';
+		this.#data.iceSelectedTuple = undefined;
+		this.#data.dtlsState = 'closed';
+
+		if (this.#data.sctpState)
+			this.#data.sctpState = 'closed';
+
+		super.listenServerClosed();
+	}
+
 	/**
 	 * Get WebRtcTransport stats.
 	 *
@@ -8,6 +8,7 @@ import * as ortc from './ortc';
 import { Channel } from './Channel';
 import { PayloadChannel } from './PayloadChannel';
 import { Router, RouterOptions } from './Router';
+import { WebRtcServer, WebRtcServerOptions } from './WebRtcServer';
 
 export type WorkerLogLevel = 'debug' | 'warn' | 'error' | 'none';
 
@@ -26,6 +27,10 @@ export type WorkerLogTag =
   | 'sctp'
   | 'message'
 
+export type WorkerChannelMessageFormat = 'json' | 'msgpack';
+
+export type WorkerPacketIo = 'libuv' | 'io_uring' | 'io_uring_sqpoll';
+
 export type WorkerSettings =
 {
 	/**
@@ -63,13 +68,308 @@ export type WorkerSettings =
 	 */
 	dtlsPrivateKeyFile?: string;
 
+	/**
+	 * Path to a directory in which the dynamically created DTLS certificate is
+	 * cached, so workers in the host reuse it instead of creating their own
+	 * (which speeds up their startup). It's rotated before it expires. Ignored
+	 * if dtlsCertificateFile and dtlsPrivateKeyFile are given.
+	 */
+	dtlsCertificateCacheDir?: string;
+
+	/**
+	 * Format of the messages exchanged with the media worker subprocess over
+	 * the Channel and the PayloadChannel. Valid values are 'json' and 'msgpack'
+	 * (MessagePack, more compact and faster to parse). Default 'json'.
+	 */
+	channelMessageFormat?: WorkerChannelMessageFormat;
+
+	/**
+	 * Index of the CPU core the media worker subprocess is pinned to (Linux
+	 * only). Useful to spread workers across cores. If unset, the worker is not
+	 * pinned.
+	 */
+	cpuAffinity?: number;
+
+	/**
+	 * Number of threads (up to 16) encrypting outgoing SRTP packets of
+	 * WebRtcTransports off the media worker main thread. Useful when a single
+	 * worker sends lots of media. Default 0 (encrypt in the main thread).
+	 */
+	srtpEncryptThreads?: number;
+
+	/**
+	 * Number of threads (up to 16) decrypting incoming SRTP and SRTCP packets
+	 * received over UDP by WebRtcTransports off the media worker main thread.
+	 * Useful when a single worker receives lots of media. Default 0 (decrypt in
+	 * the main thread).
+	 */
+	srtpDecryptThreads?: number;
+
+	/**
+	 * Number of threads (up to 16) running DTLS handshakes of WebRtcTransports
+	 * off the media worker main thread, so many peers joining at once do not
+	 * delay media forwarding. Default 0 (run them in the main thread).
+	 */
+	dtlsHandshakeThreads?: number;
+
+	/**
+	 * Let DTLS clients of WebRtcTransports resume their previous session (with
+	 * session tickets whose keys are owned by the worker and rotated every
+	 * hour) so reconnecting (i.e. after an ICE restart) takes an abbreviated
+	 * handshake. Full and resumed handshakes are counted in the worker dump.
+	 * Default false.
+	 */
+	dtlsSessionResumption?: boolean;
+
+	/**
+	 * Make DTLS just offer ECDHE-ECDSA cipher suites and X25519/P-256 key
+	 * exchange, which take less CPU per handshake. It requires a P-256 ECDSA
+	 * certificate if dtlsCertificateFile and dtlsPrivateKeyFile are given
+	 * (generated ones always are). The CPU time of full and resumed
+	 * handshakes is reported in the worker dump. Default false.
+	 */
+	dtlsEcdsaOnly?: boolean;
+
+	/**
+	 * Negotiate DTLS 1.3 with peers supporting it (falling back to DTLS 1.2),
+	 * which needs one round trip less to complete the handshake. It requires
+	 * the worker to be linked against an SSL library supporting DTLS 1.3,
+	 * otherwise DTLS 1.2 is used. The number of DTLS 1.3 handshakes is
+	 * reported in the worker dump. Default false.
+	 */
+	dtls13?: boolean;
+
+	/**
+	 * Maximum number of log lines per second the worker emits with each log
+	 * tag. Exceeding lines are dropped and their number is reported in a
+	 * warning. Default 0 (no limit).
+	 */
+	logRateLimit?: number;
+
+	/**
+	 * File into which the worker writes its log lines (appended) from a helper
+	 * thread instead of sending them to this process, so they are not emitted
+	 * as debug logs. Error lines are sent anyway.
+	 */
+	logFile?: string;
+
+	/**
+	 * File in which the worker writes, every second, the stats of its
+	 * transports and of the RTP streams of its producers and consumers as fixed
+	 * size binary records (see worker/include/StatsRegion.hpp), so they can be
+	 * sampled without requests to the worker. The file is removed when the
+	 * worker closes.
+	 */
+	statsFile?: string;
+
+	/**
+	 * Interval (in ms, up to 5000) in which the worker sends together, in a
+	 * single message, the 'score' and 'layerschange' events of producers and
+	 * consumers and the 'bwe' trace events of transports. Just the last event of
+	 * each type and entity is sent. Default 0 (events are sent immediately).
+	 */
+	notificationBatchInterval?: number;
+
+	/**
+	 * Measure the time RTP packets spend in the worker, given in the stats of
+	 * transports and consumers (forwardingLatency) and in the resource usage
+	 * (sendQueueDelay). Default false.
+	 */
+	forwardingLatency?: boolean;
+
+	/**
+	 * Shed load when the worker is overloaded (high event loop utilization or
+	 * lag): first retransmissions are not sent, then simulcast and SVC
+	 * consumers are limited to lower layers and finally video consumers with
+	 * priority 1 are paused. The worker emits 'overload' when the level changes.
+	 * Default false.
+	 */
+	overloadProtection?: boolean;
+
+	/**
+	 * Feed the REMB bandwidth estimator of transports with one of every N
+	 * received RTP packets (from 1 to 16), trading estimation accuracy for CPU.
+	 * Default 1 (all packets).
+	 */
+	rembSampling?: number;
+
+	/**
+	 * Maximum number of transports probing the bandwidth at the same time, so
+	 * many transports starting at once don't cause CPU spikes. Others wait
+	 * until one of them is done. Default 0 (no limit).
+	 */
+	maxProbingTransports?: number;
+
+	/**
+	 * Maximum number of key frame requests (PLI/FIR) per second sent to the
+	 * producers of a transport. Requests over it are delayed and spread over
+	 * time. Default 0 (no limit).
+	 */
+	maxKeyFrameRequestsPerTransport?: number;
+
+	/**
+	 * Maximum number of key frame requests (PLI/FIR) per second sent to the
+	 * producers of all the transports of a router. Default 0 (no limit).
+	 */
+	maxKeyFrameRequestsPerRouter?: number;
+
+	/**
+	 * Indexes of the CPU cores the helper threads of the media worker (SRTP
+	 * encrypt and DTLS handshake threads) are pinned to, in round robin (Linux
+	 * only). If unset, they are not pinned.
+	 */
+	helperCpuAffinity?: number[];
+
+	/**
+	 * Allocate memory in the NUMA node of the CPU core running the media worker
+	 * (Linux only). Useful along with cpuAffinity. Default false.
+	 */
+	numaLocalMemory?: boolean;
+
+	/**
+	 * Allocate the long lived objects of each transport (producers, consumers,
+	 * their RTP streams, ICE and DTLS state) in a memory arena of the transport,
+	 * so they are contiguous in memory and released in bulk when the transport
+	 * is closed. Default false.
+	 */
+	transportArenas?: boolean;
+
+	/**
+	 * Trust the frame-marking RTP header extension of H264 packets when present,
+	 * so their payload is not inspected to detect key frames. Not suitable if
+	 * some endpoint does not set the independent flag in key frames (as
+	 * libwebrtc with some hardware encoders). Default false.
+	 */
+	trustFrameMarking?: boolean;
+
+	/**
+	 * Estimate the outgoing bandwidth of transports using transport-cc with the
+	 * native mediasoup estimator (delay gradient, loss and application limited
+	 * region detection) instead of the libwebrtc one, which takes more memory
+	 * and CPU per transport. Transports using REMB are not affected. Default
+	 * false.
+	 */
+	nativeBandwidthEstimator?: boolean;
+
+	/**
+	 * Run SCTP (DataChannels) with the native mediasoup SCTP implementation
+	 * instead of usrsctp, which takes less memory and CPU per association and
+	 * has no global state. Non WebRTC SCTP peers that reset their incoming
+	 * streams are not supported. Default false.
+	 */
+	nativeSctp?: boolean;
+
+	/**
+	 * Run the media worker main thread with SCHED_FIFO real-time scheduling
+	 * with the given priority (from 1 to 99, Linux only). It requires the
+	 * CAP_SYS_NICE capability. Default 0 (normal scheduling).
+	 */
+	realtimePriority?: number;
+
+	/**
+	 * Nice value (from -20 to 19) of the media worker main thread (Linux
+	 * only). Negative values require the CAP_SYS_NICE capability. Default 0
+	 * (inherited).
+	 */
+	niceness?: number;
+
+	/**
+	 * Backend of the packet I/O of the UDP sockets and TCP connections.
+	 * 'io_uring' reads from all the sockets with multishot io_uring requests and
+	 * sends UDP datagrams in batches with no copy, submitted once per event loop
+	 * iteration (Linux >= 6.0, it falls back to 'libuv' otherwise).
+	 * 'io_uring_sqpoll' also makes a kernel thread poll the submission ring so
+	 * sending needs no syscall (it uses a CPU core while there is traffic).
+	 * Default 'libuv'.
+	 */
+	packetIo?: WorkerPacketIo;
+
+	/**
+	 * Number of UDP and TCP sockets kept bound in random ports of each listen
+	 * IP (once a transport has been created in it), so new transports take them
+	 * instead of binding sockets while their creation request is processed.
+	 * Sockets are bound again in next event loop iterations. Default 0
+	 * (disabled).
+	 */
+	socketPoolSize?: number;
+
+	/**
+	 * Size (in bytes) of the kernel receive buffer of the UDP sockets (limited
+	 * by net.core.rmem_max in Linux). Increase it if bursts of high bitrate
+	 * streams are dropped by the kernel (see the recvDrops field in transport
+	 * stats). Default 0 (OS default).
+	 */
+	udpRecvBufferSize?: number;
+
+	/**
+	 * Size (in bytes) of the kernel send buffer of the UDP sockets (limited by
+	 * net.core.wmem_max in Linux). Default 0 (OS default).
+	 */
+	udpSendBufferSize?: number;
+
+	/**
+	 * Whether received RTP packets are stamped with the time the kernel received
+	 * them, so transport-cc feedback (and REMB) and the jitter of received
+	 * streams reflect the network and not the time packets wait in a loaded
+	 * worker. Just for UDP sockets read with io_uring (see packetIo). Default
+	 * false.
+	 */
+	kernelRecvTimestamps?: boolean;
+
+	/**
+	 * Whether packets sent over UDP sockets are marked as ECN capable (ECT(0))
+	 * and CE marks in received ones are reported back via RTCP ECN feedback
+	 * (RFC 6679), so congestion reported by the network is handled as packet
+	 * loss by the send side bandwidth estimation. Reading received marks just
+	 * works for UDP sockets read with io_uring (see packetIo). Default false.
+	 */
+	ecn?: boolean;
+
+	/**
+	 * Whether TCP connections of WebRtcTransports and WebRtcServers also accept
+	 * TURN clients (using TCP transport), which is useful for clients that can
+	 * just reach the worker through a TURN server. Allocations are terminated
+	 * in the worker, so they can just be used to send data to it and the
+	 * client must be given a TURN server URL pointing to the TCP listen port.
+	 * No authentication is required. Default false.
+	 */
+	turnOverTcp?: boolean;
+
+	/**
+	 * Bitrate (in bps) at which the video sent by all the transports of the
+	 * worker is smoothed, so bursts (such as a key frame sent to many consumers
+	 * at once) are spread over time instead of leaving the NIC at once.
+	 * Transports using transport-cc hold the packets in their pacers and the
+	 * rest in a queue shared by the worker. It should be well above the
+	 * expected video egress of the worker. Default 0 (disabled).
+	 */
+	egressBitrate?: number;
+
+	/**
+	 * Duration (in ms) of the burst allowed by egressBitrate. Default 20.
+	 */
+	egressBurstMs?: number;
+
+	/**
+	 * Time (in microseconds) during which the event loop of the worker keeps
+	 * polling with no timeout (spinning) once there are no more events, before
+	 * blocking, so events arriving meanwhile do not suffer the wake up latency.
+	 * It's also set as SO_BUSY_POLL in UDP sockets (Linux). It costs CPU, so it
+	 * is meant for workers in dedicated cores (see the loop field in the
+	 * resource usage). Default 0 (disabled).
+	 */
+	busyPollUs?: number;
+
 	/**
 	 * Custom application data.
 	 */
 	appData?: Record<string, unknown>;
 }
 
-export type WorkerUpdateableSettings = Pick<WorkerSettings, 'logLevel' | 'logTags'>;
+export type WorkerUpdateableSettings = Pick<
+	WorkerSettings,
+	'logLevel' | 'logTags' | 'udpRecvBufferSize' | 'udpSendBufferSize'
+>;
 
 /**
  * An object with the fields of the uv_rusage_t struct.
@@ -162,16 +462,163 @@ export type WorkerResourceUsage =
 	ru_nivcsw: number;
 
 	/* eslint-enable camelcase */
+
+	/**
+	 * Busy time of every event loop iteration (in ns).
+	 */
+	loopLag?: WorkerMetricsHistogram;
+
+	/**
+	 * Event loop iterations. Spin ones are just done if the busyPollUs setting
+	 * is enabled, and idle spins (and the time spent in them) are the ones
+	 * that found no events.
+	 */
+	loop?:
+	{
+		iterations: number;
+		blockingIterations: number;
+		spinIterations: number;
+		idleSpins: number;
+		idleSpinMs: number;
+	};
+
+	/**
+	 * Time spent in the instrumented stages of the media path (in ns). Nested
+	 * stages are included in the outer stage.
+	 */
+	stages?:
+	{
+		transportReceiveRtp: WorkerMetricsHistogram;
+		routerFanOut: WorkerMetricsHistogram;
+		srtp: WorkerMetricsHistogram;
+		channelIo: WorkerMetricsHistogram;
+		transportCongestionControlClient: WorkerMetricsHistogram;
+		sendRtcp: WorkerMetricsHistogram;
+		channelRequest: WorkerMetricsHistogram;
+	};
+
+	/**
+	 * Time datagrams spend in the UDP egress queue (in ns). Just given if the
+	 * forwardingLatency setting is enabled.
+	 */
+	sendQueueDelay?: WorkerMetricsHistogram;
+
+	/**
+	 * Approximate memory (in bytes) used by the media buffers of all the
+	 * Routers.
+	 */
+	routerMemoryUsage?: number;
+
+	/**
+	 * Number of SRTP sessions of all the transports and how many of them have
+	 * allocated their libsrtp context (which is done once the first RTP or
+	 * RTCP packet is sent or received).
+	 */
+	srtpSessions?:
+	{
+		count: number;
+		allocated: number;
+	};
+
+	/**
+	 * Usage of the RTC port range (rtcMinPort to rtcMaxPort) by UDP and TCP in
+	 * each IP. bindFailures counts ports that were free in the worker but could
+	 * not be bound (taken by other processes).
+	 */
+	ports?:
+	{
+		udp: Record<string, WorkerPortsUsage>;
+		tcp: Record<string, WorkerPortsUsage>;
+	};
+
+	/**
+	 * Memory allocator the worker is linked with and its process wide
+	 * statistics (in bytes) if it provides them.
+	 */
+	allocator?:
+	{
+		name: 'system' | 'mimalloc' | 'jemalloc' | 'tcmalloc';
+		hugePages: boolean;
+		allocated?: number;
+		reserved?: number;
+	};
+}
+
+export type WorkerPortsUsage =
+{
+	numPorts: number;
+	numUsedPorts: number;
+	utilization: number;
+	bindFailures: number;
+	pooledSockets: number;
+	pooledBinds: number;
+}
+
+export type WorkerMetricsHistogram =
+{
+	count: number;
+	mean: number;
+	max: number;
+	p50: number;
+	p90: number;
+	p99: number;
+	p999: number;
+	/**
+	 * Non empty buckets as [lower bound, count] pairs.
+	 */
+	buckets: [number, number][];
+}
+
+export type WorkerOverloadLevel =
+	| 'none'
+	| 'drop-rtx'
+	| 'drop-temporal-layers'
+	| 'drop-spatial-layers'
+	| 'pause-consumers';
+
+export type WorkerOverloadData =
+{
+	level: WorkerOverloadLevel;
+	previousLevel: WorkerOverloadLevel;
+	/**
+	 * Event loop utilization (0-1) in the last second.
+	 */
+	loopUtilization: number;
+	/**
+	 * Max event loop lag (in ms) in the last second.
+	 */
+	maxLoopLag: number;
+	/**
+	 * Number of NACKs ignored so far.
+	 */
+	shedNacks: number;
+}
+
+/**
+ * Data of the 'state' event. The payload of the event is the state of the
+ * Router (its Transports with their full Producers and Consumers, including
+ * their send state and SRTP keys) encoded as CBOR.
+ */
+export type WorkerStateData =
+{
+	routerId: string;
+	/**
+	 * Round of the state stream. All the Routers of a round share it.
+	 */
+	seq: number;
 }
 
 export type WorkerEvents = 
 { 
 	died: [Error];
+	overload: [WorkerOverloadData];
+	state: [WorkerStateData, Buffer];
 }
 
 export type WorkerObserverEvents = 
 {
 	close: [];
+	newwebrtcserver: [WebRtcServer];
 	newrouter: [Router];
 }
 
@@ -210,6 +657,9 @@ export class Worker extends EnhancedEventEmitter<WorkerEvents>
 	// Custom app data.
 	readonly #appData: Record<string, unknown>;
 
+	// WebRtcServers set.
+	readonly #webRtcServers: Set<WebRtcServer> = new Set();
+
 	// Routers set.
 	readonly #routers: Set<Router> = new Set();
 
@@ -230,6 +680,43 @@ export class Worker extends EnhancedEventEmitter<WorkerEvents>
 			rtcMaxPort,
 			dtlsCertificateFile,
 			dtlsPrivateKeyFile,
+			dtlsCertificateCacheDir,
+			channelMessageFormat,
+			cpuAffinity,
+			srtpEncryptThreads,
+			srtpDecryptThreads,
+			dtlsHandshakeThreads,
+			dtlsSessionResumption,
+			dtlsEcdsaOnly,
+			dtls13,
+			logRateLimit,
+			logFile,
+			statsFile,
+			notificationBatchInterval,
+			forwardingLatency,
+			overloadProtection,
+			rembSampling,
+			maxProbingTransports,
+			maxKeyFrameRequestsPerTransport,
+			maxKeyFrameRequestsPerRouter,
+			helperCpuAffinity,
+			numaLocalMemory,
+			transportArenas,
+			trustFrameMarking,
+			nativeBandwidthEstimator,
+			nativeSctp,
+			realtimePriority,
+			niceness,
+			packetIo,
+			socketPoolSize,
+			udpRecvBufferSize,
+			udpSendBufferSize,
+			kernelRecvTimestamps,
+			ecn,
+			turnOverTcp,
+			egressBitrate,
+			egressBurstMs,
+			busyPollUs,
 			appData
 		}: WorkerSettings)
 	{
@@ -273,6 +760,128 @@ export class Worker extends EnhancedEventEmitter<WorkerEvents>
 		if (typeof dtlsPrivateKeyFile === 'string' && dtlsPrivateKeyFile)
 			spawnArgs.push(`--dtlsPrivateKeyFile=${dtlsPrivateKeyFile}`);
 
+		if (typeof dtlsCertificateCacheDir === 'string' && dtlsCertificateCacheDir)
+			spawnArgs.push(`--dtlsCertificateCacheDir=${dtlsCertificateCacheDir}`);
+
+		if (typeof channelMessageFormat === 'string' && channelMessageFormat)
+			spawnArgs.push(`--channelMessageFormat=${channelMessageFormat}`);
+
+		if (typeof cpuAffinity === 'number' && !Number.isNaN(cpuAffinity))
+			spawnArgs.push(`--cpuAffinity=${cpuAffinity}`);
+
+		if (typeof srtpEncryptThreads === 'number' && !Number.isNaN(srtpEncryptThreads))
+			spawnArgs.push(`--srtpEncryptThreads=${srtpEncryptThreads}`);
+
+		if (typeof srtpDecryptThreads === 'number' && !Number.isNaN(srtpDecryptThreads))
+			spawnArgs.push(`--srtpDecryptThreads=${srtpDecryptThreads}`);
+
+		if (typeof dtlsHandshakeThreads === 'number' && !Number.isNaN(dtlsHandshakeThreads))
+			spawnArgs.push(`--dtlsHandshakeThreads=${dtlsHandshakeThreads}`);
+
+		if (dtlsSessionResumption)
+			spawnArgs.push('--dtlsSessionResumption=true');
+
+		if (dtlsEcdsaOnly)
+			spawnArgs.push('--dtlsEcdsaOnly=true');
+
+		if (dtls13)
+			spawnArgs.push('--dtls13=true');
+
+		if (typeof logRateLimit === 'number' && !Number.isNaN(logRateLimit))
+			spawnArgs.push(`--logRateLimit=${logRateLimit}`);
+
+		if (typeof logFile === 'string' && logFile)
+			spawnArgs.push(`--logFile=${logFile}`);
+
+		if (typeof statsFile === 'string' && statsFile)
+			spawnArgs.push(`--statsFile=${statsFile}`);
+
+		if (
+			typeof notificationBatchInterval === 'number' &&
+			!Number.isNaN(notificationBatchInterval)
+		)
+		{
+			spawnArgs.push(`--notificationBatchInterval=${notificationBatchInterval}`);
+		}
+
+		if (forwardingLatency)
+			spawnArgs.push('--forwardingLatency');
+
+		if (overloadProtection)
+			spawnArgs.push('--overloadProtection');
+
+		if (typeof rembSampling === 'number' && !Number.isNaN(rembSampling))
+			spawnArgs.push(`--rembSampling=${rembSampling}`);
+
+		if (typeof maxProbingTransports === 'number' && !Number.isNaN(maxProbingTransports))
+			spawnArgs.push(`--maxProbingTransports=${maxProbingTransports}`);
+
+		if (
+			typeof maxKeyFrameRequestsPerTransport === 'number' &&
+			!Number.isNaN(maxKeyFrameRequestsPerTransport)
+		)
+			spawnArgs.push(`--maxKeyFrameRequestsPerTransport=${maxKeyFrameRequestsPerTransport}`);
+
+		if (
+			typeof maxKeyFrameRequestsPerRouter === 'number' &&
+			!Number.isNaN(maxKeyFrameRequestsPerRouter)
+		)
+			spawnArgs.push(`--maxKeyFrameRequestsPerRouter=${maxKeyFrameRequestsPerRouter}`);
+
+		if (Array.isArray(helperCpuAffinity) && helperCpuAffinity.length > 0)
+			spawnArgs.push(`--helperCpuAffinity=${helperCpuAffinity.join(',')}`);
+
+		if (numaLocalMemory)
+			spawnArgs.push('--numaLocalMemory=true');
+
+		if (transportArenas)
+			spawnArgs.push('--transportArenas=true');
+
+		if (trustFrameMarking)
+			spawnArgs.push('--trustFrameMarking=true');
+
+		if (nativeBandwidthEstimator)
+			spawnArgs.push('--nativeBandwidthEstimator=true');
+
+		if (nativeSctp)
+			spawnArgs.push('--nativeSctp=true');
+
+		if (typeof realtimePriority === 'number' && !Number.isNaN(realtimePriority))
+			spawnArgs.push(`--realtimePriority=${realtimePriority}`);
+
+		if (typeof niceness === 'number' && !Number.isNaN(niceness))
+			spawnArgs.push(`--niceness=${niceness}`);
+
+		if (typeof packetIo === 'string' && packetIo)
+			spawnArgs.push(`--packetIo=${packetIo}`);
+
+		if (typeof socketPoolSize === 'number' && !Number.isNaN(socketPoolSize))
+			spawnArgs.push(`--socketPoolSize=${socketPoolSize}`);
+
+		if (typeof udpRecvBufferSize === 'number' && !Number.isNaN(udpRecvBufferSize))
+			spawnArgs.push(`--udpRecvBufferSize=${udpRecvBufferSize}`);
+
+		if (typeof udpSendBufferSize === 'number' && !Number.isNaN(udpSendBufferSize))
+			spawnArgs.push(`--udpSendBufferSize=${udpSendBufferSize}`);
+
+		if (kernelRecvTimestamps)
+			spawnArgs.push('--kernelRecvTimestamps=true');
+
+		if (ecn)
+			spawnArgs.push('--ecn=true');
+
+		if (turnOverTcp)
+			spawnArgs.push('--turnOverTcp=true');
+
+		if (typeof egressBitrate === 'number' && !Number.isNaN(egressBitrate))
+			spawnArgs.push(`--egressBitrate=${egressBitrate}`);
+
+		if (typeof egressBurstMs === 'number' && !Number.isNaN(egressBurstMs))
+			spawnArgs.push(`--egressBurstMs=${egressBurstMs}`);
+
+		if (typeof busyPollUs === 'number' && !Number.isNaN(busyPollUs))
+			spawnArgs.push(`--busyPollUs=${busyPollUs}`);
+
 		logger.debug(
 			'spawning worker process: %s %s', spawnBin, spawnArgs.join(' '));
 
@@ -311,7 +920,8 @@ export class Worker extends EnhancedEventEmitter<WorkerEvents>
 			{
 				producerSocket : this.#child.stdio[3],
 				consumerSocket : this.#child.stdio[4],
-				pid            : this.#pid
+				pid            : this.#pid,
+				messageFormat  : channelMessageFormat
 			});
 
 		this.#payloadChannel = new PayloadChannel(
@@ -320,7 +930,8 @@ export class Worker extends EnhancedEventEmitter<WorkerEvents>
 				// @ts-ignore
 				producerSocket : this.#child.stdio[5],
 				// @ts-ignore
-				consumerSocket : this.#child.stdio[6]
+				consumerSocket : this.#child.stdio[6],
+				messageFormat  : channelMessageFormat
 			});
 
 		this.#appData = appData || {};
@@ -328,18 +939,36 @@ export class Worker extends EnhancedEventEmitter<WorkerEvents>
 		let spawnDone = false;
 
 		// Listen for 'running' notification.
-		this.#channel.once(String(this.#pid), (event: string) =>
+		this.#channel.once(String(this.#pid), (event: string, data?: any) =>
 		{
 			if (!spawnDone && event === 'running')
 			{
 				spawnDone = true;
 
-				logger.debug('worker process running [pid:%s]', this.#pid);
+				logger.debug(
+					'worker process running [pid:%s, startupTimes:%o]',
+					this.#pid, data?.startupTimes);
 
 				this.emit('@success');
 			}
 		});
 
+		// Listen for 'overload' notifications.
+		this.#channel.on(String(this.#pid), (event: string, data?: any) =>
+		{
+			if (event === 'overload')
+				this.safeEmit('overload', data as WorkerOverloadData);
+		});
+
+		// Listen for 'state' notifications.
+		this.#payloadChannel.on(
+			String(this.#pid),
+			(event: string, data: any, payload: Buffer) =>
+			{
+				if (event === 'state')
+					this.safeEmit('state', data as WorkerStateData, payload);
+			});
+
 		this.#child.on('exit', (code, signal) =>
 		{
 			this.#child = undefined;
@@ -467,6 +1096,7 @@ export class Worker extends EnhancedEventEmitter<WorkerEvents>
 	 * Observer.
 	 *
 	 * @emits close
+	 * @emits newwebrtcserver - (webRtcServer: WebRtcServer)
 	 * @emits newrouter - (router: Router)
 	 */
 	get observer(): EnhancedEventEmitter<WorkerObserverEvents>
@@ -474,6 +1104,15 @@ export class Worker extends EnhancedEventEmitter<WorkerEvents>
 		return this.#observer;
 	}
 
+	/**
+	 * @private
+	 * Just for testing purposes.
+	 */
+	get webRtcServersForTesting(): Set<WebRtcServer>
+	{
+		return this.#webRtcServers;
+	}
+
 	/**
 	 * @private
 	 * Just for testing purposes.
@@ -520,6 +1159,13 @@ export class Worker extends EnhancedEventEmitter<WorkerEvents>
 		}
 		this.#routers.clear();
 
+		// Close every WebRtcServer.
+		for (const webRtcServer of this.#webRtcServers)
+		{
+			webRtcServer.workerClosed();
+		}
+		this.#webRtcServers.clear();
+
 		// Emit observer event.
 		this.#observer.safeEmit('close');
 	}
@@ -544,29 +1190,82 @@ export class Worker extends EnhancedEventEmitter<WorkerEvents>
 		return this.#channel.request('worker.getResourceUsage');
 	}
 
+	/**
+	 * Periodically emit the state of every Router in the 'state' event so a
+	 * standby can take over if this worker fails. An interval of 0 disables it.
+	 */
+	async enableStateStream({ interval }: { interval: number }): Promise<void>
+	{
+		logger.debug('enableStateStream()');
+
+		await this.#channel.request('worker.enableStateStream', undefined, { interval });
+	}
+
 	/**
 	 * Update settings.
 	 */
 	async updateSettings(
 		{
 			logLevel,
-			logTags
+			logTags,
+			udpRecvBufferSize,
+			udpSendBufferSize
 		}: WorkerUpdateableSettings = {}
 	): Promise<void>
 	{
 		logger.debug('updateSettings()');
 
-		const reqData = { logLevel, logTags };
+		const reqData = { logLevel, logTags, udpRecvBufferSize, udpSendBufferSize };
 
 		await this.#channel.request('worker.updateSettings', undefined, reqData);
 	}
 
+	/**
+	 * Create a WebRtcServer.
+	 */
+	async createWebRtcServer(
+		{
+			listenInfos,
+			reusePortIndex,
+			appData
+		}: WebRtcServerOptions): Promise<WebRtcServer>
+	{
+		logger.debug('createWebRtcServer()');
+
+		if (!Array.isArray(listenInfos))
+			throw new TypeError('missing listenInfos');
+		else if (appData && typeof appData !== 'object')
+			throw new TypeError('if given, appData must be an object');
+
+		const internal = { webRtcServerId: uuidv4() };
+		const reqData = { listenInfos, reusePortIndex };
+
+		await this.#channel.request('worker.createWebRtcServer', internal, reqData);
+
+		const webRtcServer = new WebRtcServer(
+			{
+				internal,
+				channel : this.#channel,
+				appData
+			});
+
+		this.#webRtcServers.add(webRtcServer);
+		webRtcServer.on('@close', () => this.#webRtcServers.delete(webRtcServer));
+
+		// Emit observer event.
+		this.#observer.safeEmit('newwebrtcserver', webRtcServer);
+
+		return webRtcServer;
+	}
+
 	/**
 	 * Create a Router.
 	 */
 	async createRouter(
 		{
 			mediaCodecs,
+			audioLastN = 0,
+			memorySoftLimit = 0,
 			appData
 		}: RouterOptions = {}): Promise<Router>
 	{
@@ -574,18 +1273,23 @@ export class Worker extends EnhancedEventEmitter<WorkerEvents>
 
 		if (appData && typeof appData !== 'object')
 			throw new TypeError('if given, appData must be an object');
+		else if (typeof audioLastN !== 'number' || audioLastN < 0)
+			throw new TypeError('if given, audioLastN must be a non negative number');
+		else if (typeof memorySoftLimit !== 'number' || memorySoftLimit < 0)
+			throw new TypeError('if given, memorySoftLimit must be a non negative number');
 
 		// This may throw.
 		const rtpCapabilities = ortc.generateRouterRtpCapabilities(mediaCodecs);
 
 		const internal = { routerId: uuidv4() };
 
-		await this.#channel.request('worker.createRouter', internal);
+		const { handle } = await this.#channel.request(
+			'worker.createRouter', internal, { audioLastN, memorySoftLimit });
 
 		const data = { rtpCapabilities };
 		const router = new Router(
 			{
-				internal,
+				internal : { ...internal, routerHandle: handle },
 				data,
 				channel        : this.#channel,
 				payloadChannel : this.#payloadChannel,
@@ -624,6 +1328,13 @@ export class Worker extends EnhancedEventEmitter<WorkerEvents>
 		}
 		this.#routers.clear();
 
+		// Close every WebRtcServer.
+		for (const webRtcServer of this.#webRtcServers)
+		{
+			webRtcServer.workerClosed();
+		}
+		this.#webRtcServers.clear();
+
 		this.safeEmit('died', error);
 
 		// Emit observer event.
@@ -1,6 +1,8 @@
 import { Logger } from './Logger';
 import { EnhancedEventEmitter } from './EnhancedEventEmitter';
 import { Worker, WorkerSettings } from './Worker';
+import { Router } from './Router';
+import { ShardedRouter, ShardedRouterOptions } from './ShardedRouter';
 import * as utils from './utils';
 import { supportedRtpCapabilities } from './supportedRtpCapabilities';
 import { RtpCapabilities } from './RtpParameters';
@@ -42,6 +44,43 @@ export async function createWorker(
 		rtcMaxPort = 59999,
 		dtlsCertificateFile,
 		dtlsPrivateKeyFile,
+		dtlsCertificateCacheDir,
+		channelMessageFormat,
+		cpuAffinity,
+		srtpEncryptThreads,
+		srtpDecryptThreads,
+		dtlsHandshakeThreads,
+		dtlsSessionResumption,
+		dtlsEcdsaOnly,
+		dtls13,
+		logRateLimit,
+		logFile,
+		statsFile,
+		notificationBatchInterval,
+		forwardingLatency,
+		overloadProtection,
+		rembSampling,
+		maxProbingTransports,
+		maxKeyFrameRequestsPerTransport,
+		maxKeyFrameRequestsPerRouter,
+		helperCpuAffinity,
+		numaLocalMemory,
+		transportArenas,
+		trustFrameMarking,
+		nativeBandwidthEstimator,
+		nativeSctp,
+		realtimePriority,
+		niceness,
+		packetIo,
+		socketPoolSize,
+		udpRecvBufferSize,
+		udpSendBufferSize,
+		kernelRecvTimestamps,
+		ecn,
+		turnOverTcp,
+		egressBitrate,
+		egressBurstMs,
+		busyPollUs,
 		appData
 	}: WorkerSettings = {}
 ): Promise<Worker>
@@ -59,6 +98,43 @@ export async function createWorker(
 			rtcMaxPort,
 			dtlsCertificateFile,
 			dtlsPrivateKeyFile,
+			dtlsCertificateCacheDir,
+			channelMessageFormat,
+			cpuAffinity,
+			srtpEncryptThreads,
+			srtpDecryptThreads,
+			dtlsHandshakeThreads,
+			dtlsSessionResumption,
+			dtlsEcdsaOnly,
+			dtls13,
+			logRateLimit,
+			logFile,
+			statsFile,
+			notificationBatchInterval,
+			forwardingLatency,
+			overloadProtection,
+			rembSampling,
+			maxProbingTransports,
+			maxKeyFrameRequestsPerTransport,
+			maxKeyFrameRequestsPerRouter,
+			helperCpuAffinity,
+			numaLocalMemory,
+			transportArenas,
+			trustFrameMarking,
+			nativeBandwidthEstimator,
+			nativeSctp,
+			realtimePriority,
+			niceness,
+			packetIo,
+			socketPoolSize,
+			udpRecvBufferSize,
+			udpSendBufferSize,
+			kernelRecvTimestamps,
+			ecn,
+			turnOverTcp,
+			egressBitrate,
+			egressBurstMs,
+			busyPollUs,
 			appData
 		});
 
@@ -76,6 +152,47 @@ export async function createWorker(
 	});
 }
 
+/**
+ * Create a ShardedRouter with a Router in each given Worker.
+ */
+export async function createShardedRouter(
+	{
+		workers,
+		pipeOptions,
+		...routerOptions
+	}: ShardedRouterOptions
+): Promise<ShardedRouter>
+{
+	logger.debug('createShardedRouter()');
+
+	if (!Array.isArray(workers) || workers.length === 0)
+		throw new TypeError('missing workers');
+
+	const results = await Promise.allSettled(
+		workers.map((worker) => worker.createRouter(routerOptions)));
+	const routers: Router[] = [];
+
+	for (const result of results)
+	{
+		if (result.status === 'fulfilled')
+			routers.push(result.value);
+	}
+
+	// Close the created Routers if any failed.
+	if (routers.length !== results.length)
+	{
+		for (const router of routers)
+		{
+			router.close();
+		}
+
+		throw (results.find((result) => result.status === 'rejected') as PromiseRejectedResult)
+			.reason;
+	}
+
+	return new ShardedRouter({ routers, pipeOptions });
+}
+
 /**
  * Get a cloned copy of the mediasoup supported RTP capabilities.
  */
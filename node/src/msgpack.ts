@@ -0,0 +1,515 @@
+/**
+ * Minimal MessagePack encoder and decoder for Channel and PayloadChannel
+ * messages. Just the types that can be represented in JSON are supported
+ * (plus binary when decoding), and objects are encoded as JSON.stringify()
+ * would do (undefined and function members are ignored, toJSON() is called).
+ */
+
+const ENCODE_INITIAL_SIZE = 1024;
+
+class Encoder
+{
+	#buffer = Buffer.allocUnsafe(ENCODE_INITIAL_SIZE);
+
+	#pos = 0;
+
+	encode(value: any): Buffer
+	{
+		this.#pos = 0;
+
+		this.write(value);
+
+		return Buffer.from(this.#buffer.subarray(0, this.#pos));
+	}
+
+	private ensure(len: number): void
+	{
+		if (this.#pos + len <= this.#buffer.length)
+			return;
+
+		let size = this.#buffer.length * 2;
+
+		while (size < this.#pos + len)
+		{
+			size *= 2;
+		}
+
+		const buffer = Buffer.allocUnsafe(size);
+
+		this.#buffer.copy(buffer, 0, 0, this.#pos);
+		this.#buffer = buffer;
+	}
+
+	private writeUInt8(value: number): void
+	{
+		this.ensure(1);
+		this.#buffer.writeUInt8(value, this.#pos);
+		this.#pos += 1;
+	}
+
+	private writeTypeAndLength(
+		value: number, fixType: number, fixMax: number, type8: number | undefined,
+		type16: number, type32: number): void
+	{
+		if (value <= fixMax)
+		{
+			this.writeUInt8(fixType | value);
+		}
+		else if (type8 !== undefined && value <= 0xff)
+		{
+			this.ensure(2);
+			this.#buffer.writeUInt8(type8, this.#pos);
+			this.#buffer.writeUInt8(value, this.#pos + 1);
+			this.#pos += 2;
+		}
+		else if (value <= 0xffff)
+		{
+			this.ensure(3);
+			this.#buffer.writeUInt8(type16, this.#pos);
+			this.#buffer.writeUInt16BE(value, this.#pos + 1);
+			this.#pos += 3;
+		}
+		else
+		{
+			this.ensure(5);
+			this.#buffer.writeUInt8(type32, this.#pos);
+			this.#buffer.writeUInt32BE(value, this.#pos + 1);
+			this.#pos += 5;
+		}
+	}
+
+	private writeNumber(value: number): void
+	{
+		// Same as JSON.stringify().
+		if (!Number.isFinite(value))
+		{
+			this.writeUInt8(0xc0);
+		}
+		else if (!Number.isSafeInteger(value))
+		{
+			this.ensure(9);
+			this.#buffer.writeUInt8(0xcb, this.#pos);
+			this.#buffer.writeDoubleBE(value, this.#pos + 1);
+			this.#pos += 9;
+		}
+		else if (value >= 0)
+		{
+			if (value <= 0x7f)
+			{
+				this.writeUInt8(value);
+			}
+			else if (value <= 0xff)
+			{
+				this.ensure(2);
+				this.#buffer.writeUInt8(0xcc, this.#pos);
+				this.#buffer.writeUInt8(value, this.#pos + 1);
+				this.#pos += 2;
+			}
+			else if (value <= 0xffff)
+			{
+				this.ensure(3);
+				this.#buffer.writeUInt8(0xcd, this.#pos);
+				this.#buffer.writeUInt16BE(value, this.#pos + 1);
+				this.#pos += 3;
+			}
+			else if (value <= 0xffffffff)
+			{
+				this.ensure(5);
+				this.#buffer.writeUInt8(0xce, this.#pos);
+				this.#buffer.writeUInt32BE(value, this.#pos + 1);
+				this.#pos += 5;
+			}
+			else
+			{
+				this.ensure(9);
+				this.#buffer.writeUInt8(0xcf, this.#pos);
+				this.#buffer.writeUInt32BE(Math.floor(value / 0x100000000), this.#pos + 1);
+				this.#buffer.writeUInt32BE(value >>> 0, this.#pos + 5);
+				this.#pos += 9;
+			}
+		}
+		else
+		{
+			if (value >= -32)
+			{
+				this.ensure(1);
+				this.#buffer.writeInt8(value, this.#pos);
+				this.#pos += 1;
+			}
+			else if (value >= -0x80)
+			{
+				this.ensure(2);
+				this.#buffer.writeUInt8(0xd0, this.#pos);
+				this.#buffer.writeInt8(value, this.#pos + 1);
+				this.#pos += 2;
+			}
+			else if (value >= -0x8000)
+			{
+				this.ensure(3);
+				this.#buffer.writeUInt8(0xd1, this.#pos);
+				this.#buffer.writeInt16BE(value, this.#pos + 1);
+				this.#pos += 3;
+			}
+			else if (value >= -0x80000000)
+			{
+				this.ensure(5);
+				this.#buffer.writeUInt8(0xd2, this.#pos);
+				this.#buffer.writeInt32BE(value, this.#pos + 1);
+				this.#pos += 5;
+			}
+			else
+			{
+				this.ensure(9);
+				this.#buffer.writeUInt8(0xd3, this.#pos);
+				this.#buffer.writeInt32BE(Math.floor(value / 0x100000000), this.#pos + 1);
+				this.#buffer.writeUInt32BE(value >>> 0, this.#pos + 5);
+				this.#pos += 9;
+			}
+		}
+	}
+
+	private writeString(value: string): void
+	{
+		const len = Buffer.byteLength(value);
+
+		this.writeTypeAndLength(len, 0xa0, 31, 0xd9, 0xda, 0xdb);
+		this.ensure(len);
+		this.#buffer.write(value, this.#pos, len, 'utf8');
+		this.#pos += len;
+	}
+
+	private write(value: any): void
+	{
+		if (value === null || value === undefined || typeof value === 'function')
+		{
+			this.writeUInt8(0xc0);
+
+			return;
+		}
+
+		if (typeof value.toJSON === 'function')
+			value = value.toJSON();
+
+		switch (typeof value)
+		{
+			case 'boolean':
+			{
+				this.writeUInt8(value ? 0xc3 : 0xc2);
+
+				break;
+			}
+
+			case 'number':
+			{
+				this.writeNumber(value);
+
+				break;
+			}
+
+			case 'bigint':
+			{
+				this.writeNumber(Number(value));
+
+				break;
+			}
+
+			case 'string':
+			{
+				this.writeString(value);
+
+				break;
+			}
+
+			default:
+			{
+				if (Array.isArray(value))
+				{
+					this.writeTypeAndLength(value.length, 0x90, 15, undefined, 0xdc, 0xdd);
+
+					for (const item of value)
+					{
+						this.write(item);
+					}
+				}
+				else
+				{
+					const keys = Object.keys(value)
+						.filter((key) => (
+							value[key] !== undefined && typeof value[key] !== 'function'
+						));
+
+					this.writeTypeAndLength(keys.length, 0x80, 15, undefined, 0xde, 0xdf);
+
+					for (const key of keys)
+					{
+						this.writeString(key);
+						this.write(value[key]);
+					}
+				}
+			}
+		}
+	}
+}
+
+class Decoder
+{
+	#buffer: Buffer = Buffer.alloc(0);
+
+	#pos = 0;
+
+	decode(buffer: Buffer): any
+	{
+		this.#buffer = buffer;
+		this.#pos = 0;
+
+		const value = this.read();
+
+		if (this.#pos !== buffer.length)
+			throw new TypeError('invalid MessagePack data (trailing bytes)');
+
+		return value;
+	}
+
+	private check(len: number): void
+	{
+		if (this.#pos + len > this.#buffer.length)
+			throw new TypeError('invalid MessagePack data (unexpected end)');
+	}
+
+	private readString(len: number): string
+	{
+		this.check(len);
+
+		const value = this.#buffer.toString('utf8', this.#pos, this.#pos + len);
+
+		this.#pos += len;
+
+		return value;
+	}
+
+	private readBinary(len: number): Buffer
+	{
+		this.check(len);
+
+		const value = Buffer.from(this.#buffer.subarray(this.#pos, this.#pos + len));
+
+		this.#pos += len;
+
+		return value;
+	}
+
+	private readArray(len: number): any[]
+	{
+		const value = new Array(len);
+
+		for (let i = 0; i < len; ++i)
+		{
+			value[i] = this.read();
+		}
+
+		return value;
+	}
+
+	private readMap(len: number): any
+	{
+		const value: any = {};
+
+		for (let i = 0; i < len; ++i)
+		{
+			const key = this.read();
+
+			value[String(key)] = this.read();
+		}
+
+		return value;
+	}
+
+	private readLength(size: number): number
+	{
+		this.check(size);
+
+		let len;
+
+		switch (size)
+		{
+			case 1:
+				len = this.#buffer.readUInt8(this.#pos);
+				break;
+
+			case 2:
+				len = this.#buffer.readUInt16BE(this.#pos);
+				break;
+
+			default:
+				len = this.#buffer.readUInt32BE(this.#pos);
+		}
+
+		this.#pos += size;
+
+		return len;
+	}
+
+	private read(): any
+	{
+		this.check(1);
+
+		const type = this.#buffer.readUInt8(this.#pos++);
+
+		// positive fixint.
+		if (type <= 0x7f)
+			return type;
+		// fixmap.
+		else if (type <= 0x8f)
+			return this.readMap(type & 0x0f);
+		// fixarray.
+		else if (type <= 0x9f)
+			return this.readArray(type & 0x0f);
+		// fixstr.
+		else if (type <= 0xbf)
+			return this.readString(type & 0x1f);
+		// negative fixint.
+		else if (type >= 0xe0)
+			return type - 0x100;
+
+		let value;
+
+		switch (type)
+		{
+			case 0xc0:
+				return null;
+
+			case 0xc2:
+				return false;
+
+			case 0xc3:
+				return true;
+
+			case 0xc4:
+				return this.readBinary(this.readLength(1));
+
+			case 0xc5:
+				return this.readBinary(this.readLength(2));
+
+			case 0xc6:
+				return this.readBinary(this.readLength(4));
+
+			case 0xca:
+				this.check(4);
+				value = this.#buffer.readFloatBE(this.#pos);
+				this.#pos += 4;
+
+				return value;
+
+			case 0xcb:
+				this.check(8);
+				value = this.#buffer.readDoubleBE(this.#pos);
+				this.#pos += 8;
+
+				return value;
+
+			case 0xcc:
+				return this.readLength(1);
+
+			case 0xcd:
+				return this.readLength(2);
+
+			case 0xce:
+				return this.readLength(4);
+
+			case 0xcf:
+				this.check(8);
+				value =
+					(this.#buffer.readUInt32BE(this.#pos) * 0x100000000) +
+					this.#buffer.readUInt32BE(this.#pos + 4);
+				this.#pos += 8;
+
+				return value;
+
+			case 0xd0:
+				this.check(1);
+				value = this.#buffer.readInt8(this.#pos);
+				this.#pos += 1;
+
+				return value;
+
+			case 0xd1:
+				this.check(2);
+				value = this.#buffer.readInt16BE(this.#pos);
+				this.#pos += 2;
+
+				return value;
+
+			case 0xd2:
+				this.check(4);
+				value = this.#buffer.readInt32BE(this.#pos);
+				this.#pos += 4;
+
+				return value;
+
+			case 0xd3:
+				this.check(8);
+				value =
+					(this.#buffer.readInt32BE(this.#pos) * 0x100000000) +
+					this.#buffer.readUInt32BE(this.#pos + 4);
+				this.#pos += 8;
+
+				return value;
+
+			case 0xd9:
+				return this.readString(this.readLength(1));
+
+			case 0xda:
+				return this.readString(this.readLength(2));
+
+			case 0xdb:
+				return this.readString(this.readLength(4));
+
+			case 0xdc:
+				return this.readArray(this.readLength(2));
+
+			case 0xdd:
+				return this.readArray(this.readLength(4));
+
+			case 0xde:
+				return this.readMap(this.readLength(2));
+
+			case 0xdf:
+				return this.readMap(this.readLength(4));
+
+			default:
+				throw new TypeError(
+					`invalid MessagePack data (unsupported type 0x${type.toString(16)})`);
+		}
+	}
+}
+
+const encoder = new Encoder();
+const decoder = new Decoder();
+
+/**
+ * Encodes the given value into a MessagePack Buffer.
+ */
+export function encode(value: any): Buffer
+{
+	return encoder.encode(value);
+}
+
+/**
+ * Decodes the given MessagePack Buffer.
+ */
+export function decode(buffer: Buffer): any
+{
+	return decoder.decode(buffer);
+}
+
+/**
+ * Whether the given first byte of a message is a MessagePack map type.
+ */
+export function isMap(firstByte: number): boolean
+{
+	return (
+		(firstByte >= 0x80 && firstByte <= 0x8f) ||
+		firstByte === 0xde ||
+		firstByte === 0xdf
+	);
+}
@@ -424,6 +424,18 @@ export function validateRtpEncodingParameters(encoding: RtpEncodingParameters):
 			throw new TypeError('missing encoding.rtx.ssrc');
 	}
 
+	// fec is optional.
+	if (encoding.fec && typeof encoding.fec !== 'object')
+	{
+		throw new TypeError('invalid encoding.fec');
+	}
+	else if (encoding.fec)
+	{
+		// FEC ssrc is mandatory if fec is present.
+		if (typeof encoding.fec.ssrc !== 'number')
+			throw new TypeError('missing encoding.fec.ssrc');
+	}
+
 	// dtx is optional. If unset set it to false.
 	if (!encoding.dtx || typeof encoding.dtx !== 'boolean')
 		encoding.dtx = false;
@@ -1112,6 +1124,32 @@ export function getConsumerRtpParameters(
 	return consumerParams;
 }
 
+/**
+ * Clone RTP parameters generated by getConsumerRtpParameters() for another
+ * Consumer (with new SSRCs).
+ */
+export function cloneConsumerRtpParameters(
+	rtpParameters: RtpParameters,
+	pipe: boolean
+): RtpParameters
+{
+	const consumerParams = utils.clone(rtpParameters) as RtpParameters;
+	const baseSsrc = utils.generateRandomNumber();
+	const baseRtxSsrc = pipe ? utils.generateRandomNumber() : baseSsrc + 1;
+
+	for (let i = 0; i < consumerParams.encodings!.length; ++i)
+	{
+		const encoding = consumerParams.encodings![i];
+
+		encoding.ssrc = baseSsrc + i;
+
+		if (encoding.rtx)
+			encoding.rtx = { ssrc: baseRtxSsrc + i };
+	}
+
+	return consumerParams;
+}
+
 /**
  * Generate RTP parameters for a pipe Consumer.
  *
@@ -271,6 +271,19 @@ const supportedRtpCapabilities: RtpCapabilities =
 				{ type: 'goog-remb' },
 				{ type: 'transport-cc' }
 			]
+		},
+		{
+			kind         : 'video',
+			mimeType     : 'video/AV1',
+			clockRate    : 90000,
+			rtcpFeedback :
+			[
+				{ type: 'nack' },
+				{ type: 'nack', parameter: 'pli' },
+				{ type: 'ccm', parameter: 'fir' },
+				{ type: 'goog-remb' },
+				{ type: 'transport-cc' }
+			]
 		}
 	],
 	headerExtensions :
@@ -347,6 +360,13 @@ const supportedRtpCapabilities: RtpCapabilities =
 			preferredEncrypt : false,
 			direction        : 'sendrecv'
 		},
+		{
+			kind             : 'video',
+			uri              : 'https://aomediacodec.github.io/av1-rtp-spec/#dependency-descriptor-rtp-header-extension',
+			preferredId      : 8,
+			preferredEncrypt : false,
+			direction        : 'sendrecv'
+		},
 		{
 			kind             : 'audio',
 			uri              : 'urn:ietf:params:rtp-hdrext:ssrc-audio-level',
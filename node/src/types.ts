@@ -1,5 +1,7 @@
 export * from './Worker';
+export * from './WebRtcServer';
 export * from './Router';
+export * from './ShardedRouter';
 export * from './Transport';
 export * from './WebRtcTransport';
 export * from './PlainTransport';
@@ -12,6 +14,7 @@ export * from './DataConsumer';
 export * from './RtpObserver';
 export * from './ActiveSpeakerObserver';
 export * from './AudioLevelObserver';
+export * from './AudioMixer';
 export * from './RtpParameters';
 export * from './SctpParameters';
 export * from './SrtpParameters';
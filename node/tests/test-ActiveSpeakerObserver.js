@@ -54,6 +54,18 @@ test('router.createActiveSpeakerObserver() succeeds', async () =>
 			});
 }, 2000);
 
+test('router.createActiveSpeakerObserver() with useSimd succeeds', async () =>
+{
+	const activeSpeakerObserver2 =
+		await router.createActiveSpeakerObserver({ interval: 100, useSimd: true });
+
+	expect(activeSpeakerObserver2.closed).toBe(false);
+
+	activeSpeakerObserver2.close();
+
+	expect(activeSpeakerObserver2.closed).toBe(true);
+}, 2000);
+
 test('router.createActiveSpeakerObserver() with wrong arguments rejects with TypeError', async () =>
 {
 	await expect(router.createActiveSpeakerObserver({ interval: false }))
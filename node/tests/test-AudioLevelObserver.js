@@ -54,6 +54,18 @@ test('router.createAudioLevelObserver() succeeds', async () =>
 			});
 }, 2000);
 
+test('router.createAudioLevelObserver() with incremental succeeds', async () =>
+{
+	const audioLevelObserver2 =
+		await router.createAudioLevelObserver({ maxEntries: 3, incremental: true });
+
+	expect(audioLevelObserver2.closed).toBe(false);
+
+	audioLevelObserver2.close();
+
+	expect(audioLevelObserver2.closed).toBe(true);
+}, 2000);
+
 test('router.createAudioLevelObserver() with wrong arguments rejects with TypeError', async () =>
 {
 	await expect(router.createAudioLevelObserver({ maxEntries: 0 }))
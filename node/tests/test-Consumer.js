@@ -810,6 +810,108 @@ test('consumer.setPreferredLayers() with wrong arguments rejects with TypeError'
 		.toThrow(TypeError);
 }, 2000);
 
+test('transport.consumeMany() and batched Consumer requests succeed', async () =>
+{
+	const results = await transport2.consumeMany(
+		[
+			{
+				producerId      : audioProducer.id,
+				rtpCapabilities : consumerDeviceCapabilities
+			},
+			{
+				producerId      : 'foo',
+				rtpCapabilities : consumerDeviceCapabilities
+			},
+			{
+				producerId      : videoProducer.id,
+				rtpCapabilities : consumerDeviceCapabilities,
+				paused          : true
+			}
+		]);
+
+	expect(results.length).toBe(3);
+	expect(results[0].kind).toBe('audio');
+	expect(results[0].paused).toBe(false);
+	expect(results[1]).toBeInstanceOf(Error);
+	expect(results[2].kind).toBe('video');
+	expect(results[2].paused).toBe(true);
+
+	const [ audioConsumer2, , videoConsumer2 ] = results;
+
+	await expect(transport2.pauseConsumers([ audioConsumer2, videoConsumer2 ]))
+		.resolves
+		.toEqual([ undefined, undefined ]);
+
+	expect(audioConsumer2.paused).toBe(true);
+
+	await expect(audioConsumer2.dump())
+		.resolves
+		.toMatchObject({ paused: true });
+
+	await expect(transport2.resumeConsumers([ audioConsumer2, videoConsumer2 ]))
+		.resolves
+		.toEqual([ undefined, undefined ]);
+
+	expect(audioConsumer2.paused).toBe(false);
+	expect(videoConsumer2.paused).toBe(false);
+
+	const layersResults = await transport2.setConsumersPreferredLayers(
+		[
+			{ consumer: videoConsumer2, preferredLayers: { spatialLayer: 2, temporalLayer: 3 } },
+			{ consumer: videoConsumer2, preferredLayers: {} }
+		]);
+
+	expect(layersResults[0]).toBeUndefined();
+	expect(layersResults[1]).toBeInstanceOf(TypeError);
+	expect(videoConsumer2.preferredLayers).toEqual({ spatialLayer: 2, temporalLayer: 0 });
+
+	audioConsumer2.close();
+	videoConsumer2.close();
+}, 2000);
+
+test('consumer.exportSendState() and transport.consume() with sendState succeed', async () =>
+{
+	const sendState = await videoConsumer.exportSendState();
+
+	expect(sendState.type).toBe('simulcast');
+	expect(sendState.rtpSeq).toBeType('number');
+	expect(sendState.rtxSeq).toBeType('number');
+	expect(sendState.rtpParameters).toEqual(videoConsumer.rtpParameters);
+
+	const router2 = await worker.createRouter({ mediaCodecs });
+	const transport3 = await router2.createWebRtcTransport(
+		{
+			listenIps : [ '127.0.0.1' ]
+		});
+
+	await router.pipeToRouter({ producerId: videoProducer.id, router: router2 });
+
+	const migratedConsumer = await transport3.consume(
+		{
+			producerId      : videoProducer.id,
+			rtpCapabilities : consumerDeviceCapabilities,
+			sendState
+		});
+
+	expect(migratedConsumer.type).toBe('simulcast');
+	expect(migratedConsumer.rtpParameters.mid).toBe(videoConsumer.rtpParameters.mid);
+	expect(migratedConsumer.rtpParameters.encodings[0].ssrc)
+		.toBe(videoConsumer.rtpParameters.encodings[0].ssrc);
+	expect(migratedConsumer.rtpParameters.encodings[0].rtx.ssrc)
+		.toBe(videoConsumer.rtpParameters.encodings[0].rtx.ssrc);
+
+	await expect(transport3.consume(
+		{
+			producerId      : videoProducer.id,
+			rtpCapabilities : consumerDeviceCapabilities,
+			sendState       : { ...sendState, type: 'simple' }
+		}))
+		.rejects
+		.toThrow(TypeError);
+
+	router2.close();
+}, 2000);
+
 test('consumer.setPriority() succeed', async () =>
 {
 	await videoConsumer.setPriority(2);
@@ -705,6 +705,98 @@ test('router.createPipeTransport() with fixed port succeeds', async () =>
 	pipeTransport.close();
 }, 2000);
 
+test('router.createPipeTransport() with inMemory succeeds', async () =>
+{
+	const pipeTransport1 = await router1.createPipeTransport(
+		{
+			listenIp : '127.0.0.1',
+			inMemory : true
+		});
+	const pipeTransport2 = await router2.createPipeTransport(
+		{
+			listenIp : '127.0.0.1',
+			inMemory : true
+		});
+
+	expect(pipeTransport1.memoryPipeId).toBeType('string');
+	expect(pipeTransport2.memoryPipeId).toBeType('string');
+	expect(pipeTransport1.memoryPipeId).not.toBe(pipeTransport2.memoryPipeId);
+	expect(pipeTransport1.tuple.localPort).toBe(0);
+
+	// Missing memoryPipeId.
+	await expect(pipeTransport1.connect({ ip: '127.0.0.1', port: 9999 }))
+		.rejects
+		.toThrow(TypeError);
+
+	// Unknown memoryPipeId.
+	await expect(pipeTransport1.connect(
+		{
+			ip           : '127.0.0.1',
+			port         : 9999,
+			memoryPipeId : 'foo'
+		}))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(pipeTransport1.connect(
+		{
+			ip           : '127.0.0.1',
+			port         : 9999,
+			memoryPipeId : pipeTransport2.memoryPipeId
+		}))
+		.resolves
+		.toBeUndefined();
+
+	await expect(pipeTransport2.connect(
+		{
+			ip           : '127.0.0.1',
+			port         : 9999,
+			memoryPipeId : pipeTransport1.memoryPipeId
+		}))
+		.resolves
+		.toBeUndefined();
+
+	pipeTransport1.close();
+	pipeTransport2.close();
+}, 2000);
+
+test('router.createPipeTransport() with trustedNetwork succeeds', async () =>
+{
+	await expect(router1.createPipeTransport(
+		{
+			listenIp       : '127.0.0.1',
+			enableSrtp     : true,
+			trustedNetwork : true
+		}))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(router1.createPipeTransport(
+		{
+			listenIp       : '127.0.0.1',
+			inMemory       : true,
+			trustedNetwork : true
+		}))
+		.rejects
+		.toThrow(TypeError);
+
+	const pipeTransport = await router1.createPipeTransport(
+		{
+			listenIp       : '127.0.0.1',
+			trustedNetwork : true
+		});
+
+	const data = await pipeTransport.dump();
+
+	expect(data.trustedNetwork).toBe(true);
+
+	const stats = await pipeTransport.getStats();
+
+	expect(stats[0].trustedChecksumErrors).toBe(0);
+
+	pipeTransport.close();
+}, 2000);
+
 test('transport.consume() for a pipe Producer succeeds', async () =>
 {
 	videoConsumer = await transport2.consume(
@@ -887,6 +979,49 @@ test('dataProducer.close() is transmitted to pipe DataConsumer', async () =>
 	expect(dataConsumer.closed).toBe(true);
 }, 2000);
 
+test('router.pipeToRouter() relays a pipe Producer onward and detects loops', async () =>
+{
+	const routerA = await worker.createRouter({ mediaCodecs });
+	const routerB = await worker.createRouter({ mediaCodecs });
+	const routerC = await worker.createRouter({ mediaCodecs });
+	const transportA = await routerA.createWebRtcTransport({ listenIps: [ '127.0.0.1' ] });
+	const audioProducerA = await transportA.produce(audioProducerParameters);
+
+	expect(audioProducerA.relayPath).toEqual([]);
+
+	const { pipeProducer: pipeProducerB } = await routerA.pipeToRouter(
+		{
+			producerId : audioProducerA.id,
+			router     : routerB
+		});
+
+	expect(pipeProducerB.relayPath).toEqual([ routerA.id ]);
+
+	const { pipeProducer: pipeProducerC } = await routerB.pipeToRouter(
+		{
+			producerId : pipeProducerB.id,
+			router     : routerC
+		});
+
+	expect(pipeProducerC.relayPath).toEqual([ routerA.id, routerB.id ]);
+
+	const dump = await pipeProducerC.dump();
+
+	expect(dump.relayPath).toEqual([ routerA.id, routerB.id ]);
+
+	await expect(routerC.pipeToRouter(
+		{
+			producerId : pipeProducerC.id,
+			router     : routerA
+		}))
+		.rejects
+		.toThrow(/relay loop/);
+
+	routerA.close();
+	routerB.close();
+	routerC.close();
+}, 2000);
+
 test('router.pipeToRouter() called twice generates a single PipeTransport pair', async () =>
 {
 	const routerA = await worker.createRouter({ mediaCodecs });
@@ -418,6 +418,44 @@ test('router.createPlainTransport() with fixed port succeeds', async () =>
 	plainTransport.close();
 }, 2000);
 
+test('router.createPlainTransport() with sharedPort succeeds', async () =>
+{
+	const transport1 = await router.createPlainTransport(
+		{
+			listenIp   : '127.0.0.1',
+			comedia    : true,
+			sharedPort : true
+		});
+	const transport2 = await router.createPlainTransport(
+		{
+			listenIp   : '127.0.0.1',
+			sharedPort : true
+		});
+
+	expect(transport2.tuple.localPort).toBe(transport1.tuple.localPort);
+
+	await expect(transport2.connect({ ip: '127.0.0.2', port: 9999 }))
+		.resolves
+		.toBeUndefined();
+
+	const data1 = await transport1.dump();
+
+	expect(data1.sharedPort).toBe(true);
+
+	// sharedPort requires rtcpMux.
+	await expect(router.createPlainTransport(
+		{
+			listenIp   : '127.0.0.1',
+			rtcpMux    : false,
+			sharedPort : true
+		}))
+		.rejects
+		.toThrow(TypeError);
+
+	transport1.close();
+	transport2.close();
+}, 2000);
+
 test('PlainTransport emits "routerclose" if Router is closed', async () =>
 {
 	// We need different Router and PlainTransport instances here.
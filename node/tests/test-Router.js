@@ -63,7 +63,7 @@ test('worker.createRouter() succeeds', async () =>
 
 	await expect(worker.dump())
 		.resolves
-		.toEqual({ pid: worker.pid, routerIds: [ router.id ] });
+		.toMatchObject({ pid: worker.pid, routerIds: [ router.id ] });
 
 	await expect(router.dump())
 		.resolves
@@ -130,6 +130,34 @@ test('router.close() succeeds', async () =>
 	expect(router.closed).toBe(true);
 }, 2000);
 
+test('router.closeTransports() succeeds', async () =>
+{
+	worker = await createWorker();
+
+	const router = await worker.createRouter({ mediaCodecs });
+	const transport1 = await router.createDirectTransport();
+	const transport2 = await router.createDirectTransport();
+	const transport3 = await router.createDirectTransport();
+	const producer = await transport1.produceData();
+	const consumer2 = await transport2.consumeData({ dataProducerId: producer.id });
+	const consumer3 = await transport3.consumeData({ dataProducerId: producer.id });
+
+	await router.closeTransports([ transport1, transport2 ]);
+
+	expect(transport1.closed).toBe(true);
+	expect(transport2.closed).toBe(true);
+	expect(transport3.closed).toBe(false);
+	expect(consumer2.closed).toBe(true);
+
+	await new Promise((resolve) => consumer3.on('dataproducerclose', resolve));
+
+	expect(consumer3.closed).toBe(true);
+
+	const dump = await router.dump();
+
+	expect(dump.transportIds).toEqual([ transport3.id ]);
+}, 2000);
+
 test('Router emits "workerclose" if Worker is closed', async () =>
 {
 	worker = await createWorker();
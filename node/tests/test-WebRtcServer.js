@@ -0,0 +1,290 @@
+const os = require('os');
+const { toBeType } = require('jest-tobetype');
+const pickPort = require('pick-port');
+const mediasoup = require('../lib/');
+const { createWorker } = mediasoup;
+
+expect.extend({ toBeType });
+
+let worker;
+
+beforeEach(() => worker && !worker.closed && worker.close());
+afterEach(() => worker && !worker.closed && worker.close());
+
+test('worker.createWebRtcServer() succeeds', async () =>
+{
+	worker = await createWorker();
+
+	const onObserverNewWebRtcServer = jest.fn();
+
+	worker.observer.once('newwebrtcserver', onObserverNewWebRtcServer);
+
+	const port1 = await pickPort({ ip: '127.0.0.1', reserveTimeout: 0 });
+	const port2 = await pickPort({ type: 'tcp', ip: '127.0.0.1', reserveTimeout: 0 });
+
+	const webRtcServer = await worker.createWebRtcServer(
+		{
+			listenInfos :
+			[
+				{ protocol: 'udp', ip: '127.0.0.1', port: port1 },
+				{ protocol: 'tcp', ip: '127.0.0.1', announcedIp: '1.2.3.4', port: port2 }
+			],
+			appData : { foo: 123 }
+		});
+
+	expect(onObserverNewWebRtcServer).toHaveBeenCalledTimes(1);
+	expect(onObserverNewWebRtcServer).toHaveBeenCalledWith(webRtcServer);
+	expect(webRtcServer.id).toBeType('string');
+	expect(webRtcServer.closed).toBe(false);
+	expect(webRtcServer.appData).toEqual({ foo: 123 });
+
+	await expect(worker.dump())
+		.resolves
+		.toMatchObject({ webRtcServerIds: [ webRtcServer.id ] });
+
+	await expect(webRtcServer.dump())
+		.resolves
+		.toEqual(
+			{
+				id                        : webRtcServer.id,
+				udpSockets                : [ { ip: '127.0.0.1', port: port1 } ],
+				tcpServers                : [ { ip: '127.0.0.1', port: port2 } ],
+				webRtcTransportIds        : [],
+				localIceUsernameFragments : [],
+				tupleHashes               : []
+			});
+
+	// API not exposed in the interface.
+	expect(worker.webRtcServersForTesting.size).toBe(1);
+
+	worker.close();
+
+	expect(webRtcServer.closed).toBe(true);
+
+	// API not exposed in the interface.
+	expect(worker.webRtcServersForTesting.size).toBe(0);
+}, 2000);
+
+test('worker.createWebRtcServer() with wrong arguments rejects with TypeError', async () =>
+{
+	worker = await createWorker();
+
+	await expect(worker.createWebRtcServer({}))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(worker.createWebRtcServer({ listenInfos: [] }))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(worker.createWebRtcServer(
+		{
+			listenInfos : [ { protocol: 'foo', ip: '127.0.0.1' } ]
+		}))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(worker.createWebRtcServer(
+		{
+			listenInfos : [ { protocol: 'udp', ip: '127.0.0.1' } ],
+			appData     : 'NOT-AN-OBJECT'
+		}))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(worker.createWebRtcServer(
+		{
+			listenInfos    : [ { protocol: 'udp', ip: '127.0.0.1', port: 12345 } ],
+			reusePortIndex : 36
+		}))
+		.rejects
+		.toThrow(TypeError);
+
+	// reusePortIndex requires port.
+	await expect(worker.createWebRtcServer(
+		{
+			listenInfos    : [ { protocol: 'udp', ip: '127.0.0.1' } ],
+			reusePortIndex : 0
+		}))
+		.rejects
+		.toThrow(TypeError);
+
+	worker.close();
+}, 2000);
+
+test('worker.createWebRtcServer() with reusePortIndex shares the UDP port across workers', async () =>
+{
+	if (os.platform() !== 'linux')
+		return;
+
+	worker = await createWorker();
+
+	const worker2 = await createWorker();
+	const port = await pickPort({ ip: '127.0.0.1', reserveTimeout: 0 });
+
+	const webRtcServer1 = await worker.createWebRtcServer(
+		{
+			listenInfos    : [ { protocol: 'udp', ip: '127.0.0.1', port } ],
+			reusePortIndex : 0
+		});
+
+	const webRtcServer2 = await worker2.createWebRtcServer(
+		{
+			listenInfos    : [ { protocol: 'udp', ip: '127.0.0.1', port } ],
+			reusePortIndex : 1
+		});
+
+	await expect(webRtcServer2.dump())
+		.resolves
+		.toMatchObject(
+			{
+				udpSockets          : [ { ip: '127.0.0.1', port } ],
+				reusePortIndex      : 1,
+				connectedUdpSockets : 0
+			});
+
+	const router1 = await worker.createRouter();
+	const router2 = await worker2.createRouter();
+	const transport1 =
+		await router1.createWebRtcTransport({ webRtcServer: webRtcServer1 });
+	const transport2 =
+		await router2.createWebRtcTransport({ webRtcServer: webRtcServer2 });
+
+	// The ICE usernameFragment tells the kernel which worker handles it.
+	expect(transport1.iceParameters.usernameFragment.startsWith('0')).toBe(true);
+	expect(transport2.iceParameters.usernameFragment.startsWith('1')).toBe(true);
+	expect(transport2.iceParameters.usernameFragment.length).toBe(16);
+
+	worker2.close();
+	worker.close();
+}, 2000);
+
+test('router.createWebRtcTransport() with webRtcServer succeeds and transport is closed', async () =>
+{
+	worker = await createWorker();
+
+	const port1 = await pickPort({ ip: '127.0.0.1', reserveTimeout: 0 });
+	const port2 = await pickPort({ type: 'tcp', ip: '127.0.0.1', reserveTimeout: 0 });
+
+	const webRtcServer = await worker.createWebRtcServer(
+		{
+			listenInfos :
+			[
+				{ protocol: 'udp', ip: '127.0.0.1', port: port1 },
+				{ protocol: 'tcp', ip: '127.0.0.1', announcedIp: '1.2.3.4', port: port2 }
+			]
+		});
+
+	const onObserverWebRtcTransportHandled = jest.fn();
+	const onObserverWebRtcTransportUnhandled = jest.fn();
+
+	webRtcServer.observer.once('webrtctransporthandled', onObserverWebRtcTransportHandled);
+	webRtcServer.observer.once('webrtctransportunhandled', onObserverWebRtcTransportUnhandled);
+
+	const router = await worker.createRouter();
+	const transport = await router.createWebRtcTransport(
+		{
+			webRtcServer,
+			enableUdp : true,
+			enableTcp : true,
+			preferTcp : true
+		});
+
+	expect(onObserverWebRtcTransportHandled).toHaveBeenCalledTimes(1);
+	expect(onObserverWebRtcTransportHandled).toHaveBeenCalledWith(transport);
+
+	await expect(router.dump())
+		.resolves
+		.toMatchObject({ transportIds: [ transport.id ] });
+
+	const iceCandidates = transport.iceCandidates;
+
+	expect(iceCandidates.length).toBe(2);
+	expect(iceCandidates[0].ip).toBe('127.0.0.1');
+	expect(iceCandidates[0].protocol).toBe('udp');
+	expect(iceCandidates[0].port).toBe(port1);
+	expect(iceCandidates[1].ip).toBe('1.2.3.4');
+	expect(iceCandidates[1].protocol).toBe('tcp');
+	expect(iceCandidates[1].port).toBe(port2);
+	expect(iceCandidates[1].tcpType).toBe('passive');
+	expect(iceCandidates[0].priority).toBeLessThan(iceCandidates[1].priority);
+
+	await expect(webRtcServer.dump())
+		.resolves
+		.toMatchObject(
+			{
+				webRtcTransportIds        : [ transport.id ],
+				localIceUsernameFragments :
+				[
+					{
+						localIceUsernameFragment : transport.iceParameters.usernameFragment,
+						webRtcTransportId        : transport.id
+					}
+				],
+				tupleHashes : []
+			});
+
+	transport.close();
+
+	expect(onObserverWebRtcTransportUnhandled).toHaveBeenCalledTimes(1);
+	expect(onObserverWebRtcTransportUnhandled).toHaveBeenCalledWith(transport);
+
+	await expect(webRtcServer.dump())
+		.resolves
+		.toMatchObject(
+			{
+				webRtcTransportIds        : [],
+				localIceUsernameFragments : []
+			});
+}, 2000);
+
+test('router.createWebRtcTransport() with webRtcServer and listenIps rejects with TypeError', async () =>
+{
+	worker = await createWorker();
+
+	const webRtcServer = await worker.createWebRtcServer(
+		{
+			listenInfos : [ { protocol: 'udp', ip: '127.0.0.1' } ]
+		});
+
+	const router = await worker.createRouter();
+
+	await expect(router.createWebRtcTransport(
+		{
+			webRtcServer,
+			listenIps : [ '127.0.0.1' ]
+		}))
+		.rejects
+		.toThrow(TypeError);
+}, 2000);
+
+test('closing a WebRtcServer closes its WebRtcTransports', async () =>
+{
+	worker = await createWorker();
+
+	const webRtcServer = await worker.createWebRtcServer(
+		{
+			listenInfos : [ { protocol: 'udp', ip: '127.0.0.1' } ]
+		});
+
+	const router = await worker.createRouter();
+	const transport = await router.createWebRtcTransport({ webRtcServer });
+	const onListenServerClose = jest.fn();
+
+	transport.on('listenserverclose', onListenServerClose);
+
+	webRtcServer.close();
+
+	expect(webRtcServer.closed).toBe(true);
+	expect(onListenServerClose).toHaveBeenCalledTimes(1);
+	expect(transport.closed).toBe(true);
+	expect(transport.iceState).toBe('closed');
+
+	await expect(router.dump())
+		.resolves
+		.toMatchObject({ transportIds: [] });
+
+	await expect(worker.dump())
+		.resolves
+		.toMatchObject({ webRtcServerIds: [] });
+}, 2000);
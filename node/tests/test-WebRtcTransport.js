@@ -245,6 +245,7 @@ test('webRtcTransport.getStats() succeeds', async () =>
 	expect(data[0].probationBytesSent).toBe(0);
 	expect(data[0].probationSendBitrate).toBe(0);
 	expect(data[0].iceSelectedTuple).toBeUndefined();
+	expect(data[0].iceTupleCount).toBe(0);
 	expect(data[0].maxIncomingBitrate).toBeUndefined();
 }, 2000);
 
@@ -1,3 +1,4 @@
+const fs = require('fs');
 const os = require('os');
 const process = require('process');
 const path = require('path');
@@ -79,11 +80,100 @@ test('createWorker() with wrong settings rejects with TypeError', async () =>
 		.rejects
 		.toThrow(TypeError);
 
+	await expect(createWorker({ dtlsCertificateCacheDir: '/notfound' }))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(createWorker({ channelMessageFormat: 'xml' }))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(createWorker({ cpuAffinity: -1 }))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(createWorker({ srtpEncryptThreads: 17 }))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(createWorker({ srtpDecryptThreads: 17 }))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(createWorker({ dtlsHandshakeThreads: -1 }))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(createWorker({ helperCpuAffinity: [ 0, -1 ] }))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(createWorker({ realtimePriority: 100 }))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(createWorker({ niceness: 20 }))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(createWorker({ packetIo: 'af_xdp' }))
+		.rejects
+		.toThrow(TypeError);
+
+	await expect(createWorker({ logRateLimit: -1 }))
+		.rejects
+		.toThrow(TypeError);
+
 	await expect(createWorker({ appData: 'NOT-AN-OBJECT' }))
 		.rejects
 		.toThrow(TypeError);
 }, 2000);
 
+test('createWorker() with msgpack channelMessageFormat succeeds', async () =>
+{
+	worker = await createWorker({ channelMessageFormat: 'msgpack' });
+
+	await expect(worker.dump())
+		.resolves
+		.toMatchObject({ pid: worker.pid, routerIds: [] });
+
+	const router = await worker.createRouter({ appData: { foo: 'bar' } });
+
+	await expect(router.dump())
+		.resolves
+		.toMatchObject({ id: router.id, transportIds: [] });
+
+	worker.close();
+}, 2000);
+
+test('createWorker() with dtlsCertificateCacheDir reuses the DTLS certificate', async () =>
+{
+	const dtlsCertificateCacheDir =
+		fs.mkdtempSync(path.join(os.tmpdir(), 'mediasoup-test-'));
+	const fingerprints = [];
+
+	for (let i = 0; i < 2; ++i)
+	{
+		worker = await createWorker({ dtlsCertificateCacheDir });
+
+		const router = await worker.createRouter();
+		const transport = await router.createWebRtcTransport(
+			{
+				listenIps : [ '127.0.0.1' ]
+			});
+
+		fingerprints.push(transport.dtlsParameters.fingerprints);
+
+		worker.close();
+	}
+
+	expect(fs.existsSync(path.join(dtlsCertificateCacheDir, 'mediasoup-dtls.pem')))
+		.toBe(true);
+	expect(fingerprints[1]).toEqual(fingerprints[0]);
+
+	fs.rmSync(dtlsCertificateCacheDir, { recursive: true, force: true });
+}, 4000);
+
 test('worker.updateSettings() succeeds', async () =>
 {
 	worker = await createWorker();
@@ -124,7 +214,72 @@ test('worker.dump() succeeds', async () =>
 
 	await expect(worker.dump())
 		.resolves
-		.toEqual({ pid: worker.pid, routerIds: [] });
+		.toEqual(
+			{
+				pid             : worker.pid,
+				webRtcServerIds : [],
+				routerIds       : [],
+				udpRecvBatching : { batches: 0, datagrams: 0, averageBatchSize: 0 },
+				udpSendBatching : { batches: 0, datagrams: 0, averageBatchSize: 0 },
+				objectPool      : { hits: 0, misses: 0, cachedBlocks: 0 },
+				placement       : expect.any(Object),
+				packetIo        : { backend: 'libuv' }
+			});
+
+	worker.close();
+}, 2000);
+
+test('worker.dump() reports the thread placement', async () =>
+{
+	worker = await createWorker(
+		{
+			cpuAffinity          : 0,
+			helperCpuAffinity    : [ 0 ],
+			srtpEncryptThreads   : 1,
+			srtpDecryptThreads   : 1,
+			dtlsHandshakeThreads : 1,
+			niceness             : 1
+		});
+
+	const { placement } = await worker.dump();
+
+	if (os.platform() === 'linux')
+	{
+		expect(placement).toMatchObject(
+			{
+				cpu               : 0,
+				cpuAffinity       : [ 0 ],
+				helperCpuAffinity : [ 0, 0, 0 ],
+				schedPolicy       : 'other',
+				niceness          : 1
+			});
+	}
+
+	worker.close();
+}, 2000);
+
+test('worker.dump() reports the packet I/O backend', async () =>
+{
+	worker = await createWorker({ packetIo: 'io_uring' });
+
+	const router = await worker.createRouter();
+
+	await router.createPlainTransport({ listenIp: '127.0.0.1' });
+
+	const { packetIo } = await worker.dump();
+
+	// It falls back to libuv if io_uring is not available.
+	expect([ 'io_uring', 'libuv' ]).toContain(packetIo.backend);
+
+	if (packetIo.backend === 'io_uring')
+	{
+		expect(packetIo).toMatchObject(
+			{
+				sqPoll      : false,
+				recvSockets : 1
+			});
+		expect(typeof packetIo.submitCalls).toBe('number');
+	}
 
 	worker.close();
 }, 2000);
@@ -152,6 +307,37 @@ test('worker.getResourceUsage() succeeds', async () =>
 	worker.close();
 }, 2000);
 
+test('worker.enableStateStream() emits "state"', async () =>
+{
+	worker = await createWorker();
+
+	const router = await worker.createRouter();
+
+	await router.createWebRtcTransport({ listenIps: [ '127.0.0.1' ] });
+
+	const statePromise = new Promise((resolve) =>
+	{
+		worker.once('state', (data, payload) => resolve({ data, payload }));
+	});
+
+	await worker.enableStateStream({ interval: 1000 });
+
+	const { data, payload } = await statePromise;
+
+	expect(data.routerId).toBe(router.id);
+	expect(data.seq).toBe(1);
+	expect(Buffer.isBuffer(payload)).toBe(true);
+	expect(payload.length).toBeGreaterThan(0);
+
+	await expect(worker.enableStateStream({ interval: 10 }))
+		.rejects
+		.toThrow(TypeError);
+
+	await worker.enableStateStream({ interval: 0 });
+
+	worker.close();
+}, 2000);
+
 test('worker.close() succeeds', async () =>
 {
 	worker = await createWorker({ logLevel: 'warn' });
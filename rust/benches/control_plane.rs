@@ -0,0 +1,157 @@
+use criterion::{criterion_group, criterion_main, Criterion};
+use mediasoup::prelude::*;
+use mediasoup::rtp_parameters::{
+    RtcpParameters, RtpCodecParameters, RtpEncodingParameters, RtpHeaderExtension,
+    RtpHeaderExtensionDirection, RtpHeaderExtensionParameters, RtpHeaderExtensionUri,
+};
+use std::num::{NonZeroU32, NonZeroU8};
+
+fn media_codecs() -> Vec<RtpCodecCapability> {
+    vec![RtpCodecCapability::Audio {
+        mime_type: MimeTypeAudio::Opus,
+        preferred_payload_type: None,
+        clock_rate: NonZeroU32::new(48000).unwrap(),
+        channels: NonZeroU8::new(2).unwrap(),
+        parameters: RtpCodecParametersParameters::default(),
+        rtcp_feedback: vec![],
+    }]
+}
+
+fn audio_producer_options() -> ProducerOptions {
+    ProducerOptions::new(
+        MediaKind::Audio,
+        RtpParameters {
+            mid: Some("AUDIO".to_string()),
+            codecs: vec![RtpCodecParameters::Audio {
+                mime_type: MimeTypeAudio::Opus,
+                payload_type: 111,
+                clock_rate: NonZeroU32::new(48000).unwrap(),
+                channels: NonZeroU8::new(2).unwrap(),
+                parameters: RtpCodecParametersParameters::default(),
+                rtcp_feedback: vec![],
+            }],
+            header_extensions: vec![RtpHeaderExtensionParameters {
+                uri: RtpHeaderExtensionUri::Mid,
+                id: 10,
+                encrypt: false,
+            }],
+            encodings: vec![RtpEncodingParameters {
+                ssrc: Some(11111111),
+                ..RtpEncodingParameters::default()
+            }],
+            rtcp: RtcpParameters {
+                cname: Some("FOOBAR".to_string()),
+                ..RtcpParameters::default()
+            },
+        },
+    )
+}
+
+fn consumer_device_capabilities() -> RtpCapabilities {
+    RtpCapabilities {
+        codecs: vec![RtpCodecCapability::Audio {
+            mime_type: MimeTypeAudio::Opus,
+            preferred_payload_type: Some(100),
+            clock_rate: NonZeroU32::new(48000).unwrap(),
+            channels: NonZeroU8::new(2).unwrap(),
+            parameters: RtpCodecParametersParameters::default(),
+            rtcp_feedback: vec![],
+        }],
+        header_extensions: vec![RtpHeaderExtension {
+            kind: MediaKind::Audio,
+            uri: RtpHeaderExtensionUri::Mid,
+            preferred_id: 1,
+            preferred_encrypt: false,
+            direction: RtpHeaderExtensionDirection::default(),
+        }],
+    }
+}
+
+fn webrtc_transport_options() -> WebRtcTransportOptions {
+    WebRtcTransportOptions::new(TransportListenIps::new(TransportListenIp {
+        ip: "127.0.0.1".parse().unwrap(),
+        announced_ip: None,
+    }))
+}
+
+async fn init() -> Result<(Worker, Router), Box<dyn std::error::Error>> {
+    let worker_manager = WorkerManager::new();
+    let worker = worker_manager
+        .create_worker(WorkerSettings::default())
+        .await?;
+
+    let router = worker
+        .create_router(RouterOptions::new(media_codecs()))
+        .await?;
+
+    Ok((worker, router))
+}
+
+// Requests sent through the Channel, each one awaited before sending the next, so the figures are
+// requests/sec of a single Router.
+pub fn criterion_benchmark(c: &mut Criterion) {
+    let mut group = c.benchmark_group("control_plane");
+
+    let (_worker, router) = futures_lite::future::block_on(async { init().await.unwrap() });
+
+    // NOTE: Transports and consumers are dropped (and hence closed) out of the measurement.
+    group.bench_function("create_webrtc_transport", |b| {
+        b.iter_with_large_drop(|| {
+            futures_lite::future::block_on(async {
+                router
+                    .create_webrtc_transport(webrtc_transport_options())
+                    .await
+                    .unwrap()
+            })
+        })
+    });
+
+    let (transport, producer, consumer) = futures_lite::future::block_on(async {
+        let transport = router
+            .create_webrtc_transport(webrtc_transport_options())
+            .await
+            .unwrap();
+        let producer = transport.produce(audio_producer_options()).await.unwrap();
+        let consumer = transport
+            .consume(ConsumerOptions::new(
+                producer.id(),
+                consumer_device_capabilities(),
+            ))
+            .await
+            .unwrap();
+
+        (transport, producer, consumer)
+    });
+
+    group.bench_function("consume", |b| {
+        b.iter_with_large_drop(|| {
+            futures_lite::future::block_on(async {
+                transport
+                    .consume(ConsumerOptions::new(
+                        producer.id(),
+                        consumer_device_capabilities(),
+                    ))
+                    .await
+                    .unwrap()
+            })
+        })
+    });
+
+    group.bench_function("pause_resume", |b| {
+        b.iter(|| {
+            futures_lite::future::block_on(async {
+                consumer.pause().await.unwrap();
+                consumer.resume().await.unwrap();
+            })
+        })
+    });
+
+    group.bench_function("get_stats", |b| {
+        b.iter(|| futures_lite::future::block_on(async { consumer.get_stats().await.unwrap() }))
+    });
+
+    group.finish();
+}
+
+criterion_group!(benches, criterion_benchmark);
+criterion_main!(benches);
@@ -0,0 +1,192 @@
+use criterion::{criterion_group, criterion_main, Criterion, Throughput};
+use mediasoup::consumer::ConsumerTraceEventType;
+use mediasoup::prelude::*;
+use mediasoup::producer::DirectProducer;
+use mediasoup::rtp_parameters::{RtcpParameters, RtpCodecParameters, RtpEncodingParameters};
+use std::num::{NonZeroU32, NonZeroU8};
+use std::sync::mpsc;
+
+const SSRC: u32 = 11111111;
+const PAYLOAD_TYPE: u8 = 111;
+const PAYLOAD_SIZE: usize = 160;
+// Packets sent in every iteration, all of them awaited before the next iteration.
+const BATCH_SIZE: usize = 100;
+
+fn media_codecs() -> Vec<RtpCodecCapability> {
+    vec![RtpCodecCapability::Audio {
+        mime_type: MimeTypeAudio::Opus,
+        preferred_payload_type: None,
+        clock_rate: NonZeroU32::new(48000).unwrap(),
+        channels: NonZeroU8::new(2).unwrap(),
+        parameters: RtpCodecParametersParameters::default(),
+        rtcp_feedback: vec![],
+    }]
+}
+
+fn audio_producer_options() -> ProducerOptions {
+    ProducerOptions::new(
+        MediaKind::Audio,
+        RtpParameters {
+            mid: None,
+            codecs: vec![RtpCodecParameters::Audio {
+                mime_type: MimeTypeAudio::Opus,
+                payload_type: PAYLOAD_TYPE,
+                clock_rate: NonZeroU32::new(48000).unwrap(),
+                channels: NonZeroU8::new(2).unwrap(),
+                parameters: RtpCodecParametersParameters::default(),
+                rtcp_feedback: vec![],
+            }],
+            header_extensions: vec![],
+            encodings: vec![RtpEncodingParameters {
+                ssrc: Some(SSRC),
+                ..RtpEncodingParameters::default()
+            }],
+            rtcp: RtcpParameters {
+                cname: Some("FOOBAR".to_string()),
+                ..RtcpParameters::default()
+            },
+        },
+    )
+}
+
+fn consumer_device_capabilities() -> RtpCapabilities {
+    RtpCapabilities {
+        codecs: vec![RtpCodecCapability::Audio {
+            mime_type: MimeTypeAudio::Opus,
+            preferred_payload_type: Some(100),
+            clock_rate: NonZeroU32::new(48000).unwrap(),
+            channels: NonZeroU8::new(2).unwrap(),
+            parameters: RtpCodecParametersParameters::default(),
+            rtcp_feedback: vec![],
+        }],
+        header_extensions: vec![],
+    }
+}
+
+async fn create_producer_consumer_pair(
+) -> Result<(Worker, DirectProducer, Consumer), Box<dyn std::error::Error>> {
+    let worker_manager = WorkerManager::new();
+    let worker = worker_manager
+        .create_worker(WorkerSettings::default())
+        .await?;
+
+    let router = worker
+        .create_router(RouterOptions::new(media_codecs()))
+        .await?;
+    let direct_transport = router
+        .create_direct_transport(DirectTransportOptions::default())
+        .await?;
+
+    let producer = direct_transport.produce(audio_producer_options()).await?;
+    let consumer = direct_transport
+        .consume(ConsumerOptions::new(
+            producer.id(),
+            consumer_device_capabilities(),
+        ))
+        .await?;
+
+    let direct_producer = if let Producer::Direct(direct_producer) = producer {
+        direct_producer
+    } else {
+        unreachable!()
+    };
+
+    Ok((worker, direct_producer, consumer))
+}
+
+// Consecutive Opus packets of the producer's stream.
+struct RtpPacketGenerator {
+    seq: u16,
+    timestamp: u32,
+    payload: Vec<u8>,
+}
+
+impl RtpPacketGenerator {
+    fn new() -> Self {
+        Self {
+            seq: 0,
+            timestamp: 0,
+            payload: std::iter::repeat_with(|| fastrand::u8(..))
+                .take(PAYLOAD_SIZE)
+                .collect(),
+        }
+    }
+
+    fn next_packet(&mut self) -> Vec<u8> {
+        // Enough capacity for the worker to parse the packet in place.
+        let mut packet = Vec::with_capacity(1600);
+
+        packet.extend_from_slice(&[0b1000_0000, PAYLOAD_TYPE]);
+        packet.extend_from_slice(&self.seq.to_be_bytes());
+        packet.extend_from_slice(&self.timestamp.to_be_bytes());
+        packet.extend_from_slice(&SSRC.to_be_bytes());
+        packet.extend_from_slice(&self.payload);
+
+        self.seq = self.seq.wrapping_add(1);
+        self.timestamp = self.timestamp.wrapping_add(960);
+
+        packet
+    }
+}
+
+pub fn criterion_benchmark(c: &mut Criterion) {
+    let mut group = c.benchmark_group("direct_rtp");
+
+    group.throughput(Throughput::Elements(BATCH_SIZE as u64));
+
+    let (_worker, direct_producer, consumer) =
+        futures_lite::future::block_on(async { create_producer_consumer_pair().await.unwrap() });
+    let mut generator = RtpPacketGenerator::new();
+
+    // RTP packets sent and received through the PayloadChannel.
+    {
+        let (sender, receiver) = mpsc::sync_channel(BATCH_SIZE);
+        let _handler_id = consumer.on_rtp(move |_packet| {
+            let _ = sender.send(());
+        });
+
+        group.bench_function("send_recv", |b| {
+            b.iter(|| {
+                for _ in 0..BATCH_SIZE {
+                    direct_producer.send(generator.next_packet()).unwrap();
+                }
+
+                for _ in 0..BATCH_SIZE {
+                    receiver.recv().unwrap();
+                }
+            })
+        });
+    }
+
+    // A "trace" notification per RTP packet sent through the Channel.
+    {
+        futures_lite::future::block_on(async {
+            consumer
+                .enable_trace_event(vec![ConsumerTraceEventType::Rtp])
+                .await
+                .unwrap();
+        });
+
+        let (sender, receiver) = mpsc::sync_channel(BATCH_SIZE);
+        let _handler_id = consumer.on_trace(move |_trace_event_data| {
+            let _ = sender.send(());
+        });
+
+        group.bench_function("notifications", |b| {
+            b.iter(|| {
+                for _ in 0..BATCH_SIZE {
+                    direct_producer.send(generator.next_packet()).unwrap();
+                }
+
+                for _ in 0..BATCH_SIZE {
+                    receiver.recv().unwrap();
+                }
+            })
+        });
+    }
+
+    group.finish();
+}
+
+criterion_group!(benches, criterion_benchmark);
+criterion_main!(benches);
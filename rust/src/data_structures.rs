@@ -234,6 +234,96 @@ impl TransportTuple {
     }
 }
 
+/// Stats of the UDP socket of a transport.
+#[derive(Debug, Copy, Clone, Ord, PartialOrd, Eq, PartialEq, Hash, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[non_exhaustive]
+pub struct TransportUdpSocketStat {
+    /// Received bytes.
+    pub recv_bytes: usize,
+    /// Sent bytes.
+    pub sent_bytes: usize,
+    /// Size of the kernel receive buffer (Linux reports twice the requested one).
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub recv_buffer_size: Option<u32>,
+    /// Size of the kernel send buffer (Linux reports twice the requested one).
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub send_buffer_size: Option<u32>,
+    /// Datagrams dropped by the kernel because the receive buffer was full (Linux >= 4.6 only).
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub recv_drops: Option<u32>,
+}
+
+/// Stats of the TCP connection of a transport.
+#[derive(Debug, Copy, Clone, Ord, PartialOrd, Eq, PartialEq, Hash, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[non_exhaustive]
+pub struct TransportTcpConnectionStat {
+    /// Received bytes.
+    pub recv_bytes: usize,
+    /// Sent bytes.
+    pub sent_bytes: usize,
+    /// Bytes waiting to be written into the kernel.
+    pub write_queue_size: usize,
+    /// RTP packets dropped because they waited too long to be written.
+    pub dropped_media_packets: usize,
+    /// Bytes of RTP packets dropped because they waited too long to be written.
+    pub dropped_media_bytes: usize,
+}
+
+/// Limits of the packets received by a WebRTC or plain transport, applied before parsing or
+/// decrypting them. Packets over them are dropped.
+#[derive(Debug, Copy, Clone, Ord, PartialOrd, Eq, PartialEq, Hash, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+pub struct TransportIngressPolicer {
+    /// Max bitrate (in bps) received by the transport. 0 means unlimited.
+    /// Default 0.
+    pub bitrate: u32,
+    /// Max bitrate (in bps) received from each remote tuple. 0 means unlimited.
+    /// Default 0.
+    pub tuple_bitrate: u32,
+    /// Duration (in ms) of the bursts allowed over the bitrates.
+    /// Default 500.
+    pub burst_ms: u32,
+}
+
+impl Default for TransportIngressPolicer {
+    fn default() -> Self {
+        Self {
+            bitrate: 0,
+            tuple_bitrate: 0,
+            burst_ms: 500,
+        }
+    }
+}
+
+/// Packets (and bytes) received by a transport and dropped for a reason before parsing them.
+#[derive(Debug, Copy, Clone, Ord, PartialOrd, Eq, PartialEq, Hash, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[non_exhaustive]
+pub struct TransportIngressDropCounter {
+    /// Dropped packets.
+    pub packets: u64,
+    /// Dropped bytes.
+    pub bytes: u64,
+}
+
+/// Packets received by a transport and dropped before parsing them.
+#[derive(Debug, Copy, Clone, Ord, PartialOrd, Eq, PartialEq, Hash, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[non_exhaustive]
+pub struct TransportIngressDrops {
+    /// Over [`TransportIngressPolicer::bitrate`].
+    pub transport_bitrate: TransportIngressDropCounter,
+    /// Over [`TransportIngressPolicer::tuple_bitrate`].
+    pub tuple_bitrate: TransportIngressDropCounter,
+    /// Coming from a tuple not validated by ICE (or other than the connected one in a plain
+    /// transport).
+    pub unknown_tuple: TransportIngressDropCounter,
+    /// STUN packets over the rate allowed from a tuple not validated by ICE.
+    pub stun_rate: TransportIngressDropCounter,
+}
+
 /// DTLS state.
 #[derive(Debug, Copy, Clone, Ord, PartialOrd, Eq, PartialEq, Hash, Deserialize, Serialize)]
 #[serde(rename_all = "camelCase")]
@@ -1,18 +1,21 @@
 use crate::active_speaker_observer::ActiveSpeakerObserverOptions;
 use crate::audio_level_observer::AudioLevelObserverOptions;
 use crate::consumer::{
-    ConsumerDump, ConsumerId, ConsumerLayers, ConsumerScore, ConsumerStats, ConsumerTraceEventType,
-    ConsumerType,
+    ConsumerDump, ConsumerId, ConsumerLayers, ConsumerScore, ConsumerSendState, ConsumerStats,
+    ConsumerTraceEventType, ConsumerType,
+};
+use crate::data_consumer::{
+    DataConsumerDump, DataConsumerId, DataConsumerQueueDropPolicy, DataConsumerStat,
+    DataConsumerType,
 };
-use crate::data_consumer::{DataConsumerDump, DataConsumerId, DataConsumerStat, DataConsumerType};
 use crate::data_producer::{DataProducerDump, DataProducerId, DataProducerStat, DataProducerType};
 use crate::data_structures::{
     DtlsParameters, DtlsRole, DtlsState, IceCandidate, IceParameters, IceRole, IceState, SctpState,
-    TransportListenIp, TransportTuple,
+    TransportIngressPolicer, TransportListenIp, TransportTuple,
 };
 use crate::direct_transport::DirectTransportOptions;
 use crate::ortc::RtpMapping;
-use crate::pipe_transport::PipeTransportOptions;
+use crate::pipe_transport::{PipeTransportOptions, PipeTransportTcpRole};
 use crate::plain_transport::PlainTransportOptions;
 use crate::producer::{
     ProducerDump, ProducerId, ProducerStat, ProducerTraceEventType, ProducerType,
@@ -191,13 +194,34 @@ request_response!(
     },
 );
 
+request_response!(
+    "worker.enableStateStream",
+    WorkerEnableStateStreamRequest {
+        data: WorkerEnableStateStreamData,
+    },
+);
+
+#[derive(Debug, Serialize)]
+pub(crate) struct WorkerEnableStateStreamData {
+    pub(crate) interval: u32,
+}
+
 request_response!(
     "worker.createRouter",
     WorkerCreateRouterRequest {
         internal: RouterInternal,
+        data: WorkerCreateRouterData,
     },
+    WorkerCreateRouterResponse { handle: u32 },
 );
 
+#[derive(Debug, Serialize)]
+#[serde(rename_all = "camelCase")]
+pub(crate) struct WorkerCreateRouterData {
+    pub(crate) audio_last_n: u32,
+    pub(crate) memory_soft_limit: u64,
+}
+
 request_response!(
     "router.close",
     RouterCloseRequest {
@@ -220,6 +244,8 @@ request_response!(
 pub(crate) struct RouterCreateDirectTransportData {
     pub(crate) direct: bool,
     pub(crate) max_message_size: usize,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub(crate) record_path: Option<String>,
 }
 
 impl RouterCreateDirectTransportData {
@@ -227,6 +253,7 @@ impl RouterCreateDirectTransportData {
         Self {
             direct: true,
             max_message_size: direct_transport_options.max_message_size,
+            record_path: direct_transport_options.record_path.clone(),
         }
     }
 }
@@ -255,7 +282,11 @@ pub(crate) struct RouterCreateWebrtcTransportData {
     num_sctp_streams: NumSctpStreams,
     max_sctp_message_size: u32,
     sctp_send_buffer_size: u32,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    sctp_bitrate_share: Option<f32>,
     is_data_channel: bool,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    ingress_policer: Option<TransportIngressPolicer>,
 }
 
 impl RouterCreateWebrtcTransportData {
@@ -273,7 +304,9 @@ impl RouterCreateWebrtcTransportData {
             num_sctp_streams: webrtc_transport_options.num_sctp_streams,
             max_sctp_message_size: webrtc_transport_options.max_sctp_message_size,
             sctp_send_buffer_size: webrtc_transport_options.sctp_send_buffer_size,
+            sctp_bitrate_share: webrtc_transport_options.sctp_bitrate_share,
             is_data_channel: true,
+            ingress_policer: webrtc_transport_options.ingress_policer,
         }
     }
 }
@@ -306,13 +339,23 @@ pub(crate) struct RouterCreatePlainTransportData {
     port: Option<u16>,
     rtcp_mux: bool,
     comedia: bool,
+    shared_port: bool,
     enable_sctp: bool,
     num_sctp_streams: NumSctpStreams,
     max_sctp_message_size: u32,
     sctp_send_buffer_size: u32,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    sctp_bitrate_share: Option<f32>,
     enable_srtp: bool,
     srtp_crypto_suite: SrtpCryptoSuite,
+    rtp_reorder_delay: u32,
     is_data_channel: bool,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    ingress_policer: Option<TransportIngressPolicer>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    multicast_ttl: Option<u8>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    multicast_interface: Option<IpAddr>,
 }
 
 impl RouterCreatePlainTransportData {
@@ -322,13 +365,19 @@ impl RouterCreatePlainTransportData {
             port: plain_transport_options.port,
             rtcp_mux: plain_transport_options.rtcp_mux,
             comedia: plain_transport_options.comedia,
+            shared_port: plain_transport_options.shared_port,
             enable_sctp: plain_transport_options.enable_sctp,
             num_sctp_streams: plain_transport_options.num_sctp_streams,
             max_sctp_message_size: plain_transport_options.max_sctp_message_size,
             sctp_send_buffer_size: plain_transport_options.sctp_send_buffer_size,
+            sctp_bitrate_share: plain_transport_options.sctp_bitrate_share,
             enable_srtp: plain_transport_options.enable_srtp,
             srtp_crypto_suite: plain_transport_options.srtp_crypto_suite,
+            rtp_reorder_delay: plain_transport_options.rtp_reorder_delay,
             is_data_channel: false,
+            ingress_policer: plain_transport_options.ingress_policer,
+            multicast_ttl: plain_transport_options.multicast_ttl,
+            multicast_interface: plain_transport_options.multicast_interface,
         }
     }
 }
@@ -363,6 +412,13 @@ pub(crate) struct RouterCreatePipeTransportData {
     sctp_send_buffer_size: u32,
     enable_rtx: bool,
     enable_srtp: bool,
+    in_memory: bool,
+    enable_trunk: bool,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    trunk_max_frame_size: Option<u16>,
+    enable_tcp: bool,
+    trusted_network: bool,
+    rtp_reorder_delay: u32,
     is_data_channel: bool,
 }
 
@@ -377,6 +433,12 @@ impl RouterCreatePipeTransportData {
             sctp_send_buffer_size: pipe_transport_options.sctp_send_buffer_size,
             enable_rtx: pipe_transport_options.enable_rtx,
             enable_srtp: pipe_transport_options.enable_srtp,
+            in_memory: pipe_transport_options.in_memory,
+            enable_trunk: pipe_transport_options.enable_trunk,
+            trunk_max_frame_size: pipe_transport_options.trunk_max_frame_size,
+            enable_tcp: pipe_transport_options.enable_tcp,
+            trusted_network: pipe_transport_options.trusted_network,
+            rtp_reorder_delay: pipe_transport_options.rtp_reorder_delay,
             is_data_channel: false,
         }
     }
@@ -394,6 +456,7 @@ request_response!(
         sctp_state: Mutex<Option<SctpState>>,
         rtx: bool,
         srtp_parameters: Mutex<Option<SrtpParameters>>,
+        memory_pipe_id: Option<String>,
     },
 );
 
@@ -403,6 +466,7 @@ pub(crate) struct RouterCreateAudioLevelObserverData {
     pub(crate) max_entries: NonZeroU16,
     pub(crate) threshold: i8,
     pub(crate) interval: u16,
+    pub(crate) incremental: bool,
 }
 
 impl RouterCreateAudioLevelObserverData {
@@ -411,6 +475,7 @@ impl RouterCreateAudioLevelObserverData {
             max_entries: audio_level_observer_options.max_entries,
             threshold: audio_level_observer_options.threshold,
             interval: audio_level_observer_options.interval,
+            incremental: audio_level_observer_options.incremental,
         }
     }
 }
@@ -427,6 +492,8 @@ request_response!(
 #[serde(rename_all = "camelCase")]
 pub(crate) struct RouterCreateActiveSpeakerObserverData {
     pub(crate) interval: u16,
+    pub(crate) use_simd: bool,
+    pub(crate) video_last_n: u32,
 }
 
 impl RouterCreateActiveSpeakerObserverData {
@@ -435,6 +502,8 @@ impl RouterCreateActiveSpeakerObserverData {
     ) -> Self {
         Self {
             interval: active_speaker_observer_options.interval,
+            use_simd: active_speaker_observer_options.use_simd,
+            video_last_n: active_speaker_observer_options.video_last_n,
         }
     }
 }
@@ -496,6 +565,10 @@ pub(crate) struct TransportConnectRequestPipeData {
     pub(crate) port: u16,
     #[serde(skip_serializing_if = "Option::is_none")]
     pub(crate) srtp_parameters: Option<SrtpParameters>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub(crate) memory_pipe_id: Option<String>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub(crate) tcp_role: Option<PipeTransportTcpRole>,
 }
 
 request_response!(
@@ -580,7 +653,10 @@ pub(crate) struct TransportProduceData {
     pub(crate) rtp_parameters: RtpParameters,
     pub(crate) rtp_mapping: RtpMapping,
     pub(crate) key_frame_request_delay: u32,
+    pub(crate) enable_key_frame_cache: bool,
     pub(crate) paused: bool,
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub(crate) relay_path: Vec<RouterId>,
 }
 
 request_response!(
@@ -603,6 +679,11 @@ pub(crate) struct TransportConsumeData {
     pub(crate) consumable_rtp_encodings: Vec<RtpEncodingParameters>,
     pub(crate) paused: bool,
     pub(crate) preferred_layers: Option<ConsumerLayers>,
+    pub(crate) ignore_dtx: bool,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub(crate) thumbnail_framerate: Option<f32>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub(crate) send_state: Option<ConsumerSendState>,
 }
 
 request_response!(
@@ -651,6 +732,12 @@ pub(crate) struct TransportConsumeDataData {
     pub(crate) sctp_stream_parameters: Option<SctpStreamParameters>,
     pub(crate) label: String,
     pub(crate) protocol: String,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub(crate) max_queued_messages: Option<u32>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub(crate) queue_drop_policy: Option<DataConsumerQueueDropPolicy>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub(crate) coalesce_key_length: Option<u32>,
 }
 
 request_response!(
@@ -804,6 +891,23 @@ request_response!(
     Option<ConsumerLayers>,
 );
 
+#[derive(Debug, Serialize)]
+#[serde(rename_all = "camelCase")]
+pub(crate) struct ConsumerSetLayerDemandData {
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub(crate) spatial_layer: Option<u8>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub(crate) temporal_layer: Option<u8>,
+}
+
+request_response!(
+    "consumer.setLayerDemand",
+    ConsumerSetLayerDemandRequest {
+        internal: ConsumerInternal,
+        data: ConsumerSetLayerDemandData,
+    },
+);
+
 #[derive(Debug, Serialize)]
 #[serde(rename_all = "camelCase")]
 pub(crate) struct ConsumerSetPriorityData {
@@ -826,6 +930,14 @@ request_response!(
     },
 );
 
+request_response!(
+    "consumer.exportSendState",
+    ConsumerExportSendStateRequest {
+        internal: ConsumerInternal,
+    },
+    ConsumerSendState,
+);
+
 #[derive(Debug, Serialize)]
 #[serde(rename_all = "camelCase")]
 pub(crate) struct ConsumerEnableTraceEventData {
@@ -973,6 +1085,8 @@ request_response!(
 #[serde(rename_all = "camelCase")]
 pub(crate) struct RtpObserverAddRemoveProducerRequestData {
     pub(crate) producer_id: ProducerId,
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub(crate) video_producer_ids: Vec<ProducerId>,
 }
 
 request_response!(
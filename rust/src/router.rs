@@ -41,7 +41,8 @@ use crate::messages::{
     TransportInternal,
 };
 use crate::pipe_transport::{
-    PipeTransport, PipeTransportOptions, PipeTransportRemoteParameters, WeakPipeTransport,
+    PipeTransport, PipeTransportOptions, PipeTransportRemoteParameters, PipeTransportTcpRole,
+    WeakPipeTransport,
 };
 use crate::plain_transport::{PlainTransport, PlainTransportOptions};
 use crate::producer::{PipedProducer, Producer, ProducerId, ProducerOptions, WeakProducer};
@@ -86,6 +87,14 @@ uuid_based_wrapper_type!(
 pub struct RouterOptions {
     /// Router media codecs.
     pub media_codecs: Vec<RtpCodecCapability>,
+    /// If greater than zero, audio from producers that are not among the N loudest ones (according
+    /// to the audio level RTP header extension) is not sent to consumers, except pipe consumers.
+    /// Default 0 (disabled).
+    pub audio_last_n: u32,
+    /// If greater than zero, memory (in bytes) used by the router media buffers above which the
+    /// retransmission buffers of consumers are shrunk until the usage is back below half of it.
+    /// Default 0 (no limit).
+    pub memory_soft_limit: u64,
     /// Custom application data.
     pub app_data: AppData,
 }
@@ -96,6 +105,8 @@ impl RouterOptions {
     pub fn new(media_codecs: Vec<RtpCodecCapability>) -> Self {
         Self {
             media_codecs,
+            audio_last_n: 0,
+            memory_soft_limit: 0,
             app_data: AppData::default(),
         }
     }
@@ -133,6 +144,25 @@ pub struct PipeToRouterOptions {
     ///
     /// Default `false`.
     pub enable_srtp: bool,
+    /// Exchange packets through memory instead of UDP. Only valid if both Routers belong to
+    /// workers running as threads of this same process.
+    ///
+    /// Default `false`.
+    pub in_memory: bool,
+    /// Aggregate RTP and RTCP packets into bigger frames (see
+    /// [`PipeTransportOptions::enable_trunk`]).
+    ///
+    /// Default `false`.
+    pub enable_trunk: bool,
+    /// Exchange packets over TCP instead of UDP (see [`PipeTransportOptions::enable_tcp`]).
+    ///
+    /// Default `false`.
+    pub enable_tcp: bool,
+    /// Skip SRTP and use lightweight integrity checks (see
+    /// [`PipeTransportOptions::trusted_network`]).
+    ///
+    /// Default `false`.
+    pub trusted_network: bool,
 }
 
 impl PipeToRouterOptions {
@@ -149,6 +179,10 @@ impl PipeToRouterOptions {
             num_sctp_streams: NumSctpStreams::default(),
             enable_rtx: false,
             enable_srtp: false,
+            in_memory: false,
+            enable_trunk: false,
+            enable_tcp: false,
+            trusted_network: false,
         }
     }
 }
@@ -278,6 +312,7 @@ pub struct RouterDump {
     pub map_producer_id_observer_ids: HashedMap<ProducerId, HashedSet<RtpObserverId>>,
     pub rtp_observer_ids: HashedSet<RtpObserverId>,
     pub transport_ids: HashedSet<TransportId>,
+    pub cpu_ms_per_second: Option<f64>,
 }
 
 /// New transport that was just created.
@@ -1041,6 +1076,8 @@ impl Router {
                     pipe_consumer.rtp_parameters().clone(),
                 );
                 producer_options.paused = pipe_consumer.producer_paused();
+                producer_options.relay_path = producer.relay_path().to_vec();
+                producer_options.relay_path.push(self.id());
                 producer_options.app_data = producer.app_data().clone();
 
                 producer_options
@@ -1093,6 +1130,23 @@ impl Router {
             .detach();
 
         // Pipe events from the pipe Producer to the pipe Consumer.
+        // Don't send streams nobody consumes in the remote router.
+        pipe_producer
+            .on_layer_demand_change({
+                let executor = Arc::clone(&self.inner.executor);
+                let pipe_consumer_weak = pipe_consumer.downgrade();
+
+                move |layer_demand| {
+                    if let Some(pipe_consumer) = pipe_consumer_weak.upgrade() {
+                        executor
+                            .spawn(async move {
+                                let _ = pipe_consumer.set_layer_demand(layer_demand).await;
+                            })
+                            .detach();
+                    }
+                }
+            })
+            .detach();
         pipe_producer
             .on_close({
                 let pipe_consumer = pipe_consumer.clone();
@@ -1105,6 +1159,9 @@ impl Router {
             })
             .detach();
 
+        // The pipe producer has no consumers yet.
+        pipe_consumer.set_layer_demand(None).await?;
+
         let pipe_producer = PipedProducer::new(pipe_producer, {
             let weak_producer = producer.downgrade();
 
@@ -1400,6 +1457,10 @@ impl Router {
             num_sctp_streams,
             enable_rtx,
             enable_srtp,
+            in_memory,
+            enable_trunk,
+            enable_tcp,
+            trusted_network,
         } = pipe_to_router_options;
 
         let remote_router_id = router.id();
@@ -1409,6 +1470,10 @@ impl Router {
             num_sctp_streams,
             enable_rtx,
             enable_srtp,
+            in_memory,
+            enable_trunk,
+            enable_tcp,
+            trusted_network,
             app_data: AppData::default(),
             ..PipeTransportOptions::new(listen_ip)
         };
@@ -1419,27 +1484,35 @@ impl Router {
         let (local_pipe_transport, remote_pipe_transport) =
             future::try_zip(local_pipe_transport_fut, remote_pipe_transport_fut).await?;
 
-        let local_connect_fut = local_pipe_transport.connect({
-            let tuple = remote_pipe_transport.tuple();
-
-            PipeTransportRemoteParameters {
-                ip: tuple.local_ip(),
-                port: tuple.local_port(),
-                srtp_parameters: remote_pipe_transport.srtp_parameters(),
-            }
-        });
-
-        let remote_connect_fut = remote_pipe_transport.connect({
-            let tuple = local_pipe_transport.tuple();
-
-            PipeTransportRemoteParameters {
-                ip: tuple.local_ip(),
-                port: tuple.local_port(),
-                srtp_parameters: local_pipe_transport.srtp_parameters(),
-            }
-        });
+        // The remote `PipeTransport` is connected first so it's ready to adopt the TCP connection
+        // initiated by the local one.
+        remote_pipe_transport
+            .connect({
+                let tuple = local_pipe_transport.tuple();
+
+                PipeTransportRemoteParameters {
+                    ip: tuple.local_ip(),
+                    port: tuple.local_port(),
+                    srtp_parameters: local_pipe_transport.srtp_parameters(),
+                    memory_pipe_id: local_pipe_transport.memory_pipe_id(),
+                    tcp_role: enable_tcp.then(|| PipeTransportTcpRole::Server),
+                }
+            })
+            .await?;
 
-        future::try_zip(local_connect_fut, remote_connect_fut).await?;
+        local_pipe_transport
+            .connect({
+                let tuple = remote_pipe_transport.tuple();
+
+                PipeTransportRemoteParameters {
+                    ip: tuple.local_ip(),
+                    port: tuple.local_port(),
+                    srtp_parameters: remote_pipe_transport.srtp_parameters(),
+                    memory_pipe_id: remote_pipe_transport.memory_pipe_id(),
+                    tcp_role: enable_tcp.then(|| PipeTransportTcpRole::Client),
+                }
+            })
+            .await?;
 
         local_pipe_transport
             .on_close({
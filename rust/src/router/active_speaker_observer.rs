@@ -28,6 +28,15 @@ pub struct ActiveSpeakerObserverOptions {
     /// Interval in ms for checking audio volumes.
     /// Default 300.
     pub interval: u16,
+    /// Compute speaker activity scores of all producers at once with SIMD kernels.
+    /// Dominant speaker decisions are the same.
+    /// Default false.
+    pub use_simd: bool,
+    /// If greater than zero, consumers of the video producers of the speakers (see
+    /// [`RtpObserverAddProducerOptions::video_producer_ids`]) that are not among the last N
+    /// dominant speakers are paused within the worker (pipe consumers excluded).
+    /// Default 0 (disabled).
+    pub video_last_n: u32,
     /// Custom application data.
     pub app_data: AppData,
 }
@@ -36,6 +45,8 @@ impl Default for ActiveSpeakerObserverOptions {
     fn default() -> Self {
         Self {
             interval: 300,
+            use_simd: false,
+            video_last_n: 0,
             app_data: AppData::default(),
         }
     }
@@ -212,7 +223,10 @@ impl RtpObserver for ActiveSpeakerObserver {
 
     async fn add_producer(
         &self,
-        RtpObserverAddProducerOptions { producer_id }: RtpObserverAddProducerOptions,
+        RtpObserverAddProducerOptions {
+            producer_id,
+            video_producer_ids,
+        }: RtpObserverAddProducerOptions,
     ) -> Result<(), RequestError> {
         let producer = match self.inner.router.get_producer(&producer_id) {
             Some(producer) => producer,
@@ -224,7 +238,10 @@ impl RtpObserver for ActiveSpeakerObserver {
             .channel
             .request(RtpObserverAddProducerRequest {
                 internal: self.get_internal(),
-                data: RtpObserverAddRemoveProducerRequestData { producer_id },
+                data: RtpObserverAddRemoveProducerRequestData {
+                    producer_id,
+                    video_producer_ids,
+                },
             })
             .await?;
 
@@ -244,7 +261,10 @@ impl RtpObserver for ActiveSpeakerObserver {
             .channel
             .request(RtpObserverRemoveProducerRequest {
                 internal: self.get_internal(),
-                data: RtpObserverAddRemoveProducerRequestData { producer_id },
+                data: RtpObserverAddRemoveProducerRequestData {
+                    producer_id,
+                    video_producer_ids: Vec::new(),
+                },
             })
             .await?;
 
@@ -35,6 +35,11 @@ pub struct AudioLevelObserverOptions {
     /// Interval in ms for checking audio volumes.
     /// Default 1000.
     pub interval: u16,
+    /// Keep the loudest producers updated on every received packet instead of computing them
+    /// once per interval. A 'volumes' event is then also emitted (at most once per interval) as
+    /// soon as a new producer enters them.
+    /// Default false.
+    pub incremental: bool,
     /// Custom application data.
     pub app_data: AppData,
 }
@@ -45,6 +50,7 @@ impl Default for AudioLevelObserverOptions {
             max_entries: NonZeroU16::new(1).unwrap(),
             threshold: -80,
             interval: 1000,
+            incremental: false,
             app_data: AppData::default(),
         }
     }
@@ -223,7 +229,7 @@ impl RtpObserver for AudioLevelObserver {
 
     async fn add_producer(
         &self,
-        RtpObserverAddProducerOptions { producer_id }: RtpObserverAddProducerOptions,
+        RtpObserverAddProducerOptions { producer_id, .. }: RtpObserverAddProducerOptions,
     ) -> Result<(), RequestError> {
         let producer = match self.inner.router.get_producer(&producer_id) {
             Some(producer) => producer,
@@ -235,7 +241,10 @@ impl RtpObserver for AudioLevelObserver {
             .channel
             .request(RtpObserverAddProducerRequest {
                 internal: self.get_internal(),
-                data: RtpObserverAddRemoveProducerRequestData { producer_id },
+                data: RtpObserverAddRemoveProducerRequestData {
+                    producer_id,
+                    video_producer_ids: Vec::new(),
+                },
             })
             .await?;
 
@@ -255,7 +264,10 @@ impl RtpObserver for AudioLevelObserver {
             .channel
             .request(RtpObserverRemoveProducerRequest {
                 internal: self.get_internal(),
-                data: RtpObserverAddRemoveProducerRequestData { producer_id },
+                data: RtpObserverAddRemoveProducerRequestData {
+                    producer_id,
+                    video_producer_ids: Vec::new(),
+                },
             })
             .await?;
 
@@ -4,11 +4,14 @@ mod tests;
 use crate::data_structures::{AppData, RtpPacketTraceInfo, SsrcTraceInfo, TraceEventDirection};
 use crate::messages::{
     ConsumerCloseRequest, ConsumerDumpRequest, ConsumerEnableTraceEventData,
-    ConsumerEnableTraceEventRequest, ConsumerGetStatsRequest, ConsumerInternal,
-    ConsumerPauseRequest, ConsumerRequestKeyFrameRequest, ConsumerResumeRequest,
-    ConsumerSetPreferredLayersRequest, ConsumerSetPriorityData, ConsumerSetPriorityRequest,
+    ConsumerEnableTraceEventRequest, ConsumerExportSendStateRequest, ConsumerGetStatsRequest,
+    ConsumerInternal, ConsumerPauseRequest, ConsumerRequestKeyFrameRequest, ConsumerResumeRequest,
+    ConsumerSetLayerDemandData, ConsumerSetLayerDemandRequest, ConsumerSetPreferredLayersRequest,
+    ConsumerSetPriorityData, ConsumerSetPriorityRequest,
+};
+use crate::producer::{
+    Producer, ProducerId, ProducerLayerDemand, ProducerStat, ProducerType, WeakProducer,
 };
-use crate::producer::{Producer, ProducerId, ProducerStat, ProducerType, WeakProducer};
 use crate::rtp_parameters::{MediaKind, MimeType, RtpCapabilities, RtpParameters};
 use crate::scalability_modes::ScalabilityMode;
 use crate::transport::Transport;
@@ -39,6 +42,35 @@ pub struct ConsumerLayers {
     pub temporal_layer: Option<u8>,
 }
 
+/// State of the RTP stream sent by a consumer, see [`Consumer::export_send_state`].
+#[derive(Debug, Clone, PartialEq, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[non_exhaustive]
+pub struct ConsumerSendState {
+    /// Consumer type.
+    pub r#type: ConsumerType,
+    /// Sequence number of the last sent RTP packet.
+    pub rtp_seq: u16,
+    /// Sequence number of the last sent RTX packet (if RTX is used).
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub rtx_seq: Option<u16>,
+    /// Current spatial layer (simulcast and SVC), essentially `Option<u8>` or `Option<-1>`.
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub spatial_layer: Option<i16>,
+    /// Current temporal layer (simulcast and SVC), essentially `Option<u8>` or `Option<-1>`.
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub temporal_layer: Option<i16>,
+    /// Spatial layer RTP timestamps are referred to (simulcast).
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub ts_reference_spatial_layer: Option<i16>,
+    /// Whether the last sent RTP packet had the marker bit (simulcast).
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub last_sent_packet_has_marker: Option<bool>,
+    /// RTP parameters of the consumer (not known by the worker).
+    #[serde(skip)]
+    pub rtp_parameters: RtpParameters,
+}
+
 /// Score of consumer and corresponding producer.
 #[derive(Debug, Clone, Eq, PartialEq, Ord, PartialOrd, Hash, Deserialize, Serialize)]
 #[serde(rename_all = "camelCase")]
@@ -78,8 +110,20 @@ pub struct ConsumerOptions {
     /// Preferred spatial and temporal layer for simulcast or SVC media sources.
     /// If `None`, the highest ones are selected.
     pub preferred_layers: Option<ConsumerLayers>,
+    /// Whether this Consumer should drop Opus DTX packets instead of sending them to the consuming
+    /// endpoint. Just for audio Consumers with Opus codec. Default false.
+    pub ignore_dtx: bool,
+    /// Frame rate (greater than 0 and up to 5) of a thumbnail of a simulcast media source, below
+    /// the one of its lowest temporal layer. Just key frames of the selected spatial layer are sent,
+    /// requested to the producer at this rate, so every frame sent is decodable.
+    /// Default none (disabled).
+    pub thumbnail_framerate: Option<f32>,
     /// Whether this Consumer should consume all RTP streams generated by the Producer.
     pub pipe: bool,
+    /// Send state exported by [`Consumer::export_send_state`] of a consumer (of the same producer,
+    /// piped into this router) whose stream this consumer must continue. Its SSRCs, MID and layers
+    /// are reused so the consuming endpoint does not need to renegotiate.
+    pub send_state: Option<ConsumerSendState>,
     /// Custom application data.
     pub app_data: AppData,
 }
@@ -93,8 +137,11 @@ impl ConsumerOptions {
             rtp_capabilities,
             paused: false,
             preferred_layers: None,
+            ignore_dtx: false,
+            thumbnail_framerate: None,
             pipe: false,
             mid: None,
+            send_state: None,
             app_data: AppData::default(),
         }
     }
@@ -237,6 +284,35 @@ pub struct ConsumerStat {
     pub byte_count: usize,
     pub bitrate: u32,
     pub round_trip_time: Option<f32>,
+    // Just for simulcast consumers.
+    pub spatial_layer_switch_latency: Option<ConsumerSpatialLayerSwitchLatency>,
+    // Just for SVC consumers.
+    pub key_frame_requests_avoided: Option<u32>,
+    pub join_latency: Option<ConsumerJoinLatency>,
+}
+
+/// Time (ms) since the consumer creation until its first RTP packet and its first key frame (just
+/// video) were sent.
+#[derive(Debug, Clone, PartialEq, Eq, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[non_exhaustive]
+#[allow(missing_docs)]
+pub struct ConsumerJoinLatency {
+    pub first_rtp_ms: u64,
+    pub first_key_frame_ms: Option<u64>,
+}
+
+/// Histogram of the time needed to switch to a new spatial layer.
+#[derive(Debug, Clone, PartialEq, Eq, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[non_exhaustive]
+pub struct ConsumerSpatialLayerSwitchLatency {
+    /// Upper bound (in ms) of each bucket but the last one.
+    pub buckets_ms: Vec<u64>,
+    /// Number of switches in each bucket.
+    pub counts: Vec<u32>,
+    /// Number of switches done by sending the producer key frame cache.
+    pub key_frame_cache_switches: u32,
 }
 
 /// RTC statistics of the consumer, may or may not include producer statistics.
@@ -799,6 +875,30 @@ impl Consumer {
         Ok(())
     }
 
+    /// Sets the max layers wanted from a pipe consumer (usually the layer demand of the pipe
+    /// producer in the remote router). Streams of other layers are paused, and `None` pauses them
+    /// all. Just valid for pipe consumers.
+    ///
+    /// [`Router::pipe_producer_to_router`](crate::router::Router::pipe_producer_to_router) calls
+    /// it already.
+    pub async fn set_layer_demand(
+        &self,
+        layer_demand: Option<ProducerLayerDemand>,
+    ) -> Result<(), RequestError> {
+        debug!("set_layer_demand()");
+
+        self.inner
+            .channel
+            .request(ConsumerSetLayerDemandRequest {
+                internal: self.get_internal(),
+                data: ConsumerSetLayerDemandData {
+                    spatial_layer: layer_demand.map(|layers| layers.spatial_layer),
+                    temporal_layer: layer_demand.map(|layers| layers.temporal_layer),
+                },
+            })
+            .await
+    }
+
     /// Sets the priority for this consumer. It affects how the estimated outgoing bitrate in the
     /// transport (obtained via transport-cc or REMB) is distributed among all video consumers, by
     /// prioritizing those with higher priority.
@@ -851,6 +951,25 @@ impl Consumer {
             .await
     }
 
+    /// Export the state of the RTP stream sent by this consumer so a consumer of the same producer
+    /// in another router (given it in [`ConsumerOptions::send_state`]) continues it. Not valid for
+    /// pipe consumers.
+    pub async fn export_send_state(&self) -> Result<ConsumerSendState, RequestError> {
+        debug!("export_send_state()");
+
+        let mut send_state = self
+            .inner
+            .channel
+            .request(ConsumerExportSendStateRequest {
+                internal: self.get_internal(),
+            })
+            .await?;
+
+        send_state.rtp_parameters = self.rtp_parameters().clone();
+
+        Ok(send_state)
+    }
+
     /// Instructs the consumer to emit "trace" events. For monitoring purposes. Use with caution.
     pub async fn enable_trace_event(
         &self,
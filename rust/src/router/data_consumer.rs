@@ -51,6 +51,11 @@ pub struct DataConsumerOptions {
     /// Defaults to the value in the [`DataProducer`](crate::data_producer::DataProducer) if it
     /// has type `Sctp` or unset if it has type `Direct`.
     pub(super) max_retransmits: Option<u16>,
+    /// Just if consuming over SCTP.
+    /// Queue in the worker for messages that do not fit in the SCTP send buffer, so they are
+    /// sent once there is room instead of being discarded (with a `sctpsendbufferfull` event).
+    /// Disabled by default.
+    pub send_queue: Option<DataConsumerSendQueue>,
     /// Custom application data.
     pub app_data: AppData,
 }
@@ -65,6 +70,7 @@ impl DataConsumerOptions {
             ordered: None,
             max_packet_life_time: None,
             max_retransmits: None,
+            send_queue: None,
             app_data: AppData::default(),
         }
     }
@@ -77,6 +83,7 @@ impl DataConsumerOptions {
             ordered: Some(true),
             max_packet_life_time: None,
             max_retransmits: None,
+            send_queue: None,
             app_data: AppData::default(),
         }
     }
@@ -89,6 +96,7 @@ impl DataConsumerOptions {
             ordered: None,
             max_packet_life_time: None,
             max_retransmits: None,
+            send_queue: None,
             app_data: AppData::default(),
         }
     }
@@ -105,6 +113,7 @@ impl DataConsumerOptions {
             ordered: None,
             max_packet_life_time: Some(max_packet_life_time),
             max_retransmits: None,
+            send_queue: None,
             app_data: AppData::default(),
         }
     }
@@ -120,11 +129,55 @@ impl DataConsumerOptions {
             ordered: None,
             max_packet_life_time: None,
             max_retransmits: Some(max_retransmits),
+            send_queue: None,
             app_data: AppData::default(),
         }
     }
 }
 
+/// What to do with a message when the send queue of a data consumer is full.
+#[derive(Debug, Copy, Clone, Eq, PartialEq, Hash, Deserialize, Serialize)]
+#[serde(rename_all = "kebab-case")]
+pub enum DataConsumerQueueDropPolicy {
+    /// Drop the oldest queued message.
+    DropOldest,
+    /// Drop the new message.
+    DropNewest,
+    /// Replace the queued message with same key (its first `coalesce_key_length` bytes),
+    /// otherwise drop the oldest queued message.
+    Coalesce,
+}
+
+impl Default for DataConsumerQueueDropPolicy {
+    fn default() -> Self {
+        Self::DropOldest
+    }
+}
+
+/// Send queue of a data consumer, see [`DataConsumerOptions::send_queue`].
+#[derive(Debug, Copy, Clone, Eq, PartialEq, Hash)]
+pub struct DataConsumerSendQueue {
+    /// Maximum number of queued messages.
+    pub max_messages: u32,
+    /// What to do with a message when the queue is full.
+    pub drop_policy: DataConsumerQueueDropPolicy,
+    /// Number of leading bytes of a message used as key. Required if `drop_policy` is
+    /// [`DataConsumerQueueDropPolicy::Coalesce`].
+    pub coalesce_key_length: Option<u32>,
+}
+
+impl DataConsumerSendQueue {
+    /// Queue of up to `max_messages` messages dropping the oldest one when full.
+    #[must_use]
+    pub fn new(max_messages: u32) -> Self {
+        Self {
+            max_messages,
+            drop_policy: DataConsumerQueueDropPolicy::default(),
+            coalesce_key_length: None,
+        }
+    }
+}
+
 #[derive(Debug, Clone, PartialEq, Deserialize, Serialize)]
 #[serde(rename_all = "camelCase")]
 #[doc(hidden)]
@@ -152,6 +205,8 @@ pub struct DataConsumerStat {
     pub messages_sent: usize,
     pub bytes_sent: usize,
     pub buffered_amount: u32,
+    pub messages_queued: usize,
+    pub messages_dropped: usize,
 }
 
 /// Data consumer type.
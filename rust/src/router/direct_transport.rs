@@ -36,6 +36,9 @@ pub struct DirectTransportOptions {
     /// Maximum allowed size for direct messages sent from DataProducers.
     /// Default 262_144.
     pub max_message_size: usize,
+    /// If given, RTP and RTCP packets sent by the transport are written by the worker into this
+    /// file (in rtpdump format) instead of being emitted. RTCP packets are still emitted.
+    pub record_path: Option<String>,
     /// Custom application data.
     pub app_data: AppData,
 }
@@ -44,6 +47,7 @@ impl Default for DirectTransportOptions {
     fn default() -> Self {
         Self {
             max_message_size: 262_144,
+            record_path: None,
             app_data: AppData::default(),
         }
     }
@@ -107,6 +111,26 @@ pub struct DirectTransportStat {
     pub rtp_packet_loss_received: Option<f64>,
     #[serde(skip_serializing_if = "Option::is_none")]
     pub rtp_packet_loss_sent: Option<f64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub ecn_ce_packets_received: Option<u64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub ecn_ce_packets_sent: Option<u64>,
+    pub cpu_ms_per_second: f64,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub recording: Option<DirectTransportRecordingStat>,
+}
+
+/// Statistics of the recording of a direct transport.
+#[derive(Debug, Clone, PartialEq, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[non_exhaustive]
+#[allow(missing_docs)]
+pub struct DirectTransportRecordingStat {
+    pub path: String,
+    pub packets: u64,
+    pub dropped_packets: u64,
+    pub bytes: u64,
+    pub write_errors: u64,
 }
 
 #[derive(Default)]
@@ -4,7 +4,10 @@ mod tests;
 use crate::consumer::{Consumer, ConsumerId, ConsumerOptions};
 use crate::data_consumer::{DataConsumer, DataConsumerId, DataConsumerOptions, DataConsumerType};
 use crate::data_producer::{DataProducer, DataProducerId, DataProducerOptions, DataProducerType};
-use crate::data_structures::{AppData, SctpState, TransportListenIp, TransportTuple};
+use crate::data_structures::{
+    AppData, SctpState, TransportListenIp, TransportTcpConnectionStat, TransportTuple,
+    TransportUdpSocketStat,
+};
 use crate::messages::{
     PipeTransportData, TransportCloseRequest, TransportConnectPipeRequest,
     TransportConnectRequestPipeData, TransportInternal,
@@ -60,6 +63,39 @@ pub struct PipeTransportOptions {
     /// different hosts. For this to work, connect() must be called with remote SRTP parameters.
     /// Default false.
     pub enable_srtp: bool,
+    /// Exchange packets with the paired `PipeTransport` through memory instead of UDP. Only valid
+    /// if both Routers belong to workers running as threads of this same process. If both belong
+    /// to the same worker, RTP and RTCP packets are directly handed to the paired `PipeTransport`.
+    /// For this to work, connect() must be called with the remote `memory_pipe_id`.
+    /// Default false.
+    pub in_memory: bool,
+    /// Aggregate the RTP and RTCP packets sent to the remote `PipeTransport` into frames of up
+    /// to `trunk_max_frame_size` bytes (one UDP datagram each). If SRTP is enabled, a single
+    /// AES-128-GCM operation protects each frame instead of SRTP. For this to work, both
+    /// PipeTransports must enable this setting. Not valid along with `in_memory`.
+    /// Default false.
+    pub enable_trunk: bool,
+    /// Max size (in bytes) of trunk frames. Values above the path MTU rely on jumbo frames or IP
+    /// fragmentation.
+    /// Default 8192.
+    pub trunk_max_frame_size: Option<u16>,
+    /// Exchange packets with the remote `PipeTransport` over a single TCP connection (RFC 4571
+    /// framing) instead of UDP. Useful across lossy or filtered inter-datacenter links. For this
+    /// to work, both PipeTransports must enable this setting and connect() must be called with
+    /// opposite `tcp_role` values. Not valid along with `in_memory` or `enable_trunk`.
+    /// Default false.
+    pub enable_tcp: bool,
+    /// For `PipeTransport`s within a host or a private network. RTP and RTCP are not encrypted
+    /// but carry a CRC32c checksum, and RTP packets also carry a compact stream index so the
+    /// receiver finds their producer without looking up their SSRC. For this to work, both
+    /// PipeTransports must enable this setting. Not valid along with `enable_srtp`, `in_memory`
+    /// or `enable_trunk`.
+    /// Default false.
+    pub trusted_network: bool,
+    /// Max time (in ms) received media packets following a sequence number gap are held waiting
+    /// for the missing ones, so packets reordered by the network are not NACKed. Up to 50.
+    /// Default 0 (disabled).
+    pub rtp_reorder_delay: u32,
     /// Custom application data.
     pub app_data: AppData,
 }
@@ -77,6 +113,12 @@ impl PipeTransportOptions {
             sctp_send_buffer_size: 268_435_456,
             enable_rtx: false,
             enable_srtp: false,
+            in_memory: false,
+            enable_trunk: false,
+            trunk_max_frame_size: None,
+            enable_tcp: false,
+            trusted_network: false,
+            rtp_reorder_delay: 0,
             app_data: AppData::default(),
         }
     }
@@ -144,8 +186,23 @@ pub struct PipeTransportStat {
     pub rtp_packet_loss_received: Option<f64>,
     #[serde(skip_serializing_if = "Option::is_none")]
     pub rtp_packet_loss_sent: Option<f64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub ecn_ce_packets_received: Option<u64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub ecn_ce_packets_sent: Option<u64>,
+    pub cpu_ms_per_second: f64,
     // PipeTransport specific.
     pub tuple: Option<TransportTuple>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub trunk_sent_frames: Option<u64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub trunk_sent_packets: Option<u64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub trusted_checksum_errors: Option<u64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub udp_socket: Option<TransportUdpSocketStat>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub tcp_connection: Option<TransportTcpConnectionStat>,
 }
 
 /// Remote parameters for pipe transport.
@@ -158,6 +215,20 @@ pub struct PipeTransportRemoteParameters {
     pub port: u16,
     /// SRTP parameters used by the paired `PipeTransport` to encrypt its RTP and RTCP.
     pub srtp_parameters: Option<SrtpParameters>,
+    /// Memory pipe id of the paired `PipeTransport`. Required if `in_memory` is enabled.
+    pub memory_pipe_id: Option<String>,
+    /// Role of this `PipeTransport` in the TCP connection. Required if `enable_tcp` is enabled.
+    pub tcp_role: Option<PipeTransportTcpRole>,
+}
+
+/// Role of a [`PipeTransport`] in the TCP connection with its paired `PipeTransport`.
+#[derive(Debug, Copy, Clone, PartialEq, Eq, Deserialize, Serialize)]
+#[serde(rename_all = "lowercase")]
+pub enum PipeTransportTcpRole {
+    /// Connects to the paired `PipeTransport` (and reconnects if the connection is closed).
+    Client,
+    /// Waits for the connection of the paired `PipeTransport`.
+    Server,
 }
 
 #[derive(Default)]
@@ -563,6 +634,8 @@ impl PipeTransport {
                     ip: remote_parameters.ip,
                     port: remote_parameters.port,
                     srtp_parameters: remote_parameters.srtp_parameters,
+                    memory_pipe_id: remote_parameters.memory_pipe_id,
+                    tcp_role: remote_parameters.tcp_role,
                 },
             })
             .await?;
@@ -613,6 +686,13 @@ impl PipeTransport {
         self.inner.data.srtp_parameters.lock().clone()
     }
 
+    /// Id of the memory pipe to be passed to the paired `PipeTransport`. Or `None` if `in_memory`
+    /// is not enabled.
+    #[must_use]
+    pub fn memory_pipe_id(&self) -> Option<String> {
+        self.inner.data.memory_pipe_id.clone()
+    }
+
     /// Callback is called after the remote RTP origin has been discovered. Only if `comedia` mode
     /// was set.
     pub fn on_tuple<F: Fn(&TransportTuple) + Send + Sync + 'static>(
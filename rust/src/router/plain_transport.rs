@@ -4,7 +4,10 @@ mod tests;
 use crate::consumer::{Consumer, ConsumerId, ConsumerOptions};
 use crate::data_consumer::{DataConsumer, DataConsumerId, DataConsumerOptions, DataConsumerType};
 use crate::data_producer::{DataProducer, DataProducerId, DataProducerOptions, DataProducerType};
-use crate::data_structures::{AppData, SctpState, TransportListenIp, TransportTuple};
+use crate::data_structures::{
+    AppData, SctpState, TransportIngressDrops, TransportIngressPolicer, TransportListenIp,
+    TransportTuple, TransportUdpSocketStat,
+};
 use crate::messages::{
     PlainTransportData, TransportCloseRequest, TransportConnectPlainRequest,
     TransportConnectRequestPlainData, TransportInternal,
@@ -57,6 +60,11 @@ pub struct PlainTransportOptions {
     /// SRTP is enabled. If so, it must be called with just remote SRTP parameters.
     /// Default false.
     pub comedia: bool,
+    /// Share the listening port with every other plain transport in the same worker created with
+    /// this option. Packets are dispatched to the transport connected to their source IP:port or,
+    /// in comedia mode, to the transport with a producer matching their SSRC. Requires `rtcp_mux`.
+    /// Default false.
+    pub shared_port: bool,
     /// Create a SCTP association.
     /// Default false.
     pub enable_sctp: bool,
@@ -68,12 +76,32 @@ pub struct PlainTransportOptions {
     /// Maximum SCTP send buffer used by DataConsumers.
     /// Default 262144.
     pub sctp_send_buffer_size: u32,
+    /// Share (between 0 and 1) of the estimated outgoing bitrate for SCTP packets. If given, they
+    /// are paced along with the media (once there is bandwidth estimation), so large DataChannel
+    /// transfers do not cause queueing delay to the media.
+    /// Default none (not paced).
+    pub sctp_bitrate_share: Option<f32>,
     /// Enable SRTP. For this to work, connect() must be called with remote SRTP parameters.
     /// Default false.
     pub enable_srtp: bool,
     /// The SRTP crypto suite to be used if enableSrtp is set.
     /// Default 'AesCm128HmacSha180'.
     pub srtp_crypto_suite: SrtpCryptoSuite,
+    /// Max time (in ms) received media packets following a sequence number gap are held waiting
+    /// for the missing ones, so packets reordered by the network are not NACKed. Up to 50.
+    /// Default 0 (disabled).
+    pub rtp_reorder_delay: u32,
+    /// Limits of the received packets, applied before parsing them.
+    /// Default none.
+    pub ingress_policer: Option<TransportIngressPolicer>,
+    /// TTL (between 1 and 255) of the packets sent to a multicast group given in connect(), so
+    /// several receivers get a single stream. Not valid with `comedia` or `shared_port`.
+    /// Default none (system default of 1).
+    pub multicast_ttl: Option<u8>,
+    /// Local IP address of the interface used to send packets to a multicast group given in
+    /// connect(). Not valid with `comedia` or `shared_port`.
+    /// Default none (chosen by the system).
+    pub multicast_interface: Option<IpAddr>,
     /// Custom application data.
     pub app_data: AppData,
 }
@@ -87,12 +115,18 @@ impl PlainTransportOptions {
             port: None,
             rtcp_mux: true,
             comedia: false,
+            shared_port: false,
             enable_sctp: false,
             num_sctp_streams: NumSctpStreams::default(),
             max_sctp_message_size: 262_144,
             sctp_send_buffer_size: 262_144,
+            sctp_bitrate_share: None,
             enable_srtp: false,
             srtp_crypto_suite: SrtpCryptoSuite::default(),
+            rtp_reorder_delay: 0,
+            ingress_policer: None,
+            multicast_ttl: None,
+            multicast_interface: None,
             app_data: AppData::default(),
         }
     }
@@ -122,6 +156,8 @@ pub struct PlainTransportDump {
     // PlainTransport specific.
     pub rtcp_mux: bool,
     pub comedia: bool,
+    #[serde(default)]
+    pub shared_port: bool,
     pub tuple: TransportTuple,
     pub rtcp_tuple: Option<TransportTuple>,
     pub srtp_parameters: Option<SrtpParameters>,
@@ -162,11 +198,21 @@ pub struct PlainTransportStat {
     pub rtp_packet_loss_received: Option<f64>,
     #[serde(skip_serializing_if = "Option::is_none")]
     pub rtp_packet_loss_sent: Option<f64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub ecn_ce_packets_received: Option<u64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub ecn_ce_packets_sent: Option<u64>,
+    pub cpu_ms_per_second: f64,
     // PlainTransport specific.
     pub rtcp_mux: bool,
     pub comedia: bool,
     pub tuple: Option<TransportTuple>,
     pub rtcp_tuple: Option<TransportTuple>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub udp_socket: Option<TransportUdpSocketStat>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub rtcp_udp_socket: Option<TransportUdpSocketStat>,
+    pub ingress_drops: TransportIngressDrops,
 }
 
 /// Remote parameters for plain transport.
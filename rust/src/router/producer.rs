@@ -9,6 +9,7 @@ use crate::messages::{
     ProducerPauseRequest, ProducerResumeRequest, ProducerSendNotification,
 };
 pub use crate::ortc::RtpMapping;
+use crate::router::RouterId;
 use crate::rtp_parameters::{MediaKind, MimeType, RtpParameters};
 use crate::transport::Transport;
 use crate::uuid_based_wrapper_type;
@@ -44,6 +45,9 @@ pub struct ProducerOptions {
     /// Producer id (just for
     /// [`Router::pipe_producer_to_router`](crate::router::Router::pipe_producer_to_router) method).
     pub(super) id: Option<ProducerId>,
+    /// Ids of the routers the stream was relayed through, origin first (just for
+    /// [`Router::pipe_producer_to_router`](crate::router::Router::pipe_producer_to_router) method).
+    pub(super) relay_path: Vec<RouterId>,
     /// Media kind.
     pub kind: MediaKind,
     /// RTP parameters defining what the endpoint is sending.
@@ -53,6 +57,10 @@ pub struct ProducerOptions {
     /// Just for video. Time (in ms) before asking the sender for a new key frame after having asked
     /// a previous one. If 0 there is no delay.
     pub key_frame_request_delay: u32,
+    /// Just for video. Whether to cache the packets of the most recent key frame (and the ones
+    /// following it), so consumers that need to sync are bootstrapped from it instead of asking the
+    /// endpoint for a new key frame. Default false.
+    pub enable_key_frame_cache: bool,
     /// Custom application data.
     pub app_data: AppData,
 }
@@ -67,10 +75,12 @@ impl ProducerOptions {
     ) -> Self {
         Self {
             id: Some(producer_id),
+            relay_path: Vec::new(),
             kind,
             rtp_parameters,
             paused: false,
             key_frame_request_delay: 0,
+            enable_key_frame_cache: false,
             app_data: AppData::default(),
         }
     }
@@ -80,10 +90,12 @@ impl ProducerOptions {
     pub fn new(kind: MediaKind, rtp_parameters: RtpParameters) -> Self {
         Self {
             id: None,
+            relay_path: Vec::new(),
             kind,
             rtp_parameters,
             paused: false,
             key_frame_request_delay: 0,
+            enable_key_frame_cache: false,
             app_data: AppData::default(),
         }
     }
@@ -116,6 +128,8 @@ pub struct ProducerDump {
     pub rtp_streams: Vec<RtpStreamRecv>,
     pub trace_event_types: String,
     pub r#type: ProducerType,
+    #[serde(default)]
+    pub relay_path: Vec<RouterId>,
 }
 
 /// Producer type.
@@ -170,6 +184,16 @@ pub struct ProducerVideoOrientation {
     pub rotation: Rotation,
 }
 
+/// Max layers wanted by the consumers of a simulcast or SVC producer.
+#[derive(Debug, Copy, Clone, PartialEq, Eq, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+pub struct ProducerLayerDemand {
+    /// The max spatial layer wanted by any consumer.
+    pub spatial_layer: u8,
+    /// The max temporal layer wanted by any consumer.
+    pub temporal_layer: u8,
+}
+
 /// RTC statistics of the producer.
 #[derive(Debug, Clone, PartialEq, Deserialize, Serialize)]
 #[serde(rename_all = "camelCase")]
@@ -202,6 +226,49 @@ pub struct ProducerStat {
     // RtpStreamRecv specific.
     pub jitter: u32,
     pub bitrate_by_layer: Option<HashedMap<String, u32>>,
+    // Just if the Producer sends the abs-capture-time RTP header extension.
+    pub capture_latency: Option<ProducerCaptureLatency>,
+    // Just if the Producer was relayed from another Router.
+    pub relay_hops: Option<usize>,
+    pub hop_latency: Option<f32>,
+    // Just if the Transport has `rtp_reorder_delay`.
+    pub reorder_buffer: Option<ProducerReorderBufferStat>,
+    pub join_latency: Option<ProducerJoinLatency>,
+}
+
+/// Time (ms) since the producer creation until its first RTP packet was received.
+#[derive(Debug, Clone, PartialEq, Eq, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[non_exhaustive]
+#[allow(missing_docs)]
+pub struct ProducerJoinLatency {
+    pub first_rtp_ms: u64,
+}
+
+/// Distribution of the time (ms) since media capture until the packet was received.
+#[derive(Debug, Clone, PartialEq, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[non_exhaustive]
+#[allow(missing_docs)]
+pub struct ProducerCaptureLatency {
+    pub count: u64,
+    pub mean: f64,
+    pub max: u64,
+    pub p50: u64,
+    pub p90: u64,
+    pub p99: u64,
+    pub p999: u64,
+}
+
+/// Stats of the RTP reorder buffer of a producer stream.
+#[derive(Debug, Clone, PartialEq, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[non_exhaustive]
+#[allow(missing_docs)]
+pub struct ProducerReorderBufferStat {
+    pub reordered_packets: usize,
+    pub nacks_avoided: usize,
+    pub skipped_packets: usize,
 }
 
 /// 'trace' event data.
@@ -274,6 +341,7 @@ pub enum ProducerTraceEventType {
 enum Notification {
     Score(Vec<ProducerScore>),
     VideoOrientationChange(ProducerVideoOrientation),
+    LayerDemandChange(Option<ProducerLayerDemand>),
     Trace(ProducerTraceEventData),
 }
 
@@ -281,6 +349,7 @@ enum Notification {
 struct Handlers {
     score: Bag<Arc<dyn Fn(&[ProducerScore]) + Send + Sync>>,
     video_orientation_change: Bag<Arc<dyn Fn(ProducerVideoOrientation) + Send + Sync>>,
+    layer_demand_change: Bag<Arc<dyn Fn(Option<ProducerLayerDemand>) + Send + Sync>>,
     pause: Bag<Arc<dyn Fn() + Send + Sync>>,
     resume: Bag<Arc<dyn Fn() + Send + Sync>>,
     trace: Bag<Arc<dyn Fn(&ProducerTraceEventData) + Send + Sync>, ProducerTraceEventData>,
@@ -294,6 +363,7 @@ struct Inner {
     r#type: ProducerType,
     rtp_parameters: RtpParameters,
     consumable_rtp_parameters: RtpParameters,
+    relay_path: Vec<RouterId>,
     direct: bool,
     paused: AtomicBool,
     score: Arc<Mutex<Vec<ProducerScore>>>,
@@ -441,6 +511,7 @@ impl Producer {
         r#type: ProducerType,
         rtp_parameters: RtpParameters,
         consumable_rtp_parameters: RtpParameters,
+        relay_path: Vec<RouterId>,
         paused: bool,
         executor: Arc<Executor<'static>>,
         channel: Channel,
@@ -472,6 +543,11 @@ impl Producer {
                                 callback(video_orientation);
                             });
                         }
+                        Notification::LayerDemandChange(layer_demand) => {
+                            handlers.layer_demand_change.call(|callback| {
+                                callback(layer_demand);
+                            });
+                        }
                         Notification::Trace(trace_event_data) => {
                             handlers.trace.call_simple(&trace_event_data);
                         }
@@ -501,6 +577,7 @@ impl Producer {
             r#type,
             rtp_parameters,
             consumable_rtp_parameters,
+            relay_path,
             direct,
             paused: AtomicBool::new(paused),
             score,
@@ -557,6 +634,12 @@ impl Producer {
         self.inner().r#type
     }
 
+    /// Ids of the routers the stream was relayed through (origin first).
+    #[must_use]
+    pub fn relay_path(&self) -> &[RouterId] {
+        &self.inner().relay_path
+    }
+
     /// Whether the Producer is paused.
     #[must_use]
     pub fn paused(&self) -> bool {
@@ -690,6 +773,19 @@ impl Producer {
             .add(Arc::new(callback))
     }
 
+    /// Callback is called when the max layers wanted by the consumers of a simulcast or SVC
+    /// producer change (`None` if no consumer wants any layer). Senders may stop encoding higher
+    /// layers.
+    pub fn on_layer_demand_change<F: Fn(Option<ProducerLayerDemand>) + Send + Sync + 'static>(
+        &self,
+        callback: F,
+    ) -> HandlerId {
+        self.inner()
+            .handlers
+            .layer_demand_change
+            .add(Arc::new(callback))
+    }
+
     /// Callback is called when the producer is paused.
     pub fn on_pause<F: Fn() + Send + Sync + 'static>(&self, callback: F) -> HandlerId {
         self.inner().handlers.pause.add(Arc::new(callback))
@@ -767,6 +863,10 @@ impl Producer {
 
 impl DirectProducer {
     /// Sends a RTP packet from the Rust process.
+    ///
+    /// Ownership of `rtp_packet` is handed over to the worker. If its capacity is at least 1600
+    /// bytes (MTU plus room for header extensions) the worker parses it in place instead of copying
+    /// it, so reusing buffers allocated with `Vec::with_capacity(1600)` avoids a copy per packet.
     pub fn send(&self, rtp_packet: Vec<u8>) -> Result<(), NotificationError> {
         self.inner.payload_channel.notify(
             ProducerSendNotification {
@@ -17,13 +17,19 @@ uuid_based_wrapper_type!(
 pub struct RtpObserverAddProducerOptions {
     /// The id of the Producer to be added.
     pub producer_id: ProducerId,
+    /// Video producers of the same participant, paused and resumed by the video last N policy of
+    /// an [`ActiveSpeakerObserver`](crate::active_speaker_observer::ActiveSpeakerObserver).
+    pub video_producer_ids: Vec<ProducerId>,
 }
 
 impl RtpObserverAddProducerOptions {
     /// * `producer_id` - The id of the [`Producer`] to be added.
     #[must_use]
     pub fn new(producer_id: ProducerId) -> Self {
-        Self { producer_id }
+        Self {
+            producer_id,
+            video_producer_ids: Vec::new(),
+        }
     }
 }
 
@@ -1,4 +1,4 @@
-use crate::consumer::{Consumer, ConsumerId, ConsumerOptions, ConsumerType};
+use crate::consumer::{Consumer, ConsumerId, ConsumerLayers, ConsumerOptions, ConsumerType};
 use crate::data_consumer::{DataConsumer, DataConsumerId, DataConsumerOptions, DataConsumerType};
 use crate::data_producer::{DataProducer, DataProducerId, DataProducerOptions, DataProducerType};
 use crate::data_structures::{AppData, BweTraceInfo, RtpPacketTraceInfo, TraceEventDirection};
@@ -30,6 +30,7 @@ use parking_lot::Mutex;
 use serde::de::DeserializeOwned;
 use serde::{Deserialize, Serialize};
 use serde_json::Value;
+use std::convert::TryFrom;
 use std::fmt::Debug;
 use std::sync::atomic::{AtomicUsize, Ordering};
 use std::sync::Arc;
@@ -451,6 +452,8 @@ pub(super) trait TransportImpl: TransportGeneric {
             mut rtp_parameters,
             paused,
             key_frame_request_delay,
+            enable_key_frame_cache,
+            relay_path,
             app_data,
         } = producer_options;
 
@@ -513,7 +516,9 @@ pub(super) trait TransportImpl: TransportGeneric {
                     rtp_parameters: rtp_parameters.clone(),
                     rtp_mapping,
                     key_frame_request_delay,
+                    enable_key_frame_cache,
                     paused,
+                    relay_path: relay_path.clone(),
                 },
             })
             .await
@@ -525,6 +530,7 @@ pub(super) trait TransportImpl: TransportGeneric {
             response.r#type,
             rtp_parameters,
             consumable_rtp_parameters,
+            relay_path,
             paused,
             Arc::clone(self.executor()),
             self.channel().clone(),
@@ -548,8 +554,11 @@ pub(super) trait TransportImpl: TransportGeneric {
             rtp_capabilities,
             paused,
             mid,
-            preferred_layers,
+            mut preferred_layers,
+            ignore_dtx,
+            thumbnail_framerate,
             pipe,
+            send_state,
             app_data,
         } = consumer_options;
         ortc::validate_rtp_capabilities(&rtp_capabilities)
@@ -573,7 +582,12 @@ pub(super) trait TransportImpl: TransportGeneric {
             .map_err(ConsumeError::BadConsumerRtpParameters)?;
 
             if !pipe {
-                // Set MID.
+                // Set MID, a migrated consumer keeps its MID.
+                let mid = mid.or_else(|| {
+                    send_state
+                        .as_ref()
+                        .and_then(|send_state| send_state.rtp_parameters.mid.clone())
+                });
                 rtp_parameters.mid = mid.or_else(|| {
                     // We use up to 8 bytes for MID (string).
                     let next_mid_for_consumers = self
@@ -584,6 +598,34 @@ pub(super) trait TransportImpl: TransportGeneric {
                 })
             }
 
+            // Continue the stream of a migrated consumer, so reuse its SSRCs and layers.
+            if let Some(send_state) = &send_state {
+                if let (Some(encoding), Some(sent_encoding)) = (
+                    rtp_parameters.encodings.get_mut(0),
+                    send_state.rtp_parameters.encodings.get(0),
+                ) {
+                    encoding.ssrc = sent_encoding.ssrc;
+
+                    if encoding.rtx.is_some() && sent_encoding.rtx.is_some() {
+                        encoding.rtx = sent_encoding.rtx;
+                    }
+                }
+
+                if preferred_layers.is_none() {
+                    if let Some(spatial_layer) = send_state
+                        .spatial_layer
+                        .and_then(|layer| u8::try_from(layer).ok())
+                    {
+                        preferred_layers = Some(ConsumerLayers {
+                            spatial_layer,
+                            temporal_layer: send_state
+                                .temporal_layer
+                                .and_then(|layer| u8::try_from(layer).ok()),
+                        });
+                    }
+                }
+            }
+
             rtp_parameters
         };
 
@@ -616,6 +658,9 @@ pub(super) trait TransportImpl: TransportGeneric {
                         .clone(),
                     paused,
                     preferred_layers,
+                    ignore_dtx,
+                    thumbnail_framerate,
+                    send_state,
                 },
             })
             .await
@@ -721,6 +766,7 @@ pub(super) trait TransportImpl: TransportGeneric {
             ordered,
             max_packet_life_time,
             max_retransmits,
+            send_queue,
             app_data,
         } = data_consumer_options;
 
@@ -753,13 +799,20 @@ pub(super) trait TransportImpl: TransportGeneric {
                 sctp_stream_parameters
             }
             DataConsumerType::Direct => {
-                if ordered.is_some() || max_packet_life_time.is_some() || max_retransmits.is_some()
+                if ordered.is_some()
+                    || max_packet_life_time.is_some()
+                    || max_retransmits.is_some()
+                    || send_queue.is_some()
                 {
-                    warn!("ordered, max_packet_life_time and max_retransmits are ignored when consuming data on a DirectTransport");
+                    warn!("ordered, max_packet_life_time, max_retransmits and send_queue are ignored when consuming data on a DirectTransport");
                 }
                 None
             }
         };
+        let send_queue = match r#type {
+            DataConsumerType::Sctp => send_queue,
+            DataConsumerType::Direct => None,
+        };
 
         let data_consumer_id = DataConsumerId::new();
 
@@ -779,6 +832,10 @@ pub(super) trait TransportImpl: TransportGeneric {
                     sctp_stream_parameters,
                     label: data_producer.label().clone(),
                     protocol: data_producer.protocol().clone(),
+                    max_queued_messages: send_queue.map(|send_queue| send_queue.max_messages),
+                    queue_drop_policy: send_queue.map(|send_queue| send_queue.drop_policy),
+                    coalesce_key_length: send_queue
+                        .and_then(|send_queue| send_queue.coalesce_key_length),
                 },
             })
             .await
@@ -6,7 +6,8 @@ use crate::data_consumer::{DataConsumer, DataConsumerId, DataConsumerOptions, Da
 use crate::data_producer::{DataProducer, DataProducerId, DataProducerOptions, DataProducerType};
 use crate::data_structures::{
     AppData, DtlsParameters, DtlsState, IceCandidate, IceParameters, IceRole, IceState, SctpState,
-    TransportListenIp, TransportTuple,
+    TransportIngressDrops, TransportIngressPolicer, TransportListenIp, TransportTcpConnectionStat,
+    TransportTuple, TransportUdpSocketStat,
 };
 use crate::messages::{
     TransportCloseRequest, TransportConnectRequestWebRtcData, TransportConnectWebRtcRequest,
@@ -121,6 +122,15 @@ pub struct WebRtcTransportOptions {
     /// Maximum SCTP send buffer used by DataConsumers.
     /// Default 262144.
     pub sctp_send_buffer_size: u32,
+    /// Share (between 0 and 1) of the estimated outgoing bitrate for SCTP packets. If given, they
+    /// are paced along with the media (once there is bandwidth estimation), so large DataChannel
+    /// transfers do not cause queueing delay to the media.
+    /// Default none (not paced).
+    pub sctp_bitrate_share: Option<f32>,
+    /// Limits of the received packets, applied before parsing them. STUN packets from tuples not
+    /// validated by ICE are always rate limited.
+    /// Default none.
+    pub ingress_policer: Option<TransportIngressPolicer>,
     /// Custom application data.
     pub app_data: AppData,
 }
@@ -141,6 +151,8 @@ impl WebRtcTransportOptions {
             num_sctp_streams: NumSctpStreams::default(),
             max_sctp_message_size: 262_144,
             sctp_send_buffer_size: 262_144,
+            sctp_bitrate_share: None,
+            ingress_policer: None,
             app_data: AppData::default(),
         }
     }
@@ -212,12 +224,38 @@ pub struct WebRtcTransportStat {
     pub rtp_packet_loss_received: Option<f64>,
     #[serde(skip_serializing_if = "Option::is_none")]
     pub rtp_packet_loss_sent: Option<f64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub ecn_ce_packets_received: Option<u64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub ecn_ce_packets_sent: Option<u64>,
+    pub cpu_ms_per_second: f64,
     // WebRtcTransport specific.
     pub ice_role: IceRole,
     pub ice_state: IceState,
     #[serde(skip_serializing_if = "Option::is_none")]
     pub ice_selected_tuple: Option<TransportTuple>,
+    pub ice_tuple_count: usize,
     pub dtls_state: DtlsState,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub udp_socket: Option<TransportUdpSocketStat>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub tcp_connection: Option<TransportTcpConnectionStat>,
+    pub ingress_drops: TransportIngressDrops,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub join_latency: Option<WebRtcTransportJoinLatency>,
+}
+
+/// Duration (ms) of the phases done so far until the [`WebRtcTransport`] got connected.
+#[derive(Debug, Clone, PartialEq, Eq, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[non_exhaustive]
+pub struct WebRtcTransportJoinLatency {
+    /// Since the transport creation until the first ICE Binding request.
+    pub ice_binding_ms: u64,
+    /// Since the first ICE Binding request until ICE connected.
+    pub ice_connect_ms: Option<u64>,
+    /// Since ICE connected until DTLS connected.
+    pub dtls_connect_ms: Option<u64>,
 }
 
 /// Remote parameters for [`WebRtcTransport`].
@@ -270,6 +270,9 @@ pub enum MimeTypeVideo {
     /// H265
     #[serde(rename = "video/H265")]
     H265,
+    /// AV1
+    #[serde(rename = "video/AV1")]
+    Av1,
     /// RTX
     #[serde(rename = "video/rtx")]
     Rtx,
@@ -420,6 +423,11 @@ pub enum RtpHeaderExtensionUri {
     /// urn:ietf:params:rtp-hdrext:framemarking
     #[serde(rename = "urn:ietf:params:rtp-hdrext:framemarking")]
     FrameMarking,
+    /// <https://aomediacodec.github.io/av1-rtp-spec/#dependency-descriptor-rtp-header-extension>
+    #[serde(
+        rename = "https://aomediacodec.github.io/av1-rtp-spec/#dependency-descriptor-rtp-header-extension"
+    )]
+    DependencyDescriptor,
     /// urn:ietf:params:rtp-hdrext:ssrc-audio-level
     #[serde(rename = "urn:ietf:params:rtp-hdrext:ssrc-audio-level")]
     AudioLevel,
@@ -457,6 +465,9 @@ impl RtpHeaderExtensionUri {
                 "http://tools.ietf.org/html/draft-ietf-avtext-framemarking-07"
             }
             RtpHeaderExtensionUri::FrameMarking => "urn:ietf:params:rtp-hdrext:framemarking",
+            RtpHeaderExtensionUri::DependencyDescriptor => {
+                "https://aomediacodec.github.io/av1-rtp-spec/#dependency-descriptor-rtp-header-extension"
+            }
             RtpHeaderExtensionUri::AudioLevel => "urn:ietf:params:rtp-hdrext:ssrc-audio-level",
             RtpHeaderExtensionUri::VideoOrientation => "urn:3gpp:video-orientation",
             RtpHeaderExtensionUri::TimeOffset => "urn:ietf:params:rtp-hdrext:toffset",
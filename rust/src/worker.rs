@@ -8,7 +8,8 @@ mod utils;
 
 use crate::data_structures::AppData;
 use crate::messages::{
-    RouterInternal, WorkerCloseRequest, WorkerCreateRouterRequest, WorkerDumpRequest,
+    RouterInternal, WorkerCloseRequest, WorkerCreateRouterData, WorkerCreateRouterRequest,
+    WorkerDumpRequest, WorkerEnableStateStreamData, WorkerEnableStateStreamRequest,
     WorkerUpdateSettingsRequest,
 };
 pub use crate::ortc::RtpCapabilitiesError;
@@ -154,6 +155,38 @@ impl WorkerLogTag {
     }
 }
 
+/// Backend of the packet I/O of the UDP sockets and TCP connections of the worker.
+///
+/// Default [`WorkerPacketIo::Libuv`].
+#[derive(Debug, Copy, Clone, Eq, PartialEq, Ord, PartialOrd, Hash, Serialize)]
+#[serde(rename_all = "snake_case")]
+pub enum WorkerPacketIo {
+    /// libuv reads and `sendmmsg()`.
+    Libuv,
+    /// io_uring multishot receive and batched UDP send submitted once per loop iteration
+    /// (Linux >= 6.0, falls back to libuv otherwise).
+    IoUring,
+    /// Same as [`WorkerPacketIo::IoUring`] with a kernel thread polling the submission ring, so
+    /// sending needs no syscall (it uses a CPU core while there is traffic).
+    IoUringSqPoll,
+}
+
+impl Default for WorkerPacketIo {
+    fn default() -> Self {
+        Self::Libuv
+    }
+}
+
+impl WorkerPacketIo {
+    fn as_str(self) -> &'static str {
+        match self {
+            Self::Libuv => "libuv",
+            Self::IoUring => "io_uring",
+            Self::IoUringSqPoll => "io_uring_sqpoll",
+        }
+    }
+}
+
 /// DTLS certificate and private key.
 #[derive(Debug, Clone)]
 pub struct WorkerDtlsFiles {
@@ -180,6 +213,198 @@ pub struct WorkerSettings {
     ///
     /// If `None`, a certificate is dynamically created.
     pub dtls_files: Option<WorkerDtlsFiles>,
+    /// Directory in which the dynamically created DTLS certificate is cached, so workers in the
+    /// host reuse it instead of creating their own (which speeds up their startup). It's rotated
+    /// before it expires. Ignored if `dtls_files` is given.
+    ///
+    /// Workers running in the same process always share it.
+    pub dtls_certificate_cache_dir: Option<PathBuf>,
+    /// Number of threads (up to 16) encrypting outgoing SRTP packets of WebRTC transports off the
+    /// worker thread. Useful when a single worker sends lots of media.
+    ///
+    /// Default `0` (encrypt in the worker thread).
+    pub srtp_encrypt_threads: u8,
+    /// Number of threads (up to 16) decrypting incoming SRTP and SRTCP packets received over UDP
+    /// by WebRTC transports off the worker thread. Useful when a single worker receives lots of
+    /// media.
+    ///
+    /// Default `0` (decrypt in the worker thread).
+    pub srtp_decrypt_threads: u8,
+    /// Number of threads (up to 16) running DTLS handshakes of WebRTC transports off the worker
+    /// thread, so many peers joining at once do not delay media forwarding.
+    ///
+    /// Default `0` (run them in the worker thread).
+    pub dtls_handshake_threads: u8,
+    /// Let DTLS clients of WebRTC transports resume their previous session (with session tickets
+    /// whose keys are owned by the worker and rotated every hour) so reconnecting takes an
+    /// abbreviated handshake. Full and resumed handshakes are counted in the worker dump.
+    ///
+    /// Default `false`.
+    pub dtls_session_resumption: bool,
+    /// Make DTLS just offer ECDHE-ECDSA cipher suites and X25519/P-256 key exchange, which take
+    /// less CPU per handshake. It requires a P-256 ECDSA certificate if `dtls_files` are given
+    /// (generated ones always are).
+    ///
+    /// Default `false`.
+    pub dtls_ecdsa_only: bool,
+    /// Negotiate DTLS 1.3 with peers supporting it (falling back to DTLS 1.2), which needs one
+    /// round trip less to complete the handshake. It requires the worker to be linked against an
+    /// SSL library supporting DTLS 1.3, otherwise DTLS 1.2 is used.
+    ///
+    /// Default `false`.
+    pub dtls13: bool,
+    /// Maximum number of log lines per second the worker emits with each log tag. Exceeding lines
+    /// are dropped and their number is reported in a warning.
+    ///
+    /// Default `0` (no limit).
+    pub log_rate_limit: u32,
+    /// File into which the worker writes its log lines (appended) from a helper thread instead of
+    /// sending them to this process, so they are not emitted as logs. Error lines are sent anyway.
+    pub log_file: Option<PathBuf>,
+    /// File in which the worker writes, every second, the stats of its transports and of the RTP
+    /// streams of its producers and consumers as fixed size binary records (see
+    /// `worker/include/StatsRegion.hpp`), so they can be sampled without requests to the worker.
+    /// The file is removed when the worker closes.
+    pub stats_file: Option<PathBuf>,
+    /// Measure the time RTP packets spend in the worker, given in the stats of transports and
+    /// consumers (`forwardingLatency`) and in the resource usage (`sendQueueDelay`).
+    ///
+    /// Default `false`.
+    pub forwarding_latency: bool,
+    /// Shed load when the worker is overloaded (high event loop utilization or lag): first
+    /// retransmissions are not sent, then simulcast and SVC consumers are limited to lower layers
+    /// and finally video consumers with priority 1 are paused.
+    ///
+    /// Default `false`.
+    pub overload_protection: bool,
+    /// Feed the REMB bandwidth estimator of transports with one of every N received RTP packets
+    /// (from 1 to 16), trading estimation accuracy for CPU.
+    ///
+    /// Default `1` (all packets).
+    pub remb_sampling: u8,
+    /// Maximum number of transports probing the bandwidth at the same time, so many transports
+    /// starting at once don't cause CPU spikes. Others wait until one of them is done.
+    ///
+    /// Default `0` (no limit).
+    pub max_probing_transports: u32,
+    /// Maximum number of key frame requests (PLI/FIR) per second sent to the producers of a
+    /// transport. Requests over it are delayed and spread over time.
+    ///
+    /// Default `0` (no limit).
+    pub max_key_frame_requests_per_transport: u32,
+    /// Maximum number of key frame requests (PLI/FIR) per second sent to the producers of all the
+    /// transports of a router.
+    ///
+    /// Default `0` (no limit).
+    pub max_key_frame_requests_per_router: u32,
+    /// CPU cores the helper threads of the worker (SRTP encrypt and DTLS handshake threads) are
+    /// pinned to, in round robin (Linux only).
+    ///
+    /// Default empty (not pinned).
+    pub helper_cpu_affinity: Vec<u32>,
+    /// Allocate memory in the NUMA node of the CPU core running the worker thread (Linux only).
+    /// Useful when the worker thread is pinned with `thread_initializer`.
+    ///
+    /// Default `false`.
+    pub numa_local_memory: bool,
+    /// Allocate the long lived objects of each transport (producers, consumers, their RTP
+    /// streams, ICE and DTLS state) in a memory arena of the transport, so they are contiguous in
+    /// memory and released in bulk when the transport is closed.
+    ///
+    /// Default `false`.
+    pub transport_arenas: bool,
+    /// Trust the frame-marking RTP header extension of H264 packets when present, so their
+    /// payload is not inspected to detect key frames. Not suitable if some endpoint does not set
+    /// the independent flag in key frames (as libwebrtc with some hardware encoders).
+    ///
+    /// Default `false`.
+    pub trust_frame_marking: bool,
+    /// Estimate the outgoing bandwidth of transports using transport-cc with the native mediasoup
+    /// estimator (delay gradient, loss and application limited region detection) instead of the
+    /// libwebrtc one, which takes more memory and CPU per transport. Transports using REMB are not
+    /// affected.
+    ///
+    /// Default `false`.
+    pub native_bandwidth_estimator: bool,
+    /// Run SCTP (DataChannels) with the native mediasoup SCTP implementation instead of usrsctp,
+    /// which takes less memory and CPU per association and has no global state. Non WebRTC SCTP
+    /// peers that reset their incoming streams are not supported.
+    ///
+    /// Default `false`.
+    pub native_sctp: bool,
+    /// Run the worker thread with `SCHED_FIFO` real-time scheduling with the given priority (from
+    /// 1 to 99, Linux only). It requires the `CAP_SYS_NICE` capability.
+    ///
+    /// Default `0` (normal scheduling).
+    pub realtime_priority: u8,
+    /// Nice value (from -20 to 19) of the worker thread (Linux only). Negative values require the
+    /// `CAP_SYS_NICE` capability.
+    ///
+    /// Default `0` (inherited).
+    pub niceness: i8,
+    /// Backend of the packet I/O of the UDP sockets.
+    ///
+    /// Default [`WorkerPacketIo::Libuv`].
+    pub packet_io: WorkerPacketIo,
+    /// Number of UDP and TCP sockets kept bound in random ports of each listen IP (once a
+    /// transport has been created in it), so new transports take them instead of binding sockets
+    /// while their creation request is processed. Sockets are bound again in next event loop
+    /// iterations.
+    ///
+    /// Default `0` (disabled).
+    pub socket_pool_size: u32,
+    /// Size (in bytes) of the kernel receive buffer of the UDP sockets (limited by
+    /// `net.core.rmem_max` in Linux). Increase it if bursts of high bitrate streams are dropped by
+    /// the kernel (see the `recv_drops` field in transport stats).
+    ///
+    /// Default `0` (OS default).
+    pub udp_recv_buffer_size: u32,
+    /// Size (in bytes) of the kernel send buffer of the UDP sockets (limited by
+    /// `net.core.wmem_max` in Linux).
+    ///
+    /// Default `0` (OS default).
+    pub udp_send_buffer_size: u32,
+    /// Whether received RTP packets are stamped with the time the kernel received them, so
+    /// transport-cc feedback (and REMB) and the jitter of received streams reflect the network and
+    /// not the time packets wait in a loaded worker. Just for UDP sockets read with io_uring (see
+    /// `packet_io`).
+    ///
+    /// Default `false`.
+    pub kernel_recv_timestamps: bool,
+    /// Whether packets sent over UDP sockets are marked as ECN capable (ECT(0)) and CE marks in
+    /// received ones are reported back via RTCP ECN feedback (RFC 6679), so congestion reported by
+    /// the network is handled as packet loss by the send side bandwidth estimation. Reading
+    /// received marks just works for UDP sockets read with io_uring (see `packet_io`).
+    ///
+    /// Default `false`.
+    pub ecn: bool,
+    /// Whether TCP connections of WebRTC transports and WebRTC servers also accept TURN clients
+    /// (using TCP transport), which is useful for clients that can just reach the worker through a
+    /// TURN server. Allocations are terminated in the worker, so they can just be used to send data
+    /// to it and the client must be given a TURN server URL pointing to the TCP listen port. No
+    /// authentication is required.
+    ///
+    /// Default `false`.
+    pub turn_over_tcp: bool,
+    /// Bitrate (in bps) at which the video sent by all the transports of the worker is smoothed,
+    /// so bursts (such as a key frame sent to many consumers at once) are spread over time instead
+    /// of leaving the NIC at once. Transports using transport-cc hold the packets in their pacers
+    /// and the rest in a queue shared by the worker. It should be well above the expected video
+    /// egress of the worker.
+    ///
+    /// Default `0` (disabled).
+    pub egress_bitrate: u32,
+    /// Duration (in ms) of the burst allowed by `egress_bitrate`.
+    ///
+    /// Default `20`.
+    pub egress_burst_ms: u32,
+    /// Time (in microseconds) during which the event loop of the worker keeps polling with no
+    /// timeout (spinning) once there are no more events, before blocking, so events arriving
+    /// meanwhile do not suffer the wake up latency. It's also set as `SO_BUSY_POLL` in UDP sockets
+    /// (Linux). It costs CPU, so it is meant for workers in dedicated cores.
+    ///
+    /// Default `0` (disabled).
+    pub busy_poll_us: u32,
     /// Function that will be called under worker thread before worker starts, can be used for
     /// pinning worker threads to CPU cores.
     pub thread_initializer: Option<Arc<dyn Fn() + Send + Sync>>,
@@ -194,6 +419,40 @@ impl Default for WorkerSettings {
             log_tags: Vec::new(),
             rtc_ports_range: 10000..=59999,
             dtls_files: None,
+            dtls_certificate_cache_dir: None,
+            srtp_encrypt_threads: 0,
+            srtp_decrypt_threads: 0,
+            dtls_handshake_threads: 0,
+            dtls_session_resumption: false,
+            dtls_ecdsa_only: false,
+            dtls13: false,
+            log_rate_limit: 0,
+            log_file: None,
+            stats_file: None,
+            forwarding_latency: false,
+            overload_protection: false,
+            remb_sampling: 1,
+            max_probing_transports: 0,
+            max_key_frame_requests_per_transport: 0,
+            max_key_frame_requests_per_router: 0,
+            helper_cpu_affinity: Vec::new(),
+            numa_local_memory: false,
+            transport_arenas: false,
+            trust_frame_marking: false,
+            native_bandwidth_estimator: false,
+            native_sctp: false,
+            realtime_priority: 0,
+            niceness: 0,
+            packet_io: WorkerPacketIo::default(),
+            socket_pool_size: 0,
+            udp_recv_buffer_size: 0,
+            udp_send_buffer_size: 0,
+            kernel_recv_timestamps: false,
+            ecn: false,
+            turn_over_tcp: false,
+            egress_bitrate: 0,
+            egress_burst_ms: 20,
+            busy_poll_us: 0,
             thread_initializer: None,
             app_data: AppData::default(),
         }
@@ -207,6 +466,40 @@ impl fmt::Debug for WorkerSettings {
             log_tags,
             rtc_ports_range,
             dtls_files,
+            dtls_certificate_cache_dir,
+            srtp_encrypt_threads,
+            srtp_decrypt_threads,
+            dtls_handshake_threads,
+            dtls_session_resumption,
+            dtls_ecdsa_only,
+            dtls13,
+            log_rate_limit,
+            log_file,
+            stats_file,
+            forwarding_latency,
+            overload_protection,
+            remb_sampling,
+            max_probing_transports,
+            max_key_frame_requests_per_transport,
+            max_key_frame_requests_per_router,
+            helper_cpu_affinity,
+            numa_local_memory,
+            transport_arenas,
+            trust_frame_marking,
+            native_bandwidth_estimator,
+            native_sctp,
+            realtime_priority,
+            niceness,
+            packet_io,
+            socket_pool_size,
+            udp_recv_buffer_size,
+            udp_send_buffer_size,
+            kernel_recv_timestamps,
+            ecn,
+            turn_over_tcp,
+            egress_bitrate,
+            egress_burst_ms,
+            busy_poll_us,
             thread_initializer,
             app_data,
         } = self;
@@ -216,6 +509,46 @@ impl fmt::Debug for WorkerSettings {
             .field("log_tags", &log_tags)
             .field("rtc_ports_range", &rtc_ports_range)
             .field("dtls_files", &dtls_files)
+            .field("dtls_certificate_cache_dir", &dtls_certificate_cache_dir)
+            .field("srtp_encrypt_threads", &srtp_encrypt_threads)
+            .field("srtp_decrypt_threads", &srtp_decrypt_threads)
+            .field("dtls_handshake_threads", &dtls_handshake_threads)
+            .field("dtls_session_resumption", &dtls_session_resumption)
+            .field("dtls_ecdsa_only", &dtls_ecdsa_only)
+            .field("dtls13", &dtls13)
+            .field("log_rate_limit", &log_rate_limit)
+            .field("log_file", &log_file)
+            .field("stats_file", &stats_file)
+            .field("forwarding_latency", &forwarding_latency)
+            .field("overload_protection", &overload_protection)
+            .field("remb_sampling", &remb_sampling)
+            .field("max_probing_transports", &max_probing_transports)
+            .field(
+                "max_key_frame_requests_per_transport",
+                &max_key_frame_requests_per_transport,
+            )
+            .field(
+                "max_key_frame_requests_per_router",
+                &max_key_frame_requests_per_router,
+            )
+            .field("helper_cpu_affinity", &helper_cpu_affinity)
+            .field("numa_local_memory", &numa_local_memory)
+            .field("transport_arenas", &transport_arenas)
+            .field("trust_frame_marking", &trust_frame_marking)
+            .field("native_bandwidth_estimator", &native_bandwidth_estimator)
+            .field("native_sctp", &native_sctp)
+            .field("realtime_priority", &realtime_priority)
+            .field("niceness", &niceness)
+            .field("packet_io", &packet_io)
+            .field("socket_pool_size", &socket_pool_size)
+            .field("udp_recv_buffer_size", &udp_recv_buffer_size)
+            .field("udp_send_buffer_size", &udp_send_buffer_size)
+            .field("kernel_recv_timestamps", &kernel_recv_timestamps)
+            .field("ecn", &ecn)
+            .field("turn_over_tcp", &turn_over_tcp)
+            .field("egress_bitrate", &egress_bitrate)
+            .field("egress_burst_ms", &egress_burst_ms)
+            .field("busy_poll_us", &busy_poll_us)
             .field(
                 "thread_initializer",
                 &thread_initializer.as_ref().map(|_| "ThreadInitializer"),
@@ -239,6 +572,15 @@ pub struct WorkerUpdateSettings {
     ///
     /// If `None`, log tags will not be updated.
     pub log_tags: Option<Vec<WorkerLogTag>>,
+    /// Size (in bytes) of the kernel receive buffer of the UDP sockets, applied to the open ones
+    /// too.
+    ///
+    /// If `None`, it will not be updated.
+    pub udp_recv_buffer_size: Option<u32>,
+    /// Size (in bytes) of the kernel send buffer of the UDP sockets, applied to the open ones too.
+    ///
+    /// If `None`, it will not be updated.
+    pub udp_send_buffer_size: Option<u32>,
 }
 
 #[derive(Debug, Clone, Deserialize, Serialize)]
@@ -248,6 +590,113 @@ pub struct WorkerUpdateSettings {
 pub struct WorkerDump {
     // Dump has `pid` field too, but it is useless here because of thead-based worker usage
     pub router_ids: Vec<RouterId>,
+    pub udp_recv_batching: WorkerUdpBatching,
+    pub udp_send_batching: WorkerUdpBatching,
+    pub placement: WorkerPlacement,
+    pub packet_io: WorkerPacketIoDump,
+    pub dtls_handshakes: WorkerDtlsHandshakes,
+}
+
+/// DTLS handshakes completed by the WebRTC transports of the worker.
+#[derive(Debug, Default, Clone, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[doc(hidden)]
+#[non_exhaustive]
+pub struct WorkerDtlsHandshakes {
+    /// Whether DTLS session resumption is enabled.
+    pub session_resumption: bool,
+    /// Number of full handshakes.
+    pub full: u64,
+    /// Number of abbreviated handshakes resuming a previous session.
+    pub resumed: u64,
+    /// Whether DTLS just uses ECDHE-ECDSA cipher suites.
+    pub ecdsa_only: bool,
+    /// CPU time (in ns) taken by full handshakes.
+    pub full_cpu_time: WorkerDtlsHandshakeCpuTime,
+    /// CPU time (in ns) taken by resumed handshakes.
+    pub resumed_cpu_time: WorkerDtlsHandshakeCpuTime,
+}
+
+/// Distribution of the CPU time (in ns) taken by DTLS handshakes.
+#[derive(Debug, Default, Clone, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[doc(hidden)]
+#[non_exhaustive]
+pub struct WorkerDtlsHandshakeCpuTime {
+    pub count: u64,
+    pub mean: f64,
+    pub max: u64,
+    pub p50: u64,
+    pub p90: u64,
+    pub p99: u64,
+    pub p999: u64,
+}
+
+/// Packet I/O backend of the UDP sockets of the worker and its stats.
+#[derive(Debug, Default, Clone, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[doc(hidden)]
+#[non_exhaustive]
+pub struct WorkerPacketIoDump {
+    /// Backend in use ("libuv" or "io_uring").
+    pub backend: String,
+    /// Whether a kernel thread polls the submission ring.
+    pub sq_poll: Option<bool>,
+    /// Whether UDP GSO was disabled after a failure.
+    pub gso_disabled: Option<bool>,
+    /// Number of `io_uring_enter()` syscalls done to submit requests.
+    pub submit_calls: Option<u64>,
+    /// Number of received datagrams (or TCP reads).
+    pub recv_completions: Option<u64>,
+    /// Number of sent messages.
+    pub send_completions: Option<u64>,
+    /// Number of failed sent messages.
+    pub send_errors: Option<u64>,
+    /// Number of received datagrams dropped for being too big.
+    pub truncated_datagrams: Option<u64>,
+    /// Number of sockets (UDP and TCP) reading with io_uring.
+    pub recv_sockets: Option<u64>,
+    /// Number of send batches not completed yet.
+    pub pending_send_batches: Option<u64>,
+}
+
+/// Effective placement and scheduling of the worker thread (Linux only, fields are `None`
+/// elsewhere).
+#[derive(Debug, Default, Clone, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[doc(hidden)]
+#[non_exhaustive]
+pub struct WorkerPlacement {
+    /// CPU core the worker thread was running on.
+    pub cpu: Option<u32>,
+    /// NUMA node of that CPU core.
+    pub numa_node: Option<u32>,
+    /// CPU cores the worker thread may run on.
+    pub cpu_affinity: Option<Vec<u32>>,
+    /// CPU cores helper threads are pinned to.
+    pub helper_cpu_affinity: Option<Vec<u32>>,
+    /// Whether memory is allocated in the local NUMA node.
+    pub numa_local_memory: Option<bool>,
+    /// Scheduling policy ("fifo", "rr" or "other").
+    pub sched_policy: Option<String>,
+    /// Scheduling priority.
+    pub sched_priority: Option<u8>,
+    /// Nice value.
+    pub niceness: Option<i8>,
+}
+
+/// UDP batching stats (recvmmsg/sendmmsg) of all the UDP sockets in the worker.
+#[derive(Debug, Copy, Clone, Deserialize, Serialize)]
+#[serde(rename_all = "camelCase")]
+#[doc(hidden)]
+#[non_exhaustive]
+pub struct WorkerUdpBatching {
+    /// Number of read wakeups (or send syscalls) that handled at least one datagram.
+    pub batches: u64,
+    /// Number of datagrams handled by them.
+    pub datagrams: u64,
+    /// Average number of datagrams per batch.
+    pub average_batch_size: f64,
 }
 
 /// Error that caused [`Worker::create_router`] to fail.
@@ -297,6 +746,40 @@ impl Inner {
             log_tags,
             rtc_ports_range,
             dtls_files,
+            dtls_certificate_cache_dir,
+            srtp_encrypt_threads,
+            srtp_decrypt_threads,
+            dtls_handshake_threads,
+            dtls_session_resumption,
+            dtls_ecdsa_only,
+            dtls13,
+            log_rate_limit,
+            log_file,
+            stats_file,
+            forwarding_latency,
+            overload_protection,
+            remb_sampling,
+            max_probing_transports,
+            max_key_frame_requests_per_transport,
+            max_key_frame_requests_per_router,
+            helper_cpu_affinity,
+            numa_local_memory,
+            transport_arenas,
+            trust_frame_marking,
+            native_bandwidth_estimator,
+            native_sctp,
+            realtime_priority,
+            niceness,
+            packet_io,
+            socket_pool_size,
+            udp_recv_buffer_size,
+            udp_send_buffer_size,
+            kernel_recv_timestamps,
+            ecn,
+            turn_over_tcp,
+            egress_bitrate,
+            egress_burst_ms,
+            busy_poll_us,
             thread_initializer,
             app_data,
         }: WorkerSettings,
@@ -338,6 +821,167 @@ impl Inner {
             ));
         }
 
+        if let Some(dtls_certificate_cache_dir) = dtls_certificate_cache_dir {
+            spawn_args.push(format!(
+                "--dtlsCertificateCacheDir={}",
+                dtls_certificate_cache_dir
+                    .to_str()
+                    .expect("Paths are only expected to be utf8")
+            ));
+        }
+
+        if srtp_encrypt_threads > 0 {
+            spawn_args.push(format!("--srtpEncryptThreads={}", srtp_encrypt_threads));
+        }
+
+        if srtp_decrypt_threads > 0 {
+            spawn_args.push(format!("--srtpDecryptThreads={}", srtp_decrypt_threads));
+        }
+
+        if dtls_handshake_threads > 0 {
+            spawn_args.push(format!("--dtlsHandshakeThreads={}", dtls_handshake_threads));
+        }
+
+        if dtls_session_resumption {
+            spawn_args.push("--dtlsSessionResumption=true".to_string());
+        }
+
+        if dtls_ecdsa_only {
+            spawn_args.push("--dtlsEcdsaOnly=true".to_string());
+        }
+
+        if dtls13 {
+            spawn_args.push("--dtls13=true".to_string());
+        }
+
+        if log_rate_limit > 0 {
+            spawn_args.push(format!("--logRateLimit={}", log_rate_limit));
+        }
+
+        if let Some(log_file) = log_file {
+            spawn_args.push(format!(
+                "--logFile={}",
+                log_file
+                    .to_str()
+                    .expect("Paths are only expected to be utf8")
+            ));
+        }
+
+        if let Some(stats_file) = stats_file {
+            spawn_args.push(format!(
+                "--statsFile={}",
+                stats_file
+                    .to_str()
+                    .expect("Paths are only expected to be utf8")
+            ));
+        }
+
+        if forwarding_latency {
+            spawn_args.push("--forwardingLatency".to_string());
+        }
+
+        if overload_protection {
+            spawn_args.push("--overloadProtection".to_string());
+        }
+
+        if remb_sampling > 1 {
+            spawn_args.push(format!("--rembSampling={}", remb_sampling));
+        }
+
+        if max_probing_transports > 0 {
+            spawn_args.push(format!("--maxProbingTransports={}", max_probing_transports));
+        }
+
+        if max_key_frame_requests_per_transport > 0 {
+            spawn_args.push(format!(
+                "--maxKeyFrameRequestsPerTransport={}",
+                max_key_frame_requests_per_transport
+            ));
+        }
+
+        if max_key_frame_requests_per_router > 0 {
+            spawn_args.push(format!(
+                "--maxKeyFrameRequestsPerRouter={}",
+                max_key_frame_requests_per_router
+            ));
+        }
+
+        if !helper_cpu_affinity.is_empty() {
+            spawn_args.push(format!(
+                "--helperCpuAffinity={}",
+                helper_cpu_affinity
+                    .iter()
+                    .map(|cpu| cpu.to_string())
+                    .collect::<Vec<_>>()
+                    .join(",")
+            ));
+        }
+
+        if numa_local_memory {
+            spawn_args.push("--numaLocalMemory=true".to_string());
+        }
+
+        if transport_arenas {
+            spawn_args.push("--transportArenas=true".to_string());
+        }
+
+        if trust_frame_marking {
+            spawn_args.push("--trustFrameMarking=true".to_string());
+        }
+
+        if native_bandwidth_estimator {
+            spawn_args.push("--nativeBandwidthEstimator=true".to_string());
+        }
+
+        if native_sctp {
+            spawn_args.push("--nativeSctp=true".to_string());
+        }
+
+        if realtime_priority > 0 {
+            spawn_args.push(format!("--realtimePriority={}", realtime_priority));
+        }
+
+        if niceness != 0 {
+            spawn_args.push(format!("--niceness={}", niceness));
+        }
+
+        if packet_io != WorkerPacketIo::Libuv {
+            spawn_args.push(format!("--packetIo={}", packet_io.as_str()));
+        }
+
+        if socket_pool_size > 0 {
+            spawn_args.push(format!("--socketPoolSize={}", socket_pool_size));
+        }
+
+        if udp_recv_buffer_size > 0 {
+            spawn_args.push(format!("--udpRecvBufferSize={}", udp_recv_buffer_size));
+        }
+
+        if udp_send_buffer_size > 0 {
+            spawn_args.push(format!("--udpSendBufferSize={}", udp_send_buffer_size));
+        }
+
+        if kernel_recv_timestamps {
+            spawn_args.push("--kernelRecvTimestamps=true".to_string());
+        }
+
+        if ecn {
+            spawn_args.push("--ecn=true".to_string());
+        }
+
+        if turn_over_tcp {
+            spawn_args.push("--turnOverTcp=true".to_string());
+        }
+
+        if egress_bitrate > 0 {
+            spawn_args.push(format!("--egressBitrate={}", egress_bitrate));
+            spawn_args.push(format!("--egressBurstMs={}", egress_burst_ms));
+        }
+
+        if busy_poll_us > 0 {
+            spawn_args.push(format!("--busyPollUs={}", busy_poll_us));
+        }
+
         let id = WorkerId::new();
         debug!(
             "spawning worker with arguments [id:{}]: {}",
@@ -599,6 +1243,21 @@ impl Worker {
             .await
     }
 
+    /// Makes the worker periodically emit a CBOR encoded snapshot of the state of every router
+    /// (transports, producers and consumers) so a hot-standby worker can take over on failure.
+    ///
+    /// `interval` is in milliseconds, `0` disables the stream.
+    pub async fn enable_state_stream(&self, interval: u32) -> Result<(), RequestError> {
+        debug!("enable_state_stream()");
+
+        self.inner
+            .channel
+            .request(WorkerEnableStateStreamRequest {
+                data: WorkerEnableStateStreamData { interval },
+            })
+            .await
+    }
+
     /// Create a Router.
     ///
     /// Worker will be kept alive as long as at least one router instance is alive.
@@ -611,6 +1270,8 @@ impl Worker {
         let RouterOptions {
             app_data,
             media_codecs,
+            audio_last_n,
+            memory_soft_limit,
         } = router_options;
 
         let rtp_capabilities = ortc::generate_router_rtp_capabilities(media_codecs)
@@ -621,12 +1282,21 @@ impl Worker {
 
         let _buffer_guard = self.inner.channel.buffer_messages_for(router_id.into());
 
-        self.inner
+        let response = self
+            .inner
             .channel
-            .request(WorkerCreateRouterRequest { internal })
+            .request(WorkerCreateRouterRequest {
+                internal,
+                data: WorkerCreateRouterData {
+                    audio_last_n,
+                    memory_soft_limit,
+                },
+            })
             .await
             .map_err(CreateRouterError::Request)?;
 
+        debug!("router created [handle:{}]", response.handle);
+
         let router = Router::new(
             router_id,
             Arc::clone(&self.inner.executor),
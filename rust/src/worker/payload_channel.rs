@@ -25,7 +25,11 @@ pub(super) enum InternalMessage {
 #[serde(untagged)]
 enum PayloadChannelReceiveMessage {
     #[serde(rename_all = "camelCase")]
-    Notification { target_id: SubscriptionTarget },
+    Notification {
+        target_id: SubscriptionTarget,
+        #[serde(default)]
+        data: Option<NotificationData>,
+    },
     ResponseSuccess {
         id: u32,
         // The following field is present, unused, but needed for differentiating successful
@@ -45,6 +49,15 @@ enum PayloadChannelReceiveMessage {
     Internal(InternalMessage),
 }
 
+/// Data of a notification sent once for many targets (i.e. a DataChannel message sent to all the
+/// data consumers of a direct transport), which share the payload.
+#[derive(Debug, Deserialize)]
+#[serde(rename_all = "camelCase")]
+struct NotificationData {
+    #[serde(default)]
+    target_ids: Option<Vec<SubscriptionTarget>>,
+}
+
 fn deserialize_message(bytes: &[u8]) -> PayloadChannelReceiveMessage {
     match serde_json::from_slice(bytes) {
         Ok(message) => message,
@@ -207,10 +220,22 @@ impl PayloadChannel {
                 trace!("received raw message: {}", String::from_utf8_lossy(message));
 
                 match deserialize_message(message) {
-                    PayloadChannelReceiveMessage::Notification { target_id } => {
+                    PayloadChannelReceiveMessage::Notification { target_id, data } => {
                         trace!("received notification payload of {} bytes", payload.len());
 
-                        event_handlers.call_callbacks_with_two_values(&target_id, message, payload);
+                        match data.and_then(|data| data.target_ids) {
+                            Some(target_ids) => {
+                                for target_id in &target_ids {
+                                    event_handlers.call_callbacks_with_two_values(
+                                        target_id, message, payload,
+                                    );
+                                }
+                            }
+                            None => {
+                                event_handlers
+                                    .call_callbacks_with_two_values(&target_id, message, payload);
+                            }
+                        }
                     }
                     PayloadChannelReceiveMessage::ResponseSuccess { id, data, .. } => {
                         let sender = requests_container.lock().handlers.remove(&id);
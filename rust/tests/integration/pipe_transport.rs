@@ -728,6 +728,8 @@ fn create_with_enable_srtp_succeeds() {
                     ip: "127.0.0.2".parse().unwrap(),
                     port: 9999,
                     srtp_parameters: None,
+                    memory_pipe_id: None,
+                    tcp_role: None,
                 })
                 .await,
             Err(RequestError::Response { .. }),
@@ -742,6 +744,8 @@ fn create_with_enable_srtp_succeeds() {
                     crypto_suite: SrtpCryptoSuite::AesCm128HmacSha180,
                     key_base64: "ZnQ3eWJraDg0d3ZoYzM5cXN1Y2pnaHU5NWxrZTVv".to_string(),
                 }),
+                memory_pipe_id: None,
+                tcp_role: None,
             })
             .await
             .expect("Failed to establish Pipe transport connection");
@@ -771,6 +775,8 @@ fn create_with_invalid_srtp_parameters_fails() {
                         crypto_suite: SrtpCryptoSuite::AesCm128HmacSha180,
                         key_base64: "ZnQ3eWJraDg0d3ZoYzM5cXN1Y2pnaHU5NWxrZTVv".to_string(),
                     }),
+                    memory_pipe_id: None,
+                    tcp_role: None,
                 })
                 .await,
             Err(RequestError::Response { .. }),
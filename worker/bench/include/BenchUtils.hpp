@@ -0,0 +1,126 @@
+#ifndef MS_BENCH_UTILS_HPP
+#define MS_BENCH_UTILS_HPP
+
+#include "common.hpp"
+#include "Utils.hpp"
+#include <cstring> // std::memset()
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Bench
+{
+	namespace Utils
+	{
+		// Extension ids used by the RTP packets built by FillRtpPacket().
+		constexpr uint8_t MidExtensionId{ 1u };
+		constexpr uint8_t AbsSendTimeExtensionId{ 2u };
+		// Max size of the RTP packets built by FillRtpPacket().
+		constexpr size_t MaxPacketSize{ 1500u };
+
+		/**
+		 * Writes into the given buffer (of at least MaxPacketSize bytes) a VP8 like
+		 * RTP packet [pt:96, mid:"m00"] with one-byte header extensions and a
+		 * payload of the given length, so every benchmark works over the same
+		 * bytes. Returns the length of the packet.
+		 */
+		inline size_t FillRtpPacket(
+		  uint8_t* buffer, uint16_t seq, uint32_t timestamp, uint32_t ssrc, size_t payloadLen)
+		{
+			// clang-format off
+			const uint8_t header[] =
+			{
+				0x90, 0x60, 0x00, 0x00, // V=2, X=1, PT=96, seq
+				0x00, 0x00, 0x00, 0x00, // timestamp
+				0x00, 0x00, 0x00, 0x00, // ssrc
+				0xBE, 0xDE, 0x00, 0x02, // One-Byte extensions, 2 words
+				0x12, 'm',  '0',  '0',  // id:1 (mid), len:3
+				0x22, 0x12, 0x34, 0x56  // id:2 (abs-send-time), len:3
+			};
+			// clang-format on
+
+			const size_t len = std::min(sizeof(header) + payloadLen, MaxPacketSize);
+
+			std::memcpy(buffer, header, sizeof(header));
+			std::memset(buffer + sizeof(header), 0xAB, len - sizeof(header));
+
+			::Utils::Byte::Set2Bytes(buffer, 2, seq);
+			::Utils::Byte::Set4Bytes(buffer, 4, timestamp);
+			::Utils::Byte::Set4Bytes(buffer, 8, ssrc);
+
+			return len;
+		}
+
+		/**
+		 * Reads the given file of the test data directory (so the benchmark must be
+		 * run from the worker directory) into the given buffer. Returns the length
+		 * of the file or 0 if it cannot be read.
+		 */
+		inline size_t ReadTestDataFile(const std::string& file, uint8_t* buffer, size_t bufferLen)
+		{
+			std::ifstream in("test/data/" + file, std::ios::ate | std::ios::binary);
+
+			if (!in)
+				return 0u;
+
+			const auto len = static_cast<size_t>(in.tellg());
+
+			if (len > bufferLen)
+				return 0u;
+
+			in.seekg(0, std::ios::beg);
+			in.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(len));
+
+			return len;
+		}
+
+		/**
+		 * Reads every file (up to MaxPacketSize bytes) of the given directories of
+		 * the worker directory (such as the fuzzer corpora), so the benchmark must
+		 * be run from the worker directory. Missing directories are skipped.
+		 */
+		inline std::vector<std::vector<uint8_t>> ReadCorpus(const std::vector<std::string>& dirs)
+		{
+			std::vector<std::vector<uint8_t>> corpus;
+
+			for (const auto& dir : dirs)
+			{
+				std::error_code ec;
+
+				for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+				{
+					if (!entry.is_regular_file(ec))
+						continue;
+
+					std::ifstream in(entry.path(), std::ios::ate | std::ios::binary);
+
+					if (!in)
+						continue;
+
+					const auto len = static_cast<size_t>(in.tellg());
+
+					if (len == 0u || len > MaxPacketSize)
+						continue;
+
+					std::vector<uint8_t> data(len);
+
+					in.seekg(0, std::ios::beg);
+					in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(len));
+
+					corpus.push_back(std::move(data));
+				}
+			}
+
+			return corpus;
+		}
+
+		/**
+		 * Number of heap allocations (operator new calls) done so far by the
+		 * benchmark binary.
+		 */
+		size_t GetNumAllocations();
+	} // namespace Utils
+} // namespace Bench
+
+#endif
@@ -0,0 +1,151 @@
+#include "common.hpp"
+#include "BenchUtils.hpp"
+#include "RTC/RTCP/Packet.hpp"
+#include "RTC/RtpPacket.hpp"
+#include "RTC/StunPacket.hpp"
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace RTC;
+
+namespace
+{
+	// Same corpora the fuzzer runs over (see `make fuzzer-run-all`), so parsers
+	// are measured over real world and malformed input.
+	const std::string CorporaDir{ "deps/webrtc-fuzzer-corpora/corpora/" };
+	const std::string NewCorpusDir{ "fuzzer/new-corpus" };
+
+	size_t parseRtp(const std::vector<uint8_t>& data)
+	{
+		if (!RtpPacket::IsRtp(data.data(), data.size()))
+			return 0u;
+
+		auto* packet = RtpPacket::Parse(data.data(), data.size());
+
+		if (!packet)
+			return 0u;
+
+		delete packet;
+
+		return 1u;
+	}
+
+	size_t parseStun(const std::vector<uint8_t>& data)
+	{
+		if (!StunPacket::IsStun(data.data(), data.size()))
+			return 0u;
+
+		auto* packet = StunPacket::Parse(data.data(), data.size());
+
+		if (!packet)
+			return 0u;
+
+		delete packet;
+
+		return 1u;
+	}
+
+	size_t parseRtcp(const std::vector<uint8_t>& data)
+	{
+		if (!RTCP::Packet::IsRtcp(data.data(), data.size()))
+			return 0u;
+
+		auto* packet = RTCP::Packet::Parse(data.data(), data.size());
+		size_t numPackets{ 0u };
+
+		while (packet)
+		{
+			auto* nextPacket = packet->GetNext();
+
+			delete packet;
+
+			packet = nextPacket;
+			numPackets++;
+		}
+
+		return numPackets;
+	}
+
+	size_t parseCorpus(
+	  const std::vector<std::vector<uint8_t>>& corpus,
+	  const std::function<size_t(const std::vector<uint8_t>&)>& parse)
+	{
+		size_t numParsed{ 0u };
+
+		for (const auto& data : corpus)
+		{
+			numParsed += parse(data);
+		}
+
+		return numParsed;
+	}
+
+	// Catch2 reports the time of a pass over the whole corpus, so also report
+	// the time and the heap allocations per packet.
+	void reportPerPacket(
+	  const std::string& name,
+	  const std::vector<std::vector<uint8_t>>& corpus,
+	  const std::function<size_t(const std::vector<uint8_t>&)>& parse)
+	{
+		static constexpr size_t NumPasses{ 1000u };
+
+		if (corpus.empty())
+			return;
+
+		size_t numParsed{ 0u };
+		const auto numAllocations = Bench::Utils::GetNumAllocations();
+		const auto start          = std::chrono::steady_clock::now();
+
+		for (size_t i{ 0u }; i < NumPasses; ++i)
+		{
+			numParsed += parseCorpus(corpus, parse);
+		}
+
+		const auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		                         std::chrono::steady_clock::now() - start)
+		                         .count();
+		const auto numPackets = corpus.size() * NumPasses;
+
+		WARN(
+		  name << ": " << corpus.size() << " packets (" << numParsed / NumPasses << " parsed), "
+		       << static_cast<double>(elapsedNs) / numPackets << " ns/packet, "
+		       << static_cast<double>(Bench::Utils::GetNumAllocations() - numAllocations) / numPackets
+		       << " allocations/packet");
+	}
+} // namespace
+
+TEST_CASE("Parsers over fuzzer corpora", "[bench][corpus]")
+{
+	const auto rtpCorpus  = Bench::Utils::ReadCorpus({ CorporaDir + "rtp-corpus", NewCorpusDir });
+	const auto stunCorpus = Bench::Utils::ReadCorpus({ CorporaDir + "stun-corpus", NewCorpusDir });
+	const auto rtcpCorpus = Bench::Utils::ReadCorpus({ CorporaDir + "rtcp-corpus", NewCorpusDir });
+
+	if (rtpCorpus.empty() && stunCorpus.empty() && rtcpCorpus.empty())
+	{
+		WARN("no corpus found, the benchmark must be run from the worker directory");
+
+		return;
+	}
+
+	BENCHMARK("RtpPacket::Parse")
+	{
+		return parseCorpus(rtpCorpus, parseRtp);
+	};
+
+	BENCHMARK("StunPacket::Parse")
+	{
+		return parseCorpus(stunCorpus, parseStun);
+	};
+
+	BENCHMARK("RTCP::Packet::Parse")
+	{
+		return parseCorpus(rtcpCorpus, parseRtcp);
+	};
+
+	reportPerPacket("RtpPacket::Parse", rtpCorpus, parseRtp);
+	reportPerPacket("StunPacket::Parse", stunCorpus, parseStun);
+	reportPerPacket("RTCP::Packet::Parse", rtcpCorpus, parseRtcp);
+}
@@ -0,0 +1,209 @@
+#include "common.hpp"
+#include "DepLibUV.hpp"
+#include "RTC/DtlsHandshakePool.hpp"
+#include "RTC/DtlsTransport.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm> // std::sort()
+#include <chrono>
+#include <cstdio> // std::printf()
+#include <deque>
+#include <memory> // std::unique_ptr
+#include <vector>
+
+using namespace RTC;
+
+namespace
+{
+	class StormPeer;
+
+	// DTLS datagrams in flight.
+	using Wire = std::deque<std::pair<StormPeer*, std::vector<uint8_t>>>;
+
+	class StormPeer : public DtlsTransport::Listener
+	{
+	public:
+		explicit StormPeer(Wire& wire) : wire(wire), dtlsTransport(new DtlsTransport(this))
+		{
+		}
+
+	public:
+		void OnDtlsTransportConnecting(const DtlsTransport* /*dtlsTransport*/) override
+		{
+		}
+		void OnDtlsTransportConnected(
+		  const DtlsTransport* /*dtlsTransport*/,
+		  SrtpSession::CryptoSuite /*srtpCryptoSuite*/,
+		  uint8_t* /*srtpLocalKey*/,
+		  size_t /*srtpLocalKeyLen*/,
+		  uint8_t* /*srtpRemoteKey*/,
+		  size_t /*srtpRemoteKeyLen*/,
+		  std::string& /*remoteCert*/) override
+		{
+			this->connected = true;
+		}
+		void OnDtlsTransportFailed(const DtlsTransport* /*dtlsTransport*/) override
+		{
+		}
+		void OnDtlsTransportClosed(const DtlsTransport* /*dtlsTransport*/) override
+		{
+		}
+		void OnDtlsTransportSendData(
+		  const DtlsTransport* /*dtlsTransport*/, const uint8_t* data, size_t len) override
+		{
+			this->wire.emplace_back(this->remote, std::vector<uint8_t>(data, data + len));
+		}
+		void OnDtlsTransportApplicationDataReceived(
+		  const DtlsTransport* /*dtlsTransport*/, const uint8_t* /*data*/, size_t /*len*/) override
+		{
+		}
+
+	public:
+		Wire& wire;
+		std::unique_ptr<DtlsTransport> dtlsTransport;
+		StormPeer* remote{ nullptr };
+		bool isServer{ false };
+		bool connected{ false };
+	};
+
+	/**
+	 * Runs numPeers simultaneous DTLS handshakes. Server side DtlsTransports
+	 * play the worker and client side ones play the joining browsers. Returns
+	 * the duration (in microseconds) of every task the worker loop ran for
+	 * the server side, which is what forwarded packets wait for.
+	 */
+	std::vector<double> runJoinStorm(size_t numPeers)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		Wire wire;
+		std::vector<std::unique_ptr<StormPeer>> peers;
+		DtlsTransport::Fingerprint fingerprint;
+
+		for (size_t i{ 0u }; i < numPeers; ++i)
+		{
+			auto* server = new StormPeer(wire);
+			auto* client = new StormPeer(wire);
+
+			if (fingerprint.algorithm == DtlsTransport::FingerprintAlgorithm::NONE)
+			{
+				for (auto& localFingerprint : server->dtlsTransport->GetLocalFingerprints())
+				{
+					if (localFingerprint.algorithm == DtlsTransport::FingerprintAlgorithm::SHA256)
+						fingerprint = localFingerprint;
+				}
+			}
+
+			server->remote   = client;
+			server->isServer = true;
+			client->remote   = server;
+
+			// Same certificate at both sides since they live in the same thread.
+			server->dtlsTransport->SetRemoteFingerprint(fingerprint);
+			client->dtlsTransport->SetRemoteFingerprint(fingerprint);
+
+			peers.emplace_back(server);
+			peers.emplace_back(client);
+		}
+
+		for (auto& peer : peers)
+		{
+			if (peer->isServer)
+				peer->dtlsTransport->Run(DtlsTransport::Role::SERVER);
+		}
+
+		for (auto& peer : peers)
+		{
+			if (!peer->isServer)
+				peer->dtlsTransport->Run(DtlsTransport::Role::CLIENT);
+		}
+
+		std::vector<double> taskDurations;
+		const auto deadline = Clock::now() + std::chrono::seconds(30);
+
+		auto allConnected = [&peers]()
+		{
+			return std::all_of(
+			  peers.begin(), peers.end(), [](const auto& peer) { return peer->connected; });
+		};
+
+		while (!allConnected() && Clock::now() < deadline)
+		{
+			// Deliver datagrams sent so far.
+			Wire inFlight;
+
+			inFlight.swap(wire);
+
+			for (auto& [peer, data] : inFlight)
+			{
+				auto start = Clock::now();
+
+				peer->dtlsTransport->ProcessDtlsData(data.data(), data.size());
+
+				if (peer->isServer)
+				{
+					taskDurations.push_back(
+					  std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+				}
+			}
+
+			// Run DTLS timers and handshake pool callbacks.
+			auto start = Clock::now();
+
+			uv_run(DepLibUV::GetLoop(), UV_RUN_NOWAIT);
+
+			taskDurations.push_back(
+			  std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+		}
+
+		REQUIRE(allConnected());
+
+		peers.clear();
+
+		return taskDurations;
+	}
+
+	void printJoinStorm(size_t numPeers, size_t numThreads)
+	{
+		DtlsHandshakePool::ClassInit(numThreads);
+
+		auto taskDurations = runJoinStorm(numPeers);
+
+		DtlsHandshakePool::ClassDestroy();
+
+		// Let the loop close the handles.
+		uv_run(DepLibUV::GetLoop(), UV_RUN_NOWAIT);
+
+		std::sort(taskDurations.begin(), taskDurations.end());
+
+		auto percentile = [&taskDurations](double p)
+		{ return taskDurations[static_cast<size_t>(p * (taskDurations.size() - 1))]; };
+
+		std::printf(
+		  "join storm [peers:%zu, dtlsHandshakeThreads:%zu]: "
+		  "loop task p50:%.1fus p99:%.1fus max:%.1fus\n",
+		  numPeers,
+		  numThreads,
+		  percentile(0.50),
+		  percentile(0.99),
+		  taskDurations.back());
+	}
+} // namespace
+
+TEST_CASE("DtlsTransport", "[bench][dtls]")
+{
+	static constexpr size_t NumPeers{ 200u };
+
+	DtlsTransport::ClassInit();
+
+	SECTION("join storm with handshakes in the worker thread")
+	{
+		printJoinStorm(NumPeers, 0u);
+	}
+
+	SECTION("join storm with handshakes in the DTLS handshake pool")
+	{
+		printJoinStorm(NumPeers, 4u);
+	}
+
+	DtlsTransport::ClassDestroy();
+}
@@ -0,0 +1,159 @@
+#include "common.hpp"
+#include "BenchUtils.hpp"
+#include "Settings.hpp"
+#include "RTC/Codecs/H264.hpp"
+#include "RTC/Codecs/H264_SVC.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <catch2/catch.hpp>
+#include <memory> // std::unique_ptr
+#include <vector>
+
+using namespace RTC;
+
+namespace
+{
+	// Writes a STAP-A payload with the given number of non IDR slices of the
+	// given size, so key frame detection walks all of them. Returns its length.
+	size_t FillStapA(uint8_t* buffer, size_t numNalus, size_t naluSize)
+	{
+		size_t len{ 0u };
+
+		buffer[len++] = 0x18; // STAP-A.
+
+		for (size_t idx{ 0u }; idx < numNalus; ++idx)
+		{
+			::Utils::Byte::Set2Bytes(buffer, len, static_cast<uint16_t>(naluSize));
+			len += 2;
+
+			buffer[len] = 0x41; // Non IDR slice.
+			std::memset(buffer + len + 1, 0xAB, naluSize - 1);
+			len += naluSize;
+		}
+
+		return len;
+	}
+} // namespace
+
+TEST_CASE("H264", "[bench][h264]")
+{
+	uint8_t stapA[Bench::Utils::MaxPacketSize];
+	const size_t stapALen = FillStapA(stapA, 10u, 100u);
+
+	// clang-format off
+	uint8_t fuA[] =
+	{
+		0x7C, 0x85, 0xAB, 0xAB, 0xAB, 0xAB, 0xAB, 0xAB // FU-A, start of IDR.
+	};
+	// clang-format on
+
+	// Start of a frame not flagged as independent.
+	RtpPacket::FrameMarking frameMarking{};
+
+	frameMarking.start = 1;
+
+	BENCHMARK("H264::Parse STAP-A")
+	{
+		std::unique_ptr<Codecs::H264::PayloadDescriptor> payloadDescriptor(
+		  Codecs::H264::Parse(stapA, stapALen));
+
+		return payloadDescriptor->isKeyFrame;
+	};
+
+	BENCHMARK("H264::Parse FU-A")
+	{
+		std::unique_ptr<Codecs::H264::PayloadDescriptor> payloadDescriptor(
+		  Codecs::H264::Parse(fuA, sizeof(fuA)));
+
+		return payloadDescriptor->isKeyFrame;
+	};
+
+	BENCHMARK("H264::Parse STAP-A with frame-marking")
+	{
+		std::unique_ptr<Codecs::H264::PayloadDescriptor> payloadDescriptor(
+		  Codecs::H264::Parse(stapA, stapALen, &frameMarking, 1u));
+
+		return payloadDescriptor->isKeyFrame;
+	};
+
+	Settings::configuration.trustFrameMarking = true;
+
+	BENCHMARK("H264::Parse STAP-A with trusted frame-marking")
+	{
+		std::unique_ptr<Codecs::H264::PayloadDescriptor> payloadDescriptor(
+		  Codecs::H264::Parse(stapA, stapALen, &frameMarking, 1u));
+
+		return payloadDescriptor->isKeyFrame;
+	};
+
+	Settings::configuration.trustFrameMarking = false;
+}
+
+TEST_CASE("H264_SVC", "[bench][h264]")
+{
+	const char* files[] = { "H264_SVC/I0-5.bin",  "H264_SVC/I0-7.bin",  "H264_SVC/I0-8.bin",
+		                      "H264_SVC/I0-14.bin", "H264_SVC/I1-15.bin", "H264_SVC/2SL-I14.bin" };
+	std::vector<std::vector<uint8_t>> buffers;
+	std::vector<std::unique_ptr<RtpPacket>> packets;
+
+	for (const auto* file : files)
+	{
+		std::vector<uint8_t> buffer(Bench::Utils::MaxPacketSize);
+		const size_t len = Bench::Utils::ReadTestDataFile(file, buffer.data(), buffer.size());
+
+		if (len == 0u)
+			continue;
+
+		std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer.data(), len));
+
+		if (!packet)
+			continue;
+
+		packet->SetFrameMarkingExtensionId(1u);
+
+		buffers.push_back(std::move(buffer));
+		packets.push_back(std::move(packet));
+	}
+
+	if (packets.empty())
+	{
+		WARN("test data not found (run from the worker directory)");
+
+		return;
+	}
+
+	auto parseAll = [&packets]()
+	{
+		size_t keyFrames{ 0u };
+
+		for (auto& packet : packets)
+		{
+			RtpPacket::FrameMarking* frameMarking{ nullptr };
+			uint8_t frameMarkingLen{ 0u };
+
+			packet->ReadFrameMarking(&frameMarking, frameMarkingLen);
+
+			std::unique_ptr<Codecs::H264_SVC::PayloadDescriptor> payloadDescriptor(
+			  Codecs::H264_SVC::Parse(
+			    packet->GetPayload(), packet->GetPayloadLength(), frameMarking, frameMarkingLen));
+
+			if (payloadDescriptor && payloadDescriptor->isKeyFrame)
+				++keyFrames;
+		}
+
+		return keyFrames;
+	};
+
+	BENCHMARK("H264_SVC::Parse test data")
+	{
+		return parseAll();
+	};
+
+	Settings::configuration.trustFrameMarking = true;
+
+	BENCHMARK("H264_SVC::Parse test data with trusted frame-marking")
+	{
+		return parseAll();
+	};
+
+	Settings::configuration.trustFrameMarking = false;
+}
@@ -0,0 +1,70 @@
+#include "common.hpp"
+#include "BenchUtils.hpp"
+#include "RTC/NackGenerator.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+class BenchNackGeneratorListener : public NackGenerator::Listener
+{
+	void OnNackGeneratorNackRequired(const std::vector<uint16_t>& /*seqNumbers*/) override
+	{
+	}
+
+	void OnNackGeneratorKeyFrameRequired() override
+	{
+	}
+};
+
+TEST_CASE("NackGenerator", "[bench][rtp]")
+{
+	BenchNackGeneratorListener listener;
+	uint8_t buffer[Bench::Utils::MaxPacketSize];
+	const size_t len =
+	  Bench::Utils::FillRtpPacket(buffer, uint16_t{ 0 }, uint32_t{ 90000 }, uint32_t{ 1111 }, 1000u);
+	std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer, len));
+
+	REQUIRE(packet);
+
+	BENCHMARK_ADVANCED("ReceivePacket in order")(Catch::Benchmark::Chronometer meter)
+	{
+		NackGenerator nackGenerator(&listener, 10u);
+		uint16_t seq{ 0u };
+
+		meter.measure(
+		  [&]
+		  {
+			  packet->SetSequenceNumber(++seq);
+
+			  return nackGenerator.ReceivePacket(packet.get(), /*isRecovered*/ false);
+		  });
+	};
+
+	BENCHMARK_ADVANCED("ReceivePacket with losses")(Catch::Benchmark::Chronometer meter)
+	{
+		NackGenerator nackGenerator(&listener, 10u);
+		uint16_t seq{ 0u };
+
+		meter.measure(
+		  [&]
+		  {
+			  // One of every 20 packets is lost and recovered 10 packets later.
+			  if ((++seq % 20u) == 0u)
+				  ++seq;
+
+			  packet->SetSequenceNumber(seq);
+
+			  bool ret = nackGenerator.ReceivePacket(packet.get(), /*isRecovered*/ false);
+
+			  if ((seq % 20u) == 10u)
+			  {
+				  packet->SetSequenceNumber(seq - 10u);
+
+				  ret = nackGenerator.ReceivePacket(packet.get(), /*isRecovered*/ true);
+			  }
+
+			  return ret;
+		  });
+	};
+}
@@ -0,0 +1,45 @@
+#include "common.hpp"
+#include "RTC/RateCalculator.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+TEST_CASE("RateCalculator", "[bench][rtp]")
+{
+	// Use a fixed time base so results do not depend on the clock.
+	static constexpr uint64_t StartMs{ 1000000u };
+
+	BENCHMARK_ADVANCED("Update")(Catch::Benchmark::Chronometer meter)
+	{
+		RateCalculator rate;
+		uint64_t nowMs{ StartMs };
+		size_t count{ 0u };
+
+		meter.measure(
+		  [&]
+		  {
+			  // 10 packets per ms.
+			  if ((++count % 10u) == 0u)
+				  ++nowMs;
+
+			  rate.Update(1200u, nowMs);
+
+			  return count;
+		  });
+	};
+
+	BENCHMARK_ADVANCED("GetRate")(Catch::Benchmark::Chronometer meter)
+	{
+		RateCalculator rate;
+		uint64_t nowMs{ StartMs };
+
+		for (size_t i{ 0u }; i < 10000u; ++i)
+		{
+			rate.Update(1200u, nowMs + i / 10u);
+		}
+
+		nowMs += 1000u;
+
+		meter.measure([&] { return rate.GetRate(++nowMs); });
+	};
+}
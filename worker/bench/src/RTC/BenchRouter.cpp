@@ -0,0 +1,113 @@
+#include "common.hpp"
+#include "BenchUtils.hpp"
+#include "RTC/RtpPacket.hpp"
+#include "RTC/RtpStreamSend.hpp"
+#include "RTC/SeqManager.hpp"
+#include <catch2/catch.hpp>
+#include <string>
+#include <vector>
+
+using namespace RTC;
+
+class BenchRtpStreamSendListener : public RtpStreamSend::Listener
+{
+	void OnRtpStreamScore(RtpStream* /*rtpStream*/, uint8_t /*score*/, uint8_t /*previousScore*/) override
+	{
+	}
+
+	void OnRtpStreamRetransmitRtpPackets(
+	  RtpStreamSend* /*rtpStream*/, RtpPacket** /*packets*/, size_t /*count*/) override
+	{
+	}
+
+	void OnRtpStreamSendFecPacket(RtpStreamSend* /*rtpStream*/, RtpPacket* /*packet*/) override
+	{
+	}
+};
+
+/**
+ * What a SimpleConsumer does for every packet received by Router from its
+ * Producer (without the Transport and the Channel).
+ */
+struct BenchConsumer
+{
+	BenchConsumer(RtpStreamSend::Listener* listener, RtpStream::Params& params, std::string mid)
+	  : mid(std::move(mid)), ssrc(params.ssrc), rtpStream(listener, params, 600u)
+	{
+	}
+
+	void SendRtpPacket(RtpPacket* packet)
+	{
+		uint16_t seq;
+
+		packet->UpdateMid(this->mid);
+
+		this->rtpSeqManager.Input(packet->GetSequenceNumber(), seq);
+
+		auto origSsrc = packet->GetSsrc();
+		auto origSeq  = packet->GetSequenceNumber();
+
+		packet->SetSsrc(this->ssrc);
+		packet->SetSequenceNumber(seq);
+
+		this->rtpStream.ReceivePacket(packet);
+
+		packet->SetSsrc(origSsrc);
+		packet->SetSequenceNumber(origSeq);
+	}
+
+	std::string mid;
+	uint32_t ssrc{ 0u };
+	SeqManager<uint16_t> rtpSeqManager;
+	RtpStreamSend rtpStream;
+};
+
+TEST_CASE("Router", "[bench][rtp]")
+{
+	BenchRtpStreamSendListener listener;
+
+	for (size_t numConsumers : { 1u, 10u, 100u })
+	{
+		BENCHMARK_ADVANCED("RTP packet fan-out to " + std::to_string(numConsumers) + " consumers")
+		(Catch::Benchmark::Chronometer meter)
+		{
+			std::vector<std::unique_ptr<BenchConsumer>> consumers;
+
+			for (size_t i{ 0u }; i < numConsumers; ++i)
+			{
+				RtpStream::Params params;
+
+				params.ssrc      = 2000u + static_cast<uint32_t>(i);
+				params.clockRate = 90000u;
+				params.useNack   = true;
+
+				consumers.emplace_back(new BenchConsumer(&listener, params, std::to_string(i % 100u)));
+			}
+
+			uint8_t buffer[Bench::Utils::MaxPacketSize];
+			uint16_t seq{ 0u };
+			uint32_t timestamp{ 90000u };
+
+			meter.measure(
+			  [&]
+			  {
+				  // A new packet is parsed for every one received by the Producer.
+				  ++seq;
+				  timestamp += (seq % 10u) == 0u ? 3000u : 0u;
+
+				  const size_t len =
+				    Bench::Utils::FillRtpPacket(buffer, seq, timestamp, uint32_t{ 1111 }, 1000u);
+				  std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer, len));
+
+				  packet->SetMidExtensionId(Bench::Utils::MidExtensionId);
+
+				  for (auto& consumer : consumers)
+				  {
+					  consumer->SendRtpPacket(packet.get());
+				  }
+
+				  return packet->GetSize();
+			  });
+		};
+	}
+}
@@ -0,0 +1,48 @@
+#include "common.hpp"
+#include "BenchUtils.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+TEST_CASE("RtpPacket", "[bench][rtp]")
+{
+	uint8_t buffer[Bench::Utils::MaxPacketSize];
+	uint8_t cloneBuffer[MtuSize + 100];
+	const size_t len =
+	  Bench::Utils::FillRtpPacket(buffer, uint16_t{ 1000 }, uint32_t{ 90000 }, uint32_t{ 1111 }, 1000u);
+
+	BENCHMARK("Parse")
+	{
+		auto* packet = RtpPacket::Parse(buffer, len);
+		auto size    = packet->GetSize();
+
+		delete packet;
+
+		return size;
+	};
+
+	std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer, len));
+
+	REQUIRE(packet);
+
+	packet->SetMidExtensionId(Bench::Utils::MidExtensionId);
+
+	BENCHMARK("Clone")
+	{
+		auto* clonedPacket = packet->Clone(cloneBuffer);
+		auto size          = clonedPacket->GetSize();
+
+		delete clonedPacket;
+
+		return size;
+	};
+
+	const std::string mids[] = { "m01", "m02" };
+	size_t idx{ 0u };
+
+	BENCHMARK("UpdateMid")
+	{
+		return packet->UpdateMid(mids[++idx & 1u]);
+	};
+}
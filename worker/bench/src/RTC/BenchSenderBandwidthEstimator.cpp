@@ -0,0 +1,103 @@
+#include "common.hpp"
+#include "DepLibUV.hpp"
+#include "Settings.hpp"
+#include "RTC/RTCP/FeedbackRtpTransport.hpp"
+#include "RTC/TransportCongestionControlClient.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+namespace
+{
+	class BenchTransportCongestionControlClientListener
+	  : public TransportCongestionControlClient::Listener
+	{
+	public:
+		void OnTransportCongestionControlClientBitrates(
+		  TransportCongestionControlClient* /*tccClient*/,
+		  TransportCongestionControlClient::Bitrates& /*bitrates*/) override
+		{
+		}
+
+		void OnTransportCongestionControlClientSendRtpPacket(
+		  TransportCongestionControlClient* /*tccClient*/,
+		  RtpPacket* /*packet*/,
+		  const webrtc::PacedPacketInfo& /*pacingInfo*/) override
+		{
+		}
+
+		RtpPacket* OnTransportCongestionControlClientGeneratePadding(
+		  TransportCongestionControlClient* /*tccClient*/, size_t /*size*/) override
+		{
+			return nullptr;
+		}
+	};
+
+	// Sends a batch of packets and receives the transport-cc feedback of all of
+	// them, as a Transport sending ~5 Mbps would do every 100 ms.
+	void sendBatchAndReceiveFeedback(TransportCongestionControlClient& tccClient, uint16_t& wideSeq)
+	{
+		static constexpr size_t NumPackets{ 50u };
+		static constexpr size_t PacketSize{ 1200u };
+
+		const auto nowMs = DepLibUV::GetTimeMs();
+		RTCP::FeedbackRtpTransportPacket feedback(0u, 0u);
+
+		// The first added packet just sets the base of the feedback.
+		feedback.AddPacket(wideSeq, nowMs, 1500u);
+
+		for (size_t i{ 0u }; i < NumPackets; ++i)
+		{
+			webrtc::RtpPacketSendInfo packetInfo;
+
+			packetInfo.transport_sequence_number = ++wideSeq;
+			packetInfo.length                    = PacketSize;
+			packetInfo.pacing_info               = tccClient.GetPacingInfo();
+
+			tccClient.InsertPacket(packetInfo);
+			tccClient.PacketSent(packetInfo, static_cast<int64_t>(nowMs));
+
+			feedback.AddPacket(wideSeq, nowMs + 20 + (i * 2), 1500u);
+		}
+
+		feedback.Finish();
+
+		tccClient.ReceiveRtcpTransportFeedback(&feedback);
+	}
+} // namespace
+
+TEST_CASE("SenderBandwidthEstimator", "[bench][bwe]")
+{
+	static constexpr uint32_t InitialAvailableBitrate{ 600000u };
+	static constexpr uint32_t MaxOutgoingBitrate{ 10000000u };
+
+	BenchTransportCongestionControlClientListener listener;
+
+	BENCHMARK_ADVANCED("libwebrtc GoogCC: 50 packets + feedback")
+	(Catch::Benchmark::Chronometer meter)
+	{
+		TransportCongestionControlClient tccClient(
+		  &listener, BweType::TRANSPORT_CC, InitialAvailableBitrate, MaxOutgoingBitrate);
+		uint16_t wideSeq{ 0u };
+
+		tccClient.TransportConnected();
+
+		meter.measure([&] { sendBatchAndReceiveFeedback(tccClient, wideSeq); });
+	};
+
+	BENCHMARK_ADVANCED("native SenderBandwidthEstimator: 50 packets + feedback")
+	(Catch::Benchmark::Chronometer meter)
+	{
+		Settings::configuration.nativeBandwidthEstimator = true;
+
+		TransportCongestionControlClient tccClient(
+		  &listener, BweType::TRANSPORT_CC, InitialAvailableBitrate, MaxOutgoingBitrate);
+		uint16_t wideSeq{ 0u };
+
+		Settings::configuration.nativeBandwidthEstimator = false;
+
+		tccClient.TransportConnected();
+
+		meter.measure([&] { sendBatchAndReceiveFeedback(tccClient, wideSeq); });
+	};
+}
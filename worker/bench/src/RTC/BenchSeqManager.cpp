@@ -0,0 +1,126 @@
+#include "common.hpp"
+#include "RTC/SeqManager.hpp"
+#include <catch2/catch.hpp>
+#include <iterator> // std::distance()
+#include <set>
+
+using namespace RTC;
+
+namespace
+{
+	// Previous SeqManager implementation, storing dropped inputs in a std::set,
+	// kept here to compare it with the current one.
+	class SetSeqManager
+	{
+	public:
+		void Drop(uint16_t input)
+		{
+			if (SeqManager<uint16_t>::IsSeqHigherThan(input, this->maxInput))
+				this->dropped.insert(input);
+		}
+
+		bool Input(const uint16_t input, uint16_t& output)
+		{
+			auto base = this->base;
+
+			if (!this->dropped.empty())
+			{
+				size_t droppedCount = this->dropped.size();
+				auto it             = this->dropped.lower_bound(input - SeqManager<uint16_t>::MaxValue / 2);
+
+				this->dropped.erase(this->dropped.begin(), it);
+				this->base -= (droppedCount - this->dropped.size());
+
+				droppedCount = this->dropped.size();
+				it           = this->dropped.lower_bound(input);
+
+				if (it != this->dropped.end())
+				{
+					if (*it == input)
+						return false;
+
+					droppedCount -= std::distance(it, this->dropped.end());
+				}
+
+				base = this->base - droppedCount;
+			}
+
+			output = input + base;
+
+			uint16_t idelta = input - this->maxInput;
+			uint16_t odelta = output - this->maxOutput;
+
+			if (idelta < SeqManager<uint16_t>::MaxValue / 2)
+				this->maxInput = input;
+
+			if (odelta < SeqManager<uint16_t>::MaxValue / 2)
+				this->maxOutput = output;
+
+			return true;
+		}
+
+	private:
+		uint16_t base{ 0u };
+		uint16_t maxOutput{ 0u };
+		uint16_t maxInput{ 0u };
+		std::set<uint16_t, SeqManager<uint16_t>::SeqLowerThan> dropped;
+	};
+
+	template<typename S>
+	bool dropTemporalLayer(S& seqManager, uint16_t& input, uint16_t& output)
+	{
+		// Drop every other input as a Consumer dropping the highest temporal layer
+		// of a two layers stream would do.
+		seqManager.Drop(++input);
+
+		return seqManager.Input(++input, output);
+	}
+} // namespace
+
+TEST_CASE("SeqManager", "[bench][rtp]")
+{
+	BENCHMARK_ADVANCED("Input in order")(Catch::Benchmark::Chronometer meter)
+	{
+		SeqManager<uint16_t> seqManager;
+		uint16_t input{ 0u };
+		uint16_t output;
+
+		meter.measure([&] { return seqManager.Input(++input, output); });
+	};
+
+	BENCHMARK_ADVANCED("Input with dropped inputs")(Catch::Benchmark::Chronometer meter)
+	{
+		SeqManager<uint16_t> seqManager;
+		uint16_t input{ 0u };
+		uint16_t output;
+
+		meter.measure(
+		  [&]
+		  {
+			  // Drop one of every 8 inputs as a Consumer dropping layers would do.
+			  if ((++input & 0x07) == 0u)
+				  seqManager.Drop(input++);
+
+			  return seqManager.Input(input, output);
+		  });
+	};
+
+	BENCHMARK_ADVANCED("Input dropping a temporal layer")(Catch::Benchmark::Chronometer meter)
+	{
+		SeqManager<uint16_t> seqManager;
+		uint16_t input{ 0u };
+		uint16_t output;
+
+		meter.measure([&] { return dropTemporalLayer(seqManager, input, output); });
+	};
+
+	BENCHMARK_ADVANCED("Input dropping a temporal layer (std::set)")
+	(Catch::Benchmark::Chronometer meter)
+	{
+		SetSeqManager seqManager;
+		uint16_t input{ 0u };
+		uint16_t output;
+
+		meter.measure([&] { return dropTemporalLayer(seqManager, input, output); });
+	};
+}
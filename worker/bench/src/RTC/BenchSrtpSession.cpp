@@ -0,0 +1,134 @@
+#include "common.hpp"
+#include "BenchUtils.hpp"
+#include "RTC/RtpPacket.hpp"
+#include "RTC/SrtpSession.hpp"
+#include <catch2/catch.hpp>
+#include <cstring> // std::memcpy()
+#include <memory>
+#include <vector>
+
+using namespace RTC;
+
+static void benchEncryptRtp(
+  Catch::Benchmark::Chronometer& meter, SrtpSession::CryptoSuite cryptoSuite, size_t keyLen)
+{
+	// Fixed key so results are reproducible.
+	uint8_t key[64];
+
+	for (size_t i{ 0u }; i < sizeof(key); ++i)
+	{
+		key[i] = static_cast<uint8_t>(i);
+	}
+
+	SrtpSession srtpSession(SrtpSession::Type::OUTBOUND, cryptoSuite, key, keyLen);
+	uint8_t buffer[Bench::Utils::MaxPacketSize];
+	uint8_t encryptBuffer[Bench::Utils::MaxPacketSize + SrtpSession::MaxTrailerSize];
+	const size_t len =
+	  Bench::Utils::FillRtpPacket(buffer, uint16_t{ 0 }, uint32_t{ 90000 }, uint32_t{ 1111 }, 1100u);
+	uint16_t seq{ 0u };
+
+	meter.measure(
+	  [&]
+	  {
+		  int encryptedLen = static_cast<int>(len);
+
+		  ::Utils::Byte::Set2Bytes(buffer, 2, ++seq);
+
+		  return srtpSession.EncryptRtp(buffer, &encryptedLen, encryptBuffer);
+	  });
+}
+
+// Encrypts a batch of 64 packets of 16 sessions interleaved (as a fan-out of
+// the same stream to 16 Consumers would queue them) either one by one or with
+// EncryptRtpBatch().
+static void benchEncryptRtpBatch(
+  Catch::Benchmark::Chronometer& meter,
+  SrtpSession::CryptoSuite cryptoSuite,
+  size_t keyLen,
+  bool batch)
+{
+	static constexpr size_t NumSessions{ 16u };
+	static constexpr size_t NumPackets{ 64u };
+
+	uint8_t key[64];
+
+	for (size_t i{ 0u }; i < sizeof(key); ++i)
+	{
+		key[i] = static_cast<uint8_t>(i);
+	}
+
+	std::vector<std::unique_ptr<SrtpSession>> srtpSessions;
+
+	uint8_t buffer[Bench::Utils::MaxPacketSize];
+	static uint8_t
+	  encryptBuffers[NumPackets][Bench::Utils::MaxPacketSize + SrtpSession::MaxTrailerSize];
+	SrtpSession::RtpBatchItem items[NumPackets];
+	const size_t len =
+	  Bench::Utils::FillRtpPacket(buffer, uint16_t{ 0 }, uint32_t{ 90000 }, uint32_t{ 1111 }, 1100u);
+	uint16_t seq{ 0u };
+
+	for (size_t i{ 0u }; i < NumSessions; ++i)
+	{
+		srtpSessions.emplace_back(
+		  new SrtpSession(SrtpSession::Type::OUTBOUND, cryptoSuite, key, keyLen));
+
+		// Allocate the libsrtp context, which ProtectRtp() does not do.
+		int encryptedLen = static_cast<int>(len);
+
+		srtpSessions.back()->EncryptRtp(buffer, &encryptedLen, encryptBuffers[0]);
+	}
+
+	meter.measure(
+	  [&]
+	  {
+		  size_t numEncrypted{ 0u };
+
+		  for (size_t i{ 0u }; i < NumPackets; ++i)
+		  {
+			  if (i % NumSessions == 0u)
+				  ::Utils::Byte::Set2Bytes(buffer, 2, ++seq);
+
+			  std::memcpy(encryptBuffers[i], buffer, len);
+
+			  items[i] = {
+				  srtpSessions[i % NumSessions].get(), encryptBuffers[i], static_cast<int>(len), false
+			  };
+		  }
+
+		  if (batch)
+			  return SrtpSession::EncryptRtpBatch(items, NumPackets);
+
+		  for (auto& item : items)
+		  {
+			  if (item.session->ProtectRtp(item.data, &item.len))
+				  ++numEncrypted;
+		  }
+
+		  return numEncrypted;
+	  });
+}
+
+TEST_CASE("SrtpSession", "[bench][srtp]")
+{
+	BENCHMARK_ADVANCED("EncryptRtp AES_CM_128_HMAC_SHA1_80")(Catch::Benchmark::Chronometer meter)
+	{
+		benchEncryptRtp(meter, SrtpSession::CryptoSuite::AES_CM_128_HMAC_SHA1_80, 30u);
+	};
+
+	BENCHMARK_ADVANCED("EncryptRtp AEAD_AES_128_GCM")(Catch::Benchmark::Chronometer meter)
+	{
+		benchEncryptRtp(meter, SrtpSession::CryptoSuite::AEAD_AES_128_GCM, 28u);
+	};
+
+	BENCHMARK_ADVANCED("ProtectRtp AEAD_AES_128_GCM: 64 packets of 16 sessions")
+	(Catch::Benchmark::Chronometer meter)
+	{
+		benchEncryptRtpBatch(meter, SrtpSession::CryptoSuite::AEAD_AES_128_GCM, 28u, false);
+	};
+
+	BENCHMARK_ADVANCED("EncryptRtpBatch AEAD_AES_128_GCM: 64 packets of 16 sessions")
+	(Catch::Benchmark::Chronometer meter)
+	{
+		benchEncryptRtpBatch(meter, SrtpSession::CryptoSuite::AEAD_AES_128_GCM, 28u, true);
+	};
+}
@@ -0,0 +1,82 @@
+#define CATCH_CONFIG_RUNNER
+
+#include "BenchUtils.hpp"
+#include "DepLibSRTP.hpp"
+#include "DepLibUV.hpp"
+#include "DepLibWebRTC.hpp"
+#include "DepOpenSSL.hpp"
+#include "DepUsrSCTP.hpp"
+#include "LogLevel.hpp"
+#include "Settings.hpp"
+#include "Utils.hpp"
+#include "handles/TimerWheel.hpp"
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <cstdlib> // std::getenv(), std::malloc(), std::free()
+#include <new>     // std::bad_alloc
+
+static std::atomic<size_t> numAllocations{ 0u };
+
+// Count heap allocations so benchmarks can report them along with timings.
+void* operator new(size_t size)
+{
+	numAllocations.fetch_add(1u, std::memory_order_relaxed);
+
+	if (void* ptr = std::malloc(size != 0u ? size : 1u))
+		return ptr;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept
+{
+	std::free(ptr);
+}
+
+size_t Bench::Utils::GetNumAllocations()
+{
+	return numAllocations.load(std::memory_order_relaxed);
+}
+
+int main(int argc, char* argv[])
+{
+	LogLevel logLevel{ LogLevel::LOG_NONE };
+
+	// Get logLevel from ENV variable.
+	if (std::getenv("MS_BENCH_LOG_LEVEL"))
+	{
+		if (std::string(std::getenv("MS_BENCH_LOG_LEVEL")) == "debug")
+			logLevel = LogLevel::LOG_DEBUG;
+		else if (std::string(std::getenv("MS_BENCH_LOG_LEVEL")) == "warn")
+			logLevel = LogLevel::LOG_WARN;
+		else if (std::string(std::getenv("MS_BENCH_LOG_LEVEL")) == "error")
+			logLevel = LogLevel::LOG_ERROR;
+	}
+
+	Settings::configuration.logLevel = logLevel;
+
+	// Initialize static stuff.
+	DepLibUV::ClassInit();
+	DepOpenSSL::ClassInit();
+	DepLibSRTP::ClassInit();
+	DepUsrSCTP::ClassInit();
+	DepLibWebRTC::ClassInit();
+	Utils::Crypto::ClassInit();
+
+	int status = Catch::Session().run(argc, argv);
+
+	// Free static stuff.
+	DepLibSRTP::ClassDestroy();
+	Utils::Crypto::ClassDestroy();
+	DepLibWebRTC::ClassDestroy();
+	DepUsrSCTP::ClassDestroy();
+	TimerWheel::ClassDestroy();
+	DepLibUV::ClassDestroy();
+
+	return status;
+}
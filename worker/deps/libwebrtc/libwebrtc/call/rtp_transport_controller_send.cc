@@ -64,6 +64,7 @@ RtpTransportControllerSend::RtpTransportControllerSend(
       controller_factory_override_(controller_factory),
       process_interval_(controller_factory_override_->GetProcessInterval()),
       last_report_block_time_(Timestamp::ms(DepLibUV::GetTimeMsInt64())),
+      last_ecn_report_time_(Timestamp::ms(DepLibUV::GetTimeMsInt64())),
       send_side_bwe_with_overhead_(
           webrtc::field_trial::IsEnabled("WebRTC-SendSideBwe-WithOverhead")),
       transport_overhead_bytes_per_packet_(0),
@@ -222,6 +223,33 @@ void RtpTransportControllerSend::OnReceivedRtcpReceiverReport(
     PostUpdates(controller_->OnRoundTripTimeUpdate(report));
 }
 
+void RtpTransportControllerSend::OnReceivedEcnFeedback(
+    int64_t packets_ce_delta,
+    int64_t packets_delta,
+    int64_t now_ms) {
+  MS_DEBUG_DEV("<<<<< packets_ce_delta:%" PRIi64 ", packets_delta:%" PRIi64,
+               packets_ce_delta, packets_delta);
+
+  if (!controller_)
+    return;
+
+  int64_t packets_received_delta = packets_delta - packets_ce_delta;
+
+  if (packets_received_delta < 1)
+    return;
+
+  Timestamp now = Timestamp::ms(now_ms);
+  TransportLossReport msg;
+  msg.packets_lost_delta = packets_ce_delta;
+  msg.packets_received_delta = packets_received_delta;
+  msg.receive_time = now;
+  msg.start_time = last_ecn_report_time_;
+  msg.end_time = now;
+
+  PostUpdates(controller_->OnTransportLossReport(msg));
+  last_ecn_report_time_ = now;
+}
+
 void RtpTransportControllerSend::OnAddPacket(
     const RtpPacketSendInfo& packet_info) {
   transport_feedback_adapter_.AddPacket(
@@ -82,6 +82,12 @@ class RtpTransportControllerSend final
   // Implements NetworkStateEstimateObserver interface
   void OnRemoteNetworkEstimate(NetworkStateEstimate estimate) override;
 
+  // MS_NOTE: CE marked packets reported by RTCP ECN feedback (RFC 6679) are
+  // provided to the controller as lost ones.
+  void OnReceivedEcnFeedback(int64_t packets_ce_delta,
+                             int64_t packets_delta,
+                             int64_t now_ms);
+
   void Process();
 
  private:
@@ -114,6 +120,7 @@ class RtpTransportControllerSend final
 
   std::map<uint32_t, RTCPReportBlock> last_report_blocks_;
   Timestamp last_report_block_time_;
+  Timestamp last_ecn_report_time_;
 
   NetworkControllerConfig initial_config_;
 	StreamsConfig streams_config_;
@@ -15,20 +15,6 @@ namespace mediasoup_helpers
 	 */
 	namespace FeedbackRtpTransport
 	{
-		const std::vector<webrtc::rtcp::ReceivedPacket> GetReceivedPackets(
-			const RTC::RTCP::FeedbackRtpTransportPacket* packet)
-		{
-			std::vector<webrtc::rtcp::ReceivedPacket> receivedPackets;
-
-			for (auto& packetResult : packet->GetPacketResults())
-			{
-			  if (packetResult.received)
-			    receivedPackets.emplace_back(packetResult.sequenceNumber, packetResult.delta);
-			}
-
-			return receivedPackets;
-		}
-
 		// Get the reference time in microseconds, including any precision loss.
 		int64_t GetBaseTimeUs(const RTC::RTCP::FeedbackRtpTransportPacket* packet)
 		{
@@ -206,7 +206,14 @@ std::vector<PacketFeedback> TransportFeedbackAdapter::GetPacketFeedbackVector(
     int64_t offset_us = 0;
     int64_t timestamp_ms = 0;
     uint16_t seq_num = feedback.GetBaseSequenceNumber();
-    for (const auto& packet : mediasoup_helpers::FeedbackRtpTransport::GetReceivedPackets(&feedback)) {
+    RTC::RTCP::FeedbackRtpTransportPacket::PacketResultsReader reader(&feedback);
+    RTC::RTCP::FeedbackRtpTransportPacket::PacketResult packetResult;
+    while (reader.Read(packetResult)) {
+      if (!packetResult.received)
+        continue;
+
+      const rtcp::ReceivedPacket packet(packetResult.sequenceNumber, packetResult.delta);
+
       // Insert into the vector those unreceived packets which precede this
       // iteration's received packet.
       for (; seq_num != packet.sequence_number(); ++seq_num) {
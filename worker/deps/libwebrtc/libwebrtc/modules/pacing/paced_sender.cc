@@ -182,6 +182,11 @@ void PacedSender::Process() {
   if (!prober_.IsProbing())
     return;
 
+  // MS_NOTE: The packet router may defer probing (i.e. when too many
+  // transports are probing at the same time).
+  if (!packet_router_->MayProbe())
+    return;
+
   PacedPacketInfo pacing_info;
   absl::optional<size_t> recommended_probe_size;
 
@@ -62,6 +62,9 @@ class PacedSender {
   // effect.
   void SetProbingEnabled(bool enabled);
 
+  // MS_NOTE: Added so the packet router can tell when probing is over.
+  bool IsProbing() const { return prober_.IsProbing(); }
+
   // Sets the pacing rates. Must be called once before packets can be sent.
   void SetPacingRates(uint32_t pacing_rate_bps, uint32_t padding_rate_bps);
 
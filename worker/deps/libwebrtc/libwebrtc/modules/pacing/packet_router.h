@@ -36,6 +36,9 @@ class PacketRouter {
 
   // MS_NOTE: Changed to return a single RtpPacket pointer (maybe nullptr).
   virtual RTC::RtpPacket* GeneratePadding(size_t target_size_bytes) = 0;
+
+  // MS_NOTE: Added. Whether probe packets can be sent now.
+  virtual bool MayProbe() = 0;
 };
 }  // namespace webrtc
 #endif  // MODULES_PACING_PACKET_ROUTER_H_
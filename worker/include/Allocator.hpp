@@ -0,0 +1,34 @@
+#ifndef MS_ALLOCATOR_HPP
+#define MS_ALLOCATOR_HPP
+
+#include "common.hpp"
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/**
+ * Memory allocator the worker is linked with, chosen at build time with the
+ * ms_allocator Meson option (system, mimalloc, jemalloc or tcmalloc).
+ *
+ * With the ms_huge_pages Meson option (Linux only) the heap is backed by
+ * transparent huge pages, so long running workers suffer less TLB misses:
+ *
+ * - mimalloc: large OS pages are enabled.
+ * - jemalloc: the thp:always configuration is used.
+ * - system (glibc): the heap grows in huge page steps so the kernel can back
+ *   it with huge pages if its THP mode is "always" (or if glibc >= 2.35 runs
+ *   with GLIBC_TUNABLES=glibc.malloc.hugetlb=1).
+ * - tcmalloc: nothing to do, it depends on the kernel THP mode.
+ *
+ * Allocator statistics are process wide (so shared by workers running in
+ * the same process) and reported in the resource usage of the Worker.
+ */
+class Allocator
+{
+public:
+	static void ClassInit();
+	static const char* GetName();
+	static void FillJson(json& jsonObject);
+};
+
+#endif
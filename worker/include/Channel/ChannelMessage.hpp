@@ -0,0 +1,41 @@
+#ifndef MS_CHANNEL_MESSAGE_HPP
+#define MS_CHANNEL_MESSAGE_HPP
+
+#include "common.hpp"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace Channel
+{
+	/**
+	 * Encoding of the Channel and PayloadChannel messages. It's negotiated at
+	 * worker spawn (--channelMessageFormat) and applies to the messages sent
+	 * by the worker. Received messages may come in any of them since the format
+	 * is detected by their first byte ('{' in JSON, a map type in MessagePack).
+	 */
+	class ChannelMessage
+	{
+	public:
+		enum class Format : uint8_t
+		{
+			JSON = 0,
+			MSGPACK
+		};
+
+	public:
+		static bool GetFormat(const std::string& name, Format& format);
+		static const std::string& GetFormatName(Format format);
+		// Returned data is valid until the next call.
+		static const uint8_t* Serialize(const json& jsonMessage, size_t& len);
+		static json Parse(const uint8_t* data, size_t len);
+
+	private:
+		thread_local static std::string jsonBuffer;
+		thread_local static std::vector<uint8_t> msgpackBuffer;
+	};
+} // namespace Channel
+
+#endif
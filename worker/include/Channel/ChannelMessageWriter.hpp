@@ -0,0 +1,67 @@
+#ifndef MS_CHANNEL_MESSAGE_WRITER_HPP
+#define MS_CHANNEL_MESSAGE_WRITER_HPP
+
+#include "common.hpp"
+#include "Channel/ChannelMessage.hpp"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace Channel
+{
+	/**
+	 * Writes a Channel message (in JSON or MessagePack) as values are given,
+	 * so big replies (i.e. dumps) are serialized without building a json tree
+	 * first.
+	 *
+	 * Since MessagePack maps and arrays carry their size in their header, the
+	 * number of entries of objects and items of arrays must be given when
+	 * starting them (they are ignored in JSON).
+	 */
+	class ChannelMessageWriter
+	{
+	public:
+		explicit ChannelMessageWriter(ChannelMessage::Format format);
+
+	public:
+		void StartObject(size_t numEntries);
+		void EndObject();
+		void StartArray(size_t numItems);
+		void EndArray();
+		void Key(const std::string& key);
+		void String(const std::string& value);
+		void UInt(uint64_t value);
+		void Int(int64_t value);
+		void Double(double value);
+		void Bool(bool value);
+		void Null();
+		// Writes an already built value.
+		void Value(const json& value);
+		const uint8_t* GetData() const
+		{
+			return this->buffer.data();
+		}
+		size_t GetLength() const
+		{
+			return this->buffer.size();
+		}
+
+	private:
+		void BeforeValue();
+		void WriteJsonString(const std::string& value);
+		void WriteMsgpackHeader(uint8_t fixType, uint8_t fixMax, uint8_t type16, size_t size);
+		void WriteBigEndian(uint64_t value, size_t len);
+
+	private:
+		ChannelMessage::Format format;
+		std::vector<uint8_t> buffer;
+		// JSON: whether each open container has no value yet.
+		std::vector<bool> emptyContainers;
+		// JSON: whether a key was just written.
+		bool afterKey{ false };
+	};
+} // namespace Channel
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "common.hpp"
 #include "Channel/ChannelSocket.hpp"
+#include <absl/container/flat_hash_map.h>
 #include <nlohmann/json.hpp>
 #include <string>
 
@@ -13,12 +14,28 @@ namespace Channel
 	public:
 		static void ClassInit(Channel::ChannelSocket* channel);
 		static void Emit(uint64_t targetId, const char* event);
+		static void Emit(uint64_t targetId, const char* event, json& data);
 		static void Emit(const std::string& targetId, const char* event);
 		static void Emit(const std::string& targetId, const char* event, json& data);
+		// Like Emit() but, if batching is enabled, the notification is kept until
+		// FlushBatch() is called and replaces any pending one with same target
+		// and event. So it must just be used for notifications whose last value
+		// is all that matters (score, layers, etc).
+		static void EmitBatched(const std::string& targetId, const char* event, json& data);
+		static void EnableBatching();
+		// Sends all the pending notifications in a single message.
+		static void FlushBatch();
 
 	public:
 		// Passed by argument.
 		thread_local static Channel::ChannelSocket* channel;
+
+	private:
+		thread_local static bool batching;
+		// Array of [targetId, event, data] entries.
+		thread_local static json batch;
+		// Index in the batch of every target and event pair.
+		thread_local static absl::flat_hash_map<std::string, size_t> batchIndexes;
 	};
 } // namespace Channel
 
@@ -4,6 +4,7 @@
 #include "common.hpp"
 #include <absl/container/flat_hash_map.h>
 #include <nlohmann/json.hpp>
+#include <functional>
 #include <string>
 
 using json = nlohmann::json;
@@ -13,6 +14,7 @@ namespace Channel
 	// Avoid cyclic #include problem by declaring classes instead of including
 	// the corresponding header files.
 	class ChannelSocket;
+	class ChannelMessageWriter;
 
 	class ChannelRequest
 	{
@@ -24,26 +26,41 @@ namespace Channel
 			WORKER_GET_RESOURCE_USAGE,
 			WORKER_UPDATE_SETTINGS,
 			WORKER_CREATE_ROUTER,
+			WORKER_CREATE_WEBRTC_SERVER,
+			WORKER_ENABLE_STATE_STREAM,
+			WEBRTC_SERVER_CLOSE,
+			WEBRTC_SERVER_DUMP,
 			ROUTER_CLOSE,
 			ROUTER_DUMP,
 			ROUTER_CREATE_WEBRTC_TRANSPORT,
+			ROUTER_CREATE_WEBRTC_TRANSPORT_WITH_SERVER,
 			ROUTER_CREATE_PLAIN_TRANSPORT,
 			ROUTER_CREATE_PIPE_TRANSPORT,
 			ROUTER_CREATE_DIRECT_TRANSPORT,
 			ROUTER_CREATE_ACTIVE_SPEAKER_OBSERVER,
 			ROUTER_CREATE_AUDIO_LEVEL_OBSERVER,
+			ROUTER_CREATE_AUDIO_MIXER,
+			ROUTER_CLOSE_TRANSPORTS,
 			TRANSPORT_CLOSE,
 			TRANSPORT_DUMP,
 			TRANSPORT_GET_STATS,
 			TRANSPORT_CONNECT,
 			TRANSPORT_SET_MAX_INCOMING_BITRATE,
 			TRANSPORT_SET_MAX_OUTGOING_BITRATE,
+			TRANSPORT_SET_BWE_HINT,
 			TRANSPORT_RESTART_ICE,
 			TRANSPORT_PRODUCE,
 			TRANSPORT_CONSUME,
 			TRANSPORT_PRODUCE_DATA,
 			TRANSPORT_CONSUME_DATA,
 			TRANSPORT_ENABLE_TRACE_EVENT,
+			TRANSPORT_CONSUME_MANY,
+			TRANSPORT_PAUSE_CONSUMERS,
+			TRANSPORT_RESUME_CONSUMERS,
+			TRANSPORT_SET_CONSUMERS_PREFERRED_LAYERS,
+			TRANSPORT_ENABLE_PACKET_CAPTURE,
+			TRANSPORT_DISABLE_PACKET_CAPTURE,
+			TRANSPORT_DUMP_PACKET_CAPTURE,
 			PRODUCER_CLOSE,
 			PRODUCER_DUMP,
 			PRODUCER_GET_STATS,
@@ -56,9 +73,11 @@ namespace Channel
 			CONSUMER_PAUSE,
 			CONSUMER_RESUME,
 			CONSUMER_SET_PREFERRED_LAYERS,
+			CONSUMER_SET_LAYER_DEMAND,
 			CONSUMER_SET_PRIORITY,
 			CONSUMER_REQUEST_KEY_FRAME,
 			CONSUMER_ENABLE_TRACE_EVENT,
+			CONSUMER_EXPORT_SEND_STATE,
 			DATA_PRODUCER_CLOSE,
 			DATA_PRODUCER_DUMP,
 			DATA_PRODUCER_GET_STATS,
@@ -79,12 +98,31 @@ namespace Channel
 
 	public:
 		ChannelRequest(Channel::ChannelSocket* channel, json& jsonRequest);
+		// Item of a batch request. Its internal is the one of the batch request
+		// merged with the "internal" of the item, and its response is appended
+		// to the given array instead of being sent.
+		ChannelRequest(
+		  const ChannelRequest* batchRequest, MethodId methodId, json& jsonItem, json& responses);
 		virtual ~ChannelRequest();
 
 		void Accept();
 		void Accept(json& data);
+		// The data is written into the given writer by the given function, so
+		// big replies are serialized without building a json tree.
+		void Accept(const std::function<void(ChannelMessageWriter& writer)>& writeData);
 		void Error(const char* reason = nullptr);
 		void TypeError(const char* reason = nullptr);
+		// Handles the rest of this request later in steps, each of them returning
+		// whether the request is done (and replied). Steps are run by the
+		// Channel within its time budget per loop iteration, and no other
+		// request is handled meanwhile. Not valid for items of batch requests.
+		void Defer(const std::function<bool()>& step)
+		{
+			this->deferredStep = step;
+		}
+
+	private:
+		void Reply(json& jsonResponse);
 
 	public:
 		// Passed by argument.
@@ -96,6 +134,10 @@ namespace Channel
 		json data;
 		// Others.
 		bool replied{ false };
+		// Responses of the batch request this one is an item of.
+		json* responses{ nullptr };
+		// Rest of the request (see Defer()).
+		std::function<bool()> deferredStep;
 	};
 } // namespace Channel
 
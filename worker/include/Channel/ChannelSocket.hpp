@@ -17,12 +17,22 @@ namespace Channel
 			virtual ~Listener() = default;
 
 		public:
+			// New data was read. The listener must call HandleMessages() (now or
+			// later).
+			virtual void OnConsumerSocketRead(ConsumerSocket* consumerSocket) = 0;
+			virtual bool OnConsumerSocketCanHandleMessage(ConsumerSocket* consumerSocket) = 0;
 			virtual void OnConsumerSocketMessage(ConsumerSocket* consumerSocket, char* msg, size_t msgLen) = 0;
 			virtual void OnConsumerSocketClosed(ConsumerSocket* consumerSocket) = 0;
 		};
 
 	public:
 		ConsumerSocket(int fd, size_t bufferSize, Listener* listener);
+
+	public:
+		// Passes the read messages to the listener while it can handle them.
+		// Returns whether none is left.
+		bool HandleMessages();
+
 		/* Pure virtual methods inherited from ::UnixStreamSocket. */
 	public:
 		void UserOnUnixStreamRead() override;
@@ -48,6 +58,13 @@ namespace Channel
 		}
 	};
 
+	/**
+	 * Requests are handled within a time budget per loop iteration. Once it's
+	 * exhausted the rest are handled in next iterations (reading from the
+	 * socket is paused meanwhile) so the I/O of media is not delayed by a
+	 * burst of requests. Heavy requests can be handled in steps (see
+	 * ChannelRequest::Defer()) with the same budget.
+	 */
 	class ChannelSocket : public ConsumerSocket::Listener
 	{
 	public:
@@ -62,6 +79,11 @@ namespace Channel
 			virtual void OnChannelClosed(Channel::ChannelSocket* channel)        = 0;
 		};
 
+	public:
+		// Time (in ns) requests can take in a loop iteration before yielding to
+		// I/O.
+		static constexpr uint64_t RequestsBudgetNs{ 2000000u };
+
 	public:
 		explicit ChannelSocket(int consumerFd, int producerFd);
 		explicit ChannelSocket(
@@ -76,13 +98,35 @@ namespace Channel
 		void SetListener(Listener* listener);
 		bool CallbackRead();
 		void Send(json& jsonMessage);
+		// Already serialized message (see ChannelMessageWriter).
+		void Send(const uint8_t* message, size_t messageLen);
 		void SendLog(const char* message, uint32_t messageLen);
+		// Writes the messages queued in this loop iteration.
+		void Flush();
 
 	private:
 		void SendImpl(const uint8_t* payload, uint32_t payloadLen);
+		void HandleMessage(const uint8_t* msg, size_t msgLen);
+		// Handles requests until running out of budget. Returns whether none is
+		// left.
+		bool HandleRequests();
+		bool HandleDeferredRequest();
+		bool HasBudget() const
+		{
+			return uv_hrtime() - this->budgetStartedAtNs < ChannelSocket::RequestsBudgetNs;
+		}
+		void StartRequests();
+
+		/* Callbacks fired by UV events. */
+	public:
+		void OnUvPrepare();
+		void OnUvReadAsync();
+		void OnUvIdle();
 
 		/* Pure virtual methods inherited from ConsumerSocket::Listener. */
 	public:
+		void OnConsumerSocketRead(ConsumerSocket* consumerSocket) override;
+		bool OnConsumerSocketCanHandleMessage(ConsumerSocket* consumerSocket) override;
 		void OnConsumerSocketMessage(ConsumerSocket* consumerSocket, char* msg, size_t msgLen) override;
 		void OnConsumerSocketClosed(ConsumerSocket* consumerSocket) override;
 
@@ -98,7 +142,17 @@ namespace Channel
 		ChannelWriteFn channelWriteFn{ nullptr };
 		ChannelWriteCtx channelWriteCtx{ nullptr };
 		uv_async_t* uvReadHandle{ nullptr };
+		// Messages are queued here and written at once before the loop blocks
+		// for I/O (so there is a single write per loop iteration).
 		uint8_t* writeBuffer{ nullptr };
+		size_t writeBufferLen{ 0u };
+		uv_prepare_t* uvPrepareHandle{ nullptr };
+		// Active while requests are left for next loop iterations.
+		uv_idle_t* uvIdleHandle{ nullptr };
+		bool yielding{ false };
+		uint64_t budgetStartedAtNs{ 0u };
+		// Request being handled in steps.
+		Channel::ChannelRequest* deferredRequest{ nullptr };
 	};
 } // namespace Channel
 
@@ -2,28 +2,63 @@
 #define MS_DEP_LIBUV_HPP
 
 #include "common.hpp"
+#include <nlohmann/json.hpp>
 #include <uv.h>
 
+using json = nlohmann::json;
+
 class DepLibUV
 {
 public:
 	static void ClassInit();
 	static void ClassDestroy();
 	static void PrintVersion();
-	static void RunLoop();
+	// If busyPollUs is given, once woken up the loop keeps polling with no
+	// timeout until there are no events during busyPollUs, so events arriving
+	// meanwhile do not suffer the wake up latency of a blocking poll.
+	static void RunLoop(uint32_t busyPollUs = 0u);
+	static void FillJsonLoopStats(json& jsonObject);
 	static uv_loop_t* GetLoop()
 	{
 		return DepLibUV::loop;
 	}
+	// While the loop runs, the time is read once per loop iteration phase
+	// (timers, I/O callbacks and checks) and cached, so reading it many times
+	// per packet costs no syscall.
 	static uint64_t GetTimeMs()
 	{
-		return static_cast<uint64_t>(uv_hrtime() / 1000000u);
+		return static_cast<uint64_t>(DepLibUV::GetTimeNs() / 1000000u);
 	}
 	static uint64_t GetTimeUs()
 	{
-		return static_cast<uint64_t>(uv_hrtime() / 1000u);
+		return static_cast<uint64_t>(DepLibUV::GetTimeNs() / 1000u);
 	}
 	static uint64_t GetTimeNs()
+	{
+		if (DepLibUV::cachedTimeNs != 0u)
+			return DepLibUV::cachedTimeNs;
+
+		const uint64_t nowNs = uv_hrtime();
+
+		if (DepLibUV::running)
+			DepLibUV::cachedTimeNs = nowNs;
+
+		return nowNs;
+	}
+	// Out of the loop, makes GetTimeNs() (and the rest of cached time getters)
+	// return the given time until called with 0, so tests can drive time
+	// dependent code deterministically and faster than real time.
+	static void SetVirtualTimeNs(uint64_t nowNs)
+	{
+		DepLibUV::cachedTimeNs = nowNs;
+	}
+	// Current time, not cached. Use it where precision matters (i.e. send
+	// times of packets and latency measurements).
+	static uint64_t GetHighResTimeMs()
+	{
+		return static_cast<uint64_t>(uv_hrtime() / 1000000u);
+	}
+	static uint64_t GetHighResTimeNs()
 	{
 		return uv_hrtime();
 	}
@@ -39,9 +74,36 @@ public:
 	{
 		return static_cast<int64_t>(DepLibUV::GetTimeUs());
 	}
+	// Used within libwebrtc dependency which uses int64_t values for time
+	// representation.
+	static int64_t GetHighResTimeMsInt64()
+	{
+		return static_cast<int64_t>(DepLibUV::GetHighResTimeMs());
+	}
+
+	/* Callbacks fired by UV events. */
+public:
+	static void OnUvPrepare();
+	static void OnUvCheck();
+
+private:
+	static int RunBusyPollLoop(uint64_t busyPollNs);
 
 private:
 	thread_local static uv_loop_t* loop;
+	// Invalidate the cached time before polling and after I/O callbacks.
+	thread_local static uv_prepare_t* uvPrepareHandle;
+	thread_local static uv_check_t* uvCheckHandle;
+	thread_local static bool running;
+	thread_local static uint64_t cachedTimeNs;
+	// Whether I/O callbacks ran in the last poll.
+	thread_local static bool polledEvents;
+	// Loop stats.
+	thread_local static uint64_t numIterations;
+	thread_local static uint64_t numBlockingIterations;
+	thread_local static uint64_t numSpinIterations;
+	thread_local static uint64_t numIdleSpins;
+	thread_local static uint64_t idleSpinNs;
 };
 
 #endif
@@ -5,6 +5,8 @@
 #include "RTC/SctpAssociation.hpp"
 #include "handles/Timer.hpp"
 #include <absl/container/flat_hash_map.h>
+#include <uv.h>
+#include <vector>
 
 class DepUsrSCTP
 {
@@ -18,6 +20,10 @@ private:
 	public:
 		void Start();
 		void Stop();
+		void HandleActivity();
+		void ScheduleFlush(RTC::SctpAssociation* sctpAssociation);
+		void CancelFlush(RTC::SctpAssociation* sctpAssociation);
+		void Flush();
 
 		/* Pure virtual methods inherited from Timer::Listener. */
 	public:
@@ -25,7 +31,14 @@ private:
 
 	private:
 		Timer* timer{ nullptr };
+		uv_prepare_t* uvPrepareHandle{ nullptr };
 		uint64_t lastCalledAtMs{ 0u };
+		// Current check interval (it grows while SCTP is idle).
+		uint64_t intervalMs{ 0u };
+		// Whether there has been SCTP activity since the last check.
+		bool activity{ false };
+		// SctpAssociations with messages to be sent before the loop blocks for I/O.
+		std::vector<RTC::SctpAssociation*> flushSctpAssociations;
 	};
 
 public:
@@ -37,9 +50,21 @@ public:
 	static void RegisterSctpAssociation(RTC::SctpAssociation* sctpAssociation);
 	static void DeregisterSctpAssociation(RTC::SctpAssociation* sctpAssociation);
 	static RTC::SctpAssociation* RetrieveSctpAssociation(uintptr_t id);
+	// Must be called when SCTP data is sent or received so usrsctp timers are
+	// checked often enough.
+	static void HandleSctpActivity();
+	// Makes the SctpAssociation send its queued messages in this loop iteration.
+	static void ScheduleSctpAssociationFlush(RTC::SctpAssociation* sctpAssociation);
+	static void CancelSctpAssociationFlush(RTC::SctpAssociation* sctpAssociation);
+
+	/* Callbacks fired by UV events. */
+public:
+	static void OnUvPrepare();
 
 private:
 	thread_local static Checker* checker;
+	// Whether usrsctp was initialized by this thread.
+	thread_local static bool initialized;
 	static uint64_t numSctpAssociations;
 	static uintptr_t nextSctpAssociationId;
 	static absl::flat_hash_map<uintptr_t, RTC::SctpAssociation*> mapIdSctpAssociation;
@@ -0,0 +1,71 @@
+#ifndef MS_LOG_FILE_SINK_HPP
+#define MS_LOG_FILE_SINK_HPP
+
+#include "common.hpp"
+#include <atomic>
+#include <memory> // std::unique_ptr
+#include <string>
+#include <thread>
+
+/**
+ * File into which log lines are written (logFile setting) by a helper thread,
+ * so the thread logging never blocks on disk.
+ *
+ * Lines are pushed into a bounded lock-free ring of fixed size slots which
+ * any number of threads can write into (a sequence per slot tells whether it
+ * is free or holds a line). Longer lines are truncated and lines pushed while
+ * the ring is full are dropped and counted. The helper thread drains the ring
+ * and writes all the lines it got with a single write() call.
+ */
+class LogFileSink
+{
+public:
+	// Must be a power of 2.
+	static constexpr size_t NumSlots{ 4096u };
+	static constexpr size_t SlotSize{ 512u };
+	// Time the helper thread sleeps when there are no lines.
+	static constexpr uint32_t IdleIntervalMs{ 20u };
+
+private:
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		uint16_t len;
+		char data[SlotSize];
+	};
+
+	static_assert((NumSlots & (NumSlots - 1)) == 0, "NumSlots must be a power of 2");
+
+public:
+	explicit LogFileSink(const std::string& path);
+	~LogFileSink();
+
+public:
+	// Can be called from any thread. Returns false if the line was dropped.
+	bool Push(const char* line, size_t len);
+	uint64_t GetDroppedLines() const
+	{
+		return this->droppedLines.load(std::memory_order_relaxed);
+	}
+
+private:
+	// Called from the helper thread. Returns the number of lines appended.
+	size_t Drain(std::string& batch);
+	void ThreadMain();
+
+private:
+	// Passed by argument.
+	std::string path;
+	// Others.
+	int fd{ -1 };
+	std::unique_ptr<Slot[]> slots;
+	// Written by producers.
+	alignas(64) std::atomic<size_t> enqueuePos{ 0u };
+	// Written by the helper thread.
+	alignas(64) size_t dequeuePos{ 0u };
+	std::atomic<bool> stopping{ false };
+	std::atomic<uint64_t> droppedLines{ 0u };
+	std::thread thread;
+};
+
+#endif
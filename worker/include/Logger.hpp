@@ -90,6 +90,7 @@
 #include "LogLevel.hpp"
 #include "Settings.hpp"
 #include "Channel/ChannelSocket.hpp"
+#include <cstddef> // offsetof()
 #include <cstdio>  // std::snprintf(), std::fprintf(), stdout, stderr
 #include <cstdlib> // std::abort()
 #include <cstring>
@@ -98,6 +99,8 @@
 
 #define _MS_TAG_ENABLED(tag) Settings::configuration.logTags.tag
 #define _MS_TAG_ENABLED_2(tag1, tag2) (Settings::configuration.logTags.tag1 || Settings::configuration.logTags.tag2)
+#define _MS_TAG_INDEX(tag) offsetof(Settings::LogTags, tag)
+#define _MS_TAG_INDEX_2(tag1, tag2) (_MS_TAG_ENABLED(tag1) ? _MS_TAG_INDEX(tag1) : _MS_TAG_INDEX(tag2))
 
 #if !defined(MS_LOG_DEV_LEVEL)
 	#define MS_LOG_DEV_LEVEL 0
@@ -126,16 +129,38 @@
 	((value & 0x02) ? '1' : '0'), \
 	((value & 0x01) ? '1' : '0')
 
+class LogFileSink;
+
 class Logger
 {
+private:
+	struct TagRate
+	{
+		uint64_t windowStartMs{ 0u };
+		uint32_t lines{ 0u };
+		uint64_t droppedLines{ 0u };
+	};
+
 public:
 	static void ClassInit(Channel::ChannelSocket* channel);
+	// Lines are written into the given file (logFile setting) instead of being
+	// sent to the Channel (but errors, which are sent anyway).
+	static void ClassInitFileSink(const std::string& path);
+	static void ClassDestroy();
+	static void Write(const char* line, size_t len);
+	// Applies the logRateLimit setting to lines of the given tag (its index in
+	// Settings::LogTags).
+	static bool IsTagLineAllowed(size_t tagIdx);
 
 public:
-	static const uint64_t pid;
+	thread_local static uint64_t pid;
 	thread_local static Channel::ChannelSocket* channel;
+	thread_local static LogFileSink* fileSink;
 	static const size_t bufferSize {50000};
 	thread_local static char buffer[];
+
+private:
+	thread_local static TagRate tagRates[];
 };
 
 /* Logging macros. */
@@ -160,7 +185,7 @@ public:
 			if (Settings::configuration.logLevel == LogLevel::LOG_DEBUG) \
 			{ \
 				int loggerWritten = std::snprintf(Logger::buffer, Logger::bufferSize, "D(trace) " _MS_LOG_STR, _MS_LOG_ARG); \
-				Logger::channel->SendLog(Logger::buffer, static_cast<uint32_t>(loggerWritten)); \
+				Logger::Write(Logger::buffer, static_cast<size_t>(loggerWritten)); \
 			} \
 		} \
 		while (false)
@@ -189,10 +214,10 @@ public:
 #define MS_DEBUG_TAG(tag, desc, ...) \
 	do \
 	{ \
-		if (Settings::configuration.logLevel == LogLevel::LOG_DEBUG && _MS_TAG_ENABLED(tag)) \
+		if (Settings::configuration.logLevel == LogLevel::LOG_DEBUG && _MS_TAG_ENABLED(tag) && Logger::IsTagLineAllowed(_MS_TAG_INDEX(tag))) \
 		{ \
 			int loggerWritten = std::snprintf(Logger::buffer, Logger::bufferSize, "D" _MS_LOG_STR_DESC desc, _MS_LOG_ARG, ##__VA_ARGS__); \
-			Logger::channel->SendLog(Logger::buffer, static_cast<uint32_t>(loggerWritten)); \
+			Logger::Write(Logger::buffer, static_cast<size_t>(loggerWritten)); \
 		} \
 	} \
 	while (false)
@@ -211,10 +236,10 @@ public:
 #define MS_WARN_TAG(tag, desc, ...) \
 	do \
 	{ \
-		if (Settings::configuration.logLevel >= LogLevel::LOG_WARN && _MS_TAG_ENABLED(tag)) \
+		if (Settings::configuration.logLevel >= LogLevel::LOG_WARN && _MS_TAG_ENABLED(tag) && Logger::IsTagLineAllowed(_MS_TAG_INDEX(tag))) \
 		{ \
 			int loggerWritten = std::snprintf(Logger::buffer, Logger::bufferSize, "W" _MS_LOG_STR_DESC desc, _MS_LOG_ARG, ##__VA_ARGS__); \
-			Logger::channel->SendLog(Logger::buffer, static_cast<uint32_t>(loggerWritten)); \
+			Logger::Write(Logger::buffer, static_cast<size_t>(loggerWritten)); \
 		} \
 	} \
 	while (false)
@@ -233,10 +258,10 @@ public:
 #define MS_DEBUG_2TAGS(tag1, tag2, desc, ...) \
 	do \
 	{ \
-		if (Settings::configuration.logLevel == LogLevel::LOG_DEBUG && _MS_TAG_ENABLED_2(tag1, tag2)) \
+		if (Settings::configuration.logLevel == LogLevel::LOG_DEBUG && _MS_TAG_ENABLED_2(tag1, tag2) && Logger::IsTagLineAllowed(_MS_TAG_INDEX_2(tag1, tag2))) \
 		{ \
 			int loggerWritten = std::snprintf(Logger::buffer, Logger::bufferSize, "D" _MS_LOG_STR_DESC desc, _MS_LOG_ARG, ##__VA_ARGS__); \
-			Logger::channel->SendLog(Logger::buffer, static_cast<uint32_t>(loggerWritten)); \
+			Logger::Write(Logger::buffer, static_cast<size_t>(loggerWritten)); \
 		} \
 	} \
 	while (false)
@@ -255,10 +280,10 @@ public:
 #define MS_WARN_2TAGS(tag1, tag2, desc, ...) \
 	do \
 	{ \
-		if (Settings::configuration.logLevel >= LogLevel::LOG_WARN && _MS_TAG_ENABLED_2(tag1, tag2)) \
+		if (Settings::configuration.logLevel >= LogLevel::LOG_WARN && _MS_TAG_ENABLED_2(tag1, tag2) && Logger::IsTagLineAllowed(_MS_TAG_INDEX_2(tag1, tag2))) \
 		{ \
 			int loggerWritten = std::snprintf(Logger::buffer, Logger::bufferSize, "W" _MS_LOG_STR_DESC desc, _MS_LOG_ARG, ##__VA_ARGS__); \
-			Logger::channel->SendLog(Logger::buffer, static_cast<uint32_t>(loggerWritten)); \
+			Logger::Write(Logger::buffer, static_cast<size_t>(loggerWritten)); \
 		} \
 	} \
 	while (false)
@@ -279,7 +304,7 @@ public:
 		do \
 		{ \
 			int loggerWritten = std::snprintf(Logger::buffer, Logger::bufferSize, "D" _MS_LOG_STR_DESC desc, _MS_LOG_ARG, ##__VA_ARGS__); \
-			Logger::channel->SendLog(Logger::buffer, static_cast<uint32_t>(loggerWritten)); \
+			Logger::Write(Logger::buffer, static_cast<size_t>(loggerWritten)); \
 		} \
 		while (false)
 
@@ -301,7 +326,7 @@ public:
 		do \
 		{ \
 			int loggerWritten = std::snprintf(Logger::buffer, Logger::bufferSize, "W" _MS_LOG_STR_DESC desc, _MS_LOG_ARG, ##__VA_ARGS__); \
-			Logger::channel->SendLog(Logger::buffer, static_cast<uint32_t>(loggerWritten)); \
+			Logger::Write(Logger::buffer, static_cast<size_t>(loggerWritten)); \
 		} \
 		while (false)
 
@@ -321,7 +346,7 @@ public:
 	do \
 	{ \
 		int loggerWritten = std::snprintf(Logger::buffer, Logger::bufferSize, "X" _MS_LOG_STR_DESC desc, _MS_LOG_ARG, ##__VA_ARGS__); \
-		Logger::channel->SendLog(Logger::buffer, static_cast<uint32_t>(loggerWritten)); \
+		Logger::Write(Logger::buffer, static_cast<size_t>(loggerWritten)); \
 	} \
 	while (false)
 
@@ -337,7 +362,7 @@ public:
 	do \
 	{ \
 		int loggerWritten = std::snprintf(Logger::buffer, Logger::bufferSize, "X(data) " _MS_LOG_STR, _MS_LOG_ARG); \
-		Logger::channel->SendLog(Logger::buffer, static_cast<uint32_t>(loggerWritten)); \
+		Logger::Write(Logger::buffer, static_cast<size_t>(loggerWritten)); \
 		size_t bufferDataLen{ 0 }; \
 		for (size_t i{0}; i < len; ++i) \
 		{ \
@@ -345,7 +370,7 @@ public:
 		  { \
 		  	if (bufferDataLen != 0) \
 		  	{ \
-		  		Logger::channel->SendLog(Logger::buffer, static_cast<uint32_t>(bufferDataLen)); \
+		  		Logger::Write(Logger::buffer, bufferDataLen); \
 		  		bufferDataLen = 0; \
 		  	} \
 		    int loggerWritten = std::snprintf(Logger::buffer + bufferDataLen, Logger::bufferSize, "X%06X ", static_cast<unsigned int>(i)); \
@@ -355,7 +380,7 @@ public:
 		  bufferDataLen += loggerWritten; \
 		} \
 		if (bufferDataLen != 0) \
-			Logger::channel->SendLog(Logger::buffer, static_cast<uint32_t>(bufferDataLen)); \
+			Logger::Write(Logger::buffer, bufferDataLen); \
 	} \
 	while (false)
 
@@ -395,7 +420,7 @@ public:
 		if (Settings::configuration.logLevel >= LogLevel::LOG_ERROR || MS_LOG_DEV_LEVEL >= 1) \
 		{ \
 			int loggerWritten = std::snprintf(Logger::buffer, Logger::bufferSize, "E" _MS_LOG_STR_DESC desc, _MS_LOG_ARG, ##__VA_ARGS__); \
-			Logger::channel->SendLog(Logger::buffer, static_cast<uint32_t>(loggerWritten)); \
+			Logger::Write(Logger::buffer, static_cast<size_t>(loggerWritten)); \
 		} \
 	} \
 	while (false)
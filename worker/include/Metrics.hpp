@@ -0,0 +1,224 @@
+#ifndef MS_METRICS_HPP
+#define MS_METRICS_HPP
+
+#include "common.hpp"
+#include <nlohmann/json.hpp>
+#include <uv.h>
+#include <array>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#endif
+
+using json = nlohmann::json;
+
+/**
+ * Per thread (so per worker) always on instrumentation of the event loop and
+ * of the hot stages of the media path, reported in the resource usage of the
+ * Worker.
+ *
+ * - Loop lag: busy time of every loop iteration (so the max delay an I/O event
+ *   may suffer before being processed), measured with a uv_check handle and
+ *   the loop idle time (UV_METRICS_IDLE_TIME).
+ * - Stages: CPU cycles (TSC on x86, nanoseconds elsewhere) spent in each
+ *   instrumented stage. Nested stages are included in the outer stage.
+ * - Ingress time (forwardingLatency setting): time at which the socket (or
+ *   the Channel) data being processed was read, so RTP packets parsed from it
+ *   are stamped with it, and time datagrams spend in the UDP egress queue.
+ * - Allocations (ms_allocation_stats Meson option): heap allocations (and
+ *   their bytes) done in each stage, counted by replacing the global operator
+ *   new and reported in the dump of the Worker. Nested stages are included
+ *   in the outer stage too.
+ *
+ * Samples are kept in log-linear histograms so recording is a couple of
+ * integer operations and memory usage is fixed.
+ */
+class Metrics
+{
+public:
+	enum class Stage : uint8_t
+	{
+		TRANSPORT_RECEIVE_RTP = 0,
+		ROUTER_FAN_OUT,
+		SRTP,
+		CHANNEL_IO,
+		TRANSPORT_CONGESTION_CONTROL_CLIENT,
+		SEND_RTCP,
+		CHANNEL_REQUEST,
+		// Number of stages.
+		MAX
+	};
+
+	/**
+	 * HDR style histogram: values below 16 have their own bucket and every power
+	 * of two above is split into 8 buckets, so the relative error is below 12.5%.
+	 */
+	class Histogram
+	{
+	public:
+		static constexpr size_t SubBucketBits{ 3u };
+		static constexpr size_t SubBucketCount{ 1u << SubBucketBits };
+		static constexpr size_t LinearBucketCount{ 2u * SubBucketCount };
+		static constexpr size_t BucketCount{ LinearBucketCount +
+			                                   ((64u - SubBucketBits - 1u) * SubBucketCount) };
+
+	public:
+		static size_t GetBucketIndex(uint64_t value);
+		static uint64_t GetBucketLowerBound(size_t index);
+
+	public:
+		void Record(uint64_t value)
+		{
+			this->counts[GetBucketIndex(value)]++;
+			this->count++;
+			this->sum += value;
+
+			if (value > this->max)
+				this->max = value;
+		}
+		uint64_t GetCount() const
+		{
+			return this->count;
+		}
+		uint64_t GetMax() const
+		{
+			return this->max;
+		}
+		// Lower bound of the bucket holding the given percentile (0-100).
+		uint64_t GetPercentile(double percentile) const;
+		// Values are multiplied by the given scale (i.e. to convert them to ns).
+		void FillJson(json& jsonObject, double scale, bool withBuckets = true) const;
+
+	private:
+		uint64_t counts[BucketCount]{};
+		uint64_t count{ 0u };
+		uint64_t sum{ 0u };
+		uint64_t max{ 0u };
+	};
+
+	/**
+	 * Records the cycles spent (and the heap allocations done if built with
+	 * ms_allocation_stats) in the enclosing scope.
+	 */
+	class StageScope
+	{
+	public:
+		explicit StageScope(Stage stage) : stage(stage), startedAt(Metrics::GetCycles())
+		{
+#ifdef MS_ALLOCATION_STATS
+			this->startAllocations    = Metrics::allocations;
+			this->startAllocatedBytes = Metrics::allocatedBytes;
+#endif
+		}
+		~StageScope()
+		{
+			Metrics::RecordStage(this->stage, Metrics::GetCycles() - this->startedAt);
+#ifdef MS_ALLOCATION_STATS
+			Metrics::RecordStageAllocations(
+			  this->stage,
+			  Metrics::allocations - this->startAllocations,
+			  Metrics::allocatedBytes - this->startAllocatedBytes);
+#endif
+		}
+
+	private:
+		Stage stage;
+		uint64_t startedAt;
+#ifdef MS_ALLOCATION_STATS
+		uint64_t startAllocations{ 0u };
+		uint64_t startAllocatedBytes{ 0u };
+#endif
+	};
+
+public:
+	static void ClassInit();
+	static void ClassDestroy();
+	static void FillJson(json& jsonObject);
+	static uint64_t GetCycles()
+	{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+		return __rdtsc();
+#else
+		return uv_hrtime();
+#endif
+	}
+	// Ns per cycle as measured since ClassInit().
+	static double GetNsPerCycle();
+	static void RecordStage(Stage stage, uint64_t cycles)
+	{
+		// Not initialized in this thread (i.e. a SRTP encryption thread).
+		if (!Metrics::stageHistograms)
+			return;
+
+		Metrics::stageHistograms[static_cast<size_t>(stage)].Record(cycles);
+	}
+	static void OnUvCheck();
+	// Busy time (ns) of the loop and max loop lag (ns) since the previous call.
+	static void TakeLoopWindow(uint64_t& busyNs, uint64_t& maxLagNs);
+	static void EnableIngressTime();
+	static bool IsIngressTimeEnabled()
+	{
+		return Metrics::ingressTimeEnabled;
+	}
+	// Called when data is read from a socket.
+	static void MarkIngress()
+	{
+		if (Metrics::ingressTimeEnabled)
+			Metrics::ingressTimeNs = uv_hrtime();
+	}
+	// Called when data read before is processed later (f.e. once decrypted out
+	// of the loop thread).
+	static void SetIngressTime(uint64_t ingressTimeNs)
+	{
+		Metrics::ingressTimeNs = ingressTimeNs;
+	}
+	// Time (ns) at which the data being processed was read (0 if disabled).
+	static uint64_t GetIngressTime()
+	{
+		return Metrics::ingressTimeNs;
+	}
+	static void RecordSendQueueDelay(uint64_t ns)
+	{
+		if (!Metrics::sendQueueDelayHistogram)
+			return;
+
+		Metrics::sendQueueDelayHistogram->Record(ns);
+	}
+	// Called by the global operator new (if built with ms_allocation_stats).
+	static void RecordAllocation(size_t size)
+	{
+		++Metrics::allocations;
+		Metrics::allocatedBytes += size;
+	}
+	static void RecordStageAllocations(Stage stage, uint64_t allocations, uint64_t allocatedBytes)
+	{
+		Metrics::stageAllocations[static_cast<size_t>(stage)] += allocations;
+		Metrics::stageAllocatedBytes[static_cast<size_t>(stage)] += allocatedBytes;
+	}
+	static void FillJsonAllocations(json& jsonObject);
+
+private:
+	using StageCounters = std::array<uint64_t, static_cast<size_t>(Stage::MAX)>;
+
+private:
+	thread_local static uv_check_t* uvCheckHandle;
+	thread_local static Histogram* loopLagHistogram;
+	thread_local static Histogram* stageHistograms;
+	thread_local static uint64_t lastCheckAtNs;
+	thread_local static uint64_t lastIdleTimeNs;
+	thread_local static uint64_t windowBusyNs;
+	thread_local static uint64_t windowMaxLagNs;
+	// Used to convert cycles into ns.
+	thread_local static uint64_t initCycles;
+	thread_local static uint64_t initTimeNs;
+	thread_local static bool ingressTimeEnabled;
+	thread_local static uint64_t ingressTimeNs;
+	thread_local static Histogram* sendQueueDelayHistogram;
+	thread_local static uint64_t allocations;
+	thread_local static uint64_t allocatedBytes;
+	thread_local static StageCounters stageAllocations;
+	thread_local static StageCounters stageAllocatedBytes;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef MS_OVERLOAD_CONTROLLER_HPP
+#define MS_OVERLOAD_CONTROLLER_HPP
+
+#include "common.hpp"
+#include "handles/Timer.hpp"
+#include <nlohmann/json.hpp>
+#include <string>
+
+using json = nlohmann::json;
+
+/**
+ * Sheds load when the event loop of the worker saturates (overloadProtection
+ * setting), so media keeps flowing for most consumers instead of degrading
+ * for all of them (late NACK timers, delayed BWE feedback, etc).
+ *
+ * Every second the loop utilization (busy time measured by Metrics) and the
+ * max loop lag are checked. The level is raised one step every time they are
+ * high and lowered one step after they have been low for a while:
+ *
+ * - DROP_RTX: NACKs are ignored so nothing is retransmitted.
+ * - DROP_TEMPORAL_LAYERS: Simulcast and SVC Consumers send up to temporal
+ *   layer 1.
+ * - DROP_SPATIAL_LAYERS: Also up to spatial layer 0.
+ * - PAUSE_CONSUMERS: Also video Consumers with the lowest priority (1) are
+ *   paused.
+ *
+ * The current level is per thread (so per worker) state that Consumers read
+ * when created.
+ */
+class OverloadController : public Timer::Listener
+{
+public:
+	enum class Level : uint8_t
+	{
+		NONE = 0,
+		DROP_RTX,
+		DROP_TEMPORAL_LAYERS,
+		DROP_SPATIAL_LAYERS,
+		PAUSE_CONSUMERS
+	};
+
+public:
+	class Listener
+	{
+	public:
+		virtual ~Listener() = default;
+
+	public:
+		virtual void OnOverloadControllerLevelChange(
+		  OverloadController* overloadController, Level level, Level previousLevel) = 0;
+	};
+
+public:
+	static Level GetLevel()
+	{
+		return OverloadController::level;
+	}
+	// Whether a received NACK must be ignored (it counts it).
+	static bool ShedNack();
+	// Max layers a Consumer may send at the given level (-1 means no limit).
+	static void GetMaxLayers(Level level, int16_t& maxSpatialLayer, int16_t& maxTemporalLayer);
+	static const std::string& GetLevelString(Level level);
+
+public:
+	explicit OverloadController(Listener* listener);
+	~OverloadController() override;
+
+public:
+	// Given the loop utilization (0-1) and max loop lag of the last period.
+	void Update(double utilization, uint64_t maxLoopLagMs);
+	void FillJson(json& jsonObject) const;
+
+	/* Pure virtual methods inherited from Timer::Listener. */
+public:
+	void OnTimer(Timer* timer) override;
+
+private:
+	thread_local static Level level;
+	thread_local static uint64_t shedNacks;
+
+private:
+	// Passed by argument.
+	Listener* listener{ nullptr };
+	// Allocated by this.
+	Timer* checkTimer{ nullptr };
+	// Others.
+	uint64_t lastCheckAtNs{ 0u };
+	// Consecutive periods with low load.
+	uint32_t lowLoadPeriods{ 0u };
+	double utilization{ 0 };
+	uint64_t maxLoopLagMs{ 0u };
+};
+
+#endif
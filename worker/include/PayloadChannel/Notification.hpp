@@ -32,6 +32,9 @@ namespace PayloadChannel
 
 	public:
 		void SetPayload(const uint8_t* payload, size_t payloadLen);
+		// The payload buffer is handed over by the embedder (see
+		// PayloadChannelReadFn) so it can be written while handling this.
+		void SetOwnedPayload(uint8_t* payload, size_t payloadLen, size_t payloadCapacity);
 
 	public:
 		// Passed by argument.
@@ -41,6 +44,9 @@ namespace PayloadChannel
 		json data;
 		const uint8_t* payload{ nullptr };
 		size_t payloadLen{ 0u };
+		// Set if the payload can be written (up to payloadCapacity bytes).
+		uint8_t* writablePayload{ nullptr };
+		size_t payloadCapacity{ 0u };
 	};
 } // namespace PayloadChannel
 
@@ -5,6 +5,7 @@
 #include "PayloadChannel/PayloadChannelSocket.hpp"
 #include <nlohmann/json.hpp>
 #include <string>
+#include <vector>
 
 namespace PayloadChannel
 {
@@ -20,10 +21,38 @@ namespace PayloadChannel
 		  json& data,
 		  const uint8_t* payload,
 		  size_t payloadLen);
+		// Same as above with { ppid } as data (i.e. DataChannel messages).
+		static void Emit(
+		  const std::string& targetId,
+		  const char* event,
+		  uint32_t ppid,
+		  const uint8_t* payload,
+		  size_t payloadLen);
+		// Same as above with { ppid, targetIds } as data, so the payload is sent
+		// once for all the given targets.
+		static void Emit(
+		  const std::string& targetId,
+		  const char* event,
+		  uint32_t ppid,
+		  const std::vector<const std::string*>& targetIds,
+		  const uint8_t* payload,
+		  size_t payloadLen);
+
+	private:
+		static bool SerializeNotification(
+		  const std::string& targetId,
+		  const char* event,
+		  const uint32_t* ppid,
+		  const std::vector<const std::string*>* targetIds = nullptr);
 
 	public:
 		// Passed by argument.
 		thread_local static PayloadChannel::PayloadChannelSocket* payloadChannel;
+
+	private:
+		// Notifications are emitted per packet, so they are serialized here
+		// rather than building and dumping a json object.
+		thread_local static std::vector<uint8_t> notificationBuffer;
 	};
 } // namespace PayloadChannel
 
@@ -84,12 +84,20 @@ namespace PayloadChannel
 		bool CallbackRead();
 		void Send(json& jsonMessage, const uint8_t* payload, size_t payloadLen);
 		void Send(json& jsonMessage);
+		// Sends an already serialized message.
+		void Send(const uint8_t* message, size_t messageLen, const uint8_t* payload, size_t payloadLen);
+		// Writes the messages queued in this loop iteration.
+		void Flush();
 
 	private:
 		void SendImpl(const uint8_t* message, uint32_t messageLen);
 		void SendImpl(
 		  const uint8_t* message, uint32_t messageLen, const uint8_t* payload, uint32_t payloadLen);
 
+		/* Callbacks fired by UV events. */
+	public:
+		void OnUvPrepare();
+
 		/* Pure virtual methods inherited from ConsumerSocket::Listener. */
 	public:
 		void OnConsumerSocketMessage(ConsumerSocket* consumerSocket, char* msg, size_t msgLen) override;
@@ -109,7 +117,11 @@ namespace PayloadChannel
 		PayloadChannel::Notification* ongoingNotification{ nullptr };
 		PayloadChannel::PayloadChannelRequest* ongoingRequest{ nullptr };
 		uv_async_t* uvReadHandle{ nullptr };
+		// Messages are queued here and written at once before the loop blocks
+		// for I/O (so there is a single write per loop iteration).
 		uint8_t* writeBuffer{ nullptr };
+		size_t writeBufferLen{ 0u };
+		uv_prepare_t* uvPrepareHandle{ nullptr };
 	};
 } // namespace PayloadChannel
 
@@ -2,6 +2,7 @@
 #define MS_RTC_ACTIVE_SPEAKER_OBSERVER_HPP
 
 #include "RTC/RtpObserver.hpp"
+#include "RTC/VideoLastNPolicy.hpp"
 #include "handles/Timer.hpp"
 #include <absl/container/flat_hash_map.h>
 #include <nlohmann/json.hpp>
@@ -21,8 +22,10 @@ namespace RTC
 	private:
 		class Speaker
 		{
+			friend class ActiveSpeakerObserver;
+
 		public:
-			Speaker();
+			explicit Speaker(bool useSimd);
 			void EvalActivityScores();
 			double GetActivityScore(int32_t interval);
 			void LevelChanged(uint32_t level, uint64_t now);
@@ -51,8 +54,19 @@ namespace RTC
 			std::vector<uint8_t> immediates;
 			std::vector<uint8_t> mediums;
 			std::vector<uint8_t> longs;
-			std::vector<uint8_t> levels;
+			std::vector<uint8_t> levelsStorage;
+			// Circular buffer of levels. Points to levelsStorage or, in SIMD mode,
+			// to the row of this Speaker in the levels table of the observer.
+			uint8_t* levels{ nullptr };
 			size_t nextLevelIndex;
+			// Row in the levels table of the observer (SIMD mode).
+			size_t levelsRow{ 0u };
+		};
+
+		// Row of levels of a Speaker, padded and aligned for vector loads.
+		struct alignas(64) LevelsRow
+		{
+			uint8_t levels[64]{};
 		};
 
 		struct ProducerSpeaker
@@ -62,10 +76,16 @@ namespace RTC
 		};
 
 	public:
-		ActiveSpeakerObserver(const std::string& id, json& data);
+		ActiveSpeakerObserver(
+		  RTC::VideoLastNPolicy::Listener* videoLastNPolicyListener, const std::string& id, json& data);
 		~ActiveSpeakerObserver() override;
 
 	public:
+		// Just if videoLastN was given.
+		RTC::VideoLastNPolicy* GetVideoLastNPolicy() const
+		{
+			return this->videoLastNPolicy;
+		}
 		void AddProducer(RTC::Producer* producer) override;
 		void RemoveProducer(RTC::Producer* producer) override;
 		void ReceiveRtpPacket(RTC::Producer* producer, RTC::RtpPacket* packet) override;
@@ -78,6 +98,9 @@ namespace RTC
 		void Update();
 		bool CalculateActiveSpeaker();
 		void TimeoutIdleLevels(uint64_t now);
+		void AddLevelsRow(Speaker* speaker);
+		void RemoveLevelsRow(Speaker* speaker);
+		void EvalLevelsTableActivityScores();
 
 		/* Pure virtual methods inherited from Timer. */
 	protected:
@@ -88,9 +111,15 @@ namespace RTC
 		double relativeSpeachActivities[relativeSpeachActivitiesLen];
 		std::string dominantId{ "" };
 		Timer* periodicTimer{ nullptr };
+		RTC::VideoLastNPolicy* videoLastNPolicy{ nullptr };
 		uint16_t interval{ 300u };
 		absl::flat_hash_map<std::string, struct ProducerSpeaker> mapProducerSpeaker;
 		uint64_t lastLevelIdleTime{ 0 };
+		// SIMD mode: levels of every Speaker laid out in a single table and
+		// activity scores of all of them computed at once by vector kernels.
+		bool useSimd{ false };
+		std::vector<LevelsRow> levelsTable;
+		std::vector<Speaker*> levelsTableSpeakers;
 	};
 } // namespace RTC
 
@@ -0,0 +1,59 @@
+#ifndef MS_RTC_AUDIO_LAST_N_SELECTOR_HPP
+#define MS_RTC_AUDIO_LAST_N_SELECTOR_HPP
+
+#include "common.hpp"
+#include "RTC/Producer.hpp"
+#include "RTC/RtpPacket.hpp"
+#include "handles/Timer.hpp"
+#include <absl/container/flat_hash_map.h>
+
+namespace RTC
+{
+	/**
+	 * Selects the N loudest audio Producers of a Router based on the audio level
+	 * RTP header extension. Just packets of selected Producers are forwarded to
+	 * Consumers, so silent Producers don't consume egress bandwidth.
+	 *
+	 * The selection is updated periodically. A Producer that starts speaking is
+	 * selected right away if there is room for it.
+	 */
+	class AudioLastNSelector : public Timer::Listener
+	{
+	private:
+		struct ProducerLevel
+		{
+			// Sum of the -dBov values of the packets in the current interval (127 for
+			// packets without voice).
+			uint32_t volumeSum{ 0u };
+			uint32_t packetCount{ 0u };
+			uint32_t voicePacketCount{ 0u };
+			bool selected{ false };
+		};
+
+	public:
+		explicit AudioLastNSelector(size_t lastN);
+		~AudioLastNSelector();
+
+	public:
+		// Whether the given packet of the given audio Producer must be forwarded to
+		// its Consumers.
+		bool ForwardRtpPacket(const RTC::Producer* producer, const RTC::RtpPacket* packet);
+		void RemoveProducer(const RTC::Producer* producer);
+		void Update();
+
+		/* Pure virtual methods inherited from Timer::Listener. */
+	public:
+		void OnTimer(Timer* timer) override;
+
+	private:
+		// Passed by argument.
+		size_t lastN{ 0u };
+		// Allocated by this.
+		Timer* updateTimer{ nullptr };
+		// Others.
+		absl::flat_hash_map<const RTC::Producer*, ProducerLevel> mapProducerLevels;
+		size_t selectedCount{ 0u };
+	};
+} // namespace RTC
+
+#endif
@@ -3,8 +3,11 @@
 
 #include "RTC/RtpObserver.hpp"
 #include "handles/Timer.hpp"
-#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/container/node_hash_map.h>
 #include <nlohmann/json.hpp>
+#include <limits>
+#include <vector>
 
 using json = nlohmann::json;
 
@@ -17,8 +20,16 @@ namespace RTC
 		{
 			uint16_t totalSum{ 0u }; // Sum of dBvos (positive integer).
 			size_t count{ 0u };      // Number of dBvos entries in totalSum.
+			// Incremental mode.
+			RTC::Producer* producer{ nullptr };
+			uint32_t epoch{ 0u }; // Interval in which totalSum and count were set.
+			int8_t avgDBov{ 0 };  // Running average of the current interval.
+			size_t heapIndex{ NotInHeap };
 		};
 
+	private:
+		static constexpr size_t NotInHeap{ std::numeric_limits<size_t>::max() };
+
 	public:
 		AudioLevelObserver(const std::string& id, json& data);
 		~AudioLevelObserver() override;
@@ -35,6 +46,14 @@ namespace RTC
 		void Resumed() override;
 		void Update();
 		void ResetMapProducerDBovs();
+		void UpdateTopDBovs(DBovs& dBovs);
+		void EmitVolumes();
+		void ResetTopDBovs();
+		void HeapPush(DBovs* dBovs);
+		void HeapRemove(size_t idx);
+		void HeapSiftUp(size_t idx);
+		void HeapSiftDown(size_t idx);
+		void HeapSet(size_t idx, DBovs* dBovs);
 
 		/* Pure virtual methods inherited from Timer. */
 	protected:
@@ -45,11 +64,20 @@ namespace RTC
 		uint16_t maxEntries{ 1u };
 		int8_t threshold{ -80 };
 		uint16_t interval{ 1000u };
+		bool incremental{ false };
 		// Allocated by this.
 		Timer* periodicTimer{ nullptr };
 		// Others.
-		absl::flat_hash_map<RTC::Producer*, DBovs> mapProducerDBovs;
+		absl::node_hash_map<RTC::Producer*, DBovs> mapProducerDBovs;
 		bool silence{ true };
+		// Incremental mode: min-heap (by average dBov) with the loudest maxEntries
+		// Producers of the current interval, updated on every received packet.
+		std::vector<DBovs*> topDBovs;
+		uint32_t epoch{ 0u };
+		// Producers in the last emitted 'volumes' and whether an early 'volumes'
+		// was already emitted in the current interval.
+		absl::flat_hash_set<RTC::Producer*> lastVolumesProducers;
+		bool earlyVolumesEmitted{ false };
 	};
 } // namespace RTC
 
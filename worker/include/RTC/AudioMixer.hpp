@@ -0,0 +1,169 @@
+#ifndef MS_RTC_AUDIO_MIXER_HPP
+#define MS_RTC_AUDIO_MIXER_HPP
+
+#include "common.hpp"
+#include "RTC/AudioLastNSelector.hpp"
+#include "RTC/RtpObserver.hpp"
+#include "RTC/SpscQueue.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <nlohmann/json.hpp>
+#include <uv.h>
+#include <atomic>
+#include <limits>
+#include <string>
+#include <thread>
+
+using json = nlohmann::json;
+
+struct OpusDecoder;
+struct OpusEncoder;
+
+namespace RTC
+{
+	/**
+	 * Decodes the Opus audio of the loudest maxSpeakers Producers added to it,
+	 * mixes it in a helper thread and sends the encoded mix as RTP packets of
+	 * the output Producer (usually produced on a DirectTransport), so each
+	 * listener of a large audio room just needs a single Consumer.
+	 *
+	 * Requires the worker to be built with the ms_audio_mixer Meson option
+	 * (libopus must be installed in the system).
+	 */
+	class AudioMixer : public RTC::RtpObserver
+	{
+	public:
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			virtual void OnAudioMixerRtpPacket(RTC::AudioMixer* audioMixer, RTC::RtpPacket* packet) = 0;
+		};
+
+	public:
+		// Mixed audio is 48 kHz mono in frames of 20 ms.
+		static constexpr uint32_t SampleRate{ 48000u };
+		static constexpr size_t FrameSamples{ 960u };
+		static constexpr uint32_t FrameIntervalMs{ 20u };
+		// Max samples (120 ms) decoded from a single Opus packet.
+		static constexpr size_t MaxPacketSamples{ 5760u };
+		// Decoded audio of a source above which older samples are discarded so
+		// latency stays bounded.
+		static constexpr size_t MaxBufferedSamples{ 3u * FrameSamples };
+		// Time (in milliseconds) after which a source without packets is removed.
+		static constexpr uint32_t SourceTimeoutMs{ 1000u };
+		// Must be a power of 2.
+		static constexpr size_t QueueSize{ 256u };
+
+	public:
+		// Adds the given 16 bits samples into the given accumulator.
+		static void AccumulateFrame(int32_t* mix, const int16_t* samples, size_t count)
+		{
+			// Plain loop so the compiler vectorizes it.
+			for (size_t i{ 0u }; i < count; ++i)
+			{
+				mix[i] += samples[i];
+			}
+		}
+		// Writes the given accumulator into 16 bits samples with saturation.
+		static void ClampFrame(const int32_t* mix, int16_t* samples, size_t count)
+		{
+			// Plain loop so the compiler vectorizes it.
+			for (size_t i{ 0u }; i < count; ++i)
+			{
+				const int32_t sample = mix[i] > std::numeric_limits<int16_t>::max()
+				                         ? std::numeric_limits<int16_t>::max()
+				                         : mix[i];
+
+				samples[i] = static_cast<int16_t>(
+				  sample < std::numeric_limits<int16_t>::min() ? std::numeric_limits<int16_t>::min()
+				                                               : sample);
+			}
+		}
+
+	private:
+		// Opus packet of a source, from the loop thread to the mixing thread.
+		struct InputItem
+		{
+			uint64_t sourceId;
+			uint16_t len;
+			uint8_t data[RTC::MtuSize];
+		};
+
+		// Encoded mix, from the mixing thread to the loop thread.
+		struct OutputItem
+		{
+			// Number of frames since the mixer started.
+			uint64_t frame;
+			// First frame after silence.
+			bool marker;
+			uint16_t len;
+			uint8_t data[RTC::MtuSize];
+		};
+
+		// Decoding state of a source, just used by the mixing thread.
+		struct Source
+		{
+			OpusDecoder* decoder{ nullptr };
+			int16_t samples[MaxBufferedSamples + MaxPacketSamples];
+			size_t sampleCount{ 0u };
+			uint64_t lastPacketFrame{ 0u };
+		};
+
+	public:
+		AudioMixer(RTC::AudioMixer::Listener* listener, const std::string& id, json& data);
+		~AudioMixer() override;
+
+	public:
+		const std::string& GetOutputProducerId() const
+		{
+			return this->outputProducerId;
+		}
+		void AddProducer(RTC::Producer* producer) override;
+		void RemoveProducer(RTC::Producer* producer) override;
+		void ReceiveRtpPacket(RTC::Producer* producer, RTC::RtpPacket* packet) override;
+		void ProducerPaused(RTC::Producer* producer) override;
+		void ProducerResumed(RTC::Producer* producer) override;
+
+	private:
+		void Paused() override;
+		void Resumed() override;
+		void ThreadMain();
+		void MixFrame(uint64_t frame);
+
+		/* Callbacks fired by UV events. */
+	public:
+		void OnUvAsync();
+
+	private:
+		// Passed by argument.
+		RTC::AudioMixer::Listener* listener{ nullptr };
+		std::string outputProducerId;
+		uint16_t maxSpeakers{ 3u };
+		uint32_t bitrate{ 32000u };
+		// Allocated by this.
+		AudioLastNSelector* selector{ nullptr };
+		uv_async_t* uvAsyncHandle{ nullptr };
+		// Others.
+		// Source ids of added Producers. A new id is given to a Producer added
+		// again so the mixing thread doesn't reuse stale decoding state.
+		absl::flat_hash_map<const RTC::Producer*, uint64_t> mapProducerSourceIds;
+		uint64_t nextSourceId{ 1u };
+		SpscQueue<InputItem> inputQueue{ QueueSize };
+		SpscQueue<OutputItem> outputQueue{ QueueSize };
+		std::atomic<bool> stopping{ false };
+		std::thread thread;
+		uint16_t seq{ 0u };
+		uint32_t baseTimestamp{ 0u };
+		uint8_t packetBuffer[RTC::MtuSize + 100];
+		// Used by the mixing thread.
+		absl::flat_hash_map<uint64_t, Source*> mapSources;
+		OpusEncoder* encoder{ nullptr };
+		int32_t mix[FrameSamples];
+		int16_t mixedSamples[FrameSamples];
+		bool silence{ true };
+	};
+} // namespace RTC
+
+#endif
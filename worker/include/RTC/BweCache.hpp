@@ -0,0 +1,57 @@
+#ifndef MS_RTC_BWE_CACHE_HPP
+#define MS_RTC_BWE_CACHE_HPP
+
+#include "common.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <string>
+
+namespace RTC
+{
+	/**
+	 * Per thread (so per worker) cache of the last outgoing bandwidth estimates
+	 * of the remote endpoints, so a new Transport to a known endpoint (after a
+	 * reconnection or opening a second Transport) starts the estimation from
+	 * there instead of ramping up from initialAvailableOutgoingBitrate.
+	 *
+	 * Endpoints are identified by their IPv4 address or their IPv6 /64 prefix
+	 * (a single host may use several addresses in it). Estimates expire after
+	 * MaxAgeMs.
+	 */
+	class BweCache
+	{
+	public:
+		static constexpr uint64_t MaxAgeMs{ 60000u };
+		// Number of entries above which expired ones are removed.
+		static constexpr size_t PruneThreshold{ 4096u };
+
+	private:
+		struct Entry
+		{
+			uint32_t bitrate{ 0u };
+			uint64_t updatedAtMs{ 0u };
+		};
+
+	public:
+		// Returns an empty key if the address family is not supported.
+		static std::string GetKey(const struct sockaddr* addr);
+		static void Set(const std::string& key, uint32_t bitrate);
+		// Returns 0 if there is no recent estimate.
+		static uint32_t Get(const std::string& key);
+		static size_t GetSize()
+		{
+			return BweCache::entries.size();
+		}
+		static void Clear()
+		{
+			BweCache::entries.clear();
+		}
+
+	private:
+		static void Prune(uint64_t nowMs);
+
+	private:
+		thread_local static absl::flat_hash_map<std::string, Entry> entries;
+	};
+} // namespace RTC
+
+#endif
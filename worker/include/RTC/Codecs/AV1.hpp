@@ -0,0 +1,139 @@
+#ifndef MS_RTC_CODECS_AV1_HPP
+#define MS_RTC_CODECS_AV1_HPP
+
+#include "common.hpp"
+#include "RTC/Codecs/PayloadDescriptorHandler.hpp"
+#include "RTC/RtpPacket.hpp"
+
+/* RTP payload format for AV1 (aggregation header):
+ * https://aomediacodec.github.io/av1-rtp-spec/
+ *
+ *   0 1 2 3 4 5 6 7
+ *  +-+-+-+-+-+-+-+-+
+ *  |Z|Y| W |N|-|-|-|
+ *  +-+-+-+-+-+-+-+-+
+ *
+ * Spatial and temporal layers are given by the Dependency Descriptor RTP
+ * header extension, whose frame template ids refer to the template
+ * dependency structure sent with key frames.
+ */
+
+namespace RTC
+{
+	namespace Codecs
+	{
+		class AV1
+		{
+		public:
+			// Max number of frame templates (template ids are 6 bits long).
+			static constexpr size_t MaxTemplates{ 64u };
+
+		public:
+			// Layers of each frame template in the latest template dependency
+			// structure received in a stream. It must be kept per stream since
+			// frames refer to it by template id.
+			struct TemplateStructure
+			{
+				void Dump() const;
+
+				bool present{ false };
+				// Frame number of the frame that carried the structure.
+				uint16_t frameNumber{ 0u };
+				uint8_t templateIdOffset{ 0u };
+				uint8_t templateCount{ 0u };
+				uint8_t maxSpatialId{ 0u };
+				uint8_t maxTemporalId{ 0u };
+				uint8_t spatialIds[MaxTemplates]{};
+				uint8_t temporalIds[MaxTemplates]{};
+			};
+
+		public:
+			struct PayloadDescriptor : public RTC::Codecs::PayloadDescriptor
+			{
+				~PayloadDescriptor() = default;
+
+				void Dump() const override;
+
+				// Fields in aggregation header.
+				uint8_t z : 1; // Continuation of an OBU from the previous packet.
+				uint8_t y : 1; // Last OBU continues in the next packet.
+				uint8_t n : 1; // First packet of a coded video sequence.
+
+				// Mandatory fields in dependency descriptor.
+				uint8_t startOfFrame : 1;
+				uint8_t endOfFrame : 1;
+				uint8_t templateId{ 0u };
+				uint16_t frameNumber{ 0u };
+
+				// Parsed values.
+				bool hasDependencyDescriptor{ false };
+				bool hasLayers{ false };
+				uint8_t spatialLayer{ 0u };
+				uint8_t temporalLayer{ 0u };
+				bool isKeyFrame{ false };
+			};
+
+		public:
+			static AV1::PayloadDescriptor* Parse(
+			  const uint8_t* data,
+			  size_t len,
+			  const uint8_t* dependencyDescriptor = nullptr,
+			  uint8_t dependencyDescriptorLen     = 0,
+			  TemplateStructure* templateStructure = nullptr);
+			static bool ParseTemplateStructure(
+			  const uint8_t* data, size_t len, TemplateStructure* templateStructure);
+			static void ProcessRtpPacket(
+			  RTC::RtpPacket* packet, TemplateStructure* templateStructure = nullptr);
+
+		public:
+			class EncodingContext : public RTC::Codecs::EncodingContext
+			{
+			public:
+				explicit EncodingContext(RTC::Codecs::EncodingContext::Params& params)
+				  : RTC::Codecs::EncodingContext(params)
+				{
+				}
+				~EncodingContext() = default;
+
+				/* Pure virtual methods inherited from RTC::Codecs::EncodingContext. */
+			public:
+				void SyncRequired() override
+				{
+				}
+			};
+
+		public:
+			class PayloadDescriptorHandler : public RTC::Codecs::PayloadDescriptorHandler
+			{
+			public:
+				explicit PayloadDescriptorHandler(PayloadDescriptor* payloadDescriptor);
+				~PayloadDescriptorHandler() = default;
+
+			public:
+				void Dump() const override
+				{
+					this->payloadDescriptor->Dump();
+				}
+				bool Process(RTC::Codecs::EncodingContext* encodingContext, uint8_t* data, bool& marker) override;
+				void Restore(uint8_t* data) override;
+				uint8_t GetSpatialLayer() const override
+				{
+					return this->payloadDescriptor->spatialLayer;
+				}
+				uint8_t GetTemporalLayer() const override
+				{
+					return this->payloadDescriptor->temporalLayer;
+				}
+				bool IsKeyFrame() const override
+				{
+					return this->payloadDescriptor->isKeyFrame;
+				}
+
+			private:
+				std::unique_ptr<PayloadDescriptor> payloadDescriptor;
+			};
+		};
+	} // namespace Codecs
+} // namespace RTC
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef MS_RTC_CODECS_H265_HPP
+#define MS_RTC_CODECS_H265_HPP
+
+#include "common.hpp"
+#include "RTC/Codecs/PayloadDescriptorHandler.hpp"
+#include "RTC/RtpPacket.hpp"
+
+namespace RTC
+{
+	namespace Codecs
+	{
+		// H.265/HEVC RTP payload (RFC 7798). Temporal layers are read from the
+		// TID of the NAL unit header and can be switched up at TSA/STSA and IRAP
+		// pictures.
+		class H265
+		{
+		public:
+			struct PayloadDescriptor : public RTC::Codecs::PayloadDescriptor
+			{
+				/* Pure virtual methods inherited from RTC::Codecs::PayloadDescriptor. */
+				~PayloadDescriptor() = default;
+
+				void Dump() const override;
+
+				// Fields in frame-marking extension.
+				uint8_t s : 1;          // Start of Frame.
+				uint8_t e : 1;          // End of Frame.
+				uint8_t i : 1;          // Independent Frame.
+				uint8_t d : 1;          // Discardable Frame.
+				uint8_t b : 1;          // Base Layer Sync.
+				uint8_t tid{ 0 };       // Temporal layer id.
+				uint8_t lid{ 0 };       // Spatial layer id.
+				uint8_t tl0picidx{ 0 }; // TL0PICIDX
+				// Type of the (first) NAL unit in the packet.
+				uint8_t nalUnitType{ 0 };
+				// Parsed values.
+				bool hasLid{ false };
+				bool hasTid{ false };
+				bool hasTl0picidx{ false };
+				bool isKeyFrame{ false };
+			};
+
+		public:
+			static H265::PayloadDescriptor* Parse(
+			  const uint8_t* data,
+			  size_t len,
+			  RTC::RtpPacket::FrameMarking* frameMarking = nullptr,
+			  uint8_t frameMarkingLen                    = 0);
+			static void ProcessRtpPacket(RTC::RtpPacket* packet);
+			// Used by Consumers of this codec instead of RtpPacket::ProcessPayload()
+			// and RtpPacket::RestorePayload(), so calls to the handler are not
+			// virtual.
+			static bool ProcessPayload(
+			  RTC::RtpPacket* packet, RTC::Codecs::EncodingContext* encodingContext, bool& marker);
+			static void RestorePayload(RTC::RtpPacket* packet);
+
+		public:
+			class EncodingContext final : public RTC::Codecs::EncodingContext
+			{
+			public:
+				explicit EncodingContext(RTC::Codecs::EncodingContext::Params& params)
+				  : RTC::Codecs::EncodingContext(params)
+				{
+				}
+				~EncodingContext() = default;
+
+				/* Pure virtual methods inherited from RTC::Codecs::EncodingContext. */
+			public:
+				void SyncRequired() override
+				{
+				}
+			};
+
+		public:
+			class PayloadDescriptorHandler final : public RTC::Codecs::PayloadDescriptorHandler
+			{
+			public:
+				explicit PayloadDescriptorHandler(PayloadDescriptor* payloadDescriptor);
+				~PayloadDescriptorHandler() = default;
+
+			public:
+				void Dump() const override
+				{
+					this->payloadDescriptor->Dump();
+				}
+				bool Process(RTC::Codecs::EncodingContext* encodingContext, uint8_t* data, bool& marker) override;
+				void Restore(uint8_t* data) override;
+				uint8_t GetSpatialLayer() const override
+				{
+					return 0u;
+				}
+				uint8_t GetTemporalLayer() const override
+				{
+					return this->payloadDescriptor->tid;
+				}
+				bool IsKeyFrame() const override
+				{
+					return this->payloadDescriptor->isKeyFrame;
+				}
+
+			private:
+				std::unique_ptr<PayloadDescriptor> payloadDescriptor;
+			};
+		};
+	} // namespace Codecs
+} // namespace RTC
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef MS_RTC_CODECS_OPUS_HPP
+#define MS_RTC_CODECS_OPUS_HPP
+
+#include "common.hpp"
+#include "RTC/RtpPacket.hpp"
+
+namespace RTC
+{
+	namespace Codecs
+	{
+		class Opus
+		{
+		public:
+			// Whether the packet is a DTX packet (silence, just the TOC byte and
+			// optionally the frame count byte).
+			static bool IsDtx(const RTC::RtpPacket* packet);
+		};
+	} // namespace Codecs
+} // namespace RTC
+
+#endif
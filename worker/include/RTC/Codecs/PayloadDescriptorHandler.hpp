@@ -2,13 +2,17 @@
 #define MS_RTC_CODECS_PAYLOAD_DESCRIPTOR_HANDLER_HPP
 
 #include "common.hpp"
+#include "RTC/ObjectPool.hpp"
 
 namespace RTC
 {
+	class RtpPacket;
+
 	namespace Codecs
 	{
 		// Codec payload descriptor.
-		struct PayloadDescriptor
+		// NOTE: Allocated for every video packet so it uses the ObjectPool.
+		struct PayloadDescriptor : public RTC::ObjectPool::Allocated
 		{
 			virtual ~PayloadDescriptor() = default;
 			virtual void Dump() const    = 0;
@@ -87,7 +91,8 @@ namespace RTC
 			int16_t currentTemporalLayer{ -1 };
 		};
 
-		class PayloadDescriptorHandler
+		// NOTE: Allocated for every video packet so it uses the ObjectPool.
+		class PayloadDescriptorHandler : public RTC::ObjectPool::Allocated
 		{
 		public:
 			virtual ~PayloadDescriptorHandler() = default;
@@ -100,6 +105,12 @@ namespace RTC
 			virtual uint8_t GetTemporalLayer() const                                                 = 0;
 			virtual bool IsKeyFrame() const                                                          = 0;
 		};
+
+		// Payload processing functions used by a Consumer, picked for its codec
+		// when it's created (see RTC::Codecs::Tools).
+		using ProcessPayloadFn =
+		  bool (*)(RTC::RtpPacket* packet, RTC::Codecs::EncodingContext* encodingContext, bool& marker);
+		using RestorePayloadFn = void (*)(RTC::RtpPacket* packet);
 	} // namespace Codecs
 } // namespace RTC
 
@@ -2,8 +2,10 @@
 #define MS_RTC_CODECS_TOOLS_HPP
 
 #include "common.hpp"
+#include "RTC/Codecs/AV1.hpp"
 #include "RTC/Codecs/H264.hpp"
 #include "RTC/Codecs/H264_SVC.hpp"
+#include "RTC/Codecs/H265.hpp"
 #include "RTC/Codecs/PayloadDescriptorHandler.hpp"
 #include "RTC/Codecs/VP8.hpp"
 #include "RTC/Codecs/VP9.hpp"
@@ -31,6 +33,8 @@ namespace RTC
 							case RTC::RtpCodecMimeType::Subtype::VP9:
 							case RTC::RtpCodecMimeType::Subtype::H264:
 							case RTC::RtpCodecMimeType::Subtype::H264_SVC:
+							case RTC::RtpCodecMimeType::Subtype::H265:
+							case RTC::RtpCodecMimeType::Subtype::AV1:
 								return true;
 							default:
 								return false;
@@ -44,7 +48,12 @@ namespace RTC
 				}
 			}
 
-			static void ProcessRtpPacket(RTC::RtpPacket* packet, const RTC::RtpCodecMimeType& mimeType)
+			// NOTE: av1TemplateStructure is the per stream AV1 template dependency
+			// structure. AV1 packets lack layer info if not given.
+			static void ProcessRtpPacket(
+			  RTC::RtpPacket* packet,
+			  const RTC::RtpCodecMimeType& mimeType,
+			  RTC::Codecs::AV1::TemplateStructure* av1TemplateStructure = nullptr)
 			{
 				switch (mimeType.type)
 				{
@@ -79,6 +88,20 @@ namespace RTC
 								break;
 							}
 
+							case RTC::RtpCodecMimeType::Subtype::H265:
+							{
+								RTC::Codecs::H265::ProcessRtpPacket(packet);
+
+								break;
+							}
+
+							case RTC::RtpCodecMimeType::Subtype::AV1:
+							{
+								RTC::Codecs::AV1::ProcessRtpPacket(packet, av1TemplateStructure);
+
+								break;
+							}
+
 							default:;
 						}
 					}
@@ -111,6 +134,8 @@ namespace RTC
 								{
 									case RTC::RtpCodecMimeType::Subtype::VP8:
 									case RTC::RtpCodecMimeType::Subtype::H264:
+									case RTC::RtpCodecMimeType::Subtype::H265:
+									case RTC::RtpCodecMimeType::Subtype::AV1:
 										return true;
 									default:
 										return false;
@@ -134,6 +159,8 @@ namespace RTC
 								{
 									case RTC::RtpCodecMimeType::Subtype::VP9:
 									case RTC::RtpCodecMimeType::Subtype::H264_SVC:
+									case RTC::RtpCodecMimeType::Subtype::H265:
+									case RTC::RtpCodecMimeType::Subtype::AV1:
 										return true;
 									default:
 										return false;
@@ -159,6 +186,40 @@ namespace RTC
 				}
 			}
 
+			static ProcessPayloadFn GetProcessPayloadFn(const RTC::RtpCodecMimeType& mimeType)
+			{
+				switch (mimeType.subtype)
+				{
+					case RTC::RtpCodecMimeType::Subtype::VP8:
+						return RTC::Codecs::VP8::ProcessPayload;
+					case RTC::RtpCodecMimeType::Subtype::VP9:
+						return RTC::Codecs::VP9::ProcessPayload;
+					case RTC::RtpCodecMimeType::Subtype::H264:
+						return RTC::Codecs::H264::ProcessPayload;
+					case RTC::RtpCodecMimeType::Subtype::H265:
+						return RTC::Codecs::H265::ProcessPayload;
+					default:
+						return ProcessPayload;
+				}
+			}
+
+			static RestorePayloadFn GetRestorePayloadFn(const RTC::RtpCodecMimeType& mimeType)
+			{
+				switch (mimeType.subtype)
+				{
+					case RTC::RtpCodecMimeType::Subtype::VP8:
+						return RTC::Codecs::VP8::RestorePayload;
+					case RTC::RtpCodecMimeType::Subtype::VP9:
+						return RTC::Codecs::VP9::RestorePayload;
+					case RTC::RtpCodecMimeType::Subtype::H264:
+						return RTC::Codecs::H264::RestorePayload;
+					case RTC::RtpCodecMimeType::Subtype::H265:
+						return RTC::Codecs::H265::RestorePayload;
+					default:
+						return RestorePayload;
+				}
+			}
+
 			static EncodingContext* GetEncodingContext(
 			  const RTC::RtpCodecMimeType& mimeType, RTC::Codecs::EncodingContext::Params& params)
 			{
@@ -176,6 +237,10 @@ namespace RTC
 								return new RTC::Codecs::H264::EncodingContext(params);
 							case RTC::RtpCodecMimeType::Subtype::H264_SVC:
 								return new RTC::Codecs::H264_SVC::EncodingContext(params);
+							case RTC::RtpCodecMimeType::Subtype::H265:
+								return new RTC::Codecs::H265::EncodingContext(params);
+							case RTC::RtpCodecMimeType::Subtype::AV1:
+								return new RTC::Codecs::AV1::EncodingContext(params);
 							default:
 								return nullptr;
 						}
@@ -187,6 +252,18 @@ namespace RTC
 					}
 				}
 			}
+
+		private:
+			// Used for codecs with no specialised functions.
+			static bool ProcessPayload(
+			  RTC::RtpPacket* packet, RTC::Codecs::EncodingContext* encodingContext, bool& marker)
+			{
+				return packet->ProcessPayload(encodingContext, marker);
+			}
+			static void RestorePayload(RTC::RtpPacket* packet)
+			{
+				packet->RestorePayload();
+			}
 		};
 	} // namespace Codecs
 } // namespace RTC
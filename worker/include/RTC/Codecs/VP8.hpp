@@ -68,6 +68,10 @@ namespace RTC
 				bool hasTwoBytesPictureId{ false };
 				bool hasTl0PictureIndex{ false };
 				bool hasTlIndex{ false };
+				// Offsets of the rewritable fields in the payload, computed once so
+				// Encode() does not walk the descriptor again.
+				uint8_t pictureIdOffset{ 0u };
+				uint8_t tl0PictureIndexOffset{ 0u };
 			};
 
 		public:
@@ -77,9 +81,15 @@ namespace RTC
 			  RTC::RtpPacket::FrameMarking* frameMarking = nullptr,
 			  uint8_t frameMarkingLen                    = 0);
 			static void ProcessRtpPacket(RTC::RtpPacket* packet);
+			// Used by Consumers of this codec instead of RtpPacket::ProcessPayload()
+			// and RtpPacket::RestorePayload(), so calls to the handler are not
+			// virtual.
+			static bool ProcessPayload(
+			  RTC::RtpPacket* packet, RTC::Codecs::EncodingContext* encodingContext, bool& marker);
+			static void RestorePayload(RTC::RtpPacket* packet);
 
 		public:
-			class EncodingContext : public RTC::Codecs::EncodingContext
+			class EncodingContext final : public RTC::Codecs::EncodingContext
 			{
 			public:
 				explicit EncodingContext(RTC::Codecs::EncodingContext::Params& params)
@@ -102,7 +112,7 @@ namespace RTC
 			};
 
 		public:
-			class PayloadDescriptorHandler : public RTC::Codecs::PayloadDescriptorHandler
+			class PayloadDescriptorHandler final : public RTC::Codecs::PayloadDescriptorHandler
 			{
 			public:
 				explicit PayloadDescriptorHandler(PayloadDescriptor* payloadDescriptor);
@@ -130,6 +140,8 @@ namespace RTC
 
 			private:
 				std::unique_ptr<PayloadDescriptor> payloadDescriptor;
+				// Whether Process() rewrote the payload, so Restore() must undo it.
+				bool encoded{ false };
 			};
 		};
 	} // namespace Codecs
@@ -94,9 +94,15 @@ namespace RTC
 			  RTC::RtpPacket::FrameMarking* frameMarking = nullptr,
 			  uint8_t frameMarkingLen                    = 0);
 			static void ProcessRtpPacket(RTC::RtpPacket* packet);
+			// Used by Consumers of this codec instead of RtpPacket::ProcessPayload()
+			// and RtpPacket::RestorePayload(), so calls to the handler are not
+			// virtual.
+			static bool ProcessPayload(
+			  RTC::RtpPacket* packet, RTC::Codecs::EncodingContext* encodingContext, bool& marker);
+			static void RestorePayload(RTC::RtpPacket* packet);
 
 		public:
-			class EncodingContext : public RTC::Codecs::EncodingContext
+			class EncodingContext final : public RTC::Codecs::EncodingContext
 			{
 			public:
 				explicit EncodingContext(RTC::Codecs::EncodingContext::Params& params)
@@ -117,7 +123,7 @@ namespace RTC
 				bool syncRequired{ false };
 			};
 
-			class PayloadDescriptorHandler : public RTC::Codecs::PayloadDescriptorHandler
+			class PayloadDescriptorHandler final : public RTC::Codecs::PayloadDescriptorHandler
 			{
 			public:
 				explicit PayloadDescriptorHandler(PayloadDescriptor* payloadDescriptor);
@@ -2,7 +2,10 @@
 #define MS_RTC_CONSUMER_HPP
 
 #include "common.hpp"
+#include "OverloadController.hpp"
 #include "Channel/ChannelRequest.hpp"
+#include "RTC/ConsumerGroup.hpp"
+#include "RTC/ForwardingLatency.hpp"
 #include "RTC/RTCP/CompoundPacket.hpp"
 #include "RTC/RTCP/FeedbackPs.hpp"
 #include "RTC/RTCP/FeedbackPsFir.hpp"
@@ -14,7 +17,14 @@
 #include "RTC/RtpPacket.hpp"
 #include "RTC/RtpStream.hpp"
 #include "RTC/RtpStreamSend.hpp"
-#include <absl/container/flat_hash_set.h>
+#include "RTC/SeqManager.hpp"
+#include "RTC/StatsDelta.hpp"
+#include "RTC/TraceEventSampler.hpp"
+#include "RTC/TransportArena.hpp"
+#include <absl/container/inlined_vector.h>
+#include <algorithm> // std::min()
+#include <bitset>    // std::bitset
+#include <memory>    // std::shared_ptr
 #include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
@@ -23,7 +33,8 @@ using json = nlohmann::json;
 
 namespace RTC
 {
-	class Consumer
+	// NOTE: Long lived object of a Transport so it uses its TransportArena.
+	class Consumer : public RTC::TransportArena::Allocated
 	{
 	public:
 		class Listener
@@ -33,11 +44,17 @@ namespace RTC
 
 		public:
 			virtual void OnConsumerSendRtpPacket(RTC::Consumer* consumer, RTC::RtpPacket* packet) = 0;
-			virtual void OnConsumerRetransmitRtpPacket(RTC::Consumer* consumer, RTC::RtpPacket* packet) = 0;
+			// Packets requested by a NACK are given all together.
+			virtual void OnConsumerRetransmitRtpPackets(
+			  RTC::Consumer* consumer, RTC::RtpPacket** packets, size_t count) = 0;
 			virtual void OnConsumerKeyFrameRequested(RTC::Consumer* consumer, uint32_t mappedSsrc) = 0;
 			virtual void OnConsumerNeedBitrateChange(RTC::Consumer* consumer)                      = 0;
 			virtual void OnConsumerNeedZeroBitrate(RTC::Consumer* consumer)                        = 0;
 			virtual void OnConsumerProducerClosed(RTC::Consumer* consumer)                         = 0;
+			// Called when RTC::Consumer::IsActive() (just the Consumer and Producer
+			// paused and Transport connected states) may have changed.
+			virtual void OnConsumerActiveChanged(RTC::Consumer* consumer)          = 0;
+			virtual void OnConsumerPreferredLayersChanged(RTC::Consumer* consumer) = 0;
 		};
 
 	public:
@@ -57,6 +74,11 @@ namespace RTC
 			bool fir{ false };
 		};
 
+	public:
+		// Forgets the RTP parameters kept for Consumers of the given Producer
+		// (see rtpParametersKey in the consume request).
+		static void RemoveRtpParametersTemplates(const std::string& producerId);
+
 	public:
 		Consumer(
 		  const std::string& id,
@@ -69,7 +91,11 @@ namespace RTC
 	public:
 		virtual void FillJson(json& jsonObject) const;
 		virtual void FillJsonStats(json& jsonArray) const  = 0;
+		void FillStatsRecords(StatsRegion* statsRegion, const std::string& transportId, uint64_t nowMs);
 		virtual void FillJsonScore(json& jsonObject) const = 0;
+		// Send state of the streams sent to the remote so a Consumer created in
+		// another Router (with sendState) continues them.
+		virtual void FillJsonSendState(json& jsonObject) const = 0;
 		virtual void HandleRequest(Channel::ChannelRequest* request);
 		RTC::Media::Kind GetKind() const
 		{
@@ -94,11 +120,21 @@ namespace RTC
 
 			return layers;
 		}
-		const std::vector<uint32_t>& GetMediaSsrcs() const
+		// Key of the group of Consumers of the same Producer this one can share
+		// send state with (empty if it can't be grouped).
+		const std::string& GetGroupKey() const
+		{
+			return this->groupKey;
+		}
+		void SetGroup(std::shared_ptr<RTC::ConsumerGroup> group)
+		{
+			this->group = std::move(group);
+		}
+		const absl::InlinedVector<uint32_t, 4>& GetMediaSsrcs() const
 		{
 			return this->mediaSsrcs;
 		}
-		const std::vector<uint32_t>& GetRtxSsrcs() const
+		const absl::InlinedVector<uint32_t, 4>& GetRtxSsrcs() const
 		{
 			return this->rtxSsrcs;
 		}
@@ -111,6 +147,8 @@ namespace RTC
 				this->transportConnected &&
 				!this->paused &&
 				!this->producerPaused &&
+				!this->lastNPaused &&
+				!this->overloadPaused &&
 				!this->producerClosed
 			);
 			// clang-format on
@@ -121,12 +159,45 @@ namespace RTC
 		{
 			return this->paused;
 		}
+		// nullptr if the forwardingLatency setting is not enabled.
+		RTC::ForwardingLatency* GetForwardingLatency() const
+		{
+			return this->forwardingLatency;
+		}
+		// Called by the Transport when a RTP packet (not a retransmission) of this
+		// Consumer is sent.
+		void RtpPacketSent(const RTC::RtpPacket* packet)
+		{
+			// Just until the first key frame (or the first packet if audio) is sent.
+			// clang-format off
+			if (
+				this->firstKeyFrameSentAtMs == 0u &&
+				(this->firstRtpSentAtMs == 0u || packet->IsKeyFrame())
+			)
+			// clang-format on
+			{
+				RecordFirstRtpPacketSent(packet);
+			}
+		}
 		bool IsProducerPaused() const
 		{
 			return this->producerPaused;
 		}
 		void ProducerPaused();
 		void ProducerResumed();
+		void SetLastNPaused(bool lastNPaused);
+		// Pauses low priority video Consumers at the highest level. Consumers with
+		// layers must also limit them (see LimitSpatialLayer()).
+		virtual void SetOverloadLevel(OverloadController::Level level);
+		// Approximate memory (in bytes) used by the RTP streams.
+		size_t GetMemoryUsage();
+		// Fills the approximate memory used by this Consumer (with the shared
+		// parameters split among the Consumers using them) and returns the
+		// total (in bytes).
+		size_t FillJsonFootprint(json& jsonObject);
+		// Shrinks the retransmission buffers of the RTP streams while the Router
+		// is above its memory soft limit.
+		void SetMemoryPressure(bool memoryPressure);
 		virtual void ProducerRtpStream(RTC::RtpStream* rtpStream, uint32_t mappedSsrc)    = 0;
 		virtual void ProducerNewRtpStream(RTC::RtpStream* rtpStream, uint32_t mappedSsrc) = 0;
 		void ProducerRtpStreamScores(const std::vector<uint8_t>* scores);
@@ -138,12 +209,18 @@ namespace RTC
 		{
 			this->externallyManagedBitrate = true;
 		}
+		uint8_t GetPriority() const
+		{
+			return this->priority;
+		}
 		virtual uint8_t GetBitratePriority() const                          = 0;
 		virtual uint32_t IncreaseLayer(uint32_t bitrate, bool considerLoss) = 0;
 		virtual void ApplyLayers()                                          = 0;
 		virtual uint32_t GetDesiredBitrate() const                          = 0;
 		virtual void SendRtpPacket(RTC::RtpPacket* packet)                  = 0;
 		virtual std::vector<RTC::RtpStreamSend*> GetRtpStreams()            = 0;
+		// sizeof() the subclass.
+		virtual size_t GetObjectSize() const = 0;
 		virtual void GetRtcp(
 		  RTC::RTCP::CompoundPacket* packet, RTC::RtpStreamSend* rtpStream, uint64_t nowMs) = 0;
 		virtual void NeedWorstRemoteFractionLost(uint32_t mappedSsrc, uint8_t& worstRemoteFractionLost) = 0;
@@ -154,13 +231,53 @@ namespace RTC
 		virtual void ReceiveRtcpXrReceiverReferenceTime(RTC::RTCP::ReceiverReferenceTime* report) = 0;
 		virtual uint32_t GetTransmissionRate(uint64_t nowMs)                                      = 0;
 		virtual float GetRtt() const                                                              = 0;
+		// Sends the given packets of the most recent key frame of the producer
+		// stream if the Consumer is waiting for a key frame. Returns true if it's
+		// in sync after that.
+		virtual bool SendKeyFrameCache(const std::vector<RTC::RtpPacket*>& /*packets*/)
+		{
+			return false;
+		}
+		// Called instead of SendRtpPacket() for packets that are not forwarded on
+		// purpose, so the sequence number gap can be removed.
+		virtual void DropRtpPacket(RTC::RtpPacket* /*packet*/)
+		{
+		}
 
 	protected:
+		// Given layer limited by the overload level.
+		int16_t LimitSpatialLayer(int16_t spatialLayer) const
+		{
+			if (this->overloadMaxSpatialLayer == -1)
+				return spatialLayer;
+
+			return std::min(spatialLayer, this->overloadMaxSpatialLayer);
+		}
+		int16_t LimitTemporalLayer(int16_t temporalLayer) const
+		{
+			if (this->overloadMaxTemporalLayer == -1)
+				return temporalLayer;
+
+			return std::min(temporalLayer, this->overloadMaxTemporalLayer);
+		}
+		void EmitTraceEvent(json& data) const;
 		void EmitTraceEventRtpAndKeyFrameTypes(RTC::RtpPacket* packet, bool isRtx = false) const;
 		void EmitTraceEventKeyFrameType(RTC::RtpPacket* packet, bool isRtx = false) const;
 		void EmitTraceEventPliType(uint32_t ssrc) const;
 		void EmitTraceEventFirType(uint32_t ssrc) const;
 		void EmitTraceEventNackType() const;
+		// Send state shared by all Consumer types sending a single stream.
+		void FillJsonStreamSendState(
+		  json& jsonObject,
+		  const RTC::SeqManager<uint16_t>& rtpSeqManager,
+		  const RTC::RtpStreamSend* rtpStream) const;
+		// This may throw.
+		void ApplySendState(
+		  json& data, RTC::SeqManager<uint16_t>& rtpSeqManager, RTC::RtpStreamSend* rtpStream);
+
+	private:
+		void SetRtpParametersFromTemplate(const std::string& rtpParametersKey, json& data);
+		void RecordFirstRtpPacketSent(const RTC::RtpPacket* packet);
 
 	private:
 		virtual void UserOnTransportConnected()    = 0;
@@ -172,6 +289,8 @@ namespace RTC
 		// Passed by argument.
 		const std::string id;
 		const std::string producerId;
+		// Numeric handle given by the parent container (see RTC::HandleTable).
+		uint32_t handle{ 0u };
 
 	protected:
 		// Passed by argument.
@@ -179,25 +298,45 @@ namespace RTC
 		RTC::Media::Kind kind;
 		RTC::RtpParameters rtpParameters;
 		RTC::RtpParameters::Type type{ RTC::RtpParameters::Type::NONE };
-		std::vector<RTC::RtpEncodingParameters> consumableRtpEncodings;
+		// Shared by the Consumers of the same Producer.
+		std::shared_ptr<const std::vector<RTC::RtpEncodingParameters>> consumableRtpEncodings;
 		struct RTC::RtpHeaderExtensionIds rtpHeaderExtensionIds;
 		const std::vector<uint8_t>* producerRtpStreamScores{ nullptr };
+		// Allocated by this.
+		RTC::TraceEventSampler* traceEventSampler{ nullptr };
+		RTC::ForwardingLatency* forwardingLatency{ nullptr };
 		// Others.
-		absl::flat_hash_set<uint8_t> supportedCodecPayloadTypes;
+		// Indexed by payload type.
+		std::bitset<128> supportedCodecPayloadTypes;
 		uint64_t lastRtcpSentTime{ 0u };
 		uint16_t maxRtcpInterval{ 0u };
 		bool externallyManagedBitrate{ false };
 		uint8_t priority{ 1u };
 		struct TraceEventTypes traceEventTypes;
+		OverloadController::Level overloadLevel{ OverloadController::Level::NONE };
+		int16_t overloadMaxSpatialLayer{ -1 };
+		int16_t overloadMaxTemporalLayer{ -1 };
+		std::string groupKey;
+		std::shared_ptr<RTC::ConsumerGroup> group;
 
 	private:
 		// Others.
-		std::vector<uint32_t> mediaSsrcs;
-		std::vector<uint32_t> rtxSsrcs;
+		absl::InlinedVector<uint32_t, 4> mediaSsrcs;
+		absl::InlinedVector<uint32_t, 4> rtxSsrcs;
 		bool transportConnected{ false };
 		bool paused{ false };
 		bool producerPaused{ false };
+		// Paused by a video last N policy of the Router.
+		bool lastNPaused{ false };
+		// Paused by the OverloadController.
+		bool overloadPaused{ false };
 		bool producerClosed{ false };
+		RTC::StatsDelta statsDelta;
+		// Times (ms) at which the Consumer was created and sent its first RTP
+		// packet and key frame (0 if not yet).
+		uint64_t createdAtMs{ 0u };
+		uint64_t firstRtpSentAtMs{ 0u };
+		uint64_t firstKeyFrameSentAtMs{ 0u };
 	};
 } // namespace RTC
 
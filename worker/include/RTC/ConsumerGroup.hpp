@@ -0,0 +1,45 @@
+#ifndef MS_RTC_CONSUMER_GROUP_HPP
+#define MS_RTC_CONSUMER_GROUP_HPP
+
+#include "common.hpp"
+#include "RTC/SeqManager.hpp"
+#include <string>
+
+namespace RTC
+{
+	/**
+	 * Send state shared by the Consumers of a Producer with identical negotiated
+	 * parameters (see RTC::Consumer::GetGroupKey()), created by the Router.
+	 *
+	 * Members in sync take the same forward or drop decision for every packet,
+	 * so the RTP sequence number mapping (dropped packets included) is computed
+	 * once per packet for all of them, and each member just adds its own offset
+	 * so its stream stays continuous across pauses and re-syncs.
+	 */
+	class ConsumerGroup
+	{
+	public:
+		explicit ConsumerGroup(const std::string& key);
+
+	public:
+		const std::string& GetKey() const
+		{
+			return this->key;
+		}
+		void Drop(uint16_t input);
+		bool Input(uint16_t input, uint16_t& output);
+
+	private:
+		// Passed by argument.
+		std::string key;
+		// Others.
+		RTC::SeqManager<uint16_t> rtpSeqManager;
+		// Last input, so following members get its output without computing it.
+		bool hasLastInput{ false };
+		uint16_t lastInput{ 0u };
+		uint16_t lastOutput{ 0u };
+		bool lastInputResult{ false };
+	};
+} // namespace RTC
+
+#endif
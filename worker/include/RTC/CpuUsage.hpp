@@ -0,0 +1,67 @@
+#ifndef MS_RTC_CPU_USAGE_HPP
+#define MS_RTC_CPU_USAGE_HPP
+
+#include "common.hpp"
+#include "Metrics.hpp"
+#include "RTC/RateCalculator.hpp"
+
+namespace RTC
+{
+	/**
+	 * CPU time spent on behalf of an entity (i.e. a Transport), measured with
+	 * the cycle counter of Metrics within Scopes. Time is exclusive: a Scope
+	 * opened within another one pauses it, so the time spent sending a packet
+	 * through a Transport is not attributed to the Transport that received it.
+	 */
+	class CpuUsage
+	{
+	public:
+		class Scope
+		{
+		public:
+			explicit Scope(CpuUsage* usage)
+			  : usage(usage), parent(CpuUsage::currentScope), startedAt(Metrics::GetCycles())
+			{
+				if (this->parent)
+					this->parent->usage->Add(this->startedAt - this->parent->startedAt);
+
+				CpuUsage::currentScope = this;
+			}
+			~Scope()
+			{
+				auto now = Metrics::GetCycles();
+
+				this->usage->Add(now - this->startedAt);
+
+				CpuUsage::currentScope = this->parent;
+
+				if (this->parent)
+					this->parent->startedAt = now;
+			}
+
+		private:
+			CpuUsage* usage;
+			Scope* parent;
+			uint64_t startedAt;
+		};
+
+	public:
+		// CPU time (in ms) spent per second in the last second.
+		double GetMsPerSecond(uint64_t nowMs);
+
+	private:
+		void Add(uint64_t cycles)
+		{
+			this->cycles.Update(cycles, DepLibUV::GetTimeMs());
+		}
+
+	private:
+		thread_local static Scope* currentScope;
+
+	private:
+		// Cycles per ms in the last second.
+		RTC::RateCalculator cycles{ 1000u, 1.0f };
+	};
+} // namespace RTC
+
+#endif
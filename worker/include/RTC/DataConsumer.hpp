@@ -6,7 +6,9 @@
 #include "PayloadChannel/PayloadChannelRequest.hpp"
 #include "RTC/SctpDictionaries.hpp"
 #include <nlohmann/json.hpp>
+#include <deque>
 #include <string>
+#include <vector>
 
 namespace RTC
 {
@@ -38,6 +40,25 @@ namespace RTC
 			DIRECT
 		};
 
+	public:
+		// What to do with a message when the queue of messages waiting for room in
+		// the SCTP send buffer is full.
+		enum class QueueDropPolicy : uint8_t
+		{
+			DROP_OLDEST = 0,
+			DROP_NEWEST,
+			// A message replaces the queued one with same key (its first
+			// coalesceKeyLength bytes). Otherwise the oldest one is dropped.
+			COALESCE
+		};
+
+	private:
+		struct QueuedMessage
+		{
+			uint32_t ppid;
+			std::vector<uint8_t> msg;
+		};
+
 	public:
 		DataConsumer(
 		  const std::string& id,
@@ -77,6 +98,17 @@ namespace RTC
 		void SctpAssociationBufferedAmount(uint32_t bufferedAmount);
 		void DataProducerClosed();
 		void SendMessage(uint32_t ppid, const uint8_t* msg, size_t len, onQueuedCallback* = nullptr);
+		// Called when the SctpAssociation could not send a message of this
+		// DataConsumer because the SCTP send buffer is full. Returns true if the
+		// message was taken by the queue (to be sent again once there is room in
+		// the SCTP send buffer, or dropped by the QueueDropPolicy).
+		bool SctpSendBufferFull(uint32_t ppid, const uint8_t* msg, size_t len);
+
+	private:
+		bool QueueMessage(uint32_t ppid, const uint8_t* msg, size_t len);
+		void SendQueuedMessages(size_t maxBytes);
+		void ClearQueuedMessages();
+		bool HasSameKey(const QueuedMessage& queuedMessage, const uint8_t* msg, size_t len) const;
 
 	public:
 		// Passed by argument.
@@ -101,6 +133,18 @@ namespace RTC
 		uint32_t bufferedAmount{ 0u };
 		uint32_t bufferedAmountLowThreshold{ 0u };
 		bool forceTriggerBufferedAmountLow{ false };
+		// Queue of messages waiting for room in the SCTP send buffer (0 means no
+		// queue).
+		uint32_t maxQueuedMessages{ 0u };
+		QueueDropPolicy queueDropPolicy{ QueueDropPolicy::DROP_OLDEST };
+		size_t coalesceKeyLength{ 0u };
+		// Oldest first.
+		std::deque<QueuedMessage> queuedMessages;
+		// Messages given back by the SctpAssociation since the last retry. They
+		// are older than the rest so they go first.
+		size_t numRequeuedMessages{ 0u };
+		bool sendingQueuedMessages{ false };
+		size_t messagesDropped{ 0u };
 	};
 } // namespace RTC
 
@@ -1,12 +1,28 @@
 #ifndef MS_RTC_DIRECT_TRANSPORT_HPP
 #define MS_RTC_DIRECT_TRANSPORT_HPP
 
+#include "RTC/RtpRecorder.hpp"
 #include "RTC/Transport.hpp"
+#include <string>
+#include <vector>
 
 namespace RTC
 {
 	class DirectTransport : public RTC::Transport
 	{
+	public:
+		// While a message multicast is open, the messages sent to DataConsumers of
+		// DirectTransports are not emitted but collected, and the multicast end
+		// emits a single notification with the ids of all those DataConsumers so
+		// the message payload is sent once.
+		static void StartMessageMulticast();
+		static void EndMessageMulticast(
+		  const std::string& dataProducerId, uint32_t ppid, const uint8_t* msg, size_t len);
+
+	private:
+		thread_local static bool messageMulticast;
+		thread_local static std::vector<const std::string*> multicastDataConsumerIds;
+
 	public:
 		DirectTransport(const std::string& id, RTC::Transport::Listener* listener, json& data);
 		~DirectTransport() override;
@@ -38,6 +54,9 @@ namespace RTC
 	private:
 		// Allocated by this.
 		uint8_t* buffer{ nullptr };
+		// Given if packets sent by this are recorded into a file (recordPath
+		// option) instead of being sent to Node.
+		RTC::RtpRecorder* rtpRecorder{ nullptr };
 	};
 } // namespace RTC
 
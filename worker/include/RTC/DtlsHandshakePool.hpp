@@ -0,0 +1,115 @@
+#ifndef MS_RTC_DTLS_HANDSHAKE_POOL_HPP
+#define MS_RTC_DTLS_HANDSHAKE_POOL_HPP
+
+#include "common.hpp"
+#include <openssl/bio.h>
+#include <openssl/ssl.h>
+#include <uv.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace RTC
+{
+	/**
+	 * Per worker pool of threads that run the expensive steps of DTLS handshakes
+	 * (ECDHE, certificate signature and verification) out of the event loop
+	 * thread (disabled unless the dtlsHandshakeThreads setting is set), so a
+	 * burst of joining peers does not stall media forwarding.
+	 *
+	 * A job feeds a received DTLS datagram into the SSL instance and calls
+	 * SSL_read() in a pool thread. Once done, the result is handed to its
+	 * listener in the event loop thread. The caller must not touch the SSL
+	 * instance until then, so it must not submit a new job for it meanwhile.
+	 */
+	class DtlsHandshakePool
+	{
+	public:
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			// sslError is the SSL_get_error() value for the SSL_read() return
+			// value, and opensslErrors are the ones in the OpenSSL error queue of the
+			// pool thread (which is per thread). elapsedNs is the time spent in
+			// SSL_read().
+			virtual void OnDtlsHandshakePoolDataProcessed(
+			  int read,
+			  int sslError,
+			  const std::vector<unsigned long>& opensslErrors,
+			  const uint8_t* data,
+			  size_t len,
+			  uint64_t elapsedNs) = 0;
+		};
+
+	public:
+		// Max number of threads.
+		static constexpr size_t MaxThreads{ 16u };
+
+	private:
+		struct Job
+		{
+			Listener* listener;
+			SSL* ssl;
+			BIO* sslBioFromNetwork;
+			// Received DTLS data, replaced by read application data (if any).
+			std::vector<uint8_t> data;
+			int read;
+			int sslError;
+			std::vector<unsigned long> opensslErrors;
+			uint64_t elapsedNs;
+		};
+
+		// State shared with the pool threads.
+		struct Shared
+		{
+			std::mutex mutex;
+			// Signaled when jobs are submitted or the pool is stopped.
+			std::condition_variable submittedCv;
+			// Signaled when a pool thread is done with a job.
+			std::condition_variable doneCv;
+			std::deque<Job*> pendingJobs;
+			// Job being processed by each pool thread.
+			std::vector<Job*> runningJobs;
+			std::deque<Job*> doneJobs;
+			bool stopping{ false };
+			uv_async_t* uvAsyncHandle{ nullptr };
+		};
+
+	public:
+		static void ClassInit(size_t numThreads);
+		static void ClassDestroy();
+		static bool IsEnabled()
+		{
+			return DtlsHandshakePool::shared != nullptr;
+		}
+		static bool IsPoolThread()
+		{
+			return DtlsHandshakePool::isPoolThread;
+		}
+		static void ProcessDtlsData(
+		  Listener* listener, SSL* ssl, BIO* sslBioFromNetwork, const uint8_t* data, size_t len);
+		// Discards pending jobs of the listener and waits until none of them is
+		// being processed. Must be called before deleting the listener or
+		// modifying its SSL instance.
+		static void RemoveListener(Listener* listener);
+
+		/* Callbacks fired by UV events. */
+	public:
+		static void OnUvAsync();
+
+	private:
+		static void ThreadMain(Shared* shared, size_t threadIdx);
+
+	private:
+		thread_local static Shared* shared;
+		thread_local static std::vector<std::thread> threads;
+		thread_local static bool isPoolThread;
+	};
+} // namespace RTC
+
+#endif
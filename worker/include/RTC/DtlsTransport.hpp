@@ -2,18 +2,29 @@
 #define MS_RTC_DTLS_TRANSPORT_HPP
 
 #include "common.hpp"
+#include "Metrics.hpp"
+#include "RTC/DtlsHandshakePool.hpp"
 #include "RTC/SrtpSession.hpp"
+#include "RTC/TransportArena.hpp"
 #include "handles/Timer.hpp"
 #include <openssl/bio.h>
 #include <openssl/ssl.h>
 #include <openssl/x509.h>
 #include <absl/container/flat_hash_map.h>
+#include <nlohmann/json.hpp>
+#include <deque>
+#include <mutex>
 #include <string>
 #include <vector>
 
+using json = nlohmann::json;
+
 namespace RTC
 {
-	class DtlsTransport : public Timer::Listener
+	// NOTE: Long lived object of a Transport so it uses its TransportArena.
+	class DtlsTransport : public RTC::TransportArena::Allocated,
+	                      public Timer::Listener,
+	                      public RTC::DtlsHandshakePool::Listener
 	{
 	public:
 		enum class DtlsState
@@ -134,10 +145,61 @@ namespace RTC
 		}
 
 	private:
-		static void GenerateCertificateAndPrivateKey();
+		// Certificate and fingerprints shared by workers running in the same
+		// process (not read from PEM files).
+		struct SharedCertificate
+		{
+			X509* certificate{ nullptr };
+			EVP_PKEY* privateKey{ nullptr };
+			std::vector<Fingerprint> fingerprints;
+		};
+
+	private:
+		struct SessionTicketKey
+		{
+			uint8_t name[16];
+			uint8_t aesKey[32];
+			uint8_t hmacKey[32];
+		};
+
+	private:
+		// Keys of the DTLS session tickets issued by the worker. Tickets of the
+		// previous key are accepted (and renewed) until the next rotation. Used
+		// by DTLS handshake pool threads too.
+		struct SessionTickets
+		{
+			std::mutex mutex;
+			SessionTicketKey currentKey;
+			SessionTicketKey previousKey;
+			bool hasPreviousKey{ false };
+			uint64_t rotatedAtNs{ 0u };
+		};
+
+	public:
+		// Rotation interval of the session ticket keys (in seconds).
+		static constexpr uint64_t SessionTicketKeyRotationInterval{ 3600u };
+
+	public:
+		// Called by OpenSSL to encrypt (enc is 1) or decrypt a session ticket.
+		static int ProcessSessionTicketKey(
+		  SSL* ssl,
+		  unsigned char* keyName,
+		  unsigned char* iv,
+		  EVP_CIPHER_CTX* cipherCtx,
+		  EVP_MAC_CTX* macCtx,
+		  int enc);
+		static void FillJsonHandshakes(json& jsonObject);
+
+	private:
+		static void GenerateCertificateAndPrivateKey(long validity);
 		static void ReadCertificateAndPrivateKeyFromFiles();
+		static void ReadOrGenerateCachedCertificateAndPrivateKey(const std::string& cacheDir);
+		static void WriteCachedCertificateAndPrivateKey(const std::string& cachePath);
+		static bool IsCertificateExpiring(X509* certificate);
 		static void CreateSslCtx();
 		static void GenerateFingerprints();
+		static void GenerateSessionTicketKey(SessionTicketKey& key);
+		static void CheckEcdsaOnlyPrivateKey();
 
 	private:
 		thread_local static X509* certificate;
@@ -149,6 +211,17 @@ namespace RTC
 		static absl::flat_hash_map<FingerprintAlgorithm, std::string> fingerprintAlgorithm2String;
 		thread_local static std::vector<Fingerprint> localFingerprints;
 		static std::vector<SrtpCryptoSuiteMapEntry> srtpCryptoSuites;
+		// Indexed by certificate cache directory (empty if none).
+		static std::mutex sharedCertificatesMutex;
+		static absl::flat_hash_map<std::string, SharedCertificate> sharedCertificates;
+		thread_local static SessionTickets* sessionTickets;
+		thread_local static uint64_t fullHandshakes;
+		thread_local static uint64_t resumedHandshakes;
+		// Handshakes (full or resumed) that negotiated DTLS 1.3.
+		thread_local static uint64_t dtls13Handshakes;
+		// CPU time of each full and resumed handshake (in ns).
+		thread_local static Metrics::Histogram* fullHandshakeCpuTimes;
+		thread_local static Metrics::Histogram* resumedHandshakeCpuTimes;
 
 	public:
 		explicit DtlsTransport(Listener* listener);
@@ -193,6 +266,9 @@ namespace RTC
 		}
 		void Reset();
 		bool CheckStatus(int returnCode);
+		bool CheckSslError(int err);
+		void ProcessSslRead(int read, int sslError, const uint8_t* data);
+		void ProcessPendingDtlsData();
 		void SendPendingOutgoingDtlsData();
 		bool SetTimeout();
 		bool ProcessHandshake();
@@ -208,6 +284,16 @@ namespace RTC
 	public:
 		void OnTimer(Timer* timer) override;
 
+		/* Pure virtual methods inherited from RTC::DtlsHandshakePool::Listener. */
+	public:
+		void OnDtlsHandshakePoolDataProcessed(
+		  int read,
+		  int sslError,
+		  const std::vector<unsigned long>& opensslErrors,
+		  const uint8_t* data,
+		  size_t len,
+		  uint64_t elapsedNs) override;
+
 	private:
 		// Passed by argument.
 		Listener* listener{ nullptr };
@@ -223,6 +309,12 @@ namespace RTC
 		bool handshakeDone{ false };
 		bool handshakeDoneNow{ false };
 		std::string remoteCert;
+		// Whether the DTLS handshake pool is processing data of this->ssl.
+		bool handshakeJobInFlight{ false };
+		// DTLS data received meanwhile.
+		std::deque<std::vector<uint8_t>> pendingDtlsData;
+		// Time spent by OpenSSL processing the current handshake (in ns).
+		uint64_t handshakeCpuTimeNs{ 0u };
 	};
 } // namespace RTC
 
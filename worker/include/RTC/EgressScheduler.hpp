@@ -0,0 +1,108 @@
+#ifndef MS_RTC_EGRESS_SCHEDULER_HPP
+#define MS_RTC_EGRESS_SCHEDULER_HPP
+
+#include "common.hpp"
+#include "Settings.hpp"
+#include "RTC/Consumer.hpp"
+#include "RTC/RtpPacket.hpp"
+#include "handles/Timer.hpp"
+#include <deque>
+#include <memory> // std::unique_ptr
+#include <vector>
+
+namespace RTC
+{
+	/**
+	 * Per thread (so per worker) smoothing of the video sent by all the
+	 * Transports, so a burst fanned out to many Consumers (i.e. a key frame)
+	 * does not leave the NIC within a few ms. A budget shared by all the
+	 * Transports grows at the egressBitrate setting and holds up to
+	 * egressBurstMs of it.
+	 *
+	 * Transports with a Pacer (those using transport-cc) also check this budget
+	 * so their Pacer queues absorb the burst. Transports without it queue here
+	 * the packets that exceed the budget and they are sent as it grows.
+	 */
+	class EgressScheduler
+	{
+	public:
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			// queuedAtNs is the time (ns) at which the packet was queued, just given
+			// if the packet has ingress time (0 otherwise).
+			virtual void OnEgressSchedulerSendRtpPacket(
+			  RTC::Consumer* consumer,
+			  RTC::RtpPacket* packet,
+			  bool retransmission,
+			  uint64_t queuedAtNs) = 0;
+		};
+
+	private:
+		class TimerListener : public Timer::Listener
+		{
+			/* Pure virtual methods inherited from Timer::Listener. */
+		public:
+			void OnTimer(Timer* timer) override;
+		};
+
+		struct QueuedPacket
+		{
+			Listener* listener{ nullptr };
+			RTC::Consumer* consumer{ nullptr };
+			RTC::RtpPacket* packet{ nullptr };
+			std::unique_ptr<uint8_t[]> buffer;
+			bool retransmission{ false };
+			uint64_t queuedAtMs{ 0u };
+			uint64_t queuedAtNs{ 0u };
+		};
+
+	public:
+		// Max size of a queued packet.
+		static constexpr size_t MaxPacketSize{ RTC::MtuSize + 100 };
+
+	public:
+		static void ClassDestroy();
+		static bool IsEnabled()
+		{
+			return Settings::configuration.egressBitrate != 0u;
+		}
+		// Whether size bytes can be sent now. If so they are taken from the
+		// budget.
+		static bool TryConsume(size_t size, uint64_t nowMs);
+		// Takes from the budget size bytes sent regardless of it.
+		static void Consume(size_t size, uint64_t nowMs);
+		// Returns false if the packet must be sent right away. Otherwise the
+		// packet has been cloned and it will be given to the listener later.
+		static bool QueuePacket(
+		  Listener* listener, RTC::Consumer* consumer, RTC::RtpPacket* packet, bool retransmission);
+		// Drops the queued packets of the given Consumer.
+		static void RemoveConsumer(const RTC::Consumer* consumer);
+		// Drops the queued packets of the given listener.
+		static void RemoveListener(const Listener* listener);
+		static size_t GetQueueSize()
+		{
+			return EgressScheduler::queue.size();
+		}
+
+	private:
+		static void UpdateBudget(uint64_t nowMs);
+		static void ReleasePacket(QueuedPacket& queuedPacket);
+		static void OnTimer();
+
+	private:
+		thread_local static TimerListener timerListener;
+		thread_local static Timer* drainTimer;
+		thread_local static std::deque<QueuedPacket> queue;
+		// Memory of queued packets (reused).
+		thread_local static std::vector<std::unique_ptr<uint8_t[]>> buffers;
+		// Bytes that can be sent now (negative if too many bytes were sent).
+		thread_local static int64_t budget;
+		thread_local static uint64_t lastBudgetUpdateAtMs;
+	};
+} // namespace RTC
+
+#endif
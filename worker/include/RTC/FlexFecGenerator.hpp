@@ -0,0 +1,96 @@
+#ifndef MS_RTC_FLEX_FEC_GENERATOR_HPP
+#define MS_RTC_FLEX_FEC_GENERATOR_HPP
+
+#include "common.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <memory> // std::unique_ptr
+
+/* FlexFEC header (draft-ietf-payload-flexible-fec-scheme-03, as implemented
+ * by libwebrtc) with a single protected SSRC and a 15 bit mask:
+ *
+ *  0                   1                   2                   3
+ *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |R|F|P|X|  CC   |M| PT recovery |        length recovery        |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                          TS recovery                          |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |   SSRCCount   |                    reserved                   |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                             SSRC                              |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |            SN base            |k|          Mask [0-14]        |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ */
+
+namespace RTC
+{
+	/**
+	 * Generates FlexFEC packets for the media packets sent in a stream. Each FEC
+	 * packet is the XOR of a group of consecutive media packets, so the remote
+	 * endpoint can recover any single lost packet of the group without waiting
+	 * for a retransmission. The group size depends on the fraction of packets
+	 * lost reported by the remote endpoint (no FEC is generated if there is no
+	 * loss).
+	 *
+	 * The XOR is computed incrementally when a media packet is added, so media
+	 * packets are not kept.
+	 */
+	class FlexFecGenerator
+	{
+	public:
+		static constexpr size_t HeaderSize{ 20u };
+		// Max number of media packets protected by a FEC packet.
+		static constexpr size_t MaxProtectedPackets{ 15u };
+
+	public:
+		FlexFecGenerator(uint8_t payloadType, uint32_t ssrc, uint32_t protectedSsrc);
+
+	public:
+		uint8_t GetPayloadType() const
+		{
+			return this->payloadType;
+		}
+		uint32_t GetSsrc() const
+		{
+			return this->ssrc;
+		}
+		// Number of media packets protected by each FEC packet (0 if disabled).
+		size_t GetGroupSize() const
+		{
+			return this->groupSize;
+		}
+		void SetFractionLost(uint8_t fractionLost);
+		// Returns a FEC packet if the given packet completes a group of protected
+		// packets. It's valid until the next call.
+		RTC::RtpPacket* AddPacket(const RTC::RtpPacket* packet);
+
+	private:
+		void ResetGroup();
+		RTC::RtpPacket* CreateFecPacket(uint32_t timestamp);
+
+	private:
+		// Passed by argument.
+		uint8_t payloadType{ 0u };
+		uint32_t ssrc{ 0u };
+		uint32_t protectedSsrc{ 0u };
+		// Others.
+		uint16_t seq{ 0u };
+		size_t groupSize{ 0u };
+		// Current group of protected packets.
+		size_t packetCount{ 0u };
+		uint16_t baseSeq{ 0u };
+		uint16_t mask{ 0u };
+		// XOR of the first 8 bytes of the RTP header of the protected packets with
+		// the length after the fixed header in place of the sequence number.
+		uint8_t headerRecovery[8]{};
+		// XOR of the protected packets after the fixed header.
+		uint8_t payloadRecovery[RTC::MtuSize]{};
+		size_t payloadRecoveryLength{ 0u };
+		// Memory of the generated FEC packet.
+		uint8_t buffer[RTC::MtuSize + 100]{};
+		std::unique_ptr<RTC::RtpPacket> fecPacket;
+	};
+} // namespace RTC
+
+#endif
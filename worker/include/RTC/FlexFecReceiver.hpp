@@ -0,0 +1,86 @@
+#ifndef MS_RTC_FLEX_FEC_RECEIVER_HPP
+#define MS_RTC_FLEX_FEC_RECEIVER_HPP
+
+#include "common.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <memory> // std::unique_ptr
+#include <vector>
+
+namespace RTC
+{
+	/**
+	 * Recovers the media packets lost in a received stream protected with
+	 * FlexFEC (the format described in RTC::FlexFecGenerator, with any of the
+	 * three mask sizes of libwebrtc). A copy of the last received media packets
+	 * is kept, and a lost packet is recovered when a FEC packet protecting it
+	 * arrives and every other packet protected by it is present.
+	 *
+	 * Recovered packets are kept as if they had been received, so a late
+	 * retransmission (or the original packet, if it was just reordered) is
+	 * recognized as a duplicate.
+	 */
+	class FlexFecReceiver
+	{
+	public:
+		// Number of last media packets kept.
+		static constexpr size_t BufferSize{ 64u };
+		// Max number of media packets protected by a FEC packet (the longest mask).
+		static constexpr size_t MaxProtectedPackets{ 109u };
+
+	private:
+		struct StoredPacket
+		{
+			std::vector<uint8_t> data;
+			uint16_t seq{ 0u };
+		};
+
+	public:
+		FlexFecReceiver(uint8_t payloadType, uint32_t ssrc, uint32_t protectedSsrc);
+
+	public:
+		uint8_t GetPayloadType() const
+		{
+			return this->payloadType;
+		}
+		uint32_t GetSsrc() const
+		{
+			return this->ssrc;
+		}
+		size_t GetRecoveredPackets() const
+		{
+			return this->recoveredPackets;
+		}
+		// Whether the given packet is the last one recovered.
+		bool IsRecoveredPacket(const RTC::RtpPacket* packet) const
+		{
+			return packet == this->recoveredPacket.get();
+		}
+		// Keeps a copy of the given media packet. Returns false if a packet with
+		// the same sequence number was already received or recovered.
+		bool AddPacket(const RTC::RtpPacket* packet);
+		// Returns the media packet recovered with the given FEC packet (if any).
+		// It's valid until the next call.
+		RTC::RtpPacket* ReceiveFecPacket(const RTC::RtpPacket* packet);
+
+	private:
+		StoredPacket* GetStoredPacket(uint16_t seq);
+		void StorePacket(const uint8_t* data, size_t len, uint16_t seq);
+
+	private:
+		// Passed by argument.
+		uint8_t payloadType{ 0u };
+		uint32_t ssrc{ 0u };
+		uint32_t protectedSsrc{ 0u };
+		// Allocated by this.
+		std::vector<StoredPacket> storage;
+		// Others.
+		bool started{ false };
+		uint16_t highestSeq{ 0u };
+		size_t recoveredPackets{ 0u };
+		// Memory of the recovered packet.
+		uint8_t buffer[RTC::MtuSize + 100]{};
+		std::unique_ptr<RTC::RtpPacket> recoveredPacket;
+	};
+} // namespace RTC
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef MS_RTC_FORWARDING_LATENCY_HPP
+#define MS_RTC_FORWARDING_LATENCY_HPP
+
+#include "common.hpp"
+#include "Metrics.hpp"
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace RTC
+{
+	/**
+	 * Histograms of the time (ns) RTP packets spend in the worker since they are
+	 * read from the socket (forwardingLatency setting):
+	 *
+	 * - routing: until they reach the sending Transport (parsing, Producer,
+	 *   Router and Consumer).
+	 * - pacing: time queued in the Pacer (0 if not queued).
+	 * - send: until they are handed to the socket (SRTP included).
+	 * - total: sum of them.
+	 *
+	 * Time in the UDP egress queue is measured per worker (sendQueueDelay in
+	 * the resource usage) since sockets may be shared by many Transports.
+	 */
+	class ForwardingLatency
+	{
+	public:
+		// routedAtNs is the time at which the packet reached the sending Transport
+		// and sendingAtNs the time at which it left the Pacer (the same if it was
+		// not paced).
+		void Record(uint64_t ingressTimeNs, uint64_t routedAtNs, uint64_t sendingAtNs, uint64_t sentAtNs);
+		void FillJson(json& jsonObject) const;
+
+	private:
+		Metrics::Histogram routing;
+		Metrics::Histogram pacing;
+		Metrics::Histogram send;
+		Metrics::Histogram total;
+	};
+} // namespace RTC
+
+#endif
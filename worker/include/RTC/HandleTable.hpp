@@ -0,0 +1,103 @@
+#ifndef MS_RTC_HANDLE_TABLE_HPP
+#define MS_RTC_HANDLE_TABLE_HPP
+
+#include "common.hpp"
+#include <vector>
+
+namespace RTC
+{
+	/**
+	 * Compact numeric handles of the objects of a container (Routers of the
+	 * Worker, Transports of a Router, Producers and Consumers of a Transport)
+	 * given at creation, so requests can address objects with an array lookup
+	 * instead of a string id one.
+	 *
+	 * A handle holds the slot index (low IndexBits) and the generation of the
+	 * slot (high bits), so the handle of a closed object does not address the
+	 * object later stored in the same slot. Handle 0 is never given.
+	 */
+	template<typename T>
+	class HandleTable
+	{
+	public:
+		static constexpr uint32_t IndexBits{ 20u };
+		static constexpr uint32_t IndexMask{ (1u << IndexBits) - 1u };
+		static constexpr uint32_t MaxGeneration{ (1u << (32u - IndexBits)) - 1u };
+
+	private:
+		struct Slot
+		{
+			T* object{ nullptr };
+			uint32_t generation{ 1u };
+		};
+
+	public:
+		// Returns 0 if there are no free slots.
+		uint32_t Add(T* object)
+		{
+			uint32_t idx;
+
+			if (!this->freeSlots.empty())
+			{
+				idx = this->freeSlots.back();
+
+				this->freeSlots.pop_back();
+			}
+			else if (this->slots.size() <= IndexMask)
+			{
+				idx = static_cast<uint32_t>(this->slots.size());
+
+				this->slots.emplace_back();
+			}
+			else
+			{
+				return 0u;
+			}
+
+			auto& slot = this->slots[idx];
+
+			slot.object = object;
+
+			return (slot.generation << IndexBits) | idx;
+		}
+		void Remove(uint32_t handle)
+		{
+			if (!Get(handle))
+				return;
+
+			const uint32_t idx = handle & IndexMask;
+			auto& slot         = this->slots[idx];
+
+			slot.object     = nullptr;
+			slot.generation = slot.generation == MaxGeneration ? 1u : slot.generation + 1u;
+
+			this->freeSlots.push_back(idx);
+		}
+		// Returns nullptr if the handle is not valid (or its object was removed).
+		T* Get(uint32_t handle) const
+		{
+			const uint32_t idx = handle & IndexMask;
+
+			if (idx >= this->slots.size())
+				return nullptr;
+
+			const auto& slot = this->slots[idx];
+
+			if (slot.generation != (handle >> IndexBits))
+				return nullptr;
+
+			return slot.object;
+		}
+		void Clear()
+		{
+			this->slots.clear();
+			this->freeSlots.clear();
+		}
+
+	private:
+		std::vector<Slot> slots;
+		std::vector<uint32_t> freeSlots;
+	};
+} // namespace RTC
+
+#endif
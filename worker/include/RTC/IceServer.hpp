@@ -3,13 +3,17 @@
 
 #include "common.hpp"
 #include "RTC/StunPacket.hpp"
+#include "RTC/TransportArena.hpp"
 #include "RTC/TransportTuple.hpp"
-#include <list>
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/inlined_vector.h>
+#include <memory> // std::unique_ptr
 #include <string>
 
 namespace RTC
 {
-	class IceServer
+	// NOTE: Long lived object of a Transport so it uses its TransportArena.
+	class IceServer : public RTC::TransportArena::Allocated
 	{
 	public:
 		enum class IceState
@@ -33,6 +37,14 @@ namespace RTC
 			 */
 			virtual void OnIceServerSendStunPacket(
 			  const RTC::IceServer* iceServer, const RTC::StunPacket* packet, RTC::TransportTuple* tuple) = 0;
+			virtual void OnIceServerLocalUsernameFragmentAdded(
+			  const RTC::IceServer* iceServer, const std::string& usernameFragment) = 0;
+			virtual void OnIceServerLocalUsernameFragmentRemoved(
+			  const RTC::IceServer* iceServer, const std::string& usernameFragment) = 0;
+			virtual void OnIceServerTupleAdded(
+			  const RTC::IceServer* iceServer, RTC::TransportTuple* tuple) = 0;
+			virtual void OnIceServerTupleRemoved(
+			  const RTC::IceServer* iceServer, RTC::TransportTuple* tuple) = 0;
 			virtual void OnIceServerSelectedTuple(
 			  const RTC::IceServer* iceServer, RTC::TransportTuple* tuple)        = 0;
 			virtual void OnIceServerConnected(const RTC::IceServer* iceServer)    = 0;
@@ -42,6 +54,7 @@ namespace RTC
 
 	public:
 		IceServer(Listener* listener, const std::string& usernameFragment, const std::string& password);
+		~IceServer();
 
 	public:
 		void ProcessStunPacket(RTC::StunPacket* packet, RTC::TransportTuple* tuple);
@@ -61,16 +74,11 @@ namespace RTC
 		{
 			return this->selectedTuple;
 		}
-		void RestartIce(const std::string& usernameFragment, const std::string& password)
+		size_t GetTupleCount() const
 		{
-			this->oldUsernameFragment = this->usernameFragment;
-			this->usernameFragment    = usernameFragment;
-
-			this->oldPassword = this->password;
-			this->password    = password;
-
-			this->remoteNomination = 0u;
+			return this->tuples.size();
 		}
+		void RestartIce(const std::string& usernameFragment, const std::string& password);
 		bool IsValidTuple(const RTC::TransportTuple* tuple) const;
 		void RemoveTuple(RTC::TransportTuple* tuple);
 		// This should be just called in 'connected' or completed' state
@@ -93,6 +101,27 @@ namespace RTC
 		 * NOTE: The given tuple MUST be already stored within the list.
 		 */
 		void SetSelectedTuple(RTC::TransportTuple* storedTuple);
+		/**
+		 * Index the given stored tuple by its key (if not already taken by
+		 * another tuple).
+		 */
+		void IndexTuple(RTC::TransportTuple* storedTuple);
+
+	private:
+		// Binding success response of a stored tuple, serialized once and then
+		// reused for its consent freshness checks.
+		struct CachedStunResponse
+		{
+			// Header, XOR-MAPPED-ADDRESS (IPv6), MESSAGE-INTEGRITY and FINGERPRINT.
+			static constexpr size_t MaxSize{ 20u + 24u + 24u + 8u };
+
+			std::unique_ptr<RTC::StunPacket> packet;
+			uint8_t buffer[MaxSize];
+		};
+
+	private:
+		void SendSuccessResponse(
+		  RTC::StunPacket* request, RTC::TransportTuple* tuple, Utils::Crypto::HmacSha1& hmacSha1);
 
 	private:
 		// Passed by argument.
@@ -102,9 +131,20 @@ namespace RTC
 		std::string password;
 		std::string oldUsernameFragment;
 		std::string oldPassword;
+		// HMAC-SHA1 keyed with password and oldPassword (if any) for the
+		// MESSAGE-INTEGRITY of STUN messages.
+		std::unique_ptr<Utils::Crypto::HmacSha1> hmacSha1;
+		std::unique_ptr<Utils::Crypto::HmacSha1> oldHmacSha1;
 		uint32_t remoteNomination{ 0u };
 		IceState state{ IceState::NEW };
-		std::list<RTC::TransportTuple> tuples;
+		// Stored tuples (allocated by this), newest last.
+		absl::InlinedVector<RTC::TransportTuple*, 4> tuples;
+		// Stored tuples indexed by key, just filled when there are many of them.
+		// If several tuples have the same key (UDP ones of different sockets with
+		// same local address) just one of them is indexed.
+		absl::flat_hash_map<RTC::TransportTuple::Key, RTC::TransportTuple*> mapKeyTuple;
+		absl::flat_hash_map<const RTC::TransportTuple*, std::unique_ptr<CachedStunResponse>>
+		  mapTupleStunResponse;
 		RTC::TransportTuple* selectedTuple{ nullptr };
 	};
 } // namespace RTC
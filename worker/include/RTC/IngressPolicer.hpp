@@ -0,0 +1,108 @@
+#ifndef MS_RTC_INGRESS_POLICER_HPP
+#define MS_RTC_INGRESS_POLICER_HPP
+
+#include "common.hpp"
+#include "RTC/TransportTuple.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace RTC
+{
+	/**
+	 * Policer of the packets received by a Transport, evaluated before they
+	 * are parsed or decrypted so a flood (from a misbehaving or malicious
+	 * client) costs as little CPU as possible. Token buckets optionally limit
+	 * the bitrate of the whole Transport and the one of each remote tuple, and
+	 * STUN packets from tuples not validated by ICE are always limited by
+	 * packet rate. Packets dropped by the Transport before parsing them (for
+	 * instance those coming from unknown tuples) are also counted here.
+	 */
+	class IngressPolicer
+	{
+	public:
+		enum class DropReason : uint8_t
+		{
+			TRANSPORT_BITRATE = 0,
+			TUPLE_BITRATE,
+			UNKNOWN_TUPLE,
+			STUN_RATE
+		};
+
+	public:
+		class TokenBucket
+		{
+		public:
+			TokenBucket() = default;
+			// Bucket refilled with ratePerSecond tokens per second and holding up
+			// to the ones of burstMs (0 rate means unlimited).
+			TokenBucket(uint32_t ratePerSecond, uint32_t burstMs);
+
+		public:
+			bool TryConsume(size_t count, uint64_t nowMs);
+
+		private:
+			// Tokens per ms.
+			double rate{ 0 };
+			double capacity{ 0 };
+			double tokens{ 0 };
+			uint64_t lastRefillAtMs{ 0u };
+		};
+
+	private:
+		struct Tuple
+		{
+			TokenBucket bytes;
+			TokenBucket stunPackets;
+			uint64_t lastPacketAtMs{ 0u };
+		};
+
+		struct Counter
+		{
+			uint64_t packets{ 0u };
+			uint64_t bytes{ 0u };
+		};
+
+	public:
+		// Default duration of the burst allowed by the bitrate buckets (in ms).
+		static constexpr uint32_t DefaultBurstMs{ 500u };
+		// STUN packets per second allowed from a tuple not validated by ICE.
+		static constexpr uint32_t UnknownTupleStunRate{ 50u };
+		// Max remote tuples tracked.
+		static constexpr size_t MaxTuples{ 1024u };
+		// Time (in ms) after which an idle tuple is forgotten.
+		static constexpr uint64_t TupleTimeoutMs{ 10000u };
+
+	public:
+		// Bitrates (in bps, 0 means unlimited) of the Transport and of each tuple.
+		void Configure(uint32_t bitrate, uint32_t tupleBitrate, uint32_t burstMs);
+		// Whether a packet of len bytes received from the given tuple is accepted
+		// by the bitrate buckets. If not it's counted as dropped.
+		bool Police(const RTC::TransportTuple* tuple, size_t len, uint64_t nowMs);
+		// Whether a STUN packet received from the given tuple (not validated by
+		// ICE) is accepted. If not it's counted as dropped.
+		bool PoliceUnknownTupleStun(const RTC::TransportTuple* tuple, size_t len, uint64_t nowMs);
+		void Drop(DropReason reason, size_t len)
+		{
+			auto& counter = this->dropped[static_cast<uint8_t>(reason)];
+
+			counter.packets++;
+			counter.bytes += len;
+		}
+		void FillJson(json& jsonObject) const;
+
+	private:
+		Tuple* GetTuple(const RTC::TransportTuple* tuple, uint64_t nowMs);
+
+	private:
+		uint32_t tupleBitrate{ 0u };
+		uint32_t burstMs{ DefaultBurstMs };
+		TokenBucket transportBytes;
+		absl::flat_hash_map<RTC::TransportTuple::Key, Tuple> mapTuples;
+		uint64_t lastPruneAtMs{ 0u };
+		Counter dropped[4];
+	};
+} // namespace RTC
+
+#endif
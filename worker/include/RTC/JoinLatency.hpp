@@ -0,0 +1,53 @@
+#ifndef MS_RTC_JOIN_LATENCY_HPP
+#define MS_RTC_JOIN_LATENCY_HPP
+
+#include "common.hpp"
+#include "Metrics.hpp"
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace RTC
+{
+	/**
+	 * Per thread (so per worker) histograms of the duration (ms) of the phases
+	 * a participant goes through until media flows, so it can be found where
+	 * join time goes (ICE, DTLS or the key frame wait). Each WebRtcTransport,
+	 * Producer and Consumer records its phases once and reports them in its
+	 * stats too.
+	 */
+	class JoinLatency
+	{
+	public:
+		enum class Phase : uint8_t
+		{
+			// WebRtcTransport creation to first ICE Binding request received.
+			ICE_BINDING = 0,
+			// First ICE Binding request received to ICE connected.
+			ICE_CONNECT,
+			// ICE connected to DTLS connected.
+			DTLS_CONNECT,
+			// Producer creation to first RTP packet received.
+			PRODUCER_FIRST_RTP,
+			// Consumer creation to first RTP packet sent.
+			CONSUMER_FIRST_RTP,
+			// Consumer creation to first key frame sent (just video).
+			CONSUMER_FIRST_KEY_FRAME,
+			// Number of phases.
+			MAX
+		};
+
+	public:
+		static void ClassDestroy();
+		static void Record(Phase phase, uint64_t durationMs);
+		static void FillJson(json& jsonObject);
+
+	private:
+		static Metrics::Histogram* GetHistograms();
+
+	private:
+		thread_local static Metrics::Histogram* histograms;
+	};
+} // namespace RTC
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef MS_RTC_KEY_FRAME_CACHE_HPP
+#define MS_RTC_KEY_FRAME_CACHE_HPP
+
+#include "common.hpp"
+#include "RTC/Codecs/AV1.hpp"
+#include "RTC/RtpDictionaries.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <memory> // std::unique_ptr
+#include <vector>
+
+namespace RTC
+{
+	/**
+	 * Keeps the packets of the most recent key frame of a Producer stream, so a
+	 * Consumer that needs to sync can be bootstrapped right away instead of
+	 * waiting for a new key frame from the producer endpoint.
+	 *
+	 * Packets following the key frame are kept too (until the next key frame)
+	 * since the decoder needs them to reach the current picture. If there are
+	 * too many of them, the cache is unusable until the next key frame.
+	 */
+	class KeyFrameCache
+	{
+	public:
+		// Max number of cached packets.
+		static constexpr size_t MaxPackets{ 500u };
+		// Max size of a cached packet.
+		static constexpr size_t MaxPacketSize{ RTC::MtuSize + 100 };
+
+	public:
+		explicit KeyFrameCache(const RTC::RtpCodecMimeType& mimeType);
+		~KeyFrameCache();
+
+	public:
+		void ReceivePacket(const RTC::RtpPacket* packet);
+		void Clear();
+		// Cached packets in reception order, the first one being a key frame.
+		// Empty if the cache is not usable.
+		const std::vector<RTC::RtpPacket*>& GetPackets() const
+		{
+			return this->packets;
+		}
+		// Memory (in bytes) of the cached packets.
+		size_t GetMemoryUsage() const
+		{
+			return this->buffers.size() * MaxPacketSize;
+		}
+
+	private:
+		void ClearPackets();
+
+	private:
+		// Passed by argument.
+		RTC::RtpCodecMimeType mimeType;
+		// Allocated by this.
+		std::vector<RTC::RtpPacket*> packets;
+		// Memory of cached packets (reused across key frames).
+		std::vector<std::unique_ptr<uint8_t[]>> buffers;
+		// Others.
+		RTC::Codecs::AV1::TemplateStructure av1TemplateStructure;
+		uint32_t keyFrameTimestamp{ 0u };
+		uint16_t keyFrameSeq{ 0u };
+		// Whether the most recent key frame did not fit.
+		bool overflow{ false };
+	};
+} // namespace RTC
+
+#endif
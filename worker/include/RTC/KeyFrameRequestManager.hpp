@@ -1,6 +1,7 @@
 #ifndef MS_KEY_FRAME_REQUEST_MANAGER_HPP
 #define MS_KEY_FRAME_REQUEST_MANAGER_HPP
 
+#include "RTC/KeyFrameRequestScheduler.hpp"
 #include "handles/Timer.hpp"
 #include <absl/container/flat_hash_map.h>
 
@@ -91,7 +92,8 @@ namespace RTC
 	};
 
 	class KeyFrameRequestManager : public PendingKeyFrameInfo::Listener,
-	                               public KeyFrameRequestDelayer::Listener
+	                               public KeyFrameRequestDelayer::Listener,
+	                               public KeyFrameRequestScheduler::Listener
 	{
 	public:
 		class Listener
@@ -110,6 +112,15 @@ namespace RTC
 		void KeyFrameNeeded(uint32_t ssrc);
 		void ForceKeyFrameNeeded(uint32_t ssrc);
 		void KeyFrameReceived(uint32_t ssrc);
+		// Key frame requests are sent through the KeyFrameRequestScheduler
+		// within the given budget (if any).
+		void SetKeyFrameRequestBudget(KeyFrameRequestScheduler::Budget* budget)
+		{
+			this->budget = budget;
+		}
+
+	private:
+		void RequestKeyFrame(uint32_t ssrc);
 
 		/* Pure virtual methods inherited from PendingKeyFrameInfo::Listener. */
 	public:
@@ -119,9 +130,14 @@ namespace RTC
 	public:
 		void OnKeyFrameDelayTimeout(KeyFrameRequestDelayer* keyFrameRequestDelayer) override;
 
+		/* Pure virtual methods inherited from KeyFrameRequestScheduler::Listener. */
+	public:
+		void OnKeyFrameRequestSchedulerRequest(uint32_t ssrc) override;
+
 	private:
 		Listener* listener{ nullptr };
 		uint32_t keyFrameRequestDelay{ 0u }; // 0 means disabled.
+		KeyFrameRequestScheduler::Budget* budget{ nullptr };
 		absl::flat_hash_map<uint32_t, PendingKeyFrameInfo*> mapSsrcPendingKeyFrameInfo;
 		absl::flat_hash_map<uint32_t, KeyFrameRequestDelayer*> mapSsrcKeyFrameRequestDelayer;
 	};
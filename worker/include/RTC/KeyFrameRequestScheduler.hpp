@@ -0,0 +1,113 @@
+#ifndef MS_RTC_KEY_FRAME_REQUEST_SCHEDULER_HPP
+#define MS_RTC_KEY_FRAME_REQUEST_SCHEDULER_HPP
+
+#include "common.hpp"
+#include "handles/Timer.hpp"
+#include <absl/container/flat_hash_set.h>
+#include <deque>
+#include <utility> // std::pair
+
+namespace RTC
+{
+	/**
+	 * Per thread (so per worker) scheduler of key frame requests (PLI/FIR)
+	 * sent to Producers. Each Transport (and optionally each Router) owns a
+	 * Budget, a token bucket limiting the key frame requests per second of its
+	 * Producers. Requests within the Budget are sent right away. Otherwise they
+	 * are queued (once per Listener and SSRC) and sent as soon as tokens are
+	 * available, so a burst of requests (for instance when the BWE of a
+	 * subscriber collapses and all its simulcast Consumers switch layers) is
+	 * spread over time instead of making every encoder produce a key frame at
+	 * once. All the queued requests are driven by a single Timer.
+	 */
+	class KeyFrameRequestScheduler
+	{
+	public:
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			virtual void OnKeyFrameRequestSchedulerRequest(uint32_t ssrc) = 0;
+		};
+
+	public:
+		class Budget
+		{
+		public:
+			// Budget of requestsPerSecond (0 means unlimited) which also consumes
+			// tokens from the given parent Budget (if any).
+			Budget(uint32_t requestsPerSecond, Budget* parent);
+
+		public:
+			bool TryConsume(uint64_t nowMs);
+			// Time until a request fits in this Budget and in its parent.
+			uint64_t GetWaitMs(uint64_t nowMs);
+
+		private:
+			bool HasToken(uint64_t nowMs);
+			void Consume();
+			void Refill(uint64_t nowMs);
+
+		private:
+			// Passed by argument.
+			uint32_t requestsPerSecond{ 0u };
+			Budget* parent{ nullptr };
+			// Others.
+			double capacity{ 1 };
+			double tokens{ 1 };
+			uint64_t lastRefillAtMs{ 0u };
+		};
+
+	private:
+		struct Request
+		{
+			Budget* budget{ nullptr };
+			Listener* listener{ nullptr };
+			uint32_t ssrc{ 0u };
+		};
+
+	private:
+		class TimerListener : public Timer::Listener
+		{
+			/* Pure virtual methods inherited from Timer::Listener. */
+		public:
+			void OnTimer(Timer* timer) override;
+		};
+
+	public:
+		// Duration of the burst of requests allowed by a Budget (in ms).
+		static constexpr uint64_t BurstMs{ 250u };
+
+	public:
+		static void ClassDestroy();
+		// Notifies the Listener now if the Budget allows it, otherwise queues the
+		// request (if not already queued).
+		static void Schedule(Budget* budget, Listener* listener, uint32_t ssrc);
+		static void Unschedule(Listener* listener, uint32_t ssrc);
+		static void Unschedule(Listener* listener);
+		static bool IsScheduled(Listener* listener, uint32_t ssrc)
+		{
+			return KeyFrameRequestScheduler::scheduled.find({ listener, ssrc }) !=
+			       KeyFrameRequestScheduler::scheduled.end();
+		}
+		static size_t GetNumScheduled()
+		{
+			return KeyFrameRequestScheduler::scheduled.size();
+		}
+
+	private:
+		static void Arm(uint64_t nowMs);
+		static void OnTimer();
+
+	private:
+		thread_local static TimerListener timerListener;
+		thread_local static Timer* timer;
+		// Queued requests in arrival order.
+		thread_local static std::deque<Request> requests;
+		thread_local static absl::flat_hash_set<std::pair<Listener*, uint32_t>> scheduled;
+	};
+} // namespace RTC
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef MS_RTC_MEMORY_PIPE_HPP
+#define MS_RTC_MEMORY_PIPE_HPP
+
+#include "common.hpp"
+#include "RTC/SpscQueue.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <uv.h>
+#include <atomic>
+#include <memory> // std::shared_ptr
+#include <mutex>
+#include <string>
+
+namespace RTC
+{
+	/**
+	 * In-memory datagram channel between two workers running in different
+	 * threads of the same process (see mediasoup_worker_run()). It replaces the
+	 * UDP socket of a PipeTransport so piped packets don't go through the
+	 * kernel.
+	 *
+	 * Each MemoryPipe owns an inbound SPSC queue that the connected remote
+	 * MemoryPipe writes into. Packets are copied as raw bytes (RtpPacket and
+	 * friends live in per thread object pools so they cannot cross threads).
+	 * The consumer loop is woken up with a uv_async_t, coalescing wake ups
+	 * while it has not drained the queue yet.
+	 */
+	class MemoryPipe
+	{
+	public:
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			virtual void OnMemoryPipePacketReceived(
+			  RTC::MemoryPipe* memoryPipe, const uint8_t* data, size_t len) = 0;
+		};
+
+	public:
+		// Max size of a packet (bigger ones are dropped).
+		static constexpr size_t MaxPacketSize{ 2048u };
+		// Number of packets that can be pending in the inbound queue.
+		static constexpr size_t QueueCapacity{ 256u };
+
+	private:
+		struct Packet
+		{
+			size_t len;
+			uint8_t data[MaxPacketSize];
+		};
+
+		// State shared with the remote MemoryPipe (which lives in another thread).
+		struct Port
+		{
+			Port() : queue(QueueCapacity)
+			{
+			}
+
+			SpscQueue<Packet> queue;
+			// Guards uvHandle, which is nullptr once the owner is closed.
+			std::mutex asyncMutex;
+			uv_async_t* uvHandle{ nullptr };
+			std::atomic<bool> signaled{ false };
+			std::atomic<bool> closed{ false };
+			// Whether a remote MemoryPipe already produces into this Port.
+			std::atomic<bool> connected{ false };
+		};
+
+	private:
+		// Process wide registry of inbound ports indexed by MemoryPipe id.
+		static std::mutex registryMutex;
+		static absl::flat_hash_map<std::string, std::shared_ptr<Port>> registry;
+
+	public:
+		explicit MemoryPipe(Listener* listener);
+		MemoryPipe& operator=(const MemoryPipe&) = delete;
+		MemoryPipe(const MemoryPipe&)            = delete;
+		~MemoryPipe();
+
+	public:
+		const std::string& GetId() const
+		{
+			return this->id;
+		}
+		bool IsConnected() const
+		{
+			return this->remotePort != nullptr;
+		}
+		void Connect(const std::string& remoteId);
+		bool Send(const uint8_t* data, size_t len);
+		// Returns a buffer of at least len bytes in the remote queue, or nullptr
+		// if not available. It must be followed by a call to SendBuffer().
+		uint8_t* GetSendBuffer(size_t len);
+		void SendBuffer(size_t len);
+		void CancelSendBuffer()
+		{
+			this->sendBufferReserved = false;
+		}
+
+		/* Callbacks fired by UV events. */
+	public:
+		void OnUvAsync();
+
+	private:
+		void Signal();
+
+	private:
+		// Passed by argument.
+		Listener* listener{ nullptr };
+		// Others.
+		std::string id;
+		std::shared_ptr<Port> localPort;
+		std::shared_ptr<Port> remotePort;
+		bool sendBufferReserved{ false };
+	};
+} // namespace RTC
+
+#endif
@@ -4,17 +4,35 @@
 #include "common.hpp"
 #include "RTC/RtpPacket.hpp"
 #include "RTC/SeqManager.hpp"
+#include "RTC/TransportArena.hpp"
 #include "handles/Timer.hpp"
-#include <absl/container/btree_map.h>
-#include <absl/container/btree_set.h>
-#include <map>
-#include <set>
+#include <array>
+#include <deque>
+#include <limits>
 #include <vector>
 
 namespace RTC
 {
-	class NackGenerator : public Timer::Listener
+	/**
+	 * Packets in the NACK list, key frames and recovered packets are tracked in
+	 * bitmap rings with one bit per sequence number, indexed by the sequence
+	 * number modulo RingSize. Retries and send times of the packets in the NACK
+	 * list are kept in a side deque sorted by sequence number.
+	 *
+	 * Each packet in the NACK list is due once sendNackDelayMs have elapsed
+	 * since it was found missing and, once requested, again when the RTT (plus
+	 * some margin) has elapsed. The timer is armed for the earliest of those
+	 * deadlines rather than ticking at a fixed interval.
+	 *
+	 * NOTE: Long lived object of a Transport so it uses its TransportArena.
+	 */
+	class NackGenerator : public RTC::TransportArena::Allocated, public Timer::Listener
 	{
+	public:
+		// Number of sequence numbers tracked by each bitmap ring (must be a power
+		// of 2 greater than the maximum packet age).
+		static constexpr size_t RingSize{ 16384u };
+
 	public:
 		class Listener
 		{
@@ -30,18 +48,18 @@ namespace RTC
 		struct NackInfo
 		{
 			NackInfo() = default;
-			explicit NackInfo(uint64_t createdAtMs, uint16_t seq, uint16_t sendAtSeq)
-			  : createdAtMs(createdAtMs), seq(seq), sendAtSeq(sendAtSeq)
+			explicit NackInfo(uint64_t createdAtMs, uint16_t seq) : createdAtMs(createdAtMs), seq(seq)
 			{
 			}
 
 			uint64_t createdAtMs{ 0u };
-			uint16_t seq{ 0u };
-			uint16_t sendAtSeq{ 0u };
 			uint64_t sentAtMs{ 0u };
+			uint16_t seq{ 0u };
 			uint8_t retries{ 0u };
 		};
 
+		using Bitmap = std::array<uint64_t, RingSize / 64u>;
+
 		enum class NackFilter
 		{
 			SEQ,
@@ -55,19 +73,26 @@ namespace RTC
 		bool ReceivePacket(RTC::RtpPacket* packet, bool isRecovered);
 		size_t GetNackListLength() const
 		{
-			return this->nackList.size();
+			return this->nackListLength;
 		}
 		void UpdateRtt(uint32_t rtt)
 		{
 			this->rtt = rtt;
 		}
+		// Approximate memory (in bytes) used by the bitmaps and the NACK list.
+		size_t GetMemoryUsage() const
+		{
+			return sizeof(NackGenerator) + this->nackInfos.size() * sizeof(NackInfo);
+		}
 		void Reset();
 
 	private:
 		void AddPacketsToNackList(uint16_t seqStart, uint16_t seqEnd);
-		bool RemoveNackItemsUntilKeyFrame();
+		bool RemoveNackItemsUntilKeyFrame(uint16_t seqEnd);
+		void RemoveNackItem(const NackInfo& nackInfo);
+		uint64_t GetNackDeadline(const NackInfo& nackInfo) const;
 		std::vector<uint16_t> GetNackBatch(NackFilter filter);
-		void MayRunTimer() const;
+		void MayRunTimer();
 
 		/* Pure virtual methods inherited from Timer::Listener. */
 	public:
@@ -80,12 +105,19 @@ namespace RTC
 		// Allocated by this.
 		Timer* timer{ nullptr };
 		// Others.
-		absl::btree_map<uint16_t, NackInfo, RTC::SeqManager<uint16_t>::SeqLowerThan> nackList;
-		absl::btree_set<uint16_t, RTC::SeqManager<uint16_t>::SeqLowerThan> keyFrameList;
-		absl::btree_set<uint16_t, RTC::SeqManager<uint16_t>::SeqLowerThan> recoveredList;
+		Bitmap nackBits{};
+		Bitmap keyFrameBits{};
+		Bitmap recoveredBits{};
+		// Sorted by seq. Entries whose bit is not set in nackBits have already
+		// been removed from the NACK list.
+		std::deque<NackInfo> nackInfos;
+		size_t nackListLength{ 0u };
 		bool started{ false };
 		uint16_t lastSeq{ 0u }; // Seq number of last valid packet.
 		uint32_t rtt{ 0u };     // Round trip time (ms).
+		// Earliest deadline of the packets in the NACK list.
+		uint64_t nextNackAtMs{ std::numeric_limits<uint64_t>::max() };
+		uint64_t timerExpiresAtMs{ 0u };
 	};
 } // namespace RTC
 
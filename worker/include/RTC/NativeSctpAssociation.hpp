@@ -0,0 +1,330 @@
+#ifndef MS_RTC_NATIVE_SCTP_ASSOCIATION_HPP
+#define MS_RTC_NATIVE_SCTP_ASSOCIATION_HPP
+
+#include "common.hpp"
+#include "handles/Timer.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace RTC
+{
+	/**
+	 * SCTP association (RFC 4960) just implementing what WebRTC DataChannels
+	 * need (RFC 8831), a lighter alternative to usrsctp:
+	 *
+	 * - Handshake with the state cookie (no HMAC, SCTP runs over DTLS) and
+	 *   handling of simultaneous INITs.
+	 * - DATA chunks with fragmentation, ordered and unordered delivery, SACK
+	 *   with gap blocks, fast retransmit and the retransmission timer, and the
+	 *   RFC 4960 congestion control.
+	 * - Partial reliability (RFC 3758) of unordered messages, so maxRetransmits
+	 *   and maxPacketLifeTime are honored with FORWARD-TSN chunks.
+	 * - Stream reset and addition of outgoing streams (RFC 6525).
+	 *
+	 * All the state belongs to the association (no global map nor locks). DATA
+	 * payloads waiting to be acknowledged or reassembled are stored in fixed
+	 * size blocks taken from a per thread pool, and messages received in a
+	 * single DATA chunk are given to the listener straight from the received
+	 * packet.
+	 */
+	class NativeSctpAssociation : public Timer::Listener
+	{
+	public:
+		enum class State : uint8_t
+		{
+			CLOSED = 0,
+			COOKIE_WAIT,
+			COOKIE_ECHOED,
+			ESTABLISHED
+		};
+
+	public:
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			virtual void OnNativeSctpAssociationConnected(
+			  RTC::NativeSctpAssociation* nativeSctpAssociation) = 0;
+			virtual void OnNativeSctpAssociationFailed(
+			  RTC::NativeSctpAssociation* nativeSctpAssociation) = 0;
+			virtual void OnNativeSctpAssociationClosed(
+			  RTC::NativeSctpAssociation* nativeSctpAssociation) = 0;
+			virtual void OnNativeSctpAssociationSendPacket(
+			  RTC::NativeSctpAssociation* nativeSctpAssociation, const uint8_t* data, size_t len) = 0;
+			virtual void OnNativeSctpAssociationMessageReceived(
+			  RTC::NativeSctpAssociation* nativeSctpAssociation,
+			  uint16_t streamId,
+			  uint32_t ppid,
+			  const uint8_t* msg,
+			  size_t len) = 0;
+			virtual void OnNativeSctpAssociationBufferedAmount(
+			  RTC::NativeSctpAssociation* nativeSctpAssociation, size_t bufferedAmount) = 0;
+			// The remote reset its outgoing stream with the given id.
+			virtual void OnNativeSctpAssociationIncomingStreamReset(
+			  RTC::NativeSctpAssociation* nativeSctpAssociation, uint16_t streamId) = 0;
+		};
+
+	private:
+		enum class ChunkType : uint8_t
+		{
+			DATA              = 0,
+			INIT              = 1,
+			INIT_ACK          = 2,
+			SACK              = 3,
+			HEARTBEAT         = 4,
+			HEARTBEAT_ACK     = 5,
+			ABORT             = 6,
+			SHUTDOWN          = 7,
+			SHUTDOWN_ACK      = 8,
+			ERROR             = 9,
+			COOKIE_ECHO       = 10,
+			COOKIE_ACK        = 11,
+			SHUTDOWN_COMPLETE = 14,
+			RE_CONFIG         = 130,
+			FORWARD_TSN       = 192
+		};
+
+		enum class ChunkState : uint8_t
+		{
+			UNSENT = 0,
+			IN_FLIGHT,
+			TO_RETRANSMIT,
+			// Acknowledged by a gap block.
+			ACKED,
+			ABANDONED
+		};
+
+		// DATA chunk waiting to be sent or acknowledged.
+		struct OutgoingChunk
+		{
+			uint8_t* payload{ nullptr };
+			uint64_t sentAtMs{ 0u };
+			// 0 means no lifetime.
+			uint64_t expiresAtMs{ 0u };
+			uint32_t tsn{ 0u };
+			uint32_t ppid{ 0u };
+			uint16_t payloadLen{ 0u };
+			uint16_t streamId{ 0u };
+			uint16_t ssn{ 0u };
+			// Max retransmissions (if limitedRetransmits).
+			uint16_t maxRetransmits{ 0u };
+			uint8_t flags{ 0u };
+			uint8_t numTransmissions{ 0u };
+			uint8_t missingReports{ 0u };
+			bool limitedRetransmits{ false };
+			ChunkState state{ ChunkState::UNSENT };
+		};
+
+		// DATA chunk waiting to be reassembled or delivered in order.
+		struct IncomingChunk
+		{
+			uint8_t* payload{ nullptr };
+			uint32_t ppid{ 0u };
+			uint16_t payloadLen{ 0u };
+			uint16_t streamId{ 0u };
+			uint16_t ssn{ 0u };
+			uint8_t flags{ 0u };
+		};
+
+		// RE-CONFIG request sent and not yet answered.
+		struct ReconfigRequest
+		{
+			uint32_t seq{ 0u };
+			// Streams to reset (if not adding streams).
+			std::vector<uint16_t> streamIds;
+			uint16_t numStreamsToAdd{ 0u };
+			uint8_t numTransmissions{ 0u };
+		};
+
+	public:
+		// Max size of the SCTP packets.
+		static constexpr size_t Mtu{ 1200u };
+		static constexpr size_t MaxDataPayloadLen{ Mtu - 12u - 16u };
+
+	public:
+		static void ClassDestroy();
+
+	private:
+		static uint8_t* AcquireBlock();
+		static void ReleaseBlock(uint8_t* block);
+
+	private:
+		// Fixed size blocks (of MaxDataPayloadLen bytes) for DATA payloads.
+		thread_local static std::vector<uint8_t*> freeBlocks;
+		// Packet being built.
+		thread_local static uint8_t packetBuffer[Mtu];
+		// Buffer to deliver messages received in several DATA chunks.
+		thread_local static std::vector<uint8_t> messageBuffer;
+
+	public:
+		NativeSctpAssociation(
+		  Listener* listener, uint16_t os, uint16_t mis, size_t maxMessageSize, size_t sendBufferSize);
+		~NativeSctpAssociation() override;
+
+	public:
+		State GetState() const
+		{
+			return this->state;
+		}
+		// Negotiated number of outgoing streams.
+		uint16_t GetOs() const
+		{
+			return this->os;
+		}
+		size_t GetBufferedAmount() const
+		{
+			return this->bufferedAmount;
+		}
+		size_t GetMemoryUsage() const;
+		// Sends the INIT chunk.
+		void Connect();
+		// The checksum of the packet must have been verified.
+		void ProcessPacket(const uint8_t* data, size_t len);
+		// Queues the message. Returns false if it does not fit in the send buffer.
+		bool SendMessage(
+		  uint16_t streamId,
+		  uint32_t ppid,
+		  bool ordered,
+		  uint16_t maxPacketLifeTime,
+		  uint16_t maxRetransmits,
+		  const uint8_t* msg,
+		  size_t len);
+		// Sends the queued messages (as the congestion and receiver windows allow)
+		// bundled into as few packets as possible.
+		void Flush();
+		// Stream changes are requested with the next Flush(), once established.
+		void ResetOutgoingStream(uint16_t streamId);
+		void AddOutgoingStreams(uint16_t numStreams);
+
+	private:
+		void ProcessInit(const uint8_t* value, size_t len);
+		void ProcessInitAck(const uint8_t* value, size_t len);
+		void ProcessCookieEcho(const uint8_t* value, size_t len);
+		void ProcessCookieAck();
+		void ProcessData(uint8_t flags, const uint8_t* value, size_t len);
+		void ProcessSack(const uint8_t* value, size_t len);
+		void ProcessForwardTsn(const uint8_t* value, size_t len);
+		void ProcessReconfig(const uint8_t* value, size_t len);
+		void ProcessHeartbeat(const uint8_t* value, size_t len);
+		void ProcessAbort();
+		void ProcessShutdown();
+		void SetEstablished();
+		void SetClosed(bool failed);
+		void InitTransmission();
+		void InitReception(uint32_t initialTsn);
+		// Resets the incoming streams requested by the remote once all the DATA
+		// sent before the request has been received.
+		void PerformDeferredReset();
+		void ReleaseIncomingChunk(IncomingChunk& chunk);
+		void DeliverInOrder(uint16_t streamId);
+		bool DeliverMessage(uint64_t firstTsn);
+		void AdvanceCumulativeTsn();
+		size_t GetRecvWindow() const;
+		void UpdateRto(uint64_t rttMs);
+		void MarkForRetransmit(size_t idx, uint64_t nowMs);
+		void AbandonMessage(size_t idx);
+		void UpdateAdvancedPeerAckPoint();
+		void NotifyBufferedAmount();
+		void SendInit();
+		void SendInitAck(
+		  uint32_t initTag, uint32_t initialTsn, uint32_t rwnd, uint16_t peerMis, uint8_t features);
+		void SendCookieEcho();
+		void SendReconfigRequest();
+		void SendNextReconfigRequest();
+		void SendAbort();
+		void BeginPacket(uint32_t verificationTag);
+		// Makes room for a chunk with the given value length in the packet being
+		// built (sent to the peer tag), sending it first if needed.
+		void PrepareChunk(size_t valueLen);
+		uint8_t* AddChunk(ChunkType type, uint8_t flags, size_t valueLen);
+		size_t GetPacketRoom() const;
+		void SendPacket();
+		void AddSack();
+		void AddForwardTsn();
+		void AddDataChunk(OutgoingChunk& chunk, uint64_t nowMs);
+		void AddReconfigResponse(uint32_t seq, uint32_t result);
+		uint64_t UnwrapIncomingTsn(uint32_t tsn) const;
+		size_t GetOutgoingIndex(uint32_t tsn) const
+		{
+			return static_cast<uint32_t>(tsn - this->outgoingChunks.front().tsn);
+		}
+
+		/* Pure virtual methods inherited from Timer::Listener. */
+	public:
+		void OnTimer(Timer* timer) override;
+
+	private:
+		// Passed by argument.
+		Listener* listener{ nullptr };
+		uint16_t os{ 0u };
+		uint16_t mis{ 0u };
+		size_t maxMessageSize{ 0u };
+		size_t sendBufferSize{ 0u };
+		// Allocated by this.
+		Timer* t1Timer{ nullptr };
+		Timer* t3Timer{ nullptr };
+		// Others.
+		State state{ State::CLOSED };
+		uint32_t myTag{ 0u };
+		uint32_t peerTag{ 0u };
+		uint32_t myInitialTsn{ 0u };
+		uint32_t peerInitialTsn{ 0u };
+		// Remote features.
+		bool peerSupportsReconfig{ false };
+		bool peerSupportsForwardTsn{ false };
+		// State cookie received in the INIT-ACK.
+		std::vector<uint8_t> cookie;
+		// Sending.
+		uint32_t nextTsn{ 0u };
+		uint32_t peerCumulativeTsn{ 0u };
+		// Highest TSN acknowledged or abandoned in sequence (RFC 3758).
+		uint32_t advancedPeerAckPoint{ 0u };
+		bool forwardTsnNeeded{ false };
+		std::deque<OutgoingChunk> outgoingChunks;
+		// TSN of the first chunk never sent.
+		uint32_t firstUnsentTsn{ 0u };
+		size_t numToRetransmit{ 0u };
+		absl::flat_hash_map<uint16_t, uint16_t> nextSsns;
+		size_t bufferedAmount{ 0u };
+		size_t notifiedBufferedAmount{ 0u };
+		size_t flightSize{ 0u };
+		size_t cwnd{ 0u };
+		size_t ssthresh{ 0u };
+		size_t partialBytesAcked{ 0u };
+		size_t peerRwnd{ 0u };
+		// Fast recovery lasts until this TSN is acknowledged.
+		bool fastRecovery{ false };
+		uint32_t fastRecoveryExitTsn{ 0u };
+		uint64_t rtoMs{ 0u };
+		double srttMs{ 0 };
+		double rttvarMs{ 0 };
+		uint8_t numT1Expirations{ 0u };
+		uint8_t numT3Expirations{ 0u };
+		// Receiving.
+		uint64_t cumulativeTsn{ 0u };
+		// TSNs received beyond the cumulative one, sorted.
+		std::vector<uint64_t> receivedTsns;
+		std::map<uint64_t, IncomingChunk> incomingChunks;
+		size_t incomingBytes{ 0u };
+		absl::flat_hash_map<uint16_t, uint16_t> expectedSsns;
+		bool sackNeeded{ false };
+		// Stream reconfiguration.
+		uint32_t nextReconfigSeq{ 0u };
+		uint32_t peerNextReconfigSeq{ 0u };
+		uint32_t peerLastReconfigResult{ 0u };
+		// Incoming streams to reset once the cumulative TSN gets to the given one.
+		uint64_t deferredResetLastTsn{ 0u };
+		std::vector<uint16_t> deferredResetStreamIds;
+		ReconfigRequest* reconfigRequest{ nullptr };
+		std::vector<uint16_t> pendingResetStreamIds;
+		uint16_t pendingNumStreamsToAdd{ 0u };
+		// Packet being built.
+		size_t packetLen{ 0u };
+	};
+} // namespace RTC
+
+#endif
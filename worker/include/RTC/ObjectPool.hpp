@@ -0,0 +1,76 @@
+#ifndef MS_RTC_OBJECT_POOL_HPP
+#define MS_RTC_OBJECT_POOL_HPP
+
+#include "common.hpp"
+#include <nlohmann/json.hpp>
+#include <array>
+
+using json = nlohmann::json;
+
+namespace RTC
+{
+	/**
+	 * Per thread (so per worker) free list of fixed size memory blocks used by
+	 * objects that are allocated and freed for every packet (RtpPacket, codec
+	 * PayloadDescriptors and PayloadDescriptorHandlers).
+	 *
+	 * Classes route their allocations through it by declaring operator new and
+	 * operator delete calling Allocate() and Deallocate() (see
+	 * ObjectPool::Allocated). Blocks are never shared between threads.
+	 */
+	class ObjectPool
+	{
+	public:
+		// Size of each size class.
+		static constexpr size_t BlockSizeStep{ 64u };
+		// Number of size classes (so bigger allocations are not pooled).
+		static constexpr size_t NumSizeClasses{ 8u };
+		// Max number of cached blocks per size class.
+		static constexpr size_t MaxCachedBlocksPerSizeClass{ 4096u };
+
+	public:
+		// Base class whose operator new and operator delete use the pool. Since
+		// the allocation size is provided by the compiler, derived classes of
+		// different sizes are served by the proper size class.
+		class Allocated
+		{
+		public:
+			static void* operator new(size_t size)
+			{
+				return ObjectPool::Allocate(size);
+			}
+			static void operator delete(void* ptr, size_t size)
+			{
+				ObjectPool::Deallocate(ptr, size);
+			}
+		};
+
+	public:
+		static void ClassDestroy();
+		static void* Allocate(size_t size);
+		static void Deallocate(void* ptr, size_t size);
+		static void FillJson(json& jsonObject);
+		static uint64_t GetHits()
+		{
+			return ObjectPool::hits;
+		}
+		static uint64_t GetMisses()
+		{
+			return ObjectPool::misses;
+		}
+
+	private:
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+
+	private:
+		thread_local static std::array<FreeBlock*, NumSizeClasses> freeLists;
+		thread_local static std::array<size_t, NumSizeClasses> numCachedBlocks;
+		thread_local static uint64_t hits;
+		thread_local static uint64_t misses;
+	};
+} // namespace RTC
+
+#endif
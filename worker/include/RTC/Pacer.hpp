@@ -0,0 +1,166 @@
+#ifndef MS_RTC_PACER_HPP
+#define MS_RTC_PACER_HPP
+
+#include "common.hpp"
+#include "RTC/Consumer.hpp"
+#include "RTC/RtpPacket.hpp"
+#include "handles/Timer.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <deque>
+#include <memory> // std::unique_ptr
+#include <vector>
+
+namespace RTC
+{
+	/**
+	 * Budget based pacer for the media sent by a Transport.
+	 *
+	 * The budget grows at the pacing rate (a multiple of the available outgoing
+	 * bitrate). Packets are sent right away while there is budget left and no
+	 * packet is queued. Otherwise they are cloned and queued, and the queue is
+	 * drained every few ms, so packets drained together are sent within the
+	 * same loop iteration (and hence with a single sendmmsg()).
+	 *
+	 * The bandwidth estimation and probing are still done by libwebrtc.
+	 *
+	 * If a SCTP bitrate share is given, SCTP packets also go through the pacer
+	 * and are sent within both the pacing budget and their own budget, which
+	 * grows at that share of the available outgoing bitrate, so large
+	 * DataChannel transfers do not burst alongside the media. They are sent
+	 * right away just if nothing is queued.
+	 *
+	 * If the oldest queued packet waits for too long (the available bitrate
+	 * is lower than the queued one), whole non reference frames (those of
+	 * temporal layers above 0) are dropped instead of sending them late, so
+	 * the bandwidth goes to the frames the rest depend on. Frames partially
+	 * sent are kept. Key frames (and their retransmissions) are never dropped
+	 * and audio is not paced.
+	 */
+	class Pacer : public Timer::Listener
+	{
+	public:
+		// Max size of a queued packet.
+		static constexpr size_t MaxPacketSize{ RTC::MtuSize + 100 };
+
+	public:
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			// queuedAtNs is the time (ns) at which the packet was queued, just given
+			// if the packet has ingress time (0 otherwise).
+			virtual void OnPacerSendRtpPacket(
+			  RTC::Pacer* pacer,
+			  RTC::Consumer* consumer,
+			  RTC::RtpPacket* packet,
+			  bool retransmission,
+			  uint64_t queuedAtNs) = 0;
+			virtual void OnPacerSendSctpData(RTC::Pacer* pacer, const uint8_t* data, size_t len) = 0;
+		};
+
+	private:
+		struct QueuedPacket
+		{
+			RTC::Consumer* consumer{ nullptr };
+			RTC::RtpPacket* packet{ nullptr };
+			std::unique_ptr<uint8_t[]> buffer;
+			bool retransmission{ false };
+			uint64_t queuedAtMs{ 0u };
+			uint64_t queuedAtNs{ 0u };
+		};
+
+		struct QueuedSctpPacket
+		{
+			std::unique_ptr<uint8_t[]> buffer;
+			size_t len{ 0u };
+			uint64_t queuedAtMs{ 0u };
+		};
+
+		// Last sent and dropped non reference frames of a stream (by RTP timestamp).
+		struct StreamFrames
+		{
+			const RTC::Consumer* consumer{ nullptr };
+			uint32_t sentTimestamp{ 0u };
+			uint32_t droppedTimestamp{ 0u };
+			uint8_t droppedTemporalLayer{ 0u };
+			bool sent{ false };
+			bool dropped{ false };
+		};
+
+	public:
+		// sctpBitrateShare (between 0 and 1) is the share of the available bitrate
+		// for SCTP packets, 0 if they are not paced.
+		Pacer(RTC::Pacer::Listener* listener, uint32_t availableBitrate, float sctpBitrateShare = 0);
+		~Pacer();
+
+	public:
+		void SetAvailableBitrate(uint32_t availableBitrate);
+		// Returns false if the packet must be sent right away. Otherwise the packet
+		// has been cloned and it will be given to the listener later, or it has
+		// been dropped along with the rest of its frame.
+		bool QueuePacket(RTC::Consumer* consumer, RTC::RtpPacket* packet, bool retransmission);
+		// Same as QueuePacket() but for SCTP packets. Returns false if the packet
+		// must be sent right away, always if no SCTP bitrate share was given.
+		bool QueueSctpPacket(const uint8_t* data, size_t len);
+		// Drops the queued packets of the given Consumer.
+		void RemoveConsumer(const RTC::Consumer* consumer);
+		// Drops all the queued packets (SCTP ones too).
+		void Clear();
+		size_t GetQueueSize() const
+		{
+			return this->queue.size();
+		}
+		size_t GetSctpQueueSize() const
+		{
+			return this->sctpQueue.size();
+		}
+		// Packets of non reference frames dropped under congestion.
+		uint64_t GetDroppedPackets() const
+		{
+			return this->droppedPackets;
+		}
+		// Memory (in bytes) of queued packets, including reusable buffers.
+		size_t GetMemoryUsage() const
+		{
+			return (this->queue.size() + this->sctpQueue.size() + this->buffers.size()) * MaxPacketSize;
+		}
+
+	private:
+		void UpdateBudget(uint64_t nowMs);
+		std::unique_ptr<uint8_t[]> GetBuffer();
+		void ReleasePacket(QueuedPacket& queuedPacket);
+		bool MustDropPacket(const RTC::RtpPacket* packet);
+		void MayDropNonReferenceFrames(uint64_t nowMs);
+		void SetFrameSent(const RTC::Consumer* consumer, const RTC::RtpPacket* packet);
+		void DrainSctpQueue(uint64_t nowMs);
+
+		/* Pure virtual methods inherited from Timer::Listener. */
+	public:
+		void OnTimer(Timer* timer) override;
+
+	private:
+		// Passed by argument.
+		Listener* listener{ nullptr };
+		// Allocated by this.
+		Timer* drainTimer{ nullptr };
+		std::deque<QueuedPacket> queue;
+		std::deque<QueuedSctpPacket> sctpQueue;
+		// Indexed by SSRC, just of streams with non reference frames.
+		absl::flat_hash_map<uint32_t, StreamFrames> mapSsrcStreamFrames;
+		// Memory of queued packets (reused).
+		std::vector<std::unique_ptr<uint8_t[]>> buffers;
+		// Others.
+		uint64_t pacingBitrate{ 0u }; // In bps.
+		// Bytes that can be sent now (negative if too many bytes were sent).
+		int64_t budget{ 0 };
+		float sctpBitrateShare{ 0 };
+		uint64_t sctpBitrate{ 0u }; // In bps.
+		int64_t sctpBudget{ 0 };
+		uint64_t lastBudgetUpdateAtMs{ 0u };
+		uint64_t droppedPackets{ 0u };
+	};
+} // namespace RTC
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef MS_RTC_PACKET_CAPTURE_HPP
+#define MS_RTC_PACKET_CAPTURE_HPP
+
+#include "common.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace RTC
+{
+	/**
+	 * On demand capture of the RTP and RTCP packets received (once decrypted)
+	 * and sent (before being encrypted) by a Transport, so a degraded room can
+	 * be diagnosed without capturing traffic in the host (useless with SRTP).
+	 *
+	 * The last maxPackets packets (or just their headers) are copied with their
+	 * timestamp into preallocated slots, overwriting the oldest ones, and are
+	 * given in pcap format when dumped.
+	 *
+	 * Packets get synthetic IPv4/UDP headers (remote 10.0.0.2 and local
+	 * 10.0.0.1, port 5004 for RTP and 5005 for RTCP) so Wireshark decodes them
+	 * with "Decode As..." RTP/RTCP or with the rtp_udp heuristic enabled.
+	 */
+	class PacketCapture
+	{
+	public:
+		enum class Direction : uint8_t
+		{
+			IN = 0,
+			OUT
+		};
+
+	public:
+		static constexpr size_t DefaultMaxPackets{ 4096u };
+		static constexpr size_t MaxMaxPackets{ 65536u };
+		// Bytes kept of every packet in headers only mode. Long enough for the RTP
+		// header with its CSRCs and extensions and for most RTCP packets.
+		static constexpr size_t HeadersSnapLen{ 256u };
+
+	private:
+		struct Slot
+		{
+			// High resolution time of the capture (in ns).
+			uint64_t timeNs;
+			uint16_t len;
+			uint16_t capturedLen;
+			Direction direction;
+			bool isRtcp;
+		};
+
+	public:
+		// Options of transport.enablePacketCapture(). This may throw.
+		static PacketCapture* Create(const json& data);
+
+	public:
+		PacketCapture(size_t maxPackets, bool headersOnly);
+
+	public:
+		void CaptureRtpPacket(Direction direction, const RTC::RtpPacket* packet)
+		{
+			const size_t len = packet->GetSize();
+
+			Capture(
+			  direction,
+			  packet->GetData(),
+			  len,
+			  this->headersOnly ? static_cast<size_t>(packet->GetPayload() - packet->GetData()) : len,
+			  false);
+		}
+		void CaptureRtcpPacket(Direction direction, const uint8_t* data, size_t len)
+		{
+			Capture(direction, data, len, len, true);
+		}
+		// Number of packets in the ring.
+		size_t GetPacketCount() const
+		{
+			return this->packetCount;
+		}
+		// Captured packets, oldest first.
+		void SerializePcap(std::vector<uint8_t>& pcap) const;
+		// This may throw.
+		void WritePcap(const std::string& path) const;
+		void FillJson(json& jsonObject) const;
+
+	private:
+		void Capture(Direction direction, const uint8_t* data, size_t len, size_t snapLen, bool isRtcp);
+
+	private:
+		// Passed by argument.
+		bool headersOnly{ false };
+		// Allocated by this.
+		std::vector<Slot> slots;
+		std::vector<uint8_t> buffer;
+		// Others.
+		size_t slotSize{ 0u };
+		size_t nextSlotIdx{ 0u };
+		size_t packetCount{ 0u };
+		uint64_t capturedPackets{ 0u };
+		// Offset from the high resolution clock to the time since the epoch (in ns).
+		int64_t epochOffsetNs{ 0 };
+	};
+} // namespace RTC
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef MS_RTC_PACKET_CLASSIFIER_HPP
+#define MS_RTC_PACKET_CLASSIFIER_HPP
+
+#include "common.hpp"
+#include "RTC/DtlsTransport.hpp"
+#include "RTC/RTCP/Packet.hpp"
+#include "RTC/RtpPacket.hpp"
+#include "RTC/StunPacket.hpp"
+
+namespace RTC
+{
+	/**
+	 * Classifies a packet received in a WebRtcTransport in a single pass, as
+	 * RFC 7983 describes: the range of the first byte tells the protocol, so
+	 * just the validator of that protocol is run (instead of trying each of
+	 * them in turn).
+	 */
+	class PacketClassifier
+	{
+	public:
+		enum class Type : uint8_t
+		{
+			UNKNOWN = 0,
+			STUN,
+			DTLS,
+			RTP,
+			RTCP
+		};
+
+	public:
+		static Type Classify(const uint8_t* data, size_t len)
+		{
+			if (len == 0u)
+				return Type::UNKNOWN;
+
+			const uint8_t firstByte = data[0];
+
+			// RTP and RTCP: [128..191].
+			if (firstByte > 127 && firstByte < 192)
+			{
+				// RTCP packet types are [192..223] (RFC 5761).
+				if (RTC::RTCP::Packet::IsRtcp(data, len))
+					return Type::RTCP;
+				else if (RTC::RtpPacket::IsRtp(data, len))
+					return Type::RTP;
+			}
+			// STUN: [0..3].
+			else if (firstByte < 4)
+			{
+				if (RTC::StunPacket::IsStun(data, len))
+					return Type::STUN;
+			}
+			// DTLS: [20..63].
+			else if (firstByte > 19 && firstByte < 64)
+			{
+				if (RTC::DtlsTransport::IsDtls(data, len))
+					return Type::DTLS;
+			}
+
+			return Type::UNKNOWN;
+		}
+	};
+} // namespace RTC
+
+#endif
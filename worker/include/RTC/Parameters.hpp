@@ -76,6 +76,8 @@ namespace RTC
 		double GetDouble(const std::string& key) const;
 		const std::string& GetString(const std::string& key) const;
 		const std::vector<int32_t>& GetArrayOfIntegers(const std::string& key) const;
+		// Heap memory (in bytes) used by the key/values.
+		size_t GetMemoryUsage() const;
 
 	private:
 		absl::flat_hash_map<std::string, Value> mapKeyValues;
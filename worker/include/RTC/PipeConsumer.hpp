@@ -21,7 +21,13 @@ namespace RTC
 		void FillJson(json& jsonObject) const override;
 		void FillJsonStats(json& jsonArray) const override;
 		void FillJsonScore(json& jsonObject) const override;
+		void FillJsonSendState(json& jsonObject) const override;
 		void HandleRequest(Channel::ChannelRequest* request) override;
+		// Layers demanded by the remote Router (all of them until told otherwise).
+		RTC::Consumer::Layers GetPreferredLayers() const override
+		{
+			return this->layerDemand;
+		}
 		void ProducerRtpStream(RTC::RtpStream* rtpStream, uint32_t mappedSsrc) override;
 		void ProducerNewRtpStream(RTC::RtpStream* rtpStream, uint32_t mappedSsrc) override;
 		void ProducerRtpStreamScore(RTC::RtpStream* rtpStream, uint8_t score, uint8_t previousScore) override;
@@ -36,6 +42,10 @@ namespace RTC
 		{
 			return this->rtpStreams;
 		}
+		size_t GetObjectSize() const override
+		{
+			return sizeof(*this);
+		}
 		void NeedWorstRemoteFractionLost(uint32_t mappedSsrc, uint8_t& worstRemoteFractionLost) override;
 		void ReceiveNack(RTC::RTCP::FeedbackRtpNackPacket* nackPacket) override;
 		void ReceiveKeyFrameRequest(RTC::RTCP::FeedbackPs::MessageType messageType, uint32_t ssrc) override;
@@ -51,11 +61,14 @@ namespace RTC
 		void UserOnResumed() override;
 		void CreateRtpStreams();
 		void RequestKeyFrame();
+		void SetLayerDemand(const RTC::Consumer::Layers& layers);
 
 		/* Pure virtual methods inherited from RtpStreamSend::Listener. */
 	public:
 		void OnRtpStreamScore(RTC::RtpStream* rtpStream, uint8_t score, uint8_t previousScore) override;
-		void OnRtpStreamRetransmitRtpPacket(RTC::RtpStreamSend* rtpStream, RTC::RtpPacket* packet) override;
+		void OnRtpStreamRetransmitRtpPackets(
+		  RTC::RtpStreamSend* rtpStream, RTC::RtpPacket** packets, size_t count) override;
+		void OnRtpStreamSendFecPacket(RTC::RtpStreamSend* rtpStream, RTC::RtpPacket* packet) override;
 
 	private:
 		// Allocated by this.
@@ -66,6 +79,10 @@ namespace RTC
 		bool keyFrameSupported{ false };
 		absl::flat_hash_map<RTC::RtpStreamSend*, bool> mapRtpStreamSyncRequired;
 		absl::flat_hash_map<RTC::RtpStreamSend*, RTC::SeqManager<uint16_t>> mapRtpStreamRtpSeqManager;
+		// Whether the remote Router has Consumers for each stream (see
+		// SetLayerDemand()). Streams without demand are paused.
+		absl::flat_hash_map<RTC::RtpStreamSend*, bool> mapRtpStreamDemanded;
+		RTC::Consumer::Layers layerDemand;
 	};
 } // namespace RTC
 
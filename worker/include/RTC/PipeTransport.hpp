@@ -1,14 +1,28 @@
 #ifndef MS_RTC_PIPE_TRANSPORT_HPP
 #define MS_RTC_PIPE_TRANSPORT_HPP
 
+#include "RTC/MemoryPipe.hpp"
+#include "RTC/PipeTrunk.hpp"
 #include "RTC/SrtpSession.hpp"
+#include "RTC/TcpConnection.hpp"
+#include "RTC/TcpServer.hpp"
 #include "RTC/Transport.hpp"
 #include "RTC/TransportTuple.hpp"
 #include "RTC/UdpSocket.hpp"
+#include "handles/TcpConnectionHandler.hpp"
+#include "handles/Timer.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <vector>
 
 namespace RTC
 {
-	class PipeTransport : public RTC::Transport, public RTC::UdpSocket::Listener
+	class PipeTransport : public RTC::Transport,
+	                      public RTC::UdpSocket::Listener,
+	                      public RTC::MemoryPipe::Listener,
+	                      public RTC::PipeTrunk::Listener,
+	                      public RTC::TcpServer::Listener,
+	                      public RTC::TcpConnection::Listener,
+	                      public ::TcpConnectionHandler::Listener
 	{
 	private:
 		struct ListenIp
@@ -17,10 +31,37 @@ namespace RTC
 			std::string announcedIp;
 		};
 
+		// Producer of a stream index announced by the remote PipeTransport in
+		// trusted network mode.
+		struct TrustedRecvStream
+		{
+			uint32_t ssrc{ 0u };
+			RTC::Producer* producer{ nullptr };
+		};
+
+	private:
+		class TcpReconnectTimerListener : public Timer::Listener
+		{
+		public:
+			explicit TcpReconnectTimerListener(PipeTransport* pipeTransport)
+			  : pipeTransport(pipeTransport)
+			{
+			}
+
+			/* Pure virtual methods inherited from Timer::Listener. */
+		public:
+			void OnTimer(Timer* timer) override;
+
+		private:
+			PipeTransport* pipeTransport{ nullptr };
+		};
+
 	private:
 		static RTC::SrtpSession::CryptoSuite srtpCryptoSuite;
 		static std::string srtpCryptoSuiteString;
 		static size_t srtpMasterLength;
+		// In-memory PipeTransports of this worker indexed by MemoryPipe id.
+		thread_local static absl::flat_hash_map<std::string, PipeTransport*> inMemoryPipeTransports;
 
 	public:
 		PipeTransport(const std::string& id, RTC::Transport::Listener* listener, json& data);
@@ -35,6 +76,17 @@ namespace RTC
 	private:
 		bool IsConnected() const override;
 		bool HasSrtp() const;
+		uint8_t* GetPeerSendBuffer(size_t len);
+		void SendPeerBuffer(size_t len, RTC::Transport::onSendCallback* cb = nullptr);
+		void SendToPeer(const uint8_t* data, size_t len, RTC::Transport::onSendCallback* cb = nullptr);
+		void SendToTrunk(const uint8_t* data, size_t len, RTC::Transport::onSendCallback* cb = nullptr);
+		void SendTrusted(
+		  const uint8_t* data, size_t len, bool isRtp, RTC::Transport::onSendCallback* cb = nullptr);
+		uint16_t GetTrustedSendStreamIndex(uint32_t ssrc);
+		bool CheckTrustedChecksum(const uint8_t* data, size_t len);
+		RTC::Producer* GetTrustedRecvProducer(uint16_t streamIndex, uint32_t ssrc);
+		void FillJsonLocalTuple(json& jsonObject) const;
+		bool SendRtcpToLocalPeer(const uint8_t* data, size_t len);
 		void SendRtpPacket(
 		  RTC::Consumer* consumer,
 		  RTC::RtpPacket* packet,
@@ -54,22 +106,83 @@ namespace RTC
 		void OnRtpDataReceived(RTC::TransportTuple* tuple, const uint8_t* data, size_t len);
 		void OnRtcpDataReceived(RTC::TransportTuple* tuple, const uint8_t* data, size_t len);
 		void OnSctpDataReceived(RTC::TransportTuple* tuple, const uint8_t* data, size_t len);
+		void OnTrunkFrameReceived(RTC::TransportTuple* tuple, const uint8_t* data, size_t len);
+		void ConnectTcp();
+		void OnTcpConnected(RTC::TcpConnection* connection);
+		void OnTcpDisconnected();
 
 		/* Pure virtual methods inherited from RTC::UdpSocket::Listener. */
 	public:
 		void OnUdpSocketPacketReceived(
 		  RTC::UdpSocket* socket, const uint8_t* data, size_t len, const struct sockaddr* remoteAddr) override;
 
+		/* Pure virtual methods inherited from RTC::MemoryPipe::Listener. */
+	public:
+		void OnMemoryPipePacketReceived(
+		  RTC::MemoryPipe* memoryPipe, const uint8_t* data, size_t len) override;
+
+		/* Pure virtual methods inherited from RTC::PipeTrunk::Listener. */
+	public:
+		void OnPipeTrunkSendFrame(RTC::PipeTrunk* pipeTrunk, const uint8_t* data, size_t len) override;
+		void OnPipeTrunkPacketReceived(
+		  RTC::PipeTrunk* pipeTrunk, const uint8_t* data, size_t len) override;
+
+		/* Pure virtual methods inherited from RTC::TcpServer::Listener. */
+	public:
+		void OnRtcTcpConnectionClosed(RTC::TcpServer* tcpServer, RTC::TcpConnection* connection) override;
+
+		/* Pure virtual methods inherited from RTC::TcpConnection::Listener. */
+	public:
+		void OnTcpConnectionPacketReceived(
+		  RTC::TcpConnection* connection, const uint8_t* data, size_t len) override;
+
+		/* Pure virtual methods inherited from ::TcpConnectionHandler::Listener. */
+	public:
+		void OnTcpConnectionClosed(::TcpConnectionHandler* connection) override;
+		void OnTcpConnectionConnected(::TcpConnectionHandler* connection) override;
+
+		/* Callbacks fired by UV events. */
+	public:
+		void OnUvTrunkPrepare();
+
 	private:
 		// Allocated by this.
 		RTC::UdpSocket* udpSocket{ nullptr };
+		RTC::MemoryPipe* memoryPipe{ nullptr };
 		RTC::TransportTuple* tuple{ nullptr };
 		RTC::SrtpSession* srtpRecvSession{ nullptr };
 		RTC::SrtpSession* srtpSendSession{ nullptr };
+		// Aggregates RTP and RTCP sent to the remote peer (if trunk is enabled).
+		RTC::PipeTrunk* trunk{ nullptr };
+		uv_prepare_t* trunkPrepareHandle{ nullptr };
+		// Listens for the remote PipeTransport (if TCP is enabled).
+		RTC::TcpServer* tcpServer{ nullptr };
+		// Outgoing connection if this is the TCP client.
+		RTC::TcpConnection* tcpClientConnection{ nullptr };
+		Timer* tcpReconnectTimer{ nullptr };
 		// Others.
+		// Paired in-memory PipeTransport if it belongs to this same worker. RTP
+		// and RTCP are directly passed to it rather than through the MemoryPipe.
+		PipeTransport* localPeer{ nullptr };
 		ListenIp listenIp;
 		struct sockaddr_storage remoteAddrStorage;
 		bool rtx{ false };
+		// No SRTP. RTP and RTCP carry a checksum and RTP packets also carry the
+		// index of their stream.
+		bool trustedNetwork{ false };
+		absl::flat_hash_map<uint32_t, uint16_t> mapSsrcTrustedSendStreamIndex;
+		std::vector<uint16_t> trustedFreeStreamIndexes;
+		uint16_t trustedNextStreamIndex{ 0u };
+		// Indexed by the stream index given by the remote PipeTransport.
+		std::vector<TrustedRecvStream> trustedRecvStreams;
+		uint64_t trustedChecksumErrors{ 0u };
+		bool tcp{ false };
+		// TCP role given in connect() ("client" or "server").
+		std::string tcpRole;
+		// Remote IP given in connect(). In TCP server role only a connection from
+		// it is adopted.
+		std::string remoteIp;
+		TcpReconnectTimerListener tcpReconnectTimerListener{ this };
 		std::string srtpKey;
 		std::string srtpKeyBase64;
 	};
@@ -0,0 +1,119 @@
+#ifndef MS_RTC_PIPE_TRUNK_HPP
+#define MS_RTC_PIPE_TRUNK_HPP
+
+#include "common.hpp"
+#include <openssl/evp.h>
+#include <vector>
+
+namespace RTC
+{
+	/**
+	 * Aggregation of the RTP and RTCP packets that a PipeTransport sends to its
+	 * remote peer into frames of up to maxFrameSize bytes (a datagram each) so
+	 * cascading many streams does not cost a syscall and a SRTP operation per
+	 * packet.
+	 *
+	 * Packets are appended to the current frame, each one preceded by its
+	 * length (2 bytes). The frame is handed to the listener once the next
+	 * packet does not fit or Flush() is called.
+	 *
+	 * If keys are set, the whole frame is protected with a single AES-128-GCM
+	 * operation. The frame counter is authenticated (as part of the header),
+	 * it's used as nonce (XORed with the salt) and it's checked against a
+	 * replay window on reception.
+	 *
+	 * Frame layout:
+	 *
+	 *   magic (4 bytes) | counter (8 bytes) | records | tag (16 bytes, if keys)
+	 */
+	class PipeTrunk
+	{
+	public:
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			virtual void OnPipeTrunkSendFrame(
+			  RTC::PipeTrunk* pipeTrunk, const uint8_t* data, size_t len) = 0;
+			virtual void OnPipeTrunkPacketReceived(
+			  RTC::PipeTrunk* pipeTrunk, const uint8_t* data, size_t len) = 0;
+		};
+
+	public:
+		static constexpr size_t HeaderSize{ 12u };
+		static constexpr size_t RecordHeaderSize{ 2u };
+		static constexpr size_t TagSize{ 16u };
+		// Length of the keys given to SetKeys(): AES-128 key (16 bytes) followed
+		// by the salt (14 bytes), same as a SRTP master key.
+		static constexpr size_t KeyLength{ 30u };
+		static constexpr size_t DefaultMaxFrameSize{ 8192u };
+		// Must fit a full RTP packet.
+		static constexpr size_t MinMaxFrameSize{ 2048u };
+		static constexpr size_t MaxMaxFrameSize{ 65000u };
+		// Number of frames tracked by the replay window.
+		static constexpr uint64_t ReplayWindowSize{ 64u };
+
+	public:
+		static bool IsFrame(const uint8_t* data, size_t len);
+
+	public:
+		PipeTrunk(Listener* listener, size_t maxFrameSize);
+		~PipeTrunk();
+
+	public:
+		// This may throw.
+		void SetKeys(const uint8_t* sendKey, const uint8_t* recvKey);
+		bool HasKeys() const
+		{
+			return this->sendCtx != nullptr;
+		}
+		size_t GetMaxFrameSize() const
+		{
+			return this->maxFrameSize;
+		}
+		bool IsEmpty() const
+		{
+			return this->frameLen == HeaderSize;
+		}
+		uint64_t GetSentFrames() const
+		{
+			return this->sentFrames;
+		}
+		uint64_t GetSentPackets() const
+		{
+			return this->sentPackets;
+		}
+		// Returns false if the packet is too big to ever fit in a frame.
+		bool Send(const uint8_t* data, size_t len);
+		void Flush();
+		// The frame is decrypted in place.
+		bool ReceiveFrame(uint8_t* data, size_t len);
+
+	private:
+		bool IsReplayed(uint64_t counter) const;
+		void UpdateReplayWindow(uint64_t counter);
+
+	private:
+		// Passed by argument.
+		Listener* listener{ nullptr };
+		size_t maxFrameSize{ DefaultMaxFrameSize };
+		// Allocated by this.
+		EVP_CIPHER_CTX* sendCtx{ nullptr };
+		EVP_CIPHER_CTX* recvCtx{ nullptr };
+		// Others.
+		std::vector<uint8_t> frame;
+		size_t frameLen{ HeaderSize };
+		uint64_t sendCounter{ 0u };
+		uint8_t sendSalt[12];
+		uint8_t recvSalt[12];
+		bool recvCounterSet{ false };
+		uint64_t maxRecvCounter{ 0u };
+		uint64_t replayWindow{ 0u };
+		uint64_t sentFrames{ 0u };
+		uint64_t sentPackets{ 0u };
+	};
+} // namespace RTC
+
+#endif
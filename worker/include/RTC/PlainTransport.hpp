@@ -1,6 +1,7 @@
 #ifndef MS_RTC_PLAIN_TRANSPORT_HPP
 #define MS_RTC_PLAIN_TRANSPORT_HPP
 
+#include "RTC/SharedUdpSocket.hpp"
 #include "RTC/SrtpSession.hpp"
 #include "RTC/Transport.hpp"
 #include "RTC/TransportTuple.hpp"
@@ -9,7 +10,9 @@
 
 namespace RTC
 {
-	class PlainTransport : public RTC::Transport, public RTC::UdpSocket::Listener
+	class PlainTransport : public RTC::Transport,
+	                       public RTC::UdpSocket::Listener,
+	                       public RTC::SharedUdpSocket::Listener
 	{
 	private:
 		struct ListenIp
@@ -62,6 +65,16 @@ namespace RTC
 		void OnUdpSocketPacketReceived(
 		  RTC::UdpSocket* socket, const uint8_t* data, size_t len, const struct sockaddr* remoteAddr) override;
 
+		/* Pure virtual methods inherited from RTC::SharedUdpSocket::Listener. */
+	public:
+		void OnSharedUdpSocketPacketReceived(
+		  RTC::SharedUdpSocket* sharedUdpSocket,
+		  RTC::TransportTuple* tuple,
+		  const uint8_t* data,
+		  size_t len) override;
+		bool OnSharedUdpSocketClaimPacket(
+		  RTC::SharedUdpSocket* sharedUdpSocket, const uint8_t* data, size_t len) override;
+
 	private:
 		// Allocated by this.
 		RTC::UdpSocket* udpSocket{ nullptr };
@@ -71,9 +84,16 @@ namespace RTC
 		RTC::SrtpSession* srtpRecvSession{ nullptr };
 		RTC::SrtpSession* srtpSendSession{ nullptr };
 		// Others.
+		// Shared with other PlainTransports (if sharedPort is set), so
+		// udpSocket belongs to it.
+		RTC::SharedUdpSocket* sharedUdpSocket{ nullptr };
 		ListenIp listenIp;
 		bool rtcpMux{ true };
 		bool comedia{ false };
+		// TTL and interface of the datagrams sent to a multicast group (0 and
+		// empty if not given).
+		uint8_t multicastTtl{ 0u };
+		std::string multicastInterface;
 		struct sockaddr_storage remoteAddrStorage;
 		struct sockaddr_storage rtcpRemoteAddrStorage;
 		RTC::SrtpSession::CryptoSuite srtpCryptoSuite{
@@ -3,9 +3,11 @@
 
 #include "common.hpp"
 #include "Settings.hpp"
+#include "handles/Timer.hpp"
 #include <uv.h>
 #include <absl/container/flat_hash_map.h>
 #include <nlohmann/json.hpp>
+#include <deque>
 #include <string>
 #include <vector>
 
@@ -20,6 +22,43 @@ namespace RTC
 			TCP
 		};
 
+		// Ports of the RTC port range in a given IP, indexed from rtcMinPort.
+		struct Ports
+		{
+			bool IsUsed(size_t portIdx) const
+			{
+				return (this->usedBitmap[portIdx / 64] >> (portIdx % 64)) & 1u;
+			}
+			void SetUsed(size_t portIdx, bool used)
+			{
+				if (used)
+					this->usedBitmap[portIdx / 64] |= uint64_t{ 1u } << (portIdx % 64);
+				else
+					this->usedBitmap[portIdx / 64] &= ~(uint64_t{ 1u } << (portIdx % 64));
+			}
+
+			// One bit per port, set if in use.
+			std::vector<uint64_t> usedBitmap;
+			// Ports not in use, in the order they will be tried. Released ports and
+			// those that failed to bind go to the back.
+			std::deque<uint16_t> freePortIdxs;
+			size_t numPorts{ 0u };
+			size_t numUsedPorts{ 0u };
+			// bind() failures in ports not in use (taken by other processes).
+			size_t bindFailures{ 0u };
+			// Sockets already bound in random ports (see socketPoolSize setting).
+			std::deque<uv_handle_t*> pool;
+			// Binds served by the pool.
+			size_t pooledBinds{ 0u };
+		};
+
+		class TimerListener : public Timer::Listener
+		{
+			/* Pure virtual methods inherited from Timer::Listener. */
+		public:
+			void OnTimer(Timer* timer) override;
+		};
+
 	public:
 		static uv_udp_t* BindUdp(std::string& ip)
 		{
@@ -29,6 +68,17 @@ namespace RTC
 		{
 			return reinterpret_cast<uv_udp_t*>(Bind(Transport::UDP, ip, port));
 		}
+		/**
+		 * Binds a UDP socket with SO_REUSEPORT (Linux only) so sockets of
+		 * different workers share the port. If remoteAddr is given the socket is
+		 * connected to it so the kernel delivers it the packets of that 5-tuple.
+		 * Otherwise the reuseport steering program is attached to the group.
+		 */
+		static uv_udp_t* BindUdpReusePort(
+		  std::string& ip, uint16_t port, const struct sockaddr* remoteAddr = nullptr)
+		{
+			return reinterpret_cast<uv_udp_t*>(Bind(Transport::UDP, ip, port, true, remoteAddr));
+		}
 		static uv_tcp_t* BindTcp(std::string& ip)
 		{
 			return reinterpret_cast<uv_tcp_t*>(Bind(Transport::TCP, ip));
@@ -46,16 +96,35 @@ namespace RTC
 			return Unbind(Transport::TCP, ip, port);
 		}
 		static void FillJson(json& jsonObject);
+		static void FillJsonUsage(json& jsonObject);
+		// Closes the pooled sockets. To be called before closing the worker.
+		static void ClosePools();
 
 	private:
 		static uv_handle_t* Bind(Transport transport, std::string& ip);
-		static uv_handle_t* Bind(Transport transport, std::string& ip, uint16_t port);
+		static uv_handle_t* BindFreePort(Transport transport, std::string& ip);
+		static uv_handle_t* Bind(
+		  Transport transport,
+		  std::string& ip,
+		  uint16_t port,
+		  bool reusePort                    = false,
+		  const struct sockaddr* remoteAddr = nullptr);
+		// This may throw.
+		static void SetReusePort(uv_udp_t* uvHandle, bool steering);
 		static void Unbind(Transport transport, std::string& ip, uint16_t port);
-		static std::vector<bool>& GetPorts(Transport transport, const std::string& ip);
+		static Ports& GetPorts(Transport transport, const std::string& ip);
+		static absl::flat_hash_map<std::string, Ports>& GetMapIpPorts(Transport transport);
+		static void FillJsonIpPorts(
+		  json& jsonObject, const absl::flat_hash_map<std::string, Ports>& mapIpPorts);
+		static void FillJsonIpPortsUsage(
+		  json& jsonObject, const absl::flat_hash_map<std::string, Ports>& mapIpPorts);
+		static void FillPools();
 
 	private:
-		thread_local static absl::flat_hash_map<std::string, std::vector<bool>> mapUdpIpPorts;
-		thread_local static absl::flat_hash_map<std::string, std::vector<bool>> mapTcpIpPorts;
+		thread_local static absl::flat_hash_map<std::string, Ports> mapUdpIpPorts;
+		thread_local static absl::flat_hash_map<std::string, Ports> mapTcpIpPorts;
+		thread_local static TimerListener poolTimerListener;
+		thread_local static Timer* poolTimer;
 	};
 } // namespace RTC
 
@@ -3,6 +3,7 @@
 
 #include "common.hpp"
 #include "Channel/ChannelRequest.hpp"
+#include "RTC/KeyFrameCache.hpp"
 #include "RTC/KeyFrameRequestManager.hpp"
 #include "RTC/RTCP/CompoundPacket.hpp"
 #include "RTC/RTCP/Packet.hpp"
@@ -11,7 +12,11 @@
 #include "RTC/RtpDictionaries.hpp"
 #include "RTC/RtpHeaderExtensionIds.hpp"
 #include "RTC/RtpPacket.hpp"
+#include "RTC/RtpReorderBuffer.hpp"
 #include "RTC/RtpStreamRecv.hpp"
+#include "RTC/StatsDelta.hpp"
+#include "RTC/TraceEventSampler.hpp"
+#include "RTC/TransportArena.hpp"
 #include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
@@ -20,7 +25,11 @@ using json = nlohmann::json;
 
 namespace RTC
 {
-	class Producer : public RTC::RtpStreamRecv::Listener, public RTC::KeyFrameRequestManager::Listener
+	// NOTE: Long lived object of a Transport so it uses its TransportArena.
+	class Producer : public RTC::TransportArena::Allocated,
+	                 public RTC::RtpStreamRecv::Listener,
+	                 public RTC::KeyFrameRequestManager::Listener,
+	                 public RTC::RtpReorderBuffer::Listener
 	{
 	public:
 		class Listener
@@ -71,7 +80,8 @@ namespace RTC
 		{
 			DISCARDED = 0,
 			MEDIA     = 1,
-			RETRANSMISSION
+			RETRANSMISSION,
+			FEC
 		};
 
 	private:
@@ -91,6 +101,8 @@ namespace RTC
 	public:
 		void FillJson(json& jsonObject) const;
 		void FillJsonStats(json& jsonArray) const;
+		void FillStatsRecords(
+		  StatsRegion* statsRegion, const std::string& transportId, uint64_t nowMs) const;
 		void HandleRequest(Channel::ChannelRequest* request);
 		RTC::Media::Kind GetKind() const
 		{
@@ -112,6 +124,25 @@ namespace RTC
 		{
 			return this->paused;
 		}
+		// Ids of the Routers this Producer's stream was relayed through (origin
+		// first). Empty unless it was piped from another Router.
+		const std::vector<std::string>& GetRelayPath() const
+		{
+			return this->relayPath;
+		}
+		bool IsInRelayPath(const std::string& routerId) const;
+		void SetKeyFrameRequestBudget(RTC::KeyFrameRequestScheduler::Budget* budget)
+		{
+			if (this->keyFrameRequestManager)
+				this->keyFrameRequestManager->SetKeyFrameRequestBudget(budget);
+		}
+		// Max time (in ms) media packets following a sequence number gap are
+		// held waiting for the missing ones (0 means disabled). It applies to
+		// streams created afterwards.
+		void SetRtpReorderDelay(uint32_t delay)
+		{
+			this->rtpReorderDelay = delay;
+		}
 		const absl::flat_hash_map<RTC::RtpStreamRecv*, uint32_t>& GetRtpStreams()
 		{
 			return this->mapRtpStreamMappedSsrc;
@@ -125,16 +156,25 @@ namespace RTC
 		void ReceiveRtcpXrDelaySinceLastRr(RTC::RTCP::DelaySinceLastRr::SsrcInfo* ssrcInfo);
 		void GetRtcp(RTC::RTCP::CompoundPacket* packet, uint64_t nowMs);
 		void RequestKeyFrame(uint32_t mappedSsrc);
+		RTC::KeyFrameCache* GetKeyFrameCache(uint32_t mappedSsrc) const;
+		// Approximate memory (in bytes) used by the NACK lists and key frame
+		// caches of the RTP streams.
+		size_t GetMemoryUsage() const;
 
 	private:
 		RTC::RtpStreamRecv* GetRtpStream(RTC::RtpPacket* packet);
 		RTC::RtpStreamRecv* CreateRtpStream(
 		  RTC::RtpPacket* packet, const RTC::RtpCodecParameters& mediaCodec, size_t encodingIdx);
 		void NotifyNewRtpStream(RTC::RtpStreamRecv* rtpStream);
+		void ReceiveFecPacket(RTC::RtpPacket* packet, RTC::RtpStreamRecv* rtpStream);
+		ReceiveRtpPacketResult ProcessRtpPacket(
+		  RTC::RtpPacket* packet, RTC::RtpStreamRecv* rtpStream, bool isNewRtpStream);
 		void PreProcessRtpPacket(RTC::RtpPacket* packet);
 		bool MangleRtpPacket(RTC::RtpPacket* packet, RTC::RtpStreamRecv* rtpStream) const;
+		bool MapRtpHeaderExtensions(RTC::RtpPacket* packet) const;
 		void PostProcessRtpPacket(RTC::RtpPacket* packet);
 		void EmitScore() const;
+		void EmitTraceEvent(json& data) const;
 		void EmitTraceEventRtpAndKeyFrameTypes(RTC::RtpPacket* packet, bool isRtx = false) const;
 		void EmitTraceEventKeyFrameType(RTC::RtpPacket* packet, bool isRtx = false) const;
 		void EmitTraceEventPliType(uint32_t ssrc) const;
@@ -152,9 +192,16 @@ namespace RTC
 	public:
 		void OnKeyFrameNeeded(RTC::KeyFrameRequestManager* keyFrameRequestManager, uint32_t ssrc) override;
 
+		/* Pure virtual methods inherited from RTC::RtpReorderBuffer::Listener. */
+	public:
+		void OnRtpReorderBufferPacket(
+		  RTC::RtpReorderBuffer* rtpReorderBuffer, RTC::RtpPacket* packet) override;
+
 	public:
 		// Passed by argument.
 		const std::string id;
+		// Numeric handle given by the parent container (see RTC::HandleTable).
+		uint32_t handle{ 0u };
 
 	private:
 		// Passed by argument.
@@ -162,6 +209,9 @@ namespace RTC
 		// Allocated by this.
 		absl::flat_hash_map<uint32_t, RTC::RtpStreamRecv*> mapSsrcRtpStream;
 		RTC::KeyFrameRequestManager* keyFrameRequestManager{ nullptr };
+		absl::flat_hash_map<RTC::RtpStreamRecv*, RTC::KeyFrameCache*> mapRtpStreamKeyFrameCache;
+		absl::flat_hash_map<RTC::RtpStreamRecv*, RTC::RtpReorderBuffer*> mapRtpStreamReorderBuffer;
+		RTC::TraceEventSampler* traceEventSampler{ nullptr };
 		// Others.
 		RTC::Media::Kind kind;
 		RTC::RtpParameters rtpParameters;
@@ -170,10 +220,18 @@ namespace RTC
 		std::vector<RTC::RtpStreamRecv*> rtpStreamByEncodingIdx;
 		std::vector<uint8_t> rtpStreamScores;
 		absl::flat_hash_map<uint32_t, RTC::RtpStreamRecv*> mapRtxSsrcRtpStream;
+		absl::flat_hash_map<uint32_t, RTC::RtpStreamRecv*> mapFecSsrcRtpStream;
 		absl::flat_hash_map<RTC::RtpStreamRecv*, uint32_t> mapRtpStreamMappedSsrc;
 		absl::flat_hash_map<uint32_t, uint32_t> mapMappedSsrcSsrc;
 		struct RTC::RtpHeaderExtensionIds rtpHeaderExtensionIds;
+		// Ids used within the Router for the header extensions kept in received
+		// packets, indexed by the (One-Byte) id negotiated by the Producer (0
+		// means the extension is dropped).
+		std::array<uint8_t, 15> mappedRtpHeaderExtensionIds{};
 		bool paused{ false };
+		std::vector<std::string> relayPath;
+		bool enableKeyFrameCache{ false };
+		uint32_t rtpReorderDelay{ 0u };
 		RTC::RtpPacket* currentRtpPacket{ nullptr };
 		// Timestamp when last RTCP was sent.
 		uint64_t lastRtcpSentTime{ 0u };
@@ -182,6 +240,11 @@ namespace RTC
 		bool videoOrientationDetected{ false };
 		struct VideoOrientation videoOrientation;
 		struct TraceEventTypes traceEventTypes;
+		RTC::StatsDelta statsDelta;
+		// Times (ms) at which the Producer was created and received its first RTP
+		// packet (0 if not yet).
+		uint64_t createdAtMs{ 0u };
+		uint64_t firstRtpReceivedAtMs{ 0u };
 	};
 } // namespace RTC
 
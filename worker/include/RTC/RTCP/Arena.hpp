@@ -0,0 +1,95 @@
+#ifndef MS_RTC_RTCP_ARENA_HPP
+#define MS_RTC_RTCP_ARENA_HPP
+
+#include "common.hpp"
+#include <cstddef> // std::max_align_t
+
+namespace RTC
+{
+	namespace RTCP
+	{
+		/**
+		 * Per thread bump arena for RTCP objects (packets, reports, chunks and
+		 * feedback items), so parsing a received compound packet or building the
+		 * ones sent on every RTCP tick does not hit the heap for every object.
+		 *
+		 * Objects are allocated in the arena only while an AllocationScope is
+		 * alive within a Scope (Packet::Parse() opens its own AllocationScope),
+		 * otherwise (or if the arena is full) the heap is used. Deleting an object
+		 * allocated in the arena runs its destructor but frees nothing, all its
+		 * memory is released at once when the Scope ends, so objects allocated in
+		 * it must not outlive it.
+		 *
+		 * Scopes may be nested (i.e. RTCP received from a local PipeTransport
+		 * while sending RTCP) and they do not inherit the AllocationScope of the
+		 * outer one.
+		 */
+		class Arena
+		{
+		public:
+			class Scope
+			{
+			public:
+				Scope();
+				~Scope();
+
+			private:
+				size_t mark{ 0u };
+				bool wasAllocating{ false };
+			};
+
+			class AllocationScope
+			{
+			public:
+				AllocationScope();
+				~AllocationScope();
+
+			private:
+				bool wasAllocating{ false };
+			};
+
+		public:
+			static void* Allocate(size_t size);
+			static void Free(void* ptr);
+			static bool Contains(const void* ptr)
+			{
+				auto* bytes = static_cast<const uint8_t*>(ptr);
+
+				return bytes >= Arena::buffer && bytes < Arena::buffer + Arena::Size;
+			}
+			// Bytes currently allocated in the arena.
+			static size_t GetUsedBytes()
+			{
+				return Arena::offset;
+			}
+
+		public:
+			static constexpr size_t Size{ 65536 };
+
+		private:
+			alignas(std::max_align_t) thread_local static uint8_t buffer[Size];
+			thread_local static size_t offset;
+			thread_local static size_t openScopes;
+			thread_local static bool allocating;
+		};
+
+		/**
+		 * Base of the RTCP classes allocated with new, so they are allocated in
+		 * the Arena when possible.
+		 */
+		class ArenaObject
+		{
+		public:
+			static void* operator new(size_t size)
+			{
+				return Arena::Allocate(size);
+			}
+			static void operator delete(void* ptr)
+			{
+				Arena::Free(ptr);
+			}
+		};
+	} // namespace RTCP
+} // namespace RTC
+
+#endif
@@ -13,7 +13,7 @@ namespace RTC
 {
 	namespace RTCP
 	{
-		class CompoundPacket
+		class CompoundPacket : public ArenaObject
 		{
 		public:
 			CompoundPacket() = default;
@@ -41,6 +41,9 @@ namespace RTC
 			void AddSdesChunk(SdesChunk* chunk);
 			void AddReceiverReferenceTime(ReceiverReferenceTime* report);
 			void AddDelaySinceLastRr(DelaySinceLastRr* report);
+			// Already serialized RTCP packets (not copied until Serialize() is
+			// called) to be appended after the reports.
+			void AddSerializedPackets(const uint8_t* data, size_t len);
 			bool HasSenderReport()
 			{
 				return this->senderReportPacket.Begin() != this->senderReportPacket.End();
@@ -62,6 +65,8 @@ namespace RTC
 			ReceiverReportPacket receiverReportPacket;
 			SdesPacket sdesPacket;
 			ExtendedReportPacket xrPacket;
+			const uint8_t* serializedPackets{ nullptr };
+			size_t serializedPacketsLen{ 0u };
 		};
 	} // namespace RTCP
 } // namespace RTC
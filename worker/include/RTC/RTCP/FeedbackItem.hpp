@@ -2,12 +2,13 @@
 #define MS_RTC_RTCP_FEEDBACK_ITEM_HPP
 
 #include "common.hpp"
+#include "RTC/RTCP/Arena.hpp"
 
 namespace RTC
 {
 	namespace RTCP
 	{
-		class FeedbackItem
+		class FeedbackItem : public ArenaObject
 		{
 		public:
 			template<typename Item>
@@ -52,6 +52,14 @@ namespace RTC
 			explicit FeedbackRtpEcnItem(FeedbackRtpEcnItem* item) : header(item->header)
 			{
 			}
+			FeedbackRtpEcnItem(
+			  uint32_t sequenceNumber,
+			  uint32_t ect0Counter,
+			  uint32_t ect1Counter,
+			  uint16_t ecnCeCounter,
+			  uint16_t notEctCounter,
+			  uint16_t lostPackets,
+			  uint16_t duplicatedPackets);
 			~FeedbackRtpEcnItem() override = default;
 
 			uint32_t GetSequenceNumber() const
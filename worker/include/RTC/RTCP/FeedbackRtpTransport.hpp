@@ -44,15 +44,16 @@ namespace RTC
 		public:
 			struct PacketResult
 			{
+				PacketResult() = default;
 				PacketResult(uint16_t sequenceNumber, bool received)
 				  : sequenceNumber(sequenceNumber), received(received)
 				{
 				}
 
-				uint16_t sequenceNumber;   // Wide sequence number.
-				int16_t delta{ 0 };        // Delta.
-				bool received{ false };    // Packet received or not.
-				int64_t receivedAtMs{ 0 }; // Received time (ms) in remote timestamp reference.
+				uint16_t sequenceNumber{ 0u }; // Wide sequence number.
+				int16_t delta{ 0 };            // Delta.
+				bool received{ false };        // Packet received or not.
+				int64_t receivedAtMs{ 0 };     // Received time (ms) in remote timestamp reference.
 			};
 
 		public:
@@ -78,113 +79,36 @@ namespace RTC
 			{
 				bool allSameStatus{ true };
 				Status currentStatus{ Status::None };
-				std::vector<Status> statuses;
+				// Statuses not represented by a chunk yet. Just the first 7 ones are
+				// stored since more are only possible if all of them are the same.
+				Status statuses[7];
+				uint16_t statusCount{ 0u };
 			};
 
-		private:
-			class Chunk
-			{
-			public:
-				static Chunk* Parse(const uint8_t* data, size_t len, uint16_t count);
-
-			public:
-				Chunk()          = default;
-				virtual ~Chunk() = default;
-
-				virtual bool AddDeltas(
-				  const uint8_t* data, size_t len, std::vector<int16_t>& deltas, size_t& offset) = 0;
-				virtual void Dump() const                                                        = 0;
-				virtual uint16_t GetCount() const                                                = 0;
-				virtual uint16_t GetReceivedStatusCount() const                                  = 0;
-				virtual void FillResults(
-				  std::vector<struct PacketResult>& packetResults, uint16_t& currentSequenceNumber) const = 0;
-				virtual size_t Serialize(uint8_t* buffer) = 0;
-			};
-
-		private:
-			class RunLengthChunk : public Chunk
-			{
-			public:
-				RunLengthChunk(Status status, uint16_t count) : status(status), count(count)
-				{
-				}
-				explicit RunLengthChunk(uint16_t buffer);
-
-			public:
-				bool AddDeltas(
-				  const uint8_t* data, size_t len, std::vector<int16_t>& deltas, size_t& offset) override;
-				Status GetStatus() const
-				{
-					return this->status;
-				}
-				void Dump() const override;
-				uint16_t GetCount() const override
-				{
-					return this->count;
-				}
-				uint16_t GetReceivedStatusCount() const override;
-				void FillResults(
-				  std::vector<struct PacketResult>& packetResults,
-				  uint16_t& currentSequenceNumber) const override;
-				size_t Serialize(uint8_t* buffer) override;
-
-			private:
-				Status status{ Status::None };
-				uint16_t count{ 0u };
-			};
-
-		private:
-			class OneBitVectorChunk : public Chunk
-			{
-			public:
-				explicit OneBitVectorChunk(const std::vector<Status>& statuses) : statuses(statuses)
-				{
-				}
-				OneBitVectorChunk(uint16_t buffer, uint16_t count);
-
-			public:
-				bool AddDeltas(
-				  const uint8_t* data, size_t len, std::vector<int16_t>& deltas, size_t& offset) override;
-				void Dump() const override;
-				uint16_t GetCount() const override
-				{
-					return this->statuses.size();
-				}
-				uint16_t GetReceivedStatusCount() const override;
-				void FillResults(
-				  std::vector<struct PacketResult>& packetResults,
-				  uint16_t& currentSequenceNumber) const override;
-				size_t Serialize(uint8_t* buffer) override;
-
-			private:
-				std::vector<Status> statuses;
-			};
-
-		private:
-			class TwoBitVectorChunk : public Chunk
+		public:
+			/**
+			 * Reads the packet results one by one straight from the serialized
+			 * chunks and deltas, without allocating them.
+			 */
+			class PacketResultsReader
 			{
 			public:
-				explicit TwoBitVectorChunk(const std::vector<Status>& statuses) : statuses(statuses)
-				{
-				}
-				TwoBitVectorChunk(uint16_t buffer, uint16_t count);
+				explicit PacketResultsReader(const FeedbackRtpTransportPacket* packet);
 
 			public:
-				bool AddDeltas(
-				  const uint8_t* data, size_t len, std::vector<int16_t>& deltas, size_t& offset) override;
-				void Dump() const override;
-				uint16_t GetCount() const override
-				{
-					return this->statuses.size();
-				}
-				uint16_t GetReceivedStatusCount() const override;
-				void FillResults(
-				  std::vector<struct PacketResult>& packetResults,
-				  uint16_t& currentSequenceNumber) const override;
-				size_t Serialize(uint8_t* buffer) override;
+				// Returns false once all the packet results have been read.
+				bool Read(PacketResult& packetResult);
 
 			private:
-				std::vector<Status> statuses;
+				const FeedbackRtpTransportPacket* packet{ nullptr };
+				size_t chunksOffset{ 0u };
+				size_t deltasOffset{ 0u };
+				uint16_t chunk{ 0u };
+				uint16_t chunkSymbolIdx{ 0u };
+				uint16_t chunkSymbolCount{ 0u };
+				uint16_t pendingStatusCount{ 0u };
+				uint16_t currentSequenceNumber{ 0u };
+				int64_t currentReceivedAtMs{ 0 };
 			};
 
 		public:
@@ -192,12 +116,16 @@ namespace RTC
 			static uint16_t maxMissingPackets;
 			static uint16_t maxPacketStatusCount;
 			static int16_t maxPacketDelta;
+			// Max size of locally generated packets.
+			static constexpr size_t MaxSize{ 1500u };
 
 		public:
 			static FeedbackRtpTransportPacket* Parse(const uint8_t* data, size_t len);
 
 		private:
 			static absl::flat_hash_map<Status, std::string> status2String;
+			static Status GetChunkStatus(uint16_t chunk, uint16_t symbolIdx);
+			static uint16_t GetChunkSymbolCount(uint16_t chunk);
 
 		public:
 			FeedbackRtpTransportPacket(uint32_t senderSsrc, uint32_t mediaSsrc)
@@ -205,11 +133,14 @@ namespace RTC
 			{
 			}
 			FeedbackRtpTransportPacket(CommonHeader* commonHeader, size_t availableLen);
-			~FeedbackRtpTransportPacket();
+			~FeedbackRtpTransportPacket() = default;
 
 		public:
 			AddPacketResult AddPacket(uint16_t sequenceNumber, uint64_t timestamp, size_t maxRtcpPacketLen);
 			void Finish(); // Just for locally generated packets.
+			// Makes a locally generated packet empty so it can be reused. SSRCs and
+			// feedback packet count are kept.
+			void Reset();
 			bool IsFull()
 			{
 				// NOTE: Since AddPendingChunks() is called at the end, we cannot track
@@ -219,7 +150,7 @@ namespace RTC
 			}
 			bool IsSerializable() const
 			{
-				return this->deltas.size() > 0;
+				return this->deltaCount > 0;
 			}
 			bool IsCorrect() const // Just for locally generated packets.
 			{
@@ -233,6 +164,11 @@ namespace RTC
 			{
 				return this->packetStatusCount;
 			}
+			// Number of packets reported as received in the packet status count.
+			uint16_t GetReceivedStatusCount() const
+			{
+				return this->receivedStatusCount;
+			}
 			int32_t GetReferenceTime() const
 			{
 				return this->referenceTime;
@@ -273,7 +209,7 @@ namespace RTC
 				size_t size = FeedbackRtpPacket::GetSize();
 
 				size += FeedbackRtpTransportPacket::fixedHeaderSize;
-				size += this->deltasAndChunksSize;
+				size += this->chunksLen + this->deltasLen;
 
 				// 32 bits padding.
 				size += (-size) & 3;
@@ -282,10 +218,19 @@ namespace RTC
 			}
 
 		private:
+			// Chunks and deltas point to the parsed packet or, for locally generated
+			// packets, to the buffers of this instance.
+			const uint8_t* GetChunks() const
+			{
+				return this->parsedChunks ? this->parsedChunks : this->chunksBuffer;
+			}
+			const uint8_t* GetDeltas() const
+			{
+				return this->parsedDeltas ? this->parsedDeltas : this->deltasBuffer;
+			}
 			void FillChunk(uint16_t previousSequenceNumber, uint16_t sequenceNumber, int16_t delta);
 			void CreateRunLengthChunk(Status status, uint16_t count);
-			void CreateOneBitVectorChunk(std::vector<Status>& statuses);
-			void CreateTwoBitVectorChunk(std::vector<Status>& statuses);
+			void CreateTwoBitVectorChunk(const Status* statuses, uint16_t count);
 			void AddPendingChunks();
 
 		private:
@@ -294,13 +239,19 @@ namespace RTC
 			uint16_t latestSequenceNumber{ 0u }; // Just for locally generated packets.
 			uint64_t latestTimestamp{ 0u };      // Just for locally generated packets.
 			uint16_t packetStatusCount{ 0u };
+			uint16_t receivedStatusCount{ 0u };
 			uint8_t feedbackPacketCount{ 0u };
-			std::vector<Chunk*> chunks;
-			std::vector<int16_t> deltas;
+			const uint8_t* parsedChunks{ nullptr };
+			const uint8_t* parsedDeltas{ nullptr };
+			size_t chunksLen{ 0u };
+			size_t deltasLen{ 0u };
+			size_t deltaCount{ 0u };
 			Context context; // Just for locally generated packets.
-			size_t deltasAndChunksSize{ 0u };
 			size_t size{ 0 };
 			bool isCorrect{ true };
+			// Serialized chunks and deltas of locally generated packets.
+			uint8_t chunksBuffer[MaxSize];
+			uint8_t deltasBuffer[MaxSize];
 		};
 	} // namespace RTCP
 } // namespace RTC
@@ -2,6 +2,7 @@
 #define MS_RTC_RTCP_PACKET_HPP
 
 #include "common.hpp"
+#include "RTC/RTCP/Arena.hpp"
 #include <absl/container/flat_hash_map.h>
 #include <string>
 
@@ -16,6 +17,8 @@ namespace RTC
 		// Maximum interval for regular RTCP mode.
 		constexpr uint16_t MaxAudioIntervalMs{ 5000 };
 		constexpr uint16_t MaxVideoIntervalMs{ 1000 };
+		// Maximum interval between SDES CNAME items in reduced-size RTCP mode.
+		constexpr uint16_t MaxReducedSizeSdesIntervalMs{ 5000 };
 
 		enum class Type : uint8_t
 		{
@@ -29,7 +32,7 @@ namespace RTC
 			XR    = 207
 		};
 
-		class Packet
+		class Packet : public ArenaObject
 		{
 		public:
 			/* Struct for RTCP common header. */
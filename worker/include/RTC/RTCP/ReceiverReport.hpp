@@ -10,7 +10,7 @@ namespace RTC
 {
 	namespace RTCP
 	{
-		class ReceiverReport
+		class ReceiverReport : public ArenaObject
 		{
 		public:
 			/* Struct for RTCP receiver report. */
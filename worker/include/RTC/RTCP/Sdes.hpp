@@ -11,7 +11,7 @@ namespace RTC
 	namespace RTCP
 	{
 		/* SDES Item. */
-		class SdesItem
+		class SdesItem : public ArenaObject
 		{
 		public:
 			enum class Type : uint8_t
@@ -79,7 +79,7 @@ namespace RTC
 			static absl::flat_hash_map<SdesItem::Type, std::string> type2String;
 		};
 
-		class SdesChunk
+		class SdesChunk : public ArenaObject
 		{
 		public:
 			using Iterator = std::vector<SdesItem*>::iterator;
@@ -9,7 +9,7 @@ namespace RTC
 {
 	namespace RTCP
 	{
-		class SenderReport
+		class SenderReport : public ArenaObject
 		{
 		public:
 			/* Struct for RTCP sender report. */
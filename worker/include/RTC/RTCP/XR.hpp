@@ -22,7 +22,7 @@ namespace RTC
 {
 	namespace RTCP
 	{
-		class ExtendedReportBlock
+		class ExtendedReportBlock : public ArenaObject
 		{
 		public:
 			enum class Type : uint8_t
@@ -33,7 +33,7 @@ namespace RTC
 			static DelaySinceLastRr* Parse(const uint8_t* data, size_t len);
 
 		public:
-			class SsrcInfo
+			class SsrcInfo : public ArenaObject
 			{
 			public:
 				static const size_t BodySize{ 12 };
@@ -9,6 +9,12 @@ namespace RTC
 {
 	// It is considered that the time source increases monotonically.
 	// ie: the current timestamp can never be minor than a timestamp in the past.
+	//
+	// Items are kept in a ring buffer along with the running sum of their counts
+	// so both Update() and GetRate() are O(1) amortised. Item start times are
+	// stored in 32 bits (they are only compared within the time window). The
+	// buffer is allocated on the first Update() since many calculators (i.e.
+	// those of RTX or probation) never get any data.
 	class RateCalculator
 	{
 	public:
@@ -24,7 +30,6 @@ namespace RTC
 		  : windowSizeMs(windowSizeMs), scale(scale), windowItems(windowItems)
 		{
 			this->itemSizeMs = std::max(windowSizeMs / windowItems, static_cast<size_t>(1));
-			this->buffer.resize(windowItems);
 		}
 		void Update(size_t size, uint64_t nowMs);
 		uint32_t GetRate(uint64_t nowMs);
@@ -32,28 +37,29 @@ namespace RTC
 		{
 			return this->bytes;
 		}
+		// Heap memory (in bytes) used by the buffer.
+		size_t GetMemoryUsage() const
+		{
+			return this->buffer.capacity() * sizeof(BufferItem);
+		}
 
 	private:
 		void RemoveOldData(uint64_t nowMs);
 		void Reset()
 		{
-			std::memset(
-			  static_cast<void*>(&this->buffer.front()), 0, sizeof(BufferItem) * this->buffer.size());
-
-			this->newestItemStartTime = 0u;
-			this->newestItemIndex     = -1;
-			this->oldestItemStartTime = 0u;
-			this->oldestItemIndex     = -1;
-			this->totalCount          = 0u;
-			this->lastRate            = 0u;
-			this->lastTime            = 0u;
+			this->oldestItemIndex = 0u;
+			this->usedItems       = 0u;
+			this->totalCount      = 0u;
+			this->lastRate        = 0u;
+			this->lastTime        = 0u;
 		}
 
 	private:
 		struct BufferItem
 		{
-			size_t count{ 0u };
-			uint64_t time{ 0u };
+			uint32_t count{ 0u };
+			// Lower 32 bits of the item start time (in milliseconds).
+			uint32_t time{ 0u };
 		};
 
 	private:
@@ -65,16 +71,14 @@ namespace RTC
 		uint16_t windowItems{ DefaultWindowItems };
 		// Item Size (in milliseconds), calculated as: windowSizeMs / windowItems.
 		size_t itemSizeMs{ 0u };
-		// Buffer to keep data.
+		// Ring buffer to keep data.
 		std::vector<BufferItem> buffer;
-		// Time (in milliseconds) for last item in the time window.
-		uint64_t newestItemStartTime{ 0u };
-		// Index for the last item in the time window.
-		int32_t newestItemIndex{ -1 };
-		// Time (in milliseconds) for oldest item in the time window.
-		uint64_t oldestItemStartTime{ 0u };
 		// Index for the oldest item in the time window.
-		int32_t oldestItemIndex{ -1 };
+		uint16_t oldestItemIndex{ 0u };
+		// Number of items in the time window.
+		uint16_t usedItems{ 0u };
+		// Time (in milliseconds) for newest item in the time window.
+		uint64_t newestItemStartTime{ 0u };
 		// Total count in the time window.
 		size_t totalCount{ 0u };
 		// Total bytes transmitted.
@@ -106,6 +110,10 @@ namespace RTC
 		{
 			return this->rate.GetBytes();
 		}
+		size_t GetMemoryUsage() const
+		{
+			return this->rate.GetMemoryUsage();
+		}
 
 	private:
 		RateCalculator rate;
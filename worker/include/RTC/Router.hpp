@@ -5,31 +5,99 @@
 #include "Channel/ChannelRequest.hpp"
 #include "PayloadChannel/Notification.hpp"
 #include "PayloadChannel/PayloadChannelRequest.hpp"
+#include "RTC/AudioLastNSelector.hpp"
+#include "RTC/AudioMixer.hpp"
 #include "RTC/Consumer.hpp"
 #include "RTC/DataConsumer.hpp"
 #include "RTC/DataProducer.hpp"
+#include "RTC/HandleTable.hpp"
 #include "RTC/Producer.hpp"
 #include "RTC/RtpObserver.hpp"
 #include "RTC/RtpPacket.hpp"
 #include "RTC/RtpStream.hpp"
 #include "RTC/Transport.hpp"
+#include "RTC/VideoLastNPolicy.hpp"
+#include "RTC/WebRtcServer.hpp"
+#include "handles/Timer.hpp"
 #include <absl/container/flat_hash_map.h>
+#include <memory> // std::shared_ptr, std::weak_ptr
 #include <nlohmann/json.hpp>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 using json = nlohmann::json;
 
 namespace RTC
 {
-	class Router : public RTC::Transport::Listener
+	class Router : public RTC::Transport::Listener,
+	               public RTC::VideoLastNPolicy::Listener,
+	               public RTC::AudioMixer::Listener,
+	               public Timer::Listener
 	{
+	private:
+		/**
+		 * Consumer of a Producer as stored in its fan-out vector, with what is
+		 * needed to forward RTP packets to it inline so inactive Consumers are
+		 * skipped without touching them. The MID is empty if it must not be
+		 * written.
+		 */
+		struct FanOutConsumer
+		{
+			RTC::Consumer* consumer{ nullptr };
+			RTC::Transport* transport{ nullptr };
+			RTC::RtpParameters::Type type{ RTC::RtpParameters::Type::NONE };
+			// Value of RTC::Consumer::IsActive().
+			bool active{ false };
+			uint8_t midLength{ 0u };
+			char mid[RTC::MidMaxLength];
+		};
+
+		/**
+		 * Consumers of a Producer. Active ones go first so RTP packets are just
+		 * forwarded walking them, while inactive ones (f.e. most of them in last
+		 * N rooms) stay parked at the end with no per packet cost. Both sets are
+		 * kept grouped by Consumer type, MID and Transport.
+		 *
+		 * Entries are sorted again before forwarding the next RTP packet once
+		 * marked as dirty, so Consumers can change their active state while
+		 * the vector is being iterated.
+		 */
+		struct FanOut
+		{
+			std::vector<FanOutConsumer> consumers;
+			size_t numActive{ 0u };
+			bool dirty{ false };
+		};
+
 	public:
-		explicit Router(const std::string& id);
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			virtual RTC::WebRtcServer* OnRouterNeedWebRtcServer(
+			  RTC::Router* router, std::string& webRtcServerId) = 0;
+		};
+
+	public:
+		Router(Listener* listener, const std::string& id, json& data);
 		virtual ~Router();
 
 	public:
-		void FillJson(json& jsonObject) const;
+		// A pageSize of 0 means no pagination.
+		void FillJson(Channel::ChannelMessageWriter& writer, size_t page, size_t pageSize) const;
+		// Dump with the full state of the Transports.
+		void FillJsonState(json& jsonObject) const;
+		void FillStatsRecords(StatsRegion* statsRegion, uint64_t nowMs) const;
+		void SetOverloadLevel(OverloadController::Level level);
+		// Fills the approximate memory used by the Transports and returns the
+		// total (in bytes).
+		size_t FillJsonMemoryUsage(json& jsonObject) const;
+		size_t GetMemoryUsage() const;
+		// CPU time (in ms) spent per second on the media of the Transports.
+		double GetCpuMsPerSecond() const;
 		void HandleRequest(Channel::ChannelRequest* request);
 		void HandleRequest(PayloadChannel::PayloadChannelRequest* request);
 		void HandleNotification(PayloadChannel::Notification* notification);
@@ -37,9 +105,20 @@ namespace RTC
 	private:
 		void SetNewTransportIdFromInternal(json& internal, std::string& transportId) const;
 		RTC::Transport* GetTransportFromInternal(json& internal) const;
+		// Closes the given Transports at once and returns the number of closed
+		// Consumers.
+		size_t CloseTransports(const std::vector<RTC::Transport*>& transports);
 		void SetNewRtpObserverIdFromInternal(json& internal, std::string& rtpObserverId) const;
 		RTC::RtpObserver* GetRtpObserverFromInternal(json& internal) const;
 		RTC::Producer* GetProducerFromData(json& data) const;
+		std::vector<RTC::Producer*> GetVideoProducersFromData(json& data) const;
+		std::shared_ptr<RTC::ConsumerGroup> GetConsumerGroup(RTC::Producer* producer, const std::string& key);
+		void CheckMemoryUsage();
+		// Notifies the max layers wanted by the Consumers of the given Producer if
+		// they changed.
+		void UpdateProducerLayerDemand(RTC::Producer* producer);
+		// Moves active Consumers first and parks inactive ones.
+		void SortFanOut(FanOut& fanOut);
 
 		/* Pure virtual methods inherited from RTC::Transport::Listener. */
 	public:
@@ -71,6 +150,9 @@ namespace RTC
 		  RTC::Transport* transport, RTC::Consumer* consumer, std::string& producerId) override;
 		void OnTransportConsumerClosed(RTC::Transport* transport, RTC::Consumer* consumer) override;
 		void OnTransportConsumerProducerClosed(RTC::Transport* transport, RTC::Consumer* consumer) override;
+		void OnTransportConsumerActiveChanged(RTC::Transport* transport, RTC::Consumer* consumer) override;
+		void OnTransportConsumerPreferredLayersChanged(
+		  RTC::Transport* transport, RTC::Consumer* consumer) override;
 		void OnTransportConsumerKeyFrameRequested(
 		  RTC::Transport* transport, RTC::Consumer* consumer, uint32_t mappedSsrc) override;
 		void OnTransportNewDataProducer(RTC::Transport* transport, RTC::DataProducer* dataProducer) override;
@@ -86,20 +168,57 @@ namespace RTC
 		void OnTransportDataConsumerClosed(RTC::Transport* transport, RTC::DataConsumer* dataConsumer) override;
 		void OnTransportDataConsumerDataProducerClosed(
 		  RTC::Transport* transport, RTC::DataConsumer* dataConsumer) override;
+		void OnTransportListenServerClosed(RTC::Transport* transport) override;
+		RTC::KeyFrameRequestScheduler::Budget* OnTransportNeedKeyFrameRequestBudget(
+		  RTC::Transport* transport) override;
+
+		/* Pure virtual methods inherited from RTC::VideoLastNPolicy::Listener. */
+	public:
+		void OnVideoLastNPolicyProducerSelected(
+		  RTC::VideoLastNPolicy* policy, RTC::Producer* videoProducer, bool selected) override;
+
+		/* Pure virtual methods inherited from RTC::AudioMixer::Listener. */
+	public:
+		void OnAudioMixerRtpPacket(RTC::AudioMixer* audioMixer, RTC::RtpPacket* packet) override;
+
+		/* Pure virtual methods inherited from Timer::Listener. */
+	public:
+		void OnTimer(Timer* timer) override;
 
 	public:
 		// Passed by argument.
 		const std::string id;
+		// Numeric handle given by the parent container (see RTC::HandleTable).
+		uint32_t handle{ 0u };
 
 	private:
+		// Passed by argument.
+		Listener* listener{ nullptr };
 		// Allocated by this.
 		absl::flat_hash_map<std::string, RTC::Transport*> mapTransports;
+		RTC::HandleTable<RTC::Transport> transportHandles;
 		absl::flat_hash_map<std::string, RTC::RtpObserver*> mapRtpObservers;
+		RTC::AudioLastNSelector* audioLastNSelector{ nullptr };
+		Timer* memoryCheckTimer{ nullptr };
+		RTC::KeyFrameRequestScheduler::Budget* keyFrameRequestBudget{ nullptr };
 		// Others.
-		absl::flat_hash_map<RTC::Producer*, absl::flat_hash_set<RTC::Consumer*>> mapProducerConsumers;
+		// Memory (in bytes) above which retransmission buffers are shrunk (0
+		// means no limit).
+		size_t memorySoftLimit{ 0u };
+		bool memoryPressure{ false };
+		absl::flat_hash_map<RTC::Producer*, FanOut> mapProducerConsumers;
 		absl::flat_hash_map<RTC::Consumer*, RTC::Producer*> mapConsumerProducer;
+		// Owned by their member Consumers.
+		absl::flat_hash_map<RTC::Producer*, std::vector<std::weak_ptr<RTC::ConsumerGroup>>>
+		  mapProducerConsumerGroups;
 		absl::flat_hash_map<RTC::Producer*, absl::flat_hash_set<RTC::RtpObserver*>> mapProducerRtpObservers;
 		absl::flat_hash_map<std::string, RTC::Producer*> mapProducers;
+		// Video last N policies of ActiveSpeakerObservers and video Producers whose
+		// Consumers are paused by them.
+		absl::flat_hash_map<RTC::RtpObserver*, RTC::VideoLastNPolicy*> mapRtpObserverVideoLastNPolicy;
+		absl::flat_hash_set<RTC::Producer*> lastNPausedProducers;
+		// Max layers wanted by the Consumers of each Producer, as last notified.
+		absl::flat_hash_map<RTC::Producer*, RTC::Consumer::Layers> mapProducerLayerDemands;
 		absl::flat_hash_map<RTC::DataProducer*, absl::flat_hash_set<RTC::DataConsumer*>>
 		  mapDataProducerDataConsumers;
 		absl::flat_hash_map<RTC::DataConsumer*, RTC::DataProducer*> mapDataConsumerDataProducer;
@@ -0,0 +1,77 @@
+#ifndef MS_RTC_RTCP_SCHEDULER_HPP
+#define MS_RTC_RTCP_SCHEDULER_HPP
+
+#include "common.hpp"
+#include "handles/Timer.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <map>
+
+namespace RTC
+{
+	/**
+	 * Per thread (so per worker) scheduler of periodic RTCP generation. Instead
+	 * of each Transport running its own RTCP timer, Transports register here
+	 * the (already randomized) delay of their next RTCP round, which is rounded
+	 * up to a time slot of SlotMs. All the Transports due in the same slot are
+	 * notified in a single pass driven by a single Timer, so the RTCP packets
+	 * they generate leave through the batched egress path of the sockets at
+	 * once.
+	 */
+	class RtcpScheduler
+	{
+	public:
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			virtual void OnRtcpSchedulerSendRtcp(uint64_t nowMs) = 0;
+		};
+
+	private:
+		class TimerListener : public Timer::Listener
+		{
+			/* Pure virtual methods inherited from Timer::Listener. */
+		public:
+			void OnTimer(Timer* timer) override;
+		};
+
+	public:
+		// Duration of a time slot (in ms).
+		static constexpr uint64_t SlotMs{ 20u };
+
+	public:
+		static void ClassDestroy();
+		static void Schedule(Listener* listener, uint64_t delayMs);
+		static void Unschedule(Listener* listener);
+		static bool IsScheduled(Listener* listener)
+		{
+			return RtcpScheduler::listenerSlots.find(listener) !=
+			       RtcpScheduler::listenerSlots.end();
+		}
+		static size_t GetNumScheduled()
+		{
+			return RtcpScheduler::listenerSlots.size();
+		}
+		static uint64_t GetNumPasses()
+		{
+			return RtcpScheduler::numPasses;
+		}
+
+	private:
+		static void Arm();
+		static void OnTimer();
+
+	private:
+		thread_local static TimerListener timerListener;
+		thread_local static Timer* timer;
+		// Listeners indexed by the slot in which they are due.
+		thread_local static std::map<uint64_t, absl::flat_hash_set<Listener*>> slots;
+		thread_local static absl::flat_hash_map<Listener*, uint64_t> listenerSlots;
+		thread_local static uint64_t numPasses;
+	};
+} // namespace RTC
+
+#endif
@@ -63,6 +63,7 @@ namespace RTC
 			H264_SVC,
 			X_H264UC,
 			H265,
+			AV1,
 			// Complementary codecs:
 			CN = 300,
 			TELEPHONE_EVENT,
@@ -71,6 +72,7 @@ namespace RTC
 			ULPFEC,
 			X_ULPFECUC,
 			FLEXFEC,
+			FLEXFEC_03,
 			RED
 		};
 
@@ -138,6 +140,7 @@ namespace RTC
 			TRANSPORT_WIDE_CC_01   = 5,
 			FRAME_MARKING_07       = 6, // NOTE: Remove once RFC.
 			FRAME_MARKING          = 7,
+			DEPENDENCY_DESCRIPTOR  = 8,
 			SSRC_AUDIO_LEVEL       = 10,
 			VIDEO_ORIENTATION      = 11,
 			TOFFSET                = 12,
@@ -196,6 +199,18 @@ namespace RTC
 		uint32_t ssrc{ 0u };
 	};
 
+	class RtpFecParameters
+	{
+	public:
+		RtpFecParameters() = default;
+		explicit RtpFecParameters(json& data);
+
+		void FillJson(json& jsonObject) const;
+
+	public:
+		uint32_t ssrc{ 0u };
+	};
+
 	class RtpEncodingParameters
 	{
 	public:
@@ -211,6 +226,8 @@ namespace RTC
 		bool hasCodecPayloadType{ false };
 		RtpRtxParameters rtx;
 		bool hasRtx{ false };
+		RtpFecParameters fec;
+		bool hasFec{ false };
 		uint32_t maxBitrate{ 0u };
 		double maxFramerate{ 0 };
 		bool dtx{ false };
@@ -279,6 +296,10 @@ namespace RTC
 		void FillJson(json& jsonObject) const;
 		const RTC::RtpCodecParameters* GetCodecForEncoding(RtpEncodingParameters& encoding) const;
 		const RTC::RtpCodecParameters* GetRtxCodecForEncoding(RtpEncodingParameters& encoding) const;
+		const RTC::RtpCodecParameters* GetFecCodec() const;
+		// Heap memory (in bytes) used by these parameters.
+		size_t GetMemoryUsage() const;
+		static size_t GetMemoryUsage(const std::vector<RtpEncodingParameters>& encodings);
 
 	private:
 		void ValidateCodecs();
@@ -19,6 +19,7 @@ namespace RTC
 		uint8_t videoOrientation{ 0u };
 		uint8_t toffset{ 0u };
 		uint8_t absCaptureTime{ 0u };
+		uint8_t dependencyDescriptor{ 0u };
 	};
 } // namespace RTC
 
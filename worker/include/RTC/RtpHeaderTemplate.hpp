@@ -0,0 +1,65 @@
+#ifndef MS_RTC_RTP_HEADER_TEMPLATE_HPP
+#define MS_RTC_RTP_HEADER_TEMPLATE_HPP
+
+#include "common.hpp"
+#include "RTC/RtpPacket.hpp"
+
+namespace RTC
+{
+	/**
+	 * Fixed RTP header fields of the stream sent by a Consumer, kept in network
+	 * byte order. Rewriting the header of a forwarded packet is a copy of its
+	 * 12 bytes (to restore them later) plus a store per rewritten field, and
+	 * restoring it is a single 12 bytes copy.
+	 *
+	 * NOTE: Header extension ids are already mapped by the Producer, so they are
+	 * the same for every Consumer and are not part of the template.
+	 */
+	class RtpHeaderTemplate
+	{
+	public:
+		using SavedHeader = RTC::RtpPacket::Header;
+
+		static_assert(
+		  sizeof(SavedHeader) == RTC::RtpPacket::HeaderSize, "unexpected size of the RTP fixed header");
+
+	public:
+		static void Restore(RTC::RtpPacket* packet, const SavedHeader& saved)
+		{
+			*packet->GetFixedHeader() = saved;
+		}
+
+	public:
+		void SetSsrc(uint32_t ssrc)
+		{
+			this->ssrc = uint32_t{ htonl(ssrc) };
+		}
+		// Rewrites SSRC and sequence number, saving the original header.
+		void Apply(RTC::RtpPacket* packet, uint16_t seq, SavedHeader& saved) const
+		{
+			auto* header = packet->GetFixedHeader();
+
+			saved = *header;
+
+			header->sequenceNumber = uint16_t{ htons(seq) };
+			header->ssrc           = this->ssrc;
+		}
+		// Rewrites SSRC, sequence number and timestamp, saving the original header.
+		void Apply(RTC::RtpPacket* packet, uint16_t seq, uint32_t timestamp, SavedHeader& saved) const
+		{
+			auto* header = packet->GetFixedHeader();
+
+			saved = *header;
+
+			header->sequenceNumber = uint16_t{ htons(seq) };
+			header->timestamp      = uint32_t{ htonl(timestamp) };
+			header->ssrc           = this->ssrc;
+		}
+
+	private:
+		// In network byte order.
+		uint32_t ssrc{ 0u };
+	};
+} // namespace RTC
+
+#endif
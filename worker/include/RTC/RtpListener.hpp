@@ -4,9 +4,10 @@
 #include "common.hpp"
 #include "RTC/Producer.hpp"
 #include "RTC/RtpPacket.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <array>
 #include <nlohmann/json.hpp>
 #include <string>
-#include <unordered_map>
 
 using json = nlohmann::json;
 
@@ -14,6 +15,35 @@ namespace RTC
 {
 	class RtpListener
 	{
+	private:
+		struct CachedSsrc
+		{
+			uint32_t ssrc{ 0u };
+			RTC::Producer* producer{ nullptr };
+		};
+
+		struct UnknownSsrc
+		{
+			uint32_t ssrc{ 0u };
+			bool valid{ false };
+		};
+
+		// Number of lookups resolved by each step of GetProducer(packet).
+		struct LookupStats
+		{
+			uint64_t ssrcCacheHits{ 0u };
+			uint64_t ssrcTableHits{ 0u };
+			uint64_t midRidHits{ 0u };
+			uint64_t unknownSsrcCacheHits{ 0u };
+			uint64_t misses{ 0u };
+		};
+
+	public:
+		// Must be a power of 2.
+		static constexpr size_t SsrcCacheSize{ 8u };
+		// Must be a power of 2.
+		static constexpr size_t UnknownSsrcCacheSize{ 16u };
+
 	public:
 		void FillJson(json& jsonObject) const;
 		void AddProducer(RTC::Producer* producer);
@@ -23,11 +53,39 @@ namespace RTC
 
 	public:
 		// Table of SSRC / Producer pairs.
-		std::unordered_map<uint32_t, RTC::Producer*> ssrcTable;
-		//  Table of MID / Producer pairs.
-		std::unordered_map<std::string, RTC::Producer*> midTable;
-		//  Table of RID / Producer pairs.
-		std::unordered_map<std::string, RTC::Producer*> ridTable;
+		absl::flat_hash_map<uint32_t, RTC::Producer*> ssrcTable;
+		// Table of MID / Producer pairs. Being its hash transparent, it can be
+		// looked up with the MID bytes in the packet without copying them.
+		absl::flat_hash_map<std::string, RTC::Producer*> midTable;
+		// Table of RID / Producer pairs. Same as above.
+		absl::flat_hash_map<std::string, RTC::Producer*> ridTable;
+
+	private:
+		void CacheSsrc(uint32_t ssrc, RTC::Producer* producer)
+		{
+			this->ssrcCache[ssrc & (SsrcCacheSize - 1)] = { ssrc, producer };
+		}
+		void CacheUnknownSsrc(uint32_t ssrc)
+		{
+			this->unknownSsrcCache[ssrc & (UnknownSsrcCacheSize - 1)] = { ssrc, true };
+		}
+		bool IsUnknownSsrcCached(uint32_t ssrc) const
+		{
+			const auto& unknownSsrc = this->unknownSsrcCache[ssrc & (UnknownSsrcCacheSize - 1)];
+
+			return unknownSsrc.valid && unknownSsrc.ssrc == ssrc;
+		}
+
+	private:
+		// Direct mapped cache of the SSRC table (indexed by the lowest bits of
+		// the SSRC), so most received packets skip the hash table lookup.
+		std::array<CachedSsrc, SsrcCacheSize> ssrcCache{};
+		// Direct mapped cache of SSRCs whose MID or RID matched no Producer, so
+		// packets of streams whose Producer does not exist yet (as it happens when
+		// many endpoints join at once) skip the MID and RID lookups. Cleared when
+		// a Producer is added.
+		std::array<UnknownSsrc, UnknownSsrcCacheSize> unknownSsrcCache{};
+		LookupStats lookupStats;
 	};
 } // namespace RTC
 
@@ -4,8 +4,10 @@
 #include "common.hpp"
 #include "Utils.hpp"
 #include "RTC/Codecs/PayloadDescriptorHandler.hpp"
-#include <absl/container/flat_hash_map.h>
+#include "RTC/ObjectPool.hpp"
+#include <absl/strings/string_view.h>
 #include <array>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
@@ -22,7 +24,9 @@ namespace RTC
 	// extension).
 	constexpr uint8_t MidMaxLength{ 8u };
 
-	class RtpPacket
+	// NOTE: Allocated for every received and cloned packet so it uses the
+	// ObjectPool.
+	class RtpPacket : public RTC::ObjectPool::Allocated
 	{
 	public:
 		/* Struct for RTP header. */
@@ -80,6 +84,17 @@ namespace RTC
 			uint8_t value[1];
 		};
 
+	private:
+		/* Struct for the location of a header extension element value. */
+		struct ExtensionSlot
+		{
+			// Offset of the value from the start of the header extension value
+			// (0 means the extension is not present).
+			uint16_t offset{ 0u };
+			// Value length (One-Byte extension length 0 already means 1 here).
+			uint8_t len{ 0u };
+		};
+
 	public:
 		/* Struct for replacing and setting header extensions. */
 		struct GenericExtension
@@ -156,6 +171,12 @@ namespace RTC
 			return (const uint8_t*)this->header;
 		}
 
+		// Used to rewrite (and restore) the fixed header at once.
+		Header* GetFixedHeader()
+		{
+			return this->header;
+		}
+
 		size_t GetSize() const
 		{
 			return this->size;
@@ -304,7 +325,30 @@ namespace RTC
 			this->videoOrientationExtensionId = id;
 		}
 
+		void SetDependencyDescriptorExtensionId(uint8_t id)
+		{
+			this->dependencyDescriptorExtensionId = id;
+		}
+
+		void SetAbsCaptureTimeExtensionId(uint8_t id)
+		{
+			this->absCaptureTimeExtensionId = id;
+		}
+
 		bool ReadMid(std::string& mid) const
+		{
+			absl::string_view value;
+
+			if (!ReadMid(value))
+				return false;
+
+			mid.assign(value.data(), value.size());
+
+			return true;
+		}
+
+		// The returned view points to the packet buffer.
+		bool ReadMid(absl::string_view& mid) const
 		{
 			uint8_t extenLen;
 			uint8_t* extenValue = GetExtension(this->midExtensionId, extenLen);
@@ -312,14 +356,27 @@ namespace RTC
 			if (!extenValue || extenLen == 0u)
 				return false;
 
-			mid.assign(reinterpret_cast<const char*>(extenValue), static_cast<size_t>(extenLen));
+			mid = absl::string_view(reinterpret_cast<const char*>(extenValue), static_cast<size_t>(extenLen));
 
 			return true;
 		}
 
-		bool UpdateMid(const std::string& mid);
+		bool UpdateMid(absl::string_view mid);
 
 		bool ReadRid(std::string& rid) const
+		{
+			absl::string_view value;
+
+			if (!ReadRid(value))
+				return false;
+
+			rid.assign(value.data(), value.size());
+
+			return true;
+		}
+
+		// The returned view points to the packet buffer.
+		bool ReadRid(absl::string_view& rid) const
 		{
 			// First try with the RID id then with the Repaired RID id.
 			uint8_t extenLen;
@@ -327,7 +384,7 @@ namespace RTC
 
 			if (extenValue && extenLen > 0u)
 			{
-				rid.assign(reinterpret_cast<const char*>(extenValue), static_cast<size_t>(extenLen));
+				rid = absl::string_view(reinterpret_cast<const char*>(extenValue), static_cast<size_t>(extenLen));
 
 				return true;
 			}
@@ -336,7 +393,7 @@ namespace RTC
 
 			if (extenValue && extenLen > 0u)
 			{
-				rid.assign(reinterpret_cast<const char*>(extenValue), static_cast<size_t>(extenLen));
+				rid = absl::string_view(reinterpret_cast<const char*>(extenValue), static_cast<size_t>(extenLen));
 
 				return true;
 			}
@@ -398,6 +455,42 @@ namespace RTC
 			return true;
 		}
 
+		// Absolute capture timestamp (UQ32.32 NTP time in the clock of the capture
+		// system) and estimated capture clock offset (Q32.32, 0 if not present).
+		bool ReadAbsCaptureTime(
+		  uint64_t& absCaptureTimestamp, int64_t& estimatedCaptureClockOffset) const
+		{
+			uint8_t extenLen;
+			uint8_t* extenValue = GetExtension(this->absCaptureTimeExtensionId, extenLen);
+
+			if (!extenValue || (extenLen != 8u && extenLen != 16u))
+				return false;
+
+			absCaptureTimestamp = Utils::Byte::Get8Bytes(extenValue, 0);
+			estimatedCaptureClockOffset =
+			  extenLen == 16u ? static_cast<int64_t>(Utils::Byte::Get8Bytes(extenValue, 8)) : 0;
+
+			return true;
+		}
+
+		// Sets the absolute capture timestamp and resets the estimated capture
+		// clock offset (if present).
+		bool UpdateAbsCaptureTime(uint64_t absCaptureTimestamp)
+		{
+			uint8_t extenLen;
+			uint8_t* extenValue = GetExtension(this->absCaptureTimeExtensionId, extenLen);
+
+			if (!extenValue || (extenLen != 8u && extenLen != 16u))
+				return false;
+
+			Utils::Byte::Set8Bytes(extenValue, 0, absCaptureTimestamp);
+
+			if (extenLen == 16u)
+				Utils::Byte::Set8Bytes(extenValue, 8, 0u);
+
+			return true;
+		}
+
 		bool ReadFrameMarking(RtpPacket::FrameMarking** frameMarking, uint8_t& length) const
 		{
 			uint8_t extenLen;
@@ -416,6 +509,21 @@ namespace RTC
 			return true;
 		}
 
+		bool ReadDependencyDescriptor(const uint8_t** dependencyDescriptor, uint8_t& length) const
+		{
+			uint8_t extenLen;
+			uint8_t* extenValue = GetExtension(this->dependencyDescriptorExtensionId, extenLen);
+
+			// Mandatory fields take 3 bytes.
+			if (!extenValue || extenLen < 3u)
+				return false;
+
+			*dependencyDescriptor = extenValue;
+			length                = extenLen;
+
+			return true;
+		}
+
 		bool ReadSsrcAudioLevel(uint8_t& volume, bool& voice) const
 		{
 			uint8_t extenLen;
@@ -468,88 +576,50 @@ namespace RTC
 
 		bool HasExtension(uint8_t id) const
 		{
-			if (id == 0u)
-			{
+			// NOTE: Slot 0 is never used since id 0 is not valid.
+			if (id >= this->numExtensionSlots || !HasValidExtensionSlots())
 				return false;
-			}
-			else if (HasOneByteExtensions())
-			{
-				if (id > 14)
-					return false;
-
-				// `-1` because we have 14 elements total 0..13 and `id` is in the range 1..14.
-				return this->oneByteExtensions[id - 1] != nullptr;
-			}
-			else if (HasTwoBytesExtensions())
-			{
-				auto it = this->mapTwoBytesExtensions.find(id);
 
-				if (it == this->mapTwoBytesExtensions.end())
-					return false;
+			const auto& slot = this->extensionSlots[id];
 
-				auto* extension = it->second;
-
-				// In Two-Byte extensions value length may be zero. If so, return false.
-				if (extension->len == 0u)
-					return false;
-
-				return true;
-			}
-			else
-			{
-				return false;
-			}
+			// In Two-Byte extensions value length may be zero. If so, return false.
+			return slot.offset != 0u && slot.len != 0u;
 		}
 
 		uint8_t* GetExtension(uint8_t id, uint8_t& len) const
 		{
 			len = 0u;
 
-			if (id == 0u)
-			{
+			// NOTE: Slot 0 is never used since id 0 is not valid.
+			if (id >= this->numExtensionSlots || !HasValidExtensionSlots())
 				return nullptr;
-			}
-			else if (HasOneByteExtensions())
-			{
-				if (id > 14)
-					return nullptr;
-
-				// `-1` because we have 14 elements total 0..13 and `id` is in the range 1..14.
-				auto* extension = this->oneByteExtensions[id - 1];
 
-				if (!extension)
-					return nullptr;
-
-				// In One-Byte extensions value length 0 means 1.
-				len = extension->len + 1;
-
-				return extension->value;
-			}
-			else if (HasTwoBytesExtensions())
-			{
-				auto it = this->mapTwoBytesExtensions.find(id);
+			const auto& slot = this->extensionSlots[id];
 
-				if (it == this->mapTwoBytesExtensions.end())
-					return nullptr;
-
-				auto* extension = it->second;
-
-				len = extension->len;
+			if (slot.offset == 0u)
+				return nullptr;
 
-				// In Two-Byte extensions value length may be zero. If so, return nullptr.
-				if (extension->len == 0u)
-					return nullptr;
+			len = slot.len;
 
-				return extension->value;
-			}
-			else
-			{
+			// In Two-Byte extensions value length may be zero. If so, return nullptr.
+			if (slot.len == 0u)
 				return nullptr;
-			}
+
+			return this->headerExtension->value + slot.offset;
 		}
 
 		bool SetExtensionLength(uint8_t id, uint8_t len);
 
+		// Bytes available for the value of the given extension, including the
+		// padding bytes after it (0 if not present).
+		uint8_t GetExtensionAvailableLength(uint8_t id) const;
+
+		// Rewrites in place the ids of the One-Byte extensions according to the
+		// given table, indexed by current id (a different id for each extension).
+		// If there are no One-Byte extensions or any of them maps to id 0 the
+		// packet is not modified and false is returned.
+		bool MapOneByteExtensionIds(const std::array<uint8_t, 15>& ids);
+
 		uint8_t* GetPayload() const
 		{
 			return this->payloadLength != 0u ? this->payload : nullptr;
@@ -567,39 +637,92 @@ namespace RTC
 			return this->payloadPadding;
 		}
 
-		uint8_t GetSpatialLayer() const
+		/**
+		 * Time (ns) at which the packet was read from the socket (0 if unknown).
+		 * Clones (so also queued and retransmitted packets) keep it.
+		 */
+		uint64_t GetIngressTime() const
 		{
-			if (!this->payloadDescriptorHandler)
-				return 0u;
+			return this->ingressTimeNs;
+		}
 
-			return this->payloadDescriptorHandler->GetSpatialLayer();
+		void SetIngressTime(uint64_t ns)
+		{
+			this->ingressTimeNs = ns;
 		}
 
-		uint8_t GetTemporalLayer() const
+		/**
+		 * Time (ms) at which the kernel received the packet (0 if unknown). Clones
+		 * keep it.
+		 */
+		uint64_t GetArrivalTime() const
 		{
-			if (!this->payloadDescriptorHandler)
-				return 0u;
+			return this->arrivalTimeMs;
+		}
 
-			return this->payloadDescriptorHandler->GetTemporalLayer();
+		void SetArrivalTime(uint64_t ms)
+		{
+			this->arrivalTimeMs = ms;
 		}
 
-		bool IsKeyFrame() const
+		uint8_t GetSpatialLayer() const
 		{
-			if (!this->payloadDescriptorHandler)
-				return false;
+			return this->spatialLayer;
+		}
 
-			return this->payloadDescriptorHandler->IsKeyFrame();
+		uint8_t GetTemporalLayer() const
+		{
+			return this->temporalLayer;
+		}
+
+		bool IsKeyFrame() const
+		{
+			return this->isKeyFrame;
 		}
 
 		RtpPacket* Clone(const uint8_t* buffer) const;
 
+		/**
+		 * Clone of the packet (as it's when first called) whose memory is shared
+		 * by all the holders of the returned pointer. Further calls return the
+		 * same clone, so a packet sent to many Consumers is stored just once.
+		 */
+		std::shared_ptr<RtpPacket> GetSharedClone();
+
 		void RtxEncode(uint8_t payloadType, uint32_t ssrc, uint16_t seq);
 
+		/**
+		 * Same as Clone() followed by RtxEncode() but the payload is written
+		 * right after the original sequence number instead of being moved later.
+		 */
+		RtpPacket* RtxClone(
+		  const uint8_t* buffer, uint8_t payloadType, uint32_t ssrc, uint16_t seq) const;
+
 		bool RtxDecode(uint8_t payloadType, uint32_t ssrc);
 
+		RTC::Codecs::PayloadDescriptorHandler* GetPayloadDescriptorHandler() const
+		{
+			return this->payloadDescriptorHandler.get();
+		}
+
 		void SetPayloadDescriptorHandler(RTC::Codecs::PayloadDescriptorHandler* payloadDescriptorHandler)
 		{
 			this->payloadDescriptorHandler.reset(payloadDescriptorHandler);
+
+			// Classify the packet once here so every Consumer reads plain fields
+			// instead of calling the handler.
+			if (payloadDescriptorHandler)
+			{
+				this->spatialLayer  = payloadDescriptorHandler->GetSpatialLayer();
+				this->temporalLayer = payloadDescriptorHandler->GetTemporalLayer();
+				this->isKeyFrame    = payloadDescriptorHandler->IsKeyFrame();
+			}
+			else
+			{
+				this->spatialLayer  = 0u;
+				this->temporalLayer = 0u;
+				this->isKeyFrame    = false;
+			}
 		}
 
 		bool ProcessPayload(RTC::Codecs::EncodingContext* context, bool& marker);
@@ -609,17 +732,36 @@ namespace RTC
 		void ShiftPayload(size_t payloadOffset, size_t shift, bool expand = true);
 
 	private:
+		RtpPacket* Clone(const uint8_t* buffer, size_t payloadGap) const;
 		void ParseExtensions();
+		// The header extension type may have been overwritten since the extension
+		// table was filled.
+		bool HasValidExtensionSlots() const
+		{
+			// clang-format off
+			return (
+				(HasOneByteExtensions() && this->numExtensionSlots == this->oneByteExtensions.size()) ||
+				(HasTwoBytesExtensions() && this->numExtensionSlots != this->oneByteExtensions.size())
+			);
+			// clang-format on
+		}
+		void ResetExtensionSlots();
+		void SetExtensionSlot(uint8_t id, const uint8_t* value, uint8_t len);
 
 	private:
 		// Passed by argument.
 		Header* header{ nullptr };
 		uint8_t* csrcList{ nullptr };
 		HeaderExtension* headerExtension{ nullptr };
-		// There might be up to 14 one-byte header extensions
-		// (https://datatracker.ietf.org/doc/html/rfc5285#section-4.2), use std::array.
-		std::array<OneByteExtension*, 14> oneByteExtensions;
-		absl::flat_hash_map<uint8_t, TwoBytesExtension*> mapTwoBytesExtensions;
+		// Location of the header extension elements indexed by id, filled when
+		// parsing or setting the extensions. There might be up to 14 One-Byte
+		// header extensions (https://datatracker.ietf.org/doc/html/rfc5285#section-4.2)
+		// and up to 255 Two-Bytes ones, whose table is allocated on demand.
+		std::array<ExtensionSlot, 15> oneByteExtensions;
+		std::unique_ptr<std::array<ExtensionSlot, 256>> twoBytesExtensions;
+		// Table of the current extension type (nullptr if none).
+		ExtensionSlot* extensionSlots{ nullptr };
+		uint16_t numExtensionSlots{ 0u };
 		uint8_t midExtensionId{ 0u };
 		uint8_t ridExtensionId{ 0u };
 		uint8_t rridExtensionId{ 0u };
@@ -629,12 +771,22 @@ namespace RTC
 		uint8_t frameMarkingExtensionId{ 0u };
 		uint8_t ssrcAudioLevelExtensionId{ 0u };
 		uint8_t videoOrientationExtensionId{ 0u };
+		uint8_t dependencyDescriptorExtensionId{ 0u };
+		uint8_t absCaptureTimeExtensionId{ 0u };
 		uint8_t* payload{ nullptr };
 		size_t payloadLength{ 0u };
 		uint8_t payloadPadding{ 0u };
 		size_t size{ 0u }; // Full size of the packet in bytes.
+		uint64_t ingressTimeNs{ 0u };
+		uint64_t arrivalTimeMs{ 0u };
 		// Codecs
 		std::unique_ptr<Codecs::PayloadDescriptorHandler> payloadDescriptorHandler;
+		// Taken from the payload descriptor handler when set.
+		uint8_t spatialLayer{ 0u };
+		uint8_t temporalLayer{ 0u };
+		bool isKeyFrame{ false };
+		// Shared clone (if requested).
+		std::shared_ptr<RtpPacket> sharedClone;
 	};
 } // namespace RTC
 
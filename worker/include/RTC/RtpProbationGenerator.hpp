@@ -11,20 +11,24 @@ namespace RTC
 	// Codec payload type of the probation RTP stream.
 	constexpr uint8_t RtpProbationCodecPayloadType{ 127u };
 
+	/**
+	 * Per thread (so per worker) generator of the padding packets of the
+	 * probation RTP stream, shared by all the Transports that probe. The
+	 * returned packet is valid until the next call.
+	 */
 	class RtpProbationGenerator
 	{
 	public:
-		explicit RtpProbationGenerator();
-		virtual ~RtpProbationGenerator();
+		static void ClassDestroy();
+		static RTC::RtpPacket* GetNextPacket(size_t size);
 
-	public:
-		RTC::RtpPacket* GetNextPacket(size_t size);
+	private:
+		static void CreateProbationPacket();
 
 	private:
-		// Allocated by this.
-		uint8_t* probationPacketBuffer{ nullptr };
-		RTC::RtpPacket* probationPacket{ nullptr };
-	}; // namespace RTC
+		thread_local static uint8_t* probationPacketBuffer;
+		thread_local static RTC::RtpPacket* probationPacket;
+	};
 
 } // namespace RTC
 
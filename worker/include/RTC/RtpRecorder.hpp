@@ -0,0 +1,78 @@
+#ifndef MS_RTC_RTP_RECORDER_HPP
+#define MS_RTC_RTP_RECORDER_HPP
+
+#include "common.hpp"
+#include "RTC/RtpPacket.hpp"
+#include "RTC/SpscQueue.hpp"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+
+using json = nlohmann::json;
+
+namespace RTC
+{
+	/**
+	 * Writes the RTP and RTCP packets sent by a DirectTransport (recordPath
+	 * option) into a file in rtpdump format (as rtptools, Wireshark and
+	 * GStreamer read it), so recording is done within the worker instead of
+	 * sending every packet to Node or to an external process.
+	 *
+	 * Packets are copied into a queue and written by a helper thread, which
+	 * drains it and writes all the packets it got with a single write() call.
+	 * Packets recorded while the queue is full are dropped and counted.
+	 */
+	class RtpRecorder
+	{
+	public:
+		// Must be a power of 2.
+		static constexpr size_t QueueSize{ 1024u };
+		// Time the helper thread sleeps when there are no packets.
+		static constexpr uint32_t IdleIntervalMs{ 10u };
+
+	private:
+		struct Item
+		{
+			// Time since the recording started (in milliseconds).
+			uint32_t offsetMs;
+			uint16_t len;
+			bool isRtcp;
+			uint8_t data[RTC::MtuSize];
+		};
+
+	public:
+		explicit RtpRecorder(const std::string& path);
+		~RtpRecorder();
+
+	public:
+		void FillJsonStats(json& jsonObject) const;
+		const std::string& GetPath() const
+		{
+			return this->path;
+		}
+		// Returns false if the packet was dropped.
+		bool Record(const uint8_t* data, size_t len, bool isRtcp);
+
+	private:
+		void ThreadMain();
+
+	private:
+		// Passed by argument.
+		std::string path;
+		// Others.
+		int fd{ -1 };
+		uint64_t startMs{ 0u };
+		SpscQueue<Item> queue{ QueueSize };
+		std::atomic<bool> stopping{ false };
+		std::thread thread;
+		// Written by the loop thread.
+		uint64_t recordedPackets{ 0u };
+		uint64_t droppedPackets{ 0u };
+		// Written by the helper thread.
+		std::atomic<uint64_t> writtenBytes{ 0u };
+		std::atomic<uint64_t> writeErrors{ 0u };
+	};
+} // namespace RTC
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef MS_RTC_RTP_REORDER_BUFFER_HPP
+#define MS_RTC_RTP_REORDER_BUFFER_HPP
+
+#include "common.hpp"
+#include "RTC/RtpPacket.hpp"
+#include "handles/Timer.hpp"
+#include <nlohmann/json.hpp>
+#include <array>
+#include <memory> // std::shared_ptr
+
+using json = nlohmann::json;
+
+namespace RTC
+{
+	/**
+	 * Holds, for a short time, the media packets of a Producer stream that
+	 * arrive after a sequence number gap, so packets just reordered by the
+	 * network are processed in order instead of being NACKed.
+	 *
+	 * Held packets are released as soon as the gap is filled, or all of them
+	 * (giving up the missing ones) once the first one has been held for the
+	 * configured delay, so the added latency is bounded by it.
+	 */
+	class RtpReorderBuffer : public Timer::Listener
+	{
+	public:
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			virtual void OnRtpReorderBufferPacket(
+			  RTC::RtpReorderBuffer* rtpReorderBuffer, RTC::RtpPacket* packet) = 0;
+		};
+
+	public:
+		// Max number of held packets (must be a power of 2).
+		static constexpr size_t MaxPackets{ 64u };
+		// Max delay (in ms) a packet can be held.
+		static constexpr uint32_t MaxDelay{ 50u };
+
+	public:
+		RtpReorderBuffer(Listener* listener, uint32_t delay, bool useNack, uint32_t sendNackDelayMs);
+		~RtpReorderBuffer() override;
+
+	public:
+		void FillJson(json& jsonObject) const;
+		// Returns true if the packet is held, so it must not be processed now (it
+		// will be provided to the listener later).
+		bool Insert(RTC::RtpPacket* packet);
+		// Provides the listener with the held packets that follow the last
+		// processed one. To be called once a not held packet has been processed.
+		void Drain();
+		void Clear();
+		size_t GetNumHeldPackets() const
+		{
+			return this->numHeldPackets;
+		}
+
+	private:
+		void ReleaseAll();
+
+		/* Pure virtual methods inherited from Timer::Listener. */
+	public:
+		void OnTimer(Timer* timer) override;
+
+	private:
+		// Passed by argument.
+		Listener* listener{ nullptr };
+		uint32_t delay{ 0u };
+		bool useNack{ false };
+		uint32_t sendNackDelayMs{ 0u };
+		// Allocated by this.
+		Timer* timer{ nullptr };
+		// Held packets indexed by sequence number.
+		std::array<std::shared_ptr<RTC::RtpPacket>, MaxPackets> packets;
+		// Others.
+		size_t numHeldPackets{ 0u };
+		bool started{ false };
+		// Sequence number of the last processed (or given up) packet.
+		uint16_t lastSeq{ 0u };
+		// When the current gap was detected.
+		uint64_t gapDetectedAtMs{ 0u };
+		// Packets that filled a gap.
+		size_t reorderedPackets{ 0u };
+		// Packets that filled a gap once it would have been NACKed.
+		size_t nacksAvoided{ 0u };
+		// Missing packets given up once the delay expired.
+		size_t skippedPackets{ 0u };
+	};
+} // namespace RTC
+
+#endif
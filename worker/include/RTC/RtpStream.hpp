@@ -3,6 +3,7 @@
 
 #include "common.hpp"
 #include "DepLibUV.hpp"
+#include "StatsRegion.hpp"
 #include "RTC/RTCP/FeedbackPsFir.hpp"
 #include "RTC/RTCP/FeedbackPsPli.hpp"
 #include "RTC/RTCP/FeedbackRtpNack.hpp"
@@ -14,6 +15,7 @@
 #include "RTC/RTCP/XrReceiverReferenceTime.hpp"
 #include "RTC/RtpDictionaries.hpp"
 #include "RTC/RtxStream.hpp"
+#include "RTC/TransportArena.hpp"
 #include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
@@ -22,7 +24,8 @@ using json = nlohmann::json;
 
 namespace RTC
 {
-	class RtpStream
+	// NOTE: Long lived object of a Transport so it uses its TransportArena.
+	class RtpStream : public RTC::TransportArena::Allocated
 	{
 	protected:
 		class Listener
@@ -55,14 +58,33 @@ namespace RTC
 			bool useDtx{ false };
 			uint8_t spatialLayers{ 1u };
 			uint8_t temporalLayers{ 1u };
+			// Whether reduced-size RTCP (RFC 5506) was negotiated.
+			bool rtcpReducedSize{ false };
 		};
 
+	public:
+		// Packet counts of a score interval, already sanitized (lost <= packets,
+		// repaired <= lost and repaired <= retransmitted).
+		struct ScoreSample
+		{
+			uint32_t packets{ 0u };
+			uint32_t lost{ 0u };
+			uint32_t repaired{ 0u };
+			uint32_t retransmitted{ 0u };
+		};
+
+	public:
+		// Computes the score (0-10) of each sample (packets must be > 0). It has
+		// no branches so the compiler can vectorize it.
+		static void ComputeScores(const ScoreSample* samples, uint8_t* scores, size_t count);
+
 	public:
 		RtpStream(RTC::RtpStream::Listener* listener, RTC::RtpStream::Params& params, uint8_t initialScore);
 		virtual ~RtpStream();
 
 		void FillJson(json& jsonObject) const;
 		virtual void FillJsonStats(json& jsonObject);
+		virtual void FillStatsRecord(StatsRegion::Record* record, uint64_t nowMs);
 		uint32_t GetEncodingIdx() const
 		{
 			return this->params.encodingIdx;
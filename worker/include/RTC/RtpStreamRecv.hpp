@@ -1,18 +1,20 @@
 #ifndef MS_RTC_RTP_STREAM_RECV_HPP
 #define MS_RTC_RTP_STREAM_RECV_HPP
 
+#include "Metrics.hpp"
+#include "RTC/Codecs/AV1.hpp"
+#include "RTC/FlexFecReceiver.hpp"
 #include "RTC/NackGenerator.hpp"
 #include "RTC/RTCP/XrDelaySinceLastRr.hpp"
 #include "RTC/RateCalculator.hpp"
 #include "RTC/RtpStream.hpp"
 #include "handles/Timer.hpp"
+#include <memory> // std::unique_ptr
 #include <vector>
 
 namespace RTC
 {
-	class RtpStreamRecv : public RTC::RtpStream,
-	                      public RTC::NackGenerator::Listener,
-	                      public Timer::Listener
+	class RtpStreamRecv : public RTC::RtpStream, public RTC::NackGenerator::Listener
 	{
 	public:
 		class Listener : public RTC::RtpStream::Listener
@@ -25,22 +27,90 @@ namespace RTC
 		};
 
 	public:
+		// Bytes and packets received in each layer. Bytes of each layer are
+		// counted in time slots of a single [slot][spatialLayer][temporalLayer]
+		// matrix (used as a ring of slots) so a packet is just added to its
+		// layer, and bitrates are computed when requested.
 		class TransmissionCounter
 		{
 		public:
 			TransmissionCounter(uint8_t spatialLayers, uint8_t temporalLayers, size_t windowSize);
-			void Update(RTC::RtpPacket* packet);
+			void Update(RTC::RtpPacket* packet, uint64_t nowMs);
 			uint32_t GetBitrate(uint64_t nowMs);
 			uint32_t GetBitrate(uint64_t nowMs, uint8_t spatialLayer, uint8_t temporalLayer);
 			uint32_t GetSpatialLayerBitrate(uint64_t nowMs, uint8_t spatialLayer);
 			uint32_t GetLayerBitrate(uint64_t nowMs, uint8_t spatialLayer, uint8_t temporalLayer);
-			size_t GetPacketCount() const;
-			size_t GetBytes() const;
+			size_t GetPacketCount() const
+			{
+				return this->packetCount;
+			}
+			size_t GetBytes() const
+			{
+				return this->bytes;
+			}
 
 		private:
-			std::vector<std::vector<RTC::RtpDataCounter>> spatialLayerCounters;
+			// Moves the current slot to the given time, clearing the expired ones.
+			void AdvanceSlots(uint64_t nowMs);
+			void UpdateLayerBitrates(uint64_t nowMs);
+
+		private:
+			static constexpr size_t NumSlots{ 100u };
+
+		private:
+			size_t spatialLayers{ 0u };
+			size_t temporalLayers{ 0u };
+			size_t numLayers{ 0u };
+			size_t windowSizeMs{ 0u };
+			size_t slotSizeMs{ 0u };
+			// Bytes of each layer in each slot followed by a last row with the bytes
+			// of each layer in the whole window.
+			std::vector<uint32_t> slotBytes;
+			size_t currentSlot{ 0u };
+			uint64_t currentSlotStartMs{ 0u };
+			bool slotsStarted{ false };
+			size_t packetCount{ 0u };
+			size_t bytes{ 0u };
+			// Snapshot of the bitrate of each layer (flattened as
+			// [spatialLayer][temporalLayer]) and their accumulated bitrates (up to
+			// each layer), refreshed at most once per millisecond. All the Consumers
+			// of the Producer read it, so a BWE tick does not hit every
+			// RateCalculator once per Consumer.
+			std::vector<uint32_t> layerBitrates;
+			std::vector<uint32_t> accumulatedLayerBitrates;
+			uint64_t layerBitratesTimeMs{ 0u };
+			bool layerBitratesValid{ false };
 		};
 
+	private:
+		// Listener of the worker level sweep timer.
+		class SweepTimerListener : public Timer::Listener
+		{
+			/* Pure virtual methods inherited from Timer. */
+		public:
+			void OnTimer(Timer* timer) override;
+		};
+
+	private:
+		static void AddToSweep(RtpStreamRecv* rtpStream);
+		static void RemoveFromSweep(RtpStreamRecv* rtpStream);
+		// Detects inactive streams and updates the pending scores of all the
+		// RtpStreamRecv at once.
+		static void Sweep(uint64_t nowMs);
+
+	private:
+		// All the RtpStreamRecv and the time (in ms) at which each one becomes
+		// inactive (the max value if paused or already inactive), in dense arrays
+		// so a single periodic sweep checks them instead of a timer per stream.
+		thread_local static std::vector<RtpStreamRecv*> sweepStreams;
+		thread_local static std::vector<uint64_t> sweepInactiveAtMs;
+		// Streams with a score update pending for the next sweep.
+		thread_local static std::vector<RtpStreamRecv*> sweepScoreStreams;
+		thread_local static std::vector<RTC::RtpStream::ScoreSample> sweepScoreSamples;
+		thread_local static std::vector<uint8_t> sweepScores;
+		thread_local static SweepTimerListener sweepTimerListener;
+		thread_local static Timer* sweepTimer;
+
 	public:
 		RtpStreamRecv(
 		  RTC::RtpStreamRecv::Listener* listener,
@@ -49,8 +119,17 @@ namespace RTC
 		~RtpStreamRecv();
 
 		void FillJsonStats(json& jsonObject) override;
+		void FillStatsRecord(StatsRegion::Record* record, uint64_t nowMs) override;
 		bool ReceivePacket(RTC::RtpPacket* packet) override;
 		bool ReceiveRtxPacket(RTC::RtpPacket* packet);
+		void SetFec(uint8_t payloadType, uint32_t ssrc);
+		bool HasFec() const
+		{
+			return this->fecReceiver != nullptr;
+		}
+		// Returns the media packet recovered with the given FEC packet (if any),
+		// to be given to ReceivePacket(). It's valid until the next call.
+		RTC::RtpPacket* ReceiveFecPacket(RTC::RtpPacket* packet);
 		RTC::RTCP::ReceiverReport* GetRtcpReceiverReport();
 		RTC::RTCP::ReceiverReport* GetRtxRtcpReceiverReport();
 		void ReceiveRtcpSenderReport(RTC::RTCP::SenderReport* report);
@@ -75,14 +154,24 @@ namespace RTC
 		{
 			return this->transmissionCounter.GetLayerBitrate(nowMs, spatialLayer, temporalLayer);
 		}
+		// Approximate memory (in bytes) used to request retransmissions.
+		size_t GetMemoryUsage() const
+		{
+			return this->nackGenerator ? this->nackGenerator->GetMemoryUsage() : 0u;
+		}
 
 	private:
-		void CalculateJitter(uint32_t rtpTimestamp);
-		void UpdateScore();
-
-		/* Pure virtual methods inherited from Timer. */
-	protected:
-		void OnTimer(Timer* timer) override;
+		void CalculateJitter(uint32_t rtpTimestamp, uint64_t nowMs);
+		void ProcessAbsCaptureTime(RTC::RtpPacket* packet, uint64_t arrivalMs, bool retransmitted);
+		void SetInactiveAt(uint64_t inactiveAtMs)
+		{
+			RtpStreamRecv::sweepInactiveAtMs[this->sweepIdx] = inactiveAtMs;
+		}
+		void PacketReceived(uint64_t nowMs);
+		void ScheduleScoreUpdate();
+		// Takes the packet counts since the previous call. Returns false if there
+		// is no score to compute.
+		bool TakeScoreSample(RTC::RtpStream::ScoreSample& sample);
 
 		/* Pure virtual methods inherited from RTC::NackGenerator. */
 	protected:
@@ -107,10 +196,19 @@ namespace RTC
 		uint8_t firSeqNumber{ 0u };
 		uint32_t reportedPacketLost{ 0u };
 		std::unique_ptr<RTC::NackGenerator> nackGenerator;
-		Timer* inactivityCheckPeriodicTimer{ nullptr };
+		RTC::FlexFecReceiver* fecReceiver{ nullptr };
+		uint64_t inactivityTimeoutMs{ 0u };
+		// Position in the sweep arrays.
+		size_t sweepIdx{ 0u };
 		bool inactive{ false };
-		TransmissionCounter transmissionCounter;      // Valid media + valid RTX.
-		RTC::RtpDataCounter mediaTransmissionCounter; // Just valid media.
+		bool scorePending{ false };
+		TransmissionCounter transmissionCounter; // Valid media + valid RTX.
+		size_t mediaPacketCount{ 0u };           // Just valid media.
+		// Latest AV1 template dependency structure (if AV1).
+		RTC::Codecs::AV1::TemplateStructure av1TemplateStructure;
+		// Time (ms) since media capture until packet arrival, allocated once a
+		// packet with abs-capture-time is received.
+		std::unique_ptr<Metrics::Histogram> captureLatency;
 	};
 } // namespace RTC
 
@@ -1,8 +1,11 @@
 #ifndef MS_RTC_RTP_STREAM_SEND_HPP
 #define MS_RTC_RTP_STREAM_SEND_HPP
 
+#include "RTC/FlexFecGenerator.hpp"
 #include "RTC/RateCalculator.hpp"
 #include "RTC/RtpStream.hpp"
+#include <deque>
+#include <memory>
 #include <vector>
 
 namespace RTC
@@ -13,23 +16,34 @@ namespace RTC
 		class Listener : public RTC::RtpStream::Listener
 		{
 		public:
-			virtual void OnRtpStreamRetransmitRtpPacket(
+			// Packets requested by a NACK are given all together. They are valid
+			// until the next NACK is received.
+			virtual void OnRtpStreamRetransmitRtpPackets(
+			  RTC::RtpStreamSend* rtpStream, RTC::RtpPacket** packets, size_t count) = 0;
+			virtual void OnRtpStreamSendFecPacket(
 			  RTC::RtpStreamSend* rtpStream, RTC::RtpPacket* packet) = 0;
 		};
 
+	public:
+		// Number of payload bytes kept per stored packet. Consumers may rewrite
+		// the codec payload descriptor at the beginning of the payload.
+		static constexpr size_t StoredPayloadHeadSize{ 16u };
+
 	public:
 		struct StorageItem
 		{
-			// Cloned packet.
-			RTC::RtpPacket* packet{ nullptr };
-			// Memory to hold the cloned packet (with extra space for RTX encoding).
-			uint8_t store[RTC::MtuSize + 100];
+			// Clone of the packet shared with other streams that sent it.
+			std::shared_ptr<RTC::RtpPacket> packet;
+			// Values of the packet when it was sent by this stream.
+			uint32_t ssrc{ 0u };
+			uint32_t timestamp{ 0u };
+			uint16_t sequenceNumber{ 0u };
+			bool marker{ false };
+			uint8_t payloadHead[StoredPayloadHeadSize];
 			// Last time this packet was resent.
 			uint64_t resentAtMs{ 0u };
 			// Number of times this packet was resent.
 			uint8_t sentTimes{ 0u };
-			// Whether the packet has been already RTX encoded.
-			bool rtxEncoded{ false };
 		};
 
 	public:
@@ -38,15 +52,29 @@ namespace RTC
 		~RtpStreamSend() override;
 
 		void FillJsonStats(json& jsonObject) override;
+		void FillStatsRecord(StatsRegion::Record* record, uint64_t nowMs) override;
 		void SetRtx(uint8_t payloadType, uint32_t ssrc) override;
+		void SetFec(uint8_t payloadType, uint32_t ssrc);
+		bool HasFec() const
+		{
+			return this->fecGenerator != nullptr;
+		}
 		bool ReceivePacket(RTC::RtpPacket* packet) override;
 		void ReceiveNack(RTC::RTCP::FeedbackRtpNackPacket* nackPacket);
 		void ReceiveKeyFrameRequest(RTC::RTCP::FeedbackPs::MessageType messageType);
 		void ReceiveRtcpReceiverReport(RTC::RTCP::ReceiverReport* report);
 		void ReceiveRtcpXrReceiverReferenceTime(RTC::RTCP::ReceiverReferenceTime* report);
+		// Whether packets were sent since the last Sender Report. If not, the
+		// stream is idle (i.e. paused) and no Sender Report is generated for it.
+		bool HasSentSinceLastSenderReport() const
+		{
+			return this->transmissionCounter.GetPacketCount() != this->lastSenderReportPacketCount;
+		}
 		RTC::RTCP::SenderReport* GetRtcpSenderReport(uint64_t nowMs);
 		RTC::RTCP::DelaySinceLastRr::SsrcInfo* GetRtcpXrDelaySinceLastRr(uint64_t nowMs);
-		RTC::RTCP::SdesChunk* GetRtcpSdesChunk();
+		// May return nullptr if reduced-size RTCP is used and the CNAME was sent
+		// recently.
+		RTC::RTCP::SdesChunk* GetRtcpSdesChunk(uint64_t nowMs);
 		void Pause() override;
 		void Resume() override;
 		uint32_t GetBitrate(uint64_t nowMs) override
@@ -56,28 +84,84 @@ namespace RTC
 		uint32_t GetBitrate(uint64_t nowMs, uint8_t spatialLayer, uint8_t temporalLayer) override;
 		uint32_t GetSpatialLayerBitrate(uint64_t nowMs, uint8_t spatialLayer) override;
 		uint32_t GetLayerBitrate(uint64_t nowMs, uint8_t spatialLayer, uint8_t temporalLayer) override;
+		// Approximate memory (in bytes) used to retransmit packets. Packets shared
+		// with other streams are split among them.
+		size_t GetMemoryUsage() const;
+		// Approximate memory (in bytes) used by this stream, including the one
+		// to retransmit packets.
+		size_t GetFootprint() const;
+		// Limits the number of packets stored for retransmission (0 means no
+		// limit other than the adaptive one). The oldest stored packets are
+		// dropped if there are more than the new limit.
+		void SetStorageLimit(size_t storageLimit);
+		// RTX packet of a recently sent packet, to be used as padding when
+		// probing (so probe bytes carry media). Returns nullptr if RTX is not
+		// used or there is no stored packet. Valid until the next call.
+		RTC::RtpPacket* GetRtxPaddingPacket(size_t size);
+		uint16_t GetRtxSeq() const
+		{
+			return this->rtxSeq;
+		}
+		void SetRtxSeq(uint16_t rtxSeq)
+		{
+			this->rtxSeq = rtxSeq;
+		}
 
 	private:
 		void StorePacket(RTC::RtpPacket* packet);
+		StorageItem* GetStorageItem(uint16_t seq) const
+		{
+			auto* storageItem = this->buffer[seq & (this->buffer.size() - 1)];
+
+			// The index position may hold a packet with another seq.
+			if (!storageItem || storageItem->sequenceNumber != seq)
+				return nullptr;
+
+			return storageItem;
+		}
 		void ClearBuffer();
+		size_t GetMaxBufferSize() const;
+		void UpdateAdaptiveBufferSize(uint64_t nowMs);
+		void ShrinkBuffer();
+		void RemoveOldestStorageItem();
 		void UpdateBufferStartIdx();
-		void FillRetransmissionContainer(uint16_t seq, uint16_t bitmask);
+		size_t FillRetransmissionContainer(uint16_t seq, uint16_t bitmask, size_t containerIdx);
+		void RetransmitPackets(size_t count);
+		// Returns a copy of the stored packet written into the given buffer, or
+		// the stored packet itself if inPlace is true and RTX is not used.
+		RTC::RtpPacket* CreateRetransmissionPacket(
+		  StorageItem* storageItem, uint8_t* buffer, bool inPlace);
 		void UpdateScore(RTC::RTCP::ReceiverReport* report);
 
 	private:
 		uint32_t lostPriorScore{ 0u }; // Packets lost at last interval for score calculation.
 		uint32_t sentPriorScore{ 0u }; // Packets sent at last interval for score calculation.
+		// Stored packets indexed by seq modulo the index size (a power of 2).
 		std::vector<StorageItem*> buffer;
+		// Seq of the oldest and newest stored packets.
 		uint16_t bufferStartIdx{ 0u };
+		uint16_t bufferEndIdx{ 0u };
+		// Number of stored packets.
 		size_t bufferSize{ 0u };
-		std::vector<StorageItem> storage;
+		// Used items first (a deque so they don't move when it grows).
+		std::deque<StorageItem> storage;
+		// Buffer size given in the constructor.
+		size_t maxBufferSize{ 0u };
+		// Buffer size according to the packet rate and RTT.
+		size_t adaptiveBufferSize{ 0u };
+		uint64_t storageWindowStartMs{ 0u };
+		size_t storedPacketsInWindow{ 0u };
+		size_t storageLimit{ 0u };
 		uint16_t rtxSeq{ 0u };
+		RTC::FlexFecGenerator* fecGenerator{ nullptr };
 		RTC::RtpDataCounter transmissionCounter;
 		uint32_t lastRrTimestamp{ 0u };  // The middle 32 bits out of 64 in the NTP
 		                                 // timestamp received in the most recent
 		                                 // receiver reference timestamp.
 		uint64_t lastRrReceivedMs{ 0u }; // Wallclock time representing the most recent
 		                                 // receiver reference timestamp arrival.
+		uint32_t lastSenderReportPacketCount{ 0u };
+		uint64_t lastSdesSentAtMs{ 0u };
 	};
 } // namespace RTC
 
@@ -5,14 +5,17 @@
 #include "Utils.hpp"
 #include "RTC/DataConsumer.hpp"
 #include "RTC/DataProducer.hpp"
+#include "RTC/NativeSctpAssociation.hpp"
 #include <usrsctp.h>
 #include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
 
 using json = nlohmann::json;
 
 namespace RTC
 {
-	class SctpAssociation
+	class SctpAssociation : public RTC::NativeSctpAssociation::Listener
 	{
 	public:
 		enum class SctpState
@@ -34,6 +37,14 @@ namespace RTC
 	protected:
 		using onQueuedCallback = const std::function<void(bool queued, bool sctpSendBufferFull)>;
 
+	private:
+		struct QueuedSctpMessage
+		{
+			std::string dataConsumerId;
+			struct sctp_sendv_spa spa;
+			std::vector<uint8_t> msg;
+		};
+
 	public:
 		class Listener
 		{
@@ -55,6 +66,13 @@ namespace RTC
 			  size_t len) = 0;
 			virtual void OnSctpAssociationBufferedAmount(
 			  RTC::SctpAssociation* sctpAssociation, uint32_t len) = 0;
+			// Must return true if the message was taken to be sent later.
+			virtual bool OnSctpAssociationSendBufferFull(
+			  RTC::SctpAssociation* sctpAssociation,
+			  const std::string& dataConsumerId,
+			  uint32_t ppid,
+			  const uint8_t* msg,
+			  size_t len) = 0;
 		};
 
 	public:
@@ -70,6 +88,18 @@ namespace RTC
 			// clang-format on
 		}
 
+	public:
+		static void ClassDestroy();
+
+	private:
+		static std::vector<uint8_t>* AcquireMessageBuffer();
+		static void ReleaseMessageBuffer(std::vector<uint8_t>* messageBuffer);
+
+	private:
+		// Buffers to reassemble messages received in parts, shared by all the
+		// SctpAssociations since few of them receive such messages at a time.
+		thread_local static std::vector<std::vector<uint8_t>*> freeMessageBuffers;
+
 	public:
 		SctpAssociation(
 		  Listener* listener,
@@ -78,7 +108,7 @@ namespace RTC
 		  size_t maxSctpMessageSize,
 		  size_t sctpSendBufferSize,
 		  bool isDataChannel);
-		~SctpAssociation();
+		~SctpAssociation() override;
 
 	public:
 		void FillJson(json& jsonObject) const;
@@ -91,6 +121,9 @@ namespace RTC
 		{
 			return this->sctpBufferedAmount;
 		}
+		// Approximate memory (in bytes) used by buffered outgoing and incoming
+		// messages.
+		size_t GetMemoryUsage() const;
 		void ProcessSctpData(const uint8_t* data, size_t len);
 		void SendSctpMessage(
 		  RTC::DataConsumer* dataConsumer,
@@ -101,10 +134,29 @@ namespace RTC
 		void HandleDataConsumer(RTC::DataConsumer* dataConsumer);
 		void DataProducerClosed(RTC::DataProducer* dataProducer);
 		void DataConsumerClosed(RTC::DataConsumer* dataConsumer);
+		void SendQueuedSctpMessages();
 
 	private:
+		// Returns false if the SCTP send buffer is full.
+		bool SendSctpMessage(
+		  const std::string& dataConsumerId,
+		  struct sctp_sendv_spa& spa,
+		  const uint8_t* msg,
+		  size_t len,
+		  onQueuedCallback* cb);
+		void SctpSendBufferFull(
+		  const std::string& dataConsumerId,
+		  uint32_t ppid,
+		  const uint8_t* msg,
+		  size_t len,
+		  onQueuedCallback* cb);
+		void SetNoDelay(bool enabled);
 		void ResetSctpStream(uint16_t streamId, StreamDirection);
 		void AddOutgoingStreams(bool force = false);
+		uint16_t GetOs() const
+		{
+			return this->nativeSctpAssociation ? this->nativeSctpAssociation->GetOs() : this->os;
+		}
 
 		/* Callbacks fired by usrsctp events. */
 	public:
@@ -114,6 +166,25 @@ namespace RTC
 		void OnUsrSctpReceiveSctpNotification(union sctp_notification* notification, size_t len);
 		void OnUsrSctpSentData(uint32_t freeBuffer);
 
+		/* Pure virtual methods inherited from RTC::NativeSctpAssociation::Listener. */
+	public:
+		void OnNativeSctpAssociationConnected(
+		  RTC::NativeSctpAssociation* nativeSctpAssociation) override;
+		void OnNativeSctpAssociationFailed(RTC::NativeSctpAssociation* nativeSctpAssociation) override;
+		void OnNativeSctpAssociationClosed(RTC::NativeSctpAssociation* nativeSctpAssociation) override;
+		void OnNativeSctpAssociationSendPacket(
+		  RTC::NativeSctpAssociation* nativeSctpAssociation, const uint8_t* data, size_t len) override;
+		void OnNativeSctpAssociationMessageReceived(
+		  RTC::NativeSctpAssociation* nativeSctpAssociation,
+		  uint16_t streamId,
+		  uint32_t ppid,
+		  const uint8_t* msg,
+		  size_t len) override;
+		void OnNativeSctpAssociationBufferedAmount(
+		  RTC::NativeSctpAssociation* nativeSctpAssociation, size_t bufferedAmount) override;
+		void OnNativeSctpAssociationIncomingStreamReset(
+		  RTC::NativeSctpAssociation* nativeSctpAssociation, uint16_t streamId) override;
+
 	public:
 		uintptr_t id{ 0u };
 
@@ -126,14 +197,21 @@ namespace RTC
 		size_t sctpSendBufferSize{ 262144u };
 		size_t sctpBufferedAmount{ 0u };
 		bool isDataChannel{ false };
-		// Allocated by this.
-		uint8_t* messageBuffer{ nullptr };
+		// Taken from the shared buffers while a message is being received in
+		// parts.
+		std::vector<uint8_t>* messageBuffer{ nullptr };
 		// Others.
 		SctpState state{ SctpState::NEW };
 		struct socket* socket{ nullptr };
 		uint16_t desiredOs{ 0u };
-		size_t messageBufferLen{ 0u };
 		uint16_t lastSsnReceived{ 0u }; // Valid for us since no SCTP I-DATA support.
+		// Messages to be sent before the loop blocks for I/O.
+		std::vector<QueuedSctpMessage> queuedSctpMessages;
+		// Used instead of usrsctp if Settings nativeSctp is enabled.
+		RTC::NativeSctpAssociation* nativeSctpAssociation{ nullptr };
+		// Whether the NativeSctpAssociation is to be flushed before the loop
+		// blocks for I/O.
+		bool nativeFlushScheduled{ false };
 	};
 } // namespace RTC
 
@@ -0,0 +1,52 @@
+#ifndef MS_RTC_SCTP_PACKET_HPP
+#define MS_RTC_SCTP_PACKET_HPP
+
+#include "common.hpp"
+#include "Utils.hpp"
+
+namespace RTC
+{
+	/**
+	 * Helpers for the SCTP common header (RFC 4960 section 3.1), shared by the
+	 * usrsctp based SctpAssociation and by the NativeSctpAssociation.
+	 */
+	class SctpPacket
+	{
+	public:
+		static constexpr size_t CommonHeaderSize{ 12u };
+		// Offset of the checksum in the SCTP common header.
+		static constexpr size_t ChecksumOffset{ 8u };
+
+	public:
+		// CRC32c of the SCTP packet with its checksum field set to zero.
+		static uint32_t ComputeChecksum(const uint8_t* data, size_t len)
+		{
+			static const uint8_t Zeroes[4]{ 0u };
+
+			uint32_t crc = Utils::Crypto::GetCRC32c(data, ChecksumOffset);
+
+			crc = Utils::Crypto::GetCRC32c(Zeroes, sizeof(Zeroes), crc);
+			crc = Utils::Crypto::GetCRC32c(
+			  data + ChecksumOffset + sizeof(Zeroes), len - ChecksumOffset - sizeof(Zeroes), crc);
+
+			return crc;
+		}
+		// The checksum goes least significant byte first (RFC 4960 appendix B).
+		static uint32_t ReadChecksum(const uint8_t* data)
+		{
+			return static_cast<uint32_t>(data[ChecksumOffset]) |
+			       (static_cast<uint32_t>(data[ChecksumOffset + 1]) << 8) |
+			       (static_cast<uint32_t>(data[ChecksumOffset + 2]) << 16) |
+			       (static_cast<uint32_t>(data[ChecksumOffset + 3]) << 24);
+		}
+		static void WriteChecksum(uint8_t* data, uint32_t checksum)
+		{
+			data[ChecksumOffset]     = static_cast<uint8_t>(checksum);
+			data[ChecksumOffset + 1] = static_cast<uint8_t>(checksum >> 8);
+			data[ChecksumOffset + 2] = static_cast<uint8_t>(checksum >> 16);
+			data[ChecksumOffset + 3] = static_cast<uint8_t>(checksum >> 24);
+		}
+	};
+} // namespace RTC
+
+#endif
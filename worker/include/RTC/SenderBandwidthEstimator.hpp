@@ -4,13 +4,32 @@
 #include "common.hpp"
 #include "RTC/RTCP/FeedbackRtpTransport.hpp"
 #include "RTC/RateCalculator.hpp"
-#include "RTC/SeqManager.hpp"
 #include "RTC/TrendCalculator.hpp"
-#include <absl/container/btree_map.h>
-#include <map>
+#include <array>
 
 namespace RTC
 {
+	/**
+	 * Send side bandwidth estimator fed with transport-cc feedback, a lighter
+	 * alternative to the libwebrtc GoogCC controller:
+	 *
+	 * - Delay based: received packets are grouped in bursts and the slope of the
+	 *   accumulated delay variation between consecutive groups (the delay
+	 *   gradient) is fitted over the last groups and compared against an
+	 *   adaptive threshold to detect overuse of the link.
+	 * - Rate control (AIMD): the estimate increases multiplicatively (or
+	 *   additively once close to the detected link capacity) while the link is
+	 *   not overused, and decreases below the acknowledged bitrate on overuse.
+	 * - Loss based: the estimate decreases on high packet loss and is held on
+	 *   moderate packet loss.
+	 * - ALR (application limited region): the estimate is not increased while
+	 *   the send bitrate is well below it, since the feedback then tells
+	 *   nothing about the spare capacity of the link.
+	 *
+	 * All the state is fixed size (sent packets are tracked in a ring indexed
+	 * by their wide sequence number) and a feedback is processed in a single
+	 * pass over its packet results.
+	 */
 	class SenderBandwidthEstimator
 	{
 	public:
@@ -26,61 +45,49 @@ namespace RTC
 			  uint32_t previousAvailableBitrate) = 0;
 		};
 
+	public:
+		enum class BandwidthUsage : uint8_t
+		{
+			NORMAL = 0,
+			OVERUSING,
+			UNDERUSING
+		};
+
 	public:
 		struct SentInfo
 		{
+			uint64_t sentAtMs{ 0u };
+			uint32_t size{ 0u };
 			uint16_t wideSeq{ 0u };
-			size_t size{ 0u };
 			bool isProbation{ false };
-			uint64_t sendingAtMs{ 0u };
-			uint64_t sentAtMs{ 0u };
 		};
 
 	private:
-		class CummulativeResult
+		enum class RateControlState : uint8_t
 		{
-		public:
-			CummulativeResult() = default;
-
-		public:
-			uint64_t GetStartedAtMs() const
-			{
-				return this->firstPacketSentAtMs;
-			}
-			size_t GetNumPackets() const
-			{
-				return this->numPackets;
-			}
-			size_t GetTotalSize() const
-			{
-				return this->totalSize;
-			}
-			uint32_t GetSendBitrate() const
-			{
-				auto sendIntervalMs =
-				  std::max<uint64_t>(this->lastPacketSentAtMs - this->firstPacketSentAtMs, 1u);
-
-				return static_cast<uint32_t>(this->totalSize / sendIntervalMs) * 8 * 1000;
-			}
-			uint32_t GetReceiveBitrate() const
-			{
-				auto recvIntervalMs =
-				  std::max<uint64_t>(this->lastPacketReceivedAtMs - this->firstPacketReceivedAtMs, 1u);
+			HOLD = 0,
+			INCREASE
+		};
 
-				return static_cast<uint32_t>(this->totalSize / recvIntervalMs) * 8 * 1000;
-			}
-			void AddPacket(size_t size, int64_t sentAtMs, int64_t receivedAtMs);
-			void Reset();
+		struct PacketGroup
+		{
+			uint64_t firstSentAtMs{ 0u };
+			uint64_t lastSentAtMs{ 0u };
+			int64_t lastReceivedAtMs{ 0 };
+		};
 
-		private:
-			size_t numPackets{ 0u };
-			size_t totalSize{ 0u };
-			int64_t firstPacketSentAtMs{ 0u };
-			int64_t lastPacketSentAtMs{ 0u };
-			int64_t firstPacketReceivedAtMs{ 0u };
-			int64_t lastPacketReceivedAtMs{ 0u };
+		struct TrendlineSample
+		{
+			double receivedAtMs{ 0 };
+			double smoothedDelayMs{ 0 };
 		};
 
+	public:
+		// Must be a power of 2.
+		static constexpr size_t SentInfosSize{ 1024u };
+		static constexpr size_t TrendlineWindowSize{ 20u };
+		static constexpr uint32_t MinBitrate{ 30000u };
+
 	public:
 		SenderBandwidthEstimator(
 		  RTC::SenderBandwidthEstimator::Listener* listener, uint32_t initialAvailableBitrate);
@@ -89,12 +96,43 @@ namespace RTC
 	public:
 		void TransportConnected();
 		void TransportDisconnected();
-		void RtpPacketSent(SentInfo& sentInfo);
-		void ReceiveRtcpTransportFeedback(const RTC::RTCP::FeedbackRtpTransportPacket* feedback);
-		void EstimateAvailableBitrate(CummulativeResult& cummulativeResult);
+		void RtpPacketSent(const SentInfo& sentInfo);
+		void ReceiveRtcpTransportFeedback(
+		  const RTC::RTCP::FeedbackRtpTransportPacket* feedback, uint64_t nowMs);
 		void UpdateRtt(float rtt);
-		uint32_t GetAvailableBitrate() const;
-		void RescheduleNextAvailableBitrateEvent();
+		// Restart the estimation from the given bitrate since packets are now sent
+		// through another network path.
+		void PathChanged(uint32_t startBitrate);
+		// 0 means no limit.
+		void SetMaxBitrate(uint32_t maxBitrate);
+		uint32_t GetAvailableBitrate() const
+		{
+			return this->availableBitrate;
+		}
+		BandwidthUsage GetBandwidthUsage() const
+		{
+			return this->bandwidthUsage;
+		}
+		bool IsInAlr() const
+		{
+			return this->inAlr;
+		}
+		// Smoothed fraction of the packets reported as lost.
+		double GetPacketLoss() const
+		{
+			return this->packetLoss;
+		}
+
+	private:
+		void Reset();
+		void ReceivePacket(uint64_t sentAtMs, int64_t receivedAtMs);
+		void UpdateTrendline(double delayVariationMs, int64_t receivedAtMs);
+		void DetectOveruse(double trend, int64_t receivedAtMs);
+		void UpdateThreshold(double modifiedTrend, int64_t receivedAtMs);
+		void UpdateAlr(uint64_t nowMs);
+		void UpdateRateControl(uint32_t ackedBitrate, uint64_t nowMs);
+		void UpdateLossBasedControl(
+		  double packetLoss, uint32_t previousAvailableBitrate, uint64_t nowMs);
 
 	private:
 		// Passed by argument.
@@ -102,11 +140,37 @@ namespace RTC
 		// Others.
 		uint32_t initialAvailableBitrate{ 0u };
 		uint32_t availableBitrate{ 0u };
-		uint64_t lastAvailableBitrateEventAtMs{ 0u };
-		absl::btree_map<uint16_t, SentInfo, RTC::SeqManager<uint16_t>::SeqLowerThan> sentInfos;
+		uint32_t maxBitrate{ 0u };
 		float rtt{ 0 }; // Round trip time in ms.
-		CummulativeResult cummulativeResult;
-		CummulativeResult probationCummulativeResult;
+		uint64_t startedAtMs{ 0u };
+		std::array<SentInfo, SentInfosSize> sentInfos{};
+		// Delay based.
+		PacketGroup currentGroup;
+		PacketGroup previousGroup;
+		std::array<TrendlineSample, TrendlineWindowSize> trendlineSamples{};
+		size_t trendlineSamplesIdx{ 0u };
+		size_t numTrendlineSamples{ 0u };
+		size_t numDeltas{ 0u };
+		int64_t firstReceivedAtMs{ -1 };
+		double accumulatedDelayMs{ 0 };
+		double smoothedDelayMs{ 0 };
+		double trend{ 0 };
+		double previousTrend{ 0 };
+		double threshold{ 0 };
+		int64_t thresholdUpdatedAtMs{ -1 };
+		size_t overuseCounter{ 0u };
+		BandwidthUsage bandwidthUsage{ BandwidthUsage::NORMAL };
+		// Rate control.
+		RateControlState rateControlState{ RateControlState::HOLD };
+		uint32_t linkCapacity{ 0u };
+		uint64_t rateControlUpdatedAtMs{ 0u };
+		uint64_t lastDecreaseAtMs{ 0u };
+		RTC::RateCalculator ackedTransmission;
+		// Loss based.
+		double packetLoss{ 0 };
+		uint64_t lastLossDecreaseAtMs{ 0u };
+		// ALR.
+		bool inAlr{ false };
 		RTC::RateCalculator sendTransmission;
 		RTC::TrendCalculator sendTransmissionTrend;
 	};
@@ -3,15 +3,25 @@
 
 #include "common.hpp"
 #include <limits> // std::numeric_limits
-#include <set>
+#include <vector>
 
 namespace RTC
 {
+	/**
+	 * Dropped inputs are tracked in a ring bitmap with one bit per input,
+	 * indexed by the input modulo RingSize, which is only allocated once the
+	 * first input is dropped. Dropped inputs leaving the ring are folded into
+	 * the base.
+	 */
 	template<typename T>
 	class SeqManager
 	{
 	public:
 		static constexpr T MaxValue = std::numeric_limits<T>::max();
+		// Number of inputs tracked by the ring (a power of 2, multiple of 64). It
+		// covers half of the range of T, up to 32768 inputs.
+		static constexpr size_t RingSize =
+		  size_t{ MaxValue } / 2u + 1u < 32768u ? size_t{ MaxValue } / 2u + 1u : 32768u;
 
 	public:
 		struct SeqLowerThan
@@ -39,15 +49,26 @@ namespace RTC
 		void Sync(T input);
 		void Drop(T input);
 		void Offset(T offset);
+		// The next synced input is output right after the given output, so this
+		// continues the output of another SeqManager.
+		void SetMaxOutput(T maxOutput);
 		bool Input(const T input, T& output);
 		T GetMaxInput() const;
 		T GetMaxOutput() const;
 
+	private:
+		void AdvanceDropped(T input);
+		size_t CountDropped(T inputStart, size_t count, bool clear = false);
+		bool IsDropped(T input) const;
+
 	private:
 		T base{ 0 };
 		T maxOutput{ 0 };
 		T maxInput{ 0 };
-		std::set<T, SeqLowerThan> dropped;
+		// Ring of dropped inputs, covering (droppedHead - RingSize, droppedHead].
+		std::vector<uint64_t> droppedBits;
+		size_t numDropped{ 0u };
+		T droppedHead{ 0 };
 	};
 } // namespace RTC
 
@@ -0,0 +1,86 @@
+#ifndef MS_RTC_SHARED_UDP_SOCKET_HPP
+#define MS_RTC_SHARED_UDP_SOCKET_HPP
+
+#include "common.hpp"
+#include "RTC/TransportTuple.hpp"
+#include "RTC/UdpSocket.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <string>
+#include <vector>
+
+namespace RTC
+{
+	/**
+	 * UDP socket shared by many PlainTransports of the same worker so ingesting
+	 * hundreds of server side streams does not take a port (and a socket read)
+	 * each. Sockets are shared by transports asking for the same listen IP and
+	 * port (0 meaning any).
+	 *
+	 * Packets are demultiplexed by source tuple. A packet coming from an unknown
+	 * tuple is offered to the listeners that are not bound to a tuple yet and the
+	 * tuple is bound to the first one that claims it (a comedia PlainTransport
+	 * claims it if its SSRC belongs to one of its Producers).
+	 */
+	class SharedUdpSocket : public RTC::UdpSocket::Listener
+	{
+	public:
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			virtual void OnSharedUdpSocketPacketReceived(
+			  RTC::SharedUdpSocket* sharedUdpSocket,
+			  RTC::TransportTuple* tuple,
+			  const uint8_t* data,
+			  size_t len) = 0;
+			virtual bool OnSharedUdpSocketClaimPacket(
+			  RTC::SharedUdpSocket* sharedUdpSocket, const uint8_t* data, size_t len) = 0;
+		};
+
+	private:
+		thread_local static absl::flat_hash_map<std::string, SharedUdpSocket*> sharedUdpSockets;
+
+	public:
+		// This may throw.
+		static SharedUdpSocket* Acquire(Listener* listener, std::string& ip, uint16_t port);
+		static void Release(SharedUdpSocket* sharedUdpSocket, Listener* listener);
+
+	private:
+		SharedUdpSocket(const std::string& key, std::string& ip, uint16_t port);
+		~SharedUdpSocket() override;
+
+	public:
+		RTC::UdpSocket* GetUdpSocket() const
+		{
+			return this->udpSocket;
+		}
+		size_t GetNumListeners() const
+		{
+			return this->listeners.size();
+		}
+		void BindTuple(Listener* listener, const RTC::TransportTuple* tuple);
+		void UnbindTuple(Listener* listener);
+
+	private:
+		bool IsBound(Listener* listener) const;
+
+		/* Pure virtual methods inherited from RTC::UdpSocket::Listener. */
+	public:
+		void OnUdpSocketPacketReceived(
+		  RTC::UdpSocket* socket, const uint8_t* data, size_t len, const struct sockaddr* remoteAddr) override;
+
+	private:
+		// Passed by argument.
+		std::string key;
+		// Allocated by this.
+		RTC::UdpSocket* udpSocket{ nullptr };
+		// Others.
+		std::vector<Listener*> listeners;
+		absl::flat_hash_map<RTC::TransportTuple::Key, Listener*> mapTupleListener;
+		absl::flat_hash_map<Listener*, RTC::TransportTuple::Key> mapListenerTuple;
+	};
+} // namespace RTC
+
+#endif
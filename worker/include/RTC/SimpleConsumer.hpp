@@ -2,6 +2,7 @@
 #define MS_RTC_SIMPLE_CONSUMER_HPP
 
 #include "RTC/Consumer.hpp"
+#include "RTC/RtpHeaderTemplate.hpp"
 #include "RTC/RtpStreamSend.hpp"
 #include "RTC/SeqManager.hpp"
 
@@ -21,6 +22,7 @@ namespace RTC
 		void FillJson(json& jsonObject) const override;
 		void FillJsonStats(json& jsonArray) const override;
 		void FillJsonScore(json& jsonObject) const override;
+		void FillJsonSendState(json& jsonObject) const override;
 		void HandleRequest(Channel::ChannelRequest* request) override;
 		bool IsActive() const override
 		{
@@ -45,6 +47,10 @@ namespace RTC
 		{
 			return this->rtpStreams;
 		}
+		size_t GetObjectSize() const override
+		{
+			return sizeof(*this);
+		}
 		void GetRtcp(RTC::RTCP::CompoundPacket* packet, RTC::RtpStreamSend* rtpStream, uint64_t nowMs) override;
 		void NeedWorstRemoteFractionLost(uint32_t mappedSsrc, uint8_t& worstRemoteFractionLost) override;
 		void ReceiveNack(RTC::RTCP::FeedbackRtpNackPacket* nackPacket) override;
@@ -53,20 +59,27 @@ namespace RTC
 		void ReceiveRtcpXrReceiverReferenceTime(RTC::RTCP::ReceiverReferenceTime* report) override;
 		uint32_t GetTransmissionRate(uint64_t nowMs) override;
 		float GetRtt() const override;
+		bool SendKeyFrameCache(const std::vector<RTC::RtpPacket*>& packets) override;
+		void DropRtpPacket(RTC::RtpPacket* packet) override;
 
 	private:
 		void UserOnTransportConnected() override;
 		void UserOnTransportDisconnected() override;
 		void UserOnPaused() override;
 		void UserOnResumed() override;
+		template<RTC::Media::Kind Kind>
+		void ForwardRtpPacket(RTC::RtpPacket* packet);
 		void CreateRtpStream();
 		void RequestKeyFrame();
+		void DropSeq(uint16_t seq);
 		void EmitScore() const;
 
 		/* Pure virtual methods inherited from RtpStreamSend::Listener. */
 	public:
 		void OnRtpStreamScore(RTC::RtpStream* rtpStream, uint8_t score, uint8_t previousScore) override;
-		void OnRtpStreamRetransmitRtpPacket(RTC::RtpStreamSend* rtpStream, RTC::RtpPacket* packet) override;
+		void OnRtpStreamRetransmitRtpPackets(
+		  RTC::RtpStreamSend* rtpStream, RTC::RtpPacket** packets, size_t count) override;
+		void OnRtpStreamSendFecPacket(RTC::RtpStreamSend* rtpStream, RTC::RtpPacket* packet) override;
 
 	private:
 		// Allocated by this.
@@ -75,8 +88,12 @@ namespace RTC
 		std::vector<RTC::RtpStreamSend*> rtpStreams;
 		RTC::RtpStream* producerRtpStream{ nullptr };
 		bool keyFrameSupported{ false };
+		bool ignoreDtx{ false };
 		bool syncRequired{ false };
 		RTC::SeqManager<uint16_t> rtpSeqManager;
+		// Added to the output of the ConsumerGroup (if any).
+		uint16_t groupSeqOffset{ 0u };
+		RTC::RtpHeaderTemplate headerTemplate;
 		bool managingBitrate{ false };
 	};
 } // namespace RTC
@@ -3,8 +3,10 @@
 
 #include "RTC/Codecs/PayloadDescriptorHandler.hpp"
 #include "RTC/Consumer.hpp"
+#include "RTC/RtpHeaderTemplate.hpp"
 #include "RTC/RtpStreamSend.hpp"
 #include "RTC/SeqManager.hpp"
+#include <array>
 
 namespace RTC
 {
@@ -22,7 +24,9 @@ namespace RTC
 		void FillJson(json& jsonObject) const override;
 		void FillJsonStats(json& jsonArray) const override;
 		void FillJsonScore(json& jsonObject) const override;
+		void FillJsonSendState(json& jsonObject) const override;
 		void HandleRequest(Channel::ChannelRequest* request) override;
+		void SetOverloadLevel(OverloadController::Level level) override;
 		RTC::Consumer::Layers GetPreferredLayers() const override
 		{
 			RTC::Consumer::Layers layers;
@@ -62,6 +66,10 @@ namespace RTC
 		{
 			return this->rtpStreams;
 		}
+		size_t GetObjectSize() const override
+		{
+			return sizeof(*this);
+		}
 		void NeedWorstRemoteFractionLost(uint32_t mappedSsrc, uint8_t& worstRemoteFractionLost) override;
 		void ReceiveNack(RTC::RTCP::FeedbackRtpNackPacket* nackPacket) override;
 		void ReceiveKeyFrameRequest(RTC::RTCP::FeedbackPs::MessageType messageType, uint32_t ssrc) override;
@@ -69,6 +77,7 @@ namespace RTC
 		void ReceiveRtcpXrReceiverReferenceTime(RTC::RTCP::ReceiverReferenceTime* report) override;
 		uint32_t GetTransmissionRate(uint64_t nowMs) override;
 		float GetRtt() const override;
+		bool SendKeyFrameCache(const std::vector<RTC::RtpPacket*>& packets) override;
 
 	private:
 		void UserOnTransportConnected() override;
@@ -79,6 +88,7 @@ namespace RTC
 		void RequestKeyFrames();
 		void RequestKeyFrameForTargetSpatialLayer();
 		void RequestKeyFrameForCurrentSpatialLayer();
+		bool IsThumbnailPacket(const RTC::RtpPacket* packet);
 		void MayChangeLayers(bool force = false);
 		bool RecalculateTargetLayers(int16_t& newTargetSpatialLayer, int16_t& newTargetTemporalLayer) const;
 		void UpdateTargetLayers(int16_t newTargetSpatialLayer, int16_t newTargetTemporalLayer);
@@ -92,7 +102,9 @@ namespace RTC
 		/* Pure virtual methods inherited from RtpStreamSend::Listener. */
 	public:
 		void OnRtpStreamScore(RTC::RtpStream* rtpStream, uint8_t score, uint8_t previousScore) override;
-		void OnRtpStreamRetransmitRtpPacket(RTC::RtpStreamSend* rtpStream, RTC::RtpPacket* packet) override;
+		void OnRtpStreamRetransmitRtpPackets(
+		  RTC::RtpStreamSend* rtpStream, RTC::RtpPacket** packets, size_t count) override;
+		void OnRtpStreamSendFecPacket(RTC::RtpStreamSend* rtpStream, RTC::RtpPacket* packet) override;
 
 	private:
 		// Allocated by this.
@@ -105,6 +117,7 @@ namespace RTC
 		int16_t spatialLayerToSync{ -1 };
 		bool lastSentPacketHasMarker{ false };
 		RTC::SeqManager<uint16_t> rtpSeqManager;
+		RTC::RtpHeaderTemplate headerTemplate;
 		int16_t preferredSpatialLayer{ -1 };
 		int16_t preferredTemporalLayer{ -1 };
 		int16_t provisionalTargetSpatialLayer{ -1 };
@@ -114,9 +127,29 @@ namespace RTC
 		int16_t currentSpatialLayer{ -1 };
 		int16_t tsReferenceSpatialLayer{ -1 }; // Used for RTP TS sync.
 		std::unique_ptr<RTC::Codecs::EncodingContext> encodingContext;
+		// Payload processing functions of the codec.
+		RTC::Codecs::ProcessPayloadFn processPayloadFn{ nullptr };
+		RTC::Codecs::RestorePayloadFn restorePayloadFn{ nullptr };
 		uint32_t tsOffset{ 0u }; // RTP Timestamp offset.
 		bool keyFrameForTsOffsetRequested{ false };
 		uint64_t lastBweDowngradeAtMs{ 0u }; // Last time we moved to lower spatial layer due to BWE.
+		// Key frame cache of the target spatial layer being sent.
+		bool sendingKeyFrameCache{ false };
+		// Original and rewritten RTP timestamp of the last frame of the key frame
+		// cache, if its RTP timestamps are rewritten.
+		bool keyFrameCacheTsMapped{ false };
+		uint32_t keyFrameCacheOrigTs{ 0u };
+		uint32_t keyFrameCacheTs{ 0u };
+		// Spatial layer switch latency.
+		uint64_t targetSpatialLayerChangedAtMs{ 0u };
+		std::array<uint32_t, 7> spatialLayerSwitchLatencyCounts{};
+		uint32_t keyFrameCacheSpatialLayerSwitches{ 0u };
+		// Thumbnail mode (just key frames are sent, requested at this frame rate).
+		float thumbnailFramerate{ 0 };
+		uint64_t thumbnailIntervalMs{ 0u };
+		uint64_t lastThumbnailAtMs{ 0u };
+		uint64_t thumbnailRequestedAtMs{ 0u };
+		uint32_t thumbnailTs{ 0u }; // Original RTP timestamp of the last key frame sent.
 	};
 } // namespace RTC
 
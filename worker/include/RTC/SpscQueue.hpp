@@ -0,0 +1,84 @@
+#ifndef MS_RTC_SPSC_QUEUE_HPP
+#define MS_RTC_SPSC_QUEUE_HPP
+
+#include "common.hpp"
+#include <atomic>
+#include <memory> // std::unique_ptr
+
+namespace RTC
+{
+	/**
+	 * Bounded lock-free queue with a single producer thread and a single
+	 * consumer thread. Items are preallocated and written/read in place so no
+	 * memory is allocated once the queue is created.
+	 *
+	 * Producer: Reserve() a slot, fill it and Commit() it.
+	 * Consumer: Front() to access the oldest item and Pop() once done with it.
+	 */
+	template<typename T>
+	class SpscQueue
+	{
+	public:
+		// Capacity is rounded up to the next power of 2.
+		explicit SpscQueue(size_t capacity)
+		{
+			while (this->capacity < capacity)
+			{
+				this->capacity <<= 1;
+			}
+
+			this->items.reset(new T[this->capacity]);
+		}
+
+	public:
+		size_t GetCapacity() const
+		{
+			return this->capacity;
+		}
+		// Approximate if called while the other thread is operating.
+		size_t GetSize() const
+		{
+			return this->tail.load(std::memory_order_acquire) -
+			       this->head.load(std::memory_order_acquire);
+		}
+		// Producer side. Returns nullptr if the queue is full.
+		T* Reserve()
+		{
+			const size_t tail = this->tail.load(std::memory_order_relaxed);
+
+			if (tail - this->head.load(std::memory_order_acquire) == this->capacity)
+				return nullptr;
+
+			return std::addressof(this->items[tail & (this->capacity - 1)]);
+		}
+		// Producer side. Publishes the slot returned by Reserve().
+		void Commit()
+		{
+			this->tail.store(this->tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+		// Consumer side. Returns nullptr if the queue is empty.
+		T* Front()
+		{
+			const size_t head = this->head.load(std::memory_order_relaxed);
+
+			if (head == this->tail.load(std::memory_order_acquire))
+				return nullptr;
+
+			return std::addressof(this->items[head & (this->capacity - 1)]);
+		}
+		// Consumer side. Releases the slot returned by Front().
+		void Pop()
+		{
+			this->head.store(this->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+	private:
+		size_t capacity{ 1u };
+		std::unique_ptr<T[]> items;
+		// Kept in different cache lines so producer and consumer don't contend.
+		alignas(64) std::atomic<size_t> head{ 0u };
+		alignas(64) std::atomic<size_t> tail{ 0u };
+	};
+} // namespace RTC
+
+#endif
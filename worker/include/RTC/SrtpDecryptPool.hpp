@@ -0,0 +1,165 @@
+#ifndef MS_RTC_SRTP_DECRYPT_POOL_HPP
+#define MS_RTC_SRTP_DECRYPT_POOL_HPP
+
+#include "common.hpp"
+#include "RTC/RtpPacket.hpp" // RTC::MtuSize
+#include "RTC/SrtpSession.hpp"
+#include "RTC/TransportTuple.hpp"
+#include <uv.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace RTC
+{
+	/**
+	 * Per worker pool of threads that decrypt received SRTP and SRTCP packets
+	 * out of the event loop thread (disabled unless the srtpDecryptThreads
+	 * setting is set).
+	 *
+	 * Datagrams received during a loop iteration (f.e. those read by a single
+	 * recvmmsg() call) form a batch which is submitted to the pool before the
+	 * loop blocks for I/O (or once it's full). As in RTC::SrtpEncryptPool every
+	 * SrtpSession is assigned to a single pool thread, so libsrtp contexts are
+	 * never used concurrently, and each pool thread decrypts its packets of a
+	 * batch with SrtpSession::DecryptBatch(). Once all the pool threads are
+	 * done with a batch the loop is woken up and decrypted packets are handed
+	 * to their listeners in the same order they were received.
+	 *
+	 * Just packets received over UDP are queued. The SRTCP packets of a
+	 * session must go through the pool along with its SRTP ones so the session
+	 * is not used by the loop thread meanwhile.
+	 */
+	class SrtpDecryptPool
+	{
+	public:
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			virtual void OnSrtpDecryptPoolRtpPacketDecrypted(
+			  const RTC::TransportTuple* tuple, uint8_t* data, size_t len) = 0;
+			virtual void OnSrtpDecryptPoolRtcpPacketDecrypted(
+			  const RTC::TransportTuple* tuple, uint8_t* data, size_t len) = 0;
+		};
+
+	public:
+		// Max number of threads.
+		static constexpr size_t MaxThreads{ 16u };
+		// Max number of packets in a batch.
+		static constexpr size_t MaxBatchSize{ 64u };
+		// Max size of a SRTP packet (bigger ones must be decrypted by the caller).
+		static constexpr size_t MaxPacketSize{ RTC::MtuSize + 100 };
+
+	private:
+		struct Job
+		{
+			Listener* listener;
+			RTC::SrtpSession* session;
+			size_t threadIdx;
+			// Copy of the tuple the packet was received from.
+			std::optional<RTC::TransportTuple> tuple;
+			uint64_t ingressTimeNs;
+			int len;
+			bool rtcp;
+			bool decrypted;
+			alignas(8) uint8_t data[MaxPacketSize];
+		};
+
+		struct Batch
+		{
+			std::array<Job, MaxBatchSize> jobs;
+			size_t numJobs{ 0u };
+			// Number of pool threads still processing this batch.
+			std::atomic<size_t> pendingThreads{ 0u };
+		};
+
+		// State shared with the pool threads.
+		struct Shared
+		{
+			std::mutex mutex;
+			// Signaled when batches are submitted or the pool is stopped.
+			std::condition_variable submittedCv;
+			// Signaled when a pool thread is done with a batch.
+			std::condition_variable doneCv;
+			// Submitted batches pending to be processed by each pool thread.
+			std::vector<std::deque<Batch*>> queues;
+			bool stopping{ false };
+			uv_async_t* uvAsyncHandle{ nullptr };
+		};
+
+	public:
+		static void ClassInit(size_t numThreads);
+		static void ClassDestroy();
+		static bool IsEnabled()
+		{
+			return SrtpDecryptPool::shared != nullptr;
+		}
+		// Queue the SRTP or SRTCP packet for decryption. Return false if it
+		// cannot be queued (so the caller must decrypt it after calling
+		// Flush()).
+		static bool DecryptSrtp(
+		  Listener* listener,
+		  RTC::SrtpSession* session,
+		  const RTC::TransportTuple* tuple,
+		  const uint8_t* data,
+		  size_t len)
+		{
+			return Queue(listener, session, tuple, data, len, false);
+		}
+		static bool DecryptSrtcp(
+		  Listener* listener,
+		  RTC::SrtpSession* session,
+		  const RTC::TransportTuple* tuple,
+		  const uint8_t* data,
+		  size_t len)
+		{
+			return Queue(listener, session, tuple, data, len, true);
+		}
+		// Waits until no queued packet of the listener is being decrypted. Must be
+		// called before using (i.e. decrypting packets or removing streams) its
+		// SrtpSession in the loop thread.
+		static void Flush(Listener* listener);
+		// Discards queued packets of the listener and waits until none of them is
+		// being decrypted. Must be called before deleting the listener or its
+		// SrtpSession.
+		static void RemoveListener(Listener* listener);
+
+		/* Callbacks fired by UV events. */
+	public:
+		static void OnUvPrepare();
+		static void OnUvAsync();
+
+	private:
+		static bool Queue(
+		  Listener* listener,
+		  RTC::SrtpSession* session,
+		  const RTC::TransportTuple* tuple,
+		  const uint8_t* data,
+		  size_t len,
+		  bool rtcp);
+		static void Submit();
+		static bool HasJobs(const Batch* batch, const Listener* listener);
+		static void ThreadMain(Shared* shared, size_t threadIdx);
+
+	private:
+		thread_local static Shared* shared;
+		thread_local static std::vector<std::thread> threads;
+		thread_local static uv_prepare_t* uvPrepareHandle;
+		// Batch being filled in this loop iteration.
+		thread_local static Batch* currentBatch;
+		// Submitted batches in submission order.
+		thread_local static std::deque<Batch*> submittedBatches;
+		thread_local static std::vector<Batch*> freeBatches;
+		thread_local static bool delivering;
+	};
+} // namespace RTC
+
+#endif
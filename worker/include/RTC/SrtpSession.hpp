@@ -2,8 +2,11 @@
 #define MS_RTC_SRTP_SESSION_HPP
 
 #include "common.hpp"
+#include <nlohmann/json.hpp>
 #include <srtp.h>
 
+using json = nlohmann::json;
+
 namespace RTC
 {
 	class SrtpSession
@@ -25,11 +28,48 @@ namespace RTC
 			OUTBOUND
 		};
 
+	public:
+		// RTP packet to be encrypted in place by EncryptRtpBatch().
+		struct RtpBatchItem
+		{
+			SrtpSession* session;
+			// Must have room for len + MaxTrailerSize bytes.
+			uint8_t* data;
+			int len;
+			bool encrypted;
+		};
+
+		// SRTP or SRTCP packet to be decrypted in place by DecryptBatch().
+		struct DecryptBatchItem
+		{
+			SrtpSession* session;
+			uint8_t* data;
+			int len;
+			bool rtcp;
+			bool decrypted;
+		};
+
+	public:
+		// Max number of bytes added by encryption (auth tag and MKI).
+		static constexpr size_t MaxTrailerSize{ SRTP_MAX_TRAILER_LEN };
+
 	public:
 		static void ClassInit();
+		// Encrypts in place the RTP packets of many sessions, all the packets of
+		// a session one after another (keeping their order) so its libsrtp
+		// context and keys stay hot in cache. Returns the number of encrypted
+		// packets. Like ProtectRtp() it does not log.
+		static size_t EncryptRtpBatch(RtpBatchItem* items, size_t numItems);
+		// Same for received SRTP and SRTCP packets. Returns the number of
+		// decrypted packets.
+		static size_t DecryptBatch(DecryptBatchItem* items, size_t numItems);
+		// Fills the number of SrtpSessions of the worker and how many of them
+		// have allocated their libsrtp context.
+		static void FillJsonUsage(json& jsonObject);
 
 	private:
 		static void OnSrtpEvent(srtp_event_data_t* data);
+		static void FillPolicy(srtp_policy_t* policy, Type type, CryptoSuite cryptoSuite);
 
 	public:
 		SrtpSession(Type type, CryptoSuite cryptoSuite, uint8_t* key, size_t keyLen);
@@ -37,17 +77,60 @@ namespace RTC
 
 	public:
 		bool EncryptRtp(const uint8_t** data, int* len);
+		// Encrypts the RTP packet into the given buffer, which must have room for
+		// len + MaxTrailerSize bytes.
+		bool EncryptRtp(const uint8_t* data, int* len, uint8_t* buffer);
+		// Encrypts the RTP packet in place (data must have room for len +
+		// MaxTrailerSize bytes). It does not log so it can be called from any
+		// thread (as long as the session is not concurrently used). It fails if
+		// the libsrtp context is not allocated yet.
+		bool ProtectRtp(uint8_t* data, int* len)
+		{
+			return this->session &&
+			       srtp_protect(this->session, static_cast<void*>(data), len) == srtp_err_status_ok;
+		}
 		bool DecryptSrtp(uint8_t* data, int* len);
+		// Decrypt the SRTP or SRTCP packet in place. Like ProtectRtp() they don't
+		// log and fail if the libsrtp context is not allocated yet.
+		bool UnprotectRtp(uint8_t* data, int* len)
+		{
+			return this->session &&
+			       srtp_unprotect(this->session, static_cast<void*>(data), len) == srtp_err_status_ok;
+		}
+		bool UnprotectRtcp(uint8_t* data, int* len)
+		{
+			return this->session &&
+			       srtp_unprotect_rtcp(this->session, static_cast<void*>(data), len) ==
+			         srtp_err_status_ok;
+		}
 		bool EncryptRtcp(const uint8_t** data, int* len);
 		bool DecryptSrtcp(uint8_t* data, int* len);
 		void RemoveStream(uint32_t ssrc)
 		{
-			srtp_remove_stream(this->session, uint32_t{ htonl(ssrc) });
+			if (this->session)
+				srtp_remove_stream(this->session, uint32_t{ htonl(ssrc) });
 		}
+		bool IsAllocated() const
+		{
+			return this->session != nullptr;
+		}
+
+	private:
+		bool Allocate();
 
 	private:
-		// Allocated by this.
+		// Passed by argument.
+		Type type;
+		CryptoSuite cryptoSuite;
+		uint8_t key[SRTP_MAX_KEY_LEN];
+		size_t keyLen{ 0u };
+		// Allocated by this (when the first packet is processed, so sessions
+		// which never carry media just hold their key).
 		srtp_t session{ nullptr };
+
+	private:
+		thread_local static size_t numSessions;
+		thread_local static size_t numAllocatedSessions;
 	};
 } // namespace RTC
 
@@ -0,0 +1,32 @@
+#ifndef MS_RTC_STATS_DELTA_HPP
+#define MS_RTC_STATS_DELTA_HPP
+
+#include "common.hpp"
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace RTC
+{
+	/**
+	 * Computes the stats fields changed since the previous getStats request of
+	 * an entity, so callers polling stats frequently just receive what changed.
+	 *
+	 * Every response carries a cursor that must be given in the next request.
+	 * If it does not match the last given one (or the number of stats entries
+	 * changed) full stats are returned. Fields "type" and "ssrc" are always
+	 * included so entries can be identified.
+	 */
+	class StatsDelta
+	{
+	public:
+		// Fills jsonObject with the cursor, whether stats are full and the stats.
+		void FillJson(json& jsonObject, json& stats, uint64_t cursor);
+
+	private:
+		json lastStats;
+		uint64_t cursor{ 0u };
+	};
+} // namespace RTC
+
+#endif
@@ -2,6 +2,7 @@
 #define MS_RTC_STUN_PACKET_HPP
 
 #include "common.hpp"
+#include "Utils.hpp"
 #include <string>
 
 namespace RTC
@@ -95,6 +96,10 @@ namespace RTC
 		{
 			return this->size;
 		}
+		const uint8_t* GetTransactionId() const
+		{
+			return this->transactionId;
+		}
 		void SetUsername(const char* username, size_t len)
 		{
 			this->username.assign(username, len);
@@ -181,10 +186,21 @@ namespace RTC
 		}
 		Authentication CheckAuthentication(
 		  const std::string& localUsername, const std::string& localPassword);
+		// Same as above with the HMAC-SHA1 keyed with the local password.
+		Authentication CheckAuthentication(
+		  const std::string& localUsername, Utils::Crypto::HmacSha1& localHmacSha1);
 		StunPacket* CreateSuccessResponse();
 		StunPacket* CreateErrorResponse(uint16_t errorCode);
 		void Authenticate(const std::string& password);
+		// Same as above with the HMAC-SHA1 keyed with the password. It must be
+		// alive until Serialize() is called.
+		void Authenticate(Utils::Crypto::HmacSha1& hmacSha1);
 		void Serialize(uint8_t* buffer);
+		// Makes an already serialized Binding success response answer another
+		// request of the same tuple by just rewriting the transaction ID, the
+		// IPv6 XOR-MAPPED-ADDRESS (which depends on it), MESSAGE-INTEGRITY and
+		// FINGERPRINT.
+		void UpdateTransactionId(const uint8_t* transactionId, Utils::Crypto::HmacSha1& hmacSha1);
 
 	private:
 		// Passed by argument.
@@ -206,6 +222,7 @@ namespace RTC
 		const struct sockaddr* xorMappedAddress{ nullptr }; // 8 or 20 bytes.
 		uint16_t errorCode{ 0u };                           // 4 bytes (no reason phrase).
 		std::string password;
+		Utils::Crypto::HmacSha1* hmacSha1{ nullptr };
 	};
 } // namespace RTC
 
@@ -3,6 +3,7 @@
 
 #include "RTC/Codecs/PayloadDescriptorHandler.hpp"
 #include "RTC/Consumer.hpp"
+#include "RTC/RtpHeaderTemplate.hpp"
 #include "RTC/RtpStreamSend.hpp"
 #include "RTC/SeqManager.hpp"
 #include <map>
@@ -23,7 +24,9 @@ namespace RTC
 		void FillJson(json& jsonObject) const override;
 		void FillJsonStats(json& jsonArray) const override;
 		void FillJsonScore(json& jsonObject) const override;
+		void FillJsonSendState(json& jsonObject) const override;
 		void HandleRequest(Channel::ChannelRequest* request) override;
+		void SetOverloadLevel(OverloadController::Level level) override;
 		RTC::Consumer::Layers GetPreferredLayers() const override
 		{
 			RTC::Consumer::Layers layers;
@@ -57,6 +60,10 @@ namespace RTC
 		{
 			return this->rtpStreams;
 		}
+		size_t GetObjectSize() const override
+		{
+			return sizeof(*this);
+		}
 		void NeedWorstRemoteFractionLost(uint32_t mappedSsrc, uint8_t& worstRemoteFractionLost) override;
 		void ReceiveNack(RTC::RTCP::FeedbackRtpNackPacket* nackPacket) override;
 		void ReceiveKeyFrameRequest(RTC::RTCP::FeedbackPs::MessageType messageType, uint32_t ssrc) override;
@@ -81,7 +88,9 @@ namespace RTC
 		/* Pure virtual methods inherited from RtpStreamSend::Listener. */
 	public:
 		void OnRtpStreamScore(RTC::RtpStream* rtpStream, uint8_t score, uint8_t previousScore) override;
-		void OnRtpStreamRetransmitRtpPacket(RTC::RtpStreamSend* rtpStream, RTC::RtpPacket* packet) override;
+		void OnRtpStreamRetransmitRtpPackets(
+		  RTC::RtpStreamSend* rtpStream, RTC::RtpPacket** packets, size_t count) override;
+		void OnRtpStreamSendFecPacket(RTC::RtpStreamSend* rtpStream, RTC::RtpPacket* packet) override;
 
 	private:
 		// Allocated by this.
@@ -91,12 +100,20 @@ namespace RTC
 		RTC::RtpStream* producerRtpStream{ nullptr };
 		bool syncRequired{ false };
 		RTC::SeqManager<uint16_t> rtpSeqManager;
+		RTC::RtpHeaderTemplate headerTemplate;
 		int16_t preferredSpatialLayer{ -1 };
 		int16_t preferredTemporalLayer{ -1 };
 		int16_t provisionalTargetSpatialLayer{ -1 };
 		int16_t provisionalTargetTemporalLayer{ -1 };
 		std::unique_ptr<RTC::Codecs::EncodingContext> encodingContext;
+		// Payload processing functions of the codec.
+		RTC::Codecs::ProcessPayloadFn processPayloadFn{ nullptr };
+		RTC::Codecs::RestorePayloadFn restorePayloadFn{ nullptr };
 		uint64_t lastBweDowngradeAtMs{ 0u }; // Last time we moved to lower spatial layer due to BWE.
+		// Since when a spatial layer upgrade waits for a switch point (0 if none).
+		uint64_t spatialUpgradePendingSinceMs{ 0u };
+		// Spatial layer upgrades done without requesting a key frame.
+		uint32_t keyFrameRequestsAvoided{ 0u };
 	};
 } // namespace RTC
 
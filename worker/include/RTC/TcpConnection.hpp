@@ -2,6 +2,7 @@
 #define MS_RTC_TCP_CONNECTION_HPP
 
 #include "common.hpp"
+#include "RTC/TurnSession.hpp"
 #include "handles/TcpConnectionHandler.hpp"
 
 namespace RTC
@@ -26,6 +27,10 @@ namespace RTC
 	public:
 		void Send(const uint8_t* data, size_t len, ::TcpConnectionHandler::onSendCallback* cb);
 
+	private:
+		// Returns false if the connection was closed (and deallocated).
+		bool ProcessTurnFrame(const uint8_t* frame, size_t len);
+
 		/* Pure virtual methods inherited from ::TcpConnectionHandler. */
 	public:
 		void UserOnTcpConnectionRead() override;
@@ -33,8 +38,12 @@ namespace RTC
 	private:
 		// Passed by argument.
 		Listener* listener{ nullptr };
+		// Allocated by this.
+		// Set if the peer is a TURN client.
+		RTC::TurnSession* turnSession{ nullptr };
 		// Others.
 		size_t frameStart{ 0u }; // Where the latest frame starts.
+		bool framingDetected{ false };
 	};
 } // namespace RTC
 
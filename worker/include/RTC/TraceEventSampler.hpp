@@ -0,0 +1,87 @@
+#ifndef MS_RTC_TRACE_EVENT_SAMPLER_HPP
+#define MS_RTC_TRACE_EVENT_SAMPLER_HPP
+
+#include "common.hpp"
+#include "handles/Timer.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <nlohmann/json.hpp>
+#include <deque>
+#include <string>
+
+using json = nlohmann::json;
+
+namespace RTC
+{
+	/**
+	 * Options given in enableTraceEvent() of Transports, Producers and Consumers
+	 * so tracing can be kept enabled under load:
+	 *
+	 * - sampleRate: just 1 in N per packet events (rtp, probation) is traced.
+	 * - mode "event": traced events are notified (default).
+	 * - mode "summary": no event is notified but, every second, a "summary"
+	 *   event with the number of events of each type (not sampled).
+	 * - mode "buffer": the last bufferSize traced events are kept and given
+	 *   in the dump of the entity.
+	 */
+	class TraceEventSampler : public Timer::Listener
+	{
+	public:
+		enum class Mode : uint8_t
+		{
+			EVENT = 0,
+			SUMMARY,
+			BUFFER
+		};
+
+	public:
+		static constexpr size_t DefaultBufferSize{ 100u };
+		static constexpr size_t MaxBufferSize{ 10000u };
+		static constexpr uint64_t SummaryInterval{ 1000u }; // In ms.
+
+	public:
+		// Returns nullptr if default options are given (every event is notified).
+		static TraceEventSampler* Create(const std::string& targetId, const json& data);
+
+	public:
+		TraceEventSampler(const std::string& targetId, Mode mode, uint32_t sampleRate, size_t bufferSize);
+		~TraceEventSampler() override;
+
+	public:
+		// Whether the event must be built and given to Emit().
+		bool Sample(const char* type, bool perPacket = false)
+		{
+			if (this->mode == Mode::SUMMARY)
+			{
+				this->summaryCounts[type]++;
+
+				return false;
+			}
+
+			if (perPacket)
+				return (this->perPacketCount++ % this->sampleRate) == 0u;
+
+			return true;
+		}
+		void Emit(json& data);
+		void FillJson(json& jsonObject) const;
+
+		/* Pure virtual methods inherited from Timer::Listener. */
+	public:
+		void OnTimer(Timer* timer) override;
+
+	private:
+		// Passed by argument.
+		std::string targetId;
+		Mode mode{ Mode::EVENT };
+		uint32_t sampleRate{ 1u };
+		size_t bufferSize{ DefaultBufferSize };
+		// Allocated by this.
+		Timer* summaryTimer{ nullptr };
+		// Others.
+		uint64_t perPacketCount{ 0u };
+		absl::flat_hash_map<std::string, uint64_t> summaryCounts;
+		std::deque<json> buffer;
+	};
+} // namespace RTC
+
+#endif
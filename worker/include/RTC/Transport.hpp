@@ -1,34 +1,45 @@
 #ifndef MS_RTC_TRANSPORT_HPP
 #define MS_RTC_TRANSPORT_HPP
-// #define ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
 
 #include "common.hpp"
 #include "DepLibUV.hpp"
+#include "StatsRegion.hpp"
 #include "Channel/ChannelRequest.hpp"
 #include "PayloadChannel/Notification.hpp"
 #include "PayloadChannel/PayloadChannelRequest.hpp"
+#include "RTC/BweCache.hpp"
 #include "RTC/Consumer.hpp"
+#include "RTC/CpuUsage.hpp"
 #include "RTC/DataConsumer.hpp"
 #include "RTC/DataProducer.hpp"
+#include "RTC/EgressScheduler.hpp"
+#include "RTC/HandleTable.hpp"
+#include "RTC/ForwardingLatency.hpp"
+#include "RTC/IngressPolicer.hpp"
+#include "RTC/KeyFrameRequestScheduler.hpp"
+#include "RTC/Pacer.hpp"
+#include "RTC/PacketCapture.hpp"
 #include "RTC/Producer.hpp"
 #include "RTC/RTCP/CompoundPacket.hpp"
 #include "RTC/RTCP/Packet.hpp"
 #include "RTC/RTCP/ReceiverReport.hpp"
 #include "RTC/RateCalculator.hpp"
+#include "RTC/RtcpScheduler.hpp"
 #include "RTC/RtpHeaderExtensionIds.hpp"
 #include "RTC/RtpListener.hpp"
 #include "RTC/RtpPacket.hpp"
 #include "RTC/SctpAssociation.hpp"
 #include "RTC/SctpListener.hpp"
-#ifdef ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
-#include "RTC/SenderBandwidthEstimator.hpp"
-#endif
+#include "RTC/StatsDelta.hpp"
+#include "RTC/TraceEventSampler.hpp"
+#include "RTC/TransportArena.hpp"
 #include "RTC/TransportCongestionControlClient.hpp"
 #include "RTC/TransportCongestionControlServer.hpp"
 #include "handles/Timer.hpp"
 #include <absl/container/flat_hash_map.h>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <vector>
 
 using json = nlohmann::json;
 
@@ -41,12 +52,14 @@ namespace RTC
 	                  public RTC::SctpAssociation::Listener,
 	                  public RTC::TransportCongestionControlClient::Listener,
 	                  public RTC::TransportCongestionControlServer::Listener,
-#ifdef ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
-	                  public RTC::SenderBandwidthEstimator::Listener,
-#endif
+	                  public RTC::Pacer::Listener,
+	                  public RTC::EgressScheduler::Listener,
+	                  public RTC::RtcpScheduler::Listener,
 	                  public Timer::Listener
 	{
 	protected:
+		// NOTE: Send callbacks are owned by the caller and invoked exactly once
+		// before SendRtpPacket() returns, so they can live in the caller's stack.
 		using onSendCallback   = const std::function<void(bool sent)>;
 		using onQueuedCallback = const std::function<void(bool queued, bool sctpSendBufferFull)>;
 
@@ -86,6 +99,10 @@ namespace RTC
 			virtual void OnTransportConsumerClosed(RTC::Transport* transport, RTC::Consumer* consumer) = 0;
 			virtual void OnTransportConsumerProducerClosed(
 			  RTC::Transport* transport, RTC::Consumer* consumer) = 0;
+			virtual void OnTransportConsumerActiveChanged(
+			  RTC::Transport* transport, RTC::Consumer* consumer) = 0;
+			virtual void OnTransportConsumerPreferredLayersChanged(
+			  RTC::Transport* transport, RTC::Consumer* consumer) = 0;
 			virtual void OnTransportConsumerKeyFrameRequested(
 			  RTC::Transport* transport, RTC::Consumer* consumer, uint32_t mappedSsrc) = 0;
 			virtual void OnTransportNewDataProducer(
@@ -104,6 +121,9 @@ namespace RTC
 			  RTC::Transport* transport, RTC::DataConsumer* dataConsumer) = 0;
 			virtual void OnTransportDataConsumerDataProducerClosed(
 			  RTC::Transport* transport, RTC::DataConsumer* dataConsumer) = 0;
+			virtual void OnTransportListenServerClosed(RTC::Transport* transport) = 0;
+			virtual RTC::KeyFrameRequestScheduler::Budget* OnTransportNeedKeyFrameRequestBudget(
+			  RTC::Transport* transport) = 0;
 		};
 
 	private:
@@ -118,10 +138,31 @@ namespace RTC
 		virtual ~Transport();
 
 	public:
-		void CloseProducersAndConsumers();
+		// If notifyConsumers is false the Consumers are deleted without notifying
+		// the listener (which must have already forgotten them).
+		void CloseProducersAndConsumers(bool notifyConsumers = true);
+		const absl::flat_hash_map<std::string, RTC::Consumer*>& GetConsumers() const
+		{
+			return this->mapConsumers;
+		}
+		void ListenServerClosed();
 		// Subclasses must also invoke the parent Close().
 		virtual void FillJson(json& jsonObject) const;
 		virtual void FillJsonStats(json& jsonArray);
+		// Dump with the full Producers and Consumers (and their send state).
+		virtual void FillJsonState(json& jsonObject) const;
+		void FillStatsRecords(StatsRegion* statsRegion, uint64_t nowMs);
+		void SetOverloadLevel(OverloadController::Level level);
+		// Fills the approximate memory used by this Transport and its Producers
+		// and Consumers, and returns the total (in bytes).
+		size_t FillJsonMemoryUsage(json& jsonObject) const;
+		size_t GetMemoryUsage() const;
+		void SetMemoryPressure(bool memoryPressure);
+		// CPU time (in ms) spent per second on the media of this Transport.
+		double GetCpuMsPerSecond(uint64_t nowMs)
+		{
+			return this->cpuUsage.GetMsPerSecond(nowMs);
+		}
 		// Subclasses must implement these methods and call the parent's ones to
 		// handle common requests.
 		virtual void HandleRequest(Channel::ChannelRequest* request);
@@ -132,6 +173,16 @@ namespace RTC
 		// Must be called from the subclass.
 		void Connected();
 		void Disconnected();
+		// Remote endpoint whose outgoing bandwidth estimates are kept in the
+		// worker BweCache. Must be called before Connected().
+		void SetBweCacheKey(const struct sockaddr* remoteAddr)
+		{
+			this->bweCacheKey = RTC::BweCache::GetKey(remoteAddr);
+		}
+		// The remote endpoint is now reached at the given address (f.e. a new ICE
+		// selected tuple). If it's in another network, the outgoing bandwidth
+		// estimation restarts from the last estimate of it.
+		void PathChanged(const struct sockaddr* remoteAddr);
 		void DataReceived(size_t len)
 		{
 			this->recvTransmission.Update(len, DepLibUV::GetTimeMs());
@@ -140,8 +191,25 @@ namespace RTC
 		{
 			this->sendTransmission.Update(len, DepLibUV::GetTimeMs());
 		}
-		void ReceiveRtpPacket(RTC::RtpPacket* packet);
+		// If the Producer is not given it's looked up in the RtpListener.
+		void ReceiveRtpPacket(RTC::RtpPacket* packet, RTC::Producer* producer = nullptr);
+		RTC::Producer* GetProducerBySsrc(uint32_t ssrc) const
+		{
+			return this->rtpListener.GetProducer(ssrc);
+		}
 		void ReceiveRtcpPacket(RTC::RTCP::Packet* packet);
+		// Received RTCP must be given once decrypted and before being parsed.
+		void MayCaptureRtcpPacket(
+		  RTC::PacketCapture::Direction direction, const uint8_t* data, size_t len)
+		{
+			if (this->packetCapture)
+				this->packetCapture->CaptureRtcpPacket(direction, data, len);
+		}
+		void MayCaptureRtpPacket(RTC::PacketCapture::Direction direction, const RTC::RtpPacket* packet)
+		{
+			if (this->packetCapture)
+				this->packetCapture->CaptureRtpPacket(direction, packet);
+		}
 		void ReceiveSctpData(const uint8_t* data, size_t len);
 		void SetNewProducerIdFromInternal(json& internal, std::string& producerId) const;
 		RTC::Producer* GetProducerFromInternal(json& internal) const;
@@ -158,10 +226,14 @@ namespace RTC
 		virtual bool IsConnected() const = 0;
 		virtual void SendRtpPacket(
 		  RTC::Consumer* consumer, RTC::RtpPacket* packet, onSendCallback* cb = nullptr) = 0;
+		void HandleBatchRequest(
+		  Channel::ChannelRequest* request, Channel::ChannelRequest::MethodId itemMethodId);
 		void HandleRtcpPacket(RTC::RTCP::Packet* packet);
 		void SendRtcp(uint64_t nowMs);
 		virtual void SendRtcpPacket(RTC::RTCP::Packet* packet)                 = 0;
 		virtual void SendRtcpCompoundPacket(RTC::RTCP::CompoundPacket* packet) = 0;
+		void QueueRtcpFeedbackPacket(RTC::RTCP::Packet* packet);
+		void SendRtcpFeedbackPackets();
 		virtual void SendMessage(
 		  RTC::DataConsumer* dataConsumer,
 		  uint32_t ppid,
@@ -171,10 +243,20 @@ namespace RTC
 		virtual void SendSctpData(const uint8_t* data, size_t len) = 0;
 		virtual void RecvStreamClosed(uint32_t ssrc)               = 0;
 		virtual void SendStreamClosed(uint32_t ssrc)               = 0;
+		void MayDistributeAvailableOutgoingBitrate(bool forceBitrate = false);
 		void DistributeAvailableOutgoingBitrate();
 		void ComputeOutgoingDesiredBitrate(bool forceBitrate = false);
+		void MaySetInitialAvailableOutgoingBitrate();
+		void UpdateBitrateConsumers();
+		void EmitTraceEvent(json& data) const;
 		void EmitTraceEventProbationType(RTC::RtpPacket* packet) const;
 		void EmitTraceEventBweType(RTC::TransportCongestionControlClient::Bitrates& bitrates) const;
+		// Whether the packet has been queued to be sent later by the Pacer (or by
+		// the worker egress scheduler if there is no Pacer).
+		bool QueueConsumerRtpPacket(
+		  RTC::Consumer* consumer, RTC::RtpPacket* packet, bool retransmission);
+		void SendConsumerRtpPacket(
+		  RTC::Consumer* consumer, RTC::RtpPacket* packet, bool retransmission, uint64_t queuedAtNs = 0u);
 
 		/* Pure virtual methods inherited from RTC::Producer::Listener. */
 	public:
@@ -194,11 +276,14 @@ namespace RTC
 		/* Pure virtual methods inherited from RTC::Consumer::Listener. */
 	public:
 		void OnConsumerSendRtpPacket(RTC::Consumer* consumer, RTC::RtpPacket* packet) override;
-		void OnConsumerRetransmitRtpPacket(RTC::Consumer* consumer, RTC::RtpPacket* packet) override;
+		void OnConsumerRetransmitRtpPackets(
+		  RTC::Consumer* consumer, RTC::RtpPacket** packets, size_t count) override;
 		void OnConsumerKeyFrameRequested(RTC::Consumer* consumer, uint32_t mappedSsrc) override;
 		void OnConsumerNeedBitrateChange(RTC::Consumer* consumer) override;
 		void OnConsumerNeedZeroBitrate(RTC::Consumer* consumer) override;
 		void OnConsumerProducerClosed(RTC::Consumer* consumer) override;
+		void OnConsumerActiveChanged(RTC::Consumer* consumer) override;
+		void OnConsumerPreferredLayersChanged(RTC::Consumer* consumer) override;
 
 		/* Pure virtual methods inherited from RTC::DataProducer::Listener. */
 	public:
@@ -231,6 +316,12 @@ namespace RTC
 		  size_t len) override;
 		void OnSctpAssociationBufferedAmount(
 		  RTC::SctpAssociation* sctpAssociation, uint32_t bufferedAmount) override;
+		bool OnSctpAssociationSendBufferFull(
+		  RTC::SctpAssociation* sctpAssociation,
+		  const std::string& dataConsumerId,
+		  uint32_t ppid,
+		  const uint8_t* msg,
+		  size_t len) override;
 
 		/* Pure virtual methods inherited from RTC::TransportCongestionControlClient::Listener. */
 	public:
@@ -241,20 +332,35 @@ namespace RTC
 		  RTC::TransportCongestionControlClient* tccClient,
 		  RTC::RtpPacket* packet,
 		  const webrtc::PacedPacketInfo& pacingInfo) override;
+		RTC::RtpPacket* OnTransportCongestionControlClientGeneratePadding(
+		  RTC::TransportCongestionControlClient* tccClient, size_t size) override;
 
 		/* Pure virtual methods inherited from RTC::TransportCongestionControlServer::Listener. */
 	public:
 		void OnTransportCongestionControlServerSendRtcpPacket(
 		  RTC::TransportCongestionControlServer* tccServer, RTC::RTCP::Packet* packet) override;
 
-#ifdef ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
-		/* Pure virtual methods inherited from RTC::SenderBandwidthEstimator::Listener. */
+		/* Pure virtual methods inherited from RTC::Pacer::Listener. */
 	public:
-		void OnSenderBandwidthEstimatorAvailableBitrate(
-		  RTC::SenderBandwidthEstimator* senderBwe,
-		  uint32_t availableBitrate,
-		  uint32_t previousAvailableBitrate) override;
-#endif
+		void OnPacerSendRtpPacket(
+		  RTC::Pacer* pacer,
+		  RTC::Consumer* consumer,
+		  RTC::RtpPacket* packet,
+		  bool retransmission,
+		  uint64_t queuedAtNs) override;
+		void OnPacerSendSctpData(RTC::Pacer* pacer, const uint8_t* data, size_t len) override;
+
+		/* Pure virtual methods inherited from RTC::EgressScheduler::Listener. */
+	public:
+		void OnEgressSchedulerSendRtpPacket(
+		  RTC::Consumer* consumer,
+		  RTC::RtpPacket* packet,
+		  bool retransmission,
+		  uint64_t queuedAtNs) override;
+
+		/* Pure virtual methods inherited from RTC::RtcpScheduler::Listener. */
+	public:
+		void OnRtcpSchedulerSendRtcp(uint64_t nowMs) override;
 
 		/* Pure virtual methods inherited from Timer::Listener. */
 	public:
@@ -263,11 +369,22 @@ namespace RTC
 	public:
 		// Passed by argument.
 		const std::string id;
+		// Numeric handle given by the parent container (see RTC::HandleTable).
+		uint32_t handle{ 0u };
 
 	protected:
 		size_t maxMessageSize{ 262144u };
 		// Allocated by this.
 		RTC::SctpAssociation* sctpAssociation{ nullptr };
+		// Arena of the long lived objects of this Transport (nullptr unless the
+		// transportArenas setting is enabled).
+		RTC::TransportArena* arena{ nullptr };
+		// Others.
+		// Must be evaluated by the subclasses before parsing received packets.
+		RTC::IngressPolicer ingressPolicer;
+		// CPU time spent on received and sent media (subclasses must add a
+		// Scope where they decrypt it).
+		RTC::CpuUsage cpuUsage;
 
 	private:
 		// Passed by argument.
@@ -275,16 +392,21 @@ namespace RTC
 		// Allocated by this.
 		absl::flat_hash_map<std::string, RTC::Producer*> mapProducers;
 		absl::flat_hash_map<std::string, RTC::Consumer*> mapConsumers;
+		RTC::HandleTable<RTC::Producer> producerHandles;
+		RTC::HandleTable<RTC::Consumer> consumerHandles;
 		absl::flat_hash_map<std::string, RTC::DataProducer*> mapDataProducers;
 		absl::flat_hash_map<std::string, RTC::DataConsumer*> mapDataConsumers;
 		absl::flat_hash_map<uint32_t, RTC::Consumer*> mapSsrcConsumer;
 		absl::flat_hash_map<uint32_t, RTC::Consumer*> mapRtxSsrcConsumer;
-		Timer* rtcpTimer{ nullptr };
+		Timer* bitrateDistributionTimer{ nullptr };
+		Timer* rtcpFeedbackTimer{ nullptr };
 		RTC::TransportCongestionControlClient* tccClient{ nullptr };
 		RTC::TransportCongestionControlServer* tccServer{ nullptr };
-#ifdef ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
-		RTC::SenderBandwidthEstimator* senderBwe{ nullptr };
-#endif
+		RTC::Pacer* pacer{ nullptr };
+		RTC::TraceEventSampler* traceEventSampler{ nullptr };
+		RTC::PacketCapture* packetCapture{ nullptr };
+		RTC::ForwardingLatency* forwardingLatency{ nullptr };
+		RTC::KeyFrameRequestScheduler::Budget* keyFrameRequestBudget{ nullptr };
 		// Others.
 		bool direct{ false }; // Whether this Transport allows PayloadChannel comm.
 		bool destroying{ false };
@@ -293,6 +415,7 @@ namespace RTC
 		RTC::SctpListener sctpListener;
 		RTC::RateCalculator recvTransmission;
 		RTC::RateCalculator sendTransmission;
+		RTC::RateCalculator sctpSendTransmission;
 		RTC::RtpDataCounter recvRtpTransmission;
 		RTC::RtpDataCounter sendRtpTransmission;
 		RTC::RtpDataCounter recvRtxTransmission;
@@ -300,9 +423,33 @@ namespace RTC
 		RTC::RtpDataCounter sendProbationTransmission;
 		uint16_t transportWideCcSeq{ 0u };
 		uint32_t initialAvailableOutgoingBitrate{ 600000u };
+		// Outgoing bitrate to start the estimation from, given by the app (0 if
+		// not given).
+		uint32_t bweHint{ 0u };
+		// Key of the remote endpoint in the BweCache (empty if unknown).
+		std::string bweCacheKey;
+		// Max time (in ms) received media packets are held to be reordered.
+		uint32_t rtpReorderDelay{ 0u };
 		uint32_t maxIncomingBitrate{ 0u };
 		uint32_t maxOutgoingBitrate{ 0u };
+		// Share of the available outgoing bitrate for SCTP packets (0 if they are
+		// not paced).
+		float sctpBitrateShare{ 0 };
 		struct TraceEventTypes traceEventTypes;
+		// Consumers sorted by priority (highest first) for bitrate distribution.
+		// Rebuilt only when Consumers are added, removed or change priority.
+		std::vector<RTC::Consumer*> bitrateConsumers;
+		bool bitrateConsumersDirty{ false };
+		// Consumers that may still increase their layers during a distribution.
+		std::vector<std::pair<uint8_t, RTC::Consumer*>> increasingBitrateConsumers;
+		uint64_t lastBitrateDistributionAtMs{ 0u };
+		uint32_t lastDistributedAvailableBitrate{ 0u };
+		bool pendingForceDesiredBitrate{ false };
+		RTC::StatsDelta statsDelta;
+		// Serialized RTCP feedback packets (NACK, PLI, FIR, REMB, etc), sent
+		// together in a single RTCP compound packet once rtcpFeedbackTimer fires.
+		uint8_t rtcpFeedbackBuffer[RTC::MtuSize]{};
+		size_t rtcpFeedbackBufferLen{ 0u };
 	};
 } // namespace RTC
 
@@ -0,0 +1,122 @@
+#ifndef MS_RTC_TRANSPORT_ARENA_HPP
+#define MS_RTC_TRANSPORT_ARENA_HPP
+
+#include "common.hpp"
+#include <nlohmann/json.hpp>
+#include <array>
+#include <cstddef> // std::max_align_t
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace RTC
+{
+	/**
+	 * Memory arena of a Transport (enabled with the transportArenas worker
+	 * setting) for its long lived objects (Producers, Consumers, their RTP
+	 * streams, NACK generators, the IceServer and the DtlsTransport), so they
+	 * sit together in a few chunks instead of being spread across the heap, and
+	 * are released in bulk when the Transport is destroyed.
+	 *
+	 * Classes opt in by deriving from TransportArena::Allocated. Their objects
+	 * are allocated in the arena of the current TransportArena::Scope (or in
+	 * the heap if there is none). Each block is prefixed with its owning arena
+	 * so it is freed in the proper place no matter the current Scope. Freed
+	 * blocks are kept in per size class free lists of the arena for reuse.
+	 *
+	 * Chunks are allocated (and first touched) by the worker thread, so with
+	 * numaLocalMemory they land in the NUMA node of the worker CPU.
+	 */
+	class TransportArena
+	{
+	public:
+		static constexpr size_t ChunkSize{ 65536u };
+		// Size of each size class.
+		static constexpr size_t BlockSizeStep{ 64u };
+		// Number of size classes (so bigger allocations go to the heap).
+		static constexpr size_t NumSizeClasses{ 64u };
+		// Prefix of each block holding its owning arena (nullptr for the heap).
+		static constexpr size_t HeaderSize{ alignof(std::max_align_t) };
+
+	public:
+		// Base class whose operator new and operator delete use the arena of the
+		// current Scope.
+		class Allocated
+		{
+		public:
+			static void* operator new(size_t size)
+			{
+				return TransportArena::Allocate(size);
+			}
+			static void operator delete(void* ptr, size_t size)
+			{
+				TransportArena::Deallocate(ptr, size);
+			}
+		};
+
+		// Makes the given arena (may be nullptr) the current one during its
+		// lifetime.
+		class Scope
+		{
+		public:
+			explicit Scope(TransportArena* arena) : previous(TransportArena::current)
+			{
+				TransportArena::current = arena;
+			}
+			~Scope()
+			{
+				TransportArena::current = this->previous;
+			}
+			Scope(const Scope&)            = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			TransportArena* previous{ nullptr };
+		};
+
+	public:
+		static void* Allocate(size_t size);
+		static void Deallocate(void* ptr, size_t size);
+
+	private:
+		thread_local static TransportArena* current;
+
+	public:
+		TransportArena() = default;
+		~TransportArena();
+		TransportArena(const TransportArena&)            = delete;
+		TransportArena& operator=(const TransportArena&) = delete;
+
+	public:
+		void FillJson(json& jsonObject) const;
+		// Bytes of the chunks.
+		size_t GetReservedBytes() const
+		{
+			return this->chunks.size() * ChunkSize;
+		}
+		// Bytes of the blocks given and not freed.
+		size_t GetUsedBytes() const
+		{
+			return this->usedBytes;
+		}
+
+	private:
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+
+	private:
+		uint8_t* AllocateBlock(size_t sizeClass);
+		void DeallocateBlock(uint8_t* block, size_t sizeClass);
+
+	private:
+		std::vector<uint8_t*> chunks;
+		uint8_t* cursor{ nullptr };
+		size_t available{ 0u };
+		std::array<FreeBlock*, NumSizeClasses> freeLists{};
+		size_t usedBytes{ 0u };
+	};
+} // namespace RTC
+
+#endif
@@ -3,22 +3,38 @@
 
 #include "common.hpp"
 #include "RTC/BweType.hpp"
+#include "RTC/RTCP/FeedbackRtpEcn.hpp"
 #include "RTC/RTCP/FeedbackRtpTransport.hpp"
 #include "RTC/RTCP/ReceiverReport.hpp"
 #include "RTC/RtpPacket.hpp"
 #include "RTC/RtpProbationGenerator.hpp"
+#include "RTC/SenderBandwidthEstimator.hpp"
 #include "RTC/TrendCalculator.hpp"
 #include "handles/Timer.hpp"
 #include <libwebrtc/api/transport/goog_cc_factory.h>
 #include <libwebrtc/api/transport/network_types.h>
 #include <libwebrtc/call/rtp_transport_controller_send.h>
 #include <libwebrtc/modules/pacing/packet_router.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 #include <deque>
 
 namespace RTC
 {
+	/**
+	 * Outgoing bandwidth estimation and pacing of probation packets, with the
+	 * libwebrtc GoogCC controller or, if the nativeBandwidthEstimator setting is
+	 * enabled and transport-cc is used, with the lighter native
+	 * SenderBandwidthEstimator (which does not probe).
+	 *
+	 * The libwebrtc controller (pacer, prober and GoogCC) is just created once
+	 * the Transport is connected and there is media to send, and destroyed
+	 * after a while without it. Its last estimate is kept as the start bitrate
+	 * of the next one so it restarts warm.
+	 */
 	class TransportCongestionControlClient : public webrtc::PacketRouter,
 	                                         public webrtc::TargetTransferRateObserver,
+	                                         public RTC::SenderBandwidthEstimator::Listener,
 	                                         public Timer::Listener
 	{
 	public:
@@ -47,6 +63,10 @@ namespace RTC
 			  RTC::TransportCongestionControlClient* tccClient,
 			  RTC::RtpPacket* packet,
 			  const webrtc::PacedPacketInfo& pacingInfo) = 0;
+			// May return a RTX packet of recently sent media to be used as padding
+			// when probing. Otherwise a probation RTP packet is used.
+			virtual RTC::RtpPacket* OnTransportCongestionControlClientGeneratePadding(
+			  RTC::TransportCongestionControlClient* tccClient, size_t size) = 0;
 		};
 
 	public:
@@ -70,14 +90,25 @@ namespace RTC
 		void ReceiveEstimatedBitrate(uint32_t bitrate);
 		void ReceiveRtcpReceiverReport(RTC::RTCP::ReceiverReportPacket* packet, float rtt, int64_t nowMs);
 		void ReceiveRtcpTransportFeedback(const RTC::RTCP::FeedbackRtpTransportPacket* feedback);
+		void ReceiveRtcpEcnFeedback(RTC::RTCP::FeedbackRtpEcnPacket* feedback);
 		void SetDesiredBitrate(uint32_t desiredBitrate, bool force);
 		void SetMaxOutgoingBitrate(uint32_t maxBitrate);
+		// Start the estimation from the given bitrate (f.e. a previous estimate of
+		// the same remote endpoint). It has no effect once the estimation started.
+		void SetInitialAvailableBitrate(uint32_t bitrate);
+		// Packets are now sent through another network path, so restart the
+		// estimation from the given bitrate (or the initial one if 0).
+		void PathChanged(uint32_t startBitrate);
 		const Bitrates& GetBitrates() const
 		{
 			return this->bitrates;
 		}
 		uint32_t GetAvailableBitrate() const;
 		double GetPacketLoss() const;
+		uint64_t GetEcnCePackets() const
+		{
+			return this->ecnCePackets;
+		}
 		void RescheduleNextAvailableBitrateEvent();
 
 	private:
@@ -85,6 +116,7 @@ namespace RTC
 		void UpdatePacketLoss(double packetLoss);
 		void ApplyBitrateUpdates();
 
+		void MayInitializeController();
 		void InitializeController();
 		void DestroyController();
 
@@ -99,29 +131,61 @@ namespace RTC
 	public:
 		void SendPacket(RTC::RtpPacket* packet, const webrtc::PacedPacketInfo& pacingInfo) override;
 		RTC::RtpPacket* GeneratePadding(size_t size) override;
+		bool MayProbe() override;
+
+		/* Pure virtual methods inherited from RTC::SenderBandwidthEstimator::Listener. */
+	public:
+		void OnSenderBandwidthEstimatorAvailableBitrate(
+		  RTC::SenderBandwidthEstimator* senderBwe,
+		  uint32_t availableBitrate,
+		  uint32_t previousAvailableBitrate) override;
 
 		/* Pure virtual methods inherited from RTC::Timer. */
 	public:
 		void OnTimer(Timer* timer) override;
 
+	private:
+		// Counters of the last ECN feedback item of a media SSRC.
+		struct EcnCounters
+		{
+			uint32_t ect0{ 0u };
+			uint32_t ect1{ 0u };
+			uint16_t ce{ 0u };
+			uint16_t notEct{ 0u };
+		};
+
+	private:
+		// Clients currently probing (only tracked if the number of probing
+		// Transports is limited).
+		thread_local static absl::flat_hash_set<TransportCongestionControlClient*> probingClients;
+
 	private:
 		// Passed by argument.
 		Listener* listener{ nullptr };
 		// Allocated by this.
 		webrtc::NetworkControllerFactoryInterface* controllerFactory{ nullptr };
 		webrtc::RtpTransportControllerSend* rtpTransportControllerSend{ nullptr };
-		RTC::RtpProbationGenerator* probationGenerator{ nullptr };
 		Timer* processTimer{ nullptr };
+		RTC::SenderBandwidthEstimator* senderBwe{ nullptr };
 		// Others.
 		RTC::BweType bweType;
 		uint32_t initialAvailableBitrate{ 0u };
 		uint32_t maxOutgoingBitrate{ 0u };
 		Bitrates bitrates;
+		bool connected{ false };
+		// Start bitrate of the current libwebrtc controller.
+		uint32_t controllerStartBitrate{ 0u };
+		// Last time there was media to send, in ms.
+		uint64_t lastDemandAtMs{ 0u };
 		bool availableBitrateEventCalled{ false };
 		uint64_t lastAvailableBitrateEventAtMs{ 0u };
 		RTC::TrendCalculator desiredBitrateTrend;
 		std::deque<double> packetLossHistory;
 		double packetLoss{ 0 };
+		// Last ECN feedback counters indexed by media SSRC.
+		absl::flat_hash_map<uint32_t, EcnCounters> ecnCounters;
+		// Sent packets reported as CE marked.
+		uint64_t ecnCePackets{ 0u };
 	};
 } // namespace RTC
 
@@ -3,11 +3,13 @@
 
 #include "common.hpp"
 #include "RTC/BweType.hpp"
+#include "RTC/RTCP/FeedbackRtpEcn.hpp"
 #include "RTC/RTCP/FeedbackRtpTransport.hpp"
 #include "RTC/RTCP/Packet.hpp"
 #include "RTC/RtpPacket.hpp"
 #include "handles/Timer.hpp"
 #include <libwebrtc/modules/remote_bitrate_estimator/remote_bitrate_estimator_abs_send_time.h>
+#include <array>
 #include <deque>
 
 namespace RTC
@@ -26,6 +28,19 @@ namespace RTC
 			  RTC::TransportCongestionControlServer* tccServer, RTC::RTCP::Packet* packet) = 0;
 		};
 
+	private:
+		// Transport-wide sequence number and arrival time (relative to
+		// transportCcRingBaseMs) of a received RTP packet not yet added to the
+		// Transport-CC feedback packet.
+		struct TransportCcRecord
+		{
+			uint32_t receivedAtOffsetMs;
+			uint16_t wideSeqNumber;
+		};
+
+	private:
+		static constexpr size_t TransportCcRingSize{ 256u };
+
 	public:
 		TransportCongestionControlServer(
 		  RTC::TransportCongestionControlServer::Listener* listener,
@@ -53,10 +68,18 @@ namespace RTC
 		}
 		double GetPacketLoss() const;
 		void IncomingPacket(uint64_t nowMs, const RTC::RtpPacket* packet);
+		// ecn is the ECN codepoint (RFC 3168) of the IP header of the packet.
+		void IncomingEcn(uint64_t nowMs, const RTC::RtpPacket* packet, uint8_t ecn);
+		uint64_t GetEcnCePackets() const
+		{
+			return this->ecnCeCounter;
+		}
 		void SetMaxIncomingBitrate(uint32_t bitrate);
 
 	private:
+		void DrainTransportCcRing();
 		void SendTransportCcFeedback();
+		void SendEcnFeedback();
 		void MaySendLimitationRembFeedback();
 		void UpdatePacketLoss(double packetLoss);
 
@@ -84,11 +107,27 @@ namespace RTC
 		uint8_t transportCcFeedbackPacketCount{ 0u };
 		uint32_t transportCcFeedbackSenderSsrc{ 0u };
 		uint32_t transportCcFeedbackMediaSsrc{ 0u };
+		std::array<TransportCcRecord, TransportCcRingSize> transportCcRing;
+		size_t transportCcRingCount{ 0u };
+		uint64_t transportCcRingBaseMs{ 0u };
+		// Feed the REMB server with one of every rembSampling RTP packets.
+		uint8_t rembSampling{ 1u };
+		uint8_t rembSamplingCounter{ 0u };
 		uint32_t maxIncomingBitrate{ 0u };
 		uint64_t limitationRembSentAtMs{ 0u };
 		uint8_t unlimitedRembCounter{ 0u };
 		std::deque<double> packetLossHistory;
 		double packetLoss{ 0 };
+		// ECN counters (RFC 6679) of all the received RTP packets, reported along
+		// with the extended highest sequence number of the first received stream.
+		bool ecnStarted{ false };
+		uint32_t ecnMediaSsrc{ 0u };
+		uint32_t ecnExtendedHighestSeq{ 0u };
+		uint32_t ecnEct0Counter{ 0u };
+		uint32_t ecnEct1Counter{ 0u };
+		uint64_t ecnCeCounter{ 0u };
+		uint32_t ecnNotEctCounter{ 0u };
+		uint64_t ecnFeedbackSentAtMs{ 0u };
 	};
 } // namespace RTC
 
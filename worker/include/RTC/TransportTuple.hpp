@@ -6,6 +6,7 @@
 #include "RTC/TcpConnection.hpp"
 #include "RTC/UdpSocket.hpp"
 #include <nlohmann/json.hpp>
+#include <array>
 #include <string>
 
 using json = nlohmann::json;
@@ -24,19 +25,48 @@ namespace RTC
 			TCP
 		};
 
+		/**
+		 * Packed 5-tuple (local and remote IPs and ports and protocol) with a
+		 * precomputed hash, so tuples are compared with no family specific code
+		 * and can be used as keys of hash maps.
+		 */
+		struct Key
+		{
+			bool operator==(const Key& other) const
+			{
+				return this->hash == other.hash && this->words == other.words;
+			}
+			bool operator!=(const Key& other) const
+			{
+				return !(*this == other);
+			}
+			template<typename H>
+			friend H AbslHashValue(H h, const Key& key)
+			{
+				return H::combine(std::move(h), key.hash);
+			}
+
+			// Local IP and remote IP (IPv4 ones as IPv4-mapped IPv6), local port
+			// and remote port (in network order) and protocol.
+			std::array<uint64_t, 5> words{};
+			size_t hash{ 0u };
+		};
+
 	public:
 		TransportTuple(RTC::UdpSocket* udpSocket, const struct sockaddr* udpRemoteAddr)
 		  : udpSocket(udpSocket), udpRemoteAddr((struct sockaddr*)udpRemoteAddr), protocol(Protocol::UDP)
 		{
+			GenerateKey();
 		}
 
 		explicit TransportTuple(RTC::TcpConnection* tcpConnection)
 		  : tcpConnection(tcpConnection), protocol(Protocol::TCP)
 		{
+			GenerateKey();
 		}
 
 		explicit TransportTuple(const TransportTuple* tuple)
-		  : udpSocket(tuple->udpSocket), udpRemoteAddr(tuple->udpRemoteAddr),
+		  : key(tuple->key), udpSocket(tuple->udpSocket), udpRemoteAddr(tuple->udpRemoteAddr),
 		    tcpConnection(tuple->tcpConnection), localAnnouncedIp(tuple->localAnnouncedIp),
 		    protocol(tuple->protocol)
 		{
@@ -59,20 +89,9 @@ namespace RTC
 
 		bool Compare(const TransportTuple* tuple) const
 		{
-			if (this->protocol == Protocol::UDP && tuple->GetProtocol() == Protocol::UDP)
-			{
-				return (
-				  this->udpSocket == tuple->udpSocket &&
-				  Utils::IP::CompareAddresses(this->udpRemoteAddr, tuple->GetRemoteAddress()));
-			}
-			else if (this->protocol == Protocol::TCP && tuple->GetProtocol() == Protocol::TCP)
-			{
-				return (this->tcpConnection == tuple->tcpConnection);
-			}
-			else
-			{
-				return false;
-			}
+			// UDP sockets connected to a remote address share the local address of
+			// the listening one, so they must also match.
+			return this->key == tuple->key && this->udpSocket == tuple->udpSocket;
 		}
 
 		void SetLocalAnnouncedIp(std::string& localAnnouncedIp)
@@ -88,11 +107,39 @@ namespace RTC
 				this->tcpConnection->Send(data, len, cb);
 		}
 
+		/**
+		 * Memory where a packet of up to len bytes can be written to be sent
+		 * with SendBuffer() with no extra copy. Returns nullptr if not available
+		 * (for instance in TCP tuples).
+		 */
+		uint8_t* GetSendBuffer(size_t len)
+		{
+			if (this->protocol == Protocol::UDP)
+				return this->udpSocket->GetSendBuffer(len);
+			else
+				return nullptr;
+		}
+
+		void SendBuffer(size_t len, RTC::TransportTuple::onSendCallback* cb = nullptr)
+		{
+			this->udpSocket->SendBuffer(len, this->udpRemoteAddr, cb);
+		}
+
 		Protocol GetProtocol() const
 		{
 			return this->protocol;
 		}
 
+		RTC::UdpSocket* GetUdpSocket() const
+		{
+			return this->udpSocket;
+		}
+
+		RTC::TcpConnection* GetTcpConnection() const
+		{
+			return this->tcpConnection;
+		}
+
 		const struct sockaddr* GetLocalAddress() const
 		{
 			if (this->protocol == Protocol::UDP)
@@ -125,6 +172,12 @@ namespace RTC
 				return this->tcpConnection->GetSentBytes();
 		}
 
+	private:
+		void GenerateKey();
+
+	public:
+		Key key;
+
 	private:
 		// Passed by argument.
 		RTC::UdpSocket* udpSocket{ nullptr };
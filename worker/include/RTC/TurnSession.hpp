@@ -0,0 +1,101 @@
+#ifndef MS_RTC_TURN_SESSION_HPP
+#define MS_RTC_TURN_SESSION_HPP
+
+#include "common.hpp"
+#include <absl/container/flat_hash_map.h>
+
+namespace RTC
+{
+	/**
+	 * TURN (RFC 8656) allocation of a client connected over TCP to a TCP
+	 * listen port of the worker. The worker is the only allowed peer, so data
+	 * sent by the client to any peer is handed to the connection as if
+	 * received from it, and data sent by the worker is relayed to the client
+	 * as coming from the latest peer the client sent data to.
+	 *
+	 * There is no authentication (data cannot be relayed elsewhere, and ICE
+	 * authenticates it anyway) and the allocation lives as long as the TCP
+	 * connection does.
+	 */
+	class TurnSession
+	{
+	public:
+		// Lifetime (in seconds) announced to the client.
+		static constexpr uint32_t Lifetime{ 600u };
+		// Max size of the header written by FillDataHeader().
+		static constexpr size_t MaxDataHeaderSize{ 48u };
+
+	public:
+		// Whether the given data (at least 8 bytes) starts a STUN message
+		// instead of a RFC 4571 frame.
+		static bool IsTurn(const uint8_t* data, size_t len)
+		{
+			// clang-format off
+			return (
+				(len >= 8) &&
+				// First two bits must be 0.
+				(data[0] < 0x40) &&
+				// Magic cookie in its position.
+				(data[4] == 0x21) && (data[5] == 0x12) && (data[6] == 0xa4) && (data[7] == 0x42)
+			);
+			// clang-format on
+		}
+		// Size of the message at the beginning of the given data (at least 4
+		// bytes), including padding, or 0 if it's not a TURN message.
+		static size_t GetMessageSize(const uint8_t* data, size_t len);
+		static bool IsChannelData(const uint8_t* data)
+		{
+			return (data[0] & 0xc0) == 0x40;
+		}
+		static size_t GetPaddingSize(size_t len)
+		{
+			return (4 - (len % 4)) % 4;
+		}
+
+	public:
+		TurnSession(const struct sockaddr* clientAddr, const struct sockaddr* relayedAddr);
+
+	public:
+		/**
+		 * Processes a STUN message received from the client. Returns the size of
+		 * the response written into response (0 if none). If it's a Send
+		 * indication, data and dataLen are set to its payload.
+		 */
+		size_t ProcessMessage(
+		  const uint8_t* msg, size_t len, uint8_t* response, const uint8_t*& data, size_t& dataLen);
+		/**
+		 * Returns the payload of a ChannelData message received from the client,
+		 * or nullptr if its channel is not bound.
+		 */
+		const uint8_t* ProcessChannelData(const uint8_t* msg, size_t len, size_t& dataLen);
+		/**
+		 * Writes the header of a message relaying dataLen bytes to the client.
+		 * It must be followed by the data and GetPaddingSize(dataLen) zero bytes.
+		 * Returns 0 if the client didn't send any data yet (so the peer is
+		 * unknown).
+		 */
+		size_t FillDataHeader(uint8_t* header, size_t dataLen) const;
+		// The client released the allocation.
+		bool IsReleased() const
+		{
+			return this->released;
+		}
+
+	private:
+		void SetPeer(const struct sockaddr_storage& peerAddr, uint16_t channel);
+
+	private:
+		struct sockaddr_storage clientAddr;
+		struct sockaddr_storage relayedAddr;
+		bool allocated{ false };
+		bool released{ false };
+		// Peer addresses indexed by channel number.
+		absl::flat_hash_map<uint16_t, struct sockaddr_storage> channels;
+		// Peer (and its channel, 0 if none) of the latest data from the client.
+		struct sockaddr_storage peerAddr;
+		bool hasPeer{ false };
+		uint16_t peerChannel{ 0u };
+	};
+} // namespace RTC
+
+#endif
@@ -23,6 +23,13 @@ namespace RTC
 	public:
 		UdpSocket(Listener* listener, std::string& ip);
 		UdpSocket(Listener* listener, std::string& ip, uint16_t port);
+		// Bound with SO_REUSEPORT and connected to remoteAddr if given.
+		UdpSocket(
+		  Listener* listener,
+		  std::string& ip,
+		  uint16_t port,
+		  const struct sockaddr* remoteAddr,
+		  bool reusePort);
 		~UdpSocket() override;
 
 		/* Pure virtual methods inherited from ::UdpSocketHandler. */
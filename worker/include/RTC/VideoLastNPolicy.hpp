@@ -0,0 +1,65 @@
+#ifndef MS_RTC_VIDEO_LAST_N_POLICY_HPP
+#define MS_RTC_VIDEO_LAST_N_POLICY_HPP
+
+#include "common.hpp"
+#include "RTC/Producer.hpp"
+#include <vector>
+
+namespace RTC
+{
+	/**
+	 * Keeps the video Producers of the N most recent dominant speakers selected.
+	 * Each speaker (an audio Producer) has its video Producers. The Router pauses
+	 * the Consumers of the video Producers that are not selected, without any
+	 * round trip to Node.
+	 */
+	class VideoLastNPolicy
+	{
+	public:
+		class Listener
+		{
+		public:
+			virtual ~Listener() = default;
+
+		public:
+			virtual void OnVideoLastNPolicyProducerSelected(
+			  RTC::VideoLastNPolicy* policy, RTC::Producer* videoProducer, bool selected) = 0;
+		};
+
+	private:
+		struct Speaker
+		{
+			RTC::Producer* audioProducer{ nullptr };
+			std::vector<RTC::Producer*> videoProducers;
+			// Video Producers are selected until told otherwise.
+			bool selected{ true };
+		};
+
+	public:
+		VideoLastNPolicy(Listener* listener, size_t lastN);
+
+	public:
+		void AddSpeaker(RTC::Producer* audioProducer, const std::vector<RTC::Producer*>& videoProducers);
+		void RemoveSpeaker(RTC::Producer* audioProducer);
+		// The video Producer is being closed so it's not notified.
+		void RemoveVideoProducer(RTC::Producer* videoProducer);
+		void DominantSpeakerChanged(RTC::Producer* audioProducer);
+		bool IsSelected(const RTC::Producer* audioProducer) const;
+		// Selects every video Producer again and removes all speakers.
+		void Close();
+
+	private:
+		void ApplySelection();
+		void SetSelected(Speaker& speaker, bool selected);
+
+	private:
+		// Passed by argument.
+		Listener* listener{ nullptr };
+		size_t lastN{ 0u };
+		// Others.
+		// Most recent dominant speaker first.
+		std::vector<Speaker> speakers;
+	};
+} // namespace RTC
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef MS_RTC_WEBRTC_SERVER_HPP
+#define MS_RTC_WEBRTC_SERVER_HPP
+
+#include "common.hpp"
+#include "Channel/ChannelRequest.hpp"
+#include "RTC/IceCandidate.hpp"
+#include "RTC/StunPacket.hpp"
+#include "RTC/TcpConnection.hpp"
+#include "RTC/TcpServer.hpp"
+#include "RTC/TransportTuple.hpp"
+#include "RTC/UdpSocket.hpp"
+#include "RTC/WebRtcTransport.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace RTC
+{
+	class WebRtcServer : public RTC::UdpSocket::Listener,
+	                     public RTC::TcpServer::Listener,
+	                     public RTC::TcpConnection::Listener,
+	                     public RTC::WebRtcTransport::WebRtcTransportListener
+	{
+	private:
+		struct UdpSocketOrTcpServer
+		{
+			// Expose a constructor to use vector.emplace_back().
+			UdpSocketOrTcpServer(
+			  RTC::UdpSocket* udpSocket, RTC::TcpServer* tcpServer, std::string& announcedIp)
+			  : udpSocket(udpSocket), tcpServer(tcpServer), announcedIp(announcedIp)
+			{
+			}
+
+			RTC::UdpSocket* udpSocket;
+			RTC::TcpServer* tcpServer;
+			std::string announcedIp;
+		};
+
+	public:
+		WebRtcServer(const std::string& id, json& data);
+		~WebRtcServer();
+
+	public:
+		void FillJson(json& jsonObject) const;
+		void HandleRequest(Channel::ChannelRequest* request);
+		std::vector<RTC::IceCandidate> GetIceCandidates(
+		  bool enableUdp, bool enableTcp, bool preferUdp, bool preferTcp);
+		const std::string& GetIceUsernameFragmentPrefix() const
+		{
+			return this->iceUsernameFragmentPrefix;
+		}
+
+	private:
+		std::string GetLocalIceUsernameFragmentFromReceivedStunPacket(RTC::StunPacket* packet) const;
+		void OnPacketReceived(RTC::TransportTuple* tuple, const uint8_t* data, size_t len);
+		void OnStunDataReceived(RTC::TransportTuple* tuple, const uint8_t* data, size_t len);
+		void OnNonStunDataReceived(RTC::TransportTuple* tuple, const uint8_t* data, size_t len);
+
+		/* Pure virtual methods inherited from RTC::WebRtcTransport::WebRtcTransportListener. */
+	public:
+		void OnWebRtcTransportCreated(RTC::WebRtcTransport* webRtcTransport) override;
+		void OnWebRtcTransportClosed(RTC::WebRtcTransport* webRtcTransport) override;
+		void OnWebRtcTransportLocalIceUsernameFragmentAdded(
+		  RTC::WebRtcTransport* webRtcTransport, const std::string& usernameFragment) override;
+		void OnWebRtcTransportLocalIceUsernameFragmentRemoved(
+		  RTC::WebRtcTransport* webRtcTransport, const std::string& usernameFragment) override;
+		void OnWebRtcTransportTransportTupleAdded(
+		  RTC::WebRtcTransport* webRtcTransport, RTC::TransportTuple* tuple) override;
+		void OnWebRtcTransportTransportTupleRemoved(
+		  RTC::WebRtcTransport* webRtcTransport, RTC::TransportTuple* tuple) override;
+
+		/* Pure virtual methods inherited from RTC::UdpSocket::Listener. */
+	public:
+		void OnUdpSocketPacketReceived(
+		  RTC::UdpSocket* socket, const uint8_t* data, size_t len, const struct sockaddr* remoteAddr) override;
+
+		/* Pure virtual methods inherited from RTC::TcpServer::Listener. */
+	public:
+		void OnRtcTcpConnectionClosed(RTC::TcpServer* tcpServer, RTC::TcpConnection* connection) override;
+
+		/* Pure virtual methods inherited from RTC::TcpConnection::Listener. */
+	public:
+		void OnTcpConnectionPacketReceived(
+		  RTC::TcpConnection* connection, const uint8_t* data, size_t len) override;
+
+	public:
+		// Passed by argument.
+		const std::string id;
+
+	private:
+		// Allocated by this.
+		std::vector<UdpSocketOrTcpServer> udpSocketOrTcpServers;
+		// UDP sockets connected to ICE selected tuples (reusePortIndex given),
+		// indexed by tuple key, and the listening UDP socket they belong to.
+		absl::flat_hash_map<RTC::TransportTuple::Key, RTC::UdpSocket*> mapTupleConnectedUdpSocket;
+		absl::flat_hash_map<RTC::UdpSocket*, RTC::UdpSocket*> mapConnectedUdpSocketUdpSocket;
+		// Others.
+		// Index of this server in the SO_REUSEPORT group of its UDP ports (-1 if
+		// not shared with other workers).
+		int8_t reusePortIndex{ -1 };
+		// First char of the ICE usernameFragment of its transports (it tells the
+		// reuseport steering program which worker handles a STUN request).
+		std::string iceUsernameFragmentPrefix;
+		absl::flat_hash_set<RTC::WebRtcTransport*> webRtcTransports;
+		absl::flat_hash_map<std::string, RTC::WebRtcTransport*> mapLocalIceUsernameFragmentWebRtcTransport;
+		absl::flat_hash_map<RTC::TransportTuple::Key, RTC::WebRtcTransport*> mapTupleWebRtcTransport;
+	};
+} // namespace RTC
+
+#endif
@@ -4,6 +4,9 @@
 #include "RTC/DtlsTransport.hpp"
 #include "RTC/IceCandidate.hpp"
 #include "RTC/IceServer.hpp"
+#include "RTC/PacketClassifier.hpp"
+#include "RTC/SrtpDecryptPool.hpp"
+#include "RTC/SrtpEncryptPool.hpp"
 #include "RTC/SrtpSession.hpp"
 #include "RTC/StunPacket.hpp"
 #include "RTC/TcpConnection.hpp"
@@ -20,7 +23,9 @@ namespace RTC
 	                        public RTC::TcpServer::Listener,
 	                        public RTC::TcpConnection::Listener,
 	                        public RTC::IceServer::Listener,
-	                        public RTC::DtlsTransport::Listener
+	                        public RTC::DtlsTransport::Listener,
+	                        public RTC::SrtpEncryptPool::Listener,
+	                        public RTC::SrtpDecryptPool::Listener
 	{
 	private:
 		struct ListenIp
@@ -29,19 +34,55 @@ namespace RTC
 			std::string announcedIp;
 		};
 
+	public:
+		class WebRtcTransportListener
+		{
+		public:
+			virtual ~WebRtcTransportListener() = default;
+
+		public:
+			virtual void OnWebRtcTransportCreated(RTC::WebRtcTransport* webRtcTransport) = 0;
+			virtual void OnWebRtcTransportClosed(RTC::WebRtcTransport* webRtcTransport) = 0;
+			virtual void OnWebRtcTransportLocalIceUsernameFragmentAdded(
+			  RTC::WebRtcTransport* webRtcTransport, const std::string& usernameFragment) = 0;
+			virtual void OnWebRtcTransportLocalIceUsernameFragmentRemoved(
+			  RTC::WebRtcTransport* webRtcTransport, const std::string& usernameFragment) = 0;
+			virtual void OnWebRtcTransportTransportTupleAdded(
+			  RTC::WebRtcTransport* webRtcTransport, RTC::TransportTuple* tuple) = 0;
+			virtual void OnWebRtcTransportTransportTupleRemoved(
+			  RTC::WebRtcTransport* webRtcTransport, RTC::TransportTuple* tuple) = 0;
+		};
+
 	public:
 		WebRtcTransport(const std::string& id, RTC::Transport::Listener* listener, json& data);
+		WebRtcTransport(
+		  const std::string& id,
+		  RTC::Transport::Listener* listener,
+		  WebRtcTransportListener* webRtcTransportListener,
+		  std::vector<RTC::IceCandidate>& iceCandidates,
+		  const std::string& iceUsernameFragmentPrefix,
+		  json& data);
 		~WebRtcTransport() override;
 
 	public:
 		void FillJson(json& jsonObject) const override;
 		void FillJsonStats(json& jsonArray) override;
+		void FillJsonState(json& jsonObject) const override;
 		void HandleRequest(Channel::ChannelRequest* request) override;
 		void HandleNotification(PayloadChannel::Notification* notification) override;
+		// These are called by the WebRtcServer that owns the sockets this transport
+		// is listening on (if any).
+		void ProcessStunPacketFromWebRtcServer(RTC::TransportTuple* tuple, RTC::StunPacket* packet);
+		void ProcessNonStunPacketFromWebRtcServer(
+		  RTC::TransportTuple* tuple, const uint8_t* data, size_t len);
+		void RemoveTuple(RTC::TransportTuple* tuple);
 
 	private:
+		std::string GenerateIceUsernameFragment() const;
 		bool IsConnected() const override;
 		void MayRunDtlsTransport();
+		void MayRecordIceBinding(const RTC::StunPacket* packet);
+		void MayRecordIceConnected();
 		void SendRtpPacket(
 		  RTC::Consumer* consumer,
 		  RTC::RtpPacket* packet,
@@ -62,6 +103,12 @@ namespace RTC
 		void OnDtlsDataReceived(const RTC::TransportTuple* tuple, const uint8_t* data, size_t len);
 		void OnRtpDataReceived(RTC::TransportTuple* tuple, const uint8_t* data, size_t len);
 		void OnRtcpDataReceived(RTC::TransportTuple* tuple, const uint8_t* data, size_t len);
+		void OnDecryptedRtpDataReceived(
+		  const RTC::TransportTuple* tuple, const uint8_t* data, size_t len);
+		void OnDecryptedRtcpDataReceived(
+		  const RTC::TransportTuple* tuple, const uint8_t* data, size_t len);
+		void OnNonStunPacketReceived(
+		  RTC::TransportTuple* tuple, RTC::PacketClassifier::Type type, const uint8_t* data, size_t len);
 
 		/* Pure virtual methods inherited from RTC::UdpSocket::Listener. */
 	public:
@@ -83,6 +130,12 @@ namespace RTC
 		  const RTC::IceServer* iceServer,
 		  const RTC::StunPacket* packet,
 		  RTC::TransportTuple* tuple) override;
+		void OnIceServerLocalUsernameFragmentAdded(
+		  const RTC::IceServer* iceServer, const std::string& usernameFragment) override;
+		void OnIceServerLocalUsernameFragmentRemoved(
+		  const RTC::IceServer* iceServer, const std::string& usernameFragment) override;
+		void OnIceServerTupleAdded(const RTC::IceServer* iceServer, RTC::TransportTuple* tuple) override;
+		void OnIceServerTupleRemoved(const RTC::IceServer* iceServer, RTC::TransportTuple* tuple) override;
 		void OnIceServerSelectedTuple(const RTC::IceServer* iceServer, RTC::TransportTuple* tuple) override;
 		void OnIceServerConnected(const RTC::IceServer* iceServer) override;
 		void OnIceServerCompleted(const RTC::IceServer* iceServer) override;
@@ -106,7 +159,20 @@ namespace RTC
 		void OnDtlsTransportApplicationDataReceived(
 		  const RTC::DtlsTransport* dtlsTransport, const uint8_t* data, size_t len) override;
 
+		/* Pure virtual methods inherited from RTC::SrtpEncryptPool::Listener. */
+	public:
+		void OnSrtpEncryptPoolRtpPacketEncrypted(const uint8_t* data, size_t len) override;
+
+		/* Pure virtual methods inherited from RTC::SrtpDecryptPool::Listener. */
+	public:
+		void OnSrtpDecryptPoolRtpPacketDecrypted(
+		  const RTC::TransportTuple* tuple, uint8_t* data, size_t len) override;
+		void OnSrtpDecryptPoolRtcpPacketDecrypted(
+		  const RTC::TransportTuple* tuple, uint8_t* data, size_t len) override;
+
 	private:
+		// Passed by argument.
+		WebRtcTransportListener* webRtcTransportListener{ nullptr };
 		// Allocated by this.
 		RTC::IceServer* iceServer{ nullptr };
 		// Map of UdpSocket/TcpServer and local announced IP (if any).
@@ -118,7 +184,18 @@ namespace RTC
 		// Others.
 		bool connectCalled{ false }; // Whether connect() was succesfully called.
 		std::vector<RTC::IceCandidate> iceCandidates;
+		// Prefix of the local ICE usernameFragment (given by the WebRtcServer).
+		std::string iceUsernameFragmentPrefix;
 		RTC::DtlsTransport::Role dtlsRole{ RTC::DtlsTransport::Role::AUTO };
+		// Keys of the SRTP sessions (given by DTLS), for the state.
+		RTC::SrtpSession::CryptoSuite srtpCryptoSuite{ RTC::SrtpSession::CryptoSuite::NONE };
+		std::string srtpLocalKeyBase64;
+		std::string srtpRemoteKeyBase64;
+		// Times (ms) at which the join phases were done (0 if not yet).
+		uint64_t createdAtMs{ 0u };
+		uint64_t iceBindingAtMs{ 0u };
+		uint64_t iceConnectedAtMs{ 0u };
+		uint64_t dtlsConnectedAtMs{ 0u };
 	};
 } // namespace RTC
 
@@ -3,6 +3,7 @@
 
 #include "common.hpp"
 #include "LogLevel.hpp"
+#include "Channel/ChannelMessage.hpp"
 #include "Channel/ChannelRequest.hpp"
 #include <absl/container/flat_hash_map.h>
 #include <string>
@@ -38,6 +39,105 @@ public:
 		uint16_t rtcMaxPort{ 59999u };
 		std::string dtlsCertificateFile;
 		std::string dtlsPrivateKeyFile;
+		// Directory in which the generated DTLS certificate is cached and shared
+		// by workers in the host.
+		std::string dtlsCertificateCacheDir;
+		Channel::ChannelMessage::Format channelMessageFormat{ Channel::ChannelMessage::Format::JSON };
+		// CPU the worker thread is pinned to (-1 means no pinning).
+		int32_t cpuAffinity{ -1 };
+		// CPUs the helper threads (SRTP encrypt and DTLS handshake pools) are
+		// pinned to, in round robin (empty means no pinning).
+		std::vector<int32_t> helperCpuAffinity;
+		// Whether memory is allocated in the NUMA node of the CPU running the
+		// thread that allocates it.
+		bool numaLocalMemory{ false };
+		// Whether each Transport allocates its long lived objects in its own
+		// memory arena.
+		bool transportArenas{ false };
+		// Whether the frame-marking RTP extension of H264 packets is trusted, so
+		// their payload is not inspected to detect key frames.
+		bool trustFrameMarking{ false };
+		// Whether Transports estimate the outgoing bandwidth with transport-cc
+		// feedback with the native SenderBandwidthEstimator instead of libwebrtc.
+		bool nativeBandwidthEstimator{ false };
+		// Whether SctpAssociations run the NativeSctpAssociation instead of
+		// usrsctp.
+		bool nativeSctp{ false };
+		// SCHED_FIFO priority of the worker thread (0 means SCHED_OTHER).
+		uint8_t realtimePriority{ 0u };
+		// Nice value of the worker thread (0 means inherited).
+		int8_t niceness{ 0 };
+		// Backend of the UDP sockets packet I/O: "libuv", "io_uring" or
+		// "io_uring_sqpoll".
+		std::string packetIo{ "libuv" };
+		// Number of threads encrypting outgoing SRTP (0 means in the worker thread).
+		uint8_t srtpEncryptThreads{ 0u };
+		// Number of threads decrypting incoming SRTP (0 means in the worker thread).
+		uint8_t srtpDecryptThreads{ 0u };
+		// Number of threads running DTLS handshakes (0 means in the worker thread).
+		uint8_t dtlsHandshakeThreads{ 0u };
+		// Whether DTLS clients can resume their sessions with session tickets
+		// issued by the worker (so reconnecting is cheaper).
+		bool dtlsSessionResumption{ false };
+		// Whether DTLS just uses ECDHE-ECDSA cipher suites with a P-256 key and
+		// cheap ECDHE curves.
+		bool dtlsEcdsaOnly{ false };
+		// Whether DTLS 1.3 is negotiated (with fallback to DTLS 1.2) if the SSL
+		// library supports it.
+		bool dtls13{ false };
+		// Maximum number of lines per second logged with each tag (0 means no
+		// limit).
+		uint32_t logRateLimit{ 0u };
+		// File into which log lines are written instead of sending them to the
+		// Node process (disabled if empty).
+		std::string logFile;
+		// File in which stats are periodically written (disabled if empty).
+		std::string statsFile;
+		// Interval (ms) in which score, layers and bwe notifications are sent
+		// together in a single message (0 means sent immediately).
+		uint32_t notificationBatchInterval{ 0u };
+		// Whether the time RTP packets spend in the worker is measured.
+		bool forwardingLatency{ false };
+		// Whether load is shed when the worker is overloaded.
+		bool overloadProtection{ false };
+		// Transports using REMB feed its bandwidth estimator with one of every
+		// rembSampling received RTP packets (1 means all of them).
+		uint8_t rembSampling{ 1u };
+		// Maximum number of transports probing the bandwidth at the same time
+		// (0 means no limit).
+		uint32_t maxProbingTransports{ 0u };
+		// Maximum number of key frame requests per second sent to the Producers
+		// of a Transport and of a Router (0 means no limit).
+		uint32_t maxKeyFrameRequestsPerTransport{ 0u };
+		uint32_t maxKeyFrameRequestsPerRouter{ 0u };
+		// Number of sockets kept bound in random ports of each IP (and for UDP
+		// and TCP) so transports are created without binding them (0 means
+		// disabled).
+		uint32_t socketPoolSize{ 0u };
+		// Size (bytes) of the kernel receive and send buffers of the UDP sockets
+		// (0 means the OS default).
+		uint32_t udpRecvBufferSize{ 0u };
+		uint32_t udpSendBufferSize{ 0u };
+		// Whether received RTP packets are stamped with the time the kernel
+		// received them (just UDP sockets read with io_uring) so transport-cc
+		// feedback and jitter do not include the time they waited in the worker.
+		bool kernelRecvTimestamps{ false };
+		// Whether UDP sockets send ECN capable datagrams and read the CE marks of
+		// received ones (just UDP sockets read with io_uring) to send ECN feedback.
+		bool ecn{ false };
+		// Whether TCP connections of WebRtcTransports and WebRtcServers accept
+		// TURN clients, terminating their allocations in the worker.
+		bool turnOverTcp{ false };
+		// Bitrate (bps) at which the video sent by all the transports of the
+		// worker is smoothed so bursts (i.e. key frames sent to many consumers)
+		// are spread over time (0 means disabled).
+		uint32_t egressBitrate{ 0u };
+		// Duration (ms) of the burst allowed by egressBitrate.
+		uint32_t egressBurstMs{ 20u };
+		// Time (us) during which the event loop keeps polling with no timeout
+		// once there are no events, before blocking. Also set as SO_BUSY_POLL in
+		// UDP sockets (0 means disabled).
+		uint32_t busyPollUs{ 0u };
 	};
 
 public:
@@ -48,7 +148,9 @@ public:
 private:
 	static void SetLogLevel(std::string& level);
 	static void SetLogTags(const std::vector<std::string>& tags);
+	static uint32_t GetUdpBufferSize(const char* name, int64_t value);
 	static void SetDtlsCertificateAndPrivateKeyFiles();
+	static void SetDtlsCertificateCacheDir();
 
 public:
 	thread_local static struct Configuration configuration;
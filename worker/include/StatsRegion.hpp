@@ -0,0 +1,129 @@
+#ifndef MS_STATS_REGION_HPP
+#define MS_STATS_REGION_HPP
+
+#include "common.hpp"
+#include <atomic>
+#include <string>
+
+/**
+ * Memory mapped file (statsFile setting) with a snapshot of the stats of every
+ * Transport and of every RTP stream of every Producer and Consumer of the
+ * Worker, stored as fixed size binary records. The Worker rewrites it
+ * periodically from the existing counters, so readers can sample it at any
+ * rate without sending requests to the Worker.
+ *
+ * Layout (native endianness):
+ *
+ * - Header (64 bytes).
+ * - recordCount records (256 bytes each).
+ *
+ * Consistency is provided by a sequence lock: the header sequence is odd
+ * while records are being written, so readers must copy the records and
+ * retry if the sequence was odd or changed meanwhile.
+ */
+class StatsRegion
+{
+public:
+	static constexpr uint32_t Version{ 1u };
+	static constexpr uint32_t MaxRecords{ 4096u };
+
+public:
+	enum class RecordType : uint8_t
+	{
+		TRANSPORT = 1,
+		PRODUCER_STREAM,
+		CONSUMER_STREAM
+	};
+
+	enum class RecordKind : uint8_t
+	{
+		NONE = 0,
+		AUDIO,
+		VIDEO
+	};
+
+	struct Header
+	{
+		// "MSSTATS" (NUL terminated).
+		char magic[8];
+		uint32_t version;
+		uint32_t headerSize;
+		uint32_t recordSize;
+		uint32_t maxRecords;
+		std::atomic<uint64_t> sequence;
+		uint32_t recordCount;
+		// Not all the records fit into the file.
+		uint32_t truncated;
+		// Time of the last update (ms).
+		uint64_t updatedAt;
+		uint8_t reserved[16];
+	};
+
+	struct Record
+	{
+		RecordType type;
+		RecordKind kind;
+		uint8_t score;
+		uint8_t fractionLost;
+		uint32_t ssrc;
+		// Id of the Transport, Producer or Consumer (NUL terminated).
+		char id[40];
+		// Id of the Transport of the Producer or Consumer (NUL terminated).
+		char transportId[40];
+		// RTP stream stats.
+		uint64_t packetCount;
+		uint64_t byteCount;
+		uint64_t packetsLost;
+		uint64_t packetsDiscarded;
+		uint64_t packetsRetransmitted;
+		uint64_t packetsRepaired;
+		uint64_t nackCount;
+		uint64_t nackPacketCount;
+		uint64_t pliCount;
+		uint64_t firCount;
+		uint32_t bitrate;
+		uint32_t jitter;
+		// Round trip time in ms (0 if unknown).
+		float roundTripTime;
+		uint32_t reserved1;
+		// Transport stats.
+		uint64_t bytesReceived;
+		uint64_t bytesSent;
+		uint32_t recvBitrate;
+		uint32_t sendBitrate;
+		uint32_t rtpRecvBitrate;
+		uint32_t rtpSendBitrate;
+		uint32_t availableOutgoingBitrate;
+		uint32_t availableIncomingBitrate;
+		float rtpPacketLossReceived;
+		float rtpPacketLossSent;
+		uint8_t reserved2[24];
+	};
+
+	static_assert(sizeof(Header) == 64, "unexpected Header size");
+	static_assert(sizeof(Record) == 256, "unexpected Record size");
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "sequence must be lock free");
+
+public:
+	explicit StatsRegion(const std::string& path);
+	~StatsRegion();
+
+public:
+	void BeginUpdate();
+	// Returns nullptr if there is no room for more records.
+	Record* AddRecord(RecordType type, const std::string& id, const std::string& transportId);
+	void EndUpdate(uint64_t nowMs);
+
+private:
+	// Passed by argument.
+	std::string path;
+	// Others.
+	int fd{ -1 };
+	size_t size{ 0u };
+	Header* header{ nullptr };
+	Record* records{ nullptr };
+	uint32_t recordCount{ 0u };
+	bool truncated{ false };
+};
+
+#endif
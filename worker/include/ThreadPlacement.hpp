@@ -0,0 +1,39 @@
+#ifndef MS_THREAD_PLACEMENT_HPP
+#define MS_THREAD_PLACEMENT_HPP
+
+#include "common.hpp"
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * Placement and scheduling of the threads of the worker (Linux only, ignored
+ * with a warning elsewhere):
+ *
+ * - cpuAffinity setting: CPU the worker (loop) thread is pinned to.
+ * - helperCpuAffinity setting: CPUs the helper threads (SRTP encrypt and DTLS
+ *   handshake pools) are pinned to, in round robin.
+ * - numaLocalMemory setting: memory is allocated in the NUMA node of the CPU
+ *   running the allocating thread (MPOL_LOCAL). Helper threads created later
+ *   inherit it.
+ * - realtimePriority setting: the worker thread runs with SCHED_FIFO.
+ * - niceness setting: nice value of the worker thread.
+ *
+ * The effective placement is reported in the dump of the Worker.
+ */
+class ThreadPlacement
+{
+public:
+	// This may throw.
+	static void ApplyToWorkerThread();
+	// This may throw.
+	static void ApplyToHelperThread(std::thread& thread);
+	static void FillJson(json& jsonObject);
+
+private:
+	thread_local static std::vector<int32_t> helperCpus;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef MS_TRACEPOINTS_HPP
+#define MS_TRACEPOINTS_HPP
+
+/**
+ * USDT (SystemTap SDT) static tracepoints of the "mediasoup" provider. They
+ * are enabled when the worker is built with sys/sdt.h available (MS_USDT
+ * macro). A disabled tracepoint is a single nop instruction so they are
+ * always compiled in, and they can be attached to a running worker with
+ * bpftrace, perf or SystemTap:
+ *
+ *   bpftrace -e 'usdt:./mediasoup-worker:mediasoup:consumer_packet_dropped
+ *     { @[str(arg3)] = count(); }' -p <pid>
+ *
+ * Tracepoints (and their arguments):
+ *
+ * - rtp_received: transport id, SSRC, sequence number, packet size.
+ * - producer_packet_dropped: producer id, SSRC, sequence number, reason.
+ * - consumer_packet_dropped: consumer id, SSRC, sequence number, reason.
+ * - nack_sent: media SSRC, first sequence number, number of packets.
+ * - nack_received: media SSRC, first sequence number, number of packets (for
+ *   every NACK item).
+ * - key_frame_requested: media SSRC.
+ * - srtp_failure: operation, libsrtp error code.
+ * - bwe_update: transport id, available bitrate, desired bitrate.
+ * - channel_request: method, request id.
+ *
+ * Strings are given as const char* and reasons are static strings.
+ */
+
+#ifdef MS_USDT
+#include <sys/sdt.h>
+
+#define MS_TRACEPOINT(name, ...) STAP_PROBEV(mediasoup, name, ##__VA_ARGS__)
+#else
+#define MS_TRACEPOINT(name, ...)
+#endif
+
+#endif
@@ -5,6 +5,7 @@
 #include <openssl/evp.h>
 #include <cmath>
 #include <cstring> // std::memcmp(), std::memcpy()
+#include <memory>  // std::addressof()
 #include <nlohmann/json.hpp>
 #include <string>
 #ifdef _WIN32
@@ -12,6 +13,7 @@
 // https://stackoverflow.com/a/24550632/2085408
 #include <intrin.h>
 #define __builtin_popcount __popcnt
+#define __builtin_popcountll __popcnt64
 #endif
 
 using json = nlohmann::json;
@@ -69,6 +71,30 @@ namespace Utils
 			}
 		}
 
+		static bool IsMulticast(const struct sockaddr* addr)
+		{
+			switch (addr->sa_family)
+			{
+				case AF_INET:
+				{
+					// 224.0.0.0/4.
+					return (ntohl(reinterpret_cast<const struct sockaddr_in*>(addr)->sin_addr.s_addr) &
+					        0xF0000000) == 0xE0000000;
+				}
+
+				case AF_INET6:
+				{
+					// ff00::/8.
+					return reinterpret_cast<const struct sockaddr_in6*>(addr)->sin6_addr.s6_addr[0] == 0xFF;
+				}
+
+				default:
+				{
+					return false;
+				}
+			}
+		}
+
 		static struct sockaddr_storage CopyAddress(const struct sockaddr* addr)
 		{
 			struct sockaddr_storage copiedAddr;
@@ -94,6 +120,7 @@ namespace Utils
 	{
 	public:
 		static void CheckFile(const char* file);
+		static void CheckDirectory(const char* dir);
 	};
 
 	class Byte
@@ -193,10 +220,56 @@ namespace Utils
 		{
 			return static_cast<size_t>(__builtin_popcount(mask));
 		}
+
+		static size_t CountSetBits(const uint64_t mask)
+		{
+			return static_cast<size_t>(__builtin_popcountll(mask));
+		}
+
+		// NOTE: mask must not be 0.
+		static size_t CountTrailingZeros(const uint64_t mask)
+		{
+#ifdef _WIN32
+			unsigned long idx;
+
+			_BitScanForward64(&idx, mask);
+
+			return static_cast<size_t>(idx);
+#else
+			return static_cast<size_t>(__builtin_ctzll(mask));
+#endif
+		}
 	};
 
 	class Crypto
 	{
+	public:
+		/**
+		 * HMAC-SHA1 with a fixed key. The inner and outer padded key states are
+		 * computed once, so every message just hashes its own bytes.
+		 */
+		class HmacSha1
+		{
+		public:
+			explicit HmacSha1(const std::string& key);
+			HmacSha1& operator=(const HmacSha1&) = delete;
+			HmacSha1(const HmacSha1&)            = delete;
+			~HmacSha1();
+
+		public:
+			const std::string& GetKey() const
+			{
+				return this->key;
+			}
+			// Returns the 20 bytes digest, valid until the next HMAC-SHA1 computed
+			// in this thread.
+			const uint8_t* Compute(const uint8_t* data, size_t len);
+
+		private:
+			std::string key;
+			EVP_MAC_CTX* ctx{ nullptr };
+		};
+
 	public:
 		static void ClassInit();
 		static void ClassDestroy();
@@ -238,18 +311,14 @@ namespace Utils
 			return std::string(buffer, len);
 		}
 
-		static uint32_t GetCRC32(const uint8_t* data, size_t size)
-		{
-			uint32_t crc{ 0xFFFFFFFF };
-			const uint8_t* p = data;
-
-			while (size--)
-			{
-				crc = Crypto::crc32Table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
-			}
+		// CRC32 (ISO-HDLC) as used by the STUN FINGERPRINT attribute, 8 bytes at
+		// a time (slicing-by-8).
+		static uint32_t GetCRC32(const uint8_t* data, size_t size);
 
-			return crc ^ ~0U;
-		}
+		// CRC32c (Castagnoli) as used by SCTP, hardware accelerated if the CPU
+		// supports it. The given crc (the one of the previous data) allows
+		// computing it in chunks.
+		static uint32_t GetCRC32c(const uint8_t* data, size_t size, uint32_t crc = 0u);
 
 		static const uint8_t* GetHmacSha1(const std::string& key, const uint8_t* data, size_t len);
 
@@ -258,7 +327,6 @@ namespace Utils
 		thread_local static EVP_MAC* mac;
 		thread_local static EVP_MAC_CTX* hmacSha1Ctx;
 		thread_local static uint8_t hmacSha1Buffer[];
-		static const uint32_t crc32Table[256];
 	};
 
 	class String
@@ -276,6 +344,18 @@ namespace Utils
 		static uint8_t* Base64Decode(const uint8_t* data, size_t len, size_t& outLen);
 
 		static uint8_t* Base64Decode(const std::string& str, size_t& outLen);
+
+		// Heap memory (in bytes) used by the string (none if short enough to be
+		// stored inline).
+		static size_t GetMemoryUsage(const std::string& str)
+		{
+			const auto* begin = reinterpret_cast<const char*>(std::addressof(str));
+
+			if (str.data() >= begin && str.data() < begin + sizeof(std::string))
+				return 0u;
+
+			return str.capacity() + 1u;
+		}
 	};
 
 	class Time
@@ -2,13 +2,18 @@
 #define MS_WORKER_HPP
 
 #include "common.hpp"
+#include "OverloadController.hpp"
 #include "Channel/ChannelRequest.hpp"
 #include "Channel/ChannelSocket.hpp"
 #include "PayloadChannel/Notification.hpp"
 #include "PayloadChannel/PayloadChannelRequest.hpp"
 #include "PayloadChannel/PayloadChannelSocket.hpp"
+#include "RTC/HandleTable.hpp"
 #include "RTC/Router.hpp"
+#include "StatsRegion.hpp"
+#include "RTC/WebRtcServer.hpp"
 #include "handles/SignalsHandler.hpp"
+#include "handles/Timer.hpp"
 #include <absl/container/flat_hash_map.h>
 #include <nlohmann/json.hpp>
 #include <string>
@@ -17,18 +22,29 @@ using json = nlohmann::json;
 
 class Worker : public Channel::ChannelSocket::Listener,
                public PayloadChannel::PayloadChannelSocket::Listener,
-               public SignalsHandler::Listener
+               public SignalsHandler::Listener,
+               public RTC::Router::Listener,
+               public Timer::Listener,
+               public OverloadController::Listener
 {
 public:
-	explicit Worker(Channel::ChannelSocket* channel, PayloadChannel::PayloadChannelSocket* payloadChannel);
+	// startupTimes is sent with the 'running' notification.
+	Worker(
+	  Channel::ChannelSocket* channel,
+	  PayloadChannel::PayloadChannelSocket* payloadChannel,
+	  json& startupTimes);
 	~Worker();
 
 private:
 	void Close();
 	void FillJson(json& jsonObject) const;
 	void FillJsonResourceUsage(json& jsonObject) const;
+	void UpdateStatsRegion();
+	void EmitState();
 	void SetNewRouterIdFromInternal(json& internal, std::string& routerId) const;
 	RTC::Router* GetRouterFromInternal(json& internal) const;
+	void SetNewWebRtcServerIdFromInternal(json& internal, std::string& webRtcServerId) const;
+	RTC::WebRtcServer* GetWebRtcServerFromInternal(json& internal) const;
 
 	/* Methods inherited from Channel::lUnixStreamSocket::Listener. */
 public:
@@ -49,15 +65,39 @@ public:
 public:
 	void OnSignal(SignalsHandler* signalsHandler, int signum) override;
 
+	/* Pure virtual methods inherited from RTC::Router::Listener. */
+public:
+	RTC::WebRtcServer* OnRouterNeedWebRtcServer(
+	  RTC::Router* router, std::string& webRtcServerId) override;
+
+	/* Pure virtual methods inherited from Timer::Listener. */
+public:
+	void OnTimer(Timer* timer) override;
+
+	/* Pure virtual methods inherited from OverloadController::Listener. */
+public:
+	void OnOverloadControllerLevelChange(
+	  OverloadController* overloadController,
+	  OverloadController::Level level,
+	  OverloadController::Level previousLevel) override;
+
 private:
 	// Passed by argument.
 	Channel::ChannelSocket* channel{ nullptr };
 	PayloadChannel::PayloadChannelSocket* payloadChannel{ nullptr };
 	// Allocated by this.
 	SignalsHandler* signalsHandler{ nullptr };
+	absl::flat_hash_map<std::string, RTC::WebRtcServer*> mapWebRtcServers;
 	absl::flat_hash_map<std::string, RTC::Router*> mapRouters;
+	RTC::HandleTable<RTC::Router> routerHandles;
+	StatsRegion* statsRegion{ nullptr };
+	Timer* statsRegionTimer{ nullptr };
+	Timer* notificationBatchTimer{ nullptr };
+	Timer* stateStreamTimer{ nullptr };
+	OverloadController* overloadController{ nullptr };
 	// Others.
 	bool closed{ false };
+	uint64_t stateSeq{ 0u };
 };
 
 #endif
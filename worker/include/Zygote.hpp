@@ -0,0 +1,44 @@
+#ifndef MS_ZYGOTE_HPP
+#define MS_ZYGOTE_HPP
+
+#include "common.hpp"
+#include <string>
+#include <vector>
+
+/**
+ * Template mediasoup-worker process (POSIX only), enabled by running the
+ * worker with the MEDIASOUP_ZYGOTE_SOCKET environment variable set to the
+ * path of a Unix socket to listen on.
+ *
+ * The zygote initializes OpenSSL and libsrtp and generates the default DTLS
+ * certificate once, and then forks a worker for each connection to the
+ * socket, so workers share that state copy-on-write and skip its cost.
+ *
+ * Protocol, one request per connection:
+ *
+ * - The client sends a single message whose payload are the worker command
+ *   line arguments (without the program name), each one terminated by '\0',
+ *   and whose ancillary data (SCM_RIGHTS) are the 4 channel fds in the order
+ *   consumer, producer, payload consumer and payload producer.
+ * - The zygote replies with the pid of the new worker in decimal followed by
+ *   '\n' (or "0\n" on failure) and closes the connection.
+ *
+ * Workers are reaped automatically (SIGCHLD is ignored by the zygote).
+ */
+class Zygote
+{
+public:
+	static constexpr size_t NumChannelFds{ 4u };
+	static constexpr size_t MaxArgsLength{ 65536u };
+
+public:
+	static int Run(const char* socketPath, const std::string& version);
+	// Splits a '\0' terminated list of arguments. Exposed for testing.
+	static std::vector<std::string> ParseArgs(const uint8_t* data, size_t len);
+
+private:
+	static void WarmUp();
+	static void HandleConnection(int listenFd, int connFd, const std::string& version);
+};
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef MS_IO_URING_HPP
+#define MS_IO_URING_HPP
+
+#include "common.hpp"
+#include <absl/container/flat_hash_set.h>
+#include <nlohmann/json.hpp>
+#include <uv.h>
+#include <vector>
+#ifdef __linux__
+#include <sys/socket.h> // struct msghdr
+#include <sys/uio.h>    // struct iovec
+#endif
+
+using json = nlohmann::json;
+
+/**
+ * Per thread (so per worker) io_uring I/O backend of the UDP sockets and TCP
+ * connections (packetIo setting), used instead of libuv reads and sendmmsg()
+ * (Linux only, kernel 6.0 or newer, no liburing needed).
+ *
+ * - Receive: a multishot recvmsg (UDP) or recv (TCP) request per socket
+ *   writes into a ring of buffers provided by us (sized for a RTP packet), so
+ *   no syscall is done per socket read and completions of all the sockets are
+ *   reaped in a single loop wakeup (the ring fd is polled by libuv). Datagrams
+ *   are given to the socket straight from the provided buffer, which is
+ *   recycled once the callback returns. TCP data is copied into the buffer of
+ *   the connection, where it's framed.
+ * - Send: the egress queue of the UDP socket (whose datagrams SRTP encrypts
+ *   in place) is moved into a batch of sendmsg requests with no copy, kept
+ *   alive until all of them complete. Requests of all the sockets are
+ *   submitted at once at the end of the loop iteration. With SQPOLL a kernel
+ *   thread consumes the submission ring, so sending does not need any
+ *   syscall.
+ *
+ * If io_uring is not available the libuv path is used.
+ */
+class IoUring
+{
+public:
+	/* Ancillary data of a received datagram. */
+	struct RecvInfo
+	{
+		// CLOCK_REALTIME time at which the kernel received it (0 if unknown).
+		uint64_t kernelTimeNs{ 0u };
+		// IP TOS (or IPv6 traffic class) byte (-1 if unknown).
+		int16_t tos{ -1 };
+	};
+
+	class Listener
+	{
+	public:
+		virtual ~Listener() = default;
+
+	public:
+		virtual void OnIoUringDatagramReceived(
+		  const uint8_t* data,
+		  size_t len,
+		  const struct sockaddr* addr,
+		  const IoUring::RecvInfo& recvInfo) = 0;
+	};
+
+	class StreamListener
+	{
+	public:
+		virtual ~StreamListener() = default;
+
+	public:
+		// Returns the number of bytes consumed. The rest is given again unless
+		// it's 0 or the socket was closed.
+		virtual size_t OnIoUringStreamReceived(const uint8_t* data, size_t len) = 0;
+		// error is 0 if the stream was closed by the peer and a negated errno
+		// otherwise.
+		virtual void OnIoUringStreamClosed(int error) = 0;
+	};
+
+	struct SendBatch;
+	struct RecvContext;
+
+#ifdef __linux__
+	/* Datagrams sent by a batch of sendmsg requests. */
+	struct SendBatch
+	{
+		// Datagrams (memory of the egress queue of the socket).
+		std::vector<uint8_t> buffer;
+		std::vector<struct sockaddr_storage> addrs;
+		std::vector<struct iovec> iovs;
+		std::vector<struct msghdr> msgs;
+		// Buffer for the UDP_SEGMENT cmsg of every message.
+		std::vector<uint8_t> controls;
+		// Whether some message has UDP GSO segments.
+		bool gso{ false };
+		size_t pendingMsgs{ 0u };
+	};
+
+	/* A socket reading with a multishot recvmsg (or recv) request. */
+	struct RecvContext
+	{
+		int fd{ -1 };
+		// Just one of them is set (unset once the socket is closed).
+		Listener* listener{ nullptr };
+		StreamListener* streamListener{ nullptr };
+		// Whether the multishot request is in flight.
+		bool armed{ false };
+		// Whether datagrams come with a SO_TIMESTAMPNS cmsg.
+		bool timestamps{ false };
+		// Whether datagrams come with a IP_TOS (or IPV6_TCLASS) cmsg.
+		bool tos{ false };
+		// Template of the received messages (just the name and control lengths
+		// are used).
+		struct msghdr msg;
+	};
+#endif
+
+public:
+	// Tag of the request in the low bits of its user data.
+	enum class RequestTag : uint64_t
+	{
+		RECV   = 1,
+		SEND   = 2,
+		CANCEL = 3
+	};
+
+public:
+	static void ClassInit(bool sqPoll);
+	static void ClassDestroy();
+	static bool IsRunning()
+	{
+		return IoUring::ringFd >= 0;
+	}
+	static bool IsGsoDisabled()
+	{
+		return IoUring::gsoDisabled;
+	}
+	static void FillJson(json& jsonObject);
+#ifdef __linux__
+	// If timestamps is true the socket must have SO_TIMESTAMPNS enabled. If tos
+	// is true it must have IP_RECVTOS (or IPV6_RECVTCLASS) enabled.
+	static RecvContext* StartRecv(
+	  int fd, Listener* listener, bool timestamps = false, bool tos = false);
+	static RecvContext* StartStreamRecv(int fd, StreamListener* streamListener);
+	static void StopRecv(RecvContext* recvContext);
+	// Takes ownership of the batch (deleted once its requests complete) if it
+	// returns true. Requests are submitted at the end of the loop iteration.
+	static bool Send(int fd, SendBatch* batch);
+#endif
+
+	/* Callbacks fired by UV events. */
+public:
+	static void OnUvPoll();
+	static void OnUvPrepare();
+
+private:
+#ifdef __linux__
+	static struct io_uring_sqe* GetSqe();
+	static RecvContext* StartRecv(RecvContext* recvContext);
+	static bool SubmitRecv(RecvContext* recvContext);
+	static void DeliverStreamData(RecvContext* recvContext, const uint8_t* data, size_t len);
+	static void Submit();
+	static void RecycleBuffer(uint16_t bufferId);
+	static void ProcessCompletions();
+#endif
+
+private:
+	thread_local static int ringFd;
+	thread_local static bool sqPoll;
+	thread_local static bool gsoDisabled;
+	thread_local static uv_poll_t* uvPollHandle;
+	thread_local static uv_prepare_t* uvPrepareHandle;
+#ifdef __linux__
+	// Requests not completed yet (freed in ClassDestroy() otherwise).
+	thread_local static absl::flat_hash_set<RecvContext*> recvContexts;
+	thread_local static absl::flat_hash_set<SendBatch*> sendBatches;
+#endif
+	// Stats (submitCalls counts io_uring_enter() syscalls).
+	thread_local static uint64_t submitCalls;
+	thread_local static uint64_t recvCompletions;
+	thread_local static uint64_t sendCompletions;
+	thread_local static uint64_t sendErrors;
+	thread_local static uint64_t truncatedDatagrams;
+};
+
+#endif
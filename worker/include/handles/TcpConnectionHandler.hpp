@@ -2,12 +2,22 @@
 #define MS_TCP_CONNECTION_HPP
 
 #include "common.hpp"
+#include "handles/IoUring.hpp"
+#include <nlohmann/json.hpp>
 #include <uv.h>
+#include <deque>
 #include <string>
+#include <vector>
 
-class TcpConnectionHandler
+using json = nlohmann::json;
+
+class TcpConnectionHandler : public IoUring::StreamListener
 {
 protected:
+	// NOTE: The callback is owned by the caller. If given, it's invoked exactly
+	// once before Write() returns, so it can live in the caller's stack. Written
+	// data is queued and sent once per loop iteration, so the callback just
+	// tells whether it was queued.
 	using onSendCallback = const std::function<void(bool sent)>;
 
 public:
@@ -18,31 +28,25 @@ public:
 
 	public:
 		virtual void OnTcpConnectionClosed(TcpConnectionHandler* connection) = 0;
+		// Only called for connections initiated with Connect().
+		virtual void OnTcpConnectionConnected(TcpConnectionHandler* /*connection*/)
+		{
+		}
 	};
 
 public:
 	/* Struct for the data field of uv_req_t when writing into the connection. */
 	struct UvWriteData
 	{
-		explicit UvWriteData(size_t storeSize)
-		{
-			this->store = new uint8_t[storeSize];
-		}
-
-		// Disable copy constructor because of the dynamically allocated data (store).
-		UvWriteData(const UvWriteData&) = delete;
-
-		~UvWriteData()
-		{
-			delete[] this->store;
-			delete this->cb;
-		}
-
 		uv_write_t req;
-		uint8_t* store{ nullptr };
-		TcpConnectionHandler::onSendCallback* cb{ nullptr };
+		std::vector<uint8_t> store;
 	};
 
+public:
+	// Max time (in ms) media data can wait in the write queue. Older one is
+	// dropped instead of adding latency.
+	static constexpr uint64_t MaxQueuedMediaAge{ 200u };
+
 public:
 	explicit TcpConnectionHandler(size_t bufferSize);
 	TcpConnectionHandler& operator=(const TcpConnectionHandler&) = delete;
@@ -52,11 +56,19 @@ public:
 public:
 	void Close();
 	virtual void Dump() const;
+	void FillJsonStats(json& jsonObject) const;
 	void Setup(
 	  Listener* listener,
 	  struct sockaddr_storage* localAddr,
 	  const std::string& localIp,
 	  uint16_t localPort);
+	/**
+	 * Connect to the given remote address instead of being accepted by a
+	 * TcpServerHandler. Once connected it's started and the listener is
+	 * notified. If it fails the connection is closed and the listener is
+	 * notified too.
+	 */
+	void Connect(Listener* listener, const struct sockaddr* remoteAddr);
 	bool IsClosed() const
 	{
 		return this->closed;
@@ -66,12 +78,17 @@ public:
 		return this->uvHandle;
 	}
 	void Start();
+	/**
+	 * If isMedia is set, the data is dropped if it cannot be written within
+	 * MaxQueuedMediaAge ms (because the connection is congested).
+	 */
 	void Write(
 	  const uint8_t* data1,
 	  size_t len1,
 	  const uint8_t* data2,
 	  size_t len2,
-	  TcpConnectionHandler::onSendCallback* cb);
+	  TcpConnectionHandler::onSendCallback* cb,
+	  bool isMedia = false);
 	void ErrorReceiving();
 	const struct sockaddr* GetLocalAddress() const
 	{
@@ -109,15 +126,27 @@ public:
 	{
 		return this->sentBytes;
 	}
+	// Bytes not written into the kernel yet.
+	size_t GetWriteQueueSize() const;
 
 private:
 	bool SetPeerAddress();
+	void SetSocketOptions();
+	void Flush();
+	void DropStaleMedia();
 
 	/* Callbacks fired by UV events. */
 public:
 	void OnUvReadAlloc(size_t suggestedSize, uv_buf_t* buf);
 	void OnUvRead(ssize_t nread, const uv_buf_t* buf);
-	void OnUvWrite(int status, onSendCallback* cb);
+	void OnUvWrite(int status);
+	void OnUvPrepare();
+	void OnUvConnect(int status);
+
+	/* Pure virtual methods inherited from IoUring::StreamListener. */
+public:
+	size_t OnIoUringStreamReceived(const uint8_t* data, size_t len) override;
+	void OnIoUringStreamClosed(int error) override;
 
 	/* Pure virtual methods that must be implemented by the subclass. */
 protected:
@@ -136,18 +165,43 @@ protected:
 	std::string peerIp;
 	uint16_t peerPort{ 0u };
 
+private:
+	// Media data in the write buffer.
+	struct QueuedMedia
+	{
+		size_t offset;
+		size_t len;
+		uint64_t queuedAtMs;
+	};
+
 private:
 	// Passed by argument.
 	Listener* listener{ nullptr };
 	// Allocated by this.
 	uv_tcp_t* uvHandle{ nullptr };
+	uv_prepare_t* uvPrepareHandle{ nullptr };
+	// Set if data is read with io_uring (packetIo setting) instead of libuv
+	// (deleted by IoUring).
+	IoUring::RecvContext* ioUringRecvContext{ nullptr };
+	// Data pending to be written, reused across writes. If a write is in
+	// progress it's owned by libuv.
+	UvWriteData* uvWriteData{ nullptr };
 	// Others.
+	// Data written in this loop iteration (or while a write is in progress).
+	std::vector<uint8_t> writeBuffer;
+	std::deque<QueuedMedia> queuedMedia;
+	bool writing{ false };
 	struct sockaddr_storage* localAddr{ nullptr };
 	bool closed{ false };
 	size_t recvBytes{ 0u };
 	size_t sentBytes{ 0u };
+	size_t droppedMediaPackets{ 0u };
+	size_t droppedMediaBytes{ 0u };
 	bool isClosedByPeer{ false };
 	bool hasError{ false };
+	// Local address of connections initiated with Connect().
+	struct sockaddr_storage connectLocalAddr;
+	bool connecting{ false };
 };
 
 #endif
@@ -2,7 +2,7 @@
 #define MS_TIMER_HPP
 
 #include "common.hpp"
-#include <uv.h>
+#include "handles/TimerWheel.hpp"
 
 class Timer
 {
@@ -38,19 +38,18 @@ public:
 	}
 	bool IsActive() const
 	{
-		return uv_is_active(reinterpret_cast<uv_handle_t*>(this->uvHandle)) != 0;
+		return TimerWheel::IsArmed(std::addressof(this->wheelNode));
 	}
 
-	/* Callbacks fired by UV events. */
+	/* Callbacks fired by TimerWheel. */
 public:
-	void OnUvTimer();
+	void OnTimerWheel();
 
 private:
 	// Passed by argument.
 	Listener* listener{ nullptr };
-	// Allocated by this.
-	uv_timer_t* uvHandle{ nullptr };
 	// Others.
+	TimerWheel::Node wheelNode;
 	bool closed{ false };
 	uint64_t timeout{ 0u };
 	uint64_t repeat{ 0u };
@@ -0,0 +1,70 @@
+#ifndef MS_TIMER_WHEEL_HPP
+#define MS_TIMER_WHEEL_HPP
+
+#include "common.hpp"
+#include <uv.h>
+#include <array>
+
+class Timer;
+
+/**
+ * Per thread (so per worker) hashed timing wheel with millisecond resolution
+ * driven by a single uv timer. Every Timer registers with it instead of
+ * owning its own uv_timer_t, so arming and cancelling a Timer is O(1) and
+ * does not allocate memory nor touch the libuv timer heap.
+ *
+ * Each slot covers one millisecond and holds an intrusive list of the timers
+ * expiring in that millisecond of any wheel turn. The uv timer is only armed
+ * while there are timers in the wheel, and it is set to fire at the next non
+ * empty slot.
+ */
+class TimerWheel
+{
+public:
+	// Number of slots (must be a power of 2), so a wheel turn lasts this many
+	// milliseconds. Timers expiring after more turns just stay in their slot.
+	static constexpr size_t NumSlots{ 1024u };
+
+public:
+	// Intrusive list node embedded into every Timer.
+	struct Node
+	{
+		Node* prev{ nullptr };
+		Node* next{ nullptr };
+		Timer* timer{ nullptr };
+		uint64_t expiresAt{ 0u };
+	};
+
+public:
+	static void ClassDestroy();
+	static void Arm(Node* node, uint64_t timeout);
+	static void Cancel(Node* node);
+	static bool IsArmed(const Node* node)
+	{
+		return node->next != nullptr;
+	}
+	static size_t GetNumArmed()
+	{
+		return TimerWheel::numArmed;
+	}
+
+	/* Callbacks fired by UV events. */
+public:
+	static void OnUvTimer();
+
+private:
+	static void Init();
+	static void Schedule(uint64_t now);
+
+private:
+	thread_local static uv_timer_t* uvHandle;
+	thread_local static std::array<Node, NumSlots> slots;
+	// Timers expired (and not yet notified) in the ongoing OnUvTimer().
+	thread_local static Node expired;
+	thread_local static uint64_t currentTick;
+	thread_local static uint64_t scheduledAt;
+	thread_local static size_t numArmed;
+	thread_local static bool processing;
+};
+
+#endif
@@ -2,12 +2,20 @@
 #define MS_UDP_SOCKET_HPP
 
 #include "common.hpp"
+#include "handles/IoUring.hpp"
+#include <nlohmann/json.hpp>
 #include <uv.h>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
-class UdpSocketHandler
+using json = nlohmann::json;
+
+class UdpSocketHandler : public IoUring::Listener
 {
 protected:
+	// NOTE: The callback is owned by the caller. If given, it's invoked exactly
+	// once before Send() returns, so it can live in the caller's stack.
 	using onSendCallback = const std::function<void(bool sent)>;
 
 public:
@@ -25,14 +33,79 @@ public:
 		~UvSendData()
 		{
 			delete[] this->store;
-			delete this->cb;
 		}
 
 		uv_udp_send_t req;
 		uint8_t* store{ nullptr };
-		UdpSocketHandler::onSendCallback* cb{ nullptr };
+	};
+
+private:
+	/* Struct for a datagram waiting in the egress queue. */
+	struct SendQueueItem
+	{
+		size_t offset{ 0u };
+		size_t len{ 0u };
+		struct sockaddr_storage addr;
+		// Set if the forwardingLatency setting is enabled.
+		uint64_t queuedAtNs{ 0u };
 	};
 
+public:
+	static uint64_t GetRecvBatches()
+	{
+		return UdpSocketHandler::recvBatches;
+	}
+	static uint64_t GetRecvBatchedDatagrams()
+	{
+		return UdpSocketHandler::recvBatchedDatagrams;
+	}
+	static uint64_t GetSendBatches()
+	{
+		return UdpSocketHandler::sendBatches;
+	}
+	static uint64_t GetSendBatchedDatagrams()
+	{
+		return UdpSocketHandler::sendBatchedDatagrams;
+	}
+	/**
+	 * Apply the udpRecvBufferSize and udpSendBufferSize settings to all the
+	 * open sockets.
+	 */
+	static void ApplyBufferSizes();
+	/**
+	 * Time (ms, in the DepLibUV::GetTimeMs() time base) at which the kernel
+	 * received the datagram being notified to the subclass. 0 if unknown (the
+	 * kernelRecvTimestamps setting is disabled or the socket is not read with
+	 * io_uring).
+	 */
+	static uint64_t GetRecvTime()
+	{
+		return UdpSocketHandler::recvTimeMs;
+	}
+	/**
+	 * ECN codepoint (RFC 3168) of the datagram being notified to the subclass.
+	 * -1 if unknown (the ecn setting is disabled or the socket is not read with
+	 * io_uring).
+	 */
+	static int8_t GetRecvEcn()
+	{
+		return UdpSocketHandler::recvEcn;
+	}
+
+private:
+	// Open sockets (so settings can be applied to them in runtime).
+	thread_local static std::unordered_set<UdpSocketHandler*> handlers;
+	thread_local static uint64_t recvTimeMs;
+	thread_local static int8_t recvEcn;
+	// Number of libuv read wakeups that delivered at least one datagram and
+	// total number of datagrams delivered by them (in all sockets).
+	thread_local static uint64_t recvBatches;
+	thread_local static uint64_t recvBatchedDatagrams;
+	// Number of sendmmsg() calls (or io_uring send batches) and total number of
+	// datagrams sent by them (in all sockets).
+	thread_local static uint64_t sendBatches;
+	thread_local static uint64_t sendBatchedDatagrams;
+
 public:
 	/**
 	 * uvHandle must be an already initialized and binded uv_udp_t pointer.
@@ -45,8 +118,26 @@ public:
 public:
 	void Close();
 	virtual void Dump() const;
+	void FillJsonStats(json& jsonObject) const;
 	void Send(
 	  const uint8_t* data, size_t len, const struct sockaddr* addr, UdpSocketHandler::onSendCallback* cb);
+	/**
+	 * Memory in the egress queue where a datagram of up to len bytes can be
+	 * written and then sent with SendBuffer() with no extra copy. No other
+	 * method must be called in between. Returns nullptr if not available.
+	 */
+	uint8_t* GetSendBuffer(size_t len);
+	void SendBuffer(size_t len, const struct sockaddr* addr, UdpSocketHandler::onSendCallback* cb);
+	/**
+	 * Send the datagrams queued in the egress queue now instead of waiting for
+	 * the end of the event loop iteration.
+	 */
+	void FlushSendQueue();
+	/**
+	 * Options of the datagrams sent to multicast groups. These may throw.
+	 */
+	void SetMulticastTtl(uint8_t ttl);
+	void SetMulticastInterface(const std::string& ip);
 	const struct sockaddr* GetLocalAddress() const
 	{
 		return reinterpret_cast<const struct sockaddr*>(&this->localAddr);
@@ -74,12 +165,31 @@ public:
 
 private:
 	bool SetLocalAddress();
+	void SetBufferSizes();
+	void SendNow(
+	  const uint8_t* data, size_t len, const struct sockaddr* addr, UdpSocketHandler::onSendCallback* cb);
+	void EnqueueSend(
+	  const uint8_t* data, size_t len, const struct sockaddr* addr, UdpSocketHandler::onSendCallback* cb);
+	uint8_t* ReserveSendQueueBuffer(size_t len);
+	void CommitSendQueueBuffer(
+	  size_t len, const struct sockaddr* addr, UdpSocketHandler::onSendCallback* cb);
+	bool FlushSendQueueIoUring(std::vector<SendQueueItem>& items, std::vector<uint8_t>& buffer);
+	static size_t GetGsoGroupEnd(const std::vector<SendQueueItem>& items, size_t begin, bool gso);
 
 	/* Callbacks fired by UV events. */
 public:
 	void OnUvRecvAlloc(size_t suggestedSize, uv_buf_t* buf);
 	void OnUvRecv(ssize_t nread, const uv_buf_t* buf, const struct sockaddr* addr, unsigned int flags);
-	void OnUvSend(int status, UdpSocketHandler::onSendCallback* cb);
+	void OnUvSend(int status);
+	void OnUvPrepare();
+
+	/* Pure virtual methods inherited from IoUring::Listener. */
+public:
+	void OnIoUringDatagramReceived(
+	  const uint8_t* data,
+	  size_t len,
+	  const struct sockaddr* addr,
+	  const IoUring::RecvInfo& recvInfo) override;
 
 	/* Pure virtual methods that must be implemented by the subclass. */
 protected:
@@ -94,10 +204,23 @@ protected:
 private:
 	// Allocated by this (may be passed by argument).
 	uv_udp_t* uvHandle{ nullptr };
+	// Allocated by this.
+	uv_prepare_t* uvPrepareHandle{ nullptr };
+	// Set if datagrams are read with io_uring (packetIo setting) instead of
+	// libuv (deleted by IoUring).
+	IoUring::RecvContext* ioUringRecvContext{ nullptr };
 	// Others.
 	bool closed{ false };
 	size_t recvBytes{ 0u };
 	size_t sentBytes{ 0u };
+	size_t currentRecvBatchSize{ 0u };
+	// Egress queue flushed with sendmmsg() (or io_uring) once per event loop
+	// iteration.
+	int fd{ -1 };
+	bool gsoEnabled{ true };
+	std::vector<SendQueueItem> sendQueue;
+	std::vector<uint8_t> sendQueueBuffer;
+	size_t sendQueueBufferLen{ 0u };
 };
 
 #endif
@@ -46,7 +46,13 @@ public:
 	{
 		return this->closed;
 	}
+	// Stop reading (so the peer is pushed back once the kernel buffers are
+	// full) until ResumeReading() is called.
+	void PauseReading();
+	void ResumeReading();
 	void Write(const uint8_t* data, size_t len);
+	// Writes the given buffers at once (just the data not written yet is copied).
+	void Write(const uv_buf_t* buffers, size_t numBuffers);
 
 	/* Callbacks fired by UV events. */
 public:
@@ -66,6 +72,7 @@ private:
 	bool closed{ false };
 	bool isClosedByPeer{ false };
 	bool hasError{ false };
+	bool readingPaused{ false };
 
 protected:
 	// Passed by argument.
@@ -0,0 +1,61 @@
+#ifndef MS_LOAD_GEN_CAPTURE_HPP
+#define MS_LOAD_GEN_CAPTURE_HPP
+
+#include "common.hpp"
+#include <string>
+#include <vector>
+
+namespace LoadGen
+{
+	/**
+	 * RTP packets of a single stream read from a pcap (Ethernet, raw IP or Linux
+	 * cooked link types, UDP over IPv4 or IPv6) or rtpdump (rtptools) capture,
+	 * with their reception time relative to the first one.
+	 */
+	class Capture
+	{
+	public:
+		struct Packet
+		{
+			uint64_t offsetUs{ 0u };
+			std::vector<uint8_t> data;
+		};
+
+	public:
+		// If ssrc is 0 the stream with more packets is used. It throws if the file
+		// cannot be read or there are no RTP packets.
+		explicit Capture(const std::string& path, uint32_t ssrc = 0u);
+
+	public:
+		const std::vector<Packet>& GetPackets() const
+		{
+			return this->packets;
+		}
+		uint32_t GetSsrc() const
+		{
+			return this->ssrc;
+		}
+		uint8_t GetPayloadType() const
+		{
+			return this->payloadType;
+		}
+		uint64_t GetDurationUs() const
+		{
+			return this->packets.back().offsetUs;
+		}
+
+	private:
+		void LoadPcap(const std::vector<uint8_t>& file);
+		void LoadRtpDump(const std::vector<uint8_t>& file);
+		void AddUdpPayload(uint64_t timeUs, const uint8_t* data, size_t len);
+		void AddIpPacket(uint64_t timeUs, const uint8_t* data, size_t len);
+		void SelectStream(uint32_t ssrc);
+
+	private:
+		std::vector<Packet> packets;
+		uint32_t ssrc{ 0u };
+		uint8_t payloadType{ 0u };
+	};
+} // namespace LoadGen
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef MS_LOAD_GEN_WORKER_CLIENT_HPP
+#define MS_LOAD_GEN_WORKER_CLIENT_HPP
+
+#include "common.hpp"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace LoadGen
+{
+	/**
+	 * Runs a worker in a thread of this process (as the Rust crate does) and
+	 * talks to it over its Channel like the Node library does, so the whole
+	 * worker (Channel, Router, transports and sockets) is exercised.
+	 */
+	class WorkerClient
+	{
+	public:
+		// Given arguments are worker settings (i.e. "--logLevel=warn").
+		explicit WorkerClient(const std::vector<std::string>& workerArgs);
+		~WorkerClient();
+
+	public:
+		// Sends a request and waits for its response. Returns the response data
+		// and throws if rejected.
+		json Request(const std::string& method, const json& internal, const json& data = json::object());
+		// Reads and discards available notifications and logs.
+		void Drain();
+		// Fd from which worker messages are read (to poll it).
+		int GetFd() const
+		{
+			return this->readFd;
+		}
+
+	private:
+		void Send(const json& request);
+		// Returns false if blocking is false and there is no message.
+		bool ReadMessage(json& message, bool blocking);
+
+	private:
+		std::vector<std::string> args;
+		std::thread thread;
+		// Our ends of the Channel and PayloadChannel socket pairs.
+		int writeFd{ -1 };
+		int readFd{ -1 };
+		int payloadWriteFd{ -1 };
+		int payloadReadFd{ -1 };
+		// Worker ends.
+		int workerFds[4]{ -1, -1, -1, -1 };
+		uint32_t nextId{ 0u };
+		std::vector<uint8_t> readBuffer;
+	};
+} // namespace LoadGen
+
+#endif
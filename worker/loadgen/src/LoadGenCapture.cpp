@@ -0,0 +1,328 @@
+#define MS_CLASS "LoadGen::Capture"
+
+#include "LoadGenCapture.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "Utils.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <cstring> // std::memcmp()
+#include <fstream>
+#include <iterator> // std::istreambuf_iterator
+
+namespace LoadGen
+{
+	/* Static. */
+
+	static constexpr uint32_t PcapMagic{ 0xA1B2C3D4 };
+	static constexpr uint32_t PcapNsMagic{ 0xA1B23C4D };
+	static constexpr size_t PcapHeaderSize{ 24u };
+	static constexpr size_t PcapRecordHeaderSize{ 16u };
+	static constexpr uint32_t LinkTypeEthernet{ 1u };
+	static constexpr uint32_t LinkTypeRaw{ 101u };
+	static constexpr uint32_t LinkTypeRawAlt{ 12u };
+	static constexpr uint32_t LinkTypeLinuxSll{ 113u };
+	static constexpr uint32_t LinkTypeLinuxSll2{ 276u };
+	static constexpr uint16_t EtherTypeIpv4{ 0x0800 };
+	static constexpr uint16_t EtherTypeIpv6{ 0x86DD };
+	static constexpr uint16_t EtherTypeVlan{ 0x8100 };
+	static constexpr uint8_t IpProtocolUdp{ 17u };
+	static constexpr char RtpDumpMagic[]{ "#!rtpplay1.0 " };
+	static constexpr size_t RtpDumpHeaderSize{ 16u };
+	static constexpr size_t RtpDumpRecordHeaderSize{ 8u };
+
+	static uint32_t readUint32(const uint8_t* data, bool bigEndian)
+	{
+		// Get4Bytes() reads big endian.
+		uint32_t value = Utils::Byte::Get4Bytes(data, 0);
+
+		return bigEndian ? value : __builtin_bswap32(value);
+	}
+
+	/* Instance methods. */
+
+	Capture::Capture(const std::string& path, uint32_t ssrc)
+	{
+		MS_TRACE_STD();
+
+		std::ifstream stream(path, std::ios::binary);
+
+		if (!stream)
+			MS_THROW_ERROR_STD("cannot open capture file '%s'", path.c_str());
+
+		std::vector<uint8_t> file(
+		  (std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+		// clang-format off
+		if (
+			file.size() >= sizeof(RtpDumpMagic) - 1 &&
+			std::memcmp(file.data(), RtpDumpMagic, sizeof(RtpDumpMagic) - 1) == 0
+		)
+		// clang-format on
+		{
+			LoadRtpDump(file);
+		}
+		else
+		{
+			LoadPcap(file);
+		}
+
+		SelectStream(ssrc);
+	}
+
+	void Capture::LoadPcap(const std::vector<uint8_t>& file)
+	{
+		MS_TRACE_STD();
+
+		if (file.size() < PcapHeaderSize)
+			MS_THROW_ERROR_STD("not a pcap or rtpdump file");
+
+		// Magic number is written in the endianness of the capturing host.
+		uint32_t magic = Utils::Byte::Get4Bytes(file.data(), 0);
+		bool bigEndian{ false };
+		bool nanoseconds{ false };
+
+		if (magic == PcapMagic || magic == PcapNsMagic)
+		{
+			bigEndian   = true;
+			nanoseconds = magic == PcapNsMagic;
+		}
+		else if (__builtin_bswap32(magic) == PcapMagic || __builtin_bswap32(magic) == PcapNsMagic)
+		{
+			nanoseconds = __builtin_bswap32(magic) == PcapNsMagic;
+		}
+		else
+		{
+			MS_THROW_ERROR_STD("not a pcap or rtpdump file (pcapng is not supported)");
+		}
+
+		uint32_t linkType = readUint32(file.data() + 20, bigEndian) & 0x0FFFFFFF;
+		size_t pos{ PcapHeaderSize };
+
+		while (pos + PcapRecordHeaderSize <= file.size())
+		{
+			const uint8_t* record = file.data() + pos;
+			uint64_t sec          = readUint32(record, bigEndian);
+			uint64_t frac         = readUint32(record + 4, bigEndian);
+			size_t len            = readUint32(record + 8, bigEndian);
+			uint64_t timeUs       = (sec * 1000000u) + (nanoseconds ? frac / 1000u : frac);
+			const uint8_t* data   = record + PcapRecordHeaderSize;
+
+			pos += PcapRecordHeaderSize + len;
+
+			if (pos > file.size())
+				break;
+
+			switch (linkType)
+			{
+				case LinkTypeEthernet:
+				{
+					size_t offset{ 12u };
+
+					if (len < offset + 2u)
+						break;
+
+					uint16_t etherType = Utils::Byte::Get2Bytes(data, offset);
+
+					// Skip 802.1Q tags.
+					while (etherType == EtherTypeVlan && len >= offset + 6u)
+					{
+						offset += 4u;
+						etherType = Utils::Byte::Get2Bytes(data, offset);
+					}
+
+					if (etherType == EtherTypeIpv4 || etherType == EtherTypeIpv6)
+						AddIpPacket(timeUs, data + offset + 2u, len - offset - 2u);
+
+					break;
+				}
+
+				case LinkTypeRaw:
+				case LinkTypeRawAlt:
+				{
+					AddIpPacket(timeUs, data, len);
+
+					break;
+				}
+
+				case LinkTypeLinuxSll:
+				{
+					if (len > 16u)
+						AddIpPacket(timeUs, data + 16u, len - 16u);
+
+					break;
+				}
+
+				case LinkTypeLinuxSll2:
+				{
+					if (len > 20u)
+						AddIpPacket(timeUs, data + 20u, len - 20u);
+
+					break;
+				}
+
+				default:
+				{
+					MS_THROW_ERROR_STD("unsupported pcap link type %" PRIu32, linkType);
+				}
+			}
+		}
+	}
+
+	void Capture::LoadRtpDump(const std::vector<uint8_t>& file)
+	{
+		MS_TRACE_STD();
+
+		// Skip the text line ("#!rtpplay1.0 address/port\n") and the binary header.
+		size_t pos{ 0u };
+
+		while (pos < file.size() && file[pos] != '\n')
+		{
+			++pos;
+		}
+
+		pos += 1u + RtpDumpHeaderSize;
+
+		while (pos + RtpDumpRecordHeaderSize <= file.size())
+		{
+			const uint8_t* record = file.data() + pos;
+			size_t len            = Utils::Byte::Get2Bytes(record, 0);
+			size_t packetLen      = Utils::Byte::Get2Bytes(record, 2);
+			uint64_t offsetMs     = Utils::Byte::Get4Bytes(record, 4);
+
+			if (len < RtpDumpRecordHeaderSize || pos + len > file.size())
+				break;
+
+			pos += len;
+
+			// A zero packet length means RTCP.
+			if (packetLen == 0u)
+				continue;
+
+			AddUdpPayload(
+			  offsetMs * 1000u, record + RtpDumpRecordHeaderSize, len - RtpDumpRecordHeaderSize);
+		}
+	}
+
+	void Capture::AddIpPacket(uint64_t timeUs, const uint8_t* data, size_t len)
+	{
+		MS_TRACE_STD();
+
+		if (len < 1u)
+			return;
+
+		size_t offset;
+		uint8_t protocol;
+
+		switch (data[0] >> 4)
+		{
+			case 4:
+			{
+				offset = (data[0] & 0x0F) * 4u;
+
+				if (len < 20u || len < offset)
+					return;
+
+				// Fragments are not supported.
+				if ((Utils::Byte::Get2Bytes(data, 6) & 0x3FFF) != 0u)
+					return;
+
+				protocol = data[9];
+
+				break;
+			}
+
+			case 6:
+			{
+				offset = 40u;
+
+				if (len < offset)
+					return;
+
+				// Extension headers are not supported.
+				protocol = data[6];
+
+				break;
+			}
+
+			default:
+			{
+				return;
+			}
+		}
+
+		if (protocol != IpProtocolUdp || len < offset + 8u)
+			return;
+
+		AddUdpPayload(timeUs, data + offset + 8u, len - offset - 8u);
+	}
+
+	void Capture::AddUdpPayload(uint64_t timeUs, const uint8_t* data, size_t len)
+	{
+		MS_TRACE_STD();
+
+		// clang-format off
+		if (
+			len < 12u ||
+			(data[0] >> 6) != 2u ||
+			// RTCP packet types (200-207) seen as RTP payload types (72-79).
+			((data[1] & 0x7F) >= 64u && (data[1] & 0x7F) <= 95u)
+		)
+		// clang-format on
+		{
+			return;
+		}
+
+		this->packets.emplace_back();
+
+		auto& packet = this->packets.back();
+
+		packet.offsetUs = timeUs;
+		packet.data.assign(data, data + len);
+	}
+
+	void Capture::SelectStream(uint32_t ssrc)
+	{
+		MS_TRACE_STD();
+
+		if (ssrc == 0u)
+		{
+			absl::flat_hash_map<uint32_t, size_t> counts;
+			size_t maxCount{ 0u };
+
+			for (const auto& packet : this->packets)
+			{
+				auto packetSsrc = Utils::Byte::Get4Bytes(packet.data.data(), 8);
+				auto count      = ++counts[packetSsrc];
+
+				if (count > maxCount)
+				{
+					maxCount = count;
+					ssrc     = packetSsrc;
+				}
+			}
+		}
+
+		std::vector<Packet> selected;
+
+		for (auto& packet : this->packets)
+		{
+			if (Utils::Byte::Get4Bytes(packet.data.data(), 8) == ssrc)
+				selected.push_back(std::move(packet));
+		}
+
+		if (selected.empty())
+			MS_THROW_ERROR_STD("no RTP packets found in capture");
+
+		// Make times relative to the first packet.
+		auto firstUs = selected.front().offsetUs;
+
+		for (auto& packet : selected)
+		{
+			packet.offsetUs = packet.offsetUs >= firstUs ? packet.offsetUs - firstUs : 0u;
+		}
+
+		this->packets     = std::move(selected);
+		this->ssrc        = ssrc;
+		this->payloadType = this->packets.front().data[1] & 0x7F;
+	}
+} // namespace LoadGen
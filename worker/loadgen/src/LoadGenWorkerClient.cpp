@@ -0,0 +1,207 @@
+#define MS_CLASS "LoadGen::WorkerClient"
+
+#include "LoadGenWorkerClient.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "lib.hpp"
+#include <cerrno>
+#include <cstring> // std::memcpy(), std::strerror()
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace LoadGen
+{
+	/* Static. */
+
+	static constexpr size_t ReadChunkSize{ 65536u };
+
+	static void createSocketPair(int& ourFd, int& workerFd)
+	{
+		int fds[2];
+
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+			MS_THROW_ERROR_STD("socketpair() failed: %s", std::strerror(errno));
+
+		ourFd    = fds[0];
+		workerFd = fds[1];
+	}
+
+	/* Instance methods. */
+
+	WorkerClient::WorkerClient(const std::vector<std::string>& workerArgs)
+	{
+		MS_TRACE_STD();
+
+		// Worker reads requests from its consumer fd and writes into its producer fd.
+		createSocketPair(this->writeFd, this->workerFds[0]);
+		createSocketPair(this->readFd, this->workerFds[1]);
+		createSocketPair(this->payloadWriteFd, this->workerFds[2]);
+		createSocketPair(this->payloadReadFd, this->workerFds[3]);
+
+		this->args.emplace_back("mediasoup-worker");
+		this->args.insert(this->args.end(), workerArgs.begin(), workerArgs.end());
+
+		this->thread = std::thread(
+		  [this]()
+		  {
+			  std::vector<char*> argv;
+
+			  for (auto& arg : this->args)
+			  {
+				  argv.push_back(const_cast<char*>(arg.c_str()));
+			  }
+
+			  argv.push_back(nullptr);
+
+			  mediasoup_worker_run(
+			    static_cast<int>(this->args.size()),
+			    argv.data(),
+			    "loadgen",
+			    this->workerFds[0],
+			    this->workerFds[1],
+			    this->workerFds[2],
+			    this->workerFds[3],
+			    nullptr,
+			    nullptr,
+			    nullptr,
+			    nullptr,
+			    nullptr,
+			    nullptr,
+			    nullptr,
+			    nullptr);
+		  });
+	}
+
+	WorkerClient::~WorkerClient()
+	{
+		MS_TRACE_STD();
+
+		// No response is sent to this request, the worker just closes.
+		Send({ { "id", ++this->nextId }, { "method", "worker.close" } });
+
+		this->thread.join();
+
+		for (int fd : { this->writeFd, this->readFd, this->payloadWriteFd, this->payloadReadFd })
+		{
+			close(fd);
+		}
+	}
+
+	json WorkerClient::Request(const std::string& method, const json& internal, const json& data)
+	{
+		MS_TRACE_STD();
+
+		auto id = ++this->nextId;
+
+		Send({ { "id", id }, { "method", method }, { "internal", internal }, { "data", data } });
+
+		// Wait for the response, discarding notifications meanwhile.
+		while (true)
+		{
+			json response;
+
+			ReadMessage(response, true);
+
+			auto jsonIdIt = response.find("id");
+
+			if (jsonIdIt == response.end() || jsonIdIt->get<uint32_t>() != id)
+				continue;
+
+			if (response.value("accepted", false))
+				return response.value("data", json::object());
+
+			MS_THROW_ERROR_STD(
+			  "request '%s' failed: %s",
+			  method.c_str(),
+			  response.value("reason", std::string("unknown")).c_str());
+		}
+	}
+
+	void WorkerClient::Drain()
+	{
+		MS_TRACE_STD();
+
+		json message;
+
+		while (ReadMessage(message, false))
+		{
+		}
+	}
+
+	void WorkerClient::Send(const json& request)
+	{
+		MS_TRACE_STD();
+
+		auto payload = request.dump();
+		auto len     = static_cast<uint32_t>(payload.size());
+		std::string message(sizeof(len), '\0');
+
+		std::memcpy(message.data(), &len, sizeof(len));
+		message.append(payload);
+
+		size_t written{ 0u };
+
+		while (written < message.size())
+		{
+			auto ret = write(this->writeFd, message.data() + written, message.size() - written);
+
+			if (ret < 0 && errno != EINTR)
+				MS_THROW_ERROR_STD("write() failed: %s", std::strerror(errno));
+
+			if (ret > 0)
+				written += static_cast<size_t>(ret);
+		}
+	}
+
+	bool WorkerClient::ReadMessage(json& message, bool blocking)
+	{
+		MS_TRACE_STD();
+
+		while (true)
+		{
+			// Parse a buffered message.
+			while (this->readBuffer.size() >= sizeof(uint32_t))
+			{
+				uint32_t len;
+
+				std::memcpy(&len, this->readBuffer.data(), sizeof(len));
+
+				if (this->readBuffer.size() < sizeof(len) + len)
+					break;
+
+				auto* payload = this->readBuffer.data() + sizeof(len);
+				bool isJson   = len > 0u && payload[0] == '{';
+
+				if (isJson)
+					message = json::parse(payload, payload + len);
+
+				this->readBuffer.erase(
+				  this->readBuffer.begin(), this->readBuffer.begin() + sizeof(len) + len);
+
+				// Otherwise it is a log line.
+				if (isJson)
+					return true;
+			}
+
+			struct pollfd pollFd = { this->readFd, POLLIN, 0 };
+
+			if (poll(&pollFd, 1, blocking ? -1 : 0) <= 0)
+			{
+				if (!blocking)
+					return false;
+
+				continue;
+			}
+
+			uint8_t chunk[ReadChunkSize];
+			auto ret = read(this->readFd, chunk, sizeof(chunk));
+
+			if (ret == 0)
+				MS_THROW_ERROR_STD("worker closed the channel");
+
+			if (ret > 0)
+				this->readBuffer.insert(this->readBuffer.end(), chunk, chunk + ret);
+		}
+	}
+} // namespace LoadGen
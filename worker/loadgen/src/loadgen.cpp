@@ -0,0 +1,812 @@
+#define MS_CLASS "mediasoup-worker-loadgen"
+
+/**
+ * Capacity test harness. It replays the RTP packets of a pcap or rtpdump
+ * capture as N producers into a worker (running in this process) through
+ * PlainTransports, consumes each of them from M PlainTransports and measures
+ * the sustained throughput, the per packet latency (send to reception, using
+ * a timestamp written at the end of the payload) and the event loop lag of
+ * the worker.
+ *
+ * Usage:
+ *
+ *   mediasoup-worker-loadgen --capture=FILE [OPTIONS]
+ *
+ * Options:
+ *
+ *   --capture=FILE         pcap or rtpdump file.
+ *   --ssrc=SSRC            Stream of the capture to replay (default the one
+ *                          with more packets).
+ *   --codec=CODEC          opus, vp8 (default), vp9 or h264.
+ *   --producers=N          Number of producers (default 1).
+ *   --consumers=M          Number of receiving transports, each one consuming
+ *                          every producer (default 1).
+ *   --simulcast=S          Send the capture as S simulcast streams.
+ *   --svc=MODE             Produce a single SVC stream with the given
+ *                          scalabilityMode (i.e. L3T3, needs a VP9 capture).
+ *   --loss=PERCENT         Packets dropped before reaching the worker.
+ *   --joinStorm            Create every consumer at once after the warmup
+ *                          (instead of before sending).
+ *   --warmup=SECONDS       Time not measured (default 2).
+ *   --duration=SECONDS     Measured time (default 10).
+ *   --seed=SEED            Seed of the loss generator (default 1).
+ *   --minRecvPps=PPS       Fail if fewer packets per second are received.
+ *   --maxLatencyP99=US     Fail if the p99 latency is higher.
+ *   --maxLoopLagP99=US     Fail if the p99 worker loop lag is higher.
+ *   --workerArg=ARG        Worker setting (i.e. --workerArg=--srtpEncryptThreads=2).
+ *
+ * Results are printed as JSON to stdout and the exit code is 1 if a given
+ * threshold is not met, so it can gate releases.
+ */
+
+#include "LoadGenCapture.hpp"
+#include "LoadGenWorkerClient.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "Metrics.hpp"
+#include "Utils.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <algorithm> // std::min(), std::max()
+#include <arpa/inet.h>  // inet_pton()
+#include <cerrno>
+#include <chrono>
+#include <cstdlib> // std::strtoul(), std::strtod()
+#include <cstring> // std::memcpy(), std::strerror()
+#include <fcntl.h>
+#include <getopt.h>
+#include <iostream> // std::cout, std::cerr
+#include <netinet/in.h>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+/* Static. */
+
+static constexpr char LoopbackIp[]{ "127.0.0.1" };
+static constexpr int SocketBufferSize{ 4 * 1024 * 1024 };
+static constexpr size_t MaxPacketSize{ 1500u };
+// Payload tail holding the send time.
+static constexpr uint8_t StampMagic[]{ 'M', 'S', 'L', 'G' };
+static constexpr size_t StampSize{ sizeof(StampMagic) + sizeof(uint64_t) };
+// Smaller payloads are not stamped so codec payload headers are kept.
+static constexpr size_t MinStampedPayloadSize{ 32u };
+static constexpr uint32_t SsrcBase{ 10000000u };
+static constexpr uint64_t ProducerStaggerUs{ 997u };
+static constexpr int MaxPollTimeoutMs{ 5 };
+
+struct Codec
+{
+	const char* mimeType;
+	const char* kind;
+	uint32_t clockRate;
+	uint8_t channels;
+};
+
+// clang-format off
+static const absl::flat_hash_map<std::string, Codec> Codecs =
+{
+	{ "opus", { "audio/opus", "audio", 48000u, 2u } },
+	{ "vp8",  { "video/VP8",  "video", 90000u, 0u } },
+	{ "vp9",  { "video/VP9",  "video", 90000u, 0u } },
+	{ "h264", { "video/H264", "video", 90000u, 0u } }
+};
+// clang-format on
+
+struct Options
+{
+	std::string capture;
+	uint32_t ssrc{ 0u };
+	std::string codec{ "vp8" };
+	uint32_t producers{ 1u };
+	uint32_t consumers{ 1u };
+	uint32_t simulcast{ 1u };
+	std::string svc;
+	double loss{ 0 };
+	bool joinStorm{ false };
+	uint32_t warmup{ 2u };
+	uint32_t duration{ 10u };
+	uint32_t seed{ 1u };
+	double minRecvPps{ 0 };
+	uint64_t maxLatencyP99Us{ 0u };
+	uint64_t maxLoopLagP99Us{ 0u };
+	std::vector<std::string> workerArgs;
+};
+
+struct Producer
+{
+	int fd{ -1 };
+	struct sockaddr_in remoteAddr;
+	std::vector<uint32_t> ssrcs;
+	// Number of capture packets sent (including previous loops).
+	uint64_t sent{ 0u };
+	uint64_t staggerUs{ 0u };
+};
+
+struct ConsumerEndpoint
+{
+	int fd{ -1 };
+	uint16_t port{ 0u };
+	uint64_t firstPacketAtUs{ 0u };
+};
+
+struct Counters
+{
+	uint64_t sentPackets{ 0u };
+	uint64_t droppedPackets{ 0u };
+	uint64_t receivedPackets{ 0u };
+	uint64_t receivedBytes{ 0u };
+	Metrics::Histogram latencyUs;
+};
+
+static uint64_t getTimeUs()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+	         std::chrono::steady_clock::now().time_since_epoch())
+	  .count();
+}
+
+static int createUdpSocket(uint16_t& port)
+{
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+	if (fd == -1)
+		MS_THROW_ERROR_STD("socket() failed: %s", std::strerror(errno));
+
+	struct sockaddr_in addr = {};
+
+	addr.sin_family = AF_INET;
+	inet_pton(AF_INET, LoopbackIp, &addr.sin_addr);
+
+	if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0)
+		MS_THROW_ERROR_STD("bind() failed: %s", std::strerror(errno));
+
+	socklen_t addrLen = sizeof(addr);
+
+	getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &addrLen);
+	port = ntohs(addr.sin_port);
+
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &SocketBufferSize, sizeof(SocketBufferSize));
+	setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &SocketBufferSize, sizeof(SocketBufferSize));
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	return fd;
+}
+
+// Whether it is a RTP packet and, if so, its payload position (without padding).
+static bool getRtpPayload(const uint8_t* data, size_t len, size_t& offset, size_t& payloadLen)
+{
+	// clang-format off
+	if (
+		len < 12u ||
+		(data[0] >> 6) != 2u ||
+		((data[1] & 0x7F) >= 64u && (data[1] & 0x7F) <= 95u)
+	)
+	// clang-format on
+	{
+		return false;
+	}
+
+	offset = 12u + ((data[0] & 0x0F) * 4u);
+
+	// Header extension.
+	if ((data[0] & 0x10) != 0u)
+	{
+		if (len < offset + 4u)
+			return false;
+
+		offset += 4u + (Utils::Byte::Get2Bytes(data, offset + 2u) * 4u);
+	}
+
+	size_t paddingLen = (data[0] & 0x20) != 0u ? data[len - 1] : 0u;
+
+	if (len < offset + paddingLen)
+		return false;
+
+	payloadLen = len - offset - paddingLen;
+
+	return true;
+}
+
+static void parseOptions(int argc, char* argv[], Options& options)
+{
+	// clang-format off
+	struct option longOptions[] =
+	{
+		{ "capture",       required_argument, nullptr, 'c' },
+		{ "ssrc",          required_argument, nullptr, 's' },
+		{ "codec",         required_argument, nullptr, 'C' },
+		{ "producers",     required_argument, nullptr, 'p' },
+		{ "consumers",     required_argument, nullptr, 'm' },
+		{ "simulcast",     required_argument, nullptr, 'S' },
+		{ "svc",           required_argument, nullptr, 'v' },
+		{ "loss",          required_argument, nullptr, 'l' },
+		{ "joinStorm",     no_argument,       nullptr, 'j' },
+		{ "warmup",        required_argument, nullptr, 'w' },
+		{ "duration",      required_argument, nullptr, 'd' },
+		{ "seed",          required_argument, nullptr, 'r' },
+		{ "minRecvPps",    required_argument, nullptr, 'P' },
+		{ "maxLatencyP99", required_argument, nullptr, 'L' },
+		{ "maxLoopLagP99", required_argument, nullptr, 'G' },
+		{ "workerArg",     required_argument, nullptr, 'W' },
+		{ nullptr, 0, nullptr, 0 }
+	};
+	// clang-format on
+
+	int c;
+	int optionIdx{ 0 };
+
+	while ((c = getopt_long_only(argc, argv, "", longOptions, &optionIdx)) != -1)
+	{
+		switch (c)
+		{
+			case 'c':
+				options.capture = optarg;
+				break;
+			case 's':
+				options.ssrc = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10));
+				break;
+			case 'C':
+				options.codec = optarg;
+				break;
+			case 'p':
+				options.producers = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10));
+				break;
+			case 'm':
+				options.consumers = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10));
+				break;
+			case 'S':
+				options.simulcast = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10));
+				break;
+			case 'v':
+				options.svc = optarg;
+				break;
+			case 'l':
+				options.loss = std::strtod(optarg, nullptr);
+				break;
+			case 'j':
+				options.joinStorm = true;
+				break;
+			case 'w':
+				options.warmup = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10));
+				break;
+			case 'd':
+				options.duration = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10));
+				break;
+			case 'r':
+				options.seed = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10));
+				break;
+			case 'P':
+				options.minRecvPps = std::strtod(optarg, nullptr);
+				break;
+			case 'L':
+				options.maxLatencyP99Us = std::strtoull(optarg, nullptr, 10);
+				break;
+			case 'G':
+				options.maxLoopLagP99Us = std::strtoull(optarg, nullptr, 10);
+				break;
+			case 'W':
+				options.workerArgs.emplace_back(optarg);
+				break;
+			default:
+				MS_THROW_ERROR_STD("invalid option");
+		}
+	}
+
+	if (options.capture.empty())
+		MS_THROW_ERROR_STD("missing --capture");
+
+	if (Codecs.find(options.codec) == Codecs.end())
+		MS_THROW_ERROR_STD("unsupported codec '%s'", options.codec.c_str());
+
+	if (options.producers == 0u || options.consumers == 0u || options.duration == 0u)
+		MS_THROW_ERROR_STD("producers, consumers and duration must be greater than 0");
+
+	if (options.simulcast == 0u || (options.simulcast > 1u && !options.svc.empty()))
+		MS_THROW_ERROR_STD("invalid simulcast (or given together with svc)");
+
+	if (options.loss < 0 || options.loss >= 100)
+		MS_THROW_ERROR_STD("invalid loss");
+}
+
+static json createRtpParameters(const Codec& codec, uint8_t payloadType, const json& encodings)
+{
+	json jsonCodec = {
+		{ "mimeType", codec.mimeType },
+		{ "payloadType", payloadType },
+		{ "clockRate", codec.clockRate },
+		{ "parameters", json::object() },
+		{ "rtcpFeedback", json::array() },
+	};
+
+	if (codec.channels > 0u)
+		jsonCodec["channels"] = codec.channels;
+
+	if (std::string(codec.kind) == "video")
+	{
+		jsonCodec["rtcpFeedback"] = json::array({
+		  { { "type", "nack" } },
+		  { { "type", "nack" }, { "parameter", "pli" } },
+		  { { "type", "ccm" }, { "parameter", "fir" } },
+		});
+	}
+
+	return {
+		{ "codecs", json::array({ jsonCodec }) },
+		{ "headerExtensions", json::array() },
+		{ "encodings", encodings },
+		{ "rtcp", { { "cname", "loadgen" }, { "reducedSize", true }, { "mux", true } } },
+	};
+}
+
+static json createPlainTransport(
+  LoadGen::WorkerClient& worker, const std::string& routerId, const std::string& transportId, bool comedia)
+{
+	return worker.Request(
+	  "router.createPlainTransport",
+	  { { "routerId", routerId }, { "transportId", transportId } },
+	  {
+	    { "listenIp", { { "ip", LoopbackIp } } },
+	    { "rtcpMux", true },
+	    { "comedia", comedia },
+	    { "enableSctp", false },
+	    { "numSctpStreams", { { "OS", 1024 }, { "MIS", 1024 } } },
+	    { "maxSctpMessageSize", 262144 },
+	    { "sctpSendBufferSize", 262144 },
+	    { "isDataChannel", false },
+	    { "enableSrtp", false },
+	  });
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+
+	try
+	{
+		parseOptions(argc, argv, options);
+
+		LoadGen::Capture capture(options.capture, options.ssrc);
+
+		const auto& codec   = Codecs.at(options.codec);
+		const auto& packets = capture.GetPackets();
+		auto payloadType    = capture.GetPayloadType();
+
+		// Replay loop (so a short capture can feed a long run).
+		uint64_t loopSpanUs =
+		  capture.GetDurationUs() + std::max<uint64_t>(capture.GetDurationUs() / packets.size(), 1000u);
+		auto firstSeq = Utils::Byte::Get2Bytes(packets.front().data.data(), 2);
+		auto lastSeq  = Utils::Byte::Get2Bytes(packets.back().data.data(), 2);
+		auto seqSpan  = static_cast<uint16_t>(lastSeq - firstSeq + 1u);
+		auto tsSpan   = static_cast<uint32_t>(loopSpanUs * codec.clockRate / 1000000u);
+
+		std::vector<std::string> workerArgs{ "--logLevel=warn" };
+
+		workerArgs.insert(workerArgs.end(), options.workerArgs.begin(), options.workerArgs.end());
+
+		LoadGen::WorkerClient worker(workerArgs);
+
+		const std::string routerId{ "loadgen-router" };
+
+		worker.Request("worker.createRouter", { { "routerId", routerId } });
+
+		/* Create producers. */
+
+		std::vector<Producer> producers(options.producers);
+		std::vector<json> consumableEncodings(options.producers);
+		std::vector<std::string> producerTypes(options.producers);
+
+		for (uint32_t idx{ 0u }; idx < options.producers; ++idx)
+		{
+			auto& producer          = producers[idx];
+			auto transportId        = "producer-transport-" + std::to_string(idx);
+			uint16_t port{ 0u };
+			json encodings          = json::array();
+			json mappingEncodings   = json::array();
+			consumableEncodings[idx] = json::array();
+
+			producer.fd        = createUdpSocket(port);
+			producer.staggerUs = (idx * ProducerStaggerUs) % loopSpanUs;
+
+			auto data = createPlainTransport(worker, routerId, transportId, true);
+
+			producer.remoteAddr            = {};
+			producer.remoteAddr.sin_family = AF_INET;
+			producer.remoteAddr.sin_port   = htons(data["tuple"]["localPort"].get<uint16_t>());
+			inet_pton(AF_INET, LoopbackIp, &producer.remoteAddr.sin_addr);
+
+			for (uint32_t streamIdx{ 0u }; streamIdx < options.simulcast; ++streamIdx)
+			{
+				uint32_t ssrc       = SsrcBase + (idx * 100u) + streamIdx;
+				uint32_t mappedSsrc = ssrc + 50u;
+				json encoding       = { { "ssrc", ssrc } };
+				json consumable     = { { "ssrc", mappedSsrc } };
+
+				if (options.simulcast > 1u && std::string(codec.kind) == "video")
+				{
+					encoding["scalabilityMode"]   = "L1T3";
+					consumable["scalabilityMode"] = "L1T3";
+				}
+				else if (!options.svc.empty())
+				{
+					encoding["scalabilityMode"]   = options.svc;
+					consumable["scalabilityMode"] = options.svc;
+				}
+
+				producer.ssrcs.push_back(ssrc);
+				encodings.push_back(encoding);
+				consumableEncodings[idx].push_back(consumable);
+				mappingEncodings.push_back({ { "ssrc", ssrc }, { "mappedSsrc", mappedSsrc } });
+			}
+
+			auto status = worker.Request(
+			  "transport.produce",
+			  { { "routerId", routerId },
+			    { "transportId", transportId },
+			    { "producerId", "producer-" + std::to_string(idx) } },
+			  {
+			    { "kind", codec.kind },
+			    { "rtpParameters", createRtpParameters(codec, payloadType, encodings) },
+			    { "rtpMapping",
+			      { { "codecs",
+			          json::array({ { { "payloadType", payloadType }, { "mappedPayloadType", payloadType } } }) },
+			        { "encodings", mappingEncodings } } },
+			    { "paused", false },
+			  });
+
+			producerTypes[idx] = status["type"].get<std::string>();
+		}
+
+		/* Consumers creation. */
+
+		std::vector<ConsumerEndpoint> consumerEndpoints;
+
+		auto createConsumers = [&]()
+		{
+			for (uint32_t idx{ 0u }; idx < options.consumers; ++idx)
+			{
+				consumerEndpoints.emplace_back();
+
+				auto& endpoint   = consumerEndpoints.back();
+				auto transportId = "consumer-transport-" + std::to_string(idx);
+				json internal    = { { "routerId", routerId }, { "transportId", transportId } };
+
+				endpoint.fd = createUdpSocket(endpoint.port);
+
+				createPlainTransport(worker, routerId, transportId, false);
+				worker.Request("transport.connect", internal, { { "ip", LoopbackIp }, { "port", endpoint.port } });
+
+				for (uint32_t producerIdx{ 0u }; producerIdx < options.producers; ++producerIdx)
+				{
+					json encoding = { { "ssrc", SsrcBase + 5000000u + (idx * options.producers) + producerIdx } };
+
+					if (options.simulcast > 1u && std::string(codec.kind) == "video")
+						encoding["scalabilityMode"] = "L" + std::to_string(options.simulcast) + "T3";
+					else if (!options.svc.empty())
+						encoding["scalabilityMode"] = options.svc;
+
+					internal["consumerId"] =
+					  "consumer-" + std::to_string(idx) + "-" + std::to_string(producerIdx);
+					internal["producerId"] = "producer-" + std::to_string(producerIdx);
+
+					worker.Request(
+					  "transport.consume",
+					  internal,
+					  {
+					    { "kind", codec.kind },
+					    { "rtpParameters", createRtpParameters(codec, payloadType, json::array({ encoding })) },
+					    { "type", producerTypes[producerIdx] },
+					    { "consumableRtpEncodings", consumableEncodings[producerIdx] },
+					    { "paused", false },
+					  });
+				}
+			}
+		};
+
+		if (!options.joinStorm)
+			createConsumers();
+
+		/* Replay. */
+
+		std::mt19937 random(options.seed);
+		std::uniform_real_distribution<double> lossDistribution(0, 100);
+		Counters counters;
+		std::vector<struct pollfd> pollFds;
+		uint8_t buffer[MaxPacketSize];
+
+		auto updatePollFds = [&]()
+		{
+			pollFds.clear();
+			pollFds.push_back({ worker.GetFd(), POLLIN, 0 });
+
+			for (auto& producer : producers)
+			{
+				pollFds.push_back({ producer.fd, POLLIN, 0 });
+			}
+
+			for (auto& endpoint : consumerEndpoints)
+			{
+				pollFds.push_back({ endpoint.fd, POLLIN, 0 });
+			}
+		};
+
+		auto getSendTimeUs = [&](const Producer& producer)
+		{
+			return producer.staggerUs + ((producer.sent / packets.size()) * loopSpanUs) +
+			       packets[producer.sent % packets.size()].offsetUs;
+		};
+
+		updatePollFds();
+
+		uint64_t startUs{ getTimeUs() };
+		uint64_t measureStartUs{ startUs + (options.warmup * 1000000u) };
+		uint64_t endUs{ measureStartUs + (options.duration * 1000000u) };
+		uint64_t joinStartUs{ 0u };
+		uint64_t joinRequestsUs{ 0u };
+		bool measuring{ false };
+
+		while (true)
+		{
+			auto nowUs = getTimeUs();
+
+			if (nowUs >= endUs)
+				break;
+
+			// Start measuring (and join consumers in a join storm).
+			if (!measuring && nowUs >= measureStartUs)
+			{
+				measuring = true;
+				counters  = Counters();
+
+				if (options.joinStorm)
+				{
+					joinStartUs = nowUs;
+
+					createConsumers();
+					updatePollFds();
+
+					joinRequestsUs = getTimeUs() - joinStartUs;
+				}
+			}
+
+			// Send due packets.
+			uint64_t nextSendUs{ endUs };
+
+			for (auto& producer : producers)
+			{
+				while (startUs + getSendTimeUs(producer) <= nowUs)
+				{
+					const auto& packet = packets[producer.sent % packets.size()];
+					auto loop          = producer.sent / packets.size();
+					auto len           = std::min(packet.data.size(), MaxPacketSize);
+					size_t offset;
+					size_t payloadLen;
+
+					std::memcpy(buffer, packet.data.data(), len);
+
+					Utils::Byte::Set2Bytes(
+					  buffer,
+					  2,
+					  static_cast<uint16_t>(Utils::Byte::Get2Bytes(buffer, 2) + (loop * seqSpan)));
+					Utils::Byte::Set4Bytes(
+					  buffer, 4, static_cast<uint32_t>(Utils::Byte::Get4Bytes(buffer, 4) + (loop * tsSpan)));
+
+					bool stamped = getRtpPayload(buffer, len, offset, payloadLen) &&
+					               (buffer[0] & 0x20) == 0u && payloadLen >= MinStampedPayloadSize;
+
+					for (auto ssrc : producer.ssrcs)
+					{
+						Utils::Byte::Set4Bytes(buffer, 8, ssrc);
+
+						if (options.loss > 0 && lossDistribution(random) < options.loss)
+						{
+							counters.droppedPackets++;
+
+							continue;
+						}
+
+						if (stamped)
+						{
+							uint64_t sentAtUs = getTimeUs();
+
+							std::memcpy(buffer + len - StampSize, StampMagic, sizeof(StampMagic));
+							std::memcpy(buffer + len - sizeof(sentAtUs), &sentAtUs, sizeof(sentAtUs));
+						}
+
+						sendto(
+						  producer.fd,
+						  buffer,
+						  len,
+						  0,
+						  reinterpret_cast<struct sockaddr*>(&producer.remoteAddr),
+						  sizeof(producer.remoteAddr));
+
+						counters.sentPackets++;
+					}
+
+					producer.sent++;
+				}
+
+				nextSendUs = std::min(nextSendUs, startUs + getSendTimeUs(producer));
+			}
+
+			// Wait for packets or the next send time.
+			nowUs = getTimeUs();
+
+			int timeoutMs = nextSendUs > nowUs
+			                  ? std::min(static_cast<int>((nextSendUs - nowUs) / 1000u), MaxPollTimeoutMs)
+			                  : 0;
+
+			if (poll(pollFds.data(), pollFds.size(), timeoutMs) <= 0)
+				continue;
+
+			if ((pollFds[0].revents & POLLIN) != 0)
+				worker.Drain();
+
+			// Discard RTCP sent to producers.
+			for (size_t idx{ 1u }; idx <= producers.size(); ++idx)
+			{
+				if ((pollFds[idx].revents & POLLIN) == 0)
+					continue;
+
+				while (recv(pollFds[idx].fd, buffer, sizeof(buffer), 0) > 0)
+				{
+				}
+			}
+
+			for (size_t idx{ 0u }; idx < consumerEndpoints.size(); ++idx)
+			{
+				auto& endpoint = consumerEndpoints[idx];
+
+				if ((pollFds[1u + producers.size() + idx].revents & POLLIN) == 0)
+					continue;
+
+				ssize_t ret;
+
+				while ((ret = recv(endpoint.fd, buffer, sizeof(buffer), 0)) > 0)
+				{
+					auto len = static_cast<size_t>(ret);
+					size_t offset;
+					size_t payloadLen;
+
+					if (!getRtpPayload(buffer, len, offset, payloadLen))
+						continue;
+
+					auto receivedAtUs = getTimeUs();
+
+					if (endpoint.firstPacketAtUs == 0u)
+						endpoint.firstPacketAtUs = receivedAtUs;
+
+					if (!measuring)
+						continue;
+
+					counters.receivedPackets++;
+					counters.receivedBytes += len;
+
+					// clang-format off
+					if (
+						(buffer[0] & 0x20) == 0u &&
+						payloadLen >= MinStampedPayloadSize &&
+						std::memcmp(buffer + len - StampSize, StampMagic, sizeof(StampMagic)) == 0
+					)
+					// clang-format on
+					{
+						uint64_t sentAtUs;
+
+						std::memcpy(&sentAtUs, buffer + len - sizeof(sentAtUs), sizeof(sentAtUs));
+
+						if (receivedAtUs >= sentAtUs)
+							counters.latencyUs.Record(receivedAtUs - sentAtUs);
+					}
+				}
+			}
+		}
+
+		/* Results. */
+
+		auto resourceUsage = worker.Request("worker.getResourceUsage", json::object());
+		double seconds     = options.duration;
+		json result        = json::object();
+
+		result["capture"]   = { { "ssrc", capture.GetSsrc() },
+			                      { "payloadType", payloadType },
+			                      { "packets", packets.size() },
+			                      { "durationMs", capture.GetDurationUs() / 1000u } };
+		result["producers"] = options.producers;
+		result["consumers"] = options.producers * options.consumers;
+		result["duration"]  = options.duration;
+		result["sent"]      = { { "packets", counters.sentPackets },
+			                      { "dropped", counters.droppedPackets },
+			                      { "pps", static_cast<double>(counters.sentPackets) / seconds } };
+		result["received"]  = {
+      { "packets", counters.receivedPackets },
+      { "pps", static_cast<double>(counters.receivedPackets) / seconds },
+      { "bitrate", static_cast<double>(counters.receivedBytes) * 8 / seconds },
+		};
+
+		counters.latencyUs.FillJson(result["latencyUs"], 1.0);
+		result["latencyUs"].erase("buckets");
+
+		// Worker loop lag is given in ns.
+		auto jsonLoopLagIt     = resourceUsage.find("loopLag");
+		uint64_t loopLagP99Us{ 0u };
+
+		if (jsonLoopLagIt != resourceUsage.end())
+		{
+			loopLagP99Us = jsonLoopLagIt->value("p99", uint64_t{ 0u }) / 1000u;
+
+			result["workerLoopLagUs"] = { { "p50", jsonLoopLagIt->value("p50", uint64_t{ 0u }) / 1000u },
+				                            { "p99", loopLagP99Us },
+				                            { "max", jsonLoopLagIt->value("max", uint64_t{ 0u }) / 1000u } };
+		}
+
+		if (options.joinStorm)
+		{
+			uint64_t lastFirstPacketAtUs{ 0u };
+			size_t receiving{ 0u };
+
+			for (auto& endpoint : consumerEndpoints)
+			{
+				if (endpoint.firstPacketAtUs == 0u)
+					continue;
+
+				receiving++;
+				lastFirstPacketAtUs = std::max(lastFirstPacketAtUs, endpoint.firstPacketAtUs);
+			}
+
+			result["joinStorm"] = {
+				{ "requestsMs", joinRequestsUs / 1000u },
+				{ "receivingEndpoints", receiving },
+				{ "allReceivingMs",
+				  receiving != 0u ? static_cast<int64_t>((lastFirstPacketAtUs - joinStartUs) / 1000u) : -1 },
+			};
+		}
+
+		std::cout << result.dump(2) << std::endl;
+
+		/* Thresholds. */
+
+		int status{ 0 };
+		double recvPps = static_cast<double>(counters.receivedPackets) / seconds;
+
+		if (options.minRecvPps > 0 && recvPps < options.minRecvPps)
+		{
+			std::cerr << "FAIL: received pps " << recvPps << " < " << options.minRecvPps << std::endl;
+			status = 1;
+		}
+
+		if (options.maxLatencyP99Us > 0u && counters.latencyUs.GetPercentile(99) > options.maxLatencyP99Us)
+		{
+			std::cerr << "FAIL: p99 latency " << counters.latencyUs.GetPercentile(99) << " us > "
+			          << options.maxLatencyP99Us << " us" << std::endl;
+			status = 1;
+		}
+
+		if (options.maxLoopLagP99Us > 0u && loopLagP99Us > options.maxLoopLagP99Us)
+		{
+			std::cerr << "FAIL: p99 loop lag " << loopLagP99Us << " us > " << options.maxLoopLagP99Us
+			          << " us" << std::endl;
+			status = 1;
+		}
+
+		for (auto& producer : producers)
+		{
+			close(producer.fd);
+		}
+
+		for (auto& endpoint : consumerEndpoints)
+		{
+			close(endpoint.fd);
+		}
+
+		return status;
+	}
+	catch (const MediaSoupError& error)
+	{
+		std::cerr << "error: " << error.what() << std::endl;
+
+		return 1;
+	}
+}
@@ -8,7 +8,9 @@ const workerFiles =
 	'../test/src/**/*.cpp',
 	'../test/include/helpers.hpp',
 	'../fuzzer/src/**/*.cpp',
-	'../fuzzer/include/**/*.hpp'
+	'../fuzzer/include/**/*.hpp',
+	'../bench/src/**/*.cpp',
+	'../bench/include/**/*.hpp'
 ];
 
 gulp.task('lint:worker', () =>
@@ -0,0 +1,136 @@
+#define MS_CLASS "Allocator"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "Allocator.hpp"
+#include "Logger.hpp"
+#include <mutex> // std::once_flag, std::call_once()
+#if defined(MS_ALLOCATOR_MIMALLOC)
+#include <mimalloc.h>
+#elif defined(MS_ALLOCATOR_JEMALLOC)
+#include <jemalloc/jemalloc.h>
+#elif defined(MS_ALLOCATOR_TCMALLOC)
+#include <gperftools/malloc_extension.h>
+#elif defined(__GLIBC__)
+#include <malloc.h> // mallopt(), mallinfo2()
+#endif
+
+/* Static. */
+
+#ifdef MS_HUGE_PAGES
+// Size of a transparent huge page on x86_64 and aarch64 (with 4 KiB pages).
+static constexpr size_t HugePageSize{ 2u * 1024 * 1024 };
+#endif
+
+static std::once_flag globalInitOnce;
+
+#if defined(MS_ALLOCATOR_JEMALLOC) && defined(MS_HUGE_PAGES)
+// Read by jemalloc when it initializes.
+extern "C" const char* malloc_conf = "thp:always,metadata_thp:auto";
+#endif
+
+#if defined(MS_ALLOCATOR_JEMALLOC)
+static size_t getJemallocStat(const char* name)
+{
+	size_t value{ 0u };
+	size_t len{ sizeof(value) };
+
+	if (mallctl(name, &value, &len, nullptr, 0) != 0)
+		return 0u;
+
+	return value;
+}
+#endif
+
+/* Class methods. */
+
+void Allocator::ClassInit()
+{
+	MS_TRACE();
+
+	// Process wide, so just once even if several workers run in the process.
+	std::call_once(
+	  globalInitOnce,
+	  []()
+	  {
+#if defined(MS_HUGE_PAGES) && defined(MS_ALLOCATOR_MIMALLOC)
+		  mi_option_enable(mi_option_large_os_pages);
+#elif defined(MS_HUGE_PAGES) && defined(__linux__) && defined(__GLIBC__) &&                        \
+  !defined(MS_ALLOCATOR_JEMALLOC) && !defined(MS_ALLOCATOR_TCMALLOC)
+		  // Grow the heap in huge page steps and keep big allocations in it.
+		  mallopt(M_TOP_PAD, static_cast<int>(HugePageSize));
+		  mallopt(M_MMAP_THRESHOLD, static_cast<int>(4 * HugePageSize));
+#endif
+	  });
+
+	MS_DEBUG_TAG(info, "allocator: \"%s\"", Allocator::GetName());
+}
+
+const char* Allocator::GetName()
+{
+	MS_TRACE();
+
+#if defined(MS_ALLOCATOR_MIMALLOC)
+	return "mimalloc";
+#elif defined(MS_ALLOCATOR_JEMALLOC)
+	return "jemalloc";
+#elif defined(MS_ALLOCATOR_TCMALLOC)
+	return "tcmalloc";
+#else
+	return "system";
+#endif
+}
+
+void Allocator::FillJson(json& jsonObject)
+{
+	MS_TRACE();
+
+	// Add name.
+	jsonObject["name"] = Allocator::GetName();
+
+	// Add hugePages.
+#ifdef MS_HUGE_PAGES
+	jsonObject["hugePages"] = true;
+#else
+	jsonObject["hugePages"] = false;
+#endif
+
+	// Add allocated (bytes in use) and reserved (bytes held by the allocator)
+	// if the allocator provides them.
+#if defined(MS_ALLOCATOR_MIMALLOC)
+	size_t elapsedMs, userMs, systemMs, currentRss, peakRss, currentCommit, peakCommit, pageFaults;
+
+	mi_process_info(
+	  &elapsedMs,
+	  &userMs,
+	  &systemMs,
+	  &currentRss,
+	  &peakRss,
+	  &currentCommit,
+	  &peakCommit,
+	  &pageFaults);
+
+	jsonObject["reserved"] = currentCommit;
+#elif defined(MS_ALLOCATOR_JEMALLOC)
+	// Refresh the cached statistics.
+	uint64_t epoch{ 1u };
+
+	mallctl("epoch", nullptr, nullptr, &epoch, sizeof(epoch));
+
+	jsonObject["allocated"] = getJemallocStat("stats.allocated");
+	jsonObject["reserved"]  = getJemallocStat("stats.mapped");
+#elif defined(MS_ALLOCATOR_TCMALLOC)
+	size_t allocated{ 0u };
+	size_t reserved{ 0u };
+
+	MallocExtension::instance()->GetNumericProperty("generic.current_allocated_bytes", &allocated);
+	MallocExtension::instance()->GetNumericProperty("generic.heap_size", &reserved);
+
+	jsonObject["allocated"] = allocated;
+	jsonObject["reserved"]  = reserved;
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	const auto info = mallinfo2();
+
+	jsonObject["allocated"] = info.uordblks + info.hblkhd;
+	jsonObject["reserved"]  = info.arena + info.hblkhd;
+#endif
+}
@@ -0,0 +1,91 @@
+#define MS_CLASS "Channel::ChannelMessage"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "Channel/ChannelMessage.hpp"
+#include "Logger.hpp"
+#include "Settings.hpp"
+
+namespace Channel
+{
+	/* Static. */
+
+	static const std::string JsonFormatName{ "json" };
+	static const std::string MsgpackFormatName{ "msgpack" };
+
+	/* Class variables. */
+
+	thread_local std::string ChannelMessage::jsonBuffer;
+	thread_local std::vector<uint8_t> ChannelMessage::msgpackBuffer;
+
+	/* Class methods. */
+
+	bool ChannelMessage::GetFormat(const std::string& name, Format& format)
+	{
+		MS_TRACE();
+
+		if (name == JsonFormatName)
+			format = Format::JSON;
+		else if (name == MsgpackFormatName)
+			format = Format::MSGPACK;
+		else
+			return false;
+
+		return true;
+	}
+
+	const std::string& ChannelMessage::GetFormatName(Format format)
+	{
+		MS_TRACE();
+
+		switch (format)
+		{
+			case Format::JSON:
+				return JsonFormatName;
+
+			case Format::MSGPACK:
+				return MsgpackFormatName;
+		}
+
+		return JsonFormatName;
+	}
+
+	const uint8_t* ChannelMessage::Serialize(const json& jsonMessage, size_t& len)
+	{
+		MS_TRACE();
+
+		switch (Settings::configuration.channelMessageFormat)
+		{
+			case Format::MSGPACK:
+			{
+				// NOTE: The buffer keeps its memory between messages.
+				ChannelMessage::msgpackBuffer.clear();
+
+				json::to_msgpack(jsonMessage, ChannelMessage::msgpackBuffer);
+
+				len = ChannelMessage::msgpackBuffer.size();
+
+				return ChannelMessage::msgpackBuffer.data();
+			}
+
+			default:
+			{
+				ChannelMessage::jsonBuffer = jsonMessage.dump();
+
+				len = ChannelMessage::jsonBuffer.length();
+
+				return reinterpret_cast<const uint8_t*>(ChannelMessage::jsonBuffer.c_str());
+			}
+		}
+	}
+
+	json ChannelMessage::Parse(const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		// NOTE: Both throw json::parse_error on invalid data.
+		if (len != 0 && data[0] != '{')
+			return json::from_msgpack(data, data + len);
+		else
+			return json::parse(data, data + len);
+	}
+} // namespace Channel
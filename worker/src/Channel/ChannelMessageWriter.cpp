@@ -0,0 +1,422 @@
+#define MS_CLASS "Channel::ChannelMessageWriter"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "Channel/ChannelMessageWriter.hpp"
+#include "Logger.hpp"
+#include <cmath>   // std::isfinite()
+#include <cstdio>  // std::snprintf()
+#include <cstring> // std::memcpy()
+
+namespace Channel
+{
+	/* Static. */
+
+	// Initial capacity of the buffer.
+	static constexpr size_t InitialBufferSize{ 4096u };
+
+	/* Instance methods. */
+
+	ChannelMessageWriter::ChannelMessageWriter(ChannelMessage::Format format) : format(format)
+	{
+		MS_TRACE();
+
+		this->buffer.reserve(InitialBufferSize);
+	}
+
+	void ChannelMessageWriter::StartObject(size_t numEntries)
+	{
+		MS_TRACE();
+
+		if (this->format == ChannelMessage::Format::MSGPACK)
+		{
+			// fixmap, map 16 and map 32.
+			WriteMsgpackHeader(0x80, 15u, 0xde, numEntries);
+
+			return;
+		}
+
+		BeforeValue();
+
+		this->buffer.push_back('{');
+		this->emptyContainers.push_back(true);
+	}
+
+	void ChannelMessageWriter::EndObject()
+	{
+		MS_TRACE();
+
+		if (this->format == ChannelMessage::Format::MSGPACK)
+			return;
+
+		this->buffer.push_back('}');
+		this->emptyContainers.pop_back();
+	}
+
+	void ChannelMessageWriter::StartArray(size_t numItems)
+	{
+		MS_TRACE();
+
+		if (this->format == ChannelMessage::Format::MSGPACK)
+		{
+			// fixarray, array 16 and array 32.
+			WriteMsgpackHeader(0x90, 15u, 0xdc, numItems);
+
+			return;
+		}
+
+		BeforeValue();
+
+		this->buffer.push_back('[');
+		this->emptyContainers.push_back(true);
+	}
+
+	void ChannelMessageWriter::EndArray()
+	{
+		MS_TRACE();
+
+		if (this->format == ChannelMessage::Format::MSGPACK)
+			return;
+
+		this->buffer.push_back(']');
+		this->emptyContainers.pop_back();
+	}
+
+	void ChannelMessageWriter::Key(const std::string& key)
+	{
+		MS_TRACE();
+
+		if (this->format == ChannelMessage::Format::MSGPACK)
+		{
+			String(key);
+
+			return;
+		}
+
+		BeforeValue();
+		WriteJsonString(key);
+
+		this->buffer.push_back(':');
+		this->afterKey = true;
+	}
+
+	void ChannelMessageWriter::String(const std::string& value)
+	{
+		MS_TRACE();
+
+		if (this->format == ChannelMessage::Format::MSGPACK)
+		{
+			// fixstr, str 8, str 16 and str 32.
+			if (value.size() > 31u && value.size() <= 0xFFu)
+			{
+				this->buffer.push_back(0xd9);
+				this->buffer.push_back(static_cast<uint8_t>(value.size()));
+			}
+			else
+			{
+				WriteMsgpackHeader(0xa0, 31u, 0xda, value.size());
+			}
+
+			this->buffer.insert(this->buffer.end(), value.begin(), value.end());
+
+			return;
+		}
+
+		BeforeValue();
+		WriteJsonString(value);
+	}
+
+	void ChannelMessageWriter::UInt(uint64_t value)
+	{
+		MS_TRACE();
+
+		if (this->format == ChannelMessage::Format::MSGPACK)
+		{
+			// positive fixint, uint 8, uint 16, uint 32 and uint 64.
+			if (value <= 0x7Fu)
+			{
+				this->buffer.push_back(static_cast<uint8_t>(value));
+			}
+			else if (value <= 0xFFu)
+			{
+				this->buffer.push_back(0xcc);
+				WriteBigEndian(value, 1u);
+			}
+			else if (value <= 0xFFFFu)
+			{
+				this->buffer.push_back(0xcd);
+				WriteBigEndian(value, 2u);
+			}
+			else if (value <= 0xFFFFFFFFu)
+			{
+				this->buffer.push_back(0xce);
+				WriteBigEndian(value, 4u);
+			}
+			else
+			{
+				this->buffer.push_back(0xcf);
+				WriteBigEndian(value, 8u);
+			}
+
+			return;
+		}
+
+		BeforeValue();
+
+		const auto str = std::to_string(value);
+
+		this->buffer.insert(this->buffer.end(), str.begin(), str.end());
+	}
+
+	void ChannelMessageWriter::Int(int64_t value)
+	{
+		MS_TRACE();
+
+		if (value >= 0)
+		{
+			UInt(static_cast<uint64_t>(value));
+
+			return;
+		}
+
+		if (this->format == ChannelMessage::Format::MSGPACK)
+		{
+			// negative fixint, int 8, int 16, int 32 and int 64.
+			if (value >= -32)
+			{
+				this->buffer.push_back(static_cast<uint8_t>(value));
+			}
+			else if (value >= INT8_MIN)
+			{
+				this->buffer.push_back(0xd0);
+				WriteBigEndian(static_cast<uint64_t>(value), 1u);
+			}
+			else if (value >= INT16_MIN)
+			{
+				this->buffer.push_back(0xd1);
+				WriteBigEndian(static_cast<uint64_t>(value), 2u);
+			}
+			else if (value >= INT32_MIN)
+			{
+				this->buffer.push_back(0xd2);
+				WriteBigEndian(static_cast<uint64_t>(value), 4u);
+			}
+			else
+			{
+				this->buffer.push_back(0xd3);
+				WriteBigEndian(static_cast<uint64_t>(value), 8u);
+			}
+
+			return;
+		}
+
+		BeforeValue();
+
+		const auto str = std::to_string(value);
+
+		this->buffer.insert(this->buffer.end(), str.begin(), str.end());
+	}
+
+	void ChannelMessageWriter::Double(double value)
+	{
+		MS_TRACE();
+
+		if (this->format == ChannelMessage::Format::MSGPACK)
+		{
+			uint64_t bits;
+
+			std::memcpy(&bits, &value, sizeof(bits));
+
+			// float 64.
+			this->buffer.push_back(0xcb);
+			WriteBigEndian(bits, 8u);
+
+			return;
+		}
+
+		// As nlohmann::json does.
+		if (!std::isfinite(value))
+		{
+			Null();
+
+			return;
+		}
+
+		BeforeValue();
+
+		char str[32];
+		const int len = std::snprintf(str, sizeof(str), "%.17g", value);
+
+		this->buffer.insert(this->buffer.end(), str, str + len);
+	}
+
+	void ChannelMessageWriter::Bool(bool value)
+	{
+		MS_TRACE();
+
+		if (this->format == ChannelMessage::Format::MSGPACK)
+		{
+			this->buffer.push_back(value ? 0xc3 : 0xc2);
+
+			return;
+		}
+
+		BeforeValue();
+
+		static const std::string TrueStr{ "true" };
+		static const std::string FalseStr{ "false" };
+		const auto& str = value ? TrueStr : FalseStr;
+
+		this->buffer.insert(this->buffer.end(), str.begin(), str.end());
+	}
+
+	void ChannelMessageWriter::Null()
+	{
+		MS_TRACE();
+
+		if (this->format == ChannelMessage::Format::MSGPACK)
+		{
+			this->buffer.push_back(0xc0);
+
+			return;
+		}
+
+		BeforeValue();
+
+		static const std::string NullStr{ "null" };
+
+		this->buffer.insert(this->buffer.end(), NullStr.begin(), NullStr.end());
+	}
+
+	void ChannelMessageWriter::Value(const json& value)
+	{
+		MS_TRACE();
+
+		if (this->format == ChannelMessage::Format::MSGPACK)
+		{
+			// It appends to the buffer.
+			json::to_msgpack(value, this->buffer);
+
+			return;
+		}
+
+		BeforeValue();
+
+		const auto str = value.dump();
+
+		this->buffer.insert(this->buffer.end(), str.begin(), str.end());
+	}
+
+	void ChannelMessageWriter::BeforeValue()
+	{
+		if (this->afterKey)
+		{
+			this->afterKey = false;
+
+			return;
+		}
+
+		if (this->emptyContainers.empty())
+			return;
+
+		if (!this->emptyContainers.back())
+			this->buffer.push_back(',');
+
+		this->emptyContainers.back() = false;
+	}
+
+	void ChannelMessageWriter::WriteJsonString(const std::string& value)
+	{
+		static const char HexDigits[]{ "0123456789abcdef" };
+
+		this->buffer.push_back('"');
+
+		for (const char chr : value)
+		{
+			const auto byte = static_cast<uint8_t>(chr);
+
+			switch (byte)
+			{
+				case '"':
+				case '\\':
+				{
+					this->buffer.push_back('\\');
+					this->buffer.push_back(byte);
+
+					break;
+				}
+
+				case '\n':
+				{
+					this->buffer.push_back('\\');
+					this->buffer.push_back('n');
+
+					break;
+				}
+
+				case '\r':
+				{
+					this->buffer.push_back('\\');
+					this->buffer.push_back('r');
+
+					break;
+				}
+
+				case '\t':
+				{
+					this->buffer.push_back('\\');
+					this->buffer.push_back('t');
+
+					break;
+				}
+
+				default:
+				{
+					// Other control characters.
+					if (byte < 0x20)
+					{
+						const uint8_t escaped[] = {
+							'\\', 'u', '0', '0', static_cast<uint8_t>(HexDigits[byte >> 4]),
+							static_cast<uint8_t>(HexDigits[byte & 0x0F])
+						};
+
+						this->buffer.insert(this->buffer.end(), escaped, escaped + sizeof(escaped));
+					}
+					else
+					{
+						this->buffer.push_back(byte);
+					}
+				}
+			}
+		}
+
+		this->buffer.push_back('"');
+	}
+
+	void ChannelMessageWriter::WriteMsgpackHeader(
+	  uint8_t fixType, uint8_t fixMax, uint8_t type16, size_t size)
+	{
+		if (size <= fixMax)
+		{
+			this->buffer.push_back(static_cast<uint8_t>(fixType | size));
+		}
+		else if (size <= 0xFFFFu)
+		{
+			this->buffer.push_back(type16);
+			WriteBigEndian(size, 2u);
+		}
+		else
+		{
+			// The 32 bits type always follows the 16 bits one.
+			this->buffer.push_back(static_cast<uint8_t>(type16 + 1));
+			WriteBigEndian(size, 4u);
+		}
+	}
+
+	void ChannelMessageWriter::WriteBigEndian(uint64_t value, size_t len)
+	{
+		for (size_t idx{ len }; idx > 0u; --idx)
+		{
+			this->buffer.push_back(static_cast<uint8_t>(value >> ((idx - 1) * 8)));
+		}
+	}
+} // namespace Channel
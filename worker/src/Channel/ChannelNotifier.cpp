@@ -9,6 +9,9 @@ namespace Channel
 	/* Class variables. */
 
 	thread_local Channel::ChannelSocket* ChannelNotifier::channel{ nullptr };
+	thread_local bool ChannelNotifier::batching{ false };
+	thread_local json ChannelNotifier::batch = json::array();
+	thread_local absl::flat_hash_map<std::string, size_t> ChannelNotifier::batchIndexes;
 
 	/* Static methods. */
 
@@ -33,6 +36,21 @@ namespace Channel
 		ChannelNotifier::channel->Send(jsonNotification);
 	}
 
+	void ChannelNotifier::Emit(uint64_t targetId, const char* event, json& data)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(ChannelNotifier::channel, "channel unset");
+
+		json jsonNotification = json::object();
+
+		jsonNotification["targetId"] = targetId;
+		jsonNotification["event"]    = event;
+		jsonNotification["data"]     = data;
+
+		ChannelNotifier::channel->Send(jsonNotification);
+	}
+
 	void ChannelNotifier::Emit(const std::string& targetId, const char* event)
 	{
 		MS_TRACE();
@@ -61,4 +79,59 @@ namespace Channel
 
 		ChannelNotifier::channel->Send(jsonNotification);
 	}
+
+	void ChannelNotifier::EmitBatched(const std::string& targetId, const char* event, json& data)
+	{
+		MS_TRACE();
+
+		if (!ChannelNotifier::batching)
+		{
+			Emit(targetId, event, data);
+
+			return;
+		}
+
+		std::string key = targetId;
+
+		key.append(":").append(event);
+
+		auto it = ChannelNotifier::batchIndexes.find(key);
+
+		// Replace the pending notification.
+		if (it != ChannelNotifier::batchIndexes.end())
+		{
+			ChannelNotifier::batch[it->second][2] = data;
+
+			return;
+		}
+
+		ChannelNotifier::batchIndexes[key] = ChannelNotifier::batch.size();
+		ChannelNotifier::batch.push_back(json::array({ targetId, event, data }));
+	}
+
+	void ChannelNotifier::EnableBatching()
+	{
+		MS_TRACE();
+
+		ChannelNotifier::batching = true;
+	}
+
+	void ChannelNotifier::FlushBatch()
+	{
+		MS_TRACE();
+
+		MS_ASSERT(ChannelNotifier::channel, "channel unset");
+
+		if (ChannelNotifier::batch.empty())
+			return;
+
+		json jsonNotification = json::object();
+
+		jsonNotification["batch"] = std::move(ChannelNotifier::batch);
+
+		ChannelNotifier::channel->Send(jsonNotification);
+
+		ChannelNotifier::batch = json::array();
+		ChannelNotifier::batchIndexes.clear();
+	}
 } // namespace Channel
@@ -4,7 +4,9 @@
 #include "Channel/ChannelRequest.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Settings.hpp"
 #include "Utils.hpp"
+#include "Channel/ChannelMessageWriter.hpp"
 
 namespace Channel
 {
@@ -18,26 +20,41 @@ namespace Channel
 		{ "worker.getResourceUsage",                     ChannelRequest::MethodId::WORKER_GET_RESOURCE_USAGE                        },
 		{ "worker.updateSettings",                       ChannelRequest::MethodId::WORKER_UPDATE_SETTINGS                           },
 		{ "worker.createRouter",                         ChannelRequest::MethodId::WORKER_CREATE_ROUTER                             },
+		{ "worker.createWebRtcServer",                   ChannelRequest::MethodId::WORKER_CREATE_WEBRTC_SERVER                      },
+		{ "worker.enableStateStream",                    ChannelRequest::MethodId::WORKER_ENABLE_STATE_STREAM                       },
+		{ "webRtcServer.close",                          ChannelRequest::MethodId::WEBRTC_SERVER_CLOSE                              },
+		{ "webRtcServer.dump",                           ChannelRequest::MethodId::WEBRTC_SERVER_DUMP                               },
 		{ "router.close",                                ChannelRequest::MethodId::ROUTER_CLOSE                                     },
 		{ "router.dump",                                 ChannelRequest::MethodId::ROUTER_DUMP                                      },
 		{ "router.createWebRtcTransport",                ChannelRequest::MethodId::ROUTER_CREATE_WEBRTC_TRANSPORT                   },
+		{ "router.createWebRtcTransportWithServer",      ChannelRequest::MethodId::ROUTER_CREATE_WEBRTC_TRANSPORT_WITH_SERVER       },
 		{ "router.createPlainTransport",                 ChannelRequest::MethodId::ROUTER_CREATE_PLAIN_TRANSPORT                    },
 		{ "router.createPipeTransport",                  ChannelRequest::MethodId::ROUTER_CREATE_PIPE_TRANSPORT                     },
 		{ "router.createDirectTransport",                ChannelRequest::MethodId::ROUTER_CREATE_DIRECT_TRANSPORT                   },
 		{ "router.createActiveSpeakerObserver",          ChannelRequest::MethodId::ROUTER_CREATE_ACTIVE_SPEAKER_OBSERVER            },
 		{ "router.createAudioLevelObserver",             ChannelRequest::MethodId::ROUTER_CREATE_AUDIO_LEVEL_OBSERVER               },
+		{ "router.createAudioMixer",                     ChannelRequest::MethodId::ROUTER_CREATE_AUDIO_MIXER                        },
+		{ "router.closeTransports",                      ChannelRequest::MethodId::ROUTER_CLOSE_TRANSPORTS                          },
 		{ "transport.close",                             ChannelRequest::MethodId::TRANSPORT_CLOSE                                  },
 		{ "transport.dump",                              ChannelRequest::MethodId::TRANSPORT_DUMP                                   },
 		{ "transport.getStats",                          ChannelRequest::MethodId::TRANSPORT_GET_STATS                              },
 		{ "transport.connect",                           ChannelRequest::MethodId::TRANSPORT_CONNECT                                },
 		{ "transport.setMaxIncomingBitrate",             ChannelRequest::MethodId::TRANSPORT_SET_MAX_INCOMING_BITRATE               },
 		{ "transport.setMaxOutgoingBitrate",             ChannelRequest::MethodId::TRANSPORT_SET_MAX_OUTGOING_BITRATE               },
+		{ "transport.setBweHint",                        ChannelRequest::MethodId::TRANSPORT_SET_BWE_HINT                           },
 		{ "transport.restartIce",                        ChannelRequest::MethodId::TRANSPORT_RESTART_ICE                            },
 		{ "transport.produce",                           ChannelRequest::MethodId::TRANSPORT_PRODUCE                                },
 		{ "transport.consume",                           ChannelRequest::MethodId::TRANSPORT_CONSUME                                },
 		{ "transport.produceData",                       ChannelRequest::MethodId::TRANSPORT_PRODUCE_DATA                           },
 		{ "transport.consumeData",                       ChannelRequest::MethodId::TRANSPORT_CONSUME_DATA                           },
 		{ "transport.enableTraceEvent",                  ChannelRequest::MethodId::TRANSPORT_ENABLE_TRACE_EVENT                     },
+		{ "transport.consumeMany",                       ChannelRequest::MethodId::TRANSPORT_CONSUME_MANY                           },
+		{ "transport.pauseConsumers",                    ChannelRequest::MethodId::TRANSPORT_PAUSE_CONSUMERS                        },
+		{ "transport.resumeConsumers",                   ChannelRequest::MethodId::TRANSPORT_RESUME_CONSUMERS                       },
+		{ "transport.setConsumersPreferredLayers",       ChannelRequest::MethodId::TRANSPORT_SET_CONSUMERS_PREFERRED_LAYERS         },
+		{ "transport.enablePacketCapture",               ChannelRequest::MethodId::TRANSPORT_ENABLE_PACKET_CAPTURE                  },
+		{ "transport.disablePacketCapture",              ChannelRequest::MethodId::TRANSPORT_DISABLE_PACKET_CAPTURE                 },
+		{ "transport.dumpPacketCapture",                 ChannelRequest::MethodId::TRANSPORT_DUMP_PACKET_CAPTURE                    },
 		{ "producer.close",                              ChannelRequest::MethodId::PRODUCER_CLOSE                                   },
 		{ "producer.dump",                               ChannelRequest::MethodId::PRODUCER_DUMP                                    },
 		{ "producer.getStats",                           ChannelRequest::MethodId::PRODUCER_GET_STATS                               },
@@ -50,9 +67,11 @@ namespace Channel
 		{ "consumer.pause",                              ChannelRequest::MethodId::CONSUMER_PAUSE                                   },
 		{ "consumer.resume",                             ChannelRequest::MethodId::CONSUMER_RESUME                                  },
 		{ "consumer.setPreferredLayers",                 ChannelRequest::MethodId::CONSUMER_SET_PREFERRED_LAYERS                    },
+		{ "consumer.setLayerDemand",                     ChannelRequest::MethodId::CONSUMER_SET_LAYER_DEMAND                        },
 		{ "consumer.setPriority",                        ChannelRequest::MethodId::CONSUMER_SET_PRIORITY                            },
 		{ "consumer.requestKeyFrame",                    ChannelRequest::MethodId::CONSUMER_REQUEST_KEY_FRAME                       },
 		{ "consumer.enableTraceEvent",                   ChannelRequest::MethodId::CONSUMER_ENABLE_TRACE_EVENT                      },
+		{ "consumer.exportSendState",                    ChannelRequest::MethodId::CONSUMER_EXPORT_SEND_STATE                       },
 		{ "dataProducer.close",                          ChannelRequest::MethodId::DATA_PRODUCER_CLOSE                              },
 		{ "dataProducer.dump",                           ChannelRequest::MethodId::DATA_PRODUCER_DUMP                               },
 		{ "dataProducer.getStats",                       ChannelRequest::MethodId::DATA_PRODUCER_GET_STATS                          },
@@ -116,6 +135,26 @@ namespace Channel
 			this->data = json::object();
 	}
 
+	ChannelRequest::ChannelRequest(
+	  const ChannelRequest* batchRequest, MethodId methodId, json& jsonItem, json& responses)
+	  : channel(batchRequest->channel), id(batchRequest->id), method(batchRequest->method),
+	    methodId(methodId), internal(batchRequest->internal), responses(std::addressof(responses))
+	{
+		MS_TRACE();
+
+		auto jsonInternalIt = jsonItem.find("internal");
+
+		if (jsonInternalIt != jsonItem.end() && jsonInternalIt->is_object())
+			this->internal.update(*jsonInternalIt);
+
+		auto jsonDataIt = jsonItem.find("data");
+
+		if (jsonDataIt != jsonItem.end() && jsonDataIt->is_object())
+			this->data = *jsonDataIt;
+		else
+			this->data = json::object();
+	}
+
 	ChannelRequest::~ChannelRequest()
 	{
 		MS_TRACE();
@@ -134,7 +173,7 @@ namespace Channel
 		jsonResponse["id"]       = this->id;
 		jsonResponse["accepted"] = true;
 
-		this->channel->Send(jsonResponse);
+		Reply(jsonResponse);
 	}
 
 	void ChannelRequest::Accept(json& data)
@@ -153,7 +192,38 @@ namespace Channel
 		if (data.is_structured())
 			jsonResponse["data"] = data;
 
-		this->channel->Send(jsonResponse);
+		Reply(jsonResponse);
+	}
+
+	void ChannelRequest::Accept(const std::function<void(ChannelMessageWriter& writer)>& writeData)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(!this->replied, "request already replied");
+
+		this->replied = true;
+
+		ChannelMessageWriter writer(Settings::configuration.channelMessageFormat);
+
+		writer.StartObject(3u);
+		writer.Key("id");
+		writer.UInt(this->id);
+		writer.Key("accepted");
+		writer.Bool(true);
+		writer.Key("data");
+		writeData(writer);
+		writer.EndObject();
+
+		if (this->responses)
+		{
+			auto jsonResponse = ChannelMessage::Parse(writer.GetData(), writer.GetLength());
+
+			Reply(jsonResponse);
+		}
+		else
+		{
+			this->channel->Send(writer.GetData(), writer.GetLength());
+		}
 	}
 
 	void ChannelRequest::Error(const char* reason)
@@ -172,7 +242,7 @@ namespace Channel
 		if (reason != nullptr)
 			jsonResponse["reason"] = reason;
 
-		this->channel->Send(jsonResponse);
+		Reply(jsonResponse);
 	}
 
 	void ChannelRequest::TypeError(const char* reason)
@@ -191,6 +261,23 @@ namespace Channel
 		if (reason != nullptr)
 			jsonResponse["reason"] = reason;
 
-		this->channel->Send(jsonResponse);
+		Reply(jsonResponse);
+	}
+
+	void ChannelRequest::Reply(json& jsonResponse)
+	{
+		MS_TRACE();
+
+		if (this->responses)
+		{
+			// Items of a batch request do not carry their own id.
+			jsonResponse.erase("id");
+
+			this->responses->push_back(jsonResponse);
+		}
+		else
+		{
+			this->channel->Send(jsonResponse);
+		}
 	}
 } // namespace Channel
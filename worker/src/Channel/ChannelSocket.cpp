@@ -2,9 +2,11 @@
 // #define MS_LOG_DEV_LEVEL 3
 
 #include "Channel/ChannelSocket.hpp"
+#include "Channel/ChannelMessage.hpp"
 #include "DepLibUV.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Metrics.hpp"
 #include <cmath>   // std::ceil()
 #include <cstdio>  // sprintf()
 #include <cstring> // std::memcpy(), std::memmove()
@@ -14,10 +16,23 @@ namespace Channel
 	/* Static methods for UV callbacks. */
 	inline static void onAsync(uv_handle_t* handle)
 	{
-		while (static_cast<ChannelSocket*>(handle->data)->CallbackRead())
-		{
-			// Read while there are new messages.
-		}
+		static_cast<ChannelSocket*>(handle->data)->OnUvReadAsync();
+	}
+
+	inline static void onIdle(uv_idle_t* handle)
+	{
+		auto* channel = static_cast<ChannelSocket*>(handle->data);
+
+		if (channel)
+			channel->OnUvIdle();
+	}
+
+	inline static void onPrepare(uv_prepare_t* handle)
+	{
+		auto* channel = static_cast<ChannelSocket*>(handle->data);
+
+		if (channel)
+			channel->OnUvPrepare();
 	}
 
 	inline static void onClose(uv_handle_t* handle)
@@ -25,6 +40,34 @@ namespace Channel
 		delete handle;
 	}
 
+	inline static void onClosePrepare(uv_handle_t* handle)
+	{
+		delete reinterpret_cast<uv_prepare_t*>(handle);
+	}
+
+	inline static void onCloseIdle(uv_handle_t* handle)
+	{
+		delete reinterpret_cast<uv_idle_t*>(handle);
+	}
+
+	static uv_idle_t* createIdleHandle(ChannelSocket* channel)
+	{
+		auto* uvIdleHandle = new uv_idle_t;
+
+		uvIdleHandle->data = static_cast<void*>(channel);
+
+		int err = uv_idle_init(DepLibUV::GetLoop(), uvIdleHandle);
+
+		if (err != 0)
+		{
+			delete uvIdleHandle;
+
+			MS_THROW_ERROR_STD("uv_idle_init() failed: %s", uv_strerror(err));
+		}
+
+		return uvIdleHandle;
+	}
+
 	// Binary length for a 4194304 bytes payload.
 	static constexpr size_t MessageMaxLen{ 4194308 };
 	static constexpr size_t PayloadMaxLen{ 4194304 };
@@ -36,6 +79,21 @@ namespace Channel
 	    writeBuffer(static_cast<uint8_t*>(std::malloc(MessageMaxLen)))
 	{
 		MS_TRACE_STD();
+
+		this->uvPrepareHandle       = new uv_prepare_t;
+		this->uvPrepareHandle->data = static_cast<void*>(this);
+
+		int err = uv_prepare_init(DepLibUV::GetLoop(), this->uvPrepareHandle);
+
+		if (err != 0)
+		{
+			delete this->uvPrepareHandle;
+			this->uvPrepareHandle = nullptr;
+
+			MS_ERROR_STD("uv_prepare_init() failed, messages written one by one: %s", uv_strerror(err));
+		}
+
+		this->uvIdleHandle = createIdleHandle(this);
 	}
 
 	ChannelSocket::ChannelSocket(
@@ -73,17 +131,21 @@ namespace Channel
 
 			MS_THROW_ERROR_STD("uv_async_send() failed: %s", uv_strerror(err));
 		}
+
+		this->uvIdleHandle = createIdleHandle(this);
 	}
 
 	ChannelSocket::~ChannelSocket()
 	{
 		MS_TRACE_STD();
 
-		std::free(this->writeBuffer);
-
+		// NOTE: It writes queued messages so must be called before freeing the
+		// write buffer.
 		if (!this->closed)
 			Close();
 
+		std::free(this->writeBuffer);
+
 		delete this->consumerSocket;
 		delete this->producerSocket;
 	}
@@ -95,13 +157,37 @@ namespace Channel
 		if (this->closed)
 			return;
 
+		// Write queued messages.
+		Flush();
+
 		this->closed = true;
 
+		if (this->uvPrepareHandle)
+		{
+			this->uvPrepareHandle->data = nullptr;
+
+			uv_close(
+			  reinterpret_cast<uv_handle_t*>(this->uvPrepareHandle),
+			  static_cast<uv_close_cb>(onClosePrepare));
+		}
+
 		if (this->uvReadHandle)
 		{
 			uv_close(reinterpret_cast<uv_handle_t*>(this->uvReadHandle), static_cast<uv_close_cb>(onClose));
 		}
 
+		if (this->uvIdleHandle)
+		{
+			this->uvIdleHandle->data = nullptr;
+
+			uv_close(
+			  reinterpret_cast<uv_handle_t*>(this->uvIdleHandle), static_cast<uv_close_cb>(onCloseIdle));
+		}
+
+		// The rest of the request won't be handled (nor replied).
+		delete this->deferredRequest;
+		this->deferredRequest = nullptr;
+
 		if (this->consumerSocket)
 		{
 			this->consumerSocket->Close();
@@ -124,26 +210,49 @@ namespace Channel
 	{
 		MS_TRACE_STD();
 
+		Metrics::StageScope metricsScope(Metrics::Stage::CHANNEL_IO);
+
 		if (this->closed)
 			return;
 
-		std::string message = jsonMessage.dump();
+		size_t messageLen;
+		const auto* message = Channel::ChannelMessage::Serialize(jsonMessage, messageLen);
+
+		if (messageLen > PayloadMaxLen)
+		{
+			MS_ERROR_STD("message too big");
+
+			return;
+		}
+
+		SendImpl(message, static_cast<uint32_t>(messageLen));
+	}
+
+	void ChannelSocket::Send(const uint8_t* message, size_t messageLen)
+	{
+		MS_TRACE_STD();
 
-		if (message.length() > PayloadMaxLen)
+		Metrics::StageScope metricsScope(Metrics::Stage::CHANNEL_IO);
+
+		if (this->closed)
+			return;
+
+		if (messageLen > PayloadMaxLen)
 		{
 			MS_ERROR_STD("message too big");
 
 			return;
 		}
 
-		SendImpl(
-		  reinterpret_cast<const uint8_t*>(message.c_str()), static_cast<uint32_t>(message.length()));
+		SendImpl(message, static_cast<uint32_t>(messageLen));
 	}
 
 	void ChannelSocket::SendLog(const char* message, uint32_t messageLen)
 	{
 		MS_TRACE_STD();
 
+		Metrics::StageScope metricsScope(Metrics::Stage::CHANNEL_IO);
+
 		if (this->closed)
 			return;
 
@@ -155,6 +264,26 @@ namespace Channel
 		}
 
 		SendImpl(reinterpret_cast<const uint8_t*>(message), messageLen);
+
+		// Write errors right away, the process may be about to abort. Other
+		// lines are written along with the rest of messages once the loop
+		// iteration is done.
+		if (messageLen > 0u && message[0] == 'E')
+			Flush();
+	}
+
+	void ChannelSocket::Flush()
+	{
+		MS_TRACE_STD();
+
+		if (this->writeBufferLen == 0u)
+			return;
+
+		uv_prepare_stop(this->uvPrepareHandle);
+
+		this->producerSocket->Write(this->writeBuffer, this->writeBufferLen);
+
+		this->writeBufferLen = 0u;
 	}
 
 	bool ChannelSocket::CallbackRead()
@@ -173,36 +302,7 @@ namespace Channel
 
 		if (free)
 		{
-			try
-			{
-				json jsonMessage = json::parse(message, message + static_cast<size_t>(messageLen));
-				auto* request    = new Channel::ChannelRequest(this, jsonMessage);
-
-				// Notify the listener.
-				try
-				{
-					this->listener->OnChannelRequest(this, request);
-				}
-				catch (const MediaSoupTypeError& error)
-				{
-					request->TypeError(error.what());
-				}
-				catch (const MediaSoupError& error)
-				{
-					request->Error(error.what());
-				}
-
-				// Delete the Request.
-				delete request;
-			}
-			catch (const json::parse_error& error)
-			{
-				MS_ERROR_STD("JSON parsing error: %s", error.what());
-			}
-			catch (const MediaSoupError& error)
-			{
-				MS_ERROR_STD("discarding wrong Channel request");
-			}
+			HandleMessage(message, static_cast<size_t>(messageLen));
 
 			free(message, messageLen, messageCtx);
 		}
@@ -221,26 +321,64 @@ namespace Channel
 		}
 		else
 		{
-			std::memcpy(this->writeBuffer, &payloadLen, sizeof(uint32_t));
+			size_t len = sizeof(uint32_t) + payloadLen;
+
+			// Make room for it.
+			if (this->writeBufferLen + len > MessageMaxLen)
+				Flush();
+
+			uint8_t* writePtr = this->writeBuffer + this->writeBufferLen;
+
+			std::memcpy(writePtr, &payloadLen, sizeof(uint32_t));
 
 			if (payloadLen != 0)
 			{
-				std::memcpy(this->writeBuffer + sizeof(uint32_t), payload, payloadLen);
+				std::memcpy(writePtr + sizeof(uint32_t), payload, payloadLen);
 			}
 
-			size_t len = sizeof(uint32_t) + payloadLen;
+			if (!this->uvPrepareHandle)
+			{
+				this->producerSocket->Write(writePtr, len);
+
+				return;
+			}
+
+			// First queued message in this iteration, write them before next poll.
+			// NOTE: Cannot log on failure since logs are sent through this Channel.
+			// clang-format off
+			if (
+				this->writeBufferLen == 0u &&
+				uv_prepare_start(this->uvPrepareHandle, static_cast<uv_prepare_cb>(onPrepare)) != 0
+			)
+			// clang-format on
+			{
+				this->producerSocket->Write(writePtr, len);
 
-			this->producerSocket->Write(this->writeBuffer, len);
+				return;
+			}
+
+			this->writeBufferLen += len;
 		}
 	}
 
-	void ChannelSocket::OnConsumerSocketMessage(ConsumerSocket* /*consumerSocket*/, char* msg, size_t msgLen)
+	inline void ChannelSocket::OnUvPrepare()
+	{
+		MS_TRACE_STD();
+
+		Metrics::StageScope metricsScope(Metrics::Stage::CHANNEL_IO);
+
+		Flush();
+	}
+
+	inline void ChannelSocket::HandleMessage(const uint8_t* msg, size_t msgLen)
 	{
 		MS_TRACE_STD();
 
+		Metrics::StageScope metricsScope(Metrics::Stage::CHANNEL_REQUEST);
+
 		try
 		{
-			json jsonMessage = json::parse(msg, msg + msgLen);
+			json jsonMessage = Channel::ChannelMessage::Parse(msg, msgLen);
 			auto* request    = new Channel::ChannelRequest(this, jsonMessage);
 
 			// Notify the listener.
@@ -257,8 +395,12 @@ namespace Channel
 				request->Error(error.what());
 			}
 
-			// Delete the Request.
-			delete request;
+			// Keep the Request if the rest of it is handled in steps.
+			if (request->deferredStep && !request->replied && !this->closed)
+				this->deferredRequest = request;
+			// Otherwise delete the Request.
+			else
+				delete request;
 		}
 		catch (const json::parse_error& error)
 		{
@@ -270,6 +412,143 @@ namespace Channel
 		}
 	}
 
+	bool ChannelSocket::HandleRequests()
+	{
+		MS_TRACE_STD();
+
+		if (!HandleDeferredRequest())
+			return false;
+
+		if (this->consumerSocket)
+			return this->consumerSocket->HandleMessages() && HandleDeferredRequest();
+
+		while (!this->closed)
+		{
+			if (!HandleDeferredRequest() || !HasBudget())
+				return false;
+
+			// No more messages.
+			if (!CallbackRead())
+				break;
+		}
+
+		return true;
+	}
+
+	bool ChannelSocket::HandleDeferredRequest()
+	{
+		MS_TRACE_STD();
+
+		while (this->deferredRequest && !this->closed)
+		{
+			if (!HasBudget())
+				return false;
+
+			Metrics::StageScope metricsScope(Metrics::Stage::CHANNEL_REQUEST);
+
+			auto* request = this->deferredRequest;
+			bool done{ true };
+
+			try
+			{
+				done = request->deferredStep();
+			}
+			catch (const MediaSoupTypeError& error)
+			{
+				if (!request->replied)
+					request->TypeError(error.what());
+			}
+			catch (const MediaSoupError& error)
+			{
+				if (!request->replied)
+					request->Error(error.what());
+			}
+
+			if (done && this->deferredRequest == request)
+			{
+				this->deferredRequest = nullptr;
+
+				delete request;
+			}
+		}
+
+		return true;
+	}
+
+	void ChannelSocket::StartRequests()
+	{
+		MS_TRACE_STD();
+
+		this->budgetStartedAtNs = uv_hrtime();
+
+		if (HandleRequests())
+		{
+			if (!this->yielding || this->closed)
+				return;
+
+			this->yielding = false;
+
+			uv_idle_stop(this->uvIdleHandle);
+
+			if (this->consumerSocket)
+				this->consumerSocket->ResumeReading();
+		}
+		// Handle the rest once I/O is polled (without blocking). Meanwhile the
+		// socket is not read so its buffer does not grow.
+		else if (!this->yielding && !this->closed)
+		{
+			this->yielding = true;
+
+			uv_idle_start(this->uvIdleHandle, static_cast<uv_idle_cb>(onIdle));
+
+			if (this->consumerSocket)
+				this->consumerSocket->PauseReading();
+		}
+	}
+
+	inline void ChannelSocket::OnUvReadAsync()
+	{
+		MS_TRACE_STD();
+
+		// The rest of requests are being handled in next iterations.
+		if (this->yielding)
+			return;
+
+		StartRequests();
+	}
+
+	inline void ChannelSocket::OnUvIdle()
+	{
+		MS_TRACE_STD();
+
+		StartRequests();
+	}
+
+	void ChannelSocket::OnConsumerSocketRead(ConsumerSocket* /*consumerSocket*/)
+	{
+		MS_TRACE_STD();
+
+		// The rest of requests are being handled in next iterations.
+		if (this->yielding)
+			return;
+
+		StartRequests();
+	}
+
+	bool ChannelSocket::OnConsumerSocketCanHandleMessage(ConsumerSocket* /*consumerSocket*/)
+	{
+		MS_TRACE_STD();
+
+		return !this->closed && HandleDeferredRequest() && HasBudget();
+	}
+
+	void ChannelSocket::OnConsumerSocketMessage(ConsumerSocket* /*consumerSocket*/, char* msg, size_t msgLen)
+	{
+		MS_TRACE_STD();
+
+		HandleMessage(reinterpret_cast<const uint8_t*>(msg), msgLen);
+	}
+
 	void ChannelSocket::OnConsumerSocketClosed(ConsumerSocket* /*consumerSocket*/)
 	{
 		MS_TRACE_STD();
@@ -283,17 +562,18 @@ namespace Channel
 		MS_TRACE_STD();
 	}
 
-	void ConsumerSocket::UserOnUnixStreamRead()
+	bool ConsumerSocket::HandleMessages()
 	{
 		MS_TRACE_STD();
 
 		size_t msgStart{ 0 };
+		bool handledAll{ true };
 
 		// Be ready to parse more than a single message in a single chunk.
 		while (true)
 		{
 			if (IsClosed())
-				return;
+				return true;
 
 			size_t readLen = this->bufferDataLen - msgStart;
 
@@ -313,6 +593,13 @@ namespace Channel
 				break;
 			}
 
+			if (!this->listener->OnConsumerSocketCanHandleMessage(this))
+			{
+				handledAll = false;
+
+				break;
+			}
+
 			this->listener->OnConsumerSocketMessage(
 			  this,
 			  reinterpret_cast<char*>(this->buffer + msgStart + sizeof(uint32_t)),
@@ -330,6 +617,16 @@ namespace Channel
 				std::memmove(this->buffer, this->buffer + msgStart, this->bufferDataLen);
 			}
 		}
+
+		return handledAll;
+	}
+
+	void ConsumerSocket::UserOnUnixStreamRead()
+	{
+		MS_TRACE_STD();
+
+		// Notify the listener.
+		this->listener->OnConsumerSocketRead(this);
 	}
 
 	void ConsumerSocket::UserOnUnixStreamSocketClosed()
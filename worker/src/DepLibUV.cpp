@@ -8,14 +8,44 @@
 /* Static variables. */
 
 thread_local uv_loop_t* DepLibUV::loop{ nullptr };
+thread_local uv_prepare_t* DepLibUV::uvPrepareHandle{ nullptr };
+thread_local uv_check_t* DepLibUV::uvCheckHandle{ nullptr };
+thread_local bool DepLibUV::running{ false };
+thread_local uint64_t DepLibUV::cachedTimeNs{ 0u };
+thread_local bool DepLibUV::polledEvents{ false };
+thread_local uint64_t DepLibUV::numIterations{ 0u };
+thread_local uint64_t DepLibUV::numBlockingIterations{ 0u };
+thread_local uint64_t DepLibUV::numSpinIterations{ 0u };
+thread_local uint64_t DepLibUV::numIdleSpins{ 0u };
+thread_local uint64_t DepLibUV::idleSpinNs{ 0u };
 
 /* Static methods for UV callbacks. */
 
+inline static void onPrepare(uv_prepare_t* /*handle*/)
+{
+	DepLibUV::OnUvPrepare();
+}
+
+inline static void onCheck(uv_check_t* /*handle*/)
+{
+	DepLibUV::OnUvCheck();
+}
+
 inline static void onClose(uv_handle_t* handle)
 {
 	delete handle;
 }
 
+inline static void onClosePrepare(uv_handle_t* handle)
+{
+	delete reinterpret_cast<uv_prepare_t*>(handle);
+}
+
+inline static void onCloseCheck(uv_handle_t* handle)
+{
+	delete reinterpret_cast<uv_check_t*>(handle);
+}
+
 inline static void onWalk(uv_handle_t* handle, void* /*arg*/)
 {
 	// Must use MS_ERROR_STD since at this point the Channel is already closed.
@@ -42,6 +72,34 @@ void DepLibUV::ClassInit()
 
 	if (err != 0)
 		MS_ABORT("libuv loop initialization failed");
+
+	// Needed by Metrics to compute the loop lag.
+	err = uv_loop_configure(DepLibUV::loop, UV_METRICS_IDLE_TIME);
+
+	if (err != 0)
+		MS_ABORT("libuv loop configuration failed");
+
+	// NOTE: This prepare handle is started before any other, so it runs after
+	// all of them (libuv runs them in reverse start order) right before polling.
+	DepLibUV::uvPrepareHandle = new uv_prepare_t;
+	DepLibUV::uvCheckHandle   = new uv_check_t;
+
+	uv_prepare_init(DepLibUV::loop, DepLibUV::uvPrepareHandle);
+	uv_check_init(DepLibUV::loop, DepLibUV::uvCheckHandle);
+
+	err = uv_prepare_start(DepLibUV::uvPrepareHandle, static_cast<uv_prepare_cb>(onPrepare));
+
+	if (err != 0)
+		MS_ABORT("uv_prepare_start() failed");
+
+	err = uv_check_start(DepLibUV::uvCheckHandle, static_cast<uv_check_cb>(onCheck));
+
+	if (err != 0)
+		MS_ABORT("uv_check_start() failed");
+
+	// Do not keep the loop alive.
+	uv_unref(reinterpret_cast<uv_handle_t*>(DepLibUV::uvPrepareHandle));
+	uv_unref(reinterpret_cast<uv_handle_t*>(DepLibUV::uvCheckHandle));
 }
 
 void DepLibUV::ClassDestroy()
@@ -55,6 +113,18 @@ void DepLibUV::ClassDestroy()
 
 	int err;
 
+	uv_close(
+	  reinterpret_cast<uv_handle_t*>(DepLibUV::uvPrepareHandle),
+	  static_cast<uv_close_cb>(onClosePrepare));
+	uv_close(
+	  reinterpret_cast<uv_handle_t*>(DepLibUV::uvCheckHandle), static_cast<uv_close_cb>(onCloseCheck));
+
+	DepLibUV::uvPrepareHandle = nullptr;
+	DepLibUV::uvCheckHandle   = nullptr;
+
+	// Run their close callbacks so they are not reported below.
+	uv_run(DepLibUV::loop, UV_RUN_NOWAIT);
+
 	uv_stop(DepLibUV::loop);
 	uv_walk(DepLibUV::loop, onWalk, nullptr);
 
@@ -81,14 +151,96 @@ void DepLibUV::PrintVersion()
 	MS_DEBUG_TAG(info, "libuv version: \"%s\"", uv_version_string());
 }
 
-void DepLibUV::RunLoop()
+void DepLibUV::RunLoop(uint32_t busyPollUs)
 {
 	MS_TRACE();
 
 	// This should never happen.
 	MS_ASSERT(DepLibUV::loop != nullptr, "loop unset");
 
-	int ret = uv_run(DepLibUV::loop, UV_RUN_DEFAULT);
+	DepLibUV::running = true;
+
+	int ret;
+
+	if (busyPollUs == 0u)
+		ret = uv_run(DepLibUV::loop, UV_RUN_DEFAULT);
+	else
+		ret = DepLibUV::RunBusyPollLoop(static_cast<uint64_t>(busyPollUs) * 1000u);
+
+	DepLibUV::running      = false;
+	DepLibUV::cachedTimeNs = 0u;
 
 	MS_ASSERT(ret == 0, "uv_run() returned %s", uv_err_name(ret));
 }
+
+void DepLibUV::FillJsonLoopStats(json& jsonObject)
+{
+	MS_TRACE();
+
+	jsonObject["iterations"]         = DepLibUV::numIterations;
+	jsonObject["blockingIterations"] = DepLibUV::numBlockingIterations;
+	jsonObject["spinIterations"]     = DepLibUV::numSpinIterations;
+	jsonObject["idleSpins"]          = DepLibUV::numIdleSpins;
+	jsonObject["idleSpinMs"]         = DepLibUV::idleSpinNs / 1000000u;
+}
+
+int DepLibUV::RunBusyPollLoop(uint64_t busyPollNs)
+{
+	MS_TRACE();
+
+	uint64_t spinUntilNs{ 0u };
+
+	while (true)
+	{
+		const uint64_t startNs = uv_hrtime();
+		// Poll with no timeout while spinning. Otherwise block until there are
+		// events (or timers).
+		const bool spinning = startNs < spinUntilNs;
+
+		DepLibUV::polledEvents = false;
+
+		const int alive = uv_run(DepLibUV::loop, spinning ? UV_RUN_NOWAIT : UV_RUN_ONCE);
+
+		if (!spinning)
+		{
+			DepLibUV::numBlockingIterations++;
+		}
+		else
+		{
+			DepLibUV::numSpinIterations++;
+
+			if (!DepLibUV::polledEvents)
+			{
+				DepLibUV::numIdleSpins++;
+				DepLibUV::idleSpinNs += uv_hrtime() - startNs;
+			}
+		}
+
+		if (alive == 0)
+			return 0;
+
+		// Keep spinning while there are events.
+		if (DepLibUV::polledEvents)
+			spinUntilNs = uv_hrtime() + busyPollNs;
+	}
+}
+
+inline void DepLibUV::OnUvPrepare()
+{
+	// Polling may block, so read the time again once woken up.
+	DepLibUV::cachedTimeNs = 0u;
+}
+
+inline void DepLibUV::OnUvCheck()
+{
+	DepLibUV::numIterations++;
+
+	// NOTE: The time is not cached before polling (see OnUvPrepare()) and every
+	// I/O callback (packets, Channel messages...) reads it, so if it's cached
+	// now some I/O callback ran.
+	if (DepLibUV::cachedTimeNs != 0u)
+		DepLibUV::polledEvents = true;
+
+	// Timers of the next iteration read the time again.
+	DepLibUV::cachedTimeNs = 0u;
+}
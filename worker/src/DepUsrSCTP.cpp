@@ -4,12 +4,15 @@
 #include "DepUsrSCTP.hpp"
 #include "DepLibUV.hpp"
 #include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
 #include <usrsctp.h>
+#include <algorithm> // std::min(), std::find()
 #include <mutex>
 
 /* Static. */
 
-static constexpr size_t CheckerInterval{ 10u }; // In ms.
+static constexpr uint64_t CheckerInterval{ 10u };     // In ms.
+static constexpr uint64_t CheckerMaxInterval{ 100u }; // In ms.
 static std::mutex GlobalSyncMutex;
 static size_t GlobalInstances{ 0u };
 
@@ -33,6 +36,18 @@ inline static int onSendSctpData(void* addr, void* data, size_t len, uint8_t /*t
 	return 0;
 }
 
+/* Static methods for UV callbacks. */
+
+inline static void onPrepare(uv_prepare_t* /*handle*/)
+{
+	DepUsrSCTP::OnUvPrepare();
+}
+
+inline static void onClose(uv_handle_t* handle)
+{
+	delete reinterpret_cast<uv_prepare_t*>(handle);
+}
+
 // Static method for printing usrsctp debug.
 inline static void sctpDebug(const char* format, ...)
 {
@@ -53,6 +68,7 @@ inline static void sctpDebug(const char* format, ...)
 /* Static variables. */
 
 thread_local DepUsrSCTP::Checker* DepUsrSCTP::checker{ nullptr };
+thread_local bool DepUsrSCTP::initialized{ false };
 uint64_t DepUsrSCTP::numSctpAssociations{ 0u };
 uintptr_t DepUsrSCTP::nextSctpAssociationId{ 0u };
 absl::flat_hash_map<uintptr_t, RTC::SctpAssociation*> DepUsrSCTP::mapIdSctpAssociation;
@@ -63,6 +79,11 @@ void DepUsrSCTP::ClassInit()
 {
 	MS_TRACE();
 
+	// NOTE: Called when the first SctpAssociation of this thread is created, so
+	// Workers not using SCTP don't initialize usrsctp.
+	if (DepUsrSCTP::initialized)
+		return;
+
 	MS_DEBUG_TAG(info, "usrsctp");
 
 	std::lock_guard<std::mutex> lock(GlobalSyncMutex);
@@ -71,6 +92,10 @@ void DepUsrSCTP::ClassInit()
 	{
 		usrsctp_init_nothreads(0, onSendSctpData, sctpDebug);
 
+		// We compute and verify the SCTP checksum ourselves since our CRC32c
+		// implementation is hardware accelerated.
+		usrsctp_enable_crc32c_offload();
+
 		// Disable explicit congestion notifications (ecn).
 		usrsctp_sysctl_set_sctp_ecn_enable(0);
 
@@ -80,12 +105,19 @@ void DepUsrSCTP::ClassInit()
 	}
 
 	++GlobalInstances;
+
+	DepUsrSCTP::initialized = true;
 }
 
 void DepUsrSCTP::ClassDestroy()
 {
 	MS_TRACE();
 
+	if (!DepUsrSCTP::initialized)
+		return;
+
+	DepUsrSCTP::initialized = false;
+
 	std::lock_guard<std::mutex> lock(GlobalSyncMutex);
 	--GlobalInstances;
 
@@ -193,6 +225,38 @@ RTC::SctpAssociation* DepUsrSCTP::RetrieveSctpAssociation(uintptr_t id)
 	return it->second;
 }
 
+void DepUsrSCTP::HandleSctpActivity()
+{
+	MS_TRACE();
+
+	if (DepUsrSCTP::checker)
+		DepUsrSCTP::checker->HandleActivity();
+}
+
+void DepUsrSCTP::ScheduleSctpAssociationFlush(RTC::SctpAssociation* sctpAssociation)
+{
+	MS_TRACE();
+
+	MS_ASSERT(DepUsrSCTP::checker != nullptr, "Checker not created");
+
+	DepUsrSCTP::checker->ScheduleFlush(sctpAssociation);
+}
+
+void DepUsrSCTP::CancelSctpAssociationFlush(RTC::SctpAssociation* sctpAssociation)
+{
+	MS_TRACE();
+
+	if (DepUsrSCTP::checker)
+		DepUsrSCTP::checker->CancelFlush(sctpAssociation);
+}
+
+inline void DepUsrSCTP::OnUvPrepare()
+{
+	MS_TRACE();
+
+	DepUsrSCTP::checker->Flush();
+}
+
 /* DepUsrSCTP::Checker instance methods. */
 
 DepUsrSCTP::Checker::Checker()
@@ -200,6 +264,23 @@ DepUsrSCTP::Checker::Checker()
 	MS_TRACE();
 
 	this->timer = new Timer(this);
+
+	this->uvPrepareHandle = new uv_prepare_t;
+
+	int err = uv_prepare_init(DepLibUV::GetLoop(), this->uvPrepareHandle);
+
+	if (err != 0)
+	{
+		delete this->uvPrepareHandle;
+		this->uvPrepareHandle = nullptr;
+
+		delete this->timer;
+
+		MS_THROW_ERROR("uv_prepare_init() failed: %s", uv_strerror(err));
+	}
+
+	// It must not keep the loop alive.
+	uv_unref(reinterpret_cast<uv_handle_t*>(this->uvPrepareHandle));
 }
 
 DepUsrSCTP::Checker::~Checker()
@@ -207,6 +288,9 @@ DepUsrSCTP::Checker::~Checker()
 	MS_TRACE();
 
 	delete this->timer;
+
+	uv_close(
+	  reinterpret_cast<uv_handle_t*>(this->uvPrepareHandle), static_cast<uv_close_cb>(onClose));
 }
 
 void DepUsrSCTP::Checker::Start()
@@ -216,8 +300,10 @@ void DepUsrSCTP::Checker::Start()
 	MS_DEBUG_TAG(sctp, "usrsctp periodic check started");
 
 	this->lastCalledAtMs = 0u;
+	this->intervalMs     = CheckerInterval;
+	this->activity       = false;
 
-	this->timer->Start(CheckerInterval, CheckerInterval);
+	this->timer->Start(this->intervalMs);
 }
 
 void DepUsrSCTP::Checker::Stop()
@@ -231,6 +317,65 @@ void DepUsrSCTP::Checker::Stop()
 	this->timer->Stop();
 }
 
+void DepUsrSCTP::Checker::HandleActivity()
+{
+	MS_TRACE();
+
+	this->activity = true;
+
+	// Check soon if we were idle, since usrsctp may have armed a timer (i.e.
+	// retransmission or delayed SACK).
+	if (this->intervalMs > CheckerInterval && this->timer->IsActive())
+	{
+		this->intervalMs = CheckerInterval;
+
+		this->timer->Start(this->intervalMs);
+	}
+}
+
+void DepUsrSCTP::Checker::ScheduleFlush(RTC::SctpAssociation* sctpAssociation)
+{
+	MS_TRACE();
+
+	if (this->flushSctpAssociations.empty())
+	{
+		int err = uv_prepare_start(this->uvPrepareHandle, static_cast<uv_prepare_cb>(onPrepare));
+
+		if (err != 0)
+			MS_ABORT("uv_prepare_start() failed: %s", uv_strerror(err));
+	}
+
+	this->flushSctpAssociations.push_back(sctpAssociation);
+}
+
+void DepUsrSCTP::Checker::CancelFlush(RTC::SctpAssociation* sctpAssociation)
+{
+	MS_TRACE();
+
+	auto it = std::find(
+	  this->flushSctpAssociations.begin(), this->flushSctpAssociations.end(), sctpAssociation);
+
+	if (it != this->flushSctpAssociations.end())
+		this->flushSctpAssociations.erase(it);
+}
+
+void DepUsrSCTP::Checker::Flush()
+{
+	MS_TRACE();
+
+	// NOTE: SctpAssociations may be scheduled or cancelled while flushing.
+	while (!this->flushSctpAssociations.empty())
+	{
+		auto* sctpAssociation = this->flushSctpAssociations.back();
+
+		this->flushSctpAssociations.pop_back();
+
+		sctpAssociation->SendQueuedSctpMessages();
+	}
+
+	uv_prepare_stop(this->uvPrepareHandle);
+}
+
 void DepUsrSCTP::Checker::OnTimer(Timer* /*timer*/)
 {
 	MS_TRACE();
@@ -241,4 +386,15 @@ void DepUsrSCTP::Checker::OnTimer(Timer* /*timer*/)
 	usrsctp_handle_timers(elapsedMs);
 
 	this->lastCalledAtMs = nowMs;
+
+	// usrsctp does not tell when its next timer is due, so check less often
+	// while there is no SCTP activity.
+	if (this->activity)
+		this->intervalMs = CheckerInterval;
+	else
+		this->intervalMs = std::min(this->intervalMs * 2, CheckerMaxInterval);
+
+	this->activity = false;
+
+	this->timer->Start(this->intervalMs);
 }
@@ -0,0 +1,194 @@
+#define MS_CLASS "LogFileSink"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "LogFileSink.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "ThreadPlacement.hpp"
+#include <algorithm> // std::min()
+#include <cerrno>
+#include <chrono>
+#include <cstring> // std::memcpy(), std::strerror()
+#ifndef _WIN32
+#include <fcntl.h>  // open()
+#include <unistd.h> // write(), close()
+#endif
+
+/* Static. */
+
+// Initial capacity of the buffer in which the helper thread batches lines.
+static constexpr size_t BatchCapacity{ 65536u };
+
+/* Instance methods. */
+
+LogFileSink::LogFileSink(const std::string& path) : path(path)
+{
+	MS_TRACE();
+
+#ifdef _WIN32
+	MS_THROW_ERROR("logFile is not supported on Windows");
+#else
+	this->fd = open(this->path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+	if (this->fd == -1)
+		MS_THROW_ERROR("open() failed for '%s': %s", this->path.c_str(), std::strerror(errno));
+
+	this->slots.reset(new Slot[NumSlots]);
+
+	for (size_t idx{ 0u }; idx < NumSlots; ++idx)
+	{
+		this->slots[idx].sequence.store(idx, std::memory_order_relaxed);
+	}
+
+	this->thread = std::thread(&LogFileSink::ThreadMain, this);
+
+	try
+	{
+		ThreadPlacement::ApplyToHelperThread(this->thread);
+	}
+	catch (const MediaSoupError&)
+	{
+		this->stopping.store(true, std::memory_order_release);
+		this->thread.join();
+
+		close(this->fd);
+
+		throw;
+	}
+#endif
+}
+
+LogFileSink::~LogFileSink()
+{
+	MS_TRACE_STD();
+
+#ifndef _WIN32
+	// The helper thread writes remaining lines before exiting.
+	this->stopping.store(true, std::memory_order_release);
+
+	if (this->thread.joinable())
+		this->thread.join();
+
+	if (this->fd != -1)
+		close(this->fd);
+#endif
+}
+
+bool LogFileSink::Push(const char* line, size_t len)
+{
+	MS_TRACE_STD();
+
+	size_t pos = this->enqueuePos.load(std::memory_order_relaxed);
+	Slot* slot;
+
+	while (true)
+	{
+		slot = std::addressof(this->slots[pos & (NumSlots - 1)]);
+
+		const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+		// Free slot, try to take it.
+		if (diff == 0)
+		{
+			if (this->enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		// Ring full.
+		else if (diff < 0)
+		{
+			this->droppedLines.fetch_add(1u, std::memory_order_relaxed);
+
+			return false;
+		}
+		// Taken by another producer meanwhile.
+		else
+		{
+			pos = this->enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	len = std::min(len, SlotSize);
+
+	std::memcpy(slot->data, line, len);
+	slot->len = static_cast<uint16_t>(len);
+
+	// Publish the line.
+	slot->sequence.store(pos + 1, std::memory_order_release);
+
+	return true;
+}
+
+size_t LogFileSink::Drain(std::string& batch)
+{
+	MS_TRACE_STD();
+
+	size_t lines{ 0u };
+
+	while (true)
+	{
+		auto& slot = this->slots[this->dequeuePos & (NumSlots - 1)];
+
+		// No line published in this slot yet.
+		if (slot.sequence.load(std::memory_order_acquire) != this->dequeuePos + 1)
+			break;
+
+		batch.append(slot.data, slot.len);
+		batch.push_back('\n');
+
+		// Give the slot back to producers for the next round.
+		slot.sequence.store(this->dequeuePos + NumSlots, std::memory_order_release);
+
+		++this->dequeuePos;
+		++lines;
+	}
+
+	return lines;
+}
+
+void LogFileSink::ThreadMain()
+{
+	// NOTE: No logging here since the Logger only works in the loop thread.
+
+#ifndef _WIN32
+	std::string batch;
+
+	batch.reserve(BatchCapacity);
+
+	while (true)
+	{
+		// Read it before draining so no line pushed before stopping is lost.
+		const bool stopping = this->stopping.load(std::memory_order_acquire);
+
+		batch.clear();
+
+		if (Drain(batch) > 0u)
+		{
+			const char* data = batch.data();
+			size_t len       = batch.size();
+
+			while (len > 0u)
+			{
+				auto written = write(this->fd, data, len);
+
+				if (written < 0 && errno == EINTR)
+					continue;
+				// Nothing else to do, lines are lost.
+				else if (written <= 0)
+					break;
+
+				data += written;
+				len -= static_cast<size_t>(written);
+			}
+		}
+		else if (stopping)
+		{
+			return;
+		}
+		else
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(IdleIntervalMs));
+		}
+	}
+#endif
+}
@@ -2,13 +2,30 @@
 // #define MS_LOG_DEV_LEVEL 3
 
 #include "Logger.hpp"
+#include "DepLibUV.hpp"
+#include "LogFileSink.hpp"
+#include <cinttypes> // PRIu64
 #include <uv.h>
 
+/* Static. */
+
+static constexpr uint64_t RateWindowMs{ 1000u };
+// Names of the fields of Settings::LogTags, in order.
+static constexpr const char* TagNames[] = {
+	"info", "ice", "dtls", "rtp", "srtp", "rtcp", "rtx", "bwe", "score", "simulcast", "svc", "sctp",
+	"message"
+};
+static constexpr size_t NumTags{ sizeof(TagNames) / sizeof(TagNames[0]) };
+
+static_assert(sizeof(Settings::LogTags) == NumTags, "TagNames does not match Settings::LogTags");
+
 /* Class variables. */
 
-const uint64_t Logger::pid{ static_cast<uint64_t>(uv_os_getpid()) };
+thread_local uint64_t Logger::pid{ 0u };
 thread_local Channel::ChannelSocket* Logger::channel{ nullptr };
+thread_local LogFileSink* Logger::fileSink{ nullptr };
 thread_local char Logger::buffer[Logger::bufferSize];
+thread_local Logger::TagRate Logger::tagRates[NumTags];
 
 /* Class methods. */
 
@@ -16,5 +33,106 @@ void Logger::ClassInit(Channel::ChannelSocket* channel)
 {
 	Logger::channel = channel;
 
+	// Set here since workers forked by the zygote are not the process that
+	// loaded us.
+	Logger::pid = static_cast<uint64_t>(uv_os_getpid());
+
+	MS_TRACE();
+}
+
+void Logger::ClassInitFileSink(const std::string& path)
+{
+	MS_TRACE();
+
+	// This may throw.
+	Logger::fileSink = new LogFileSink(path);
+
+	MS_DEBUG_TAG(info, "writing log lines into file [path:%s]", path.c_str());
+}
+
+void Logger::ClassDestroy()
+{
 	MS_TRACE();
+
+	if (!Logger::fileSink)
+		return;
+
+	auto* fileSink = Logger::fileSink;
+
+	// Following lines go to the Channel.
+	Logger::fileSink = nullptr;
+
+	if (fileSink->GetDroppedLines() > 0u)
+	{
+		MS_WARN_TAG(
+		  info, "%" PRIu64 " log lines dropped (log file too slow)", fileSink->GetDroppedLines());
+	}
+
+	// Writes remaining lines and joins the helper thread.
+	delete fileSink;
+}
+
+void Logger::Write(const char* line, size_t len)
+{
+	// NOTE: No MS_TRACE() here since it calls this method.
+
+	if (len >= Logger::bufferSize)
+		len = Logger::bufferSize - 1;
+
+	if (Logger::fileSink)
+	{
+		Logger::fileSink->Push(line, len);
+
+		// Errors are also sent to the Node process.
+		if (line[0] != 'E')
+			return;
+	}
+
+	Logger::channel->SendLog(line, static_cast<uint32_t>(len));
+}
+
+bool Logger::IsTagLineAllowed(size_t tagIdx)
+{
+	// NOTE: No MS_TRACE() here since it's called by every tag log macro.
+
+	const uint32_t logRateLimit = Settings::configuration.logRateLimit;
+
+	if (logRateLimit == 0u)
+		return true;
+
+	auto& tagRate        = Logger::tagRates[tagIdx];
+	const uint64_t nowMs = DepLibUV::GetTimeMs();
+
+	if (nowMs - tagRate.windowStartMs >= RateWindowMs)
+	{
+		const uint64_t droppedLines = tagRate.droppedLines;
+
+		tagRate.windowStartMs = nowMs;
+		tagRate.lines         = 0u;
+		tagRate.droppedLines  = 0u;
+
+		if (droppedLines > 0u)
+		{
+			int loggerWritten = std::snprintf(
+			  Logger::buffer,
+			  Logger::bufferSize,
+			  "W" _MS_LOG_STR_DESC "%" PRIu64 " lines of tag '%s' dropped (logRateLimit)",
+			  _MS_LOG_ARG,
+			  droppedLines,
+			  TagNames[tagIdx]);
+
+			Logger::Write(Logger::buffer, static_cast<size_t>(loggerWritten));
+		}
+	}
+
+	if (tagRate.lines >= logRateLimit)
+	{
+		++tagRate.droppedLines;
+
+		return false;
+	}
+
+	++tagRate.lines;
+
+	return true;
 }
@@ -0,0 +1,360 @@
+#define MS_CLASS "Metrics"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "Metrics.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include <cmath> // std::ceil()
+#ifdef MS_ALLOCATION_STATS
+#include <cstdlib> // std::malloc(), std::free()
+#include <new>     // std::bad_alloc
+#endif
+
+/* Static methods for UV callbacks. */
+
+inline static void onCheck(uv_check_t* /*handle*/)
+{
+	Metrics::OnUvCheck();
+}
+
+inline static void onClose(uv_handle_t* handle)
+{
+	delete reinterpret_cast<uv_check_t*>(handle);
+}
+
+/* Static. */
+
+// clang-format off
+static const char* StageNames[] =
+{
+	"transportReceiveRtp",
+	"routerFanOut",
+	"srtp",
+	"channelIo",
+	"transportCongestionControlClient",
+	"sendRtcp",
+	"channelRequest"
+};
+// clang-format on
+
+static_assert(
+  sizeof(StageNames) / sizeof(StageNames[0]) == static_cast<size_t>(Metrics::Stage::MAX),
+  "a name is needed for every stage");
+
+/* Class variables. */
+
+thread_local uv_check_t* Metrics::uvCheckHandle{ nullptr };
+thread_local Metrics::Histogram* Metrics::loopLagHistogram{ nullptr };
+thread_local Metrics::Histogram* Metrics::stageHistograms{ nullptr };
+thread_local uint64_t Metrics::lastCheckAtNs{ 0u };
+thread_local uint64_t Metrics::lastIdleTimeNs{ 0u };
+thread_local uint64_t Metrics::windowBusyNs{ 0u };
+thread_local uint64_t Metrics::windowMaxLagNs{ 0u };
+thread_local uint64_t Metrics::initCycles{ 0u };
+thread_local uint64_t Metrics::initTimeNs{ 0u };
+thread_local bool Metrics::ingressTimeEnabled{ false };
+thread_local uint64_t Metrics::ingressTimeNs{ 0u };
+thread_local Metrics::Histogram* Metrics::sendQueueDelayHistogram{ nullptr };
+thread_local uint64_t Metrics::allocations{ 0u };
+thread_local uint64_t Metrics::allocatedBytes{ 0u };
+thread_local Metrics::StageCounters Metrics::stageAllocations{};
+thread_local Metrics::StageCounters Metrics::stageAllocatedBytes{};
+
+/* Global allocation functions. */
+
+// Replacements counting the allocations of the calling thread. The other ones
+// (array, nothrow and sized variants) call these by default. The test binary
+// replaces them on its own.
+#if defined(MS_ALLOCATION_STATS) && !defined(MS_TEST)
+void* operator new(size_t size)
+{
+	Metrics::RecordAllocation(size);
+
+	auto* ptr = std::malloc(size != 0u ? size : 1u);
+
+	if (!ptr)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept
+{
+	std::free(ptr);
+}
+#endif
+
+/* Class methods. */
+
+void Metrics::ClassInit()
+{
+	MS_TRACE();
+
+	Metrics::loopLagHistogram = new Histogram();
+	Metrics::stageHistograms  = new Histogram[static_cast<size_t>(Stage::MAX)];
+	Metrics::initCycles       = Metrics::GetCycles();
+	Metrics::initTimeNs       = DepLibUV::GetHighResTimeNs();
+	Metrics::uvCheckHandle    = new uv_check_t;
+
+	int err = uv_check_init(DepLibUV::GetLoop(), Metrics::uvCheckHandle);
+
+	if (err != 0)
+	{
+		delete Metrics::uvCheckHandle;
+		Metrics::uvCheckHandle = nullptr;
+
+		MS_THROW_ERROR("uv_check_init() failed: %s", uv_strerror(err));
+	}
+
+	err = uv_check_start(Metrics::uvCheckHandle, static_cast<uv_check_cb>(onCheck));
+
+	if (err != 0)
+		MS_THROW_ERROR("uv_check_start() failed: %s", uv_strerror(err));
+
+	// Do not keep the loop alive.
+	uv_unref(reinterpret_cast<uv_handle_t*>(Metrics::uvCheckHandle));
+}
+
+void Metrics::ClassDestroy()
+{
+	MS_TRACE();
+
+	if (Metrics::uvCheckHandle)
+	{
+		uv_close(reinterpret_cast<uv_handle_t*>(Metrics::uvCheckHandle), static_cast<uv_close_cb>(onClose));
+
+		Metrics::uvCheckHandle = nullptr;
+	}
+
+	delete Metrics::loopLagHistogram;
+	Metrics::loopLagHistogram = nullptr;
+
+	delete[] Metrics::stageHistograms;
+	Metrics::stageHistograms = nullptr;
+
+	delete Metrics::sendQueueDelayHistogram;
+	Metrics::sendQueueDelayHistogram = nullptr;
+
+	Metrics::ingressTimeEnabled = false;
+	Metrics::ingressTimeNs      = 0u;
+
+	Metrics::stageAllocations.fill(0u);
+	Metrics::stageAllocatedBytes.fill(0u);
+}
+
+void Metrics::TakeLoopWindow(uint64_t& busyNs, uint64_t& maxLagNs)
+{
+	MS_TRACE();
+
+	busyNs   = Metrics::windowBusyNs;
+	maxLagNs = Metrics::windowMaxLagNs;
+
+	Metrics::windowBusyNs   = 0u;
+	Metrics::windowMaxLagNs = 0u;
+}
+
+void Metrics::EnableIngressTime()
+{
+	MS_TRACE();
+
+	if (Metrics::ingressTimeEnabled)
+		return;
+
+	Metrics::ingressTimeEnabled      = true;
+	Metrics::sendQueueDelayHistogram = new Histogram();
+}
+
+double Metrics::GetNsPerCycle()
+{
+	MS_TRACE();
+
+	if (Metrics::initTimeNs == 0u)
+		return 1.0;
+
+	// Calibrate cycles against the monotonic clock since ClassInit().
+	auto elapsedCycles = Metrics::GetCycles() - Metrics::initCycles;
+	auto elapsedNs     = DepLibUV::GetHighResTimeNs() - Metrics::initTimeNs;
+
+	return elapsedCycles != 0u ? static_cast<double>(elapsedNs) / static_cast<double>(elapsedCycles)
+	                           : 1.0;
+}
+
+void Metrics::FillJson(json& jsonObject)
+{
+	MS_TRACE();
+
+	if (!Metrics::stageHistograms)
+		return;
+
+	auto nsPerCycle = Metrics::GetNsPerCycle();
+
+	// Add loopLag.
+	Metrics::loopLagHistogram->FillJson(jsonObject["loopLag"], 1.0);
+
+	// Add loop.
+	DepLibUV::FillJsonLoopStats(jsonObject["loop"]);
+
+	// Add stages.
+	jsonObject["stages"] = json::object();
+	auto jsonStagesIt    = jsonObject.find("stages");
+
+	for (size_t idx{ 0u }; idx < static_cast<size_t>(Stage::MAX); ++idx)
+	{
+		Metrics::stageHistograms[idx].FillJson((*jsonStagesIt)[StageNames[idx]], nsPerCycle);
+	}
+
+	// Add sendQueueDelay.
+	if (Metrics::sendQueueDelayHistogram)
+		Metrics::sendQueueDelayHistogram->FillJson(jsonObject["sendQueueDelay"], 1.0);
+}
+
+void Metrics::FillJsonAllocations(json& jsonObject)
+{
+	MS_TRACE();
+
+	// Add total.
+	jsonObject["total"] = json::object();
+	auto jsonTotalIt    = jsonObject.find("total");
+
+	(*jsonTotalIt)["allocations"] = Metrics::allocations;
+	(*jsonTotalIt)["bytes"]       = Metrics::allocatedBytes;
+
+	// Add stages.
+	jsonObject["stages"] = json::object();
+	auto jsonStagesIt    = jsonObject.find("stages");
+
+	for (size_t idx{ 0u }; idx < static_cast<size_t>(Stage::MAX); ++idx)
+	{
+		auto& jsonStage = (*jsonStagesIt)[StageNames[idx]];
+		uint64_t calls  = Metrics::stageHistograms ? Metrics::stageHistograms[idx].GetCount() : 0u;
+
+		jsonStage["calls"]       = calls;
+		jsonStage["allocations"] = Metrics::stageAllocations[idx];
+		jsonStage["bytes"]       = Metrics::stageAllocatedBytes[idx];
+		jsonStage["allocationsPerCall"] =
+		  calls != 0u ? static_cast<double>(Metrics::stageAllocations[idx]) / calls : 0.0;
+	}
+}
+
+void Metrics::OnUvCheck()
+{
+	// NOTE: No MS_TRACE() here since this is called on every loop iteration.
+
+	auto nowNs      = DepLibUV::GetHighResTimeNs();
+	auto idleTimeNs = uv_metrics_idle_time(DepLibUV::GetLoop());
+
+	if (Metrics::lastCheckAtNs != 0u)
+	{
+		auto iterationNs = nowNs - Metrics::lastCheckAtNs;
+		auto idleNs      = idleTimeNs - Metrics::lastIdleTimeNs;
+
+		auto lagNs = iterationNs > idleNs ? iterationNs - idleNs : 0u;
+
+		Metrics::loopLagHistogram->Record(lagNs);
+
+		Metrics::windowBusyNs += lagNs;
+
+		if (lagNs > Metrics::windowMaxLagNs)
+			Metrics::windowMaxLagNs = lagNs;
+	}
+
+	Metrics::lastCheckAtNs  = nowNs;
+	Metrics::lastIdleTimeNs = idleTimeNs;
+}
+
+/* Histogram class methods. */
+
+size_t Metrics::Histogram::GetBucketIndex(uint64_t value)
+{
+	if (value < LinearBucketCount)
+		return static_cast<size_t>(value);
+
+	// Position of the most significant bit (4 or higher here).
+#ifdef _MSC_VER
+	unsigned long msb;
+
+	_BitScanReverse64(&msb, value);
+
+	size_t exponent{ static_cast<size_t>(msb) };
+#else
+	size_t exponent{ 63u - static_cast<size_t>(__builtin_clzll(value)) };
+#endif
+	size_t subBucket = static_cast<size_t>(value >> (exponent - SubBucketBits)) - SubBucketCount;
+
+	return LinearBucketCount + ((exponent - SubBucketBits - 1u) * SubBucketCount) + subBucket;
+}
+
+uint64_t Metrics::Histogram::GetBucketLowerBound(size_t index)
+{
+	if (index < LinearBucketCount)
+		return static_cast<uint64_t>(index);
+
+	size_t exponent  = ((index - LinearBucketCount) / SubBucketCount) + SubBucketBits + 1u;
+	size_t subBucket = (index - LinearBucketCount) % SubBucketCount;
+
+	return static_cast<uint64_t>(SubBucketCount + subBucket) << (exponent - SubBucketBits);
+}
+
+/* Histogram instance methods. */
+
+uint64_t Metrics::Histogram::GetPercentile(double percentile) const
+{
+	MS_TRACE();
+
+	if (this->count == 0u)
+		return 0u;
+
+	auto target = static_cast<uint64_t>(std::ceil(static_cast<double>(this->count) * percentile / 100));
+	uint64_t accumulated{ 0u };
+
+	if (target == 0u)
+		target = 1u;
+
+	for (size_t idx{ 0u }; idx < BucketCount; ++idx)
+	{
+		accumulated += this->counts[idx];
+
+		if (accumulated >= target)
+			return GetBucketLowerBound(idx);
+	}
+
+	return this->max;
+}
+
+void Metrics::Histogram::FillJson(json& jsonObject, double scale, bool withBuckets) const
+{
+	MS_TRACE();
+
+	auto scaled = [scale](uint64_t value) { return static_cast<uint64_t>(value * scale); };
+
+	jsonObject["count"] = this->count;
+	jsonObject["mean"] =
+	  this->count != 0u ? static_cast<double>(this->sum) * scale / static_cast<double>(this->count)
+	                    : 0.0;
+	jsonObject["max"]  = scaled(this->max);
+	jsonObject["p50"]  = scaled(GetPercentile(50));
+	jsonObject["p90"]  = scaled(GetPercentile(90));
+	jsonObject["p99"]  = scaled(GetPercentile(99));
+	jsonObject["p999"] = scaled(GetPercentile(99.9));
+
+	if (!withBuckets)
+		return;
+
+	// Add buckets (only non empty ones, as [lower bound, count] pairs).
+	jsonObject["buckets"] = json::array();
+	auto jsonBucketsIt    = jsonObject.find("buckets");
+
+	for (size_t idx{ 0u }; idx < BucketCount; ++idx)
+	{
+		if (this->counts[idx] == 0u)
+			continue;
+
+		jsonBucketsIt->push_back(json::array({ scaled(GetBucketLowerBound(idx)), this->counts[idx] }));
+	}
+}
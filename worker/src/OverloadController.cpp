@@ -0,0 +1,181 @@
+#define MS_CLASS "OverloadController"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "OverloadController.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include <absl/container/flat_hash_map.h>
+#include <algorithm> // std::min()
+
+/* Static. */
+
+static constexpr uint64_t CheckIntervalMs{ 1000u };
+// Loop utilization and max loop lag above which the level is raised.
+static constexpr double HighUtilization{ 0.85 };
+static constexpr uint64_t HighLoopLagMs{ 50u };
+// Loop utilization and max loop lag below which the load is low.
+static constexpr double LowUtilization{ 0.6 };
+static constexpr uint64_t LowLoopLagMs{ 20u };
+// Periods with low load needed to lower the level.
+static constexpr uint32_t LowLoadPeriodsToRecover{ 5u };
+
+// clang-format off
+static const absl::flat_hash_map<OverloadController::Level, std::string> Level2String =
+{
+	{ OverloadController::Level::NONE,                 "none"                 },
+	{ OverloadController::Level::DROP_RTX,             "drop-rtx"             },
+	{ OverloadController::Level::DROP_TEMPORAL_LAYERS, "drop-temporal-layers" },
+	{ OverloadController::Level::DROP_SPATIAL_LAYERS,  "drop-spatial-layers"  },
+	{ OverloadController::Level::PAUSE_CONSUMERS,      "pause-consumers"      }
+};
+// clang-format on
+
+thread_local OverloadController::Level OverloadController::level{ OverloadController::Level::NONE };
+thread_local uint64_t OverloadController::shedNacks{ 0u };
+
+/* Class methods. */
+
+bool OverloadController::ShedNack()
+{
+	MS_TRACE();
+
+	if (OverloadController::level < Level::DROP_RTX)
+		return false;
+
+	++OverloadController::shedNacks;
+
+	return true;
+}
+
+void OverloadController::GetMaxLayers(
+  Level level, int16_t& maxSpatialLayer, int16_t& maxTemporalLayer)
+{
+	MS_TRACE();
+
+	maxSpatialLayer  = level >= Level::DROP_SPATIAL_LAYERS ? 0 : -1;
+	maxTemporalLayer = level >= Level::DROP_TEMPORAL_LAYERS ? 1 : -1;
+}
+
+const std::string& OverloadController::GetLevelString(Level level)
+{
+	MS_TRACE();
+
+	return Level2String.at(level);
+}
+
+/* Instance methods. */
+
+OverloadController::OverloadController(Listener* listener) : listener(listener)
+{
+	MS_TRACE();
+
+	// Discard what was measured so far.
+	uint64_t busyNs;
+	uint64_t maxLagNs;
+
+	Metrics::TakeLoopWindow(busyNs, maxLagNs);
+
+	this->lastCheckAtNs = DepLibUV::GetHighResTimeNs();
+
+	this->checkTimer = new Timer(this);
+	this->checkTimer->Start(CheckIntervalMs, CheckIntervalMs);
+}
+
+OverloadController::~OverloadController()
+{
+	MS_TRACE();
+
+	delete this->checkTimer;
+	this->checkTimer = nullptr;
+
+	OverloadController::level     = Level::NONE;
+	OverloadController::shedNacks = 0u;
+}
+
+void OverloadController::Update(double utilization, uint64_t maxLoopLagMs)
+{
+	MS_TRACE();
+
+	this->utilization  = utilization;
+	this->maxLoopLagMs = maxLoopLagMs;
+
+	auto previousLevel = OverloadController::level;
+
+	if (utilization >= HighUtilization || maxLoopLagMs >= HighLoopLagMs)
+	{
+		this->lowLoadPeriods = 0u;
+
+		if (previousLevel == Level::PAUSE_CONSUMERS)
+			return;
+
+		OverloadController::level =
+		  static_cast<Level>(static_cast<uint8_t>(previousLevel) + 1);
+	}
+	else if (utilization < LowUtilization && maxLoopLagMs < LowLoopLagMs)
+	{
+		if (previousLevel == Level::NONE)
+			return;
+
+		if (++this->lowLoadPeriods < LowLoadPeriodsToRecover)
+			return;
+
+		this->lowLoadPeriods = 0u;
+
+		OverloadController::level =
+		  static_cast<Level>(static_cast<uint8_t>(previousLevel) - 1);
+	}
+	else
+	{
+		this->lowLoadPeriods = 0u;
+
+		return;
+	}
+
+	MS_WARN_TAG(
+	  info,
+	  "overload level changed [level:%s, previousLevel:%s, utilization:%.2f, maxLoopLagMs:%" PRIu64
+	  "]",
+	  OverloadController::GetLevelString(OverloadController::level).c_str(),
+	  OverloadController::GetLevelString(previousLevel).c_str(),
+	  utilization,
+	  maxLoopLagMs);
+
+	this->listener->OnOverloadControllerLevelChange(this, OverloadController::level, previousLevel);
+}
+
+void OverloadController::FillJson(json& jsonObject) const
+{
+	MS_TRACE();
+
+	jsonObject["level"]           = OverloadController::GetLevelString(OverloadController::level);
+	jsonObject["loopUtilization"] = this->utilization;
+	jsonObject["maxLoopLag"]      = this->maxLoopLagMs;
+	jsonObject["shedNacks"]       = OverloadController::shedNacks;
+}
+
+inline void OverloadController::OnTimer(Timer* timer)
+{
+	MS_TRACE();
+
+	if (timer == this->checkTimer)
+	{
+		uint64_t busyNs;
+		uint64_t maxLagNs;
+
+		Metrics::TakeLoopWindow(busyNs, maxLagNs);
+
+		auto nowNs     = DepLibUV::GetHighResTimeNs();
+		auto elapsedNs = nowNs - this->lastCheckAtNs;
+
+		this->lastCheckAtNs = nowNs;
+
+		if (elapsedNs == 0u)
+			return;
+
+		auto utilization =
+		  std::min(static_cast<double>(busyNs) / static_cast<double>(elapsedNs), 1.0);
+
+		Update(utilization, maxLagNs / 1000000u);
+	}
+}
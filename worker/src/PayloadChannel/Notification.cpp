@@ -87,4 +87,14 @@ namespace PayloadChannel
 		this->payload    = payload;
 		this->payloadLen = payloadLen;
 	}
+
+	void Notification::SetOwnedPayload(uint8_t* payload, size_t payloadLen, size_t payloadCapacity)
+	{
+		MS_TRACE();
+
+		this->payload         = payload;
+		this->payloadLen      = payloadLen;
+		this->writablePayload = payload;
+		this->payloadCapacity = payloadCapacity;
+	}
 } // namespace PayloadChannel
@@ -3,12 +3,115 @@
 
 #include "PayloadChannel/PayloadChannelNotifier.hpp"
 #include "Logger.hpp"
+#include "Settings.hpp"
+#include "Channel/ChannelMessage.hpp"
+#include <cstring> // std::strlen()
+
+/* Static methods for notification serialization. */
+
+inline static void appendBytes(std::vector<uint8_t>& buffer, const void* data, size_t len)
+{
+	const auto* bytes = static_cast<const uint8_t*>(data);
+
+	buffer.insert(buffer.end(), bytes, bytes + len);
+}
+
+inline static void appendBigEndian(std::vector<uint8_t>& buffer, uint32_t value, size_t len)
+{
+	for (size_t i{ len }; i > 0; --i)
+	{
+		buffer.push_back(static_cast<uint8_t>(value >> ((i - 1) * 8)));
+	}
+}
+
+inline static void appendMsgpackString(std::vector<uint8_t>& buffer, const char* str, size_t len)
+{
+	if (len <= 31)
+	{
+		buffer.push_back(static_cast<uint8_t>(0xa0 | len));
+	}
+	else if (len <= 0xff)
+	{
+		buffer.push_back(0xd9);
+		appendBigEndian(buffer, static_cast<uint32_t>(len), 1);
+	}
+	else if (len <= 0xffff)
+	{
+		buffer.push_back(0xda);
+		appendBigEndian(buffer, static_cast<uint32_t>(len), 2);
+	}
+	else
+	{
+		buffer.push_back(0xdb);
+		appendBigEndian(buffer, static_cast<uint32_t>(len), 4);
+	}
+
+	appendBytes(buffer, str, len);
+}
+
+inline static void appendMsgpackUInt(std::vector<uint8_t>& buffer, uint32_t value)
+{
+	if (value <= 0x7f)
+	{
+		buffer.push_back(static_cast<uint8_t>(value));
+	}
+	else if (value <= 0xff)
+	{
+		buffer.push_back(0xcc);
+		appendBigEndian(buffer, value, 1);
+	}
+	else if (value <= 0xffff)
+	{
+		buffer.push_back(0xcd);
+		appendBigEndian(buffer, value, 2);
+	}
+	else
+	{
+		buffer.push_back(0xce);
+		appendBigEndian(buffer, value, 4);
+	}
+}
+
+inline static void appendMsgpackArrayHeader(std::vector<uint8_t>& buffer, size_t len)
+{
+	if (len <= 15)
+	{
+		buffer.push_back(static_cast<uint8_t>(0x90 | len));
+	}
+	else if (len <= 0xffff)
+	{
+		buffer.push_back(0xdc);
+		appendBigEndian(buffer, static_cast<uint32_t>(len), 2);
+	}
+	else
+	{
+		buffer.push_back(0xdd);
+		appendBigEndian(buffer, static_cast<uint32_t>(len), 4);
+	}
+}
+
+inline static bool isJsonSafe(const std::string& str)
+{
+	for (auto c : str)
+	{
+		if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20)
+			return false;
+	}
+
+	return true;
+}
+
+inline static void appendJsonString(std::vector<uint8_t>& buffer, const char* str)
+{
+	appendBytes(buffer, str, std::strlen(str));
+}
 
 namespace PayloadChannel
 {
 	/* Class variables. */
 
 	thread_local PayloadChannel::PayloadChannelSocket* PayloadChannelNotifier::payloadChannel{ nullptr };
+	thread_local std::vector<uint8_t> PayloadChannelNotifier::notificationBuffer;
 
 	/* Static methods. */
 
@@ -26,6 +129,16 @@ namespace PayloadChannel
 
 		MS_ASSERT(PayloadChannelNotifier::payloadChannel, "payloadChannel unset");
 
+		if (SerializeNotification(targetId, event, nullptr))
+		{
+			const auto& buffer = PayloadChannelNotifier::notificationBuffer;
+
+			PayloadChannelNotifier::payloadChannel->Send(
+			  buffer.data(), buffer.size(), payload, payloadLen);
+
+			return;
+		}
+
 		json jsonNotification = json::object();
 
 		jsonNotification["targetId"] = targetId;
@@ -49,4 +162,167 @@ namespace PayloadChannel
 
 		PayloadChannelNotifier::payloadChannel->Send(jsonNotification, payload, payloadLen);
 	}
+
+	void PayloadChannelNotifier::Emit(
+	  const std::string& targetId,
+	  const char* event,
+	  uint32_t ppid,
+	  const uint8_t* payload,
+	  size_t payloadLen)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(PayloadChannelNotifier::payloadChannel, "payloadChannel unset");
+
+		if (SerializeNotification(targetId, event, std::addressof(ppid)))
+		{
+			const auto& buffer = PayloadChannelNotifier::notificationBuffer;
+
+			PayloadChannelNotifier::payloadChannel->Send(
+			  buffer.data(), buffer.size(), payload, payloadLen);
+
+			return;
+		}
+
+		json data = json::object();
+
+		data["ppid"] = ppid;
+
+		Emit(targetId, event, data, payload, payloadLen);
+	}
+
+	void PayloadChannelNotifier::Emit(
+	  const std::string& targetId,
+	  const char* event,
+	  uint32_t ppid,
+	  const std::vector<const std::string*>& targetIds,
+	  const uint8_t* payload,
+	  size_t payloadLen)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(PayloadChannelNotifier::payloadChannel, "payloadChannel unset");
+
+		if (SerializeNotification(targetId, event, std::addressof(ppid), std::addressof(targetIds)))
+		{
+			const auto& buffer = PayloadChannelNotifier::notificationBuffer;
+
+			PayloadChannelNotifier::payloadChannel->Send(
+			  buffer.data(), buffer.size(), payload, payloadLen);
+
+			return;
+		}
+
+		json data = json::object();
+
+		data["ppid"] = ppid;
+
+		auto jsonTargetIdsIt = data.emplace("targetIds", json::array()).first;
+
+		for (const auto* id : targetIds)
+		{
+			jsonTargetIdsIt->emplace_back(*id);
+		}
+
+		Emit(targetId, event, data, payload, payloadLen);
+	}
+
+	bool PayloadChannelNotifier::SerializeNotification(
+	  const std::string& targetId,
+	  const char* event,
+	  const uint32_t* ppid,
+	  const std::vector<const std::string*>* targetIds)
+	{
+		MS_TRACE();
+
+		auto& buffer = PayloadChannelNotifier::notificationBuffer;
+
+		buffer.clear();
+
+		switch (Settings::configuration.channelMessageFormat)
+		{
+			case Channel::ChannelMessage::Format::MSGPACK:
+			{
+				buffer.push_back(ppid ? 0x83 : 0x82);
+
+				appendMsgpackString(buffer, "targetId", 8);
+				appendMsgpackString(buffer, targetId.c_str(), targetId.length());
+				appendMsgpackString(buffer, "event", 5);
+				appendMsgpackString(buffer, event, std::strlen(event));
+
+				if (ppid)
+				{
+					appendMsgpackString(buffer, "data", 4);
+					buffer.push_back(targetIds ? 0x82 : 0x81);
+					appendMsgpackString(buffer, "ppid", 4);
+					appendMsgpackUInt(buffer, *ppid);
+
+					if (targetIds)
+					{
+						appendMsgpackString(buffer, "targetIds", 9);
+						appendMsgpackArrayHeader(buffer, targetIds->size());
+
+						for (const auto* id : *targetIds)
+						{
+							appendMsgpackString(buffer, id->c_str(), id->length());
+						}
+					}
+				}
+
+				return true;
+			}
+
+			default:
+			{
+				// Let json escape it.
+				if (!isJsonSafe(targetId))
+					return false;
+
+				if (targetIds)
+				{
+					for (const auto* id : *targetIds)
+					{
+						if (!isJsonSafe(*id))
+							return false;
+					}
+				}
+
+				appendJsonString(buffer, "{\"targetId\":\"");
+				appendBytes(buffer, targetId.c_str(), targetId.length());
+				appendJsonString(buffer, "\",\"event\":\"");
+				appendJsonString(buffer, event);
+
+				if (ppid)
+				{
+					appendJsonString(buffer, "\",\"data\":{\"ppid\":");
+					appendJsonString(buffer, std::to_string(*ppid).c_str());
+
+					if (targetIds)
+					{
+						appendJsonString(buffer, ",\"targetIds\":[");
+
+						for (size_t i{ 0u }; i < targetIds->size(); ++i)
+						{
+							if (i > 0u)
+								appendJsonString(buffer, ",");
+
+							appendJsonString(buffer, "\"");
+							appendBytes(buffer, (*targetIds)[i]->c_str(), (*targetIds)[i]->length());
+							appendJsonString(buffer, "\"");
+						}
+
+						appendJsonString(buffer, "]");
+					}
+
+					appendJsonString(buffer, "}}");
+				}
+				else
+				{
+					appendJsonString(buffer, "\"}");
+				}
+
+				return true;
+			}
+		}
+	}
 } // namespace PayloadChannel
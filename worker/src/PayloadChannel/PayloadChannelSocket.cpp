@@ -2,6 +2,7 @@
 // #define MS_LOG_DEV_LEVEL 3
 
 #include "PayloadChannel/PayloadChannelSocket.hpp"
+#include "Channel/ChannelMessage.hpp"
 #include "DepLibUV.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
@@ -21,14 +22,29 @@ namespace PayloadChannel
 		}
 	}
 
+	inline static void onPrepare(uv_prepare_t* handle)
+	{
+		auto* payloadChannel = static_cast<PayloadChannelSocket*>(handle->data);
+
+		if (payloadChannel)
+			payloadChannel->OnUvPrepare();
+	}
+
 	inline static void onClose(uv_handle_t* handle)
 	{
 		delete handle;
 	}
 
+	inline static void onClosePrepare(uv_handle_t* handle)
+	{
+		delete reinterpret_cast<uv_prepare_t*>(handle);
+	}
+
 	// Binary length for a 4194304 bytes payload.
 	static constexpr size_t MessageMaxLen{ 4194308 };
 	static constexpr size_t PayloadMaxLen{ 4194304 };
+	// Bigger payloads are not copied into the write buffer.
+	static constexpr size_t PayloadCopyMaxLen{ 16384 };
 
 	/* Instance methods. */
 	PayloadChannelSocket::PayloadChannelSocket(int consumerFd, int producerFd)
@@ -37,6 +53,19 @@ namespace PayloadChannel
 	    writeBuffer(static_cast<uint8_t*>(std::malloc(MessageMaxLen)))
 	{
 		MS_TRACE();
+
+		this->uvPrepareHandle       = new uv_prepare_t;
+		this->uvPrepareHandle->data = static_cast<void*>(this);
+
+		int err = uv_prepare_init(DepLibUV::GetLoop(), this->uvPrepareHandle);
+
+		if (err != 0)
+		{
+			delete this->uvPrepareHandle;
+			this->uvPrepareHandle = nullptr;
+
+			MS_WARN_DEV("uv_prepare_init() failed, messages written one by one: %s", uv_strerror(err));
+		}
 	}
 
 	PayloadChannelSocket::PayloadChannelSocket(
@@ -80,12 +109,14 @@ namespace PayloadChannel
 	{
 		MS_TRACE();
 
-		std::free(this->writeBuffer);
-		delete this->ongoingNotification;
-
+		// NOTE: It writes queued messages so must be called before freeing the
+		// write buffer.
 		if (!this->closed)
 			Close();
 
+		std::free(this->writeBuffer);
+		delete this->ongoingNotification;
+
 		delete this->consumerSocket;
 		delete this->producerSocket;
 	}
@@ -97,8 +128,20 @@ namespace PayloadChannel
 		if (this->closed)
 			return;
 
+		// Write queued messages.
+		Flush();
+
 		this->closed = true;
 
+		if (this->uvPrepareHandle)
+		{
+			this->uvPrepareHandle->data = nullptr;
+
+			uv_close(
+			  reinterpret_cast<uv_handle_t*>(this->uvPrepareHandle),
+			  static_cast<uv_close_cb>(onClosePrepare));
+		}
+
 		if (this->uvReadHandle)
 		{
 			uv_close(reinterpret_cast<uv_handle_t*>(this->uvReadHandle), static_cast<uv_close_cb>(onClose));
@@ -129,9 +172,10 @@ namespace PayloadChannel
 		if (this->closed)
 			return;
 
-		std::string message = jsonMessage.dump();
+		size_t messageLen;
+		const auto* message = Channel::ChannelMessage::Serialize(jsonMessage, messageLen);
 
-		if (message.length() > PayloadMaxLen)
+		if (messageLen > PayloadMaxLen)
 		{
 			MS_ERROR("message too big");
 
@@ -145,10 +189,7 @@ namespace PayloadChannel
 		}
 
 		SendImpl(
-		  reinterpret_cast<const uint8_t*>(message.c_str()),
-		  static_cast<uint32_t>(message.length()),
-		  payload,
-		  static_cast<uint32_t>(payloadLen));
+		  message, static_cast<uint32_t>(messageLen), payload, static_cast<uint32_t>(payloadLen));
 	}
 
 	void PayloadChannelSocket::Send(json& jsonMessage)
@@ -158,17 +199,56 @@ namespace PayloadChannel
 		if (this->closed)
 			return;
 
-		std::string message = jsonMessage.dump();
+		size_t messageLen;
+		const auto* message = Channel::ChannelMessage::Serialize(jsonMessage, messageLen);
 
-		if (message.length() > PayloadMaxLen)
+		if (messageLen > PayloadMaxLen)
 		{
 			MS_ERROR_STD("message too big");
 
 			return;
 		}
 
+		SendImpl(message, static_cast<uint32_t>(messageLen));
+	}
+
+	void PayloadChannelSocket::Send(
+	  const uint8_t* message, size_t messageLen, const uint8_t* payload, size_t payloadLen)
+	{
+		MS_TRACE();
+
+		if (this->closed)
+			return;
+
+		if (messageLen > PayloadMaxLen)
+		{
+			MS_ERROR("message too big");
+
+			return;
+		}
+		else if (payloadLen > PayloadMaxLen)
+		{
+			MS_ERROR("payload too big");
+
+			return;
+		}
+
 		SendImpl(
-		  reinterpret_cast<const uint8_t*>(message.c_str()), static_cast<uint32_t>(message.length()));
+		  message, static_cast<uint32_t>(messageLen), payload, static_cast<uint32_t>(payloadLen));
+	}
+
+	void PayloadChannelSocket::Flush()
+	{
+		MS_TRACE_STD();
+
+		if (this->writeBufferLen == 0u)
+			return;
+
+		uv_prepare_stop(this->uvPrepareHandle);
+
+		this->producerSocket->Write(this->writeBuffer, this->writeBufferLen);
+
+		this->writeBufferLen = 0u;
 	}
 
 	bool PayloadChannelSocket::CallbackRead()
@@ -200,7 +280,8 @@ namespace PayloadChannel
 		{
 			try
 			{
-				json jsonData = json::parse(message, message + static_cast<size_t>(messageLen));
+				json jsonData =
+				  Channel::ChannelMessage::Parse(message, static_cast<size_t>(messageLen));
 
 				if (PayloadChannelRequest::IsRequest(jsonData))
 				{
@@ -241,7 +322,7 @@ namespace PayloadChannel
 					try
 					{
 						auto* notification = new PayloadChannel::Notification(jsonData);
-						notification->SetPayload(payload, payloadLen);
+						notification->SetOwnedPayload(payload, payloadLen, payloadCapacity);
 
 						// Notify the listener.
 						try
@@ -298,16 +379,39 @@ namespace PayloadChannel
 		}
 		else
 		{
-			std::memcpy(this->writeBuffer, &messageLen, sizeof(uint32_t));
+			size_t len = sizeof(uint32_t) + messageLen;
+
+			// Make room for it.
+			if (this->writeBufferLen + len > MessageMaxLen)
+				Flush();
+
+			uint8_t* writePtr = this->writeBuffer + this->writeBufferLen;
+
+			std::memcpy(writePtr, &messageLen, sizeof(uint32_t));
 
 			if (messageLen != 0)
 			{
-				std::memcpy(this->writeBuffer + sizeof(uint32_t), message, messageLen);
+				std::memcpy(writePtr + sizeof(uint32_t), message, messageLen);
 			}
 
-			size_t len = sizeof(uint32_t) + messageLen;
+			if (!this->uvPrepareHandle)
+			{
+				this->producerSocket->Write(writePtr, len);
 
-			this->producerSocket->Write(this->writeBuffer, len);
+				return;
+			}
+
+			// First queued message in this iteration, write them before next poll.
+			if (this->writeBufferLen == 0u)
+			{
+				int err =
+				  uv_prepare_start(this->uvPrepareHandle, static_cast<uv_prepare_cb>(onPrepare));
+
+				if (err != 0)
+					MS_ABORT("uv_prepare_start() failed: %s", uv_strerror(err));
+			}
+
+			this->writeBufferLen += len;
 		}
 	}
 
@@ -322,6 +426,30 @@ namespace PayloadChannel
 			this->payloadChannelWriteFn(
 			  message, messageLen, payload, payloadLen, this->payloadChannelWriteCtx);
 		}
+		else if (this->uvPrepareHandle && payloadLen > PayloadCopyMaxLen)
+		{
+			SendImpl(message, messageLen);
+
+			// Make room for the payload length.
+			if (this->writeBufferLen + sizeof(uint32_t) > MessageMaxLen)
+				Flush();
+
+			std::memcpy(this->writeBuffer + this->writeBufferLen, &payloadLen, sizeof(uint32_t));
+
+			this->writeBufferLen += sizeof(uint32_t);
+
+			// Write queued messages and the payload at once.
+			uv_buf_t buffers[] = {
+				uv_buf_init(reinterpret_cast<char*>(this->writeBuffer), this->writeBufferLen),
+				uv_buf_init(reinterpret_cast<char*>(const_cast<uint8_t*>(payload)), payloadLen)
+			};
+
+			uv_prepare_stop(this->uvPrepareHandle);
+
+			this->producerSocket->Write(buffers, 2);
+
+			this->writeBufferLen = 0u;
+		}
 		else
 		{
 			SendImpl(message, messageLen);
@@ -329,6 +457,13 @@ namespace PayloadChannel
 		}
 	}
 
+	inline void PayloadChannelSocket::OnUvPrepare()
+	{
+		MS_TRACE();
+
+		Flush();
+	}
+
 	void PayloadChannelSocket::OnConsumerSocketMessage(
 	  ConsumerSocket* /*consumerSocket*/, char* msg, size_t msgLen)
 	{
@@ -336,7 +471,8 @@ namespace PayloadChannel
 
 		if (!this->ongoingNotification && !this->ongoingRequest)
 		{
-			json jsonData = json::parse(msg, msg + msgLen);
+			json jsonData =
+			  Channel::ChannelMessage::Parse(reinterpret_cast<const uint8_t*>(msg), msgLen);
 			if (PayloadChannelRequest::IsRequest(jsonData))
 			{
 				try
@@ -6,6 +6,11 @@
 #include "Utils.hpp"
 #include "Channel/ChannelNotifier.hpp"
 #include "RTC/RtpDictionaries.hpp"
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 namespace RTC
 {
@@ -29,6 +34,11 @@ namespace RTC
 	constexpr uint32_t LongsBuffLen{ LongCount };
 	constexpr uint32_t LevelsBuffLen{ LongCount * N3 * N2 };
 	constexpr double MinActivityScore{ 0.0000000001 };
+	constexpr uint64_t LevelsMask{ (uint64_t{ 1 } << LevelsBuffLen) - 1 };
+
+	// The SIMD kernels rely on this layout.
+	static_assert(LevelsBuffLen <= 64, "levels do not fit in a LevelsRow");
+	static_assert(LongCount == 1 && LongThreashold == N2 - 1, "unexpected mediums layout");
 
 	inline int64_t BinomialCoefficient(int32_t n, int32_t r)
 	{
@@ -92,7 +102,123 @@ namespace RTC
 		return changed;
 	}
 
-	ActiveSpeakerObserver::ActiveSpeakerObserver(const std::string& id, json& data)
+	// Returns a mask with bit i set if levels[i] >= threshold (for the 64 bytes of
+	// the given row).
+	inline uint64_t LevelsAboveMask(const uint8_t* levels, uint8_t threshold)
+	{
+#if defined(__AVX2__)
+		const __m256i t = _mm256_set1_epi8(static_cast<char>(threshold));
+		uint64_t mask{ 0u };
+
+		for (size_t i{ 0u }; i < 2u; ++i)
+		{
+			const __m256i v =
+			  _mm256_load_si256(reinterpret_cast<const __m256i*>(levels + (i * 32u)));
+			// Unsigned v >= t <=> max(v, t) == v.
+			const __m256i ge = _mm256_cmpeq_epi8(_mm256_max_epu8(v, t), v);
+
+			mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(ge))) << (i * 32u);
+		}
+
+		return mask;
+#elif defined(__SSE2__)
+		const __m128i t = _mm_set1_epi8(static_cast<char>(threshold));
+		uint64_t mask{ 0u };
+
+		for (size_t i{ 0u }; i < 4u; ++i)
+		{
+			const __m128i v  = _mm_load_si128(reinterpret_cast<const __m128i*>(levels + (i * 16u)));
+			const __m128i ge = _mm_cmpeq_epi8(_mm_max_epu8(v, t), v);
+
+			mask |= static_cast<uint64_t>(_mm_movemask_epi8(ge)) << (i * 16u);
+		}
+
+		return mask;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+		static const uint8_t Weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+		const uint8x16_t t = vdupq_n_u8(threshold);
+		const uint8x16_t w = vld1q_u8(Weights);
+		uint64_t mask{ 0u };
+
+		for (size_t i{ 0u }; i < 4u; ++i)
+		{
+			const uint8x16_t ge = vandq_u8(vcgeq_u8(vld1q_u8(levels + (i * 16u)), t), w);
+			const uint64_t bits = static_cast<uint64_t>(vaddv_u8(vget_low_u8(ge))) |
+			                      (static_cast<uint64_t>(vaddv_u8(vget_high_u8(ge))) << 8u);
+
+			mask |= bits << (i * 16u);
+		}
+
+		return mask;
+#else
+		uint64_t mask{ 0u };
+
+		for (size_t i{ 0u }; i < 64u; ++i)
+		{
+			if (levels[i] >= threshold)
+				mask |= uint64_t{ 1 } << i;
+		}
+
+		return mask;
+#endif
+	}
+
+	// Activity scores only depend on the first immediate, medium and long, so
+	// they are precomputed for the SIMD mode. Values are the same ones the
+	// scalar path computes.
+	inline double ImmediateActivityScore(uint8_t immediate)
+	{
+		static const auto Scores = []
+		{
+			std::vector<double> scores(MaxLevel / SubunitLengthN1 + 1);
+
+			for (size_t vL{ 0u }; vL < scores.size(); ++vL)
+			{
+				scores[vL] = ComputeActivityScore(vL, N1, 0.5, 0.78);
+			}
+
+			return scores;
+		}();
+
+		return Scores[immediate];
+	}
+
+	inline double MediumActivityScore(uint8_t medium)
+	{
+		static const auto Scores = []
+		{
+			std::vector<double> scores(N2 + 1);
+
+			for (size_t vL{ 0u }; vL < scores.size(); ++vL)
+			{
+				scores[vL] = ComputeActivityScore(vL, N2, 0.5, 24);
+			}
+
+			return scores;
+		}();
+
+		return Scores[medium];
+	}
+
+	inline double LongActivityScore(uint8_t longCount)
+	{
+		static const auto Scores = []
+		{
+			std::vector<double> scores(N3 + 1);
+
+			for (size_t vL{ 0u }; vL < scores.size(); ++vL)
+			{
+				scores[vL] = ComputeActivityScore(vL, N3, 0.5, 47);
+			}
+
+			return scores;
+		}();
+
+		return Scores[longCount];
+	}
+
+	ActiveSpeakerObserver::ActiveSpeakerObserver(
+	  RTC::VideoLastNPolicy::Listener* videoLastNPolicyListener, const std::string& id, json& data)
 	  : RTC::RtpObserver(id)
 	{
 		MS_TRACE();
@@ -109,6 +235,21 @@ namespace RTC
 		else if (this->interval > 5000)
 			this->interval = 5000;
 
+		auto jsonUseSimdIt = data.find("useSimd");
+
+		if (jsonUseSimdIt != data.end() && jsonUseSimdIt->is_boolean())
+			this->useSimd = jsonUseSimdIt->get<bool>();
+
+		auto jsonVideoLastNIt = data.find("videoLastN");
+
+		if (jsonVideoLastNIt != data.end() && Utils::Json::IsPositiveInteger(*jsonVideoLastNIt))
+		{
+			auto videoLastN = jsonVideoLastNIt->get<size_t>();
+
+			if (videoLastN > 0u)
+				this->videoLastNPolicy = new RTC::VideoLastNPolicy(videoLastNPolicyListener, videoLastN);
+		}
+
 		this->periodicTimer = new Timer(this);
 
 		this->periodicTimer->Start(interval, interval);
@@ -119,6 +260,8 @@ namespace RTC
 		MS_TRACE();
 
 		delete this->periodicTimer;
+
+		delete this->videoLastNPolicy;
 	}
 
 	void ActiveSpeakerObserver::AddProducer(RTC::Producer* producer)
@@ -131,8 +274,13 @@ namespace RTC
 		if (this->mapProducerSpeaker.find(producer->id) != this->mapProducerSpeaker.end())
 			MS_THROW_ERROR("Producer already in map");
 
+		auto* speaker = new Speaker(this->useSimd);
+
 		this->mapProducerSpeaker[producer->id].producer = producer;
-		this->mapProducerSpeaker[producer->id].speaker  = new Speaker();
+		this->mapProducerSpeaker[producer->id].speaker  = speaker;
+
+		if (this->useSimd)
+			AddLevelsRow(speaker);
 	}
 
 	void ActiveSpeakerObserver::RemoveProducer(RTC::Producer* producer)
@@ -148,12 +296,18 @@ namespace RTC
 
 		if (it->second.speaker != nullptr)
 		{
+			if (this->useSimd)
+				RemoveLevelsRow(it->second.speaker);
+
 			delete it->second.speaker;
 			it->second.speaker = nullptr;
 		}
 
 		this->mapProducerSpeaker.erase(producer->id);
 
+		if (this->videoLastNPolicy)
+			this->videoLastNPolicy->RemoveSpeaker(producer);
+
 		if (producer->id == this->dominantId)
 		{
 			this->dominantId.erase();
@@ -255,6 +409,12 @@ namespace RTC
 			json data          = json::object();
 			data["producerId"] = this->dominantId;
 
+			if (this->videoLastNPolicy)
+			{
+				this->videoLastNPolicy->DominantSpeakerChanged(
+				  this->mapProducerSpeaker[this->dominantId].producer);
+			}
+
 			Channel::ChannelNotifier::Emit(this->id, "dominantspeaker", data);
 		}
 	}
@@ -292,7 +452,11 @@ namespace RTC
 				newDominantId = "";
 			}
 
-			dominantSpeaker->EvalActivityScores();
+			if (this->useSimd)
+				EvalLevelsTableActivityScores();
+			else
+				dominantSpeaker->EvalActivityScores();
+
 			double newDominantC2 = C2;
 
 			for (auto it = this->mapProducerSpeaker.begin(); it != this->mapProducerSpeaker.end(); ++it)
@@ -305,7 +469,8 @@ namespace RTC
 					continue;
 				}
 
-				speaker->EvalActivityScores();
+				if (!this->useSimd)
+					speaker->EvalActivityScores();
 
 				for (int interval = 0; interval < this->relativeSpeachActivitiesLen; ++interval)
 				{
@@ -355,13 +520,118 @@ namespace RTC
 		}
 	}
 
-	ActiveSpeakerObserver::Speaker::Speaker()
+	void ActiveSpeakerObserver::AddLevelsRow(Speaker* speaker)
+	{
+		MS_TRACE();
+
+		auto* data = this->levelsTable.data();
+
+		speaker->levelsRow = this->levelsTable.size();
+		this->levelsTable.emplace_back();
+		this->levelsTableSpeakers.push_back(speaker);
+
+		// Table reallocated, update levels of all Speakers.
+		if (this->levelsTable.data() != data)
+		{
+			for (size_t row{ 0u }; row < this->levelsTable.size(); ++row)
+			{
+				this->levelsTableSpeakers[row]->levels = this->levelsTable[row].levels;
+			}
+		}
+		else
+		{
+			speaker->levels = this->levelsTable.back().levels;
+		}
+	}
+
+	void ActiveSpeakerObserver::RemoveLevelsRow(Speaker* speaker)
+	{
+		MS_TRACE();
+
+		const size_t row = speaker->levelsRow;
+
+		// Move the last row into the removed one.
+		if (row != this->levelsTable.size() - 1)
+		{
+			Speaker* lastSpeaker = this->levelsTableSpeakers.back();
+
+			this->levelsTable[row]         = this->levelsTable.back();
+			this->levelsTableSpeakers[row] = lastSpeaker;
+			lastSpeaker->levelsRow         = row;
+			lastSpeaker->levels            = this->levelsTable[row].levels;
+		}
+
+		this->levelsTable.pop_back();
+		this->levelsTableSpeakers.pop_back();
+
+		speaker->levels = nullptr;
+	}
+
+	void ActiveSpeakerObserver::EvalLevelsTableActivityScores()
+	{
+		MS_TRACE();
+
+		for (size_t row{ 0u }; row < this->levelsTable.size(); ++row)
+		{
+			Speaker* speaker       = this->levelsTableSpeakers[row];
+			const uint8_t* levels  = this->levelsTable[row].levels;
+			const size_t nextIndex = speaker->nextLevelIndex;
+
+			// Levels below this one count as MinLevel (see ComputeImmediates()).
+			const int8_t signedMinLevel = speaker->minLevel + SubunitLengthN1;
+			const uint8_t minLevel      = signedMinLevel > 0 ? signedMinLevel : 0;
+
+			// An immediate is greater than MediumThreshold if its level is at least
+			// (MediumThreshold + 1) * SubunitLengthN1 and not below minLevel.
+			const uint8_t threshold =
+			  std::max(static_cast<uint8_t>((MediumThreshold + 1) * SubunitLengthN1), minLevel);
+
+			// Rotate the circular buffer mask so the newest level is in the highest
+			// bit. Groups of N2 bits then match the mediums.
+			uint64_t mask = LevelsAboveMask(levels, threshold) & LevelsMask;
+
+			mask = ((mask >> nextIndex) | (mask << (LevelsBuffLen - nextIndex))) & LevelsMask;
+
+			uint8_t newestLevel = levels[nextIndex == 0 ? LevelsBuffLen - 1 : nextIndex - 1];
+
+			if (newestLevel < minLevel)
+				newestLevel = MinLevel;
+
+			const uint8_t immediate = newestLevel / SubunitLengthN1;
+			const uint8_t medium =
+			  static_cast<uint8_t>(Utils::Bits::CountSetBits(mask >> (LevelsBuffLen - N2)));
+			uint8_t longCount{ 0u };
+
+			// A medium is greater than LongThreashold if all its immediates are.
+			for (uint32_t b{ 0u }; b < MediumsBuffLen; ++b)
+			{
+				if (((mask >> (b * N2)) & ((1u << N2) - 1)) == ((1u << N2) - 1))
+					++longCount;
+			}
+
+			speaker->immediateActivityScore = ImmediateActivityScore(immediate);
+			speaker->mediumActivityScore    = MediumActivityScore(medium);
+			speaker->longActivityScore      = LongActivityScore(longCount);
+		}
+	}
+
+	ActiveSpeakerObserver::Speaker::Speaker(bool useSimd)
 	  : immediateActivityScore(MinActivityScore), mediumActivityScore(MinActivityScore),
 	    longActivityScore(MinActivityScore), lastLevelChangeTime(DepLibUV::GetTimeMs()),
-	    minLevel(MinLevel), nextMinLevel(MinLevel), immediates(ImmediateBuffLen, 0),
-	    mediums(MediumsBuffLen, 0), longs(LongsBuffLen, 0), levels(LevelsBuffLen, 0), nextLevelIndex(0)
+	    minLevel(MinLevel), nextMinLevel(MinLevel), nextLevelIndex(0)
 	{
 		MS_TRACE();
+
+		// In SIMD mode levels are given by the observer and scores are computed
+		// from its levels table.
+		if (useSimd)
+			return;
+
+		this->immediates.resize(ImmediateBuffLen, 0);
+		this->mediums.resize(MediumsBuffLen, 0);
+		this->longs.resize(LongsBuffLen, 0);
+		this->levelsStorage.resize(LevelsBuffLen, 0);
+		this->levels = this->levelsStorage.data();
 	}
 
 	void ActiveSpeakerObserver::Speaker::EvalActivityScores()
@@ -0,0 +1,135 @@
+#define MS_CLASS "RTC::AudioLastNSelector"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/AudioLastNSelector.hpp"
+#include "Logger.hpp"
+#include <algorithm> // std::partial_sort()
+#include <utility>   // std::pair
+#include <vector>
+
+namespace RTC
+{
+	/* Static. */
+
+	static constexpr uint64_t UpdateIntervalMs{ 300u };
+	static constexpr uint8_t SilenceVolume{ 127u }; // In -dBov.
+
+	/* Instance methods. */
+
+	AudioLastNSelector::AudioLastNSelector(size_t lastN) : lastN(lastN)
+	{
+		MS_TRACE();
+
+		this->updateTimer = new Timer(this);
+
+		this->updateTimer->Start(UpdateIntervalMs, UpdateIntervalMs);
+	}
+
+	AudioLastNSelector::~AudioLastNSelector()
+	{
+		MS_TRACE();
+
+		delete this->updateTimer;
+		this->updateTimer = nullptr;
+	}
+
+	bool AudioLastNSelector::ForwardRtpPacket(
+	  const RTC::Producer* producer, const RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		uint8_t volume;
+		bool voice;
+
+		// Forward it if the audio level is unknown.
+		if (!packet->ReadSsrcAudioLevel(volume, voice))
+			return true;
+
+		auto& level = this->mapProducerLevels[producer];
+
+		level.volumeSum += voice ? volume : SilenceVolume;
+		level.packetCount++;
+
+		if (voice)
+			level.voicePacketCount++;
+
+		if (level.selected)
+			return true;
+
+		// Select a Producer that starts speaking if there is room for it.
+		if (voice && this->selectedCount < this->lastN)
+		{
+			level.selected = true;
+			this->selectedCount++;
+
+			return true;
+		}
+
+		return false;
+	}
+
+	void AudioLastNSelector::RemoveProducer(const RTC::Producer* producer)
+	{
+		MS_TRACE();
+
+		auto it = this->mapProducerLevels.find(producer);
+
+		if (it == this->mapProducerLevels.end())
+			return;
+
+		if (it->second.selected)
+			this->selectedCount--;
+
+		this->mapProducerLevels.erase(it);
+	}
+
+	void AudioLastNSelector::Update()
+	{
+		MS_TRACE();
+
+		// Average volume (in -dBov, lower is louder) of the Producers that spoke
+		// during the last interval.
+		std::vector<std::pair<uint32_t, ProducerLevel*>> candidates;
+
+		candidates.reserve(this->mapProducerLevels.size());
+
+		for (auto& kv : this->mapProducerLevels)
+		{
+			auto& level = kv.second;
+
+			level.selected = false;
+
+			if (level.voicePacketCount > 0u)
+				candidates.emplace_back(level.volumeSum / level.packetCount, &level);
+
+			level.volumeSum        = 0u;
+			level.packetCount      = 0u;
+			level.voicePacketCount = 0u;
+		}
+
+		this->selectedCount = std::min(candidates.size(), this->lastN);
+
+		std::partial_sort(
+		  candidates.begin(),
+		  candidates.begin() + this->selectedCount,
+		  candidates.end(),
+		  [](const std::pair<uint32_t, ProducerLevel*>& a, const std::pair<uint32_t, ProducerLevel*>& b)
+		  { return a.first < b.first; });
+
+		for (size_t i{ 0u }; i < this->selectedCount; ++i)
+		{
+			candidates[i].second->selected = true;
+		}
+
+		MS_DEBUG_DEV(
+		  "selection updated [selected:%zu, candidates:%zu]", this->selectedCount, candidates.size());
+	}
+
+	inline void AudioLastNSelector::OnTimer(Timer* timer)
+	{
+		MS_TRACE();
+
+		if (timer == this->updateTimer)
+			Update();
+	}
+} // namespace RTC
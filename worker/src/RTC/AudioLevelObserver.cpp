@@ -7,7 +7,9 @@
 #include "Utils.hpp"
 #include "Channel/ChannelNotifier.hpp"
 #include "RTC/RtpDictionaries.hpp"
-#include <cmath> // std::lround()
+#include <absl/container/btree_map.h>
+#include <algorithm> // std::sort()
+#include <cmath>     // std::lround()
 #include <map>
 
 namespace RTC
@@ -57,6 +59,11 @@ namespace RTC
 		else if (this->interval > 5000)
 			this->interval = 5000;
 
+		auto jsonIncrementalIt = data.find("incremental");
+
+		if (jsonIncrementalIt != data.end() && jsonIncrementalIt->is_boolean())
+			this->incremental = jsonIncrementalIt->get<bool>();
+
 		this->periodicTimer = new Timer(this);
 
 		this->periodicTimer->Start(this->interval, this->interval);
@@ -77,15 +84,23 @@ namespace RTC
 			MS_THROW_TYPE_ERROR("not an audio Producer");
 
 		// Insert into the map.
-		this->mapProducerDBovs[producer];
+		this->mapProducerDBovs[producer].producer = producer;
 	}
 
 	void AudioLevelObserver::RemoveProducer(RTC::Producer* producer)
 	{
 		MS_TRACE();
 
+		auto it = this->mapProducerDBovs.find(producer);
+
+		if (it == this->mapProducerDBovs.end())
+			return;
+
+		if (it->second.heapIndex != NotInHeap)
+			HeapRemove(it->second.heapIndex);
+
 		// Remove from the map.
-		this->mapProducerDBovs.erase(producer);
+		this->mapProducerDBovs.erase(it);
 	}
 
 	void AudioLevelObserver::ReceiveRtpPacket(RTC::Producer* producer, RTC::RtpPacket* packet)
@@ -103,20 +118,30 @@ namespace RTC
 
 		auto& dBovs = this->mapProducerDBovs.at(producer);
 
+		// Incremental mode: values of a previous interval are reset lazily.
+		if (this->incremental && dBovs.epoch != this->epoch)
+		{
+			dBovs.totalSum = 0;
+			dBovs.count    = 0;
+			dBovs.epoch    = this->epoch;
+		}
+
 		dBovs.totalSum += volume;
 		dBovs.count++;
+
+		if (this->incremental)
+			UpdateTopDBovs(dBovs);
 	}
 
 	void AudioLevelObserver::ProducerPaused(RTC::Producer* producer)
 	{
-		// Remove from the map.
-		this->mapProducerDBovs.erase(producer);
+		RemoveProducer(producer);
 	}
 
 	void AudioLevelObserver::ProducerResumed(RTC::Producer* producer)
 	{
 		// Insert into the map.
-		this->mapProducerDBovs[producer];
+		this->mapProducerDBovs[producer].producer = producer;
 	}
 
 	void AudioLevelObserver::Paused()
@@ -125,11 +150,15 @@ namespace RTC
 
 		this->periodicTimer->Stop();
 
-		ResetMapProducerDBovs();
+		if (this->incremental)
+			ResetTopDBovs();
+		else
+			ResetMapProducerDBovs();
 
 		if (!this->silence)
 		{
 			this->silence = true;
+			this->lastVolumesProducers.clear();
 
 			Channel::ChannelNotifier::Emit(this->id, "silence");
 		}
@@ -146,6 +175,26 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		if (this->incremental)
+		{
+			if (!this->topDBovs.empty())
+			{
+				EmitVolumes();
+			}
+			else if (!this->silence)
+			{
+				this->silence = true;
+				this->lastVolumesProducers.clear();
+
+				Channel::ChannelNotifier::Emit(this->id, "silence");
+			}
+
+			// Start a new interval.
+			ResetTopDBovs();
+
+			return;
+		}
+
 		absl::btree_map<int8_t, RTC::Producer*> mapDBovsProducer;
 
 		for (auto& kv : this->mapProducerDBovs)
@@ -206,6 +255,183 @@ namespace RTC
 		}
 	}
 
+	void AudioLevelObserver::UpdateTopDBovs(DBovs& dBovs)
+	{
+		MS_TRACE();
+
+		if (dBovs.count < 10)
+			return;
+
+		dBovs.avgDBov = -1 * static_cast<int8_t>(std::lround(dBovs.totalSum / dBovs.count));
+
+		if (dBovs.heapIndex != NotInHeap)
+		{
+			if (dBovs.avgDBov < this->threshold)
+			{
+				HeapRemove(dBovs.heapIndex);
+			}
+			else
+			{
+				HeapSiftUp(dBovs.heapIndex);
+				HeapSiftDown(dBovs.heapIndex);
+			}
+
+			return;
+		}
+
+		if (dBovs.avgDBov < this->threshold)
+			return;
+
+		if (this->topDBovs.size() < this->maxEntries)
+		{
+			HeapPush(std::addressof(dBovs));
+		}
+		// Louder than the quietest one in the heap, replace it.
+		else if (dBovs.avgDBov > this->topDBovs.front()->avgDBov)
+		{
+			this->topDBovs.front()->heapIndex = NotInHeap;
+			HeapSet(0, std::addressof(dBovs));
+			HeapSiftDown(0);
+		}
+		else
+		{
+			return;
+		}
+
+		// A Producer entered the loudest ones. Notify it early, once per interval.
+		if (!this->earlyVolumesEmitted && !this->lastVolumesProducers.contains(dBovs.producer))
+		{
+			this->earlyVolumesEmitted = true;
+
+			EmitVolumes();
+		}
+	}
+
+	void AudioLevelObserver::EmitVolumes()
+	{
+		MS_TRACE();
+
+		std::vector<const DBovs*> sortedDBovs(this->topDBovs.begin(), this->topDBovs.end());
+
+		std::sort(
+		  sortedDBovs.begin(),
+		  sortedDBovs.end(),
+		  [](const DBovs* a, const DBovs* b) { return a->avgDBov > b->avgDBov; });
+
+		this->silence = false;
+		this->lastVolumesProducers.clear();
+
+		json data = json::array();
+
+		for (const auto* dBovs : sortedDBovs)
+		{
+			data.emplace_back(json::value_t::object);
+
+			auto& jsonEntry = data.back();
+
+			jsonEntry["producerId"] = dBovs->producer->id;
+			jsonEntry["volume"]     = dBovs->avgDBov;
+
+			this->lastVolumesProducers.insert(dBovs->producer);
+		}
+
+		Channel::ChannelNotifier::Emit(this->id, "volumes", data);
+	}
+
+	void AudioLevelObserver::ResetTopDBovs()
+	{
+		MS_TRACE();
+
+		for (auto* dBovs : this->topDBovs)
+		{
+			dBovs->heapIndex = NotInHeap;
+		}
+
+		this->topDBovs.clear();
+		this->earlyVolumesEmitted = false;
+
+		// Values of every Producer are reset when receiving its next packet.
+		++this->epoch;
+	}
+
+	inline void AudioLevelObserver::HeapPush(DBovs* dBovs)
+	{
+		this->topDBovs.push_back(dBovs);
+		dBovs->heapIndex = this->topDBovs.size() - 1;
+
+		HeapSiftUp(dBovs->heapIndex);
+	}
+
+	void AudioLevelObserver::HeapRemove(size_t idx)
+	{
+		MS_TRACE();
+
+		this->topDBovs[idx]->heapIndex = NotInHeap;
+
+		auto* last = this->topDBovs.back();
+
+		this->topDBovs.pop_back();
+
+		if (idx == this->topDBovs.size())
+			return;
+
+		HeapSet(idx, last);
+		HeapSiftUp(idx);
+		HeapSiftDown(last->heapIndex);
+	}
+
+	inline void AudioLevelObserver::HeapSiftUp(size_t idx)
+	{
+		while (idx > 0)
+		{
+			size_t parent = (idx - 1) / 2;
+
+			if (this->topDBovs[parent]->avgDBov <= this->topDBovs[idx]->avgDBov)
+				break;
+
+			auto* dBovs = this->topDBovs[idx];
+
+			HeapSet(idx, this->topDBovs[parent]);
+			HeapSet(parent, dBovs);
+
+			idx = parent;
+		}
+	}
+
+	inline void AudioLevelObserver::HeapSiftDown(size_t idx)
+	{
+		const size_t size = this->topDBovs.size();
+
+		while (true)
+		{
+			size_t smallest = idx;
+			size_t left     = (2 * idx) + 1;
+			size_t right    = left + 1;
+
+			if (left < size && this->topDBovs[left]->avgDBov < this->topDBovs[smallest]->avgDBov)
+				smallest = left;
+
+			if (right < size && this->topDBovs[right]->avgDBov < this->topDBovs[smallest]->avgDBov)
+				smallest = right;
+
+			if (smallest == idx)
+				break;
+
+			auto* dBovs = this->topDBovs[idx];
+
+			HeapSet(idx, this->topDBovs[smallest]);
+			HeapSet(smallest, dBovs);
+
+			idx = smallest;
+		}
+	}
+
+	inline void AudioLevelObserver::HeapSet(size_t idx, DBovs* dBovs)
+	{
+		this->topDBovs[idx] = dBovs;
+		dBovs->heapIndex    = idx;
+	}
+
 	inline void AudioLevelObserver::OnTimer(Timer* /*timer*/)
 	{
 		MS_TRACE();
@@ -0,0 +1,431 @@
+#define MS_CLASS "RTC::AudioMixer"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/AudioMixer.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "ThreadPlacement.hpp"
+#include "Utils.hpp"
+#include <algorithm> // std::fill_n(), std::any_of()
+#include <chrono>
+#include <cstring> // std::memcpy(), std::memmove()
+#ifdef MS_AUDIO_MIXER
+#include <opus/opus.h>
+#endif
+
+/* Static methods for UV callbacks. */
+
+inline static void onAsync(uv_async_t* handle)
+{
+	static_cast<RTC::AudioMixer*>(handle->data)->OnUvAsync();
+}
+
+inline static void onClose(uv_handle_t* handle)
+{
+	delete reinterpret_cast<uv_async_t*>(handle);
+}
+
+namespace RTC
+{
+	/* Static. */
+
+	static constexpr size_t RtpHeaderSize{ 12u };
+
+	/* Instance methods. */
+
+	AudioMixer::AudioMixer(RTC::AudioMixer::Listener* listener, const std::string& id, json& data)
+	  : RTC::RtpObserver(id), listener(listener)
+	{
+		MS_TRACE();
+
+		auto jsonOutputProducerIdIt = data.find("outputProducerId");
+
+		if (jsonOutputProducerIdIt == data.end() || !jsonOutputProducerIdIt->is_string())
+			MS_THROW_TYPE_ERROR("missing outputProducerId");
+
+		this->outputProducerId = jsonOutputProducerIdIt->get<std::string>();
+
+		auto jsonMaxSpeakersIt = data.find("maxSpeakers");
+
+		if (jsonMaxSpeakersIt != data.end() && Utils::Json::IsPositiveInteger(*jsonMaxSpeakersIt))
+			this->maxSpeakers = jsonMaxSpeakersIt->get<uint16_t>();
+
+		if (this->maxSpeakers < 1)
+			MS_THROW_TYPE_ERROR("invalid maxSpeakers value %" PRIu16, this->maxSpeakers);
+
+		auto jsonBitrateIt = data.find("bitrate");
+
+		if (jsonBitrateIt != data.end() && Utils::Json::IsPositiveInteger(*jsonBitrateIt))
+			this->bitrate = jsonBitrateIt->get<uint32_t>();
+
+		if (this->bitrate < 6000)
+			this->bitrate = 6000;
+		else if (this->bitrate > 510000)
+			this->bitrate = 510000;
+
+#ifndef MS_AUDIO_MIXER
+		MS_THROW_ERROR("AudioMixer not supported (worker built without ms_audio_mixer option)");
+#else
+		int err;
+
+		this->encoder = opus_encoder_create(SampleRate, 1, OPUS_APPLICATION_VOIP, &err);
+
+		if (err != OPUS_OK)
+			MS_THROW_ERROR("opus_encoder_create() failed: %s", opus_strerror(err));
+
+		opus_encoder_ctl(this->encoder, OPUS_SET_BITRATE(static_cast<opus_int32>(this->bitrate)));
+
+		this->uvAsyncHandle       = new uv_async_t;
+		this->uvAsyncHandle->data = static_cast<void*>(this);
+
+		err = uv_async_init(
+		  DepLibUV::GetLoop(), this->uvAsyncHandle, static_cast<uv_async_cb>(onAsync));
+
+		if (err != 0)
+		{
+			delete this->uvAsyncHandle;
+			opus_encoder_destroy(this->encoder);
+
+			MS_THROW_ERROR("uv_async_init() failed: %s", uv_strerror(err));
+		}
+
+		// This handle must not keep the loop alive.
+		uv_unref(reinterpret_cast<uv_handle_t*>(this->uvAsyncHandle));
+
+		this->selector      = new AudioLastNSelector(this->maxSpeakers);
+		this->baseTimestamp = Utils::Crypto::GetRandomUInt(0u, 0xFFFFFFFF);
+		this->thread        = std::thread(&AudioMixer::ThreadMain, this);
+
+		try
+		{
+			ThreadPlacement::ApplyToHelperThread(this->thread);
+		}
+		catch (const MediaSoupError&)
+		{
+			this->stopping.store(true, std::memory_order_release);
+			this->thread.join();
+
+			delete this->selector;
+			uv_close(
+			  reinterpret_cast<uv_handle_t*>(this->uvAsyncHandle), static_cast<uv_close_cb>(onClose));
+			opus_encoder_destroy(this->encoder);
+
+			throw;
+		}
+#endif
+	}
+
+	AudioMixer::~AudioMixer()
+	{
+		MS_TRACE();
+
+#ifdef MS_AUDIO_MIXER
+		this->stopping.store(true, std::memory_order_release);
+
+		if (this->thread.joinable())
+			this->thread.join();
+
+		for (auto& kv : this->mapSources)
+		{
+			auto* source = kv.second;
+
+			if (source->decoder)
+				opus_decoder_destroy(source->decoder);
+
+			delete source;
+		}
+
+		opus_encoder_destroy(this->encoder);
+
+		uv_close(
+		  reinterpret_cast<uv_handle_t*>(this->uvAsyncHandle), static_cast<uv_close_cb>(onClose));
+
+		delete this->selector;
+#endif
+	}
+
+	void AudioMixer::AddProducer(RTC::Producer* producer)
+	{
+		MS_TRACE();
+
+		if (producer->GetKind() != RTC::Media::Kind::AUDIO)
+			MS_THROW_TYPE_ERROR("not an audio Producer");
+
+		if (producer->id == this->outputProducerId)
+			MS_THROW_TYPE_ERROR("cannot add the output Producer");
+
+		const auto& codecs = producer->GetRtpParameters().codecs;
+
+		// clang-format off
+		if (
+			!std::any_of(codecs.begin(), codecs.end(), [](const RTC::RtpCodecParameters& codec)
+			{
+				return codec.mimeType.subtype == RTC::RtpCodecMimeType::Subtype::OPUS;
+			})
+		)
+		// clang-format on
+		{
+			MS_THROW_TYPE_ERROR("not an Opus Producer");
+		}
+
+		// Insert into the map.
+		this->mapProducerSourceIds[producer] = this->nextSourceId++;
+	}
+
+	void AudioMixer::RemoveProducer(RTC::Producer* producer)
+	{
+		MS_TRACE();
+
+		// Its decoding state is removed by the mixing thread once it times out.
+		this->mapProducerSourceIds.erase(producer);
+		this->selector->RemoveProducer(producer);
+	}
+
+	void AudioMixer::ReceiveRtpPacket(RTC::Producer* producer, RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		if (IsPaused())
+			return;
+
+		auto it = this->mapProducerSourceIds.find(producer);
+
+		if (it == this->mapProducerSourceIds.end())
+			return;
+
+		if (packet->GetPayloadLength() == 0u || !this->selector->ForwardRtpPacket(producer, packet))
+			return;
+
+		auto* item = this->inputQueue.Reserve();
+
+		// Mixing thread is behind, so drop it.
+		if (!item)
+		{
+			MS_DEBUG_DEV("input queue full, packet dropped [producerId:%s]", producer->id.c_str());
+
+			return;
+		}
+
+		item->sourceId = it->second;
+		item->len      = static_cast<uint16_t>(packet->GetPayloadLength());
+
+		std::memcpy(item->data, packet->GetPayload(), packet->GetPayloadLength());
+
+		this->inputQueue.Commit();
+	}
+
+	void AudioMixer::ProducerPaused(RTC::Producer* producer)
+	{
+		MS_TRACE();
+
+		this->selector->RemoveProducer(producer);
+	}
+
+	void AudioMixer::ProducerResumed(RTC::Producer* /*producer*/)
+	{
+		MS_TRACE();
+	}
+
+	void AudioMixer::Paused()
+	{
+		MS_TRACE();
+	}
+
+	void AudioMixer::Resumed()
+	{
+		MS_TRACE();
+	}
+
+	void AudioMixer::ThreadMain()
+	{
+		// NOTE: No logging here since the Logger only works in the loop thread.
+
+#ifdef MS_AUDIO_MIXER
+		const auto start = std::chrono::steady_clock::now();
+		const uint64_t sourceTimeoutFrames{ SourceTimeoutMs / FrameIntervalMs };
+		uint64_t frame{ 0u };
+
+		while (!this->stopping.load(std::memory_order_acquire))
+		{
+			std::this_thread::sleep_until(
+			  start + std::chrono::milliseconds(FrameIntervalMs * (frame + 1u)));
+
+			InputItem* item;
+
+			while ((item = this->inputQueue.Front()))
+			{
+				auto*& source = this->mapSources[item->sourceId];
+
+				if (!source)
+				{
+					int err;
+
+					source          = new Source();
+					source->decoder = opus_decoder_create(SampleRate, 1, &err);
+
+					if (err != OPUS_OK)
+						source->decoder = nullptr;
+				}
+
+				int decoded{ 0 };
+
+				if (source->decoder)
+				{
+					decoded = opus_decode(
+					  source->decoder,
+					  item->data,
+					  static_cast<opus_int32>(item->len),
+					  source->samples + source->sampleCount,
+					  static_cast<int>(MaxPacketSamples),
+					  0);
+				}
+
+				// Invalid packets are ignored.
+				if (decoded > 0)
+					source->sampleCount += static_cast<size_t>(decoded);
+
+				// Keep the newest samples.
+				if (source->sampleCount > MaxBufferedSamples)
+				{
+					std::memmove(
+					  source->samples,
+					  source->samples + (source->sampleCount - MaxBufferedSamples),
+					  MaxBufferedSamples * sizeof(int16_t));
+
+					source->sampleCount = MaxBufferedSamples;
+				}
+
+				source->lastPacketFrame = frame;
+
+				this->inputQueue.Pop();
+			}
+
+			MixFrame(frame);
+
+			// Remove sources without packets for a while (their Producers were
+			// removed, paused or are not among the loudest ones anymore).
+			for (auto it = this->mapSources.begin(); it != this->mapSources.end();)
+			{
+				auto* source = it->second;
+
+				if (frame - source->lastPacketFrame > sourceTimeoutFrames)
+				{
+					if (source->decoder)
+						opus_decoder_destroy(source->decoder);
+
+					delete source;
+					this->mapSources.erase(it++);
+				}
+				else
+				{
+					++it;
+				}
+			}
+
+			auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+			                   std::chrono::steady_clock::now() - start)
+			                   .count();
+
+			++frame;
+
+			// If the thread was delayed for more than a frame skip the lost frames
+			// (RTP timestamps keep matching the elapsed time).
+			if (static_cast<uint64_t>(elapsedMs) / FrameIntervalMs > frame)
+				frame = static_cast<uint64_t>(elapsedMs) / FrameIntervalMs;
+		}
+#endif
+	}
+
+#ifdef MS_AUDIO_MIXER
+	void AudioMixer::MixFrame(uint64_t frame)
+	{
+		size_t mixedSources{ 0u };
+
+		std::fill_n(this->mix, FrameSamples, 0);
+
+		for (auto& kv : this->mapSources)
+		{
+			auto* source = kv.second;
+
+			if (source->sampleCount < FrameSamples)
+				continue;
+
+			AccumulateFrame(this->mix, source->samples, FrameSamples);
+
+			source->sampleCount -= FrameSamples;
+
+			std::memmove(
+			  source->samples, source->samples + FrameSamples, source->sampleCount * sizeof(int16_t));
+
+			++mixedSources;
+		}
+
+		// Nothing is sent while nobody speaks.
+		if (mixedSources == 0u)
+		{
+			this->silence = true;
+
+			return;
+		}
+
+		ClampFrame(this->mix, this->mixedSamples, FrameSamples);
+
+		auto* item = this->outputQueue.Reserve();
+
+		// Loop thread is behind, so drop it.
+		if (!item)
+			return;
+
+		auto len = opus_encode(
+		  this->encoder,
+		  this->mixedSamples,
+		  static_cast<int>(FrameSamples),
+		  item->data,
+		  static_cast<opus_int32>(RTC::MtuSize));
+
+		if (len <= 0)
+			return;
+
+		item->frame  = frame;
+		item->marker = this->silence;
+		item->len    = static_cast<uint16_t>(len);
+
+		this->outputQueue.Commit();
+		this->silence = false;
+
+		uv_async_send(this->uvAsyncHandle);
+	}
+#endif
+
+	inline void AudioMixer::OnUvAsync()
+	{
+		MS_TRACE();
+
+		OutputItem* item;
+
+		while ((item = this->outputQueue.Front()))
+		{
+			auto timestamp = static_cast<uint32_t>(this->baseTimestamp + (item->frame * FrameSamples));
+
+			// Payload type and SSRC are set by the listener.
+			this->packetBuffer[0] = 0x80;
+			this->packetBuffer[1] = item->marker ? 0x80 : 0x00;
+			Utils::Byte::Set2Bytes(this->packetBuffer, 2, this->seq++);
+			Utils::Byte::Set4Bytes(this->packetBuffer, 4, timestamp);
+			Utils::Byte::Set4Bytes(this->packetBuffer, 8, 0u);
+			std::memcpy(this->packetBuffer + RtpHeaderSize, item->data, item->len);
+
+			auto* packet = RTC::RtpPacket::Parse(this->packetBuffer, RtpHeaderSize + item->len);
+
+			this->outputQueue.Pop();
+
+			if (!packet)
+				continue;
+
+			this->listener->OnAudioMixerRtpPacket(this, packet);
+
+			delete packet;
+		}
+	}
+} // namespace RTC
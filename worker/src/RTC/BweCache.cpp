@@ -0,0 +1,99 @@
+#define MS_CLASS "RTC::BweCache"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/BweCache.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+
+namespace RTC
+{
+	/* Class variables. */
+
+	thread_local absl::flat_hash_map<std::string, BweCache::Entry> BweCache::entries;
+
+	/* Class methods. */
+
+	std::string BweCache::GetKey(const struct sockaddr* addr)
+	{
+		MS_TRACE();
+
+		switch (addr->sa_family)
+		{
+			case AF_INET:
+			{
+				const auto* addrIn = reinterpret_cast<const struct sockaddr_in*>(addr);
+
+				return { reinterpret_cast<const char*>(std::addressof(addrIn->sin_addr)), 4u };
+			}
+
+			case AF_INET6:
+			{
+				const auto* addrIn6 = reinterpret_cast<const struct sockaddr_in6*>(addr);
+
+				// Just the /64 prefix.
+				return { reinterpret_cast<const char*>(std::addressof(addrIn6->sin6_addr)), 8u };
+			}
+
+			default:
+			{
+				return {};
+			}
+		}
+	}
+
+	void BweCache::Set(const std::string& key, uint32_t bitrate)
+	{
+		MS_TRACE();
+
+		auto nowMs = DepLibUV::GetTimeMs();
+
+		// clang-format off
+		if (
+			BweCache::entries.size() >= PruneThreshold &&
+			BweCache::entries.find(key) == BweCache::entries.end()
+		)
+		// clang-format on
+		{
+			Prune(nowMs);
+		}
+
+		auto& entry = BweCache::entries[key];
+
+		entry.bitrate     = bitrate;
+		entry.updatedAtMs = nowMs;
+	}
+
+	uint32_t BweCache::Get(const std::string& key)
+	{
+		MS_TRACE();
+
+		auto it = BweCache::entries.find(key);
+
+		if (it == BweCache::entries.end())
+			return 0u;
+
+		if (DepLibUV::GetTimeMs() - it->second.updatedAtMs > MaxAgeMs)
+		{
+			BweCache::entries.erase(it);
+
+			return 0u;
+		}
+
+		return it->second.bitrate;
+	}
+
+	void BweCache::Prune(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		for (auto it = BweCache::entries.begin(); it != BweCache::entries.end();)
+		{
+			if (nowMs - it->second.updatedAtMs > MaxAgeMs)
+				BweCache::entries.erase(it++);
+			else
+				++it;
+		}
+
+		MS_DEBUG_DEV("expired entries removed [entries:%zu]", BweCache::entries.size());
+	}
+} // namespace RTC
@@ -0,0 +1,476 @@
+#define MS_CLASS "RTC::Codecs::AV1"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/Codecs/AV1.hpp"
+#include "Logger.hpp"
+
+/* Static. */
+
+namespace
+{
+	// Reads the bit fields of the Dependency Descriptor.
+	class BitReader
+	{
+	public:
+		BitReader(const uint8_t* data, size_t len) : data(data), len(len)
+		{
+		}
+
+	public:
+		bool HasBits(size_t count) const
+		{
+			return this->offset + count <= this->len * 8;
+		}
+		// f(n) in the specification.
+		uint32_t Read(size_t count)
+		{
+			uint32_t value{ 0u };
+
+			for (size_t i{ 0u }; i < count; ++i, ++this->offset)
+			{
+				value = (value << 1) | ((this->data[this->offset / 8] >> (7 - this->offset % 8)) & 0x01);
+			}
+
+			return value;
+		}
+		void Skip(size_t count)
+		{
+			this->offset += count;
+		}
+
+	private:
+		const uint8_t* data;
+		size_t len;
+		size_t offset{ 0u };
+	};
+} // namespace
+
+namespace RTC
+{
+	namespace Codecs
+	{
+		/* Class methods. */
+
+		AV1::PayloadDescriptor* AV1::Parse(
+		  const uint8_t* data,
+		  size_t len,
+		  const uint8_t* dependencyDescriptor,
+		  uint8_t dependencyDescriptorLen,
+		  TemplateStructure* templateStructure)
+		{
+			MS_TRACE();
+
+			if (len < 1)
+				return nullptr;
+
+			std::unique_ptr<PayloadDescriptor> payloadDescriptor(new PayloadDescriptor());
+
+			// Read aggregation header.
+			uint8_t byte = data[0];
+
+			payloadDescriptor->z = (byte >> 7) & 0x01;
+			payloadDescriptor->y = (byte >> 6) & 0x01;
+			payloadDescriptor->n = (byte >> 3) & 0x01;
+
+			// A new coded video sequence starts with a key frame.
+			payloadDescriptor->isKeyFrame = payloadDescriptor->n && !payloadDescriptor->z;
+
+			payloadDescriptor->startOfFrame = 0;
+			payloadDescriptor->endOfFrame   = 0;
+
+			// Read dependency descriptor mandatory fields.
+			if (dependencyDescriptor && dependencyDescriptorLen >= 3)
+			{
+				payloadDescriptor->hasDependencyDescriptor = true;
+				payloadDescriptor->startOfFrame            = (dependencyDescriptor[0] >> 7) & 0x01;
+				payloadDescriptor->endOfFrame              = (dependencyDescriptor[0] >> 6) & 0x01;
+				payloadDescriptor->templateId              = dependencyDescriptor[0] & 0x3F;
+				payloadDescriptor->frameNumber =
+				  (uint16_t{ dependencyDescriptor[1] } << 8) | dependencyDescriptor[2];
+
+				if (templateStructure)
+				{
+					// A template dependency structure is present. Parse it just once
+					// (it may be repeated in every packet of the key frame).
+					// clang-format off
+					if (
+						dependencyDescriptorLen > 3 &&
+						(dependencyDescriptor[3] & 0x80) &&
+						(
+							!templateStructure->present ||
+							templateStructure->frameNumber != payloadDescriptor->frameNumber
+						)
+					)
+					// clang-format on
+					{
+						TemplateStructure newTemplateStructure;
+
+						if (AV1::ParseTemplateStructure(
+						      dependencyDescriptor, dependencyDescriptorLen, &newTemplateStructure))
+						{
+							*templateStructure = newTemplateStructure;
+						}
+						else
+						{
+							MS_WARN_DEV("invalid template dependency structure");
+						}
+					}
+
+					if (templateStructure->present)
+					{
+						size_t templateIndex =
+						  (payloadDescriptor->templateId + MaxTemplates - templateStructure->templateIdOffset) %
+						  MaxTemplates;
+
+						if (templateIndex < templateStructure->templateCount)
+						{
+							payloadDescriptor->hasLayers     = true;
+							payloadDescriptor->spatialLayer  = templateStructure->spatialIds[templateIndex];
+							payloadDescriptor->temporalLayer = templateStructure->temporalIds[templateIndex];
+						}
+					}
+				}
+			}
+
+			return payloadDescriptor.release();
+		}
+
+		bool AV1::ParseTemplateStructure(
+		  const uint8_t* data, size_t len, TemplateStructure* templateStructure)
+		{
+			MS_TRACE();
+
+			BitReader reader(data, len);
+
+			// Mandatory fields and extended descriptor flags.
+			if (!reader.HasBits(24 + 5 + 6 + 5))
+				return false;
+
+			reader.Skip(24);
+
+			// template_dependency_structure_present_flag.
+			if (reader.Read(1) == 0u)
+				return false;
+
+			// Other extended descriptor flags.
+			reader.Skip(4);
+
+			templateStructure->frameNumber      = (uint16_t{ data[1] } << 8) | data[2];
+			templateStructure->templateIdOffset = reader.Read(6);
+
+			// dt_cnt_minus_one. Decode targets are not needed.
+			reader.Skip(5);
+
+			// template_layers().
+			uint8_t spatialId{ 0u };
+			uint8_t temporalId{ 0u };
+			uint8_t templateCount{ 0u };
+			uint32_t nextLayerIdc;
+
+			templateStructure->maxTemporalId = 0u;
+
+			do
+			{
+				if (templateCount == MaxTemplates || !reader.HasBits(2))
+					return false;
+
+				templateStructure->spatialIds[templateCount]  = spatialId;
+				templateStructure->temporalIds[templateCount] = temporalId;
+				++templateCount;
+
+				nextLayerIdc = reader.Read(2);
+
+				// Next template has the next temporal layer.
+				if (nextLayerIdc == 1u)
+				{
+					++temporalId;
+
+					if (temporalId > templateStructure->maxTemporalId)
+						templateStructure->maxTemporalId = temporalId;
+				}
+				// Next template has the next spatial layer.
+				else if (nextLayerIdc == 2u)
+				{
+					temporalId = 0u;
+					++spatialId;
+				}
+			} while (nextLayerIdc != 3u);
+
+			templateStructure->templateCount = templateCount;
+			templateStructure->maxSpatialId  = spatialId;
+			templateStructure->present       = true;
+
+			return true;
+		}
+
+		void AV1::ProcessRtpPacket(RTC::RtpPacket* packet, TemplateStructure* templateStructure)
+		{
+			MS_TRACE();
+
+			auto* data = packet->GetPayload();
+			auto len   = packet->GetPayloadLength();
+			const uint8_t* dependencyDescriptor{ nullptr };
+			uint8_t dependencyDescriptorLen{ 0 };
+
+			// Read dependency descriptor.
+			packet->ReadDependencyDescriptor(&dependencyDescriptor, dependencyDescriptorLen);
+
+			PayloadDescriptor* payloadDescriptor =
+			  AV1::Parse(data, len, dependencyDescriptor, dependencyDescriptorLen, templateStructure);
+
+			if (!payloadDescriptor)
+				return;
+
+			auto* payloadDescriptorHandler = new PayloadDescriptorHandler(payloadDescriptor);
+
+			packet->SetPayloadDescriptorHandler(payloadDescriptorHandler);
+		}
+
+		/* Instance methods. */
+
+		void AV1::TemplateStructure::Dump() const
+		{
+			MS_TRACE();
+
+			MS_DUMP("<TemplateStructure>");
+			MS_DUMP("  present          : %s", this->present ? "true" : "false");
+			MS_DUMP("  frameNumber      : %" PRIu16, this->frameNumber);
+			MS_DUMP("  templateIdOffset : %" PRIu8, this->templateIdOffset);
+			MS_DUMP("  templateCount    : %" PRIu8, this->templateCount);
+			MS_DUMP("  maxSpatialId     : %" PRIu8, this->maxSpatialId);
+			MS_DUMP("  maxTemporalId    : %" PRIu8, this->maxTemporalId);
+			MS_DUMP("</TemplateStructure>");
+		}
+
+		void AV1::PayloadDescriptor::Dump() const
+		{
+			MS_TRACE();
+
+			MS_DUMP("<PayloadDescriptor>");
+			MS_DUMP(
+			  "  z|y|n                   : %" PRIu8 "|%" PRIu8 "|%" PRIu8, this->z, this->y, this->n);
+			MS_DUMP(
+			  "  hasDependencyDescriptor : %s", this->hasDependencyDescriptor ? "true" : "false");
+			if (this->hasDependencyDescriptor)
+			{
+				MS_DUMP(
+				  "  s|e                     : %" PRIu8 "|%" PRIu8, this->startOfFrame, this->endOfFrame);
+				MS_DUMP("  templateId              : %" PRIu8, this->templateId);
+				MS_DUMP("  frameNumber             : %" PRIu16, this->frameNumber);
+			}
+			MS_DUMP("  hasLayers               : %s", this->hasLayers ? "true" : "false");
+			MS_DUMP("  spatialLayer            : %" PRIu8, this->spatialLayer);
+			MS_DUMP("  temporalLayer           : %" PRIu8, this->temporalLayer);
+			MS_DUMP("  isKeyFrame              : %s", this->isKeyFrame ? "true" : "false");
+			MS_DUMP("</PayloadDescriptor>");
+		}
+
+		AV1::PayloadDescriptorHandler::PayloadDescriptorHandler(
+		  AV1::PayloadDescriptor* payloadDescriptor)
+		{
+			MS_TRACE();
+
+			this->payloadDescriptor.reset(payloadDescriptor);
+		}
+
+		bool AV1::PayloadDescriptorHandler::Process(
+		  RTC::Codecs::EncodingContext* encodingContext, uint8_t* /*data*/, bool& marker)
+		{
+			MS_TRACE();
+
+			auto* context = static_cast<RTC::Codecs::AV1::EncodingContext*>(encodingContext);
+
+			MS_ASSERT(context->GetTargetTemporalLayer() >= 0, "target temporal layer cannot be -1");
+
+			// Without layer info the packet cannot be filtered. That happens if the
+			// template dependency structure has not been received yet.
+			if (!this->payloadDescriptor->hasLayers)
+			{
+				// clang-format off
+				if (
+					context->GetSpatialLayers() > 1 ||
+					context->GetTemporalLayers() > 1
+				)
+				// clang-format on
+				{
+					MS_WARN_DEV("layered stream but unknown packet layers, packet dropped");
+
+					return false;
+				}
+
+				return true;
+			}
+
+			auto packetSpatialLayer  = GetSpatialLayer();
+			auto packetTemporalLayer = GetTemporalLayer();
+			auto tmpSpatialLayer     = context->GetCurrentSpatialLayer();
+			auto tmpTemporalLayer    = context->GetCurrentTemporalLayer();
+
+			// If packet spatial or temporal layer is higher than maximum announced
+			// one, drop the packet.
+			// clang-format off
+			if (
+				packetSpatialLayer >= context->GetSpatialLayers() ||
+				packetTemporalLayer >= context->GetTemporalLayers()
+			)
+			// clang-format on
+			{
+				MS_WARN_TAG(
+				  rtp, "too high packet layers %" PRIu8 ":%" PRIu8, packetSpatialLayer, packetTemporalLayer);
+
+				return false;
+			}
+
+			// Spatial layers are just handled in SVC (in simulcast every stream has a
+			// single spatial layer and the target one is -1).
+			if (context->GetTargetSpatialLayer() >= 0)
+			{
+				// Upgrade current spatial layer if needed.
+				if (context->GetTargetSpatialLayer() > context->GetCurrentSpatialLayer())
+				{
+					if (this->payloadDescriptor->isKeyFrame)
+					{
+						MS_DEBUG_DEV(
+						  "upgrading tmpSpatialLayer from %" PRIu16 " to %" PRIu16 " (packet:%" PRIu8
+						  ":%" PRIu8 ")",
+						  context->GetCurrentSpatialLayer(),
+						  context->GetTargetSpatialLayer(),
+						  packetSpatialLayer,
+						  packetTemporalLayer);
+
+						tmpSpatialLayer  = context->GetTargetSpatialLayer();
+						tmpTemporalLayer = 0; // Just in case.
+					}
+				}
+				// Downgrade current spatial layer if needed.
+				else if (context->GetTargetSpatialLayer() < context->GetCurrentSpatialLayer())
+				{
+					// In K-SVC we must wait for a keyframe.
+					if (context->IsKSvc())
+					{
+						if (this->payloadDescriptor->isKeyFrame)
+						{
+							MS_DEBUG_DEV(
+							  "downgrading tmpSpatialLayer from %" PRIu16 " to %" PRIu16 " (packet:%" PRIu8
+							  ":%" PRIu8 ") after keyframe (K-SVC)",
+							  context->GetCurrentSpatialLayer(),
+							  context->GetTargetSpatialLayer(),
+							  packetSpatialLayer,
+							  packetTemporalLayer);
+
+							tmpSpatialLayer  = context->GetTargetSpatialLayer();
+							tmpTemporalLayer = 0; // Just in case.
+						}
+					}
+					// In full SVC we do not need a keyframe.
+					else
+					{
+						// clang-format off
+						if (
+							packetSpatialLayer == context->GetTargetSpatialLayer() &&
+							this->payloadDescriptor->endOfFrame
+						)
+						// clang-format on
+						{
+							MS_DEBUG_DEV(
+							  "downgrading tmpSpatialLayer from %" PRIu16 " to %" PRIu16 " (packet:%" PRIu8
+							  ":%" PRIu8 ") without keyframe (full SVC)",
+							  context->GetCurrentSpatialLayer(),
+							  context->GetTargetSpatialLayer(),
+							  packetSpatialLayer,
+							  packetTemporalLayer);
+
+							tmpSpatialLayer  = context->GetTargetSpatialLayer();
+							tmpTemporalLayer = 0; // Just in case.
+						}
+					}
+				}
+
+				// Filter spatial layers higher than current one.
+				if (packetSpatialLayer > tmpSpatialLayer)
+					return false;
+			}
+
+			// Upgrade current temporal layer if needed.
+			if (context->GetTargetTemporalLayer() > context->GetCurrentTemporalLayer())
+			{
+				// clang-format off
+				if (
+					packetTemporalLayer >= context->GetCurrentTemporalLayer() + 1 &&
+					this->payloadDescriptor->startOfFrame
+				)
+				// clang-format on
+				{
+					MS_DEBUG_DEV(
+					  "upgrading tmpTemporalLayer from %" PRIu16 " to %" PRIu8 " (packet:%" PRIu8 ":%" PRIu8
+					  ")",
+					  context->GetCurrentTemporalLayer(),
+					  packetTemporalLayer,
+					  packetSpatialLayer,
+					  packetTemporalLayer);
+
+					tmpTemporalLayer = packetTemporalLayer;
+				}
+			}
+			// Downgrade current temporal layer if needed.
+			else if (context->GetTargetTemporalLayer() < context->GetCurrentTemporalLayer())
+			{
+				// clang-format off
+				if (
+					packetTemporalLayer == context->GetTargetTemporalLayer() &&
+					this->payloadDescriptor->endOfFrame
+				)
+				// clang-format on
+				{
+					MS_DEBUG_DEV(
+					  "downgrading tmpTemporalLayer from %" PRIu16 " to %" PRIu16 " (packet:%" PRIu8
+					  ":%" PRIu8 ")",
+					  context->GetCurrentTemporalLayer(),
+					  context->GetTargetTemporalLayer(),
+					  packetSpatialLayer,
+					  packetTemporalLayer);
+
+					tmpTemporalLayer = context->GetTargetTemporalLayer();
+				}
+			}
+
+			// Filter temporal layers higher than current one.
+			if (packetTemporalLayer > tmpTemporalLayer)
+				return false;
+
+			// Set marker bit if needed.
+			// clang-format off
+			if (
+				context->GetTargetSpatialLayer() >= 0 &&
+				packetSpatialLayer == tmpSpatialLayer &&
+				this->payloadDescriptor->endOfFrame
+			)
+			// clang-format on
+			{
+				marker = true;
+			}
+
+			// Update current spatial layer if needed.
+			// clang-format off
+			if (
+				context->GetTargetSpatialLayer() >= 0 &&
+				tmpSpatialLayer != context->GetCurrentSpatialLayer()
+			)
+			// clang-format on
+			{
+				context->SetCurrentSpatialLayer(tmpSpatialLayer);
+			}
+
+			// Update current temporal layer if needed.
+			if (tmpTemporalLayer != context->GetCurrentTemporalLayer())
+				context->SetCurrentTemporalLayer(tmpTemporalLayer);
+
+			return true;
+		}
+
+		void AV1::PayloadDescriptorHandler::Restore(uint8_t* /*data*/)
+		{
+			MS_TRACE();
+		}
+	} // namespace Codecs
+} // namespace RTC
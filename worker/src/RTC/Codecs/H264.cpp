@@ -3,6 +3,7 @@
 
 #include "RTC/Codecs/H264.hpp"
 #include "Logger.hpp"
+#include "Settings.hpp"
 #include "Utils.hpp"
 
 namespace RTC
@@ -56,8 +57,14 @@ namespace RTC
 			//   https://bugs.chromium.org/p/webrtc/issues/detail?id=10746
 			//
 			// As a temporal workaround, always do payload parsing to detect keyframes if
-			// there is no frame-marking or if there is but keyframe was not detected above.
-			if (!frameMarking || !payloadDescriptor->isKeyFrame)
+			// there is no frame-marking or if there is but keyframe was not detected above
+			// (unless frame-marking is trusted).
+			// clang-format off
+			if (
+				!frameMarking ||
+				(!payloadDescriptor->isKeyFrame && !Settings::configuration.trustFrameMarking)
+			)
+			// clang-format on
 			{
 				uint8_t nal = *data & 0x1F;
 
@@ -145,6 +152,34 @@ namespace RTC
 			packet->SetPayloadDescriptorHandler(payloadDescriptorHandler);
 		}
 
+		bool H264::ProcessPayload(
+		  RTC::RtpPacket* packet, RTC::Codecs::EncodingContext* encodingContext, bool& marker)
+		{
+			MS_TRACE();
+
+			// NOTE: The packet was processed by ProcessRtpPacket() of this codec.
+			auto* payloadDescriptorHandler =
+			  static_cast<PayloadDescriptorHandler*>(packet->GetPayloadDescriptorHandler());
+
+			if (!payloadDescriptorHandler)
+				return true;
+
+			return payloadDescriptorHandler->Process(encodingContext, packet->GetPayload(), marker);
+		}
+
+		void H264::RestorePayload(RTC::RtpPacket* packet)
+		{
+			MS_TRACE();
+
+			auto* payloadDescriptorHandler =
+			  static_cast<PayloadDescriptorHandler*>(packet->GetPayloadDescriptorHandler());
+
+			if (!payloadDescriptorHandler)
+				return;
+
+			payloadDescriptorHandler->Restore(packet->GetPayload());
+		}
+
 		/* Instance methods. */
 
 		void H264::PayloadDescriptor::Dump() const
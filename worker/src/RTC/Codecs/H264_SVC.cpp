@@ -2,6 +2,7 @@
 
 #include "RTC/Codecs/H264_SVC.hpp"
 #include "Logger.hpp"
+#include "Settings.hpp"
 #include "Utils.hpp"
 
 namespace RTC
@@ -55,8 +56,14 @@ namespace RTC
 			//   https://bugs.chromium.org/p/webrtc/issues/detail?id=10746
 			//
 			// As a temporal workaround, always do payload parsing to detect keyframes if
-			// there is no frame-marking or if there is but keyframe was not detected above.
-			if (!frameMarking || !payloadDescriptor->isKeyFrame)
+			// there is no frame-marking or if there is but keyframe was not detected above
+			// (unless frame-marking is trusted).
+			// clang-format off
+			if (
+				!frameMarking ||
+				(!payloadDescriptor->isKeyFrame && !Settings::configuration.trustFrameMarking)
+			)
+			// clang-format on
 			{
 				uint8_t nal = *data & 0x1F;
 
@@ -0,0 +1,314 @@
+#define MS_CLASS "RTC::Codecs::H265"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/Codecs/H265.hpp"
+#include "Logger.hpp"
+#include "Settings.hpp"
+#include "Utils.hpp"
+
+namespace RTC
+{
+	namespace Codecs
+	{
+		/* Static. */
+
+		// NAL unit types (RFC 7798 and ITU-T H.265 table 7-1).
+		static constexpr uint8_t NalUnitTypeTsaN{ 2u };
+		static constexpr uint8_t NalUnitTypeStsaR{ 5u };
+		static constexpr uint8_t NalUnitTypeBlaWLp{ 16u };
+		static constexpr uint8_t NalUnitTypeCraNut{ 21u };
+		static constexpr uint8_t NalUnitTypeAp{ 48u };
+		static constexpr uint8_t NalUnitTypeFu{ 49u };
+
+		// Intra random access point (BLA, IDR and CRA) pictures.
+		static inline bool IsIrap(uint8_t nalUnitType)
+		{
+			return nalUnitType >= NalUnitTypeBlaWLp && nalUnitType <= NalUnitTypeCraNut;
+		}
+
+		// Temporal sub-layer access (TSA and STSA) pictures, from which higher
+		// temporal layers can be decoded.
+		static inline bool IsTemporalSwitchingPoint(uint8_t nalUnitType)
+		{
+			return nalUnitType >= NalUnitTypeTsaN && nalUnitType <= NalUnitTypeStsaR;
+		}
+
+		static inline uint8_t GetNalUnitType(const uint8_t* data)
+		{
+			return (data[0] >> 1) & 0x3F;
+		}
+
+		/* Class methods. */
+
+		H265::PayloadDescriptor* H265::Parse(
+		  const uint8_t* data, size_t len, RTC::RtpPacket::FrameMarking* frameMarking, uint8_t frameMarkingLen)
+		{
+			MS_TRACE();
+
+			// Payload header (2 bytes) and something else.
+			if (len < 3)
+				return nullptr;
+
+			const uint8_t tidPlusOne = data[1] & 0x07;
+
+			// TID 0 is forbidden.
+			if (tidPlusOne == 0)
+				return nullptr;
+
+			std::unique_ptr<PayloadDescriptor> payloadDescriptor(new PayloadDescriptor());
+
+			payloadDescriptor->nalUnitType = GetNalUnitType(data);
+
+			// Use frame-marking.
+			if (frameMarking)
+			{
+				// Read fields.
+				payloadDescriptor->s   = frameMarking->start;
+				payloadDescriptor->e   = frameMarking->end;
+				payloadDescriptor->i   = frameMarking->independent;
+				payloadDescriptor->d   = frameMarking->discardable;
+				payloadDescriptor->b   = frameMarking->base;
+				payloadDescriptor->tid = frameMarking->tid;
+
+				payloadDescriptor->hasTid = true;
+
+				if (frameMarkingLen >= 2)
+				{
+					payloadDescriptor->hasLid = true;
+					payloadDescriptor->lid    = frameMarking->lid;
+				}
+
+				if (frameMarkingLen == 3)
+				{
+					payloadDescriptor->hasTl0picidx = true;
+					payloadDescriptor->tl0picidx    = frameMarking->tl0picidx;
+				}
+
+				// Detect key frame.
+				if (frameMarking->start && frameMarking->independent)
+					payloadDescriptor->isKeyFrame = true;
+			}
+			// Otherwise the payload header carries the TID of the NAL unit (or the
+			// lowest one of the aggregated NAL units).
+			else
+			{
+				payloadDescriptor->tid    = tidPlusOne - 1;
+				payloadDescriptor->hasTid = true;
+			}
+
+			// Inspect the payload to detect key frames if there is no frame-marking
+			// or if there is but keyframe was not detected above (unless
+			// frame-marking is trusted). See the same workaround in H264.
+			// clang-format off
+			if (
+				!frameMarking ||
+				(!payloadDescriptor->isKeyFrame && !Settings::configuration.trustFrameMarking)
+			)
+			// clang-format on
+			{
+				// Whether the packet starts a NAL unit (just false for non first
+				// fragments).
+				bool startsNalUnit{ true };
+
+				switch (payloadDescriptor->nalUnitType)
+				{
+					// Aggregation packet.
+					// NOTE: DONL fields are not expected since they are just present if
+					// sprop-max-don-diff is greater than 0, which WebRTC never signals.
+					case NalUnitTypeAp:
+					{
+						size_t offset{ 2 };
+
+						// Iterate NAL units.
+						while (offset + 4 <= len)
+						{
+							auto naluSize = Utils::Byte::Get2Bytes(data, offset);
+
+							// Check if there is room for the indicated NAL unit size.
+							if (naluSize < 2 || offset + 2 + naluSize > len)
+								break;
+
+							const uint8_t subNalUnitType = GetNalUnitType(data + offset + 2);
+
+							if (IsIrap(subNalUnitType))
+							{
+								payloadDescriptor->nalUnitType = subNalUnitType;
+								payloadDescriptor->isKeyFrame  = true;
+
+								break;
+							}
+
+							offset += 2 + naluSize;
+						}
+
+						break;
+					}
+
+					// Fragmentation unit.
+					case NalUnitTypeFu:
+					{
+						const uint8_t fuHeader = data[2];
+
+						payloadDescriptor->nalUnitType = fuHeader & 0x3F;
+						startsNalUnit                  = (fuHeader & 0x80) != 0;
+
+						if (startsNalUnit && IsIrap(payloadDescriptor->nalUnitType))
+							payloadDescriptor->isKeyFrame = true;
+
+						break;
+					}
+
+					// Single NAL unit packet.
+					default:
+					{
+						if (IsIrap(payloadDescriptor->nalUnitType))
+							payloadDescriptor->isKeyFrame = true;
+
+						break;
+					}
+				}
+
+				// Without frame-marking, switching up to the temporal layer of this
+				// packet is possible if it starts an IRAP, TSA or STSA NAL unit.
+				// clang-format off
+				if (
+					!frameMarking &&
+					startsNalUnit &&
+					(
+						IsIrap(payloadDescriptor->nalUnitType) ||
+						IsTemporalSwitchingPoint(payloadDescriptor->nalUnitType) ||
+						payloadDescriptor->tid == 0
+					)
+				)
+				// clang-format on
+				{
+					payloadDescriptor->b = 1;
+				}
+			}
+
+			return payloadDescriptor.release();
+		}
+
+		void H265::ProcessRtpPacket(RTC::RtpPacket* packet)
+		{
+			MS_TRACE();
+
+			auto* data = packet->GetPayload();
+			auto len   = packet->GetPayloadLength();
+			RtpPacket::FrameMarking* frameMarking{ nullptr };
+			uint8_t frameMarkingLen{ 0 };
+
+			// Read frame-marking.
+			packet->ReadFrameMarking(&frameMarking, frameMarkingLen);
+
+			PayloadDescriptor* payloadDescriptor = H265::Parse(data, len, frameMarking, frameMarkingLen);
+
+			if (!payloadDescriptor)
+				return;
+
+			auto* payloadDescriptorHandler = new PayloadDescriptorHandler(payloadDescriptor);
+
+			packet->SetPayloadDescriptorHandler(payloadDescriptorHandler);
+		}
+
+		bool H265::ProcessPayload(
+		  RTC::RtpPacket* packet, RTC::Codecs::EncodingContext* encodingContext, bool& marker)
+		{
+			MS_TRACE();
+
+			// NOTE: The packet was processed by ProcessRtpPacket() of this codec.
+			auto* payloadDescriptorHandler =
+			  static_cast<PayloadDescriptorHandler*>(packet->GetPayloadDescriptorHandler());
+
+			if (!payloadDescriptorHandler)
+				return true;
+
+			return payloadDescriptorHandler->Process(encodingContext, packet->GetPayload(), marker);
+		}
+
+		void H265::RestorePayload(RTC::RtpPacket* packet)
+		{
+			MS_TRACE();
+
+			auto* payloadDescriptorHandler =
+			  static_cast<PayloadDescriptorHandler*>(packet->GetPayloadDescriptorHandler());
+
+			if (!payloadDescriptorHandler)
+				return;
+
+			payloadDescriptorHandler->Restore(packet->GetPayload());
+		}
+
+		/* Instance methods. */
+
+		void H265::PayloadDescriptor::Dump() const
+		{
+			MS_TRACE();
+
+			MS_DUMP("<PayloadDescriptor>");
+			MS_DUMP(
+			  "  s:%" PRIu8 "|e:%" PRIu8 "|i:%" PRIu8 "|d:%" PRIu8 "|b:%" PRIu8,
+			  this->s,
+			  this->e,
+			  this->i,
+			  this->d,
+			  this->b);
+			MS_DUMP("  nalUnitType: %" PRIu8, this->nalUnitType);
+			if (this->hasTid)
+				MS_DUMP("  tid        : %" PRIu8, this->tid);
+			if (this->hasLid)
+				MS_DUMP("  lid        : %" PRIu8, this->lid);
+			if (this->hasTl0picidx)
+				MS_DUMP("  tl0picidx  : %" PRIu8, this->tl0picidx);
+			MS_DUMP("  isKeyFrame : %s", this->isKeyFrame ? "true" : "false");
+			MS_DUMP("</PayloadDescriptor>");
+		}
+
+		H265::PayloadDescriptorHandler::PayloadDescriptorHandler(H265::PayloadDescriptor* payloadDescriptor)
+		{
+			MS_TRACE();
+
+			this->payloadDescriptor.reset(payloadDescriptor);
+		}
+
+		bool H265::PayloadDescriptorHandler::Process(
+		  RTC::Codecs::EncodingContext* encodingContext, uint8_t* /*data*/, bool& /*marker*/)
+		{
+			MS_TRACE();
+
+			auto* context = static_cast<RTC::Codecs::H265::EncodingContext*>(encodingContext);
+
+			MS_ASSERT(context->GetTargetTemporalLayer() >= 0, "target temporal layer cannot be -1");
+
+			// Drop packets of temporal layers above the target one.
+			if (this->payloadDescriptor->tid > context->GetTargetTemporalLayer())
+			{
+				return false;
+			}
+			// Upgrade required. Drop current packet if it is not a switching point.
+			// clang-format off
+			else if (
+				this->payloadDescriptor->tid > context->GetCurrentTemporalLayer() &&
+				!this->payloadDescriptor->b
+			)
+			// clang-format on
+			{
+				return false;
+			}
+
+			// Update/fix current temporal layer.
+			if (this->payloadDescriptor->tid > context->GetCurrentTemporalLayer())
+				context->SetCurrentTemporalLayer(this->payloadDescriptor->tid);
+
+			if (context->GetCurrentTemporalLayer() > context->GetTargetTemporalLayer())
+				context->SetCurrentTemporalLayer(context->GetTargetTemporalLayer());
+
+			return true;
+		}
+
+		void H265::PayloadDescriptorHandler::Restore(uint8_t* /*data*/)
+		{
+			MS_TRACE();
+		}
+	} // namespace Codecs
+} // namespace RTC
@@ -0,0 +1,26 @@
+#define MS_CLASS "RTC::Codecs::Opus"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/Codecs/Opus.hpp"
+#include "Logger.hpp"
+
+namespace RTC
+{
+	namespace Codecs
+	{
+		/* Static. */
+
+		// Same as libwebrtc, which considers Opus packets with 2 bytes or less as
+		// DTX.
+		static constexpr size_t MaxDtxPayloadLength{ 2u };
+
+		/* Class methods. */
+
+		bool Opus::IsDtx(const RTC::RtpPacket* packet)
+		{
+			MS_TRACE();
+
+			return packet->GetPayloadLength() <= MaxDtxPayloadLength;
+		}
+	} // namespace Codecs
+} // namespace RTC
@@ -3,7 +3,6 @@
 
 #include "RTC/Codecs/VP8.hpp"
 #include "Logger.hpp"
-#include <cstring> // std::memcpy()
 
 namespace RTC
 {
@@ -56,6 +55,8 @@ namespace RTC
 
 				byte = data[offset];
 
+				payloadDescriptor->pictureIdOffset = offset;
+
 				if ((byte >> 7) & 0x01)
 				{
 					if (len < ++offset + 1)
@@ -79,8 +80,9 @@ namespace RTC
 				if (len < ++offset + 1)
 					return nullptr;
 
-				payloadDescriptor->hasTl0PictureIndex = true;
-				payloadDescriptor->tl0PictureIndex    = data[offset];
+				payloadDescriptor->hasTl0PictureIndex    = true;
+				payloadDescriptor->tl0PictureIndex       = data[offset];
+				payloadDescriptor->tl0PictureIndexOffset = offset;
 			}
 
 			if (payloadDescriptor->t || payloadDescriptor->k)
@@ -144,9 +146,40 @@ namespace RTC
 				// Update the payloadDescriptor.
 				payloadDescriptor->hasOneBytePictureId  = false;
 				payloadDescriptor->hasTwoBytesPictureId = true;
+
+				if (payloadDescriptor->hasTl0PictureIndex)
+					++payloadDescriptor->tl0PictureIndexOffset;
 			}
 		}
 
+		bool VP8::ProcessPayload(
+		  RTC::RtpPacket* packet, RTC::Codecs::EncodingContext* encodingContext, bool& marker)
+		{
+			MS_TRACE();
+
+			// NOTE: The packet was processed by ProcessRtpPacket() of this codec.
+			auto* payloadDescriptorHandler =
+			  static_cast<PayloadDescriptorHandler*>(packet->GetPayloadDescriptorHandler());
+
+			if (!payloadDescriptorHandler)
+				return true;
+
+			return payloadDescriptorHandler->Process(encodingContext, packet->GetPayload(), marker);
+		}
+
+		void VP8::RestorePayload(RTC::RtpPacket* packet)
+		{
+			MS_TRACE();
+
+			auto* payloadDescriptorHandler =
+			  static_cast<PayloadDescriptorHandler*>(packet->GetPayloadDescriptorHandler());
+
+			if (!payloadDescriptorHandler)
+				return;
+
+			payloadDescriptorHandler->Restore(packet->GetPayload());
+		}
+
 		/* Instance methods. */
 
 		void VP8::PayloadDescriptor::Dump() const
@@ -178,34 +211,21 @@ namespace RTC
 		{
 			MS_TRACE();
 
-			// Nothing to do.
-			if (!this->extended)
-				return;
-
-			data += 2;
-
-			if (this->i)
+			if (this->hasTwoBytesPictureId)
 			{
-				if (this->hasTwoBytesPictureId)
-				{
-					uint16_t netPictureId = htons(pictureId);
-
-					std::memcpy(data, &netPictureId, 2);
-					data[0] |= 0x80;
-					data += 2;
-				}
-				else if (this->hasOneBytePictureId)
-				{
-					*data = pictureId;
-					data++;
+				data[this->pictureIdOffset]     = 0x80 | static_cast<uint8_t>(pictureId >> 8);
+				data[this->pictureIdOffset + 1] = static_cast<uint8_t>(pictureId);
+			}
+			else if (this->hasOneBytePictureId)
+			{
+				data[this->pictureIdOffset] = static_cast<uint8_t>(pictureId);
 
-					if (pictureId > 127)
-						MS_DEBUG_TAG(rtp, "casting pictureId value to one byte");
-				}
+				if (pictureId > 127)
+					MS_DEBUG_TAG(rtp, "casting pictureId value to one byte");
 			}
 
-			if (this->l)
-				*data = tl0PictureIndex;
+			if (this->hasTl0PictureIndex)
+				data[this->tl0PictureIndexOffset] = tl0PictureIndex;
 		}
 
 		void VP8::PayloadDescriptor::Restore(uint8_t* data) const
@@ -339,14 +359,22 @@ namespace RTC
 			if (context->GetCurrentTemporalLayer() > context->GetTargetTemporalLayer())
 				context->SetCurrentTemporalLayer(context->GetTargetTemporalLayer());
 
+			// Rewrite the payload unless the values do not change (so there is
+			// nothing to restore either).
 			// clang-format off
 			if (
 				this->payloadDescriptor->hasPictureId &&
-				this->payloadDescriptor->hasTl0PictureIndex
+				this->payloadDescriptor->hasTl0PictureIndex &&
+				(
+					pictureId != this->payloadDescriptor->pictureId ||
+					tl0PictureIndex != this->payloadDescriptor->tl0PictureIndex
+				)
 			)
 			// clang-format on
 			{
 				this->payloadDescriptor->Encode(data, pictureId, tl0PictureIndex);
+
+				this->encoded = true;
 			}
 
 			return true;
@@ -356,14 +384,11 @@ namespace RTC
 		{
 			MS_TRACE();
 
-			// clang-format off
-			if (
-				this->payloadDescriptor->hasPictureId &&
-				this->payloadDescriptor->hasTl0PictureIndex
-			)
-			// clang-format on
+			if (this->encoded)
 			{
 				this->payloadDescriptor->Restore(data);
+
+				this->encoded = false;
 			}
 		}
 	} // namespace Codecs
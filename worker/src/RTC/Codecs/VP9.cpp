@@ -128,6 +128,34 @@ namespace RTC
 			packet->SetPayloadDescriptorHandler(payloadDescriptorHandler);
 		}
 
+		bool VP9::ProcessPayload(
+		  RTC::RtpPacket* packet, RTC::Codecs::EncodingContext* encodingContext, bool& marker)
+		{
+			MS_TRACE();
+
+			// NOTE: The packet was processed by ProcessRtpPacket() of this codec.
+			auto* payloadDescriptorHandler =
+			  static_cast<PayloadDescriptorHandler*>(packet->GetPayloadDescriptorHandler());
+
+			if (!payloadDescriptorHandler)
+				return true;
+
+			return payloadDescriptorHandler->Process(encodingContext, packet->GetPayload(), marker);
+		}
+
+		void VP9::RestorePayload(RTC::RtpPacket* packet)
+		{
+			MS_TRACE();
+
+			auto* payloadDescriptorHandler =
+			  static_cast<PayloadDescriptorHandler*>(packet->GetPayloadDescriptorHandler());
+
+			if (!payloadDescriptorHandler)
+				return;
+
+			payloadDescriptorHandler->Restore(packet->GetPayload());
+		}
+
 		/* Instance methods. */
 
 		void VP9::PayloadDescriptor::Dump() const
@@ -235,6 +263,31 @@ namespace RTC
 					tmpSpatialLayer  = context->GetTargetSpatialLayer();
 					tmpTemporalLayer = 0; // Just in case.
 				}
+				// Otherwise move to the next spatial layer on a switch point: the
+				// start of a layer frame that is not predicted from previous pictures
+				// but just from the lower layer frame (already sent) of this picture.
+				// clang-format off
+				else if (
+					!isOldPacket &&
+					context->GetCurrentSpatialLayer() >= 0 &&
+					packetSpatialLayer == context->GetCurrentSpatialLayer() + 1 &&
+					packetTemporalLayer == 0 &&
+					this->payloadDescriptor->hasSlIndex &&
+					this->payloadDescriptor->b &&
+					!this->payloadDescriptor->p &&
+					this->payloadDescriptor->interLayerDependency
+				)
+				// clang-format on
+				{
+					MS_DEBUG_DEV(
+					  "upgrading tmpSpatialLayer from %" PRIu16 " to %" PRIu8 " (packet:%" PRIu8 ":%" PRIu8
+					  ") without keyframe",
+					  context->GetCurrentSpatialLayer(),
+					  packetSpatialLayer,
+					  packetTemporalLayer);
+
+					tmpSpatialLayer = packetSpatialLayer;
+				}
 			}
 			// Downgrade current spatial layer if needed.
 			else if (context->GetTargetSpatialLayer() < context->GetCurrentSpatialLayer())
@@ -5,12 +5,69 @@
 #include "DepLibUV.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Metrics.hpp"
+#include "Utils.hpp"
 #include "Channel/ChannelNotifier.hpp"
+#include "RTC/JoinLatency.hpp"
+#include <absl/container/flat_hash_map.h>
 #include <iterator> // std::ostream_iterator
 #include <sstream>  // std::ostringstream
 
 namespace RTC
 {
+	/* Static. */
+
+	// Max packets stored for retransmission by each RTP stream while under
+	// memory pressure.
+	static constexpr size_t MemoryPressureStorageLimit{ 100u };
+	// Consumable RTP encodings (the same for every Consumer of a Producer)
+	// shared by Consumers, indexed by their JSON.
+	thread_local static absl::flat_hash_map<
+	  std::string,
+	  std::weak_ptr<const std::vector<RTC::RtpEncodingParameters>>>
+	  SharedConsumableRtpEncodings;
+
+	// RTP parameters (and consumable RTP encodings) of Consumers of a Producer
+	// which just differ in their MID and SSRCs.
+	struct RtpParametersTemplate
+	{
+		RTC::RtpParameters rtpParameters;
+		std::shared_ptr<const std::vector<RTC::RtpEncodingParameters>> consumableRtpEncodings;
+	};
+
+	// Indexed by Producer id and rtpParametersKey (given by the application).
+	thread_local static absl::flat_hash_map<
+	  std::string,
+	  absl::flat_hash_map<std::string, RtpParametersTemplate>>
+	  RtpParametersTemplates;
+
+	static void removeExpiredSharedConsumableRtpEncodings()
+	{
+		for (auto it = SharedConsumableRtpEncodings.begin(); it != SharedConsumableRtpEncodings.end();)
+		{
+			if (it->second.expired())
+				SharedConsumableRtpEncodings.erase(it++);
+			else
+				++it;
+		}
+	}
+
+	/* Class methods. */
+
+	void Consumer::RemoveRtpParametersTemplates(const std::string& producerId)
+	{
+		MS_TRACE();
+
+		auto it = RtpParametersTemplates.find(producerId);
+
+		if (it == RtpParametersTemplates.end())
+			return;
+
+		RtpParametersTemplates.erase(it);
+
+		removeExpiredSharedConsumableRtpEncodings();
+	}
+
 	/* Instance methods. */
 
 	Consumer::Consumer(
@@ -23,6 +80,8 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		this->createdAtMs = DepLibUV::GetTimeMs();
+
 		auto jsonKindIt = data.find("kind");
 
 		if (jsonKindIt == data.end() || !jsonKindIt->is_string())
@@ -34,48 +93,89 @@ namespace RTC
 		if (this->kind == RTC::Media::Kind::ALL)
 			MS_THROW_TYPE_ERROR("invalid empty kind");
 
-		auto jsonRtpParametersIt = data.find("rtpParameters");
+		std::string rtpParametersKey;
+		auto jsonRtpParametersKeyIt = data.find("rtpParametersKey");
 
-		if (jsonRtpParametersIt == data.end() || !jsonRtpParametersIt->is_object())
-			MS_THROW_TYPE_ERROR("missing rtpParameters");
+		if (jsonRtpParametersKeyIt != data.end())
+		{
+			if (!jsonRtpParametersKeyIt->is_string())
+				MS_THROW_TYPE_ERROR("wrong rtpParametersKey (not a string)");
 
-		// This may throw.
-		this->rtpParameters = RTC::RtpParameters(*jsonRtpParametersIt);
+			rtpParametersKey = jsonRtpParametersKeyIt->get<std::string>();
+		}
 
-		if (this->rtpParameters.encodings.empty())
-			MS_THROW_TYPE_ERROR("empty rtpParameters.encodings");
+		auto jsonRtpParametersIt = data.find("rtpParameters");
 
-		// All encodings must have SSRCs.
-		for (auto& encoding : this->rtpParameters.encodings)
+		// Just MID and SSRCs are given if the RTP parameters were already given
+		// with the same key.
+		if (jsonRtpParametersIt == data.end() && !rtpParametersKey.empty())
 		{
-			if (encoding.ssrc == 0)
-				MS_THROW_TYPE_ERROR("invalid encoding in rtpParameters (missing ssrc)");
-			else if (encoding.hasRtx && encoding.rtx.ssrc == 0)
-				MS_THROW_TYPE_ERROR("invalid encoding in rtpParameters (missing rtx.ssrc)");
+			// This may throw.
+			SetRtpParametersFromTemplate(rtpParametersKey, data);
+
+			// Don't store it again.
+			rtpParametersKey.clear();
 		}
+		else
+		{
+			if (jsonRtpParametersIt == data.end() || !jsonRtpParametersIt->is_object())
+				MS_THROW_TYPE_ERROR("missing rtpParameters");
 
-		auto jsonConsumableRtpEncodingsIt = data.find("consumableRtpEncodings");
+			// This may throw.
+			this->rtpParameters = RTC::RtpParameters(*jsonRtpParametersIt);
 
-		if (jsonConsumableRtpEncodingsIt == data.end() || !jsonConsumableRtpEncodingsIt->is_array())
-			MS_THROW_TYPE_ERROR("missing consumableRtpEncodings");
+			if (this->rtpParameters.encodings.empty())
+				MS_THROW_TYPE_ERROR("empty rtpParameters.encodings");
 
-		if (jsonConsumableRtpEncodingsIt->empty())
-			MS_THROW_TYPE_ERROR("empty consumableRtpEncodings");
+			auto jsonConsumableRtpEncodingsIt = data.find("consumableRtpEncodings");
 
-		this->consumableRtpEncodings.reserve(jsonConsumableRtpEncodingsIt->size());
+			if (jsonConsumableRtpEncodingsIt == data.end() || !jsonConsumableRtpEncodingsIt->is_array())
+				MS_THROW_TYPE_ERROR("missing consumableRtpEncodings");
 
-		for (size_t i{ 0 }; i < jsonConsumableRtpEncodingsIt->size(); ++i)
-		{
-			auto& entry = (*jsonConsumableRtpEncodingsIt)[i];
+			if (jsonConsumableRtpEncodingsIt->empty())
+				MS_THROW_TYPE_ERROR("empty consumableRtpEncodings");
+
+			auto consumableRtpEncodingsKey = jsonConsumableRtpEncodingsIt->dump();
+			auto sharedIt = SharedConsumableRtpEncodings.find(consumableRtpEncodingsKey);
 
-			// This may throw due the constructor of RTC::RtpEncodingParameters.
-			this->consumableRtpEncodings.emplace_back(entry);
+			if (sharedIt != SharedConsumableRtpEncodings.end())
+				this->consumableRtpEncodings = sharedIt->second.lock();
 
-			// Verify that it has ssrc field.
-			auto& encoding = this->consumableRtpEncodings[i];
+			if (!this->consumableRtpEncodings)
+			{
+				std::vector<RTC::RtpEncodingParameters> consumableRtpEncodings;
 
-			if (encoding.ssrc == 0u)
-				MS_THROW_TYPE_ERROR("wrong encoding in consumableRtpEncodings (missing ssrc)");
+				consumableRtpEncodings.reserve(jsonConsumableRtpEncodingsIt->size());
+
+				for (size_t i{ 0 }; i < jsonConsumableRtpEncodingsIt->size(); ++i)
+				{
+					auto& entry = (*jsonConsumableRtpEncodingsIt)[i];
+
+					// This may throw due the constructor of RTC::RtpEncodingParameters.
+					consumableRtpEncodings.emplace_back(entry);
+
+					// Verify that it has ssrc field.
+					auto& encoding = consumableRtpEncodings[i];
+
+					if (encoding.ssrc == 0u)
+						MS_THROW_TYPE_ERROR("wrong encoding in consumableRtpEncodings (missing ssrc)");
+				}
+
+				this->consumableRtpEncodings =
+				  std::make_shared<const std::vector<RTC::RtpEncodingParameters>>(
+				    std::move(consumableRtpEncodings));
+
+				SharedConsumableRtpEncodings[consumableRtpEncodingsKey] = this->consumableRtpEncodings;
+			}
+		}
+
+		// All encodings must have SSRCs.
+		for (auto& encoding : this->rtpParameters.encodings)
+		{
+			if (encoding.ssrc == 0)
+				MS_THROW_TYPE_ERROR("invalid encoding in rtpParameters (missing ssrc)");
+			else if (encoding.hasRtx && encoding.rtx.ssrc == 0)
+				MS_THROW_TYPE_ERROR("invalid encoding in rtpParameters (missing rtx.ssrc)");
 		}
 
 		// Fill RTP header extension ids and their mapped values.
@@ -126,11 +226,18 @@ namespace RTC
 		if (jsonPausedIt != data.end() && jsonPausedIt->is_boolean())
 			this->paused = jsonPausedIt->get<bool>();
 
-		// Fill supported codec payload types.
+		// Fill supported codec payload types (those of RTP packets have 7 bits).
 		for (auto& codec : this->rtpParameters.codecs)
 		{
-			if (codec.mimeType.IsMediaCodec())
-				this->supportedCodecPayloadTypes.insert(codec.payloadType);
+			// clang-format off
+			if (
+				codec.mimeType.IsMediaCodec() &&
+				codec.payloadType < this->supportedCodecPayloadTypes.size()
+			)
+			// clang-format on
+			{
+				this->supportedCodecPayloadTypes.set(codec.payloadType);
+			}
 		}
 
 		// Fill media SSRCs vector.
@@ -151,11 +258,113 @@ namespace RTC
 			this->maxRtcpInterval = RTC::RTCP::MaxAudioIntervalMs;
 		else
 			this->maxRtcpInterval = RTC::RTCP::MaxVideoIntervalMs;
+
+		// Measure the forwarding latency if enabled in the Worker.
+		if (Metrics::IsIngressTimeEnabled())
+			this->forwardingLatency = new RTC::ForwardingLatency();
+
+		// Keep the parsed RTP parameters for next Consumers with the same key.
+		if (!rtpParametersKey.empty())
+		{
+			auto& rtpParametersTemplate = RtpParametersTemplates[this->producerId][rtpParametersKey];
+
+			rtpParametersTemplate.rtpParameters          = this->rtpParameters;
+			rtpParametersTemplate.consumableRtpEncodings = this->consumableRtpEncodings;
+		}
 	}
 
 	Consumer::~Consumer()
 	{
 		MS_TRACE();
+
+		// Delete the TraceEventSampler.
+		delete this->traceEventSampler;
+
+		// Delete the ForwardingLatency.
+		delete this->forwardingLatency;
+
+		// Forget the shared consumable RTP encodings if this was the last user.
+		if (this->consumableRtpEncodings && this->consumableRtpEncodings.use_count() == 1)
+		{
+			this->consumableRtpEncodings.reset();
+
+			removeExpiredSharedConsumableRtpEncodings();
+		}
+	}
+
+	void Consumer::SetRtpParametersFromTemplate(const std::string& rtpParametersKey, json& data)
+	{
+		MS_TRACE();
+
+		auto templatesIt = RtpParametersTemplates.find(this->producerId);
+
+		if (templatesIt == RtpParametersTemplates.end())
+			MS_THROW_ERROR("unknown rtpParametersKey '%s'", rtpParametersKey.c_str());
+
+		auto templateIt = templatesIt->second.find(rtpParametersKey);
+
+		if (templateIt == templatesIt->second.end())
+			MS_THROW_ERROR("unknown rtpParametersKey '%s'", rtpParametersKey.c_str());
+
+		const auto& rtpParametersTemplate = templateIt->second;
+		auto jsonEncodingsIt              = data.find("encodings");
+
+		if (jsonEncodingsIt == data.end() || !jsonEncodingsIt->is_array())
+			MS_THROW_TYPE_ERROR("missing encodings");
+
+		if (jsonEncodingsIt->size() != rtpParametersTemplate.rtpParameters.encodings.size())
+			MS_THROW_TYPE_ERROR("wrong encodings (not as many as in the RTP parameters)");
+
+		this->rtpParameters          = rtpParametersTemplate.rtpParameters;
+		this->consumableRtpEncodings = rtpParametersTemplate.consumableRtpEncodings;
+
+		// Set the SSRCs.
+		for (size_t i{ 0u }; i < jsonEncodingsIt->size(); ++i)
+		{
+			auto& jsonEncoding = (*jsonEncodingsIt)[i];
+			auto& encoding     = this->rtpParameters.encodings[i];
+
+			if (!jsonEncoding.is_object())
+				MS_THROW_TYPE_ERROR("wrong encoding (not an object)");
+
+			auto jsonSsrcIt = jsonEncoding.find("ssrc");
+
+			if (jsonSsrcIt == jsonEncoding.end() || !Utils::Json::IsPositiveInteger(*jsonSsrcIt))
+				MS_THROW_TYPE_ERROR("wrong encoding (missing ssrc)");
+
+			encoding.ssrc = jsonSsrcIt->get<uint32_t>();
+
+			if (!encoding.hasRtx)
+				continue;
+
+			auto jsonRtxIt = jsonEncoding.find("rtx");
+
+			if (jsonRtxIt == jsonEncoding.end() || !jsonRtxIt->is_object())
+				MS_THROW_TYPE_ERROR("wrong encoding (missing rtx)");
+
+			auto jsonRtxSsrcIt = jsonRtxIt->find("ssrc");
+
+			if (jsonRtxSsrcIt == jsonRtxIt->end() || !Utils::Json::IsPositiveInteger(*jsonRtxSsrcIt))
+				MS_THROW_TYPE_ERROR("wrong encoding (missing rtx.ssrc)");
+
+			encoding.rtx.ssrc = jsonRtxSsrcIt->get<uint32_t>();
+		}
+
+		// Set the MID.
+		auto jsonMidIt = data.find("mid");
+
+		if (jsonMidIt == data.end())
+		{
+			this->rtpParameters.mid.clear();
+		}
+		else if (jsonMidIt->is_string())
+		{
+			this->rtpParameters.mid = jsonMidIt->get<std::string>();
+		}
+		else
+		{
+			MS_THROW_TYPE_ERROR("wrong mid (not a string)");
+		}
 	}
 
 	void Consumer::FillJson(json& jsonObject) const
@@ -181,18 +390,26 @@ namespace RTC
 		jsonObject["consumableRtpEncodings"] = json::array();
 		auto jsonConsumableRtpEncodingsIt    = jsonObject.find("consumableRtpEncodings");
 
-		for (size_t i{ 0 }; i < this->consumableRtpEncodings.size(); ++i)
+		for (size_t i{ 0 }; i < this->consumableRtpEncodings->size(); ++i)
 		{
 			jsonConsumableRtpEncodingsIt->emplace_back(json::value_t::object);
 
 			auto& jsonEntry      = (*jsonConsumableRtpEncodingsIt)[i];
-			const auto& encoding = this->consumableRtpEncodings[i];
+			const auto& encoding = (*this->consumableRtpEncodings)[i];
 
 			encoding.FillJson(jsonEntry);
 		}
 
 		// Add supportedCodecPayloadTypes.
-		jsonObject["supportedCodecPayloadTypes"] = this->supportedCodecPayloadTypes;
+		jsonObject["supportedCodecPayloadTypes"] = json::array();
+		auto jsonSupportedCodecPayloadTypesIt    = jsonObject.find("supportedCodecPayloadTypes");
+
+		for (size_t payloadType{ 0u }; payloadType < this->supportedCodecPayloadTypes.size();
+		     ++payloadType)
+		{
+			if (this->supportedCodecPayloadTypes.test(payloadType))
+				jsonSupportedCodecPayloadTypesIt->push_back(payloadType);
+		}
 
 		// Add paused.
 		jsonObject["paused"] = this->paused;
@@ -200,6 +417,12 @@ namespace RTC
 		// Add producerPaused.
 		jsonObject["producerPaused"] = this->producerPaused;
 
+		// Add lastNPaused.
+		jsonObject["lastNPaused"] = this->lastNPaused;
+
+		// Add overloadPaused.
+		jsonObject["overloadPaused"] = this->overloadPaused;
+
 		// Add priority.
 		jsonObject["priority"] = this->priority;
 
@@ -228,6 +451,27 @@ namespace RTC
 		}
 
 		jsonObject["traceEventTypes"] = traceEventTypesStream.str();
+
+		// Add trace event sampling options and buffered events.
+		if (this->traceEventSampler)
+			this->traceEventSampler->FillJson(jsonObject);
+	}
+
+	void Consumer::FillStatsRecords(
+	  StatsRegion* statsRegion, const std::string& transportId, uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		for (auto* rtpStream : GetRtpStreams())
+		{
+			auto* record = statsRegion->AddRecord(
+			  StatsRegion::RecordType::CONSUMER_STREAM, this->id, transportId);
+
+			if (!record)
+				return;
+
+			rtpStream->FillStatsRecord(record, nowMs);
+		}
 	}
 
 	void Consumer::HandleRequest(Channel::ChannelRequest* request)
@@ -242,6 +486,9 @@ namespace RTC
 
 				FillJson(data);
 
+				// Add footprint.
+				FillJsonFootprint(data["footprint"]);
+
 				request->Accept(data);
 
 				break;
@@ -253,7 +500,44 @@ namespace RTC
 
 				FillJsonStats(data);
 
-				request->Accept(data);
+				// Add joinLatency to the entry of this Consumer.
+				if (!data.empty() && this->firstRtpSentAtMs != 0u)
+				{
+					auto& jsonJoinLatency = data[0]["joinLatency"];
+
+					jsonJoinLatency["firstRtpMs"] = this->firstRtpSentAtMs - this->createdAtMs;
+
+					if (this->firstKeyFrameSentAtMs != 0u)
+						jsonJoinLatency["firstKeyFrameMs"] = this->firstKeyFrameSentAtMs - this->createdAtMs;
+				}
+
+				// Add forwarding latency as an extra entry.
+				if (this->forwardingLatency)
+				{
+					json jsonForwardingLatency = json::object();
+
+					jsonForwardingLatency["type"] = "forwarding-latency";
+
+					this->forwardingLatency->FillJson(jsonForwardingLatency);
+
+					data.push_back(jsonForwardingLatency);
+				}
+
+				auto jsonCursorIt = request->data.find("cursor");
+
+				// Just changed stats requested.
+				if (jsonCursorIt != request->data.end() && jsonCursorIt->is_number_unsigned())
+				{
+					json jsonDelta = json::object();
+
+					this->statsDelta.FillJson(jsonDelta, data, jsonCursorIt->get<uint64_t>());
+
+					request->Accept(jsonDelta);
+				}
+				else
+				{
+					request->Accept(data);
+				}
 
 				break;
 			}
@@ -273,6 +557,8 @@ namespace RTC
 
 				MS_DEBUG_DEV("Consumer paused [consumerId:%s]", this->id.c_str());
 
+				this->listener->OnConsumerActiveChanged(this);
+
 				if (wasActive)
 					UserOnPaused();
 
@@ -294,6 +580,8 @@ namespace RTC
 
 				MS_DEBUG_DEV("Consumer resumed [consumerId:%s]", this->id.c_str());
 
+				this->listener->OnConsumerActiveChanged(this);
+
 				if (IsActive())
 					UserOnResumed();
 
@@ -316,6 +604,9 @@ namespace RTC
 
 				this->priority = priority;
 
+				// The priority decides whether it's paused when overloaded.
+				SetOverloadLevel(this->overloadLevel);
+
 				json data = json::object();
 
 				data["priority"] = this->priority;
@@ -325,6 +616,17 @@ namespace RTC
 				break;
 			}
 
+			case Channel::ChannelRequest::MethodId::CONSUMER_EXPORT_SEND_STATE:
+			{
+				json data = json::object();
+
+				FillJsonSendState(data);
+
+				request->Accept(data);
+
+				break;
+			}
+
 			case Channel::ChannelRequest::MethodId::CONSUMER_ENABLE_TRACE_EVENT:
 			{
 				auto jsonTypesIt = request->data.find("types");
@@ -355,7 +657,13 @@ namespace RTC
 						newTraceEventTypes.fir = true;
 				}
 
-				this->traceEventTypes = newTraceEventTypes;
+				// This may throw.
+				auto* traceEventSampler = RTC::TraceEventSampler::Create(this->id, request->data);
+
+				delete this->traceEventSampler;
+
+				this->traceEventTypes   = newTraceEventTypes;
+				this->traceEventSampler = traceEventSampler;
 
 				request->Accept();
 
@@ -380,6 +688,8 @@ namespace RTC
 
 		MS_DEBUG_DEV("Transport connected [consumerId:%s]", this->id.c_str());
 
+		this->listener->OnConsumerActiveChanged(this);
+
 		UserOnTransportConnected();
 	}
 
@@ -394,6 +704,8 @@ namespace RTC
 
 		MS_DEBUG_DEV("Transport disconnected [consumerId:%s]", this->id.c_str());
 
+		this->listener->OnConsumerActiveChanged(this);
+
 		UserOnTransportDisconnected();
 	}
 
@@ -410,6 +722,8 @@ namespace RTC
 
 		MS_DEBUG_DEV("Producer paused [consumerId:%s]", this->id.c_str());
 
+		this->listener->OnConsumerActiveChanged(this);
+
 		if (wasActive)
 			UserOnPaused();
 
@@ -427,12 +741,136 @@ namespace RTC
 
 		MS_DEBUG_DEV("Producer resumed [consumerId:%s]", this->id.c_str());
 
+		this->listener->OnConsumerActiveChanged(this);
+
 		if (IsActive())
 			UserOnResumed();
 
 		Channel::ChannelNotifier::Emit(this->id, "producerresume");
 	}
 
+	void Consumer::SetLastNPaused(bool lastNPaused)
+	{
+		MS_TRACE();
+
+		if (lastNPaused == this->lastNPaused)
+			return;
+
+		bool wasActive = IsActive();
+
+		this->lastNPaused = lastNPaused;
+
+		MS_DEBUG_DEV(
+		  "Consumer %s by last N policy [consumerId:%s]",
+		  lastNPaused ? "paused" : "resumed",
+		  this->id.c_str());
+
+		this->listener->OnConsumerActiveChanged(this);
+
+		// NOTE: Node is not notified, this is internal to the Router.
+		if (wasActive && !IsActive())
+			UserOnPaused();
+		else if (!wasActive && IsActive())
+			UserOnResumed();
+	}
+
+	void Consumer::SetOverloadLevel(OverloadController::Level level)
+	{
+		MS_TRACE();
+
+		this->overloadLevel = level;
+
+		OverloadController::GetMaxLayers(
+		  level, this->overloadMaxSpatialLayer, this->overloadMaxTemporalLayer);
+
+		// clang-format off
+		bool overloadPaused = (
+			this->kind == RTC::Media::Kind::VIDEO &&
+			this->priority == 1u &&
+			level >= OverloadController::Level::PAUSE_CONSUMERS
+		);
+		// clang-format on
+
+		if (overloadPaused == this->overloadPaused)
+			return;
+
+		bool wasActive = IsActive();
+
+		this->overloadPaused = overloadPaused;
+
+		MS_DEBUG_DEV(
+		  "Consumer %s due to overload [consumerId:%s]",
+		  overloadPaused ? "paused" : "resumed",
+		  this->id.c_str());
+
+		this->listener->OnConsumerActiveChanged(this);
+
+		// NOTE: Node is not notified, the worker emits "overload" instead.
+		if (wasActive && !IsActive())
+			UserOnPaused();
+		else if (!wasActive && IsActive())
+			UserOnResumed();
+	}
+
+	size_t Consumer::GetMemoryUsage()
+	{
+		MS_TRACE();
+
+		size_t memoryUsage{ 0u };
+
+		for (auto* rtpStream : GetRtpStreams())
+		{
+			memoryUsage += rtpStream->GetMemoryUsage();
+		}
+
+		return memoryUsage;
+	}
+
+	size_t Consumer::FillJsonFootprint(json& jsonObject)
+	{
+		MS_TRACE();
+
+		// Add object.
+		auto objectSize      = GetObjectSize();
+		jsonObject["object"] = objectSize;
+
+		// Add rtpParameters.
+		auto rtpParametersSize      = this->rtpParameters.GetMemoryUsage();
+		jsonObject["rtpParameters"] = rtpParametersSize;
+
+		// Add consumableRtpEncodings.
+		auto consumableRtpEncodingsSize =
+		  RTC::RtpParameters::GetMemoryUsage(*this->consumableRtpEncodings) /
+		  this->consumableRtpEncodings.use_count();
+		jsonObject["consumableRtpEncodings"] = consumableRtpEncodingsSize;
+
+		// Add rtpStreams.
+		size_t rtpStreamsSize{ 0u };
+
+		for (auto* rtpStream : GetRtpStreams())
+		{
+			rtpStreamsSize += rtpStream->GetFootprint();
+		}
+
+		jsonObject["rtpStreams"] = rtpStreamsSize;
+
+		// Add total.
+		auto total = objectSize + rtpParametersSize + consumableRtpEncodingsSize + rtpStreamsSize;
+		jsonObject["total"] = total;
+
+		return total;
+	}
+
+	void Consumer::SetMemoryPressure(bool memoryPressure)
+	{
+		MS_TRACE();
+
+		for (auto* rtpStream : GetRtpStreams())
+		{
+			rtpStream->SetStorageLimit(memoryPressure ? MemoryPressureStorageLimit : 0u);
+		}
+	}
+
 	void Consumer::ProducerRtpStreamScores(const std::vector<uint8_t>* scores)
 	{
 		MS_TRACE();
@@ -456,12 +894,25 @@ namespace RTC
 		this->listener->OnConsumerProducerClosed(this);
 	}
 
+	void Consumer::EmitTraceEvent(json& data) const
+	{
+		MS_TRACE();
+
+		if (this->traceEventSampler)
+			this->traceEventSampler->Emit(data);
+		else
+			Channel::ChannelNotifier::Emit(this->id, "trace", data);
+	}
+
 	void Consumer::EmitTraceEventRtpAndKeyFrameTypes(RTC::RtpPacket* packet, bool isRtx) const
 	{
 		MS_TRACE();
 
 		if (this->traceEventTypes.keyframe && packet->IsKeyFrame())
 		{
+			if (this->traceEventSampler && !this->traceEventSampler->Sample("keyframe"))
+				return;
+
 			json data = json::object();
 
 			data["type"]      = "keyframe";
@@ -473,10 +924,13 @@ namespace RTC
 			if (isRtx)
 				data["info"]["isRtx"] = true;
 
-			Channel::ChannelNotifier::Emit(this->id, "trace", data);
+			EmitTraceEvent(data);
 		}
 		else if (this->traceEventTypes.rtp)
 		{
+			if (this->traceEventSampler && !this->traceEventSampler->Sample("rtp", true))
+				return;
+
 			json data = json::object();
 
 			data["type"]      = "rtp";
@@ -488,7 +942,7 @@ namespace RTC
 			if (isRtx)
 				data["info"]["isRtx"] = true;
 
-			Channel::ChannelNotifier::Emit(this->id, "trace", data);
+			EmitTraceEvent(data);
 		}
 	}
 
@@ -499,6 +953,9 @@ namespace RTC
 		if (!this->traceEventTypes.pli)
 			return;
 
+		if (this->traceEventSampler && !this->traceEventSampler->Sample("pli"))
+			return;
+
 		json data = json::object();
 
 		data["type"]         = "pli";
@@ -506,7 +963,7 @@ namespace RTC
 		data["direction"]    = "in";
 		data["info"]["ssrc"] = ssrc;
 
-		Channel::ChannelNotifier::Emit(this->id, "trace", data);
+		EmitTraceEvent(data);
 	}
 
 	void Consumer::EmitTraceEventFirType(uint32_t ssrc) const
@@ -516,6 +973,9 @@ namespace RTC
 		if (!this->traceEventTypes.fir)
 			return;
 
+		if (this->traceEventSampler && !this->traceEventSampler->Sample("fir"))
+			return;
+
 		json data = json::object();
 
 		data["type"]         = "fir";
@@ -523,7 +983,7 @@ namespace RTC
 		data["direction"]    = "in";
 		data["info"]["ssrc"] = ssrc;
 
-		Channel::ChannelNotifier::Emit(this->id, "trace", data);
+		EmitTraceEvent(data);
 	}
 
 	void Consumer::EmitTraceEventNackType() const
@@ -533,6 +993,9 @@ namespace RTC
 		if (!this->traceEventTypes.nack)
 			return;
 
+		if (this->traceEventSampler && !this->traceEventSampler->Sample("nack"))
+			return;
+
 		json data = json::object();
 
 		data["type"]      = "nack";
@@ -540,6 +1003,87 @@ namespace RTC
 		data["direction"] = "in";
 		data["info"]      = json::object();
 
-		Channel::ChannelNotifier::Emit(this->id, "trace", data);
+		EmitTraceEvent(data);
+	}
+
+	void Consumer::FillJsonStreamSendState(
+	  json& jsonObject,
+	  const RTC::SeqManager<uint16_t>& rtpSeqManager,
+	  const RTC::RtpStreamSend* rtpStream) const
+	{
+		MS_TRACE();
+
+		jsonObject["type"]   = RTC::RtpParameters::GetTypeString(this->type);
+		jsonObject["rtpSeq"] = rtpSeqManager.GetMaxOutput();
+
+		if (rtpStream->HasRtx())
+			jsonObject["rtxSeq"] = rtpStream->GetRtxSeq();
+	}
+
+	void Consumer::ApplySendState(
+	  json& data, RTC::SeqManager<uint16_t>& rtpSeqManager, RTC::RtpStreamSend* rtpStream)
+	{
+		MS_TRACE();
+
+		if (!data.is_object())
+			MS_THROW_TYPE_ERROR("wrong sendState (not an object)");
+
+		auto jsonTypeIt   = data.find("type");
+		auto jsonRtpSeqIt = data.find("rtpSeq");
+		auto jsonRtxSeqIt = data.find("rtxSeq");
+
+		if (jsonTypeIt == data.end() || !jsonTypeIt->is_string())
+			MS_THROW_TYPE_ERROR("missing sendState.type");
+		else if (jsonTypeIt->get<std::string>() != RTC::RtpParameters::GetTypeString(this->type))
+			MS_THROW_TYPE_ERROR("sendState.type does not match Consumer type");
+
+		// clang-format off
+		if (
+			jsonRtpSeqIt == data.end() ||
+			!Utils::Json::IsPositiveInteger(*jsonRtpSeqIt) ||
+			jsonRtpSeqIt->get<uint32_t>() > 0xFFFF
+		)
+		// clang-format on
+		{
+			MS_THROW_TYPE_ERROR("missing sendState.rtpSeq");
+		}
+
+		// The first sent packet follows the last one sent by the exported Consumer.
+		rtpSeqManager.SetMaxOutput(jsonRtpSeqIt->get<uint16_t>());
+
+		// clang-format off
+		if (
+			rtpStream->HasRtx() &&
+			jsonRtxSeqIt != data.end() &&
+			Utils::Json::IsPositiveInteger(*jsonRtxSeqIt)
+		)
+		// clang-format on
+		{
+			rtpStream->SetRtxSeq(jsonRtxSeqIt->get<uint16_t>());
+		}
+	}
+
+	void Consumer::RecordFirstRtpPacketSent(const RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		const uint64_t nowMs = DepLibUV::GetTimeMs();
+
+		if (this->firstRtpSentAtMs == 0u)
+		{
+			this->firstRtpSentAtMs = nowMs;
+
+			RTC::JoinLatency::Record(
+			  RTC::JoinLatency::Phase::CONSUMER_FIRST_RTP, this->firstRtpSentAtMs - this->createdAtMs);
+		}
+
+		if (packet->IsKeyFrame())
+		{
+			this->firstKeyFrameSentAtMs = nowMs;
+
+			RTC::JoinLatency::Record(
+			  RTC::JoinLatency::Phase::CONSUMER_FIRST_KEY_FRAME,
+			  this->firstKeyFrameSentAtMs - this->createdAtMs);
+		}
 	}
 } // namespace RTC
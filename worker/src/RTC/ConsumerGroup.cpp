@@ -0,0 +1,43 @@
+#define MS_CLASS "RTC::ConsumerGroup"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/ConsumerGroup.hpp"
+#include "Logger.hpp"
+
+namespace RTC
+{
+	/* Instance methods. */
+
+	ConsumerGroup::ConsumerGroup(const std::string& key) : key(key)
+	{
+		MS_TRACE();
+	}
+
+	void ConsumerGroup::Drop(uint16_t input)
+	{
+		MS_TRACE();
+
+		this->rtpSeqManager.Drop(input);
+
+		this->hasLastInput = false;
+	}
+
+	bool ConsumerGroup::Input(uint16_t input, uint16_t& output)
+	{
+		MS_TRACE();
+
+		if (this->hasLastInput && input == this->lastInput)
+		{
+			output = this->lastOutput;
+
+			return this->lastInputResult;
+		}
+
+		this->lastInputResult = this->rtpSeqManager.Input(input, output);
+		this->lastInput       = input;
+		this->lastOutput      = output;
+		this->hasLastInput    = true;
+
+		return this->lastInputResult;
+	}
+} // namespace RTC
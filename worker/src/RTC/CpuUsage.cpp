@@ -0,0 +1,22 @@
+#define MS_CLASS "RTC::CpuUsage"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/CpuUsage.hpp"
+#include "Logger.hpp"
+
+namespace RTC
+{
+	/* Class variables. */
+
+	thread_local CpuUsage::Scope* CpuUsage::currentScope{ nullptr };
+
+	/* Instance methods. */
+
+	double CpuUsage::GetMsPerSecond(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		// Cycles per ms into ns per ms, so ms per second.
+		return this->cycles.GetRate(nowMs) * Metrics::GetNsPerCycle() / 1000.0;
+	}
+} // namespace RTC
@@ -7,6 +7,8 @@
 #include "MediaSoupErrors.hpp"
 #include "Utils.hpp"
 #include "Channel/ChannelNotifier.hpp"
+#include <algorithm> // std::find_if(), std::min()
+#include <cstring>   // std::memcmp()
 
 namespace RTC
 {
@@ -53,6 +55,53 @@ namespace RTC
 
 			// This may throw.
 			this->sctpStreamParameters = RTC::SctpStreamParameters(*jsonSctpStreamParametersIt);
+
+			auto jsonMaxQueuedMessagesIt = data.find("maxQueuedMessages");
+			auto jsonQueueDropPolicyIt   = data.find("queueDropPolicy");
+			auto jsonCoalesceKeyLengthIt = data.find("coalesceKeyLength");
+
+			if (jsonMaxQueuedMessagesIt != data.end())
+			{
+				if (!jsonMaxQueuedMessagesIt->is_number_unsigned())
+					MS_THROW_TYPE_ERROR("wrong maxQueuedMessages (not an unsigned number)");
+
+				this->maxQueuedMessages = jsonMaxQueuedMessagesIt->get<uint32_t>();
+			}
+
+			if (jsonQueueDropPolicyIt != data.end())
+			{
+				if (!jsonQueueDropPolicyIt->is_string())
+					MS_THROW_TYPE_ERROR("wrong queueDropPolicy (not a string)");
+
+				auto queueDropPolicy = jsonQueueDropPolicyIt->get<std::string>();
+
+				if (queueDropPolicy == "drop-oldest")
+					this->queueDropPolicy = QueueDropPolicy::DROP_OLDEST;
+				else if (queueDropPolicy == "drop-newest")
+					this->queueDropPolicy = QueueDropPolicy::DROP_NEWEST;
+				else if (queueDropPolicy == "coalesce")
+					this->queueDropPolicy = QueueDropPolicy::COALESCE;
+				else
+					MS_THROW_TYPE_ERROR("invalid queueDropPolicy");
+			}
+
+			if (jsonCoalesceKeyLengthIt != data.end())
+			{
+				if (!jsonCoalesceKeyLengthIt->is_number_unsigned())
+					MS_THROW_TYPE_ERROR("wrong coalesceKeyLength (not an unsigned number)");
+
+				this->coalesceKeyLength = jsonCoalesceKeyLengthIt->get<size_t>();
+			}
+
+			// clang-format off
+			if (
+				this->queueDropPolicy == QueueDropPolicy::COALESCE &&
+				this->coalesceKeyLength == 0u
+			)
+			// clang-format on
+			{
+				MS_THROW_TYPE_ERROR("missing coalesceKeyLength");
+			}
 		}
 
 		if (jsonLabelIt != data.end() && jsonLabelIt->is_string())
@@ -123,6 +172,12 @@ namespace RTC
 
 		// Add bufferedAmount.
 		jsonObject["bufferedAmount"] = this->bufferedAmount;
+
+		// Add messagesQueued.
+		jsonObject["messagesQueued"] = this->queuedMessages.size();
+
+		// Add messagesDropped.
+		jsonObject["messagesDropped"] = this->messagesDropped;
 	}
 
 	void DataConsumer::HandleRequest(Channel::ChannelRequest* request)
@@ -259,6 +314,8 @@ namespace RTC
 
 		this->transportConnected = false;
 
+		ClearQueuedMessages();
+
 		MS_DEBUG_DEV("Transport disconnected [dataConsumerId:%s]", this->id.c_str());
 	}
 
@@ -277,6 +334,8 @@ namespace RTC
 
 		this->sctpAssociationConnected = false;
 
+		ClearQueuedMessages();
+
 		MS_DEBUG_DEV("SctpAssociation closed [dataConsumerId:%s]", this->id.c_str());
 	}
 
@@ -304,6 +363,20 @@ namespace RTC
 
 			Channel::ChannelNotifier::Emit(this->id, "bufferedamountlow", data);
 		}
+
+		// There is room again in the SCTP send buffer, so send as many queued
+		// messages as bytes were freed. Messages sent now increase the buffered
+		// amount, so ignore it while sending them.
+		// clang-format off
+		if (
+			!this->queuedMessages.empty() &&
+			!this->sendingQueuedMessages &&
+			this->bufferedAmount < previousBufferedAmount
+		)
+		// clang-format on
+		{
+			SendQueuedMessages(previousBufferedAmount - this->bufferedAmount);
+		}
 	}
 
 	// The caller (Router) is supposed to proceed with the deletion of this DataConsumer
@@ -342,6 +415,194 @@ namespace RTC
 		this->messagesSent++;
 		this->bytesSent += len;
 
+		// Messages cannot overtake those waiting for room in the SCTP send buffer.
+		if (!this->queuedMessages.empty())
+		{
+			const bool queued = QueueMessage(ppid, msg, len);
+
+			if (cb)
+			{
+				(*cb)(queued, !queued);
+				delete cb;
+			}
+
+			return;
+		}
+
 		this->listener->OnDataConsumerSendMessage(this, ppid, msg, len, cb);
 	}
+
+	bool DataConsumer::SctpSendBufferFull(uint32_t ppid, const uint8_t* msg, size_t len)
+	{
+		MS_TRACE();
+
+		if (this->maxQueuedMessages == 0u || !IsActive())
+			return false;
+
+		auto& queuedMessages = this->queuedMessages;
+
+		// Messages given back before this one were sent before it.
+		this->numRequeuedMessages = std::min(this->numRequeuedMessages, queuedMessages.size());
+
+		auto requeueIt = queuedMessages.begin() + this->numRequeuedMessages;
+
+		// A newer message with same key is already queued, so this one is useless.
+		if (this->queueDropPolicy == QueueDropPolicy::COALESCE)
+		{
+			auto it = std::find_if(
+			  requeueIt,
+			  queuedMessages.end(),
+			  [this, msg, len](const QueuedMessage& queuedMessage)
+			  { return HasSameKey(queuedMessage, msg, len); });
+
+			if (it != queuedMessages.end())
+			{
+				this->messagesDropped++;
+
+				return true;
+			}
+		}
+
+		if (queuedMessages.size() >= this->maxQueuedMessages)
+		{
+			this->messagesDropped++;
+
+			if (this->queueDropPolicy == QueueDropPolicy::DROP_NEWEST)
+			{
+				// This message is the newest one.
+				if (requeueIt == queuedMessages.end())
+					return true;
+
+				queuedMessages.pop_back();
+			}
+			else
+			{
+				// This message is the oldest one.
+				if (this->numRequeuedMessages == 0u)
+					return true;
+
+				queuedMessages.pop_front();
+				this->numRequeuedMessages--;
+			}
+
+			requeueIt = queuedMessages.begin() + this->numRequeuedMessages;
+		}
+
+		queuedMessages.insert(requeueIt, { ppid, { msg, msg + len } });
+		this->numRequeuedMessages++;
+
+		MS_DEBUG_DEV(
+		  "message queued until there is room in the SCTP send buffer [dataConsumerId:%s, queued:%zu]",
+		  this->id.c_str(),
+		  queuedMessages.size());
+
+		return true;
+	}
+
+	bool DataConsumer::QueueMessage(uint32_t ppid, const uint8_t* msg, size_t len)
+	{
+		MS_TRACE();
+
+		auto& queuedMessages = this->queuedMessages;
+
+		if (this->queueDropPolicy == QueueDropPolicy::COALESCE)
+		{
+			auto it = std::find_if(
+			  queuedMessages.rbegin(),
+			  queuedMessages.rend(),
+			  [this, msg, len](const QueuedMessage& queuedMessage)
+			  { return HasSameKey(queuedMessage, msg, len); });
+
+			// Replace the queued message with same key keeping its position.
+			if (it != queuedMessages.rend())
+			{
+				it->ppid = ppid;
+				it->msg.assign(msg, msg + len);
+
+				this->messagesDropped++;
+
+				return true;
+			}
+		}
+
+		if (queuedMessages.size() >= this->maxQueuedMessages)
+		{
+			this->messagesDropped++;
+
+			if (this->queueDropPolicy == QueueDropPolicy::DROP_NEWEST)
+				return false;
+
+			queuedMessages.pop_front();
+
+			if (this->numRequeuedMessages > 0u)
+				this->numRequeuedMessages--;
+		}
+
+		queuedMessages.push_back({ ppid, { msg, msg + len } });
+
+		return true;
+	}
+
+	void DataConsumer::SendQueuedMessages(size_t maxBytes)
+	{
+		MS_TRACE();
+
+		this->sendingQueuedMessages = true;
+		this->numRequeuedMessages   = 0u;
+
+		size_t sentBytes{ 0u };
+		size_t numSent{ 0u };
+
+		// Send at least one message so the queue cannot get stuck.
+		// clang-format off
+		while (
+			!this->queuedMessages.empty() &&
+			(numSent == 0u || sentBytes + this->queuedMessages.front().msg.size() <= maxBytes)
+		)
+		// clang-format on
+		{
+			auto queuedMessage = std::move(this->queuedMessages.front());
+
+			this->queuedMessages.pop_front();
+
+			sentBytes += queuedMessage.msg.size();
+			numSent++;
+
+			// Messages failing again are given back by SctpSendBufferFull().
+			this->listener->OnDataConsumerSendMessage(
+			  this, queuedMessage.ppid, queuedMessage.msg.data(), queuedMessage.msg.size(), nullptr);
+		}
+
+		this->sendingQueuedMessages = false;
+
+		MS_DEBUG_DEV(
+		  "queued messages sent [dataConsumerId:%s, sent:%zu, queued:%zu]",
+		  this->id.c_str(),
+		  numSent,
+		  this->queuedMessages.size());
+	}
+
+	void DataConsumer::ClearQueuedMessages()
+	{
+		MS_TRACE();
+
+		this->messagesDropped += this->queuedMessages.size();
+
+		this->queuedMessages.clear();
+		this->numRequeuedMessages = 0u;
+	}
+
+	bool DataConsumer::HasSameKey(
+	  const QueuedMessage& queuedMessage, const uint8_t* msg, size_t len) const
+	{
+		MS_TRACE();
+
+		// clang-format off
+		return (
+			len >= this->coalesceKeyLength &&
+			queuedMessage.msg.size() >= this->coalesceKeyLength &&
+			std::memcmp(queuedMessage.msg.data(), msg, this->coalesceKeyLength) == 0
+		);
+		// clang-format on
+	}
 } // namespace RTC
@@ -4,10 +4,53 @@
 #include "RTC/DirectTransport.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Metrics.hpp"
 #include "PayloadChannel/PayloadChannelNotifier.hpp"
 
 namespace RTC
 {
+	/* Class variables. */
+
+	thread_local bool DirectTransport::messageMulticast{ false };
+	thread_local std::vector<const std::string*> DirectTransport::multicastDataConsumerIds;
+
+	/* Class methods. */
+
+	void DirectTransport::StartMessageMulticast()
+	{
+		MS_TRACE();
+
+		DirectTransport::messageMulticast = true;
+		DirectTransport::multicastDataConsumerIds.clear();
+	}
+
+	void DirectTransport::EndMessageMulticast(
+	  const std::string& dataProducerId, uint32_t ppid, const uint8_t* msg, size_t len)
+	{
+		MS_TRACE();
+
+		auto& dataConsumerIds = DirectTransport::multicastDataConsumerIds;
+
+		DirectTransport::messageMulticast = false;
+
+		if (dataConsumerIds.empty())
+			return;
+
+		// Notify the Node DirectTransport(s).
+		if (dataConsumerIds.size() == 1u)
+		{
+			PayloadChannel::PayloadChannelNotifier::Emit(
+			  *dataConsumerIds.front(), "message", ppid, msg, len);
+		}
+		else
+		{
+			PayloadChannel::PayloadChannelNotifier::Emit(
+			  dataProducerId, "message", ppid, dataConsumerIds, msg, len);
+		}
+
+		dataConsumerIds.clear();
+	}
+
 	/* Instance methods. */
 
 	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
@@ -15,6 +58,17 @@ namespace RTC
 	  : RTC::Transport::Transport(id, listener, data)
 	{
 		MS_TRACE();
+
+		auto jsonRecordPathIt = data.find("recordPath");
+
+		if (jsonRecordPathIt != data.end())
+		{
+			if (!jsonRecordPathIt->is_string() || jsonRecordPathIt->get<std::string>().empty())
+				MS_THROW_TYPE_ERROR("wrong recordPath (not a non empty string)");
+
+			// This may throw.
+			this->rtpRecorder = new RTC::RtpRecorder(jsonRecordPathIt->get<std::string>());
+		}
 	}
 
 	DirectTransport::~DirectTransport()
@@ -22,6 +76,10 @@ namespace RTC
 		MS_TRACE();
 
 		delete[] this->buffer;
+
+		// Remaining packets are written before it's deleted.
+		delete this->rtpRecorder;
+		this->rtpRecorder = nullptr;
 	}
 
 	void DirectTransport::FillJson(json& jsonObject) const
@@ -30,6 +88,10 @@ namespace RTC
 
 		// Call the parent method.
 		RTC::Transport::FillJson(jsonObject);
+
+		// Add recordPath.
+		if (this->rtpRecorder)
+			jsonObject["recordPath"] = this->rtpRecorder->GetPath();
 	}
 
 	void DirectTransport::FillJsonStats(json& jsonArray)
@@ -43,6 +105,10 @@ namespace RTC
 
 		// Add type.
 		jsonObject["type"] = "direct-transport";
+
+		// Add recording.
+		if (this->rtpRecorder)
+			this->rtpRecorder->FillJsonStats(jsonObject["recording"]);
 	}
 
 	void DirectTransport::HandleRequest(Channel::ChannelRequest* request)
@@ -74,6 +140,11 @@ namespace RTC
 					return;
 				}
 
+				MayCaptureRtcpPacket(RTC::PacketCapture::Direction::IN, data, len);
+
+				// Parsed RTCP objects are released all together after being handled.
+				RTC::RTCP::Arena::Scope arenaScope;
+
 				RTC::RTCP::Packet* packet = RTC::RTCP::Packet::Parse(data, len);
 
 				if (!packet)
@@ -104,14 +175,32 @@ namespace RTC
 					return;
 				}
 
-				// If this is the first time to reveive a RTP packet then allocate the receiving buffer now.
-				if (!this->buffer)
-					this->buffer = new uint8_t[RTC::MtuSize + 100];
+				uint8_t* buffer;
+
+				// The packet is fully handled before the embedder gets its buffer back,
+				// so parse it in place if it has room to be expanded later.
+				// clang-format off
+				if (
+					notification->writablePayload &&
+					notification->payloadCapacity >= RTC::MtuSize + 100
+				)
+				// clang-format on
+				{
+					buffer = notification->writablePayload;
+				}
+				else
+				{
+					// If this is the first time to reveive a RTP packet then allocate the receiving buffer now.
+					if (!this->buffer)
+						this->buffer = new uint8_t[RTC::MtuSize + 100];
+
+					// Copy the received packet into this buffer so it can be expanded later.
+					std::memcpy(this->buffer, data, static_cast<size_t>(len));
 
-				// Copy the received packet into this buffer so it can be expanded later.
-				std::memcpy(this->buffer, data, static_cast<size_t>(len));
+					buffer = this->buffer;
+				}
 
-				RTC::RtpPacket* packet = RTC::RtpPacket::Parse(this->buffer, len);
+				RTC::RtpPacket* packet = RTC::RtpPacket::Parse(buffer, len);
 
 				if (!packet)
 				{
@@ -120,6 +209,9 @@ namespace RTC
 					return;
 				}
 
+				// It was not read from a socket.
+				Metrics::MarkIngress();
+
 				// Pass the packet to the parent transport.
 				RTC::Transport::ReceiveRtpPacket(packet);
 
@@ -189,14 +281,14 @@ namespace RTC
 		const uint8_t* data = packet->GetData();
 		size_t len          = packet->GetSize();
 
-		// Notify the Node DirectTransport.
-		PayloadChannel::PayloadChannelNotifier::Emit(consumer->id, "rtp", data, len);
+		// Record it or notify the Node DirectTransport.
+		if (this->rtpRecorder)
+			this->rtpRecorder->Record(data, len, false);
+		else
+			PayloadChannel::PayloadChannelNotifier::Emit(consumer->id, "rtp", data, len);
 
 		if (cb)
-		{
 			(*cb)(true);
-			delete cb;
-		}
 
 		// Increase send transmission.
 		RTC::Transport::DataSent(len);
@@ -209,7 +301,11 @@ namespace RTC
 		const uint8_t* data = packet->GetData();
 		size_t len          = packet->GetSize();
 
-		// Notify the Node DirectTransport.
+		// Record it (Sender Reports are needed to sync streams) and notify the
+		// Node DirectTransport.
+		if (this->rtpRecorder)
+			this->rtpRecorder->Record(data, len, true);
+
 		PayloadChannel::PayloadChannelNotifier::Emit(this->id, "rtcp", data, len);
 
 		// Increase send transmission.
@@ -223,7 +319,11 @@ namespace RTC
 		const uint8_t* data = packet->GetData();
 		size_t len          = packet->GetSize();
 
-		// Notify the Node DirectTransport.
+		// Record it (Sender Reports are needed to sync streams) and notify the
+		// Node DirectTransport.
+		if (this->rtpRecorder)
+			this->rtpRecorder->Record(data, len, true);
+
 		PayloadChannel::PayloadChannelNotifier::Emit(this->id, "rtcp", data, len);
 
 		// Increase send transmission.
@@ -235,12 +335,12 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		// Emitted once for all the DataConsumers when the multicast ends.
+		if (DirectTransport::messageMulticast)
+			DirectTransport::multicastDataConsumerIds.push_back(std::addressof(dataConsumer->id));
 		// Notify the Node DirectTransport.
-		json data = json::object();
-
-		data["ppid"] = ppid;
-
-		PayloadChannel::PayloadChannelNotifier::Emit(dataConsumer->id, "message", data, msg, len);
+		else
+			PayloadChannel::PayloadChannelNotifier::Emit(dataConsumer->id, "message", ppid, msg, len);
 
 		// Increase send transmission.
 		RTC::Transport::DataSent(len);
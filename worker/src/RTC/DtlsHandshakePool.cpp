@@ -0,0 +1,278 @@
+#define MS_CLASS "RTC::DtlsHandshakePool"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/DtlsHandshakePool.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "ThreadPlacement.hpp"
+#include <openssl/err.h>
+#include <algorithm> // std::find_if(), std::remove_if()
+
+/* Static. */
+
+static constexpr int SslReadBufferSize{ 65536 };
+
+/* Static methods for UV callbacks. */
+
+inline static void onAsync(uv_async_t* /*handle*/)
+{
+	RTC::DtlsHandshakePool::OnUvAsync();
+}
+
+inline static void onClose(uv_handle_t* handle)
+{
+	delete reinterpret_cast<uv_async_t*>(handle);
+}
+
+namespace RTC
+{
+	/* Class variables. */
+
+	thread_local DtlsHandshakePool::Shared* DtlsHandshakePool::shared{ nullptr };
+	thread_local std::vector<std::thread> DtlsHandshakePool::threads;
+	thread_local bool DtlsHandshakePool::isPoolThread{ false };
+
+	/* Class methods. */
+
+	void DtlsHandshakePool::ClassInit(size_t numThreads)
+	{
+		MS_TRACE();
+
+		if (numThreads == 0u)
+			return;
+
+		MS_ASSERT(numThreads <= MaxThreads, "too many threads");
+
+		DtlsHandshakePool::shared = new Shared();
+		DtlsHandshakePool::shared->runningJobs.resize(numThreads, nullptr);
+
+		DtlsHandshakePool::shared->uvAsyncHandle = new uv_async_t;
+
+		int err = uv_async_init(
+		  DepLibUV::GetLoop(),
+		  DtlsHandshakePool::shared->uvAsyncHandle,
+		  static_cast<uv_async_cb>(onAsync));
+
+		if (err != 0)
+			MS_THROW_ERROR("uv_async_init() failed: %s", uv_strerror(err));
+
+		// It must not keep the loop alive.
+		uv_unref(reinterpret_cast<uv_handle_t*>(DtlsHandshakePool::shared->uvAsyncHandle));
+
+		for (size_t threadIdx{ 0u }; threadIdx < numThreads; ++threadIdx)
+		{
+			DtlsHandshakePool::threads.emplace_back(
+			  DtlsHandshakePool::ThreadMain, DtlsHandshakePool::shared, threadIdx);
+
+			// This may throw.
+			ThreadPlacement::ApplyToHelperThread(DtlsHandshakePool::threads.back());
+		}
+
+		MS_DEBUG_TAG(dtls, "DTLS handshake pool running [threads:%zu]", numThreads);
+	}
+
+	void DtlsHandshakePool::ClassDestroy()
+	{
+		MS_TRACE();
+
+		if (!DtlsHandshakePool::shared)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(DtlsHandshakePool::shared->mutex);
+
+			DtlsHandshakePool::shared->stopping = true;
+		}
+
+		DtlsHandshakePool::shared->submittedCv.notify_all();
+
+		for (auto& thread : DtlsHandshakePool::threads)
+		{
+			thread.join();
+		}
+		DtlsHandshakePool::threads.clear();
+
+		uv_close(
+		  reinterpret_cast<uv_handle_t*>(DtlsHandshakePool::shared->uvAsyncHandle),
+		  static_cast<uv_close_cb>(onClose));
+
+		for (auto* job : DtlsHandshakePool::shared->pendingJobs)
+		{
+			delete job;
+		}
+
+		for (auto* job : DtlsHandshakePool::shared->doneJobs)
+		{
+			delete job;
+		}
+
+		delete DtlsHandshakePool::shared;
+		DtlsHandshakePool::shared = nullptr;
+	}
+
+	void DtlsHandshakePool::ProcessDtlsData(
+	  Listener* listener, SSL* ssl, BIO* sslBioFromNetwork, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(DtlsHandshakePool::shared, "DTLS handshake pool not enabled");
+
+		auto* job = new Job();
+
+		job->listener          = listener;
+		job->ssl               = ssl;
+		job->sslBioFromNetwork = sslBioFromNetwork;
+		job->data.assign(data, data + len);
+
+		{
+			std::lock_guard<std::mutex> lock(DtlsHandshakePool::shared->mutex);
+
+			DtlsHandshakePool::shared->pendingJobs.push_back(job);
+		}
+
+		DtlsHandshakePool::shared->submittedCv.notify_one();
+	}
+
+	void DtlsHandshakePool::RemoveListener(Listener* listener)
+	{
+		MS_TRACE();
+
+		if (!DtlsHandshakePool::shared)
+			return;
+
+		auto isListenerJob = [listener](const Job* job)
+		{
+			if (job->listener != listener)
+				return false;
+
+			delete job;
+
+			return true;
+		};
+
+		std::unique_lock<std::mutex> lock(DtlsHandshakePool::shared->mutex);
+
+		auto& pendingJobs = DtlsHandshakePool::shared->pendingJobs;
+
+		pendingJobs.erase(
+		  std::remove_if(pendingJobs.begin(), pendingJobs.end(), isListenerJob), pendingJobs.end());
+
+		// Pool threads may be using its SSL instance.
+		DtlsHandshakePool::shared->doneCv.wait(
+		  lock,
+		  [listener]()
+		  {
+			  auto& runningJobs = DtlsHandshakePool::shared->runningJobs;
+
+			  return std::find_if(
+			           runningJobs.begin(),
+			           runningJobs.end(),
+			           [listener](const Job* job)
+			           { return job && job->listener == listener; }) == runningJobs.end();
+		  });
+
+		auto& doneJobs = DtlsHandshakePool::shared->doneJobs;
+
+		doneJobs.erase(
+		  std::remove_if(doneJobs.begin(), doneJobs.end(), isListenerJob), doneJobs.end());
+	}
+
+	inline void DtlsHandshakePool::OnUvAsync()
+	{
+		MS_TRACE();
+
+		// NOTE: The lock is not held while calling listeners since they may submit
+		// new jobs or remove themselves.
+		while (true)
+		{
+			Job* job;
+
+			{
+				std::lock_guard<std::mutex> lock(DtlsHandshakePool::shared->mutex);
+
+				if (DtlsHandshakePool::shared->doneJobs.empty())
+					return;
+
+				job = DtlsHandshakePool::shared->doneJobs.front();
+				DtlsHandshakePool::shared->doneJobs.pop_front();
+			}
+
+			job->listener->OnDtlsHandshakePoolDataProcessed(
+			  job->read,
+			  job->sslError,
+			  job->opensslErrors,
+			  job->data.data(),
+			  job->data.size(),
+			  job->elapsedNs);
+
+			delete job;
+		}
+	}
+
+	void DtlsHandshakePool::ThreadMain(Shared* shared, size_t threadIdx)
+	{
+		// NOTE: No logging here since the Logger only works in the loop thread.
+
+		DtlsHandshakePool::isPoolThread = true;
+
+		std::vector<uint8_t> sslReadBuffer(SslReadBufferSize);
+
+		while (true)
+		{
+			Job* job;
+
+			{
+				std::unique_lock<std::mutex> lock(shared->mutex);
+
+				shared->submittedCv.wait(
+				  lock, [shared]() { return shared->stopping || !shared->pendingJobs.empty(); });
+
+				if (shared->stopping)
+					return;
+
+				job = shared->pendingJobs.front();
+				shared->pendingJobs.pop_front();
+
+				shared->runningJobs[threadIdx] = job;
+			}
+
+			ERR_clear_error();
+
+			const uint64_t startNs = uv_hrtime();
+
+			BIO_write(
+			  job->sslBioFromNetwork,
+			  static_cast<const void*>(job->data.data()),
+			  static_cast<int>(job->data.size()));
+
+			job->read =
+			  SSL_read(job->ssl, static_cast<void*>(sslReadBuffer.data()), SslReadBufferSize);
+			job->sslError  = SSL_get_error(job->ssl, job->read);
+			job->elapsedNs = uv_hrtime() - startNs;
+
+			unsigned long err;
+
+			while ((err = ERR_get_error()) != 0)
+			{
+				job->opensslErrors.push_back(err);
+			}
+
+			if (job->read > 0)
+				job->data.assign(sslReadBuffer.data(), sslReadBuffer.data() + job->read);
+			else
+				job->data.clear();
+
+			{
+				std::lock_guard<std::mutex> lock(shared->mutex);
+
+				shared->runningJobs[threadIdx] = nullptr;
+				shared->doneJobs.push_back(job);
+			}
+
+			uv_async_send(shared->uvAsyncHandle);
+
+			shared->doneCv.notify_all();
+		}
+	}
+} // namespace RTC
@@ -6,11 +6,17 @@
 #include "MediaSoupErrors.hpp"
 #include "Settings.hpp"
 #include "Utils.hpp"
+#include <openssl/core_names.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
+#include <openssl/rand.h>
 #include <uv.h>
-#include <cstdio>  // std::sprintf(), std::fopen()
+#include <cstdio>  // std::sprintf(), std::fopen(), std::rename(), std::remove()
 #include <cstring> // std::memcpy(), std::strcmp()
+#include <ctime>   // std::time()
+#ifndef _WIN32
+#include <sys/stat.h> // chmod()
+#endif
 
 #define LOG_OPENSSL_ERROR(desc)                                                                    \
 	do                                                                                               \
@@ -43,6 +49,17 @@ inline static void onSslInfo(const SSL* ssl, int where, int ret)
 	static_cast<RTC::DtlsTransport*>(SSL_get_ex_data(ssl, 0))->OnSslInfo(where, ret);
 }
 
+inline static int onSslSessionTicketKey(
+  SSL* ssl,
+  unsigned char* keyName,
+  unsigned char* iv,
+  EVP_CIPHER_CTX* cipherCtx,
+  EVP_MAC_CTX* macCtx,
+  int enc)
+{
+	return RTC::DtlsTransport::ProcessSessionTicketKey(ssl, keyName, iv, cipherCtx, macCtx, enc);
+}
+
 inline static unsigned int onSslDtlsTimer(SSL* /*ssl*/, unsigned int timerUs)
 {
 	if (timerUs == 0)
@@ -59,6 +76,13 @@ namespace RTC
 
 	// clang-format off
 	static constexpr int DtlsMtu{ 1350 };
+	// Validity of generated DTLS certificates (10 years).
+	static constexpr long CertificateValidity{ 315360000 };
+	// Validity of cached DTLS certificates (30 days) so they are rotated.
+	static constexpr long CachedCertificateValidity{ 2592000 };
+	// Cached DTLS certificates are rotated once they expire within 1 day.
+	static constexpr long CachedCertificateExpiryMargin{ 86400 };
+	static constexpr const char* CachedCertificateFileName{ "mediasoup-dtls.pem" };
 	static constexpr int SslReadBufferSize{ 65536 };
 	// AES-HMAC: http://tools.ietf.org/html/rfc3711
 	static constexpr size_t SrtpMasterKeyLength{ 16 };
@@ -111,6 +135,17 @@ namespace RTC
 		{ RTC::SrtpSession::CryptoSuite::AES_CM_128_HMAC_SHA1_32, "SRTP_AES128_CM_SHA1_32" }
 	};
 	// clang-format on
+	// NOTE: Not thread_local since they are shared by workers running in
+	// different threads.
+	std::mutex DtlsTransport::sharedCertificatesMutex;
+	absl::flat_hash_map<std::string, DtlsTransport::SharedCertificate>
+	  DtlsTransport::sharedCertificates;
+	thread_local DtlsTransport::SessionTickets* DtlsTransport::sessionTickets{ nullptr };
+	thread_local uint64_t DtlsTransport::fullHandshakes{ 0u };
+	thread_local uint64_t DtlsTransport::resumedHandshakes{ 0u };
+	thread_local uint64_t DtlsTransport::dtls13Handshakes{ 0u };
+	thread_local Metrics::Histogram* DtlsTransport::fullHandshakeCpuTimes{ nullptr };
+	thread_local Metrics::Histogram* DtlsTransport::resumedHandshakeCpuTimes{ nullptr };
 
 	/* Class methods. */
 
@@ -118,23 +153,88 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		// Generate a X509 certificate and private key (unless PEM files are provided).
+		DtlsTransport::fullHandshakeCpuTimes    = new Metrics::Histogram();
+		DtlsTransport::resumedHandshakeCpuTimes = new Metrics::Histogram();
+
+		// Read the X509 certificate and private key from PEM files if provided.
 		if (
-		  Settings::configuration.dtlsCertificateFile.empty() ||
-		  Settings::configuration.dtlsPrivateKeyFile.empty())
+		  !Settings::configuration.dtlsCertificateFile.empty() &&
+		  !Settings::configuration.dtlsPrivateKeyFile.empty())
 		{
-			GenerateCertificateAndPrivateKey();
+			ReadCertificateAndPrivateKeyFromFiles();
+
+			// Generated (and cached) ones are always P-256 ECDSA.
+			if (Settings::configuration.dtlsEcdsaOnly)
+				CheckEcdsaOnlyPrivateKey();
+
+			// Create a global SSL_CTX.
+			CreateSslCtx();
+
+			// Generate certificate fingerprints.
+			GenerateFingerprints();
+
+			return;
 		}
-		else
+
+		// Otherwise reuse the one generated by a previous worker in this process
+		// or generate it (or read it from the cache directory if given).
+		const std::string& cacheDir = Settings::configuration.dtlsCertificateCacheDir;
+
 		{
-			ReadCertificateAndPrivateKeyFromFiles();
+			std::lock_guard<std::mutex> lock(DtlsTransport::sharedCertificatesMutex);
+
+			auto it = DtlsTransport::sharedCertificates.find(cacheDir);
+
+			// Cached certificates must be rotated even if the process lives long.
+			if (
+			  it != DtlsTransport::sharedCertificates.end() && !cacheDir.empty() &&
+			  IsCertificateExpiring(it->second.certificate))
+			{
+				X509_free(it->second.certificate);
+				EVP_PKEY_free(it->second.privateKey);
+
+				DtlsTransport::sharedCertificates.erase(it);
+
+				it = DtlsTransport::sharedCertificates.end();
+			}
+
+			if (it == DtlsTransport::sharedCertificates.end())
+			{
+				if (cacheDir.empty())
+					GenerateCertificateAndPrivateKey(CertificateValidity);
+				else
+					ReadOrGenerateCachedCertificateAndPrivateKey(cacheDir);
+
+				// Generate certificate fingerprints.
+				GenerateFingerprints();
+
+				auto& sharedCertificate = DtlsTransport::sharedCertificates[cacheDir];
+
+				// Keep a reference for the next workers.
+				X509_up_ref(DtlsTransport::certificate);
+				EVP_PKEY_up_ref(DtlsTransport::privateKey);
+
+				sharedCertificate.certificate  = DtlsTransport::certificate;
+				sharedCertificate.privateKey   = DtlsTransport::privateKey;
+				sharedCertificate.fingerprints = DtlsTransport::localFingerprints;
+			}
+			else
+			{
+				MS_DEBUG_TAG(dtls, "reusing DTLS certificate generated by another worker");
+
+				auto& sharedCertificate = it->second;
+
+				X509_up_ref(sharedCertificate.certificate);
+				EVP_PKEY_up_ref(sharedCertificate.privateKey);
+
+				DtlsTransport::certificate       = sharedCertificate.certificate;
+				DtlsTransport::privateKey        = sharedCertificate.privateKey;
+				DtlsTransport::localFingerprints = sharedCertificate.fingerprints;
+			}
 		}
 
 		// Create a global SSL_CTX.
 		CreateSslCtx();
-
-		// Generate certificate fingerprints.
-		GenerateFingerprints();
 	}
 
 	void DtlsTransport::ClassDestroy()
@@ -147,9 +247,123 @@ namespace RTC
 			X509_free(DtlsTransport::certificate);
 		if (DtlsTransport::sslCtx)
 			SSL_CTX_free(DtlsTransport::sslCtx);
+
+		delete DtlsTransport::sessionTickets;
+		DtlsTransport::sessionTickets = nullptr;
+
+		delete DtlsTransport::fullHandshakeCpuTimes;
+		DtlsTransport::fullHandshakeCpuTimes = nullptr;
+
+		delete DtlsTransport::resumedHandshakeCpuTimes;
+		DtlsTransport::resumedHandshakeCpuTimes = nullptr;
+	}
+
+	int DtlsTransport::ProcessSessionTicketKey(
+	  SSL* ssl,
+	  unsigned char* keyName,
+	  unsigned char* iv,
+	  EVP_CIPHER_CTX* cipherCtx,
+	  EVP_MAC_CTX* macCtx,
+	  int enc)
+	{
+		// NOTE: Called from DTLS handshake pool threads too, so neither logs nor
+		// thread_local variables are used here.
+
+		auto* sessionTickets =
+		  static_cast<SessionTickets*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), 0));
+		const std::lock_guard<std::mutex> lock(sessionTickets->mutex);
+		const uint64_t nowNs = uv_hrtime();
+
+		if (nowNs - sessionTickets->rotatedAtNs >= SessionTicketKeyRotationInterval * 1000000000u)
+		{
+			sessionTickets->previousKey    = sessionTickets->currentKey;
+			sessionTickets->hasPreviousKey = true;
+			sessionTickets->rotatedAtNs    = nowNs;
+
+			GenerateSessionTicketKey(sessionTickets->currentKey);
+		}
+
+		const SessionTicketKey* key{ nullptr };
+		// 1 means valid ticket, 2 means valid ticket that must be renewed.
+		int ret{ 1 };
+
+		// Encrypt a new ticket with the current key.
+		if (enc == 1)
+		{
+			key = std::addressof(sessionTickets->currentKey);
+
+			if (RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) != 1)
+				return -1;
+
+			std::memcpy(keyName, key->name, sizeof(key->name));
+
+			if (EVP_EncryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key->aesKey, iv) != 1)
+				return -1;
+		}
+		// Decrypt a ticket with the key it was encrypted with.
+		else
+		{
+			if (std::memcmp(keyName, sessionTickets->currentKey.name, sizeof(SessionTicketKey::name)) == 0)
+			{
+				key = std::addressof(sessionTickets->currentKey);
+			}
+			else if (
+			  sessionTickets->hasPreviousKey &&
+			  std::memcmp(keyName, sessionTickets->previousKey.name, sizeof(SessionTicketKey::name)) == 0)
+			{
+				key = std::addressof(sessionTickets->previousKey);
+				ret = 2;
+			}
+			// Unknown or expired key, so do a full handshake.
+			else
+			{
+				return 0;
+			}
+
+			if (EVP_DecryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key->aesKey, iv) != 1)
+				return -1;
+		}
+
+		// clang-format off
+		OSSL_PARAM params[] =
+		{
+			OSSL_PARAM_construct_octet_string(
+				OSSL_MAC_PARAM_KEY, const_cast<uint8_t*>(key->hmacKey), sizeof(key->hmacKey)),
+			OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char*>("SHA256"), 0),
+			OSSL_PARAM_construct_end()
+		};
+		// clang-format on
+
+		if (EVP_MAC_CTX_set_params(macCtx, params) != 1)
+			return -1;
+
+		return ret;
+	}
+
+	void DtlsTransport::FillJsonHandshakes(json& jsonObject)
+	{
+		MS_TRACE();
+
+		jsonObject["sessionResumption"] = DtlsTransport::sessionTickets != nullptr;
+		jsonObject["ecdsaOnly"]         = Settings::configuration.dtlsEcdsaOnly;
+		jsonObject["full"]              = DtlsTransport::fullHandshakes;
+		jsonObject["resumed"]           = DtlsTransport::resumedHandshakes;
+		jsonObject["dtls13"]            = DtlsTransport::dtls13Handshakes;
+
+		if (DtlsTransport::fullHandshakeCpuTimes)
+		{
+			DtlsTransport::fullHandshakeCpuTimes->FillJson(
+			  jsonObject["fullCpuTime"], 1.0, /*withBuckets*/ false);
+		}
+
+		if (DtlsTransport::resumedHandshakeCpuTimes)
+		{
+			DtlsTransport::resumedHandshakeCpuTimes->FillJson(
+			  jsonObject["resumedCpuTime"], 1.0, /*withBuckets*/ false);
+		}
 	}
 
-	void DtlsTransport::GenerateCertificateAndPrivateKey()
+	void DtlsTransport::GenerateCertificateAndPrivateKey(long validity)
 	{
 		MS_TRACE();
 
@@ -158,7 +372,8 @@ namespace RTC
 		std::string subject =
 		  std::string("mediasoup") + std::to_string(Utils::Crypto::GetRandomUInt(100000, 999999));
 
-		// Create key with curve.
+		// Create key with curve. Being a named curve, OpenSSL signs with its
+		// optimized P-256 implementation and precomputed tables.
 		DtlsTransport::privateKey = EVP_EC_gen(SN_X9_62_prime256v1);
 
 		if (!DtlsTransport::privateKey)
@@ -187,8 +402,8 @@ namespace RTC
 		  static_cast<uint64_t>(Utils::Crypto::GetRandomUInt(1000000, 9999999)));
 
 		// Set valid period.
-		X509_gmtime_adj(X509_get_notBefore(DtlsTransport::certificate), -315360000); // -10 years.
-		X509_gmtime_adj(X509_get_notAfter(DtlsTransport::certificate), 315360000);   // 10 years.
+		X509_gmtime_adj(X509_get_notBefore(DtlsTransport::certificate), -validity);
+		X509_gmtime_adj(X509_get_notAfter(DtlsTransport::certificate), validity);
 
 		// Set the public key for the certificate using the key.
 		ret = X509_set_pubkey(DtlsTransport::certificate, DtlsTransport::privateKey);
@@ -248,6 +463,31 @@ namespace RTC
 		MS_THROW_ERROR("DTLS certificate and private key generation failed");
 	}
 
+	void DtlsTransport::CheckEcdsaOnlyPrivateKey()
+	{
+		MS_TRACE();
+
+		char groupName[64];
+		size_t groupNameLen{ 0u };
+
+		// Keys with explicit curve parameters (instead of a named curve) are not
+		// accepted since OpenSSL signs with them using the slow generic code.
+		// clang-format off
+		if (
+			EVP_PKEY_get_base_id(DtlsTransport::privateKey) != EVP_PKEY_EC ||
+			EVP_PKEY_get_group_name(
+				DtlsTransport::privateKey, groupName, sizeof(groupName), &groupNameLen) != 1 ||
+			(
+				OBJ_sn2nid(groupName) != NID_X9_62_prime256v1 &&
+				EC_curve_nist2nid(groupName) != NID_X9_62_prime256v1
+			)
+		)
+		// clang-format on
+		{
+			MS_THROW_TYPE_ERROR("dtlsEcdsaOnly requires a P-256 ECDSA private key");
+		}
+	}
+
 	void DtlsTransport::ReadCertificateAndPrivateKeyFromFiles()
 	{
 		MS_TRACE();
@@ -301,6 +541,112 @@ namespace RTC
 		MS_THROW_ERROR("error reading DTLS certificate and private key PEM files");
 	}
 
+	void DtlsTransport::ReadOrGenerateCachedCertificateAndPrivateKey(const std::string& cacheDir)
+	{
+		MS_TRACE();
+
+		// Both of them are in the same file so they are replaced at once.
+		const std::string cachePath = cacheDir + "/" + CachedCertificateFileName;
+		FILE* file                  = fopen(cachePath.c_str(), "r");
+
+		if (file)
+		{
+			X509* certificate    = PEM_read_X509(file, nullptr, nullptr, nullptr);
+			EVP_PKEY* privateKey = PEM_read_PrivateKey(file, nullptr, nullptr, nullptr);
+
+			fclose(file);
+
+			// clang-format off
+			if (
+				certificate &&
+				privateKey &&
+				X509_check_private_key(certificate, privateKey) == 1 &&
+				!IsCertificateExpiring(certificate)
+			)
+			// clang-format on
+			{
+				MS_DEBUG_TAG(dtls, "using cached DTLS certificate [path:%s]", cachePath.c_str());
+
+				DtlsTransport::certificate = certificate;
+				DtlsTransport::privateKey  = privateKey;
+
+				return;
+			}
+
+			MS_DEBUG_TAG(
+			  dtls,
+			  "cached DTLS certificate invalid or expiring, rotating it [path:%s]",
+			  cachePath.c_str());
+
+			if (certificate)
+				X509_free(certificate);
+
+			if (privateKey)
+				EVP_PKEY_free(privateKey);
+
+			ERR_clear_error();
+		}
+
+		GenerateCertificateAndPrivateKey(CachedCertificateValidity);
+		WriteCachedCertificateAndPrivateKey(cachePath);
+	}
+
+	void DtlsTransport::WriteCachedCertificateAndPrivateKey(const std::string& cachePath)
+	{
+		MS_TRACE();
+
+		// Write into a temporary file and rename it so other workers never read
+		// a partially written one.
+		const std::string tmpPath =
+		  cachePath + ".tmp" + std::to_string(Utils::Crypto::GetRandomUInt(100000, 999999));
+		FILE* file = fopen(tmpPath.c_str(), "w");
+
+		if (!file)
+		{
+			MS_WARN_TAG(dtls, "cannot write cached DTLS certificate: %s", std::strerror(errno));
+
+			return;
+		}
+
+#ifndef _WIN32
+		// The private key must only be readable by the owner.
+		chmod(tmpPath.c_str(), S_IRUSR | S_IWUSR);
+#endif
+
+		int ret = PEM_write_X509(file, DtlsTransport::certificate);
+
+		if (ret == 1)
+		{
+			ret = PEM_write_PrivateKey(
+			  file, DtlsTransport::privateKey, nullptr, nullptr, 0, nullptr, nullptr);
+		}
+
+		if (fclose(file) != 0)
+			ret = 0;
+
+		if (ret != 1 || std::rename(tmpPath.c_str(), cachePath.c_str()) != 0)
+		{
+			MS_WARN_TAG(dtls, "cannot write cached DTLS certificate [path:%s]", cachePath.c_str());
+
+			std::remove(tmpPath.c_str());
+			ERR_clear_error();
+
+			return;
+		}
+
+		MS_DEBUG_TAG(dtls, "DTLS certificate cached [path:%s]", cachePath.c_str());
+	}
+
+	bool DtlsTransport::IsCertificateExpiring(X509* certificate)
+	{
+		MS_TRACE();
+
+		time_t time = std::time(nullptr) + CachedCertificateExpiryMargin;
+
+		// It returns 0 on error.
+		return X509_cmp_time(X509_get0_notAfter(certificate), &time) <= 0;
+	}
+
 	void DtlsTransport::CreateSslCtx()
 	{
 		MS_TRACE();
@@ -310,7 +656,8 @@ namespace RTC
 
 		/* Set the global DTLS context. */
 
-		// Both DTLS 1.0 and 1.2 (requires OpenSSL >= 1.1.0).
+		// DTLS 1.0, 1.2 and, if enabled and supported, 1.3 (requires OpenSSL >=
+		// 1.1.0).
 		DtlsTransport::sslCtx = SSL_CTX_new(DTLS_method());
 
 		if (!DtlsTransport::sslCtx)
@@ -350,12 +697,58 @@ namespace RTC
 		// Set options.
 		SSL_CTX_set_options(
 		  DtlsTransport::sslCtx,
-		  SSL_OP_CIPHER_SERVER_PREFERENCE | SSL_OP_NO_TICKET | SSL_OP_SINGLE_ECDH_USE |
-		    SSL_OP_NO_QUERY_MTU);
+		  SSL_OP_CIPHER_SERVER_PREFERENCE | SSL_OP_SINGLE_ECDH_USE | SSL_OP_NO_QUERY_MTU);
+
+		// Negotiate DTLS 1.3 just if enabled, so its 1-RTT handshake is used with
+		// peers supporting it while the rest fall back to DTLS 1.2.
+		// NOTE: DTLS1_3_VERSION is not defined by SSL libraries without DTLS 1.3
+		// support.
+#ifdef DTLS1_3_VERSION
+		ret = SSL_CTX_set_max_proto_version(
+		  DtlsTransport::sslCtx,
+		  Settings::configuration.dtls13 ? DTLS1_3_VERSION : DTLS1_2_VERSION);
+#else
+		if (Settings::configuration.dtls13)
+			MS_WARN_TAG(dtls, "DTLS 1.3 not supported by the SSL library, using DTLS 1.2");
+
+		ret = SSL_CTX_set_max_proto_version(DtlsTransport::sslCtx, DTLS1_2_VERSION);
+#endif
+
+		if (ret == 0)
+		{
+			LOG_OPENSSL_ERROR("SSL_CTX_set_max_proto_version() failed");
+
+			goto error;
+		}
 
 		// Don't use sessions cache.
 		SSL_CTX_set_session_cache_mode(DtlsTransport::sslCtx, SSL_SESS_CACHE_OFF);
 
+		// Let clients resume their sessions with stateless session tickets whose
+		// keys are owned by this worker.
+		if (Settings::configuration.dtlsSessionResumption)
+		{
+			DtlsTransport::sessionTickets              = new SessionTickets();
+			DtlsTransport::sessionTickets->rotatedAtNs = uv_hrtime();
+
+			GenerateSessionTicketKey(DtlsTransport::sessionTickets->currentKey);
+
+			SSL_CTX_set_ex_data(DtlsTransport::sslCtx, 0, DtlsTransport::sessionTickets);
+			SSL_CTX_set_tlsext_ticket_key_evp_cb(DtlsTransport::sslCtx, onSslSessionTicketKey);
+
+			// Required to resume sessions since the peer certificate is verified.
+			SSL_CTX_set_session_id_context(
+			  DtlsTransport::sslCtx, reinterpret_cast<const unsigned char*>("mediasoup"), 9);
+
+			// Tickets of the previous key are valid until the next rotation.
+			SSL_CTX_set_timeout(
+			  DtlsTransport::sslCtx, static_cast<long>(2 * SessionTicketKeyRotationInterval));
+		}
+		else
+		{
+			SSL_CTX_set_options(DtlsTransport::sslCtx, SSL_OP_NO_TICKET);
+		}
+
 		// Read always as much into the buffer as possible.
 		// NOTE: This is the default for DTLS, but a bug in non latest OpenSSL
 		// versions makes this call required.
@@ -371,8 +764,24 @@ namespace RTC
 		SSL_CTX_set_info_callback(DtlsTransport::sslCtx, onSslInfo);
 
 		// Set ciphers.
-		ret = SSL_CTX_set_cipher_list(
-		  DtlsTransport::sslCtx, "DEFAULT:!NULL:!aNULL:!SHA256:!SHA384:!aECDH:!AESGCM+AES256:!aPSK");
+		// NOTE: With dtlsEcdsaOnly just ECDHE-ECDSA ones (as browsers use) are
+		// offered, and the ECDHE key exchange is limited to the cheapest curves.
+		if (Settings::configuration.dtlsEcdsaOnly)
+		{
+			ret = SSL_CTX_set_cipher_list(
+			  DtlsTransport::sslCtx,
+			  "ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-ECDSA-CHACHA20-POLY1305:"
+			  "ECDHE-ECDSA-AES128-SHA:ECDHE-ECDSA-AES256-SHA");
+
+			if (ret == 1)
+				ret = SSL_CTX_set1_groups_list(DtlsTransport::sslCtx, "X25519:P-256");
+		}
+		else
+		{
+			ret = SSL_CTX_set_cipher_list(
+			  DtlsTransport::sslCtx,
+			  "DEFAULT:!NULL:!aNULL:!SHA256:!SHA384:!aECDH:!AESGCM+AES256:!aPSK");
+		}
 
 		if (ret == 0)
 		{
@@ -428,6 +837,22 @@ namespace RTC
 		MS_THROW_ERROR("SSL context creation failed");
 	}
 
+	void DtlsTransport::GenerateSessionTicketKey(SessionTicketKey& key)
+	{
+		// NOTE: Called from DTLS handshake pool threads too, so no MS_TRACE().
+
+		// clang-format off
+		if (
+			RAND_bytes(key.name, sizeof(key.name)) != 1 ||
+			RAND_bytes(key.aesKey, sizeof(key.aesKey)) != 1 ||
+			RAND_bytes(key.hmacKey, sizeof(key.hmacKey)) != 1
+		)
+		// clang-format on
+		{
+			MS_ABORT("RAND_bytes() failed");
+		}
+	}
+
 	void DtlsTransport::GenerateFingerprints()
 	{
 		MS_TRACE();
@@ -574,6 +999,8 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		RTC::DtlsHandshakePool::RemoveListener(this);
+
 		if (IsRunning())
 		{
 			// Send close alert to the peer.
@@ -678,7 +1105,13 @@ namespace RTC
 				MS_DEBUG_TAG(dtls, "running [role:client]");
 
 				SSL_set_connect_state(this->ssl);
+
+				const uint64_t startNs = uv_hrtime();
+
 				SSL_do_handshake(this->ssl);
+
+				this->handshakeCpuTimeNs += uv_hrtime() - startNs;
+
 				SendPendingOutgoingDtlsData();
 				SetTimeout();
 
@@ -737,6 +1170,23 @@ namespace RTC
 			return;
 		}
 
+		// Let the DTLS handshake pool (if enabled) run the handshake. The SSL
+		// instance cannot be used until it's done with it.
+		if (this->handshakeJobInFlight)
+		{
+			this->pendingDtlsData.emplace_back(data, data + len);
+
+			return;
+		}
+		else if (!this->handshakeDone && RTC::DtlsHandshakePool::IsEnabled())
+		{
+			this->handshakeJobInFlight = true;
+
+			RTC::DtlsHandshakePool::ProcessDtlsData(this, this->ssl, this->sslBioFromNetwork, data, len);
+
+			return;
+		}
+
 		// Write the received DTLS data into the sslBioFromNetwork.
 		written =
 		  BIO_write(this->sslBioFromNetwork, static_cast<const void*>(data), static_cast<int>(len));
@@ -750,35 +1200,16 @@ namespace RTC
 			  len);
 		}
 
+		const bool inHandshake = !this->handshakeDone;
+		const uint64_t startNs = inHandshake ? uv_hrtime() : 0u;
+
 		// Must call SSL_read() to process received DTLS data.
 		read = SSL_read(this->ssl, static_cast<void*>(DtlsTransport::sslReadBuffer), SslReadBufferSize);
 
-		// Send data if it's ready.
-		SendPendingOutgoingDtlsData();
+		if (inHandshake)
+			this->handshakeCpuTimeNs += uv_hrtime() - startNs;
 
-		// Check SSL status and return if it is bad/closed.
-		if (!CheckStatus(read))
-			return;
-
-		// Set/update the DTLS timeout.
-		if (!SetTimeout())
-			return;
-
-		// Application data received. Notify to the listener.
-		if (read > 0)
-		{
-			// It is allowed to receive DTLS data even before validating remote fingerprint.
-			if (!this->handshakeDone)
-			{
-				MS_WARN_TAG(dtls, "ignoring application data received while DTLS handshake not done");
-
-				return;
-			}
-
-			// Notify the listener.
-			this->listener->OnDtlsTransportApplicationDataReceived(
-			  this, (uint8_t*)DtlsTransport::sslReadBuffer, static_cast<size_t>(read));
-		}
+		ProcessSslRead(read, SSL_get_error(this->ssl, read), DtlsTransport::sslReadBuffer);
 	}
 
 	void DtlsTransport::SendApplicationData(const uint8_t* data, size_t len)
@@ -832,6 +1263,12 @@ namespace RTC
 
 		MS_WARN_TAG(dtls, "resetting DTLS transport");
 
+		// Discard DTLS data pending to be processed.
+		RTC::DtlsHandshakePool::RemoveListener(this);
+
+		this->handshakeJobInFlight = false;
+		this->pendingDtlsData.clear();
+
 		// Stop the DTLS timer.
 		this->timer->Stop();
 
@@ -842,8 +1279,9 @@ namespace RTC
 
 		this->localRole        = Role::NONE;
 		this->state            = DtlsState::NEW;
-		this->handshakeDone    = false;
-		this->handshakeDoneNow = false;
+		this->handshakeDone      = false;
+		this->handshakeDoneNow   = false;
+		this->handshakeCpuTimeNs = 0u;
 
 		// Reset SSL status.
 		// NOTE: For this to properly work, SSL_shutdown() must be called before.
@@ -859,10 +1297,14 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		int err;
-		bool wasHandshakeDone = this->handshakeDone;
+		return CheckSslError(SSL_get_error(this->ssl, returnCode));
+	}
 
-		err = SSL_get_error(this->ssl, returnCode);
+	inline bool DtlsTransport::CheckSslError(int err)
+	{
+		MS_TRACE();
+
+		bool wasHandshakeDone = this->handshakeDone;
 
 		switch (err)
 		{
@@ -950,6 +1392,52 @@ namespace RTC
 		}
 	}
 
+	inline void DtlsTransport::ProcessSslRead(int read, int sslError, const uint8_t* data)
+	{
+		MS_TRACE();
+
+		// Send data if it's ready.
+		SendPendingOutgoingDtlsData();
+
+		// Check SSL status and return if it is bad/closed.
+		if (!CheckSslError(sslError))
+			return;
+
+		// Set/update the DTLS timeout.
+		if (!SetTimeout())
+			return;
+
+		// Application data received. Notify to the listener.
+		if (read > 0)
+		{
+			// It is allowed to receive DTLS data even before validating remote fingerprint.
+			if (!this->handshakeDone)
+			{
+				MS_WARN_TAG(dtls, "ignoring application data received while DTLS handshake not done");
+
+				return;
+			}
+
+			// Notify the listener.
+			this->listener->OnDtlsTransportApplicationDataReceived(this, data, static_cast<size_t>(read));
+		}
+	}
+
+	inline void DtlsTransport::ProcessPendingDtlsData()
+	{
+		MS_TRACE();
+
+		// Stop if a new handshake pool job was submitted for any of them.
+		while (!this->handshakeJobInFlight && !this->pendingDtlsData.empty())
+		{
+			auto data = std::move(this->pendingDtlsData.front());
+
+			this->pendingDtlsData.pop_front();
+
+			ProcessDtlsData(data.data(), data.size());
+		}
+	}
+
 	inline void DtlsTransport::SendPendingOutgoingDtlsData()
 	{
 		MS_TRACE();
@@ -1049,6 +1537,24 @@ namespace RTC
 			return false;
 		}
 
+		if (SSL_session_reused(this->ssl) == 1)
+		{
+			MS_DEBUG_TAG(dtls, "DTLS session resumed");
+
+			DtlsTransport::resumedHandshakes++;
+			DtlsTransport::resumedHandshakeCpuTimes->Record(this->handshakeCpuTimeNs);
+		}
+		else
+		{
+			DtlsTransport::fullHandshakes++;
+			DtlsTransport::fullHandshakeCpuTimes->Record(this->handshakeCpuTimeNs);
+		}
+
+#ifdef DTLS1_3_VERSION
+		if (SSL_version(this->ssl) == DTLS1_3_VERSION)
+			DtlsTransport::dtls13Handshakes++;
+#endif
+
 		// Get the negotiated SRTP crypto suite.
 		RTC::SrtpSession::CryptoSuite srtpCryptoSuite = GetNegotiatedSrtpCryptoSuite();
 
@@ -1345,6 +1851,15 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		// Called from a DTLS handshake pool thread, so cannot log.
+		if (RTC::DtlsHandshakePool::IsPoolThread())
+		{
+			if ((where & SSL_CB_HANDSHAKE_DONE) != 0)
+				this->handshakeDoneNow = true;
+
+			return;
+		}
+
 		int w = where & -SSL_ST_MASK;
 		const char* role;
 
@@ -1417,13 +1932,24 @@ namespace RTC
 		MS_TRACE();
 
 		// Workaround for https://github.com/openssl/openssl/issues/7998.
+		// NOTE: In DTLS 1.3 the last handshake flight and the session tickets are
+		// retransmitted until acknowledged, so the timer is needed once done.
+#ifdef DTLS1_3_VERSION
+		if (this->handshakeDone && SSL_version(this->ssl) != DTLS1_3_VERSION)
+#else
 		if (this->handshakeDone)
+#endif
 		{
 			MS_DEBUG_DEV("handshake is done so return");
 
 			return;
 		}
 
+		// The DTLS handshake pool is using the SSL instance. The timer will be set
+		// again once it's done.
+		if (this->handshakeJobInFlight)
+			return;
+
 		auto ret = DTLSv1_handle_timeout(this->ssl);
 
 		// -1 means that too many timeouts had expired without progress or an
@@ -1447,4 +1973,32 @@ namespace RTC
 			SetTimeout();
 		}
 	}
+
+	inline void DtlsTransport::OnDtlsHandshakePoolDataProcessed(
+	  int read,
+	  int sslError,
+	  const std::vector<unsigned long>& opensslErrors,
+	  const uint8_t* data,
+	  size_t /*len*/,
+	  uint64_t elapsedNs)
+	{
+		MS_TRACE();
+
+		this->handshakeJobInFlight = false;
+		this->handshakeCpuTimeNs += elapsedNs;
+
+		for (auto err : opensslErrors)
+		{
+			MS_ERROR(
+			  "OpenSSL error [desc:'SSL_read() in DTLS handshake pool', error:'%s']",
+			  ERR_error_string(err, nullptr));
+		}
+
+		ProcessSslRead(read, sslError, data);
+
+		// Process DTLS data received while the handshake pool was busy (unless the
+		// transport was reset).
+		if (IsRunning())
+			ProcessPendingDtlsData();
+	}
 } // namespace RTC
@@ -0,0 +1,251 @@
+#define MS_CLASS "RTC::EgressScheduler"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/EgressScheduler.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include <algorithm> // std::min(), std::remove_if()
+
+namespace RTC
+{
+	/* Static. */
+
+	static constexpr uint64_t DrainIntervalMs{ 5u };
+	// Queued packets are sent regardless of the budget after this time.
+	static constexpr uint64_t MaxQueueDelayMs{ 250u };
+
+	/* Class variables. */
+
+	thread_local EgressScheduler::TimerListener EgressScheduler::timerListener;
+	thread_local Timer* EgressScheduler::drainTimer{ nullptr };
+	thread_local std::deque<EgressScheduler::QueuedPacket> EgressScheduler::queue;
+	thread_local std::vector<std::unique_ptr<uint8_t[]>> EgressScheduler::buffers;
+	thread_local int64_t EgressScheduler::budget{ 0 };
+	thread_local uint64_t EgressScheduler::lastBudgetUpdateAtMs{ 0u };
+
+	/* Class methods. */
+
+	void EgressScheduler::ClassDestroy()
+	{
+		MS_TRACE();
+
+		delete EgressScheduler::drainTimer;
+		EgressScheduler::drainTimer = nullptr;
+
+		for (auto& queuedPacket : EgressScheduler::queue)
+		{
+			delete queuedPacket.packet;
+		}
+		EgressScheduler::queue.clear();
+		EgressScheduler::buffers.clear();
+
+		EgressScheduler::budget               = 0;
+		EgressScheduler::lastBudgetUpdateAtMs = 0u;
+	}
+
+	bool EgressScheduler::TryConsume(size_t size, uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		if (!EgressScheduler::IsEnabled())
+			return true;
+
+		UpdateBudget(nowMs);
+
+		if (EgressScheduler::budget <= 0)
+			return false;
+
+		EgressScheduler::budget -= static_cast<int64_t>(size);
+
+		return true;
+	}
+
+	void EgressScheduler::Consume(size_t size, uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		if (!EgressScheduler::IsEnabled())
+			return;
+
+		UpdateBudget(nowMs);
+
+		EgressScheduler::budget -= static_cast<int64_t>(size);
+	}
+
+	bool EgressScheduler::QueuePacket(
+	  Listener* listener, RTC::Consumer* consumer, RTC::RtpPacket* packet, bool retransmission)
+	{
+		MS_TRACE();
+
+		if (!EgressScheduler::IsEnabled())
+			return false;
+
+		auto nowMs = DepLibUV::GetTimeMs();
+
+		// Send it right away if there is budget and nothing queued before it. Also
+		// if it does not fit into a queue buffer.
+		if (packet->GetSize() > MaxPacketSize)
+		{
+			Consume(packet->GetSize(), nowMs);
+
+			return false;
+		}
+		else if (EgressScheduler::queue.empty() && TryConsume(packet->GetSize(), nowMs))
+		{
+			return false;
+		}
+
+		QueuedPacket queuedPacket;
+
+		if (!EgressScheduler::buffers.empty())
+		{
+			queuedPacket.buffer = std::move(EgressScheduler::buffers.back());
+			EgressScheduler::buffers.pop_back();
+		}
+		else
+		{
+			queuedPacket.buffer.reset(new uint8_t[MaxPacketSize]);
+		}
+
+		queuedPacket.listener       = listener;
+		queuedPacket.consumer       = consumer;
+		queuedPacket.packet         = packet->Clone(queuedPacket.buffer.get());
+		queuedPacket.retransmission = retransmission;
+		queuedPacket.queuedAtMs     = nowMs;
+
+		// Precise time just needed to measure the forwarding latency.
+		if (packet->GetIngressTime() != 0u)
+			queuedPacket.queuedAtNs = DepLibUV::GetHighResTimeNs();
+
+		EgressScheduler::queue.push_back(std::move(queuedPacket));
+
+		if (!EgressScheduler::drainTimer)
+			EgressScheduler::drainTimer = new Timer(std::addressof(EgressScheduler::timerListener));
+
+		if (!EgressScheduler::drainTimer->IsActive())
+			EgressScheduler::drainTimer->Start(DrainIntervalMs, DrainIntervalMs);
+
+		return true;
+	}
+
+	void EgressScheduler::RemoveConsumer(const RTC::Consumer* consumer)
+	{
+		MS_TRACE();
+
+		auto it = std::remove_if(
+		  EgressScheduler::queue.begin(),
+		  EgressScheduler::queue.end(),
+		  [consumer](QueuedPacket& queuedPacket)
+		  {
+			  if (queuedPacket.consumer != consumer)
+				  return false;
+
+			  ReleasePacket(queuedPacket);
+
+			  return true;
+		  });
+
+		EgressScheduler::queue.erase(it, EgressScheduler::queue.end());
+
+		if (EgressScheduler::queue.empty() && EgressScheduler::drainTimer)
+			EgressScheduler::drainTimer->Stop();
+	}
+
+	void EgressScheduler::RemoveListener(const Listener* listener)
+	{
+		MS_TRACE();
+
+		auto it = std::remove_if(
+		  EgressScheduler::queue.begin(),
+		  EgressScheduler::queue.end(),
+		  [listener](QueuedPacket& queuedPacket)
+		  {
+			  if (queuedPacket.listener != listener)
+				  return false;
+
+			  ReleasePacket(queuedPacket);
+
+			  return true;
+		  });
+
+		EgressScheduler::queue.erase(it, EgressScheduler::queue.end());
+
+		if (EgressScheduler::queue.empty() && EgressScheduler::drainTimer)
+			EgressScheduler::drainTimer->Stop();
+	}
+
+	void EgressScheduler::UpdateBudget(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		const uint64_t burstMs = Settings::configuration.egressBurstMs;
+		auto elapsedMs         = std::min(nowMs - EgressScheduler::lastBudgetUpdateAtMs, burstMs);
+
+		if (elapsedMs == 0u)
+			return;
+
+		const uint64_t bitrate = Settings::configuration.egressBitrate;
+		auto maxBudget         = static_cast<int64_t>(bitrate * burstMs / 8000);
+
+		// NOTE: The first update (with lastBudgetUpdateAtMs 0) fills the budget.
+		EgressScheduler::budget += static_cast<int64_t>(bitrate * elapsedMs / 8000);
+		EgressScheduler::budget               = std::min(EgressScheduler::budget, maxBudget);
+		EgressScheduler::lastBudgetUpdateAtMs = nowMs;
+	}
+
+	void EgressScheduler::ReleasePacket(QueuedPacket& queuedPacket)
+	{
+		MS_TRACE();
+
+		delete queuedPacket.packet;
+		queuedPacket.packet = nullptr;
+
+		EgressScheduler::buffers.push_back(std::move(queuedPacket.buffer));
+	}
+
+	void EgressScheduler::OnTimer()
+	{
+		MS_TRACE();
+
+		auto nowMs = DepLibUV::GetTimeMs();
+
+		UpdateBudget(nowMs);
+
+		while (!EgressScheduler::queue.empty())
+		{
+			auto& front = EgressScheduler::queue.front();
+
+			if (EgressScheduler::budget <= 0 && nowMs - front.queuedAtMs < MaxQueueDelayMs)
+				break;
+
+			// Remove it from the queue before giving it to the listener.
+			auto queuedPacket = std::move(front);
+
+			EgressScheduler::queue.pop_front();
+
+			EgressScheduler::budget -= static_cast<int64_t>(queuedPacket.packet->GetSize());
+
+			queuedPacket.listener->OnEgressSchedulerSendRtpPacket(
+			  queuedPacket.consumer,
+			  queuedPacket.packet,
+			  queuedPacket.retransmission,
+			  queuedPacket.queuedAtNs);
+
+			ReleasePacket(queuedPacket);
+		}
+
+		MS_DEBUG_DEV("queue drained [remaining packets:%zu]", EgressScheduler::queue.size());
+
+		if (EgressScheduler::queue.empty())
+			EgressScheduler::drainTimer->Stop();
+	}
+
+	/* Instance methods. */
+
+	inline void EgressScheduler::TimerListener::OnTimer(Timer* /*timer*/)
+	{
+		MS_TRACE();
+
+		EgressScheduler::OnTimer();
+	}
+} // namespace RTC
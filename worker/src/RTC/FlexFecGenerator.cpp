@@ -0,0 +1,194 @@
+#define MS_CLASS "RTC::FlexFecGenerator"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/FlexFecGenerator.hpp"
+#include "Logger.hpp"
+#include "Utils.hpp"
+#include <algorithm> // std::max()
+#include <cstring> // std::memcpy(), std::memset()
+
+namespace RTC
+{
+	/* Static. */
+
+	static constexpr size_t RtpFixedHeaderSize{ 12u };
+
+	// Number of media packets protected by each FEC packet depending on the
+	// fraction of packets lost (in 1/256 units) reported by the remote endpoint.
+	struct GroupSizeStep
+	{
+		uint8_t maxFractionLost;
+		size_t groupSize;
+	};
+
+	// clang-format off
+	static constexpr GroupSizeStep GroupSizeSteps[] =
+	{
+		{ 2,   0  }, // Below 1%, no FEC.
+		{ 12,  10 }, // Below 5%.
+		{ 25,  6  }, // Below 10%.
+		{ 51,  4  }, // Below 20%.
+		{ 255, 2  }
+	};
+	// clang-format on
+
+	// XORs src into dst. It's done in 64 bit words, which the compiler turns
+	// into vector instructions.
+	inline static void xorBytes(uint8_t* dst, const uint8_t* src, size_t len)
+	{
+		size_t i{ 0u };
+
+		for (; i + 8 <= len; i += 8)
+		{
+			uint64_t a;
+			uint64_t b;
+
+			std::memcpy(&a, dst + i, 8);
+			std::memcpy(&b, src + i, 8);
+
+			a ^= b;
+
+			std::memcpy(dst + i, &a, 8);
+		}
+
+		for (; i < len; ++i)
+		{
+			dst[i] ^= src[i];
+		}
+	}
+
+	/* Instance methods. */
+
+	FlexFecGenerator::FlexFecGenerator(uint8_t payloadType, uint32_t ssrc, uint32_t protectedSsrc)
+	  : payloadType(payloadType), ssrc(ssrc), protectedSsrc(protectedSsrc),
+	    seq(Utils::Crypto::GetRandomUInt(0u, 0xFFFF))
+	{
+		MS_TRACE();
+	}
+
+	void FlexFecGenerator::SetFractionLost(uint8_t fractionLost)
+	{
+		MS_TRACE();
+
+		size_t groupSize{ 0u };
+
+		for (const auto& step : GroupSizeSteps)
+		{
+			if (fractionLost <= step.maxFractionLost)
+			{
+				groupSize = step.groupSize;
+
+				break;
+			}
+		}
+
+		if (groupSize == this->groupSize)
+			return;
+
+		MS_DEBUG_DEV(
+		  "FEC group size changed [ssrc:%" PRIu32 ", fractionLost:%" PRIu8 ", groupSize:%zu]",
+		  this->ssrc,
+		  fractionLost,
+		  groupSize);
+
+		this->groupSize = groupSize;
+
+		ResetGroup();
+	}
+
+	RTC::RtpPacket* FlexFecGenerator::AddPacket(const RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		if (this->groupSize == 0u)
+			return nullptr;
+
+		// Don't protect packets that don't fit into a FEC packet.
+		if (packet->GetSize() > RTC::MtuSize)
+			return nullptr;
+
+		auto seq = packet->GetSequenceNumber();
+
+		// Start a new group if the packet cannot be protected by the current one.
+		if (this->packetCount > 0u && static_cast<uint16_t>(seq - this->baseSeq) >= MaxProtectedPackets)
+			ResetGroup();
+
+		if (this->packetCount == 0u)
+			this->baseSeq = seq;
+
+		const uint8_t* data = packet->GetData();
+		size_t length       = packet->GetSize() - RtpFixedHeaderSize;
+
+		// P, X, CC, M and PT fields.
+		this->headerRecovery[0] ^= data[0];
+		this->headerRecovery[1] ^= data[1];
+		// Length after the fixed header.
+		this->headerRecovery[2] ^= static_cast<uint8_t>(length >> 8);
+		this->headerRecovery[3] ^= static_cast<uint8_t>(length);
+		// Timestamp.
+		xorBytes(this->headerRecovery + 4, data + 4, 4);
+
+		xorBytes(this->payloadRecovery, data + RtpFixedHeaderSize, length);
+
+		this->payloadRecoveryLength = std::max(this->payloadRecoveryLength, length);
+		this->mask |= 1u << (14u - static_cast<uint16_t>(seq - this->baseSeq));
+		this->packetCount++;
+
+		// Close the group when it's full or at the end of a frame, so a frame does
+		// not wait for the next one to be protected.
+		if (this->packetCount < this->groupSize && !packet->HasMarker())
+			return nullptr;
+
+		auto* fecPacket = CreateFecPacket(packet->GetTimestamp());
+
+		ResetGroup();
+
+		return fecPacket;
+	}
+
+	void FlexFecGenerator::ResetGroup()
+	{
+		MS_TRACE();
+
+		std::memset(this->headerRecovery, 0, sizeof(this->headerRecovery));
+		std::memset(this->payloadRecovery, 0, this->payloadRecoveryLength);
+
+		this->payloadRecoveryLength = 0u;
+		this->packetCount           = 0u;
+		this->mask                  = 0u;
+	}
+
+	RTC::RtpPacket* FlexFecGenerator::CreateFecPacket(uint32_t timestamp)
+	{
+		MS_TRACE();
+
+		auto* rtpHeader = this->buffer;
+		auto* fecHeader = this->buffer + RtpFixedHeaderSize;
+
+		// RTP header (version 2).
+		rtpHeader[0] = 0x80;
+		rtpHeader[1] = this->payloadType;
+		Utils::Byte::Set2Bytes(rtpHeader, 2, ++this->seq);
+		Utils::Byte::Set4Bytes(rtpHeader, 4, timestamp);
+		Utils::Byte::Set4Bytes(rtpHeader, 8, this->ssrc);
+
+		// FEC header (R and F bits unset).
+		std::memcpy(fecHeader, this->headerRecovery, sizeof(this->headerRecovery));
+		fecHeader[0] &= 0x3F;
+		fecHeader[8] = 1u; // SSRCCount.
+		Utils::Byte::Set3Bytes(fecHeader, 9, 0u);
+		Utils::Byte::Set4Bytes(fecHeader, 12, this->protectedSsrc);
+		Utils::Byte::Set2Bytes(fecHeader, 16, this->baseSeq);
+		// k bit set since the mask ends here.
+		Utils::Byte::Set2Bytes(fecHeader, 18, 0x8000 | this->mask);
+
+		// Repair payload.
+		std::memcpy(fecHeader + HeaderSize, this->payloadRecovery, this->payloadRecoveryLength);
+
+		size_t size = RtpFixedHeaderSize + HeaderSize + this->payloadRecoveryLength;
+
+		this->fecPacket.reset(RTC::RtpPacket::Parse(this->buffer, size));
+
+		return this->fecPacket.get();
+	}
+} // namespace RTC
@@ -0,0 +1,268 @@
+#define MS_CLASS "RTC::FlexFecReceiver"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/FlexFecReceiver.hpp"
+#include "Logger.hpp"
+#include "Utils.hpp"
+#include "RTC/SeqManager.hpp"
+#include <cstring> // std::memcpy()
+
+namespace RTC
+{
+	/* Static. */
+
+	static constexpr size_t RtpFixedHeaderSize{ 12u };
+	// FEC header up to the first mask (SN base included).
+	static constexpr size_t FecFixedHeaderSize{ 18u };
+
+	// Masks following the SN base. Each one starts with the k bit, which tells
+	// whether it's the last one.
+	struct MaskChunk
+	{
+		size_t len;
+		size_t bits;
+	};
+
+	// clang-format off
+	static constexpr MaskChunk MaskChunks[] =
+	{
+		{ 2, 15 },
+		{ 4, 31 },
+		{ 8, 63 }
+	};
+	// clang-format on
+
+	inline static uint64_t getMaskChunk(const uint8_t* data, size_t i, size_t len)
+	{
+		switch (len)
+		{
+			case 2:
+				return Utils::Byte::Get2Bytes(data, i);
+			case 4:
+				return Utils::Byte::Get4Bytes(data, i);
+			default:
+				return Utils::Byte::Get8Bytes(data, i);
+		}
+	}
+
+	/* Instance methods. */
+
+	FlexFecReceiver::FlexFecReceiver(uint8_t payloadType, uint32_t ssrc, uint32_t protectedSsrc)
+	  : payloadType(payloadType), ssrc(ssrc), protectedSsrc(protectedSsrc), storage(BufferSize)
+	{
+		MS_TRACE();
+	}
+
+	bool FlexFecReceiver::AddPacket(const RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		auto seq = packet->GetSequenceNumber();
+
+		if (GetStoredPacket(seq))
+			return false;
+
+		StorePacket(packet->GetData(), packet->GetSize(), seq);
+
+		return true;
+	}
+
+	RTC::RtpPacket* FlexFecReceiver::ReceiveFecPacket(const RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		// Nothing to recover from yet.
+		if (!this->started)
+			return nullptr;
+
+		const uint8_t* fecHeader = packet->GetPayload();
+		const size_t fecLength   = packet->GetPayloadLength();
+
+		if (fecLength < FecFixedHeaderSize)
+		{
+			MS_WARN_TAG(rtp, "FEC packet too short [ssrc:%" PRIu32 "]", packet->GetSsrc());
+
+			return nullptr;
+		}
+
+		// R (retransmission) and F (fixed mask) bits are not supported, nor
+		// protecting more than one SSRC.
+		// clang-format off
+		if (
+			(fecHeader[0] & 0xC0) != 0u ||
+			fecHeader[8] != 1u ||
+			Utils::Byte::Get4Bytes(fecHeader, 12) != this->protectedSsrc
+		)
+		// clang-format on
+		{
+			MS_DEBUG_DEV("unsupported FEC packet [ssrc:%" PRIu32 "]", packet->GetSsrc());
+
+			return nullptr;
+		}
+
+		const uint16_t baseSeq = Utils::Byte::Get2Bytes(fecHeader, 16);
+		size_t headerSize{ FecFixedHeaderSize };
+		size_t offset{ 0u };
+		// Protected packets and the missing one.
+		const StoredPacket* protectedPackets[MaxProtectedPackets];
+		size_t protectedCount{ 0u };
+		size_t missingCount{ 0u };
+		uint16_t missingSeq{ 0u };
+
+		for (const auto& chunk : MaskChunks)
+		{
+			if (fecLength < headerSize + chunk.len)
+				return nullptr;
+
+			const uint64_t value = getMaskChunk(fecHeader, headerSize, chunk.len);
+			const bool kBit      = (value >> chunk.bits) & 1u;
+
+			headerSize += chunk.len;
+
+			for (size_t i{ 0u }; i < chunk.bits; ++i)
+			{
+				if (((value >> (chunk.bits - 1u - i)) & 1u) == 0u)
+					continue;
+
+				const uint16_t seq = baseSeq + static_cast<uint16_t>(offset + i);
+				auto* storedPacket = GetStoredPacket(seq);
+
+				if (storedPacket)
+				{
+					protectedPackets[protectedCount++] = storedPacket;
+				}
+				// Just a single lost packet can be recovered.
+				else if (++missingCount > 1u)
+				{
+					return nullptr;
+				}
+				else
+				{
+					missingSeq = seq;
+				}
+			}
+
+			offset += chunk.bits;
+
+			if (kBit)
+				break;
+		}
+
+		if (missingCount == 0u)
+			return nullptr;
+
+		// Packets too old to be in the storage are not lost, just forgotten.
+		// clang-format off
+		if (
+			!RTC::SeqManager<uint16_t>::IsSeqHigherThan(missingSeq, this->highestSeq) &&
+			static_cast<uint16_t>(this->highestSeq - missingSeq) >= BufferSize
+		)
+		// clang-format on
+		{
+			return nullptr;
+		}
+
+		const size_t payloadRecoveryLength = fecLength - headerSize;
+
+		if (RtpFixedHeaderSize + payloadRecoveryLength > sizeof(this->buffer))
+			return nullptr;
+
+		uint8_t headerRecovery[8];
+
+		std::memcpy(headerRecovery, fecHeader, sizeof(headerRecovery));
+		std::memcpy(this->buffer + RtpFixedHeaderSize, fecHeader + headerSize, payloadRecoveryLength);
+
+		for (size_t i{ 0u }; i < protectedCount; ++i)
+		{
+			const auto& data  = protectedPackets[i]->data;
+			const size_t size = data.size() - RtpFixedHeaderSize;
+
+			if (size > payloadRecoveryLength)
+			{
+				MS_WARN_TAG(rtp, "protected packet longer than FEC payload [ssrc:%" PRIu32 "]", this->ssrc);
+
+				return nullptr;
+			}
+
+			// P, X, CC, M and PT fields.
+			headerRecovery[0] ^= data[0];
+			headerRecovery[1] ^= data[1];
+			// Length after the fixed header.
+			headerRecovery[2] ^= static_cast<uint8_t>(size >> 8);
+			headerRecovery[3] ^= static_cast<uint8_t>(size);
+
+			// Timestamp.
+			for (size_t j{ 4u }; j < 8u; ++j)
+			{
+				headerRecovery[j] ^= data[j];
+			}
+
+			uint8_t* payload = this->buffer + RtpFixedHeaderSize;
+
+			for (size_t j{ 0u }; j < size; ++j)
+			{
+				payload[j] ^= data[RtpFixedHeaderSize + j];
+			}
+		}
+
+		const size_t size = Utils::Byte::Get2Bytes(headerRecovery, 2);
+
+		if (size > payloadRecoveryLength)
+		{
+			MS_WARN_TAG(rtp, "wrong recovered packet length [ssrc:%" PRIu32 "]", this->ssrc);
+
+			return nullptr;
+		}
+
+		// RTP header (version 2).
+		this->buffer[0] = 0x80 | (headerRecovery[0] & 0x3F);
+		this->buffer[1] = headerRecovery[1];
+		Utils::Byte::Set2Bytes(this->buffer, 2, missingSeq);
+		std::memcpy(this->buffer + 4, headerRecovery + 4, 4);
+		Utils::Byte::Set4Bytes(this->buffer, 8, this->protectedSsrc);
+
+		this->recoveredPacket.reset(RTC::RtpPacket::Parse(this->buffer, RtpFixedHeaderSize + size));
+
+		if (!this->recoveredPacket)
+		{
+			MS_WARN_TAG(rtp, "invalid recovered packet [ssrc:%" PRIu32 "]", this->ssrc);
+
+			return nullptr;
+		}
+
+		MS_DEBUG_DEV(
+		  "packet recovered [ssrc:%" PRIu32 ", seq:%" PRIu16 "]", this->protectedSsrc, missingSeq);
+
+		StorePacket(this->buffer, RtpFixedHeaderSize + size, missingSeq);
+
+		this->recoveredPackets++;
+
+		return this->recoveredPacket.get();
+	}
+
+	inline FlexFecReceiver::StoredPacket* FlexFecReceiver::GetStoredPacket(uint16_t seq)
+	{
+		auto& storedPacket = this->storage[seq % BufferSize];
+
+		if (storedPacket.data.empty() || storedPacket.seq != seq)
+			return nullptr;
+
+		return std::addressof(storedPacket);
+	}
+
+	inline void FlexFecReceiver::StorePacket(const uint8_t* data, size_t len, uint16_t seq)
+	{
+		auto& storedPacket = this->storage[seq % BufferSize];
+
+		// NOTE: The vector keeps its capacity, so this doesn't allocate once the
+		// storage is warm.
+		storedPacket.data.assign(data, data + len);
+		storedPacket.seq = seq;
+
+		if (!this->started || RTC::SeqManager<uint16_t>::IsSeqHigherThan(seq, this->highestSeq))
+		{
+			this->started    = true;
+			this->highestSeq = seq;
+		}
+	}
+} // namespace RTC
@@ -0,0 +1,44 @@
+#define MS_CLASS "RTC::ForwardingLatency"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/ForwardingLatency.hpp"
+#include "Logger.hpp"
+
+namespace RTC
+{
+	/* Instance methods. */
+
+	void ForwardingLatency::Record(
+	  uint64_t ingressTimeNs, uint64_t routedAtNs, uint64_t sendingAtNs, uint64_t sentAtNs)
+	{
+		MS_TRACE();
+
+		// clang-format off
+		if (
+			ingressTimeNs > routedAtNs ||
+			routedAtNs > sendingAtNs ||
+			sendingAtNs > sentAtNs
+		)
+		// clang-format on
+		{
+			MS_WARN_DEV("ignoring non monotonic times");
+
+			return;
+		}
+
+		this->routing.Record(routedAtNs - ingressTimeNs);
+		this->pacing.Record(sendingAtNs - routedAtNs);
+		this->send.Record(sentAtNs - sendingAtNs);
+		this->total.Record(sentAtNs - ingressTimeNs);
+	}
+
+	void ForwardingLatency::FillJson(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		this->routing.FillJson(jsonObject["routing"], 1.0, /*withBuckets*/ false);
+		this->pacing.FillJson(jsonObject["pacing"], 1.0, /*withBuckets*/ false);
+		this->send.FillJson(jsonObject["send"], 1.0, /*withBuckets*/ false);
+		this->total.FillJson(jsonObject["total"], 1.0, /*withBuckets*/ false);
+	}
+} // namespace RTC
@@ -1,6 +1,7 @@
 #define MS_CLASS "RTC::IceServer"
 // #define MS_LOG_DEV_LEVEL 3
 
+#include <algorithm> // std::find()
 #include <utility>
 
 #include "Logger.hpp"
@@ -12,13 +13,43 @@ namespace RTC
 
 	static constexpr size_t StunSerializeBufferSize{ 65536 };
 	thread_local static uint8_t StunSerializeBuffer[StunSerializeBufferSize];
+	// Number of stored tuples above which they are also indexed by key.
+	static constexpr size_t MaxTuplesWithoutIndex{ 8u };
 
 	/* Instance methods. */
 
 	IceServer::IceServer(Listener* listener, const std::string& usernameFragment, const std::string& password)
-	  : listener(listener), usernameFragment(usernameFragment), password(password)
+	  : listener(listener), usernameFragment(usernameFragment), password(password),
+	    hmacSha1(new Utils::Crypto::HmacSha1(password))
 	{
 		MS_TRACE();
+
+		this->listener->OnIceServerLocalUsernameFragmentAdded(this, usernameFragment);
+	}
+
+	IceServer::~IceServer()
+	{
+		MS_TRACE();
+
+		// Here we must notify the listener about the removal of current
+		// usernameFragments (and also the old one if any) and all tuples.
+
+		this->listener->OnIceServerLocalUsernameFragmentRemoved(this, this->usernameFragment);
+
+		if (!this->oldUsernameFragment.empty())
+			this->listener->OnIceServerLocalUsernameFragmentRemoved(this, this->oldUsernameFragment);
+
+		// Clean the tuples list.
+		for (auto* storedTuple : this->tuples)
+		{
+			this->listener->OnIceServerTupleRemoved(this, storedTuple);
+
+			delete storedTuple;
+		}
+		this->tuples.clear();
+		this->mapKeyTuple.clear();
+		this->mapTupleStunResponse.clear();
+		this->selectedTuple = nullptr;
 	}
 
 	void IceServer::ProcessStunPacket(RTC::StunPacket* packet, RTC::TransportTuple* tuple)
@@ -98,7 +129,7 @@ namespace RTC
 				}
 
 				// Check authentication.
-				switch (packet->CheckAuthentication(this->usernameFragment, this->password))
+				switch (packet->CheckAuthentication(this->usernameFragment, *this->hmacSha1))
 				{
 					case RTC::StunPacket::Authentication::OK:
 					{
@@ -106,8 +137,13 @@ namespace RTC
 						{
 							MS_DEBUG_TAG(ice, "new ICE credentials applied");
 
+							// Notify the listener.
+							this->listener->OnIceServerLocalUsernameFragmentRemoved(
+							  this, this->oldUsernameFragment);
+
 							this->oldUsernameFragment.clear();
 							this->oldPassword.clear();
+							this->oldHmacSha1.reset();
 						}
 
 						break;
@@ -121,7 +157,7 @@ namespace RTC
 						if (
 							!this->oldUsernameFragment.empty() &&
 							!this->oldPassword.empty() &&
-							packet->CheckAuthentication(this->oldUsernameFragment, this->oldPassword) == RTC::StunPacket::Authentication::OK
+							packet->CheckAuthentication(this->oldUsernameFragment, *this->oldHmacSha1) == RTC::StunPacket::Authentication::OK
 						)
 						// clang-format on
 						{
@@ -180,23 +216,10 @@ namespace RTC
 				  static_cast<uint32_t>(packet->GetPriority()),
 				  packet->HasUseCandidate() ? "true" : "false");
 
-				// Create a success response.
-				RTC::StunPacket* response = packet->CreateSuccessResponse();
-
-				// Add XOR-MAPPED-ADDRESS.
-				response->SetXorMappedAddress(tuple->GetRemoteAddress());
-
-				// Authenticate the response.
-				if (this->oldPassword.empty())
-					response->Authenticate(this->password);
-				else
-					response->Authenticate(this->oldPassword);
-
-				// Send back.
-				response->Serialize(StunSerializeBuffer);
-				this->listener->OnIceServerSendStunPacket(this, response, tuple);
-
-				delete response;
+				// Send a success response authenticated with the credentials that
+				// authenticated the request.
+				SendSuccessResponse(
+				  packet, tuple, this->oldPassword.empty() ? *this->hmacSha1 : *this->oldHmacSha1);
 
 				uint32_t nomination{ 0u };
 
@@ -232,6 +255,28 @@ namespace RTC
 		}
 	}
 
+	void IceServer::RestartIce(const std::string& usernameFragment, const std::string& password)
+	{
+		MS_TRACE();
+
+		if (!this->oldUsernameFragment.empty())
+			this->listener->OnIceServerLocalUsernameFragmentRemoved(this, this->oldUsernameFragment);
+
+		this->oldUsernameFragment = this->usernameFragment;
+		this->usernameFragment    = usernameFragment;
+
+		this->oldPassword = this->password;
+		this->password    = password;
+
+		this->oldHmacSha1 = std::move(this->hmacSha1);
+		this->hmacSha1.reset(new Utils::Crypto::HmacSha1(password));
+
+		this->remoteNomination = 0u;
+
+		// Notify the listener.
+		this->listener->OnIceServerLocalUsernameFragmentAdded(this, usernameFragment);
+	}
+
 	bool IceServer::IsValidTuple(const RTC::TransportTuple* tuple) const
 	{
 		MS_TRACE();
@@ -243,41 +288,59 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		RTC::TransportTuple* removedTuple{ nullptr };
+		RTC::TransportTuple* removedTuple = HasTuple(tuple);
+
+		// If not found, ignore.
+		if (!removedTuple)
+			return;
+
+		// Notify the listener.
+		this->listener->OnIceServerTupleRemoved(this, removedTuple);
 
-		// Find the removed tuple.
-		auto it = this->tuples.begin();
+		const bool wasSelectedTuple = removedTuple == this->selectedTuple;
 
-		for (; it != this->tuples.end(); ++it)
+		// Remove from the list of tuples.
+		this->tuples.erase(std::find(this->tuples.begin(), this->tuples.end(), removedTuple));
+		this->mapTupleStunResponse.erase(removedTuple);
+
+		if (this->tuples.size() <= MaxTuplesWithoutIndex)
+		{
+			this->mapKeyTuple.clear();
+		}
+		else
 		{
-			RTC::TransportTuple* storedTuple = std::addressof(*it);
+			auto mapKeyTupleIt = this->mapKeyTuple.find(removedTuple->key);
 
-			if (storedTuple->Compare(tuple))
+			if (mapKeyTupleIt != this->mapKeyTuple.end() && mapKeyTupleIt->second == removedTuple)
 			{
-				removedTuple = storedTuple;
+				this->mapKeyTuple.erase(mapKeyTupleIt);
 
-				break;
+				// Index another stored tuple with the same key (if any).
+				for (auto* storedTuple : this->tuples)
+				{
+					if (storedTuple->key == removedTuple->key)
+					{
+						IndexTuple(storedTuple);
+
+						break;
+					}
+				}
 			}
 		}
 
-		// If not found, ignore.
-		if (!removedTuple)
-			return;
-
-		// Remove from the list of tuples.
-		this->tuples.erase(it);
+		delete removedTuple;
 
 		// If this is not the selected tuple, stop here.
-		if (removedTuple != this->selectedTuple)
+		if (!wasSelectedTuple)
 			return;
 
 		// Otherwise this was the selected tuple.
 		this->selectedTuple = nullptr;
 
-		// Mark the first tuple as selected tuple (if any).
-		if (this->tuples.begin() != this->tuples.end())
+		// Mark the newest tuple as selected tuple (if any).
+		if (!this->tuples.empty())
 		{
-			SetSelectedTuple(std::addressof(*this->tuples.begin()));
+			SetSelectedTuple(this->tuples.back());
 		}
 		// Or just emit 'disconnected'.
 		else
@@ -306,6 +369,54 @@ namespace RTC
 		SetSelectedTuple(storedTuple);
 	}
 
+	void IceServer::SendSuccessResponse(
+	  RTC::StunPacket* request, RTC::TransportTuple* tuple, Utils::Crypto::HmacSha1& hmacSha1)
+	{
+		MS_TRACE();
+
+		auto* storedTuple = HasTuple(tuple);
+
+		// Not yet stored tuple, so build the response from scratch.
+		if (!storedTuple)
+		{
+			RTC::StunPacket* response = request->CreateSuccessResponse();
+
+			// Add XOR-MAPPED-ADDRESS.
+			response->SetXorMappedAddress(tuple->GetRemoteAddress());
+
+			// Authenticate the response.
+			response->Authenticate(hmacSha1);
+
+			// Send back.
+			response->Serialize(StunSerializeBuffer);
+			this->listener->OnIceServerSendStunPacket(this, response, tuple);
+
+			delete response;
+
+			return;
+		}
+
+		auto& cachedResponse = this->mapTupleStunResponse[storedTuple];
+
+		// The response just differs in the transaction ID (and the fields that
+		// depend on it) from the previous one of the same tuple.
+		if (cachedResponse)
+		{
+			cachedResponse->packet->UpdateTransactionId(request->GetTransactionId(), hmacSha1);
+		}
+		else
+		{
+			cachedResponse.reset(new CachedStunResponse());
+			cachedResponse->packet.reset(request->CreateSuccessResponse());
+
+			cachedResponse->packet->SetXorMappedAddress(storedTuple->GetRemoteAddress());
+			cachedResponse->packet->Authenticate(hmacSha1);
+			cachedResponse->packet->Serialize(cachedResponse->buffer);
+		}
+
+		this->listener->OnIceServerSendStunPacket(this, cachedResponse->packet.get(), tuple);
+	}
+
 	void IceServer::HandleTuple(
 	  RTC::TransportTuple* tuple, bool hasUseCandidate, bool hasNomination, uint32_t nomination)
 	{
@@ -521,16 +632,32 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		// Add the new tuple at the beginning of the list.
-		this->tuples.push_front(*tuple);
+		// Add the new tuple at the end of the list.
+		auto* storedTuple = new RTC::TransportTuple(*tuple);
 
-		auto* storedTuple = std::addressof(*this->tuples.begin());
+		this->tuples.push_back(storedTuple);
 
 		// If it is UDP then we must store the remote address (until now it is
 		// just a pointer that will be freed soon).
 		if (storedTuple->GetProtocol() == TransportTuple::Protocol::UDP)
 			storedTuple->StoreUdpRemoteAddress();
 
+		// Too many tuples to look for them linearly, index them all.
+		if (this->tuples.size() == MaxTuplesWithoutIndex + 1)
+		{
+			for (auto* it : this->tuples)
+			{
+				IndexTuple(it);
+			}
+		}
+		else if (this->tuples.size() > MaxTuplesWithoutIndex + 1)
+		{
+			IndexTuple(storedTuple);
+		}
+
+		// Notify the listener.
+		this->listener->OnIceServerTupleAdded(this, storedTuple);
+
 		// Return the address of the inserted tuple.
 		return storedTuple;
 	}
@@ -548,10 +675,25 @@ namespace RTC
 		if (this->selectedTuple->Compare(tuple))
 			return this->selectedTuple;
 
-		// Otherwise check other stored tuples.
-		for (const auto& it : this->tuples)
+		// Otherwise check the tuple indexed by key (if many).
+		if (!this->mapKeyTuple.empty())
+		{
+			auto mapKeyTupleIt = this->mapKeyTuple.find(tuple->key);
+
+			// No stored tuple with same key.
+			if (mapKeyTupleIt == this->mapKeyTuple.end())
+				return nullptr;
+
+			if (mapKeyTupleIt->second->Compare(tuple))
+				return mapKeyTupleIt->second;
+
+			// Same key but different socket, fallback to check every tuple.
+		}
+
+		// Check other stored tuples (newest first).
+		for (auto it = this->tuples.rbegin(); it != this->tuples.rend(); ++it)
 		{
-			auto* storedTuple = const_cast<RTC::TransportTuple*>(std::addressof(it));
+			auto* storedTuple = *it;
 
 			if (storedTuple->Compare(tuple))
 				return storedTuple;
@@ -560,6 +702,13 @@ namespace RTC
 		return nullptr;
 	}
 
+	inline void IceServer::IndexTuple(RTC::TransportTuple* storedTuple)
+	{
+		MS_TRACE();
+
+		this->mapKeyTuple.try_emplace(storedTuple->key, storedTuple);
+	}
+
 	inline void IceServer::SetSelectedTuple(RTC::TransportTuple* storedTuple)
 	{
 		MS_TRACE();
@@ -0,0 +1,164 @@
+#define MS_CLASS "RTC::IngressPolicer"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/IngressPolicer.hpp"
+#include "Logger.hpp"
+#include <algorithm> // std::min()
+
+namespace RTC
+{
+	/* Static. */
+
+	// Tuples are not pruned more often than this (in ms) so a flood of new
+	// tuples doesn't make every packet iterate them all.
+	static constexpr uint64_t PruneIntervalMs{ 1000u };
+
+	/* Instance methods. */
+
+	IngressPolicer::TokenBucket::TokenBucket(uint32_t ratePerSecond, uint32_t burstMs)
+	  : rate(ratePerSecond / 1000.0), capacity(this->rate * burstMs), tokens(this->capacity)
+	{
+		MS_TRACE();
+	}
+
+	bool IngressPolicer::TokenBucket::TryConsume(size_t count, uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		// Unlimited.
+		if (this->rate == 0)
+			return true;
+
+		if (nowMs > this->lastRefillAtMs)
+		{
+			this->tokens =
+			  std::min(this->capacity, this->tokens + (this->rate * (nowMs - this->lastRefillAtMs)));
+			this->lastRefillAtMs = nowMs;
+		}
+
+		if (this->tokens < count)
+			return false;
+
+		this->tokens -= count;
+
+		return true;
+	}
+
+	void IngressPolicer::Configure(uint32_t bitrate, uint32_t tupleBitrate, uint32_t burstMs)
+	{
+		MS_TRACE();
+
+		this->tupleBitrate   = tupleBitrate;
+		this->burstMs        = burstMs;
+		this->transportBytes = TokenBucket(bitrate / 8u, burstMs);
+
+		// Tuples get new buckets.
+		this->mapTuples.clear();
+	}
+
+	bool IngressPolicer::Police(const RTC::TransportTuple* tuple, size_t len, uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		if (this->tupleBitrate != 0u)
+		{
+			auto* policedTuple = GetTuple(tuple, nowMs);
+
+			if (!policedTuple || !policedTuple->bytes.TryConsume(len, nowMs))
+			{
+				Drop(DropReason::TUPLE_BITRATE, len);
+
+				return false;
+			}
+		}
+
+		if (!this->transportBytes.TryConsume(len, nowMs))
+		{
+			Drop(DropReason::TRANSPORT_BITRATE, len);
+
+			return false;
+		}
+
+		return true;
+	}
+
+	bool IngressPolicer::PoliceUnknownTupleStun(
+	  const RTC::TransportTuple* tuple, size_t len, uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		auto* policedTuple = GetTuple(tuple, nowMs);
+
+		if (!policedTuple || !policedTuple->stunPackets.TryConsume(1u, nowMs))
+		{
+			Drop(DropReason::STUN_RATE, len);
+
+			return false;
+		}
+
+		return true;
+	}
+
+	void IngressPolicer::FillJson(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		static const char* const Reasons[] = {
+			"transportBitrate", "tupleBitrate", "unknownTuple", "stunRate"
+		};
+
+		jsonObject = json::object();
+
+		for (uint8_t reason{ 0u }; reason < 4u; ++reason)
+		{
+			auto& jsonReason = jsonObject[Reasons[reason]];
+
+			jsonReason["packets"] = this->dropped[reason].packets;
+			jsonReason["bytes"]   = this->dropped[reason].bytes;
+		}
+	}
+
+	IngressPolicer::Tuple* IngressPolicer::GetTuple(const RTC::TransportTuple* tuple, uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		auto it = this->mapTuples.find(tuple->key);
+
+		if (it == this->mapTuples.end())
+		{
+			if (
+			  this->mapTuples.size() >= IngressPolicer::MaxTuples &&
+			  nowMs - this->lastPruneAtMs >= PruneIntervalMs)
+			{
+				this->lastPruneAtMs = nowMs;
+
+				for (auto it2 = this->mapTuples.begin(); it2 != this->mapTuples.end();)
+				{
+					if (nowMs - it2->second.lastPacketAtMs > IngressPolicer::TupleTimeoutMs)
+						this->mapTuples.erase(it2++);
+					else
+						++it2;
+				}
+			}
+
+			// Packets from new tuples are dropped while too many are tracked.
+			if (this->mapTuples.size() >= IngressPolicer::MaxTuples)
+			{
+				MS_DEBUG_DEV("too many tuples, dropping packet from a new one");
+
+				return nullptr;
+			}
+
+			it = this->mapTuples
+			       .emplace(
+			         tuple->key,
+			         Tuple{ TokenBucket(this->tupleBitrate / 8u, this->burstMs),
+			                TokenBucket(IngressPolicer::UnknownTupleStunRate, 1000u) })
+			       .first;
+		}
+
+		it->second.lastPacketAtMs = nowMs;
+
+		return &it->second;
+	}
+} // namespace RTC
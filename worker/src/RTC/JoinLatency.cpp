@@ -0,0 +1,65 @@
+#define MS_CLASS "RTC::JoinLatency"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/JoinLatency.hpp"
+#include "Logger.hpp"
+
+namespace RTC
+{
+	/* Static. */
+
+	// Indexed by Phase.
+	static constexpr const char* PhaseNames[]{
+		"iceBinding",       "iceConnect",       "dtlsConnect",
+		"producerFirstRtp", "consumerFirstRtp", "consumerFirstKeyFrame"
+	};
+
+	static_assert(
+	  sizeof(PhaseNames) / sizeof(PhaseNames[0]) == static_cast<size_t>(JoinLatency::Phase::MAX),
+	  "a name is needed for every phase");
+
+	/* Class variables. */
+
+	thread_local Metrics::Histogram* JoinLatency::histograms{ nullptr };
+
+	/* Class methods. */
+
+	void JoinLatency::ClassDestroy()
+	{
+		MS_TRACE();
+
+		delete[] JoinLatency::histograms;
+		JoinLatency::histograms = nullptr;
+	}
+
+	void JoinLatency::Record(Phase phase, uint64_t durationMs)
+	{
+		MS_TRACE();
+
+		MS_DEBUG_DEV(
+		  "%s phase done in %" PRIu64 "ms", PhaseNames[static_cast<size_t>(phase)], durationMs);
+
+		GetHistograms()[static_cast<size_t>(phase)].Record(durationMs);
+	}
+
+	void JoinLatency::FillJson(json& jsonObject)
+	{
+		MS_TRACE();
+
+		auto* histograms = GetHistograms();
+
+		for (size_t idx{ 0u }; idx < static_cast<size_t>(Phase::MAX); ++idx)
+		{
+			histograms[idx].FillJson(jsonObject[PhaseNames[idx]], 1.0, /*withBuckets*/ false);
+		}
+	}
+
+	Metrics::Histogram* JoinLatency::GetHistograms()
+	{
+		// Allocated on first use since most workers never record some phases.
+		if (!JoinLatency::histograms)
+			JoinLatency::histograms = new Metrics::Histogram[static_cast<size_t>(Phase::MAX)];
+
+		return JoinLatency::histograms;
+	}
+} // namespace RTC
@@ -0,0 +1,99 @@
+#define MS_CLASS "RTC::KeyFrameCache"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/KeyFrameCache.hpp"
+#include "Logger.hpp"
+#include "RTC/Codecs/Tools.hpp"
+#include "RTC/SeqManager.hpp"
+
+namespace RTC
+{
+	/* Instance methods. */
+
+	KeyFrameCache::KeyFrameCache(const RTC::RtpCodecMimeType& mimeType) : mimeType(mimeType)
+	{
+		MS_TRACE();
+	}
+
+	KeyFrameCache::~KeyFrameCache()
+	{
+		MS_TRACE();
+
+		ClearPackets();
+	}
+
+	void KeyFrameCache::ReceivePacket(const RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		// A new key frame (retransmitted packets of the current one are not).
+		// clang-format off
+		if (
+			packet->IsKeyFrame() &&
+			(
+				(this->packets.empty() && !this->overflow) ||
+				packet->GetTimestamp() != this->keyFrameTimestamp
+			)
+		)
+		// clang-format on
+		{
+			ClearPackets();
+
+			this->keyFrameTimestamp = packet->GetTimestamp();
+			this->keyFrameSeq       = packet->GetSequenceNumber();
+			this->overflow          = false;
+		}
+
+		if (this->packets.empty())
+			return;
+
+		// Ignore packets older than the key frame.
+		if (RTC::SeqManager<uint16_t>::IsSeqLowerThan(packet->GetSequenceNumber(), this->keyFrameSeq))
+			return;
+
+		if (this->packets.size() == MaxPackets || packet->GetSize() > MaxPacketSize)
+		{
+			MS_DEBUG_TAG(
+			  rtp,
+			  "key frame cache overflow, unusable until next key frame [ssrc:%" PRIu32 "]",
+			  packet->GetSsrc());
+
+			ClearPackets();
+
+			this->overflow = true;
+
+			return;
+		}
+
+		if (this->buffers.size() == this->packets.size())
+			this->buffers.emplace_back(new uint8_t[MaxPacketSize]);
+
+		auto* clonedPacket = packet->Clone(this->buffers[this->packets.size()].get());
+
+		// Process the packet at codec level so it's known whether it's a key frame.
+		RTC::Codecs::Tools::ProcessRtpPacket(clonedPacket, this->mimeType, &this->av1TemplateStructure);
+
+		this->packets.push_back(clonedPacket);
+	}
+
+	void KeyFrameCache::Clear()
+	{
+		MS_TRACE();
+
+		ClearPackets();
+
+		this->overflow = false;
+	}
+
+	void KeyFrameCache::ClearPackets()
+	{
+		MS_TRACE();
+
+		for (auto* packet : this->packets)
+		{
+			delete packet;
+		}
+
+		this->packets.clear();
+	}
+} // namespace RTC
@@ -74,6 +74,8 @@ RTC::KeyFrameRequestManager::~KeyFrameRequestManager()
 {
 	MS_TRACE();
 
+	KeyFrameRequestScheduler::Unschedule(this);
+
 	for (auto& kv : this->mapSsrcPendingKeyFrameInfo)
 	{
 		auto* pendingKeyFrameInfo = kv.second;
@@ -135,7 +137,7 @@ void RTC::KeyFrameRequestManager::KeyFrameNeeded(uint32_t ssrc)
 
 	this->mapSsrcPendingKeyFrameInfo[ssrc] = new PendingKeyFrameInfo(this, ssrc);
 
-	this->listener->OnKeyFrameNeeded(this, ssrc);
+	RequestKeyFrame(ssrc);
 }
 
 void RTC::KeyFrameRequestManager::ForceKeyFrameNeeded(uint32_t ssrc)
@@ -174,7 +176,7 @@ void RTC::KeyFrameRequestManager::ForceKeyFrameNeeded(uint32_t ssrc)
 		this->mapSsrcPendingKeyFrameInfo[ssrc] = new PendingKeyFrameInfo(this, ssrc);
 	}
 
-	this->listener->OnKeyFrameNeeded(this, ssrc);
+	RequestKeyFrame(ssrc);
 }
 
 void RTC::KeyFrameRequestManager::KeyFrameReceived(uint32_t ssrc)
@@ -192,6 +194,20 @@ void RTC::KeyFrameRequestManager::KeyFrameReceived(uint32_t ssrc)
 	delete pendingKeyFrameInfo;
 
 	this->mapSsrcPendingKeyFrameInfo.erase(it);
+
+	// Drop the request if still waiting for budget.
+	if (this->budget)
+		KeyFrameRequestScheduler::Unschedule(this, ssrc);
+}
+
+void RTC::KeyFrameRequestManager::RequestKeyFrame(uint32_t ssrc)
+{
+	MS_TRACE();
+
+	if (this->budget)
+		KeyFrameRequestScheduler::Schedule(this->budget, this, ssrc);
+	else
+		this->listener->OnKeyFrameNeeded(this, ssrc);
 }
 
 inline void RTC::KeyFrameRequestManager::OnKeyFrameRequestTimeout(PendingKeyFrameInfo* pendingKeyFrameInfo)
@@ -218,7 +234,7 @@ inline void RTC::KeyFrameRequestManager::OnKeyFrameRequestTimeout(PendingKeyFram
 
 	MS_DEBUG_DEV("requesting key frame on timeout");
 
-	this->listener->OnKeyFrameNeeded(this, pendingKeyFrameInfo->GetSsrc());
+	RequestKeyFrame(pendingKeyFrameInfo->GetSsrc());
 }
 
 inline void RTC::KeyFrameRequestManager::OnKeyFrameDelayTimeout(
@@ -246,3 +262,10 @@ inline void RTC::KeyFrameRequestManager::OnKeyFrameDelayTimeout(
 		KeyFrameNeeded(ssrc);
 	}
 }
+
+inline void RTC::KeyFrameRequestManager::OnKeyFrameRequestSchedulerRequest(uint32_t ssrc)
+{
+	MS_TRACE();
+
+	this->listener->OnKeyFrameNeeded(this, ssrc);
+}
@@ -0,0 +1,259 @@
+#define MS_CLASS "RTC::KeyFrameRequestScheduler"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/KeyFrameRequestScheduler.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include <algorithm> // std::max(), std::min(), std::remove_if()
+#include <cmath>     // std::ceil()
+#include <limits>
+#include <vector>
+
+namespace RTC
+{
+	/* Class variables. */
+
+	thread_local KeyFrameRequestScheduler::TimerListener KeyFrameRequestScheduler::timerListener;
+	thread_local Timer* KeyFrameRequestScheduler::timer{ nullptr };
+	thread_local std::deque<KeyFrameRequestScheduler::Request> KeyFrameRequestScheduler::requests;
+	thread_local absl::flat_hash_set<std::pair<KeyFrameRequestScheduler::Listener*, uint32_t>>
+	  KeyFrameRequestScheduler::scheduled;
+
+	/* Class methods. */
+
+	void KeyFrameRequestScheduler::ClassDestroy()
+	{
+		MS_TRACE();
+
+		delete KeyFrameRequestScheduler::timer;
+		KeyFrameRequestScheduler::timer = nullptr;
+
+		KeyFrameRequestScheduler::requests.clear();
+		KeyFrameRequestScheduler::scheduled.clear();
+	}
+
+	void KeyFrameRequestScheduler::Schedule(Budget* budget, Listener* listener, uint32_t ssrc)
+	{
+		MS_TRACE();
+
+		// Already queued, so it will be sent once.
+		if (IsScheduled(listener, ssrc))
+			return;
+
+		const uint64_t nowMs = DepLibUV::GetTimeMs();
+
+		if (budget->TryConsume(nowMs))
+		{
+			listener->OnKeyFrameRequestSchedulerRequest(ssrc);
+
+			return;
+		}
+
+		MS_DEBUG_DEV("key frame request budget exhausted, queueing request [ssrc:%" PRIu32 "]", ssrc);
+
+		KeyFrameRequestScheduler::requests.push_back({ budget, listener, ssrc });
+		KeyFrameRequestScheduler::scheduled.insert({ listener, ssrc });
+
+		if (KeyFrameRequestScheduler::requests.size() == 1u)
+			Arm(nowMs);
+	}
+
+	void KeyFrameRequestScheduler::Unschedule(Listener* listener, uint32_t ssrc)
+	{
+		MS_TRACE();
+
+		if (KeyFrameRequestScheduler::scheduled.erase({ listener, ssrc }) == 0u)
+			return;
+
+		auto& requests = KeyFrameRequestScheduler::requests;
+
+		// NOTE: The timer is not re-armed. If this was the only request it will
+		// just fire with nothing to do.
+		requests.erase(
+		  std::remove_if(
+		    requests.begin(),
+		    requests.end(),
+		    [listener, ssrc](const Request& request)
+		    { return request.listener == listener && request.ssrc == ssrc; }),
+		  requests.end());
+	}
+
+	void KeyFrameRequestScheduler::Unschedule(Listener* listener)
+	{
+		MS_TRACE();
+
+		auto& requests = KeyFrameRequestScheduler::requests;
+
+		requests.erase(
+		  std::remove_if(
+		    requests.begin(),
+		    requests.end(),
+		    [listener](const Request& request)
+		    {
+			    if (request.listener != listener)
+				    return false;
+
+			    KeyFrameRequestScheduler::scheduled.erase({ request.listener, request.ssrc });
+
+			    return true;
+		    }),
+		  requests.end());
+	}
+
+	void KeyFrameRequestScheduler::Arm(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		if (!KeyFrameRequestScheduler::timer)
+		{
+			KeyFrameRequestScheduler::timer =
+			  new Timer(std::addressof(KeyFrameRequestScheduler::timerListener));
+		}
+
+		if (KeyFrameRequestScheduler::requests.empty())
+		{
+			KeyFrameRequestScheduler::timer->Stop();
+
+			return;
+		}
+
+		uint64_t waitMs{ std::numeric_limits<uint64_t>::max() };
+
+		for (auto& request : KeyFrameRequestScheduler::requests)
+		{
+			waitMs = std::min(waitMs, request.budget->GetWaitMs(nowMs));
+		}
+
+		KeyFrameRequestScheduler::timer->Start(std::max<uint64_t>(waitMs, 1u));
+	}
+
+	void KeyFrameRequestScheduler::OnTimer()
+	{
+		MS_TRACE();
+
+		const uint64_t nowMs = DepLibUV::GetTimeMs();
+		auto& requests       = KeyFrameRequestScheduler::requests;
+		std::vector<Request> dueRequests;
+
+		// Take, in arrival order, the requests whose Budget allows them now. Those
+		// of exhausted Budgets stay queued without delaying the others.
+		requests.erase(
+		  std::remove_if(
+		    requests.begin(),
+		    requests.end(),
+		    [nowMs, &dueRequests](const Request& request)
+		    {
+			    if (!request.budget->TryConsume(nowMs))
+				    return false;
+
+			    KeyFrameRequestScheduler::scheduled.erase({ request.listener, request.ssrc });
+			    dueRequests.push_back(request);
+
+			    return true;
+		    }),
+		  requests.end());
+
+		for (auto& request : dueRequests)
+		{
+			request.listener->OnKeyFrameRequestSchedulerRequest(request.ssrc);
+		}
+
+		Arm(nowMs);
+	}
+
+	/* Instance methods. */
+
+	KeyFrameRequestScheduler::Budget::Budget(uint32_t requestsPerSecond, Budget* parent)
+	  : requestsPerSecond(requestsPerSecond), parent(parent)
+	{
+		MS_TRACE();
+
+		// Allow a burst of BurstMs worth of requests, and at least one.
+		this->capacity = std::max(
+		  1.0, static_cast<double>(requestsPerSecond) * KeyFrameRequestScheduler::BurstMs / 1000);
+		this->tokens         = this->capacity;
+		this->lastRefillAtMs = DepLibUV::GetTimeMs();
+	}
+
+	bool KeyFrameRequestScheduler::Budget::TryConsume(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		if (!HasToken(nowMs))
+			return false;
+
+		Consume();
+
+		return true;
+	}
+
+	uint64_t KeyFrameRequestScheduler::Budget::GetWaitMs(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		uint64_t waitMs{ 0u };
+
+		if (this->requestsPerSecond > 0u)
+		{
+			Refill(nowMs);
+
+			if (this->tokens < 1)
+			{
+				waitMs =
+				  static_cast<uint64_t>(std::ceil((1 - this->tokens) * 1000 / this->requestsPerSecond));
+			}
+		}
+
+		if (this->parent)
+			waitMs = std::max(waitMs, this->parent->GetWaitMs(nowMs));
+
+		return waitMs;
+	}
+
+	bool KeyFrameRequestScheduler::Budget::HasToken(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		if (this->requestsPerSecond > 0u)
+		{
+			Refill(nowMs);
+
+			if (this->tokens < 1)
+				return false;
+		}
+
+		return !this->parent || this->parent->HasToken(nowMs);
+	}
+
+	void KeyFrameRequestScheduler::Budget::Consume()
+	{
+		MS_TRACE();
+
+		if (this->requestsPerSecond > 0u)
+			this->tokens -= 1;
+
+		if (this->parent)
+			this->parent->Consume();
+	}
+
+	void KeyFrameRequestScheduler::Budget::Refill(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		if (nowMs <= this->lastRefillAtMs)
+			return;
+
+		this->tokens = std::min(
+		  this->capacity,
+		  this->tokens +
+		    (static_cast<double>(nowMs - this->lastRefillAtMs) * this->requestsPerSecond / 1000));
+		this->lastRefillAtMs = nowMs;
+	}
+
+	inline void KeyFrameRequestScheduler::TimerListener::OnTimer(Timer* /*timer*/)
+	{
+		MS_TRACE();
+
+		KeyFrameRequestScheduler::OnTimer();
+	}
+} // namespace RTC
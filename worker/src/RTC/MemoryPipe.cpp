@@ -0,0 +1,237 @@
+#define MS_CLASS "RTC::MemoryPipe"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/MemoryPipe.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "Utils.hpp"
+#include <cstring> // std::memcpy()
+
+/* Static. */
+
+static constexpr size_t MemoryPipeIdLength{ 32u };
+
+/* Static methods for UV callbacks. */
+
+inline static void onAsync(uv_async_t* handle)
+{
+	auto* memoryPipe = static_cast<RTC::MemoryPipe*>(handle->data);
+
+	if (memoryPipe)
+		memoryPipe->OnUvAsync();
+}
+
+inline static void onClose(uv_handle_t* handle)
+{
+	delete reinterpret_cast<uv_async_t*>(handle);
+}
+
+namespace RTC
+{
+	/* Class variables. */
+
+	// NOTE: Not thread_local since it's shared by workers running in different
+	// threads.
+	std::mutex MemoryPipe::registryMutex;
+	absl::flat_hash_map<std::string, std::shared_ptr<MemoryPipe::Port>> MemoryPipe::registry;
+
+	/* Instance methods. */
+
+	MemoryPipe::MemoryPipe(Listener* listener)
+	  : listener(listener), localPort(std::make_shared<Port>())
+	{
+		MS_TRACE();
+
+		auto* uvHandle = new uv_async_t;
+		int err = uv_async_init(DepLibUV::GetLoop(), uvHandle, static_cast<uv_async_cb>(onAsync));
+
+		if (err != 0)
+		{
+			delete uvHandle;
+
+			MS_THROW_ERROR("uv_async_init() failed: %s", uv_strerror(err));
+		}
+
+		uvHandle->data            = static_cast<void*>(this);
+		this->localPort->uvHandle = uvHandle;
+
+		std::lock_guard<std::mutex> lock(MemoryPipe::registryMutex);
+
+		do
+		{
+			this->id = Utils::Crypto::GetRandomString(MemoryPipeIdLength);
+		} while (MemoryPipe::registry.find(this->id) != MemoryPipe::registry.end());
+
+		MemoryPipe::registry[this->id] = this->localPort;
+	}
+
+	MemoryPipe::~MemoryPipe()
+	{
+		MS_TRACE();
+
+		{
+			std::lock_guard<std::mutex> lock(MemoryPipe::registryMutex);
+
+			MemoryPipe::registry.erase(this->id);
+		}
+
+		this->localPort->closed = true;
+
+		if (this->remotePort)
+		{
+			this->remotePort->connected = false;
+			this->remotePort.reset();
+		}
+
+		uv_async_t* uvHandle;
+
+		// Once uvHandle is unset the remote MemoryPipe won't signal us anymore.
+		{
+			std::lock_guard<std::mutex> lock(this->localPort->asyncMutex);
+
+			uvHandle                  = this->localPort->uvHandle;
+			this->localPort->uvHandle = nullptr;
+		}
+
+		uvHandle->data = nullptr;
+
+		uv_close(reinterpret_cast<uv_handle_t*>(uvHandle), static_cast<uv_close_cb>(onClose));
+	}
+
+	void MemoryPipe::Connect(const std::string& remoteId)
+	{
+		MS_TRACE();
+
+		if (this->remotePort)
+			MS_THROW_ERROR("already connected");
+		else if (remoteId == this->id)
+			MS_THROW_TYPE_ERROR("cannot connect to itself");
+
+		std::shared_ptr<Port> remotePort;
+
+		{
+			std::lock_guard<std::mutex> lock(MemoryPipe::registryMutex);
+
+			auto it = MemoryPipe::registry.find(remoteId);
+
+			if (it == MemoryPipe::registry.end())
+				MS_THROW_TYPE_ERROR("MemoryPipe with id \"%s\" not found", remoteId.c_str());
+
+			remotePort = it->second;
+		}
+
+		// The queue accepts a single producer.
+		bool expected{ false };
+
+		if (!remotePort->connected.compare_exchange_strong(expected, true))
+			MS_THROW_ERROR("MemoryPipe with id \"%s\" already connected", remoteId.c_str());
+
+		this->remotePort = std::move(remotePort);
+	}
+
+	bool MemoryPipe::Send(const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		auto* buffer = GetSendBuffer(len);
+
+		if (!buffer)
+			return false;
+
+		std::memcpy(buffer, data, len);
+
+		SendBuffer(len);
+
+		return true;
+	}
+
+	uint8_t* MemoryPipe::GetSendBuffer(size_t len)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(!this->sendBufferReserved, "send buffer already reserved");
+
+		if (!this->remotePort || this->remotePort->closed || len > MaxPacketSize)
+			return nullptr;
+
+		auto* packet = this->remotePort->queue.Reserve();
+
+		if (!packet)
+		{
+			MS_DEBUG_DEV("remote queue full, packet dropped");
+
+			// Make sure the remote loop is awake to drain it.
+			Signal();
+
+			return nullptr;
+		}
+
+		this->sendBufferReserved = true;
+
+		return packet->data;
+	}
+
+	void MemoryPipe::SendBuffer(size_t len)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(this->sendBufferReserved, "send buffer not reserved");
+		MS_ASSERT(len <= MaxPacketSize, "too big packet");
+
+		this->sendBufferReserved = false;
+
+		auto* packet = this->remotePort->queue.Reserve();
+
+		packet->len = len;
+
+		this->remotePort->queue.Commit();
+
+		Signal();
+	}
+
+	inline void MemoryPipe::Signal()
+	{
+		MS_TRACE();
+
+		// Coalesce wake ups until the consumer drains the queue.
+		if (this->remotePort->signaled.exchange(true))
+			return;
+
+		std::lock_guard<std::mutex> lock(this->remotePort->asyncMutex);
+
+		if (this->remotePort->uvHandle)
+			uv_async_send(this->remotePort->uvHandle);
+	}
+
+	inline void MemoryPipe::OnUvAsync()
+	{
+		MS_TRACE();
+
+		// Reset the flag before draining so packets committed from now on trigger
+		// a new wake up.
+		this->localPort->signaled.store(false);
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		auto& queue = this->localPort->queue;
+
+		// Do not drain more than the queue capacity so a fast producer cannot
+		// starve the loop.
+		for (size_t i{ 0u }; i < queue.GetCapacity(); ++i)
+		{
+			auto* packet = queue.Front();
+
+			if (!packet)
+				return;
+
+			this->listener->OnMemoryPipePacketReceived(this, packet->data, packet->len);
+
+			queue.Pop();
+		}
+
+		// More packets pending, process them in the next loop iteration.
+		if (queue.Front() && !this->localPort->signaled.exchange(true))
+			uv_async_send(this->localPort->uvHandle);
+	}
+} // namespace RTC
@@ -4,9 +4,11 @@
 #include "RTC/NackGenerator.hpp"
 #include "DepLibUV.hpp"
 #include "Logger.hpp"
-#include <iterator> // std::ostream_iterator
-#include <sstream>  // std::ostringstream
-#include <utility>  // std::make_pair()
+
+#include "Utils.hpp"
+#include <algorithm> // std::lower_bound(), std::max(), std::min(), std::remove_if()
+#include <iterator>  // std::ostream_iterator
+#include <sstream>   // std::ostringstream
 
 namespace RTC
 {
@@ -16,7 +18,80 @@ namespace RTC
 	static constexpr size_t MaxNackPackets{ 1000u };
 	static constexpr uint32_t DefaultRtt{ 100u };
 	static constexpr uint8_t MaxNackRetries{ 10u };
-	static constexpr uint64_t TimerInterval{ 40u };
+	// A packet is requested again after the RTT plus a fraction of it, so the
+	// retransmission has time to arrive despite jitter.
+	static constexpr uint32_t RetryRttMarginDivisor{ 4u };
+	static constexpr uint64_t MinRetryIntervalMs{ 20u };
+	// Key frames and recovered packets newer than the last valid packet can only
+	// be tracked if they are not further than this from it, otherwise their bits
+	// would collide with the ones of the oldest tracked packets.
+	static constexpr uint16_t MaxAheadAge{ NackGenerator::RingSize - MaxPacketAge - 1u };
+
+	static_assert(
+	  (NackGenerator::RingSize & (NackGenerator::RingSize - 1u)) == 0u, "RingSize must be a power of 2");
+	static_assert(MaxAheadAge > MaxNackPackets, "RingSize too small");
+
+	static inline size_t getSlot(uint16_t seq)
+	{
+		return seq & (NackGenerator::RingSize - 1u);
+	}
+
+	static inline bool testBit(const uint64_t* bitmap, uint16_t seq)
+	{
+		const size_t slot = getSlot(seq);
+
+		return (bitmap[slot / 64u] & (uint64_t{ 1u } << (slot % 64u))) != 0u;
+	}
+
+	static inline void setBit(uint64_t* bitmap, uint16_t seq)
+	{
+		const size_t slot = getSlot(seq);
+
+		bitmap[slot / 64u] |= uint64_t{ 1u } << (slot % 64u);
+	}
+
+	static inline void clearBit(uint64_t* bitmap, uint16_t seq)
+	{
+		const size_t slot = getSlot(seq);
+
+		bitmap[slot / 64u] &= ~(uint64_t{ 1u } << (slot % 64u));
+	}
+
+	// Returns the mask of the bits of the word containing the given seq that
+	// belong to [seq, seq + count), and updates count with the number of them.
+	static inline uint64_t getWordMask(uint16_t seq, size_t& count)
+	{
+		const size_t bit = getSlot(seq) % 64u;
+
+		count = std::min(count, 64u - bit);
+
+		const uint64_t mask = count == 64u ? ~uint64_t{ 0u } : (uint64_t{ 1u } << count) - 1u;
+
+		return mask << bit;
+	}
+
+	static void clearBits(uint64_t* bitmap, uint16_t seqStart, size_t count)
+	{
+		if (count >= NackGenerator::RingSize)
+		{
+			std::fill(bitmap, bitmap + (NackGenerator::RingSize / 64u), uint64_t{ 0u });
+
+			return;
+		}
+
+		uint16_t seq = seqStart;
+
+		while (count != 0u)
+		{
+			size_t wordCount    = count;
+			const uint64_t mask = getWordMask(seq, wordCount);
+
+			bitmap[getSlot(seq) / 64u] &= ~mask;
+
+			seq += static_cast<uint16_t>(wordCount);
+			count -= wordCount;
+		}
+	}
 
 	/* Instance methods. */
 
@@ -51,7 +126,7 @@ namespace RTC
 			this->lastSeq = seq;
 
 			if (isKeyFrame)
-				this->keyFrameList.insert(seq);
+				setBit(this->keyFrameBits.data(), seq);
 
 			return false;
 		}
@@ -64,10 +139,10 @@ namespace RTC
 		// or a retransmitted packet.
 		if (SeqManager<uint16_t>::IsSeqLowerThan(seq, this->lastSeq))
 		{
-			auto it = this->nackList.find(seq);
-
 			// It was a nacked packet.
-			if (it != this->nackList.end())
+			if (
+			  static_cast<uint16_t>(this->lastSeq - seq) <= MaxPacketAge &&
+			  testBit(this->nackBits.data(), seq))
 			{
 				MS_DEBUG_DEV(
 				  "NACKed packet received [ssrc:%" PRIu32 ", seq:%" PRIu16 ", recovered:%s]",
@@ -75,9 +150,18 @@ namespace RTC
 				  packet->GetSequenceNumber(),
 				  isRecovered ? "true" : "false");
 
-				auto retries = it->second.retries;
+				auto it = std::lower_bound(
+				  this->nackInfos.begin(),
+				  this->nackInfos.end(),
+				  seq,
+				  [](const NackInfo& nackInfo, uint16_t seq)
+				  { return SeqManager<uint16_t>::IsSeqLowerThan(nackInfo.seq, seq); });
 
-				this->nackList.erase(it);
+				MS_ASSERT(it != this->nackInfos.end() && it->seq == seq, "NACK info not found");
+
+				auto retries = it->retries;
+
+				RemoveNackItem(*it);
 
 				if (retries != 0)
 					return true;
@@ -100,26 +184,24 @@ namespace RTC
 		// If we are here it means that we may have lost some packets so seq is
 		// newer than the latest seq seen.
 
-		if (isKeyFrame)
-			this->keyFrameList.insert(seq);
+		const uint16_t aheadAge = seq - this->lastSeq;
 
 		// Remove old keyframes.
-		{
-			auto it = this->keyFrameList.lower_bound(seq - MaxPacketAge);
+		clearBits(this->keyFrameBits.data(), this->lastSeq - MaxPacketAge, aheadAge);
 
-			if (it != this->keyFrameList.begin())
-				this->keyFrameList.erase(this->keyFrameList.begin(), it);
-		}
+		// A key frame that is not recovered becomes the last valid packet, so it
+		// can always be tracked.
+		if (isKeyFrame && (!isRecovered || aheadAge <= MaxAheadAge))
+			setBit(this->keyFrameBits.data(), seq);
+
+		// Remove old ones so we don't accumulate recovered packets. This also
+		// makes room for the packets ahead of the new last valid packet.
+		clearBits(this->recoveredBits.data(), this->lastSeq - MaxPacketAge, aheadAge);
 
 		if (isRecovered)
 		{
-			this->recoveredList.insert(seq);
-
-			// Remove old ones so we don't accumulate recovered packets.
-			auto it = this->recoveredList.lower_bound(seq - MaxPacketAge);
-
-			if (it != this->recoveredList.begin())
-				this->recoveredList.erase(this->recoveredList.begin(), it);
+			if (aheadAge <= MaxAheadAge)
+				setBit(this->recoveredBits.data(), seq);
 
 			// Do not let a packet pass if it's newer than last seen seq and came via
 			// RTX.
@@ -136,9 +218,10 @@ namespace RTC
 		if (!nackBatch.empty())
 			this->listener->OnNackGeneratorNackRequired(nackBatch);
 
-		// This is important. Otherwise the running timer (filter:TIME) would be
-		// interrupted and NACKs would never been sent more than once for each seq.
-		if (!this->timer->IsActive())
+		// This is important. Re-arm the running timer (filter:TIME) only if some
+		// NACK is due before it fires, otherwise it would be postponed and NACKs
+		// would never been sent more than once for each seq.
+		if (!this->timer->IsActive() || this->nextNackAtMs < this->timerExpiresAtMs)
 			MayRunTimer();
 
 		return false;
@@ -149,81 +232,160 @@ namespace RTC
 		MS_TRACE();
 
 		// Remove old packets.
-		auto it = this->nackList.lower_bound(seqEnd - MaxPacketAge);
-
-		this->nackList.erase(this->nackList.begin(), it);
+		while (!this->nackInfos.empty() &&
+		       SeqManager<uint16_t>::IsSeqLowerThan(this->nackInfos.front().seq, seqEnd - MaxPacketAge))
+		{
+			RemoveNackItem(this->nackInfos.front());
+			this->nackInfos.pop_front();
+		}
 
 		// If the nack list is too large, remove packets from the nack list until
 		// the latest first packet of a keyframe. If the list is still too large,
 		// clear it and request a keyframe.
 		uint16_t numNewNacks = seqEnd - seqStart;
 
-		if (static_cast<uint16_t>(this->nackList.size()) + numNewNacks > MaxNackPackets)
+		if (static_cast<uint16_t>(this->nackListLength) + numNewNacks > MaxNackPackets)
 		{
 			// clang-format off
 			while (
-				RemoveNackItemsUntilKeyFrame() &&
-				static_cast<uint16_t>(this->nackList.size()) + numNewNacks > MaxNackPackets
+				RemoveNackItemsUntilKeyFrame(seqEnd) &&
+				static_cast<uint16_t>(this->nackListLength) + numNewNacks > MaxNackPackets
 			)
 			// clang-format on
 			{
 			}
 
-			if (static_cast<uint16_t>(this->nackList.size()) + numNewNacks > MaxNackPackets)
+			if (static_cast<uint16_t>(this->nackListLength) + numNewNacks > MaxNackPackets)
 			{
 				MS_WARN_TAG(
 				  rtx, "NACK list full, clearing it and requesting a key frame [seqEnd:%" PRIu16 "]", seqEnd);
 
-				this->nackList.clear();
+				this->nackBits.fill(0u);
+				this->nackInfos.clear();
+				this->nackListLength = 0u;
 				this->listener->OnNackGeneratorKeyFrameRequired();
 
 				return;
 			}
 		}
 
-		for (uint16_t seq = seqStart; seq != seqEnd; ++seq)
+		const uint64_t nowMs = DepLibUV::GetTimeMs();
+		uint16_t seq         = seqStart;
+		size_t count         = numNewNacks;
+
+		// Add a word of the ring at a time.
+		while (count != 0u)
 		{
-			MS_ASSERT(this->nackList.find(seq) == this->nackList.end(), "packet already in the NACK list");
+			size_t wordCount    = count;
+			const uint64_t mask = getWordMask(seq, wordCount);
+			const size_t word   = getSlot(seq) / 64u;
+
+			MS_ASSERT((this->nackBits[word] & mask) == 0u, "packet already in the NACK list");
 
 			// Do not send NACK for packets that are already recovered by RTX.
-			if (this->recoveredList.find(seq) != this->recoveredList.end())
-				continue;
+			uint64_t newBits = mask & ~this->recoveredBits[word];
+
+			this->nackBits[word] |= newBits;
+			this->nackListLength += Utils::Bits::CountSetBits(newBits);
 
-			this->nackList.emplace(std::make_pair(
-			  seq,
-			  NackInfo{
-			    DepLibUV::GetTimeMs(),
-			    seq,
-			    seq,
-			  }));
+			// Seq of the first bit of the word.
+			const auto wordSeq = static_cast<uint16_t>(seq - getSlot(seq) % 64u);
+
+			while (newBits != 0u)
+			{
+				this->nackInfos.emplace_back(
+				  nowMs, static_cast<uint16_t>(wordSeq + Utils::Bits::CountTrailingZeros(newBits)));
+
+				// Unset the lowest bit.
+				newBits &= newBits - 1u;
+			}
+
+			seq += static_cast<uint16_t>(wordCount);
+			count -= wordCount;
 		}
 	}
 
-	bool NackGenerator::RemoveNackItemsUntilKeyFrame()
+	bool NackGenerator::RemoveNackItemsUntilKeyFrame(uint16_t seqEnd)
 	{
 		MS_TRACE();
 
-		while (!this->keyFrameList.empty())
+		// Look for the oldest keyframe, starting from the oldest packet that may be
+		// tracked.
+		const size_t firstSlot = getSlot(seqEnd - MaxPacketAge);
+
+		for (size_t i{ 0u }; i < RingSize;)
 		{
-			auto it = this->nackList.lower_bound(*this->keyFrameList.begin());
+			const size_t slot   = (firstSlot + i) & (RingSize - 1u);
+			const uint64_t word = this->keyFrameBits[slot / 64u] >> (slot % 64u);
 
-			if (it != this->nackList.begin())
+			if (word == 0u)
+			{
+				i += 64u - slot % 64u;
+
+				continue;
+			}
+
+			i += Utils::Bits::CountTrailingZeros(word);
+
+			if (i >= RingSize)
+				break;
+
+			const auto keyFrameSeq = static_cast<uint16_t>(seqEnd - MaxPacketAge + i);
+
+			// Drop the already removed packets at the front.
+			while (!this->nackInfos.empty() && !testBit(this->nackBits.data(), this->nackInfos.front().seq))
+			{
+				this->nackInfos.pop_front();
+			}
+
+			if (
+			  !this->nackInfos.empty() &&
+			  SeqManager<uint16_t>::IsSeqLowerThan(this->nackInfos.front().seq, keyFrameSeq))
 			{
 				// We have found a keyframe that actually is newer than at least one
 				// packet in the nack list.
-				this->nackList.erase(this->nackList.begin(), it);
+				while (!this->nackInfos.empty() &&
+				       SeqManager<uint16_t>::IsSeqLowerThan(this->nackInfos.front().seq, keyFrameSeq))
+				{
+					RemoveNackItem(this->nackInfos.front());
+					this->nackInfos.pop_front();
+				}
 
 				return true;
 			}
 
 			// If this keyframe is so old it does not remove any packets from the list,
 			// remove it from the list of keyframes and try the next keyframe.
-			this->keyFrameList.erase(this->keyFrameList.begin());
+			clearBit(this->keyFrameBits.data(), keyFrameSeq);
+
+			++i;
 		}
 
 		return false;
 	}
 
+	inline void NackGenerator::RemoveNackItem(const NackInfo& nackInfo)
+	{
+		if (!testBit(this->nackBits.data(), nackInfo.seq))
+			return;
+
+		clearBit(this->nackBits.data(), nackInfo.seq);
+
+		--this->nackListLength;
+	}
+
+	inline uint64_t NackGenerator::GetNackDeadline(const NackInfo& nackInfo) const
+	{
+		// Not requested yet.
+		if (nackInfo.sentAtMs == 0u)
+			return nackInfo.createdAtMs + this->sendNackDelayMs;
+
+		const uint64_t retryIntervalMs =
+		  std::max<uint64_t>(this->rtt + (this->rtt / RetryRttMarginDivisor), MinRetryIntervalMs);
+
+		return nackInfo.sentAtMs + retryIntervalMs;
+	}
+
 	std::vector<uint16_t> NackGenerator::GetNackBatch(NackFilter filter)
 	{
 		MS_TRACE();
@@ -231,77 +393,69 @@ namespace RTC
 		uint64_t nowMs = DepLibUV::GetTimeMs();
 		std::vector<uint16_t> nackBatch;
 
-		auto it = this->nackList.begin();
+		this->nextNackAtMs = std::numeric_limits<uint64_t>::max();
 
-		while (it != this->nackList.end())
+		// Drop the already removed packets if they take most of the deque.
+		if (this->nackInfos.size() > 2u * this->nackListLength)
 		{
-			NackInfo& nackInfo = it->second;
-			uint16_t seq       = nackInfo.seq;
+			this->nackInfos.erase(
+			  std::remove_if(
+			    this->nackInfos.begin(),
+			    this->nackInfos.end(),
+			    [this](const NackInfo& nackInfo) { return !testBit(this->nackBits.data(), nackInfo.seq); }),
+			  this->nackInfos.end());
+		}
 
-			if (this->sendNackDelayMs > 0 && nowMs - nackInfo.createdAtMs < this->sendNackDelayMs)
-			{
-				++it;
+		for (auto& nackInfo : this->nackInfos)
+		{
+			uint16_t seq = nackInfo.seq;
+
+			// Already removed from the NACK list.
+			if (!testBit(this->nackBits.data(), seq))
 				continue;
-			}
+
+			const uint64_t deadlineMs = GetNackDeadline(nackInfo);
 
 			// clang-format off
-			if (
-				filter == NackFilter::SEQ &&
-				nackInfo.sentAtMs == 0 &&
+			const bool isDue = nowMs >= deadlineMs &&
+			(
+				filter == NackFilter::TIME ||
 				(
-					nackInfo.sendAtSeq == this->lastSeq ||
-					SeqManager<uint16_t>::IsSeqHigherThan(this->lastSeq, nackInfo.sendAtSeq)
+					nackInfo.sentAtMs == 0 &&
+					(
+						seq == this->lastSeq ||
+						SeqManager<uint16_t>::IsSeqHigherThan(this->lastSeq, seq)
+					)
 				)
-			)
+			);
 			// clang-format on
-			{
-				nackBatch.emplace_back(seq);
-				nackInfo.retries++;
-				nackInfo.sentAtMs = nowMs;
 
-				if (nackInfo.retries >= MaxNackRetries)
-				{
-					MS_WARN_TAG(
-					  rtx,
-					  "sequence number removed from the NACK list due to max retries [filter:seq, seq:%" PRIu16
-					  "]",
-					  seq);
-
-					it = this->nackList.erase(it);
-				}
-				else
-				{
-					++it;
-				}
+			if (!isDue)
+			{
+				this->nextNackAtMs = std::min(this->nextNackAtMs, deadlineMs);
 
 				continue;
 			}
 
-			if (filter == NackFilter::TIME && (nackInfo.sentAtMs == 0 || nowMs - nackInfo.sentAtMs >= this->rtt))
+			nackBatch.emplace_back(seq);
+			nackInfo.retries++;
+			nackInfo.sentAtMs = nowMs;
+
+			if (nackInfo.retries >= MaxNackRetries)
 			{
-				nackBatch.emplace_back(seq);
-				nackInfo.retries++;
-				nackInfo.sentAtMs = nowMs;
+				MS_WARN_TAG(
+				  rtx,
+				  "sequence number removed from the NACK list due to max retries [filter:%s, seq:%" PRIu16
+				  "]",
+				  filter == NackFilter::SEQ ? "seq" : "time",
+				  seq);
 
-				if (nackInfo.retries >= MaxNackRetries)
-				{
-					MS_WARN_TAG(
-					  rtx,
-					  "sequence number removed from the NACK list due to max retries [filter:time, seq:%" PRIu16
-					  "]",
-					  seq);
-
-					it = this->nackList.erase(it);
-				}
-				else
-				{
-					++it;
-				}
+				RemoveNackItem(nackInfo);
 
 				continue;
 			}
 
-			++it;
+			this->nextNackAtMs = std::min(this->nextNackAtMs, GetNackDeadline(nackInfo));
 		}
 
 #if MS_LOG_DEV_LEVEL == 3
@@ -326,18 +480,34 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		this->nackList.clear();
-		this->keyFrameList.clear();
-		this->recoveredList.clear();
+		this->nackBits.fill(0u);
+		this->keyFrameBits.fill(0u);
+		this->recoveredBits.fill(0u);
+		this->nackInfos.clear();
+		this->nackListLength = 0u;
 
-		this->started = false;
-		this->lastSeq = 0u;
+		this->started      = false;
+		this->lastSeq      = 0u;
+		this->nextNackAtMs = std::numeric_limits<uint64_t>::max();
 	}
 
-	inline void NackGenerator::MayRunTimer() const
+	inline void NackGenerator::MayRunTimer()
 	{
-		if (!this->nackList.empty())
-			this->timer->Start(TimerInterval);
+		// clang-format off
+		if (
+			this->nackListLength == 0u ||
+			this->nextNackAtMs == std::numeric_limits<uint64_t>::max()
+		)
+		// clang-format on
+		{
+			return;
+		}
+
+		const uint64_t nowMs = DepLibUV::GetTimeMs();
+
+		this->timerExpiresAtMs = std::max(this->nextNackAtMs, nowMs);
+
+		this->timer->Start(this->timerExpiresAtMs - nowMs);
 	}
 
 	inline void NackGenerator::OnTimer(Timer* /*timer*/)
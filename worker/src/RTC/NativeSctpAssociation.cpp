@@ -0,0 +1,2152 @@
+#define MS_CLASS "RTC::NativeSctpAssociation"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/NativeSctpAssociation.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include "Utils.hpp"
+#include "RTC/SctpPacket.hpp"
+#include <algorithm> // std::min(), std::max(), std::lower_bound()
+#include <cmath>     // std::fabs()
+#include <cstring>   // std::memcpy()
+
+namespace RTC
+{
+	/* Static. */
+
+	// Same port in both sides, as WebRTC does.
+	static constexpr uint16_t Port{ 5000u };
+	static constexpr size_t ChunkHeaderSize{ 4u };
+	// TSN, stream id, SSN and PPID.
+	static constexpr size_t DataHeaderSize{ 12u };
+	// Initiate tag, a_rwnd, OS, MIS and initial TSN.
+	static constexpr size_t InitFixedSize{ 16u };
+	// Supported Extensions (padded) and Forward-TSN-Supported parameters.
+	static constexpr size_t InitParametersSize{ 8u + 4u };
+	static constexpr uint8_t DataFlagUnordered{ 0x04 };
+	static constexpr uint8_t DataFlagBeginning{ 0x02 };
+	static constexpr uint8_t DataFlagEnd{ 0x01 };
+	// T bit of ABORT and SHUTDOWN-COMPLETE chunks.
+	static constexpr uint8_t ReflectedTagFlag{ 0x01 };
+	static constexpr uint16_t StateCookieParameter{ 7u };
+	static constexpr uint16_t OutgoingResetRequestParameter{ 13u };
+	static constexpr uint16_t IncomingResetRequestParameter{ 14u };
+	static constexpr uint16_t ReconfigResponseParameter{ 16u };
+	static constexpr uint16_t AddOutgoingStreamsParameter{ 17u };
+	static constexpr uint16_t AddIncomingStreamsParameter{ 18u };
+	static constexpr uint16_t SupportedExtensionsParameter{ 0x8008 };
+	static constexpr uint16_t ForwardTsnSupportedParameter{ 0xC000 };
+	// RE-CONFIG results (RFC 6525 section 4.4).
+	static constexpr uint32_t ReconfigResultNothingToDo{ 0u };
+	static constexpr uint32_t ReconfigResultPerformed{ 1u };
+	static constexpr uint32_t ReconfigResultDenied{ 2u };
+	static constexpr uint32_t ReconfigResultBadSequenceNumber{ 5u };
+	static constexpr uint32_t ReconfigResultInProgress{ 6u };
+	static constexpr uint8_t FeatureReconfig{ 0x01 };
+	static constexpr uint8_t FeatureForwardTsn{ 0x02 };
+	// "msNS".
+	static constexpr uint32_t CookieMagic{ 0x6d734e53 };
+	// Magic, tags, initial TSNs, a_rwnd, MIS, features and padding.
+	static constexpr size_t CookieLen{ 28u };
+	static constexpr size_t RecvWindow{ 262144u };
+	// Max TSNs received beyond the cumulative one.
+	static constexpr size_t MaxReceivedTsns{ 4096u };
+	static constexpr size_t MaxGapBlocks{ 64u };
+	// Max streams reset by a single RE-CONFIG request.
+	static constexpr size_t MaxStreamsPerReset{ 256u };
+	static constexpr uint64_t InitialRtoMs{ 500u };
+	static constexpr uint64_t MinRtoMs{ 200u };
+	static constexpr uint64_t MaxRtoMs{ 10000u };
+	static constexpr uint8_t MaxInitRetransmissions{ 8u };
+	static constexpr uint8_t MaxRetransmissions{ 10u };
+	static constexpr uint8_t FastRetransmitThreshold{ 3u };
+	static constexpr size_t InitialCwnd{ 10u * NativeSctpAssociation::Mtu };
+	static constexpr size_t MinSsthresh{ 4u * NativeSctpAssociation::Mtu };
+	static constexpr size_t MaxFreeBlocks{ 1024u };
+
+	// Serial number arithmetic of 32 bit TSNs.
+	inline static bool isTsnLower(uint32_t lhs, uint32_t rhs)
+	{
+		return static_cast<int32_t>(lhs - rhs) < 0;
+	}
+
+	inline static bool isSsnHigherOrEqual(uint16_t lhs, uint16_t rhs)
+	{
+		return static_cast<int16_t>(lhs - rhs) >= 0;
+	}
+
+	inline static size_t padTo4Bytes(size_t size)
+	{
+		return (size + 3u) & ~size_t{ 3u };
+	}
+
+	// Writes the fixed fields and the parameters of INIT and INIT-ACK chunks.
+	inline static void writeInitValue(
+	  uint8_t* value, uint32_t initTag, uint32_t rwnd, uint16_t os, uint16_t mis, uint32_t initialTsn)
+	{
+		Utils::Byte::Set4Bytes(value, 0, initTag);
+		Utils::Byte::Set4Bytes(value, 4, rwnd);
+		Utils::Byte::Set2Bytes(value, 8, os);
+		Utils::Byte::Set2Bytes(value, 10, mis);
+		Utils::Byte::Set4Bytes(value, 12, initialTsn);
+
+		// Supported Extensions: RE-CONFIG and FORWARD-TSN.
+		Utils::Byte::Set2Bytes(value, 16, SupportedExtensionsParameter);
+		Utils::Byte::Set2Bytes(value, 18, 6u);
+		value[20] = static_cast<uint8_t>(130u);
+		value[21] = static_cast<uint8_t>(192u);
+		value[22] = 0u;
+		value[23] = 0u;
+		// Forward-TSN-Supported.
+		Utils::Byte::Set2Bytes(value, 24, ForwardTsnSupportedParameter);
+		Utils::Byte::Set2Bytes(value, 26, 4u);
+	}
+
+	// Reads the parameters of INIT and INIT-ACK chunks.
+	static uint8_t readInitParameters(
+	  const uint8_t* params, size_t len, const uint8_t** cookie, size_t* cookieLen)
+	{
+		uint8_t features{ 0u };
+		size_t offset{ 0u };
+
+		while (offset + 4u <= len)
+		{
+			const uint16_t type     = Utils::Byte::Get2Bytes(params, offset);
+			const uint16_t paramLen = Utils::Byte::Get2Bytes(params, offset + 2);
+
+			if (paramLen < 4u || offset + paramLen > len)
+				break;
+
+			switch (type)
+			{
+				case SupportedExtensionsParameter:
+				{
+					for (size_t i{ 4u }; i < paramLen; ++i)
+					{
+						if (params[offset + i] == 130u)
+							features |= FeatureReconfig;
+						else if (params[offset + i] == 192u)
+							features |= FeatureForwardTsn;
+					}
+
+					break;
+				}
+
+				case ForwardTsnSupportedParameter:
+				{
+					features |= FeatureForwardTsn;
+
+					break;
+				}
+
+				case StateCookieParameter:
+				{
+					if (cookie)
+					{
+						*cookie    = params + offset + 4u;
+						*cookieLen = paramLen - 4u;
+					}
+
+					break;
+				}
+
+				default:;
+			}
+
+			offset += padTo4Bytes(paramLen);
+		}
+
+		return features;
+	}
+
+	/* Class variables. */
+
+	thread_local std::vector<uint8_t*> NativeSctpAssociation::freeBlocks;
+	thread_local uint8_t NativeSctpAssociation::packetBuffer[NativeSctpAssociation::Mtu];
+	thread_local std::vector<uint8_t> NativeSctpAssociation::messageBuffer;
+
+	/* Class methods. */
+
+	void NativeSctpAssociation::ClassDestroy()
+	{
+		MS_TRACE();
+
+		for (auto* block : NativeSctpAssociation::freeBlocks)
+		{
+			delete[] block;
+		}
+
+		NativeSctpAssociation::freeBlocks.clear();
+		NativeSctpAssociation::freeBlocks.shrink_to_fit();
+		NativeSctpAssociation::messageBuffer.clear();
+		NativeSctpAssociation::messageBuffer.shrink_to_fit();
+	}
+
+	uint8_t* NativeSctpAssociation::AcquireBlock()
+	{
+		MS_TRACE();
+
+		if (NativeSctpAssociation::freeBlocks.empty())
+			return new uint8_t[MaxDataPayloadLen];
+
+		auto* block = NativeSctpAssociation::freeBlocks.back();
+
+		NativeSctpAssociation::freeBlocks.pop_back();
+
+		return block;
+	}
+
+	void NativeSctpAssociation::ReleaseBlock(uint8_t* block)
+	{
+		MS_TRACE();
+
+		if (NativeSctpAssociation::freeBlocks.size() >= MaxFreeBlocks)
+			delete[] block;
+		else
+			NativeSctpAssociation::freeBlocks.push_back(block);
+	}
+
+	/* Instance methods. */
+
+	NativeSctpAssociation::NativeSctpAssociation(
+	  Listener* listener, uint16_t os, uint16_t mis, size_t maxMessageSize, size_t sendBufferSize)
+	  : listener(listener), os(os), mis(mis), maxMessageSize(maxMessageSize),
+	    sendBufferSize(sendBufferSize)
+	{
+		MS_TRACE();
+
+		this->t1Timer = new Timer(this);
+		this->t3Timer = new Timer(this);
+
+		this->myTag        = Utils::Crypto::GetRandomUInt(1u, 0xFFFFFFFE);
+		this->myInitialTsn = Utils::Crypto::GetRandomUInt(0u, 0xFFFFFFFE);
+		// The first RE-CONFIG request sequence number is the initial TSN
+		// (RFC 6525 section 4.1).
+		this->nextReconfigSeq = this->myInitialTsn;
+		this->rtoMs           = InitialRtoMs;
+
+		InitTransmission();
+	}
+
+	NativeSctpAssociation::~NativeSctpAssociation()
+	{
+		MS_TRACE();
+
+		delete this->t1Timer;
+		delete this->t3Timer;
+		delete this->reconfigRequest;
+
+		for (auto& chunk : this->outgoingChunks)
+		{
+			ReleaseBlock(chunk.payload);
+		}
+
+		for (auto& kv : this->incomingChunks)
+		{
+			ReleaseIncomingChunk(kv.second);
+		}
+	}
+
+	size_t NativeSctpAssociation::GetMemoryUsage() const
+	{
+		MS_TRACE();
+
+		return sizeof(NativeSctpAssociation) +
+		       (this->outgoingChunks.size() * (sizeof(OutgoingChunk) + MaxDataPayloadLen)) +
+		       this->incomingBytes + (this->receivedTsns.capacity() * sizeof(uint64_t));
+	}
+
+	void NativeSctpAssociation::Connect()
+	{
+		MS_TRACE();
+
+		if (this->state != State::CLOSED)
+			return;
+
+		this->state            = State::COOKIE_WAIT;
+		this->numT1Expirations = 0u;
+
+		SendInit();
+
+		this->t1Timer->Start(this->rtoMs);
+	}
+
+	void NativeSctpAssociation::ProcessPacket(const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		if (len < SctpPacket::CommonHeaderSize + ChunkHeaderSize)
+			return;
+
+		const uint32_t verificationTag = Utils::Byte::Get4Bytes(data, 4);
+		const auto firstType           = static_cast<ChunkType>(data[SctpPacket::CommonHeaderSize]);
+		const uint8_t firstFlags       = data[SctpPacket::CommonHeaderSize + 1];
+
+		// Verification tag rules (RFC 4960 section 8.5.1).
+		if (firstType == ChunkType::INIT)
+		{
+			if (verificationTag != 0u)
+				return;
+		}
+		// clang-format off
+		else if (
+			(firstType == ChunkType::ABORT || firstType == ChunkType::SHUTDOWN_COMPLETE) &&
+			(firstFlags & ReflectedTagFlag)
+		)
+		// clang-format on
+		{
+			if (verificationTag != this->peerTag)
+				return;
+		}
+		else if (verificationTag != this->myTag)
+		{
+			MS_DEBUG_DEV("ignoring packet with wrong verification tag");
+
+			return;
+		}
+
+		size_t offset{ SctpPacket::CommonHeaderSize };
+
+		while (offset + ChunkHeaderSize <= len)
+		{
+			const auto type         = static_cast<ChunkType>(data[offset]);
+			const uint8_t flags     = data[offset + 1];
+			const uint16_t chunkLen = Utils::Byte::Get2Bytes(data, offset + 2);
+			const uint8_t* value    = data + offset + ChunkHeaderSize;
+
+			if (chunkLen < ChunkHeaderSize || offset + chunkLen > len)
+				break;
+
+			const size_t valueLen = chunkLen - ChunkHeaderSize;
+
+			// Chunks that need an established association.
+			// clang-format off
+			if (
+				this->state != State::ESTABLISHED &&
+				(
+					type == ChunkType::DATA ||
+					type == ChunkType::SACK ||
+					type == ChunkType::FORWARD_TSN ||
+					type == ChunkType::RE_CONFIG
+				)
+			)
+			// clang-format on
+			{
+				offset += padTo4Bytes(chunkLen);
+
+				continue;
+			}
+
+			switch (type)
+			{
+				case ChunkType::DATA:
+				{
+					ProcessData(flags, value, valueLen);
+
+					break;
+				}
+
+				case ChunkType::INIT:
+				{
+					ProcessInit(value, valueLen);
+
+					break;
+				}
+
+				case ChunkType::INIT_ACK:
+				{
+					ProcessInitAck(value, valueLen);
+
+					break;
+				}
+
+				case ChunkType::SACK:
+				{
+					ProcessSack(value, valueLen);
+
+					break;
+				}
+
+				case ChunkType::HEARTBEAT:
+				{
+					ProcessHeartbeat(value, valueLen);
+
+					break;
+				}
+
+				case ChunkType::HEARTBEAT_ACK:
+				{
+					break;
+				}
+
+				case ChunkType::ABORT:
+				{
+					ProcessAbort();
+
+					return;
+				}
+
+				case ChunkType::SHUTDOWN:
+				{
+					ProcessShutdown();
+
+					return;
+				}
+
+				case ChunkType::SHUTDOWN_ACK:
+				{
+					BeginPacket(this->peerTag);
+					AddChunk(ChunkType::SHUTDOWN_COMPLETE, 0u, 0u);
+					SendPacket();
+					SetClosed(false);
+
+					return;
+				}
+
+				case ChunkType::SHUTDOWN_COMPLETE:
+				{
+					SetClosed(false);
+
+					return;
+				}
+
+				case ChunkType::ERROR:
+				{
+					MS_DEBUG_TAG(sctp, "ERROR chunk received");
+
+					break;
+				}
+
+				case ChunkType::COOKIE_ECHO:
+				{
+					ProcessCookieEcho(value, valueLen);
+
+					break;
+				}
+
+				case ChunkType::COOKIE_ACK:
+				{
+					ProcessCookieAck();
+
+					break;
+				}
+
+				case ChunkType::RE_CONFIG:
+				{
+					ProcessReconfig(value, valueLen);
+
+					break;
+				}
+
+				case ChunkType::FORWARD_TSN:
+				{
+					ProcessForwardTsn(value, valueLen);
+
+					break;
+				}
+
+				default:
+				{
+					// Unknown chunk: the upper bit tells whether to skip it or to stop
+					// processing the packet (RFC 4960 section 3.2).
+					if ((data[offset] & 0x80) == 0u)
+					{
+						MS_DEBUG_TAG(sctp, "unknown chunk [type:%" PRIu8 "]", data[offset]);
+
+						offset = len;
+
+						continue;
+					}
+				}
+			}
+
+			offset += padTo4Bytes(chunkLen);
+		}
+
+		if (this->peerLastReconfigResult == ReconfigResultInProgress)
+			PerformDeferredReset();
+
+		// Send the SACK (and the chunks queued meanwhile) bundled in the same
+		// packets as the pending data.
+		Flush();
+	}
+
+	bool NativeSctpAssociation::SendMessage(
+	  uint16_t streamId,
+	  uint32_t ppid,
+	  bool ordered,
+	  uint16_t maxPacketLifeTime,
+	  uint16_t maxRetransmits,
+	  const uint8_t* msg,
+	  size_t len)
+	{
+		MS_TRACE();
+
+		// DATA chunks cannot be empty.
+		if (len == 0u)
+		{
+			MS_WARN_TAG(sctp, "ignoring empty message");
+
+			return true;
+		}
+
+		if (this->bufferedAmount + len > this->sendBufferSize)
+			return false;
+
+		const uint16_t ssn = ordered ? this->nextSsns[streamId]++ : 0u;
+		// Only unordered messages are partially reliable, since abandoning an
+		// ordered one would need to announce its stream and SSN.
+		const uint64_t expiresAtMs =
+		  !ordered && maxPacketLifeTime != 0u ? DepLibUV::GetTimeMs() + maxPacketLifeTime : 0u;
+		const bool limitedRetransmits = !ordered && maxPacketLifeTime == 0u && maxRetransmits != 0u;
+
+		for (size_t offset{ 0u }; offset < len; offset += MaxDataPayloadLen)
+		{
+			OutgoingChunk chunk;
+
+			chunk.payloadLen         = static_cast<uint16_t>(std::min(len - offset, MaxDataPayloadLen));
+			chunk.payload            = AcquireBlock();
+			chunk.expiresAtMs        = expiresAtMs;
+			chunk.tsn                = this->nextTsn++;
+			chunk.ppid               = ppid;
+			chunk.streamId           = streamId;
+			chunk.ssn                = ssn;
+			chunk.maxRetransmits     = maxRetransmits;
+			chunk.limitedRetransmits = limitedRetransmits;
+
+			if (!ordered)
+				chunk.flags |= DataFlagUnordered;
+			if (offset == 0u)
+				chunk.flags |= DataFlagBeginning;
+			if (offset + chunk.payloadLen == len)
+				chunk.flags |= DataFlagEnd;
+
+			std::memcpy(chunk.payload, msg + offset, chunk.payloadLen);
+
+			this->outgoingChunks.push_back(chunk);
+		}
+
+		this->bufferedAmount += len;
+
+		NotifyBufferedAmount();
+
+		return true;
+	}
+
+	void NativeSctpAssociation::Flush()
+	{
+		MS_TRACE();
+
+		if (this->state != State::ESTABLISHED)
+		{
+			SendPacket();
+
+			return;
+		}
+
+		const uint64_t nowMs = DepLibUV::GetTimeMs();
+
+		// Abandon the expired messages.
+		if (this->peerSupportsForwardTsn)
+		{
+			for (size_t idx{ 0u }; idx < this->outgoingChunks.size(); ++idx)
+			{
+				auto& chunk = this->outgoingChunks[idx];
+
+				// clang-format off
+				if (
+					chunk.expiresAtMs != 0u &&
+					chunk.expiresAtMs <= nowMs &&
+					chunk.state != ChunkState::ACKED &&
+					chunk.state != ChunkState::ABANDONED
+				)
+				// clang-format on
+				{
+					AbandonMessage(idx);
+				}
+			}
+
+			UpdateAdvancedPeerAckPoint();
+		}
+
+		if (this->sackNeeded)
+			AddSack();
+
+		if (this->forwardTsnNeeded)
+			AddForwardTsn();
+
+		// Retransmissions first.
+		if (this->numToRetransmit != 0u)
+		{
+			const size_t numSent = GetOutgoingIndex(this->firstUnsentTsn);
+			bool retransmitted{ false };
+
+			for (size_t idx{ 0u }; idx < numSent && this->numToRetransmit != 0u; ++idx)
+			{
+				auto& chunk = this->outgoingChunks[idx];
+
+				if (chunk.state != ChunkState::TO_RETRANSMIT)
+					continue;
+
+				// The first one goes anyway so fast retransmit is not delayed
+				// (RFC 4960 section 7.2.4).
+				if (retransmitted && this->flightSize >= this->cwnd)
+					break;
+
+				AddDataChunk(chunk, nowMs);
+
+				retransmitted = true;
+			}
+		}
+
+		// Then new chunks.
+		while (!this->outgoingChunks.empty())
+		{
+			const size_t idx = GetOutgoingIndex(this->firstUnsentTsn);
+
+			if (idx >= this->outgoingChunks.size())
+				break;
+
+			auto& chunk = this->outgoingChunks[idx];
+
+			if (chunk.state == ChunkState::ABANDONED)
+			{
+				this->firstUnsentTsn++;
+
+				continue;
+			}
+
+			// A chunk is always allowed when nothing is in flight (RFC 4960
+			// section 6.1).
+			if (this->flightSize != 0u)
+			{
+				if (this->flightSize >= this->cwnd)
+					break;
+				else if (this->flightSize + chunk.payloadLen > this->peerRwnd)
+					break;
+			}
+
+			AddDataChunk(chunk, nowMs);
+
+			this->firstUnsentTsn++;
+		}
+
+		// After the DATA, so the remote gets it before resetting the streams.
+		SendNextReconfigRequest();
+		SendPacket();
+
+		// clang-format off
+		if (
+			!this->t3Timer->IsActive() &&
+			(this->flightSize != 0u || this->advancedPeerAckPoint != this->peerCumulativeTsn)
+		)
+		// clang-format on
+		{
+			this->t3Timer->Start(this->rtoMs);
+		}
+	}
+
+	void NativeSctpAssociation::ResetOutgoingStream(uint16_t streamId)
+	{
+		MS_TRACE();
+
+		this->pendingResetStreamIds.push_back(streamId);
+	}
+
+	void NativeSctpAssociation::AddOutgoingStreams(uint16_t numStreams)
+	{
+		MS_TRACE();
+
+		const size_t total = size_t{ this->os } + this->pendingNumStreamsToAdd + numStreams;
+
+		if (total > 65535u)
+			numStreams = static_cast<uint16_t>(65535u - this->os - this->pendingNumStreamsToAdd);
+
+		if (numStreams == 0u)
+			return;
+
+		this->pendingNumStreamsToAdd += numStreams;
+	}
+
+	void NativeSctpAssociation::ProcessInit(const uint8_t* value, size_t len)
+	{
+		MS_TRACE();
+
+		if (len < InitFixedSize)
+			return;
+
+		const uint32_t initTag    = Utils::Byte::Get4Bytes(value, 0);
+		const uint32_t rwnd       = Utils::Byte::Get4Bytes(value, 4);
+		const uint16_t peerOs     = Utils::Byte::Get2Bytes(value, 8);
+		const uint16_t peerMis    = Utils::Byte::Get2Bytes(value, 10);
+		const uint32_t initialTsn = Utils::Byte::Get4Bytes(value, 12);
+
+		if (initTag == 0u || peerOs == 0u || peerMis == 0u)
+		{
+			MS_WARN_TAG(sctp, "invalid INIT chunk");
+
+			return;
+		}
+
+		const uint8_t features =
+		  readInitParameters(value + InitFixedSize, len - InitFixedSize, nullptr, nullptr);
+
+		// No state is kept until the COOKIE-ECHO (RFC 4960 section 5.1), which
+		// also covers simultaneous INITs and restarts of the remote endpoint.
+		SendInitAck(initTag, initialTsn, rwnd, peerMis, features);
+	}
+
+	void NativeSctpAssociation::ProcessInitAck(const uint8_t* value, size_t len)
+	{
+		MS_TRACE();
+
+		if (this->state != State::COOKIE_WAIT || len < InitFixedSize)
+			return;
+
+		const uint32_t initTag    = Utils::Byte::Get4Bytes(value, 0);
+		const uint32_t rwnd       = Utils::Byte::Get4Bytes(value, 4);
+		const uint16_t peerMis    = Utils::Byte::Get2Bytes(value, 10);
+		const uint32_t initialTsn = Utils::Byte::Get4Bytes(value, 12);
+		const uint8_t* cookie{ nullptr };
+		size_t cookieLen{ 0u };
+
+		const uint8_t features =
+		  readInitParameters(value + InitFixedSize, len - InitFixedSize, &cookie, &cookieLen);
+
+		if (initTag == 0u || peerMis == 0u || !cookie)
+		{
+			MS_WARN_TAG(sctp, "invalid INIT-ACK chunk");
+
+			return;
+		}
+
+		this->peerTag                = initTag;
+		this->peerRwnd               = rwnd;
+		this->ssthresh               = rwnd;
+		this->os                     = std::min(this->os, peerMis);
+		this->peerSupportsReconfig   = features & FeatureReconfig;
+		this->peerSupportsForwardTsn = features & FeatureForwardTsn;
+
+		this->cookie.assign(cookie, cookie + cookieLen);
+
+		InitReception(initialTsn);
+
+		this->state            = State::COOKIE_ECHOED;
+		this->numT1Expirations = 0u;
+
+		SendCookieEcho();
+
+		this->t1Timer->Start(this->rtoMs);
+	}
+
+	void NativeSctpAssociation::ProcessCookieEcho(const uint8_t* value, size_t len)
+	{
+		MS_TRACE();
+
+		// clang-format off
+		if (
+			len < CookieLen ||
+			Utils::Byte::Get4Bytes(value, 0) != CookieMagic ||
+			Utils::Byte::Get4Bytes(value, 4) != this->myTag
+		)
+		// clang-format on
+		{
+			MS_WARN_TAG(sctp, "invalid state cookie");
+
+			return;
+		}
+
+		const uint32_t cookiePeerTag = Utils::Byte::Get4Bytes(value, 8);
+		const uint32_t initialTsn    = Utils::Byte::Get4Bytes(value, 16);
+		const uint32_t rwnd          = Utils::Byte::Get4Bytes(value, 20);
+		const uint16_t peerMis       = Utils::Byte::Get2Bytes(value, 24);
+		const uint8_t features       = value[26];
+
+		// Duplicated COOKIE-ECHO, just acknowledge it again.
+		if (this->state == State::ESTABLISHED && cookiePeerTag == this->peerTag)
+		{
+			PrepareChunk(0u);
+			AddChunk(ChunkType::COOKIE_ACK, 0u, 0u);
+
+			return;
+		}
+
+		// The remote endpoint restarted the association, so everything sent and
+		// received so far is lost for it.
+		if (this->state == State::ESTABLISHED)
+		{
+			MS_DEBUG_TAG(sctp, "remote endpoint restarted the association");
+
+			for (auto& chunk : this->outgoingChunks)
+			{
+				ReleaseBlock(chunk.payload);
+			}
+
+			this->outgoingChunks.clear();
+			this->nextSsns.clear();
+			this->bufferedAmount = 0u;
+
+			InitTransmission();
+			NotifyBufferedAmount();
+		}
+
+		this->peerTag                = cookiePeerTag;
+		this->peerRwnd               = rwnd;
+		this->ssthresh               = rwnd;
+		this->os                     = std::min(this->os, peerMis);
+		this->peerSupportsReconfig   = features & FeatureReconfig;
+		this->peerSupportsForwardTsn = features & FeatureForwardTsn;
+
+		InitReception(initialTsn);
+
+		PrepareChunk(0u);
+		AddChunk(ChunkType::COOKIE_ACK, 0u, 0u);
+
+		if (this->state != State::ESTABLISHED)
+			SetEstablished();
+	}
+
+	void NativeSctpAssociation::ProcessCookieAck()
+	{
+		MS_TRACE();
+
+		if (this->state == State::COOKIE_ECHOED)
+			SetEstablished();
+	}
+
+	void NativeSctpAssociation::ProcessData(uint8_t flags, const uint8_t* value, size_t len)
+	{
+		MS_TRACE();
+
+		if (len <= DataHeaderSize)
+			return;
+
+		const uint32_t tsn      = Utils::Byte::Get4Bytes(value, 0);
+		const uint16_t streamId = Utils::Byte::Get2Bytes(value, 4);
+		const uint16_t ssn      = Utils::Byte::Get2Bytes(value, 6);
+		const uint32_t ppid     = Utils::Byte::Get4Bytes(value, 8);
+		const uint8_t* payload  = value + DataHeaderSize;
+		const size_t payloadLen = len - DataHeaderSize;
+		const auto delta = static_cast<int32_t>(tsn - static_cast<uint32_t>(this->cumulativeTsn));
+
+		// Every DATA chunk is acknowledged, duplicated ones too.
+		this->sackNeeded = true;
+
+		if (delta <= 0)
+			return;
+
+		const uint64_t tsn64 = this->cumulativeTsn + delta;
+		auto it = std::lower_bound(this->receivedTsns.begin(), this->receivedTsns.end(), tsn64);
+
+		if (it != this->receivedTsns.end() && *it == tsn64)
+			return;
+
+		// Drop it if the receive window is exceeded, but for the next expected
+		// TSN so the association never stalls.
+		// clang-format off
+		if (
+			tsn64 != this->cumulativeTsn + 1u &&
+			(
+				this->incomingBytes + payloadLen > GetRecvWindow() ||
+				this->receivedTsns.size() >= MaxReceivedTsns
+			)
+		)
+		// clang-format on
+		{
+			MS_DEBUG_DEV("receive window exceeded, DATA chunk dropped");
+
+			return;
+		}
+
+		this->receivedTsns.insert(it, tsn64);
+
+		AdvanceCumulativeTsn();
+
+		const bool unordered = flags & DataFlagUnordered;
+		const bool complete  = (flags & (DataFlagBeginning | DataFlagEnd)) ==
+		                      (DataFlagBeginning | DataFlagEnd);
+
+		// Message in a single chunk that can be delivered right away (the most
+		// common case) is given to the listener straight from the packet.
+		if (complete && (unordered || ssn == this->expectedSsns[streamId]))
+		{
+			if (payloadLen > this->maxMessageSize)
+			{
+				MS_WARN_TAG(
+				  sctp, "ignoring message bigger than maxMessageSize [len:%zu]", payloadLen);
+			}
+			else
+			{
+				this->listener->OnNativeSctpAssociationMessageReceived(
+				  this, streamId, ppid, payload, payloadLen);
+			}
+
+			if (!unordered)
+			{
+				this->expectedSsns[streamId]++;
+
+				DeliverInOrder(streamId);
+			}
+
+			return;
+		}
+
+		IncomingChunk chunk;
+
+		chunk.ppid       = ppid;
+		chunk.payloadLen = static_cast<uint16_t>(payloadLen);
+		chunk.streamId   = streamId;
+		chunk.ssn        = ssn;
+		chunk.flags      = flags;
+		// The remote may use a bigger MTU than ours.
+		chunk.payload = payloadLen <= MaxDataPayloadLen ? AcquireBlock() : new uint8_t[payloadLen];
+
+		std::memcpy(chunk.payload, payload, payloadLen);
+
+		this->incomingChunks[tsn64] = chunk;
+		this->incomingBytes += payloadLen;
+
+		if (!unordered)
+		{
+			DeliverInOrder(streamId);
+
+			return;
+		}
+
+		// Look for the first chunk of the unordered message.
+		uint64_t firstTsn{ tsn64 };
+
+		while (!(this->incomingChunks[firstTsn].flags & DataFlagBeginning))
+		{
+			auto prevIt = this->incomingChunks.find(firstTsn - 1u);
+
+			if (prevIt == this->incomingChunks.end() || (prevIt->second.flags & DataFlagEnd))
+				return;
+
+			firstTsn--;
+		}
+
+		DeliverMessage(firstTsn);
+	}
+
+	void NativeSctpAssociation::ProcessSack(const uint8_t* value, size_t len)
+	{
+		MS_TRACE();
+
+		if (len < 12u)
+			return;
+
+		const uint32_t cumTsnAck  = Utils::Byte::Get4Bytes(value, 0);
+		const uint32_t rwnd       = Utils::Byte::Get4Bytes(value, 4);
+		const uint16_t numGaps    = Utils::Byte::Get2Bytes(value, 8);
+		const uint16_t numDups    = Utils::Byte::Get2Bytes(value, 10);
+		const uint64_t nowMs      = DepLibUV::GetTimeMs();
+		const bool cumTsnAdvanced = cumTsnAck != this->peerCumulativeTsn;
+		size_t bytesAcked{ 0u };
+		uint64_t rttMs{ 0u };
+		bool rttMeasured{ false };
+
+		if (len < 12u + (size_t{ numGaps } * 4u) + (size_t{ numDups } * 4u))
+			return;
+
+		// Old SACK, or acknowledging TSNs never sent.
+		// clang-format off
+		if (
+			isTsnLower(cumTsnAck, this->peerCumulativeTsn) ||
+			isTsnLower(this->firstUnsentTsn - 1u, cumTsnAck)
+		)
+		// clang-format on
+		{
+			return;
+		}
+
+		// Cumulative acknowledgement.
+		while (!this->outgoingChunks.empty() &&
+		       !isTsnLower(cumTsnAck, this->outgoingChunks.front().tsn))
+		{
+			auto& chunk = this->outgoingChunks.front();
+
+			if (chunk.state == ChunkState::IN_FLIGHT)
+			{
+				this->flightSize -= chunk.payloadLen;
+				bytesAcked += chunk.payloadLen;
+
+				// Karn's algorithm.
+				if (chunk.numTransmissions == 1u)
+				{
+					rttMs       = nowMs - chunk.sentAtMs;
+					rttMeasured = true;
+				}
+			}
+			else if (chunk.state == ChunkState::TO_RETRANSMIT)
+			{
+				this->numToRetransmit--;
+				bytesAcked += chunk.payloadLen;
+			}
+
+			this->bufferedAmount -= chunk.payloadLen;
+
+			ReleaseBlock(chunk.payload);
+
+			this->outgoingChunks.pop_front();
+		}
+
+		this->peerCumulativeTsn = cumTsnAck;
+
+		if (isTsnLower(this->advancedPeerAckPoint, cumTsnAck))
+			this->advancedPeerAckPoint = cumTsnAck;
+
+		// Gap blocks.
+		const size_t numSent =
+		  this->outgoingChunks.empty() ? 0u : GetOutgoingIndex(this->firstUnsentTsn);
+		size_t highestAckedIdx{ 0u };
+
+		for (size_t i{ 0u }; i < numGaps; ++i)
+		{
+			const uint16_t start = Utils::Byte::Get2Bytes(value, 12u + (i * 4u));
+			const uint16_t end   = Utils::Byte::Get2Bytes(value, 14u + (i * 4u));
+
+			// Offsets are relative to the cumulative TSN, so index = offset - 1.
+			for (size_t idx = start == 0u ? 0u : start - 1u; idx < end && idx < numSent; ++idx)
+			{
+				auto& chunk = this->outgoingChunks[idx];
+
+				if (chunk.state == ChunkState::IN_FLIGHT)
+				{
+					this->flightSize -= chunk.payloadLen;
+					bytesAcked += chunk.payloadLen;
+					chunk.state = ChunkState::ACKED;
+
+					if (chunk.numTransmissions == 1u)
+					{
+						rttMs       = nowMs - chunk.sentAtMs;
+						rttMeasured = true;
+					}
+				}
+				else if (chunk.state == ChunkState::TO_RETRANSMIT)
+				{
+					this->numToRetransmit--;
+					chunk.state = ChunkState::ACKED;
+				}
+
+				highestAckedIdx = std::max(highestAckedIdx, idx + 1u);
+			}
+		}
+
+		// Chunks below the highest acknowledged one are missing (RFC 4960 section
+		// 7.2.4).
+		for (size_t idx{ 0u }; idx < highestAckedIdx; ++idx)
+		{
+			auto& chunk = this->outgoingChunks[idx];
+
+			// Chunks are fast retransmitted just once, then T3 takes care of them.
+			if (chunk.state != ChunkState::IN_FLIGHT || chunk.numTransmissions > 1u)
+				continue;
+
+			if (++chunk.missingReports < FastRetransmitThreshold)
+				continue;
+
+			if (!this->fastRecovery)
+			{
+				this->fastRecovery        = true;
+				this->fastRecoveryExitTsn = this->nextTsn - 1u;
+				this->ssthresh            = std::max(this->cwnd / 2u, MinSsthresh);
+				this->cwnd                = this->ssthresh;
+				this->partialBytesAcked   = 0u;
+			}
+
+			MarkForRetransmit(idx, nowMs);
+		}
+
+		if (this->fastRecovery && !isTsnLower(cumTsnAck, this->fastRecoveryExitTsn))
+			this->fastRecovery = false;
+
+		if (rttMeasured)
+			UpdateRto(rttMs);
+
+		// Slow start and congestion avoidance (RFC 4960 section 7.2).
+		if (cumTsnAdvanced && bytesAcked != 0u && !this->fastRecovery)
+		{
+			if (this->cwnd <= this->ssthresh)
+			{
+				this->cwnd += std::min(bytesAcked, Mtu);
+			}
+			else
+			{
+				this->partialBytesAcked += bytesAcked;
+
+				if (this->partialBytesAcked >= this->cwnd)
+				{
+					this->partialBytesAcked -= this->cwnd;
+					this->cwnd += Mtu;
+				}
+			}
+		}
+
+		this->peerRwnd = rwnd;
+
+		if (cumTsnAdvanced)
+		{
+			this->numT3Expirations = 0u;
+
+			if (this->flightSize != 0u)
+				this->t3Timer->Start(this->rtoMs);
+		}
+
+		UpdateAdvancedPeerAckPoint();
+
+		// The previous FORWARD-TSN got lost.
+		if (this->advancedPeerAckPoint != this->peerCumulativeTsn)
+			this->forwardTsnNeeded = true;
+		else if (this->flightSize == 0u)
+			this->t3Timer->Stop();
+
+		NotifyBufferedAmount();
+	}
+
+	void NativeSctpAssociation::ProcessForwardTsn(const uint8_t* value, size_t len)
+	{
+		MS_TRACE();
+
+		if (len < 4u)
+			return;
+
+		const uint32_t newCumTsn = Utils::Byte::Get4Bytes(value, 0);
+		const auto delta = static_cast<int32_t>(newCumTsn - static_cast<uint32_t>(this->cumulativeTsn));
+
+		this->sackNeeded = true;
+
+		if (delta <= 0)
+			return;
+
+		const uint64_t newCumTsn64 = this->cumulativeTsn + delta;
+		auto it = std::upper_bound(this->receivedTsns.begin(), this->receivedTsns.end(), newCumTsn64);
+
+		this->receivedTsns.erase(this->receivedTsns.begin(), it);
+		this->cumulativeTsn = newCumTsn64;
+
+		AdvanceCumulativeTsn();
+
+		// Skipped ordered messages.
+		for (size_t offset{ 4u }; offset + 4u <= len; offset += 4u)
+		{
+			const uint16_t streamId = Utils::Byte::Get2Bytes(value, offset);
+			const uint16_t ssn      = Utils::Byte::Get2Bytes(value, offset + 2);
+			auto& expectedSsn       = this->expectedSsns[streamId];
+
+			if (isSsnHigherOrEqual(ssn, expectedSsn))
+				expectedSsn = ssn + 1u;
+		}
+
+		// Drop the fragments of the abandoned messages, but for those of ordered
+		// messages still to be delivered.
+		for (auto chunkIt = this->incomingChunks.begin();
+		     chunkIt != this->incomingChunks.end() && chunkIt->first <= newCumTsn64;)
+		{
+			auto& chunk = chunkIt->second;
+
+			// clang-format off
+			if (
+				!(chunk.flags & DataFlagUnordered) &&
+				isSsnHigherOrEqual(chunk.ssn, this->expectedSsns[chunk.streamId])
+			)
+			// clang-format on
+			{
+				++chunkIt;
+
+				continue;
+			}
+
+			this->incomingBytes -= chunk.payloadLen;
+
+			ReleaseIncomingChunk(chunk);
+
+			chunkIt = this->incomingChunks.erase(chunkIt);
+		}
+
+		for (size_t offset{ 4u }; offset + 4u <= len; offset += 4u)
+		{
+			DeliverInOrder(Utils::Byte::Get2Bytes(value, offset));
+		}
+	}
+
+	void NativeSctpAssociation::ProcessReconfig(const uint8_t* value, size_t len)
+	{
+		MS_TRACE();
+
+		size_t offset{ 0u };
+
+		while (offset + 8u <= len)
+		{
+			const uint16_t type     = Utils::Byte::Get2Bytes(value, offset);
+			const uint16_t paramLen = Utils::Byte::Get2Bytes(value, offset + 2);
+			const uint8_t* param    = value + offset;
+
+			if (paramLen < 8u || offset + paramLen > len)
+				break;
+
+			offset += padTo4Bytes(paramLen);
+
+			if (type == ReconfigResponseParameter)
+			{
+				const uint32_t seq    = Utils::Byte::Get4Bytes(param, 4);
+				const uint32_t result = paramLen >= 12u ? Utils::Byte::Get4Bytes(param, 8) : 0u;
+
+				if (!this->reconfigRequest || seq != this->reconfigRequest->seq)
+					continue;
+
+				// The remote will perform it later, wait for T1 to send it again.
+				if (result == ReconfigResultInProgress)
+					continue;
+
+				if (result == ReconfigResultPerformed || result == ReconfigResultNothingToDo)
+				{
+					for (auto streamId : this->reconfigRequest->streamIds)
+					{
+						this->nextSsns.erase(streamId);
+					}
+
+					this->os += this->reconfigRequest->numStreamsToAdd;
+				}
+				else
+				{
+					MS_WARN_TAG(sctp, "RE-CONFIG request failed [result:%" PRIu32 "]", result);
+				}
+
+				delete this->reconfigRequest;
+				this->reconfigRequest = nullptr;
+
+				this->t1Timer->Stop();
+
+				continue;
+			}
+
+			const uint32_t seq = Utils::Byte::Get4Bytes(param, 4);
+
+			// Retransmission of the last request.
+			// clang-format off
+			if (
+				seq == this->peerNextReconfigSeq - 1u &&
+				this->peerLastReconfigResult != ReconfigResultInProgress
+			)
+			// clang-format on
+			{
+				AddReconfigResponse(seq, this->peerLastReconfigResult);
+
+				continue;
+			}
+			else if (seq != this->peerNextReconfigSeq && seq != this->peerNextReconfigSeq - 1u)
+			{
+				AddReconfigResponse(seq, ReconfigResultBadSequenceNumber);
+
+				continue;
+			}
+
+			if (seq == this->peerNextReconfigSeq)
+				this->peerNextReconfigSeq++;
+
+			switch (type)
+			{
+				case OutgoingResetRequestParameter:
+				{
+					if (paramLen < 16u)
+						break;
+
+					const uint32_t lastTsn = Utils::Byte::Get4Bytes(param, 12);
+
+					this->deferredResetLastTsn = UnwrapIncomingTsn(lastTsn);
+					this->deferredResetStreamIds.clear();
+
+					for (size_t i{ 16u }; i + 2u <= paramLen; i += 2u)
+					{
+						this->deferredResetStreamIds.push_back(Utils::Byte::Get2Bytes(param, i));
+					}
+
+					// Some DATA of the streams to reset are still to be received, so
+					// it is performed once they are (RFC 6525 section 5.2.2).
+					this->peerLastReconfigResult = ReconfigResultInProgress;
+
+					PerformDeferredReset();
+
+					break;
+				}
+
+				case AddOutgoingStreamsParameter:
+				{
+					this->peerLastReconfigResult = ReconfigResultPerformed;
+
+					break;
+				}
+
+				// Not used by DataChannels (RFC 8831 section 6.7).
+				case IncomingResetRequestParameter:
+				case AddIncomingStreamsParameter:
+				default:
+				{
+					this->peerLastReconfigResult = ReconfigResultDenied;
+				}
+			}
+
+			AddReconfigResponse(seq, this->peerLastReconfigResult);
+		}
+	}
+
+	void NativeSctpAssociation::ProcessHeartbeat(const uint8_t* value, size_t len)
+	{
+		MS_TRACE();
+
+		if (len > Mtu - SctpPacket::CommonHeaderSize - ChunkHeaderSize)
+			return;
+
+		PrepareChunk(len);
+
+		auto* ackValue = AddChunk(ChunkType::HEARTBEAT_ACK, 0u, len);
+
+		std::memcpy(ackValue, value, len);
+	}
+
+	void NativeSctpAssociation::ProcessAbort()
+	{
+		MS_TRACE();
+
+		if (this->state == State::CLOSED)
+			return;
+
+		MS_DEBUG_TAG(sctp, "association aborted by the remote");
+
+		SetClosed(this->state != State::ESTABLISHED);
+	}
+
+	void NativeSctpAssociation::ProcessShutdown()
+	{
+		MS_TRACE();
+
+		if (this->state == State::CLOSED)
+			return;
+
+		BeginPacket(this->peerTag);
+		AddChunk(ChunkType::SHUTDOWN_ACK, 0u, 0u);
+		SendPacket();
+
+		SetClosed(false);
+	}
+
+	void NativeSctpAssociation::SetEstablished()
+	{
+		MS_TRACE();
+
+		this->state            = State::ESTABLISHED;
+		this->numT1Expirations = 0u;
+
+		this->t1Timer->Stop();
+		this->cookie.clear();
+		this->cookie.shrink_to_fit();
+
+		this->listener->OnNativeSctpAssociationConnected(this);
+	}
+
+	void NativeSctpAssociation::SetClosed(bool failed)
+	{
+		MS_TRACE();
+
+		this->state = State::CLOSED;
+
+		this->t1Timer->Stop();
+		this->t3Timer->Stop();
+
+		if (failed)
+			this->listener->OnNativeSctpAssociationFailed(this);
+		else
+			this->listener->OnNativeSctpAssociationClosed(this);
+	}
+
+	void NativeSctpAssociation::InitTransmission()
+	{
+		MS_TRACE();
+
+		this->nextTsn              = this->myInitialTsn;
+		this->firstUnsentTsn       = this->myInitialTsn;
+		this->peerCumulativeTsn    = this->myInitialTsn - 1u;
+		this->advancedPeerAckPoint = this->myInitialTsn - 1u;
+		this->forwardTsnNeeded     = false;
+		this->numToRetransmit      = 0u;
+		this->flightSize           = 0u;
+		this->cwnd                 = InitialCwnd;
+		this->partialBytesAcked    = 0u;
+		this->fastRecovery         = false;
+		this->numT3Expirations     = 0u;
+
+		this->t3Timer->Stop();
+	}
+
+	void NativeSctpAssociation::InitReception(uint32_t initialTsn)
+	{
+		MS_TRACE();
+
+		for (auto& kv : this->incomingChunks)
+		{
+			ReleaseIncomingChunk(kv.second);
+		}
+
+		this->incomingChunks.clear();
+		this->receivedTsns.clear();
+		this->expectedSsns.clear();
+		this->deferredResetStreamIds.clear();
+
+		this->peerInitialTsn      = initialTsn;
+		this->cumulativeTsn       = static_cast<uint32_t>(initialTsn - 1u);
+		this->incomingBytes       = 0u;
+		this->sackNeeded          = false;
+		this->peerNextReconfigSeq = initialTsn;
+		// So a retransmission of the request previous to the first one is
+		// answered as such.
+		this->peerLastReconfigResult = ReconfigResultPerformed;
+	}
+
+	void NativeSctpAssociation::PerformDeferredReset()
+	{
+		MS_TRACE();
+
+		if (this->deferredResetLastTsn > this->cumulativeTsn)
+			return;
+
+		this->peerLastReconfigResult = ReconfigResultPerformed;
+
+		// No stream means all of them.
+		if (this->deferredResetStreamIds.empty())
+			this->expectedSsns.clear();
+
+		for (auto streamId : this->deferredResetStreamIds)
+		{
+			this->expectedSsns.erase(streamId);
+
+			this->listener->OnNativeSctpAssociationIncomingStreamReset(this, streamId);
+		}
+
+		this->deferredResetStreamIds.clear();
+	}
+
+	void NativeSctpAssociation::ReleaseIncomingChunk(IncomingChunk& chunk)
+	{
+		MS_TRACE();
+
+		if (chunk.payloadLen <= MaxDataPayloadLen)
+			ReleaseBlock(chunk.payload);
+		else
+			delete[] chunk.payload;
+
+		chunk.payload = nullptr;
+	}
+
+	void NativeSctpAssociation::DeliverInOrder(uint16_t streamId)
+	{
+		MS_TRACE();
+
+		while (true)
+		{
+			auto& expectedSsn = this->expectedSsns[streamId];
+			uint64_t firstTsn{ 0u };
+			bool found{ false };
+
+			for (auto& kv : this->incomingChunks)
+			{
+				const auto& chunk = kv.second;
+
+				// clang-format off
+				if (
+					chunk.streamId == streamId &&
+					chunk.ssn == expectedSsn &&
+					(chunk.flags & DataFlagBeginning) &&
+					!(chunk.flags & DataFlagUnordered)
+				)
+				// clang-format on
+				{
+					firstTsn = kv.first;
+					found    = true;
+
+					break;
+				}
+			}
+
+			if (!found || !DeliverMessage(firstTsn))
+				return;
+
+			// NOTE: Take it again since the listener could have reset the stream.
+			this->expectedSsns[streamId]++;
+		}
+	}
+
+	bool NativeSctpAssociation::DeliverMessage(uint64_t firstTsn)
+	{
+		MS_TRACE();
+
+		auto firstIt = this->incomingChunks.find(firstTsn);
+		auto lastIt  = firstIt;
+		size_t len{ 0u };
+
+		// Look for the last chunk, the message must be complete.
+		while (true)
+		{
+			len += lastIt->second.payloadLen;
+
+			if (lastIt->second.flags & DataFlagEnd)
+				break;
+
+			auto nextIt = std::next(lastIt);
+
+			if (nextIt == this->incomingChunks.end() || nextIt->first != lastIt->first + 1u)
+				return false;
+
+			lastIt = nextIt;
+		}
+
+		const uint16_t streamId = firstIt->second.streamId;
+		const uint32_t ppid     = firstIt->second.ppid;
+		auto endIt              = std::next(lastIt);
+
+		if (len > this->maxMessageSize)
+		{
+			MS_WARN_TAG(sctp, "ignoring message bigger than maxMessageSize [len:%zu]", len);
+		}
+		else if (firstIt == lastIt)
+		{
+			this->listener->OnNativeSctpAssociationMessageReceived(
+			  this, streamId, ppid, firstIt->second.payload, len);
+		}
+		else
+		{
+			auto& buffer = NativeSctpAssociation::messageBuffer;
+
+			buffer.clear();
+
+			for (auto it = firstIt; it != endIt; ++it)
+			{
+				buffer.insert(buffer.end(), it->second.payload, it->second.payload + it->second.payloadLen);
+			}
+
+			this->listener->OnNativeSctpAssociationMessageReceived(
+			  this, streamId, ppid, buffer.data(), buffer.size());
+		}
+
+		for (auto it = firstIt; it != endIt; ++it)
+		{
+			this->incomingBytes -= it->second.payloadLen;
+
+			ReleaseIncomingChunk(it->second);
+		}
+
+		this->incomingChunks.erase(firstIt, endIt);
+
+		return true;
+	}
+
+	void NativeSctpAssociation::AdvanceCumulativeTsn()
+	{
+		MS_TRACE();
+
+		size_t numAdvanced{ 0u };
+
+		while (numAdvanced < this->receivedTsns.size() &&
+		       this->receivedTsns[numAdvanced] == this->cumulativeTsn + 1u)
+		{
+			this->cumulativeTsn++;
+			numAdvanced++;
+		}
+
+		if (numAdvanced != 0u)
+		{
+			this->receivedTsns.erase(
+			  this->receivedTsns.begin(), this->receivedTsns.begin() + numAdvanced);
+		}
+	}
+
+	size_t NativeSctpAssociation::GetRecvWindow() const
+	{
+		MS_TRACE();
+
+		// Big enough to reassemble the biggest message.
+		return std::max(RecvWindow, 2u * this->maxMessageSize);
+	}
+
+	void NativeSctpAssociation::UpdateRto(uint64_t rttMs)
+	{
+		MS_TRACE();
+
+		const auto rtt = static_cast<double>(rttMs);
+
+		// RFC 6298 section 2.
+		if (this->srttMs == 0)
+		{
+			this->srttMs   = rtt;
+			this->rttvarMs = rtt / 2;
+		}
+		else
+		{
+			this->rttvarMs = (0.75 * this->rttvarMs) + (0.25 * std::fabs(this->srttMs - rtt));
+			this->srttMs   = (0.875 * this->srttMs) + (0.125 * rtt);
+		}
+
+		const auto rtoMs = static_cast<uint64_t>(this->srttMs + (4 * this->rttvarMs));
+
+		this->rtoMs = std::min(std::max(rtoMs, MinRtoMs), MaxRtoMs);
+	}
+
+	void NativeSctpAssociation::MarkForRetransmit(size_t idx, uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		auto& chunk = this->outgoingChunks[idx];
+
+		this->flightSize -= chunk.payloadLen;
+		chunk.state          = ChunkState::TO_RETRANSMIT;
+		chunk.missingReports = 0u;
+		this->numToRetransmit++;
+
+		if (!this->peerSupportsForwardTsn)
+			return;
+
+		// clang-format off
+		if (
+			(chunk.limitedRetransmits && chunk.numTransmissions > chunk.maxRetransmits) ||
+			(chunk.expiresAtMs != 0u && chunk.expiresAtMs <= nowMs)
+		)
+		// clang-format on
+		{
+			AbandonMessage(idx);
+		}
+	}
+
+	void NativeSctpAssociation::AbandonMessage(size_t idx)
+	{
+		MS_TRACE();
+
+		// Look for the first chunk of the message (if not acknowledged yet).
+		while (idx > 0u && !(this->outgoingChunks[idx].flags & DataFlagBeginning))
+		{
+			idx--;
+		}
+
+		for (; idx < this->outgoingChunks.size(); ++idx)
+		{
+			auto& chunk = this->outgoingChunks[idx];
+
+			if (chunk.state == ChunkState::IN_FLIGHT)
+				this->flightSize -= chunk.payloadLen;
+			else if (chunk.state == ChunkState::TO_RETRANSMIT)
+				this->numToRetransmit--;
+
+			chunk.state = ChunkState::ABANDONED;
+
+			if (chunk.flags & DataFlagEnd)
+				break;
+		}
+	}
+
+	void NativeSctpAssociation::UpdateAdvancedPeerAckPoint()
+	{
+		MS_TRACE();
+
+		if (!this->peerSupportsForwardTsn)
+			return;
+
+		// NOTE: The first outgoing chunk always follows the peer cumulative TSN.
+		size_t idx = this->advancedPeerAckPoint - this->peerCumulativeTsn;
+
+		// clang-format off
+		while (
+			idx < this->outgoingChunks.size() &&
+			this->outgoingChunks[idx].state == ChunkState::ABANDONED
+		)
+		// clang-format on
+		{
+			this->advancedPeerAckPoint++;
+			idx++;
+		}
+
+		if (isTsnLower(this->peerCumulativeTsn, this->advancedPeerAckPoint))
+			this->forwardTsnNeeded = true;
+
+		// Abandoned chunks never sent.
+		if (isTsnLower(this->firstUnsentTsn - 1u, this->advancedPeerAckPoint))
+			this->firstUnsentTsn = this->advancedPeerAckPoint + 1u;
+	}
+
+	void NativeSctpAssociation::NotifyBufferedAmount()
+	{
+		MS_TRACE();
+
+		if (this->bufferedAmount == this->notifiedBufferedAmount)
+			return;
+
+		this->notifiedBufferedAmount = this->bufferedAmount;
+
+		this->listener->OnNativeSctpAssociationBufferedAmount(this, this->bufferedAmount);
+	}
+
+	void NativeSctpAssociation::SendInit()
+	{
+		MS_TRACE();
+
+		BeginPacket(0u);
+
+		auto* value = AddChunk(ChunkType::INIT, 0u, InitFixedSize + InitParametersSize);
+
+		writeInitValue(
+		  value,
+		  this->myTag,
+		  static_cast<uint32_t>(GetRecvWindow()),
+		  this->os,
+		  this->mis,
+		  this->myInitialTsn);
+
+		SendPacket();
+	}
+
+	void NativeSctpAssociation::SendInitAck(
+	  uint32_t initTag, uint32_t initialTsn, uint32_t rwnd, uint16_t peerMis, uint8_t features)
+	{
+		MS_TRACE();
+
+		BeginPacket(initTag);
+
+		auto* value =
+		  AddChunk(ChunkType::INIT_ACK, 0u, InitFixedSize + InitParametersSize + 4u + CookieLen);
+
+		writeInitValue(
+		  value,
+		  this->myTag,
+		  static_cast<uint32_t>(GetRecvWindow()),
+		  this->os,
+		  this->mis,
+		  this->myInitialTsn);
+
+		// State cookie. No need to sign it since SCTP runs over DTLS.
+		auto* cookie = value + InitFixedSize + InitParametersSize;
+
+		Utils::Byte::Set2Bytes(cookie, 0, StateCookieParameter);
+		Utils::Byte::Set2Bytes(cookie, 2, 4u + CookieLen);
+		Utils::Byte::Set4Bytes(cookie, 4, CookieMagic);
+		Utils::Byte::Set4Bytes(cookie, 8, this->myTag);
+		Utils::Byte::Set4Bytes(cookie, 12, initTag);
+		Utils::Byte::Set4Bytes(cookie, 16, this->myInitialTsn);
+		Utils::Byte::Set4Bytes(cookie, 20, initialTsn);
+		Utils::Byte::Set4Bytes(cookie, 24, rwnd);
+		Utils::Byte::Set2Bytes(cookie, 28, peerMis);
+		cookie[30] = features;
+		cookie[31] = 0u;
+
+		SendPacket();
+	}
+
+	void NativeSctpAssociation::SendCookieEcho()
+	{
+		MS_TRACE();
+
+		BeginPacket(this->peerTag);
+
+		auto* value = AddChunk(ChunkType::COOKIE_ECHO, 0u, this->cookie.size());
+
+		std::memcpy(value, this->cookie.data(), this->cookie.size());
+
+		SendPacket();
+	}
+
+	void NativeSctpAssociation::SendReconfigRequest()
+	{
+		MS_TRACE();
+
+		auto* request = this->reconfigRequest;
+		size_t paramLen;
+
+		if (!request->streamIds.empty())
+			paramLen = 16u + (2u * request->streamIds.size());
+		else
+			paramLen = 12u;
+
+		PrepareChunk(paramLen);
+
+		auto* param = AddChunk(ChunkType::RE_CONFIG, 0u, paramLen);
+
+		Utils::Byte::Set2Bytes(param, 2, static_cast<uint16_t>(paramLen));
+		Utils::Byte::Set4Bytes(param, 4, request->seq);
+
+		if (!request->streamIds.empty())
+		{
+			Utils::Byte::Set2Bytes(param, 0, OutgoingResetRequestParameter);
+			Utils::Byte::Set4Bytes(param, 8, this->peerNextReconfigSeq - 1u);
+			// Last TSN assigned, the streams are reset once the remote got it.
+			Utils::Byte::Set4Bytes(param, 12, this->nextTsn - 1u);
+
+			for (size_t i{ 0u }; i < request->streamIds.size(); ++i)
+			{
+				Utils::Byte::Set2Bytes(param, 16u + (2u * i), request->streamIds[i]);
+			}
+		}
+		else
+		{
+			Utils::Byte::Set2Bytes(param, 0, AddOutgoingStreamsParameter);
+			Utils::Byte::Set2Bytes(param, 8, request->numStreamsToAdd);
+			Utils::Byte::Set2Bytes(param, 10, 0u);
+		}
+
+		SendPacket();
+
+		request->numTransmissions++;
+	}
+
+	void NativeSctpAssociation::SendNextReconfigRequest()
+	{
+		MS_TRACE();
+
+		if (this->state != State::ESTABLISHED || this->reconfigRequest)
+			return;
+
+		if (!this->peerSupportsReconfig)
+		{
+			if (!this->pendingResetStreamIds.empty() || this->pendingNumStreamsToAdd != 0u)
+			{
+				MS_DEBUG_TAG(sctp, "stream reconfiguration not negotiated");
+
+				this->pendingResetStreamIds.clear();
+				this->pendingNumStreamsToAdd = 0u;
+			}
+
+			return;
+		}
+
+		if (!this->pendingResetStreamIds.empty())
+		{
+			auto& pending    = this->pendingResetStreamIds;
+			const size_t num = std::min(pending.size(), MaxStreamsPerReset);
+
+			this->reconfigRequest = new ReconfigRequest();
+
+			this->reconfigRequest->streamIds.assign(pending.begin(), pending.begin() + num);
+			pending.erase(pending.begin(), pending.begin() + num);
+		}
+		else if (this->pendingNumStreamsToAdd != 0u)
+		{
+			this->reconfigRequest = new ReconfigRequest();
+
+			this->reconfigRequest->numStreamsToAdd = this->pendingNumStreamsToAdd;
+			this->pendingNumStreamsToAdd           = 0u;
+		}
+		else
+		{
+			return;
+		}
+
+		this->reconfigRequest->seq = this->nextReconfigSeq++;
+		this->numT1Expirations     = 0u;
+
+		SendReconfigRequest();
+
+		this->t1Timer->Start(this->rtoMs);
+	}
+
+	void NativeSctpAssociation::SendAbort()
+	{
+		MS_TRACE();
+
+		BeginPacket(this->peerTag);
+		AddChunk(ChunkType::ABORT, 0u, 0u);
+		SendPacket();
+	}
+
+	void NativeSctpAssociation::BeginPacket(uint32_t verificationTag)
+	{
+		MS_TRACE();
+
+		// Send the packet being built, if any.
+		SendPacket();
+
+		auto* packet = NativeSctpAssociation::packetBuffer;
+
+		Utils::Byte::Set2Bytes(packet, 0, Port);
+		Utils::Byte::Set2Bytes(packet, 2, Port);
+		Utils::Byte::Set4Bytes(packet, 4, verificationTag);
+		Utils::Byte::Set4Bytes(packet, 8, 0u);
+
+		this->packetLen = SctpPacket::CommonHeaderSize;
+	}
+
+	void NativeSctpAssociation::PrepareChunk(size_t valueLen)
+	{
+		MS_TRACE();
+
+		if (this->packetLen == 0u || GetPacketRoom() < valueLen)
+			BeginPacket(this->peerTag);
+	}
+
+	uint8_t* NativeSctpAssociation::AddChunk(ChunkType type, uint8_t flags, size_t valueLen)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(valueLen <= GetPacketRoom(), "chunk does not fit in the packet");
+
+		auto* chunk           = NativeSctpAssociation::packetBuffer + this->packetLen;
+		const size_t chunkLen = ChunkHeaderSize + valueLen;
+		const size_t padding  = padTo4Bytes(chunkLen) - chunkLen;
+
+		chunk[0] = static_cast<uint8_t>(type);
+		chunk[1] = flags;
+		Utils::Byte::Set2Bytes(chunk, 2, static_cast<uint16_t>(chunkLen));
+
+		std::memset(chunk + chunkLen, 0, padding);
+
+		this->packetLen += chunkLen + padding;
+
+		return chunk + ChunkHeaderSize;
+	}
+
+	size_t NativeSctpAssociation::GetPacketRoom() const
+	{
+		MS_TRACE();
+
+		if (this->packetLen + ChunkHeaderSize >= Mtu)
+			return 0u;
+
+		return Mtu - this->packetLen - ChunkHeaderSize;
+	}
+
+	void NativeSctpAssociation::SendPacket()
+	{
+		MS_TRACE();
+
+		if (this->packetLen <= SctpPacket::CommonHeaderSize)
+		{
+			this->packetLen = 0u;
+
+			return;
+		}
+
+		auto* packet     = NativeSctpAssociation::packetBuffer;
+		const size_t len = this->packetLen;
+
+		SctpPacket::WriteChecksum(packet, SctpPacket::ComputeChecksum(packet, len));
+
+		this->packetLen = 0u;
+
+		this->listener->OnNativeSctpAssociationSendPacket(this, packet, len);
+	}
+
+	void NativeSctpAssociation::AddSack()
+	{
+		MS_TRACE();
+
+		// Start and end offsets (from the cumulative TSN) of every gap block.
+		uint16_t gaps[MaxGapBlocks][2];
+		size_t numGaps{ 0u };
+
+		for (size_t i{ 0u }; i < this->receivedTsns.size() && numGaps < MaxGapBlocks; ++i)
+		{
+			const uint64_t offset = this->receivedTsns[i] - this->cumulativeTsn;
+
+			// Offsets bigger than 16 bits cannot be reported.
+			if (offset > 65535u)
+				break;
+
+			if (numGaps != 0u && offset == gaps[numGaps - 1][1] + 1u)
+			{
+				gaps[numGaps - 1][1] = static_cast<uint16_t>(offset);
+			}
+			else
+			{
+				gaps[numGaps][0] = static_cast<uint16_t>(offset);
+				gaps[numGaps][1] = static_cast<uint16_t>(offset);
+				numGaps++;
+			}
+		}
+
+		const size_t valueLen   = 12u + (4u * numGaps);
+		const size_t recvWindow = GetRecvWindow();
+		const size_t rwnd = recvWindow > this->incomingBytes ? recvWindow - this->incomingBytes : 0u;
+
+		PrepareChunk(valueLen);
+
+		auto* value = AddChunk(ChunkType::SACK, 0u, valueLen);
+
+		Utils::Byte::Set4Bytes(value, 0, static_cast<uint32_t>(this->cumulativeTsn));
+		Utils::Byte::Set4Bytes(value, 4, static_cast<uint32_t>(rwnd));
+		Utils::Byte::Set2Bytes(value, 8, static_cast<uint16_t>(numGaps));
+		Utils::Byte::Set2Bytes(value, 10, 0u);
+
+		for (size_t i{ 0u }; i < numGaps; ++i)
+		{
+			Utils::Byte::Set2Bytes(value, 12u + (4u * i), gaps[i][0]);
+			Utils::Byte::Set2Bytes(value, 14u + (4u * i), gaps[i][1]);
+		}
+
+		this->sackNeeded = false;
+	}
+
+	void NativeSctpAssociation::AddForwardTsn()
+	{
+		MS_TRACE();
+
+		PrepareChunk(4u);
+
+		auto* value = AddChunk(ChunkType::FORWARD_TSN, 0u, 4u);
+
+		// Just unordered messages are abandoned, so no stream needs to be
+		// listed.
+		Utils::Byte::Set4Bytes(value, 0, this->advancedPeerAckPoint);
+
+		this->forwardTsnNeeded = false;
+	}
+
+	void NativeSctpAssociation::AddDataChunk(OutgoingChunk& chunk, uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		PrepareChunk(DataHeaderSize + chunk.payloadLen);
+
+		auto* value = AddChunk(ChunkType::DATA, chunk.flags, DataHeaderSize + chunk.payloadLen);
+
+		Utils::Byte::Set4Bytes(value, 0, chunk.tsn);
+		Utils::Byte::Set2Bytes(value, 4, chunk.streamId);
+		Utils::Byte::Set2Bytes(value, 6, chunk.ssn);
+		Utils::Byte::Set4Bytes(value, 8, chunk.ppid);
+
+		std::memcpy(value + DataHeaderSize, chunk.payload, chunk.payloadLen);
+
+		if (chunk.state == ChunkState::TO_RETRANSMIT)
+			this->numToRetransmit--;
+
+		chunk.state          = ChunkState::IN_FLIGHT;
+		chunk.sentAtMs       = nowMs;
+		chunk.missingReports = 0u;
+		chunk.numTransmissions++;
+
+		this->flightSize += chunk.payloadLen;
+	}
+
+	uint64_t NativeSctpAssociation::UnwrapIncomingTsn(uint32_t tsn) const
+	{
+		MS_TRACE();
+
+		const auto delta = static_cast<int32_t>(tsn - static_cast<uint32_t>(this->cumulativeTsn));
+
+		return static_cast<uint64_t>(static_cast<int64_t>(this->cumulativeTsn) + delta);
+	}
+
+	void NativeSctpAssociation::AddReconfigResponse(uint32_t seq, uint32_t result)
+	{
+		MS_TRACE();
+
+		PrepareChunk(12u);
+
+		auto* param = AddChunk(ChunkType::RE_CONFIG, 0u, 12u);
+
+		Utils::Byte::Set2Bytes(param, 0, ReconfigResponseParameter);
+		Utils::Byte::Set2Bytes(param, 2, 12u);
+		Utils::Byte::Set4Bytes(param, 4, seq);
+		Utils::Byte::Set4Bytes(param, 8, result);
+	}
+
+	inline void NativeSctpAssociation::OnTimer(Timer* timer)
+	{
+		MS_TRACE();
+
+		if (timer == this->t1Timer)
+		{
+			if (++this->numT1Expirations > MaxInitRetransmissions)
+			{
+				if (this->state == State::ESTABLISHED)
+				{
+					MS_WARN_TAG(sctp, "RE-CONFIG request not answered, giving up");
+
+					delete this->reconfigRequest;
+					this->reconfigRequest = nullptr;
+
+					Flush();
+				}
+				else
+				{
+					MS_WARN_TAG(sctp, "association could not be established");
+
+					SetClosed(true);
+				}
+
+				return;
+			}
+
+			switch (this->state)
+			{
+				case State::COOKIE_WAIT:
+				{
+					this->rtoMs = std::min(this->rtoMs * 2u, MaxRtoMs);
+
+					SendInit();
+
+					break;
+				}
+
+				case State::COOKIE_ECHOED:
+				{
+					this->rtoMs = std::min(this->rtoMs * 2u, MaxRtoMs);
+
+					SendCookieEcho();
+
+					break;
+				}
+
+				case State::ESTABLISHED:
+				{
+					if (!this->reconfigRequest)
+						return;
+
+					SendReconfigRequest();
+
+					break;
+				}
+
+				default:
+				{
+					return;
+				}
+			}
+
+			this->t1Timer->Start(this->rtoMs);
+		}
+		else if (timer == this->t3Timer)
+		{
+			if (this->state != State::ESTABLISHED)
+				return;
+
+			if (++this->numT3Expirations > MaxRetransmissions)
+			{
+				MS_WARN_TAG(sctp, "too many retransmissions, aborting the association");
+
+				SendAbort();
+				SetClosed(false);
+
+				return;
+			}
+
+			// RFC 4960 section 6.3.3 and 7.2.3.
+			this->ssthresh          = std::max(this->cwnd / 2u, MinSsthresh);
+			this->cwnd              = Mtu;
+			this->partialBytesAcked = 0u;
+			this->fastRecovery      = false;
+			this->rtoMs             = std::min(this->rtoMs * 2u, MaxRtoMs);
+
+			const uint64_t nowMs = DepLibUV::GetTimeMs();
+			const size_t numSent =
+			  this->outgoingChunks.empty() ? 0u : GetOutgoingIndex(this->firstUnsentTsn);
+
+			for (size_t idx{ 0u }; idx < numSent; ++idx)
+			{
+				if (this->outgoingChunks[idx].state == ChunkState::IN_FLIGHT)
+					MarkForRetransmit(idx, nowMs);
+			}
+
+			UpdateAdvancedPeerAckPoint();
+
+			if (this->advancedPeerAckPoint != this->peerCumulativeTsn)
+				this->forwardTsnNeeded = true;
+
+			Flush();
+		}
+	}
+} // namespace RTC
@@ -0,0 +1,124 @@
+#define MS_CLASS "RTC::ObjectPool"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/ObjectPool.hpp"
+#include "Logger.hpp"
+#include <new> // ::operator new()
+
+namespace RTC
+{
+	/* Static. */
+
+	static inline size_t getSizeClass(size_t size)
+	{
+		return (size - 1) / ObjectPool::BlockSizeStep;
+	}
+
+	/* Class variables. */
+
+	thread_local std::array<ObjectPool::FreeBlock*, ObjectPool::NumSizeClasses> ObjectPool::freeLists{};
+	thread_local std::array<size_t, ObjectPool::NumSizeClasses> ObjectPool::numCachedBlocks{};
+	thread_local uint64_t ObjectPool::hits{ 0u };
+	thread_local uint64_t ObjectPool::misses{ 0u };
+
+	/* Class methods. */
+
+	void ObjectPool::ClassDestroy()
+	{
+		MS_TRACE();
+
+		for (size_t sizeClass{ 0u }; sizeClass < NumSizeClasses; ++sizeClass)
+		{
+			auto* block = ObjectPool::freeLists[sizeClass];
+
+			while (block)
+			{
+				auto* next = block->next;
+
+				::operator delete(static_cast<void*>(block));
+
+				block = next;
+			}
+
+			ObjectPool::freeLists[sizeClass]       = nullptr;
+			ObjectPool::numCachedBlocks[sizeClass] = 0u;
+		}
+	}
+
+	void* ObjectPool::Allocate(size_t size)
+	{
+		// NOTE: No MS_TRACE() here since this is called for every packet.
+
+		if (size == 0u || size > BlockSizeStep * NumSizeClasses)
+			return ::operator new(size);
+
+		const size_t sizeClass = getSizeClass(size);
+		auto* block            = ObjectPool::freeLists[sizeClass];
+
+		if (block)
+		{
+			ObjectPool::freeLists[sizeClass] = block->next;
+			--ObjectPool::numCachedBlocks[sizeClass];
+			++ObjectPool::hits;
+
+			return static_cast<void*>(block);
+		}
+
+		++ObjectPool::misses;
+
+		// Allocate the whole size class block so it can be reused by any object
+		// of the same size class.
+		return ::operator new((sizeClass + 1) * BlockSizeStep);
+	}
+
+	void ObjectPool::Deallocate(void* ptr, size_t size)
+	{
+		// NOTE: No MS_TRACE() here since this is called for every packet.
+
+		if (!ptr)
+			return;
+
+		if (size == 0u || size > BlockSizeStep * NumSizeClasses)
+		{
+			::operator delete(ptr);
+
+			return;
+		}
+
+		const size_t sizeClass = getSizeClass(size);
+
+		if (ObjectPool::numCachedBlocks[sizeClass] >= MaxCachedBlocksPerSizeClass)
+		{
+			::operator delete(ptr);
+
+			return;
+		}
+
+		auto* block = static_cast<FreeBlock*>(ptr);
+
+		block->next                      = ObjectPool::freeLists[sizeClass];
+		ObjectPool::freeLists[sizeClass] = block;
+		++ObjectPool::numCachedBlocks[sizeClass];
+	}
+
+	void ObjectPool::FillJson(json& jsonObject)
+	{
+		MS_TRACE();
+
+		size_t cachedBlocks{ 0u };
+
+		for (auto numBlocks : ObjectPool::numCachedBlocks)
+		{
+			cachedBlocks += numBlocks;
+		}
+
+		// Add hits.
+		jsonObject["hits"] = ObjectPool::hits;
+
+		// Add misses.
+		jsonObject["misses"] = ObjectPool::misses;
+
+		// Add cachedBlocks.
+		jsonObject["cachedBlocks"] = cachedBlocks;
+	}
+} // namespace RTC
@@ -0,0 +1,493 @@
+#define MS_CLASS "RTC::Pacer"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/Pacer.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include "RTC/EgressScheduler.hpp"
+#include <algorithm> // std::min(), std::remove_if()
+#include <cstring>   // std::memcpy()
+
+namespace RTC
+{
+	/* Static. */
+
+	// Same as libwebrtc PacedSender::kDefaultPaceMultiplier.
+	static constexpr float PacingFactor{ 2.5f };
+	static constexpr uint64_t MinPacingBitrate{ 30000u };
+	// So SCTP packets are not stuck when the available bitrate collapses.
+	static constexpr uint64_t MinSctpBitrate{ 16000u };
+	// Max budget that can be built up while sending less than the pacing rate.
+	static constexpr uint64_t BurstWindowMs{ 40u };
+	static constexpr uint64_t DrainIntervalMs{ 5u };
+	// Queued packets are sent regardless of the budget after this time.
+	static constexpr uint64_t MaxQueueDelayMs{ 250u };
+	// Queued non reference frames are dropped once the oldest queued packet
+	// waits for this time.
+	static constexpr uint64_t DropQueueDelayMs{ 100u };
+
+	static inline bool isNonReferenceFrame(const RTC::RtpPacket* packet)
+	{
+		return !packet->IsKeyFrame() && packet->GetTemporalLayer() > 0u;
+	}
+
+	/* Instance methods. */
+
+	Pacer::Pacer(RTC::Pacer::Listener* listener, uint32_t availableBitrate, float sctpBitrateShare)
+	  : listener(listener), sctpBitrateShare(sctpBitrateShare)
+	{
+		MS_TRACE();
+
+		this->drainTimer = new Timer(this);
+
+		SetAvailableBitrate(availableBitrate);
+
+		// Start with a full budget.
+		this->budget               = static_cast<int64_t>(this->pacingBitrate * BurstWindowMs / 8000);
+		this->sctpBudget           = static_cast<int64_t>(this->sctpBitrate * BurstWindowMs / 8000);
+		this->lastBudgetUpdateAtMs = DepLibUV::GetTimeMs();
+	}
+
+	Pacer::~Pacer()
+	{
+		MS_TRACE();
+
+		delete this->drainTimer;
+		this->drainTimer = nullptr;
+
+		for (auto& queuedPacket : this->queue)
+		{
+			delete queuedPacket.packet;
+		}
+		this->queue.clear();
+	}
+
+	void Pacer::SetAvailableBitrate(uint32_t availableBitrate)
+	{
+		MS_TRACE();
+
+		UpdateBudget(DepLibUV::GetTimeMs());
+
+		this->pacingBitrate =
+		  std::max(static_cast<uint64_t>(availableBitrate * PacingFactor), MinPacingBitrate);
+
+		if (this->sctpBitrateShare > 0)
+		{
+			this->sctpBitrate =
+			  std::max(static_cast<uint64_t>(availableBitrate * this->sctpBitrateShare), MinSctpBitrate);
+		}
+	}
+
+	bool Pacer::QueuePacket(RTC::Consumer* consumer, RTC::RtpPacket* packet, bool retransmission)
+	{
+		MS_TRACE();
+
+		auto nowMs = DepLibUV::GetTimeMs();
+
+		UpdateBudget(nowMs);
+
+		// Frames are tracked just for original packets, retransmissions are just
+		// dropped (if they are of non reference frames) under congestion.
+		const bool trackFrame = !retransmission && isNonReferenceFrame(packet);
+
+		// Drop the rest of a dropped frame and the frames depending on it.
+		if (trackFrame && MustDropPacket(packet))
+		{
+			this->droppedPackets++;
+
+			return true;
+		}
+
+		// Send it right away if it does not fit into a queue buffer.
+		if (packet->GetSize() > MaxPacketSize)
+		{
+			this->budget -= static_cast<int64_t>(packet->GetSize());
+
+			RTC::EgressScheduler::Consume(packet->GetSize(), nowMs);
+
+			if (trackFrame)
+				SetFrameSent(consumer, packet);
+
+			return false;
+		}
+
+		// Also if there is budget (also in the worker egress one) and nothing
+		// queued before it.
+		// clang-format off
+		if (
+			this->queue.empty() &&
+			this->budget > 0 &&
+			RTC::EgressScheduler::TryConsume(packet->GetSize(), nowMs)
+		)
+		// clang-format on
+		{
+			this->budget -= static_cast<int64_t>(packet->GetSize());
+
+			if (trackFrame)
+				SetFrameSent(consumer, packet);
+
+			return false;
+		}
+
+		QueuedPacket queuedPacket;
+
+		queuedPacket.buffer         = GetBuffer();
+		queuedPacket.consumer       = consumer;
+		queuedPacket.packet         = packet->Clone(queuedPacket.buffer.get());
+		queuedPacket.retransmission = retransmission;
+		queuedPacket.queuedAtMs     = nowMs;
+
+		// Precise time just needed to measure the forwarding latency.
+		if (packet->GetIngressTime() != 0u)
+			queuedPacket.queuedAtNs = DepLibUV::GetHighResTimeNs();
+
+		this->queue.push_back(std::move(queuedPacket));
+
+		MayDropNonReferenceFrames(nowMs);
+
+		if (!this->drainTimer->IsActive() && !this->queue.empty())
+			this->drainTimer->Start(DrainIntervalMs, DrainIntervalMs);
+
+		return true;
+	}
+
+	bool Pacer::QueueSctpPacket(const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		if (this->sctpBitrateShare <= 0)
+			return false;
+
+		auto nowMs = DepLibUV::GetTimeMs();
+
+		UpdateBudget(nowMs);
+
+		// Send it right away if it does not fit into a queue buffer.
+		if (len > MaxPacketSize)
+		{
+			this->budget -= static_cast<int64_t>(len);
+			this->sctpBudget -= static_cast<int64_t>(len);
+
+			RTC::EgressScheduler::Consume(len, nowMs);
+
+			return false;
+		}
+
+		// Also if there is budget (also in the worker egress one) and nothing
+		// queued before it, so it does not go before queued media.
+		// clang-format off
+		if (
+			this->queue.empty() &&
+			this->sctpQueue.empty() &&
+			this->budget > 0 &&
+			this->sctpBudget > 0 &&
+			RTC::EgressScheduler::TryConsume(len, nowMs)
+		)
+		// clang-format on
+		{
+			this->budget -= static_cast<int64_t>(len);
+			this->sctpBudget -= static_cast<int64_t>(len);
+
+			return false;
+		}
+
+		QueuedSctpPacket queuedSctpPacket;
+
+		queuedSctpPacket.buffer     = GetBuffer();
+		queuedSctpPacket.len        = len;
+		queuedSctpPacket.queuedAtMs = nowMs;
+
+		std::memcpy(queuedSctpPacket.buffer.get(), data, len);
+
+		this->sctpQueue.push_back(std::move(queuedSctpPacket));
+
+		if (!this->drainTimer->IsActive())
+			this->drainTimer->Start(DrainIntervalMs, DrainIntervalMs);
+
+		return true;
+	}
+
+	void Pacer::RemoveConsumer(const RTC::Consumer* consumer)
+	{
+		MS_TRACE();
+
+		auto it = std::remove_if(
+		  this->queue.begin(),
+		  this->queue.end(),
+		  [this, consumer](QueuedPacket& queuedPacket)
+		  {
+			  if (queuedPacket.consumer != consumer)
+				  return false;
+
+			  ReleasePacket(queuedPacket);
+
+			  return true;
+		  });
+
+		this->queue.erase(it, this->queue.end());
+
+		for (auto it = this->mapSsrcStreamFrames.begin(); it != this->mapSsrcStreamFrames.end();)
+		{
+			if (it->second.consumer == consumer)
+				this->mapSsrcStreamFrames.erase(it++);
+			else
+				++it;
+		}
+
+		if (this->queue.empty() && this->sctpQueue.empty())
+			this->drainTimer->Stop();
+	}
+
+	void Pacer::Clear()
+	{
+		MS_TRACE();
+
+		for (auto& queuedPacket : this->queue)
+		{
+			ReleasePacket(queuedPacket);
+		}
+		this->queue.clear();
+
+		for (auto& queuedSctpPacket : this->sctpQueue)
+		{
+			this->buffers.push_back(std::move(queuedSctpPacket.buffer));
+		}
+		this->sctpQueue.clear();
+
+		this->drainTimer->Stop();
+	}
+
+	void Pacer::UpdateBudget(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		auto elapsedMs = std::min(nowMs - this->lastBudgetUpdateAtMs, BurstWindowMs);
+
+		if (elapsedMs == 0u)
+			return;
+
+		auto maxBudget = static_cast<int64_t>(this->pacingBitrate * BurstWindowMs / 8000);
+
+		this->budget += static_cast<int64_t>(this->pacingBitrate * elapsedMs / 8000);
+		this->budget               = std::min(this->budget, maxBudget);
+		this->lastBudgetUpdateAtMs = nowMs;
+
+		auto maxSctpBudget = static_cast<int64_t>(this->sctpBitrate * BurstWindowMs / 8000);
+
+		this->sctpBudget += static_cast<int64_t>(this->sctpBitrate * elapsedMs / 8000);
+		this->sctpBudget = std::min(this->sctpBudget, maxSctpBudget);
+	}
+
+	std::unique_ptr<uint8_t[]> Pacer::GetBuffer()
+	{
+		MS_TRACE();
+
+		if (this->buffers.empty())
+			return std::unique_ptr<uint8_t[]>(new uint8_t[MaxPacketSize]);
+
+		auto buffer = std::move(this->buffers.back());
+
+		this->buffers.pop_back();
+
+		return buffer;
+	}
+
+	void Pacer::ReleasePacket(QueuedPacket& queuedPacket)
+	{
+		MS_TRACE();
+
+		delete queuedPacket.packet;
+		queuedPacket.packet = nullptr;
+
+		this->buffers.push_back(std::move(queuedPacket.buffer));
+	}
+
+	bool Pacer::MustDropPacket(const RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		auto it = this->mapSsrcStreamFrames.find(packet->GetSsrc());
+
+		if (it == this->mapSsrcStreamFrames.end() || !it->second.dropped)
+			return false;
+
+		auto& streamFrames = it->second;
+
+		if (packet->GetTimestamp() == streamFrames.droppedTimestamp)
+			return true;
+
+		// Higher temporal layers may reference the dropped frame.
+		// NOTE: Frames of the base layer are not tracked, so they do not end this.
+		if (packet->GetTemporalLayer() > streamFrames.droppedTemporalLayer)
+			return true;
+
+		streamFrames.dropped = false;
+
+		return false;
+	}
+
+	void Pacer::MayDropNonReferenceFrames(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		if (this->queue.empty() || nowMs - this->queue.front().queuedAtMs < DropQueueDelayMs)
+			return;
+
+		const size_t previousQueueSize = this->queue.size();
+
+		auto it = std::remove_if(
+		  this->queue.begin(),
+		  this->queue.end(),
+		  [this](QueuedPacket& queuedPacket)
+		  {
+			  const auto* packet = queuedPacket.packet;
+
+			  if (!isNonReferenceFrame(packet))
+				  return false;
+
+			  if (!queuedPacket.retransmission)
+			  {
+				  auto& streamFrames = this->mapSsrcStreamFrames[packet->GetSsrc()];
+
+				  // Part of the frame was sent, so the rest must be sent too.
+				  if (streamFrames.sent && streamFrames.sentTimestamp == packet->GetTimestamp())
+					  return false;
+
+				  streamFrames.consumer = queuedPacket.consumer;
+
+				  // clang-format off
+				  if (
+					  !streamFrames.dropped ||
+					  packet->GetTemporalLayer() < streamFrames.droppedTemporalLayer
+				  )
+				  // clang-format on
+				  {
+					  streamFrames.droppedTemporalLayer = packet->GetTemporalLayer();
+				  }
+
+				  streamFrames.droppedTimestamp = packet->GetTimestamp();
+				  streamFrames.dropped          = true;
+			  }
+
+			  ReleasePacket(queuedPacket);
+
+			  return true;
+		  });
+
+		this->queue.erase(it, this->queue.end());
+
+		this->droppedPackets += previousQueueSize - this->queue.size();
+
+		MS_DEBUG_DEV(
+		  "non reference frames dropped [dropped packets:%zu, remaining packets:%zu]",
+		  previousQueueSize - this->queue.size(),
+		  this->queue.size());
+	}
+
+	void Pacer::SetFrameSent(const RTC::Consumer* consumer, const RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		auto& streamFrames = this->mapSsrcStreamFrames[packet->GetSsrc()];
+
+		streamFrames.consumer      = consumer;
+		streamFrames.sentTimestamp = packet->GetTimestamp();
+		streamFrames.sent          = true;
+	}
+
+	void Pacer::DrainSctpQueue(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		while (!this->sctpQueue.empty())
+		{
+			auto& front = this->sctpQueue.front();
+
+			if (nowMs - front.queuedAtMs >= MaxQueueDelayMs)
+			{
+				RTC::EgressScheduler::Consume(front.len, nowMs);
+			}
+			// clang-format off
+			else if (
+				this->budget <= 0 ||
+				this->sctpBudget <= 0 ||
+				!RTC::EgressScheduler::TryConsume(front.len, nowMs)
+			)
+			// clang-format on
+			{
+				break;
+			}
+
+			// Remove it from the queue before giving it to the listener.
+			auto queuedSctpPacket = std::move(front);
+
+			this->sctpQueue.pop_front();
+
+			this->budget -= static_cast<int64_t>(queuedSctpPacket.len);
+			this->sctpBudget -= static_cast<int64_t>(queuedSctpPacket.len);
+
+			this->listener->OnPacerSendSctpData(
+			  this, queuedSctpPacket.buffer.get(), queuedSctpPacket.len);
+
+			this->buffers.push_back(std::move(queuedSctpPacket.buffer));
+		}
+	}
+
+	inline void Pacer::OnTimer(Timer* timer)
+	{
+		MS_TRACE();
+
+		if (timer == this->drainTimer)
+		{
+			auto nowMs = DepLibUV::GetTimeMs();
+
+			UpdateBudget(nowMs);
+			MayDropNonReferenceFrames(nowMs);
+
+			while (!this->queue.empty())
+			{
+				auto& front = this->queue.front();
+
+				if (nowMs - front.queuedAtMs >= MaxQueueDelayMs)
+				{
+					RTC::EgressScheduler::Consume(front.packet->GetSize(), nowMs);
+				}
+				else if (
+				  this->budget <= 0 || !RTC::EgressScheduler::TryConsume(front.packet->GetSize(), nowMs))
+				{
+					break;
+				}
+
+				// Remove it from the queue before giving it to the listener.
+				auto queuedPacket = std::move(front);
+
+				this->queue.pop_front();
+
+				this->budget -= static_cast<int64_t>(queuedPacket.packet->GetSize());
+
+				if (!queuedPacket.retransmission && isNonReferenceFrame(queuedPacket.packet))
+					SetFrameSent(queuedPacket.consumer, queuedPacket.packet);
+
+				this->listener->OnPacerSendRtpPacket(
+				  this,
+				  queuedPacket.consumer,
+				  queuedPacket.packet,
+				  queuedPacket.retransmission,
+				  queuedPacket.queuedAtNs);
+
+				ReleasePacket(queuedPacket);
+			}
+
+			// SCTP packets go after the media ones, within their share.
+			DrainSctpQueue(nowMs);
+
+			MS_DEBUG_DEV(
+			  "queue drained [remaining packets:%zu, remaining SCTP packets:%zu]",
+			  this->queue.size(),
+			  this->sctpQueue.size());
+
+			if (this->queue.empty() && this->sctpQueue.empty())
+				this->drainTimer->Stop();
+		}
+	}
+} // namespace RTC
@@ -0,0 +1,248 @@
+#define MS_CLASS "RTC::PacketCapture"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/PacketCapture.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "Utils.hpp"
+#include <algorithm> // std::min()
+#include <cerrno>
+#include <chrono>
+#include <cstdio>  // std::fopen(), std::fwrite(), std::fclose()
+#include <cstring> // std::memcpy(), std::strerror()
+
+namespace RTC
+{
+	/* Static. */
+
+	// pcap file header and packet record header. Their fields go in host byte
+	// order (readers tell it from the magic number).
+	static constexpr uint32_t PcapMagic{ 0xa1b2c3d4 };
+	static constexpr uint16_t PcapVersionMajor{ 2u };
+	static constexpr uint16_t PcapVersionMinor{ 4u };
+	static constexpr size_t PcapFileHeaderSize{ 24u };
+	static constexpr size_t PcapRecordHeaderSize{ 16u };
+	// Raw IP packets, no link layer.
+	static constexpr uint32_t PcapLinkTypeRaw{ 101u };
+	static constexpr size_t IpHeaderSize{ 20u };
+	static constexpr size_t UdpHeaderSize{ 8u };
+	static constexpr uint32_t LocalIp{ 0x0a000001 };  // 10.0.0.1
+	static constexpr uint32_t RemoteIp{ 0x0a000002 }; // 10.0.0.2
+	static constexpr uint16_t RtpPort{ 5004u };
+	static constexpr uint16_t RtcpPort{ 5005u };
+
+	static void setHostBytes(uint8_t* data, size_t i, uint32_t value)
+	{
+		std::memcpy(data + i, &value, sizeof(value));
+	}
+
+	static uint16_t getIpHeaderChecksum(const uint8_t* header)
+	{
+		uint32_t sum{ 0u };
+
+		for (size_t i{ 0u }; i < IpHeaderSize; i += 2u)
+		{
+			sum += Utils::Byte::Get2Bytes(header, i);
+		}
+
+		while (sum >> 16)
+		{
+			sum = (sum & 0xFFFF) + (sum >> 16);
+		}
+
+		return static_cast<uint16_t>(~sum);
+	}
+
+	/* Class methods. */
+
+	PacketCapture* PacketCapture::Create(const json& data)
+	{
+		MS_TRACE();
+
+		size_t maxPackets{ DefaultMaxPackets };
+		bool headersOnly{ false };
+
+		auto jsonMaxPacketsIt  = data.find("maxPackets");
+		auto jsonHeadersOnlyIt = data.find("headersOnly");
+
+		if (jsonMaxPacketsIt != data.end())
+		{
+			// clang-format off
+			if (
+				!jsonMaxPacketsIt->is_number_unsigned() ||
+				jsonMaxPacketsIt->get<size_t>() == 0u ||
+				jsonMaxPacketsIt->get<size_t>() > MaxMaxPackets
+			)
+			// clang-format on
+			{
+				MS_THROW_TYPE_ERROR("wrong maxPackets (not a number between 1 and %zu)", MaxMaxPackets);
+			}
+
+			maxPackets = jsonMaxPacketsIt->get<size_t>();
+		}
+
+		if (jsonHeadersOnlyIt != data.end())
+		{
+			if (!jsonHeadersOnlyIt->is_boolean())
+				MS_THROW_TYPE_ERROR("wrong headersOnly (not a boolean)");
+
+			headersOnly = jsonHeadersOnlyIt->get<bool>();
+		}
+
+		return new PacketCapture(maxPackets, headersOnly);
+	}
+
+	/* Instance methods. */
+
+	PacketCapture::PacketCapture(size_t maxPackets, bool headersOnly)
+	  : headersOnly(headersOnly), slots(maxPackets),
+	    slotSize(headersOnly ? HeadersSnapLen : RTC::MtuSize)
+	{
+		MS_TRACE();
+
+		// Allocate the whole ring now so capturing never allocates.
+		this->buffer.resize(maxPackets * this->slotSize);
+
+		auto sinceEpochNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		                      std::chrono::system_clock::now().time_since_epoch())
+		                      .count();
+
+		this->epochOffsetNs =
+		  static_cast<int64_t>(sinceEpochNs) - static_cast<int64_t>(DepLibUV::GetHighResTimeNs());
+	}
+
+	void PacketCapture::SerializePcap(std::vector<uint8_t>& pcap) const
+	{
+		MS_TRACE();
+
+		size_t size{ PcapFileHeaderSize };
+		// Oldest slot.
+		const size_t firstSlotIdx = this->packetCount < this->slots.size() ? 0u : this->nextSlotIdx;
+
+		for (size_t i{ 0u }; i < this->packetCount; ++i)
+		{
+			const auto& slot = this->slots[(firstSlotIdx + i) % this->slots.size()];
+
+			size += PcapRecordHeaderSize + IpHeaderSize + UdpHeaderSize + slot.capturedLen;
+		}
+
+		pcap.assign(size, 0u);
+
+		uint8_t* data = pcap.data();
+
+		setHostBytes(data, 0, PcapMagic);
+		std::memcpy(data + 4, &PcapVersionMajor, 2);
+		std::memcpy(data + 6, &PcapVersionMinor, 2);
+		// thiszone and sigfigs are zero.
+		setHostBytes(data, 16, static_cast<uint32_t>(IpHeaderSize + UdpHeaderSize + RTC::MtuSize));
+		setHostBytes(data, 20, PcapLinkTypeRaw);
+
+		data += PcapFileHeaderSize;
+
+		for (size_t i{ 0u }; i < this->packetCount; ++i)
+		{
+			const size_t slotIdx = (firstSlotIdx + i) % this->slots.size();
+			const auto& slot     = this->slots[slotIdx];
+			const uint64_t timeUs =
+			  static_cast<uint64_t>(static_cast<int64_t>(slot.timeNs) + this->epochOffsetNs) / 1000u;
+			const size_t ipLen         = IpHeaderSize + UdpHeaderSize + slot.len;
+			const size_t ipCapturedLen = IpHeaderSize + UdpHeaderSize + slot.capturedLen;
+			const uint16_t port        = slot.isRtcp ? RtcpPort : RtpPort;
+
+			setHostBytes(data, 0, static_cast<uint32_t>(timeUs / 1000000u));
+			setHostBytes(data, 4, static_cast<uint32_t>(timeUs % 1000000u));
+			setHostBytes(data, 8, static_cast<uint32_t>(ipCapturedLen));
+			setHostBytes(data, 12, static_cast<uint32_t>(ipLen));
+
+			data += PcapRecordHeaderSize;
+
+			// IPv4 header (version 4, 5 words long, don't fragment, TTL 64, UDP).
+			data[0] = 0x45;
+			Utils::Byte::Set2Bytes(data, 2, static_cast<uint16_t>(ipLen));
+			Utils::Byte::Set2Bytes(data, 6, 0x4000);
+			data[8] = 64u;
+			data[9] = 17u;
+
+			if (slot.direction == Direction::IN)
+			{
+				Utils::Byte::Set4Bytes(data, 12, RemoteIp);
+				Utils::Byte::Set4Bytes(data, 16, LocalIp);
+			}
+			else
+			{
+				Utils::Byte::Set4Bytes(data, 12, LocalIp);
+				Utils::Byte::Set4Bytes(data, 16, RemoteIp);
+			}
+
+			Utils::Byte::Set2Bytes(data, 10, getIpHeaderChecksum(data));
+
+			data += IpHeaderSize;
+
+			// UDP header (no checksum).
+			Utils::Byte::Set2Bytes(data, 0, port);
+			Utils::Byte::Set2Bytes(data, 2, port);
+			Utils::Byte::Set2Bytes(data, 4, static_cast<uint16_t>(UdpHeaderSize + slot.len));
+
+			data += UdpHeaderSize;
+
+			std::memcpy(data, this->buffer.data() + (slotIdx * this->slotSize), slot.capturedLen);
+
+			data += slot.capturedLen;
+		}
+	}
+
+	void PacketCapture::WritePcap(const std::string& path) const
+	{
+		MS_TRACE();
+
+		std::vector<uint8_t> pcap;
+
+		SerializePcap(pcap);
+
+		std::FILE* file = std::fopen(path.c_str(), "wb");
+
+		if (!file)
+			MS_THROW_ERROR("fopen() failed for '%s': %s", path.c_str(), std::strerror(errno));
+
+		const size_t written = std::fwrite(pcap.data(), 1, pcap.size(), file);
+
+		// NOTE: Check fclose() too since it flushes the file.
+		if (std::fclose(file) != 0 || written != pcap.size())
+			MS_THROW_ERROR("failed to write '%s': %s", path.c_str(), std::strerror(errno));
+	}
+
+	void PacketCapture::FillJson(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		jsonObject["maxPackets"]      = this->slots.size();
+		jsonObject["headersOnly"]     = this->headersOnly;
+		jsonObject["packetCount"]     = this->packetCount;
+		jsonObject["capturedPackets"] = this->capturedPackets;
+	}
+
+	void PacketCapture::Capture(
+	  Direction direction, const uint8_t* data, size_t len, size_t snapLen, bool isRtcp)
+	{
+		MS_TRACE();
+
+		auto& slot = this->slots[this->nextSlotIdx];
+
+		slot.timeNs      = DepLibUV::GetHighResTimeNs();
+		slot.len         = static_cast<uint16_t>(len);
+		slot.capturedLen = static_cast<uint16_t>(std::min(snapLen, this->slotSize));
+		slot.direction   = direction;
+		slot.isRtcp      = isRtcp;
+
+		std::memcpy(this->buffer.data() + (this->nextSlotIdx * this->slotSize), data, slot.capturedLen);
+
+		if (++this->nextSlotIdx == this->slots.size())
+			this->nextSlotIdx = 0u;
+
+		if (this->packetCount < this->slots.size())
+			this->packetCount++;
+
+		this->capturedPackets++;
+	}
+} // namespace RTC
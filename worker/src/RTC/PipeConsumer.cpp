@@ -18,7 +18,7 @@ namespace RTC
 		MS_TRACE();
 
 		// Ensure there are as many encodings as consumable encodings.
-		if (this->rtpParameters.encodings.size() != this->consumableRtpEncodings.size())
+		if (this->rtpParameters.encodings.size() != this->consumableRtpEncodings->size())
 			MS_THROW_TYPE_ERROR("number of rtpParameters.encodings and consumableRtpEncodings do not match");
 
 		auto& encoding   = this->rtpParameters.encodings[0];
@@ -28,6 +28,12 @@ namespace RTC
 
 		// Create RtpStreamSend instances.
 		CreateRtpStreams();
+
+		// Each stream of a simulcast Producer is a spatial layer.
+		this->layerDemand.spatial = this->rtpStreams.size() > 1u
+		                              ? static_cast<int16_t>(this->rtpStreams.size() - 1)
+		                              : static_cast<int16_t>(encoding.spatialLayers - 1);
+		this->layerDemand.temporal = static_cast<int16_t>(encoding.temporalLayers - 1);
 	}
 
 	PipeConsumer::~PipeConsumer()
@@ -91,6 +97,25 @@ namespace RTC
 		jsonObject["producerScores"] = *this->producerRtpStreamScores;
 	}
 
+	void PipeConsumer::FillJsonSendState(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		jsonObject["type"] = RTC::RtpParameters::GetTypeString(this->type);
+
+		// Add rtpSeqs (indexed by SSRC). Not importable, just informative.
+		jsonObject["rtpSeqs"] = json::object();
+		auto jsonRtpSeqsIt    = jsonObject.find("rtpSeqs");
+
+		for (const auto& kv : this->mapRtpStreamRtpSeqManager)
+		{
+			const auto* rtpStream     = kv.first;
+			const auto& rtpSeqManager = kv.second;
+
+			(*jsonRtpSeqsIt)[std::to_string(rtpStream->GetSsrc())] = rtpSeqManager.GetMaxOutput();
+		}
+	}
+
 	void PipeConsumer::HandleRequest(Channel::ChannelRequest* request)
 	{
 		MS_TRACE();
@@ -107,6 +132,11 @@ namespace RTC
 				break;
 			}
 
+			case Channel::ChannelRequest::MethodId::CONSUMER_EXPORT_SEND_STATE:
+			{
+				MS_THROW_ERROR("cannot export send state of a PipeConsumer");
+			}
+
 			case Channel::ChannelRequest::MethodId::CONSUMER_SET_PREFERRED_LAYERS:
 			{
 				// Do nothing.
@@ -116,6 +146,41 @@ namespace RTC
 				break;
 			}
 
+			case Channel::ChannelRequest::MethodId::CONSUMER_SET_LAYER_DEMAND:
+			{
+				RTC::Consumer::Layers layers;
+				auto jsonSpatialLayerIt  = request->data.find("spatialLayer");
+				auto jsonTemporalLayerIt = request->data.find("temporalLayer");
+
+				// No spatialLayer means that no layer is wanted.
+				// clang-format off
+				if (
+					jsonSpatialLayerIt != request->data.end() &&
+					Utils::Json::IsPositiveInteger(*jsonSpatialLayerIt)
+				)
+				// clang-format on
+				{
+					layers.spatial  = jsonSpatialLayerIt->get<int16_t>();
+					layers.temporal = 0;
+
+					// clang-format off
+					if (
+						jsonTemporalLayerIt != request->data.end() &&
+						Utils::Json::IsPositiveInteger(*jsonTemporalLayerIt)
+					)
+					// clang-format on
+					{
+						layers.temporal = jsonTemporalLayerIt->get<int16_t>();
+					}
+				}
+
+				SetLayerDemand(layers);
+
+				request->Accept();
+
+				break;
+			}
+
 			default:
 			{
 				// Pass it to the parent class.
@@ -195,7 +260,7 @@ namespace RTC
 
 		// NOTE: This may happen if this Consumer supports just some codecs of those
 		// in the corresponding Producer.
-		if (this->supportedCodecPayloadTypes.find(payloadType) == this->supportedCodecPayloadTypes.end())
+		if (!this->supportedCodecPayloadTypes.test(payloadType))
 		{
 			MS_DEBUG_DEV("payload type not supported [payloadType:%" PRIu8 "]", payloadType);
 
@@ -207,6 +272,10 @@ namespace RTC
 		auto& syncRequired  = this->mapRtpStreamSyncRequired.at(rtpStream);
 		auto& rtpSeqManager = this->mapRtpStreamRtpSeqManager.at(rtpStream);
 
+		// Nobody consumes it in the remote Router.
+		if (!this->mapRtpStreamDemanded.at(rtpStream))
+			return;
+
 		// If we need to sync, support key frames and this is not a key frame, ignore
 		// the packet.
 		if (syncRequired && this->keyFrameSupported && !packet->IsKeyFrame())
@@ -308,9 +377,10 @@ namespace RTC
 		packet->AddSenderReport(report);
 
 		// Build SDES chunk for this sender.
-		auto* sdesChunk = rtpStream->GetRtcpSdesChunk();
+		auto* sdesChunk = rtpStream->GetRtcpSdesChunk(nowMs);
 
-		packet->AddSdesChunk(sdesChunk);
+		if (sdesChunk)
+			packet->AddSdesChunk(sdesChunk);
 
 		auto* dlrr = rtpStream->GetRtcpXrDelaySinceLastRr(nowMs);
 
@@ -453,7 +523,8 @@ namespace RTC
 		{
 			for (auto* rtpStream : this->rtpStreams)
 			{
-				rtpStream->Resume();
+				if (this->mapRtpStreamDemanded.at(rtpStream))
+					rtpStream->Resume();
 			}
 
 			RequestKeyFrame();
@@ -493,7 +564,8 @@ namespace RTC
 		{
 			for (auto* rtpStream : this->rtpStreams)
 			{
-				rtpStream->Resume();
+				if (this->mapRtpStreamDemanded.at(rtpStream))
+					rtpStream->Resume();
 			}
 
 			RequestKeyFrame();
@@ -510,7 +582,7 @@ namespace RTC
 		{
 			auto& encoding           = this->rtpParameters.encodings[idx];
 			const auto* mediaCodec   = this->rtpParameters.GetCodecForEncoding(encoding);
-			auto& consumableEncoding = this->consumableRtpEncodings[idx];
+			auto& consumableEncoding = (*this->consumableRtpEncodings)[idx];
 
 			MS_DEBUG_TAG(
 			  rtp, "[ssrc:%" PRIu32 ", payloadType:%" PRIu8 "]", encoding.ssrc, mediaCodec->payloadType);
@@ -518,14 +590,15 @@ namespace RTC
 			// Set stream params.
 			RTC::RtpStream::Params params;
 
-			params.encodingIdx    = idx;
-			params.ssrc           = encoding.ssrc;
-			params.payloadType    = mediaCodec->payloadType;
-			params.mimeType       = mediaCodec->mimeType;
-			params.clockRate      = mediaCodec->clockRate;
-			params.cname          = this->rtpParameters.rtcp.cname;
-			params.spatialLayers  = encoding.spatialLayers;
-			params.temporalLayers = encoding.temporalLayers;
+			params.encodingIdx     = idx;
+			params.ssrc            = encoding.ssrc;
+			params.payloadType     = mediaCodec->payloadType;
+			params.mimeType        = mediaCodec->mimeType;
+			params.clockRate       = mediaCodec->clockRate;
+			params.cname           = this->rtpParameters.rtcp.cname;
+			params.rtcpReducedSize = this->rtpParameters.rtcp.reducedSize;
+			params.spatialLayers   = encoding.spatialLayers;
+			params.temporalLayers  = encoding.temporalLayers;
 
 			// Check in band FEC in codec parameters.
 			if (mediaCodec->parameters.HasInteger("useinbandfec") && mediaCodec->parameters.GetInteger("useinbandfec") == 1)
@@ -581,6 +654,9 @@ namespace RTC
 			if (IsPaused() || IsProducerPaused())
 				rtpStream->Pause();
 
+			// Every stream is demanded until told otherwise.
+			this->mapRtpStreamDemanded[rtpStream] = true;
+
 			const auto* rtxCodec = this->rtpParameters.GetRtxCodecForEncoding(encoding);
 
 			if (rtxCodec && encoding.hasRtx)
@@ -601,14 +677,84 @@ namespace RTC
 		if (this->kind != RTC::Media::Kind::VIDEO)
 			return;
 
-		for (auto& consumableRtpEncoding : this->consumableRtpEncodings)
+		for (size_t idx{ 0u }; idx < this->rtpStreams.size(); ++idx)
 		{
-			auto mappedSsrc = consumableRtpEncoding.ssrc;
+			if (!this->mapRtpStreamDemanded.at(this->rtpStreams[idx]))
+				continue;
+
+			auto mappedSsrc = (*this->consumableRtpEncodings)[idx].ssrc;
 
 			this->listener->OnConsumerKeyFrameRequested(this, mappedSsrc);
 		}
 	}
 
+	void PipeConsumer::SetLayerDemand(const RTC::Consumer::Layers& layers)
+	{
+		MS_TRACE();
+
+		// clang-format off
+		if (
+			layers.spatial == this->layerDemand.spatial &&
+			layers.temporal == this->layerDemand.temporal
+		)
+		// clang-format on
+		{
+			return;
+		}
+
+		this->layerDemand = layers;
+
+		// Let the Router propagate it to the sender of the Producer (which may be
+		// another PipeConsumer).
+		this->listener->OnConsumerPreferredLayersChanged(this);
+
+		for (size_t idx{ 0u }; idx < this->rtpStreams.size(); ++idx)
+		{
+			auto* rtpStream = this->rtpStreams[idx];
+			// Each stream of a simulcast Producer is a spatial layer. Otherwise the
+			// single stream has them all.
+			// clang-format off
+			const bool demanded = (
+				layers.spatial != -1 &&
+				(this->rtpStreams.size() == 1u || idx <= static_cast<size_t>(layers.spatial))
+			);
+			// clang-format on
+			auto& wasDemanded = this->mapRtpStreamDemanded.at(rtpStream);
+
+			if (demanded == wasDemanded)
+				continue;
+
+			wasDemanded = demanded;
+
+			MS_DEBUG_TAG(
+			  rtp,
+			  "stream %s by remote demand [ssrc:%" PRIu32 ", consumerId:%s]",
+			  demanded ? "resumed" : "paused",
+			  rtpStream->GetSsrc(),
+			  this->id.c_str());
+
+			if (!demanded)
+			{
+				rtpStream->Pause();
+
+				continue;
+			}
+
+			this->mapRtpStreamSyncRequired.at(rtpStream) = true;
+
+			if (IsActive())
+			{
+				rtpStream->Resume();
+
+				if (this->kind == RTC::Media::Kind::VIDEO)
+				{
+					this->listener->OnConsumerKeyFrameRequested(
+					  this, (*this->consumableRtpEncodings)[idx].ssrc);
+				}
+			}
+		}
+	}
+
 	inline void PipeConsumer::OnRtpStreamScore(
 	  RTC::RtpStream* /*rtpStream*/, uint8_t /*score*/, uint8_t /*previousScore*/)
 	{
@@ -617,14 +763,25 @@ namespace RTC
 		// Do nothing.
 	}
 
-	inline void PipeConsumer::OnRtpStreamRetransmitRtpPacket(
-	  RTC::RtpStreamSend* rtpStream, RTC::RtpPacket* packet)
+	inline void PipeConsumer::OnRtpStreamRetransmitRtpPackets(
+	  RTC::RtpStreamSend* rtpStream, RTC::RtpPacket** packets, size_t count)
 	{
 		MS_TRACE();
 
-		this->listener->OnConsumerRetransmitRtpPacket(this, packet);
+		this->listener->OnConsumerRetransmitRtpPackets(this, packets, count);
 
 		// May emit 'trace' event.
-		EmitTraceEventRtpAndKeyFrameTypes(packet, rtpStream->HasRtx());
+		for (size_t idx{ 0u }; idx < count; ++idx)
+		{
+			EmitTraceEventRtpAndKeyFrameTypes(packets[idx], rtpStream->HasRtx());
+		}
+	}
+
+	inline void PipeConsumer::OnRtpStreamSendFecPacket(
+	  RTC::RtpStreamSend* /*rtpStream*/, RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		this->listener->OnConsumerSendRtpPacket(this, packet);
 	}
 } // namespace RTC
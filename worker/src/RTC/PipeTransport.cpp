@@ -2,6 +2,7 @@
 // #define MS_LOG_DEV_LEVEL 3
 
 #include "RTC/PipeTransport.hpp"
+#include "DepLibUV.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
 #include "Utils.hpp"
@@ -17,6 +18,38 @@ namespace RTC
 	};
 	std::string PipeTransport::srtpCryptoSuiteString{ "AES_CM_128_HMAC_SHA1_80" };
 	size_t PipeTransport::srtpMasterLength{ 30 };
+	thread_local absl::flat_hash_map<std::string, PipeTransport*> PipeTransport::inMemoryPipeTransports;
+
+	// Max size of RTP and RTCP packets passed to a local peer.
+	static constexpr size_t LocalPeerBufferSize{ RTC::MtuSize + 100 };
+	// Read buffer of the outgoing TCP connection (same as in RTC::TcpServer).
+	static constexpr size_t TcpBufferSize{ 65536u };
+	// Kernel send and receive buffers of the TCP connection. Large enough to
+	// keep a long fat inter-DC link busy.
+	static constexpr int TcpSocketBufferSize{ 4 * 1024 * 1024 };
+	static constexpr uint64_t TcpReconnectDelayMs{ 1000u };
+	// Empty RTCP Receiver Report sent by the TCP client once connected so the
+	// TCP server adopts the connection without waiting for media.
+	static constexpr uint8_t TcpHello[]{ 0x80, 201, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00 };
+	// Trailer of RTP packets in trusted network mode: stream index (2 bytes)
+	// and CRC32c checksum (4 bytes). RTCP just carries the checksum.
+	static constexpr size_t TrustedChecksumSize{ 4u };
+	static constexpr size_t TrustedRtpTrailerSize{ 2u + TrustedChecksumSize };
+	// Stream index meaning that the receiver must look up the SSRC.
+	static constexpr uint16_t TrustedNoStreamIndex{ 0xFFFF };
+
+	inline static void onTrunkPrepare(uv_prepare_t* handle)
+	{
+		auto* pipeTransport = static_cast<PipeTransport*>(handle->data);
+
+		if (pipeTransport)
+			pipeTransport->OnUvTrunkPrepare();
+	}
+
+	inline static void onCloseTrunkPrepare(uv_handle_t* handle)
+	{
+		delete reinterpret_cast<uv_prepare_t*>(handle);
+	}
 
 	/* Instance methods. */
 
@@ -85,13 +118,97 @@ namespace RTC
 			this->srtpKeyBase64 = Utils::String::Base64Encode(this->srtpKey);
 		}
 
+		bool enableTrunk{ false };
+		size_t trunkMaxFrameSize{ RTC::PipeTrunk::DefaultMaxFrameSize };
+		auto jsonEnableTrunkIt = data.find("enableTrunk");
+
+		if (jsonEnableTrunkIt != data.end() && jsonEnableTrunkIt->is_boolean())
+			enableTrunk = jsonEnableTrunkIt->get<bool>();
+
+		auto jsonTrunkMaxFrameSizeIt = data.find("trunkMaxFrameSize");
+
+		if (jsonTrunkMaxFrameSizeIt != data.end())
+		{
+			// clang-format off
+			if (
+				!Utils::Json::IsPositiveInteger(*jsonTrunkMaxFrameSizeIt) ||
+				jsonTrunkMaxFrameSizeIt->get<size_t>() < RTC::PipeTrunk::MinMaxFrameSize ||
+				jsonTrunkMaxFrameSizeIt->get<size_t>() > RTC::PipeTrunk::MaxMaxFrameSize
+			)
+			// clang-format on
+			{
+				MS_THROW_TYPE_ERROR(
+				  "wrong trunkMaxFrameSize (must be between %zu and %zu)",
+				  RTC::PipeTrunk::MinMaxFrameSize,
+				  RTC::PipeTrunk::MaxMaxFrameSize);
+			}
+
+			trunkMaxFrameSize = jsonTrunkMaxFrameSizeIt->get<size_t>();
+		}
+
+		auto jsonTrustedNetworkIt = data.find("trustedNetwork");
+
+		if (jsonTrustedNetworkIt != data.end() && jsonTrustedNetworkIt->is_boolean())
+			this->trustedNetwork = jsonTrustedNetworkIt->get<bool>();
+
+		if (this->trustedNetwork && HasSrtp())
+			MS_THROW_TYPE_ERROR("trustedNetwork cannot be used along with enableSrtp");
+		else if (this->trustedNetwork && enableTrunk)
+			MS_THROW_TYPE_ERROR("trustedNetwork cannot be used along with enableTrunk");
+
+		auto jsonEnableTcpIt = data.find("enableTcp");
+
+		if (jsonEnableTcpIt != data.end() && jsonEnableTcpIt->is_boolean())
+			this->tcp = jsonEnableTcpIt->get<bool>();
+
+		// TCP already coalesces packets into segments.
+		if (this->tcp && enableTrunk)
+			MS_THROW_TYPE_ERROR("enableTrunk cannot be used along with enableTcp");
+
+		auto jsonInMemoryIt = data.find("inMemory");
+
+		// clang-format off
+		if (
+			jsonInMemoryIt != data.end() &&
+			jsonInMemoryIt->is_boolean() &&
+			jsonInMemoryIt->get<bool>()
+		)
+		// clang-format on
+		{
+			// Packets exchanged through memory do not cost syscalls.
+			if (enableTrunk)
+				MS_THROW_TYPE_ERROR("enableTrunk cannot be used along with inMemory");
+			else if (this->tcp)
+				MS_THROW_TYPE_ERROR("enableTcp cannot be used along with inMemory");
+			else if (this->trustedNetwork)
+				MS_THROW_TYPE_ERROR("trustedNetwork cannot be used along with inMemory");
+
+			// The remote PipeTransport must live in a worker running in another
+			// thread of this same process.
+			this->memoryPipe = new RTC::MemoryPipe(this);
+
+			PipeTransport::inMemoryPipeTransports[this->memoryPipe->GetId()] = this;
+
+			return;
+		}
+
 		try
 		{
 			// This may throw.
-			if (port != 0)
-				this->udpSocket = new RTC::UdpSocket(this, this->listenIp.ip, port);
+			if (this->tcp)
+			{
+				if (port != 0)
+					this->tcpServer = new RTC::TcpServer(this, this, this->listenIp.ip, port);
+				else
+					this->tcpServer = new RTC::TcpServer(this, this, this->listenIp.ip);
+			}
 			else
-				this->udpSocket = new RTC::UdpSocket(this, this->listenIp.ip);
+			{
+				if (port != 0)
+					this->udpSocket = new RTC::UdpSocket(this, this->listenIp.ip, port);
+				else
+					this->udpSocket = new RTC::UdpSocket(this, this->listenIp.ip);
+			}
 		}
 		catch (const MediaSoupError& error)
 		{
@@ -100,17 +217,78 @@ namespace RTC
 			delete this->udpSocket;
 			this->udpSocket = nullptr;
 
+			delete this->tcpServer;
+			this->tcpServer = nullptr;
+
 			throw;
 		}
+
+		if (enableTrunk)
+		{
+			this->trunk = new RTC::PipeTrunk(this, trunkMaxFrameSize);
+
+			this->trunkPrepareHandle       = new uv_prepare_t;
+			this->trunkPrepareHandle->data = static_cast<void*>(this);
+
+			const int err = uv_prepare_init(DepLibUV::GetLoop(), this->trunkPrepareHandle);
+
+			// If it fails, every packet is sent in its own frame.
+			if (err != 0)
+			{
+				delete this->trunkPrepareHandle;
+				this->trunkPrepareHandle = nullptr;
+
+				MS_WARN_DEV("uv_prepare_init() failed: %s", uv_strerror(err));
+			}
+		}
 	}
 
 	PipeTransport::~PipeTransport()
 	{
 		MS_TRACE();
 
+		if (this->trunkPrepareHandle)
+		{
+			this->trunkPrepareHandle->data = nullptr;
+
+			uv_close(
+			  reinterpret_cast<uv_handle_t*>(this->trunkPrepareHandle),
+			  static_cast<uv_close_cb>(onCloseTrunkPrepare));
+		}
+
+		// Pending packets in the trunk are discarded.
+		delete this->trunk;
+		this->trunk = nullptr;
+
 		delete this->udpSocket;
 		this->udpSocket = nullptr;
 
+		delete this->tcpReconnectTimer;
+		this->tcpReconnectTimer = nullptr;
+
+		delete this->tcpClientConnection;
+		this->tcpClientConnection = nullptr;
+
+		delete this->tcpServer;
+		this->tcpServer = nullptr;
+
+		if (this->memoryPipe)
+		{
+			PipeTransport::inMemoryPipeTransports.erase(this->memoryPipe->GetId());
+
+			// Unset us as local peer of the paired PipeTransport.
+			for (auto& kv : PipeTransport::inMemoryPipeTransports)
+			{
+				auto* pipeTransport = kv.second;
+
+				if (pipeTransport->localPeer == this)
+					pipeTransport->localPeer = nullptr;
+			}
+		}
+
+		delete this->memoryPipe;
+		this->memoryPipe = nullptr;
+
 		delete this->tuple;
 		this->tuple = nullptr;
 
@@ -135,21 +313,22 @@ namespace RTC
 		}
 		else
 		{
-			jsonObject["tuple"] = json::object();
-			auto jsonTupleIt    = jsonObject.find("tuple");
-
-			if (this->listenIp.announcedIp.empty())
-				(*jsonTupleIt)["localIp"] = this->udpSocket->GetLocalIp();
-			else
-				(*jsonTupleIt)["localIp"] = this->listenIp.announcedIp;
-
-			(*jsonTupleIt)["localPort"] = this->udpSocket->GetLocalPort();
-			(*jsonTupleIt)["protocol"]  = "udp";
+			FillJsonLocalTuple(jsonObject["tuple"]);
 		}
 
+		// Add memoryPipeId.
+		if (this->memoryPipe)
+			jsonObject["memoryPipeId"] = this->memoryPipe->GetId();
+
 		// Add rtx.
 		jsonObject["rtx"] = this->rtx;
 
+		// Add trunk.
+		jsonObject["trunk"] = this->trunk != nullptr;
+
+		// Add trustedNetwork.
+		jsonObject["trustedNetwork"] = this->trustedNetwork;
+
 		// Add srtpParameters.
 		if (HasSrtp())
 		{
@@ -180,17 +359,34 @@ namespace RTC
 		else
 		{
 			// Add tuple.
-			jsonObject["tuple"] = json::object();
-			auto jsonTupleIt    = jsonObject.find("tuple");
+			FillJsonLocalTuple(jsonObject["tuple"]);
+		}
 
-			if (this->listenIp.announcedIp.empty())
-				(*jsonTupleIt)["localIp"] = this->udpSocket->GetLocalIp();
-			else
-				(*jsonTupleIt)["localIp"] = this->listenIp.announcedIp;
+		// Add memoryPipeId.
+		if (this->memoryPipe)
+			jsonObject["memoryPipeId"] = this->memoryPipe->GetId();
+
+		if (this->trunk)
+		{
+			// Add trunkSentFrames.
+			jsonObject["trunkSentFrames"] = this->trunk->GetSentFrames();
+			// Add trunkSentPackets.
+			jsonObject["trunkSentPackets"] = this->trunk->GetSentPackets();
+		}
 
-			(*jsonTupleIt)["localPort"] = this->udpSocket->GetLocalPort();
-			(*jsonTupleIt)["protocol"]  = "udp";
+		if (this->trustedNetwork)
+		{
+			// Add trustedChecksumErrors.
+			jsonObject["trustedChecksumErrors"] = this->trustedChecksumErrors;
 		}
+
+		// Add udpSocket.
+		if (this->udpSocket)
+			this->udpSocket->FillJsonStats(jsonObject["udpSocket"]);
+
+		// Add tcpConnection.
+		if (this->tuple && this->tuple->GetProtocol() == RTC::TransportTuple::Protocol::TCP)
+			this->tuple->GetTcpConnection()->FillJsonStats(jsonObject["tcpConnection"]);
 	}
 
 	void PipeTransport::HandleRequest(Channel::ChannelRequest* request)
@@ -202,7 +398,7 @@ namespace RTC
 			case Channel::ChannelRequest::MethodId::TRANSPORT_CONNECT:
 			{
 				// Ensure this method is not called twice.
-				if (this->tuple)
+				if (IsConnected() || !this->tcpRole.empty())
 					MS_THROW_ERROR("connect() already called");
 
 				try
@@ -269,120 +465,187 @@ namespace RTC
 						if (outLen != PipeTransport::srtpMasterLength)
 							MS_THROW_TYPE_ERROR("invalid decoded SRTP key length");
 
-						auto* srtpLocalKey  = new uint8_t[PipeTransport::srtpMasterLength];
-						auto* srtpRemoteKey = new uint8_t[PipeTransport::srtpMasterLength];
-
-						std::memcpy(srtpLocalKey, this->srtpKey.c_str(), PipeTransport::srtpMasterLength);
-						std::memcpy(srtpRemoteKey, srtpKey, PipeTransport::srtpMasterLength);
-
-						try
+						// A single AEAD operation per trunk frame replaces SRTP.
+						if (this->trunk)
 						{
-							this->srtpSendSession = new RTC::SrtpSession(
-							  RTC::SrtpSession::Type::OUTBOUND,
-							  PipeTransport::srtpCryptoSuite,
-							  srtpLocalKey,
-							  PipeTransport::srtpMasterLength);
+							// This may throw.
+							this->trunk->SetKeys(
+							  reinterpret_cast<const uint8_t*>(this->srtpKey.c_str()), srtpKey);
 						}
-						catch (const MediaSoupError& error)
+						else
 						{
+							auto* srtpLocalKey  = new uint8_t[PipeTransport::srtpMasterLength];
+							auto* srtpRemoteKey = new uint8_t[PipeTransport::srtpMasterLength];
+
+							std::memcpy(
+							  srtpLocalKey, this->srtpKey.c_str(), PipeTransport::srtpMasterLength);
+							std::memcpy(srtpRemoteKey, srtpKey, PipeTransport::srtpMasterLength);
+
+							try
+							{
+								this->srtpSendSession = new RTC::SrtpSession(
+								  RTC::SrtpSession::Type::OUTBOUND,
+								  PipeTransport::srtpCryptoSuite,
+								  srtpLocalKey,
+								  PipeTransport::srtpMasterLength);
+							}
+							catch (const MediaSoupError& error)
+							{
+								delete[] srtpLocalKey;
+								delete[] srtpRemoteKey;
+
+								MS_THROW_ERROR("error creating SRTP sending session: %s", error.what());
+							}
+
+							try
+							{
+								this->srtpRecvSession = new RTC::SrtpSession(
+								  RTC::SrtpSession::Type::INBOUND,
+								  PipeTransport::srtpCryptoSuite,
+								  srtpRemoteKey,
+								  PipeTransport::srtpMasterLength);
+							}
+							catch (const MediaSoupError& error)
+							{
+								delete[] srtpLocalKey;
+								delete[] srtpRemoteKey;
+
+								MS_THROW_ERROR("error creating SRTP receiving session: %s", error.what());
+							}
+
 							delete[] srtpLocalKey;
 							delete[] srtpRemoteKey;
-
-							MS_THROW_ERROR("error creating SRTP sending session: %s", error.what());
 						}
+					}
+
+					if (this->memoryPipe)
+					{
+						auto jsonMemoryPipeIdIt = request->data.find("memoryPipeId");
 
-						try
+						// clang-format off
+						if (
+							jsonMemoryPipeIdIt == request->data.end() ||
+							!jsonMemoryPipeIdIt->is_string()
+						)
+						// clang-format on
 						{
-							this->srtpRecvSession = new RTC::SrtpSession(
-							  RTC::SrtpSession::Type::INBOUND,
-							  PipeTransport::srtpCryptoSuite,
-							  srtpRemoteKey,
-							  PipeTransport::srtpMasterLength);
+							MS_THROW_TYPE_ERROR("missing memoryPipeId");
 						}
-						catch (const MediaSoupError& error)
-						{
-							delete[] srtpLocalKey;
-							delete[] srtpRemoteKey;
 
-							MS_THROW_ERROR("error creating SRTP receiving session: %s", error.what());
-						}
+						const auto memoryPipeId = jsonMemoryPipeIdIt->get<std::string>();
+
+						// This may throw.
+						this->memoryPipe->Connect(memoryPipeId);
+
+						// If the paired PipeTransport belongs to this same worker, RTP and RTCP
+						// are directly passed to it. SCTP still goes through the MemoryPipe so
+						// usrsctp is not reentered from its own send callback.
+						auto it = PipeTransport::inMemoryPipeTransports.find(memoryPipeId);
 
-						delete[] srtpLocalKey;
-						delete[] srtpRemoteKey;
+						if (it != PipeTransport::inMemoryPipeTransports.end())
+							this->localPeer = it->second;
 					}
+					else
+					{
+						auto jsonIpIt = request->data.find("ip");
 
-					auto jsonIpIt = request->data.find("ip");
+						if (jsonIpIt == request->data.end() || !jsonIpIt->is_string())
+							MS_THROW_TYPE_ERROR("missing ip");
 
-					if (jsonIpIt == request->data.end() || !jsonIpIt->is_string())
-						MS_THROW_TYPE_ERROR("missing ip");
+						ip = jsonIpIt->get<std::string>();
 
-					ip = jsonIpIt->get<std::string>();
+						// This may throw.
+						Utils::IP::NormalizeIp(ip);
 
-					// This may throw.
-					Utils::IP::NormalizeIp(ip);
+						auto jsonPortIt = request->data.find("port");
 
-					auto jsonPortIt = request->data.find("port");
+						// clang-format off
+						if (
+							jsonPortIt == request->data.end() ||
+							!Utils::Json::IsPositiveInteger(*jsonPortIt)
+						)
+						// clang-format on
+						{
+							MS_THROW_TYPE_ERROR("missing port");
+						}
 
-					// clang-format off
-					if (
-						jsonPortIt == request->data.end() ||
-						!Utils::Json::IsPositiveInteger(*jsonPortIt)
-					)
-					// clang-format on
-					{
-						MS_THROW_TYPE_ERROR("missing port");
-					}
+						port = jsonPortIt->get<uint16_t>();
 
-					port = jsonPortIt->get<uint16_t>();
+						int err;
 
-					int err;
+						switch (Utils::IP::GetFamily(ip))
+						{
+							case AF_INET:
+							{
+								err = uv_ip4_addr(
+								  ip.c_str(),
+								  static_cast<int>(port),
+								  reinterpret_cast<struct sockaddr_in*>(&this->remoteAddrStorage));
+
+								if (err != 0)
+									MS_THROW_ERROR("uv_ip4_addr() failed: %s", uv_strerror(err));
+
+								break;
+							}
+
+							case AF_INET6:
+							{
+								err = uv_ip6_addr(
+								  ip.c_str(),
+								  static_cast<int>(port),
+								  reinterpret_cast<struct sockaddr_in6*>(&this->remoteAddrStorage));
+
+								if (err != 0)
+									MS_THROW_ERROR("uv_ip6_addr() failed: %s", uv_strerror(err));
+
+								break;
+							}
+
+							default:
+							{
+								MS_THROW_ERROR("invalid IP '%s'", ip.c_str());
+							}
+						}
 
-					switch (Utils::IP::GetFamily(ip))
-					{
-						case AF_INET:
+						if (this->tcp)
 						{
-							err = uv_ip4_addr(
-							  ip.c_str(),
-							  static_cast<int>(port),
-							  reinterpret_cast<struct sockaddr_in*>(&this->remoteAddrStorage));
+							auto jsonTcpRoleIt = request->data.find("tcpRole");
 
-							if (err != 0)
-								MS_THROW_ERROR("uv_ip4_addr() failed: %s", uv_strerror(err));
+							if (jsonTcpRoleIt == request->data.end() || !jsonTcpRoleIt->is_string())
+								MS_THROW_TYPE_ERROR("missing tcpRole (TCP enabled)");
 
-							break;
-						}
+							const auto tcpRole = jsonTcpRoleIt->get<std::string>();
 
-						case AF_INET6:
-						{
-							err = uv_ip6_addr(
-							  ip.c_str(),
-							  static_cast<int>(port),
-							  reinterpret_cast<struct sockaddr_in6*>(&this->remoteAddrStorage));
+							if (tcpRole != "client" && tcpRole != "server")
+								MS_THROW_TYPE_ERROR("invalid tcpRole");
 
-							if (err != 0)
-								MS_THROW_ERROR("uv_ip6_addr() failed: %s", uv_strerror(err));
+							this->tcpRole  = tcpRole;
+							this->remoteIp = ip;
 
-							break;
+							// The tuple is created once the TCP connection is established.
+							// This may throw.
+							if (this->tcpRole == "client")
+								ConnectTcp();
 						}
-
-						default:
+						else
 						{
-							MS_THROW_ERROR("invalid IP '%s'", ip.c_str());
+							// Create the tuple.
+							this->tuple = new RTC::TransportTuple(
+							  this->udpSocket, reinterpret_cast<struct sockaddr*>(&this->remoteAddrStorage));
+
+							if (!this->listenIp.announcedIp.empty())
+								this->tuple->SetLocalAnnouncedIp(this->listenIp.announcedIp);
 						}
 					}
-
-					// Create the tuple.
-					this->tuple = new RTC::TransportTuple(
-					  this->udpSocket, reinterpret_cast<struct sockaddr*>(&this->remoteAddrStorage));
-
-					if (!this->listenIp.announcedIp.empty())
-						this->tuple->SetLocalAnnouncedIp(this->listenIp.announcedIp);
 				}
 				catch (const MediaSoupError& error)
 				{
 					delete this->tuple;
 					this->tuple = nullptr;
 
+					this->tcpRole.clear();
+					this->remoteIp.clear();
+
 					delete this->srtpSendSession;
 					this->srtpSendSession = nullptr;
 
@@ -395,13 +658,30 @@ namespace RTC
 				// Tell the caller about the selected local DTLS role.
 				json data = json::object();
 
-				this->tuple->FillJson(data["tuple"]);
+				if (this->tuple)
+					this->tuple->FillJson(data["tuple"]);
+				else
+					FillJsonLocalTuple(data["tuple"]);
 
 				request->Accept(data);
 
 				// Assume we are connected (there is no much more we can do to know it)
-				// and tell the parent class.
-				RTC::Transport::Connected();
+				// and tell the parent class. In TCP mode it's done once the TCP
+				// connection is established.
+				if (!this->tcp)
+					RTC::Transport::Connected();
+
+				break;
+			}
+
+			case Channel::ChannelRequest::MethodId::PRODUCER_CLOSE:
+			{
+				// Forget Producers of remote stream indexes (they will be looked up
+				// again).
+				this->trustedRecvStreams.clear();
+
+				// Pass it to the parent class.
+				RTC::Transport::HandleRequest(request);
 
 				break;
 			}
@@ -424,6 +704,9 @@ namespace RTC
 
 	inline bool PipeTransport::IsConnected() const
 	{
+		if (this->memoryPipe)
+			return this->memoryPipe->IsConnected();
+
 		return this->tuple;
 	}
 
@@ -432,166 +715,607 @@ namespace RTC
 		return !this->srtpKey.empty();
 	}
 
-	void PipeTransport::SendRtpPacket(
-	  RTC::Consumer* /*consumer*/, RTC::RtpPacket* packet, RTC::Transport::onSendCallback* cb)
+	inline uint8_t* PipeTransport::GetPeerSendBuffer(size_t len)
 	{
-		MS_TRACE();
+		if (this->memoryPipe)
+			return this->memoryPipe->GetSendBuffer(len);
 
-		if (!IsConnected())
+		return this->tuple->GetSendBuffer(len);
+	}
+
+	inline void PipeTransport::SendPeerBuffer(size_t len, RTC::Transport::onSendCallback* cb)
+	{
+		if (this->memoryPipe)
 		{
+			this->memoryPipe->SendBuffer(len);
+
 			if (cb)
-			{
-				(*cb)(false);
-				delete cb;
-			}
+				(*cb)(true);
 
 			return;
 		}
 
-		const uint8_t* data = packet->GetData();
-		auto intLen         = static_cast<int>(packet->GetSize());
+		this->tuple->SendBuffer(len, cb);
+	}
 
-		if (HasSrtp() && !this->srtpSendSession->EncryptRtp(&data, &intLen))
+	inline void PipeTransport::SendToPeer(
+	  const uint8_t* data, size_t len, RTC::Transport::onSendCallback* cb)
+	{
+		if (this->memoryPipe)
 		{
+			const bool sent = this->memoryPipe->Send(data, len);
+
 			if (cb)
-			{
-				(*cb)(false);
-				delete cb;
-			}
+				(*cb)(sent);
 
 			return;
 		}
 
-		auto len = static_cast<size_t>(intLen);
-
 		this->tuple->Send(data, len, cb);
-
-		// Increase send transmission.
-		RTC::Transport::DataSent(len);
 	}
 
-	void PipeTransport::SendRtcpPacket(RTC::RTCP::Packet* packet)
+	inline void PipeTransport::SendToTrunk(
+	  const uint8_t* data, size_t len, RTC::Transport::onSendCallback* cb)
 	{
-		MS_TRACE();
+		const bool wasEmpty = this->trunk->IsEmpty();
 
-		if (!IsConnected())
-			return;
+		if (!this->trunk->Send(data, len))
+		{
+			MS_WARN_DEV("packet too big for the trunk, discarded [len:%zu]", len);
 
-		const uint8_t* data = packet->GetData();
-		auto intLen         = static_cast<int>(packet->GetSize());
+			if (cb)
+				(*cb)(false);
 
-		if (HasSrtp() && !this->srtpSendSession->EncryptRtcp(&data, &intLen))
 			return;
+		}
 
-		auto len = static_cast<size_t>(intLen);
+		// NOTE: The packet is owned by the trunk now, so consider it sent.
+		if (cb)
+			(*cb)(true);
 
-		this->tuple->Send(data, len);
+		if (!this->trunkPrepareHandle)
+		{
+			this->trunk->Flush();
+		}
+		// First packet of the frame, flush it before next poll.
+		else if (wasEmpty)
+		{
+			const int err = uv_prepare_start(
+			  this->trunkPrepareHandle, static_cast<uv_prepare_cb>(onTrunkPrepare));
 
-		// Increase send transmission.
-		RTC::Transport::DataSent(len);
+			if (err != 0)
+				MS_ABORT("uv_prepare_start() failed: %s", uv_strerror(err));
+		}
 	}
 
-	void PipeTransport::SendRtcpCompoundPacket(RTC::RTCP::CompoundPacket* packet)
+	void PipeTransport::SendTrusted(
+	  const uint8_t* data, size_t len, bool isRtp, RTC::Transport::onSendCallback* cb)
 	{
 		MS_TRACE();
 
-		if (!IsConnected())
-			return;
+		const size_t trailerSize = isRtp ? TrustedRtpTrailerSize : TrustedChecksumSize;
+		const size_t trustedLen  = len + trailerSize;
 
-		const uint8_t* data = packet->GetData();
-		auto intLen         = static_cast<int>(packet->GetSize());
+		// Write it straight into the egress buffer of the socket if possible.
+		alignas(8) uint8_t localBuffer[LocalPeerBufferSize];
+		uint8_t* buffer = GetPeerSendBuffer(trustedLen);
+		const bool useLocalBuffer{ buffer == nullptr };
 
-		if (HasSrtp() && !this->srtpSendSession->EncryptRtcp(&data, &intLen))
-			return;
+		if (useLocalBuffer)
+		{
+			if (trustedLen > sizeof(localBuffer))
+			{
+				MS_WARN_DEV("packet too big, discarded [len:%zu]", len);
 
-		auto len = static_cast<size_t>(intLen);
+				if (cb)
+					(*cb)(false);
 
-		this->tuple->Send(data, len);
+				return;
+			}
 
-		// Increase send transmission.
-		RTC::Transport::DataSent(len);
-	}
+			buffer = localBuffer;
+		}
 
-	void PipeTransport::SendMessage(
-	  RTC::DataConsumer* dataConsumer, uint32_t ppid, const uint8_t* msg, size_t len, onQueuedCallback* cb)
-	{
-		MS_TRACE();
+		std::memcpy(buffer, data, len);
 
-		this->sctpAssociation->SendSctpMessage(dataConsumer, ppid, msg, len, cb);
-	}
+		if (isRtp)
+		{
+			const uint32_t ssrc = Utils::Byte::Get4Bytes(data, 8);
 
-	void PipeTransport::SendSctpData(const uint8_t* data, size_t len)
-	{
-		MS_TRACE();
+			Utils::Byte::Set2Bytes(buffer, len, GetTrustedSendStreamIndex(ssrc));
+		}
 
-		if (!IsConnected())
-			return;
+		const uint32_t checksum = Utils::Crypto::GetCRC32c(buffer, trustedLen - TrustedChecksumSize);
+
+		Utils::Byte::Set4Bytes(buffer, trustedLen - TrustedChecksumSize, checksum);
 
-		this->tuple->Send(data, len);
+		if (useLocalBuffer)
+			SendToPeer(buffer, trustedLen, cb);
+		else
+			SendPeerBuffer(trustedLen, cb);
 
 		// Increase send transmission.
-		RTC::Transport::DataSent(len);
+		RTC::Transport::DataSent(trustedLen);
 	}
 
-	void PipeTransport::RecvStreamClosed(uint32_t ssrc)
+	uint16_t PipeTransport::GetTrustedSendStreamIndex(uint32_t ssrc)
 	{
 		MS_TRACE();
 
-		if (this->srtpRecvSession)
+		auto it = this->mapSsrcTrustedSendStreamIndex.find(ssrc);
+
+		if (it != this->mapSsrcTrustedSendStreamIndex.end())
+			return it->second;
+
+		uint16_t streamIndex;
+
+		if (!this->trustedFreeStreamIndexes.empty())
 		{
-			this->srtpRecvSession->RemoveStream(ssrc);
+			streamIndex = this->trustedFreeStreamIndexes.back();
+
+			this->trustedFreeStreamIndexes.pop_back();
+		}
+		else if (this->trustedNextStreamIndex != TrustedNoStreamIndex)
+		{
+			streamIndex = this->trustedNextStreamIndex++;
+		}
+		// No more indexes, the receiver will look up the SSRC.
+		else
+		{
+			return TrustedNoStreamIndex;
 		}
+
+		this->mapSsrcTrustedSendStreamIndex[ssrc] = streamIndex;
+
+		return streamIndex;
 	}
 
-	void PipeTransport::SendStreamClosed(uint32_t ssrc)
+	inline bool PipeTransport::CheckTrustedChecksum(const uint8_t* data, size_t len)
 	{
 		MS_TRACE();
 
-		if (this->srtpSendSession)
+		// clang-format off
+		if (
+			len <= TrustedChecksumSize ||
+			Utils::Crypto::GetCRC32c(data, len - TrustedChecksumSize) !=
+				Utils::Byte::Get4Bytes(data, len - TrustedChecksumSize)
+		)
+		// clang-format on
 		{
-			this->srtpSendSession->RemoveStream(ssrc);
+			++this->trustedChecksumErrors;
+
+			MS_WARN_TAG(rtp, "wrong checksum, packet discarded [len:%zu]", len);
+
+			return false;
 		}
+
+		return true;
 	}
 
-	inline void PipeTransport::OnPacketReceived(RTC::TransportTuple* tuple, const uint8_t* data, size_t len)
+	inline RTC::Producer* PipeTransport::GetTrustedRecvProducer(uint16_t streamIndex, uint32_t ssrc)
 	{
 		MS_TRACE();
 
-		// Increase receive transmission.
-		RTC::Transport::DataReceived(len);
+		if (streamIndex == TrustedNoStreamIndex)
+			return nullptr;
 
-		// Check if it's RTCP.
-		if (RTC::RTCP::Packet::IsRtcp(data, len))
-		{
-			OnRtcpDataReceived(tuple, data, len);
-		}
-		// Check if it's RTP.
-		else if (RTC::RtpPacket::IsRtp(data, len))
-		{
-			OnRtpDataReceived(tuple, data, len);
-		}
-		// Check if it's SCTP.
-		else if (RTC::SctpAssociation::IsSctp(data, len))
-		{
-			OnSctpDataReceived(tuple, data, len);
-		}
-		else
+		// clang-format off
+		if (
+			streamIndex < this->trustedRecvStreams.size() &&
+			this->trustedRecvStreams[streamIndex].ssrc == ssrc &&
+			this->trustedRecvStreams[streamIndex].producer
+		)
+		// clang-format on
 		{
-			MS_WARN_DEV("ignoring received packet of unknown type");
+			return this->trustedRecvStreams[streamIndex].producer;
 		}
+
+		// First packet of the stream (or the index was reused by the remote
+		// PipeTransport), so look up the SSRC once.
+		auto* producer = GetProducerBySsrc(ssrc);
+
+		if (!producer)
+			return nullptr;
+
+		if (streamIndex >= this->trustedRecvStreams.size())
+			this->trustedRecvStreams.resize(streamIndex + 1);
+
+		this->trustedRecvStreams[streamIndex].ssrc     = ssrc;
+		this->trustedRecvStreams[streamIndex].producer = producer;
+
+		return producer;
 	}
 
-	inline void PipeTransport::OnRtpDataReceived(RTC::TransportTuple* tuple, const uint8_t* data, size_t len)
+	inline bool PipeTransport::SendRtcpToLocalPeer(const uint8_t* data, size_t len)
 	{
 		MS_TRACE();
 
-		if (!IsConnected())
-			return;
+		if (!this->localPeer->IsConnected())
+			return false;
+
+		if (len > LocalPeerBufferSize)
+		{
+			MS_WARN_TAG(rtcp, "RTCP packet too big for local peer, discarded [len:%zu]", len);
+
+			return false;
+		}
+
+		// Copy it since the local peer may serialize its own RTCP packets into the
+		// same buffer while handling these ones.
+		alignas(8) uint8_t buffer[LocalPeerBufferSize];
+
+		std::memcpy(buffer, data, len);
+
+		this->localPeer->MayCaptureRtcpPacket(RTC::PacketCapture::Direction::IN, buffer, len);
+
+		// Parsed RTCP objects are released all together after being handled.
+		RTC::RTCP::Arena::Scope arenaScope;
+
+		RTC::RTCP::Packet* packet = RTC::RTCP::Packet::Parse(buffer, len);
+
+		if (!packet)
+			return false;
+
+		this->localPeer->DataReceived(len);
+		this->localPeer->ReceiveRtcpPacket(packet);
+
+		return true;
+	}
+
+	void PipeTransport::FillJsonLocalTuple(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		jsonObject = json::object();
+
+		if (!this->listenIp.announcedIp.empty())
+			jsonObject["localIp"] = this->listenIp.announcedIp;
+		else if (this->udpSocket)
+			jsonObject["localIp"] = this->udpSocket->GetLocalIp();
+		else if (this->tcpServer)
+			jsonObject["localIp"] = this->tcpServer->GetLocalIp();
+		else
+			jsonObject["localIp"] = this->listenIp.ip;
+
+		// There is no port when using a MemoryPipe.
+		if (this->udpSocket)
+			jsonObject["localPort"] = this->udpSocket->GetLocalPort();
+		else if (this->tcpServer)
+			jsonObject["localPort"] = this->tcpServer->GetLocalPort();
+		else
+			jsonObject["localPort"] = 0;
+
+		jsonObject["protocol"] = this->tcp ? "tcp" : "udp";
+	}
+
+	void PipeTransport::SendRtpPacket(
+	  RTC::Consumer* /*consumer*/, RTC::RtpPacket* packet, RTC::Transport::onSendCallback* cb)
+	{
+		MS_TRACE();
+
+		if (!IsConnected())
+		{
+			if (cb)
+				(*cb)(false);
+
+			return;
+		}
+
+		if (this->localPeer)
+		{
+			auto len = packet->GetSize();
+
+			if (!this->localPeer->IsConnected() || len > LocalPeerBufferSize)
+			{
+				if (cb)
+					(*cb)(false);
+
+				return;
+			}
+
+			// The receiving Producer rewrites the packet so hand it a clone (instead
+			// of serializing it into a socket and parsing it again).
+			alignas(8) uint8_t buffer[LocalPeerBufferSize];
+			auto* clonedPacket = packet->Clone(buffer);
+
+			// Increase send transmission.
+			RTC::Transport::DataSent(len);
+
+			if (cb)
+				(*cb)(true);
+
+			this->localPeer->DataReceived(len);
+			this->localPeer->ReceiveRtpPacket(clonedPacket);
+
+			return;
+		}
+
+		if (this->trunk)
+		{
+			SendToTrunk(packet->GetData(), packet->GetSize(), cb);
+
+			return;
+		}
+
+		if (this->trustedNetwork)
+		{
+			SendTrusted(packet->GetData(), packet->GetSize(), true, cb);
+
+			return;
+		}
+
+		auto intLen = static_cast<int>(packet->GetSize());
+
+		// If possible, encrypt the packet straight into the egress buffer of the
+		// socket so it's not copied again.
+		uint8_t* buffer{ nullptr };
+
+		if (HasSrtp())
+			buffer = GetPeerSendBuffer(packet->GetSize() + RTC::SrtpSession::MaxTrailerSize);
+
+		if (buffer)
+		{
+			if (!this->srtpSendSession->EncryptRtp(packet->GetData(), &intLen, buffer))
+			{
+				// Release the reserved buffer without sending anything.
+				if (this->memoryPipe)
+					this->memoryPipe->CancelSendBuffer();
+
+				if (cb)
+					(*cb)(false);
+
+				return;
+			}
+
+			auto len = static_cast<size_t>(intLen);
+
+			SendPeerBuffer(len, cb);
+
+			// Increase send transmission.
+			RTC::Transport::DataSent(len);
+
+			return;
+		}
+
+		const uint8_t* data = packet->GetData();
+
+		if (HasSrtp() && !this->srtpSendSession->EncryptRtp(&data, &intLen))
+		{
+			if (cb)
+				(*cb)(false);
+
+			return;
+		}
+
+		auto len = static_cast<size_t>(intLen);
+
+		SendToPeer(data, len, cb);
+
+		// Increase send transmission.
+		RTC::Transport::DataSent(len);
+	}
+
+	void PipeTransport::SendRtcpPacket(RTC::RTCP::Packet* packet)
+	{
+		MS_TRACE();
+
+		if (!IsConnected())
+			return;
+
+		if (this->localPeer)
+		{
+			if (SendRtcpToLocalPeer(packet->GetData(), packet->GetSize()))
+			{
+				// Increase send transmission.
+				RTC::Transport::DataSent(packet->GetSize());
+			}
+
+			return;
+		}
+
+		if (this->trunk)
+		{
+			SendToTrunk(packet->GetData(), packet->GetSize());
+
+			return;
+		}
+
+		if (this->trustedNetwork)
+		{
+			SendTrusted(packet->GetData(), packet->GetSize(), false);
+
+			return;
+		}
+
+		const uint8_t* data = packet->GetData();
+		auto intLen         = static_cast<int>(packet->GetSize());
+
+		if (HasSrtp() && !this->srtpSendSession->EncryptRtcp(&data, &intLen))
+			return;
+
+		auto len = static_cast<size_t>(intLen);
+
+		SendToPeer(data, len);
+
+		// Increase send transmission.
+		RTC::Transport::DataSent(len);
+	}
+
+	void PipeTransport::SendRtcpCompoundPacket(RTC::RTCP::CompoundPacket* packet)
+	{
+		MS_TRACE();
+
+		if (!IsConnected())
+			return;
+
+		if (this->localPeer)
+		{
+			if (SendRtcpToLocalPeer(packet->GetData(), packet->GetSize()))
+			{
+				// Increase send transmission.
+				RTC::Transport::DataSent(packet->GetSize());
+			}
+
+			return;
+		}
+
+		if (this->trunk)
+		{
+			SendToTrunk(packet->GetData(), packet->GetSize());
+
+			return;
+		}
+
+		if (this->trustedNetwork)
+		{
+			SendTrusted(packet->GetData(), packet->GetSize(), false);
+
+			return;
+		}
+
+		const uint8_t* data = packet->GetData();
+		auto intLen         = static_cast<int>(packet->GetSize());
+
+		if (HasSrtp() && !this->srtpSendSession->EncryptRtcp(&data, &intLen))
+			return;
+
+		auto len = static_cast<size_t>(intLen);
+
+		SendToPeer(data, len);
+
+		// Increase send transmission.
+		RTC::Transport::DataSent(len);
+	}
+
+	void PipeTransport::SendMessage(
+	  RTC::DataConsumer* dataConsumer, uint32_t ppid, const uint8_t* msg, size_t len, onQueuedCallback* cb)
+	{
+		MS_TRACE();
+
+		this->sctpAssociation->SendSctpMessage(dataConsumer, ppid, msg, len, cb);
+	}
+
+	void PipeTransport::SendSctpData(const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		if (!IsConnected())
+			return;
+
+		SendToPeer(data, len);
+
+		// Increase send transmission.
+		RTC::Transport::DataSent(len);
+	}
+
+	void PipeTransport::RecvStreamClosed(uint32_t ssrc)
+	{
+		MS_TRACE();
+
+		if (this->srtpRecvSession)
+		{
+			this->srtpRecvSession->RemoveStream(ssrc);
+		}
+
+		for (auto& trustedRecvStream : this->trustedRecvStreams)
+		{
+			if (trustedRecvStream.ssrc == ssrc)
+				trustedRecvStream = TrustedRecvStream();
+		}
+	}
+
+	void PipeTransport::SendStreamClosed(uint32_t ssrc)
+	{
+		MS_TRACE();
+
+		if (this->srtpSendSession)
+		{
+			this->srtpSendSession->RemoveStream(ssrc);
+		}
+
+		auto it = this->mapSsrcTrustedSendStreamIndex.find(ssrc);
+
+		if (it != this->mapSsrcTrustedSendStreamIndex.end())
+		{
+			this->trustedFreeStreamIndexes.push_back(it->second);
+			this->mapSsrcTrustedSendStreamIndex.erase(it);
+		}
+	}
+
+	inline void PipeTransport::OnPacketReceived(RTC::TransportTuple* tuple, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		// Increase receive transmission.
+		RTC::Transport::DataReceived(len);
+
+		// Check if it's a trunk frame.
+		if (RTC::PipeTrunk::IsFrame(data, len))
+		{
+			OnTrunkFrameReceived(tuple, data, len);
+		}
+		// RTP and RTCP must come in authenticated trunk frames.
+		// clang-format off
+		else if (
+			this->trunk &&
+			this->trunk->HasKeys() &&
+			!RTC::SctpAssociation::IsSctp(data, len)
+		)
+		// clang-format on
+		{
+			MS_WARN_DEV("ignoring packet out of a trunk frame");
+		}
+		// Check if it's RTCP.
+		else if (RTC::RTCP::Packet::IsRtcp(data, len))
+		{
+			OnRtcpDataReceived(tuple, data, len);
+		}
+		// Check if it's RTP.
+		else if (RTC::RtpPacket::IsRtp(data, len))
+		{
+			OnRtpDataReceived(tuple, data, len);
+		}
+		// Check if it's SCTP.
+		else if (RTC::SctpAssociation::IsSctp(data, len))
+		{
+			OnSctpDataReceived(tuple, data, len);
+		}
+		else
+		{
+			MS_WARN_DEV("ignoring received packet of unknown type");
+		}
+	}
+
+	inline void PipeTransport::OnRtpDataReceived(RTC::TransportTuple* tuple, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
+
+		if (!IsConnected())
+			return;
+
+		uint16_t trustedStreamIndex{ TrustedNoStreamIndex };
+
+		if (this->trustedNetwork)
+		{
+			if (len <= TrustedRtpTrailerSize || !CheckTrustedChecksum(data, len))
+				return;
+
+			len -= TrustedRtpTrailerSize;
+			trustedStreamIndex = Utils::Byte::Get2Bytes(data, len);
+		}
 
 		// Decrypt the SRTP packet.
 		auto intLen = static_cast<int>(len);
 
-		if (HasSrtp() && !this->srtpRecvSession->DecryptSrtp(const_cast<uint8_t*>(data), &intLen))
+		// NOTE: There is no SRTP session in trunk mode.
+		// clang-format off
+		if (
+			this->srtpRecvSession &&
+			!this->srtpRecvSession->DecryptSrtp(const_cast<uint8_t*>(data), &intLen)
+		)
+		// clang-format on
 		{
 			RTC::RtpPacket* packet = RTC::RtpPacket::Parse(data, static_cast<size_t>(intLen));
 
@@ -623,8 +1347,9 @@ namespace RTC
 			return;
 		}
 
-		// Verify that the packet's tuple matches our tuple.
-		if (!this->tuple->Compare(tuple))
+		// Verify that the packet's tuple matches our tuple (if not using a
+		// MemoryPipe).
+		if (!this->memoryPipe && !this->tuple->Compare(tuple))
 		{
 			MS_DEBUG_TAG(rtp, "ignoring RTP packet from unknown IP:port");
 
@@ -636,8 +1361,15 @@ namespace RTC
 			return;
 		}
 
+		// In trusted network mode the Producer is directly found by the stream
+		// index once known.
+		RTC::Producer* producer{ nullptr };
+
+		if (this->trustedNetwork)
+			producer = GetTrustedRecvProducer(trustedStreamIndex, packet->GetSsrc());
+
 		// Pass the packet to the parent transport.
-		RTC::Transport::ReceiveRtpPacket(packet);
+		RTC::Transport::ReceiveRtpPacket(packet, producer);
 	}
 
 	inline void PipeTransport::OnRtcpDataReceived(
@@ -645,25 +1377,47 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
+
 		if (!IsConnected())
 			return;
 
+		if (this->trustedNetwork)
+		{
+			if (!CheckTrustedChecksum(data, len))
+				return;
+
+			len -= TrustedChecksumSize;
+		}
+
 		// Decrypt the SRTCP packet.
 		auto intLen = static_cast<int>(len);
 
-		if (HasSrtp() && !this->srtpRecvSession->DecryptSrtcp(const_cast<uint8_t*>(data), &intLen))
+		// NOTE: There is no SRTP session in trunk mode.
+		// clang-format off
+		if (
+			this->srtpRecvSession &&
+			!this->srtpRecvSession->DecryptSrtcp(const_cast<uint8_t*>(data), &intLen)
+		)
+		// clang-format on
 		{
 			return;
 		}
 
-		// Verify that the packet's tuple matches our tuple.
-		if (!this->tuple->Compare(tuple))
+		// Verify that the packet's tuple matches our tuple (if not using a
+		// MemoryPipe).
+		if (!this->memoryPipe && !this->tuple->Compare(tuple))
 		{
 			MS_DEBUG_TAG(rtcp, "ignoring RTCP packet from unknown IP:port");
 
 			return;
 		}
 
+		MayCaptureRtcpPacket(RTC::PacketCapture::Direction::IN, data, static_cast<size_t>(intLen));
+
+		// Parsed RTCP objects are released all together after being handled.
+		RTC::RTCP::Arena::Scope arenaScope;
+
 		RTC::RTCP::Packet* packet = RTC::RTCP::Packet::Parse(data, static_cast<size_t>(intLen));
 
 		if (!packet)
@@ -685,8 +1439,9 @@ namespace RTC
 		if (!IsConnected())
 			return;
 
-		// Verify that the packet's tuple matches our tuple.
-		if (!this->tuple->Compare(tuple))
+		// Verify that the packet's tuple matches our tuple (if not using a
+		// MemoryPipe).
+		if (!this->memoryPipe && !this->tuple->Compare(tuple))
 		{
 			MS_DEBUG_TAG(sctp, "ignoring SCTP packet from unknown IP:port");
 
@@ -697,6 +1452,103 @@ namespace RTC
 		RTC::Transport::ReceiveSctpData(data, len);
 	}
 
+	inline void PipeTransport::OnTrunkFrameReceived(
+	  RTC::TransportTuple* tuple, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		if (!IsConnected())
+			return;
+
+		if (!this->trunk)
+		{
+			MS_WARN_DEV("ignoring trunk frame (trunk not enabled)");
+
+			return;
+		}
+
+		// Verify that the frame's tuple matches our tuple.
+		if (!this->tuple->Compare(tuple))
+		{
+			MS_DEBUG_TAG(rtp, "ignoring trunk frame from unknown IP:port");
+
+			return;
+		}
+
+		// The frame is decrypted in place and its packets are passed back.
+		this->trunk->ReceiveFrame(const_cast<uint8_t*>(data), len);
+	}
+
+	void PipeTransport::ConnectTcp()
+	{
+		MS_TRACE();
+
+		this->tcpClientConnection = new RTC::TcpConnection(this, TcpBufferSize);
+
+		try
+		{
+			// This may throw.
+			this->tcpClientConnection->Connect(
+			  this, reinterpret_cast<struct sockaddr*>(&this->remoteAddrStorage));
+		}
+		catch (const MediaSoupError& error)
+		{
+			delete this->tcpClientConnection;
+			this->tcpClientConnection = nullptr;
+
+			throw;
+		}
+	}
+
+	void PipeTransport::OnTcpConnected(RTC::TcpConnection* connection)
+	{
+		MS_TRACE();
+
+		MS_DEBUG_TAG(
+		  info,
+		  "TCP connection established [peer:%s:%" PRIu16 ", role:%s]",
+		  connection->GetPeerIp().c_str(),
+		  connection->GetPeerPort(),
+		  this->tcpRole.c_str());
+
+		auto* uvHandle = connection->GetUvHandle();
+		int bufferSize{ TcpSocketBufferSize };
+		int err;
+
+		err = uv_send_buffer_size(reinterpret_cast<uv_handle_t*>(uvHandle), &bufferSize);
+
+		if (err != 0)
+			MS_WARN_DEV("uv_send_buffer_size() failed: %s", uv_strerror(err));
+
+		bufferSize = TcpSocketBufferSize;
+
+		err = uv_recv_buffer_size(reinterpret_cast<uv_handle_t*>(uvHandle), &bufferSize);
+
+		if (err != 0)
+			MS_WARN_DEV("uv_recv_buffer_size() failed: %s", uv_strerror(err));
+
+		this->tuple = new RTC::TransportTuple(connection);
+
+		if (!this->listenIp.announcedIp.empty())
+			this->tuple->SetLocalAnnouncedIp(this->listenIp.announcedIp);
+
+		// Tell the parent class.
+		RTC::Transport::Connected();
+	}
+
+	void PipeTransport::OnTcpDisconnected()
+	{
+		MS_TRACE();
+
+		MS_DEBUG_TAG(info, "TCP connection closed [role:%s]", this->tcpRole.c_str());
+
+		delete this->tuple;
+		this->tuple = nullptr;
+
+		// Tell the parent class.
+		RTC::Transport::Disconnected();
+	}
+
 	inline void PipeTransport::OnUdpSocketPacketReceived(
 	  RTC::UdpSocket* socket, const uint8_t* data, size_t len, const struct sockaddr* remoteAddr)
 	{
@@ -706,4 +1558,141 @@ namespace RTC
 
 		OnPacketReceived(&tuple, data, len);
 	}
+
+	inline void PipeTransport::OnMemoryPipePacketReceived(
+	  RTC::MemoryPipe* /*memoryPipe*/, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		OnPacketReceived(nullptr, data, len);
+	}
+
+	inline void PipeTransport::OnPipeTrunkSendFrame(
+	  RTC::PipeTrunk* /*pipeTrunk*/, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		SendToPeer(data, len);
+
+		// Increase send transmission.
+		RTC::Transport::DataSent(len);
+	}
+
+	inline void PipeTransport::OnPipeTrunkPacketReceived(
+	  RTC::PipeTrunk* /*pipeTrunk*/, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		// NOTE: The frame tuple already matched ours.
+		if (RTC::RTCP::Packet::IsRtcp(data, len))
+			OnRtcpDataReceived(this->tuple, data, len);
+		else if (RTC::RtpPacket::IsRtp(data, len))
+			OnRtpDataReceived(this->tuple, data, len);
+		else
+			MS_WARN_DEV("ignoring trunk packet of unknown type");
+	}
+
+	inline void PipeTransport::OnRtcTcpConnectionClosed(
+	  RTC::TcpServer* /*tcpServer*/, RTC::TcpConnection* connection)
+	{
+		MS_TRACE();
+
+		RTC::TransportTuple tuple(connection);
+
+		// The remote PipeTransport will connect again.
+		if (this->tuple && this->tuple->Compare(&tuple))
+			OnTcpDisconnected();
+	}
+
+	inline void PipeTransport::OnTcpConnectionPacketReceived(
+	  RTC::TcpConnection* connection, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		// In TCP server role, adopt the first connection from the remote IP.
+		// clang-format off
+		if (
+			!this->tuple &&
+			this->tcpRole == "server" &&
+			connection->GetPeerIp() == this->remoteIp
+		)
+		// clang-format on
+		{
+			OnTcpConnected(connection);
+		}
+
+		RTC::TransportTuple tuple(connection);
+
+		OnPacketReceived(&tuple, data, len);
+	}
+
+	inline void PipeTransport::OnTcpConnectionClosed(::TcpConnectionHandler* /*connection*/)
+	{
+		MS_TRACE();
+
+		if (this->tuple)
+			OnTcpDisconnected();
+
+		// NOTE: The connection notifies us as its very last action so it can be
+		// deleted here.
+		delete this->tcpClientConnection;
+		this->tcpClientConnection = nullptr;
+
+		if (!this->tcpReconnectTimer)
+			this->tcpReconnectTimer = new Timer(std::addressof(this->tcpReconnectTimerListener));
+
+		this->tcpReconnectTimer->Start(TcpReconnectDelayMs);
+	}
+
+	inline void PipeTransport::OnTcpConnectionConnected(::TcpConnectionHandler* connection)
+	{
+		MS_TRACE();
+
+		OnTcpConnected(static_cast<RTC::TcpConnection*>(connection));
+
+		// Let the remote PipeTransport adopt this connection.
+		if (this->trustedNetwork)
+		{
+			SendTrusted(TcpHello, sizeof(TcpHello), false);
+		}
+		else
+		{
+			SendToPeer(TcpHello, sizeof(TcpHello));
+
+			// Increase send transmission.
+			RTC::Transport::DataSent(sizeof(TcpHello));
+		}
+	}
+
+	inline void PipeTransport::OnUvTrunkPrepare()
+	{
+		MS_TRACE();
+
+		uv_prepare_stop(this->trunkPrepareHandle);
+
+		this->trunk->Flush();
+
+		// The socket may have already flushed its egress queue in this loop
+		// iteration, so send the frame now rather than in the next one.
+		this->udpSocket->FlushSendQueue();
+	}
+
+	/* Instance methods of the nested TcpReconnectTimerListener class. */
+
+	inline void PipeTransport::TcpReconnectTimerListener::OnTimer(Timer* timer)
+	{
+		MS_TRACE();
+
+		try
+		{
+			// This may throw.
+			this->pipeTransport->ConnectTcp();
+		}
+		catch (const MediaSoupError& error)
+		{
+			MS_WARN_TAG(info, "TCP reconnection failed: %s", error.what());
+
+			timer->Start(TcpReconnectDelayMs);
+		}
+	}
 } // namespace RTC
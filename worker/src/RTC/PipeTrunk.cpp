@@ -0,0 +1,310 @@
+#define MS_CLASS "RTC::PipeTrunk"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/PipeTrunk.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "Utils.hpp"
+#include <cstring> // std::memcpy()
+
+namespace RTC
+{
+	/* Static. */
+
+	// "MSTK". It cannot be confused with RTP, RTCP or SCTP (whose ports are
+	// always 5000 in a PipeTransport).
+	static constexpr uint32_t Magic{ 0x4D53544B };
+	static constexpr size_t AesKeyLength{ 16u };
+	static constexpr size_t NonceLength{ 12u };
+
+	static void computeNonce(const uint8_t* salt, uint64_t counter, uint8_t* nonce)
+	{
+		std::memcpy(nonce, salt, NonceLength);
+
+		for (size_t i{ 0u }; i < 8u; ++i)
+		{
+			nonce[NonceLength - 1 - i] ^= static_cast<uint8_t>(counter >> (8u * i));
+		}
+	}
+
+	/* Class methods. */
+
+	bool PipeTrunk::IsFrame(const uint8_t* data, size_t len)
+	{
+		return len >= PipeTrunk::HeaderSize && Utils::Byte::Get4Bytes(data, 0) == Magic;
+	}
+
+	/* Instance methods. */
+
+	PipeTrunk::PipeTrunk(Listener* listener, size_t maxFrameSize)
+	  : listener(listener), maxFrameSize(maxFrameSize), frame(maxFrameSize)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(
+		  maxFrameSize >= PipeTrunk::MinMaxFrameSize && maxFrameSize <= PipeTrunk::MaxMaxFrameSize,
+		  "invalid maxFrameSize");
+	}
+
+	PipeTrunk::~PipeTrunk()
+	{
+		MS_TRACE();
+
+		EVP_CIPHER_CTX_free(this->sendCtx);
+		EVP_CIPHER_CTX_free(this->recvCtx);
+	}
+
+	void PipeTrunk::SetKeys(const uint8_t* sendKey, const uint8_t* recvKey)
+	{
+		MS_TRACE();
+
+		// Keys may be set again if a previous connection attempt failed.
+		EVP_CIPHER_CTX_free(this->sendCtx);
+		EVP_CIPHER_CTX_free(this->recvCtx);
+
+		this->recvCounterSet = false;
+
+		this->sendCtx = EVP_CIPHER_CTX_new();
+		this->recvCtx = EVP_CIPHER_CTX_new();
+
+		// clang-format off
+		if (
+			!this->sendCtx ||
+			!this->recvCtx ||
+			EVP_EncryptInit_ex(this->sendCtx, EVP_aes_128_gcm(), nullptr, sendKey, nullptr) != 1 ||
+			EVP_DecryptInit_ex(this->recvCtx, EVP_aes_128_gcm(), nullptr, recvKey, nullptr) != 1
+		)
+		// clang-format on
+		{
+			EVP_CIPHER_CTX_free(this->sendCtx);
+			this->sendCtx = nullptr;
+
+			EVP_CIPHER_CTX_free(this->recvCtx);
+			this->recvCtx = nullptr;
+
+			MS_THROW_ERROR("AES-128-GCM context initialization failed");
+		}
+
+		std::memcpy(this->sendSalt, sendKey + AesKeyLength, NonceLength);
+		std::memcpy(this->recvSalt, recvKey + AesKeyLength, NonceLength);
+	}
+
+	bool PipeTrunk::Send(const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		const size_t tagSize = HasKeys() ? PipeTrunk::TagSize : 0u;
+
+		// clang-format off
+		if (
+			len == 0u ||
+			len > 0xFFFF ||
+			PipeTrunk::HeaderSize + PipeTrunk::RecordHeaderSize + len + tagSize > this->maxFrameSize
+		)
+		// clang-format on
+		{
+			return false;
+		}
+
+		if (this->frameLen + PipeTrunk::RecordHeaderSize + len + tagSize > this->maxFrameSize)
+			Flush();
+
+		Utils::Byte::Set2Bytes(this->frame.data(), this->frameLen, static_cast<uint16_t>(len));
+		std::memcpy(this->frame.data() + this->frameLen + PipeTrunk::RecordHeaderSize, data, len);
+
+		this->frameLen += PipeTrunk::RecordHeaderSize + len;
+
+		++this->sentPackets;
+
+		return true;
+	}
+
+	void PipeTrunk::Flush()
+	{
+		MS_TRACE();
+
+		if (IsEmpty())
+			return;
+
+		uint8_t* data = this->frame.data();
+		size_t len    = this->frameLen;
+
+		Utils::Byte::Set4Bytes(data, 0, Magic);
+		Utils::Byte::Set8Bytes(data, 4, this->sendCounter);
+
+		if (HasKeys())
+		{
+			uint8_t nonce[NonceLength];
+			uint8_t* records = data + PipeTrunk::HeaderSize;
+			const int recordsLen{ static_cast<int>(len - PipeTrunk::HeaderSize) };
+			int outLen;
+
+			computeNonce(this->sendSalt, this->sendCounter, nonce);
+
+			// clang-format off
+			if (
+				EVP_EncryptInit_ex(this->sendCtx, nullptr, nullptr, nullptr, nonce) != 1 ||
+				EVP_EncryptUpdate(
+					this->sendCtx, nullptr, &outLen, data, static_cast<int>(PipeTrunk::HeaderSize)) != 1 ||
+				EVP_EncryptUpdate(this->sendCtx, records, &outLen, records, recordsLen) != 1 ||
+				EVP_EncryptFinal_ex(this->sendCtx, records + outLen, &outLen) != 1 ||
+				EVP_CIPHER_CTX_ctrl(
+					this->sendCtx,
+					EVP_CTRL_GCM_GET_TAG,
+					static_cast<int>(PipeTrunk::TagSize),
+					data + len) != 1
+			)
+			// clang-format on
+			{
+				MS_WARN_TAG(srtp, "frame encryption failed, discarding it");
+
+				this->frameLen = PipeTrunk::HeaderSize;
+
+				return;
+			}
+
+			len += PipeTrunk::TagSize;
+		}
+
+		// Reset the frame before notifying the listener.
+		this->frameLen = PipeTrunk::HeaderSize;
+
+		++this->sendCounter;
+		++this->sentFrames;
+
+		this->listener->OnPipeTrunkSendFrame(this, data, len);
+	}
+
+	bool PipeTrunk::ReceiveFrame(uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		if (!PipeTrunk::IsFrame(data, len))
+			return false;
+
+		const uint64_t counter = Utils::Byte::Get8Bytes(data, 4);
+		size_t recordsEnd      = len;
+
+		if (HasKeys())
+		{
+			if (len < PipeTrunk::HeaderSize + PipeTrunk::TagSize)
+			{
+				MS_WARN_TAG(srtp, "frame too short");
+
+				return false;
+			}
+
+			if (IsReplayed(counter))
+			{
+				MS_WARN_TAG(srtp, "replayed frame discarded [counter:%" PRIu64 "]", counter);
+
+				return false;
+			}
+
+			recordsEnd -= PipeTrunk::TagSize;
+
+			uint8_t nonce[NonceLength];
+			uint8_t* records = data + PipeTrunk::HeaderSize;
+			const int recordsLen{ static_cast<int>(recordsEnd - PipeTrunk::HeaderSize) };
+			int outLen;
+
+			computeNonce(this->recvSalt, counter, nonce);
+
+			// clang-format off
+			if (
+				EVP_DecryptInit_ex(this->recvCtx, nullptr, nullptr, nullptr, nonce) != 1 ||
+				EVP_DecryptUpdate(
+					this->recvCtx, nullptr, &outLen, data, static_cast<int>(PipeTrunk::HeaderSize)) != 1 ||
+				EVP_DecryptUpdate(this->recvCtx, records, &outLen, records, recordsLen) != 1 ||
+				EVP_CIPHER_CTX_ctrl(
+					this->recvCtx,
+					EVP_CTRL_GCM_SET_TAG,
+					static_cast<int>(PipeTrunk::TagSize),
+					data + recordsEnd) != 1 ||
+				EVP_DecryptFinal_ex(this->recvCtx, records + outLen, &outLen) != 1
+			)
+			// clang-format on
+			{
+				MS_WARN_TAG(srtp, "frame authentication failed [counter:%" PRIu64 "]", counter);
+
+				return false;
+			}
+
+			UpdateReplayWindow(counter);
+		}
+
+		size_t offset = PipeTrunk::HeaderSize;
+
+		while (offset < recordsEnd)
+		{
+			if (offset + PipeTrunk::RecordHeaderSize > recordsEnd)
+			{
+				MS_WARN_DEV("truncated record header");
+
+				return false;
+			}
+
+			const size_t packetLen = Utils::Byte::Get2Bytes(data, offset);
+
+			offset += PipeTrunk::RecordHeaderSize;
+
+			if (packetLen == 0u || offset + packetLen > recordsEnd)
+			{
+				MS_WARN_DEV("invalid record length [len:%zu]", packetLen);
+
+				return false;
+			}
+
+			this->listener->OnPipeTrunkPacketReceived(this, data + offset, packetLen);
+
+			offset += packetLen;
+		}
+
+		return true;
+	}
+
+	bool PipeTrunk::IsReplayed(uint64_t counter) const
+	{
+		MS_TRACE();
+
+		if (!this->recvCounterSet || counter > this->maxRecvCounter)
+			return false;
+
+		const uint64_t diff = this->maxRecvCounter - counter;
+
+		if (diff >= PipeTrunk::ReplayWindowSize)
+			return true;
+
+		return (this->replayWindow & (uint64_t{ 1u } << diff)) != 0u;
+	}
+
+	void PipeTrunk::UpdateReplayWindow(uint64_t counter)
+	{
+		MS_TRACE();
+
+		if (!this->recvCounterSet)
+		{
+			this->recvCounterSet = true;
+			this->maxRecvCounter = counter;
+			this->replayWindow   = 1u;
+
+			return;
+		}
+
+		if (counter > this->maxRecvCounter)
+		{
+			const uint64_t shift = counter - this->maxRecvCounter;
+
+			if (shift >= PipeTrunk::ReplayWindowSize)
+				this->replayWindow = 1u;
+			else
+				this->replayWindow = (this->replayWindow << shift) | 1u;
+
+			this->maxRecvCounter = counter;
+		}
+		else
+		{
+			this->replayWindow |= uint64_t{ 1u } << (this->maxRecvCounter - counter);
+		}
+	}
+} // namespace RTC
@@ -95,6 +95,60 @@ namespace RTC
 			this->comedia = jsonComediaIt->get<bool>();
 		}
 
+		bool sharedPort{ false };
+		auto jsonSharedPortIt = data.find("sharedPort");
+
+		if (jsonSharedPortIt != data.end())
+		{
+			if (!jsonSharedPortIt->is_boolean())
+				MS_THROW_TYPE_ERROR("wrong sharedPort (not a boolean)");
+
+			sharedPort = jsonSharedPortIt->get<bool>();
+
+			if (sharedPort && !this->rtcpMux)
+				MS_THROW_TYPE_ERROR("sharedPort requires rtcpMux");
+		}
+
+		auto jsonMulticastTtlIt       = data.find("multicastTtl");
+		auto jsonMulticastInterfaceIt = data.find("multicastInterface");
+
+		if (jsonMulticastTtlIt != data.end())
+		{
+			// clang-format off
+			if (
+				!Utils::Json::IsPositiveInteger(*jsonMulticastTtlIt) ||
+				jsonMulticastTtlIt->get<uint64_t>() == 0u ||
+				jsonMulticastTtlIt->get<uint64_t>() > 255u
+			)
+			// clang-format on
+			{
+				MS_THROW_TYPE_ERROR("wrong multicastTtl (not a number between 1 and 255)");
+			}
+
+			this->multicastTtl = jsonMulticastTtlIt->get<uint8_t>();
+		}
+
+		if (jsonMulticastInterfaceIt != data.end())
+		{
+			if (!jsonMulticastInterfaceIt->is_string())
+				MS_THROW_TYPE_ERROR("wrong multicastInterface (not a string)");
+
+			this->multicastInterface = jsonMulticastInterfaceIt->get<std::string>();
+
+			// This may throw.
+			Utils::IP::NormalizeIp(this->multicastInterface);
+		}
+
+		// The multicast group is given in connect() and the socket is not shared
+		// with other PlainTransports.
+		if (this->multicastTtl != 0u || !this->multicastInterface.empty())
+		{
+			if (this->comedia)
+				MS_THROW_TYPE_ERROR("multicastTtl and multicastInterface cannot be used with comedia");
+			else if (sharedPort)
+				MS_THROW_TYPE_ERROR("multicastTtl and multicastInterface cannot be used with sharedPort");
+		}
+
 		auto jsonEnableSrtpIt = data.find("enableSrtp");
 
 		// clang-format off
@@ -126,21 +180,43 @@ namespace RTC
 		try
 		{
 			// This may throw.
-			// This may throw.
-			if (port != 0)
+			if (sharedPort)
+			{
+				this->sharedUdpSocket = RTC::SharedUdpSocket::Acquire(this, this->listenIp.ip, port);
+				this->udpSocket       = this->sharedUdpSocket->GetUdpSocket();
+			}
+			else if (port != 0)
+			{
 				this->udpSocket = new RTC::UdpSocket(this, this->listenIp.ip, port);
+			}
 			else
+			{
 				this->udpSocket = new RTC::UdpSocket(this, this->listenIp.ip);
+			}
 
 			if (!this->rtcpMux)
 			{
 				// This may throw.
 				this->rtcpUdpSocket = new RTC::UdpSocket(this, this->listenIp.ip);
 			}
+
+			for (auto* udpSocket : { this->udpSocket, this->rtcpUdpSocket })
+			{
+				if (!udpSocket)
+					continue;
+
+				// These may throw.
+				if (this->multicastTtl != 0u)
+					udpSocket->SetMulticastTtl(this->multicastTtl);
+
+				if (!this->multicastInterface.empty())
+					udpSocket->SetMulticastInterface(this->multicastInterface);
+			}
 		}
 		catch (const MediaSoupError& error)
 		{
-			delete this->udpSocket;
+			if (!this->sharedUdpSocket)
+				delete this->udpSocket;
 			this->udpSocket = nullptr;
 
 			delete this->rtcpUdpSocket;
@@ -154,7 +230,15 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		delete this->udpSocket;
+		if (this->sharedUdpSocket)
+		{
+			RTC::SharedUdpSocket::Release(this->sharedUdpSocket, this);
+			this->sharedUdpSocket = nullptr;
+		}
+		else
+		{
+			delete this->udpSocket;
+		}
 		this->udpSocket = nullptr;
 
 		delete this->rtcpUdpSocket;
@@ -186,6 +270,16 @@ namespace RTC
 		// Add comedia.
 		jsonObject["comedia"] = this->comedia;
 
+		// Add sharedPort.
+		jsonObject["sharedPort"] = this->sharedUdpSocket != nullptr;
+
+		// Add multicastTtl and multicastInterface.
+		if (this->multicastTtl != 0u)
+			jsonObject["multicastTtl"] = this->multicastTtl;
+
+		if (!this->multicastInterface.empty())
+			jsonObject["multicastInterface"] = this->multicastInterface;
+
 		// Add tuple.
 		if (this->tuple)
 		{
@@ -280,6 +374,16 @@ namespace RTC
 		// Add rtcpTuple.
 		if (!this->rtcpMux && this->rtcpTuple)
 			this->rtcpTuple->FillJson(jsonObject["rtcpTuple"]);
+
+		// Add udpSocket.
+		this->udpSocket->FillJsonStats(jsonObject["udpSocket"]);
+
+		// Add rtcpUdpSocket.
+		if (!this->rtcpMux && this->rtcpUdpSocket)
+			this->rtcpUdpSocket->FillJsonStats(jsonObject["rtcpUdpSocket"]);
+
+		// Add ingressDrops.
+		this->ingressPolicer.FillJson(jsonObject["ingressDrops"]);
 	}
 
 	void PlainTransport::HandleRequest(Channel::ChannelRequest* request)
@@ -486,6 +590,17 @@ namespace RTC
 							}
 						}
 
+						// A multicast group is sent just by this PlainTransport.
+						// clang-format off
+						if (
+							this->sharedUdpSocket &&
+							Utils::IP::IsMulticast(reinterpret_cast<struct sockaddr*>(&this->remoteAddrStorage))
+						)
+						// clang-format on
+						{
+							MS_THROW_TYPE_ERROR("cannot connect to a multicast group with sharedPort");
+						}
+
 						// Create the tuple.
 						this->tuple = new RTC::TransportTuple(
 						  this->udpSocket, reinterpret_cast<struct sockaddr*>(&this->remoteAddrStorage));
@@ -493,6 +608,9 @@ namespace RTC
 						if (!this->listenIp.announcedIp.empty())
 							this->tuple->SetLocalAnnouncedIp(this->listenIp.announcedIp);
 
+						if (this->sharedUdpSocket)
+							this->sharedUdpSocket->BindTuple(this, this->tuple);
+
 						if (!this->rtcpMux)
 						{
 							switch (Utils::IP::GetFamily(ip))
@@ -541,6 +659,9 @@ namespace RTC
 				}
 				catch (const MediaSoupError& error)
 				{
+					if (this->sharedUdpSocket)
+						this->sharedUdpSocket->UnbindTuple(this);
+
 					delete this->tuple;
 					this->tuple = nullptr;
 
@@ -625,24 +746,46 @@ namespace RTC
 		if (!IsConnected())
 		{
 			if (cb)
-			{
 				(*cb)(false);
-				delete cb;
+
+			return;
+		}
+
+		auto intLen = static_cast<int>(packet->GetSize());
+
+		// If possible, encrypt the packet straight into the egress buffer of the
+		// socket so it's not copied again.
+		uint8_t* buffer{ nullptr };
+
+		if (HasSrtp())
+			buffer = this->tuple->GetSendBuffer(packet->GetSize() + RTC::SrtpSession::MaxTrailerSize);
+
+		if (buffer)
+		{
+			if (!this->srtpSendSession->EncryptRtp(packet->GetData(), &intLen, buffer))
+			{
+				if (cb)
+					(*cb)(false);
+
+				return;
 			}
 
+			auto len = static_cast<size_t>(intLen);
+
+			this->tuple->SendBuffer(len, cb);
+
+			// Increase send transmission.
+			RTC::Transport::DataSent(len);
+
 			return;
 		}
 
 		const uint8_t* data = packet->GetData();
-		auto intLen         = static_cast<int>(packet->GetSize());
 
 		if (HasSrtp() && !this->srtpSendSession->EncryptRtp(&data, &intLen))
 		{
 			if (cb)
-			{
 				(*cb)(false);
-				delete cb;
-			}
 
 			return;
 		}
@@ -751,6 +894,10 @@ namespace RTC
 		// Increase receive transmission.
 		RTC::Transport::DataReceived(len);
 
+		// Police it before parsing it.
+		if (!this->ingressPolicer.Police(tuple, len, DepLibUV::GetTimeMs()))
+			return;
+
 		// Check if it's RTCP.
 		if (RTC::RTCP::Packet::IsRtcp(data, len))
 		{
@@ -777,9 +924,29 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
+
 		if (HasSrtp() && !IsSrtpReady())
 			return;
 
+		// Drop packets from unknown tuples before decrypting and parsing them.
+		if (!this->tuple && !this->comedia)
+		{
+			MS_DEBUG_TAG(rtp, "ignoring RTP packet while not connected");
+
+			this->ingressPolicer.Drop(RTC::IngressPolicer::DropReason::UNKNOWN_TUPLE, len);
+
+			return;
+		}
+		else if (this->tuple && !this->tuple->Compare(tuple))
+		{
+			MS_DEBUG_TAG(rtp, "ignoring RTP packet from unknown IP:port");
+
+			this->ingressPolicer.Drop(RTC::IngressPolicer::DropReason::UNKNOWN_TUPLE, len);
+
+			return;
+		}
+
 		// Decrypt the SRTP packet.
 		auto intLen = static_cast<int>(len);
 
@@ -815,21 +982,9 @@ namespace RTC
 			return;
 		}
 
-		// If we don't have a RTP tuple yet, check whether comedia mode is set.
+		// If we don't have a RTP tuple yet, comedia mode is set.
 		if (!this->tuple)
 		{
-			if (!this->comedia)
-			{
-				MS_DEBUG_TAG(rtp, "ignoring RTP packet while not connected");
-
-				// Remove this SSRC.
-				RecvStreamClosed(packet->GetSsrc());
-
-				delete packet;
-
-				return;
-			}
-
 			MS_DEBUG_TAG(rtp, "setting RTP tuple (comedia mode enabled)");
 
 			auto wasConnected = IsConnected();
@@ -852,19 +1007,6 @@ namespace RTC
 				RTC::Transport::Connected();
 			}
 		}
-		// Otherwise, if RTP tuple is set, verify that it matches the origin
-		// of the packet.
-		else if (!this->tuple->Compare(tuple))
-		{
-			MS_DEBUG_TAG(rtp, "ignoring RTP packet from unknown IP:port");
-
-			// Remove this SSRC.
-			RecvStreamClosed(packet->GetSsrc());
-
-			delete packet;
-
-			return;
-		}
 
 		// Pass the packet to the parent transport.
 		RTC::Transport::ReceiveRtpPacket(packet);
@@ -875,9 +1017,31 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
+
 		if (HasSrtp() && !IsSrtpReady())
 			return;
 
+		const auto* rtcpTuple = this->rtcpMux ? this->tuple : this->rtcpTuple;
+
+		// Drop packets from unknown tuples before decrypting and parsing them.
+		if (!rtcpTuple && !this->comedia)
+		{
+			MS_DEBUG_TAG(rtcp, "ignoring RTCP packet while not connected");
+
+			this->ingressPolicer.Drop(RTC::IngressPolicer::DropReason::UNKNOWN_TUPLE, len);
+
+			return;
+		}
+		else if (rtcpTuple && !rtcpTuple->Compare(tuple))
+		{
+			MS_DEBUG_TAG(rtcp, "ignoring RTCP packet from unknown IP:port");
+
+			this->ingressPolicer.Drop(RTC::IngressPolicer::DropReason::UNKNOWN_TUPLE, len);
+
+			return;
+		}
+
 		// Decrypt the SRTCP packet.
 		auto intLen = static_cast<int>(len);
 
@@ -886,17 +1050,10 @@ namespace RTC
 			return;
 		}
 
-		// If we don't have a RTP tuple yet, check whether RTCP-mux and comedia
-		// mode are set.
+		// If we don't have a RTP tuple yet and RTCP-mux is set, comedia mode is
+		// set.
 		if (this->rtcpMux && !this->tuple)
 		{
-			if (!this->comedia)
-			{
-				MS_DEBUG_TAG(rtcp, "ignoring RTCP packet while not connected");
-
-				return;
-			}
-
 			MS_DEBUG_TAG(rtp, "setting RTP tuple (comedia mode enabled)");
 
 			auto wasConnected = IsConnected();
@@ -919,17 +1076,10 @@ namespace RTC
 				RTC::Transport::Connected();
 			}
 		}
-		// Otherwise, if RTCP-mux is unset and RTCP tuple is unset, set it if we
-		// are in comedia mode.
+		// Otherwise, if RTCP-mux is unset and RTCP tuple is unset, comedia mode
+		// is set.
 		else if (!this->rtcpMux && !this->rtcpTuple)
 		{
-			if (!this->comedia)
-			{
-				MS_DEBUG_TAG(rtcp, "ignoring RTCP packet while not connected");
-
-				return;
-			}
-
 			MS_DEBUG_TAG(rtcp, "setting RTCP tuple (comedia mode enabled)");
 
 			this->rtcpTuple = new RTC::TransportTuple(tuple);
@@ -944,20 +1094,11 @@ namespace RTC
 
 			Channel::ChannelNotifier::Emit(this->id, "rtcptuple", data);
 		}
-		// If RTCP-mux verify that the packet's tuple matches our RTP tuple.
-		else if (this->rtcpMux && !this->tuple->Compare(tuple))
-		{
-			MS_DEBUG_TAG(rtcp, "ignoring RTCP packet from unknown IP:port");
 
-			return;
-		}
-		// If no RTCP-mux verify that the packet's tuple matches our RTCP tuple.
-		else if (!this->rtcpMux && !this->rtcpTuple->Compare(tuple))
-		{
-			MS_DEBUG_TAG(rtcp, "ignoring RTCP packet from unknown IP:port");
+		MayCaptureRtcpPacket(RTC::PacketCapture::Direction::IN, data, static_cast<size_t>(intLen));
 
-			return;
-		}
+		// Parsed RTCP objects are released all together after being handled.
+		RTC::RTCP::Arena::Scope arenaScope;
 
 		RTC::RTCP::Packet* packet = RTC::RTCP::Packet::Parse(data, static_cast<size_t>(intLen));
 
@@ -984,6 +1125,8 @@ namespace RTC
 			{
 				MS_DEBUG_TAG(sctp, "ignoring SCTP packet while not connected");
 
+				this->ingressPolicer.Drop(RTC::IngressPolicer::DropReason::UNKNOWN_TUPLE, len);
+
 				return;
 			}
 
@@ -1015,6 +1158,8 @@ namespace RTC
 		{
 			MS_DEBUG_TAG(sctp, "ignoring SCTP packet from unknown IP:port");
 
+			this->ingressPolicer.Drop(RTC::IngressPolicer::DropReason::UNKNOWN_TUPLE, len);
+
 			return;
 		}
 
@@ -1031,4 +1176,38 @@ namespace RTC
 
 		OnPacketReceived(&tuple, data, len);
 	}
+
+	inline void PlainTransport::OnSharedUdpSocketPacketReceived(
+	  RTC::SharedUdpSocket* /*sharedUdpSocket*/,
+	  RTC::TransportTuple* tuple,
+	  const uint8_t* data,
+	  size_t len)
+	{
+		MS_TRACE();
+
+		OnPacketReceived(tuple, data, len);
+	}
+
+	inline bool PlainTransport::OnSharedUdpSocketClaimPacket(
+	  RTC::SharedUdpSocket* /*sharedUdpSocket*/, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		// Only comedia transports learn their tuple from received packets.
+		if (!this->comedia || this->tuple)
+			return false;
+
+		// Claim the packet if its SSRC (in clear even with SRTP) belongs to one
+		// of our Producers.
+		uint32_t ssrc;
+
+		if (RTC::RTCP::Packet::IsRtcp(data, len) && len >= 8u)
+			ssrc = Utils::Byte::Get4Bytes(data, 4);
+		else if (RTC::RtpPacket::IsRtp(data, len))
+			ssrc = Utils::Byte::Get4Bytes(data, 8);
+		else
+			return false;
+
+		return GetProducerBySsrc(ssrc) != nullptr;
+	}
 } // namespace RTC
@@ -7,8 +7,14 @@
 #include "MediaSoupErrors.hpp"
 #include "Settings.hpp"
 #include "Utils.hpp"
+#include <cerrno>
+#include <cstring> // std::strerror()
 #include <tuple>   // std:make_tuple()
 #include <utility> // std::piecewise_construct
+#ifdef __linux__
+#include <linux/filter.h> // struct sock_filter, struct sock_fprog
+#include <sys/socket.h>   // setsockopt(), SO_REUSEPORT, SO_ATTACH_REUSEPORT_CBPF
+#endif
 
 /* Static methods for UV callbacks. */
 
@@ -24,13 +30,71 @@ inline static void onFakeConnection(uv_stream_t* /*handle*/, int /*status*/)
 
 namespace RTC
 {
+	/* Static. */
+
+#ifdef __linux__
+	// Classic BPF program run by the kernel to pick the socket of the reuseport
+	// group that receives a datagram (offsets relative to the UDP payload).
+	// STUN requests whose first attribute is USERNAME are steered by the first
+	// char of the local ICE usernameFragment ([0-9a-z] for index 0 to 35, see
+	// WebRtcServer). Returning an index out of the group makes the kernel pick
+	// a socket by hash, but packets of ICE selected tuples never get here since
+	// the kernel prefers connected sockets.
+	// clang-format off
+	static struct sock_filter ReusePortSteeringCode[] =
+	{
+		// STUN messages start with 0x00 or 0x01.
+		BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 0),
+		BPF_JUMP(BPF_JMP | BPF_JGT | BPF_K, 0x01, 9, 0),
+		// Type of the first attribute must be USERNAME.
+		BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 20),
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0x0006, 0, 7),
+		// First char of the USERNAME value.
+		BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 24),
+		BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, 'a', 0, 2),
+		BPF_STMT(BPF_ALU | BPF_SUB | BPF_K, 'a' - 10),
+		BPF_STMT(BPF_RET | BPF_A, 0),
+		BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, '0', 0, 2),
+		BPF_STMT(BPF_ALU | BPF_SUB | BPF_K, '0'),
+		BPF_STMT(BPF_RET | BPF_A, 0),
+		// Not steerable.
+		BPF_STMT(BPF_RET | BPF_K, 0xFFFFFFFF)
+	};
+	// clang-format on
+#endif
+
 	/* Class variables. */
 
-	thread_local absl::flat_hash_map<std::string, std::vector<bool>> PortManager::mapUdpIpPorts;
-	thread_local absl::flat_hash_map<std::string, std::vector<bool>> PortManager::mapTcpIpPorts;
+	thread_local absl::flat_hash_map<std::string, PortManager::Ports> PortManager::mapUdpIpPorts;
+	thread_local absl::flat_hash_map<std::string, PortManager::Ports> PortManager::mapTcpIpPorts;
+	thread_local PortManager::TimerListener PortManager::poolTimerListener;
+	thread_local Timer* PortManager::poolTimer{ nullptr };
 
 	/* Class methods. */
 
+	void PortManager::ClosePools()
+	{
+		MS_TRACE();
+
+		delete PortManager::poolTimer;
+		PortManager::poolTimer = nullptr;
+
+		for (auto* mapIpPorts : { &PortManager::mapUdpIpPorts, &PortManager::mapTcpIpPorts })
+		{
+			for (auto& kv : *mapIpPorts)
+			{
+				auto& ports = kv.second;
+
+				for (auto* uvHandle : ports.pool)
+				{
+					uv_close(uvHandle, static_cast<uv_close_cb>(onClose));
+				}
+
+				ports.pool.clear();
+			}
+		}
+	}
+
 	uv_handle_t* PortManager::Bind(Transport transport, std::string& ip)
 	{
 		MS_TRACE();
@@ -38,14 +102,43 @@ namespace RTC
 		// First normalize the IP. This may throw if invalid IP.
 		Utils::IP::NormalizeIp(ip);
 
+		if (Settings::configuration.socketPoolSize > 0u)
+		{
+			Ports& ports = PortManager::GetPorts(transport, ip);
+
+			// Top up the pools in next loop iterations.
+			if (!PortManager::poolTimer)
+				PortManager::poolTimer = new Timer(std::addressof(PortManager::poolTimerListener));
+
+			if (!PortManager::poolTimer->IsActive())
+				PortManager::poolTimer->Start(0u);
+
+			if (!ports.pool.empty())
+			{
+				auto* uvHandle = ports.pool.front();
+
+				ports.pool.pop_front();
+				++ports.pooledBinds;
+
+				return uvHandle;
+			}
+		}
+
+		return BindFreePort(transport, ip);
+	}
+
+	uv_handle_t* PortManager::BindFreePort(Transport transport, std::string& ip)
+	{
+		MS_TRACE();
+
 		int err;
 		int family = Utils::IP::GetFamily(ip);
 		struct sockaddr_storage bindAddr; // NOLINT(cppcoreguidelines-pro-type-member-init)
 		size_t portIdx;
 		int flags{ 0 };
-		std::vector<bool>& ports = PortManager::GetPorts(transport, ip);
+		Ports& ports = PortManager::GetPorts(transport, ip);
 		size_t attempt{ 0u };
-		size_t numAttempts = ports.size();
+		size_t numAttempts = ports.freePortIdxs.size();
 		uv_handle_t* uvHandle{ nullptr };
 		uint16_t port;
 		std::string transportStr;
@@ -93,12 +186,8 @@ namespace RTC
 			}
 		}
 
-		// Choose a random port index to start from.
-		portIdx = static_cast<size_t>(Utils::Crypto::GetRandomUInt(
-		  static_cast<uint32_t>(0), static_cast<uint32_t>(ports.size() - 1)));
-
-		// Iterate all ports until getting one available. Fail if none found and also
-		// if bind() fails N times in theoretically available ports.
+		// Iterate the free ports until getting one that binds. Fail if bind()
+		// fails in all of them.
 		while (true)
 		{
 			// Increase attempt number.
@@ -114,10 +203,12 @@ namespace RTC
 				  numAttempts);
 			}
 
-			// Increase current port index.
-			portIdx = (portIdx + 1) % ports.size();
+			// Take the next free port.
+			portIdx = ports.freePortIdxs.front();
+
+			ports.freePortIdxs.pop_front();
 
-			// So the corresponding port is the vector position plus the RTC minimum port.
+			// So the corresponding port is the port index plus the RTC minimum port.
 			port = static_cast<uint16_t>(portIdx + Settings::configuration.rtcMinPort);
 
 			MS_DEBUG_DEV(
@@ -128,20 +219,6 @@ namespace RTC
 			  attempt,
 			  numAttempts);
 
-			// Check whether this port is not available.
-			if (ports[portIdx])
-			{
-				MS_DEBUG_DEV(
-				  "port in use, trying again [transport:%s, ip:'%s', port:%" PRIu16 ", attempt:%zu/%zu]",
-				  transportStr.c_str(),
-				  ip.c_str(),
-				  port,
-				  attempt,
-				  numAttempts);
-
-				continue;
-			}
-
 			// Here we already have a theoretically available port. Now let's check
 			// whether no other process is binding into it.
 
@@ -176,6 +253,8 @@ namespace RTC
 			{
 				delete uvHandle;
 
+				ports.freePortIdxs.push_front(portIdx);
+
 				switch (transport)
 				{
 					case Transport::UDP:
@@ -261,6 +340,10 @@ namespace RTC
 			// If it failed, close the handle and check the reason.
 			uv_close(reinterpret_cast<uv_handle_t*>(uvHandle), static_cast<uv_close_cb>(onClose));
 
+			// The port will be tried again once the others have been.
+			ports.freePortIdxs.push_back(portIdx);
+			++ports.bindFailures;
+
 			switch (err)
 			{
 				// If bind() fails due to "too many open files" just throw.
@@ -301,7 +384,8 @@ namespace RTC
 		}
 
 		// If here, we got an available port. Mark it as unavailable.
-		ports[portIdx] = true;
+		ports.SetUsed(portIdx, true);
+		++ports.numUsedPorts;
 
 		MS_DEBUG_DEV(
 		  "bind succeeded [transport:%s, ip:'%s', port:%" PRIu16 ", attempt:%zu/%zu]",
@@ -314,7 +398,12 @@ namespace RTC
 		return static_cast<uv_handle_t*>(uvHandle);
 	}
 
-	uv_handle_t* PortManager::Bind(Transport transport, std::string& ip, uint16_t port)
+	uv_handle_t* PortManager::Bind(
+	  Transport transport,
+	  std::string& ip,
+	  uint16_t port,
+	  bool reusePort,
+	  const struct sockaddr* remoteAddr)
 	{
 		MS_TRACE();
 
@@ -388,8 +477,12 @@ namespace RTC
 		{
 			case Transport::UDP:
 				uvHandle = reinterpret_cast<uv_handle_t*>(new uv_udp_t());
-				err      = uv_udp_init_ex(
-          DepLibUV::GetLoop(), reinterpret_cast<uv_udp_t*>(uvHandle), UV_UDP_RECVMMSG);
+				// With reusePort the socket must exist before binding it (giving the
+				// family creates it) so options can be set.
+				err = uv_udp_init_ex(
+				  DepLibUV::GetLoop(),
+				  reinterpret_cast<uv_udp_t*>(uvHandle),
+				  UV_UDP_RECVMMSG | (reusePort ? family : AF_UNSPEC));
 				break;
 
 			case Transport::TCP:
@@ -418,6 +511,20 @@ namespace RTC
 		{
 			case Transport::UDP:
 			{
+				if (reusePort)
+				{
+					try
+					{
+						SetReusePort(reinterpret_cast<uv_udp_t*>(uvHandle), !remoteAddr);
+					}
+					catch (const MediaSoupError& error)
+					{
+						uv_close(reinterpret_cast<uv_handle_t*>(uvHandle), static_cast<uv_close_cb>(onClose));
+
+						throw;
+					}
+				}
+
 				err = uv_udp_bind(
 				  reinterpret_cast<uv_udp_t*>(uvHandle),
 				  reinterpret_cast<const struct sockaddr*>(&bindAddr),
@@ -436,6 +543,22 @@ namespace RTC
 					  uv_strerror(err));
 				}
 
+				if (remoteAddr)
+				{
+					err = uv_udp_connect(reinterpret_cast<uv_udp_t*>(uvHandle), remoteAddr);
+
+					if (err != 0)
+					{
+						uv_close(reinterpret_cast<uv_handle_t*>(uvHandle), static_cast<uv_close_cb>(onClose));
+
+						MS_THROW_ERROR(
+						  "uv_udp_connect() failed [ip:'%s', port:%" PRIu16 "]: %s",
+						  ip.c_str(),
+						  port,
+						  uv_strerror(err));
+					}
+				}
+
 				break;
 			}
 
@@ -492,6 +615,39 @@ namespace RTC
 		return static_cast<uv_handle_t*>(uvHandle);
 	}
 
+	void PortManager::SetReusePort(uv_udp_t* uvHandle, bool steering)
+	{
+		MS_TRACE();
+
+#ifdef __linux__
+		uv_os_fd_t fd;
+		int err = uv_fileno(reinterpret_cast<uv_handle_t*>(uvHandle), &fd);
+
+		if (err != 0)
+			MS_THROW_ERROR("uv_fileno() failed: %s", uv_strerror(err));
+
+		const int on{ 1 };
+
+		if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0)
+			MS_THROW_ERROR("setsockopt(SO_REUSEPORT) failed: %s", std::strerror(errno));
+
+		if (!steering)
+			return;
+
+		struct sock_fprog prog; // NOLINT(cppcoreguidelines-pro-type-member-init)
+
+		prog.len    = sizeof(ReusePortSteeringCode) / sizeof(ReusePortSteeringCode[0]);
+		prog.filter = ReusePortSteeringCode;
+
+		// The program belongs to the reuseport group so it is replaced by the
+		// same one every time a socket joins it.
+		if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) != 0)
+			MS_THROW_ERROR("setsockopt(SO_ATTACH_REUSEPORT_CBPF) failed: %s", std::strerror(errno));
+#else
+		MS_THROW_TYPE_ERROR("reusePort not supported in this platform");
+#endif
+	}
+
 	void PortManager::Unbind(Transport transport, std::string& ip, uint16_t port)
 	{
 		MS_TRACE();
@@ -507,106 +663,116 @@ namespace RTC
 
 		size_t portIdx = static_cast<size_t>(port) - Settings::configuration.rtcMinPort;
 
-		switch (transport)
-		{
-			case Transport::UDP:
-			{
-				auto it = PortManager::mapUdpIpPorts.find(ip);
+		auto& mapIpPorts = PortManager::GetMapIpPorts(transport);
+		auto it          = mapIpPorts.find(ip);
 
-				if (it == PortManager::mapUdpIpPorts.end())
-					return;
+		if (it == mapIpPorts.end())
+			return;
 
-				auto& ports = it->second;
+		auto& ports = it->second;
 
-				// Mark the port as available.
-				ports[portIdx] = false;
+		// Not bound by Bind() with a random port.
+		if (!ports.IsUsed(portIdx))
+			return;
 
-				break;
-			}
+		// Mark the port as available.
+		ports.SetUsed(portIdx, false);
+		--ports.numUsedPorts;
+		ports.freePortIdxs.push_back(static_cast<uint16_t>(portIdx));
+	}
 
-			case Transport::TCP:
-			{
-				auto it = PortManager::mapTcpIpPorts.find(ip);
+	PortManager::Ports& PortManager::GetPorts(Transport transport, const std::string& ip)
+	{
+		MS_TRACE();
 
-				if (it == PortManager::mapTcpIpPorts.end())
-					return;
+		auto& mapIpPorts = PortManager::GetMapIpPorts(transport);
+		auto it          = mapIpPorts.find(ip);
 
-				auto& ports = it->second;
+		// If the IP is already handled, return its ports.
+		if (it != mapIpPorts.end())
+		{
+			auto& ports = it->second;
 
-				// Mark the port as available.
-				ports[portIdx] = false;
+			return ports;
+		}
 
-				break;
-			}
+		// Otherwise add an entry in the map and return it.
+		auto& ports = mapIpPorts[ip];
+
+		ports.numPorts = static_cast<size_t>(Settings::configuration.rtcMaxPort) -
+		                 Settings::configuration.rtcMinPort + 1;
+
+		// All ports are available.
+		ports.usedBitmap.resize((ports.numPorts + 63) / 64, 0u);
+
+		// Try them in order from a random one so different IPs and restarted
+		// workers do not pick the same ports.
+		const auto firstPortIdx = static_cast<size_t>(Utils::Crypto::GetRandomUInt(
+		  static_cast<uint32_t>(0), static_cast<uint32_t>(ports.numPorts - 1)));
+
+		for (size_t i{ 0u }; i < ports.numPorts; ++i)
+		{
+			ports.freePortIdxs.push_back(static_cast<uint16_t>((firstPortIdx + i) % ports.numPorts));
 		}
+
+		return ports;
 	}
 
-	std::vector<bool>& PortManager::GetPorts(Transport transport, const std::string& ip)
+	absl::flat_hash_map<std::string, PortManager::Ports>& PortManager::GetMapIpPorts(
+	  Transport transport)
 	{
 		MS_TRACE();
 
-		// Make GCC happy so it does not print:
-		// "control reaches end of non-void function [-Wreturn-type]"
-		static std::vector<bool> emptyPorts;
-
 		switch (transport)
 		{
 			case Transport::UDP:
-			{
-				auto it = PortManager::mapUdpIpPorts.find(ip);
-
-				// If the IP is already handled, return its ports vector.
-				if (it != PortManager::mapUdpIpPorts.end())
-				{
-					auto& ports = it->second;
-
-					return ports;
-				}
+				return PortManager::mapUdpIpPorts;
 
-				// Otherwise add an entry in the map and return it.
-				uint16_t numPorts =
-				  Settings::configuration.rtcMaxPort - Settings::configuration.rtcMinPort + 1;
+			case Transport::TCP:
+				return PortManager::mapTcpIpPorts;
+		}
 
-				// Emplace a new vector filled with numPorts false values, meaning that
-				// all ports are available.
-				auto pair = PortManager::mapUdpIpPorts.emplace(
-				  std::piecewise_construct, std::make_tuple(ip), std::make_tuple(numPorts, false));
+		// Make GCC happy so it does not print:
+		// "control reaches end of non-void function [-Wreturn-type]"
+		return PortManager::mapUdpIpPorts;
+	}
 
-				// pair.first is an iterator to the inserted value.
-				auto& ports = pair.first->second;
+	void PortManager::FillPools()
+	{
+		MS_TRACE();
 
-				return ports;
-			}
+		bool pending{ false };
 
-			case Transport::TCP:
+		// Bind one socket per IP and transport in each run so the loop is not
+		// blocked for long.
+		for (auto transport : { Transport::UDP, Transport::TCP })
+		{
+			for (auto& kv : PortManager::GetMapIpPorts(transport))
 			{
-				auto it = PortManager::mapTcpIpPorts.find(ip);
+				auto ip     = kv.first;
+				auto& ports = kv.second;
 
-				// If the IP is already handled, return its ports vector.
-				if (it != PortManager::mapTcpIpPorts.end())
-				{
-					auto& ports = it->second;
+				if (ports.pool.size() >= Settings::configuration.socketPoolSize)
+					continue;
 
-					return ports;
+				try
+				{
+					ports.pool.push_back(BindFreePort(transport, ip));
 				}
+				catch (const MediaSoupError& error)
+				{
+					MS_WARN_TAG(info, "could not bind pooled socket [ip:'%s']: %s", ip.c_str(), error.what());
 
-				// Otherwise add an entry in the map and return it.
-				uint16_t numPorts =
-				  Settings::configuration.rtcMaxPort - Settings::configuration.rtcMinPort + 1;
-
-				// Emplace a new vector filled with numPorts false values, meaning that
-				// all ports are available.
-				auto pair = PortManager::mapTcpIpPorts.emplace(
-				  std::piecewise_construct, std::make_tuple(ip), std::make_tuple(numPorts, false));
-
-				// pair.first is an iterator to the inserted value.
-				auto& ports = pair.first->second;
+					continue;
+				}
 
-				return ports;
+				if (ports.pool.size() < Settings::configuration.socketPoolSize)
+					pending = true;
 			}
 		}
 
-		return emptyPorts;
+		if (pending)
+			PortManager::poolTimer->Start(0u);
 	}
 
 	void PortManager::FillJson(json& jsonObject)
@@ -614,49 +780,83 @@ namespace RTC
 		MS_TRACE();
 
 		// Add udp.
-		jsonObject["udp"] = json::object();
-		auto jsonUdpIt    = jsonObject.find("udp");
+		FillJsonIpPorts(jsonObject["udp"], PortManager::mapUdpIpPorts);
 
-		for (auto& kv : PortManager::mapUdpIpPorts)
-		{
-			const auto& ip = kv.first;
-			auto& ports    = kv.second;
+		// Add tcp.
+		FillJsonIpPorts(jsonObject["tcp"], PortManager::mapTcpIpPorts);
+	}
 
-			(*jsonUdpIt)[ip] = json::array();
-			auto jsonIpIt    = jsonUdpIt->find(ip);
+	void PortManager::FillJsonUsage(json& jsonObject)
+	{
+		MS_TRACE();
 
-			for (size_t i{ 0 }; i < ports.size(); ++i)
-			{
-				if (!ports[i])
-					continue;
+		// Add udp.
+		FillJsonIpPortsUsage(jsonObject["udp"], PortManager::mapUdpIpPorts);
 
-				auto port = static_cast<uint16_t>(i + Settings::configuration.rtcMinPort);
+		// Add tcp.
+		FillJsonIpPortsUsage(jsonObject["tcp"], PortManager::mapTcpIpPorts);
+	}
 
-				jsonIpIt->push_back(port);
-			}
-		}
+	void PortManager::FillJsonIpPorts(
+	  json& jsonObject, const absl::flat_hash_map<std::string, Ports>& mapIpPorts)
+	{
+		MS_TRACE();
 
-		// Add tcp.
-		jsonObject["tcp"] = json::object();
-		auto jsonTcpIt    = jsonObject.find("tcp");
+		jsonObject = json::object();
 
-		for (auto& kv : PortManager::mapTcpIpPorts)
+		for (const auto& kv : mapIpPorts)
 		{
-			const auto& ip = kv.first;
-			auto& ports    = kv.second;
+			const auto& ip    = kv.first;
+			const auto& ports = kv.second;
 
-			(*jsonTcpIt)[ip] = json::array();
-			auto jsonIpIt    = jsonTcpIt->find(ip);
+			jsonObject[ip] = json::array();
+			auto jsonIpIt  = jsonObject.find(ip);
 
-			for (size_t i{ 0 }; i < ports.size(); ++i)
+			for (size_t wordIdx{ 0u }; wordIdx < ports.usedBitmap.size(); ++wordIdx)
 			{
-				if (!ports[i])
-					continue;
+				uint64_t word = ports.usedBitmap[wordIdx];
+
+				while (word != 0u)
+				{
+					const size_t portIdx = (wordIdx * 64) + Utils::Bits::CountTrailingZeros(word);
+					auto port = static_cast<uint16_t>(portIdx + Settings::configuration.rtcMinPort);
 
-				auto port = static_cast<uint16_t>(i + Settings::configuration.rtcMinPort);
+					jsonIpIt->emplace_back(port);
 
-				jsonIpIt->emplace_back(port);
+					// Clear the lowest set bit.
+					word &= word - 1;
+				}
 			}
 		}
 	}
+
+	void PortManager::FillJsonIpPortsUsage(
+	  json& jsonObject, const absl::flat_hash_map<std::string, Ports>& mapIpPorts)
+	{
+		MS_TRACE();
+
+		jsonObject = json::object();
+
+		for (const auto& kv : mapIpPorts)
+		{
+			const auto& ip    = kv.first;
+			const auto& ports = kv.second;
+			auto& jsonIp      = jsonObject[ip];
+
+			jsonIp["numPorts"]     = ports.numPorts;
+			jsonIp["numUsedPorts"] = ports.numUsedPorts;
+			jsonIp["utilization"] =
+			  ports.numPorts != 0u ? static_cast<double>(ports.numUsedPorts) / ports.numPorts : 0.0;
+			jsonIp["bindFailures"] = ports.bindFailures;
+			jsonIp["pooledSockets"] = ports.pool.size();
+			jsonIp["pooledBinds"]   = ports.pooledBinds;
+		}
+	}
+
+	inline void PortManager::TimerListener::OnTimer(Timer* /*timer*/)
+	{
+		MS_TRACE();
+
+		PortManager::FillPools();
+	}
 } // namespace RTC
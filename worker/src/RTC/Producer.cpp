@@ -5,13 +5,16 @@
 #include "DepLibUV.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Tracepoints.hpp"
 #include "Utils.hpp"
 #include "Channel/ChannelNotifier.hpp"
 #include "RTC/Codecs/Tools.hpp"
+#include "RTC/JoinLatency.hpp"
 #include "RTC/RTCP/FeedbackPs.hpp"
 #include "RTC/RTCP/FeedbackRtp.hpp"
 #include "RTC/RTCP/XrReceiverReferenceTime.hpp"
 #include <absl/container/inlined_vector.h>
+#include <algorithm> // std::find()
 #include <cstring>  // std::memcpy()
 #include <iterator> // std::ostream_iterator
 #include <sstream>  // std::ostringstream
@@ -21,6 +24,10 @@ namespace RTC
 	/* Static. */
 
 	static constexpr unsigned int SendNackDelay{ 10u }; // In ms.
+	// Streams with FEC wait for the FEC packet that closes the current group
+	// (sent at the latest at the end of the frame) before asking for a lost
+	// packet.
+	static constexpr unsigned int SendNackDelayWithFec{ 40u }; // In ms.
 
 	/* Instance methods. */
 
@@ -29,6 +36,8 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		this->createdAtMs = DepLibUV::GetTimeMs();
+
 		auto jsonKindIt = data.find("kind");
 
 		if (jsonKindIt == data.end() || !jsonKindIt->is_string())
@@ -212,6 +221,22 @@ namespace RTC
 			this->paused = jsonPausedIt->get<bool>();
 		}
 
+		auto jsonRelayPathIt = data.find("relayPath");
+
+		if (jsonRelayPathIt != data.end())
+		{
+			if (!jsonRelayPathIt->is_array())
+				MS_THROW_TYPE_ERROR("wrong relayPath (not an array)");
+
+			for (auto& routerId : *jsonRelayPathIt)
+			{
+				if (!routerId.is_string())
+					MS_THROW_TYPE_ERROR("wrong entry in relayPath (not a string)");
+
+				this->relayPath.push_back(routerId.get<std::string>());
+			}
+		}
+
 		// The number of encodings in rtpParameters must match the number of encodings
 		// in rtpMapping.
 		if (this->rtpParameters.encodings.size() != this->rtpMapping.encodings.size())
@@ -283,6 +308,58 @@ namespace RTC
 			{
 				this->rtpHeaderExtensionIds.absCaptureTime = exten.id;
 			}
+
+			if (this->rtpHeaderExtensionIds.dependencyDescriptor == 0u && exten.type == RTC::RtpHeaderExtensionUri::Type::DEPENDENCY_DESCRIPTOR)
+			{
+				this->rtpHeaderExtensionIds.dependencyDescriptor = exten.id;
+			}
+		}
+
+		// Map the ids of the header extensions kept in received packets so, if
+		// already laid out as needed, they are not rebuilt.
+		{
+			auto mapId = [this](uint8_t id, RTC::RtpHeaderExtensionUri::Type type)
+			{
+				if (id != 0u && id < this->mappedRtpHeaderExtensionIds.size())
+					this->mappedRtpHeaderExtensionIds[id] = static_cast<uint8_t>(type);
+			};
+
+			mapId(this->rtpHeaderExtensionIds.mid, RTC::RtpHeaderExtensionUri::Type::MID);
+
+			if (this->kind == RTC::Media::Kind::AUDIO)
+			{
+				mapId(
+				  this->rtpHeaderExtensionIds.ssrcAudioLevel,
+				  RTC::RtpHeaderExtensionUri::Type::SSRC_AUDIO_LEVEL);
+				mapId(
+				  this->rtpHeaderExtensionIds.absCaptureTime,
+				  RTC::RtpHeaderExtensionUri::Type::ABS_CAPTURE_TIME);
+			}
+			else if (this->kind == RTC::Media::Kind::VIDEO)
+			{
+				mapId(
+				  this->rtpHeaderExtensionIds.absSendTime, RTC::RtpHeaderExtensionUri::Type::ABS_SEND_TIME);
+				mapId(
+				  this->rtpHeaderExtensionIds.transportWideCc01,
+				  RTC::RtpHeaderExtensionUri::Type::TRANSPORT_WIDE_CC_01);
+				// NOTE: Remove this once framemarking draft becomes RFC.
+				mapId(
+				  this->rtpHeaderExtensionIds.frameMarking07,
+				  RTC::RtpHeaderExtensionUri::Type::FRAME_MARKING_07);
+				mapId(
+				  this->rtpHeaderExtensionIds.frameMarking,
+				  RTC::RtpHeaderExtensionUri::Type::FRAME_MARKING);
+				mapId(
+				  this->rtpHeaderExtensionIds.videoOrientation,
+				  RTC::RtpHeaderExtensionUri::Type::VIDEO_ORIENTATION);
+				mapId(this->rtpHeaderExtensionIds.toffset, RTC::RtpHeaderExtensionUri::Type::TOFFSET);
+				mapId(
+				  this->rtpHeaderExtensionIds.absCaptureTime,
+				  RTC::RtpHeaderExtensionUri::Type::ABS_CAPTURE_TIME);
+				mapId(
+				  this->rtpHeaderExtensionIds.dependencyDescriptor,
+				  RTC::RtpHeaderExtensionUri::Type::DEPENDENCY_DESCRIPTOR);
+			}
 		}
 
 		// Set the RTCP report generation interval.
@@ -308,6 +385,11 @@ namespace RTC
 			}
 
 			this->keyFrameRequestManager = new RTC::KeyFrameRequestManager(this, keyFrameRequestDelay);
+
+			auto jsonEnableKeyFrameCacheIt = data.find("enableKeyFrameCache");
+
+			if (jsonEnableKeyFrameCacheIt != data.end() && jsonEnableKeyFrameCacheIt->is_boolean())
+				this->enableKeyFrameCache = jsonEnableKeyFrameCacheIt->get<bool>();
 		}
 	}
 
@@ -327,11 +409,43 @@ namespace RTC
 		this->rtpStreamByEncodingIdx.clear();
 		this->rtpStreamScores.clear();
 		this->mapRtxSsrcRtpStream.clear();
+		this->mapFecSsrcRtpStream.clear();
 		this->mapRtpStreamMappedSsrc.clear();
 		this->mapMappedSsrcSsrc.clear();
 
+		// Delete all key frame caches.
+		for (auto& kv : this->mapRtpStreamKeyFrameCache)
+		{
+			auto* keyFrameCache = kv.second;
+
+			delete keyFrameCache;
+		}
+
+		this->mapRtpStreamKeyFrameCache.clear();
+
+		// Delete all reorder buffers.
+		for (auto& kv : this->mapRtpStreamReorderBuffer)
+		{
+			auto* rtpReorderBuffer = kv.second;
+
+			delete rtpReorderBuffer;
+		}
+
+		this->mapRtpStreamReorderBuffer.clear();
+
 		// Delete the KeyFrameRequestManager.
 		delete this->keyFrameRequestManager;
+
+		// Delete the TraceEventSampler.
+		delete this->traceEventSampler;
+	}
+
+	bool Producer::IsInRelayPath(const std::string& routerId) const
+	{
+		MS_TRACE();
+
+		return std::find(this->relayPath.begin(), this->relayPath.end(), routerId) !=
+		       this->relayPath.end();
 	}
 
 	void Producer::FillJson(json& jsonObject) const
@@ -420,6 +534,10 @@ namespace RTC
 		// Add paused.
 		jsonObject["paused"] = this->paused;
 
+		// Add relayPath.
+		if (!this->relayPath.empty())
+			jsonObject["relayPath"] = this->relayPath;
+
 		// Add traceEventTypes.
 		std::vector<std::string> traceEventTypes;
 		std::ostringstream traceEventTypesStream;
@@ -445,6 +563,10 @@ namespace RTC
 		}
 
 		jsonObject["traceEventTypes"] = traceEventTypesStream.str();
+
+		// Add trace event sampling options and buffered events.
+		if (this->traceEventSampler)
+			this->traceEventSampler->FillJson(jsonObject);
 	}
 
 	void Producer::FillJsonStats(json& jsonArray) const
@@ -461,6 +583,48 @@ namespace RTC
 			auto& jsonEntry = jsonArray[jsonArray.size() - 1];
 
 			rtpStream->FillJsonStats(jsonEntry);
+
+			if (!this->relayPath.empty())
+			{
+				// Add relayHops.
+				jsonEntry["relayHops"] = this->relayPath.size();
+				// Add hopLatency (one way latency of the last hop, in ms).
+				jsonEntry["hopLatency"] = rtpStream->GetRtt() / 2;
+			}
+
+			auto it = this->mapRtpStreamReorderBuffer.find(rtpStream);
+
+			// Add reorderBuffer.
+			if (it != this->mapRtpStreamReorderBuffer.end())
+			{
+				const auto* rtpReorderBuffer = it->second;
+
+				rtpReorderBuffer->FillJson(jsonEntry["reorderBuffer"]);
+			}
+
+			// Add joinLatency.
+			if (this->firstRtpReceivedAtMs != 0u)
+				jsonEntry["joinLatency"]["firstRtpMs"] = this->firstRtpReceivedAtMs - this->createdAtMs;
+		}
+	}
+
+	void Producer::FillStatsRecords(
+	  StatsRegion* statsRegion, const std::string& transportId, uint64_t nowMs) const
+	{
+		MS_TRACE();
+
+		for (auto* rtpStream : this->rtpStreamByEncodingIdx)
+		{
+			if (!rtpStream)
+				continue;
+
+			auto* record = statsRegion->AddRecord(
+			  StatsRegion::RecordType::PRODUCER_STREAM, this->id, transportId);
+
+			if (!record)
+				return;
+
+			rtpStream->FillStatsRecord(record, nowMs);
 		}
 	}
 
@@ -487,7 +651,21 @@ namespace RTC
 
 				FillJsonStats(data);
 
-				request->Accept(data);
+				auto jsonCursorIt = request->data.find("cursor");
+
+				// Just changed stats requested.
+				if (jsonCursorIt != request->data.end() && jsonCursorIt->is_number_unsigned())
+				{
+					json jsonDelta = json::object();
+
+					this->statsDelta.FillJson(jsonDelta, data, jsonCursorIt->get<uint64_t>());
+
+					request->Accept(jsonDelta);
+				}
+				else
+				{
+					request->Accept(data);
+				}
 
 				break;
 			}
@@ -509,6 +687,22 @@ namespace RTC
 					rtpStream->Pause();
 				}
 
+				// Cached key frames will be useless once resumed.
+				for (auto& kv : this->mapRtpStreamKeyFrameCache)
+				{
+					auto* keyFrameCache = kv.second;
+
+					keyFrameCache->Clear();
+				}
+
+				// Held packets would be dropped anyway.
+				for (auto& kv : this->mapRtpStreamReorderBuffer)
+				{
+					auto* rtpReorderBuffer = kv.second;
+
+					rtpReorderBuffer->Clear();
+				}
+
 				this->paused = true;
 
 				MS_DEBUG_DEV("Producer paused [producerId:%s]", this->id.c_str());
@@ -591,7 +785,13 @@ namespace RTC
 						newTraceEventTypes.fir = true;
 				}
 
-				this->traceEventTypes = newTraceEventTypes;
+				// This may throw.
+				auto* traceEventSampler = RTC::TraceEventSampler::Create(this->id, request->data);
+
+				delete this->traceEventSampler;
+
+				this->traceEventTypes   = newTraceEventTypes;
+				this->traceEventSampler = traceEventSampler;
 
 				request->Accept();
 
@@ -612,6 +812,18 @@ namespace RTC
 		// Reset current packet.
 		this->currentRtpPacket = nullptr;
 
+		// FEC packet.
+		{
+			auto it = this->mapFecSsrcRtpStream.find(packet->GetSsrc());
+
+			if (it != this->mapFecSsrcRtpStream.end())
+			{
+				ReceiveFecPacket(packet, it->second);
+
+				return ReceiveRtpPacketResult::FEC;
+			}
+		}
+
 		// Count number of RTP streams.
 		auto numRtpStreamsBefore = this->mapSsrcRtpStream.size();
 
@@ -621,12 +833,97 @@ namespace RTC
 		{
 			MS_WARN_TAG(rtp, "no stream found for received packet [ssrc:%" PRIu32 "]", packet->GetSsrc());
 
+			MS_TRACEPOINT(
+			  producer_packet_dropped,
+			  this->id.c_str(),
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  "no_stream");
+
 			return ReceiveRtpPacketResult::DISCARDED;
 		}
 
+		const bool isNewRtpStream = this->mapSsrcRtpStream.size() > numRtpStreamsBefore;
+
+		if (this->firstRtpReceivedAtMs == 0u)
+		{
+			this->firstRtpReceivedAtMs = DepLibUV::GetTimeMs();
+
+			RTC::JoinLatency::Record(
+			  RTC::JoinLatency::Phase::PRODUCER_FIRST_RTP,
+			  this->firstRtpReceivedAtMs - this->createdAtMs);
+		}
+
 		// Pre-process the packet.
 		PreProcessRtpPacket(packet);
 
+		// Media packet of a stream with reorder buffer.
+		if (packet->GetSsrc() == rtpStream->GetSsrc())
+		{
+			auto it = this->mapRtpStreamReorderBuffer.find(rtpStream);
+
+			if (it != this->mapRtpStreamReorderBuffer.end())
+			{
+				auto* rtpReorderBuffer = it->second;
+
+				// Held until the missing packets arrive (or the delay expires).
+				if (rtpReorderBuffer->Insert(packet))
+					return ReceiveRtpPacketResult::MEDIA;
+
+				auto result = ProcessRtpPacket(packet, rtpStream, isNewRtpStream);
+
+				// Process the held packets that follow this one.
+				rtpReorderBuffer->Drain();
+
+				return result;
+			}
+		}
+
+		return ProcessRtpPacket(packet, rtpStream, isNewRtpStream);
+	}
+
+	void Producer::ReceiveFecPacket(RTC::RtpPacket* packet, RTC::RtpStreamRecv* rtpStream)
+	{
+		MS_TRACE();
+
+		auto* recoveredPacket = rtpStream->ReceiveFecPacket(packet);
+
+		if (!recoveredPacket)
+			return;
+
+		MS_DEBUG_DEV(
+		  "packet recovered by FEC [ssrc:%" PRIu32 ", seq:%" PRIu16 "]",
+		  recoveredPacket->GetSsrc(),
+		  recoveredPacket->GetSequenceNumber());
+
+		// Route the recovered packet as if it had been received, so it's not
+		// NACKed and every Consumer gets it.
+		PreProcessRtpPacket(recoveredPacket);
+
+		auto it = this->mapRtpStreamReorderBuffer.find(rtpStream);
+
+		if (it != this->mapRtpStreamReorderBuffer.end())
+		{
+			auto* rtpReorderBuffer = it->second;
+
+			if (rtpReorderBuffer->Insert(recoveredPacket))
+				return;
+
+			ProcessRtpPacket(recoveredPacket, rtpStream, /*isNewRtpStream*/ false);
+
+			rtpReorderBuffer->Drain();
+
+			return;
+		}
+
+		ProcessRtpPacket(recoveredPacket, rtpStream, /*isNewRtpStream*/ false);
+	}
+
+	Producer::ReceiveRtpPacketResult Producer::ProcessRtpPacket(
+	  RTC::RtpPacket* packet, RTC::RtpStreamRecv* rtpStream, bool isNewRtpStream)
+	{
+		MS_TRACE();
+
 		ReceiveRtpPacketResult result;
 		bool isRtx{ false };
 
@@ -638,8 +935,15 @@ namespace RTC
 			// Process the packet.
 			if (!rtpStream->ReceivePacket(packet))
 			{
+				MS_TRACEPOINT(
+				  producer_packet_dropped,
+				  this->id.c_str(),
+				  packet->GetSsrc(),
+				  packet->GetSequenceNumber(),
+				  "invalid");
+
 				// May have to announce a new RTP stream to the listener.
-				if (this->mapSsrcRtpStream.size() > numRtpStreamsBefore)
+				if (isNewRtpStream)
 					NotifyNewRtpStream(rtpStream);
 
 				return result;
@@ -653,7 +957,16 @@ namespace RTC
 
 			// Process the packet.
 			if (!rtpStream->ReceiveRtxPacket(packet))
+			{
+				MS_TRACEPOINT(
+				  producer_packet_dropped,
+				  this->id.c_str(),
+				  packet->GetSsrc(),
+				  packet->GetSequenceNumber(),
+				  "invalid_rtx");
+
 				return result;
+			}
 		}
 		// Should not happen.
 		else
@@ -675,7 +988,7 @@ namespace RTC
 		}
 
 		// May have to announce a new RTP stream to the listener.
-		if (this->mapSsrcRtpStream.size() > numRtpStreamsBefore)
+		if (isNewRtpStream)
 		{
 			// Request a key frame for this stream since we may have lost the first packets
 			// (do not do it if this is a key frame).
@@ -693,20 +1006,43 @@ namespace RTC
 
 		// If paused stop here.
 		if (this->paused)
+		{
+			MS_TRACEPOINT(
+			  producer_packet_dropped,
+			  this->id.c_str(),
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  "paused");
+
 			return result;
+		}
 
 		// May emit 'trace' event.
 		EmitTraceEventRtpAndKeyFrameTypes(packet, isRtx);
 
 		// Mangle the packet before providing the listener with it.
 		if (!MangleRtpPacket(packet, rtpStream))
+		{
+			MS_TRACEPOINT(
+			  producer_packet_dropped,
+			  this->id.c_str(),
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  "mangle_failed");
+
 			return ReceiveRtpPacketResult::DISCARDED;
+		}
 
 		// Post-process the packet.
 		PostProcessRtpPacket(packet);
 
 		this->listener->OnProducerRtpPacketReceived(this, packet);
 
+		// Keep the packet if it belongs to the most recent key frame (or follows
+		// it).
+		if (this->enableKeyFrameCache)
+			this->mapRtpStreamKeyFrameCache.at(rtpStream)->ReceivePacket(packet);
+
 		return result;
 	}
 
@@ -834,6 +1170,46 @@ namespace RTC
 		this->keyFrameRequestManager->KeyFrameNeeded(ssrc);
 	}
 
+	size_t Producer::GetMemoryUsage() const
+	{
+		MS_TRACE();
+
+		size_t memoryUsage{ 0u };
+
+		for (const auto& kv : this->mapSsrcRtpStream)
+		{
+			auto* rtpStream = kv.second;
+
+			memoryUsage += rtpStream->GetMemoryUsage();
+		}
+
+		for (const auto& kv : this->mapRtpStreamKeyFrameCache)
+		{
+			auto* keyFrameCache = kv.second;
+
+			memoryUsage += keyFrameCache->GetMemoryUsage();
+		}
+
+		return memoryUsage;
+	}
+
+	RTC::KeyFrameCache* Producer::GetKeyFrameCache(uint32_t mappedSsrc) const
+	{
+		MS_TRACE();
+
+		if (!this->enableKeyFrameCache || this->paused)
+			return nullptr;
+
+		auto it = this->mapMappedSsrcSsrc.find(mappedSsrc);
+
+		if (it == this->mapMappedSsrcSsrc.end())
+			return nullptr;
+
+		auto* rtpStream = this->mapSsrcRtpStream.at(it->second);
+
+		return this->mapRtpStreamKeyFrameCache.at(rtpStream);
+	}
+
 	RTC::RtpStreamRecv* Producer::GetRtpStream(RTC::RtpPacket* packet)
 	{
 		MS_TRACE();
@@ -1142,8 +1518,22 @@ namespace RTC
 			}
 		}
 
+		const auto* fecCodec = this->rtpParameters.GetFecCodec();
+		const bool useFec    = fecCodec && encoding.hasFec;
+		auto sendNackDelay   = useFec ? SendNackDelayWithFec : SendNackDelay;
+
 		// Create a RtpStreamRecv for receiving a media stream.
-		auto* rtpStream = new RTC::RtpStreamRecv(this, params, SendNackDelay);
+		auto* rtpStream = new RTC::RtpStreamRecv(this, params, sendNackDelay);
+
+		// Recover lost packets with the FEC stream of the encoding (if any).
+		if (useFec)
+		{
+			MS_DEBUG_TAG(rtp, "FEC enabled [fecSsrc:%" PRIu32 "]", encoding.fec.ssrc);
+
+			rtpStream->SetFec(fecCodec->payloadType, encoding.fec.ssrc);
+
+			this->mapFecSsrcRtpStream[encoding.fec.ssrc] = rtpStream;
+		}
 
 		// Insert into the maps.
 		this->mapSsrcRtpStream[ssrc]              = rtpStream;
@@ -1154,6 +1544,17 @@ namespace RTC
 		this->mapRtpStreamMappedSsrc[rtpStream]             = encodingMapping.mappedSsrc;
 		this->mapMappedSsrcSsrc[encodingMapping.mappedSsrc] = ssrc;
 
+		// Create its key frame cache.
+		if (this->enableKeyFrameCache)
+			this->mapRtpStreamKeyFrameCache[rtpStream] = new RTC::KeyFrameCache(mediaCodec.mimeType);
+
+		// Create its reorder buffer.
+		if (this->rtpReorderDelay > 0u)
+		{
+			this->mapRtpStreamReorderBuffer[rtpStream] =
+			  new RTC::RtpReorderBuffer(this, this->rtpReorderDelay, params.useNack, sendNackDelay);
+		}
+
 		// If the Producer is paused tell it to the new RtpStreamRecv.
 		if (this->paused)
 			rtpStream->Pause();
@@ -1178,11 +1579,14 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		packet->SetAbsCaptureTimeExtensionId(this->rtpHeaderExtensionIds.absCaptureTime);
+
 		if (this->kind == RTC::Media::Kind::VIDEO)
 		{
 			// NOTE: Remove this once framemarking draft becomes RFC.
 			packet->SetFrameMarking07ExtensionId(this->rtpHeaderExtensionIds.frameMarking07);
 			packet->SetFrameMarkingExtensionId(this->rtpHeaderExtensionIds.frameMarking);
+			packet->SetDependencyDescriptorExtensionId(this->rtpHeaderExtensionIds.dependencyDescriptor);
 		}
 	}
 
@@ -1214,7 +1618,9 @@ namespace RTC
 			packet->SetSsrc(mappedSsrc);
 		}
 
-		// Mangle RTP header extensions.
+		// Mangle RTP header extensions. If they already have the layout of the
+		// rebuilt ones just map their ids in place.
+		if (!MapRtpHeaderExtensions(packet))
 		{
 			thread_local static uint8_t buffer[4096];
 			thread_local static std::vector<RTC::RtpPacket::GenericExtension> extensions;
@@ -1228,6 +1634,7 @@ namespace RTC
 			uint8_t* extenValue;
 			uint8_t extenLen;
 			uint8_t* bufferPtr{ buffer };
+			uint8_t extensionsType{ 1u };
 
 			// Add urn:ietf:params:rtp-hdrext:sdes:mid.
 			{
@@ -1253,6 +1660,21 @@ namespace RTC
 					  extenLen,
 					  bufferPtr);
 
+					bufferPtr += extenLen;
+				}
+
+				// Proxy http://www.webrtc.org/experiments/rtp-hdrext/abs-capture-time.
+				extenValue = packet->GetExtension(this->rtpHeaderExtensionIds.absCaptureTime, extenLen);
+
+				if (extenValue)
+				{
+					std::memcpy(bufferPtr, extenValue, extenLen);
+
+					extensions.emplace_back(
+					  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::ABS_CAPTURE_TIME),
+					  extenLen,
+					  bufferPtr);
+
 					// Not needed since this is the latest added extension.
 					// bufferPtr += extenLen;
 				}
@@ -1360,35 +1782,102 @@ namespace RTC
 					  extenLen,
 					  bufferPtr);
 
+					bufferPtr += extenLen;
+				}
+
+				// Proxy AV1 dependency descriptor.
+				extenValue =
+				  packet->GetExtension(this->rtpHeaderExtensionIds.dependencyDescriptor, extenLen);
+
+				if (extenValue)
+				{
+					std::memcpy(bufferPtr, extenValue, extenLen);
+
+					extensions.emplace_back(
+					  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::DEPENDENCY_DESCRIPTOR),
+					  extenLen,
+					  bufferPtr);
+
+					// Two-Bytes format is needed if it carries a template structure.
+					if (extenLen > 16u)
+						extensionsType = 2u;
+
 					// Not needed since this is the latest added extension.
 					// bufferPtr += extenLen;
 				}
 			}
 
-			// Set the new extensions into the packet using One-Byte format.
-			packet->SetExtensions(1, extensions);
-
-			// Assign mediasoup RTP header extension ids (just those that mediasoup may
-			// be interested in after passing it to the Router).
-			packet->SetMidExtensionId(static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::MID));
-			packet->SetAbsSendTimeExtensionId(
-			  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::ABS_SEND_TIME));
-			packet->SetTransportWideCc01ExtensionId(
-			  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::TRANSPORT_WIDE_CC_01));
-			// NOTE: Remove this once framemarking draft becomes RFC.
-			packet->SetFrameMarking07ExtensionId(
-			  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::FRAME_MARKING_07));
-			packet->SetFrameMarkingExtensionId(
-			  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::FRAME_MARKING));
-			packet->SetSsrcAudioLevelExtensionId(
-			  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::SSRC_AUDIO_LEVEL));
-			packet->SetVideoOrientationExtensionId(
-			  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::VIDEO_ORIENTATION));
+			// Set the new extensions into the packet using One-Byte format (unless
+			// some extension does not fit into it).
+			packet->SetExtensions(extensionsType, extensions);
 		}
 
+		// Assign mediasoup RTP header extension ids (just those that mediasoup may
+		// be interested in after passing it to the Router).
+		packet->SetMidExtensionId(static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::MID));
+		packet->SetAbsSendTimeExtensionId(
+		  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::ABS_SEND_TIME));
+		packet->SetTransportWideCc01ExtensionId(
+		  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::TRANSPORT_WIDE_CC_01));
+		// NOTE: Remove this once framemarking draft becomes RFC.
+		packet->SetFrameMarking07ExtensionId(
+		  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::FRAME_MARKING_07));
+		packet->SetFrameMarkingExtensionId(
+		  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::FRAME_MARKING));
+		packet->SetSsrcAudioLevelExtensionId(
+		  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::SSRC_AUDIO_LEVEL));
+		packet->SetVideoOrientationExtensionId(
+		  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::VIDEO_ORIENTATION));
+		packet->SetDependencyDescriptorExtensionId(
+		  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::DEPENDENCY_DESCRIPTOR));
+		packet->SetAbsCaptureTimeExtensionId(
+		  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::ABS_CAPTURE_TIME));
+
 		return true;
 	}
 
+	/**
+	 * Header extensions are rebuilt to keep just the ones the Router is
+	 * interested in, with MID space for any value and (video) placeholders for
+	 * abs-send-time and transport-wide-cc-01. If the packet already has that
+	 * layout (i.e. it comes from another mediasoup Router or the sender
+	 * includes all of them) its extension ids are just rewritten, if needed.
+	 */
+	inline bool Producer::MapRtpHeaderExtensions(RTC::RtpPacket* packet) const
+	{
+		MS_TRACE();
+
+		if (packet->GetExtensionAvailableLength(this->rtpHeaderExtensionIds.mid) < RTC::MidMaxLength)
+			return false;
+
+		if (this->kind == RTC::Media::Kind::VIDEO)
+		{
+			uint8_t extenLen;
+
+			// clang-format off
+			if (
+				!packet->GetExtension(this->rtpHeaderExtensionIds.absSendTime, extenLen) ||
+				extenLen != 3u
+			)
+			// clang-format on
+			{
+				return false;
+			}
+
+			// clang-format off
+			if (
+				!packet->GetExtension(this->rtpHeaderExtensionIds.transportWideCc01, extenLen) ||
+				extenLen != 2u
+			)
+			// clang-format on
+			{
+				return false;
+			}
+		}
+
+		return packet->MapOneByteExtensionIds(this->mappedRtpHeaderExtensionIds);
+	}
+
 	inline void Producer::PostProcessRtpPacket(RTC::RtpPacket* packet)
 	{
 		MS_TRACE();
@@ -1453,7 +1942,17 @@ namespace RTC
 			jsonEntry["score"] = rtpStream->GetScore();
 		}
 
-		Channel::ChannelNotifier::Emit(this->id, "score", data);
+		Channel::ChannelNotifier::EmitBatched(this->id, "score", data);
+	}
+
+	inline void Producer::EmitTraceEvent(json& data) const
+	{
+		MS_TRACE();
+
+		if (this->traceEventSampler)
+			this->traceEventSampler->Emit(data);
+		else
+			Channel::ChannelNotifier::Emit(this->id, "trace", data);
 	}
 
 	inline void Producer::EmitTraceEventRtpAndKeyFrameTypes(RTC::RtpPacket* packet, bool isRtx) const
@@ -1462,6 +1961,9 @@ namespace RTC
 
 		if (this->traceEventTypes.keyframe && packet->IsKeyFrame())
 		{
+			if (this->traceEventSampler && !this->traceEventSampler->Sample("keyframe"))
+				return;
+
 			json data = json::object();
 
 			data["type"]      = "keyframe";
@@ -1473,10 +1975,13 @@ namespace RTC
 			if (isRtx)
 				data["info"]["isRtx"] = true;
 
-			Channel::ChannelNotifier::Emit(this->id, "trace", data);
+			EmitTraceEvent(data);
 		}
 		else if (this->traceEventTypes.rtp)
 		{
+			if (this->traceEventSampler && !this->traceEventSampler->Sample("rtp", true))
+				return;
+
 			json data = json::object();
 
 			data["type"]      = "rtp";
@@ -1488,7 +1993,7 @@ namespace RTC
 			if (isRtx)
 				data["info"]["isRtx"] = true;
 
-			Channel::ChannelNotifier::Emit(this->id, "trace", data);
+			EmitTraceEvent(data);
 		}
 	}
 
@@ -1499,6 +2004,9 @@ namespace RTC
 		if (!this->traceEventTypes.pli)
 			return;
 
+		if (this->traceEventSampler && !this->traceEventSampler->Sample("pli"))
+			return;
+
 		json data = json::object();
 
 		data["type"]         = "pli";
@@ -1506,7 +2014,7 @@ namespace RTC
 		data["direction"]    = "out";
 		data["info"]["ssrc"] = ssrc;
 
-		Channel::ChannelNotifier::Emit(this->id, "trace", data);
+		EmitTraceEvent(data);
 	}
 
 	inline void Producer::EmitTraceEventFirType(uint32_t ssrc) const
@@ -1516,6 +2024,9 @@ namespace RTC
 		if (!this->traceEventTypes.fir)
 			return;
 
+		if (this->traceEventSampler && !this->traceEventSampler->Sample("fir"))
+			return;
+
 		json data = json::object();
 
 		data["type"]         = "fir";
@@ -1523,7 +2034,7 @@ namespace RTC
 		data["direction"]    = "out";
 		data["info"]["ssrc"] = ssrc;
 
-		Channel::ChannelNotifier::Emit(this->id, "trace", data);
+		EmitTraceEvent(data);
 	}
 
 	inline void Producer::EmitTraceEventNackType() const
@@ -1533,6 +2044,9 @@ namespace RTC
 		if (!this->traceEventTypes.nack)
 			return;
 
+		if (this->traceEventSampler && !this->traceEventSampler->Sample("nack"))
+			return;
+
 		json data = json::object();
 
 		data["type"]      = "nack";
@@ -1540,7 +2054,7 @@ namespace RTC
 		data["direction"] = "out";
 		data["info"]      = json::object();
 
-		Channel::ChannelNotifier::Emit(this->id, "trace", data);
+		EmitTraceEvent(data);
 	}
 
 	inline void Producer::OnRtpStreamScore(RTC::RtpStream* rtpStream, uint8_t score, uint8_t previousScore)
@@ -1640,4 +2154,19 @@ namespace RTC
 
 		rtpStream->RequestKeyFrame();
 	}
+
+	inline void Producer::OnRtpReorderBufferPacket(
+	  RTC::RtpReorderBuffer* /*rtpReorderBuffer*/, RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		auto it = this->mapSsrcRtpStream.find(packet->GetSsrc());
+
+		if (it == this->mapSsrcRtpStream.end())
+			return;
+
+		auto* rtpStream = it->second;
+
+		ProcessRtpPacket(packet, rtpStream, /*isNewRtpStream*/ false);
+	}
 } // namespace RTC
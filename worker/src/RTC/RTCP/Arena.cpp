@@ -0,0 +1,94 @@
+#define MS_CLASS "RTC::RTCP::Arena"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/RTCP/Arena.hpp"
+#include "Logger.hpp"
+#include <new> // ::operator new()
+
+namespace RTC
+{
+	namespace RTCP
+	{
+		/* Static. */
+
+		static constexpr size_t Alignment{ alignof(std::max_align_t) };
+
+		/* Class variables. */
+
+		alignas(std::max_align_t) thread_local uint8_t Arena::buffer[Arena::Size];
+		thread_local size_t Arena::offset{ 0u };
+		thread_local size_t Arena::openScopes{ 0u };
+		thread_local bool Arena::allocating{ false };
+
+		/* Class methods. */
+
+		void* Arena::Allocate(size_t size)
+		{
+			MS_TRACE();
+
+			if (Arena::allocating && Arena::openScopes > 0u)
+			{
+				const size_t alignedSize = (size + Alignment - 1) & ~(Alignment - 1);
+
+				if (Arena::offset + alignedSize <= Arena::Size)
+				{
+					auto* ptr = Arena::buffer + Arena::offset;
+
+					Arena::offset += alignedSize;
+
+					return ptr;
+				}
+
+				MS_DEBUG_DEV("arena full, allocating in the heap [size:%zu]", size);
+			}
+
+			return ::operator new(size);
+		}
+
+		void Arena::Free(void* ptr)
+		{
+			MS_TRACE();
+
+			// Memory of the arena is released when its Scope ends.
+			if (Arena::Contains(ptr))
+				return;
+
+			::operator delete(ptr);
+		}
+
+		/* Instance methods. */
+
+		Arena::Scope::Scope() : mark(Arena::offset), wasAllocating(Arena::allocating)
+		{
+			MS_TRACE();
+
+			++Arena::openScopes;
+
+			Arena::allocating = false;
+		}
+
+		Arena::Scope::~Scope()
+		{
+			MS_TRACE();
+
+			--Arena::openScopes;
+
+			Arena::offset     = this->mark;
+			Arena::allocating = this->wasAllocating;
+		}
+
+		Arena::AllocationScope::AllocationScope() : wasAllocating(Arena::allocating)
+		{
+			MS_TRACE();
+
+			Arena::allocating = true;
+		}
+
+		Arena::AllocationScope::~AllocationScope()
+		{
+			MS_TRACE();
+
+			Arena::allocating = this->wasAllocating;
+		}
+	} // namespace RTCP
+} // namespace RTC
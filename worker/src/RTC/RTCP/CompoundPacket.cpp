@@ -3,6 +3,7 @@
 
 #include "RTC/RTCP/CompoundPacket.hpp"
 #include "Logger.hpp"
+#include <cstring> // std::memcpy()
 
 namespace RTC
 {
@@ -39,6 +40,8 @@ namespace RTC
 			if (this->xrPacket.Begin() != this->xrPacket.End())
 				this->size += this->xrPacket.GetSize();
 
+			this->size += this->serializedPacketsLen;
+
 			// Fill it.
 			size_t offset{ 0 };
 
@@ -86,7 +89,10 @@ namespace RTC
 				offset += this->sdesPacket.Serialize(this->header + offset);
 
 			if (this->xrPacket.Begin() != this->xrPacket.End())
-				this->xrPacket.Serialize(this->header + offset);
+				offset += this->xrPacket.Serialize(this->header + offset);
+
+			if (this->serializedPacketsLen != 0u)
+				std::memcpy(this->header + offset, this->serializedPackets, this->serializedPacketsLen);
 		}
 
 		void CompoundPacket::Dump()
@@ -152,5 +158,15 @@ namespace RTC
 
 			this->xrPacket.AddReport(report);
 		}
+
+		void CompoundPacket::AddSerializedPackets(const uint8_t* data, size_t len)
+		{
+			MS_TRACE();
+
+			MS_ASSERT(!this->serializedPackets, "serialized packets are already present");
+
+			this->serializedPackets    = data;
+			this->serializedPacketsLen = len;
+		}
 	} // namespace RTCP
 } // namespace RTC
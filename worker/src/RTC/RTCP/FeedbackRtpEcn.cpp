@@ -9,6 +9,27 @@ namespace RTC
 {
 	namespace RTCP
 	{
+		FeedbackRtpEcnItem::FeedbackRtpEcnItem(
+		  uint32_t sequenceNumber,
+		  uint32_t ect0Counter,
+		  uint32_t ect1Counter,
+		  uint16_t ecnCeCounter,
+		  uint16_t notEctCounter,
+		  uint16_t lostPackets,
+		  uint16_t duplicatedPackets)
+		{
+			this->raw    = new uint8_t[HeaderSize];
+			this->header = reinterpret_cast<Header*>(this->raw);
+
+			this->header->sequenceNumber    = uint32_t{ htonl(sequenceNumber) };
+			this->header->ect0Counter       = uint32_t{ htonl(ect0Counter) };
+			this->header->ect1Counter       = uint32_t{ htonl(ect1Counter) };
+			this->header->ecnCeCounter      = uint16_t{ htons(ecnCeCounter) };
+			this->header->notEctCounter     = uint16_t{ htons(notEctCounter) };
+			this->header->lostPackets       = uint16_t{ htons(lostPackets) };
+			this->header->duplicatedPackets = uint16_t{ htons(duplicatedPackets) };
+		}
+
 		size_t FeedbackRtpEcnItem::Serialize(uint8_t* buffer)
 		{
 			MS_TRACE();
@@ -5,7 +5,9 @@
 #include "Logger.hpp"
 #include "Utils.hpp"
 #include "RTC/SeqManager.hpp"
-#include <limits> // std::numeric_limits()
+#include <algorithm> // std::min()
+#include <cstring>   // std::memcpy()
+#include <limits>    // std::numeric_limits()
 #include <sstream>
 
 // Code taken and adapted from libwebrtc (byte_io.h).
@@ -93,6 +95,33 @@ namespace RTC
 			return packet.release();
 		}
 
+		FeedbackRtpTransportPacket::Status FeedbackRtpTransportPacket::GetChunkStatus(
+		  uint16_t chunk, uint16_t symbolIdx)
+		{
+			// Run length chunk.
+			if ((chunk & 0x8000) == 0)
+				return static_cast<Status>((chunk >> 13) & 0x03);
+			// One bit vector chunk.
+			else if ((chunk & 0x4000) == 0)
+				return static_cast<Status>((chunk >> (14 - 1 - symbolIdx)) & 0x01);
+			// Two bit vector chunk.
+			else
+				return static_cast<Status>((chunk >> 2 * (7 - 1 - symbolIdx)) & 0x03);
+		}
+
+		uint16_t FeedbackRtpTransportPacket::GetChunkSymbolCount(uint16_t chunk)
+		{
+			// Run length chunk.
+			if ((chunk & 0x8000) == 0)
+				return chunk & 0x1FFF;
+			// One bit vector chunk.
+			else if ((chunk & 0x4000) == 0)
+				return 14u;
+			// Two bit vector chunk.
+			else
+				return 7u;
+		}
+
 		/* Instance methods. */
 
 		FeedbackRtpTransportPacket::FeedbackRtpTransportPacket(CommonHeader* commonHeader, size_t availableLen)
@@ -128,8 +157,10 @@ namespace RTC
 			                    FeedbackRtpTransportPacket::fixedHeaderSize;
 			size_t offset{ 0u };
 			uint16_t count{ 0u };
-			uint16_t receivedPacketStatusCount{ 0u };
+			size_t deltasLen{ 0u };
 
+			// Validate the chunks and compute the length of the deltas they need,
+			// without copying anything.
 			while (count < this->packetStatusCount && contentLen > offset)
 			{
 				if (contentLen - offset < 2u)
@@ -141,24 +172,71 @@ namespace RTC
 					return;
 				}
 
-				auto* chunk =
-				  Chunk::Parse(contentData + offset, contentLen - offset, this->packetStatusCount - count);
+				auto chunk       = Utils::Byte::Get2Bytes(contentData, offset);
+				auto symbolCount = GetChunkSymbolCount(chunk);
 
-				if (!chunk)
+				// Run length chunk.
+				if ((chunk & 0x8000) == 0)
 				{
-					MS_WARN_TAG(rtcp, "invalid chunk");
+					auto status = GetChunkStatus(chunk, 0u);
 
-					this->isCorrect = false;
+					switch (status)
+					{
+						case Status::SmallDelta:
+						{
+							this->receivedStatusCount += symbolCount;
+							deltasLen += symbolCount;
 
-					return;
+							break;
+						}
+
+						case Status::LargeDelta:
+						{
+							this->receivedStatusCount += symbolCount;
+							deltasLen += symbolCount * 2u;
+
+							break;
+						}
+
+						case Status::NotReceived:
+						{
+							break;
+						}
+
+						default:
+						{
+							MS_WARN_TAG(rtcp, "invalid chunk");
+
+							this->isCorrect = false;
+
+							return;
+						}
+					}
 				}
+				// Vector chunk.
+				else
+				{
+					symbolCount = std::min<uint16_t>(symbolCount, this->packetStatusCount - count);
 
-				this->chunks.push_back(chunk);
-				this->deltasAndChunksSize += 2u;
+					for (uint16_t symbolIdx{ 0u }; symbolIdx < symbolCount; ++symbolIdx)
+					{
+						auto status = GetChunkStatus(chunk, symbolIdx);
+
+						if (status == Status::SmallDelta)
+						{
+							this->receivedStatusCount++;
+							deltasLen += 1u;
+						}
+						else if (status == Status::LargeDelta)
+						{
+							this->receivedStatusCount++;
+							deltasLen += 2u;
+						}
+					}
+				}
 
 				offset += 2u;
-				count += chunk->GetCount();
-				receivedPacketStatusCount += chunk->GetReceivedStatusCount();
+				count += symbolCount;
 			}
 
 			if (count != this->packetStatusCount)
@@ -170,47 +248,20 @@ namespace RTC
 				return;
 			}
 
-			auto chunksIt = this->chunks.begin();
-
-			while (chunksIt != this->chunks.end() && contentLen > offset)
-			{
-				size_t deltasOffset{ 0u };
-				auto* chunk = *chunksIt;
-
-				if (!chunk->AddDeltas(contentData + offset, contentLen - offset, this->deltas, deltasOffset))
-				{
-					MS_WARN_TAG(rtcp, "not enough space for deltas");
-
-					this->isCorrect = false;
-
-					return;
-				}
-
-				offset += deltasOffset;
-				this->deltasAndChunksSize += deltasOffset;
-
-				++chunksIt;
-			}
-
-			if (this->deltas.size() != receivedPacketStatusCount)
+			if (contentLen - offset < deltasLen)
 			{
-				MS_WARN_TAG(rtcp, "received deltas does not match received status count");
+				MS_WARN_TAG(rtcp, "not enough space for deltas");
 
 				this->isCorrect = false;
 
 				return;
 			}
-		}
-
-		FeedbackRtpTransportPacket::~FeedbackRtpTransportPacket()
-		{
-			MS_TRACE();
 
-			for (auto* chunk : this->chunks)
-			{
-				delete chunk;
-			}
-			this->chunks.clear();
+			this->parsedChunks = contentData;
+			this->chunksLen    = offset;
+			this->parsedDeltas = contentData + offset;
+			this->deltasLen    = deltasLen;
+			this->deltaCount   = this->receivedStatusCount;
 		}
 
 		void FeedbackRtpTransportPacket::Dump() const
@@ -224,28 +275,50 @@ namespace RTC
 			MS_DUMP("  feedback packet count : %" PRIu8, this->feedbackPacketCount);
 			MS_DUMP("  size                  : %zu", GetSize());
 
-			for (auto* chunk : this->chunks)
+			MS_DUMP("  <Chunks>");
+			for (size_t offset{ 0u }; offset < this->chunksLen; offset += 2u)
 			{
-				chunk->Dump();
-			}
+				auto chunk = Utils::Byte::Get2Bytes(GetChunks(), offset);
+				std::ostringstream out;
 
-			MS_DUMP("  <Deltas>");
-			for (auto delta : this->deltas)
-			{
-				MS_DUMP("    %" PRIi16 " ms", static_cast<int16_t>(delta / 4));
+				for (uint16_t symbolIdx{ 0u }; symbolIdx < GetChunkSymbolCount(chunk) && symbolIdx < 14;
+				     ++symbolIdx)
+				{
+					out << "|" << FeedbackRtpTransportPacket::status2String[GetChunkStatus(chunk, symbolIdx)];
+				}
+
+				out << "|";
+
+				if ((chunk & 0x8000) == 0)
+				{
+					MS_DUMP(
+					  "    run length chunk (status:%s, count:%" PRIu16 ")",
+					  FeedbackRtpTransportPacket::status2String[GetChunkStatus(chunk, 0u)].c_str(),
+					  GetChunkSymbolCount(chunk));
+				}
+				else if ((chunk & 0x4000) == 0)
+				{
+					MS_DUMP("    one bit vector chunk %s", out.str().c_str());
+				}
+				else
+				{
+					MS_DUMP("    two bit vector chunk %s", out.str().c_str());
+				}
 			}
-			MS_DUMP("  </Deltas>");
+			MS_DUMP("  </Chunks>");
 
-			auto packetResults = GetPacketResults();
+			PacketResultsReader reader(this);
+			PacketResult packetResult;
 
 			MS_DUMP("  <PacketResults>");
-			for (auto& packetResult : packetResults)
+			while (reader.Read(packetResult))
 			{
 				if (packetResult.received)
 				{
 					MS_DUMP(
-					  "    seq:%" PRIu16 ", received:yes, receivedAtMs:%" PRIi64,
+					  "    seq:%" PRIu16 ", received:yes, delta:%" PRIi16 " ms, receivedAtMs:%" PRIi64,
 					  packetResult.sequenceNumber,
+					  static_cast<int16_t>(packetResult.delta / 4),
 					  packetResult.receivedAtMs);
 				}
 				else
@@ -283,26 +356,12 @@ namespace RTC
 			Utils::Byte::Set1Byte(buffer, offset, this->feedbackPacketCount);
 			offset += 1;
 
-			// Serialize chunks.
-			for (auto* chunk : this->chunks)
-			{
-				offset += chunk->Serialize(buffer + offset);
-			}
+			// Copy chunks and deltas, already serialized.
+			std::memcpy(buffer + offset, GetChunks(), this->chunksLen);
+			offset += this->chunksLen;
 
-			// Serialize deltas.
-			for (auto delta : this->deltas)
-			{
-				if (delta >= 0 && delta <= 255)
-				{
-					Utils::Byte::Set1Byte(buffer, offset, delta);
-					offset += 1u;
-				}
-				else
-				{
-					Utils::Byte::Set2Bytes(buffer, offset, delta);
-					offset += 2u;
-				}
-			}
+			std::memcpy(buffer + offset, GetDeltas(), this->deltasLen);
+			offset += this->deltasLen;
 
 			// 32 bits padding.
 			size_t padding = (-offset) & 3;
@@ -324,6 +383,9 @@ namespace RTC
 
 			MS_ASSERT(!IsFull(), "packet is full");
 
+			// Chunks and deltas are stored in fixed size buffers.
+			maxRtcpPacketLen = std::min(maxRtcpPacketLen, FeedbackRtpTransportPacket::MaxSize);
+
 			// Let's see if we must set our base.
 			if (this->latestTimestamp == 0u)
 			{
@@ -384,7 +446,7 @@ namespace RTC
 				size_t size = FeedbackRtpPacket::GetSize();
 
 				size += FeedbackRtpTransportPacket::fixedHeaderSize;
-				size += this->deltasAndChunksSize;
+				size += this->chunksLen + this->deltasLen;
 
 				// Maximum size needed for another chunk and its delta infos.
 				size += 2u;
@@ -418,33 +480,36 @@ namespace RTC
 			AddPendingChunks();
 		}
 
-		std::vector<struct FeedbackRtpTransportPacket::PacketResult> FeedbackRtpTransportPacket::GetPacketResults() const
+		void FeedbackRtpTransportPacket::Reset()
 		{
 			MS_TRACE();
 
-			std::vector<struct PacketResult> packetResults;
+			this->baseSequenceNumber   = 0u;
+			this->referenceTime        = 0;
+			this->latestSequenceNumber = 0u;
+			this->latestTimestamp      = 0u;
+			this->packetStatusCount    = 0u;
+			this->receivedStatusCount  = 0u;
+			this->chunksLen            = 0u;
+			this->deltasLen            = 0u;
+			this->deltaCount           = 0u;
+			this->context              = Context();
+			this->isCorrect            = true;
+		}
 
-			uint16_t currentSequenceNumber = this->baseSequenceNumber - 1;
+		std::vector<struct FeedbackRtpTransportPacket::PacketResult> FeedbackRtpTransportPacket::GetPacketResults() const
+		{
+			MS_TRACE();
 
-			for (auto* chunk : this->chunks)
-			{
-				chunk->FillResults(packetResults, currentSequenceNumber);
-			}
+			std::vector<struct PacketResult> packetResults;
+			PacketResultsReader reader(this);
+			PacketResult packetResult;
 
-			size_t deltaIdx{ 0u };
-			int64_t currentReceivedAtMs = static_cast<int64_t>(this->referenceTime * 64);
+			packetResults.reserve(this->packetStatusCount);
 
-			for (size_t idx{ 0u }; idx < packetResults.size(); ++idx)
+			while (reader.Read(packetResult))
 			{
-				auto& packetResult = packetResults[idx];
-
-				if (!packetResult.received)
-					continue;
-
-				currentReceivedAtMs += this->deltas.at(deltaIdx) / 4;
-				packetResult.delta        = this->deltas.at(deltaIdx);
-				packetResult.receivedAtMs = currentReceivedAtMs;
-				deltaIdx++;
+				packetResults.push_back(packetResult);
 			}
 
 			return packetResults;
@@ -455,16 +520,11 @@ namespace RTC
 			MS_TRACE();
 
 			uint16_t expected = this->packetStatusCount;
-			uint16_t lost{ 0u };
+			uint16_t lost     = this->packetStatusCount - this->receivedStatusCount;
 
 			if (expected == 0u)
 				return 0u;
 
-			for (auto* chunk : this->chunks)
-			{
-				lost += chunk->GetCount() - chunk->GetReceivedStatusCount();
-			}
-
 			// NOTE: If lost equals expected, the math below would produce 256, which
 			// becomes 0 in uint8_t.
 			if (lost == expected)
@@ -483,31 +543,31 @@ namespace RTC
 			if (missingPackets > 0)
 			{
 				// Create a long run chunk before processing this packet, if needed.
-				if (this->context.statuses.size() >= 7 && this->context.allSameStatus)
+				if (this->context.statusCount >= 7 && this->context.allSameStatus)
 				{
-					CreateRunLengthChunk(this->context.currentStatus, this->context.statuses.size());
+					CreateRunLengthChunk(this->context.currentStatus, this->context.statusCount);
 
-					this->context.statuses.clear();
+					this->context.statusCount   = 0u;
 					this->context.currentStatus = Status::None;
 				}
 
 				this->context.currentStatus = Status::NotReceived;
 				size_t representedPackets{ 0u };
 
-				// Fill statuses vector.
-				for (uint8_t i{ 0u }; i < missingPackets && this->context.statuses.size() < 7; ++i)
+				// Fill statuses.
+				for (uint8_t i{ 0u }; i < missingPackets && this->context.statusCount < 7; ++i)
 				{
-					this->context.statuses.emplace_back(Status::NotReceived);
+					this->context.statuses[this->context.statusCount++] = Status::NotReceived;
 					representedPackets++;
 				}
 
 				// Create a two bit vector if needed.
-				if (this->context.statuses.size() == 7)
+				if (this->context.statusCount == 7)
 				{
 					// Fill a vector chunk.
-					CreateTwoBitVectorChunk(this->context.statuses);
+					CreateTwoBitVectorChunk(this->context.statuses, this->context.statusCount);
 
-					this->context.statuses.clear();
+					this->context.statusCount   = 0u;
 					this->context.currentStatus = Status::None;
 				}
 
@@ -519,7 +579,7 @@ namespace RTC
 					// Fill a run length chunk with the remaining missing packets.
 					CreateRunLengthChunk(Status::NotReceived, missingPackets);
 
-					this->context.statuses.clear();
+					this->context.statusCount   = 0u;
 					this->context.currentStatus = Status::None;
 				}
 			}
@@ -534,20 +594,37 @@ namespace RTC
 			// Create a long run chunk before processing this packet, if needed.
 			// clang-format off
 			if (
-				this->context.statuses.size() >= 7 &&
+				this->context.statusCount >= 7 &&
 				this->context.allSameStatus &&
 				status != this->context.currentStatus
 			)
 			// clang-format on
 			{
-				CreateRunLengthChunk(this->context.currentStatus, this->context.statuses.size());
+				CreateRunLengthChunk(this->context.currentStatus, this->context.statusCount);
+
+				this->context.statusCount = 0u;
+			}
+
+			if (this->context.statusCount < 7)
+				this->context.statuses[this->context.statusCount] = status;
 
-				this->context.statuses.clear();
+			this->context.statusCount++;
+
+			// Serialize the delta.
+			MS_ASSERT(this->deltasLen + 2u <= FeedbackRtpTransportPacket::MaxSize, "no space for delta");
+
+			if (status == Status::SmallDelta)
+			{
+				Utils::Byte::Set1Byte(this->deltasBuffer, this->deltasLen, static_cast<uint8_t>(delta));
+				this->deltasLen += 1u;
+			}
+			else
+			{
+				Utils::Byte::Set2Bytes(this->deltasBuffer, this->deltasLen, static_cast<uint16_t>(delta));
+				this->deltasLen += 2u;
 			}
 
-			this->context.statuses.emplace_back(status);
-			this->deltas.push_back(delta);
-			this->deltasAndChunksSize += (status == Status::SmallDelta) ? 1u : 2u;
+			this->deltaCount++;
 
 			// Update context info.
 
@@ -568,493 +645,154 @@ namespace RTC
 			this->context.currentStatus = status;
 
 			// Not enough packet infos for creating a chunk.
-			if (this->context.statuses.size() < 7)
+			if (this->context.statusCount < 7)
 			{
 				return;
 			}
 			// 7 packet infos with heterogeneous status, create the chunk.
-			else if (this->context.statuses.size() == 7 && !this->context.allSameStatus)
+			else if (this->context.statusCount == 7 && !this->context.allSameStatus)
 			{
 				// Reset current status.
 				this->context.currentStatus = Status::None;
 
 				// Fill a vector chunk and return.
-				CreateTwoBitVectorChunk(this->context.statuses);
+				CreateTwoBitVectorChunk(this->context.statuses, this->context.statusCount);
 
-				this->context.statuses.clear();
+				this->context.statusCount = 0u;
 			}
 		}
 
 		void FeedbackRtpTransportPacket::CreateRunLengthChunk(Status status, uint16_t count)
 		{
-			auto* chunk = new RunLengthChunk(status, count);
-
-			this->chunks.push_back(chunk);
-			this->packetStatusCount += count;
-			this->deltasAndChunksSize += 2u;
-		}
-
-		void FeedbackRtpTransportPacket::CreateOneBitVectorChunk(std::vector<Status>& statuses)
-		{
-			auto* chunk = new OneBitVectorChunk(statuses);
-
-			this->chunks.push_back(chunk);
-			this->packetStatusCount += static_cast<uint16_t>(statuses.size());
-			this->deltasAndChunksSize += 2u;
-		}
-
-		void FeedbackRtpTransportPacket::CreateTwoBitVectorChunk(std::vector<Status>& statuses)
-		{
-			auto* chunk = new TwoBitVectorChunk(statuses);
+			MS_ASSERT(this->chunksLen + 2u <= FeedbackRtpTransportPacket::MaxSize, "no space for chunk");
 
-			this->chunks.push_back(chunk);
-			this->packetStatusCount += static_cast<uint16_t>(statuses.size());
-			this->deltasAndChunksSize += 2u;
-		}
+			uint16_t chunk{ 0x0000 };
 
-		void FeedbackRtpTransportPacket::AddPendingChunks()
-		{
-			// No pending status packets.
-			if (this->context.statuses.empty())
-				return;
+			chunk |= status << 13;
+			chunk |= count & 0x1FFF;
 
-			if (this->context.allSameStatus)
-			{
-				CreateRunLengthChunk(this->context.currentStatus, this->context.statuses.size());
-			}
-			else
-			{
-				MS_ASSERT(this->context.statuses.size() < 7, "already 7 status packets present");
+			Utils::Byte::Set2Bytes(this->chunksBuffer, this->chunksLen, chunk);
 
-				CreateTwoBitVectorChunk(this->context.statuses);
-			}
+			this->chunksLen += 2u;
+			this->packetStatusCount += count;
 
-			this->context.statuses.clear();
+			if (status == Status::SmallDelta || status == Status::LargeDelta)
+				this->receivedStatusCount += count;
 		}
 
-		FeedbackRtpTransportPacket::Chunk* FeedbackRtpTransportPacket::Chunk::Parse(
-		  const uint8_t* data, size_t len, uint16_t count)
+		void FeedbackRtpTransportPacket::CreateTwoBitVectorChunk(const Status* statuses, uint16_t count)
 		{
-			MS_TRACE();
-
-			if (len < 2u)
-			{
-				MS_WARN_TAG(rtcp, "not enough space for FeedbackRtpTransportPacket chunk, discarded");
+			MS_ASSERT(count <= 7, "packet info size must be 7 or less");
+			MS_ASSERT(this->chunksLen + 2u <= FeedbackRtpTransportPacket::MaxSize, "no space for chunk");
 
-				return nullptr;
-			}
-
-			auto bytes        = Utils::Byte::Get2Bytes(data, 0);
-			uint8_t chunkType = (bytes >> 15) & 0x01;
+			uint16_t chunk{ 0xC000 };
 
-			// Run length chunk.
-			if (chunkType == 0)
+			for (uint16_t i{ 0u }; i < count; ++i)
 			{
-				auto* chunk = new RunLengthChunk(bytes);
-
-				// Verify that the status is a valid one.
-				switch (chunk->GetStatus())
-				{
-					case Status::NotReceived:
-					case Status::SmallDelta:
-					case Status::LargeDelta:
-					{
-						return chunk;
-					}
-
-					default:
-					{
-						MS_WARN_DEV("invalid status for a run length chunk");
+				auto status = statuses[i];
 
-						delete chunk;
-
-						return nullptr;
-					}
-				}
-			}
-			// Vector chunk.
-			else
-			{
-				uint8_t symbolSize = data[0] & 0x40;
+				chunk |= status << 2 * (7 - 1 - i);
 
-				if (symbolSize == 0)
-					return new OneBitVectorChunk(bytes, count);
-				else
-					return new TwoBitVectorChunk(bytes, count);
+				if (status == Status::SmallDelta || status == Status::LargeDelta)
+					this->receivedStatusCount++;
 			}
 
-			return nullptr;
-		}
-
-		FeedbackRtpTransportPacket::RunLengthChunk::RunLengthChunk(uint16_t buffer)
-		{
-			MS_TRACE();
+			Utils::Byte::Set2Bytes(this->chunksBuffer, this->chunksLen, chunk);
 
-			this->status = static_cast<Status>((buffer >> 13) & 0x03);
-			this->count  = buffer & 0x1FFF;
+			this->chunksLen += 2u;
+			this->packetStatusCount += count;
 		}
 
-		bool FeedbackRtpTransportPacket::RunLengthChunk::AddDeltas(
-		  const uint8_t* data, size_t len, std::vector<int16_t>& deltas, size_t& offset)
+		void FeedbackRtpTransportPacket::AddPendingChunks()
 		{
-			MS_TRACE();
+			// No pending status packets.
+			if (this->context.statusCount == 0u)
+				return;
 
-			// No delta to be added.
-			if (this->status == Status::NotReceived)
-			{
-				return true;
-			}
-			else if (this->status == Status::SmallDelta)
+			if (this->context.allSameStatus)
 			{
-				if (len < this->count * 1u)
-				{
-					MS_WARN_TAG(rtcp, "not enough space for small deltas");
-
-					return false;
-				}
-
-				for (size_t i{ 0 }; i < this->count; ++i)
-				{
-					auto delta = static_cast<int16_t>(Utils::Byte::Get1Byte(data, offset));
-
-					deltas.push_back(delta);
-					offset += 1u;
-				}
+				CreateRunLengthChunk(this->context.currentStatus, this->context.statusCount);
 			}
-			else if (this->status == Status::LargeDelta)
+			else
 			{
-				if (len < this->count * 2u)
-				{
-					MS_WARN_TAG(rtcp, "not enough space for large deltas");
-
-					return false;
-				}
-
-				for (size_t i{ 0 }; i < this->count; ++i)
-				{
-					auto delta = static_cast<int16_t>(Utils::Byte::Get2Bytes(data, offset));
+				MS_ASSERT(this->context.statusCount < 7, "already 7 status packets present");
 
-					deltas.push_back(delta);
-					offset += 2u;
-				}
+				CreateTwoBitVectorChunk(this->context.statuses, this->context.statusCount);
 			}
 
-			return true;
-		}
-
-		void FeedbackRtpTransportPacket::RunLengthChunk::Dump() const
-		{
-			MS_TRACE();
-
-			MS_DUMP("  <RunLengthChunk>");
-			MS_DUMP("    status : %s", FeedbackRtpTransportPacket::status2String[this->status].c_str());
-			MS_DUMP("    count  : %" PRIu16, this->count);
-			MS_DUMP("  </RunLengthChunk>");
-		}
-
-		uint16_t FeedbackRtpTransportPacket::RunLengthChunk::GetReceivedStatusCount() const
-		{
-			MS_TRACE();
-
-			if (this->status == Status::SmallDelta || this->status == Status::LargeDelta)
-				return this->count;
-			else
-				return 0u;
-		}
-
-		void FeedbackRtpTransportPacket::RunLengthChunk::FillResults(
-		  std::vector<struct FeedbackRtpTransportPacket::PacketResult>& packetResults,
-		  uint16_t& currentSequenceNumber) const
-		{
-			MS_TRACE();
-
-			bool received = (this->status == Status::SmallDelta || this->status == Status::LargeDelta);
-
-			for (uint16_t count{ 1u }; count <= this->count; ++count)
-			{
-				packetResults.emplace_back(++currentSequenceNumber, received);
-			}
+			this->context.statusCount = 0u;
 		}
 
-		size_t FeedbackRtpTransportPacket::RunLengthChunk::Serialize(uint8_t* buffer)
+		FeedbackRtpTransportPacket::PacketResultsReader::PacketResultsReader(
+		  const FeedbackRtpTransportPacket* packet)
+		  : packet(packet), pendingStatusCount(packet->packetStatusCount),
+		    currentSequenceNumber(packet->baseSequenceNumber - 1),
+		    currentReceivedAtMs(static_cast<int64_t>(packet->referenceTime * 64))
 		{
 			MS_TRACE();
-
-			uint16_t bytes{ 0x0000 };
-
-			bytes |= this->status << 13;
-			bytes |= this->count & 0x1FFF;
-
-			Utils::Byte::Set2Bytes(buffer, 0, bytes);
-
-			return 2u;
 		}
 
-		FeedbackRtpTransportPacket::OneBitVectorChunk::OneBitVectorChunk(uint16_t buffer, uint16_t count)
+		bool FeedbackRtpTransportPacket::PacketResultsReader::Read(PacketResult& packetResult)
 		{
 			MS_TRACE();
 
-			MS_ASSERT(buffer & 0x8000, "invalid one bit vector chunk");
-
-			for (uint8_t i{ 0u }; i < 14 && count > 0; ++i, --count)
-			{
-				auto status = static_cast<Status>((buffer >> (14 - 1 - i)) & 0x01);
-
-				this->statuses.emplace_back(status);
-			}
-		}
-
-		bool FeedbackRtpTransportPacket::OneBitVectorChunk::AddDeltas(
-		  const uint8_t* data, size_t len, std::vector<int16_t>& deltas, size_t& offset)
-		{
-			MS_TRACE();
+			if (this->pendingStatusCount == 0u)
+				return false;
 
-			for (auto status : this->statuses)
+			// Move to the next chunk with symbols.
+			while (this->chunkSymbolIdx == this->chunkSymbolCount)
 			{
-				if (status == Status::NotReceived)
-				{
-					continue;
-				}
-				else if (status == Status::SmallDelta)
-				{
-					if (len < 1u)
-					{
-						MS_WARN_TAG(rtcp, "not enough space for small delta");
-
-						return false;
-					}
-
-					auto delta = static_cast<int16_t>(Utils::Byte::Get1Byte(data, offset));
-
-					deltas.push_back(delta);
-					offset += 1u;
-					len -= 1u;
-
-					continue;
-				}
-				else
-				{
-					MS_WARN_TAG(rtcp, "invalid status for one bit vector chunk");
-
+				if (this->chunksOffset + 2u > this->packet->chunksLen)
 					return false;
-				}
-			}
 
-			return true;
-		}
-
-		void FeedbackRtpTransportPacket::OneBitVectorChunk::Dump() const
-		{
-			MS_TRACE();
+				const auto* chunks = this->packet->GetChunks();
 
-			std::ostringstream out;
-
-			// Dump status slots.
-			for (auto status : this->statuses)
-			{
-				out << "|" << FeedbackRtpTransportPacket::status2String[status];
-			}
-
-			// Dump empty slots.
-			for (size_t i{ this->statuses.size() }; i < 14; ++i)
-			{
-				out << "|--";
+				this->chunk            = Utils::Byte::Get2Bytes(chunks, this->chunksOffset);
+				this->chunkSymbolIdx   = 0u;
+				this->chunkSymbolCount = FeedbackRtpTransportPacket::GetChunkSymbolCount(this->chunk);
+				this->chunksOffset += 2u;
 			}
 
-			out << "|";
+			auto status = FeedbackRtpTransportPacket::GetChunkStatus(this->chunk, this->chunkSymbolIdx);
 
-			MS_DUMP("  <OneBitVectorChunk>");
-			MS_DUMP("    %s", out.str().c_str());
-			MS_DUMP("  </OneBitVectorChunk>");
-		}
-
-		uint16_t FeedbackRtpTransportPacket::OneBitVectorChunk::GetReceivedStatusCount() const
-		{
-			MS_TRACE();
-
-			uint16_t count{ 0u };
+			this->chunkSymbolIdx++;
+			this->pendingStatusCount--;
 
-			for (auto status : this->statuses)
-			{
-				if (status == Status::SmallDelta || status == Status::LargeDelta)
-					count++;
-			}
+			packetResult.sequenceNumber = ++this->currentSequenceNumber;
+			packetResult.delta          = 0;
+			packetResult.received       = false;
+			packetResult.receivedAtMs   = 0;
 
-			return count;
-		}
+			if (status != Status::SmallDelta && status != Status::LargeDelta)
+				return true;
 
-		void FeedbackRtpTransportPacket::OneBitVectorChunk::FillResults(
-		  std::vector<struct FeedbackRtpTransportPacket::PacketResult>& packetResults,
-		  uint16_t& currentSequenceNumber) const
-		{
-			MS_TRACE();
+			const auto* deltas = this->packet->GetDeltas();
+			int16_t delta;
 
-			for (auto status : this->statuses)
+			if (status == Status::SmallDelta)
 			{
-				bool received = (status == Status::SmallDelta || status == Status::LargeDelta);
-
-				packetResults.emplace_back(++currentSequenceNumber, received);
-			}
-		}
-
-		size_t FeedbackRtpTransportPacket::OneBitVectorChunk::Serialize(uint8_t* buffer)
-		{
-			MS_TRACE();
-
-			MS_ASSERT(this->statuses.size() <= 14, "packet info size must be 14 or less");
-
-			uint16_t bytes{ 0x8000 };
-			uint8_t i{ 13u };
+				if (this->deltasOffset + 1u > this->packet->deltasLen)
+					return false;
 
-			for (auto status : this->statuses)
-			{
-				bytes |= status << i;
-				i -= 1;
+				delta = static_cast<int16_t>(Utils::Byte::Get1Byte(deltas, this->deltasOffset));
+				this->deltasOffset += 1u;
 			}
-
-			Utils::Byte::Set2Bytes(buffer, 0, bytes);
-
-			return 2u;
-		}
-
-		FeedbackRtpTransportPacket::TwoBitVectorChunk::TwoBitVectorChunk(uint16_t buffer, uint16_t count)
-		{
-			MS_TRACE();
-
-			MS_ASSERT(buffer & 0xC000, "invalid two bit vector chunk");
-
-			for (uint8_t i{ 0u }; i < 7 && count > 0; ++i, --count)
+			else
 			{
-				auto status = static_cast<Status>((buffer >> 2 * (7 - 1 - i)) & 0x03);
+				if (this->deltasOffset + 2u > this->packet->deltasLen)
+					return false;
 
-				this->statuses.emplace_back(status);
+				delta = static_cast<int16_t>(Utils::Byte::Get2Bytes(deltas, this->deltasOffset));
+				this->deltasOffset += 2u;
 			}
-		}
-
-		bool FeedbackRtpTransportPacket::TwoBitVectorChunk::AddDeltas(
-		  const uint8_t* data, size_t len, std::vector<int16_t>& deltas, size_t& offset)
-		{
-			MS_TRACE();
-
-			for (auto status : this->statuses)
-			{
-				if (status == Status::NotReceived)
-				{
-					continue;
-				}
-				else if (status == Status::SmallDelta)
-				{
-					if (len < 1u)
-					{
-						MS_WARN_TAG(rtcp, "not enough space for small delta");
-
-						return false;
-					}
-
-					auto delta = static_cast<int16_t>(Utils::Byte::Get1Byte(data, offset));
-
-					deltas.push_back(delta);
-					offset += 1u;
-					len -= 1u;
-
-					continue;
-				}
-				else if (status == Status::LargeDelta)
-				{
-					if (len < 2u)
-					{
-						MS_WARN_TAG(rtcp, "not enough space for large delta");
-
-						return false;
-					}
 
-					auto delta = static_cast<int16_t>(Utils::Byte::Get2Bytes(data, offset));
+			this->currentReceivedAtMs += delta / 4;
 
-					deltas.push_back(delta);
-					offset += 2u;
-					len -= 2u;
-
-					continue;
-				}
-			}
+			packetResult.delta        = delta;
+			packetResult.received     = true;
+			packetResult.receivedAtMs = this->currentReceivedAtMs;
 
 			return true;
 		}
-
-		void FeedbackRtpTransportPacket::TwoBitVectorChunk::Dump() const
-		{
-			MS_TRACE();
-
-			std::ostringstream out;
-
-			// Dump status slots.
-			for (auto status : this->statuses)
-			{
-				out << "|" << FeedbackRtpTransportPacket::status2String[status];
-			}
-
-			// Dump empty slots.
-			for (size_t i{ this->statuses.size() }; i < 7; ++i)
-			{
-				out << "|--";
-			}
-
-			out << "|";
-
-			MS_DUMP("  <TwoBitVectorChunk>");
-			MS_DUMP("    %s", out.str().c_str());
-			MS_DUMP("  </TwoBitVectorChunk>");
-		}
-
-		uint16_t FeedbackRtpTransportPacket::TwoBitVectorChunk::GetReceivedStatusCount() const
-		{
-			MS_TRACE();
-
-			uint16_t count{ 0u };
-
-			for (auto status : this->statuses)
-			{
-				if (status == Status::SmallDelta || status == Status::LargeDelta)
-					count++;
-			}
-
-			return count;
-		}
-
-		void FeedbackRtpTransportPacket::TwoBitVectorChunk::FillResults(
-		  std::vector<struct FeedbackRtpTransportPacket::PacketResult>& packetResults,
-		  uint16_t& currentSequenceNumber) const
-		{
-			MS_TRACE();
-
-			for (auto status : this->statuses)
-			{
-				bool received = (status == Status::SmallDelta || status == Status::LargeDelta);
-
-				packetResults.emplace_back(++currentSequenceNumber, received);
-			}
-		}
-
-		size_t FeedbackRtpTransportPacket::TwoBitVectorChunk::Serialize(uint8_t* buffer)
-		{
-			MS_TRACE();
-
-			MS_ASSERT(this->statuses.size() <= 7, "packet info size must be 7 or less");
-
-			uint16_t bytes{ 0x8000 };
-			uint8_t i{ 12u };
-
-			bytes |= 0x01 << 14;
-
-			for (auto status : this->statuses)
-			{
-				bytes |= status << i;
-				i -= 2;
-			}
-
-			Utils::Byte::Set2Bytes(buffer, 0, bytes);
-
-			return 2u;
-		}
 	} // namespace RTCP
 } // namespace RTC
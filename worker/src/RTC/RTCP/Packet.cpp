@@ -40,6 +40,9 @@ namespace RTC
 		{
 			MS_TRACE();
 
+			// Allocate the parsed objects in the arena if the caller opened a Scope.
+			Arena::AllocationScope allocationScope;
+
 			// First, Currently parsing and Last RTCP packets in the compound packet.
 			Packet* first{ nullptr };
 			Packet* current{ nullptr };
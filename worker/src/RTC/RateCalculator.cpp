@@ -12,7 +12,7 @@ namespace RTC
 		MS_TRACE();
 
 		// Ignore too old data. Should never happen.
-		if (nowMs < this->oldestItemStartTime)
+		if (this->usedItems != 0u && nowMs < this->newestItemStartTime)
 			return;
 
 		// Increase bytes.
@@ -21,16 +21,14 @@ namespace RTC
 		RemoveOldData(nowMs);
 
 		// If the elapsed time from the newest item start time is greater than the
-		// item size (in milliseconds), increase the item index.
-		if (this->newestItemIndex < 0 || nowMs - this->newestItemStartTime >= this->itemSizeMs)
+		// item size (in milliseconds), append a new item.
+		if (this->usedItems == 0u || nowMs - this->newestItemStartTime >= this->itemSizeMs)
 		{
-			this->newestItemIndex++;
-			this->newestItemStartTime = nowMs;
-			if (this->newestItemIndex >= this->windowItems)
-				this->newestItemIndex = 0;
+			if (this->buffer.empty())
+				this->buffer.resize(this->windowItems);
 
-			// Newest index overlaps with the oldest one, remove it.
-			if (this->newestItemIndex == this->oldestItemIndex && this->oldestItemIndex != -1)
+			// Buffer full, remove the oldest item.
+			if (this->usedItems == this->windowItems)
 			{
 				MS_WARN_TAG(
 				  info,
@@ -38,31 +36,36 @@ namespace RTC
 				  this->windowSizeMs,
 				  this->windowItems);
 
-				BufferItem& oldestItem = this->buffer[this->oldestItemIndex];
-				this->totalCount -= oldestItem.count;
-				oldestItem.count = 0u;
-				oldestItem.time  = 0u;
-				if (++this->oldestItemIndex >= this->windowItems)
-					this->oldestItemIndex = 0;
+				this->totalCount -= this->buffer[this->oldestItemIndex].count;
+
+				if (++this->oldestItemIndex == this->windowItems)
+					this->oldestItemIndex = 0u;
+
+				--this->usedItems;
 			}
 
+			size_t newestItemIndex = this->oldestItemIndex + this->usedItems;
+
+			if (newestItemIndex >= this->windowItems)
+				newestItemIndex -= this->windowItems;
+
 			// Set the newest item.
-			BufferItem& item = this->buffer[this->newestItemIndex];
-			item.count       = size;
-			item.time        = nowMs;
+			BufferItem& item = this->buffer[newestItemIndex];
+			item.count       = static_cast<uint32_t>(size);
+			item.time        = static_cast<uint32_t>(nowMs);
+
+			++this->usedItems;
+			this->newestItemStartTime = nowMs;
 		}
 		else
 		{
-			// Update the newest item.
-			BufferItem& item = this->buffer[this->newestItemIndex];
-			item.count += size;
-		}
+			size_t newestItemIndex = this->oldestItemIndex + this->usedItems - 1u;
 
-		// Set the oldest item index and time, if not set.
-		if (this->oldestItemIndex < 0)
-		{
-			this->oldestItemIndex     = this->newestItemIndex;
-			this->oldestItemStartTime = nowMs;
+			if (newestItemIndex >= this->windowItems)
+				newestItemIndex -= this->windowItems;
+
+			// Update the newest item.
+			this->buffer[newestItemIndex].count += static_cast<uint32_t>(size);
 		}
 
 		this->totalCount += size;
@@ -94,36 +97,30 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		// No item set.
-		if (this->newestItemIndex < 0 || this->oldestItemIndex < 0)
-			return;
-
-		uint64_t newoldestTime = nowMs - this->windowSizeMs;
-
-		// Oldest item already removed.
-		if (newoldestTime <= this->oldestItemStartTime)
+		// No item set or time going backwards.
+		if (this->usedItems == 0u || nowMs < this->newestItemStartTime)
 			return;
 
 		// A whole window size time has elapsed since last entry. Reset the buffer.
-		if (newoldestTime > this->newestItemStartTime)
+		if (nowMs - this->newestItemStartTime > this->windowSizeMs)
 		{
 			Reset();
 
 			return;
 		}
 
-		while (this->oldestItemStartTime < newoldestTime)
+		// Every item is now within 32 bits of time from nowMs, so the age of each
+		// one can be computed with wrapping 32 bit arithmetic.
+		auto now32 = static_cast<uint32_t>(nowMs);
+
+		while (now32 - this->buffer[this->oldestItemIndex].time > this->windowSizeMs)
 		{
-			BufferItem& oldestItem = this->buffer[this->oldestItemIndex];
-			this->totalCount -= oldestItem.count;
-			oldestItem.count = 0u;
-			oldestItem.time  = 0u;
+			this->totalCount -= this->buffer[this->oldestItemIndex].count;
 
-			if (++this->oldestItemIndex >= this->windowItems)
-				this->oldestItemIndex = 0;
+			if (++this->oldestItemIndex == this->windowItems)
+				this->oldestItemIndex = 0u;
 
-			const BufferItem& newOldestItem = this->buffer[this->oldestItemIndex];
-			this->oldestItemStartTime       = newOldestItem.time;
+			--this->usedItems;
 		}
 	}
 
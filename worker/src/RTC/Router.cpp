@@ -4,21 +4,72 @@
 #include "RTC/Router.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Metrics.hpp"
+#include "Settings.hpp"
 #include "Utils.hpp"
+#include "Channel/ChannelMessageWriter.hpp"
+#include "Channel/ChannelNotifier.hpp"
 #include "RTC/ActiveSpeakerObserver.hpp"
 #include "RTC/AudioLevelObserver.hpp"
 #include "RTC/DirectTransport.hpp"
 #include "RTC/PipeTransport.hpp"
 #include "RTC/PlainTransport.hpp"
 #include "RTC/WebRtcTransport.hpp"
+#include <absl/container/flat_hash_set.h>
+#include <algorithm>  // std::count_if(), std::find_if(), std::remove_if(), std::sort()
+#include <cstring>    // std::memcmp(), std::memcpy()
+#include <functional> // std::less
 
 namespace RTC
 {
+	/* Static. */
+
+	static constexpr uint64_t MemoryCheckIntervalMs{ 2000u };
+	// Transports closed per step of a deferred ROUTER_CLOSE_TRANSPORTS request.
+	static constexpr size_t CloseTransportsChunkSize{ 32u };
+
 	/* Instance methods. */
 
-	Router::Router(const std::string& id) : id(id)
+	Router::Router(Listener* listener, const std::string& id, json& data) : id(id), listener(listener)
 	{
 		MS_TRACE();
+
+		auto jsonAudioLastNIt = data.find("audioLastN");
+
+		if (jsonAudioLastNIt != data.end() && Utils::Json::IsPositiveInteger(*jsonAudioLastNIt))
+		{
+			auto audioLastN = jsonAudioLastNIt->get<size_t>();
+
+			if (audioLastN > 0u)
+				this->audioLastNSelector = new RTC::AudioLastNSelector(audioLastN);
+		}
+
+		auto jsonMemorySoftLimitIt = data.find("memorySoftLimit");
+
+		// clang-format off
+		if (
+			jsonMemorySoftLimitIt != data.end() &&
+			Utils::Json::IsPositiveInteger(*jsonMemorySoftLimitIt)
+		)
+		// clang-format on
+		{
+			this->memorySoftLimit = jsonMemorySoftLimitIt->get<size_t>();
+
+			if (this->memorySoftLimit > 0u)
+			{
+				this->memoryCheckTimer = new Timer(this);
+
+				this->memoryCheckTimer->Start(MemoryCheckIntervalMs, MemoryCheckIntervalMs);
+			}
+		}
+
+		// Limit the key frame requests sent to all our Producers if enabled in the
+		// Worker. Each Transport consumes from this budget too.
+		if (Settings::configuration.maxKeyFrameRequestsPerRouter > 0u)
+		{
+			this->keyFrameRequestBudget = new RTC::KeyFrameRequestScheduler::Budget(
+			  Settings::configuration.maxKeyFrameRequestsPerRouter, nullptr);
+		}
 	}
 
 	Router::~Router()
@@ -33,6 +84,7 @@ namespace RTC
 			delete transport;
 		}
 		this->mapTransports.clear();
+		this->transportHandles.Clear();
 
 		// Close all RtpObservers.
 		for (auto& kv : this->mapRtpObservers)
@@ -43,6 +95,18 @@ namespace RTC
 		}
 		this->mapRtpObservers.clear();
 
+		// Delete the memory check timer.
+		delete this->memoryCheckTimer;
+		this->memoryCheckTimer = nullptr;
+
+		// Delete the audio last N selector.
+		delete this->audioLastNSelector;
+		this->audioLastNSelector = nullptr;
+
+		// Delete the key frame request budget (no Transport uses it anymore).
+		delete this->keyFrameRequestBudget;
+		this->keyFrameRequestBudget = nullptr;
+
 		// Clear other maps.
 		this->mapProducerConsumers.clear();
 		this->mapConsumerProducer.clear();
@@ -53,112 +117,282 @@ namespace RTC
 		this->mapDataProducers.clear();
 	}
 
-	void Router::FillJson(json& jsonObject) const
+	void Router::FillJsonState(json& jsonObject) const
 	{
 		MS_TRACE();
 
 		// Add id.
 		jsonObject["id"] = this->id;
 
-		// Add transportIds.
-		jsonObject["transportIds"] = json::array();
-		auto jsonTransportIdsIt    = jsonObject.find("transportIds");
+		// Add transports.
+		jsonObject["transports"] = json::array();
+		auto jsonTransportsIt    = jsonObject.find("transports");
 
 		for (const auto& kv : this->mapTransports)
 		{
-			const auto& transportId = kv.first;
+			const auto* transport = kv.second;
 
-			jsonTransportIdsIt->emplace_back(transportId);
+			jsonTransportsIt->emplace_back(json::value_t::object);
+			transport->FillJsonState(jsonTransportsIt->back());
 		}
+	}
 
-		// Add rtpObserverIds.
-		jsonObject["rtpObserverIds"] = json::array();
-		auto jsonRtpObserverIdsIt    = jsonObject.find("rtpObserverIds");
+	void Router::FillJson(Channel::ChannelMessageWriter& writer, size_t page, size_t pageSize) const
+	{
+		MS_TRACE();
 
-		for (const auto& kv : this->mapRtpObservers)
+		// With pagination every collection lists its entries in
+		// [page * pageSize, (page + 1) * pageSize) in iteration order.
+		const size_t firstIdx = page * pageSize;
+		bool hasMore{ false };
+
+		auto getNumEntries = [firstIdx, pageSize, &hasMore](size_t size) -> size_t
 		{
-			const auto& rtpObserverId = kv.first;
+			if (pageSize == 0u)
+				return size;
 
-			jsonRtpObserverIdsIt->emplace_back(rtpObserverId);
-		}
+			if (size > firstIdx + pageSize)
+				hasMore = true;
 
-		// Add mapProducerIdConsumerIds.
-		jsonObject["mapProducerIdConsumerIds"] = json::object();
-		auto jsonMapProducerConsumersIt        = jsonObject.find("mapProducerIdConsumerIds");
+			if (size <= firstIdx)
+				return 0u;
 
-		for (const auto& kv : this->mapProducerConsumers)
-		{
-			auto* producer        = kv.first;
-			const auto& consumers = kv.second;
+			return std::min(size - firstIdx, pageSize);
+		};
 
-			(*jsonMapProducerConsumersIt)[producer->id] = json::array();
-			auto jsonProducerIdIt                       = jsonMapProducerConsumersIt->find(producer->id);
+		auto forEachInPage = [firstIdx, pageSize](const auto& container, const auto& fn)
+		{
+			size_t idx{ 0u };
 
-			for (auto* consumer : consumers)
+			for (const auto& kv : container)
 			{
-				jsonProducerIdIt->emplace_back(consumer->id);
+				if (pageSize != 0u && idx >= firstIdx + pageSize)
+					break;
+
+				if (idx++ >= firstIdx)
+					fn(kv);
 			}
-		}
+		};
 
-		// Add mapConsumerIdProducerId.
-		jsonObject["mapConsumerIdProducerId"] = json::object();
-		auto jsonMapConsumerProducerIt        = jsonObject.find("mapConsumerIdProducerId");
+		const size_t numTransports    = getNumEntries(this->mapTransports.size());
+		const size_t numRtpObservers  = getNumEntries(this->mapRtpObservers.size());
+		const size_t numProducers     = getNumEntries(this->mapProducerConsumers.size());
+		const size_t numConsumers     = getNumEntries(this->mapConsumerProducer.size());
+		const size_t numObserved      = getNumEntries(this->mapProducerRtpObservers.size());
+		const size_t numDataProducers = getNumEntries(this->mapDataProducerDataConsumers.size());
+		const size_t numDataConsumers = getNumEntries(this->mapDataConsumerDataProducer.size());
+		// Memory and CPU usage cover every transport so they are just in the
+		// first page.
+		const bool withUsage = pageSize == 0u || page == 0u;
+
+		writer.StartObject(8u + (withUsage ? 2u : 0u) + (pageSize != 0u ? 3u : 0u));
+
+		// Add id.
+		writer.Key("id");
+		writer.String(this->id);
+
+		// Add transportIds.
+		writer.Key("transportIds");
+		writer.StartArray(numTransports);
+
+		forEachInPage(this->mapTransports, [&writer](const auto& kv) { writer.String(kv.first); });
+
+		writer.EndArray();
+
+		// Add rtpObserverIds.
+		writer.Key("rtpObserverIds");
+		writer.StartArray(numRtpObservers);
+
+		forEachInPage(this->mapRtpObservers, [&writer](const auto& kv) { writer.String(kv.first); });
 
-		for (const auto& kv : this->mapConsumerProducer)
+		writer.EndArray();
+
+		if (withUsage)
 		{
-			auto* consumer = kv.first;
-			auto* producer = kv.second;
+			// Add memoryUsage.
+			json jsonMemoryUsage = json::object();
+
+			FillJsonMemoryUsage(jsonMemoryUsage);
 
-			(*jsonMapConsumerProducerIt)[consumer->id] = producer->id;
+			writer.Key("memoryUsage");
+			writer.Value(jsonMemoryUsage);
+
+			// Add cpuMsPerSecond.
+			writer.Key("cpuMsPerSecond");
+			writer.Double(GetCpuMsPerSecond());
 		}
 
+		// Add mapProducerIdConsumerIds.
+		writer.Key("mapProducerIdConsumerIds");
+		writer.StartObject(numProducers);
+
+		forEachInPage(
+		  this->mapProducerConsumers,
+		  [&writer](const auto& kv)
+		  {
+			  writer.Key(kv.first->id);
+			  writer.StartArray(kv.second.consumers.size());
+
+			  for (const auto& fanOutConsumer : kv.second.consumers)
+			  {
+				  writer.String(fanOutConsumer.consumer->id);
+			  }
+
+			  writer.EndArray();
+		  });
+
+		writer.EndObject();
+
+		// Add mapConsumerIdProducerId.
+		writer.Key("mapConsumerIdProducerId");
+		writer.StartObject(numConsumers);
+
+		forEachInPage(
+		  this->mapConsumerProducer,
+		  [&writer](const auto& kv)
+		  {
+			  writer.Key(kv.first->id);
+			  writer.String(kv.second->id);
+		  });
+
+		writer.EndObject();
+
 		// Add mapProducerIdObserverIds.
-		jsonObject["mapProducerIdObserverIds"] = json::object();
-		auto jsonMapProducerRtpObserversIt     = jsonObject.find("mapProducerIdObserverIds");
+		writer.Key("mapProducerIdObserverIds");
+		writer.StartObject(numObserved);
+
+		forEachInPage(
+		  this->mapProducerRtpObservers,
+		  [&writer](const auto& kv)
+		  {
+			  writer.Key(kv.first->id);
+			  writer.StartArray(kv.second.size());
 
-		for (const auto& kv : this->mapProducerRtpObservers)
+			  for (auto* rtpObserver : kv.second)
+			  {
+				  writer.String(rtpObserver->id);
+			  }
+
+			  writer.EndArray();
+		  });
+
+		writer.EndObject();
+
+		// Add mapDataProducerIdDataConsumerIds.
+		writer.Key("mapDataProducerIdDataConsumerIds");
+		writer.StartObject(numDataProducers);
+
+		forEachInPage(
+		  this->mapDataProducerDataConsumers,
+		  [&writer](const auto& kv)
+		  {
+			  writer.Key(kv.first->id);
+			  writer.StartArray(kv.second.size());
+
+			  for (auto* dataConsumer : kv.second)
+			  {
+				  writer.String(dataConsumer->id);
+			  }
+
+			  writer.EndArray();
+		  });
+
+		writer.EndObject();
+
+		// Add mapDataConsumerIdDataProducerId.
+		writer.Key("mapDataConsumerIdDataProducerId");
+		writer.StartObject(numDataConsumers);
+
+		forEachInPage(
+		  this->mapDataConsumerDataProducer,
+		  [&writer](const auto& kv)
+		  {
+			  writer.Key(kv.first->id);
+			  writer.String(kv.second->id);
+		  });
+
+		writer.EndObject();
+
+		if (pageSize != 0u)
 		{
-			auto* producer           = kv.first;
-			const auto& rtpObservers = kv.second;
+			// Add page.
+			writer.Key("page");
+			writer.UInt(page);
 
-			(*jsonMapProducerRtpObserversIt)[producer->id] = json::array();
-			auto jsonProducerIdIt = jsonMapProducerRtpObserversIt->find(producer->id);
+			// Add pageSize.
+			writer.Key("pageSize");
+			writer.UInt(pageSize);
 
-			for (auto* rtpObserver : rtpObservers)
-			{
-				jsonProducerIdIt->emplace_back(rtpObserver->id);
-			}
+			// Add hasMore.
+			writer.Key("hasMore");
+			writer.Bool(hasMore);
 		}
 
-		// Add mapDataProducerIdDataConsumerIds.
-		jsonObject["mapDataProducerIdDataConsumerIds"] = json::object();
-		auto jsonMapDataProducerDataConsumersIt = jsonObject.find("mapDataProducerIdDataConsumerIds");
+		writer.EndObject();
+	}
+
+	double Router::GetCpuMsPerSecond() const
+	{
+		MS_TRACE();
 
-		for (const auto& kv : this->mapDataProducerDataConsumers)
+		auto nowMs = DepLibUV::GetTimeMs();
+		double cpuMsPerSecond{ 0 };
+
+		for (const auto& kv : this->mapTransports)
 		{
-			auto* dataProducer        = kv.first;
-			const auto& dataConsumers = kv.second;
+			auto* transport = kv.second;
 
-			(*jsonMapDataProducerDataConsumersIt)[dataProducer->id] = json::array();
-			auto jsonDataProducerIdIt = jsonMapDataProducerDataConsumersIt->find(dataProducer->id);
+			cpuMsPerSecond += transport->GetCpuMsPerSecond(nowMs);
+		}
 
-			for (auto* dataConsumer : dataConsumers)
-			{
-				jsonDataProducerIdIt->emplace_back(dataConsumer->id);
-			}
+		return cpuMsPerSecond;
+	}
+
+	size_t Router::FillJsonMemoryUsage(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		size_t memoryUsage{ 0u };
+
+		// Add transports.
+		jsonObject["transports"] = json::object();
+		auto jsonTransportsIt    = jsonObject.find("transports");
+
+		for (const auto& kv : this->mapTransports)
+		{
+			const auto& transportId = kv.first;
+			auto* transport         = kv.second;
+
+			memoryUsage += transport->FillJsonMemoryUsage((*jsonTransportsIt)[transportId]);
 		}
 
-		// Add mapDataConsumerIdDataProducerId.
-		jsonObject["mapDataConsumerIdDataProducerId"] = json::object();
-		auto jsonMapDataConsumerDataProducerIt = jsonObject.find("mapDataConsumerIdDataProducerId");
+		// Add bytes.
+		jsonObject["bytes"] = memoryUsage;
 
-		for (const auto& kv : this->mapDataConsumerDataProducer)
+		// Add softLimit and pressure.
+		if (this->memorySoftLimit > 0u)
 		{
-			auto* dataConsumer = kv.first;
-			auto* dataProducer = kv.second;
+			jsonObject["softLimit"] = this->memorySoftLimit;
+			jsonObject["pressure"]  = this->memoryPressure;
+		}
+
+		return memoryUsage;
+	}
+
+	size_t Router::GetMemoryUsage() const
+	{
+		MS_TRACE();
 
-			(*jsonMapDataConsumerDataProducerIt)[dataConsumer->id] = dataProducer->id;
+		size_t memoryUsage{ 0u };
+
+		for (const auto& kv : this->mapTransports)
+		{
+			auto* transport = kv.second;
+
+			memoryUsage += transport->GetMemoryUsage();
 		}
+
+		return memoryUsage;
 	}
 
 	void Router::HandleRequest(Channel::ChannelRequest* request)
@@ -169,11 +403,21 @@ namespace RTC
 		{
 			case Channel::ChannelRequest::MethodId::ROUTER_DUMP:
 			{
-				json data = json::object();
+				// Optional pagination for routers with many objects.
+				size_t page{ 0u };
+				size_t pageSize{ 0u };
 
-				FillJson(data);
+				auto jsonPageIt     = request->data.find("page");
+				auto jsonPageSizeIt = request->data.find("pageSize");
 
-				request->Accept(data);
+				if (jsonPageIt != request->data.end() && jsonPageIt->is_number_unsigned())
+					page = jsonPageIt->get<size_t>();
+
+				if (jsonPageSizeIt != request->data.end() && jsonPageSizeIt->is_number_unsigned())
+					pageSize = jsonPageSizeIt->get<size_t>();
+
+				request->Accept([this, page, pageSize](Channel::ChannelMessageWriter& writer)
+				                { FillJson(writer, page, pageSize); });
 
 				break;
 			}
@@ -190,6 +434,7 @@ namespace RTC
 
 				// Insert into the map.
 				this->mapTransports[transportId] = webRtcTransport;
+				webRtcTransport->handle          = this->transportHandles.Add(webRtcTransport);
 
 				MS_DEBUG_DEV("WebRtcTransport created [transportId:%s]", transportId.c_str());
 
@@ -202,6 +447,97 @@ namespace RTC
 				break;
 			}
 
+			case Channel::ChannelRequest::MethodId::ROUTER_CREATE_WEBRTC_TRANSPORT_WITH_SERVER:
+			{
+				std::string transportId;
+
+				// This may throw.
+				SetNewTransportIdFromInternal(request->internal, transportId);
+
+				auto jsonWebRtcServerIdIt = request->data.find("webRtcServerId");
+
+				if (jsonWebRtcServerIdIt == request->data.end() || !jsonWebRtcServerIdIt->is_string())
+					MS_THROW_TYPE_ERROR("missing webRtcServerId");
+
+				std::string webRtcServerId = jsonWebRtcServerIdIt->get<std::string>();
+
+				auto* webRtcServer = this->listener->OnRouterNeedWebRtcServer(this, webRtcServerId);
+
+				if (!webRtcServer)
+					MS_THROW_ERROR("wrong webRtcServerId (no associated WebRtcServer found)");
+
+				bool enableUdp{ true };
+				auto jsonEnableUdpIt = request->data.find("enableUdp");
+
+				if (jsonEnableUdpIt != request->data.end())
+				{
+					if (!jsonEnableUdpIt->is_boolean())
+						MS_THROW_TYPE_ERROR("wrong enableUdp (not a boolean)");
+
+					enableUdp = jsonEnableUdpIt->get<bool>();
+				}
+
+				bool enableTcp{ false };
+				auto jsonEnableTcpIt = request->data.find("enableTcp");
+
+				if (jsonEnableTcpIt != request->data.end())
+				{
+					if (!jsonEnableTcpIt->is_boolean())
+						MS_THROW_TYPE_ERROR("wrong enableTcp (not a boolean)");
+
+					enableTcp = jsonEnableTcpIt->get<bool>();
+				}
+
+				bool preferUdp{ false };
+				auto jsonPreferUdpIt = request->data.find("preferUdp");
+
+				if (jsonPreferUdpIt != request->data.end())
+				{
+					if (!jsonPreferUdpIt->is_boolean())
+						MS_THROW_TYPE_ERROR("wrong preferUdp (not a boolean)");
+
+					preferUdp = jsonPreferUdpIt->get<bool>();
+				}
+
+				bool preferTcp{ false };
+				auto jsonPreferTcpIt = request->data.find("preferTcp");
+
+				if (jsonPreferTcpIt != request->data.end())
+				{
+					if (!jsonPreferTcpIt->is_boolean())
+						MS_THROW_TYPE_ERROR("wrong preferTcp (not a boolean)");
+
+					preferTcp = jsonPreferTcpIt->get<bool>();
+				}
+
+				auto iceCandidates =
+				  webRtcServer->GetIceCandidates(enableUdp, enableTcp, preferUdp, preferTcp);
+
+				// This may throw.
+				auto* webRtcTransport = new RTC::WebRtcTransport(
+				  transportId,
+				  this,
+				  webRtcServer,
+				  iceCandidates,
+				  webRtcServer->GetIceUsernameFragmentPrefix(),
+				  request->data);
+
+				// Insert into the map.
+				this->mapTransports[transportId] = webRtcTransport;
+				webRtcTransport->handle          = this->transportHandles.Add(webRtcTransport);
+
+				MS_DEBUG_DEV(
+				  "WebRtcTransport with WebRtcServer created [transportId:%s]", transportId.c_str());
+
+				json data = json::object();
+
+				webRtcTransport->FillJson(data);
+
+				request->Accept(data);
+
+				break;
+			}
+
 			case Channel::ChannelRequest::MethodId::ROUTER_CREATE_PLAIN_TRANSPORT:
 			{
 				std::string transportId;
@@ -213,6 +549,7 @@ namespace RTC
 
 				// Insert into the map.
 				this->mapTransports[transportId] = plainTransport;
+				plainTransport->handle           = this->transportHandles.Add(plainTransport);
 
 				MS_DEBUG_DEV("PlainTransport created [transportId:%s]", transportId.c_str());
 
@@ -236,6 +573,7 @@ namespace RTC
 
 				// Insert into the map.
 				this->mapTransports[transportId] = pipeTransport;
+				pipeTransport->handle            = this->transportHandles.Add(pipeTransport);
 
 				MS_DEBUG_DEV("PipeTransport created [transportId:%s]", transportId.c_str());
 
@@ -259,6 +597,7 @@ namespace RTC
 
 				// Insert into the map.
 				this->mapTransports[transportId] = directTransport;
+				directTransport->handle          = this->transportHandles.Add(directTransport);
 
 				MS_DEBUG_DEV("DirectTransport created [transportId:%s]", transportId.c_str());
 
@@ -278,11 +617,18 @@ namespace RTC
 				// This may throw.
 				SetNewRtpObserverIdFromInternal(request->internal, rtpObserverId);
 
-				auto* activeSpeakerObserver = new RTC::ActiveSpeakerObserver(rtpObserverId, request->data);
+				auto* activeSpeakerObserver =
+				  new RTC::ActiveSpeakerObserver(this, rtpObserverId, request->data);
 
 				// Insert into the map.
 				this->mapRtpObservers[rtpObserverId] = activeSpeakerObserver;
 
+				if (activeSpeakerObserver->GetVideoLastNPolicy())
+				{
+					this->mapRtpObserverVideoLastNPolicy[activeSpeakerObserver] =
+					  activeSpeakerObserver->GetVideoLastNPolicy();
+				}
+
 				MS_DEBUG_DEV("ActiveSpeakerObserver created [rtpObserverId:%s]", rtpObserverId.c_str());
 
 				request->Accept();
@@ -309,6 +655,25 @@ namespace RTC
 				break;
 			}
 
+			case Channel::ChannelRequest::MethodId::ROUTER_CREATE_AUDIO_MIXER:
+			{
+				std::string rtpObserverId;
+
+				// This may throw
+				SetNewRtpObserverIdFromInternal(request->internal, rtpObserverId);
+
+				auto* audioMixer = new RTC::AudioMixer(this, rtpObserverId, request->data);
+
+				// Insert into the map.
+				this->mapRtpObservers[rtpObserverId] = audioMixer;
+
+				MS_DEBUG_DEV("AudioMixer created [rtpObserverId:%s]", rtpObserverId.c_str());
+
+				request->Accept();
+
+				break;
+			}
+
 			case Channel::ChannelRequest::MethodId::TRANSPORT_CLOSE:
 			{
 				// This may throw.
@@ -320,6 +685,7 @@ namespace RTC
 
 				// Remove it from the map and delete it.
 				this->mapTransports.erase(transport->id);
+				this->transportHandles.Remove(transport->handle);
 
 				MS_DEBUG_DEV("Transport closed [transportId:%s]", transport->id.c_str());
 
@@ -331,6 +697,66 @@ namespace RTC
 				break;
 			}
 
+			case Channel::ChannelRequest::MethodId::ROUTER_CLOSE_TRANSPORTS:
+			{
+				auto jsonTransportIdsIt = request->data.find("transportIds");
+
+				if (jsonTransportIdsIt == request->data.end() || !jsonTransportIdsIt->is_array())
+					MS_THROW_TYPE_ERROR("missing transportIds");
+
+				std::vector<RTC::Transport*> transports;
+				absl::flat_hash_set<RTC::Transport*> seenTransports;
+
+				// Unknown (maybe already closed) Transports are ignored.
+				for (const auto& jsonTransportId : *jsonTransportIdsIt)
+				{
+					if (!jsonTransportId.is_string())
+						MS_THROW_TYPE_ERROR("wrong transportId (not a string)");
+
+					auto mapTransportsIt = this->mapTransports.find(jsonTransportId.get<std::string>());
+
+					if (mapTransportsIt == this->mapTransports.end())
+						continue;
+
+					if (seenTransports.insert(mapTransportsIt->second).second)
+						transports.push_back(mapTransportsIt->second);
+				}
+
+				size_t numTransports{ 0u };
+				size_t numConsumers{ 0u };
+
+				// Transports are closed in chunks so closing many of them does not
+				// stop media forwarding meanwhile.
+				request->Defer(
+				  [this, request, transports = std::move(transports), numTransports, numConsumers]() mutable
+				  {
+					  auto count = std::min(transports.size() - numTransports, CloseTransportsChunkSize);
+
+					  if (count != 0u)
+					  {
+						  std::vector<RTC::Transport*> chunk(
+						    transports.begin() + numTransports, transports.begin() + numTransports + count);
+
+						  numConsumers += CloseTransports(chunk);
+						  numTransports += count;
+
+						  if (numTransports < transports.size())
+							  return false;
+					  }
+
+					  json data = json::object();
+
+					  data["transports"] = numTransports;
+					  data["consumers"]  = numConsumers;
+
+					  request->Accept(data);
+
+					  return true;
+				  });
+
+				break;
+			}
+
 			case Channel::ChannelRequest::MethodId::RTP_OBSERVER_CLOSE:
 			{
 				// This may throw.
@@ -339,12 +765,23 @@ namespace RTC
 				// Remove it from the map.
 				this->mapRtpObservers.erase(rtpObserver->id);
 
+				// Resume the Consumers paused by its video last N policy.
+				auto mapRtpObserverVideoLastNPolicyIt = this->mapRtpObserverVideoLastNPolicy.find(rtpObserver);
+
+				if (mapRtpObserverVideoLastNPolicyIt != this->mapRtpObserverVideoLastNPolicy.end())
+				{
+					mapRtpObserverVideoLastNPolicyIt->second->Close();
+
+					this->mapRtpObserverVideoLastNPolicy.erase(mapRtpObserverVideoLastNPolicyIt);
+				}
+
 				// Iterate all entries in mapProducerRtpObservers and remove the closed one.
 				for (auto& kv : this->mapProducerRtpObservers)
 				{
 					auto& rtpObservers = kv.second;
 
-					rtpObservers.erase(rtpObserver);
+					if (rtpObservers.erase(rtpObserver) != 0u)
+						UpdateProducerLayerDemand(kv.first);
 				}
 
 				MS_DEBUG_DEV("RtpObserver closed [rtpObserverId:%s]", rtpObserver->id.c_str());
@@ -386,12 +823,20 @@ namespace RTC
 				// This may throw.
 				RTC::RtpObserver* rtpObserver = GetRtpObserverFromInternal(request->internal);
 				RTC::Producer* producer       = GetProducerFromData(request->data);
+				auto videoProducers           = GetVideoProducersFromData(request->data);
 
 				rtpObserver->AddProducer(producer);
 
 				// Add to the map.
 				this->mapProducerRtpObservers[producer].insert(rtpObserver);
 
+				UpdateProducerLayerDemand(producer);
+
+				auto mapRtpObserverVideoLastNPolicyIt = this->mapRtpObserverVideoLastNPolicy.find(rtpObserver);
+
+				if (mapRtpObserverVideoLastNPolicyIt != this->mapRtpObserverVideoLastNPolicy.end())
+					mapRtpObserverVideoLastNPolicyIt->second->AddSpeaker(producer, videoProducers);
+
 				request->Accept();
 
 				break;
@@ -408,6 +853,8 @@ namespace RTC
 				// Remove from the map.
 				this->mapProducerRtpObservers[producer].erase(rtpObserver);
 
+				UpdateProducerLayerDemand(producer);
+
 				request->Accept();
 
 				break;
@@ -465,6 +912,17 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		// Numeric handle given at creation, if any.
+		auto jsonTransportHandleIt = internal.find("transportHandle");
+
+		if (jsonTransportHandleIt != internal.end() && jsonTransportHandleIt->is_number_unsigned())
+		{
+			auto* transport = this->transportHandles.Get(jsonTransportHandleIt->get<uint32_t>());
+
+			if (transport)
+				return transport;
+		}
+
 		auto jsonTransportIdIt = internal.find("transportId");
 
 		if (jsonTransportIdIt == internal.end() || !jsonTransportIdIt->is_string())
@@ -480,6 +938,64 @@ namespace RTC
 		return transport;
 	}
 
+	size_t Router::CloseTransports(const std::vector<RTC::Transport*>& transports)
+	{
+		MS_TRACE();
+
+		// Forget the Consumers of all the closing Transports at once, so closing
+		// their Producers does not close (and notify) them one by one, and the
+		// Consumers of each Producer are filtered in a single pass.
+		absl::flat_hash_set<RTC::Consumer*> closingConsumers;
+		absl::flat_hash_set<RTC::Producer*> producers;
+
+		for (auto* transport : transports)
+		{
+			for (const auto& kv : transport->GetConsumers())
+			{
+				auto* consumer             = kv.second;
+				auto mapConsumerProducerIt = this->mapConsumerProducer.find(consumer);
+
+				closingConsumers.insert(consumer);
+
+				if (mapConsumerProducerIt == this->mapConsumerProducer.end())
+					continue;
+
+				producers.insert(mapConsumerProducerIt->second);
+				this->mapConsumerProducer.erase(mapConsumerProducerIt);
+			}
+		}
+
+		for (auto* producer : producers)
+		{
+			auto& fanOut    = this->mapProducerConsumers.at(producer);
+			auto& consumers = fanOut.consumers;
+
+			consumers.erase(
+			  std::remove_if(
+			    consumers.begin(),
+			    consumers.end(),
+			    [&closingConsumers](const FanOutConsumer& fanOutConsumer)
+			    { return closingConsumers.find(fanOutConsumer.consumer) != closingConsumers.end(); }),
+			  consumers.end());
+
+			fanOut.dirty = true;
+		}
+
+		// Now just the Consumers in other Transports are notified about the
+		// closure of the Producers.
+		for (auto* transport : transports)
+		{
+			transport->CloseProducersAndConsumers(/*notifyConsumers*/ false);
+
+			this->mapTransports.erase(transport->id);
+			this->transportHandles.Remove(transport->handle);
+
+			delete transport;
+		}
+
+		return closingConsumers.size();
+	}
+
 	void Router::SetNewRtpObserverIdFromInternal(json& internal, std::string& rtpObserverId) const
 	{
 		MS_TRACE();
@@ -533,6 +1049,239 @@ namespace RTC
 		return producer;
 	}
 
+	std::vector<RTC::Producer*> Router::GetVideoProducersFromData(json& data) const
+	{
+		MS_TRACE();
+
+		std::vector<RTC::Producer*> videoProducers;
+
+		auto jsonVideoProducerIdsIt = data.find("videoProducerIds");
+
+		if (jsonVideoProducerIdsIt == data.end())
+			return videoProducers;
+		else if (!jsonVideoProducerIdsIt->is_array())
+			MS_THROW_TYPE_ERROR("wrong videoProducerIds (not an array)");
+
+		for (auto& videoProducerId : *jsonVideoProducerIdsIt)
+		{
+			if (!videoProducerId.is_string())
+				MS_THROW_TYPE_ERROR("wrong videoProducerId (not a string)");
+
+			auto it = this->mapProducers.find(videoProducerId.get<std::string>());
+
+			if (it == this->mapProducers.end())
+				MS_THROW_ERROR("video Producer not found");
+
+			RTC::Producer* videoProducer = it->second;
+
+			if (videoProducer->GetKind() != RTC::Media::Kind::VIDEO)
+				MS_THROW_TYPE_ERROR("not a video Producer");
+
+			videoProducers.push_back(videoProducer);
+		}
+
+		return videoProducers;
+	}
+
+	std::shared_ptr<RTC::ConsumerGroup> Router::GetConsumerGroup(
+	  RTC::Producer* producer, const std::string& key)
+	{
+		MS_TRACE();
+
+		auto& groups = this->mapProducerConsumerGroups[producer];
+
+		for (auto it = groups.begin(); it != groups.end();)
+		{
+			auto group = it->lock();
+
+			// All its members were closed.
+			if (!group)
+			{
+				it = groups.erase(it);
+
+				continue;
+			}
+
+			if (group->GetKey() == key)
+				return group;
+
+			++it;
+		}
+
+		auto group = std::make_shared<RTC::ConsumerGroup>(key);
+
+		groups.emplace_back(group);
+
+		return group;
+	}
+
+	void Router::CheckMemoryUsage()
+	{
+		MS_TRACE();
+
+		auto memoryUsage = GetMemoryUsage();
+
+		// Shrink retransmission buffers above the soft limit and keep them shrunk
+		// until well below it, so they are not cleared over and over.
+		if (!this->memoryPressure && memoryUsage > this->memorySoftLimit)
+		{
+			this->memoryPressure = true;
+
+			MS_WARN_TAG(
+			  rtp,
+			  "memory soft limit exceeded, shrinking retransmission buffers [routerId:%s, "
+			  "memoryUsage:%zu, softLimit:%zu]",
+			  this->id.c_str(),
+			  memoryUsage,
+			  this->memorySoftLimit);
+		}
+		else if (this->memoryPressure && memoryUsage < this->memorySoftLimit / 2)
+		{
+			this->memoryPressure = false;
+
+			MS_DEBUG_TAG(
+			  rtp,
+			  "memory usage below soft limit, restoring retransmission buffers [routerId:%s, "
+			  "memoryUsage:%zu]",
+			  this->id.c_str(),
+			  memoryUsage);
+		}
+		else if (!this->memoryPressure)
+		{
+			return;
+		}
+
+		// Also applied while under pressure so new RTP streams are shrunk too.
+		for (auto& kv : this->mapTransports)
+		{
+			auto* transport = kv.second;
+
+			transport->SetMemoryPressure(this->memoryPressure);
+		}
+	}
+
+	void Router::UpdateProducerLayerDemand(RTC::Producer* producer)
+	{
+		MS_TRACE();
+
+		auto mapProducerConsumersIt = this->mapProducerConsumers.find(producer);
+
+		if (mapProducerConsumersIt == this->mapProducerConsumers.end())
+			return;
+
+		// Consumers paused by a video last N policy don't want any layer.
+		const bool lastNPaused =
+		  this->lastNPausedProducers.find(producer) != this->lastNPausedProducers.end();
+		RTC::Consumer::Layers demand;
+		auto mapProducerRtpObserversIt = this->mapProducerRtpObservers.find(producer);
+
+		// RtpObservers (audio ones) want the single layer.
+		// clang-format off
+		if (
+			mapProducerRtpObserversIt != this->mapProducerRtpObservers.end() &&
+			!mapProducerRtpObserversIt->second.empty()
+		)
+		// clang-format on
+		{
+			demand.spatial  = 0;
+			demand.temporal = 0;
+		}
+
+		for (const auto& fanOutConsumer : mapProducerConsumersIt->second.consumers)
+		{
+			if (!fanOutConsumer.active)
+				continue;
+
+			RTC::Consumer::Layers layers;
+
+			// PipeConsumers want the layers demanded by the remote Router (all of
+			// them by default).
+			if (fanOutConsumer.type == RTC::RtpParameters::Type::PIPE)
+			{
+				layers = fanOutConsumer.consumer->GetPreferredLayers();
+			}
+			// SimpleConsumers just want the single layer.
+			else if (!lastNPaused && fanOutConsumer.type == RTC::RtpParameters::Type::SIMPLE)
+			{
+				layers.spatial  = 0;
+				layers.temporal = 0;
+			}
+			else if (!lastNPaused)
+			{
+				layers = fanOutConsumer.consumer->GetPreferredLayers();
+			}
+
+			demand.spatial  = std::max(demand.spatial, layers.spatial);
+			demand.temporal = std::max(demand.temporal, layers.temporal);
+		}
+
+		auto& lastDemand = this->mapProducerLayerDemands[producer];
+
+		if (demand.spatial == lastDemand.spatial && demand.temporal == lastDemand.temporal)
+			return;
+
+		lastDemand = demand;
+
+		MS_DEBUG_DEV(
+		  "layer demand changed [spatial:%" PRIi16 ", temporal:%" PRIi16 ", producerId:%s]",
+		  demand.spatial,
+		  demand.temporal,
+		  producer->id.c_str());
+
+		// Null if no Consumer wants any layer.
+		json data = nullptr;
+
+		if (demand.spatial != -1)
+		{
+			data = json::object();
+
+			data["spatialLayer"]  = demand.spatial;
+			data["temporalLayer"] = demand.temporal;
+		}
+
+		Channel::ChannelNotifier::EmitBatched(producer->id, "layerdemandchange", data);
+	}
+
+	void Router::SortFanOut(FanOut& fanOut)
+	{
+		MS_TRACE();
+
+		auto& consumers = fanOut.consumers;
+
+		// Active Consumers first, then keep Consumers of the same type, MID and
+		// Transport together.
+		std::sort(
+		  consumers.begin(),
+		  consumers.end(),
+		  [](const FanOutConsumer& lhs, const FanOutConsumer& rhs)
+		  {
+			  if (lhs.active != rhs.active)
+				  return lhs.active;
+
+			  if (lhs.type != rhs.type)
+				  return lhs.type < rhs.type;
+
+			  const int midCmp = absl::string_view(lhs.mid, lhs.midLength)
+			                       .compare(absl::string_view(rhs.mid, rhs.midLength));
+
+			  if (midCmp != 0)
+				  return midCmp < 0;
+
+			  return std::less<RTC::Transport*>()(lhs.transport, rhs.transport);
+		  });
+
+		fanOut.numActive = static_cast<size_t>(std::count_if(
+		  consumers.begin(),
+		  consumers.end(),
+		  [](const FanOutConsumer& fanOutConsumer) { return fanOutConsumer.active; }));
+		fanOut.dirty = false;
+
+		MS_DEBUG_DEV(
+		  "fan-out sorted [active:%zu, parked:%zu]",
+		  fanOut.numActive,
+		  consumers.size() - fanOut.numActive);
+	}
+
 	inline void Router::OnTransportNewProducer(RTC::Transport* /*transport*/, RTC::Producer* producer)
 	{
 		MS_TRACE();
@@ -541,6 +1290,15 @@ namespace RTC
 		  this->mapProducerConsumers.find(producer) == this->mapProducerConsumers.end(),
 		  "Producer already present in mapProducerConsumers");
 
+		// A stream relayed back into a Router it already went through would loop
+		// forever between them (checked first for a meaningful error).
+		if (producer->IsInRelayPath(this->id))
+		{
+			MS_THROW_ERROR(
+			  "relay loop detected, Producer already relayed through this Router [producerId:%s]",
+			  producer->id.c_str());
+		}
+
 		if (this->mapProducers.find(producer->id) != this->mapProducers.end())
 		{
 			MS_THROW_ERROR("Producer already present in mapProducers [producerId:%s]", producer->id.c_str());
@@ -569,15 +1327,17 @@ namespace RTC
 		  "Producer not present in mapProducerRtpObservers");
 
 		// Close all Consumers associated to the closed Producer.
-		auto& consumers = mapProducerConsumersIt->second;
+		auto& consumers = mapProducerConsumersIt->second.consumers;
 
 		// NOTE: While iterating the set of Consumers, we call ProducerClosed() on each
 		// one, which will end calling Router::OnTransportConsumerProducerClosed(),
 		// which will remove the Consumer from mapConsumerProducer but won't remove the
 		// closed Consumer from the set of Consumers in mapProducerConsumers (here will
 		// erase the complete entry in that map).
-		for (auto* consumer : consumers)
+		for (auto& fanOutConsumer : consumers)
 		{
+			auto* consumer = fanOutConsumer.consumer;
+
 			// Call consumer->ProducerClosed() so the Consumer will notify the Node process,
 			// will notify its Transport, and its Transport will delete the Consumer.
 			consumer->ProducerClosed();
@@ -591,20 +1351,39 @@ namespace RTC
 			rtpObserver->RemoveProducer(producer);
 		}
 
+		for (auto& kv : this->mapRtpObserverVideoLastNPolicy)
+		{
+			auto* policy = kv.second;
+
+			policy->RemoveVideoProducer(producer);
+		}
+
+		this->lastNPausedProducers.erase(producer);
+
+		if (this->audioLastNSelector)
+			this->audioLastNSelector->RemoveProducer(producer);
+
 		// Remove the Producer from the maps.
 		this->mapProducers.erase(mapProducersIt);
 		this->mapProducerConsumers.erase(mapProducerConsumersIt);
 		this->mapProducerRtpObservers.erase(mapProducerRtpObserversIt);
+		this->mapProducerConsumerGroups.erase(producer);
+		this->mapProducerLayerDemands.erase(producer);
+
+		// Forget the RTP parameters kept for its Consumers.
+		RTC::Consumer::RemoveRtpParametersTemplates(producer->id);
 	}
 
 	inline void Router::OnTransportProducerPaused(RTC::Transport* /*transport*/, RTC::Producer* producer)
 	{
 		MS_TRACE();
 
-		auto& consumers = this->mapProducerConsumers.at(producer);
+		auto& consumers = this->mapProducerConsumers.at(producer).consumers;
 
-		for (auto* consumer : consumers)
+		for (auto& fanOutConsumer : consumers)
 		{
+			auto* consumer = fanOutConsumer.consumer;
+
 			consumer->ProducerPaused();
 		}
 
@@ -625,10 +1404,12 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		auto& consumers = this->mapProducerConsumers.at(producer);
+		auto& consumers = this->mapProducerConsumers.at(producer).consumers;
 
-		for (auto* consumer : consumers)
+		for (auto& fanOutConsumer : consumers)
 		{
+			auto* consumer = fanOutConsumer.consumer;
+
 			consumer->ProducerResumed();
 		}
 
@@ -650,10 +1431,12 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		auto& consumers = this->mapProducerConsumers.at(producer);
+		auto& consumers = this->mapProducerConsumers.at(producer).consumers;
 
-		for (auto* consumer : consumers)
+		for (auto& fanOutConsumer : consumers)
 		{
+			auto* consumer = fanOutConsumer.consumer;
+
 			consumer->ProducerNewRtpStream(rtpStream, mappedSsrc);
 		}
 	}
@@ -667,10 +1450,12 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		auto& consumers = this->mapProducerConsumers.at(producer);
+		auto& consumers = this->mapProducerConsumers.at(producer).consumers;
 
-		for (auto* consumer : consumers)
+		for (auto& fanOutConsumer : consumers)
 		{
+			auto* consumer = fanOutConsumer.consumer;
+
 			consumer->ProducerRtpStreamScore(rtpStream, score, previousScore);
 		}
 	}
@@ -680,10 +1465,12 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		auto& consumers = this->mapProducerConsumers.at(producer);
+		auto& consumers = this->mapProducerConsumers.at(producer).consumers;
 
-		for (auto* consumer : consumers)
+		for (auto& fanOutConsumer : consumers)
 		{
+			auto* consumer = fanOutConsumer.consumer;
+
 			consumer->ProducerRtcpSenderReport(rtpStream, first);
 		}
 	}
@@ -693,17 +1480,53 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		auto& consumers = this->mapProducerConsumers.at(producer);
+		Metrics::StageScope metricsScope(Metrics::Stage::ROUTER_FAN_OUT);
+
+		auto& fanOut = this->mapProducerConsumers.at(producer);
+
+		if (fanOut.dirty)
+			SortFanOut(fanOut);
 
-		for (auto* consumer : consumers)
+		// MID last written into the packet. Consumers are grouped by MID so it is
+		// just written once per distinct value.
+		const FanOutConsumer* midWriter{ nullptr };
+		// Audio of Producers not among the N loudest ones is just forwarded to
+		// PipeConsumers (the Router at the other side does its own selection).
+		// clang-format off
+		bool forward = (
+			!this->audioLastNSelector ||
+			producer->GetKind() != RTC::Media::Kind::AUDIO ||
+			this->audioLastNSelector->ForwardRtpPacket(producer, packet)
+		);
+		// clang-format on
+
+		// Parked Consumers are not even visited.
+		for (size_t idx{ 0u }; idx < fanOut.numActive; ++idx)
 		{
-			// Update MID RTP extension value.
-			const auto& mid = consumer->GetRtpParameters().mid;
+			auto& fanOutConsumer = fanOut.consumers[idx];
+
+			// It may have become inactive while forwarding this packet.
+			if (!fanOutConsumer.active)
+				continue;
+
+			if (!forward && fanOutConsumer.type != RTC::RtpParameters::Type::PIPE)
+			{
+				fanOutConsumer.consumer->DropRtpPacket(packet);
 
-			if (!mid.empty())
-				packet->UpdateMid(mid);
+				continue;
+			}
 
-			consumer->SendRtpPacket(packet);
+			// Update MID RTP extension value.
+			if (
+			  fanOutConsumer.midLength != 0u &&
+			  (!midWriter || midWriter->midLength != fanOutConsumer.midLength ||
+			   std::memcmp(midWriter->mid, fanOutConsumer.mid, fanOutConsumer.midLength) != 0))
+			{
+				if (packet->UpdateMid(absl::string_view(fanOutConsumer.mid, fanOutConsumer.midLength)))
+					midWriter = &fanOutConsumer;
+			}
+
+			fanOutConsumer.consumer->SendRtpPacket(packet);
 		}
 
 		auto it = this->mapProducerRtpObservers.find(producer);
@@ -727,16 +1550,18 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		auto& consumers = this->mapProducerConsumers.at(producer);
+		auto& consumers = this->mapProducerConsumers.at(producer).consumers;
 
-		for (auto* consumer : consumers)
+		for (auto& fanOutConsumer : consumers)
 		{
+			auto* consumer = fanOutConsumer.consumer;
+
 			consumer->NeedWorstRemoteFractionLost(mappedSsrc, worstRemoteFractionLost);
 		}
 	}
 
 	inline void Router::OnTransportNewConsumer(
-	  RTC::Transport* /*transport*/, RTC::Consumer* consumer, std::string& producerId)
+	  RTC::Transport* transport, RTC::Consumer* consumer, std::string& producerId)
 	{
 		MS_TRACE();
 
@@ -759,12 +1584,62 @@ namespace RTC
 		if (producer->IsPaused())
 			consumer->ProducerPaused();
 
+		// Pause it if a video last N policy says so.
+		// clang-format off
+		if (
+			consumer->GetType() != RTC::RtpParameters::Type::PIPE &&
+			this->lastNPausedProducers.find(producer) != this->lastNPausedProducers.end()
+		)
+		// clang-format on
+		{
+			consumer->SetLastNPaused(true);
+		}
+
 		// Insert the Consumer in the maps.
-		auto& consumers = mapProducerConsumersIt->second;
+		auto& fanOut = mapProducerConsumersIt->second;
+		FanOutConsumer fanOutConsumer;
+
+		fanOutConsumer.consumer  = consumer;
+		fanOutConsumer.transport = transport;
+		fanOutConsumer.type      = consumer->GetType();
+		fanOutConsumer.active    = consumer->RTC::Consumer::IsActive();
 
-		consumers.insert(consumer);
+		const auto& mid = consumer->GetRtpParameters().mid;
+
+		// MID-less forwarding. Don't write the MID into the RTP packets if the MID
+		// RTP header extension was not negotiated for the Consumer.
+		if (consumer->GetRtpHeaderExtensionIds().mid == 0u)
+		{
+			MS_DEBUG_TAG(
+			  rtp,
+			  "MID RTP header extension not negotiated, MID won't be written [consumerId:%s]",
+			  consumer->id.c_str());
+		}
+		else if (mid.size() > RTC::MidMaxLength)
+		{
+			MS_WARN_TAG(
+			  rtp,
+			  "MID too long to be written into RTP packets [consumerId:%s, mid:'%s']",
+			  consumer->id.c_str(),
+			  mid.c_str());
+		}
+		else
+		{
+			std::memcpy(fanOutConsumer.mid, mid.data(), mid.size());
+			fanOutConsumer.midLength = static_cast<uint8_t>(mid.size());
+		}
+
+		// Placed among the active or parked ones before forwarding the next RTP
+		// packet.
+		fanOut.consumers.push_back(fanOutConsumer);
+		fanOut.dirty = true;
 		this->mapConsumerProducer[consumer] = producer;
 
+		// Let the Consumer share send state with those of the Producer with
+		// identical negotiated parameters.
+		if (!consumer->GetGroupKey().empty())
+			consumer->SetGroup(GetConsumerGroup(producer, consumer->GetGroupKey()));
+
 		// Get all streams in the Producer and provide the Consumer with them.
 		for (const auto& kv : producer->GetRtpStreams())
 		{
@@ -776,6 +1651,8 @@ namespace RTC
 
 		// Provide the Consumer with the scores of all streams in the Producer.
 		consumer->ProducerRtpStreamScores(producer->GetRtpStreamScores());
+
+		UpdateProducerLayerDemand(producer);
 	}
 
 	inline void Router::OnTransportConsumerClosed(RTC::Transport* /*transport*/, RTC::Consumer* consumer)
@@ -800,13 +1677,22 @@ namespace RTC
 		  this->mapProducerConsumers.find(producer) != this->mapProducerConsumers.end(),
 		  "Producer not present in mapProducerConsumers");
 
-		// Remove the Consumer from the set of Consumers of the Producer.
-		auto& consumers = this->mapProducerConsumers.at(producer);
+		// Remove the Consumer from the Consumers of the Producer.
+		auto& fanOut    = this->mapProducerConsumers.at(producer);
+		auto& consumers = fanOut.consumers;
 
-		consumers.erase(consumer);
+		consumers.erase(std::find_if(
+		  consumers.begin(),
+		  consumers.end(),
+		  [consumer](const FanOutConsumer& fanOutConsumer)
+		  { return fanOutConsumer.consumer == consumer; }));
+
+		fanOut.dirty = true;
 
 		// Remove the Consumer from the map.
 		this->mapConsumerProducer.erase(mapConsumerProducerIt);
+
+		UpdateProducerLayerDemand(producer);
 	}
 
 	inline void Router::OnTransportConsumerProducerClosed(
@@ -829,12 +1715,90 @@ namespace RTC
 		this->mapConsumerProducer.erase(mapConsumerProducerIt);
 	}
 
+	inline void Router::OnTransportConsumerActiveChanged(
+	  RTC::Transport* /*transport*/, RTC::Consumer* consumer)
+	{
+		MS_TRACE();
+
+		auto mapConsumerProducerIt = this->mapConsumerProducer.find(consumer);
+
+		// The Consumer may not have been inserted in the maps yet.
+		if (mapConsumerProducerIt == this->mapConsumerProducer.end())
+			return;
+
+		auto* producer = mapConsumerProducerIt->second;
+		auto& fanOut   = this->mapProducerConsumers.at(producer);
+
+		for (auto& fanOutConsumer : fanOut.consumers)
+		{
+			if (fanOutConsumer.consumer != consumer)
+				continue;
+
+			const bool active = consumer->RTC::Consumer::IsActive();
+
+			// Parked or unparked before forwarding the next RTP packet, since this
+			// may be called while iterating the Consumers.
+			if (active != fanOutConsumer.active)
+			{
+				fanOutConsumer.active = active;
+				fanOut.dirty          = true;
+			}
+
+			break;
+		}
+
+		UpdateProducerLayerDemand(producer);
+	}
+
+	inline void Router::OnTransportConsumerPreferredLayersChanged(
+	  RTC::Transport* /*transport*/, RTC::Consumer* consumer)
+	{
+		MS_TRACE();
+
+		auto mapConsumerProducerIt = this->mapConsumerProducer.find(consumer);
+
+		// The Consumer may not have been inserted in the maps yet.
+		if (mapConsumerProducerIt == this->mapConsumerProducer.end())
+			return;
+
+		UpdateProducerLayerDemand(mapConsumerProducerIt->second);
+	}
+
 	inline void Router::OnTransportConsumerKeyFrameRequested(
 	  RTC::Transport* /*transport*/, RTC::Consumer* consumer, uint32_t mappedSsrc)
 	{
 		MS_TRACE();
 
-		auto* producer = this->mapConsumerProducer.at(consumer);
+		auto* producer      = this->mapConsumerProducer.at(consumer);
+		auto* keyFrameCache = producer->GetKeyFrameCache(mappedSsrc);
+
+		// If there is a cached key frame use it instead of asking the producer
+		// endpoint for a new one.
+		if (keyFrameCache && !keyFrameCache->GetPackets().empty())
+		{
+			const auto& packets = keyFrameCache->GetPackets();
+			auto& consumers     = this->mapProducerConsumers.at(producer).consumers;
+
+			// Update MID RTP extension value.
+			for (auto& fanOutConsumer : consumers)
+			{
+				if (fanOutConsumer.consumer != consumer)
+					continue;
+
+				if (fanOutConsumer.midLength != 0u)
+				{
+					for (auto* packet : packets)
+					{
+						packet->UpdateMid(absl::string_view(fanOutConsumer.mid, fanOutConsumer.midLength));
+					}
+				}
+
+				break;
+			}
+
+			if (consumer->SendKeyFrameCache(packets))
+				return;
+		}
 
 		producer->RequestKeyFrame(mappedSsrc);
 	}
@@ -908,10 +1872,23 @@ namespace RTC
 
 		auto& dataConsumers = this->mapDataProducerDataConsumers.at(dataProducer);
 
+		if (dataConsumers.size() == 1u)
+		{
+			(*dataConsumers.begin())->SendMessage(ppid, msg, len);
+
+			return;
+		}
+
+		// DataConsumers of DirectTransports get the message in a single
+		// notification rather than a copy of it each.
+		RTC::DirectTransport::StartMessageMulticast();
+
 		for (auto* consumer : dataConsumers)
 		{
 			consumer->SendMessage(ppid, msg, len);
 		}
+
+		RTC::DirectTransport::EndMessageMulticast(dataProducer->id, ppid, msg, len);
 	}
 
 	inline void Router::OnTransportNewDataConsumer(
@@ -993,4 +1970,95 @@ namespace RTC
 		// Remove the DataConsumer from the map.
 		this->mapDataConsumerDataProducer.erase(mapDataConsumerDataProducerIt);
 	}
+
+	inline void Router::OnTransportListenServerClosed(RTC::Transport* transport)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(
+		  this->mapTransports.find(transport->id) != this->mapTransports.end(),
+		  "Transport not present in mapTransports");
+
+		// Tell the Transport to close all its Producers and Consumers so it will
+		// notify us about their closures.
+		transport->CloseProducersAndConsumers();
+
+		// Remove it from the map.
+		this->mapTransports.erase(transport->id);
+		this->transportHandles.Remove(transport->handle);
+
+		// Delete it.
+		delete transport;
+	}
+
+	inline RTC::KeyFrameRequestScheduler::Budget* Router::OnTransportNeedKeyFrameRequestBudget(
+	  RTC::Transport* /*transport*/)
+	{
+		MS_TRACE();
+
+		return this->keyFrameRequestBudget;
+	}
+
+	inline void Router::OnVideoLastNPolicyProducerSelected(
+	  RTC::VideoLastNPolicy* /*policy*/, RTC::Producer* videoProducer, bool selected)
+	{
+		MS_TRACE();
+
+		if (selected)
+			this->lastNPausedProducers.erase(videoProducer);
+		else
+			this->lastNPausedProducers.insert(videoProducer);
+
+		auto& consumers = this->mapProducerConsumers.at(videoProducer).consumers;
+
+		for (auto& fanOutConsumer : consumers)
+		{
+			// PipeConsumers feed other Routers.
+			if (fanOutConsumer.type == RTC::RtpParameters::Type::PIPE)
+				continue;
+
+			fanOutConsumer.consumer->SetLastNPaused(!selected);
+		}
+
+		UpdateProducerLayerDemand(videoProducer);
+	}
+
+	inline void Router::OnAudioMixerRtpPacket(RTC::AudioMixer* audioMixer, RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		auto it = this->mapProducers.find(audioMixer->GetOutputProducerId());
+
+		// The output Producer may not exist yet or may be closed.
+		if (it == this->mapProducers.end())
+			return;
+
+		auto* producer         = it->second;
+		const auto& parameters = producer->GetRtpParameters();
+
+		if (parameters.encodings.empty() || parameters.encodings[0].ssrc == 0u)
+			return;
+
+		auto codecIt = std::find_if(
+		  parameters.codecs.begin(),
+		  parameters.codecs.end(),
+		  [](const RTC::RtpCodecParameters& codec)
+		  { return codec.mimeType.subtype == RTC::RtpCodecMimeType::Subtype::OPUS; });
+
+		if (codecIt == parameters.codecs.end())
+			return;
+
+		packet->SetSsrc(parameters.encodings[0].ssrc);
+		packet->SetPayloadType(codecIt->payloadType);
+
+		producer->ReceiveRtpPacket(packet);
+	}
+
+	inline void Router::OnTimer(Timer* timer)
+	{
+		MS_TRACE();
+
+		if (timer == this->memoryCheckTimer)
+			CheckMemoryUsage();
+	}
 } // namespace RTC
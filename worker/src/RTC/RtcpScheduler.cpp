@@ -0,0 +1,154 @@
+#define MS_CLASS "RTC::RtcpScheduler"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/RtcpScheduler.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+
+namespace RTC
+{
+	/* Class variables. */
+
+	thread_local RtcpScheduler::TimerListener RtcpScheduler::timerListener;
+	thread_local Timer* RtcpScheduler::timer{ nullptr };
+	thread_local std::map<uint64_t, absl::flat_hash_set<RtcpScheduler::Listener*>>
+	  RtcpScheduler::slots;
+	thread_local absl::flat_hash_map<RtcpScheduler::Listener*, uint64_t> RtcpScheduler::listenerSlots;
+	thread_local uint64_t RtcpScheduler::numPasses{ 0u };
+
+	/* Class methods. */
+
+	void RtcpScheduler::ClassDestroy()
+	{
+		MS_TRACE();
+
+		delete RtcpScheduler::timer;
+		RtcpScheduler::timer = nullptr;
+
+		RtcpScheduler::slots.clear();
+		RtcpScheduler::listenerSlots.clear();
+	}
+
+	void RtcpScheduler::Schedule(Listener* listener, uint64_t delayMs)
+	{
+		MS_TRACE();
+
+		const uint64_t nowMs = DepLibUV::GetTimeMs();
+		// Round up to the end of a slot, which must be in the future so a
+		// Listener scheduling itself while being notified is not notified again
+		// in the same pass.
+		uint64_t slot = (nowMs + delayMs + RtcpScheduler::SlotMs - 1) / RtcpScheduler::SlotMs;
+
+		if (slot <= nowMs / RtcpScheduler::SlotMs)
+			slot = (nowMs / RtcpScheduler::SlotMs) + 1;
+
+		auto it = RtcpScheduler::listenerSlots.find(listener);
+
+		if (it != RtcpScheduler::listenerSlots.end())
+		{
+			if (it->second == slot)
+				return;
+
+			Unschedule(listener);
+		}
+
+		RtcpScheduler::slots[slot].insert(listener);
+		RtcpScheduler::listenerSlots[listener] = slot;
+
+		// Re-arm the timer if this is the earliest slot now.
+		if (RtcpScheduler::slots.begin()->first == slot)
+			Arm();
+	}
+
+	void RtcpScheduler::Unschedule(Listener* listener)
+	{
+		MS_TRACE();
+
+		auto it = RtcpScheduler::listenerSlots.find(listener);
+
+		if (it == RtcpScheduler::listenerSlots.end())
+			return;
+
+		auto slotIt = RtcpScheduler::slots.find(it->second);
+
+		if (slotIt != RtcpScheduler::slots.end())
+		{
+			slotIt->second.erase(listener);
+
+			// NOTE: The timer is not re-armed. If this was the earliest slot it
+			// will just fire with nothing to do.
+			if (slotIt->second.empty())
+				RtcpScheduler::slots.erase(slotIt);
+		}
+
+		RtcpScheduler::listenerSlots.erase(it);
+	}
+
+	void RtcpScheduler::Arm()
+	{
+		MS_TRACE();
+
+		if (!RtcpScheduler::timer)
+			RtcpScheduler::timer = new Timer(std::addressof(RtcpScheduler::timerListener));
+
+		if (RtcpScheduler::slots.empty())
+		{
+			RtcpScheduler::timer->Stop();
+
+			return;
+		}
+
+		// NOTE: Timers count from the cached loop time, which may be behind the
+		// current time, so use it to not fire before the slot ends.
+		const uint64_t loopNowMs = uv_now(DepLibUV::GetLoop());
+		const uint64_t slotEndMs = RtcpScheduler::slots.begin()->first * RtcpScheduler::SlotMs;
+
+		RtcpScheduler::timer->Start(slotEndMs > loopNowMs ? slotEndMs - loopNowMs : 0u);
+	}
+
+	void RtcpScheduler::OnTimer()
+	{
+		MS_TRACE();
+
+		const uint64_t nowMs = DepLibUV::GetTimeMs();
+
+		++RtcpScheduler::numPasses;
+
+		while (!RtcpScheduler::slots.empty())
+		{
+			auto slotIt = RtcpScheduler::slots.begin();
+
+			if (slotIt->first * RtcpScheduler::SlotMs > nowMs)
+				break;
+
+			const uint64_t slot = slotIt->first;
+			auto listeners      = std::move(slotIt->second);
+
+			RtcpScheduler::slots.erase(slotIt);
+
+			for (auto* listener : listeners)
+			{
+				auto it = RtcpScheduler::listenerSlots.find(listener);
+
+				// May have been unscheduled by a previous Listener in this pass.
+				if (it == RtcpScheduler::listenerSlots.end() || it->second != slot)
+					continue;
+
+				RtcpScheduler::listenerSlots.erase(it);
+
+				listener->OnRtcpSchedulerSendRtcp(nowMs);
+			}
+		}
+
+		Arm();
+	}
+
+	/* Instance methods. */
+
+	inline void RtcpScheduler::TimerListener::OnTimer(Timer* /*timer*/)
+	{
+		MS_TRACE();
+
+		RtcpScheduler::OnTimer();
+	}
+} // namespace RTC
@@ -3,6 +3,7 @@
 
 #include "RTC/Parameters.hpp"
 #include "Logger.hpp"
+#include "Utils.hpp"
 
 namespace RTC
 {
@@ -278,4 +279,25 @@ namespace RTC
 
 		return value.arrayOfIntegers;
 	}
+
+	size_t Parameters::GetMemoryUsage() const
+	{
+		MS_TRACE();
+
+		// Slots of the hash map plus their control bytes.
+		size_t memoryUsage =
+		  this->mapKeyValues.capacity() * (sizeof(decltype(this->mapKeyValues)::value_type) + 1u);
+
+		for (const auto& kv : this->mapKeyValues)
+		{
+			auto& key   = kv.first;
+			auto& value = kv.second;
+
+			memoryUsage += Utils::String::GetMemoryUsage(key) +
+			               Utils::String::GetMemoryUsage(value.stringValue) +
+			               (value.arrayOfIntegers.capacity() * sizeof(int32_t));
+		}
+
+		return memoryUsage;
+	}
 } // namespace RTC
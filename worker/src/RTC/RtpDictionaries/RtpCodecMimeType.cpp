@@ -39,6 +39,7 @@ namespace RTC
 		{ "h264-svc",        RtpCodecMimeType::Subtype::H264_SVC        },
 		{ "x-h264uc",        RtpCodecMimeType::Subtype::X_H264UC        },
 		{ "h265",            RtpCodecMimeType::Subtype::H265            },
+		{ "av1",             RtpCodecMimeType::Subtype::AV1             },
 		// Complementary codecs:
 		{ "cn",              RtpCodecMimeType::Subtype::CN              },
 		{ "telephone-event", RtpCodecMimeType::Subtype::TELEPHONE_EVENT },
@@ -46,6 +47,7 @@ namespace RTC
 		{ "rtx",             RtpCodecMimeType::Subtype::RTX             },
 		{ "ulpfec",          RtpCodecMimeType::Subtype::ULPFEC          },
 		{ "flexfec",         RtpCodecMimeType::Subtype::FLEXFEC         },
+		{ "flexfec-03",      RtpCodecMimeType::Subtype::FLEXFEC_03      },
 		{ "x-ulpfecuc",      RtpCodecMimeType::Subtype::X_ULPFECUC      },
 		{ "red",             RtpCodecMimeType::Subtype::RED             }
 	};
@@ -67,6 +69,7 @@ namespace RTC
 		{ RtpCodecMimeType::Subtype::H264_SVC,        "H264-SVC"        },
 		{ RtpCodecMimeType::Subtype::X_H264UC,        "X-H264UC"        },
 		{ RtpCodecMimeType::Subtype::H265,            "H265"            },
+		{ RtpCodecMimeType::Subtype::AV1,             "AV1"             },
 		// Complementary codecs:
 		{ RtpCodecMimeType::Subtype::CN,              "CN"              },
 		{ RtpCodecMimeType::Subtype::TELEPHONE_EVENT, "telephone-event" },
@@ -74,6 +77,7 @@ namespace RTC
 		{ RtpCodecMimeType::Subtype::RTX,             "rtx"             },
 		{ RtpCodecMimeType::Subtype::ULPFEC,          "ulpfec"          },
 		{ RtpCodecMimeType::Subtype::FLEXFEC,         "flexfec"         },
+		{ RtpCodecMimeType::Subtype::FLEXFEC_03,      "flexfec-03"      },
 		{ RtpCodecMimeType::Subtype::X_ULPFECUC,      "x-ulpfecuc"      },
 		{ RtpCodecMimeType::Subtype::RED,             "red"             }
 	};
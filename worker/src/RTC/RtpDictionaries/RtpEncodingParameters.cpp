@@ -23,6 +23,7 @@ namespace RTC
 		auto jsonRidIt              = data.find("rid");
 		auto jsonCodecPayloadTypeIt = data.find("codecPayloadType");
 		auto jsonRtxIt              = data.find("rtx");
+		auto jsonFecIt              = data.find("fec");
 		auto jsonMaxBitrateIt       = data.find("maxBitrate");
 		auto jsonMaxFramerateIt     = data.find("maxFramerate");
 		auto jsonDtxIt              = data.find("dtx");
@@ -63,6 +64,14 @@ namespace RTC
 			this->hasRtx = true;
 		}
 
+		// fec is optional.
+		// This may throw.
+		if (jsonFecIt != data.end() && jsonFecIt->is_object())
+		{
+			this->fec    = RtpFecParameters(*jsonFecIt);
+			this->hasFec = true;
+		}
+
 		// maxBitrate is optional.
 		// clang-format off
 		if (
@@ -135,6 +144,10 @@ namespace RTC
 		if (this->hasRtx)
 			this->rtx.FillJson(jsonObject["rtx"]);
 
+		// Add fec.
+		if (this->hasFec)
+			this->fec.FillJson(jsonObject["fec"]);
+
 		// Add maxBitrate.
 		if (this->maxBitrate != 0u)
 			jsonObject["maxBitrate"] = this->maxBitrate;
@@ -24,6 +24,7 @@ namespace RTC
 		{ "urn:3gpp:video-orientation",                                                RtpHeaderExtensionUri::Type::VIDEO_ORIENTATION      },
 		{ "urn:ietf:params:rtp-hdrext:toffset",                                        RtpHeaderExtensionUri::Type::TOFFSET                },
 		{ "http://www.webrtc.org/experiments/rtp-hdrext/abs-capture-time",             RtpHeaderExtensionUri::Type::ABS_CAPTURE_TIME       },
+		{ "https://aomediacodec.github.io/av1-rtp-spec/#dependency-descriptor-rtp-header-extension", RtpHeaderExtensionUri::Type::DEPENDENCY_DESCRIPTOR },
 	};
 	// clang-format on
 
@@ -3,6 +3,7 @@
 
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Utils.hpp"
 #include "RTC/RtpDictionaries.hpp"
 #include <absl/container/flat_hash_set.h>
 
@@ -83,6 +84,21 @@ namespace RTC
 		return RtpParameters::type2String.at(type);
 	}
 
+	size_t RtpParameters::GetMemoryUsage(const std::vector<RtpEncodingParameters>& encodings)
+	{
+		MS_TRACE();
+
+		size_t memoryUsage = encodings.capacity() * sizeof(RtpEncodingParameters);
+
+		for (const auto& encoding : encodings)
+		{
+			memoryUsage += Utils::String::GetMemoryUsage(encoding.rid) +
+			               Utils::String::GetMemoryUsage(encoding.scalabilityMode);
+		}
+
+		return memoryUsage;
+	}
+
 	/* Instance methods. */
 
 	RtpParameters::RtpParameters(json& data)
@@ -260,6 +276,59 @@ namespace RTC
 		return nullptr;
 	}
 
+	const RTC::RtpCodecParameters* RtpParameters::GetFecCodec() const
+	{
+		MS_TRACE();
+
+		for (const auto& codec : this->codecs)
+		{
+			// clang-format off
+			if (
+				codec.mimeType.subtype == RTC::RtpCodecMimeType::Subtype::FLEXFEC ||
+				codec.mimeType.subtype == RTC::RtpCodecMimeType::Subtype::FLEXFEC_03
+			)
+			// clang-format on
+			{
+				return std::addressof(codec);
+			}
+		}
+
+		return nullptr;
+	}
+
+	size_t RtpParameters::GetMemoryUsage() const
+	{
+		MS_TRACE();
+
+		size_t memoryUsage = Utils::String::GetMemoryUsage(this->mid) +
+		                     Utils::String::GetMemoryUsage(this->rtcp.cname) +
+		                     RtpParameters::GetMemoryUsage(this->encodings);
+
+		memoryUsage += this->codecs.capacity() * sizeof(RtpCodecParameters);
+
+		for (const auto& codec : this->codecs)
+		{
+			memoryUsage += codec.parameters.GetMemoryUsage() +
+			               (codec.rtcpFeedback.capacity() * sizeof(RtcpFeedback));
+
+			for (const auto& fb : codec.rtcpFeedback)
+			{
+				memoryUsage +=
+				  Utils::String::GetMemoryUsage(fb.type) + Utils::String::GetMemoryUsage(fb.parameter);
+			}
+		}
+
+		memoryUsage += this->headerExtensions.capacity() * sizeof(RtpHeaderExtensionParameters);
+
+		for (const auto& exten : this->headerExtensions)
+		{
+			memoryUsage +=
+			  Utils::String::GetMemoryUsage(exten.uri) + exten.parameters.GetMemoryUsage();
+		}
+
+		return memoryUsage;
+	}
+
 	void RtpParameters::ValidateCodecs()
 	{
 		MS_TRACE();
@@ -296,6 +365,8 @@ namespace RTC
 								MS_THROW_TYPE_ERROR("apt in RTX codec points to a ULPFEC codec");
 							else if (codec.mimeType.subtype == RTC::RtpCodecMimeType::Subtype::FLEXFEC)
 								MS_THROW_TYPE_ERROR("apt in RTX codec points to a FLEXFEC codec");
+							else if (codec.mimeType.subtype == RTC::RtpCodecMimeType::Subtype::FLEXFEC_03)
+								MS_THROW_TYPE_ERROR("apt in RTX codec points to a FLEXFEC-03 codec");
 							else
 								break;
 						}
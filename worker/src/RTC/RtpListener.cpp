@@ -48,6 +48,15 @@ namespace RTC
 
 			(*jsonRidTableIt)[rid] = producer->id;
 		}
+
+		// Add lookupStats.
+		jsonObject["lookupStats"] = {
+			{ "ssrcCacheHits", this->lookupStats.ssrcCacheHits },
+			{ "ssrcTableHits", this->lookupStats.ssrcTableHits },
+			{ "midRidHits", this->lookupStats.midRidHits },
+			{ "unknownSsrcCacheHits", this->lookupStats.unknownSsrcCacheHits },
+			{ "misses", this->lookupStats.misses }
+		};
 	}
 
 	void RtpListener::AddProducer(RTC::Producer* producer)
@@ -56,6 +65,9 @@ namespace RTC
 
 		const auto& rtpParameters = producer->GetRtpParameters();
 
+		// SSRCs not matching any Producer so far may match this one.
+		this->unknownSsrcCache.fill({});
+
 		// Add entries into the ssrcTable.
 		for (auto& encoding : rtpParameters.encodings)
 		{
@@ -94,6 +106,23 @@ namespace RTC
 					MS_THROW_ERROR("RTX ssrc already exists in RTP listener [ssrc:%" PRIu32 "]", ssrc);
 				}
 			}
+
+			// Check encoding.fec.ssrc.
+			ssrc = encoding.fec.ssrc;
+
+			if (ssrc != 0u)
+			{
+				if (this->ssrcTable.find(ssrc) == this->ssrcTable.end())
+				{
+					this->ssrcTable[ssrc] = producer;
+				}
+				else
+				{
+					RemoveProducer(producer);
+
+					MS_THROW_ERROR("FEC ssrc already exists in RTP listener [ssrc:%" PRIu32 "]", ssrc);
+				}
+			}
 		}
 
 		// Add entries into midTable.
@@ -141,10 +170,16 @@ namespace RTC
 
 		// Remove from the listener tables all entries pointing to the Producer.
 
+		for (auto& cachedSsrc : this->ssrcCache)
+		{
+			if (cachedSsrc.producer == producer)
+				cachedSsrc = {};
+		}
+
 		for (auto it = this->ssrcTable.begin(); it != this->ssrcTable.end();)
 		{
 			if (it->second == producer)
-				it = this->ssrcTable.erase(it);
+				this->ssrcTable.erase(it++);
 			else
 				++it;
 		}
@@ -152,7 +187,7 @@ namespace RTC
 		for (auto it = this->midTable.begin(); it != this->midTable.end();)
 		{
 			if (it->second == producer)
-				it = this->midTable.erase(it);
+				this->midTable.erase(it++);
 			else
 				++it;
 		}
@@ -160,7 +195,7 @@ namespace RTC
 		for (auto it = this->ridTable.begin(); it != this->ridTable.end();)
 		{
 			if (it->second == producer)
-				it = this->ridTable.erase(it);
+				this->ridTable.erase(it++);
 			else
 				++it;
 		}
@@ -170,24 +205,55 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		// First lookup into the SSRC table.
+		const uint32_t ssrc = packet->GetSsrc();
+
+		// First lookup into the SSRC cache.
+		{
+			const auto& cachedSsrc = this->ssrcCache[ssrc & (SsrcCacheSize - 1)];
+
+			if (cachedSsrc.producer && cachedSsrc.ssrc == ssrc)
+			{
+				++this->lookupStats.ssrcCacheHits;
+
+				return cachedSsrc.producer;
+			}
+		}
+
+		// Otherwise lookup into the SSRC table.
 		{
-			auto it = this->ssrcTable.find(packet->GetSsrc());
+			auto it = this->ssrcTable.find(ssrc);
 
 			if (it != this->ssrcTable.end())
 			{
 				auto* producer = it->second;
 
+				CacheSsrc(ssrc, producer);
+
+				++this->lookupStats.ssrcTableHits;
+
 				return producer;
 			}
 		}
 
+		// Skip MID and RID lookups if they already failed for this SSRC.
+		if (IsUnknownSsrcCached(ssrc))
+		{
+			++this->lookupStats.unknownSsrcCacheHits;
+
+			return nullptr;
+		}
+
+		// Whether the packet has MID or RID (so a miss can be cached).
+		bool hasMidOrRid{ false };
+
 		// Otherwise lookup into the MID table.
 		{
-			std::string mid;
+			absl::string_view mid;
 
 			if (packet->ReadMid(mid))
 			{
+				hasMidOrRid = true;
+
 				auto it = this->midTable.find(mid);
 
 				if (it != this->midTable.end())
@@ -196,7 +262,11 @@ namespace RTC
 
 					// Fill the ssrc table.
 					// NOTE: We may be overriding an exiting SSRC here, but we don't care.
-					this->ssrcTable[packet->GetSsrc()] = producer;
+					this->ssrcTable[ssrc] = producer;
+
+					CacheSsrc(ssrc, producer);
+
+					++this->lookupStats.midRidHits;
 
 					return producer;
 				}
@@ -205,10 +275,12 @@ namespace RTC
 
 		// Otherwise lookup into the RID table.
 		{
-			std::string rid;
+			absl::string_view rid;
 
 			if (packet->ReadRid(rid))
 			{
+				hasMidOrRid = true;
+
 				auto it = this->ridTable.find(rid);
 
 				if (it != this->ridTable.end())
@@ -217,13 +289,24 @@ namespace RTC
 
 					// Fill the ssrc table.
 					// NOTE: We may be overriding an exiting SSRC here, but we don't care.
-					this->ssrcTable[packet->GetSsrc()] = producer;
+					this->ssrcTable[ssrc] = producer;
+
+					CacheSsrc(ssrc, producer);
+
+					++this->lookupStats.midRidHits;
 
 					return producer;
 				}
 			}
 		}
 
+		// NOTE: Packets without MID nor RID don't tell anything about the SSRC, and
+		// a later packet of the same stream may have them.
+		if (hasMidOrRid)
+			CacheUnknownSsrc(ssrc);
+
+		++this->lookupStats.misses;
+
 		return nullptr;
 	}
 
@@ -175,21 +175,10 @@ namespace RTC
 			std::vector<std::string> extIds;
 			std::ostringstream extIdsStream;
 
-			if (HasOneByteExtensions())
+			for (uint16_t id{ 1u }; id < this->numExtensionSlots; ++id)
 			{
-				for (const auto& extension : this->oneByteExtensions)
-				{
-					extIds.push_back(std::to_string(extension->id));
-				}
-			}
-			else
-			{
-				extIds.reserve(this->mapTwoBytesExtensions.size());
-
-				for (const auto& kv : this->mapTwoBytesExtensions)
-				{
-					extIds.push_back(std::to_string(kv.first));
-				}
+				if (this->extensionSlots[id].offset != 0u)
+					extIds.push_back(std::to_string(id));
 			}
 
 			if (!extIds.empty())
@@ -286,6 +275,24 @@ namespace RTC
 				  rotation);
 			}
 		}
+		if (this->dependencyDescriptorExtensionId != 0u)
+		{
+			MS_DUMP("  depDescriptor     : extId:%" PRIu8, this->dependencyDescriptorExtensionId);
+		}
+		if (this->absCaptureTimeExtensionId != 0u)
+		{
+			uint64_t absCaptureTimestamp;
+			int64_t estimatedCaptureClockOffset;
+
+			if (ReadAbsCaptureTime(absCaptureTimestamp, estimatedCaptureClockOffset))
+			{
+				MS_DUMP(
+				  "  absCaptureTime    : extId:%" PRIu8 ", timestamp:%" PRIu64 ", clockOffset:%" PRIi64,
+				  this->absCaptureTimeExtensionId,
+				  absCaptureTimestamp,
+				  estimatedCaptureClockOffset);
+			}
+		}
 		MS_DUMP("  csrc count        : %" PRIu8, this->header->csrcCount);
 		MS_DUMP("  marker            : %s", HasMarker() ? "true" : "false");
 		MS_DUMP("  payload type      : %" PRIu8, GetPayloadType());
@@ -367,19 +374,18 @@ namespace RTC
 		MS_ASSERT(type == 1u || type == 2u, "type must be 1 or 2");
 
 		// Reset extension ids.
-		this->midExtensionId               = 0u;
-		this->ridExtensionId               = 0u;
-		this->rridExtensionId              = 0u;
-		this->absSendTimeExtensionId       = 0u;
-		this->transportWideCc01ExtensionId = 0u;
-		this->frameMarking07ExtensionId    = 0u;
-		this->frameMarkingExtensionId      = 0u;
-		this->ssrcAudioLevelExtensionId    = 0u;
-		this->videoOrientationExtensionId  = 0u;
-
-		// Clear the One-Byte and Two-Bytes extension elements maps.
-		std::fill(std::begin(this->oneByteExtensions), std::end(this->oneByteExtensions), nullptr);
-		this->mapTwoBytesExtensions.clear();
+		this->midExtensionId                  = 0u;
+		this->ridExtensionId                  = 0u;
+		this->rridExtensionId                 = 0u;
+		this->absSendTimeExtensionId          = 0u;
+		this->transportWideCc01ExtensionId    = 0u;
+		this->frameMarking07ExtensionId       = 0u;
+		this->frameMarkingExtensionId         = 0u;
+		this->ssrcAudioLevelExtensionId       = 0u;
+		this->videoOrientationExtensionId     = 0u;
+		this->dependencyDescriptorExtensionId = 0u;
+		this->absCaptureTimeExtensionId       = 0u;
+
 
 		// If One-Byte is requested and the packet already has One-Byte extensions,
 		// keep the header extension id.
@@ -479,6 +485,9 @@ namespace RTC
 			this->headerExtension->length = htons(extensionsTotalSize / 4);
 		}
 
+		// Clear the extension elements table of the requested type.
+		ResetExtensionSlots();
+
 		// Write the new extensions into the header extension value.
 		uint8_t* ptr = this->headerExtension->value;
 
@@ -489,12 +498,12 @@ namespace RTC
 				if (extension.id == 0 || extension.id > 14 || extension.len == 0 || extension.len > 16)
 					continue;
 
-				// Store the One-Byte extension element in an array.
-				// `-1` because we have 14 elements total 0..13 and `id` is in the range 1..14.
-				this->oneByteExtensions[extension.id - 1] = reinterpret_cast<OneByteExtension*>(ptr);
-
 				*ptr = (extension.id << 4) | ((extension.len - 1) & 0x0F);
 				++ptr;
+
+				// Store the One-Byte extension element location.
+				SetExtensionSlot(extension.id, ptr, extension.len);
+
 				std::memmove(ptr, extension.value, extension.len);
 				ptr += extension.len;
 			}
@@ -503,13 +512,14 @@ namespace RTC
 				if (extension.id == 0)
 					continue;
 
-				// Store the Two-Bytes extension element in the map.
-				this->mapTwoBytesExtensions[extension.id] = reinterpret_cast<TwoBytesExtension*>(ptr);
-
 				*ptr = extension.id;
 				++ptr;
 				*ptr = extension.len;
 				++ptr;
+
+				// Store the Two-Bytes extension element location.
+				SetExtensionSlot(extension.id, ptr, extension.len);
+
 				std::memmove(ptr, extension.value, extension.len);
 				ptr += extension.len;
 			}
@@ -524,7 +534,7 @@ namespace RTC
 		MS_ASSERT(ptr == this->payload, "wrong ptr calculation");
 	}
 
-	bool RtpPacket::UpdateMid(const std::string& mid)
+	bool RtpPacket::UpdateMid(absl::string_view mid)
 	{
 		MS_TRACE();
 
@@ -539,14 +549,15 @@ namespace RTC
 		if (mid.size() > RTC::MidMaxLength)
 		{
 			MS_ERROR(
-			  "no enough space for MID value [MidMaxLength:%" PRIu8 ", mid:'%s']",
+			  "no enough space for MID value [MidMaxLength:%" PRIu8 ", mid:'%.*s']",
 			  RTC::MidMaxLength,
-			  mid.c_str());
+			  static_cast<int>(mid.size()),
+			  mid.data());
 
 			return false;
 		}
 
-		std::memcpy(extenValue, mid.c_str(), mid.size());
+		std::memcpy(extenValue, mid.data(), mid.size());
 
 		SetExtensionLength(this->midExtensionId, mid.size());
 
@@ -568,51 +579,106 @@ namespace RTC
 			return false;
 		}
 
-		if (id == 0u)
-		{
+		// NOTE: Slot 0 is never used since id 0 is not valid.
+		if (id >= this->numExtensionSlots || !HasValidExtensionSlots())
 			return false;
-		}
-		else if (HasOneByteExtensions())
-		{
-			// `-1` because we have 14 elements total 0..13 and `id` is in the range 1..14.
-			auto* extension = this->oneByteExtensions[id - 1];
 
-			if (!extension)
-				return false;
+		auto& slot = this->extensionSlots[id];
+
+		if (slot.offset == 0u)
+			return false;
 
-			auto currentLen = extension->len + 1;
+		uint8_t* value = this->headerExtension->value + slot.offset;
 
-			// Fill with 0's if new length is minor.
-			if (len < currentLen)
-				std::memset(extension->value + len, 0, currentLen - len);
+		// Fill with 0's if new length is minor.
+		if (len < slot.len)
+			std::memset(value + len, 0, slot.len - len);
 
-			// In One-Byte extensions value length 0 means 1.
-			extension->len = len - 1;
+		// In One-Byte extensions value length 0 means 1.
+		if (HasOneByteExtensions())
+			reinterpret_cast<OneByteExtension*>(value - 1)->len = len - 1;
+		else
+			reinterpret_cast<TwoBytesExtension*>(value - 2)->len = len;
 
-			return true;
+		slot.len = len;
+
+		return true;
+	}
+
+	uint8_t RtpPacket::GetExtensionAvailableLength(uint8_t id) const
+	{
+		MS_TRACE();
+
+		// NOTE: Slot 0 is never used since id 0 is not valid.
+		if (id >= this->numExtensionSlots || !HasValidExtensionSlots())
+			return 0u;
+
+		const auto& slot = this->extensionSlots[id];
+
+		if (slot.offset == 0u)
+			return 0u;
+
+		// The value may take up to the header of the next element or the end
+		// of the header extension.
+		const size_t elementHeaderSize = HasOneByteExtensions() ? 1u : 2u;
+		size_t end                     = GetHeaderExtensionLength();
+
+		for (uint16_t idx{ 1u }; idx < this->numExtensionSlots; ++idx)
+		{
+			const auto& otherSlot = this->extensionSlots[idx];
+
+			if (otherSlot.offset > slot.offset && otherSlot.offset - elementHeaderSize < end)
+				end = otherSlot.offset - elementHeaderSize;
 		}
-		else if (HasTwoBytesExtensions())
+
+		return static_cast<uint8_t>(std::min<size_t>(end - slot.offset, 255u));
+	}
+
+	bool RtpPacket::MapOneByteExtensionIds(const std::array<uint8_t, 15>& ids)
+	{
+		MS_TRACE();
+
+		if (!HasOneByteExtensions() || !HasValidExtensionSlots())
+			return false;
+
+		bool identity{ true };
+
+		// NOTE: Slot 0 is never used since id 0 is not valid.
+		for (uint8_t id{ 1u }; id < this->oneByteExtensions.size(); ++id)
 		{
-			auto it = this->mapTwoBytesExtensions.find(id);
+			if (this->oneByteExtensions[id].offset == 0u)
+				continue;
 
-			if (it == this->mapTwoBytesExtensions.end())
+			if (ids[id] == 0u || ids[id] >= this->oneByteExtensions.size())
 				return false;
 
-			auto* extension = it->second;
-			auto currentLen = extension->len;
+			if (ids[id] != id)
+				identity = false;
+		}
 
-			// Fill with 0's if new length is minor.
-			if (len < currentLen)
-				std::memset(extension->value + len, 0, currentLen - len);
+		if (identity)
+			return true;
 
-			extension->len = len;
+		std::array<ExtensionSlot, 15> oneByteExtensions;
 
-			return true;
-		}
-		else
+		for (uint8_t id{ 1u }; id < this->oneByteExtensions.size(); ++id)
 		{
-			return false;
+			const auto& slot = this->oneByteExtensions[id];
+
+			if (slot.offset == 0u)
+				continue;
+
+			auto* extension =
+			  reinterpret_cast<OneByteExtension*>(this->headerExtension->value + slot.offset - 1);
+
+			extension->id = ids[id];
+
+			oneByteExtensions[ids[id]] = slot;
 		}
+
+		this->oneByteExtensions = oneByteExtensions;
+
+		return true;
 	}
 
 	void RtpPacket::SetPayloadLength(size_t length)
@@ -635,6 +701,32 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		return Clone(buffer, 0u);
+	}
+
+	RtpPacket* RtpPacket::RtxClone(
+	  const uint8_t* buffer, uint8_t payloadType, uint32_t ssrc, uint16_t seq) const
+	{
+		MS_TRACE();
+
+		// Leave room for the original sequence number before the payload.
+		auto* packet = Clone(buffer, 2u);
+
+		Utils::Byte::Set2Bytes(packet->payload, 0, GetSequenceNumber());
+
+		packet->SetPayloadType(payloadType);
+		packet->SetSsrc(ssrc);
+		packet->SetSequenceNumber(seq);
+
+		return packet;
+	}
+
+	// Clones the packet leaving payloadGap bytes before the payload, which are
+	// considered part of it. If not 0, the payload padding is removed.
+	RtpPacket* RtpPacket::Clone(const uint8_t* buffer, size_t payloadGap) const
+	{
+		MS_TRACE();
+
 		auto* ptr = const_cast<uint8_t*>(buffer);
 		size_t numBytes{ 0 };
 
@@ -673,6 +765,8 @@ namespace RTC
 		// Copy payload.
 		uint8_t* newPayload{ ptr };
 
+		ptr += payloadGap;
+
 		if (this->payloadLength != 0u)
 		{
 			numBytes = this->payloadLength;
@@ -681,33 +775,95 @@ namespace RTC
 			ptr += numBytes;
 		}
 
+		uint8_t newPayloadPadding{ this->payloadPadding };
+
 		// Copy payload padding.
-		if (this->payloadPadding != 0u)
+		if (payloadGap != 0u)
+		{
+			newPayloadPadding = 0u;
+		}
+		else if (this->payloadPadding != 0u)
 		{
 			*(ptr + static_cast<size_t>(this->payloadPadding) - 1) = this->payloadPadding;
 			ptr += size_t{ this->payloadPadding };
 		}
 
-		MS_ASSERT(static_cast<size_t>(ptr - buffer) == this->size, "ptr - buffer == this->size");
+		auto newSize = static_cast<size_t>(ptr - buffer);
+
+		// clang-format off
+		MS_ASSERT(
+			newSize == this->size + payloadGap - (this->payloadPadding - newPayloadPadding),
+			"ptr - buffer == this->size"
+		);
+		// clang-format on
 
 		// Create the new RtpPacket instance and return it.
 		auto* packet = new RtpPacket(
-		  newHeader, newHeaderExtension, newPayload, this->payloadLength, this->payloadPadding, this->size);
+		  newHeader,
+		  newHeaderExtension,
+		  newPayload,
+		  this->payloadLength + payloadGap,
+		  newPayloadPadding,
+		  newSize);
+
+		if (newPayloadPadding != this->payloadPadding)
+			packet->SetPayloadPaddingFlag(false);
 
 		// Keep already set extension ids.
-		packet->midExtensionId               = this->midExtensionId;
-		packet->ridExtensionId               = this->ridExtensionId;
-		packet->rridExtensionId              = this->rridExtensionId;
-		packet->absSendTimeExtensionId       = this->absSendTimeExtensionId;
-		packet->transportWideCc01ExtensionId = this->transportWideCc01ExtensionId;
-		packet->frameMarking07ExtensionId    = this->frameMarking07ExtensionId; // Remove once RFC.
-		packet->frameMarkingExtensionId      = this->frameMarkingExtensionId;
-		packet->ssrcAudioLevelExtensionId    = this->ssrcAudioLevelExtensionId;
-		packet->videoOrientationExtensionId  = this->videoOrientationExtensionId;
+		packet->midExtensionId                  = this->midExtensionId;
+		packet->ridExtensionId                  = this->ridExtensionId;
+		packet->rridExtensionId                 = this->rridExtensionId;
+		packet->absSendTimeExtensionId          = this->absSendTimeExtensionId;
+		packet->transportWideCc01ExtensionId    = this->transportWideCc01ExtensionId;
+		packet->frameMarking07ExtensionId       = this->frameMarking07ExtensionId; // Remove once RFC.
+		packet->frameMarkingExtensionId         = this->frameMarkingExtensionId;
+		packet->ssrcAudioLevelExtensionId       = this->ssrcAudioLevelExtensionId;
+		packet->videoOrientationExtensionId     = this->videoOrientationExtensionId;
+		packet->dependencyDescriptorExtensionId = this->dependencyDescriptorExtensionId;
+		packet->absCaptureTimeExtensionId       = this->absCaptureTimeExtensionId;
+		// Keep the ingress and arrival times.
+		packet->ingressTimeNs = this->ingressTimeNs;
+		packet->arrivalTimeMs = this->arrivalTimeMs;
+		// Keep the layer tags (but not the payload descriptor handler) so stored
+		// and queued packets can still be classified.
+		packet->spatialLayer  = this->spatialLayer;
+		packet->temporalLayer = this->temporalLayer;
+		packet->isKeyFrame    = this->isKeyFrame;
 
 		return packet;
 	}
 
+	std::shared_ptr<RtpPacket> RtpPacket::GetSharedClone()
+	{
+		MS_TRACE();
+
+		if (this->sharedClone)
+			return this->sharedClone;
+
+		MS_ASSERT(this->size <= RTC::MtuSize, "packet too big to be cloned");
+
+		// Keep the clone and its memory in a single allocation.
+		struct SharedStore
+		{
+			~SharedStore()
+			{
+				delete this->packet;
+			}
+
+			uint8_t buffer[RTC::MtuSize];
+			RtpPacket* packet{ nullptr };
+		};
+
+		auto store = std::make_shared<SharedStore>();
+
+		store->packet = Clone(store->buffer);
+
+		// Aliasing constructor: share the ownership of the store.
+		this->sharedClone = std::shared_ptr<RtpPacket>(store, store->packet);
+
+		return this->sharedClone;
+	}
+
 	// NOTE: The caller must ensure that the buffer/memmory of the packet has
 	// space enough for adding 2 extra bytes.
 	void RtpPacket::RtxEncode(uint8_t payloadType, uint32_t ssrc, uint16_t seq)
@@ -848,12 +1004,11 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		ResetExtensionSlots();
+
 		// Parse One-Byte header extension.
 		if (HasOneByteExtensions())
 		{
-			// Clear the One-Byte extension elements map.
-			std::fill(std::begin(this->oneByteExtensions), std::end(this->oneByteExtensions), nullptr);
-
 			uint8_t* extensionStart = reinterpret_cast<uint8_t*>(this->headerExtension) + 4;
 			uint8_t* extensionEnd   = extensionStart + GetHeaderExtensionLength();
 			uint8_t* ptr            = extensionStart;
@@ -879,9 +1034,8 @@ namespace RTC
 						break;
 					}
 
-					// Store the One-Byte extension element in an array.
-					// `-1` because we have 14 elements total 0..13 and `id` is in the range 1..14.
-					this->oneByteExtensions[id - 1] = reinterpret_cast<OneByteExtension*>(ptr);
+					// Store the One-Byte extension element location.
+					SetExtensionSlot(id, ptr + 1, static_cast<uint8_t>(len));
 
 					ptr += (1 + len);
 				}
@@ -901,9 +1055,6 @@ namespace RTC
 		// Parse Two-Bytes header extension.
 		else if (HasTwoBytesExtensions())
 		{
-			// Clear the Two-Bytes extension elements map.
-			this->mapTwoBytesExtensions.clear();
-
 			uint8_t* extensionStart = reinterpret_cast<uint8_t*>(this->headerExtension) + 4;
 			uint8_t* extensionEnd   = extensionStart + GetHeaderExtensionLength();
 			uint8_t* ptr            = extensionStart;
@@ -928,8 +1079,8 @@ namespace RTC
 						break;
 					}
 
-					// Store the Two-Bytes extension element in the map.
-					this->mapTwoBytesExtensions[id] = reinterpret_cast<TwoBytesExtension*>(ptr);
+					// Store the Two-Bytes extension element location.
+					SetExtensionSlot(id, ptr + 2, len);
 
 					ptr += (2 + len);
 				}
@@ -947,4 +1098,44 @@ namespace RTC
 			}
 		}
 	}
+
+	/*
+	 * Clears the extension elements table of the current header extension
+	 * type and selects it for lookups.
+	 */
+	void RtpPacket::ResetExtensionSlots()
+	{
+		MS_TRACE();
+
+		if (HasOneByteExtensions())
+		{
+			this->oneByteExtensions.fill(ExtensionSlot{});
+
+			this->extensionSlots    = this->oneByteExtensions.data();
+			this->numExtensionSlots = static_cast<uint16_t>(this->oneByteExtensions.size());
+		}
+		else if (HasTwoBytesExtensions())
+		{
+			if (!this->twoBytesExtensions)
+				this->twoBytesExtensions.reset(new std::array<ExtensionSlot, 256>());
+			else
+				this->twoBytesExtensions->fill(ExtensionSlot{});
+
+			this->extensionSlots    = this->twoBytesExtensions->data();
+			this->numExtensionSlots = static_cast<uint16_t>(this->twoBytesExtensions->size());
+		}
+		else
+		{
+			this->extensionSlots    = nullptr;
+			this->numExtensionSlots = 0u;
+		}
+	}
+
+	inline void RtpPacket::SetExtensionSlot(uint8_t id, const uint8_t* value, uint8_t len)
+	{
+		auto& slot = this->extensionSlots[id];
+
+		slot.offset = static_cast<uint16_t>(value - this->headerExtension->value);
+		slot.len    = len;
+	}
 } // namespace RTC
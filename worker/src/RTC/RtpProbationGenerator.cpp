@@ -35,32 +35,86 @@ namespace RTC
 	static constexpr size_t MaxProbationPacketSize{ 1400u };
 	static const std::string MidValue{ "probator" }; // 8 bytes, same as RTC::MidMaxLength.
 
-	/* Instance methods. */
+	/* Class variables. */
 
-	RtpProbationGenerator::RtpProbationGenerator()
+	thread_local uint8_t* RtpProbationGenerator::probationPacketBuffer{ nullptr };
+	thread_local RTC::RtpPacket* RtpProbationGenerator::probationPacket{ nullptr };
+
+	/* Class methods. */
+
+	void RtpProbationGenerator::ClassDestroy()
+	{
+		MS_TRACE();
+
+		// Delete the probation RTP packet.
+		delete RtpProbationGenerator::probationPacket;
+		RtpProbationGenerator::probationPacket = nullptr;
+
+		// Delete the probation packet buffer.
+		delete[] RtpProbationGenerator::probationPacketBuffer;
+		RtpProbationGenerator::probationPacketBuffer = nullptr;
+	}
+
+	RTC::RtpPacket* RtpProbationGenerator::GetNextPacket(size_t size)
+	{
+		MS_TRACE();
+
+		if (!RtpProbationGenerator::probationPacket)
+			CreateProbationPacket();
+
+		auto* probationPacket = RtpProbationGenerator::probationPacket;
+
+		// Make the packet length fit into our available limits.
+		if (size > MaxProbationPacketSize)
+			size = MaxProbationPacketSize;
+		else if (size < ProbationPacketHeaderSize)
+			size = ProbationPacketHeaderSize;
+
+		// Increase RTP seq number and timestamp.
+		auto seq       = probationPacket->GetSequenceNumber();
+		auto timestamp = probationPacket->GetTimestamp();
+
+		++seq;
+		timestamp += 20u;
+
+		probationPacket->SetSequenceNumber(seq);
+		probationPacket->SetTimestamp(timestamp);
+
+		// Set probation packet payload size.
+		probationPacket->SetPayloadLength(size - ProbationPacketHeaderSize);
+
+		return probationPacket;
+	}
+
+	void RtpProbationGenerator::CreateProbationPacket()
 	{
 		MS_TRACE();
 
 		// Allocate the probation RTP packet buffer.
-		this->probationPacketBuffer = new uint8_t[MaxProbationPacketSize];
+		RtpProbationGenerator::probationPacketBuffer = new uint8_t[MaxProbationPacketSize];
 
 		// Copy the generic probation RTP packet header into the buffer.
-		std::memcpy(this->probationPacketBuffer, ProbationPacketHeader, ProbationPacketHeaderSize);
+		std::memcpy(
+		  RtpProbationGenerator::probationPacketBuffer,
+		  ProbationPacketHeader,
+		  ProbationPacketHeaderSize);
 
 		// Create the probation RTP packet.
-		this->probationPacket =
-		  RTC::RtpPacket::Parse(this->probationPacketBuffer, MaxProbationPacketSize);
+		RtpProbationGenerator::probationPacket =
+		  RTC::RtpPacket::Parse(RtpProbationGenerator::probationPacketBuffer, MaxProbationPacketSize);
+
+		auto* probationPacket = RtpProbationGenerator::probationPacket;
 
 		// Sex fixed codec payload type.
-		this->probationPacket->SetPayloadType(RTC::RtpProbationCodecPayloadType);
+		probationPacket->SetPayloadType(RTC::RtpProbationCodecPayloadType);
 
 		// Set fixed SSRC.
-		this->probationPacket->SetSsrc(RTC::RtpProbationSsrc);
+		probationPacket->SetSsrc(RTC::RtpProbationSsrc);
 
 		// Set random initial RTP seq number and timestamp.
-		this->probationPacket->SetSequenceNumber(
+		probationPacket->SetSequenceNumber(
 		  static_cast<uint16_t>(Utils::Crypto::GetRandomUInt(0, 65535)));
-		this->probationPacket->SetTimestamp(Utils::Crypto::GetRandomUInt(0, 4294967295));
+		probationPacket->SetTimestamp(Utils::Crypto::GetRandomUInt(0, 4294967295));
 
 		// Add BWE related RTP header extensions.
 		thread_local static uint8_t buffer[4096];
@@ -107,56 +161,17 @@ namespace RTC
 		}
 
 		// Set the extensions into the packet using One-Byte format.
-		this->probationPacket->SetExtensions(1, extensions);
+		probationPacket->SetExtensions(1, extensions);
 
 		// Set our urn:ietf:params:rtp-hdrext:sdes:mid extension id.
-		this->probationPacket->SetMidExtensionId(
-		  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::MID));
+		probationPacket->SetMidExtensionId(static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::MID));
 
 		// Set our abs-send-time extension id.
-		this->probationPacket->SetAbsSendTimeExtensionId(
+		probationPacket->SetAbsSendTimeExtensionId(
 		  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::ABS_SEND_TIME));
 
 		// Set our transport-wide-cc-01 extension id.
-		this->probationPacket->SetTransportWideCc01ExtensionId(
+		probationPacket->SetTransportWideCc01ExtensionId(
 		  static_cast<uint8_t>(RTC::RtpHeaderExtensionUri::Type::TRANSPORT_WIDE_CC_01));
 	}
-
-	RtpProbationGenerator::~RtpProbationGenerator()
-	{
-		MS_TRACE();
-
-		// Delete the probation packet buffer.
-		delete[] this->probationPacketBuffer;
-
-		// Delete the probation RTP packet.
-		delete this->probationPacket;
-	}
-
-	RTC::RtpPacket* RtpProbationGenerator::GetNextPacket(size_t size)
-	{
-		MS_TRACE();
-
-		// Make the packet length fit into our available limits.
-		if (size > MaxProbationPacketSize)
-			size = MaxProbationPacketSize;
-		else if (size < ProbationPacketHeaderSize)
-			size = ProbationPacketHeaderSize;
-
-		// Just send up to StepNumPackets per step.
-		// Increase RTP seq number and timestamp.
-		auto seq       = this->probationPacket->GetSequenceNumber();
-		auto timestamp = this->probationPacket->GetTimestamp();
-
-		++seq;
-		timestamp += 20u;
-
-		this->probationPacket->SetSequenceNumber(seq);
-		this->probationPacket->SetTimestamp(timestamp);
-
-		// Set probation packet payload size.
-		this->probationPacket->SetPayloadLength(size - ProbationPacketHeaderSize);
-
-		return this->probationPacket;
-	}
 } // namespace RTC
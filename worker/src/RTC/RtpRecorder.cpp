@@ -0,0 +1,222 @@
+#define MS_CLASS "RTC::RtpRecorder"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/RtpRecorder.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "ThreadPlacement.hpp"
+#include "Utils.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring> // std::memcpy(), std::strerror()
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>  // open()
+#include <unistd.h> // write(), close()
+#endif
+
+namespace RTC
+{
+	/* Static. */
+
+	// rtpdump file header: text line, start time, source address and port.
+	static constexpr char FileHeaderLine[]{ "#!rtpplay1.0 0.0.0.0/0\n" };
+	static constexpr size_t FileHeaderBinarySize{ 16u };
+	// rtpdump packet header: length (including it), RTP length (0 for RTCP) and
+	// offset.
+	static constexpr size_t PacketHeaderSize{ 8u };
+	// Size above which the helper thread writes the packets got so far.
+	static constexpr size_t BatchSize{ 65536u };
+
+#ifndef _WIN32
+	static bool writeAll(int fd, const uint8_t* data, size_t len)
+	{
+		while (len > 0u)
+		{
+			auto written = write(fd, data, len);
+
+			if (written < 0 && errno == EINTR)
+				continue;
+			else if (written <= 0)
+				return false;
+
+			data += written;
+			len -= static_cast<size_t>(written);
+		}
+
+		return true;
+	}
+#endif
+
+	/* Instance methods. */
+
+	RtpRecorder::RtpRecorder(const std::string& path) : path(path)
+	{
+		MS_TRACE();
+
+#ifdef _WIN32
+		MS_THROW_ERROR("recordPath is not supported on Windows");
+#else
+		this->fd = open(this->path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+		if (this->fd == -1)
+			MS_THROW_ERROR("open() failed for '%s': %s", this->path.c_str(), std::strerror(errno));
+
+		auto sinceEpochUs = std::chrono::duration_cast<std::chrono::microseconds>(
+		                      std::chrono::system_clock::now().time_since_epoch())
+		                      .count();
+		uint8_t fileHeader[sizeof(FileHeaderLine) - 1 + FileHeaderBinarySize]{};
+		uint8_t* binaryHeader = fileHeader + sizeof(FileHeaderLine) - 1;
+
+		std::memcpy(fileHeader, FileHeaderLine, sizeof(FileHeaderLine) - 1);
+		Utils::Byte::Set4Bytes(binaryHeader, 0, static_cast<uint32_t>(sinceEpochUs / 1000000));
+		Utils::Byte::Set4Bytes(binaryHeader, 4, static_cast<uint32_t>(sinceEpochUs % 1000000));
+
+		if (!writeAll(this->fd, fileHeader, sizeof(fileHeader)))
+		{
+			auto error = errno;
+
+			close(this->fd);
+
+			MS_THROW_ERROR("write() failed for '%s': %s", this->path.c_str(), std::strerror(error));
+		}
+
+		this->startMs = DepLibUV::GetTimeMs();
+		this->thread  = std::thread(&RtpRecorder::ThreadMain, this);
+
+		try
+		{
+			ThreadPlacement::ApplyToHelperThread(this->thread);
+		}
+		catch (const MediaSoupError&)
+		{
+			this->stopping.store(true, std::memory_order_release);
+			this->thread.join();
+
+			close(this->fd);
+
+			throw;
+		}
+#endif
+	}
+
+	RtpRecorder::~RtpRecorder()
+	{
+		MS_TRACE();
+
+#ifndef _WIN32
+		// The helper thread writes remaining packets before exiting.
+		this->stopping.store(true, std::memory_order_release);
+
+		if (this->thread.joinable())
+			this->thread.join();
+
+		if (this->fd != -1)
+			close(this->fd);
+#endif
+	}
+
+	void RtpRecorder::FillJsonStats(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		// Add path.
+		jsonObject["path"] = this->path;
+
+		// Add packets.
+		jsonObject["packets"] = this->recordedPackets;
+
+		// Add droppedPackets.
+		jsonObject["droppedPackets"] = this->droppedPackets;
+
+		// Add bytes.
+		jsonObject["bytes"] = this->writtenBytes.load(std::memory_order_relaxed);
+
+		// Add writeErrors.
+		jsonObject["writeErrors"] = this->writeErrors.load(std::memory_order_relaxed);
+	}
+
+	bool RtpRecorder::Record(const uint8_t* data, size_t len, bool isRtcp)
+	{
+		MS_TRACE();
+
+		auto* item = len <= RTC::MtuSize ? this->queue.Reserve() : nullptr;
+
+		if (!item)
+		{
+			this->droppedPackets++;
+
+			return false;
+		}
+
+		item->offsetMs = static_cast<uint32_t>(DepLibUV::GetTimeMs() - this->startMs);
+		item->len      = static_cast<uint16_t>(len);
+		item->isRtcp   = isRtcp;
+
+		std::memcpy(item->data, data, len);
+
+		this->queue.Commit();
+		this->recordedPackets++;
+
+		return true;
+	}
+
+	void RtpRecorder::ThreadMain()
+	{
+		// NOTE: No logging here since the Logger only works in the loop thread.
+
+#ifndef _WIN32
+		std::vector<uint8_t> batch;
+
+		batch.reserve(BatchSize + PacketHeaderSize + RTC::MtuSize);
+
+		auto flush = [this, &batch]()
+		{
+			if (batch.empty())
+				return;
+
+			if (writeAll(this->fd, batch.data(), batch.size()))
+				this->writtenBytes.fetch_add(batch.size(), std::memory_order_relaxed);
+			// Nothing else to do, packets are lost.
+			else
+				this->writeErrors.fetch_add(1u, std::memory_order_relaxed);
+
+			batch.clear();
+		};
+
+		while (true)
+		{
+			// Read it before draining so no packet recorded before stopping is lost.
+			const bool stopping = this->stopping.load(std::memory_order_acquire);
+			Item* item;
+
+			while ((item = this->queue.Front()))
+			{
+				auto pos = batch.size();
+
+				batch.resize(pos + PacketHeaderSize + item->len);
+
+				Utils::Byte::Set2Bytes(
+				  batch.data(), pos, static_cast<uint16_t>(PacketHeaderSize + item->len));
+				Utils::Byte::Set2Bytes(
+				  batch.data(), pos + 2, item->isRtcp ? uint16_t{ 0u } : item->len);
+				Utils::Byte::Set4Bytes(batch.data(), pos + 4, item->offsetMs);
+				std::memcpy(batch.data() + pos + PacketHeaderSize, item->data, item->len);
+
+				this->queue.Pop();
+
+				if (batch.size() >= BatchSize)
+					flush();
+			}
+
+			if (!batch.empty())
+				flush();
+			else if (stopping)
+				return;
+			else
+				std::this_thread::sleep_for(std::chrono::milliseconds(IdleIntervalMs));
+		}
+#endif
+	}
+} // namespace RTC
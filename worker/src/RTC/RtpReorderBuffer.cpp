@@ -0,0 +1,195 @@
+#define MS_CLASS "RTC::RtpReorderBuffer"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/RtpReorderBuffer.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+
+namespace RTC
+{
+	/* Static. */
+
+	static constexpr uint16_t SlotMask{ RTC::RtpReorderBuffer::MaxPackets - 1 };
+
+	/* Instance methods. */
+
+	RtpReorderBuffer::RtpReorderBuffer(
+	  Listener* listener, uint32_t delay, bool useNack, uint32_t sendNackDelayMs)
+	  : listener(listener), delay(delay), useNack(useNack), sendNackDelayMs(sendNackDelayMs)
+	{
+		MS_TRACE();
+
+		this->timer = new Timer(this);
+	}
+
+	RtpReorderBuffer::~RtpReorderBuffer()
+	{
+		MS_TRACE();
+
+		delete this->timer;
+	}
+
+	void RtpReorderBuffer::FillJson(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		jsonObject["reorderedPackets"] = this->reorderedPackets;
+		jsonObject["nacksAvoided"]     = this->nacksAvoided;
+		jsonObject["skippedPackets"]   = this->skippedPackets;
+	}
+
+	bool RtpReorderBuffer::Insert(RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		const uint16_t seq = packet->GetSequenceNumber();
+
+		if (!this->started)
+		{
+			this->started = true;
+			this->lastSeq = seq;
+
+			return false;
+		}
+
+		const uint16_t diff = seq - this->lastSeq;
+
+		// Old or duplicated packet (too late to be reordered).
+		if (diff == 0u || diff >= 0x8000)
+			return false;
+
+		// The expected packet.
+		if (diff == 1u)
+		{
+			this->lastSeq = seq;
+
+			// It fills a gap.
+			if (this->numHeldPackets != 0u)
+			{
+				++this->reorderedPackets;
+
+				// clang-format off
+				if (
+					this->useNack &&
+					DepLibUV::GetTimeMs() - this->gapDetectedAtMs >= this->sendNackDelayMs
+				)
+				// clang-format on
+				{
+					++this->nacksAvoided;
+				}
+			}
+
+			return false;
+		}
+
+		// Too far ahead (or too big to be held), so give up the gap.
+		if (diff > MaxPackets || packet->GetSize() > RTC::MtuSize)
+		{
+			MS_DEBUG_DEV(
+			  "cannot hold packet, releasing all [ssrc:%" PRIu32 ", seq:%" PRIu16 "]",
+			  packet->GetSsrc(),
+			  seq);
+
+			ReleaseAll();
+
+			// Packets in between are given up too.
+			this->skippedPackets += static_cast<uint16_t>(seq - this->lastSeq - 1);
+			this->lastSeq = seq;
+
+			return false;
+		}
+
+		auto& slot = this->packets[seq & SlotMask];
+
+		// Already held, so drop it.
+		if (slot)
+			return true;
+
+		slot = packet->GetSharedClone();
+
+		if (++this->numHeldPackets == 1u)
+		{
+			this->gapDetectedAtMs = DepLibUV::GetTimeMs();
+
+			this->timer->Start(this->delay);
+		}
+
+		return true;
+	}
+
+	void RtpReorderBuffer::Drain()
+	{
+		MS_TRACE();
+
+		while (this->numHeldPackets != 0u)
+		{
+			auto& slot = this->packets[static_cast<uint16_t>(this->lastSeq + 1) & SlotMask];
+
+			if (!slot)
+				break;
+
+			auto packet = std::move(slot);
+
+			--this->numHeldPackets;
+			++this->lastSeq;
+
+			this->listener->OnRtpReorderBufferPacket(this, packet.get());
+		}
+
+		if (this->numHeldPackets == 0u)
+			this->timer->Stop();
+	}
+
+	void RtpReorderBuffer::Clear()
+	{
+		MS_TRACE();
+
+		for (auto& slot : this->packets)
+		{
+			slot.reset();
+		}
+
+		this->numHeldPackets = 0u;
+		this->started        = false;
+
+		this->timer->Stop();
+	}
+
+	void RtpReorderBuffer::ReleaseAll()
+	{
+		MS_TRACE();
+
+		this->timer->Stop();
+
+		// Held packets are within the MaxPackets sequence numbers that follow
+		// the last processed one.
+		while (this->numHeldPackets != 0u)
+		{
+			++this->lastSeq;
+
+			auto& slot = this->packets[this->lastSeq & SlotMask];
+
+			if (!slot)
+			{
+				++this->skippedPackets;
+
+				continue;
+			}
+
+			auto packet = std::move(slot);
+
+			--this->numHeldPackets;
+
+			this->listener->OnRtpReorderBufferPacket(this, packet.get());
+		}
+	}
+
+	void RtpReorderBuffer::OnTimer(Timer* /*timer*/)
+	{
+		MS_TRACE();
+
+		MS_DEBUG_DEV("reorder delay expired, releasing %zu held packets", this->numHeldPackets);
+
+		ReleaseAll();
+	}
+} // namespace RTC
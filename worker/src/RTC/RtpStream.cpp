@@ -4,6 +4,7 @@
 #include "RTC/RtpStream.hpp"
 #include "Logger.hpp"
 #include "RTC/SeqManager.hpp"
+#include <cmath> // std::trunc()
 
 namespace RTC
 {
@@ -14,6 +15,40 @@ namespace RTC
 	static constexpr uint32_t RtpSeqMod{ 1 << 16 };
 	static constexpr size_t ScoreHistogramLength{ 24 };
 
+	/* Class methods. */
+
+	void RtpStream::ComputeScores(const ScoreSample* samples, uint8_t* scores, size_t count)
+	{
+		MS_TRACE();
+
+		for (size_t idx{ 0u }; idx < count; ++idx)
+		{
+			const auto& sample   = samples[idx];
+			auto packets         = static_cast<double>(sample.packets);
+			auto repaired        = static_cast<double>(sample.repaired);
+			auto retransmitted   = static_cast<double>(sample.retransmitted);
+			auto repairedRatio   = repaired / packets;
+			auto repairedWeight  = 1 / (repairedRatio + 1);
+			auto repairedPerSent = retransmitted > 0 ? repaired / retransmitted : 1.0;
+
+			// repairedWeight ^ 4.
+			repairedWeight *= repairedWeight;
+			repairedWeight *= repairedWeight * repairedPerSent;
+
+			// Lost packets not compensated by repaired ones (truncated as they are
+			// a packet count).
+			auto lost           = std::trunc(sample.lost - (repaired * repairedWeight));
+			auto deliveredRatio = (packets - lost) / packets;
+
+			// deliveredRatio ^ 4.
+			deliveredRatio *= deliveredRatio;
+			deliveredRatio *= deliveredRatio;
+
+			// Rounded (all the values are positive).
+			scores[idx] = static_cast<uint8_t>((deliveredRatio * 10) + 0.5);
+		}
+	}
+
 	/* Instance methods. */
 
 	RtpStream::RtpStream(
@@ -79,6 +114,41 @@ namespace RTC
 			jsonObject["roundTripTime"] = this->rtt;
 	}
 
+	void RtpStream::FillStatsRecord(StatsRegion::Record* record, uint64_t /*nowMs*/)
+	{
+		MS_TRACE();
+
+		record->ssrc = this->params.ssrc;
+
+		switch (this->params.mimeType.type)
+		{
+			case RTC::RtpCodecMimeType::Type::AUDIO:
+				record->kind = StatsRegion::RecordKind::AUDIO;
+				break;
+
+			case RTC::RtpCodecMimeType::Type::VIDEO:
+				record->kind = StatsRegion::RecordKind::VIDEO;
+				break;
+
+			default:
+				record->kind = StatsRegion::RecordKind::NONE;
+		}
+
+		record->score                = this->score;
+		record->fractionLost         = this->fractionLost;
+		record->packetsLost          = this->packetsLost;
+		record->packetsDiscarded     = this->packetsDiscarded;
+		record->packetsRetransmitted = this->packetsRetransmitted;
+		record->packetsRepaired      = this->packetsRepaired;
+		record->nackCount            = this->nackCount;
+		record->nackPacketCount      = this->nackPacketCount;
+		record->pliCount             = this->pliCount;
+		record->firCount             = this->firCount;
+
+		if (this->hasRtt)
+			record->roundTripTime = this->rtt;
+	}
+
 	void RtpStream::SetRtx(uint8_t payloadType, uint32_t ssrc)
 	{
 		MS_TRACE();
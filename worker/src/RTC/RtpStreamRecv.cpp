@@ -3,8 +3,12 @@
 
 #include "RTC/RtpStreamRecv.hpp"
 #include "Logger.hpp"
+#include "Tracepoints.hpp"
 #include "Utils.hpp"
 #include "RTC/Codecs/Tools.hpp"
+#include <algorithm> // std::find(), std::fill()
+#include <cmath>     // std::trunc(), std::ldexp(), std::llround()
+#include <limits>    // std::numeric_limits()
 
 namespace RTC
 {
@@ -12,122 +16,216 @@ namespace RTC
 
 	static constexpr uint64_t InactivityCheckInterval{ 1500u };        // In ms.
 	static constexpr uint64_t InactivityCheckIntervalWithDtx{ 5000u }; // In ms.
+	static constexpr uint64_t SweepInterval{ 250u };                   // In ms.
 
-	/* TransmissionCounter methods. */
+	/* Class variables. */
 
-	RtpStreamRecv::TransmissionCounter::TransmissionCounter(
-	  uint8_t spatialLayers, uint8_t temporalLayers, size_t windowSize)
+	thread_local std::vector<RtpStreamRecv*> RtpStreamRecv::sweepStreams;
+	thread_local std::vector<uint64_t> RtpStreamRecv::sweepInactiveAtMs;
+	thread_local std::vector<RtpStreamRecv*> RtpStreamRecv::sweepScoreStreams;
+	thread_local std::vector<RTC::RtpStream::ScoreSample> RtpStreamRecv::sweepScoreSamples;
+	thread_local std::vector<uint8_t> RtpStreamRecv::sweepScores;
+	thread_local RtpStreamRecv::SweepTimerListener RtpStreamRecv::sweepTimerListener;
+	thread_local Timer* RtpStreamRecv::sweepTimer{ nullptr };
+
+	/* Class methods. */
+
+	void RtpStreamRecv::AddToSweep(RtpStreamRecv* rtpStream)
 	{
 		MS_TRACE();
 
-		// Reserve vectors capacity.
-		this->spatialLayerCounters = std::vector<std::vector<RTC::RtpDataCounter>>(spatialLayers);
+		rtpStream->sweepIdx = RtpStreamRecv::sweepStreams.size();
+
+		RtpStreamRecv::sweepStreams.push_back(rtpStream);
+		RtpStreamRecv::sweepInactiveAtMs.push_back(std::numeric_limits<uint64_t>::max());
 
-		for (auto& spatialLayerCounter : this->spatialLayerCounters)
+		if (!RtpStreamRecv::sweepTimer)
 		{
-			for (uint8_t tIdx{ 0u }; tIdx < temporalLayers; ++tIdx)
-			{
-				spatialLayerCounter.emplace_back(RTC::RtpDataCounter(windowSize));
-			}
+			RtpStreamRecv::sweepTimer = new Timer(std::addressof(RtpStreamRecv::sweepTimerListener));
+
+			RtpStreamRecv::sweepTimer->Start(SweepInterval, SweepInterval);
 		}
 	}
 
-	void RtpStreamRecv::TransmissionCounter::Update(RTC::RtpPacket* packet)
+	void RtpStreamRecv::RemoveFromSweep(RtpStreamRecv* rtpStream)
 	{
 		MS_TRACE();
 
-		auto spatialLayer  = packet->GetSpatialLayer();
-		auto temporalLayer = packet->GetTemporalLayer();
+		auto& sweepStreams      = RtpStreamRecv::sweepStreams;
+		auto& sweepInactiveAtMs = RtpStreamRecv::sweepInactiveAtMs;
+		auto idx                = rtpStream->sweepIdx;
 
-		// Sanity check. Do not allow spatial layers higher than defined.
-		if (spatialLayer > this->spatialLayerCounters.size() - 1)
-			spatialLayer = this->spatialLayerCounters.size() - 1;
+		// Move the last one into its position.
+		sweepStreams[idx]           = sweepStreams.back();
+		sweepInactiveAtMs[idx]      = sweepInactiveAtMs.back();
+		sweepStreams[idx]->sweepIdx = idx;
 
-		// Sanity check. Do not allow temporal layers higher than defined.
-		if (temporalLayer > this->spatialLayerCounters[0].size() - 1)
-			temporalLayer = this->spatialLayerCounters[0].size() - 1;
+		sweepStreams.pop_back();
+		sweepInactiveAtMs.pop_back();
 
-		auto& counter = this->spatialLayerCounters[spatialLayer][temporalLayer];
+		if (rtpStream->scorePending)
+		{
+			auto& sweepScoreStreams = RtpStreamRecv::sweepScoreStreams;
 
-		counter.Update(packet);
+			sweepScoreStreams.erase(
+			  std::find(sweepScoreStreams.begin(), sweepScoreStreams.end(), rtpStream));
+		}
+
+		if (sweepStreams.empty())
+		{
+			delete RtpStreamRecv::sweepTimer;
+			RtpStreamRecv::sweepTimer = nullptr;
+		}
 	}
 
-	uint32_t RtpStreamRecv::TransmissionCounter::GetBitrate(uint64_t nowMs)
+	void RtpStreamRecv::Sweep(uint64_t nowMs)
 	{
 		MS_TRACE();
 
-		uint32_t rate{ 0u };
+		auto& sweepStreams      = RtpStreamRecv::sweepStreams;
+		auto& sweepInactiveAtMs = RtpStreamRecv::sweepInactiveAtMs;
 
-		for (auto& spatialLayerCounter : this->spatialLayerCounters)
+		for (size_t idx{ 0u }; idx < sweepStreams.size(); ++idx)
 		{
-			for (auto& temporalLayerCounter : spatialLayerCounter)
+			if (sweepInactiveAtMs[idx] > nowMs)
+				continue;
+
+			auto* rtpStream = sweepStreams[idx];
+
+			sweepInactiveAtMs[idx] = std::numeric_limits<uint64_t>::max();
+			rtpStream->inactive    = true;
+
+			if (rtpStream->GetScore() != 0)
 			{
-				rate += temporalLayerCounter.GetBitrate(nowMs);
+				MS_WARN_2TAGS(
+				  rtp,
+				  score,
+				  "RTP inactivity detected, resetting score to 0 [ssrc:%" PRIu32 "]",
+				  rtpStream->GetSsrc());
 			}
+
+			rtpStream->ResetScore(0, /*notify*/ true);
 		}
 
-		return rate;
+		auto& sweepScoreStreams = RtpStreamRecv::sweepScoreStreams;
+		auto& sweepScoreSamples = RtpStreamRecv::sweepScoreSamples;
+		auto& sweepScores       = RtpStreamRecv::sweepScores;
+
+		if (sweepScoreStreams.empty())
+			return;
+
+		sweepScoreSamples.resize(sweepScoreStreams.size());
+		sweepScores.resize(sweepScoreStreams.size());
+
+		// Gather the samples of the streams whose score must be computed (keeping
+		// those streams first) and compute all the scores at once.
+		size_t numSamples{ 0u };
+
+		for (auto* rtpStream : sweepScoreStreams)
+		{
+			rtpStream->scorePending = false;
+
+			if (rtpStream->TakeScoreSample(sweepScoreSamples[numSamples]))
+				sweepScoreStreams[numSamples++] = rtpStream;
+		}
+
+		RTC::RtpStream::ComputeScores(sweepScoreSamples.data(), sweepScores.data(), numSamples);
+
+		// NOTE: The listener is just called if the score changes.
+		for (size_t idx{ 0u }; idx < numSamples; ++idx)
+		{
+			sweepScoreStreams[idx]->UpdateScore(sweepScores[idx]);
+		}
+
+		sweepScoreStreams.clear();
 	}
 
-	uint32_t RtpStreamRecv::TransmissionCounter::GetBitrate(
-	  uint64_t nowMs, uint8_t spatialLayer, uint8_t temporalLayer)
+	/* TransmissionCounter methods. */
+
+	RtpStreamRecv::TransmissionCounter::TransmissionCounter(
+	  uint8_t spatialLayers, uint8_t temporalLayers, size_t windowSize)
+	  : spatialLayers(spatialLayers), temporalLayers(temporalLayers),
+	    numLayers(static_cast<size_t>(spatialLayers) * temporalLayers), windowSizeMs(windowSize),
+	    slotSizeMs(std::max<size_t>(windowSize / NumSlots, 1u))
 	{
 		MS_TRACE();
 
-		MS_ASSERT(spatialLayer < this->spatialLayerCounters.size(), "spatialLayer too high");
-		MS_ASSERT(
-		  temporalLayer < this->spatialLayerCounters[spatialLayer].size(), "temporalLayer too high");
+		this->slotBytes.resize((NumSlots + 1) * this->numLayers);
+		this->layerBitrates.resize(this->numLayers);
+		this->accumulatedLayerBitrates.resize(this->numLayers);
+	}
 
-		// Return 0 if specified layers are not being received.
-		auto& counter = this->spatialLayerCounters[spatialLayer][temporalLayer];
+	void RtpStreamRecv::TransmissionCounter::Update(RTC::RtpPacket* packet, uint64_t nowMs)
+	{
+		MS_TRACE();
 
-		if (counter.GetBitrate(nowMs) == 0)
-			return 0u;
+		size_t spatialLayer  = packet->GetSpatialLayer();
+		size_t temporalLayer = packet->GetTemporalLayer();
 
-		uint32_t rate{ 0u };
+		// Sanity check. Do not allow spatial layers higher than defined.
+		if (spatialLayer > this->spatialLayers - 1)
+			spatialLayer = this->spatialLayers - 1;
 
-		// Iterate all temporal layers of spatial layers previous to the given one.
-		for (uint8_t sIdx{ 0u }; sIdx < spatialLayer; ++sIdx)
-		{
-			for (uint8_t tIdx{ 0u }; tIdx < this->spatialLayerCounters[sIdx].size(); ++tIdx)
-			{
-				auto& temporalLayerCounter = this->spatialLayerCounters[sIdx][tIdx];
+		// Sanity check. Do not allow temporal layers higher than defined.
+		if (temporalLayer > this->temporalLayers - 1)
+			temporalLayer = this->temporalLayers - 1;
 
-				rate += temporalLayerCounter.GetBitrate(nowMs);
-			}
-		}
+		AdvanceSlots(nowMs);
 
-		// Add the given spatial layer with up to the given temporal layer.
-		for (uint8_t tIdx{ 0u }; tIdx <= temporalLayer; ++tIdx)
-		{
-			auto& temporalLayerCounter = this->spatialLayerCounters[spatialLayer][tIdx];
+		const size_t layerIdx = (spatialLayer * this->temporalLayers) + temporalLayer;
+		const auto size       = static_cast<uint32_t>(packet->GetSize());
 
-			rate += temporalLayerCounter.GetBitrate(nowMs);
-		}
+		this->slotBytes[(this->currentSlot * this->numLayers) + layerIdx] += size;
+		this->slotBytes[(NumSlots * this->numLayers) + layerIdx] += size;
 
-		return rate;
+		++this->packetCount;
+		this->bytes += size;
+	}
+
+	uint32_t RtpStreamRecv::TransmissionCounter::GetBitrate(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		UpdateLayerBitrates(nowMs);
+
+		return this->accumulatedLayerBitrates.back();
+	}
+
+	uint32_t RtpStreamRecv::TransmissionCounter::GetBitrate(
+	  uint64_t nowMs, uint8_t spatialLayer, uint8_t temporalLayer)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(spatialLayer < this->spatialLayers, "spatialLayer too high");
+		MS_ASSERT(temporalLayer < this->temporalLayers, "temporalLayer too high");
+
+		UpdateLayerBitrates(nowMs);
+
+		const size_t layerIdx = (spatialLayer * this->temporalLayers) + temporalLayer;
+
+		// Return 0 if specified layers are not being received.
+		if (this->layerBitrates[layerIdx] == 0)
+			return 0u;
+
+		// All temporal layers of spatial layers previous to the given one plus the
+		// given spatial layer with up to the given temporal layer.
+		return this->accumulatedLayerBitrates[layerIdx];
 	}
 
 	uint32_t RtpStreamRecv::TransmissionCounter::GetSpatialLayerBitrate(uint64_t nowMs, uint8_t spatialLayer)
 	{
 		MS_TRACE();
 
-		MS_ASSERT(spatialLayer < this->spatialLayerCounters.size(), "spatialLayer too high");
+		MS_ASSERT(spatialLayer < this->spatialLayers, "spatialLayer too high");
 
-		uint32_t rate{ 0u };
+		UpdateLayerBitrates(nowMs);
 
-		// clang-format off
-		for (
-			uint8_t tIdx{ 0u };
-			tIdx < this->spatialLayerCounters[spatialLayer].size();
-			++tIdx
-		)
-		// clang-format on
-		{
-			auto& temporalLayerCounter = this->spatialLayerCounters[spatialLayer][tIdx];
+		const size_t lastLayerIdx = ((spatialLayer + 1) * this->temporalLayers) - 1;
+		uint32_t rate             = this->accumulatedLayerBitrates[lastLayerIdx];
 
-			rate += temporalLayerCounter.GetBitrate(nowMs);
-		}
+		// Subtract spatial layers previous to the given one.
+		if (spatialLayer > 0)
+			rate -= this->accumulatedLayerBitrates[(spatialLayer * this->temporalLayers) - 1];
 
 		return rate;
 	}
@@ -137,47 +235,84 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		MS_ASSERT(spatialLayer < this->spatialLayerCounters.size(), "spatialLayer too high");
-		MS_ASSERT(
-		  temporalLayer < this->spatialLayerCounters[spatialLayer].size(), "temporalLayer too high");
+		MS_ASSERT(spatialLayer < this->spatialLayers, "spatialLayer too high");
+		MS_ASSERT(temporalLayer < this->temporalLayers, "temporalLayer too high");
 
-		auto& counter = this->spatialLayerCounters[spatialLayer][temporalLayer];
+		UpdateLayerBitrates(nowMs);
 
-		return counter.GetBitrate(nowMs);
+		return this->layerBitrates[(spatialLayer * this->temporalLayers) + temporalLayer];
 	}
 
-	size_t RtpStreamRecv::TransmissionCounter::GetPacketCount() const
+	inline void RtpStreamRecv::TransmissionCounter::AdvanceSlots(uint64_t nowMs)
 	{
 		MS_TRACE();
 
-		size_t packetCount{ 0u };
+		// Ignore time going backwards (should never happen) and the current slot.
+		if (this->slotsStarted && nowMs < this->currentSlotStartMs + this->slotSizeMs)
+			return;
+
+		auto* windowBytes = this->slotBytes.data() + (NumSlots * this->numLayers);
+		size_t elapsedSlots =
+		  this->slotsStarted ? (nowMs - this->currentSlotStartMs) / this->slotSizeMs : NumSlots;
 
-		for (auto& spatialLayerCounter : this->spatialLayerCounters)
+		// The whole window expired.
+		if (elapsedSlots >= NumSlots)
 		{
-			for (auto& temporalLayerCounter : spatialLayerCounter)
+			std::fill(this->slotBytes.begin(), this->slotBytes.end(), 0u);
+
+			this->currentSlot        = 0u;
+			this->currentSlotStartMs = nowMs;
+			this->slotsStarted       = true;
+
+			return;
+		}
+
+		// Clear the slots reused for the elapsed time, taking their bytes out of
+		// the window.
+		for (size_t i{ 0u }; i < elapsedSlots; ++i)
+		{
+			if (++this->currentSlot == NumSlots)
+				this->currentSlot = 0u;
+
+			auto* bytes = this->slotBytes.data() + (this->currentSlot * this->numLayers);
+
+			for (size_t layerIdx{ 0u }; layerIdx < this->numLayers; ++layerIdx)
 			{
-				packetCount += temporalLayerCounter.GetPacketCount();
+				windowBytes[layerIdx] -= bytes[layerIdx];
+				bytes[layerIdx] = 0u;
 			}
 		}
 
-		return packetCount;
+		this->currentSlotStartMs += elapsedSlots * this->slotSizeMs;
 	}
 
-	size_t RtpStreamRecv::TransmissionCounter::GetBytes() const
+	inline void RtpStreamRecv::TransmissionCounter::UpdateLayerBitrates(uint64_t nowMs)
 	{
 		MS_TRACE();
 
-		size_t bytes{ 0u };
+		// NOTE: Packets received within the same millisecond do not invalidate
+		// the snapshot.
+		if (this->layerBitratesValid && nowMs == this->layerBitratesTimeMs)
+			return;
+
+		AdvanceSlots(nowMs);
 
-		for (const auto& spatialLayerCounter : this->spatialLayerCounters)
+		const auto* windowBytes = this->slotBytes.data() + (NumSlots * this->numLayers);
+		const float scale       = RTC::RateCalculator::DefaultBpsScale / this->windowSizeMs;
+		uint32_t accumulatedBitrate{ 0u };
+
+		for (size_t layerIdx{ 0u }; layerIdx < this->numLayers; ++layerIdx)
 		{
-			for (const auto& temporalLayerCounter : spatialLayerCounter)
-			{
-				bytes += temporalLayerCounter.GetBytes();
-			}
+			auto bitrate = static_cast<uint32_t>(std::trunc((windowBytes[layerIdx] * scale) + 0.5f));
+
+			accumulatedBitrate += bitrate;
+
+			this->layerBitrates[layerIdx]            = bitrate;
+			this->accumulatedLayerBitrates[layerIdx] = accumulatedBitrate;
 		}
 
-		return bytes;
+		this->layerBitratesTimeMs = nowMs;
+		this->layerBitratesValid  = true;
 	}
 
 	/* Instance methods. */
@@ -193,23 +328,27 @@ namespace RTC
 		if (this->params.useNack)
 			this->nackGenerator.reset(new RTC::NackGenerator(this, this->sendNackDelayMs));
 
-		// Run the RTP inactivity periodic timer (use a different timeout if DTX is
-		// enabled).
-		this->inactivityCheckPeriodicTimer = new Timer(this);
-		this->inactive                     = false;
-
+		// Check RTP inactivity in the worker level sweep (use a different timeout
+		// if DTX is enabled).
 		if (!this->params.useDtx)
-			this->inactivityCheckPeriodicTimer->Start(InactivityCheckInterval);
+			this->inactivityTimeoutMs = InactivityCheckInterval;
 		else
-			this->inactivityCheckPeriodicTimer->Start(InactivityCheckIntervalWithDtx);
+			this->inactivityTimeoutMs = InactivityCheckIntervalWithDtx;
+
+		RtpStreamRecv::AddToSweep(this);
+
+		SetInactiveAt(DepLibUV::GetTimeMs() + this->inactivityTimeoutMs);
 	}
 
 	RtpStreamRecv::~RtpStreamRecv()
 	{
 		MS_TRACE();
 
-		// Close the RTP inactivity check periodic timer.
-		delete this->inactivityCheckPeriodicTimer;
+		RtpStreamRecv::RemoveFromSweep(this);
+
+		// Delete the FEC receiver.
+		delete this->fecReceiver;
+		this->fecReceiver = nullptr;
 	}
 
 	void RtpStreamRecv::FillJsonStats(json& jsonObject)
@@ -226,6 +365,10 @@ namespace RTC
 		jsonObject["byteCount"]   = this->transmissionCounter.GetBytes();
 		jsonObject["bitrate"]     = this->transmissionCounter.GetBitrate(nowMs);
 
+		// Add captureLatency.
+		if (this->captureLatency)
+			this->captureLatency->FillJson(jsonObject["captureLatency"], 1.0, /*withBuckets*/ false);
+
 		if (GetSpatialLayers() > 1 || GetTemporalLayers() > 1)
 		{
 			jsonObject["bitrateByLayer"] = json::object();
@@ -242,10 +385,36 @@ namespace RTC
 		}
 	}
 
+	void RtpStreamRecv::FillStatsRecord(StatsRegion::Record* record, uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		RTC::RtpStream::FillStatsRecord(record, nowMs);
+
+		record->jitter      = this->jitter;
+		record->packetCount = this->transmissionCounter.GetPacketCount();
+		record->byteCount   = this->transmissionCounter.GetBytes();
+		record->bitrate     = this->transmissionCounter.GetBitrate(nowMs);
+	}
+
 	bool RtpStreamRecv::ReceivePacket(RTC::RtpPacket* packet)
 	{
 		MS_TRACE();
 
+		const bool isFecRecovered = this->fecReceiver && this->fecReceiver->IsRecoveredPacket(packet);
+
+		// Keep the packet for FEC recovery. If it was already recovered (or
+		// received) there is no need to forward it again.
+		if (this->fecReceiver && !isFecRecovered && !this->fecReceiver->AddPacket(packet))
+		{
+			MS_DEBUG_DEV(
+			  "ignoring packet already received or recovered by FEC [ssrc:%" PRIu32 ", seq:%" PRIu16 "]",
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber());
+
+			return false;
+		}
+
 		// Call the parent method.
 		if (!RTC::RtpStream::ReceivePacket(packet))
 		{
@@ -256,13 +425,18 @@ namespace RTC
 
 		// Process the packet at codec level.
 		if (packet->GetPayloadType() == GetPayloadType())
-			RTC::Codecs::Tools::ProcessRtpPacket(packet, GetMimeType());
+		{
+			RTC::Codecs::Tools::ProcessRtpPacket(packet, GetMimeType(), &this->av1TemplateStructure);
+		}
+
+		bool retransmitted{ false };
 
 		// Pass the packet to the NackGenerator.
 		if (this->params.useNack)
 		{
-			// If there is RTX just provide the NackGenerator with the packet.
-			if (HasRtx())
+			// If there is RTX or the packet was recovered by FEC just provide the
+			// NackGenerator with the packet (it may remove it from the NACK list).
+			if (HasRtx() || isFecRecovered)
 			{
 				this->nackGenerator->ReceivePacket(packet, /*isRecovered*/ false);
 			}
@@ -273,29 +447,31 @@ namespace RTC
 				// Mark the packet as retransmitted and repaired.
 				RTC::RtpStream::PacketRetransmitted(packet);
 				RTC::RtpStream::PacketRepaired(packet);
+
+				retransmitted = true;
 			}
 		}
 
-		// Calculate Jitter.
-		CalculateJitter(packet->GetTimestamp());
+		if (isFecRecovered)
+			RTC::RtpStream::PacketRepaired(packet);
 
-		// Increase transmission counter.
-		this->transmissionCounter.Update(packet);
+		// Single clock read for jitter, counters and inactivity.
+		const uint64_t nowMs = DepLibUV::GetTimeMs();
 
-		// Increase media transmission counter.
-		this->mediaTransmissionCounter.Update(packet);
+		const uint64_t arrivalMs = packet->GetArrivalTime() != 0u ? packet->GetArrivalTime() : nowMs;
 
-		// Not inactive anymore.
-		if (this->inactive)
-		{
-			this->inactive = false;
+		// Calculate Jitter (with the time the kernel received the packet if known).
+		CalculateJitter(packet->GetTimestamp(), arrivalMs);
 
-			ResetScore(10, /*notify*/ true);
-		}
+		ProcessAbsCaptureTime(packet, arrivalMs, retransmitted);
+
+		// Increase transmission counter.
+		this->transmissionCounter.Update(packet, nowMs);
+
+		// Increase media packet count.
+		++this->mediaPacketCount;
 
-		// Restart the inactivityCheckPeriodicTimer.
-		if (this->inactivityCheckPeriodicTimer)
-			this->inactivityCheckPeriodicTimer->Restart();
+		PacketReceived(nowMs);
 
 		return true;
 	}
@@ -362,6 +538,17 @@ namespace RTC
 		  packet->GetSsrc(),
 		  packet->GetSequenceNumber());
 
+		// Ignore it if already recovered by FEC.
+		if (this->fecReceiver && !this->fecReceiver->AddPacket(packet))
+		{
+			MS_DEBUG_DEV(
+			  "ignoring RTX packet already recovered by FEC [ssrc:%" PRIu32 ", seq:%" PRIu16 "]",
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber());
+
+			return false;
+		}
+
 		// If not a valid packet ignore it.
 		if (!RTC::RtpStream::UpdateSeq(packet))
 		{
@@ -376,7 +563,9 @@ namespace RTC
 
 		// Process the packet at codec level.
 		if (packet->GetPayloadType() == GetPayloadType())
-			RTC::Codecs::Tools::ProcessRtpPacket(packet, GetMimeType());
+		{
+			RTC::Codecs::Tools::ProcessRtpPacket(packet, GetMimeType(), &this->av1TemplateStructure);
+		}
 
 		// Mark the packet as retransmitted.
 		RTC::RtpStream::PacketRetransmitted(packet);
@@ -389,19 +578,13 @@ namespace RTC
 			RTC::RtpStream::PacketRepaired(packet);
 
 			// Increase transmission counter.
-			this->transmissionCounter.Update(packet);
+			const uint64_t nowMs = DepLibUV::GetTimeMs();
 
-			// Not inactive anymore.
-			if (this->inactive)
-			{
-				this->inactive = false;
+			ProcessAbsCaptureTime(packet, nowMs, /*retransmitted*/ true);
 
-				ResetScore(10, /*notify*/ true);
-			}
+			this->transmissionCounter.Update(packet, nowMs);
 
-			// Restart the inactivityCheckPeriodicTimer.
-			if (this->inactivityCheckPeriodicTimer)
-				this->inactivityCheckPeriodicTimer->Restart();
+			PacketReceived(nowMs);
 
 			return true;
 		}
@@ -409,6 +592,41 @@ namespace RTC
 		return false;
 	}
 
+	void RtpStreamRecv::SetFec(uint8_t payloadType, uint32_t ssrc)
+	{
+		MS_TRACE();
+
+		delete this->fecReceiver;
+
+		this->fecReceiver = new RTC::FlexFecReceiver(payloadType, ssrc, GetSsrc());
+	}
+
+	RTC::RtpPacket* RtpStreamRecv::ReceiveFecPacket(RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		if (!this->fecReceiver)
+			return nullptr;
+
+		MS_ASSERT(packet->GetSsrc() == this->fecReceiver->GetSsrc(), "invalid ssrc on FEC packet");
+
+		// Check that the payload type corresponds to the one negotiated.
+		if (packet->GetPayloadType() != this->fecReceiver->GetPayloadType())
+		{
+			MS_WARN_TAG(
+			  rtp,
+			  "ignoring FEC packet with invalid payload type [ssrc:%" PRIu32 ", seq:%" PRIu16
+			  ", pt:%" PRIu8 "]",
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  packet->GetPayloadType());
+
+			return nullptr;
+		}
+
+		return this->fecReceiver->ReceiveFecPacket(packet);
+	}
+
 	RTC::RTCP::ReceiverReport* RtpStreamRecv::GetRtcpReceiverReport()
 	{
 		MS_TRACE();
@@ -434,8 +652,8 @@ namespace RTC
 		// Calculate Packets Expected and Lost.
 		auto expected = GetExpectedPackets();
 
-		if (expected > this->mediaTransmissionCounter.GetPacketCount())
-			this->packetsLost = expected - this->mediaTransmissionCounter.GetPacketCount();
+		if (expected > this->mediaPacketCount)
+			this->packetsLost = expected - this->mediaPacketCount;
 		else
 			this->packetsLost = 0u;
 
@@ -444,9 +662,9 @@ namespace RTC
 
 		this->expectedPrior = expected;
 
-		uint32_t receivedInterval = this->mediaTransmissionCounter.GetPacketCount() - this->receivedPrior;
+		uint32_t receivedInterval = this->mediaPacketCount - this->receivedPrior;
 
-		this->receivedPrior = this->mediaTransmissionCounter.GetPacketCount();
+		this->receivedPrior = this->mediaPacketCount;
 
 		int32_t lostInterval = expectedInterval - receivedInterval;
 
@@ -526,8 +744,8 @@ namespace RTC
 		this->lastSenderReportNtpMs = Utils::Time::Ntp2TimeMs(ntp);
 		this->lastSenderReportTs    = report->GetRtpTs();
 
-		// Update the score with the current RR.
-		UpdateScore();
+		// Update the score with the current RR in the next sweep.
+		ScheduleScoreUpdate();
 	}
 
 	void RtpStreamRecv::ReceiveRtxRtcpSenderReport(RTC::RTCP::SenderReport* report)
@@ -580,6 +798,8 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		MS_TRACEPOINT(key_frame_requested, GetSsrc());
+
 		if (this->params.usePli)
 		{
 			MS_DEBUG_2TAGS(rtcp, rtx, "sending PLI [ssrc:%" PRIu32 "]", GetSsrc());
@@ -618,8 +838,7 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		if (this->inactivityCheckPeriodicTimer)
-			this->inactivityCheckPeriodicTimer->Stop();
+		SetInactiveAt(std::numeric_limits<uint64_t>::max());
 
 		if (this->params.useNack)
 			this->nackGenerator->Reset();
@@ -633,11 +852,11 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		if (this->inactivityCheckPeriodicTimer && !this->inactive)
-			this->inactivityCheckPeriodicTimer->Restart();
+		if (!this->inactive)
+			SetInactiveAt(DepLibUV::GetTimeMs() + this->inactivityTimeoutMs);
 	}
 
-	void RtpStreamRecv::CalculateJitter(uint32_t rtpTimestamp)
+	void RtpStreamRecv::CalculateJitter(uint32_t rtpTimestamp, uint64_t nowMs)
 	{
 		MS_TRACE();
 
@@ -645,7 +864,7 @@ namespace RTC
 			return;
 
 		auto transit =
-		  static_cast<int>(DepLibUV::GetTimeMs() - (rtpTimestamp * 1000 / this->params.clockRate));
+		  static_cast<int>(nowMs - (rtpTimestamp * 1000 / this->params.clockRate));
 		int d = transit - this->transit;
 
 		// First transit calculation, save and return.
@@ -664,7 +883,87 @@ namespace RTC
 		this->jitter += (1. / 16.) * (static_cast<double>(d) - this->jitter);
 	}
 
-	void RtpStreamRecv::UpdateScore()
+	void RtpStreamRecv::ProcessAbsCaptureTime(
+	  RTC::RtpPacket* packet, uint64_t arrivalMs, bool retransmitted)
+	{
+		MS_TRACE();
+
+		uint64_t absCaptureTimestamp;
+		int64_t estimatedCaptureClockOffset;
+
+		if (!packet->ReadAbsCaptureTime(absCaptureTimestamp, estimatedCaptureClockOffset))
+			return;
+
+		// The clock of the sender is unknown until a Sender Report is received.
+		if (this->lastSrReceived == 0u)
+			return;
+
+		Utils::Time::Ntp ntp; // NOLINT(cppcoreguidelines-pro-type-member-init)
+
+		ntp.seconds   = static_cast<uint32_t>(absCaptureTimestamp >> 32);
+		ntp.fractions = static_cast<uint32_t>(absCaptureTimestamp);
+
+		// Capture time in the clock of the sender (the clock offset is Q32.32).
+		double captureMs = static_cast<double>(Utils::Time::Ntp2TimeMs(ntp)) +
+		                   (std::ldexp(static_cast<double>(estimatedCaptureClockOffset), -32) * 1000);
+
+		// Map it to the worker clock with the last Sender Report, which took half
+		// the RTT to arrive (if known, otherwise the measured latency doesn't
+		// include the network delay).
+		captureMs +=
+		  static_cast<double>(this->lastSrReceived) - static_cast<double>(this->lastSenderReportNtpMs);
+
+		if (this->hasRtt)
+			captureMs -= this->rtt / 2;
+
+		if (captureMs < 0)
+			return;
+
+		if (!retransmitted && static_cast<double>(arrivalMs) >= captureMs)
+		{
+			if (!this->captureLatency)
+				this->captureLatency.reset(new Metrics::Histogram());
+
+			this->captureLatency->Record(
+			  static_cast<uint64_t>(std::llround(static_cast<double>(arrivalMs) - captureMs)));
+		}
+
+		// Consumers send Sender Reports with the worker clock, so make the capture
+		// time refer to it (with no clock offset) for receivers to compute the
+		// whole latency.
+		ntp = Utils::Time::TimeMs2Ntp(static_cast<uint64_t>(captureMs));
+
+		packet->UpdateAbsCaptureTime((static_cast<uint64_t>(ntp.seconds) << 32) | ntp.fractions);
+	}
+
+	inline void RtpStreamRecv::PacketReceived(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		// Not inactive anymore.
+		if (this->inactive)
+		{
+			this->inactive = false;
+
+			ResetScore(10, /*notify*/ true);
+		}
+
+		SetInactiveAt(nowMs + this->inactivityTimeoutMs);
+	}
+
+	void RtpStreamRecv::ScheduleScoreUpdate()
+	{
+		MS_TRACE();
+
+		if (this->scorePending)
+			return;
+
+		this->scorePending = true;
+
+		RtpStreamRecv::sweepScoreStreams.push_back(this);
+	}
+
+	bool RtpStreamRecv::TakeScoreSample(RTC::RtpStream::ScoreSample& sample)
 	{
 		MS_TRACE();
 
@@ -675,7 +974,7 @@ namespace RTC
 		this->expectedPriorScore = totalExpected;
 
 		// Calculate number of packets received in this interval.
-		auto totalReceived = this->mediaTransmissionCounter.GetPacketCount();
+		auto totalReceived = this->mediaPacketCount;
 		uint32_t received  = totalReceived - this->receivedPriorScore;
 
 		this->receivedPriorScore = totalReceived;
@@ -701,14 +1000,22 @@ namespace RTC
 		this->retransmittedPriorScore = totatRetransmitted;
 
 		if (this->inactive)
-			return;
+			return false;
 
 		// We didn't expect more packets to come.
 		if (expected == 0)
 		{
 			RTC::RtpStream::UpdateScore(10);
 
-			return;
+			return false;
+		}
+
+		// All the expected packets were lost.
+		if (received == 0)
+		{
+			RTC::RtpStream::UpdateScore(0);
+
+			return false;
 		}
 
 		if (lost > received)
@@ -746,50 +1053,21 @@ namespace RTC
 		  retransmitted);
 #endif
 
-		auto repairedRatio  = static_cast<float>(repaired) / static_cast<float>(received);
-		auto repairedWeight = std::pow(1 / (repairedRatio + 1), 4);
-
 		MS_ASSERT(retransmitted >= repaired, "repaired packets cannot be more than retransmitted ones");
 
-		if (retransmitted > 0)
-			repairedWeight *= static_cast<float>(repaired) / retransmitted;
+		sample.packets       = received;
+		sample.lost          = lost;
+		sample.repaired      = repaired;
+		sample.retransmitted = retransmitted;
 
-		lost -= repaired * repairedWeight;
-
-		auto deliveredRatio = static_cast<float>(received - lost) / static_cast<float>(received);
-		auto score          = static_cast<uint8_t>(std::round(std::pow(deliveredRatio, 4) * 10));
-
-#if MS_LOG_DEV_LEVEL == 3
-		MS_DEBUG_TAG(
-		  score,
-		  "[deliveredRatio:%f, repairedRatio:%f, repairedWeight:%f, new lost:%" PRIu32 ", score:%" PRIu8
-		  "]",
-		  deliveredRatio,
-		  repairedRatio,
-		  repairedWeight,
-		  lost,
-		  score);
-#endif
-
-		RtpStream::UpdateScore(score);
+		return true;
 	}
 
-	inline void RtpStreamRecv::OnTimer(Timer* timer)
+	inline void RtpStreamRecv::SweepTimerListener::OnTimer(Timer* /*timer*/)
 	{
 		MS_TRACE();
 
-		if (timer == this->inactivityCheckPeriodicTimer)
-		{
-			this->inactive = true;
-
-			if (GetScore() != 0)
-			{
-				MS_WARN_2TAGS(
-				  rtp, score, "RTP inactivity detected, resetting score to 0 [ssrc:%" PRIu32 "]", GetSsrc());
-			}
-
-			ResetScore(0, /*notify*/ true);
-		}
+		RtpStreamRecv::Sweep(DepLibUV::GetTimeMs());
 	}
 
 	inline void RtpStreamRecv::OnNackGeneratorNackRequired(const std::vector<uint16_t>& seqNumbers)
@@ -805,6 +1083,8 @@ namespace RTC
 		  seqNumbers[0],
 		  seqNumbers.size());
 
+		MS_TRACEPOINT(nack_sent, this->params.ssrc, seqNumbers[0], seqNumbers.size());
+
 		RTC::RTCP::FeedbackRtpNackPacket packet(0, GetSsrc());
 
 		auto it        = seqNumbers.begin();
@@ -2,9 +2,13 @@
 // #define MS_LOG_DEV_LEVEL 3
 
 #include "RTC/RtpStreamSend.hpp"
+#include "DepLibUV.hpp"
 #include "Logger.hpp"
+#include "Tracepoints.hpp"
 #include "Utils.hpp"
 #include "RTC/SeqManager.hpp"
+#include <algorithm> // std::min(), std::max(), std::find()
+#include <cstring>   // std::memcpy()
 
 namespace RTC
 {
@@ -12,11 +16,34 @@ namespace RTC
 
 	// 17: 16 bit mask + the initial sequence number.
 	static constexpr size_t MaxRequestedPackets{ 17 };
+	// Packets requested by the NACK items of a NACK packet are retransmitted
+	// together in batches of up to this size.
+	static constexpr size_t MaxRetransmissionBatchSize{ 4 * MaxRequestedPackets };
 	thread_local static std::vector<RTC::RtpStreamSend::StorageItem*> RetransmissionContainer(
-	  MaxRequestedPackets + 1);
+	  MaxRetransmissionBatchSize);
+	// Packets to be retransmitted for each item in the RetransmissionContainer
+	// and memory to hold them (with extra space for RTX encoding).
+	thread_local static std::vector<RTC::RtpPacket*> RetransmissionPackets(
+	  MaxRetransmissionBatchSize, nullptr);
+	thread_local static uint8_t RetransmissionBuffers[MaxRetransmissionBatchSize][RTC::MtuSize + 100];
+	// Stored packets retransmitted as they are (without RTX) instead of being
+	// copied into the RetransmissionBuffers, kept alive until cleared.
+	thread_local static std::vector<std::shared_ptr<RTC::RtpPacket>> RetransmissionStoredPackets(
+	  MaxRetransmissionBatchSize);
+	// RTX packet used as padding for probation and memory to hold it.
+	thread_local static std::unique_ptr<RTC::RtpPacket> PaddingPacket;
+	thread_local static uint8_t PaddingBuffer[RTC::MtuSize + 100];
+	// Number of most recently stored packets considered as padding.
+	static constexpr size_t MaxPaddingCandidates{ 16 };
 	// Don't retransmit packets older than this (ms).
 	static constexpr uint32_t MaxRetransmissionDelay{ 2000 };
 	static constexpr uint32_t DefaultRtt{ 100 };
+	// Packets are stored for this number of RTTs (but no less than
+	// MinStorageTimeMs) and the buffer is resized every StorageWindowMs.
+	static constexpr uint32_t StorageRtts{ 3 };
+	static constexpr uint32_t MinStorageTimeMs{ 1000 };
+	static constexpr uint64_t StorageWindowMs{ 1000 };
+	static constexpr size_t MinAdaptiveBufferSize{ 32 };
 
 	static void resetStorageItem(RTC::RtpStreamSend::StorageItem* storageItem)
 	{
@@ -24,22 +51,50 @@ namespace RTC
 
 		MS_ASSERT(storageItem, "storageItem cannot be nullptr");
 
-		delete storageItem->packet;
+		storageItem->packet.reset();
 
-		storageItem->packet     = nullptr;
 		storageItem->resentAtMs = 0;
 		storageItem->sentTimes  = 0;
-		storageItem->rtxEncoded = false;
+	}
+
+	static void clearRetransmissionPackets()
+	{
+		MS_TRACE();
+
+		for (size_t idx{ 0u }; idx < MaxRetransmissionBatchSize; ++idx)
+		{
+			// Stored packets are not owned.
+			if (RetransmissionStoredPackets[idx])
+				RetransmissionStoredPackets[idx].reset();
+			else
+				delete RetransmissionPackets[idx];
+
+			RetransmissionPackets[idx] = nullptr;
+		}
 	}
 
 	/* Instance methods. */
 
 	RtpStreamSend::RtpStreamSend(
 	  RTC::RtpStreamSend::Listener* listener, RTC::RtpStream::Params& params, size_t bufferSize)
-	  : RTC::RtpStream::RtpStream(listener, params, 10), buffer(bufferSize > 0 ? 65536 : 0, nullptr),
-	    storage(bufferSize)
+	  : RTC::RtpStream::RtpStream(listener, params, 10), maxBufferSize(bufferSize),
+	    adaptiveBufferSize(bufferSize)
 	{
 		MS_TRACE();
+
+		if (bufferSize == 0u)
+			return;
+
+		// Index packets by their seq modulo a power of 2 size that leaves room for
+		// sequence number gaps.
+		size_t indexSize{ 1u };
+
+		while (indexSize < bufferSize * 2 && indexSize < 65536u)
+		{
+			indexSize <<= 1;
+		}
+
+		this->buffer.resize(indexSize, nullptr);
 	}
 
 	RtpStreamSend::~RtpStreamSend()
@@ -48,6 +103,13 @@ namespace RTC
 
 		// Clear the RTP buffer.
 		ClearBuffer();
+
+		// Delete the FEC generator.
+		delete this->fecGenerator;
+		this->fecGenerator = nullptr;
+
+		// Free the last retransmitted packets (they may belong to this stream).
+		clearRetransmissionPackets();
 	}
 
 	void RtpStreamSend::FillJsonStats(json& jsonObject)
@@ -64,6 +126,17 @@ namespace RTC
 		jsonObject["bitrate"]     = this->transmissionCounter.GetBitrate(nowMs);
 	}
 
+	void RtpStreamSend::FillStatsRecord(StatsRegion::Record* record, uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		RTC::RtpStream::FillStatsRecord(record, nowMs);
+
+		record->packetCount = this->transmissionCounter.GetPacketCount();
+		record->byteCount   = this->transmissionCounter.GetBytes();
+		record->bitrate     = this->transmissionCounter.GetBitrate(nowMs);
+	}
+
 	void RtpStreamSend::SetRtx(uint8_t payloadType, uint32_t ssrc)
 	{
 		MS_TRACE();
@@ -73,6 +146,18 @@ namespace RTC
 		this->rtxSeq = Utils::Crypto::GetRandomUInt(0u, 0xFFFF);
 	}
 
+	void RtpStreamSend::SetFec(uint8_t payloadType, uint32_t ssrc)
+	{
+		MS_TRACE();
+
+		delete this->fecGenerator;
+
+		this->fecGenerator = new RTC::FlexFecGenerator(payloadType, ssrc, GetSsrc());
+
+		// Generate FEC according to the last known loss.
+		this->fecGenerator->SetFractionLost(this->fractionLost);
+	}
+
 	bool RtpStreamSend::ReceivePacket(RTC::RtpPacket* packet)
 	{
 		MS_TRACE();
@@ -82,12 +167,26 @@ namespace RTC
 			return false;
 
 		// If bufferSize was given, store the packet into the buffer.
-		if (!this->storage.empty())
+		if (this->maxBufferSize != 0u)
 			StorePacket(packet);
 
 		// Increase transmission counter.
 		this->transmissionCounter.Update(packet);
 
+		// Protect the packet with FEC if enabled. The FEC packet is sent before the
+		// media packet that completes its group, which the remote endpoint handles
+		// since FEC packets are kept until the media packets arrive.
+		if (this->fecGenerator)
+		{
+			auto* fecPacket = this->fecGenerator->AddPacket(packet);
+
+			if (fecPacket)
+			{
+				static_cast<RTC::RtpStreamSend::Listener*>(this->listener)
+				  ->OnRtpStreamSendFecPacket(this, fecPacket);
+			}
+		}
+
 		return true;
 	}
 
@@ -97,35 +196,32 @@ namespace RTC
 
 		this->nackCount++;
 
+		// Free the packets retransmitted for the previous NACK.
+		clearRetransmissionPackets();
+
+		size_t count{ 0u };
+
 		for (auto it = nackPacket->Begin(); it != nackPacket->End(); ++it)
 		{
 			RTC::RTCP::FeedbackRtpNackItem* item = *it;
 
 			this->nackPacketCount += item->CountRequestedPackets();
 
-			FillRetransmissionContainer(item->GetPacketId(), item->GetLostPacketBitmask());
+			MS_TRACEPOINT(nack_received, GetSsrc(), item->GetPacketId(), item->CountRequestedPackets());
 
-			for (auto* storageItem : RetransmissionContainer)
+			// Retransmit the batch if the packets of this item may not fit into it.
+			if (count + MaxRequestedPackets > MaxRetransmissionBatchSize)
 			{
-				if (!storageItem)
-					break;
-
-				// Note that this is an already RTX encoded packet if RTX is used
-				// (FillRetransmissionContainer() did it).
-				auto* packet = storageItem->packet;
-
-				// Retransmit the packet.
-				static_cast<RTC::RtpStreamSend::Listener*>(this->listener)
-				  ->OnRtpStreamRetransmitRtpPacket(this, packet);
-
-				// Mark the packet as retransmitted.
-				RTC::RtpStream::PacketRetransmitted(packet);
+				RetransmitPackets(count);
+				clearRetransmissionPackets();
 
-				// Mark the packet as repaired (only if this is the first retransmission).
-				if (storageItem->sentTimes == 1)
-					RTC::RtpStream::PacketRepaired(packet);
+				count = 0u;
 			}
+
+			count = FillRetransmissionContainer(item->GetPacketId(), item->GetLostPacketBitmask(), count);
 		}
+
+		RetransmitPackets(count);
 	}
 
 	void RtpStreamSend::ReceiveKeyFrameRequest(RTC::RTCP::FeedbackPs::MessageType messageType)
@@ -182,6 +278,10 @@ namespace RTC
 		this->packetsLost  = report->GetTotalLost();
 		this->fractionLost = report->GetFractionLost();
 
+		// Adapt the FEC redundancy to the reported loss.
+		if (this->fecGenerator)
+			this->fecGenerator->SetFractionLost(this->fractionLost);
+
 		// Update the score with the received RR.
 		UpdateScore(report);
 	}
@@ -199,7 +299,9 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		if (this->transmissionCounter.GetPacketCount() == 0u)
+		// Nothing sent since the last Sender Report (or ever), so the last one
+		// still describes this stream.
+		if (!HasSentSinceLastSenderReport())
 			return nullptr;
 
 		auto ntp     = Utils::Time::TimeMs2Ntp(nowMs);
@@ -217,8 +319,9 @@ namespace RTC
 		report->SetRtpTs(this->maxPacketTs + diffTs);
 
 		// Update info about last Sender Report.
-		this->lastSenderReportNtpMs = nowMs;
-		this->lastSenderReportTs    = this->maxPacketTs + diffTs;
+		this->lastSenderReportNtpMs       = nowMs;
+		this->lastSenderReportTs          = this->maxPacketTs + diffTs;
+		this->lastSenderReportPacketCount = this->transmissionCounter.GetPacketCount();
 
 		return report;
 	}
@@ -246,10 +349,26 @@ namespace RTC
 		return ssrcInfo;
 	}
 
-	RTC::RTCP::SdesChunk* RtpStreamSend::GetRtcpSdesChunk()
+	RTC::RTCP::SdesChunk* RtpStreamSend::GetRtcpSdesChunk(uint64_t nowMs)
 	{
 		MS_TRACE();
 
+		// With reduced-size RTCP (RFC 5506) Sender Reports are not required to go
+		// in a compound packet along with the CNAME, so just send it from time to
+		// time.
+		// clang-format off
+		if (
+			this->params.rtcpReducedSize &&
+			this->lastSdesSentAtMs != 0u &&
+			nowMs - this->lastSdesSentAtMs < RTC::RTCP::MaxReducedSizeSdesIntervalMs
+		)
+		// clang-format on
+		{
+			return nullptr;
+		}
+
+		this->lastSdesSentAtMs = nowMs;
+
 		const auto& cname = GetCname();
 		auto* sdesChunk   = new RTC::RTCP::SdesChunk(GetSsrc());
 		auto* sdesItem =
@@ -311,98 +430,279 @@ namespace RTC
 			return;
 		}
 
-		auto seq          = packet->GetSequenceNumber();
-		auto* storageItem = this->buffer[seq];
+		UpdateAdaptiveBufferSize(DepLibUV::GetTimeMs());
+
+		auto seq = packet->GetSequenceNumber();
 
 		// Buffer is empty.
 		if (this->bufferSize == 0)
 		{
-			// Take the first storage position.
-			storageItem       = std::addressof(this->storage[0]);
-			this->buffer[seq] = storageItem;
-
-			// Increase buffer size and set start index.
-			this->bufferSize++;
 			this->bufferStartIdx = seq;
+			this->bufferEndIdx   = seq;
 		}
-		// The buffer item is already used. Check whether we should replace its
-		// storage with the new packet or just ignore it (if duplicated packet).
-		else if (storageItem)
+		// Newest packet. Remove those that cannot be indexed along with it.
+		else if (RTC::SeqManager<uint16_t>::IsSeqHigherThan(seq, this->bufferEndIdx))
 		{
-			auto* storedPacket = storageItem->packet;
+			this->bufferEndIdx = seq;
+
+			// clang-format off
+			while (
+				this->bufferSize != 0 &&
+				static_cast<uint16_t>(this->bufferEndIdx - this->bufferStartIdx) >= this->buffer.size()
+			)
+			// clang-format on
+			{
+				RemoveOldestStorageItem();
+			}
 
-			if (packet->GetTimestamp() == storedPacket->GetTimestamp())
+			if (this->bufferSize == 0)
+				this->bufferStartIdx = seq;
+		}
+		// Older than any stored packet. Ignore it if it does not fit.
+		else if (RTC::SeqManager<uint16_t>::IsSeqLowerThan(seq, this->bufferStartIdx))
+		{
+			// clang-format off
+			if (
+				this->bufferSize >= GetMaxBufferSize() ||
+				static_cast<uint16_t>(this->bufferEndIdx - seq) >= this->buffer.size()
+			)
+			// clang-format on
+			{
 				return;
+			}
 
-			// Reset the storage item.
-			resetStorageItem(storageItem);
+			this->bufferStartIdx = seq;
+		}
 
-			// If this was the item referenced by the buffer start index, move it to
-			// the next one.
-			if (this->bufferStartIdx == seq)
-				UpdateBufferStartIdx();
+		auto* storageItem = GetStorageItem(seq);
+
+		// The packet is already stored. Check whether we should replace it or just
+		// ignore it (if duplicated packet).
+		if (storageItem)
+		{
+			if (packet->GetTimestamp() == storageItem->timestamp)
+				return;
+
+			resetStorageItem(storageItem);
 		}
-		// Buffer not yet full, add an entry.
-		else if (this->bufferSize < this->storage.size())
+		else
 		{
+			// Buffer full, remove oldest entry.
+			if (this->bufferSize >= GetMaxBufferSize())
+				RemoveOldestStorageItem();
+
+			// Storage items are allocated as needed.
+			if (this->bufferSize == this->storage.size())
+				this->storage.emplace_back();
+
 			// Take the next storage position.
-			storageItem       = std::addressof(this->storage[this->bufferSize]);
-			this->buffer[seq] = storageItem;
+			storageItem = std::addressof(this->storage[this->bufferSize]);
 
-			// Increase buffer size.
+			this->buffer[seq & (this->buffer.size() - 1)] = storageItem;
 			this->bufferSize++;
+
+			// The only entry may have been removed.
+			if (this->bufferSize == 1u)
+			{
+				this->bufferStartIdx = seq;
+				this->bufferEndIdx   = seq;
+			}
 		}
-		// Buffer full, remove oldest entry and add new one.
-		else
-		{
-			auto* firstStorageItem = this->buffer[this->bufferStartIdx];
 
-			// Reset the first storage item.
-			resetStorageItem(firstStorageItem);
+		// Take the shared clone of the packet (so it's stored just once no matter
+		// how many streams send it) and keep the values this stream sent it with.
+		storageItem->packet         = packet->GetSharedClone();
+		storageItem->ssrc           = packet->GetSsrc();
+		storageItem->timestamp      = packet->GetTimestamp();
+		storageItem->sequenceNumber = packet->GetSequenceNumber();
+		storageItem->marker         = packet->HasMarker();
 
-			// Unfill the buffer start item.
-			this->buffer[this->bufferStartIdx] = nullptr;
+		std::memcpy(
+		  storageItem->payloadHead,
+		  packet->GetPayload(),
+		  std::min(size_t{ StoredPayloadHeadSize }, packet->GetPayloadLength()));
 
-			// Move the buffer start index.
-			UpdateBufferStartIdx();
+		this->storedPacketsInWindow++;
+	}
 
-			// Take the freed storage item.
-			storageItem       = firstStorageItem;
-			this->buffer[seq] = storageItem;
+	size_t RtpStreamSend::GetMemoryUsage() const
+	{
+		MS_TRACE();
+
+		// Shared clones keep the packet and its buffer in a single allocation.
+		static constexpr size_t SharedPacketSize{ sizeof(RTC::RtpPacket) + RTC::MtuSize };
+
+		size_t memoryUsage = this->buffer.capacity() * sizeof(StorageItem*) +
+		                     this->storage.size() * sizeof(StorageItem);
+
+		// Used storage items are always the first ones.
+		for (size_t idx{ 0u }; idx < this->bufferSize; ++idx)
+		{
+			const auto& packet = this->storage[idx].packet;
+
+			if (packet)
+				memoryUsage += SharedPacketSize / packet.use_count();
 		}
 
-		// Clone the packet into the retrieved storage item.
-		storageItem->packet = packet->Clone(storageItem->store);
+		return memoryUsage;
 	}
 
-	void RtpStreamSend::ClearBuffer()
+	size_t RtpStreamSend::GetFootprint() const
 	{
 		MS_TRACE();
 
-		if (this->storage.empty())
+		size_t footprint = sizeof(RtpStreamSend) + GetMemoryUsage() +
+		                   this->transmissionCounter.GetMemoryUsage() +
+		                   Utils::String::GetMemoryUsage(this->params.rid) +
+		                   Utils::String::GetMemoryUsage(this->params.cname);
+
+		if (this->rtxStream)
+			footprint += sizeof(RTC::RtxStream);
+
+		return footprint;
+	}
+
+	void RtpStreamSend::SetStorageLimit(size_t storageLimit)
+	{
+		MS_TRACE();
+
+		if (storageLimit == this->storageLimit)
 			return;
 
-		for (uint32_t idx{ 0 }; idx < this->buffer.size(); ++idx)
-		{
-			auto* storageItem = this->buffer[idx];
+		this->storageLimit = storageLimit;
 
-			if (!storageItem)
-			{
-				MS_ASSERT(!this->buffer[idx], "key should be NULL");
+		ShrinkBuffer();
+	}
 
-				continue;
-			}
+	void RtpStreamSend::ClearBuffer()
+	{
+		MS_TRACE();
 
-			// Reset (free RTP packet) the storage item.
-			resetStorageItem(storageItem);
+		for (size_t idx{ 0u }; idx < this->bufferSize; ++idx)
+		{
+			auto* storageItem = std::addressof(this->storage[idx]);
 
 			// Unfill the buffer item.
-			this->buffer[idx] = nullptr;
+			this->buffer[storageItem->sequenceNumber & (this->buffer.size() - 1)] = nullptr;
+
+			// Reset (free RTP packet) the storage item.
+			resetStorageItem(storageItem);
 		}
 
 		// Reset buffer.
 		this->bufferStartIdx = 0;
+		this->bufferEndIdx   = 0;
 		this->bufferSize     = 0;
+
+		this->storage.clear();
+	}
+
+	size_t RtpStreamSend::GetMaxBufferSize() const
+	{
+		MS_TRACE();
+
+		auto maxBufferSize = std::min(this->maxBufferSize, this->adaptiveBufferSize);
+
+		if (this->storageLimit != 0u)
+			maxBufferSize = std::min(maxBufferSize, this->storageLimit);
+
+		return maxBufferSize;
+	}
+
+	/**
+	 * Every second, sizes the buffer to hold the packets sent in the time a
+	 * packet can still be retransmitted (a few RTTs, but no less than
+	 * MinStorageTimeMs and no more than MaxRetransmissionDelay).
+	 */
+	void RtpStreamSend::UpdateAdaptiveBufferSize(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		if (this->storageWindowStartMs == 0u)
+		{
+			this->storageWindowStartMs = nowMs;
+
+			return;
+		}
+
+		auto elapsedMs = nowMs - this->storageWindowStartMs;
+
+		if (elapsedMs < StorageWindowMs)
+			return;
+
+		auto packetRate = static_cast<double>(this->storedPacketsInWindow) * 1000 / elapsedMs;
+		auto rtt        = this->rtt != 0u ? static_cast<uint32_t>(this->rtt) : DefaultRtt;
+		auto storageTimeMs =
+		  std::min(std::max(rtt * StorageRtts, MinStorageTimeMs), MaxRetransmissionDelay);
+		// With headroom for bursts (such as key frames).
+		auto bufferSize = static_cast<size_t>(packetRate * storageTimeMs / 1000 * 1.5);
+
+		this->adaptiveBufferSize    = std::max(bufferSize, MinAdaptiveBufferSize);
+		this->storageWindowStartMs  = nowMs;
+		this->storedPacketsInWindow = 0u;
+
+		ShrinkBuffer();
+	}
+
+	/**
+	 * Removes the oldest packets above the max buffer size and releases unused
+	 * storage items.
+	 */
+	void RtpStreamSend::ShrinkBuffer()
+	{
+		MS_TRACE();
+
+		auto maxBufferSize = GetMaxBufferSize();
+
+		while (this->bufferSize > maxBufferSize)
+		{
+			RemoveOldestStorageItem();
+		}
+
+		while (this->storage.size() > maxBufferSize)
+		{
+			this->storage.pop_back();
+		}
+	}
+
+	/**
+	 * Used storage items are kept at the beginning of the storage, so the last
+	 * used one is moved into the freed position.
+	 */
+	void RtpStreamSend::RemoveOldestStorageItem()
+	{
+		MS_TRACE();
+
+		auto* firstStorageItem = GetStorageItem(this->bufferStartIdx);
+
+		MS_ASSERT(firstStorageItem, "no storage item for the buffer start index");
+
+		// Unfill the buffer start item.
+		this->buffer[this->bufferStartIdx & (this->buffer.size() - 1)] = nullptr;
+
+		auto* lastStorageItem = std::addressof(this->storage[this->bufferSize - 1]);
+
+		if (firstStorageItem != lastStorageItem)
+		{
+			*firstStorageItem = *lastStorageItem;
+
+			this->buffer[firstStorageItem->sequenceNumber & (this->buffer.size() - 1)] =
+			  firstStorageItem;
+		}
+
+		resetStorageItem(lastStorageItem);
+
+		this->bufferSize--;
+
+		if (this->bufferSize == 0)
+		{
+			this->bufferStartIdx = 0;
+			this->bufferEndIdx   = 0;
+		}
+		else
+		{
+			UpdateBufferStartIdx();
+		}
 	}
 
 	/**
@@ -415,9 +715,7 @@ namespace RTC
 
 		for (uint32_t idx{ 0 }; idx < this->buffer.size(); ++idx, ++seq)
 		{
-			auto* storageItem = this->buffer[seq];
-
-			if (storageItem)
+			if (GetStorageItem(seq))
 			{
 				this->bufferStartIdx = seq;
 
@@ -427,23 +725,27 @@ namespace RTC
 	}
 
 	// This method looks for the requested RTP packets and inserts them into the
-	// RetransmissionContainer vector (and sets to null the next position).
+	// RetransmissionContainer vector starting at the given position, and returns
+	// the position after the last inserted one.
 	//
-	// If RTX is used the stored packet will be RTX encoded now (if not already
-	// encoded in a previous resend).
-	void RtpStreamSend::FillRetransmissionContainer(uint16_t seq, uint16_t bitmask)
+	// The packets to be retransmitted are created from the stored ones into the
+	// RetransmissionPackets vector (RTX encoded if RTX is used). They are valid
+	// until clearRetransmissionPackets() is called.
+	size_t RtpStreamSend::FillRetransmissionContainer(
+	  uint16_t seq, uint16_t bitmask, size_t containerIdx)
 	{
 		MS_TRACE();
 
-		// Ensure the container's first element is 0.
-		RetransmissionContainer[0] = nullptr;
+		MS_ASSERT(
+		  containerIdx + MaxRequestedPackets <= MaxRetransmissionBatchSize,
+		  "no room for the requested packets");
 
 		// If NACK is not supported, exit.
 		if (!this->params.useNack)
 		{
 			MS_WARN_TAG(rtx, "NACK not supported");
 
-			return;
+			return containerIdx;
 		}
 
 		// Look for each requested packet.
@@ -451,7 +753,6 @@ namespace RTC
 		uint16_t rtt        = (this->rtt != 0u ? this->rtt : DefaultRtt);
 		uint16_t currentSeq = seq;
 		bool requested{ true };
-		size_t containerIdx{ 0 };
 
 		// Variables for debugging.
 		uint16_t origBitmask = bitmask;
@@ -467,17 +768,14 @@ namespace RTC
 
 			if (requested)
 			{
-				auto* storageItem = this->buffer[currentSeq];
-				RTC::RtpPacket* packet{ nullptr };
+				auto* storageItem = GetStorageItem(currentSeq);
 				uint32_t diffMs;
 
 				// Calculate the elapsed time between the max timestampt seen and the
 				// requested packet's timestampt (in ms).
 				if (storageItem)
 				{
-					packet = storageItem->packet;
-
-					uint32_t diffTs = this->maxPacketTs - packet->GetTimestamp();
+					uint32_t diffTs = this->maxPacketTs - storageItem->timestamp;
 
 					diffMs = diffTs * 1000 / this->params.clockRate;
 				}
@@ -496,7 +794,7 @@ namespace RTC
 						  rtx,
 						  "ignoring retransmission for too old packet "
 						  "[seq:%" PRIu16 ", max age:%" PRIu32 "ms, packet age:%" PRIu32 "ms]",
-						  packet->GetSequenceNumber(),
+						  storageItem->sequenceNumber,
 						  MaxRetransmissionDelay,
 						  diffMs);
 
@@ -515,29 +813,30 @@ namespace RTC
 					  rtx,
 					  "ignoring retransmission for a packet already resent in the last RTT ms "
 					  "[seq:%" PRIu16 ", rtt:%" PRIu32 "]",
-					  packet->GetSequenceNumber(),
+					  storageItem->sequenceNumber,
 					  rtt);
 				}
 				// Stored packet is valid for retransmission. Resend it.
 				else
 				{
-					// If we use RTX and the packet has not yet been resent, encode it now.
-					if (HasRtx())
-					{
-						// Increment RTX seq.
-						++this->rtxSeq;
-
-						if (!storageItem->rtxEncoded)
-						{
-							packet->RtxEncode(this->params.rtxPayloadType, this->params.rtxSsrc, this->rtxSeq);
-
-							storageItem->rtxEncoded = true;
-						}
-						else
-						{
-							packet->SetSequenceNumber(this->rtxSeq);
-						}
-					}
+					// Without RTX the stored packet itself can be retransmitted unless
+					// it's already in the batch (the same packet may be stored more
+					// than once if it was sent again with another seq).
+					// clang-format off
+					const bool inPlace =
+						!HasRtx() &&
+						std::find(
+							RetransmissionPackets.begin(),
+							RetransmissionPackets.begin() + containerIdx,
+							storageItem->packet.get()) == RetransmissionPackets.begin() + containerIdx;
+					// clang-format on
+
+					// Create the packet to be retransmitted.
+					RetransmissionPackets[containerIdx] = CreateRetransmissionPacket(
+					  storageItem, RetransmissionBuffers[containerIdx], inPlace);
+
+					if (inPlace)
+						RetransmissionStoredPackets[containerIdx] = storageItem->packet;
 
 					// Save when this packet was resent.
 					storageItem->resentAtMs = nowMs;
@@ -590,8 +889,121 @@ namespace RTC
 			  MS_UINT16_TO_BINARY(origBitmask));
 		}
 
-		// Set the next container element to null.
-		RetransmissionContainer[containerIdx] = nullptr;
+		return containerIdx;
+	}
+
+	void RtpStreamSend::RetransmitPackets(size_t count)
+	{
+		MS_TRACE();
+
+		if (count == 0u)
+			return;
+
+		// Note that these are already RTX encoded packets if RTX is used
+		// (FillRetransmissionContainer() did it).
+		static_cast<RTC::RtpStreamSend::Listener*>(this->listener)
+		  ->OnRtpStreamRetransmitRtpPackets(this, RetransmissionPackets.data(), count);
+
+		for (size_t idx{ 0u }; idx < count; ++idx)
+		{
+			auto* storageItem = RetransmissionContainer[idx];
+			auto* packet      = RetransmissionPackets[idx];
+
+			// Mark the packet as retransmitted.
+			RTC::RtpStream::PacketRetransmitted(packet);
+
+			// Mark the packet as repaired (only if this is the first retransmission).
+			if (storageItem->sentTimes == 1)
+				RTC::RtpStream::PacketRepaired(packet);
+		}
+	}
+
+	RTC::RtpPacket* RtpStreamSend::GetRtxPaddingPacket(size_t size)
+	{
+		MS_TRACE();
+
+		if (!HasRtx() || this->bufferSize == 0u)
+			return nullptr;
+
+		// Among the most recently stored packets, take the one whose RTX size is
+		// the closest to the requested one.
+		StorageItem* paddingStorageItem{ nullptr };
+		size_t paddingSizeDiff{ 0u };
+		uint16_t seq = this->bufferEndIdx;
+
+		for (size_t idx{ 0u }; idx < std::min(this->bufferSize, MaxPaddingCandidates); ++idx, --seq)
+		{
+			auto* storageItem = GetStorageItem(seq);
+
+			if (!storageItem)
+				continue;
+
+			// 2 bytes for the original seq.
+			const size_t rtxSize  = storageItem->packet->GetSize() + 2u;
+			const size_t sizeDiff = rtxSize > size ? rtxSize - size : size - rtxSize;
+
+			if (!paddingStorageItem || sizeDiff < paddingSizeDiff)
+			{
+				paddingStorageItem = storageItem;
+				paddingSizeDiff    = sizeDiff;
+			}
+		}
+
+		if (!paddingStorageItem)
+			return nullptr;
+
+		PaddingPacket.reset(
+		  CreateRetransmissionPacket(paddingStorageItem, PaddingBuffer, /*inPlace*/ false));
+
+		return PaddingPacket.get();
+	}
+
+	RTC::RtpPacket* RtpStreamSend::CreateRetransmissionPacket(
+	  StorageItem* storageItem, uint8_t* buffer, bool inPlace)
+	{
+		MS_TRACE();
+
+		RTC::RtpPacket* packet{ nullptr };
+		// Offset of the original payload in the payload of the packet.
+		size_t payloadOffset{ 0u };
+
+		// If we use RTX, encode it while cloning so the payload is not moved.
+		if (HasRtx())
+		{
+			// Increment RTX seq.
+			++this->rtxSeq;
+
+			packet = storageItem->packet->RtxClone(
+			  buffer, this->params.rtxPayloadType, this->params.rtxSsrc, this->rtxSeq);
+
+			// Write the original seq this stream sent the packet with.
+			Utils::Byte::Set2Bytes(packet->GetPayload(), 0, storageItem->sequenceNumber);
+
+			payloadOffset = 2u;
+		}
+		// Otherwise just the header and the payload head differ from the stored
+		// packet, so if requested rewrite them and send the stored packet itself
+		// instead of a copy. It may be shared with other streams, but all of them
+		// rewrite these values before sending it.
+		else
+		{
+			packet = inPlace ? storageItem->packet.get() : storageItem->packet->Clone(buffer);
+
+			packet->SetSsrc(storageItem->ssrc);
+			packet->SetSequenceNumber(storageItem->sequenceNumber);
+		}
+
+		// Set the values this stream sent the packet with (the shared clone may
+		// have been taken from the packet sent by another stream).
+		packet->SetTimestamp(storageItem->timestamp);
+		packet->SetMarker(storageItem->marker);
+
+		std::memcpy(
+		  packet->GetPayload() + payloadOffset,
+		  storageItem->payloadHead,
+		  std::min(size_t{ StoredPayloadHeadSize }, packet->GetPayloadLength() - payloadOffset));
+
+		return packet;
 	}
 
 	void RtpStreamSend::UpdateScore(RTC::RTCP::ReceiverReport* report)
@@ -658,30 +1070,20 @@ namespace RTC
 		  retransmitted);
 #endif
 
-		auto repairedRatio  = static_cast<float>(repaired) / static_cast<float>(sent);
-		auto repairedWeight = std::pow(1 / (repairedRatio + 1), 4);
-
 		MS_ASSERT(retransmitted >= repaired, "repaired packets cannot be more than retransmitted ones");
 
-		if (retransmitted > 0)
-			repairedWeight *= static_cast<float>(repaired) / retransmitted;
+		RTC::RtpStream::ScoreSample sample;
 
-		lost -= repaired * repairedWeight;
+		sample.packets       = static_cast<uint32_t>(sent);
+		sample.lost          = lost;
+		sample.repaired      = repaired;
+		sample.retransmitted = retransmitted;
 
-		auto deliveredRatio = static_cast<float>(sent - lost) / static_cast<float>(sent);
-		auto score          = static_cast<uint8_t>(std::round(std::pow(deliveredRatio, 4) * 10));
+		uint8_t score;
 
-#if MS_LOG_DEV_LEVEL == 3
-		MS_DEBUG_TAG(
-		  score,
-		  "[deliveredRatio:%f, repairedRatio:%f, repairedWeight:%f, new lost:%" PRIu32 ", score:%" PRIu8
-		  "]",
-		  deliveredRatio,
-		  repairedRatio,
-		  repairedWeight,
-		  lost,
-		  score);
-#endif
+		RTC::RtpStream::ComputeScores(std::addressof(sample), std::addressof(score), 1u);
+
+		MS_DEBUG_DEV("[score:%" PRIu8 "]", score);
 
 		RtpStream::UpdateScore(score);
 	}
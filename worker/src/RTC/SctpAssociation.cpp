@@ -5,7 +5,11 @@
 #include "DepUsrSCTP.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Settings.hpp"
+#include "Utils.hpp"
 #include "Channel/ChannelNotifier.hpp"
+#include "RTC/SctpPacket.hpp"
+#include <absl/container/flat_hash_set.h>
 #include <cstdlib> // std::malloc(), std::free()
 #include <cstring> // std::memset(), std::memcpy()
 #include <string>
@@ -105,6 +109,56 @@ namespace RTC
 
 	static constexpr size_t SctpMtu{ 1200 };
 	static constexpr uint16_t MaxSctpStreams{ 65535 };
+	// Max number of unused message buffers kept for reuse.
+	static constexpr size_t MaxFreeMessageBuffers{ 8u };
+
+	/* Class variables. */
+
+	thread_local std::vector<std::vector<uint8_t>*> SctpAssociation::freeMessageBuffers;
+
+	/* Class methods. */
+
+	void SctpAssociation::ClassDestroy()
+	{
+		MS_TRACE();
+
+		for (auto* messageBuffer : SctpAssociation::freeMessageBuffers)
+		{
+			delete messageBuffer;
+		}
+		SctpAssociation::freeMessageBuffers.clear();
+	}
+
+	std::vector<uint8_t>* SctpAssociation::AcquireMessageBuffer()
+	{
+		MS_TRACE();
+
+		if (SctpAssociation::freeMessageBuffers.empty())
+			return new std::vector<uint8_t>();
+
+		auto* messageBuffer = SctpAssociation::freeMessageBuffers.back();
+
+		SctpAssociation::freeMessageBuffers.pop_back();
+
+		return messageBuffer;
+	}
+
+	void SctpAssociation::ReleaseMessageBuffer(std::vector<uint8_t>* messageBuffer)
+	{
+		MS_TRACE();
+
+		if (SctpAssociation::freeMessageBuffers.size() >= MaxFreeMessageBuffers)
+		{
+			delete messageBuffer;
+
+			return;
+		}
+
+		// Keep the capacity for the next message.
+		messageBuffer->clear();
+
+		SctpAssociation::freeMessageBuffers.push_back(messageBuffer);
+	}
 
 	/* Instance methods. */
 
@@ -120,6 +174,18 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		// The native SCTP association does not need usrsctp at all.
+		if (Settings::configuration.nativeSctp)
+		{
+			this->nativeSctpAssociation = new RTC::NativeSctpAssociation(
+			  this, os, mis, maxSctpMessageSize, sctpSendBufferSize);
+
+			return;
+		}
+
+		// usrsctp is initialized on first use.
+		DepUsrSCTP::ClassInit();
+
 		// Get a id for this SctpAssociation.
 		this->id = DepUsrSCTP::GetNextSctpAssociationId();
 
@@ -275,6 +341,20 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		if (this->nativeSctpAssociation)
+		{
+			if (this->nativeFlushScheduled)
+				DepUsrSCTP::CancelSctpAssociationFlush(this);
+
+			delete this->nativeSctpAssociation;
+
+			return;
+		}
+
+		// Queued messages are just discarded.
+		if (!this->queuedSctpMessages.empty())
+			DepUsrSCTP::CancelSctpAssociationFlush(this);
+
 		usrsctp_set_ulpinfo(this->socket, nullptr);
 		usrsctp_close(this->socket);
 
@@ -284,7 +364,8 @@ namespace RTC
 		// Register the SctpAssociation from the global map.
 		DepUsrSCTP::DeregisterSctpAssociation(this);
 
-		delete[] this->messageBuffer;
+		if (this->messageBuffer)
+			SctpAssociation::ReleaseMessageBuffer(this->messageBuffer);
 	}
 
 	void SctpAssociation::TransportConnected()
@@ -295,6 +376,17 @@ namespace RTC
 		if (this->state != SctpState::NEW)
 			return;
 
+		if (this->nativeSctpAssociation)
+		{
+			// Announce connecting state.
+			this->state = SctpState::CONNECTING;
+			this->listener->OnSctpAssociationConnecting(this);
+
+			this->nativeSctpAssociation->Connect();
+
+			return;
+		}
+
 		try
 		{
 			int ret;
@@ -349,7 +441,7 @@ namespace RTC
 		jsonObject["port"] = 5000;
 
 		// Add OS.
-		jsonObject["OS"] = this->os;
+		jsonObject["OS"] = GetOs();
 
 		// Add MIS.
 		jsonObject["MIS"] = this->mis;
@@ -367,6 +459,28 @@ namespace RTC
 		jsonObject["isDataChannel"] = this->isDataChannel;
 	}
 
+	size_t SctpAssociation::GetMemoryUsage() const
+	{
+		MS_TRACE();
+
+		if (this->nativeSctpAssociation)
+			return this->nativeSctpAssociation->GetMemoryUsage();
+
+		// Data given to usrsctp and not yet acknowledged.
+		size_t memoryUsage = this->sctpBufferedAmount;
+
+		// Buffer of incoming messages received in parts.
+		if (this->messageBuffer)
+			memoryUsage += this->messageBuffer->capacity();
+
+		for (const auto& queuedSctpMessage : this->queuedSctpMessages)
+		{
+			memoryUsage += sizeof(QueuedSctpMessage) + queuedSctpMessage.msg.capacity();
+		}
+
+		return memoryUsage;
+	}
+
 	void SctpAssociation::ProcessSctpData(const uint8_t* data, size_t len)
 	{
 		MS_TRACE();
@@ -375,6 +489,30 @@ namespace RTC
 		MS_DUMP_DATA(data, len);
 #endif
 
+		// usrsctp does not verify the checksum (see DepUsrSCTP::ClassInit()).
+		if (len < RTC::SctpPacket::CommonHeaderSize)
+		{
+			MS_WARN_TAG(sctp, "ignoring too small SCTP packet [len:%zu]", len);
+
+			return;
+		}
+
+		if (RTC::SctpPacket::ReadChecksum(data) != RTC::SctpPacket::ComputeChecksum(data, len))
+		{
+			MS_WARN_TAG(sctp, "ignoring SCTP packet with wrong checksum");
+
+			return;
+		}
+
+		if (this->nativeSctpAssociation)
+		{
+			this->nativeSctpAssociation->ProcessPacket(data, len);
+
+			return;
+		}
+
+		DepUsrSCTP::HandleSctpActivity();
+
 		usrsctp_conninput(reinterpret_cast<void*>(this->id), data, len, 0);
 	}
 
@@ -392,6 +530,42 @@ namespace RTC
 
 		const auto& parameters = dataConsumer->GetSctpStreamParameters();
 
+		if (this->nativeSctpAssociation)
+		{
+			const bool queued = this->nativeSctpAssociation->SendMessage(
+			  parameters.streamId,
+			  ppid,
+			  parameters.ordered,
+			  parameters.maxPacketLifeTime,
+			  parameters.maxRetransmits,
+			  msg,
+			  len);
+
+			if (!queued)
+			{
+				SctpSendBufferFull(dataConsumer->id, ppid, msg, len, cb);
+
+				return;
+			}
+
+			if (cb)
+			{
+				(*cb)(true, false);
+				delete cb;
+			}
+
+			// All the messages sent in this loop iteration are bundled into as few
+			// SCTP packets as possible.
+			if (!this->nativeFlushScheduled)
+			{
+				this->nativeFlushScheduled = true;
+
+				DepUsrSCTP::ScheduleSctpAssociationFlush(this);
+			}
+
+			return;
+		}
+
 		// Fill stcp_sendv_spa.
 		struct sctp_sendv_spa spa; // NOLINT(cppcoreguidelines-pro-type-member-init)
 
@@ -433,6 +607,106 @@ namespace RTC
 		// via onSendSctpData.
 		this->listener->OnSctpAssociationBufferedAmount(this, this->sctpBufferedAmount);
 
+		// The callback must be called now, so send queued messages first to keep
+		// the order.
+		if (cb)
+		{
+			SendQueuedSctpMessages();
+			SendSctpMessage(dataConsumer->id, spa, msg, len, cb);
+
+			return;
+		}
+
+		// Otherwise queue the message so all the messages sent in this loop
+		// iteration are bundled into as few SCTP packets as possible.
+		if (this->queuedSctpMessages.empty())
+			DepUsrSCTP::ScheduleSctpAssociationFlush(this);
+
+		this->queuedSctpMessages.push_back({ dataConsumer->id, spa, { msg, msg + len } });
+	}
+
+	void SctpAssociation::SendQueuedSctpMessages()
+	{
+		MS_TRACE();
+
+		if (this->nativeSctpAssociation)
+		{
+			if (this->nativeFlushScheduled)
+			{
+				this->nativeFlushScheduled = false;
+
+				DepUsrSCTP::CancelSctpAssociationFlush(this);
+			}
+
+			this->nativeSctpAssociation->Flush();
+
+			return;
+		}
+
+		if (this->queuedSctpMessages.empty())
+			return;
+
+		std::vector<QueuedSctpMessage> messages;
+
+		messages.swap(this->queuedSctpMessages);
+
+		DepUsrSCTP::CancelSctpAssociationFlush(this);
+
+		// Let usrsctp hold the DATA chunks (Nagle) and enable SCTP_NODELAY again
+		// before sending the last message, so all of them are sent at once.
+		const bool bundle = messages.size() > 1;
+
+		if (bundle)
+			SetNoDelay(false);
+
+		// DataConsumers whose messages did not fit in the SCTP send buffer. Their
+		// next messages must not overtake them.
+		absl::flat_hash_set<std::string> blockedDataConsumerIds;
+
+		for (size_t i{ 0u }; i < messages.size(); ++i)
+		{
+			auto& message = messages[i];
+
+			if (bundle && i == messages.size() - 1)
+				SetNoDelay(true);
+
+			// clang-format off
+			if (
+				!blockedDataConsumerIds.empty() &&
+				blockedDataConsumerIds.find(message.dataConsumerId) != blockedDataConsumerIds.end()
+			)
+			// clang-format on
+			{
+				SctpSendBufferFull(
+				  message.dataConsumerId,
+				  ntohl(message.spa.sendv_sndinfo.snd_ppid),
+				  message.msg.data(),
+				  message.msg.size(),
+				  nullptr);
+
+				continue;
+			}
+
+			if (!SendSctpMessage(
+			      message.dataConsumerId, message.spa, message.msg.data(), message.msg.size(), nullptr))
+			{
+				blockedDataConsumerIds.insert(message.dataConsumerId);
+			}
+		}
+	}
+
+	bool SctpAssociation::SendSctpMessage(
+	  const std::string& dataConsumerId,
+	  struct sctp_sendv_spa& spa,
+	  const uint8_t* msg,
+	  size_t len,
+	  onQueuedCallback* cb)
+	{
+		MS_TRACE();
+
+		auto streamId = spa.sendv_sndinfo.snd_sid;
+		auto ppid     = ntohl(spa.sendv_sndinfo.snd_ppid);
+
 		int ret = usrsctp_sendv(
 		  this->socket, msg, len, nullptr, 0, &spa, static_cast<socklen_t>(sizeof(spa)), SCTP_SENDV_SPA, 0);
 
@@ -446,7 +720,7 @@ namespace RTC
 				MS_DEBUG_DEV(
 				  sctp,
 				  "error sending SCTP message [sid:%" PRIu16 ", ppid:%" PRIu32 ", message size:%zu]: %s",
-				  parameters.streamId,
+				  streamId,
 				  ppid,
 				  len,
 				  std::strerror(errno));
@@ -456,21 +730,23 @@ namespace RTC
 				MS_WARN_TAG(
 				  sctp,
 				  "error sending SCTP message [sid:%" PRIu16 ", ppid:%" PRIu32 ", message size:%zu]: %s",
-				  parameters.streamId,
+				  streamId,
 				  ppid,
 				  len,
 				  std::strerror(errno));
 			}
 
-			if (cb)
+			if (sctpSendBufferFull)
 			{
-				(*cb)(false, sctpSendBufferFull);
-				delete cb;
+				SctpSendBufferFull(dataConsumerId, ppid, msg, len, cb);
+
+				return false;
 			}
 
-			if (sctpSendBufferFull)
+			if (cb)
 			{
-				Channel::ChannelNotifier::Emit(dataConsumer->id, "sctpsendbufferfull");
+				(*cb)(false, false);
+				delete cb;
 			}
 		}
 		else if (cb)
@@ -478,6 +754,47 @@ namespace RTC
 			(*cb)(true, false);
 			delete cb;
 		}
+
+		return true;
+	}
+
+	void SctpAssociation::SctpSendBufferFull(
+	  const std::string& dataConsumerId,
+	  uint32_t ppid,
+	  const uint8_t* msg,
+	  size_t len,
+	  onQueuedCallback* cb)
+	{
+		MS_TRACE();
+
+		// The DataConsumer may queue the message until there is room in the SCTP
+		// send buffer.
+		const bool queued =
+		  this->listener->OnSctpAssociationSendBufferFull(this, dataConsumerId, ppid, msg, len);
+
+		if (cb)
+		{
+			(*cb)(queued, !queued);
+			delete cb;
+		}
+
+		if (!queued)
+		{
+			Channel::ChannelNotifier::Emit(dataConsumerId, "sctpsendbufferfull");
+		}
+	}
+
+	void SctpAssociation::SetNoDelay(bool enabled)
+	{
+		MS_TRACE();
+
+		uint32_t noDelay = enabled ? 1 : 0;
+
+		int ret =
+		  usrsctp_setsockopt(this->socket, IPPROTO_SCTP, SCTP_NODELAY, &noDelay, sizeof(noDelay));
+
+		if (ret < 0)
+			MS_WARN_TAG(sctp, "usrsctp_setsockopt(SCTP_NODELAY) failed: %s", std::strerror(errno));
 	}
 
 	void SctpAssociation::HandleDataConsumer(RTC::DataConsumer* dataConsumer)
@@ -487,7 +804,7 @@ namespace RTC
 		auto streamId = dataConsumer->GetSctpStreamParameters().streamId;
 
 		// We need more OS.
-		if (streamId > this->os - 1)
+		if (streamId > GetOs() - 1)
 			AddOutgoingStreams(/*force*/ false);
 	}
 
@@ -520,8 +837,32 @@ namespace RTC
 		MS_TRACE();
 
 		// Do nothing if an outgoing stream that could not be allocated by us.
-		if (direction == StreamDirection::OUTGOING && streamId > this->os - 1)
+		if (direction == StreamDirection::OUTGOING && streamId > GetOs() - 1)
+			return;
+
+		if (this->nativeSctpAssociation)
+		{
+			if (direction == StreamDirection::INCOMING)
+			{
+				MS_WARN_TAG(
+				  sctp,
+				  "incoming stream reset not supported by native SCTP [streamId:%" PRIu16 "]",
+				  streamId);
+
+				return;
+			}
+
+			// NOTE: Queued messages are sent before the stream is reset anyway.
+			this->nativeSctpAssociation->ResetOutgoingStream(streamId);
+			SendQueuedSctpMessages();
+
+			MS_DEBUG_TAG(sctp, "outgoing stream reset requested [streamId:%" PRIu16 "]", streamId);
+
 			return;
+		}
+
+		// Queued messages must be sent before the stream is reset.
+		SendQueuedSctpMessages();
 
 		int ret;
 		struct sctp_assoc_value av; // NOLINT(cppcoreguidelines-pro-type-member-init)
@@ -586,20 +927,21 @@ namespace RTC
 		MS_TRACE();
 
 		uint16_t additionalOs{ 0 };
+		const uint16_t os = GetOs();
 
-		if (MaxSctpStreams - this->os >= 32)
+		if (MaxSctpStreams - os >= 32)
 			additionalOs = 32;
 		else
-			additionalOs = MaxSctpStreams - this->os;
+			additionalOs = MaxSctpStreams - os;
 
 		if (additionalOs == 0)
 		{
-			MS_WARN_TAG(sctp, "cannot add more outgoing streams [OS:%" PRIu16 "]", this->os);
+			MS_WARN_TAG(sctp, "cannot add more outgoing streams [OS:%" PRIu16 "]", os);
 
 			return;
 		}
 
-		auto nextDesiredOs = this->os + additionalOs;
+		auto nextDesiredOs = os + additionalOs;
 
 		// Already in progress, ignore (unless forced).
 		if (!force && nextDesiredOs == this->desiredOs)
@@ -624,6 +966,14 @@ namespace RTC
 
 		MS_DEBUG_TAG(sctp, "adding %" PRIu16 " outgoing streams", additionalOs);
 
+		if (this->nativeSctpAssociation)
+		{
+			this->nativeSctpAssociation->AddOutgoingStreams(additionalOs);
+			SendQueuedSctpMessages();
+
+			return;
+		}
+
 		int ret = usrsctp_setsockopt(
 		  this->socket, IPPROTO_SCTP, SCTP_ADD_STREAMS, &sas, static_cast<socklen_t>(sizeof(sas)));
 
@@ -635,12 +985,17 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		const uint8_t* data = static_cast<uint8_t*>(buffer);
+		auto* data = static_cast<uint8_t*>(buffer);
+
+		// usrsctp leaves the checksum to us (see DepUsrSCTP::ClassInit()).
+		RTC::SctpPacket::WriteChecksum(data, RTC::SctpPacket::ComputeChecksum(data, len));
 
 #if MS_LOG_DEV_LEVEL == 3
 		MS_DUMP_DATA(data, len);
 #endif
 
+		DepUsrSCTP::HandleSctpActivity();
+
 		this->listener->OnSctpAssociationSendData(this, data, len);
 	}
 
@@ -655,7 +1010,7 @@ namespace RTC
 			return;
 		}
 
-		if (this->messageBufferLen != 0 && ssn != this->lastSsnReceived)
+		if (this->messageBuffer && !this->messageBuffer->empty() && ssn != this->lastSsnReceived)
 		{
 			MS_WARN_TAG(
 			  sctp,
@@ -664,20 +1019,22 @@ namespace RTC
 			  ssn,
 			  this->lastSsnReceived);
 
-			this->messageBufferLen = 0;
+			SctpAssociation::ReleaseMessageBuffer(this->messageBuffer);
+			this->messageBuffer = nullptr;
 		}
 
 		// Update last SSN received.
 		this->lastSsnReceived = ssn;
 
-		auto eor = static_cast<bool>(flags & MSG_EOR);
+		auto eor                      = static_cast<bool>(flags & MSG_EOR);
+		const size_t messageBufferLen = this->messageBuffer ? this->messageBuffer->size() : 0u;
 
-		if (this->messageBufferLen + len > this->maxSctpMessageSize)
+		if (messageBufferLen + len > this->maxSctpMessageSize)
 		{
 			MS_WARN_TAG(
 			  sctp,
 			  "ongoing received message exceeds max allowed message size [message size:%zu, max message size:%zu, eor:%u]",
-			  this->messageBufferLen + len,
+			  messageBufferLen + len,
 			  this->maxSctpMessageSize,
 			  eor ? 1 : 0);
 
@@ -686,37 +1043,38 @@ namespace RTC
 			return;
 		}
 
-		// If end of message and there is no buffered data, notify it directly.
-		if (eor && this->messageBufferLen == 0)
+		// If end of message and there is no buffered data, notify it directly
+		// from the buffer given by usrsctp.
+		if (eor && messageBufferLen == 0)
 		{
 			MS_DEBUG_DEV("directly notifying listener [eor:1, buffer len:0]");
 
 			this->listener->OnSctpAssociationMessageReceived(this, streamId, ppid, data, len);
 		}
 		// If end of message and there is buffered data, append data and notify buffer.
-		else if (eor && this->messageBufferLen != 0)
+		else if (eor)
 		{
-			std::memcpy(this->messageBuffer + this->messageBufferLen, data, len);
-			this->messageBufferLen += len;
+			this->messageBuffer->insert(this->messageBuffer->end(), data, data + len);
 
-			MS_DEBUG_DEV("notifying listener [eor:1, buffer len:%zu]", this->messageBufferLen);
+			MS_DEBUG_DEV("notifying listener [eor:1, buffer len:%zu]", this->messageBuffer->size());
 
 			this->listener->OnSctpAssociationMessageReceived(
-			  this, streamId, ppid, this->messageBuffer, this->messageBufferLen);
+			  this, streamId, ppid, this->messageBuffer->data(), this->messageBuffer->size());
 
-			this->messageBufferLen = 0;
+			// Give the buffer back so other SctpAssociations can use it.
+			SctpAssociation::ReleaseMessageBuffer(this->messageBuffer);
+			this->messageBuffer = nullptr;
 		}
 		// If non end of message, append data to the buffer.
-		else if (!eor)
+		else
 		{
-			// Allocate the buffer if not already done.
+			// Take a buffer if not already done.
 			if (!this->messageBuffer)
-				this->messageBuffer = new uint8_t[this->maxSctpMessageSize];
+				this->messageBuffer = SctpAssociation::AcquireMessageBuffer();
 
-			std::memcpy(this->messageBuffer + this->messageBufferLen, data, len);
-			this->messageBufferLen += len;
+			this->messageBuffer->insert(this->messageBuffer->end(), data, data + len);
 
-			MS_DEBUG_DEV("data buffered [eor:0, buffer len:%zu]", this->messageBufferLen);
+			MS_DEBUG_DEV("data buffered [eor:0, buffer len:%zu]", this->messageBuffer->size());
 		}
 	}
 
@@ -1058,4 +1416,109 @@ namespace RTC
 			this->listener->OnSctpAssociationBufferedAmount(this, this->sctpBufferedAmount);
 		}
 	}
+
+	inline void SctpAssociation::OnNativeSctpAssociationConnected(
+	  RTC::NativeSctpAssociation* nativeSctpAssociation)
+	{
+		MS_TRACE();
+
+		MS_DEBUG_TAG(
+		  sctp,
+		  "SCTP association connected, streams [out:%" PRIu16 "]",
+		  nativeSctpAssociation->GetOs());
+
+		// Increase if requested before connected.
+		if (this->desiredOs > GetOs())
+			AddOutgoingStreams(/*force*/ true);
+
+		if (this->state != SctpState::CONNECTED)
+		{
+			this->state = SctpState::CONNECTED;
+			this->listener->OnSctpAssociationConnected(this);
+		}
+	}
+
+	inline void SctpAssociation::OnNativeSctpAssociationFailed(
+	  RTC::NativeSctpAssociation* /*nativeSctpAssociation*/)
+	{
+		MS_TRACE();
+
+		MS_WARN_TAG(sctp, "SCTP setup failed");
+
+		if (this->state != SctpState::FAILED)
+		{
+			this->state = SctpState::FAILED;
+			this->listener->OnSctpAssociationFailed(this);
+		}
+	}
+
+	inline void SctpAssociation::OnNativeSctpAssociationClosed(
+	  RTC::NativeSctpAssociation* /*nativeSctpAssociation*/)
+	{
+		MS_TRACE();
+
+		MS_DEBUG_TAG(sctp, "SCTP association closed");
+
+		if (this->state != SctpState::CLOSED)
+		{
+			this->state = SctpState::CLOSED;
+			this->listener->OnSctpAssociationClosed(this);
+		}
+	}
+
+	inline void SctpAssociation::OnNativeSctpAssociationSendPacket(
+	  RTC::NativeSctpAssociation* /*nativeSctpAssociation*/, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+#if MS_LOG_DEV_LEVEL == 3
+		MS_DUMP_DATA(data, len);
+#endif
+
+		this->listener->OnSctpAssociationSendData(this, data, len);
+	}
+
+	inline void SctpAssociation::OnNativeSctpAssociationMessageReceived(
+	  RTC::NativeSctpAssociation* /*nativeSctpAssociation*/,
+	  uint16_t streamId,
+	  uint32_t ppid,
+	  const uint8_t* msg,
+	  size_t len)
+	{
+		MS_TRACE();
+
+		// Ignore WebRTC DataChannel Control DATA chunks.
+		if (ppid == 50)
+		{
+			MS_WARN_TAG(sctp, "ignoring SCTP data with ppid:50 (WebRTC DataChannel Control)");
+
+			return;
+		}
+
+		this->listener->OnSctpAssociationMessageReceived(this, streamId, ppid, msg, len);
+	}
+
+	inline void SctpAssociation::OnNativeSctpAssociationBufferedAmount(
+	  RTC::NativeSctpAssociation* /*nativeSctpAssociation*/, size_t bufferedAmount)
+	{
+		MS_TRACE();
+
+		this->sctpBufferedAmount = bufferedAmount;
+
+		this->listener->OnSctpAssociationBufferedAmount(
+		  this, static_cast<uint32_t>(this->sctpBufferedAmount));
+	}
+
+	inline void SctpAssociation::OnNativeSctpAssociationIncomingStreamReset(
+	  RTC::NativeSctpAssociation* /*nativeSctpAssociation*/, uint16_t streamId)
+	{
+		MS_TRACE();
+
+		MS_DEBUG_TAG(sctp, "SCTP incoming stream reset [streamId:%" PRIu16 "]", streamId);
+
+		// Special case for WebRTC DataChannels in which we must also reset our
+		// outgoing SCTP stream.
+		if (this->isDataChannel)
+			ResetSctpStream(streamId, StreamDirection::OUTGOING);
+	}
 } // namespace RTC
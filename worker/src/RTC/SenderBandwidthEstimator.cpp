@@ -2,26 +2,64 @@
 // #define MS_LOG_DEV_LEVEL 3
 
 #include "RTC/SenderBandwidthEstimator.hpp"
-#include "DepLibUV.hpp"
 #include "Logger.hpp"
-#include <limits>
+#include <algorithm> // std::min(), std::max()
+#include <cmath>     // std::fabs(), std::pow()
 
 namespace RTC
 {
 	/* Static. */
 
-	// static constexpr uint64_t AvailableBitrateEventInterval{ 2000u }; // In ms.
-	static constexpr uint16_t MaxSentInfoAge{ 2000u }; // TODO: Let's see.
 	static constexpr float DefaultRtt{ 100 };
+	// Packets sent within this interval belong to the same group (burst).
+	static constexpr uint64_t BurstIntervalMs{ 5u };
+	// Greater receive deltas (or negative ones) mean that the remote clock
+	// jumped or that sending paused, so the delay gradient starts over.
+	static constexpr int64_t MaxReceiveDeltaMs{ 3000 };
+	static constexpr double SmoothingCoef{ 0.9 };
+	static constexpr double ThresholdGain{ 4.0 };
+	static constexpr size_t MaxNumDeltas{ 60u };
+	static constexpr double InitialThreshold{ 12.5 };
+	static constexpr double MinThreshold{ 6 };
+	static constexpr double MaxThreshold{ 600 };
+	static constexpr double ThresholdKUp{ 0.0087 };
+	static constexpr double ThresholdKDown{ 0.039 };
+	static constexpr double MaxAdaptOffset{ 15 };
+	static constexpr int64_t MaxThresholdUpdateIntervalMs{ 100 };
+	// Fraction of the acknowledged bitrate the estimate decreases to on overuse.
+	static constexpr double Beta{ 0.85 };
+	static constexpr double MultiplicativeIncreaseFactor{ 1.08 }; // Per second.
+	static constexpr uint32_t AdditiveIncreasePacketBits{ 1200u * 8u };
+	static constexpr uint32_t MinIncrease{ 1000u };
+	static constexpr uint64_t MaxRateControlIntervalMs{ 1000u };
+	static constexpr float ResponseTimeExtraMs{ 100 };
+	// The estimate is near the link capacity within these margins.
+	static constexpr double LinkCapacityLowerMargin{ 0.75 };
+	static constexpr double LinkCapacityUpperMargin{ 1.15 };
+	static constexpr double LinkCapacitySmoothing{ 0.75 };
+	static constexpr double MaxAckedBitrateFactor{ 1.5 };
+	static constexpr uint32_t AckedBitrateMargin{ 10000u };
+	static constexpr size_t AckedBitrateWindowMs{ 500u };
+	static constexpr size_t SendBitrateWindowMs{ 1000u };
+	static constexpr double LossSmoothing{ 0.8 };
+	static constexpr double HighLoss{ 0.1 };
+	static constexpr double LowLoss{ 0.02 };
+	static constexpr uint64_t LossDecreaseIntervalMs{ 300u };
+	static constexpr double AlrStartRatio{ 0.65 };
+	static constexpr double AlrStopRatio{ 0.8 };
 
 	/* Instance methods. */
 
 	SenderBandwidthEstimator::SenderBandwidthEstimator(
 	  RTC::SenderBandwidthEstimator::Listener* listener, uint32_t initialAvailableBitrate)
-	  : listener(listener), initialAvailableBitrate(initialAvailableBitrate), rtt(DefaultRtt),
-	    sendTransmission(1000u), sendTransmissionTrend(0.15f)
+	  : listener(listener),
+	    initialAvailableBitrate(std::max<uint32_t>(initialAvailableBitrate, MinBitrate)),
+	    rtt(DefaultRtt), ackedTransmission(AckedBitrateWindowMs, 8000.0f, 50u),
+	    sendTransmission(SendBitrateWindowMs), sendTransmissionTrend(0.15f)
 	{
 		MS_TRACE();
+
+		Reset();
 	}
 
 	SenderBandwidthEstimator::~SenderBandwidthEstimator()
@@ -33,236 +71,514 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		this->availableBitrate              = this->initialAvailableBitrate;
-		this->lastAvailableBitrateEventAtMs = DepLibUV::GetTimeMs();
+		Reset();
+
+		this->availableBitrate = this->initialAvailableBitrate;
+
+		if (this->maxBitrate > 0u)
+			this->availableBitrate = std::min(this->availableBitrate, this->maxBitrate);
 	}
 
 	void SenderBandwidthEstimator::TransportDisconnected()
 	{
 		MS_TRACE();
 
-		this->availableBitrate = 0u;
+		Reset();
 
-		this->sentInfos.clear();
-		this->cummulativeResult.Reset();
+		this->availableBitrate = 0u;
 	}
 
-	void SenderBandwidthEstimator::RtpPacketSent(SentInfo& sentInfo)
+	void SenderBandwidthEstimator::PathChanged(uint32_t startBitrate)
 	{
 		MS_TRACE();
 
-		auto nowMs = sentInfo.sentAtMs;
+		// Nothing measured on the old path applies to the new one.
+		Reset();
 
-		// Remove old sent infos.
-		auto it = this->sentInfos.lower_bound(sentInfo.wideSeq - MaxSentInfoAge + 1);
+		this->availableBitrate = std::max(startBitrate, MinBitrate);
 
-		this->sentInfos.erase(this->sentInfos.begin(), it);
+		if (this->maxBitrate > 0u)
+			this->availableBitrate = std::min(this->availableBitrate, this->maxBitrate);
+	}
 
-		// Insert the sent info into the map.
-		this->sentInfos[sentInfo.wideSeq] = sentInfo;
+	void SenderBandwidthEstimator::RtpPacketSent(const SentInfo& sentInfo)
+	{
+		MS_TRACE();
 
-		// Fill the send transmission counter.
-		this->sendTransmission.Update(sentInfo.size, nowMs);
+		if (this->startedAtMs == 0u)
+			this->startedAtMs = sentInfo.sentAtMs;
 
-		// Update the send transmission trend.
-		auto sendBitrate = this->sendTransmission.GetRate(nowMs);
+		// Older packets with the same slot are not expected to be reported
+		// anymore.
+		this->sentInfos[sentInfo.wideSeq & (SentInfosSize - 1)] = sentInfo;
 
-		this->sendTransmissionTrend.Update(sendBitrate, nowMs);
+		// Probation packets do not tell whether the application is limited.
+		if (sentInfo.isProbation)
+			return;
 
-		// TODO: Remove.
-		// MS_DEBUG_DEV(
-		// 	"[wideSeq:%" PRIu16 ", size:%zu, isProbation:%s, bitrate:%" PRIu32 "]",
-		// 	sentInfo.wideSeq,
-		// 	sentInfo.size,
-		// 	sentInfo.isProbation ? "true" : "false",
-		// 	sendBitrate);
+		this->sendTransmission.Update(sentInfo.size, sentInfo.sentAtMs);
+		this->sendTransmissionTrend.Update(
+		  this->sendTransmission.GetRate(sentInfo.sentAtMs), sentInfo.sentAtMs);
 	}
 
 	void SenderBandwidthEstimator::ReceiveRtcpTransportFeedback(
-	  const RTC::RTCP::FeedbackRtpTransportPacket* feedback)
+	  const RTC::RTCP::FeedbackRtpTransportPacket* feedback, uint64_t nowMs)
 	{
 		MS_TRACE();
 
-		auto nowMs         = DepLibUV::GetTimeMs();
-		uint64_t elapsedMs = nowMs - this->cummulativeResult.GetStartedAtMs();
+		// Not connected.
+		if (this->availableBitrate == 0u)
+			return;
 
-		// Drop ongoing cummulative result if too old.
-		if (elapsedMs > 1000u)
-			this->cummulativeResult.Reset();
+		RTC::RTCP::FeedbackRtpTransportPacket::PacketResultsReader reader(feedback);
+		RTC::RTCP::FeedbackRtpTransportPacket::PacketResult result;
+		size_t numPackets{ 0u };
+		size_t numLostPackets{ 0u };
+		size_t ackedSize{ 0u };
 
-		for (auto& result : feedback->GetPacketResults())
+		while (reader.Read(result))
 		{
-			if (!result.received)
+			auto& sentInfo = this->sentInfos[result.sequenceNumber & (SentInfosSize - 1)];
+
+			// Unknown, already acknowledged or too old packet.
+			if (sentInfo.sentAtMs == 0u || sentInfo.wideSeq != result.sequenceNumber)
 				continue;
 
-			uint16_t wideSeq = result.sequenceNumber;
-			auto it          = this->sentInfos.find(wideSeq);
+			numPackets++;
 
-			if (it == this->sentInfos.end())
+			if (!result.received)
 			{
-				MS_WARN_DEV("received packet not present in sent infos [wideSeq:%" PRIu16 "]", wideSeq);
+				numLostPackets++;
 
 				continue;
 			}
 
-			auto& sentInfo = it->second;
+			ackedSize += sentInfo.size;
 
-			if (!sentInfo.isProbation)
-			{
-				this->cummulativeResult.AddPacket(
-				  sentInfo.size, static_cast<int64_t>(sentInfo.sentAtMs), result.receivedAtMs);
-			}
-			else
-			{
-				this->probationCummulativeResult.AddPacket(
-				  sentInfo.size, static_cast<int64_t>(sentInfo.sentAtMs), result.receivedAtMs);
-			}
+			ReceivePacket(sentInfo.sentAtMs, result.receivedAtMs);
+
+			sentInfo.sentAtMs = 0u;
 		}
 
-		// Handle probation packets separately.
-		if (this->probationCummulativeResult.GetNumPackets() >= 2u)
+		if (numPackets == 0u)
+			return;
+
+		this->ackedTransmission.Update(ackedSize, nowMs);
+
+		auto previousAvailableBitrate = this->availableBitrate;
+
+		UpdateAlr(nowMs);
+		UpdateRateControl(this->ackedTransmission.GetRate(nowMs), nowMs);
+		UpdateLossBasedControl(
+		  static_cast<double>(numLostPackets) / numPackets, previousAvailableBitrate, nowMs);
+
+		if (this->maxBitrate > 0u)
+			this->availableBitrate = std::min(this->availableBitrate, this->maxBitrate);
+
+		this->availableBitrate = std::max(this->availableBitrate, MinBitrate);
+
+		MS_DEBUG_DEV(
+		  "[usage:%d, alr:%s, loss:%f, availableBitrate:%" PRIu32 "]",
+		  static_cast<int>(this->bandwidthUsage),
+		  this->inAlr ? "true" : "false",
+		  this->packetLoss,
+		  this->availableBitrate);
+
+		this->listener->OnSenderBandwidthEstimatorAvailableBitrate(
+		  this, this->availableBitrate, previousAvailableBitrate);
+	}
+
+	void SenderBandwidthEstimator::UpdateRtt(float rtt)
+	{
+		MS_TRACE();
+
+		this->rtt = rtt;
+	}
+
+	void SenderBandwidthEstimator::SetMaxBitrate(uint32_t maxBitrate)
+	{
+		MS_TRACE();
+
+		this->maxBitrate = maxBitrate;
+
+		if (this->maxBitrate > 0u && this->availableBitrate > this->maxBitrate)
+			this->availableBitrate = std::max(this->maxBitrate, MinBitrate);
+	}
+
+	void SenderBandwidthEstimator::Reset()
+	{
+		MS_TRACE();
+
+		this->sentInfos.fill({});
+
+		this->startedAtMs            = 0u;
+		this->currentGroup           = {};
+		this->previousGroup          = {};
+		this->trendlineSamplesIdx    = 0u;
+		this->numTrendlineSamples    = 0u;
+		this->numDeltas              = 0u;
+		this->firstReceivedAtMs      = -1;
+		this->accumulatedDelayMs     = 0;
+		this->smoothedDelayMs        = 0;
+		this->trend                  = 0;
+		this->previousTrend          = 0;
+		this->threshold              = InitialThreshold;
+		this->thresholdUpdatedAtMs   = -1;
+		this->overuseCounter         = 0u;
+		this->bandwidthUsage         = BandwidthUsage::NORMAL;
+		this->rateControlState       = RateControlState::HOLD;
+		this->linkCapacity           = 0u;
+		this->rateControlUpdatedAtMs = 0u;
+		this->lastDecreaseAtMs       = 0u;
+		this->ackedTransmission      = RTC::RateCalculator(AckedBitrateWindowMs, 8000.0f, 50u);
+		this->packetLoss             = 0;
+		this->lastLossDecreaseAtMs   = 0u;
+		this->inAlr                  = false;
+		this->sendTransmission       = RTC::RateCalculator(SendBitrateWindowMs);
+
+		this->sendTransmissionTrend.ForceUpdate(0u, 0u);
+	}
+
+	void SenderBandwidthEstimator::ReceivePacket(uint64_t sentAtMs, int64_t receivedAtMs)
+	{
+		MS_TRACE();
+
+		auto& currentGroup = this->currentGroup;
+
+		// First packet.
+		if (currentGroup.firstSentAtMs == 0u)
 		{
-			// MS_DEBUG_DEV(
-			//   "probation [packets:%zu, size:%zu] "
-			//   "[send bps:%" PRIu32 ", recv bps:%" PRIu32 "] ",
-			//   this->probationCummulativeResult.GetNumPackets(),
-			//   this->probationCummulativeResult.GetTotalSize(),
-			//   this->probationCummulativeResult.GetSendBitrate(),
-			//   this->probationCummulativeResult.GetReceiveBitrate());
-
-			EstimateAvailableBitrate(this->probationCummulativeResult);
-
-			// Reset probation cummulative result.
-			this->probationCummulativeResult.Reset();
+			currentGroup = { sentAtMs, sentAtMs, receivedAtMs };
+
+			return;
 		}
-		else
+
+		// Reordered packet of a previous group.
+		if (sentAtMs < currentGroup.firstSentAtMs)
+			return;
+
+		// Packet of the current group.
+		if (sentAtMs - currentGroup.firstSentAtMs <= BurstIntervalMs)
 		{
-			// Reset probation cummulative result.
-			this->probationCummulativeResult.Reset();
+			currentGroup.lastSentAtMs     = std::max(currentGroup.lastSentAtMs, sentAtMs);
+			currentGroup.lastReceivedAtMs = std::max(currentGroup.lastReceivedAtMs, receivedAtMs);
+
+			return;
 		}
 
-		// Handle real and probation packets all together.
-		if (elapsedMs >= 100u && this->cummulativeResult.GetNumPackets() >= 20u)
+		// The current group is complete, so compare it with the previous one.
+		if (this->previousGroup.firstSentAtMs != 0u)
 		{
-			// auto sendBitrate      = this->sendTransmission.GetRate(nowMs);
-			// auto sendBitrateTrend = this->sendTransmissionTrend.GetValue();
-
-			// MS_DEBUG_DEV(
-			//   "real+prob [packets:%zu, size:%zu] "
-			//   "[send bps:%" PRIu32 ", recv bps:%" PRIu32
-			//   "] "
-			//   "[real bps:%" PRIu32 ", trend bps:%" PRIu32 "]",
-			//   this->cummulativeResult.GetNumPackets(),
-			//   this->cummulativeResult.GetTotalSize(),
-			//   this->cummulativeResult.GetSendBitrate(),
-			//   this->cummulativeResult.GetReceiveBitrate(),
-			//   sendBitrate,
-			//   sendBitrateTrend);
-
-			EstimateAvailableBitrate(this->cummulativeResult);
-
-			// Reset cummulative result.
-			this->cummulativeResult.Reset();
+			auto sendDeltaMs =
+			  static_cast<int64_t>(currentGroup.lastSentAtMs - this->previousGroup.lastSentAtMs);
+			auto receiveDeltaMs = currentGroup.lastReceivedAtMs - this->previousGroup.lastReceivedAtMs;
+
+			if (receiveDeltaMs < 0 || receiveDeltaMs > MaxReceiveDeltaMs)
+			{
+				MS_DEBUG_DEV("unexpected receive delta, resetting delay gradient");
+
+				this->trendlineSamplesIdx = 0u;
+				this->numTrendlineSamples = 0u;
+				this->numDeltas           = 0u;
+				this->firstReceivedAtMs   = -1;
+				this->accumulatedDelayMs  = 0;
+				this->smoothedDelayMs     = 0;
+				this->trend               = 0;
+			}
+			else
+			{
+				UpdateTrendline(
+				  static_cast<double>(receiveDeltaMs - sendDeltaMs), currentGroup.lastReceivedAtMs);
+			}
 		}
+
+		this->previousGroup = currentGroup;
+		currentGroup        = { sentAtMs, sentAtMs, receivedAtMs };
 	}
 
-	void SenderBandwidthEstimator::EstimateAvailableBitrate(CummulativeResult& cummulativeResult)
+	void SenderBandwidthEstimator::UpdateTrendline(double delayVariationMs, int64_t receivedAtMs)
 	{
 		MS_TRACE();
 
-		auto previousAvailableBitrate = this->availableBitrate;
+		if (this->firstReceivedAtMs == -1)
+			this->firstReceivedAtMs = receivedAtMs;
 
-		double ratio = static_cast<double>(cummulativeResult.GetReceiveBitrate()) /
-		               static_cast<double>(cummulativeResult.GetSendBitrate());
-		auto bitrate =
-		  std::min<uint32_t>(cummulativeResult.GetReceiveBitrate(), cummulativeResult.GetSendBitrate());
+		this->numDeltas = std::min(this->numDeltas + 1, MaxNumDeltas);
+		this->accumulatedDelayMs += delayVariationMs;
+		this->smoothedDelayMs =
+		  (SmoothingCoef * this->smoothedDelayMs) + ((1 - SmoothingCoef) * this->accumulatedDelayMs);
 
-		if (0.75f <= ratio && ratio <= 1.25f)
-		{
-			if (bitrate > this->availableBitrate)
-			{
-				this->availableBitrate = bitrate;
+		auto& sample = this->trendlineSamples[this->trendlineSamplesIdx];
 
-				MS_DEBUG_DEV("BWE UP [ratio:%f, availableBitrate:%" PRIu32 "]", ratio, this->availableBitrate);
-			}
-		}
-		else
+		sample.receivedAtMs    = static_cast<double>(receivedAtMs - this->firstReceivedAtMs);
+		sample.smoothedDelayMs = this->smoothedDelayMs;
+
+		this->trendlineSamplesIdx = (this->trendlineSamplesIdx + 1) % TrendlineWindowSize;
+		this->numTrendlineSamples = std::min(this->numTrendlineSamples + 1, TrendlineWindowSize);
+
+		// The delay gradient is the slope of the least squares fit of the
+		// smoothed delay over the receive time.
+		if (this->numTrendlineSamples == TrendlineWindowSize)
 		{
-			if (bitrate < this->availableBitrate)
+			double sumX{ 0 };
+			double sumY{ 0 };
+
+			for (const auto& sample : this->trendlineSamples)
 			{
-				this->availableBitrate = bitrate;
+				sumX += sample.receivedAtMs;
+				sumY += sample.smoothedDelayMs;
+			}
 
-				MS_DEBUG_DEV(
-				  "BWE DOWN [ratio:%f, availableBitrate:%" PRIu32 "]", ratio, this->availableBitrate);
+			const double avgX = sumX / TrendlineWindowSize;
+			const double avgY = sumY / TrendlineWindowSize;
+			double numerator{ 0 };
+			double denominator{ 0 };
+
+			for (const auto& sample : this->trendlineSamples)
+			{
+				numerator += (sample.receivedAtMs - avgX) * (sample.smoothedDelayMs - avgY);
+				denominator += (sample.receivedAtMs - avgX) * (sample.receivedAtMs - avgX);
 			}
+
+			if (denominator != 0)
+				this->trend = numerator / denominator;
 		}
 
-		// TODO: No, should wait for AvailableBitrateEventInterval and so on.
-		this->listener->OnSenderBandwidthEstimatorAvailableBitrate(
-		  this, this->availableBitrate, previousAvailableBitrate);
+		DetectOveruse(this->trend, receivedAtMs);
 	}
 
-	void SenderBandwidthEstimator::UpdateRtt(float rtt)
+	void SenderBandwidthEstimator::DetectOveruse(double trend, int64_t receivedAtMs)
 	{
 		MS_TRACE();
 
-		this->rtt = rtt;
+		if (this->numDeltas < 2u)
+		{
+			this->bandwidthUsage = BandwidthUsage::NORMAL;
+
+			return;
+		}
+
+		const double modifiedTrend = static_cast<double>(this->numDeltas) * trend * ThresholdGain;
+
+		if (modifiedTrend > this->threshold)
+		{
+			this->overuseCounter++;
+
+			// Require a sustained and not decreasing delay gradient.
+			if (this->overuseCounter > 1u && trend >= this->previousTrend)
+			{
+				this->overuseCounter = 0u;
+				this->bandwidthUsage = BandwidthUsage::OVERUSING;
+			}
+		}
+		else if (modifiedTrend < -this->threshold)
+		{
+			this->overuseCounter = 0u;
+			this->bandwidthUsage = BandwidthUsage::UNDERUSING;
+		}
+		else
+		{
+			this->overuseCounter = 0u;
+			this->bandwidthUsage = BandwidthUsage::NORMAL;
+		}
+
+		this->previousTrend = trend;
+
+		UpdateThreshold(modifiedTrend, receivedAtMs);
 	}
 
-	uint32_t SenderBandwidthEstimator::GetAvailableBitrate() const
+	void SenderBandwidthEstimator::UpdateThreshold(double modifiedTrend, int64_t receivedAtMs)
 	{
 		MS_TRACE();
 
-		return this->availableBitrate;
+		if (this->thresholdUpdatedAtMs == -1)
+			this->thresholdUpdatedAtMs = receivedAtMs;
+
+		const double absTrend = std::fabs(modifiedTrend);
+
+		// Do not adapt to spikes.
+		if (absTrend > this->threshold + MaxAdaptOffset)
+		{
+			this->thresholdUpdatedAtMs = receivedAtMs;
+
+			return;
+		}
+
+		const double k = absTrend < this->threshold ? ThresholdKDown : ThresholdKUp;
+		const auto elapsedMs =
+		  std::min(receivedAtMs - this->thresholdUpdatedAtMs, MaxThresholdUpdateIntervalMs);
+
+		this->threshold += k * (absTrend - this->threshold) * static_cast<double>(elapsedMs);
+		this->threshold            = std::min(std::max(this->threshold, MinThreshold), MaxThreshold);
+		this->thresholdUpdatedAtMs = receivedAtMs;
 	}
 
-	void SenderBandwidthEstimator::RescheduleNextAvailableBitrateEvent()
+	void SenderBandwidthEstimator::UpdateAlr(uint64_t nowMs)
 	{
 		MS_TRACE();
 
-		this->lastAvailableBitrateEventAtMs = DepLibUV::GetTimeMs();
+		// The send bitrate is not meaningful until a whole window of it.
+		if (nowMs - this->startedAtMs < SendBitrateWindowMs)
+			return;
+
+		this->sendTransmissionTrend.Update(this->sendTransmission.GetRate(nowMs), nowMs);
+
+		const auto sendBitrate = this->sendTransmissionTrend.GetValue();
+
+		if (!this->inAlr && sendBitrate < this->availableBitrate * AlrStartRatio)
+		{
+			MS_DEBUG_DEV("entering ALR [sendBitrate:%" PRIu32 "]", sendBitrate);
+
+			this->inAlr = true;
+		}
+		else if (this->inAlr && sendBitrate > this->availableBitrate * AlrStopRatio)
+		{
+			MS_DEBUG_DEV("leaving ALR [sendBitrate:%" PRIu32 "]", sendBitrate);
+
+			this->inAlr = false;
+		}
 	}
 
-	void SenderBandwidthEstimator::CummulativeResult::AddPacket(
-	  size_t size, int64_t sentAtMs, int64_t receivedAtMs)
+	void SenderBandwidthEstimator::UpdateRateControl(uint32_t ackedBitrate, uint64_t nowMs)
 	{
 		MS_TRACE();
 
-		if (this->numPackets == 0u)
+		const uint64_t elapsedMs =
+		  this->rateControlUpdatedAtMs == 0u
+		    ? 0u
+		    : std::min(nowMs - this->rateControlUpdatedAtMs, MaxRateControlIntervalMs);
+
+		this->rateControlUpdatedAtMs = nowMs;
+
+		// The acknowledged bitrate is not meaningful until a whole window of it.
+		if (nowMs - this->startedAtMs < AckedBitrateWindowMs)
+			ackedBitrate = 0u;
+
+		auto bitrate = this->availableBitrate;
+
+		switch (this->bandwidthUsage)
 		{
-			this->firstPacketSentAtMs     = sentAtMs;
-			this->firstPacketReceivedAtMs = receivedAtMs;
-			this->lastPacketSentAtMs      = sentAtMs;
-			this->lastPacketReceivedAtMs  = receivedAtMs;
+			case BandwidthUsage::OVERUSING:
+			{
+				this->rateControlState = RateControlState::HOLD;
+
+				// Decrease at most once per round trip time, so the effect of a
+				// decrease is seen before the next one.
+				if (nowMs - this->lastDecreaseAtMs < static_cast<uint64_t>(this->rtt))
+					break;
+
+				auto newBitrate =
+				  static_cast<uint32_t>(Beta * (ackedBitrate > 0u ? ackedBitrate : bitrate));
+
+				// Never increase on overuse.
+				if (newBitrate > bitrate)
+					newBitrate = static_cast<uint32_t>(Beta * bitrate);
+
+				if (ackedBitrate > 0u)
+				{
+					this->linkCapacity =
+					  this->linkCapacity == 0u
+					    ? ackedBitrate
+					    : static_cast<uint32_t>(
+					        (LinkCapacitySmoothing * this->linkCapacity) +
+					        ((1 - LinkCapacitySmoothing) * ackedBitrate));
+				}
+
+				MS_DEBUG_DEV(
+				  "overuse, decreasing [ackedBitrate:%" PRIu32 ", bitrate:%" PRIu32 "]",
+				  ackedBitrate,
+				  newBitrate);
+
+				bitrate                = newBitrate;
+				this->lastDecreaseAtMs = nowMs;
+
+				break;
+			}
+
+			case BandwidthUsage::UNDERUSING:
+			{
+				// Let the queues drain.
+				this->rateControlState = RateControlState::HOLD;
+
+				break;
+			}
+
+			case BandwidthUsage::NORMAL:
+			{
+				this->rateControlState = RateControlState::INCREASE;
+
+				break;
+			}
 		}
-		else
+
+		if (this->rateControlState == RateControlState::INCREASE && !this->inAlr)
 		{
-			if (sentAtMs < this->firstPacketSentAtMs)
-				this->firstPacketSentAtMs = sentAtMs;
+			// The link capacity changed, so forget it.
+			if (this->linkCapacity > 0u && bitrate > this->linkCapacity * LinkCapacityUpperMargin)
+				this->linkCapacity = 0u;
 
-			if (receivedAtMs < this->firstPacketReceivedAtMs)
-				this->firstPacketReceivedAtMs = receivedAtMs;
+			uint32_t increase;
 
-			if (sentAtMs > this->lastPacketSentAtMs)
-				this->lastPacketSentAtMs = sentAtMs;
+			// Near the link capacity, increase a packet per response time.
+			if (this->linkCapacity > 0u && bitrate >= this->linkCapacity * LinkCapacityLowerMargin)
+			{
+				const double responseTimeMs = this->rtt + ResponseTimeExtraMs;
+
+				increase = static_cast<uint32_t>(AdditiveIncreasePacketBits * elapsedMs / responseTimeMs);
+			}
+			else
+			{
+				const double factor =
+				  std::pow(MultiplicativeIncreaseFactor, static_cast<double>(elapsedMs) / 1000);
 
-			if (receivedAtMs > this->lastPacketReceivedAtMs)
-				this->lastPacketReceivedAtMs = receivedAtMs;
+				increase = static_cast<uint32_t>(bitrate * (factor - 1));
+			}
+
+			auto newBitrate = bitrate + std::max(increase, MinIncrease);
+
+			// Do not go far beyond what the remote endpoint acknowledges.
+			if (ackedBitrate > 0u)
+			{
+				const auto maxBitrate =
+				  static_cast<uint32_t>(MaxAckedBitrateFactor * ackedBitrate) + AckedBitrateMargin;
+
+				newBitrate = std::min(newBitrate, std::max(bitrate, maxBitrate));
+			}
+
+			bitrate = newBitrate;
 		}
 
-		this->numPackets++;
-		this->totalSize += size;
+		this->availableBitrate = bitrate;
 	}
 
-	void SenderBandwidthEstimator::CummulativeResult::Reset()
+	void SenderBandwidthEstimator::UpdateLossBasedControl(
+	  double packetLoss, uint32_t previousAvailableBitrate, uint64_t nowMs)
 	{
 		MS_TRACE();
 
-		this->numPackets              = 0u;
-		this->totalSize               = 0u;
-		this->firstPacketSentAtMs     = 0u;
-		this->lastPacketSentAtMs      = 0u;
-		this->firstPacketReceivedAtMs = 0u;
-		this->lastPacketReceivedAtMs  = 0u;
+		this->packetLoss = (LossSmoothing * this->packetLoss) + ((1 - LossSmoothing) * packetLoss);
+
+		if (this->packetLoss > HighLoss)
+		{
+			if (nowMs - this->lastLossDecreaseAtMs >= LossDecreaseIntervalMs + this->rtt)
+			{
+				MS_DEBUG_DEV("high packet loss, decreasing [loss:%f]", this->packetLoss);
+
+				this->availableBitrate = std::min(
+				  this->availableBitrate,
+				  static_cast<uint32_t>(previousAvailableBitrate * (1 - (0.5 * this->packetLoss))));
+
+				this->lastLossDecreaseAtMs = nowMs;
+			}
+			else
+			{
+				this->availableBitrate = std::min(this->availableBitrate, previousAvailableBitrate);
+			}
+		}
+		// Hold the estimate.
+		else if (this->packetLoss > LowLoss)
+		{
+			this->availableBitrate = std::min(this->availableBitrate, previousAvailableBitrate);
+		}
 	}
 } // namespace RTC
@@ -3,7 +3,8 @@
 
 #include "RTC/SeqManager.hpp"
 #include "Logger.hpp"
-#include <iterator>
+#include "Utils.hpp"
+#include <algorithm> // std::fill(), std::min()
 
 namespace RTC
 {
@@ -48,18 +49,46 @@ namespace RTC
 		// Update maxInput.
 		this->maxInput = input;
 
-		// Clear dropped set.
-		this->dropped.clear();
+		// Clear dropped ring.
+		if (this->numDropped != 0u)
+		{
+			std::fill(this->droppedBits.begin(), this->droppedBits.end(), uint64_t{ 0u });
+
+			this->numDropped = 0u;
+		}
 	}
 
 	template<typename T>
 	void SeqManager<T>::Drop(T input)
 	{
 		// Mark as dropped if 'input' is higher than anyone already processed.
-		if (SeqManager<T>::IsSeqHigherThan(input, this->maxInput))
+		if (!SeqManager<T>::IsSeqHigherThan(input, this->maxInput))
+			return;
+
+		if (this->droppedBits.empty())
+			this->droppedBits.resize(RingSize / 64u, 0u);
+
+		if (this->numDropped == 0u)
+			this->droppedHead = input;
+		else if (SeqManager<T>::IsSeqHigherThan(input, this->droppedHead))
+			AdvanceDropped(input);
+
+		// Too old to be tracked, so it is lower than any input to come.
+		if (static_cast<T>(this->droppedHead - input) >= RingSize)
 		{
-			this->dropped.insert(input);
+			--this->base;
+
+			return;
 		}
+
+		if (IsDropped(input))
+			return;
+
+		const size_t slot = input & (RingSize - 1u);
+
+		this->droppedBits[slot / 64u] |= uint64_t{ 1u } << (slot % 64u);
+
+		++this->numDropped;
 	}
 
 	template<typename T>
@@ -68,39 +97,39 @@ namespace RTC
 		this->base += offset;
 	}
 
+	template<typename T>
+	void SeqManager<T>::SetMaxOutput(T maxOutput)
+	{
+		this->maxOutput = maxOutput;
+	}
+
 	template<typename T>
 	bool SeqManager<T>::Input(const T input, T& output)
 	{
 		auto base = this->base;
 
 		// There are dropped inputs. Synchronize.
-		if (!this->dropped.empty())
+		if (this->numDropped != 0u)
 		{
-			// Delete dropped inputs older than input - MaxValue/2.
-			size_t droppedCount = this->dropped.size();
-			auto it             = this->dropped.lower_bound(input - MaxValue / 2);
+			// Fold dropped inputs older than input - RingSize into the base.
+			if (SeqManager<T>::IsSeqHigherThan(input, this->droppedHead))
+				AdvanceDropped(input);
 
-			this->dropped.erase(this->dropped.begin(), it);
-			this->base -= (droppedCount - this->dropped.size());
+			const auto distance = static_cast<T>(this->droppedHead - input);
 
 			// Count dropped entries before 'input' in order to adapt the base.
-			droppedCount = this->dropped.size();
-			it           = this->dropped.lower_bound(input);
-
-			if (it != this->dropped.end())
+			if (distance < RingSize)
 			{
 				// Check whether this input was dropped.
-				if (*it == input)
+				if (IsDropped(input))
 				{
 					MS_DEBUG_DEV("trying to send a dropped input");
 
 					return false;
 				}
 
-				droppedCount -= std::distance(it, this->dropped.end());
+				base = this->base - (this->numDropped - CountDropped(input + 1, distance));
 			}
-
-			base = this->base - droppedCount;
 		}
 
 		output = input + base;
@@ -133,6 +162,71 @@ namespace RTC
 		return this->maxOutput;
 	}
 
+	/*
+	 * Moves the head of the dropped ring to the given (higher) input and folds
+	 * the dropped inputs leaving the ring into the base.
+	 */
+	template<typename T>
+	void SeqManager<T>::AdvanceDropped(T input)
+	{
+		const auto advance = static_cast<T>(input - this->droppedHead);
+		size_t numFolded;
+
+		// Slots of inputs in (droppedHead, input] are reused.
+		if (advance >= RingSize)
+		{
+			numFolded = this->numDropped;
+
+			std::fill(this->droppedBits.begin(), this->droppedBits.end(), uint64_t{ 0u });
+		}
+		else
+		{
+			numFolded = CountDropped(this->droppedHead + 1, advance, /*clear*/ true);
+		}
+
+		this->base -= static_cast<T>(numFolded);
+		this->numDropped -= numFolded;
+		this->droppedHead = input;
+	}
+
+	/*
+	 * Counts (and optionally clears) the dropped inputs in
+	 * [inputStart, inputStart + count), a ring word at a time.
+	 */
+	template<typename T>
+	size_t SeqManager<T>::CountDropped(T inputStart, size_t count, bool clear)
+	{
+		size_t numDropped{ 0u };
+		size_t slot = inputStart & (RingSize - 1u);
+
+		while (count != 0u)
+		{
+			const size_t bit       = slot % 64u;
+			const size_t wordCount = std::min(count, 64u - bit);
+			const uint64_t mask =
+			  (wordCount == 64u ? ~uint64_t{ 0u } : (uint64_t{ 1u } << wordCount) - 1u) << bit;
+			auto& word = this->droppedBits[slot / 64u];
+
+			numDropped += Utils::Bits::CountSetBits(word & mask);
+
+			if (clear)
+				word &= ~mask;
+
+			slot = (slot + wordCount) & (RingSize - 1u);
+			count -= wordCount;
+		}
+
+		return numDropped;
+	}
+
+	template<typename T>
+	bool SeqManager<T>::IsDropped(T input) const
+	{
+		const size_t slot = input & (RingSize - 1u);
+
+		return (this->droppedBits[slot / 64u] & (uint64_t{ 1u } << (slot % 64u))) != 0u;
+	}
+
 	// Explicit instantiation to have all SeqManager definitions in this file.
 	template class SeqManager<uint8_t>;
 	template class SeqManager<uint16_t>;
@@ -0,0 +1,158 @@
+#define MS_CLASS "RTC::SharedUdpSocket"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/SharedUdpSocket.hpp"
+#include "Logger.hpp"
+#include <algorithm> // std::find()
+
+namespace RTC
+{
+	/* Class variables. */
+
+	thread_local absl::flat_hash_map<std::string, SharedUdpSocket*> SharedUdpSocket::sharedUdpSockets;
+
+	/* Class methods. */
+
+	SharedUdpSocket* SharedUdpSocket::Acquire(Listener* listener, std::string& ip, uint16_t port)
+	{
+		MS_TRACE();
+
+		const std::string key = ip + ":" + std::to_string(port);
+		SharedUdpSocket* sharedUdpSocket{ nullptr };
+
+		auto it = SharedUdpSocket::sharedUdpSockets.find(key);
+
+		if (it != SharedUdpSocket::sharedUdpSockets.end())
+		{
+			sharedUdpSocket = it->second;
+		}
+		else
+		{
+			// This may throw.
+			sharedUdpSocket = new SharedUdpSocket(key, ip, port);
+
+			SharedUdpSocket::sharedUdpSockets[key] = sharedUdpSocket;
+		}
+
+		sharedUdpSocket->listeners.push_back(listener);
+
+		return sharedUdpSocket;
+	}
+
+	void SharedUdpSocket::Release(SharedUdpSocket* sharedUdpSocket, Listener* listener)
+	{
+		MS_TRACE();
+
+		sharedUdpSocket->UnbindTuple(listener);
+
+		auto& listeners = sharedUdpSocket->listeners;
+		auto it         = std::find(listeners.begin(), listeners.end(), listener);
+
+		if (it != listeners.end())
+			listeners.erase(it);
+
+		if (!listeners.empty())
+			return;
+
+		SharedUdpSocket::sharedUdpSockets.erase(sharedUdpSocket->key);
+
+		delete sharedUdpSocket;
+	}
+
+	/* Instance methods. */
+
+	SharedUdpSocket::SharedUdpSocket(const std::string& key, std::string& ip, uint16_t port)
+	  : key(key)
+	{
+		MS_TRACE();
+
+		// This may throw.
+		if (port != 0)
+			this->udpSocket = new RTC::UdpSocket(this, ip, port);
+		else
+			this->udpSocket = new RTC::UdpSocket(this, ip);
+	}
+
+	SharedUdpSocket::~SharedUdpSocket()
+	{
+		MS_TRACE();
+
+		delete this->udpSocket;
+		this->udpSocket = nullptr;
+	}
+
+	void SharedUdpSocket::BindTuple(Listener* listener, const RTC::TransportTuple* tuple)
+	{
+		MS_TRACE();
+
+		// A listener is bound to a single tuple.
+		UnbindTuple(listener);
+
+		auto it = this->mapTupleListener.find(tuple->key);
+
+		if (it != this->mapTupleListener.end() && it->second != listener)
+		{
+			MS_WARN_TAG(rtp, "tuple already bound to another listener, replacing it");
+
+			this->mapListenerTuple.erase(it->second);
+		}
+
+		this->mapTupleListener[tuple->key] = listener;
+		this->mapListenerTuple[listener]    = tuple->key;
+	}
+
+	void SharedUdpSocket::UnbindTuple(Listener* listener)
+	{
+		MS_TRACE();
+
+		auto it = this->mapListenerTuple.find(listener);
+
+		if (it == this->mapListenerTuple.end())
+			return;
+
+		this->mapTupleListener.erase(it->second);
+		this->mapListenerTuple.erase(it);
+	}
+
+	bool SharedUdpSocket::IsBound(Listener* listener) const
+	{
+		MS_TRACE();
+
+		return this->mapListenerTuple.find(listener) != this->mapListenerTuple.end();
+	}
+
+	inline void SharedUdpSocket::OnUdpSocketPacketReceived(
+	  RTC::UdpSocket* socket, const uint8_t* data, size_t len, const struct sockaddr* remoteAddr)
+	{
+		MS_TRACE();
+
+		RTC::TransportTuple tuple(socket, remoteAddr);
+
+		auto it = this->mapTupleListener.find(tuple.key);
+
+		if (it != this->mapTupleListener.end())
+		{
+			it->second->OnSharedUdpSocketPacketReceived(this, &tuple, data, len);
+
+			return;
+		}
+
+		// Unknown tuple, offer the packet to the listeners waiting for one.
+		for (auto* listener : this->listeners)
+		{
+			if (IsBound(listener))
+				continue;
+
+			if (!listener->OnSharedUdpSocketClaimPacket(this, data, len))
+				continue;
+
+			BindTuple(listener, &tuple);
+
+			listener->OnSharedUdpSocketPacketReceived(this, &tuple, data, len);
+
+			return;
+		}
+
+		MS_DEBUG_TAG(rtp, "ignoring packet from unknown tuple");
+	}
+} // namespace RTC
@@ -5,11 +5,20 @@
 #include "DepLibUV.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Tracepoints.hpp"
 #include "Channel/ChannelNotifier.hpp"
+#include "RTC/Codecs/Opus.hpp"
 #include "RTC/Codecs/Tools.hpp"
+#include <vector>
 
 namespace RTC
 {
+	/* Static. */
+
+	// Retransmission buffer size (in packets) if NACK is supported.
+	static constexpr size_t VideoRetransmissionBufferSize{ 600u };
+	static constexpr size_t AudioRetransmissionBufferSize{ 100u };
+
 	/* Instance methods. */
 
 	SimpleConsumer::SimpleConsumer(
@@ -19,7 +28,7 @@ namespace RTC
 		MS_TRACE();
 
 		// Ensure there is a single encoding.
-		if (this->consumableRtpEncodings.size() != 1u)
+		if (this->consumableRtpEncodings->size() != 1u)
 			MS_THROW_TYPE_ERROR("invalid consumableRtpEncodings with size != 1");
 
 		auto& encoding         = this->rtpParameters.encodings[0];
@@ -27,8 +36,50 @@ namespace RTC
 
 		this->keyFrameSupported = RTC::Codecs::Tools::CanBeKeyFrame(mediaCodec->mimeType);
 
+		auto jsonIgnoreDtxIt = data.find("ignoreDtx");
+
+		// NOTE: Just Opus DTX packets can be detected.
+		// clang-format off
+		if (
+			jsonIgnoreDtxIt != data.end() &&
+			jsonIgnoreDtxIt->is_boolean() &&
+			jsonIgnoreDtxIt->get<bool>() &&
+			(
+				mediaCodec->mimeType.subtype == RTC::RtpCodecMimeType::Subtype::OPUS ||
+				mediaCodec->mimeType.subtype == RTC::RtpCodecMimeType::Subtype::MULTIOPUS
+			)
+		)
+		// clang-format on
+		{
+			this->ignoreDtx = true;
+		}
+
+		// Consumers of the same Producer with the same codecs and DTX setting take
+		// the same decision for every packet, so they can share send state.
+		this->groupKey = this->ignoreDtx ? "simple:ignoreDtx" : "simple";
+
+		for (size_t payloadType{ 0u }; payloadType < this->supportedCodecPayloadTypes.size();
+		     ++payloadType)
+		{
+			if (this->supportedCodecPayloadTypes.test(payloadType))
+				this->groupKey.append(":").append(std::to_string(payloadType));
+		}
+
+		this->headerTemplate.SetSsrc(encoding.ssrc);
+
 		// Create RtpStreamSend instance for sending a single stream to the remote.
 		CreateRtpStream();
+
+		auto jsonSendStateIt = data.find("sendState");
+
+		// Continue the stream of a migrated Consumer (if given).
+		if (jsonSendStateIt != data.end())
+		{
+			// This may throw.
+			ApplySendState(*jsonSendStateIt, this->rtpSeqManager, this->rtpStream);
+
+			this->syncRequired = true;
+		}
 	}
 
 	SimpleConsumer::~SimpleConsumer()
@@ -81,6 +132,13 @@ namespace RTC
 		jsonObject["producerScores"] = *this->producerRtpStreamScores;
 	}
 
+	void SimpleConsumer::FillJsonSendState(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		FillJsonStreamSendState(jsonObject, this->rtpSeqManager, this->rtpStream);
+	}
+
 	void SimpleConsumer::HandleRequest(Channel::ChannelRequest* request)
 	{
 		MS_TRACE();
@@ -232,6 +290,17 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		if (this->kind == RTC::Media::Kind::AUDIO)
+			ForwardRtpPacket<RTC::Media::Kind::AUDIO>(packet);
+		else
+			ForwardRtpPacket<RTC::Media::Kind::VIDEO>(packet);
+	}
+
+	template<RTC::Media::Kind Kind>
+	void SimpleConsumer::ForwardRtpPacket(RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
 		if (!IsActive())
 			return;
 
@@ -239,17 +308,40 @@ namespace RTC
 
 		// NOTE: This may happen if this Consumer supports just some codecs of those
 		// in the corresponding Producer.
-		if (this->supportedCodecPayloadTypes.find(payloadType) == this->supportedCodecPayloadTypes.end())
+		if (!this->supportedCodecPayloadTypes.test(payloadType))
 		{
 			MS_DEBUG_DEV("payload type not supported [payloadType:%" PRIu8 "]", payloadType);
 
+			MS_TRACEPOINT(
+			  consumer_packet_dropped,
+			  this->id.c_str(),
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  "unsupported_payload_type");
+
 			return;
 		}
 
 		// If we need to sync, support key frames and this is not a key frame, ignore
 		// the packet.
-		if (this->syncRequired && this->keyFrameSupported && !packet->IsKeyFrame())
+		// clang-format off
+		if (
+			Kind == RTC::Media::Kind::VIDEO &&
+			this->syncRequired &&
+			this->keyFrameSupported &&
+			!packet->IsKeyFrame()
+		)
+		// clang-format on
+		{
+			MS_TRACEPOINT(
+			  consumer_packet_dropped,
+			  this->id.c_str(),
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  "waiting_key_frame");
+
 			return;
+		}
 
 		// Whether this is the first packet after re-sync.
 		bool isSyncPacket = this->syncRequired;
@@ -257,26 +349,61 @@ namespace RTC
 		// Sync sequence number and timestamp if required.
 		if (isSyncPacket)
 		{
-			if (packet->IsKeyFrame())
+			if (Kind == RTC::Media::Kind::VIDEO && packet->IsKeyFrame())
 				MS_DEBUG_TAG(rtp, "sync key frame received");
 
-			this->rtpSeqManager.Sync(packet->GetSequenceNumber() - 1);
+			// NOTE: Members of a group continue their stream when computing their
+			// offset below.
+			if (!this->group)
+				this->rtpSeqManager.Sync(packet->GetSequenceNumber() - 1);
 
 			this->syncRequired = false;
 		}
 
+		// Drop DTX packets if requested.
+		if (Kind == RTC::Media::Kind::AUDIO && this->ignoreDtx && RTC::Codecs::Opus::IsDtx(packet))
+		{
+			MS_TRACEPOINT(
+			  consumer_packet_dropped,
+			  this->id.c_str(),
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  "dtx");
+
+			DropSeq(packet->GetSequenceNumber());
+
+			return;
+		}
+
 		// Update RTP seq number and timestamp.
 		uint16_t seq;
 
-		this->rtpSeqManager.Input(packet->GetSequenceNumber(), seq);
+		if (this->group)
+		{
+			uint16_t groupSeq;
+
+			this->group->Input(packet->GetSequenceNumber(), groupSeq);
+
+			// Continue the stream right after the last sent packet.
+			if (isSyncPacket)
+				this->groupSeqOffset = this->rtpSeqManager.GetMaxOutput() + 1 - groupSeq;
 
-		// Save original packet fields.
-		auto origSsrc = packet->GetSsrc();
-		auto origSeq  = packet->GetSequenceNumber();
+			seq = groupSeq + this->groupSeqOffset;
 
-		// Rewrite packet.
-		packet->SetSsrc(this->rtpParameters.encodings[0].ssrc);
-		packet->SetSequenceNumber(seq);
+			// Keep the max output of the own SeqManager so the stream can be continued
+			// after a re-sync or exported.
+			if (RTC::SeqManager<uint16_t>::IsSeqHigherThan(seq, this->rtpSeqManager.GetMaxOutput()))
+				this->rtpSeqManager.SetMaxOutput(seq);
+		}
+		else
+		{
+			this->rtpSeqManager.Input(packet->GetSequenceNumber(), seq);
+		}
+
+		RTC::RtpHeaderTemplate::SavedHeader savedHeader;
+
+		// Rewrite packet (saving its original header).
+		this->headerTemplate.Apply(packet, seq, savedHeader);
 
 		if (isSyncPacket)
 		{
@@ -287,7 +414,7 @@ namespace RTC
 			  packet->GetSsrc(),
 			  packet->GetSequenceNumber(),
 			  packet->GetTimestamp(),
-			  origSeq);
+			  uint16_t{ ntohs(savedHeader.sequenceNumber) });
 		}
 
 		// Process the packet.
@@ -308,12 +435,11 @@ namespace RTC
 			  packet->GetSsrc(),
 			  packet->GetSequenceNumber(),
 			  packet->GetTimestamp(),
-			  origSeq);
+			  uint16_t{ ntohs(savedHeader.sequenceNumber) });
 		}
 
-		// Restore packet fields.
-		packet->SetSsrc(origSsrc);
-		packet->SetSequenceNumber(origSeq);
+		// Restore packet header.
+		RTC::RtpHeaderTemplate::Restore(packet, savedHeader);
 	}
 
 	void SimpleConsumer::GetRtcp(
@@ -334,9 +460,10 @@ namespace RTC
 		packet->AddSenderReport(report);
 
 		// Build SDES chunk for this sender.
-		auto* sdesChunk = this->rtpStream->GetRtcpSdesChunk();
+		auto* sdesChunk = this->rtpStream->GetRtcpSdesChunk(nowMs);
 
-		packet->AddSdesChunk(sdesChunk);
+		if (sdesChunk)
+			packet->AddSdesChunk(sdesChunk);
 
 		auto* dlrr = this->rtpStream->GetRtcpXrDelaySinceLastRr(nowMs);
 
@@ -440,6 +567,44 @@ namespace RTC
 		return this->rtpStream->GetRtt();
 	}
 
+	bool SimpleConsumer::SendKeyFrameCache(const std::vector<RTC::RtpPacket*>& packets)
+	{
+		MS_TRACE();
+
+		if (!IsActive() || !this->syncRequired || !this->keyFrameSupported)
+			return false;
+
+		if (packets.empty() || !packets.front()->IsKeyFrame())
+			return false;
+
+		MS_DEBUG_TAG(rtp, "sending cached key frame [packets:%zu]", packets.size());
+
+		for (auto* packet : packets)
+		{
+			SendRtpPacket(packet);
+		}
+
+		return !this->syncRequired;
+	}
+
+	void SimpleConsumer::DropRtpPacket(RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		// NOTE: The stream is synced again with the next sent packet anyway.
+		if (!IsActive() || this->syncRequired)
+			return;
+
+		MS_TRACEPOINT(
+		  consumer_packet_dropped,
+		  this->id.c_str(),
+		  packet->GetSsrc(),
+		  packet->GetSequenceNumber(),
+		  "last_n");
+
+		DropSeq(packet->GetSequenceNumber());
+	}
+
 	void SimpleConsumer::UserOnTransportConnected()
 	{
 		MS_TRACE();
@@ -490,11 +655,12 @@ namespace RTC
 		// Set stream params.
 		RTC::RtpStream::Params params;
 
-		params.ssrc        = encoding.ssrc;
-		params.payloadType = mediaCodec->payloadType;
-		params.mimeType    = mediaCodec->mimeType;
-		params.clockRate   = mediaCodec->clockRate;
-		params.cname       = this->rtpParameters.rtcp.cname;
+		params.ssrc            = encoding.ssrc;
+		params.payloadType     = mediaCodec->payloadType;
+		params.mimeType        = mediaCodec->mimeType;
+		params.clockRate       = mediaCodec->clockRate;
+		params.cname           = this->rtpParameters.rtcp.cname;
+		params.rtcpReducedSize = this->rtpParameters.rtcp.reducedSize;
 
 		// Check in band FEC in codec parameters.
 		if (mediaCodec->parameters.HasInteger("useinbandfec") && mediaCodec->parameters.GetInteger("useinbandfec") == 1)
@@ -543,7 +709,13 @@ namespace RTC
 		}
 
 		// Create a RtpStreamSend for sending a single media stream.
-		size_t bufferSize = params.useNack ? 600u : 0u;
+		size_t bufferSize{ 0u };
+
+		if (params.useNack)
+		{
+			bufferSize = this->kind == RTC::Media::Kind::AUDIO ? AudioRetransmissionBufferSize
+			                                                   : VideoRetransmissionBufferSize;
+		}
 
 		this->rtpStream = new RTC::RtpStreamSend(this, params, bufferSize);
 		this->rtpStreams.push_back(this->rtpStream);
@@ -556,6 +728,11 @@ namespace RTC
 
 		if (rtxCodec && encoding.hasRtx)
 			this->rtpStream->SetRtx(rtxCodec->payloadType, encoding.rtx.ssrc);
+
+		const auto* fecCodec = this->rtpParameters.GetFecCodec();
+
+		if (fecCodec && encoding.hasFec)
+			this->rtpStream->SetFec(fecCodec->payloadType, encoding.fec.ssrc);
 	}
 
 	void SimpleConsumer::RequestKeyFrame()
@@ -565,11 +742,21 @@ namespace RTC
 		if (this->kind != RTC::Media::Kind::VIDEO)
 			return;
 
-		auto mappedSsrc = this->consumableRtpEncodings[0].ssrc;
+		auto mappedSsrc = (*this->consumableRtpEncodings)[0].ssrc;
 
 		this->listener->OnConsumerKeyFrameRequested(this, mappedSsrc);
 	}
 
+	inline void SimpleConsumer::DropSeq(uint16_t seq)
+	{
+		MS_TRACE();
+
+		if (this->group)
+			this->group->Drop(seq);
+		else
+			this->rtpSeqManager.Drop(seq);
+	}
+
 	inline void SimpleConsumer::EmitScore() const
 	{
 		MS_TRACE();
@@ -578,7 +765,7 @@ namespace RTC
 
 		FillJsonScore(data);
 
-		Channel::ChannelNotifier::Emit(this->id, "score", data);
+		Channel::ChannelNotifier::EmitBatched(this->id, "score", data);
 	}
 
 	inline void SimpleConsumer::OnRtpStreamScore(
@@ -590,14 +777,25 @@ namespace RTC
 		EmitScore();
 	}
 
-	inline void SimpleConsumer::OnRtpStreamRetransmitRtpPacket(
-	  RTC::RtpStreamSend* /*rtpStream*/, RTC::RtpPacket* packet)
+	inline void SimpleConsumer::OnRtpStreamRetransmitRtpPackets(
+	  RTC::RtpStreamSend* /*rtpStream*/, RTC::RtpPacket** packets, size_t count)
 	{
 		MS_TRACE();
 
-		this->listener->OnConsumerRetransmitRtpPacket(this, packet);
+		this->listener->OnConsumerRetransmitRtpPackets(this, packets, count);
 
 		// May emit 'trace' event.
-		EmitTraceEventRtpAndKeyFrameTypes(packet, this->rtpStream->HasRtx());
+		for (size_t idx{ 0u }; idx < count; ++idx)
+		{
+			EmitTraceEventRtpAndKeyFrameTypes(packets[idx], this->rtpStream->HasRtx());
+		}
+	}
+
+	inline void SimpleConsumer::OnRtpStreamSendFecPacket(
+	  RTC::RtpStreamSend* /*rtpStream*/, RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		this->listener->OnConsumerSendRtpPacket(this, packet);
 	}
 } // namespace RTC
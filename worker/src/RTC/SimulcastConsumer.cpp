@@ -5,6 +5,7 @@
 #include "DepLibUV.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Tracepoints.hpp"
 #include "Utils.hpp"
 #include "Channel/ChannelNotifier.hpp"
 #include "RTC/Codecs/Tools.hpp"
@@ -16,6 +17,12 @@ namespace RTC
 	static constexpr uint64_t StreamMinActiveMs{ 2000u };           // In ms.
 	static constexpr uint64_t BweDowngradeConservativeMs{ 10000u }; // In ms.
 	static constexpr uint64_t BweDowngradeMinActiveMs{ 8000u };     // In ms.
+	// Upper bounds of the spatial layer switch latency histogram buckets (the
+	// last bucket counts the switches above them).
+	static constexpr std::array<uint64_t, 6> SpatialLayerSwitchLatencyBucketsMs{
+		50u, 100u, 250u, 500u, 1000u, 2000u
+	};
+	static constexpr float MaxThumbnailFramerate{ 5.0f };
 
 	/* Instance methods. */
 
@@ -26,23 +33,24 @@ namespace RTC
 		MS_TRACE();
 
 		// Ensure there are N > 1 encodings.
-		if (this->consumableRtpEncodings.size() <= 1u)
+		if (this->consumableRtpEncodings->size() <= 1u)
 			MS_THROW_TYPE_ERROR("invalid consumableRtpEncodings with size <= 1");
 
 		auto& encoding = this->rtpParameters.encodings[0];
 
 		// Ensure there are as many spatial layers as encodings.
-		if (encoding.spatialLayers != this->consumableRtpEncodings.size())
+		if (encoding.spatialLayers != this->consumableRtpEncodings->size())
 		{
 			MS_THROW_TYPE_ERROR("encoding.spatialLayers does not match number of consumableRtpEncodings");
 		}
 
-		auto jsonPreferredLayersIt = data.find("preferredLayers");
+		auto jsonPreferredLayersIt    = data.find("preferredLayers");
+		auto jsonThumbnailFramerateIt = data.find("thumbnailFramerate");
 
 		// Fill mapMappedSsrcSpatialLayer.
-		for (size_t idx{ 0u }; idx < this->consumableRtpEncodings.size(); ++idx)
+		for (size_t idx{ 0u }; idx < this->consumableRtpEncodings->size(); ++idx)
 		{
-			auto& encoding = this->consumableRtpEncodings[idx];
+			auto& encoding = (*this->consumableRtpEncodings)[idx];
 
 			this->mapMappedSsrcSpatialLayer[encoding.ssrc] = static_cast<int16_t>(idx);
 		}
@@ -93,10 +101,29 @@ namespace RTC
 			this->preferredTemporalLayer = encoding.temporalLayers - 1;
 		}
 
+		if (jsonThumbnailFramerateIt != data.end())
+		{
+			// clang-format off
+			if (
+				!jsonThumbnailFramerateIt->is_number() ||
+				jsonThumbnailFramerateIt->get<float>() <= 0 ||
+				jsonThumbnailFramerateIt->get<float>() > MaxThumbnailFramerate
+			)
+			// clang-format on
+			{
+				MS_THROW_TYPE_ERROR(
+				  "wrong thumbnailFramerate (not a number greater than 0 and up to %g)",
+				  MaxThumbnailFramerate);
+			}
+
+			this->thumbnailFramerate  = jsonThumbnailFramerateIt->get<float>();
+			this->thumbnailIntervalMs = static_cast<uint64_t>(1000 / this->thumbnailFramerate);
+		}
+
 		// Reserve space for the Producer RTP streams by filling all the possible
 		// entries with nullptr.
 		this->producerRtpStreams.insert(
-		  this->producerRtpStreams.begin(), this->consumableRtpEncodings.size(), nullptr);
+		  this->producerRtpStreams.begin(), this->consumableRtpEncodings->size(), nullptr);
 
 		// Create the encoding context.
 		const auto* mediaCodec = this->rtpParameters.GetCodecForEncoding(encoding);
@@ -116,8 +143,42 @@ namespace RTC
 
 		MS_ASSERT(this->encodingContext, "no encoding context for this codec");
 
+		this->processPayloadFn = RTC::Codecs::Tools::GetProcessPayloadFn(mediaCodec->mimeType);
+		this->restorePayloadFn = RTC::Codecs::Tools::GetRestorePayloadFn(mediaCodec->mimeType);
+
+		this->headerTemplate.SetSsrc(this->rtpParameters.encodings[0].ssrc);
+
 		// Create RtpStreamSend instance for sending a single stream to the remote.
 		CreateRtpStream();
+
+		auto jsonSendStateIt = data.find("sendState");
+
+		// Continue the stream of a migrated Consumer (if given). There is no
+		// need to force a sync since switching to the first layer does it.
+		if (jsonSendStateIt != data.end())
+		{
+			// This may throw.
+			ApplySendState(*jsonSendStateIt, this->rtpSeqManager, this->rtpStream);
+
+			auto jsonTsReferenceSpatialLayerIt = jsonSendStateIt->find("tsReferenceSpatialLayer");
+			auto jsonMarkerIt = jsonSendStateIt->find("lastSentPacketHasMarker");
+
+			// Keep the RTP timestamps of the exported Consumer by referring them to
+			// the same spatial layer.
+			// clang-format off
+			if (
+				jsonTsReferenceSpatialLayerIt != jsonSendStateIt->end() &&
+				Utils::Json::IsPositiveInteger(*jsonTsReferenceSpatialLayerIt) &&
+				jsonTsReferenceSpatialLayerIt->get<size_t>() < this->producerRtpStreams.size()
+			)
+			// clang-format on
+			{
+				this->tsReferenceSpatialLayer = jsonTsReferenceSpatialLayerIt->get<int16_t>();
+			}
+
+			if (jsonMarkerIt != jsonSendStateIt->end() && jsonMarkerIt->is_boolean())
+				this->lastSentPacketHasMarker = jsonMarkerIt->get<bool>();
+		}
 	}
 
 	SimulcastConsumer::~SimulcastConsumer()
@@ -154,6 +215,10 @@ namespace RTC
 
 		// Add currentTemporalLayer.
 		jsonObject["currentTemporalLayer"] = this->encodingContext->GetCurrentTemporalLayer();
+
+		// Add thumbnailFramerate.
+		if (this->thumbnailIntervalMs != 0u)
+			jsonObject["thumbnailFramerate"] = this->thumbnailFramerate;
 	}
 
 	void SimulcastConsumer::FillJsonStats(json& jsonArray) const
@@ -164,6 +229,13 @@ namespace RTC
 		jsonArray.emplace_back(json::value_t::object);
 		this->rtpStream->FillJsonStats(jsonArray[0]);
 
+		// Add spatial layer switch latency histogram.
+		jsonArray[0]["spatialLayerSwitchLatency"] = {
+			{ "bucketsMs", SpatialLayerSwitchLatencyBucketsMs },
+			{ "counts", this->spatialLayerSwitchLatencyCounts },
+			{ "keyFrameCacheSwitches", this->keyFrameCacheSpatialLayerSwitches }
+		};
+
 		// Add stats of our recv stream.
 		auto* producerCurrentRtpStream = GetProducerCurrentRtpStream();
 
@@ -192,6 +264,18 @@ namespace RTC
 		jsonObject["producerScores"] = *this->producerRtpStreamScores;
 	}
 
+	void SimulcastConsumer::FillJsonSendState(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		FillJsonStreamSendState(jsonObject, this->rtpSeqManager, this->rtpStream);
+
+		jsonObject["spatialLayer"]            = this->currentSpatialLayer;
+		jsonObject["temporalLayer"]           = this->encodingContext->GetCurrentTemporalLayer();
+		jsonObject["tsReferenceSpatialLayer"] = this->tsReferenceSpatialLayer;
+		jsonObject["lastSentPacketHasMarker"] = this->lastSentPacketHasMarker;
+	}
+
 	void SimulcastConsumer::HandleRequest(Channel::ChannelRequest* request)
 	{
 		MS_TRACE();
@@ -265,15 +349,15 @@ namespace RTC
 
 				// clang-format off
 				if (
-					IsActive() &&
-					(
-						this->preferredSpatialLayer != previousPreferredSpatialLayer ||
-						this->preferredTemporalLayer != previousPreferredTemporalLayer
-					)
+					this->preferredSpatialLayer != previousPreferredSpatialLayer ||
+					this->preferredTemporalLayer != previousPreferredTemporalLayer
 				)
 				// clang-format on
 				{
-					MayChangeLayers(/*force*/ true);
+					if (IsActive())
+						MayChangeLayers(/*force*/ true);
+
+					this->listener->OnConsumerPreferredLayersChanged(this);
 				}
 
 				break;
@@ -287,6 +371,29 @@ namespace RTC
 		}
 	}
 
+	void SimulcastConsumer::SetOverloadLevel(OverloadController::Level level)
+	{
+		MS_TRACE();
+
+		auto previousMaxSpatialLayer  = this->overloadMaxSpatialLayer;
+		auto previousMaxTemporalLayer = this->overloadMaxTemporalLayer;
+
+		RTC::Consumer::SetOverloadLevel(level);
+
+		// clang-format off
+		if (
+			IsActive() &&
+			(
+				this->overloadMaxSpatialLayer != previousMaxSpatialLayer ||
+				this->overloadMaxTemporalLayer != previousMaxTemporalLayer
+			)
+		)
+		// clang-format on
+		{
+			MayChangeLayers(/*force*/ true);
+		}
+	}
+
 	void SimulcastConsumer::ProducerRtpStream(RTC::RtpStream* rtpStream, uint32_t mappedSsrc)
 	{
 		MS_TRACE();
@@ -385,8 +492,8 @@ namespace RTC
 		// If already in the preferred layers, do nothing.
 		// clang-format off
 		if (
-			this->provisionalTargetSpatialLayer == this->preferredSpatialLayer &&
-			this->provisionalTargetTemporalLayer == this->preferredTemporalLayer
+			this->provisionalTargetSpatialLayer == LimitSpatialLayer(this->preferredSpatialLayer) &&
+			this->provisionalTargetTemporalLayer == LimitTemporalLayer(this->preferredTemporalLayer)
 		)
 		// clang-format on
 		{
@@ -474,6 +581,10 @@ namespace RTC
 			// Check bitrate of every temporal layer.
 			for (; temporalLayer < producerRtpStream->GetTemporalLayers(); ++temporalLayer)
 			{
+				// Don't go beyond the temporal layers allowed by the overload level.
+				if (temporalLayer > LimitTemporalLayer(temporalLayer))
+					break;
+
 				// Ignore temporal layers lower than the one we already have (taking into account
 				// the spatial layer too).
 				// clang-format off
@@ -527,7 +638,7 @@ namespace RTC
 			}
 
 			// If this is the preferred or higher spatial layer, take it and exit.
-			if (spatialLayer >= this->preferredSpatialLayer)
+			if (spatialLayer >= LimitSpatialLayer(this->preferredSpatialLayer))
 				break;
 		}
 
@@ -589,7 +700,7 @@ namespace RTC
 			if (
 				this->rtpStream->GetActiveMs() > BweDowngradeMinActiveMs &&
 				this->targetSpatialLayer < this->currentSpatialLayer &&
-				this->currentSpatialLayer <= this->preferredSpatialLayer
+				this->currentSpatialLayer <= LimitSpatialLayer(this->preferredSpatialLayer)
 			)
 			// clang-format on
 			{
@@ -653,10 +764,17 @@ namespace RTC
 
 		// NOTE: This may happen if this Consumer supports just some codecs of those
 		// in the corresponding Producer.
-		if (this->supportedCodecPayloadTypes.find(payloadType) == this->supportedCodecPayloadTypes.end())
+		if (!this->supportedCodecPayloadTypes.test(payloadType))
 		{
 			MS_DEBUG_DEV("payload type not supported [payloadType:%" PRIu8 "]", payloadType);
 
+			MS_TRACEPOINT(
+			  consumer_packet_dropped,
+			  this->id.c_str(),
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  "unsupported_payload_type");
+
 			return;
 		}
 
@@ -669,7 +787,16 @@ namespace RTC
 		{
 			// Ignore if not a key frame.
 			if (!packet->IsKeyFrame())
+			{
+				MS_TRACEPOINT(
+				  consumer_packet_dropped,
+				  this->id.c_str(),
+				  packet->GetSsrc(),
+				  packet->GetSequenceNumber(),
+				  "waiting_key_frame");
+
 				return;
+			}
 
 			shouldSwitchCurrentSpatialLayer = true;
 
@@ -681,12 +808,46 @@ namespace RTC
 		// drop it.
 		else if (spatialLayer != this->currentSpatialLayer)
 		{
+			MS_TRACEPOINT(
+			  consumer_packet_dropped,
+			  this->id.c_str(),
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  "other_spatial_layer");
+
 			return;
 		}
 
 		// If we need to sync and this is not a key frame, ignore the packet.
 		if (this->syncRequired && !packet->IsKeyFrame())
+		{
+			MS_TRACEPOINT(
+			  consumer_packet_dropped,
+			  this->id.c_str(),
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  "waiting_key_frame");
+
+			return;
+		}
+
+		// In thumbnail mode just the key frames are sent, so the remote decodes
+		// every frame sent regardless of the dropped ones.
+		if (this->thumbnailIntervalMs != 0u && !IsThumbnailPacket(packet))
+		{
+			MS_TRACEPOINT(
+			  consumer_packet_dropped,
+			  this->id.c_str(),
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  "thumbnail_filtered");
+
+			// NOTE: No sync is pending here since the key frame it waits for is
+			// always sent.
+			this->rtpSeqManager.Drop(packet->GetSequenceNumber());
+
 			return;
+		}
 
 		// Whether this is the first packet after re-sync.
 		bool isSyncPacket = this->syncRequired;
@@ -743,9 +904,13 @@ namespace RTC
 			// If so, apply an extra offset to "fix" it for the whole live of this selected
 			// Producer stream.
 			//
+			// NOTE: Not needed for the key frame cache since its RTP timestamps are
+			// rewritten below.
+			//
 			// clang-format off
 			if (
 				shouldSwitchCurrentSpatialLayer &&
+				!this->sendingKeyFrameCache &&
 				(packet->GetTimestamp() - tsOffset <= this->rtpStream->GetMaxPacketTs())
 			)
 			// clang-format on
@@ -786,10 +951,11 @@ namespace RTC
 					  "), requesting keyframe",
 					  tsExtraOffset);
 
-					RequestKeyFrameForTargetSpatialLayer();
-
+					// NOTE: Set it first since the key frame cache may be sent meanwhile.
 					this->keyFrameForTsOffsetRequested = true;
 
+					RequestKeyFrameForTargetSpatialLayer();
+
 					return;
 				}
 
@@ -808,6 +974,20 @@ namespace RTC
 
 			this->tsOffset = tsOffset;
 
+			// The key frame cache is older than the last packets sent, so its frames
+			// are sent with consecutive RTP timestamps right after the highest one
+			// sent (it's decoded but not really displayed).
+			if (this->sendingKeyFrameCache && this->rtpStream->GetMaxPacketMs() != 0u)
+			{
+				this->keyFrameCacheTsMapped = true;
+				this->keyFrameCacheOrigTs   = packet->GetTimestamp();
+				this->keyFrameCacheTs       = this->rtpStream->GetMaxPacketTs() + 1u;
+			}
+			else
+			{
+				this->keyFrameCacheTsMapped = false;
+			}
+
 			// Sync our RTP stream's sequence number.
 			// If previous frame has not been sent completely when we switch layer, we can tell
 			// libwebrtc that previous frame is incomplete by skipping one RTP sequence number.
@@ -827,11 +1007,30 @@ namespace RTC
 
 		if (shouldSwitchCurrentSpatialLayer)
 		{
+			// Update spatial layer switch latency.
+			if (this->targetSpatialLayerChangedAtMs != 0u)
+			{
+				auto latencyMs = DepLibUV::GetTimeMs() - this->targetSpatialLayerChangedAtMs;
+				size_t idx{ 0u };
+
+				for (; idx < SpatialLayerSwitchLatencyBucketsMs.size(); ++idx)
+				{
+					if (latencyMs <= SpatialLayerSwitchLatencyBucketsMs[idx])
+						break;
+				}
+
+				this->spatialLayerSwitchLatencyCounts[idx]++;
+				this->targetSpatialLayerChangedAtMs = 0u;
+			}
+
 			// Update current spatial layer.
 			this->currentSpatialLayer = this->targetSpatialLayer;
 
-			// Update target and current temporal layer.
-			this->encodingContext->SetTargetTemporalLayer(this->targetTemporalLayer);
+			// Update target and current temporal layer. When sending the key frame
+			// cache just the lowest temporal layer is sent, so less frames are needed
+			// to reach the last one.
+			this->encodingContext->SetTargetTemporalLayer(
+			  this->sendingKeyFrameCache ? 0 : this->targetTemporalLayer);
 			this->encodingContext->SetCurrentTemporalLayer(packet->GetTemporalLayer());
 
 			// Reset the score of our RtpStream to 10.
@@ -844,15 +1043,22 @@ namespace RTC
 			EmitScore();
 
 			// Rewrite payload if needed.
-			packet->ProcessPayload(this->encodingContext.get(), marker);
+			this->processPayloadFn(packet, this->encodingContext.get(), marker);
 		}
 		else
 		{
 			auto previousTemporalLayer = this->encodingContext->GetCurrentTemporalLayer();
 
 			// Rewrite payload if needed. Drop packet if necessary.
-			if (!packet->ProcessPayload(this->encodingContext.get(), marker))
+			if (!this->processPayloadFn(packet, this->encodingContext.get(), marker))
 			{
+				MS_TRACEPOINT(
+				  consumer_packet_dropped,
+				  this->id.c_str(),
+				  packet->GetSsrc(),
+				  packet->GetSequenceNumber(),
+				  "layer_filtered");
+
 				this->rtpSeqManager.Drop(packet->GetSequenceNumber());
 
 				return;
@@ -866,17 +1072,26 @@ namespace RTC
 		uint16_t seq;
 		uint32_t timestamp = packet->GetTimestamp() - this->tsOffset;
 
+		if (this->keyFrameCacheTsMapped)
+		{
+			if (this->sendingKeyFrameCache && packet->GetTimestamp() != this->keyFrameCacheOrigTs)
+			{
+				this->keyFrameCacheOrigTs = packet->GetTimestamp();
+				this->keyFrameCacheTs++;
+			}
+
+			// NOTE: Remaining packets of the last frame of the key frame cache may be
+			// received after sending it.
+			if (packet->GetTimestamp() == this->keyFrameCacheOrigTs)
+				timestamp = this->keyFrameCacheTs;
+		}
+
 		this->rtpSeqManager.Input(packet->GetSequenceNumber(), seq);
 
-		// Save original packet fields.
-		auto origSsrc      = packet->GetSsrc();
-		auto origSeq       = packet->GetSequenceNumber();
-		auto origTimestamp = packet->GetTimestamp();
+		RTC::RtpHeaderTemplate::SavedHeader savedHeader;
 
-		// Rewrite packet.
-		packet->SetSsrc(this->rtpParameters.encodings[0].ssrc);
-		packet->SetSequenceNumber(seq);
-		packet->SetTimestamp(timestamp);
+		// Rewrite packet (saving its original header).
+		this->headerTemplate.Apply(packet, seq, timestamp, savedHeader);
 
 		if (isSyncPacket)
 		{
@@ -887,9 +1102,9 @@ namespace RTC
 			  packet->GetSsrc(),
 			  packet->GetSequenceNumber(),
 			  packet->GetTimestamp(),
-			  origSsrc,
-			  origSeq,
-			  origTimestamp);
+			  uint32_t{ ntohl(savedHeader.ssrc) },
+			  uint16_t{ ntohs(savedHeader.sequenceNumber) },
+			  uint32_t{ ntohl(savedHeader.timestamp) });
 		}
 
 		// Process the packet.
@@ -913,18 +1128,16 @@ namespace RTC
 			  packet->GetSsrc(),
 			  packet->GetSequenceNumber(),
 			  packet->GetTimestamp(),
-			  origSsrc,
-			  origSeq,
-			  origTimestamp);
+			  uint32_t{ ntohl(savedHeader.ssrc) },
+			  uint16_t{ ntohs(savedHeader.sequenceNumber) },
+			  uint32_t{ ntohl(savedHeader.timestamp) });
 		}
 
-		// Restore packet fields.
-		packet->SetSsrc(origSsrc);
-		packet->SetSequenceNumber(origSeq);
-		packet->SetTimestamp(origTimestamp);
+		// Restore packet header.
+		RTC::RtpHeaderTemplate::Restore(packet, savedHeader);
 
 		// Restore the original payload if needed.
-		packet->RestorePayload();
+		this->restorePayloadFn(packet);
 	}
 
 	void SimulcastConsumer::GetRtcp(
@@ -945,9 +1158,10 @@ namespace RTC
 		packet->AddSenderReport(report);
 
 		// Build SDES chunk for this sender.
-		auto* sdesChunk = this->rtpStream->GetRtcpSdesChunk();
+		auto* sdesChunk = this->rtpStream->GetRtcpSdesChunk(nowMs);
 
-		packet->AddSdesChunk(sdesChunk);
+		if (sdesChunk)
+			packet->AddSdesChunk(sdesChunk);
 
 		auto* dlrr = this->rtpStream->GetRtcpXrDelaySinceLastRr(nowMs);
 
@@ -1016,7 +1230,9 @@ namespace RTC
 
 		this->rtpStream->ReceiveKeyFrameRequest(messageType);
 
-		if (IsActive())
+		// In thumbnail mode key frames are requested periodically anyway, and the
+		// remote asks for them since it misses the dropped frames.
+		if (IsActive() && this->thumbnailIntervalMs == 0u)
 			RequestKeyFrameForCurrentSpatialLayer();
 	}
 
@@ -1051,6 +1267,55 @@ namespace RTC
 		return this->rtpStream->GetRtt();
 	}
 
+	bool SimulcastConsumer::SendKeyFrameCache(const std::vector<RTC::RtpPacket*>& packets)
+	{
+		MS_TRACE();
+
+		// Sending it may request a key frame again.
+		if (this->sendingKeyFrameCache)
+			return false;
+
+		if (!IsActive() || this->targetSpatialLayer == -1 || this->targetTemporalLayer == -1)
+			return false;
+
+		if (this->currentSpatialLayer == this->targetSpatialLayer && !this->syncRequired)
+			return false;
+
+		if (packets.empty() || !packets.front()->IsKeyFrame())
+			return false;
+
+		auto it = this->mapMappedSsrcSpatialLayer.find(packets.front()->GetSsrc());
+
+		// Just useful if it belongs to the target spatial layer.
+		if (it == this->mapMappedSsrcSpatialLayer.end() || it->second != this->targetSpatialLayer)
+			return false;
+
+		MS_DEBUG_TAG(
+		  simulcast,
+		  "sending cached key frame of target spatial layer [spatial:%" PRIi16 ", packets:%zu]",
+		  this->targetSpatialLayer,
+		  packets.size());
+
+		this->sendingKeyFrameCache = true;
+
+		for (auto* packet : packets)
+		{
+			SendRtpPacket(packet);
+		}
+
+		this->sendingKeyFrameCache = false;
+
+		if (this->currentSpatialLayer != this->targetSpatialLayer || this->syncRequired)
+			return false;
+
+		this->keyFrameCacheSpatialLayerSwitches++;
+
+		// Upgrade to the target temporal layer from now on.
+		this->encodingContext->SetTargetTemporalLayer(this->targetTemporalLayer);
+
+		return true;
+	}
+
 	void SimulcastConsumer::UserOnTransportConnected()
 	{
 		MS_TRACE();
@@ -1113,13 +1378,14 @@ namespace RTC
 		// Set stream params.
 		RTC::RtpStream::Params params;
 
-		params.ssrc           = encoding.ssrc;
-		params.payloadType    = mediaCodec->payloadType;
-		params.mimeType       = mediaCodec->mimeType;
-		params.clockRate      = mediaCodec->clockRate;
-		params.cname          = this->rtpParameters.rtcp.cname;
-		params.spatialLayers  = encoding.spatialLayers;
-		params.temporalLayers = encoding.temporalLayers;
+		params.ssrc            = encoding.ssrc;
+		params.payloadType     = mediaCodec->payloadType;
+		params.mimeType        = mediaCodec->mimeType;
+		params.clockRate       = mediaCodec->clockRate;
+		params.cname           = this->rtpParameters.rtcp.cname;
+		params.rtcpReducedSize = this->rtpParameters.rtcp.reducedSize;
+		params.spatialLayers   = encoding.spatialLayers;
+		params.temporalLayers  = encoding.temporalLayers;
 
 		// Check in band FEC in codec parameters.
 		if (mediaCodec->parameters.HasInteger("useinbandfec") && mediaCodec->parameters.GetInteger("useinbandfec") == 1)
@@ -1181,6 +1447,11 @@ namespace RTC
 
 		if (rtxCodec && encoding.hasRtx)
 			this->rtpStream->SetRtx(rtxCodec->payloadType, encoding.rtx.ssrc);
+
+		const auto* fecCodec = this->rtpParameters.GetFecCodec();
+
+		if (fecCodec && encoding.hasFec)
+			this->rtpStream->SetFec(fecCodec->payloadType, encoding.fec.ssrc);
 	}
 
 	void SimulcastConsumer::RequestKeyFrames()
@@ -1195,14 +1466,14 @@ namespace RTC
 
 		if (producerTargetRtpStream)
 		{
-			auto mappedSsrc = this->consumableRtpEncodings[this->targetSpatialLayer].ssrc;
+			auto mappedSsrc = (*this->consumableRtpEncodings)[this->targetSpatialLayer].ssrc;
 
 			this->listener->OnConsumerKeyFrameRequested(this, mappedSsrc);
 		}
 
 		if (producerCurrentRtpStream && producerCurrentRtpStream != producerTargetRtpStream)
 		{
-			auto mappedSsrc = this->consumableRtpEncodings[this->currentSpatialLayer].ssrc;
+			auto mappedSsrc = (*this->consumableRtpEncodings)[this->currentSpatialLayer].ssrc;
 
 			this->listener->OnConsumerKeyFrameRequested(this, mappedSsrc);
 		}
@@ -1220,7 +1491,7 @@ namespace RTC
 		if (!producerTargetRtpStream)
 			return;
 
-		auto mappedSsrc = this->consumableRtpEncodings[this->targetSpatialLayer].ssrc;
+		auto mappedSsrc = (*this->consumableRtpEncodings)[this->targetSpatialLayer].ssrc;
 
 		this->listener->OnConsumerKeyFrameRequested(this, mappedSsrc);
 	}
@@ -1237,11 +1508,58 @@ namespace RTC
 		if (!producerCurrentRtpStream)
 			return;
 
-		auto mappedSsrc = this->consumableRtpEncodings[this->currentSpatialLayer].ssrc;
+		auto mappedSsrc = (*this->consumableRtpEncodings)[this->currentSpatialLayer].ssrc;
 
 		this->listener->OnConsumerKeyFrameRequested(this, mappedSsrc);
 	}
 
+	bool SimulcastConsumer::IsThumbnailPacket(const RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		// Rest of the last key frame sent.
+		if (this->lastThumbnailAtMs != 0u && packet->GetTimestamp() == this->thumbnailTs)
+			return true;
+
+		auto nowMs     = DepLibUV::GetTimeMs();
+		auto elapsedMs = nowMs - this->lastThumbnailAtMs;
+		bool due       = this->lastThumbnailAtMs == 0u || elapsedMs >= this->thumbnailIntervalMs;
+
+		// Send the requested key frame, any key frame once due or the one needed
+		// to sync the stream.
+		// clang-format off
+		if (
+			packet->IsKeyFrame() &&
+			(due || this->thumbnailRequestedAtMs != 0u || this->syncRequired)
+		)
+		// clang-format on
+		{
+			this->lastThumbnailAtMs      = nowMs;
+			this->thumbnailRequestedAtMs = 0u;
+			this->thumbnailTs            = packet->GetTimestamp();
+
+			return true;
+		}
+
+		// Ask for the next one (again if the key frame did not arrive in time).
+		// clang-format off
+		if (
+			due &&
+			(
+				this->thumbnailRequestedAtMs == 0u ||
+				nowMs - this->thumbnailRequestedAtMs >= this->thumbnailIntervalMs
+			)
+		)
+		// clang-format on
+		{
+			this->thumbnailRequestedAtMs = nowMs;
+
+			RequestKeyFrameForCurrentSpatialLayer();
+		}
+
+		return false;
+	}
+
 	void SimulcastConsumer::MayChangeLayers(bool force)
 	{
 		MS_TRACE();
@@ -1319,16 +1637,16 @@ namespace RTC
 			newTargetSpatialLayer = spatialLayer;
 
 			// If this is the preferred or higher spatial layer take it and exit.
-			if (spatialLayer >= this->preferredSpatialLayer)
+			if (spatialLayer >= LimitSpatialLayer(this->preferredSpatialLayer))
 				break;
 		}
 
 		if (newTargetSpatialLayer != -1)
 		{
-			if (newTargetSpatialLayer == this->preferredSpatialLayer)
-				newTargetTemporalLayer = this->preferredTemporalLayer;
-			else if (newTargetSpatialLayer < this->preferredSpatialLayer)
-				newTargetTemporalLayer = this->rtpStream->GetTemporalLayers() - 1;
+			if (newTargetSpatialLayer == LimitSpatialLayer(this->preferredSpatialLayer))
+				newTargetTemporalLayer = LimitTemporalLayer(this->preferredTemporalLayer);
+			else if (newTargetSpatialLayer < LimitSpatialLayer(this->preferredSpatialLayer))
+				newTargetTemporalLayer = LimitTemporalLayer(this->rtpStream->GetTemporalLayers() - 1);
 			else
 				newTargetTemporalLayer = 0;
 		}
@@ -1365,6 +1683,8 @@ namespace RTC
 			this->encodingContext->SetTargetTemporalLayer(-1);
 			this->encodingContext->SetCurrentTemporalLayer(-1);
 
+			this->targetSpatialLayerChangedAtMs = 0u;
+
 			MS_DEBUG_TAG(
 			  simulcast, "target layers changed [spatial:-1, temporal:-1, consumerId:%s]", this->id.c_str());
 
@@ -1381,6 +1701,13 @@ namespace RTC
 		if (this->targetSpatialLayer == this->currentSpatialLayer)
 			this->encodingContext->SetTargetTemporalLayer(this->targetTemporalLayer);
 
+		// Measure the switch latency (if not pending yet) when switching from a
+		// spatial layer being sent.
+		if (this->targetSpatialLayer == this->currentSpatialLayer)
+			this->targetSpatialLayerChangedAtMs = 0u;
+		else if (this->currentSpatialLayer != -1 && this->targetSpatialLayerChangedAtMs == 0u)
+			this->targetSpatialLayerChangedAtMs = DepLibUV::GetTimeMs();
+
 		MS_DEBUG_TAG(
 		  simulcast,
 		  "target layers changed [spatial:%" PRIi16 ", temporal:%" PRIi16 ", consumerId:%s]",
@@ -1431,7 +1758,7 @@ namespace RTC
 
 		FillJsonScore(data);
 
-		Channel::ChannelNotifier::Emit(this->id, "score", data);
+		Channel::ChannelNotifier::EmitBatched(this->id, "score", data);
 	}
 
 	inline void SimulcastConsumer::EmitLayersChange() const
@@ -1456,7 +1783,7 @@ namespace RTC
 			data = nullptr;
 		}
 
-		Channel::ChannelNotifier::Emit(this->id, "layerschange", data);
+		Channel::ChannelNotifier::EmitBatched(this->id, "layerschange", data);
 	}
 
 	inline RTC::RtpStream* SimulcastConsumer::GetProducerCurrentRtpStream() const
@@ -1510,14 +1837,25 @@ namespace RTC
 		}
 	}
 
-	inline void SimulcastConsumer::OnRtpStreamRetransmitRtpPacket(
-	  RTC::RtpStreamSend* /*rtpStream*/, RTC::RtpPacket* packet)
+	inline void SimulcastConsumer::OnRtpStreamRetransmitRtpPackets(
+	  RTC::RtpStreamSend* /*rtpStream*/, RTC::RtpPacket** packets, size_t count)
 	{
 		MS_TRACE();
 
-		this->listener->OnConsumerRetransmitRtpPacket(this, packet);
+		this->listener->OnConsumerRetransmitRtpPackets(this, packets, count);
 
 		// May emit 'trace' event.
-		EmitTraceEventRtpAndKeyFrameTypes(packet, this->rtpStream->HasRtx());
+		for (size_t idx{ 0u }; idx < count; ++idx)
+		{
+			EmitTraceEventRtpAndKeyFrameTypes(packets[idx], this->rtpStream->HasRtx());
+		}
+	}
+
+	inline void SimulcastConsumer::OnRtpStreamSendFecPacket(
+	  RTC::RtpStreamSend* /*rtpStream*/, RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		this->listener->OnConsumerSendRtpPacket(this, packet);
 	}
 } // namespace RTC
@@ -0,0 +1,474 @@
+#define MS_CLASS "RTC::SrtpDecryptPool"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/SrtpDecryptPool.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "Metrics.hpp"
+#include "ThreadPlacement.hpp"
+#include <absl/hash/hash.h>
+#include <cstring> // std::memcpy()
+#include <memory>  // std::addressof()
+
+/* Static methods for UV callbacks. */
+
+inline static void onPrepare(uv_prepare_t* /*handle*/)
+{
+	RTC::SrtpDecryptPool::OnUvPrepare();
+}
+
+inline static void onAsync(uv_async_t* /*handle*/)
+{
+	RTC::SrtpDecryptPool::OnUvAsync();
+}
+
+inline static void onClose(uv_handle_t* handle)
+{
+	delete handle;
+}
+
+namespace RTC
+{
+	/* Class variables. */
+
+	thread_local SrtpDecryptPool::Shared* SrtpDecryptPool::shared{ nullptr };
+	thread_local std::vector<std::thread> SrtpDecryptPool::threads;
+	thread_local uv_prepare_t* SrtpDecryptPool::uvPrepareHandle{ nullptr };
+	thread_local SrtpDecryptPool::Batch* SrtpDecryptPool::currentBatch{ nullptr };
+	thread_local std::deque<SrtpDecryptPool::Batch*> SrtpDecryptPool::submittedBatches;
+	thread_local std::vector<SrtpDecryptPool::Batch*> SrtpDecryptPool::freeBatches;
+	thread_local bool SrtpDecryptPool::delivering{ false };
+
+	/* Class methods. */
+
+	void SrtpDecryptPool::ClassInit(size_t numThreads)
+	{
+		MS_TRACE();
+
+		if (numThreads == 0u)
+			return;
+
+		MS_ASSERT(numThreads <= MaxThreads, "too many threads");
+
+		int err;
+
+		SrtpDecryptPool::shared = new Shared();
+		SrtpDecryptPool::shared->queues.resize(numThreads);
+
+		SrtpDecryptPool::shared->uvAsyncHandle = new uv_async_t;
+
+		err = uv_async_init(
+		  DepLibUV::GetLoop(),
+		  SrtpDecryptPool::shared->uvAsyncHandle,
+		  static_cast<uv_async_cb>(onAsync));
+
+		if (err != 0)
+			MS_THROW_ERROR("uv_async_init() failed: %s", uv_strerror(err));
+
+		SrtpDecryptPool::uvPrepareHandle = new uv_prepare_t;
+
+		err = uv_prepare_init(DepLibUV::GetLoop(), SrtpDecryptPool::uvPrepareHandle);
+
+		if (err != 0)
+			MS_THROW_ERROR("uv_prepare_init() failed: %s", uv_strerror(err));
+
+		// These handles must not keep the loop alive.
+		uv_unref(reinterpret_cast<uv_handle_t*>(SrtpDecryptPool::shared->uvAsyncHandle));
+		uv_unref(reinterpret_cast<uv_handle_t*>(SrtpDecryptPool::uvPrepareHandle));
+
+		for (size_t threadIdx{ 0u }; threadIdx < numThreads; ++threadIdx)
+		{
+			SrtpDecryptPool::threads.emplace_back(
+			  SrtpDecryptPool::ThreadMain, SrtpDecryptPool::shared, threadIdx);
+
+			// This may throw.
+			ThreadPlacement::ApplyToHelperThread(SrtpDecryptPool::threads.back());
+		}
+
+		MS_DEBUG_TAG(srtp, "SRTP decrypt pool running [threads:%zu]", numThreads);
+	}
+
+	void SrtpDecryptPool::ClassDestroy()
+	{
+		MS_TRACE();
+
+		if (!SrtpDecryptPool::shared)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(SrtpDecryptPool::shared->mutex);
+
+			SrtpDecryptPool::shared->stopping = true;
+		}
+
+		SrtpDecryptPool::shared->submittedCv.notify_all();
+
+		for (auto& thread : SrtpDecryptPool::threads)
+		{
+			thread.join();
+		}
+		SrtpDecryptPool::threads.clear();
+
+		uv_close(
+		  reinterpret_cast<uv_handle_t*>(SrtpDecryptPool::shared->uvAsyncHandle),
+		  static_cast<uv_close_cb>(onClose));
+		uv_close(
+		  reinterpret_cast<uv_handle_t*>(SrtpDecryptPool::uvPrepareHandle),
+		  static_cast<uv_close_cb>(onClose));
+
+		SrtpDecryptPool::uvPrepareHandle = nullptr;
+
+		delete SrtpDecryptPool::currentBatch;
+		SrtpDecryptPool::currentBatch = nullptr;
+
+		for (auto* batch : SrtpDecryptPool::submittedBatches)
+		{
+			delete batch;
+		}
+		SrtpDecryptPool::submittedBatches.clear();
+
+		for (auto* batch : SrtpDecryptPool::freeBatches)
+		{
+			delete batch;
+		}
+		SrtpDecryptPool::freeBatches.clear();
+
+		delete SrtpDecryptPool::shared;
+		SrtpDecryptPool::shared = nullptr;
+	}
+
+	bool SrtpDecryptPool::Queue(
+	  Listener* listener,
+	  RTC::SrtpSession* session,
+	  const RTC::TransportTuple* tuple,
+	  const uint8_t* data,
+	  size_t len,
+	  bool rtcp)
+	{
+		MS_TRACE();
+
+		// NOTE: The libsrtp context of the session is allocated by the first
+		// packet decrypted by the caller, never by pool threads.
+		// clang-format off
+		if (
+			!SrtpDecryptPool::shared ||
+			len > MaxPacketSize ||
+			tuple->GetProtocol() != RTC::TransportTuple::Protocol::UDP ||
+			!session->IsAllocated()
+		)
+		// clang-format on
+		{
+			return false;
+		}
+
+		if (!SrtpDecryptPool::currentBatch)
+		{
+			if (!SrtpDecryptPool::freeBatches.empty())
+			{
+				SrtpDecryptPool::currentBatch = SrtpDecryptPool::freeBatches.back();
+				SrtpDecryptPool::freeBatches.pop_back();
+			}
+			else
+			{
+				SrtpDecryptPool::currentBatch = new Batch();
+			}
+
+			// Submit the batch before the loop blocks for I/O.
+			int err =
+			  uv_prepare_start(SrtpDecryptPool::uvPrepareHandle, static_cast<uv_prepare_cb>(onPrepare));
+
+			if (err != 0)
+				MS_ABORT("uv_prepare_start() failed: %s", uv_strerror(err));
+		}
+
+		auto* batch = SrtpDecryptPool::currentBatch;
+		auto& job   = batch->jobs[batch->numJobs++];
+
+		job.listener  = listener;
+		job.session   = session;
+		job.threadIdx = absl::Hash<const void*>{}(session) % SrtpDecryptPool::shared->queues.size();
+		// NOTE: It also stores the remote address of the tuple.
+		job.tuple.emplace(tuple);
+		job.ingressTimeNs = Metrics::GetIngressTime();
+		job.len           = static_cast<int>(len);
+		job.rtcp          = rtcp;
+		job.decrypted     = false;
+
+		std::memcpy(job.data, data, len);
+
+		if (batch->numJobs == MaxBatchSize)
+			Submit();
+
+		return true;
+	}
+
+	void SrtpDecryptPool::Flush(Listener* listener)
+	{
+		MS_TRACE();
+
+		if (!SrtpDecryptPool::shared)
+			return;
+
+		if (SrtpDecryptPool::currentBatch && HasJobs(SrtpDecryptPool::currentBatch, listener))
+			Submit();
+
+		std::unique_lock<std::mutex> lock(SrtpDecryptPool::shared->mutex);
+
+		SrtpDecryptPool::shared->doneCv.wait(
+		  lock,
+		  [listener]()
+		  {
+			  for (auto* batch : SrtpDecryptPool::submittedBatches)
+			  {
+				  // clang-format off
+				  if (
+					  batch->pendingThreads.load(std::memory_order_acquire) != 0u &&
+					  HasJobs(batch, listener)
+				  )
+				  // clang-format on
+				  {
+					  return false;
+				  }
+			  }
+
+			  return true;
+		  });
+	}
+
+	void SrtpDecryptPool::RemoveListener(Listener* listener)
+	{
+		MS_TRACE();
+
+		if (!SrtpDecryptPool::shared)
+			return;
+
+		// Not yet submitted jobs are just discarded.
+		if (SrtpDecryptPool::currentBatch)
+		{
+			auto* batch = SrtpDecryptPool::currentBatch;
+
+			for (size_t i{ 0u }; i < batch->numJobs; ++i)
+			{
+				auto& job = batch->jobs[i];
+
+				if (job.listener == listener)
+				{
+					job.listener = nullptr;
+					job.session  = nullptr;
+				}
+			}
+		}
+
+		// Submitted ones must be waited for since pool threads may be using their
+		// SrtpSession.
+		Flush(listener);
+
+		for (auto* batch : SrtpDecryptPool::submittedBatches)
+		{
+			for (size_t i{ 0u }; i < batch->numJobs; ++i)
+			{
+				auto& job = batch->jobs[i];
+
+				if (job.listener == listener)
+					job.listener = nullptr;
+			}
+		}
+	}
+
+	inline void SrtpDecryptPool::OnUvPrepare()
+	{
+		MS_TRACE();
+
+		Submit();
+	}
+
+	inline void SrtpDecryptPool::OnUvAsync()
+	{
+		MS_TRACE();
+
+		// Avoid reentrance if a listener queues packets.
+		if (SrtpDecryptPool::delivering)
+			return;
+
+		SrtpDecryptPool::delivering = true;
+
+		// Deliver completed batches in submission order.
+		while (!SrtpDecryptPool::submittedBatches.empty())
+		{
+			auto* batch = SrtpDecryptPool::submittedBatches.front();
+
+			if (batch->pendingThreads.load(std::memory_order_acquire) != 0u)
+				break;
+
+			// NOTE: Listeners may be removed while iterating, so the batch is kept
+			// in the deque until done.
+			for (size_t i{ 0u }; i < batch->numJobs; ++i)
+			{
+				auto& job = batch->jobs[i];
+
+				if (!job.listener)
+					continue;
+
+				if (!job.decrypted)
+				{
+					MS_WARN_TAG(
+					  srtp,
+					  "%s failed in SRTP decrypt pool, packet discarded",
+					  job.rtcp ? "srtp_unprotect_rtcp()" : "srtp_unprotect()");
+
+					continue;
+				}
+
+				// Forwarding latency is measured from the reception of the datagram.
+				Metrics::SetIngressTime(job.ingressTimeNs);
+
+				if (job.rtcp)
+				{
+					job.listener->OnSrtpDecryptPoolRtcpPacketDecrypted(
+					  std::addressof(*job.tuple), job.data, static_cast<size_t>(job.len));
+				}
+				else
+				{
+					job.listener->OnSrtpDecryptPoolRtpPacketDecrypted(
+					  std::addressof(*job.tuple), job.data, static_cast<size_t>(job.len));
+				}
+			}
+
+			SrtpDecryptPool::submittedBatches.pop_front();
+
+			for (size_t i{ 0u }; i < batch->numJobs; ++i)
+			{
+				batch->jobs[i].tuple.reset();
+			}
+
+			batch->numJobs = 0u;
+			SrtpDecryptPool::freeBatches.push_back(batch);
+		}
+
+		SrtpDecryptPool::delivering = false;
+	}
+
+	void SrtpDecryptPool::Submit()
+	{
+		MS_TRACE();
+
+		auto* batch = SrtpDecryptPool::currentBatch;
+
+		if (!batch)
+			return;
+
+		SrtpDecryptPool::currentBatch = nullptr;
+
+		uv_prepare_stop(SrtpDecryptPool::uvPrepareHandle);
+
+		// Just wake up the pool threads having jobs in this batch.
+		std::array<bool, MaxThreads> hasJobs{};
+		size_t numThreads{ 0u };
+
+		for (size_t i{ 0u }; i < batch->numJobs; ++i)
+		{
+			auto& job = batch->jobs[i];
+
+			if (!job.session || hasJobs[job.threadIdx])
+				continue;
+
+			hasJobs[job.threadIdx] = true;
+			++numThreads;
+		}
+
+		batch->pendingThreads.store(numThreads, std::memory_order_relaxed);
+
+		SrtpDecryptPool::submittedBatches.push_back(batch);
+
+		// All its jobs were discarded.
+		if (numThreads == 0u)
+		{
+			uv_async_send(SrtpDecryptPool::shared->uvAsyncHandle);
+
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(SrtpDecryptPool::shared->mutex);
+
+			for (size_t threadIdx{ 0u }; threadIdx < SrtpDecryptPool::shared->queues.size(); ++threadIdx)
+			{
+				if (hasJobs[threadIdx])
+					SrtpDecryptPool::shared->queues[threadIdx].push_back(batch);
+			}
+		}
+
+		SrtpDecryptPool::shared->submittedCv.notify_all();
+	}
+
+	bool SrtpDecryptPool::HasJobs(const Batch* batch, const Listener* listener)
+	{
+		for (size_t i{ 0u }; i < batch->numJobs; ++i)
+		{
+			if (batch->jobs[i].listener == listener)
+				return true;
+		}
+
+		return false;
+	}
+
+	void SrtpDecryptPool::ThreadMain(Shared* shared, size_t threadIdx)
+	{
+		// NOTE: No logging here since the Logger only works in the loop thread.
+
+		auto& queue = shared->queues[threadIdx];
+		std::array<RTC::SrtpSession::DecryptBatchItem, MaxBatchSize> items;
+		std::array<Job*, MaxBatchSize> itemJobs;
+
+		while (true)
+		{
+			Batch* batch;
+
+			{
+				std::unique_lock<std::mutex> lock(shared->mutex);
+
+				shared->submittedCv.wait(lock, [&]() { return shared->stopping || !queue.empty(); });
+
+				if (queue.empty())
+					return;
+
+				batch = queue.front();
+				queue.pop_front();
+			}
+
+			size_t numItems{ 0u };
+
+			for (size_t i{ 0u }; i < batch->numJobs; ++i)
+			{
+				auto& job = batch->jobs[i];
+
+				if (job.threadIdx != threadIdx || !job.session)
+					continue;
+
+				items[numItems]    = { job.session, job.data, job.len, job.rtcp, false };
+				itemJobs[numItems] = std::addressof(job);
+				++numItems;
+			}
+
+			RTC::SrtpSession::DecryptBatch(items.data(), numItems);
+
+			for (size_t i{ 0u }; i < numItems; ++i)
+			{
+				itemJobs[i]->len       = items[i].len;
+				itemJobs[i]->decrypted = items[i].decrypted;
+			}
+
+			// Last thread done with the batch wakes up the loop.
+			if (batch->pendingThreads.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+				uv_async_send(shared->uvAsyncHandle);
+
+			{
+				// Lock so Flush() cannot miss the notification.
+				std::lock_guard<std::mutex> lock(shared->mutex);
+			}
+
+			shared->doneCv.notify_all();
+		}
+	}
+} // namespace RTC
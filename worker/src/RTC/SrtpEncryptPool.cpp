@@ -0,0 +1,436 @@
+#define MS_CLASS "RTC::SrtpEncryptPool"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/SrtpEncryptPool.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "ThreadPlacement.hpp"
+#include <absl/hash/hash.h>
+#include <cstring> // std::memcpy()
+#include <memory>  // std::addressof()
+
+/* Static methods for UV callbacks. */
+
+inline static void onPrepare(uv_prepare_t* /*handle*/)
+{
+	RTC::SrtpEncryptPool::OnUvPrepare();
+}
+
+inline static void onAsync(uv_async_t* /*handle*/)
+{
+	RTC::SrtpEncryptPool::OnUvAsync();
+}
+
+inline static void onClose(uv_handle_t* handle)
+{
+	delete handle;
+}
+
+namespace RTC
+{
+	/* Class variables. */
+
+	thread_local SrtpEncryptPool::Shared* SrtpEncryptPool::shared{ nullptr };
+	thread_local std::vector<std::thread> SrtpEncryptPool::threads;
+	thread_local uv_prepare_t* SrtpEncryptPool::uvPrepareHandle{ nullptr };
+	thread_local SrtpEncryptPool::Batch* SrtpEncryptPool::currentBatch{ nullptr };
+	thread_local std::deque<SrtpEncryptPool::Batch*> SrtpEncryptPool::submittedBatches;
+	thread_local std::vector<SrtpEncryptPool::Batch*> SrtpEncryptPool::freeBatches;
+	thread_local bool SrtpEncryptPool::delivering{ false };
+
+	/* Class methods. */
+
+	void SrtpEncryptPool::ClassInit(size_t numThreads)
+	{
+		MS_TRACE();
+
+		if (numThreads == 0u)
+			return;
+
+		MS_ASSERT(numThreads <= MaxThreads, "too many threads");
+
+		int err;
+
+		SrtpEncryptPool::shared = new Shared();
+		SrtpEncryptPool::shared->queues.resize(numThreads);
+
+		SrtpEncryptPool::shared->uvAsyncHandle = new uv_async_t;
+
+		err = uv_async_init(
+		  DepLibUV::GetLoop(),
+		  SrtpEncryptPool::shared->uvAsyncHandle,
+		  static_cast<uv_async_cb>(onAsync));
+
+		if (err != 0)
+			MS_THROW_ERROR("uv_async_init() failed: %s", uv_strerror(err));
+
+		SrtpEncryptPool::uvPrepareHandle = new uv_prepare_t;
+
+		err = uv_prepare_init(DepLibUV::GetLoop(), SrtpEncryptPool::uvPrepareHandle);
+
+		if (err != 0)
+			MS_THROW_ERROR("uv_prepare_init() failed: %s", uv_strerror(err));
+
+		// These handles must not keep the loop alive.
+		uv_unref(reinterpret_cast<uv_handle_t*>(SrtpEncryptPool::shared->uvAsyncHandle));
+		uv_unref(reinterpret_cast<uv_handle_t*>(SrtpEncryptPool::uvPrepareHandle));
+
+		for (size_t threadIdx{ 0u }; threadIdx < numThreads; ++threadIdx)
+		{
+			SrtpEncryptPool::threads.emplace_back(
+			  SrtpEncryptPool::ThreadMain, SrtpEncryptPool::shared, threadIdx);
+
+			// This may throw.
+			ThreadPlacement::ApplyToHelperThread(SrtpEncryptPool::threads.back());
+		}
+
+		MS_DEBUG_TAG(srtp, "SRTP encrypt pool running [threads:%zu]", numThreads);
+	}
+
+	void SrtpEncryptPool::ClassDestroy()
+	{
+		MS_TRACE();
+
+		if (!SrtpEncryptPool::shared)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(SrtpEncryptPool::shared->mutex);
+
+			SrtpEncryptPool::shared->stopping = true;
+		}
+
+		SrtpEncryptPool::shared->submittedCv.notify_all();
+
+		for (auto& thread : SrtpEncryptPool::threads)
+		{
+			thread.join();
+		}
+		SrtpEncryptPool::threads.clear();
+
+		uv_close(
+		  reinterpret_cast<uv_handle_t*>(SrtpEncryptPool::shared->uvAsyncHandle),
+		  static_cast<uv_close_cb>(onClose));
+		uv_close(
+		  reinterpret_cast<uv_handle_t*>(SrtpEncryptPool::uvPrepareHandle),
+		  static_cast<uv_close_cb>(onClose));
+
+		SrtpEncryptPool::uvPrepareHandle = nullptr;
+
+		delete SrtpEncryptPool::currentBatch;
+		SrtpEncryptPool::currentBatch = nullptr;
+
+		for (auto* batch : SrtpEncryptPool::submittedBatches)
+		{
+			delete batch;
+		}
+		SrtpEncryptPool::submittedBatches.clear();
+
+		for (auto* batch : SrtpEncryptPool::freeBatches)
+		{
+			delete batch;
+		}
+		SrtpEncryptPool::freeBatches.clear();
+
+		delete SrtpEncryptPool::shared;
+		SrtpEncryptPool::shared = nullptr;
+	}
+
+	bool SrtpEncryptPool::EncryptRtp(
+	  Listener* listener, RTC::SrtpSession* session, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		// NOTE: The libsrtp context of the session is allocated by the first
+		// packet encrypted by the caller, never by pool threads.
+		if (!SrtpEncryptPool::shared || len > MaxPacketSize || !session->IsAllocated())
+			return false;
+
+		if (!SrtpEncryptPool::currentBatch)
+		{
+			if (!SrtpEncryptPool::freeBatches.empty())
+			{
+				SrtpEncryptPool::currentBatch = SrtpEncryptPool::freeBatches.back();
+				SrtpEncryptPool::freeBatches.pop_back();
+			}
+			else
+			{
+				SrtpEncryptPool::currentBatch = new Batch();
+			}
+
+			// Submit the batch before the loop blocks for I/O.
+			int err =
+			  uv_prepare_start(SrtpEncryptPool::uvPrepareHandle, static_cast<uv_prepare_cb>(onPrepare));
+
+			if (err != 0)
+				MS_ABORT("uv_prepare_start() failed: %s", uv_strerror(err));
+		}
+
+		auto* batch = SrtpEncryptPool::currentBatch;
+		auto& job   = batch->jobs[batch->numJobs++];
+
+		job.listener  = listener;
+		job.session   = session;
+		job.threadIdx = absl::Hash<const void*>{}(session) % SrtpEncryptPool::shared->queues.size();
+		job.len       = static_cast<int>(len);
+		job.encrypted = false;
+
+		std::memcpy(job.data, data, len);
+
+		if (batch->numJobs == MaxBatchSize)
+			Submit();
+
+		return true;
+	}
+
+	void SrtpEncryptPool::Flush(Listener* listener)
+	{
+		MS_TRACE();
+
+		if (!SrtpEncryptPool::shared)
+			return;
+
+		if (SrtpEncryptPool::currentBatch && HasJobs(SrtpEncryptPool::currentBatch, listener))
+			Submit();
+
+		std::unique_lock<std::mutex> lock(SrtpEncryptPool::shared->mutex);
+
+		SrtpEncryptPool::shared->doneCv.wait(
+		  lock,
+		  [listener]()
+		  {
+			  for (auto* batch : SrtpEncryptPool::submittedBatches)
+			  {
+				  // clang-format off
+				  if (
+					  batch->pendingThreads.load(std::memory_order_acquire) != 0u &&
+					  HasJobs(batch, listener)
+				  )
+				  // clang-format on
+				  {
+					  return false;
+				  }
+			  }
+
+			  return true;
+		  });
+	}
+
+	void SrtpEncryptPool::RemoveListener(Listener* listener)
+	{
+		MS_TRACE();
+
+		if (!SrtpEncryptPool::shared)
+			return;
+
+		// Not yet submitted jobs are just discarded.
+		if (SrtpEncryptPool::currentBatch)
+		{
+			auto* batch = SrtpEncryptPool::currentBatch;
+
+			for (size_t i{ 0u }; i < batch->numJobs; ++i)
+			{
+				auto& job = batch->jobs[i];
+
+				if (job.listener == listener)
+				{
+					job.listener = nullptr;
+					job.session  = nullptr;
+				}
+			}
+		}
+
+		// Submitted ones must be waited for since pool threads may be using their
+		// SrtpSession.
+		Flush(listener);
+
+		for (auto* batch : SrtpEncryptPool::submittedBatches)
+		{
+			for (size_t i{ 0u }; i < batch->numJobs; ++i)
+			{
+				auto& job = batch->jobs[i];
+
+				if (job.listener == listener)
+					job.listener = nullptr;
+			}
+		}
+	}
+
+	inline void SrtpEncryptPool::OnUvPrepare()
+	{
+		MS_TRACE();
+
+		Submit();
+	}
+
+	inline void SrtpEncryptPool::OnUvAsync()
+	{
+		MS_TRACE();
+
+		// Avoid reentrance if a listener queues packets.
+		if (SrtpEncryptPool::delivering)
+			return;
+
+		SrtpEncryptPool::delivering = true;
+
+		// Deliver completed batches in submission order.
+		while (!SrtpEncryptPool::submittedBatches.empty())
+		{
+			auto* batch = SrtpEncryptPool::submittedBatches.front();
+
+			if (batch->pendingThreads.load(std::memory_order_acquire) != 0u)
+				break;
+
+			// NOTE: Listeners may be removed while iterating, so the batch is kept
+			// in the deque until done.
+			for (size_t i{ 0u }; i < batch->numJobs; ++i)
+			{
+				auto& job = batch->jobs[i];
+
+				if (!job.listener)
+					continue;
+
+				if (!job.encrypted)
+				{
+					MS_WARN_TAG(srtp, "srtp_protect() failed in SRTP encrypt pool, packet discarded");
+
+					continue;
+				}
+
+				job.listener->OnSrtpEncryptPoolRtpPacketEncrypted(
+				  job.data, static_cast<size_t>(job.len));
+			}
+
+			SrtpEncryptPool::submittedBatches.pop_front();
+
+			batch->numJobs = 0u;
+			SrtpEncryptPool::freeBatches.push_back(batch);
+		}
+
+		SrtpEncryptPool::delivering = false;
+	}
+
+	void SrtpEncryptPool::Submit()
+	{
+		MS_TRACE();
+
+		auto* batch = SrtpEncryptPool::currentBatch;
+
+		if (!batch)
+			return;
+
+		SrtpEncryptPool::currentBatch = nullptr;
+
+		uv_prepare_stop(SrtpEncryptPool::uvPrepareHandle);
+
+		// Just wake up the pool threads having jobs in this batch.
+		std::array<bool, MaxThreads> hasJobs{};
+		size_t numThreads{ 0u };
+
+		for (size_t i{ 0u }; i < batch->numJobs; ++i)
+		{
+			auto& job = batch->jobs[i];
+
+			if (!job.session || hasJobs[job.threadIdx])
+				continue;
+
+			hasJobs[job.threadIdx] = true;
+			++numThreads;
+		}
+
+		batch->pendingThreads.store(numThreads, std::memory_order_relaxed);
+
+		SrtpEncryptPool::submittedBatches.push_back(batch);
+
+		// All its jobs were discarded.
+		if (numThreads == 0u)
+		{
+			uv_async_send(SrtpEncryptPool::shared->uvAsyncHandle);
+
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(SrtpEncryptPool::shared->mutex);
+
+			for (size_t threadIdx{ 0u }; threadIdx < SrtpEncryptPool::shared->queues.size(); ++threadIdx)
+			{
+				if (hasJobs[threadIdx])
+					SrtpEncryptPool::shared->queues[threadIdx].push_back(batch);
+			}
+		}
+
+		SrtpEncryptPool::shared->submittedCv.notify_all();
+	}
+
+	bool SrtpEncryptPool::HasJobs(const Batch* batch, const Listener* listener)
+	{
+		for (size_t i{ 0u }; i < batch->numJobs; ++i)
+		{
+			if (batch->jobs[i].listener == listener)
+				return true;
+		}
+
+		return false;
+	}
+
+	void SrtpEncryptPool::ThreadMain(Shared* shared, size_t threadIdx)
+	{
+		// NOTE: No logging here since the Logger only works in the loop thread.
+
+		auto& queue = shared->queues[threadIdx];
+		std::array<RTC::SrtpSession::RtpBatchItem, MaxBatchSize> items;
+		std::array<Job*, MaxBatchSize> itemJobs;
+
+		while (true)
+		{
+			Batch* batch;
+
+			{
+				std::unique_lock<std::mutex> lock(shared->mutex);
+
+				shared->submittedCv.wait(lock, [&]() { return shared->stopping || !queue.empty(); });
+
+				if (queue.empty())
+					return;
+
+				batch = queue.front();
+				queue.pop_front();
+			}
+
+			size_t numItems{ 0u };
+
+			for (size_t i{ 0u }; i < batch->numJobs; ++i)
+			{
+				auto& job = batch->jobs[i];
+
+				if (job.threadIdx != threadIdx || !job.session)
+					continue;
+
+				items[numItems]    = { job.session, job.data, job.len, false };
+				itemJobs[numItems] = std::addressof(job);
+				++numItems;
+			}
+
+			RTC::SrtpSession::EncryptRtpBatch(items.data(), numItems);
+
+			for (size_t i{ 0u }; i < numItems; ++i)
+			{
+				itemJobs[i]->len       = items[i].len;
+				itemJobs[i]->encrypted = items[i].encrypted;
+			}
+
+			// Last thread done with the batch wakes up the loop.
+			if (batch->pendingThreads.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+				uv_async_send(shared->uvAsyncHandle);
+
+			{
+				// Lock so Flush() cannot miss the notification.
+				std::lock_guard<std::mutex> lock(shared->mutex);
+			}
+
+			shared->doneCv.notify_all();
+		}
+	}
+} // namespace RTC
@@ -5,7 +5,11 @@
 #include "DepLibSRTP.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
-#include <cstring> // std::memset(), std::memcpy()
+#include "Metrics.hpp"
+#include "Tracepoints.hpp"
+#include <algorithm> // std::stable_sort()
+#include <cstring>   // std::memset(), std::memcpy()
+#include <vector>
 
 namespace RTC
 {
@@ -13,6 +17,13 @@ namespace RTC
 
 	static constexpr size_t EncryptBufferSize{ 65536 };
 	thread_local static uint8_t EncryptBuffer[EncryptBufferSize];
+	// Indexes of the items of a batch in encryption order.
+	thread_local static std::vector<size_t> BatchOrder;
+
+	/* Class variables. */
+
+	thread_local size_t SrtpSession::numSessions{ 0u };
+	thread_local size_t SrtpSession::numAllocatedSessions{ 0u };
 
 	/* Class methods. */
 
@@ -28,6 +39,75 @@ namespace RTC
 		}
 	}
 
+	size_t SrtpSession::EncryptRtpBatch(RtpBatchItem* items, size_t numItems)
+	{
+		// NOTE: No MS_TRACE() since this may run out of the loop thread.
+
+		BatchOrder.resize(numItems);
+
+		for (size_t i{ 0u }; i < numItems; ++i)
+		{
+			BatchOrder[i] = i;
+		}
+
+		// Group the packets by session. Stable so each stream keeps its order,
+		// which libsrtp needs to estimate the rollover counter.
+		std::stable_sort(
+		  BatchOrder.begin(),
+		  BatchOrder.end(),
+		  [items](size_t a, size_t b) { return items[a].session < items[b].session; });
+
+		size_t numEncrypted{ 0u };
+
+		for (auto idx : BatchOrder)
+		{
+			auto& item = items[idx];
+
+			item.encrypted = item.session->ProtectRtp(item.data, &item.len);
+
+			if (item.encrypted)
+				++numEncrypted;
+		}
+
+		return numEncrypted;
+	}
+
+	size_t SrtpSession::DecryptBatch(DecryptBatchItem* items, size_t numItems)
+	{
+		// NOTE: No MS_TRACE() since this may run out of the loop thread.
+
+		BatchOrder.resize(numItems);
+
+		for (size_t i{ 0u }; i < numItems; ++i)
+		{
+			BatchOrder[i] = i;
+		}
+
+		// Group the packets by session, keeping the order of each one (replay
+		// protection and rollover counter estimation depend on it).
+		std::stable_sort(
+		  BatchOrder.begin(),
+		  BatchOrder.end(),
+		  [items](size_t a, size_t b) { return items[a].session < items[b].session; });
+
+		size_t numDecrypted{ 0u };
+
+		for (auto idx : BatchOrder)
+		{
+			auto& item = items[idx];
+
+			if (item.rtcp)
+				item.decrypted = item.session->UnprotectRtcp(item.data, &item.len);
+			else
+				item.decrypted = item.session->UnprotectRtp(item.data, &item.len);
+
+			if (item.decrypted)
+				++numDecrypted;
+		}
+
+		return numDecrypted;
+	}
+
 	void SrtpSession::OnSrtpEvent(srtp_event_data_t* data)
 	{
 		MS_TRACE();
@@ -52,48 +132,52 @@ namespace RTC
 		}
 	}
 
-	/* Instance methods. */
-
-	SrtpSession::SrtpSession(Type type, CryptoSuite cryptoSuite, uint8_t* key, size_t keyLen)
+	void SrtpSession::FillJsonUsage(json& jsonObject)
 	{
 		MS_TRACE();
 
-		srtp_policy_t policy; // NOLINT(cppcoreguidelines-pro-type-member-init)
+		jsonObject["count"]     = SrtpSession::numSessions;
+		jsonObject["allocated"] = SrtpSession::numAllocatedSessions;
+	}
+
+	void SrtpSession::FillPolicy(srtp_policy_t* policy, Type type, CryptoSuite cryptoSuite)
+	{
+		MS_TRACE();
 
 		// Set all policy fields to 0.
-		std::memset(&policy, 0, sizeof(srtp_policy_t));
+		std::memset(policy, 0, sizeof(srtp_policy_t));
 
 		switch (cryptoSuite)
 		{
 			case CryptoSuite::AES_CM_128_HMAC_SHA1_80:
 			{
-				srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&policy.rtp);
-				srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&policy.rtcp);
+				srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&policy->rtp);
+				srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&policy->rtcp);
 
 				break;
 			}
 
 			case CryptoSuite::AES_CM_128_HMAC_SHA1_32:
 			{
-				srtp_crypto_policy_set_aes_cm_128_hmac_sha1_32(&policy.rtp);
+				srtp_crypto_policy_set_aes_cm_128_hmac_sha1_32(&policy->rtp);
 				// NOTE: Must be 80 for RTCP.
-				srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&policy.rtcp);
+				srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&policy->rtcp);
 
 				break;
 			}
 
 			case CryptoSuite::AEAD_AES_256_GCM:
 			{
-				srtp_crypto_policy_set_aes_gcm_256_16_auth(&policy.rtp);
-				srtp_crypto_policy_set_aes_gcm_256_16_auth(&policy.rtcp);
+				srtp_crypto_policy_set_aes_gcm_256_16_auth(&policy->rtp);
+				srtp_crypto_policy_set_aes_gcm_256_16_auth(&policy->rtcp);
 
 				break;
 			}
 
 			case CryptoSuite::AEAD_AES_128_GCM:
 			{
-				srtp_crypto_policy_set_aes_gcm_128_16_auth(&policy.rtp);
-				srtp_crypto_policy_set_aes_gcm_128_16_auth(&policy.rtcp);
+				srtp_crypto_policy_set_aes_gcm_128_16_auth(&policy->rtp);
+				srtp_crypto_policy_set_aes_gcm_128_16_auth(&policy->rtcp);
 
 				break;
 			}
@@ -104,33 +188,44 @@ namespace RTC
 			}
 		}
 
-		MS_ASSERT(
-		  (int)keyLen == policy.rtp.cipher_key_len,
-		  "given keyLen does not match policy.rtp.cipher_keyLen");
-
 		switch (type)
 		{
 			case Type::INBOUND:
-				policy.ssrc.type = ssrc_any_inbound;
+				policy->ssrc.type = ssrc_any_inbound;
 				break;
 
 			case Type::OUTBOUND:
-				policy.ssrc.type = ssrc_any_outbound;
+				policy->ssrc.type = ssrc_any_outbound;
 				break;
 		}
 
-		policy.ssrc.value = 0;
-		policy.key        = key;
+		policy->ssrc.value = 0;
 		// Required for sending RTP retransmission without RTX.
-		policy.allow_repeat_tx = 1;
-		policy.window_size     = 1024;
-		policy.next            = nullptr;
+		policy->allow_repeat_tx = 1;
+		policy->window_size     = 1024;
+		policy->next            = nullptr;
+	}
 
-		// Set the SRTP session.
-		srtp_err_status_t err = srtp_create(&this->session, &policy);
+	/* Instance methods. */
 
-		if (DepLibSRTP::IsError(err))
-			MS_THROW_ERROR("srtp_create() failed: %s", DepLibSRTP::GetErrorString(err));
+	SrtpSession::SrtpSession(Type type, CryptoSuite cryptoSuite, uint8_t* key, size_t keyLen)
+	  : type(type), cryptoSuite(cryptoSuite), keyLen(keyLen)
+	{
+		MS_TRACE();
+
+		srtp_policy_t policy; // NOLINT(cppcoreguidelines-pro-type-member-init)
+
+		FillPolicy(&policy, type, cryptoSuite);
+
+		MS_ASSERT(
+		  (int)keyLen == policy.rtp.cipher_key_len,
+		  "given keyLen does not match policy.rtp.cipher_keyLen");
+
+		// NOTE: The libsrtp context (cipher contexts and key schedules) is not
+		// allocated until the first packet is processed.
+		std::memcpy(this->key, key, keyLen);
+
+		++SrtpSession::numSessions;
 	}
 
 	SrtpSession::~SrtpSession()
@@ -143,7 +238,39 @@ namespace RTC
 
 			if (DepLibSRTP::IsError(err))
 				MS_ABORT("srtp_dealloc() failed: %s", DepLibSRTP::GetErrorString(err));
+
+			--SrtpSession::numAllocatedSessions;
+		}
+
+		std::memset(this->key, 0, sizeof(this->key));
+
+		--SrtpSession::numSessions;
+	}
+
+	bool SrtpSession::Allocate()
+	{
+		MS_TRACE();
+
+		srtp_policy_t policy; // NOLINT(cppcoreguidelines-pro-type-member-init)
+
+		FillPolicy(&policy, this->type, this->cryptoSuite);
+
+		policy.key = this->key;
+
+		srtp_err_status_t err = srtp_create(&this->session, &policy);
+
+		if (DepLibSRTP::IsError(err))
+		{
+			MS_ERROR("srtp_create() failed: %s", DepLibSRTP::GetErrorString(err));
+
+			this->session = nullptr;
+
+			return false;
 		}
+
+		++SrtpSession::numAllocatedSessions;
+
+		return true;
 	}
 
 	bool SrtpSession::EncryptRtp(const uint8_t** data, int* len)
@@ -158,20 +285,36 @@ namespace RTC
 			return false;
 		}
 
-		std::memcpy(EncryptBuffer, *data, *len);
+		if (!EncryptRtp(*data, len, EncryptBuffer))
+			return false;
+
+		// Update the given data pointer.
+		*data = (const uint8_t*)EncryptBuffer;
+
+		return true;
+	}
+
+	bool SrtpSession::EncryptRtp(const uint8_t* data, int* len, uint8_t* buffer)
+	{
+		MS_TRACE();
+
+		Metrics::StageScope metricsScope(Metrics::Stage::SRTP);
+
+		if (!this->session && !Allocate())
+			return false;
 
-		srtp_err_status_t err = srtp_protect(this->session, static_cast<void*>(EncryptBuffer), len);
+		std::memcpy(buffer, data, *len);
+
+		srtp_err_status_t err = srtp_protect(this->session, static_cast<void*>(buffer), len);
 
 		if (DepLibSRTP::IsError(err))
 		{
 			MS_WARN_TAG(srtp, "srtp_protect() failed: %s", DepLibSRTP::GetErrorString(err));
+			MS_TRACEPOINT(srtp_failure, "srtp_protect", static_cast<int>(err));
 
 			return false;
 		}
 
-		// Update the given data pointer.
-		*data = (const uint8_t*)EncryptBuffer;
-
 		return true;
 	}
 
@@ -179,11 +322,17 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		Metrics::StageScope metricsScope(Metrics::Stage::SRTP);
+
+		if (!this->session && !Allocate())
+			return false;
+
 		srtp_err_status_t err = srtp_unprotect(this->session, static_cast<void*>(data), len);
 
 		if (DepLibSRTP::IsError(err))
 		{
 			MS_DEBUG_TAG(srtp, "srtp_unprotect() failed: %s", DepLibSRTP::GetErrorString(err));
+			MS_TRACEPOINT(srtp_failure, "srtp_unprotect", static_cast<int>(err));
 
 			return false;
 		}
@@ -195,6 +344,8 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		Metrics::StageScope metricsScope(Metrics::Stage::SRTP);
+
 		// Ensure that the resulting SRTCP packet fits into the encrypt buffer.
 		if (static_cast<size_t>(*len) + SRTP_MAX_TRAILER_LEN > EncryptBufferSize)
 		{
@@ -203,6 +354,9 @@ namespace RTC
 			return false;
 		}
 
+		if (!this->session && !Allocate())
+			return false;
+
 		std::memcpy(EncryptBuffer, *data, *len);
 
 		srtp_err_status_t err = srtp_protect_rtcp(this->session, static_cast<void*>(EncryptBuffer), len);
@@ -210,6 +364,7 @@ namespace RTC
 		if (DepLibSRTP::IsError(err))
 		{
 			MS_WARN_TAG(srtp, "srtp_protect_rtcp() failed: %s", DepLibSRTP::GetErrorString(err));
+			MS_TRACEPOINT(srtp_failure, "srtp_protect_rtcp", static_cast<int>(err));
 
 			return false;
 		}
@@ -224,11 +379,17 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		Metrics::StageScope metricsScope(Metrics::Stage::SRTP);
+
+		if (!this->session && !Allocate())
+			return false;
+
 		srtp_err_status_t err = srtp_unprotect_rtcp(this->session, static_cast<void*>(data), len);
 
 		if (DepLibSRTP::IsError(err))
 		{
 			MS_DEBUG_TAG(srtp, "srtp_unprotect_rtcp() failed: %s", DepLibSRTP::GetErrorString(err));
+			MS_TRACEPOINT(srtp_failure, "srtp_unprotect_rtcp", static_cast<int>(err));
 
 			return false;
 		}
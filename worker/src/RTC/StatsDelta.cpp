@@ -0,0 +1,67 @@
+#define MS_CLASS "RTC::StatsDelta"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/StatsDelta.hpp"
+#include "Logger.hpp"
+
+namespace RTC
+{
+	/* Instance methods. */
+
+	void StatsDelta::FillJson(json& jsonObject, json& stats, uint64_t cursor)
+	{
+		MS_TRACE();
+
+		// clang-format off
+		bool full = (
+			cursor == 0u ||
+			cursor != this->cursor ||
+			!this->lastStats.is_array() ||
+			this->lastStats.size() != stats.size()
+		);
+		// clang-format on
+
+		jsonObject["full"] = full;
+
+		if (full)
+		{
+			jsonObject["stats"] = stats;
+		}
+		else
+		{
+			jsonObject["stats"] = json::array();
+			auto jsonStatsIt    = jsonObject.find("stats");
+
+			for (size_t idx{ 0u }; idx < stats.size(); ++idx)
+			{
+				const auto& entry     = stats[idx];
+				const auto& lastEntry = this->lastStats[idx];
+				json jsonEntry        = json::object();
+
+				for (auto it = entry.begin(); it != entry.end(); ++it)
+				{
+					const auto& key = it.key();
+					auto lastIt     = lastEntry.find(key);
+
+					// clang-format off
+					if (
+						key == "type" ||
+						key == "ssrc" ||
+						lastIt == lastEntry.end() ||
+						*lastIt != it.value()
+					)
+					// clang-format on
+					{
+						jsonEntry[key] = it.value();
+					}
+				}
+
+				jsonStatsIt->push_back(jsonEntry);
+			}
+		}
+
+		this->lastStats = std::move(stats);
+
+		jsonObject["cursor"] = ++this->cursor;
+	}
+} // namespace RTC
@@ -422,6 +422,16 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		Utils::Crypto::HmacSha1 localHmacSha1(localPassword);
+
+		return CheckAuthentication(localUsername, localHmacSha1);
+	}
+
+	StunPacket::Authentication StunPacket::CheckAuthentication(
+	  const std::string& localUsername, Utils::Crypto::HmacSha1& localHmacSha1)
+	{
+		MS_TRACE();
+
 		switch (this->klass)
 		{
 			case Class::REQUEST:
@@ -461,8 +471,8 @@ namespace RTC
 			Utils::Byte::Set2Bytes(this->data, 2, static_cast<uint16_t>(this->size - 20 - 8));
 
 		// Calculate the HMAC-SHA1 of the message according to MESSAGE-INTEGRITY rules.
-		const uint8_t* computedMessageIntegrity = Utils::Crypto::GetHmacSha1(
-		  localPassword, this->data, (this->messageIntegrity - 4) - this->data);
+		const uint8_t* computedMessageIntegrity =
+		  localHmacSha1.Compute(this->data, (this->messageIntegrity - 4) - this->data);
 
 		Authentication result;
 
@@ -517,6 +527,21 @@ namespace RTC
 		}
 
 		this->password = password;
+		this->hmacSha1 = nullptr;
+	}
+
+	void StunPacket::Authenticate(Utils::Crypto::HmacSha1& hmacSha1)
+	{
+		// Just for Request, Indication and SuccessResponse messages.
+		if (this->klass == Class::ERROR_RESPONSE)
+		{
+			MS_ERROR("cannot set password for ErrorResponse messages");
+
+			return;
+		}
+
+		this->password = hmacSha1.GetKey();
+		this->hmacSha1 = std::addressof(hmacSha1);
 	}
 
 	void StunPacket::Serialize(uint8_t* buffer)
@@ -764,7 +789,8 @@ namespace RTC
 
 			// Calculate the HMAC-SHA1 of the packet according to MESSAGE-INTEGRITY rules.
 			const uint8_t* computedMessageIntegrity =
-			  Utils::Crypto::GetHmacSha1(this->password, buffer, pos);
+			  this->hmacSha1 ? this->hmacSha1->Compute(buffer, pos)
+			                 : Utils::Crypto::GetHmacSha1(this->password, buffer, pos);
 
 			Utils::Byte::Set2Bytes(buffer, pos, static_cast<uint16_t>(Attribute::MESSAGE_INTEGRITY));
 			Utils::Byte::Set2Bytes(buffer, pos + 2, 20);
@@ -806,4 +832,53 @@ namespace RTC
 
 		MS_ASSERT(pos == this->size, "pos != this->size");
 	}
+
+	void StunPacket::UpdateTransactionId(
+	  const uint8_t* transactionId, Utils::Crypto::HmacSha1& hmacSha1)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(
+		  this->klass == Class::SUCCESS_RESPONSE && this->messageIntegrity && this->hasFingerprint,
+		  "not a serialized success response with MESSAGE-INTEGRITY and FINGERPRINT");
+
+		auto* currentTransactionId = this->data + 8;
+		const size_t messageIntegrityPos =
+		  static_cast<size_t>((this->messageIntegrity - 4) - this->data);
+
+		// The IPv6 address in XOR-MAPPED-ADDRESS is XORed with the transaction ID.
+		for (size_t pos{ 20u }; pos + 4 <= messageIntegrityPos;)
+		{
+			const auto type = static_cast<Attribute>(Utils::Byte::Get2Bytes(this->data, pos));
+			const size_t len = Utils::Byte::Get2Bytes(this->data, pos + 2);
+
+			if (type == Attribute::XOR_MAPPED_ADDRESS && len == 20)
+			{
+				uint8_t* attrValue = this->data + pos + 4;
+
+				for (size_t idx{ 0u }; idx < 12; ++idx)
+				{
+					attrValue[8 + idx] ^= currentTransactionId[idx] ^ transactionId[idx];
+				}
+			}
+
+			pos += 4 + Utils::Byte::PadTo4Bytes(static_cast<uint16_t>(len));
+		}
+
+		std::memcpy(currentTransactionId, transactionId, 12);
+
+		// MESSAGE-INTEGRITY is computed with the length field ignoring FINGERPRINT.
+		Utils::Byte::Set2Bytes(this->data, 2, static_cast<uint16_t>(this->size - 20 - 8));
+
+		std::memcpy(
+		  this->data + messageIntegrityPos + 4, hmacSha1.Compute(this->data, messageIntegrityPos), 20);
+
+		Utils::Byte::Set2Bytes(this->data, 2, static_cast<uint16_t>(this->size - 20));
+
+		// FINGERPRINT is the last attribute.
+		const uint32_t computedFingerprint =
+		  Utils::Crypto::GetCRC32(this->data, this->size - 8) ^ 0x5354554e;
+
+		Utils::Byte::Set4Bytes(this->data, this->size - 4, computedFingerprint);
+	}
 } // namespace RTC
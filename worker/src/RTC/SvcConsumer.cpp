@@ -5,6 +5,7 @@
 #include "DepLibUV.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Tracepoints.hpp"
 #include "Utils.hpp"
 #include "Channel/ChannelNotifier.hpp"
 #include "RTC/Codecs/Tools.hpp"
@@ -15,6 +16,9 @@ namespace RTC
 
 	static constexpr uint64_t BweDowngradeConservativeMs{ 10000u }; // In ms.
 	static constexpr uint64_t BweDowngradeMinActiveMs{ 8000u };     // In ms.
+	// Max time a spatial layer upgrade waits for a switch point before
+	// requesting a key frame.
+	static constexpr uint64_t SpatialUpgradeMaxWaitMs{ 1000u }; // In ms.
 
 	/* Instance methods. */
 
@@ -25,7 +29,7 @@ namespace RTC
 		MS_TRACE();
 
 		// Ensure there is a single encoding.
-		if (this->consumableRtpEncodings.size() != 1u)
+		if (this->consumableRtpEncodings->size() != 1u)
 			MS_THROW_TYPE_ERROR("invalid consumableRtpEncodings with size != 1");
 
 		auto& encoding = this->rtpParameters.encodings[0];
@@ -100,8 +104,24 @@ namespace RTC
 
 		MS_ASSERT(this->encodingContext, "no encoding context for this codec");
 
+		this->processPayloadFn = RTC::Codecs::Tools::GetProcessPayloadFn(mediaCodec->mimeType);
+		this->restorePayloadFn = RTC::Codecs::Tools::GetRestorePayloadFn(mediaCodec->mimeType);
+
+		this->headerTemplate.SetSsrc(this->rtpParameters.encodings[0].ssrc);
+
 		// Create RtpStreamSend instance for sending a single stream to the remote.
 		CreateRtpStream();
+
+		auto jsonSendStateIt = data.find("sendState");
+
+		// Continue the stream of a migrated Consumer (if given).
+		if (jsonSendStateIt != data.end())
+		{
+			// This may throw.
+			ApplySendState(*jsonSendStateIt, this->rtpSeqManager, this->rtpStream);
+
+			this->syncRequired = true;
+		}
 	}
 
 	SvcConsumer::~SvcConsumer()
@@ -148,6 +168,9 @@ namespace RTC
 		jsonArray.emplace_back(json::value_t::object);
 		this->rtpStream->FillJsonStats(jsonArray[0]);
 
+		// Add number of spatial layer upgrades done without key frame request.
+		jsonArray[0]["keyFrameRequestsAvoided"] = this->keyFrameRequestsAvoided;
+
 		// Add stats of our recv stream.
 		if (this->producerRtpStream)
 		{
@@ -172,6 +195,16 @@ namespace RTC
 		jsonObject["producerScores"] = *this->producerRtpStreamScores;
 	}
 
+	void SvcConsumer::FillJsonSendState(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		FillJsonStreamSendState(jsonObject, this->rtpSeqManager, this->rtpStream);
+
+		jsonObject["spatialLayer"]  = this->encodingContext->GetCurrentSpatialLayer();
+		jsonObject["temporalLayer"] = this->encodingContext->GetCurrentTemporalLayer();
+	}
+
 	void SvcConsumer::HandleRequest(Channel::ChannelRequest* request)
 	{
 		MS_TRACE();
@@ -245,15 +278,15 @@ namespace RTC
 
 				// clang-format off
 				if (
-					IsActive() &&
-					(
-						this->preferredSpatialLayer != previousPreferredSpatialLayer ||
-						this->preferredTemporalLayer != previousPreferredTemporalLayer
-					)
+					this->preferredSpatialLayer != previousPreferredSpatialLayer ||
+					this->preferredTemporalLayer != previousPreferredTemporalLayer
 				)
 				// clang-format on
 				{
-					MayChangeLayers(/*force*/ true);
+					if (IsActive())
+						MayChangeLayers(/*force*/ true);
+
+					this->listener->OnConsumerPreferredLayersChanged(this);
 				}
 
 				break;
@@ -267,6 +300,29 @@ namespace RTC
 		}
 	}
 
+	void SvcConsumer::SetOverloadLevel(OverloadController::Level level)
+	{
+		MS_TRACE();
+
+		auto previousMaxSpatialLayer  = this->overloadMaxSpatialLayer;
+		auto previousMaxTemporalLayer = this->overloadMaxTemporalLayer;
+
+		RTC::Consumer::SetOverloadLevel(level);
+
+		// clang-format off
+		if (
+			IsActive() &&
+			(
+				this->overloadMaxSpatialLayer != previousMaxSpatialLayer ||
+				this->overloadMaxTemporalLayer != previousMaxTemporalLayer
+			)
+		)
+		// clang-format on
+		{
+			MayChangeLayers(/*force*/ true);
+		}
+	}
+
 	void SvcConsumer::ProducerRtpStream(RTC::RtpStream* rtpStream, uint32_t /*mappedSsrc*/)
 	{
 		MS_TRACE();
@@ -342,8 +398,8 @@ namespace RTC
 		// If already in the preferred layers, do nothing.
 		// clang-format off
 		if (
-			this->provisionalTargetSpatialLayer == this->preferredSpatialLayer &&
-			this->provisionalTargetTemporalLayer == this->preferredTemporalLayer
+			this->provisionalTargetSpatialLayer == LimitSpatialLayer(this->preferredSpatialLayer) &&
+			this->provisionalTargetTemporalLayer == LimitTemporalLayer(this->preferredTemporalLayer)
 		)
 		// clang-format on
 		{
@@ -399,6 +455,10 @@ namespace RTC
 			// Check bitrate of every temporal layer.
 			for (; temporalLayer < this->producerRtpStream->GetTemporalLayers(); ++temporalLayer)
 			{
+				// Don't go beyond the temporal layers allowed by the overload level.
+				if (temporalLayer > LimitTemporalLayer(temporalLayer))
+					break;
+
 				// Ignore temporal layers lower than the one we already have (taking into account
 				// the spatial layer too).
 				// clang-format off
@@ -430,7 +490,7 @@ namespace RTC
 			}
 
 			// If this is the preferred or higher spatial layer, take it and exit.
-			if (spatialLayer >= this->preferredSpatialLayer)
+			if (spatialLayer >= LimitSpatialLayer(this->preferredSpatialLayer))
 				break;
 		}
 
@@ -495,7 +555,7 @@ namespace RTC
 			if (
 				this->rtpStream->GetActiveMs() > BweDowngradeMinActiveMs &&
 				this->encodingContext->GetTargetSpatialLayer() < this->encodingContext->GetCurrentSpatialLayer() &&
-				this->encodingContext->GetCurrentSpatialLayer() <= this->preferredSpatialLayer
+				this->encodingContext->GetCurrentSpatialLayer() <= LimitSpatialLayer(this->preferredSpatialLayer)
 			)
 			// clang-format on
 			{
@@ -553,16 +613,32 @@ namespace RTC
 
 		// NOTE: This may happen if this Consumer supports just some codecs of those
 		// in the corresponding Producer.
-		if (this->supportedCodecPayloadTypes.find(payloadType) == this->supportedCodecPayloadTypes.end())
+		if (!this->supportedCodecPayloadTypes.test(payloadType))
 		{
 			MS_DEBUG_DEV("payload type not supported [payloadType:%" PRIu8 "]", payloadType);
 
+			MS_TRACEPOINT(
+			  consumer_packet_dropped,
+			  this->id.c_str(),
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  "unsupported_payload_type");
+
 			return;
 		}
 
 		// If we need to sync and this is not a key frame, ignore the packet.
 		if (this->syncRequired && !packet->IsKeyFrame())
+		{
+			MS_TRACEPOINT(
+			  consumer_packet_dropped,
+			  this->id.c_str(),
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  "waiting_key_frame");
+
 			return;
+		}
 
 		// Whether this is the first packet after re-sync.
 		bool isSyncPacket = this->syncRequired;
@@ -578,19 +654,54 @@ namespace RTC
 			this->syncRequired = false;
 		}
 
+		// Give up waiting for a spatial layer switch point.
+		// clang-format off
+		if (
+			this->spatialUpgradePendingSinceMs != 0u &&
+			DepLibUV::GetTimeMs() - this->spatialUpgradePendingSinceMs >= SpatialUpgradeMaxWaitMs
+		)
+		// clang-format on
+		{
+			MS_DEBUG_DEV("no switch point received for spatial upgrade, requesting keyframe");
+
+			this->spatialUpgradePendingSinceMs = 0u;
+
+			RequestKeyFrame();
+		}
+
 		auto previousSpatialLayer  = this->encodingContext->GetCurrentSpatialLayer();
 		auto previousTemporalLayer = this->encodingContext->GetCurrentTemporalLayer();
 
 		bool marker{ false };
-		bool origMarker = packet->HasMarker();
 
-		if (!packet->ProcessPayload(this->encodingContext.get(), marker))
+		if (!this->processPayloadFn(packet, this->encodingContext.get(), marker))
 		{
+			MS_TRACEPOINT(
+			  consumer_packet_dropped,
+			  this->id.c_str(),
+			  packet->GetSsrc(),
+			  packet->GetSequenceNumber(),
+			  "layer_filtered");
+
 			this->rtpSeqManager.Drop(packet->GetSequenceNumber());
 
 			return;
 		}
 
+		// clang-format off
+		if (
+			this->spatialUpgradePendingSinceMs != 0u &&
+			this->encodingContext->GetCurrentSpatialLayer() >=
+				this->encodingContext->GetTargetSpatialLayer()
+		)
+		// clang-format on
+		{
+			this->spatialUpgradePendingSinceMs = 0u;
+
+			if (!packet->IsKeyFrame())
+				++this->keyFrameRequestsAvoided;
+		}
+
 		// clang-format off
 		if (
 			previousSpatialLayer != this->encodingContext->GetCurrentSpatialLayer() ||
@@ -607,13 +718,10 @@ namespace RTC
 
 		this->rtpSeqManager.Input(packet->GetSequenceNumber(), seq);
 
-		// Save original packet fields.
-		auto origSsrc = packet->GetSsrc();
-		auto origSeq  = packet->GetSequenceNumber();
+		RTC::RtpHeaderTemplate::SavedHeader savedHeader;
 
-		// Rewrite packet.
-		packet->SetSsrc(this->rtpParameters.encodings[0].ssrc);
-		packet->SetSequenceNumber(seq);
+		// Rewrite packet (saving its original header).
+		this->headerTemplate.Apply(packet, seq, savedHeader);
 
 		if (marker)
 		{
@@ -629,7 +737,7 @@ namespace RTC
 			  packet->GetSsrc(),
 			  packet->GetSequenceNumber(),
 			  packet->GetTimestamp(),
-			  origSeq);
+			  uint16_t{ ntohs(savedHeader.sequenceNumber) });
 		}
 
 		// Process the packet.
@@ -650,17 +758,15 @@ namespace RTC
 			  packet->GetSsrc(),
 			  packet->GetSequenceNumber(),
 			  packet->GetTimestamp(),
-			  origSsrc,
-			  origSeq);
+			  uint32_t{ ntohl(savedHeader.ssrc) },
+			  uint16_t{ ntohs(savedHeader.sequenceNumber) });
 		}
 
-		// Restore packet fields.
-		packet->SetSsrc(origSsrc);
-		packet->SetSequenceNumber(origSeq);
-		packet->SetMarker(origMarker);
+		// Restore packet header (marker included).
+		RTC::RtpHeaderTemplate::Restore(packet, savedHeader);
 
 		// Restore the original payload if needed.
-		packet->RestorePayload();
+		this->restorePayloadFn(packet);
 	}
 
 	void SvcConsumer::GetRtcp(
@@ -681,9 +787,10 @@ namespace RTC
 		packet->AddSenderReport(report);
 
 		// Build SDES chunk for this sender.
-		auto* sdesChunk = this->rtpStream->GetRtcpSdesChunk();
+		auto* sdesChunk = this->rtpStream->GetRtcpSdesChunk(nowMs);
 
-		packet->AddSdesChunk(sdesChunk);
+		if (sdesChunk)
+			packet->AddSdesChunk(sdesChunk);
 
 		auto* dlrr = this->rtpStream->GetRtcpXrDelaySinceLastRr(nowMs);
 
@@ -843,13 +950,14 @@ namespace RTC
 		// Set stream params.
 		RTC::RtpStream::Params params;
 
-		params.ssrc           = encoding.ssrc;
-		params.payloadType    = mediaCodec->payloadType;
-		params.mimeType       = mediaCodec->mimeType;
-		params.clockRate      = mediaCodec->clockRate;
-		params.cname          = this->rtpParameters.rtcp.cname;
-		params.spatialLayers  = encoding.spatialLayers;
-		params.temporalLayers = encoding.temporalLayers;
+		params.ssrc            = encoding.ssrc;
+		params.payloadType     = mediaCodec->payloadType;
+		params.mimeType        = mediaCodec->mimeType;
+		params.clockRate       = mediaCodec->clockRate;
+		params.cname           = this->rtpParameters.rtcp.cname;
+		params.rtcpReducedSize = this->rtpParameters.rtcp.reducedSize;
+		params.spatialLayers   = encoding.spatialLayers;
+		params.temporalLayers  = encoding.temporalLayers;
 
 		// Check in band FEC in codec parameters.
 		if (mediaCodec->parameters.HasInteger("useinbandfec") && mediaCodec->parameters.GetInteger("useinbandfec") == 1)
@@ -911,6 +1019,11 @@ namespace RTC
 
 		if (rtxCodec && encoding.hasRtx)
 			this->rtpStream->SetRtx(rtxCodec->payloadType, encoding.rtx.ssrc);
+
+		const auto* fecCodec = this->rtpParameters.GetFecCodec();
+
+		if (fecCodec && encoding.hasFec)
+			this->rtpStream->SetFec(fecCodec->payloadType, encoding.fec.ssrc);
 	}
 
 	void SvcConsumer::RequestKeyFrame()
@@ -920,7 +1033,7 @@ namespace RTC
 		if (this->kind != RTC::Media::Kind::VIDEO)
 			return;
 
-		auto mappedSsrc = this->consumableRtpEncodings[0].ssrc;
+		auto mappedSsrc = (*this->consumableRtpEncodings)[0].ssrc;
 
 		this->listener->OnConsumerKeyFrameRequested(this, mappedSsrc);
 	}
@@ -986,16 +1099,16 @@ namespace RTC
 
 			// If this is the preferred or higher spatial layer and has bitrate,
 			// take it and exit.
-			if (spatialLayer >= this->preferredSpatialLayer)
+			if (spatialLayer >= LimitSpatialLayer(this->preferredSpatialLayer))
 				break;
 		}
 
 		if (newTargetSpatialLayer != -1)
 		{
-			if (newTargetSpatialLayer == this->preferredSpatialLayer)
-				newTargetTemporalLayer = this->preferredTemporalLayer;
-			else if (newTargetSpatialLayer < this->preferredSpatialLayer)
-				newTargetTemporalLayer = this->rtpStream->GetTemporalLayers() - 1;
+			if (newTargetSpatialLayer == LimitSpatialLayer(this->preferredSpatialLayer))
+				newTargetTemporalLayer = LimitTemporalLayer(this->preferredTemporalLayer);
+			else if (newTargetSpatialLayer < LimitSpatialLayer(this->preferredSpatialLayer))
+				newTargetTemporalLayer = LimitTemporalLayer(this->rtpStream->GetTemporalLayers() - 1);
 			else
 				newTargetTemporalLayer = 0;
 		}
@@ -1041,17 +1154,39 @@ namespace RTC
 		  newTargetTemporalLayer,
 		  this->id.c_str());
 
+		// Target spatial layer is not higher than current one, so no upgrade is
+		// pending anymore.
+		if (newTargetSpatialLayer <= this->encodingContext->GetCurrentSpatialLayer())
+			this->spatialUpgradePendingSinceMs = 0u;
+
 		// Target spatial layer has changed.
 		if (newTargetSpatialLayer != this->encodingContext->GetCurrentSpatialLayer())
 		{
-			// In K-SVC always ask for a keyframe when changing target spatial layer.
-			if (this->encodingContext->IsKSvc())
+			// When upgrading target spatial layer while already sending some layer,
+			// wait for a switch point (a layer frame just predicted from the lower
+			// layer) so other Consumers of the Producer do not get a keyframe. If
+			// none comes within SpatialUpgradeMaxWaitMs a keyframe is requested.
+			// clang-format off
+			if (
+				newTargetSpatialLayer > this->encodingContext->GetCurrentSpatialLayer() &&
+				this->encodingContext->GetCurrentSpatialLayer() >= 0
+			)
+			// clang-format on
+			{
+				MS_DEBUG_DEV("waiting for a switch point to target spatial upgrade");
+
+				if (this->spatialUpgradePendingSinceMs == 0u)
+					this->spatialUpgradePendingSinceMs = DepLibUV::GetTimeMs();
+			}
+			// In K-SVC always ask for a keyframe when downgrading target spatial
+			// layer or when no layer is being sent yet.
+			else if (this->encodingContext->IsKSvc())
 			{
 				MS_DEBUG_DEV("K-SVC: requesting keyframe to target spatial change");
 
 				RequestKeyFrame();
 			}
-			// In full SVC just ask for a keyframe when upgrading target spatial layer.
+			// In full SVC just ask for a keyframe when no layer is being sent yet.
 			// NOTE: This is because nobody implements RTCP LRR yet.
 			else if (newTargetSpatialLayer > this->encodingContext->GetCurrentSpatialLayer())
 			{
@@ -1070,7 +1205,7 @@ namespace RTC
 
 		FillJsonScore(data);
 
-		Channel::ChannelNotifier::Emit(this->id, "score", data);
+		Channel::ChannelNotifier::EmitBatched(this->id, "score", data);
 	}
 
 	inline void SvcConsumer::EmitLayersChange() const
@@ -1095,7 +1230,7 @@ namespace RTC
 			data = nullptr;
 		}
 
-		Channel::ChannelNotifier::Emit(this->id, "layerschange", data);
+		Channel::ChannelNotifier::EmitBatched(this->id, "layerschange", data);
 	}
 
 	inline void SvcConsumer::OnRtpStreamScore(
@@ -1116,14 +1251,25 @@ namespace RTC
 		}
 	}
 
-	inline void SvcConsumer::OnRtpStreamRetransmitRtpPacket(
-	  RTC::RtpStreamSend* /*rtpStream*/, RTC::RtpPacket* packet)
+	inline void SvcConsumer::OnRtpStreamRetransmitRtpPackets(
+	  RTC::RtpStreamSend* /*rtpStream*/, RTC::RtpPacket** packets, size_t count)
 	{
 		MS_TRACE();
 
-		this->listener->OnConsumerRetransmitRtpPacket(this, packet);
+		this->listener->OnConsumerRetransmitRtpPackets(this, packets, count);
 
 		// May emit 'trace' event.
-		EmitTraceEventRtpAndKeyFrameTypes(packet, this->rtpStream->HasRtx());
+		for (size_t idx{ 0u }; idx < count; ++idx)
+		{
+			EmitTraceEventRtpAndKeyFrameTypes(packets[idx], this->rtpStream->HasRtx());
+		}
+	}
+
+	inline void SvcConsumer::OnRtpStreamSendFecPacket(
+	  RTC::RtpStreamSend* /*rtpStream*/, RTC::RtpPacket* packet)
+	{
+		MS_TRACE();
+
+		this->listener->OnConsumerSendRtpPacket(this, packet);
 	}
 } // namespace RTC
@@ -3,7 +3,10 @@
 
 #include "RTC/TcpConnection.hpp"
 #include "Logger.hpp"
+#include "Settings.hpp"
 #include "Utils.hpp"
+#include "RTC/RTCP/Packet.hpp"
+#include "RTC/RtpPacket.hpp"
 #include <cstring> // std::memmove(), std::memcpy()
 
 namespace RTC
@@ -12,6 +15,8 @@ namespace RTC
 
 	static constexpr size_t ReadBufferSize{ 65536 };
 	thread_local static uint8_t ReadBuffer[ReadBufferSize];
+	// Messages written to TURN clients.
+	thread_local static uint8_t TurnBuffer[ReadBufferSize + RTC::TurnSession::MaxDataHeaderSize + 4];
 
 	/* Instance methods. */
 
@@ -24,6 +29,8 @@ namespace RTC
 	TcpConnection::~TcpConnection()
 	{
 		MS_TRACE();
+
+		delete this->turnSession;
 	}
 
 	void TcpConnection::UserOnTcpConnectionRead()
@@ -63,29 +70,72 @@ namespace RTC
 				return;
 
 			size_t dataLen = this->bufferDataLen - this->frameStart;
-			size_t packetLen;
+			size_t frameLen{ 0u };
+
+			// A TURN client sends STUN messages instead of RFC 4571 frames.
+			if (!this->framingDetected && dataLen >= 8)
+			{
+				this->framingDetected = true;
 
-			if (dataLen >= 2)
-				packetLen = size_t{ Utils::Byte::Get2Bytes(this->buffer + this->frameStart, 0) };
+				// clang-format off
+				if (
+					Settings::configuration.turnOverTcp &&
+					RTC::TurnSession::IsTurn(this->buffer + this->frameStart, dataLen)
+				)
+				// clang-format on
+				{
+					MS_DEBUG_TAG(
+					  ice,
+					  "TURN client connected [remote:%s :%" PRIu16 "]",
+					  GetPeerIp().c_str(),
+					  GetPeerPort());
+
+					this->turnSession = new RTC::TurnSession(GetPeerAddress(), GetLocalAddress());
+				}
+			}
 
-			// We have packetLen bytes.
-			if (dataLen >= 2 && dataLen >= 2 + packetLen)
+			if (this->turnSession)
 			{
-				const uint8_t* packet = this->buffer + this->frameStart + 2;
+				frameLen = RTC::TurnSession::GetMessageSize(this->buffer + this->frameStart, dataLen);
 
+				if (dataLen >= 4 && frameLen == 0u)
+				{
+					MS_WARN_DEV("invalid TURN message, closing the connection");
+
+					ErrorReceiving();
+
+					return;
+				}
+			}
+			else if (dataLen >= 2)
+			{
+				frameLen = 2 + size_t{ Utils::Byte::Get2Bytes(this->buffer + this->frameStart, 0) };
+			}
+
+			// We have frameLen bytes.
+			if (frameLen != 0u && dataLen >= frameLen)
+			{
+				const uint8_t* frame = this->buffer + this->frameStart;
+
+				if (this->turnSession)
+				{
+					// And exit fast if we are supposed to be deallocated.
+					if (!ProcessTurnFrame(frame, frameLen))
+						return;
+				}
 				// Update received bytes and notify the listener.
-				if (packetLen != 0)
+				else if (frameLen != 2)
 				{
 					// Copy the received packet into the static buffer so it can be expanded
 					// later.
-					std::memcpy(ReadBuffer, packet, packetLen);
+					std::memcpy(ReadBuffer, frame + 2, frameLen - 2);
 
-					this->listener->OnTcpConnectionPacketReceived(this, ReadBuffer, packetLen);
+					this->listener->OnTcpConnectionPacketReceived(this, ReadBuffer, frameLen - 2);
 				}
 
 				// If there is no more space available in the buffer and that is because
 				// the latest parsed frame filled it, then empty the full buffer.
-				if ((this->frameStart + 2 + packetLen) == this->bufferSize)
+				if ((this->frameStart + frameLen) == this->bufferSize)
 				{
 					MS_DEBUG_DEV("no more space in the buffer, emptying the buffer data");
 
@@ -96,7 +146,7 @@ namespace RTC
 				// frame to the next position after the parsed frame.
 				else
 				{
-					this->frameStart += 2 + packetLen;
+					this->frameStart += frameLen;
 				}
 
 				// If there is more data in the buffer after the parsed frame then
@@ -158,11 +208,78 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		// RTP packets can be dropped if they wait too long to be written.
+		const bool isMedia = !RTC::RTCP::Packet::IsRtcp(data, len) && RTC::RtpPacket::IsRtp(data, len);
+
+		// Relay it to the TURN client as coming from its peer.
+		if (this->turnSession)
+		{
+			const size_t headerLen  = this->turnSession->FillDataHeader(TurnBuffer, len);
+			const size_t paddingLen = RTC::TurnSession::GetPaddingSize(len);
+
+			if (headerLen == 0u || headerLen + len + paddingLen > sizeof(TurnBuffer))
+			{
+				if (cb)
+					(*cb)(false);
+
+				return;
+			}
+
+			std::memcpy(TurnBuffer + headerLen, data, len);
+			std::memset(TurnBuffer + headerLen + len, 0, paddingLen);
+
+			::TcpConnectionHandler::Write(
+			  TurnBuffer, headerLen + len + paddingLen, nullptr, 0, cb, isMedia);
+
+			return;
+		}
+
 		// Write according to Framing RFC 4571.
 
 		uint8_t frameLen[2];
 
 		Utils::Byte::Set2Bytes(frameLen, 0, len);
-		::TcpConnectionHandler::Write(frameLen, 2, data, len, cb);
+		::TcpConnectionHandler::Write(frameLen, 2, data, len, cb, isMedia);
+	}
+
+	bool TcpConnection::ProcessTurnFrame(const uint8_t* frame, size_t len)
+	{
+		MS_TRACE();
+
+		const uint8_t* data{ nullptr };
+		size_t dataLen{ 0u };
+
+		if (RTC::TurnSession::IsChannelData(frame))
+		{
+			data = this->turnSession->ProcessChannelData(frame, len, dataLen);
+		}
+		else
+		{
+			const size_t responseLen =
+			  this->turnSession->ProcessMessage(frame, len, TurnBuffer, data, dataLen);
+
+			if (responseLen != 0u)
+				::TcpConnectionHandler::Write(TurnBuffer, responseLen, nullptr, 0, nullptr);
+
+			if (this->turnSession->IsReleased())
+			{
+				MS_DEBUG_TAG(ice, "TURN allocation released, closing the connection");
+
+				ErrorReceiving();
+
+				return false;
+			}
+		}
+
+		if (data && dataLen != 0u)
+		{
+			// Copy the received packet into the static buffer so it can be expanded
+			// later.
+			std::memcpy(ReadBuffer, data, dataLen);
+
+			this->listener->OnTcpConnectionPacketReceived(this, ReadBuffer, dataLen);
+		}
+
+		return true;
 	}
 } // namespace RTC
@@ -0,0 +1,188 @@
+#define MS_CLASS "RTC::TraceEventSampler"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/TraceEventSampler.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "Channel/ChannelNotifier.hpp"
+
+namespace RTC
+{
+	/* Class methods. */
+
+	TraceEventSampler* TraceEventSampler::Create(const std::string& targetId, const json& data)
+	{
+		MS_TRACE();
+
+		Mode mode{ Mode::EVENT };
+		uint32_t sampleRate{ 1u };
+		size_t bufferSize{ DefaultBufferSize };
+
+		auto jsonModeIt       = data.find("mode");
+		auto jsonSampleRateIt = data.find("sampleRate");
+		auto jsonBufferSizeIt = data.find("bufferSize");
+
+		if (jsonModeIt != data.end())
+		{
+			if (!jsonModeIt->is_string())
+				MS_THROW_TYPE_ERROR("wrong mode (not a string)");
+
+			auto modeStr = jsonModeIt->get<std::string>();
+
+			if (modeStr == "event")
+				mode = Mode::EVENT;
+			else if (modeStr == "summary")
+				mode = Mode::SUMMARY;
+			else if (modeStr == "buffer")
+				mode = Mode::BUFFER;
+			else
+				MS_THROW_TYPE_ERROR("invalid mode '%s'", modeStr.c_str());
+		}
+
+		if (jsonSampleRateIt != data.end())
+		{
+			// clang-format off
+			if (
+				!jsonSampleRateIt->is_number_unsigned() ||
+				jsonSampleRateIt->get<uint32_t>() == 0u
+			)
+			// clang-format on
+			{
+				MS_THROW_TYPE_ERROR("wrong sampleRate (not a positive number)");
+			}
+
+			sampleRate = jsonSampleRateIt->get<uint32_t>();
+		}
+
+		if (jsonBufferSizeIt != data.end())
+		{
+			// clang-format off
+			if (
+				!jsonBufferSizeIt->is_number_unsigned() ||
+				jsonBufferSizeIt->get<size_t>() == 0u ||
+				jsonBufferSizeIt->get<size_t>() > MaxBufferSize
+			)
+			// clang-format on
+			{
+				MS_THROW_TYPE_ERROR("wrong bufferSize (not a number between 1 and %zu)", MaxBufferSize);
+			}
+
+			bufferSize = jsonBufferSizeIt->get<size_t>();
+		}
+
+		if (mode == Mode::EVENT && sampleRate == 1u)
+			return nullptr;
+
+		return new TraceEventSampler(targetId, mode, sampleRate, bufferSize);
+	}
+
+	/* Instance methods. */
+
+	TraceEventSampler::TraceEventSampler(
+	  const std::string& targetId, Mode mode, uint32_t sampleRate, size_t bufferSize)
+	  : targetId(targetId), mode(mode), sampleRate(sampleRate), bufferSize(bufferSize)
+	{
+		MS_TRACE();
+
+		if (this->mode == Mode::SUMMARY)
+		{
+			this->summaryTimer = new Timer(this);
+
+			this->summaryTimer->Start(SummaryInterval, SummaryInterval);
+		}
+	}
+
+	TraceEventSampler::~TraceEventSampler()
+	{
+		MS_TRACE();
+
+		delete this->summaryTimer;
+	}
+
+	void TraceEventSampler::Emit(json& data)
+	{
+		MS_TRACE();
+
+		switch (this->mode)
+		{
+			case Mode::EVENT:
+			{
+				Channel::ChannelNotifier::Emit(this->targetId, "trace", data);
+
+				break;
+			}
+
+			case Mode::BUFFER:
+			{
+				if (this->buffer.size() == this->bufferSize)
+					this->buffer.pop_front();
+
+				this->buffer.push_back(std::move(data));
+
+				break;
+			}
+
+			// Nothing is built in summary mode.
+			case Mode::SUMMARY:
+			{
+				break;
+			}
+		}
+	}
+
+	void TraceEventSampler::FillJson(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		switch (this->mode)
+		{
+			case Mode::EVENT:
+				jsonObject["traceEventMode"] = "event";
+				break;
+			case Mode::SUMMARY:
+				jsonObject["traceEventMode"] = "summary";
+				break;
+			case Mode::BUFFER:
+				jsonObject["traceEventMode"] = "buffer";
+				break;
+		}
+
+		jsonObject["traceEventSampleRate"] = this->sampleRate;
+
+		if (this->mode != Mode::BUFFER)
+			return;
+
+		// Add traceEvents.
+		jsonObject["traceEvents"] = json::array();
+		auto jsonTraceEventsIt    = jsonObject.find("traceEvents");
+
+		for (const auto& data : this->buffer)
+		{
+			jsonTraceEventsIt->push_back(data);
+		}
+	}
+
+	inline void TraceEventSampler::OnTimer(Timer* /*timer*/)
+	{
+		MS_TRACE();
+
+		if (this->summaryCounts.empty())
+			return;
+
+		json data = json::object();
+
+		data["type"]      = "summary";
+		data["timestamp"] = DepLibUV::GetTimeMs();
+		data["info"]      = json::object();
+
+		for (const auto& kv : this->summaryCounts)
+		{
+			data["info"][kv.first] = kv.second;
+		}
+
+		this->summaryCounts.clear();
+
+		Channel::ChannelNotifier::Emit(this->targetId, "trace", data);
+	}
+} // namespace RTC
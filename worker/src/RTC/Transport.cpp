@@ -4,6 +4,9 @@
 #include "RTC/Transport.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Metrics.hpp"
+#include "Settings.hpp"
+#include "Tracepoints.hpp"
 #include "Utils.hpp"
 #include "Channel/ChannelNotifier.hpp"
 #include "PayloadChannel/PayloadChannelNotifier.hpp"
@@ -20,15 +23,27 @@
 #include "RTC/SimpleConsumer.hpp"
 #include "RTC/SimulcastConsumer.hpp"
 #include "RTC/SvcConsumer.hpp"
+#include "handles/UdpSocketHandler.hpp"
 #include <libwebrtc/modules/rtp_rtcp/include/rtp_rtcp_defines.h> // webrtc::RtpPacketSendInfo
+#include <algorithm>                                             // std::stable_sort()
+#include <cstring>                                               // std::memcpy()
 #include <iterator>                                              // std::ostream_iterator
-#include <map>                                                   // std::multimap
+#include <memory>                                                // std::make_shared()
 #include <sstream>                                               // std::ostringstream
 
 namespace RTC
 {
 	static size_t DefaultSctpSendBufferSize{ 262144 }; // 2^18.
 	static size_t MaxSctpSendBufferSize{ 268435456 };  // 2^28.
+	// Min time between bitrate distributions triggered by Consumers.
+	static constexpr uint64_t BitrateDistributionMinIntervalMs{ 100u }; // In ms.
+	// Max time without bitrate distribution if BWE does not change much.
+	static constexpr uint64_t BitrateDistributionMaxIntervalMs{ 2000u }; // In ms.
+	// BWE changes within this factor do not trigger a bitrate distribution.
+	static constexpr float BitrateDistributionHysteresisFactor{ 0.05f };
+	// Room for feedback packets in a RTCP compound packet headed by an empty
+	// Receiver Report (8 bytes).
+	static constexpr size_t RtcpFeedbackBufferMaxLen{ RTC::MtuSize - 8u };
 
 	/* Instance methods. */
 
@@ -38,6 +53,9 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		if (Settings::configuration.transportArenas)
+			this->arena = new RTC::TransportArena();
+
 		auto jsonDirectIt = data.find("direct");
 
 		// clang-format off
@@ -76,6 +94,73 @@ namespace RTC
 			this->initialAvailableOutgoingBitrate = jsonInitialAvailableOutgoingBitrateIt->get<uint32_t>();
 		}
 
+		auto jsonRtpReorderDelayIt = data.find("rtpReorderDelay");
+
+		if (jsonRtpReorderDelayIt != data.end())
+		{
+			// clang-format off
+			if (
+				!Utils::Json::IsPositiveInteger(*jsonRtpReorderDelayIt) ||
+				jsonRtpReorderDelayIt->get<uint32_t>() > RTC::RtpReorderBuffer::MaxDelay
+			)
+			// clang-format on
+			{
+				MS_THROW_TYPE_ERROR(
+				  "wrong rtpReorderDelay (must be between 0 and %" PRIu32 ")",
+				  RTC::RtpReorderBuffer::MaxDelay);
+			}
+
+			this->rtpReorderDelay = jsonRtpReorderDelayIt->get<uint32_t>();
+		}
+
+		auto jsonIngressPolicerIt = data.find("ingressPolicer");
+
+		if (jsonIngressPolicerIt != data.end() && !jsonIngressPolicerIt->is_null())
+		{
+			if (!jsonIngressPolicerIt->is_object())
+				MS_THROW_TYPE_ERROR("wrong ingressPolicer (not an object)");
+
+			uint32_t bitrate{ 0u };
+			uint32_t tupleBitrate{ 0u };
+			uint32_t burstMs{ RTC::IngressPolicer::DefaultBurstMs };
+			auto jsonBitrateIt      = jsonIngressPolicerIt->find("bitrate");
+			auto jsonTupleBitrateIt = jsonIngressPolicerIt->find("tupleBitrate");
+			auto jsonBurstMsIt      = jsonIngressPolicerIt->find("burstMs");
+
+			if (jsonBitrateIt != jsonIngressPolicerIt->end())
+			{
+				if (!Utils::Json::IsPositiveInteger(*jsonBitrateIt))
+					MS_THROW_TYPE_ERROR("wrong ingressPolicer.bitrate (not a number)");
+
+				bitrate = jsonBitrateIt->get<uint32_t>();
+			}
+
+			if (jsonTupleBitrateIt != jsonIngressPolicerIt->end())
+			{
+				if (!Utils::Json::IsPositiveInteger(*jsonTupleBitrateIt))
+					MS_THROW_TYPE_ERROR("wrong ingressPolicer.tupleBitrate (not a number)");
+
+				tupleBitrate = jsonTupleBitrateIt->get<uint32_t>();
+			}
+
+			if (jsonBurstMsIt != jsonIngressPolicerIt->end())
+			{
+				// clang-format off
+				if (
+					!Utils::Json::IsPositiveInteger(*jsonBurstMsIt) ||
+					jsonBurstMsIt->get<uint32_t>() == 0u
+				)
+				// clang-format on
+				{
+					MS_THROW_TYPE_ERROR("wrong ingressPolicer.burstMs (not a positive number)");
+				}
+
+				burstMs = jsonBurstMsIt->get<uint32_t>();
+			}
+
+			this->ingressPolicer.Configure(bitrate, tupleBitrate, burstMs);
+		}
+
 		auto jsonEnableSctpIt = data.find("enableSctp");
 
 		// clang-format off
@@ -95,6 +180,7 @@ namespace RTC
 			auto jsonMaxSctpMessageSizeIt = data.find("maxSctpMessageSize");
 			auto jsonSctpSendBufferSizeIt = data.find("sctpSendBufferSize");
 			auto jsonIsDataChannelIt      = data.find("isDataChannel");
+			auto jsonSctpBitrateShareIt   = data.find("sctpBitrateShare");
 
 			// numSctpStreams is mandatory.
 			// clang-format off
@@ -167,13 +253,52 @@ namespace RTC
 			if (jsonIsDataChannelIt != data.end() && jsonIsDataChannelIt->is_boolean())
 				isDataChannel = jsonIsDataChannelIt->get<bool>();
 
+			// sctpBitrateShare is optional.
+			if (jsonSctpBitrateShareIt != data.end())
+			{
+				// clang-format off
+				if (
+					!jsonSctpBitrateShareIt->is_number() ||
+					jsonSctpBitrateShareIt->get<float>() < 0 ||
+					jsonSctpBitrateShareIt->get<float>() > 1
+				)
+				// clang-format on
+				{
+					MS_THROW_TYPE_ERROR("wrong sctpBitrateShare (not a number between 0 and 1)");
+				}
+
+				this->sctpBitrateShare = jsonSctpBitrateShareIt->get<float>();
+			}
+
 			// This may throw.
 			this->sctpAssociation = new RTC::SctpAssociation(
 			  this, os, mis, this->maxMessageSize, sctpSendBufferSize, isDataChannel);
 		}
 
-		// Create the RTCP timer.
-		this->rtcpTimer = new Timer(this);
+		// Create the bitrate distribution timer.
+		this->bitrateDistributionTimer = new Timer(this);
+
+		// Create the RTCP feedback timer.
+		this->rtcpFeedbackTimer = new Timer(this);
+
+		// Measure the forwarding latency if enabled in the Worker.
+		if (Metrics::IsIngressTimeEnabled())
+			this->forwardingLatency = new RTC::ForwardingLatency();
+
+		// Limit the key frame requests sent to our Producers if enabled in the
+		// Worker, also within the budget of the Router (if any).
+		auto* routerKeyFrameRequestBudget = this->listener->OnTransportNeedKeyFrameRequestBudget(this);
+
+		// clang-format off
+		if (
+			Settings::configuration.maxKeyFrameRequestsPerTransport > 0u ||
+			routerKeyFrameRequestBudget
+		)
+		// clang-format on
+		{
+			this->keyFrameRequestBudget = new RTC::KeyFrameRequestScheduler::Budget(
+			  Settings::configuration.maxKeyFrameRequestsPerTransport, routerKeyFrameRequestBudget);
+		}
 	}
 
 	Transport::~Transport()
@@ -193,6 +318,7 @@ namespace RTC
 			delete producer;
 		}
 		this->mapProducers.clear();
+		this->producerHandles.Clear();
 
 		// Delete all Consumers.
 		for (auto& kv : this->mapConsumers)
@@ -202,6 +328,7 @@ namespace RTC
 			delete consumer;
 		}
 		this->mapConsumers.clear();
+		this->consumerHandles.Clear();
 		this->mapSsrcConsumer.clear();
 		this->mapRtxSsrcConsumer.clear();
 
@@ -227,9 +354,23 @@ namespace RTC
 		delete this->sctpAssociation;
 		this->sctpAssociation = nullptr;
 
-		// Delete the RTCP timer.
-		delete this->rtcpTimer;
-		this->rtcpTimer = nullptr;
+		// Stop scheduling RTCP.
+		RTC::RtcpScheduler::Unschedule(this);
+
+		// Delete the bitrate distribution timer.
+		delete this->bitrateDistributionTimer;
+		this->bitrateDistributionTimer = nullptr;
+
+		// Delete the RTCP feedback timer (pending feedback is discarded).
+		delete this->rtcpFeedbackTimer;
+		this->rtcpFeedbackTimer = nullptr;
+
+		// Delete the pacer.
+		delete this->pacer;
+		this->pacer = nullptr;
+
+		// Drop the packets waiting in the worker egress scheduler.
+		RTC::EgressScheduler::RemoveListener(this);
 
 		// Delete Transport-CC client.
 		delete this->tccClient;
@@ -239,14 +380,28 @@ namespace RTC
 		delete this->tccServer;
 		this->tccServer = nullptr;
 
-#ifdef ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
-		// Delete Sender BWE.
-		delete this->senderBwe;
-		this->senderBwe = nullptr;
-#endif
+		// Delete the TraceEventSampler.
+		delete this->traceEventSampler;
+		this->traceEventSampler = nullptr;
+
+		// Delete the PacketCapture.
+		delete this->packetCapture;
+		this->packetCapture = nullptr;
+
+		// Delete the ForwardingLatency.
+		delete this->forwardingLatency;
+		this->forwardingLatency = nullptr;
+
+		// Delete the key frame request budget (no Producer uses it anymore).
+		delete this->keyFrameRequestBudget;
+		this->keyFrameRequestBudget = nullptr;
+
+		// Delete the arena last since all objects allocated in it are gone now.
+		delete this->arena;
+		this->arena = nullptr;
 	}
 
-	void Transport::CloseProducersAndConsumers()
+	void Transport::CloseProducersAndConsumers(bool notifyConsumers)
 	{
 		MS_TRACE();
 
@@ -267,6 +422,7 @@ namespace RTC
 			delete producer;
 		}
 		this->mapProducers.clear();
+		this->producerHandles.Clear();
 
 		// Delete all Consumers.
 		for (auto& kv : this->mapConsumers)
@@ -274,11 +430,13 @@ namespace RTC
 			auto* consumer = kv.second;
 
 			// Notify the listener.
-			this->listener->OnTransportConsumerClosed(this, consumer);
+			if (notifyConsumers)
+				this->listener->OnTransportConsumerClosed(this, consumer);
 
 			delete consumer;
 		}
 		this->mapConsumers.clear();
+		this->consumerHandles.Clear();
 		this->mapSsrcConsumer.clear();
 		this->mapRtxSsrcConsumer.clear();
 
@@ -307,6 +465,49 @@ namespace RTC
 		this->mapDataConsumers.clear();
 	}
 
+	void Transport::ListenServerClosed()
+	{
+		MS_TRACE();
+
+		// Ask our parent Router to close/delete us.
+		this->listener->OnTransportListenServerClosed(this);
+	}
+
+	void Transport::FillJsonState(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		FillJson(jsonObject);
+
+		// Add producers.
+		jsonObject["producers"] = json::array();
+		auto jsonProducersIt    = jsonObject.find("producers");
+
+		for (const auto& kv : this->mapProducers)
+		{
+			const auto* producer = kv.second;
+
+			jsonProducersIt->emplace_back(json::value_t::object);
+			producer->FillJson(jsonProducersIt->back());
+		}
+
+		// Add consumers.
+		jsonObject["consumers"] = json::array();
+		auto jsonConsumersIt    = jsonObject.find("consumers");
+
+		for (const auto& kv : this->mapConsumers)
+		{
+			const auto* consumer = kv.second;
+
+			jsonConsumersIt->emplace_back(json::value_t::object);
+
+			auto& jsonConsumer = jsonConsumersIt->back();
+
+			consumer->FillJson(jsonConsumer);
+			consumer->FillJsonSendState(jsonConsumer["sendState"]);
+		}
+	}
+
 	void Transport::FillJson(json& jsonObject) const
 	{
 		MS_TRACE();
@@ -314,6 +515,9 @@ namespace RTC
 		// Add id.
 		jsonObject["id"] = this->id;
 
+		// Add handle.
+		jsonObject["handle"] = this->handle;
+
 		// Add direct.
 		jsonObject["direct"] = this->direct;
 
@@ -411,6 +615,10 @@ namespace RTC
 		// Add maxMessageSize.
 		jsonObject["maxMessageSize"] = this->maxMessageSize;
 
+		// Add rtpReorderDelay.
+		if (this->rtpReorderDelay > 0u)
+			jsonObject["rtpReorderDelay"] = this->rtpReorderDelay;
+
 		if (this->sctpAssociation)
 		{
 			// Add sctpParameters.
@@ -459,6 +667,14 @@ namespace RTC
 		}
 
 		jsonObject["traceEventTypes"] = traceEventTypesStream.str();
+
+		// Add trace event sampling options and buffered events.
+		if (this->traceEventSampler)
+			this->traceEventSampler->FillJson(jsonObject);
+
+		// Add packetCapture.
+		if (this->packetCapture)
+			this->packetCapture->FillJson(jsonObject["packetCapture"]);
 	}
 
 	void Transport::FillJsonStats(json& jsonArray)
@@ -560,12 +776,188 @@ namespace RTC
 		// Add packetLossSent.
 		if (this->tccClient)
 			jsonObject["rtpPacketLossSent"] = this->tccClient->GetPacketLoss();
+
+		// Add ecnCePacketsReceived and ecnCePacketsSent.
+		if (Settings::configuration.ecn)
+		{
+			if (this->tccServer)
+				jsonObject["ecnCePacketsReceived"] = this->tccServer->GetEcnCePackets();
+
+			if (this->tccClient)
+				jsonObject["ecnCePacketsSent"] = this->tccClient->GetEcnCePackets();
+		}
+
+		// Add forwardingLatency.
+		if (this->forwardingLatency)
+			this->forwardingLatency->FillJson(jsonObject["forwardingLatency"]);
+
+		// Add cpuMsPerSecond.
+		jsonObject["cpuMsPerSecond"] = this->cpuUsage.GetMsPerSecond(nowMs);
+	}
+
+	void Transport::SetOverloadLevel(OverloadController::Level level)
+	{
+		MS_TRACE();
+
+		for (auto& kv : this->mapConsumers)
+		{
+			auto* consumer = kv.second;
+
+			consumer->SetOverloadLevel(level);
+		}
+	}
+
+	size_t Transport::FillJsonMemoryUsage(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		size_t memoryUsage{ 0u };
+
+		// Add producers.
+		jsonObject["producers"] = json::object();
+		auto jsonProducersIt    = jsonObject.find("producers");
+
+		for (const auto& kv : this->mapProducers)
+		{
+			auto* producer           = kv.second;
+			auto producerMemoryUsage = producer->GetMemoryUsage();
+
+			(*jsonProducersIt)[producer->id] = producerMemoryUsage;
+			memoryUsage += producerMemoryUsage;
+		}
+
+		// Add consumers.
+		jsonObject["consumers"] = json::object();
+		auto jsonConsumersIt    = jsonObject.find("consumers");
+
+		for (const auto& kv : this->mapConsumers)
+		{
+			auto* consumer           = kv.second;
+			auto consumerMemoryUsage = consumer->GetMemoryUsage();
+
+			(*jsonConsumersIt)[consumer->id] = consumerMemoryUsage;
+			memoryUsage += consumerMemoryUsage;
+		}
+
+		// Add sctp.
+		if (this->sctpAssociation)
+		{
+			auto sctpMemoryUsage = this->sctpAssociation->GetMemoryUsage();
+
+			jsonObject["sctp"] = sctpMemoryUsage;
+			memoryUsage += sctpMemoryUsage;
+		}
+
+		// Add pacer.
+		if (this->pacer)
+		{
+			auto pacerMemoryUsage = this->pacer->GetMemoryUsage();
+
+			jsonObject["pacer"] = pacerMemoryUsage;
+			memoryUsage += pacerMemoryUsage;
+		}
+
+		// Add arena (not added to the total since it holds the objects above).
+		if (this->arena)
+			this->arena->FillJson(jsonObject["arena"]);
+
+		// Add bytes.
+		jsonObject["bytes"] = memoryUsage;
+
+		return memoryUsage;
+	}
+
+	size_t Transport::GetMemoryUsage() const
+	{
+		MS_TRACE();
+
+		size_t memoryUsage{ 0u };
+
+		for (const auto& kv : this->mapProducers)
+		{
+			auto* producer = kv.second;
+
+			memoryUsage += producer->GetMemoryUsage();
+		}
+
+		for (const auto& kv : this->mapConsumers)
+		{
+			auto* consumer = kv.second;
+
+			memoryUsage += consumer->GetMemoryUsage();
+		}
+
+		if (this->sctpAssociation)
+			memoryUsage += this->sctpAssociation->GetMemoryUsage();
+
+		if (this->pacer)
+			memoryUsage += this->pacer->GetMemoryUsage();
+
+		return memoryUsage;
+	}
+
+	void Transport::SetMemoryPressure(bool memoryPressure)
+	{
+		MS_TRACE();
+
+		for (auto& kv : this->mapConsumers)
+		{
+			auto* consumer = kv.second;
+
+			consumer->SetMemoryPressure(memoryPressure);
+		}
+	}
+
+	void Transport::FillStatsRecords(StatsRegion* statsRegion, uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		auto* record = statsRegion->AddRecord(StatsRegion::RecordType::TRANSPORT, this->id, this->id);
+
+		if (!record)
+			return;
+
+		record->bytesReceived  = this->recvTransmission.GetBytes();
+		record->recvBitrate    = this->recvTransmission.GetRate(nowMs);
+		record->bytesSent      = this->sendTransmission.GetBytes();
+		record->sendBitrate    = this->sendTransmission.GetRate(nowMs);
+		record->rtpRecvBitrate = this->recvRtpTransmission.GetBitrate(nowMs);
+		record->rtpSendBitrate = this->sendRtpTransmission.GetBitrate(nowMs);
+
+		if (this->tccClient)
+		{
+			record->availableOutgoingBitrate = this->tccClient->GetAvailableBitrate();
+			record->rtpPacketLossSent        = static_cast<float>(this->tccClient->GetPacketLoss());
+		}
+
+		if (this->tccServer)
+		{
+			record->availableIncomingBitrate = this->tccServer->GetAvailableBitrate();
+			record->rtpPacketLossReceived    = static_cast<float>(this->tccServer->GetPacketLoss());
+		}
+
+		for (auto& kv : this->mapProducers)
+		{
+			auto* producer = kv.second;
+
+			producer->FillStatsRecords(statsRegion, this->id, nowMs);
+		}
+
+		for (auto& kv : this->mapConsumers)
+		{
+			auto* consumer = kv.second;
+
+			consumer->FillStatsRecords(statsRegion, this->id, nowMs);
+		}
 	}
 
 	void Transport::HandleRequest(Channel::ChannelRequest* request)
 	{
 		MS_TRACE();
 
+		// Producers and Consumers (and their streams) are created here.
+		RTC::TransportArena::Scope arenaScope(this->arena);
+
 		switch (request->methodId)
 		{
 			case Channel::ChannelRequest::MethodId::TRANSPORT_DUMP:
@@ -585,7 +977,21 @@ namespace RTC
 
 				FillJsonStats(data);
 
-				request->Accept(data);
+				auto jsonCursorIt = request->data.find("cursor");
+
+				// Just changed stats requested.
+				if (jsonCursorIt != request->data.end() && jsonCursorIt->is_number_unsigned())
+				{
+					json jsonDelta = json::object();
+
+					this->statsDelta.FillJson(jsonDelta, data, jsonCursorIt->get<uint64_t>());
+
+					request->Accept(jsonDelta);
+				}
+				else
+				{
+					request->Accept(data);
+				}
 
 				break;
 			}
@@ -650,6 +1056,32 @@ namespace RTC
 				break;
 			}
 
+			case Channel::ChannelRequest::MethodId::TRANSPORT_SET_BWE_HINT:
+			{
+				auto jsonBitrateIt = request->data.find("bitrate");
+
+				// clang-format off
+				if (
+					jsonBitrateIt == request->data.end() ||
+					!Utils::Json::IsPositiveInteger(*jsonBitrateIt)
+				)
+				// clang-format on
+				{
+					MS_THROW_TYPE_ERROR("missing bitrate");
+				}
+
+				this->bweHint = jsonBitrateIt->get<uint32_t>();
+
+				MS_DEBUG_TAG(bwe, "outgoing bitrate hint set to %" PRIu32, this->bweHint);
+
+				if (this->tccClient)
+					MaySetInitialAvailableOutgoingBitrate();
+
+				request->Accept();
+
+				break;
+			}
+
 			case Channel::ChannelRequest::MethodId::TRANSPORT_PRODUCE:
 			{
 				std::string producerId;
@@ -660,6 +1092,9 @@ namespace RTC
 				// This may throw.
 				auto* producer = new RTC::Producer(producerId, this, request->data);
 
+				producer->SetKeyFrameRequestBudget(this->keyFrameRequestBudget);
+				producer->SetRtpReorderDelay(this->rtpReorderDelay);
+
 				// Insert the Producer into the RtpListener.
 				// This may throw. If so, delete the Producer and throw.
 				try
@@ -690,6 +1125,7 @@ namespace RTC
 
 				// Insert into the map.
 				this->mapProducers[producerId] = producer;
+				producer->handle               = this->producerHandles.Add(producer);
 
 				MS_DEBUG_DEV("Producer created [producerId:%s]", producerId.c_str());
 
@@ -728,7 +1164,8 @@ namespace RTC
 				// Create status response.
 				json data = json::object();
 
-				data["type"] = RTC::RtpParameters::GetTypeString(producer->GetType());
+				data["type"]   = RTC::RtpParameters::GetTypeString(producer->GetType());
+				data["handle"] = producer->handle;
 
 				request->Accept(data);
 
@@ -888,6 +1325,8 @@ namespace RTC
 
 				// Insert into the maps.
 				this->mapConsumers[consumerId] = consumer;
+				consumer->handle               = this->consumerHandles.Add(consumer);
+				this->bitrateConsumersDirty    = true;
 
 				for (auto ssrc : consumer->GetMediaSsrcs())
 				{
@@ -899,6 +1338,10 @@ namespace RTC
 					this->mapRtxSsrcConsumer[ssrc] = consumer;
 				}
 
+				// Apply the current overload level (if any).
+				if (OverloadController::GetLevel() != OverloadController::Level::NONE)
+					consumer->SetOverloadLevel(OverloadController::GetLevel());
+
 				MS_DEBUG_DEV(
 				  "Consumer created [consumerId:%s, producerId:%s]", consumerId.c_str(), producerId.c_str());
 
@@ -907,6 +1350,7 @@ namespace RTC
 
 				data["paused"]         = consumer->IsPaused();
 				data["producerPaused"] = consumer->IsProducerPaused();
+				data["handle"]         = consumer->handle;
 
 				consumer->FillJsonScore(data["score"]);
 
@@ -996,8 +1440,14 @@ namespace RTC
 						this->tccClient = new RTC::TransportCongestionControlClient(
 						  this, bweType, this->initialAvailableOutgoingBitrate, this->maxOutgoingBitrate);
 
+						MaySetInitialAvailableOutgoingBitrate();
+
 						if (IsConnected())
 							this->tccClient->TransportConnected();
+
+						// Pace the sent media according to the estimated bandwidth.
+						this->pacer = new RTC::Pacer(
+						  this, this->initialAvailableOutgoingBitrate, this->sctpBitrateShare);
 					}
 				}
 
@@ -1006,53 +1456,6 @@ namespace RTC
 				if (this->tccClient)
 					consumer->SetExternallyManagedBitrate();
 
-#ifdef ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
-				// Create SenderBandwidthEstimator if:
-				// - not already created,
-				// - it's a video Consumer, and
-				// - there is transport-wide-cc-01 RTP header extension, and
-				// - there is "transport-cc" in codecs RTCP feedback.
-				//
-				// clang-format off
-				if (
-					!this->senderBwe &&
-					consumer->GetKind() == RTC::Media::Kind::VIDEO &&
-					rtpHeaderExtensionIds.transportWideCc01 != 0u &&
-					std::any_of(
-						codecs.begin(), codecs.end(), [](const RTC::RtpCodecParameters& codec)
-						{
-							return std::any_of(
-								codec.rtcpFeedback.begin(), codec.rtcpFeedback.end(), [](const RTC::RtcpFeedback& fb)
-								{
-									return fb.type == "transport-cc";
-								});
-						})
-				)
-				// clang-format on
-				{
-					MS_DEBUG_TAG(bwe, "enabling SenderBandwidthEstimator");
-
-					// Tell all the Consumers that we are gonna manage their bitrate.
-					for (auto& kv : this->mapConsumers)
-					{
-						auto* consumer = kv.second;
-
-						consumer->SetExternallyManagedBitrate();
-					};
-
-					this->senderBwe =
-					  new RTC::SenderBandwidthEstimator(this, this->initialAvailableOutgoingBitrate);
-
-					if (IsConnected())
-						this->senderBwe->TransportConnected();
-				}
-
-				// If applicable, tell the new Consumer that we are gonna manage its
-				// bitrate.
-				if (this->senderBwe)
-					consumer->SetExternallyManagedBitrate();
-#endif
-
 				if (IsConnected())
 					consumer->TransportConnected();
 
@@ -1280,13 +1683,84 @@ namespace RTC
 						newTraceEventTypes.bwe = true;
 				}
 
-				this->traceEventTypes = newTraceEventTypes;
+				// This may throw.
+				auto* traceEventSampler = RTC::TraceEventSampler::Create(this->id, request->data);
+
+				delete this->traceEventSampler;
+
+				this->traceEventTypes   = newTraceEventTypes;
+				this->traceEventSampler = traceEventSampler;
 
 				request->Accept();
 
 				break;
 			}
 
+			case Channel::ChannelRequest::MethodId::TRANSPORT_ENABLE_PACKET_CAPTURE:
+			{
+				// This may throw.
+				auto* packetCapture = RTC::PacketCapture::Create(request->data);
+
+				// Packets captured so far are discarded.
+				delete this->packetCapture;
+
+				this->packetCapture = packetCapture;
+
+				request->Accept();
+
+				break;
+			}
+
+			case Channel::ChannelRequest::MethodId::TRANSPORT_DISABLE_PACKET_CAPTURE:
+			{
+				delete this->packetCapture;
+				this->packetCapture = nullptr;
+
+				request->Accept();
+
+				break;
+			}
+
+			case Channel::ChannelRequest::MethodId::TRANSPORT_DUMP_PACKET_CAPTURE:
+			{
+				if (!this->packetCapture)
+					MS_THROW_ERROR("packet capture not enabled");
+
+				auto jsonPathIt = request->data.find("path");
+				json data       = json::object();
+
+				data["packetCount"] = this->packetCapture->GetPacketCount();
+
+				// Write the pcap into the given file, otherwise give it in base64.
+				if (jsonPathIt != request->data.end())
+				{
+					// clang-format off
+					if (
+						!jsonPathIt->is_string() ||
+						jsonPathIt->get<std::string>().empty()
+					)
+					// clang-format on
+					{
+						MS_THROW_TYPE_ERROR("wrong path (not a non empty string)");
+					}
+
+					// This may throw.
+					this->packetCapture->WritePcap(jsonPathIt->get<std::string>());
+				}
+				else
+				{
+					std::vector<uint8_t> pcap;
+
+					this->packetCapture->SerializePcap(pcap);
+
+					data["pcap"] = Utils::String::Base64Encode(pcap.data(), pcap.size());
+				}
+
+				request->Accept(data);
+
+				break;
+			}
+
 			case Channel::ChannelRequest::MethodId::PRODUCER_CLOSE:
 			{
 				// This may throw.
@@ -1297,6 +1771,7 @@ namespace RTC
 
 				// Remove it from the map.
 				this->mapProducers.erase(producer->id);
+				this->producerHandles.Remove(producer->handle);
 
 				// Tell the child class to clear associated SSRCs.
 				for (const auto& kv : producer->GetRtpStreams())
@@ -1329,6 +1804,14 @@ namespace RTC
 
 				// Remove it from the maps.
 				this->mapConsumers.erase(consumer->id);
+				this->consumerHandles.Remove(consumer->handle);
+				this->bitrateConsumersDirty = true;
+
+				// Drop its packets waiting to be paced.
+				if (this->pacer)
+					this->pacer->RemoveConsumer(consumer);
+				else
+					RTC::EgressScheduler::RemoveConsumer(consumer);
 
 				for (auto ssrc : consumer->GetMediaSsrcs())
 				{
@@ -1363,6 +1846,35 @@ namespace RTC
 				break;
 			}
 
+			case Channel::ChannelRequest::MethodId::TRANSPORT_CONSUME_MANY:
+			{
+				HandleBatchRequest(request, Channel::ChannelRequest::MethodId::TRANSPORT_CONSUME);
+
+				break;
+			}
+
+			case Channel::ChannelRequest::MethodId::TRANSPORT_PAUSE_CONSUMERS:
+			{
+				HandleBatchRequest(request, Channel::ChannelRequest::MethodId::CONSUMER_PAUSE);
+
+				break;
+			}
+
+			case Channel::ChannelRequest::MethodId::TRANSPORT_RESUME_CONSUMERS:
+			{
+				HandleBatchRequest(request, Channel::ChannelRequest::MethodId::CONSUMER_RESUME);
+
+				break;
+			}
+
+			case Channel::ChannelRequest::MethodId::TRANSPORT_SET_CONSUMERS_PREFERRED_LAYERS:
+			{
+				HandleBatchRequest(
+				  request, Channel::ChannelRequest::MethodId::CONSUMER_SET_PREFERRED_LAYERS);
+
+				break;
+			}
+
 			case Channel::ChannelRequest::MethodId::PRODUCER_DUMP:
 			case Channel::ChannelRequest::MethodId::PRODUCER_GET_STATS:
 			case Channel::ChannelRequest::MethodId::PRODUCER_PAUSE:
@@ -1382,15 +1894,21 @@ namespace RTC
 			case Channel::ChannelRequest::MethodId::CONSUMER_PAUSE:
 			case Channel::ChannelRequest::MethodId::CONSUMER_RESUME:
 			case Channel::ChannelRequest::MethodId::CONSUMER_SET_PREFERRED_LAYERS:
+			case Channel::ChannelRequest::MethodId::CONSUMER_SET_LAYER_DEMAND:
 			case Channel::ChannelRequest::MethodId::CONSUMER_SET_PRIORITY:
 			case Channel::ChannelRequest::MethodId::CONSUMER_REQUEST_KEY_FRAME:
 			case Channel::ChannelRequest::MethodId::CONSUMER_ENABLE_TRACE_EVENT:
+			case Channel::ChannelRequest::MethodId::CONSUMER_EXPORT_SEND_STATE:
 			{
 				// This may throw.
 				RTC::Consumer* consumer = GetConsumerFromInternal(request->internal);
 
 				consumer->HandleRequest(request);
 
+				// Consumers are sorted by priority for bitrate distribution.
+				if (request->methodId == Channel::ChannelRequest::MethodId::CONSUMER_SET_PRIORITY)
+					this->bitrateConsumersDirty = true;
+
 				break;
 			}
 
@@ -1523,6 +2041,69 @@ namespace RTC
 		}
 	}
 
+	void Transport::HandleBatchRequest(
+	  Channel::ChannelRequest* request, Channel::ChannelRequest::MethodId itemMethodId)
+	{
+		MS_TRACE();
+
+		auto jsonItemsIt = request->data.find("items");
+
+		if (jsonItemsIt == request->data.end() || !jsonItemsIt->is_array())
+			MS_THROW_TYPE_ERROR("wrong items (not an array)");
+
+		// Validate all the items before handling any of them.
+		for (const auto& jsonItem : *jsonItemsIt)
+		{
+			if (!jsonItem.is_object())
+				MS_THROW_TYPE_ERROR("wrong item (not an object)");
+		}
+
+		auto results = std::make_shared<json>(json::array());
+		size_t itemIdx{ 0u };
+
+		// Each item is handled as a standalone request whose response (or error)
+		// is collected, so a failing item does not abort the rest of the batch.
+		// Items are handled in steps so a big batch does not stop media
+		// forwarding meanwhile.
+		request->Defer(
+		  [this, request, itemMethodId, results, itemIdx]() mutable
+		  {
+			  auto& jsonItems = request->data["items"];
+
+			  if (itemIdx < jsonItems.size())
+			  {
+				  Channel::ChannelRequest itemRequest(
+				    request, itemMethodId, jsonItems[itemIdx++], *results);
+
+				  try
+				  {
+					  HandleRequest(std::addressof(itemRequest));
+				  }
+				  catch (const MediaSoupTypeError& error)
+				  {
+					  if (!itemRequest.replied)
+						  itemRequest.TypeError(error.what());
+				  }
+				  catch (const MediaSoupError& error)
+				  {
+					  if (!itemRequest.replied)
+						  itemRequest.Error(error.what());
+				  }
+
+				  if (itemIdx < jsonItems.size())
+					  return false;
+			  }
+
+			  json data = json::object();
+
+			  data["results"] = std::move(*results);
+
+			  request->Accept(data);
+
+			  return true;
+		  });
+	}
+
 	void Transport::HandleRequest(PayloadChannel::PayloadChannelRequest* request)
 	{
 		MS_TRACE();
@@ -1593,22 +2174,61 @@ namespace RTC
 		if (this->sctpAssociation)
 			this->sctpAssociation->TransportConnected();
 
-		// Start the RTCP timer.
-		this->rtcpTimer->Start(static_cast<uint64_t>(RTC::RTCP::MaxVideoIntervalMs / 2));
+		// Schedule the first RTCP round.
+		RTC::RtcpScheduler::Schedule(this, static_cast<uint64_t>(RTC::RTCP::MaxVideoIntervalMs / 2));
 
 		// Tell the TransportCongestionControlClient.
 		if (this->tccClient)
+		{
+			// The remote endpoint may be known just now.
+			MaySetInitialAvailableOutgoingBitrate();
+
 			this->tccClient->TransportConnected();
+		}
 
 		// Tell the TransportCongestionControlServer.
 		if (this->tccServer)
 			this->tccServer->TransportConnected();
+	}
+
+	void Transport::MaySetInitialAvailableOutgoingBitrate()
+	{
+		MS_TRACE();
+
+		// Prefer the hint given by the app over the last estimate of the remote
+		// endpoint.
+		uint32_t bitrate = this->bweHint;
+
+		if (bitrate == 0u && !this->bweCacheKey.empty())
+			bitrate = RTC::BweCache::Get(this->bweCacheKey);
 
-#ifdef ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
-		// Tell the SenderBandwidthEstimator.
-		if (this->senderBwe)
-			this->senderBwe->TransportConnected();
-#endif
+		if (bitrate == 0u)
+			return;
+
+		// NOTE: The Pacer follows once the estimation starts.
+		this->tccClient->SetInitialAvailableBitrate(bitrate);
+	}
+
+	void Transport::PathChanged(const struct sockaddr* remoteAddr)
+	{
+		MS_TRACE();
+
+		auto bweCacheKey = RTC::BweCache::GetKey(remoteAddr);
+
+		// Same network (f.e. just a NAT rebinding), so keep the estimation.
+		if (bweCacheKey == this->bweCacheKey)
+			return;
+
+		this->bweCacheKey = std::move(bweCacheKey);
+
+		if (!this->tccClient)
+			return;
+
+		// Prefer the last estimate of the new remote endpoint over the hint given
+		// by the app, which was meant for the initial path.
+		auto bitrate = this->bweCacheKey.empty() ? 0u : RTC::BweCache::Get(this->bweCacheKey);
+
+		this->tccClient->PathChanged(bitrate);
 	}
 
 	void Transport::Disconnected()
@@ -1631,28 +2251,51 @@ namespace RTC
 			dataConsumer->TransportDisconnected();
 		}
 
-		// Stop the RTCP timer.
-		this->rtcpTimer->Stop();
+		// Stop scheduling RTCP.
+		RTC::RtcpScheduler::Unschedule(this);
 
 		// Tell the TransportCongestionControlClient.
 		if (this->tccClient)
 			this->tccClient->TransportDisconnected();
 
+		// Drop the packets waiting to be paced.
+		if (this->pacer)
+			this->pacer->Clear();
+		else
+			RTC::EgressScheduler::RemoveListener(this);
+
 		// Tell the TransportCongestionControlServer.
 		if (this->tccServer)
 			this->tccServer->TransportDisconnected();
-
-#ifdef ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
-		// Tell the SenderBandwidthEstimator.
-		if (this->senderBwe)
-			this->senderBwe->TransportDisconnected();
-#endif
 	}
 
-	void Transport::ReceiveRtpPacket(RTC::RtpPacket* packet)
+	void Transport::ReceiveRtpPacket(RTC::RtpPacket* packet, RTC::Producer* producer)
 	{
 		MS_TRACE();
 
+		Metrics::StageScope metricsScope(Metrics::Stage::TRANSPORT_RECEIVE_RTP);
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
+		// Producer RTP streams are created when their first packet is received.
+		RTC::TransportArena::Scope arenaScope(this->arena);
+
+		MS_TRACEPOINT(
+		  rtp_received,
+		  this->id.c_str(),
+		  packet->GetSsrc(),
+		  packet->GetSequenceNumber(),
+		  packet->GetSize());
+
+		MayCaptureRtpPacket(RTC::PacketCapture::Direction::IN, packet);
+
+		// Stamp it with the time its data was read (unless it's a clone sent by a
+		// PipeTransport of this worker).
+		if (packet->GetIngressTime() == 0u)
+			packet->SetIngressTime(Metrics::GetIngressTime());
+
+		// Also with the time the kernel received it if known.
+		if (packet->GetArrivalTime() == 0u)
+			packet->SetArrivalTime(UdpSocketHandler::GetRecvTime());
+
 		// Apply the Transport RTP header extension ids so the RTP listener can use them.
 		packet->SetMidExtensionId(this->recvRtpHeaderExtensionIds.mid);
 		packet->SetRidExtensionId(this->recvRtpHeaderExtensionIds.rid);
@@ -1660,14 +2303,22 @@ namespace RTC
 		packet->SetAbsSendTimeExtensionId(this->recvRtpHeaderExtensionIds.absSendTime);
 		packet->SetTransportWideCc01ExtensionId(this->recvRtpHeaderExtensionIds.transportWideCc01);
 
-		auto nowMs = DepLibUV::GetTimeMs();
-
 		// Feed the TransportCongestionControlServer.
 		if (this->tccServer)
-			this->tccServer->IncomingPacket(nowMs, packet);
+		{
+			const uint64_t arrivalMs =
+			  packet->GetArrivalTime() != 0u ? packet->GetArrivalTime() : DepLibUV::GetTimeMs();
+
+			this->tccServer->IncomingPacket(arrivalMs, packet);
+
+			// Also with the ECN codepoint the packet was received with, if known.
+			if (UdpSocketHandler::GetRecvEcn() >= 0)
+				this->tccServer->IncomingEcn(arrivalMs, packet, UdpSocketHandler::GetRecvEcn());
+		}
 
-		// Get the associated Producer.
-		RTC::Producer* producer = this->rtpListener.GetProducer(packet);
+		// Get the associated Producer (unless already known by the child class).
+		if (!producer)
+			producer = this->rtpListener.GetProducer(packet);
 
 		if (!producer)
 		{
@@ -1716,6 +2367,8 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
+
 		// Handle each RTCP packet.
 		while (packet)
 		{
@@ -1763,6 +2416,17 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		// Numeric handle given at creation, if any.
+		auto jsonProducerHandleIt = internal.find("producerHandle");
+
+		if (jsonProducerHandleIt != internal.end() && jsonProducerHandleIt->is_number_unsigned())
+		{
+			auto* producer = this->producerHandles.Get(jsonProducerHandleIt->get<uint32_t>());
+
+			if (producer)
+				return producer;
+		}
+
 		auto jsonProducerIdIt = internal.find("producerId");
 
 		if (jsonProducerIdIt == internal.end() || !jsonProducerIdIt->is_string())
@@ -1797,6 +2461,17 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		// Numeric handle given at creation, if any.
+		auto jsonConsumerHandleIt = internal.find("consumerHandle");
+
+		if (jsonConsumerHandleIt != internal.end() && jsonConsumerHandleIt->is_number_unsigned())
+		{
+			auto* consumer = this->consumerHandles.Get(jsonConsumerHandleIt->get<uint32_t>());
+
+			if (consumer)
+				return consumer;
+		}
+
 		auto jsonConsumerIdIt = internal.find("consumerId");
 
 		if (jsonConsumerIdIt == internal.end() || !jsonConsumerIdIt->is_string())
@@ -2147,6 +2822,10 @@ namespace RTC
 							break;
 						}
 
+						// Nothing is retransmitted while overloaded.
+						if (OverloadController::ShedNack())
+							break;
+
 						auto* nackPacket = static_cast<RTC::RTCP::FeedbackRtpNackPacket*>(packet);
 
 						consumer->ReceiveNack(nackPacket);
@@ -2161,11 +2840,15 @@ namespace RTC
 						if (this->tccClient)
 							this->tccClient->ReceiveRtcpTransportFeedback(feedback);
 
-#ifdef ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
-						// Pass it to the SenderBandwidthEstimator client.
-						if (this->senderBwe)
-							this->senderBwe->ReceiveRtcpTransportFeedback(feedback);
-#endif
+						break;
+					}
+
+					case RTC::RTCP::FeedbackRtp::MessageType::ECN:
+					{
+						auto* feedback = static_cast<RTC::RTCP::FeedbackRtpEcnPacket*>(packet);
+
+						if (this->tccClient)
+							this->tccClient->ReceiveRtcpEcnFeedback(feedback);
 
 						break;
 					}
@@ -2305,7 +2988,8 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		std::unique_ptr<RTC::RTCP::CompoundPacket> packet{ nullptr };
+		Metrics::StageScope metricsScope(Metrics::Stage::SEND_RTCP);
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
 
 		for (auto& kv : this->mapConsumers)
 		{
@@ -2313,36 +2997,65 @@ namespace RTC
 
 			for (auto* rtpStream : consumer->GetRtpStreams())
 			{
-				// Reset the Compound packet.
-				packet.reset(new RTC::RTCP::CompoundPacket());
+				// Idle (i.e. paused) streams have no Sender Report to send, so don't
+				// even build a compound packet for them.
+				if (!rtpStream->HasSentSinceLastSenderReport())
+					continue;
+
+				// RTCP objects of each compound packet are built in the arena and
+				// released all together once sent.
+				RTC::RTCP::Arena::Scope arenaScope;
+				std::unique_ptr<RTC::RTCP::CompoundPacket> packet{ nullptr };
+
+				{
+					RTC::RTCP::Arena::AllocationScope allocationScope;
+
+					packet.reset(new RTC::RTCP::CompoundPacket());
 
-				consumer->GetRtcp(packet.get(), rtpStream, nowMs);
+					consumer->GetRtcp(packet.get(), rtpStream, nowMs);
+				}
 
 				// Send the RTCP compound packet if there is a sender report.
 				if (packet->HasSenderReport())
 				{
 					packet->Serialize(RTC::RTCP::Buffer);
+					MayCaptureRtcpPacket(
+					  RTC::PacketCapture::Direction::OUT, packet->GetData(), packet->GetSize());
 					SendRtcpCompoundPacket(packet.get());
 				}
 			}
 		}
 
-		// Reset the Compound packet.
-		packet.reset(new RTC::RTCP::CompoundPacket());
+		RTC::RTCP::Arena::Scope arenaScope;
+		std::unique_ptr<RTC::RTCP::CompoundPacket> packet{ nullptr };
+
+		{
+			RTC::RTCP::Arena::AllocationScope allocationScope;
+
+			packet.reset(new RTC::RTCP::CompoundPacket());
+		}
 
 		for (auto& kv : this->mapProducers)
 		{
 			auto* producer = kv.second;
 
-			producer->GetRtcp(packet.get(), nowMs);
+			{
+				RTC::RTCP::Arena::AllocationScope allocationScope;
+
+				producer->GetRtcp(packet.get(), nowMs);
+			}
 
 			// One more RR would exceed the MTU, send the compound packet now.
 			if (packet->GetSize() + sizeof(RTCP::ReceiverReport::Header) > RTC::MtuSize)
 			{
 				packet->Serialize(RTC::RTCP::Buffer);
+				MayCaptureRtcpPacket(
+				  RTC::PacketCapture::Direction::OUT, packet->GetData(), packet->GetSize());
 				SendRtcpCompoundPacket(packet.get());
 
 				// Reset the Compound packet.
+				RTC::RTCP::Arena::AllocationScope allocationScope;
+
 				packet.reset(new RTC::RTCP::CompoundPacket());
 			}
 		}
@@ -2350,52 +3063,152 @@ namespace RTC
 		if (packet->GetReceiverReportCount() != 0u)
 		{
 			packet->Serialize(RTC::RTCP::Buffer);
+			MayCaptureRtcpPacket(
+			  RTC::PacketCapture::Direction::OUT, packet->GetData(), packet->GetSize());
 			SendRtcpCompoundPacket(packet.get());
 		}
 	}
 
+	void Transport::QueueRtcpFeedbackPacket(RTC::RTCP::Packet* packet)
+	{
+		MS_TRACE();
+
+		const size_t len = packet->GetSize();
+
+		if (len > RtcpFeedbackBufferMaxLen)
+		{
+			MayCaptureRtcpPacket(RTC::PacketCapture::Direction::OUT, packet->GetData(), len);
+			SendRtcpPacket(packet);
+
+			return;
+		}
+
+		if (this->rtcpFeedbackBufferLen + len > RtcpFeedbackBufferMaxLen)
+			SendRtcpFeedbackPackets();
+
+		// NOTE: The packet has already been serialized by its sender.
+		std::memcpy(this->rtcpFeedbackBuffer + this->rtcpFeedbackBufferLen, packet->GetData(), len);
+
+		this->rtcpFeedbackBufferLen += len;
+
+		// Let feedback packets sent in this tick (i.e. NACKs and key frame
+		// requests of other Producers or REMB) join the compound packet, so it
+		// takes a single SRTCP operation and a single datagram.
+		if (!this->rtcpFeedbackTimer->IsActive())
+			this->rtcpFeedbackTimer->Start(0u);
+	}
+
+	void Transport::SendRtcpFeedbackPackets()
+	{
+		MS_TRACE();
+
+		this->rtcpFeedbackTimer->Stop();
+
+		if (this->rtcpFeedbackBufferLen == 0u)
+			return;
+
+		RTC::RTCP::Arena::Scope arenaScope;
+		std::unique_ptr<RTC::RTCP::CompoundPacket> packet{ nullptr };
+
+		{
+			RTC::RTCP::Arena::AllocationScope allocationScope;
+
+			packet.reset(new RTC::RTCP::CompoundPacket());
+		}
+
+		packet->AddSerializedPackets(this->rtcpFeedbackBuffer, this->rtcpFeedbackBufferLen);
+		packet->Serialize(RTC::RTCP::Buffer);
+		MayCaptureRtcpPacket(RTC::PacketCapture::Direction::OUT, packet->GetData(), packet->GetSize());
+		SendRtcpCompoundPacket(packet.get());
+
+		this->rtcpFeedbackBufferLen = 0u;
+	}
+
+	void Transport::MayDistributeAvailableOutgoingBitrate(bool forceBitrate)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(this->tccClient, "no TransportCongestionClient");
+
+		if (forceBitrate)
+			this->pendingForceDesiredBitrate = true;
+
+		// Already scheduled.
+		if (this->bitrateDistributionTimer->IsActive())
+			return;
+
+		auto elapsedMs = DepLibUV::GetTimeMs() - this->lastBitrateDistributionAtMs;
+
+		// Coalesce changes of many Consumers (i.e. when a Producer consumed by all
+		// of them changes its layers) into a single distribution.
+		if (elapsedMs < BitrateDistributionMinIntervalMs)
+		{
+			this->bitrateDistributionTimer->Start(BitrateDistributionMinIntervalMs - elapsedMs);
+
+			return;
+		}
+
+		DistributeAvailableOutgoingBitrate();
+		ComputeOutgoingDesiredBitrate();
+	}
+
 	void Transport::DistributeAvailableOutgoingBitrate()
 	{
 		MS_TRACE();
 
 		MS_ASSERT(this->tccClient, "no TransportCongestionClient");
 
-		std::multimap<uint8_t, RTC::Consumer*> multimapPriorityConsumer;
+		// A scheduled distribution is not needed anymore.
+		this->bitrateDistributionTimer->Stop();
 
-		// Fill the map with Consumers and their priority (if > 0).
-		for (auto& kv : this->mapConsumers)
+		UpdateBitrateConsumers();
+
+		// Fill the list with Consumers and their priority (if > 0).
+		this->increasingBitrateConsumers.clear();
+
+		for (auto* consumer : this->bitrateConsumers)
 		{
-			auto* consumer = kv.second;
-			auto priority  = consumer->GetBitratePriority();
+			auto priority = consumer->GetBitratePriority();
 
 			if (priority > 0u)
-				multimapPriorityConsumer.emplace(priority, consumer);
+				this->increasingBitrateConsumers.emplace_back(priority, consumer);
 		}
 
 		// Nobody wants bitrate. Exit.
-		if (multimapPriorityConsumer.empty())
+		if (this->increasingBitrateConsumers.empty())
 			return;
 
 		bool baseAllocation       = true;
 		uint32_t availableBitrate = this->tccClient->GetAvailableBitrate();
+		auto bweType              = this->tccClient->GetBweType();
 
 		this->tccClient->RescheduleNextAvailableBitrateEvent();
 
+		this->lastBitrateDistributionAtMs     = DepLibUV::GetTimeMs();
+		this->lastDistributedAvailableBitrate = availableBitrate;
+
 		MS_DEBUG_DEV("before layer-by-layer iterations [availableBitrate:%" PRIu32 "]", availableBitrate);
 
 		// Redistribute the available bitrate by allowing Consumers to increase
 		// layer by layer. Initially try to spread the bitrate across all
 		// consumers. Then allocate the excess bitrate to Consumers starting
 		// with the highest priorty.
-		while (availableBitrate > 0u)
+		//
+		// NOTE: A Consumer that cannot increase its layer given the available
+		// bitrate won't be able to do it later (since the available bitrate can
+		// just decrease), so it's removed from the list. Hence each iteration
+		// just visits Consumers that are still increasing.
+		size_t numIncreasingConsumers = this->increasingBitrateConsumers.size();
+
+		while (availableBitrate > 0u && numIncreasingConsumers > 0u)
 		{
-			auto previousAvailableBitrate = availableBitrate;
+			size_t numStillIncreasingConsumers{ 0u };
 
-			for (auto it = multimapPriorityConsumer.rbegin(); it != multimapPriorityConsumer.rend(); ++it)
+			for (size_t idx{ 0u }; idx < numIncreasingConsumers; ++idx)
 			{
-				auto priority  = it->first;
-				auto* consumer = it->second;
-				auto bweType   = this->tccClient->GetBweType();
+				auto priority  = this->increasingBitrateConsumers[idx].first;
+				auto* consumer = this->increasingBitrateConsumers[idx].second;
+				bool increased{ true };
 
 				for (uint8_t i{ 1u }; i <= (baseAllocation ? 1u : priority); ++i)
 				{
@@ -2417,25 +3230,33 @@ namespace RTC
 
 					// Exit the loop fast if used bitrate is 0.
 					if (usedBitrate == 0u)
+					{
+						increased = false;
+
 						break;
+					}
 				}
-			}
 
-			// If no Consumer used bitrate, exit the loop.
-			if (availableBitrate == previousAvailableBitrate)
-				break;
+				// Keep it (in the same order) for the next iteration.
+				if (increased)
+				{
+					std::swap(
+					  this->increasingBitrateConsumers[numStillIncreasingConsumers++],
+					  this->increasingBitrateConsumers[idx]);
+				}
+			}
 
-			baseAllocation = false;
+			numIncreasingConsumers = numStillIncreasingConsumers;
+			baseAllocation         = false;
 		}
 
 		MS_DEBUG_DEV("after layer-by-layer iterations [availableBitrate:%" PRIu32 "]", availableBitrate);
 
 		// Finally instruct Consumers to apply their computed layers.
-		for (auto it = multimapPriorityConsumer.rbegin(); it != multimapPriorityConsumer.rend(); ++it)
+		for (auto* consumer : this->bitrateConsumers)
 		{
-			auto* consumer = it->second;
-
-			consumer->ApplyLayers();
+			if (consumer->GetBitratePriority() > 0u)
+				consumer->ApplyLayers();
 		}
 	}
 
@@ -2455,9 +3276,52 @@ namespace RTC
 			totalDesiredBitrate += desiredBitrate;
 		}
 
+		// Also the bitrate of the SCTP packets paced along with the media.
+		if (this->sctpBitrateShare > 0)
+			totalDesiredBitrate += this->sctpSendTransmission.GetRate(DepLibUV::GetTimeMs());
+
 		MS_DEBUG_DEV("total desired bitrate: %" PRIu32, totalDesiredBitrate);
 
-		this->tccClient->SetDesiredBitrate(totalDesiredBitrate, forceBitrate);
+		// Also force it if requested by a Consumer since the latest call.
+		this->tccClient->SetDesiredBitrate(
+		  totalDesiredBitrate, forceBitrate || this->pendingForceDesiredBitrate);
+
+		this->pendingForceDesiredBitrate = false;
+	}
+
+	void Transport::UpdateBitrateConsumers()
+	{
+		MS_TRACE();
+
+		if (!this->bitrateConsumersDirty)
+			return;
+
+		this->bitrateConsumers.clear();
+
+		for (auto& kv : this->mapConsumers)
+		{
+			auto* consumer = kv.second;
+
+			this->bitrateConsumers.push_back(consumer);
+		}
+
+		std::stable_sort(
+		  this->bitrateConsumers.begin(),
+		  this->bitrateConsumers.end(),
+		  [](const RTC::Consumer* a, const RTC::Consumer* b)
+		  { return a->GetPriority() > b->GetPriority(); });
+
+		this->bitrateConsumersDirty = false;
+	}
+
+	inline void Transport::EmitTraceEvent(json& data) const
+	{
+		MS_TRACE();
+
+		if (this->traceEventSampler)
+			this->traceEventSampler->Emit(data);
+		else
+			Channel::ChannelNotifier::Emit(this->id, "trace", data);
 	}
 
 	inline void Transport::EmitTraceEventProbationType(RTC::RtpPacket* packet) const
@@ -2467,6 +3331,9 @@ namespace RTC
 		if (!this->traceEventTypes.probation)
 			return;
 
+		if (this->traceEventSampler && !this->traceEventSampler->Sample("probation", true))
+			return;
+
 		json data = json::object();
 
 		data["type"]      = "probation";
@@ -2475,7 +3342,7 @@ namespace RTC
 
 		packet->FillJson(data["info"]);
 
-		Channel::ChannelNotifier::Emit(this->id, "trace", data);
+		EmitTraceEvent(data);
 	}
 
 	inline void Transport::EmitTraceEventBweType(
@@ -2486,6 +3353,9 @@ namespace RTC
 		if (!this->traceEventTypes.bwe)
 			return;
 
+		if (this->traceEventSampler && !this->traceEventSampler->Sample("bwe"))
+			return;
+
 		json data = json::object();
 
 		data["type"]                            = "bwe";
@@ -2509,14 +3379,115 @@ namespace RTC
 				break;
 		}
 
-		Channel::ChannelNotifier::Emit(this->id, "trace", data);
+		if (this->traceEventSampler)
+			this->traceEventSampler->Emit(data);
+		else
+			Channel::ChannelNotifier::EmitBatched(this->id, "trace", data);
 	}
 
-	inline void Transport::OnProducerPaused(RTC::Producer* producer)
+	bool Transport::QueueConsumerRtpPacket(
+	  RTC::Consumer* consumer, RTC::RtpPacket* packet, bool retransmission)
 	{
 		MS_TRACE();
 
-		this->listener->OnTransportProducerPaused(this, producer);
+		if (this->pacer)
+			return this->pacer->QueuePacket(consumer, packet, retransmission);
+
+		// Packets of a DirectTransport do not leave through the NIC.
+		if (this->direct)
+			return false;
+
+		return RTC::EgressScheduler::QueuePacket(this, consumer, packet, retransmission);
+	}
+
+	void Transport::SendConsumerRtpPacket(
+	  RTC::Consumer* consumer, RTC::RtpPacket* packet, bool retransmission, uint64_t queuedAtNs)
+	{
+		MS_TRACE();
+
+		// Time at which the packet leaves the Pacer (if any). Retransmissions are
+		// not measured since they wait for the NACK.
+		uint64_t sendingAtNs{ 0u };
+
+		if (this->forwardingLatency && !retransmission && packet->GetIngressTime() != 0u)
+			sendingAtNs = DepLibUV::GetHighResTimeNs();
+
+		const uint64_t nowMs = DepLibUV::GetTimeMs();
+
+		// Update abs-send-time if present.
+		packet->UpdateAbsSendTime(nowMs);
+
+		// Update transport wide sequence number if present.
+		// clang-format off
+		if (
+			this->tccClient &&
+			this->tccClient->GetBweType() == RTC::BweType::TRANSPORT_CC &&
+			packet->UpdateTransportWideCc01(this->transportWideCcSeq + 1)
+		)
+		// clang-format on
+		{
+			this->transportWideCcSeq++;
+
+			auto* tccClient = this->tccClient;
+			webrtc::RtpPacketSendInfo packetInfo;
+
+			packetInfo.ssrc                      = packet->GetSsrc();
+			packetInfo.transport_sequence_number = this->transportWideCcSeq;
+			packetInfo.has_rtp_sequence_number   = true;
+			packetInfo.rtp_sequence_number       = packet->GetSequenceNumber();
+			packetInfo.length                    = packet->GetSize();
+			packetInfo.pacing_info               = this->tccClient->GetPacingInfo();
+
+			// Indicate the pacer (and prober) that a packet is to be sent.
+			this->tccClient->InsertPacket(packetInfo);
+
+			onSendCallback cb(
+			  [tccClient, &packetInfo](bool sent)
+			  {
+				  if (sent)
+					  tccClient->PacketSent(packetInfo, DepLibUV::GetHighResTimeMsInt64());
+			  });
+
+			MayCaptureRtpPacket(RTC::PacketCapture::Direction::OUT, packet);
+			SendRtpPacket(consumer, packet, &cb);
+		}
+		else
+		{
+			MayCaptureRtpPacket(RTC::PacketCapture::Direction::OUT, packet);
+			SendRtpPacket(consumer, packet);
+		}
+
+		if (!retransmission)
+		{
+			this->sendRtpTransmission.Update(packet);
+
+			consumer->RtpPacketSent(packet);
+		}
+		else
+		{
+			this->sendRtxTransmission.Update(packet);
+		}
+
+		if (sendingAtNs != 0u)
+		{
+			auto sentAtNs   = DepLibUV::GetHighResTimeNs();
+			auto routedAtNs = queuedAtNs != 0u ? queuedAtNs : sendingAtNs;
+
+			this->forwardingLatency->Record(packet->GetIngressTime(), routedAtNs, sendingAtNs, sentAtNs);
+
+			if (consumer->GetForwardingLatency())
+			{
+				consumer->GetForwardingLatency()->Record(
+				  packet->GetIngressTime(), routedAtNs, sendingAtNs, sentAtNs);
+			}
+		}
+	}
+
+	inline void Transport::OnProducerPaused(RTC::Producer* producer)
+	{
+		MS_TRACE();
+
+		this->listener->OnTransportProducerPaused(this, producer);
 	}
 
 	inline void Transport::OnProducerResumed(RTC::Producer* producer)
@@ -2561,7 +3532,7 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		SendRtcpPacket(packet);
+		QueueRtcpFeedbackPacket(packet);
 	}
 
 	inline void Transport::OnProducerNeedWorstRemoteFractionLost(
@@ -2577,144 +3548,42 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		// Update abs-send-time if present.
-		packet->UpdateAbsSendTime(DepLibUV::GetTimeMs());
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
 
-		// Update transport wide sequence number if present.
+		// Let the pacer (or the worker egress scheduler if there is no pacer) queue
+		// it if there is no budget to send it now. Audio is not paced.
 		// clang-format off
 		if (
-			this->tccClient &&
-			this->tccClient->GetBweType() == RTC::BweType::TRANSPORT_CC &&
-			packet->UpdateTransportWideCc01(this->transportWideCcSeq + 1)
+			consumer->GetKind() == RTC::Media::Kind::VIDEO &&
+			QueueConsumerRtpPacket(consumer, packet, /*retransmission*/ false)
 		)
 		// clang-format on
 		{
-			this->transportWideCcSeq++;
-
-			auto* tccClient = this->tccClient;
-			webrtc::RtpPacketSendInfo packetInfo;
-
-			packetInfo.ssrc                      = packet->GetSsrc();
-			packetInfo.transport_sequence_number = this->transportWideCcSeq;
-			packetInfo.has_rtp_sequence_number   = true;
-			packetInfo.rtp_sequence_number       = packet->GetSequenceNumber();
-			packetInfo.length                    = packet->GetSize();
-			packetInfo.pacing_info               = this->tccClient->GetPacingInfo();
-
-			// Indicate the pacer (and prober) that a packet is to be sent.
-			this->tccClient->InsertPacket(packetInfo);
-
-#ifdef ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
-			auto* senderBwe = this->senderBwe;
-			RTC::SenderBandwidthEstimator::SentInfo sentInfo;
-
-			sentInfo.wideSeq     = this->transportWideCcSeq;
-			sentInfo.size        = packet->GetSize();
-			sentInfo.sendingAtMs = DepLibUV::GetTimeMs();
-
-			auto* cb = new onSendCallback(
-			  [tccClient, &packetInfo, senderBwe, &sentInfo](bool sent)
-			  {
-				  if (sent)
-				  {
-					  tccClient->PacketSent(packetInfo, DepLibUV::GetTimeMsInt64());
-
-					  sentInfo.sentAtMs = DepLibUV::GetTimeMs();
-
-					  senderBwe->RtpPacketSent(sentInfo);
-				  }
-			  });
-
-			SendRtpPacket(consumer, packet, cb);
-#else
-			const auto* cb = new onSendCallback(
-			  [tccClient, &packetInfo](bool sent)
-			  {
-				  if (sent)
-					  tccClient->PacketSent(packetInfo, DepLibUV::GetTimeMsInt64());
-			  });
-
-			SendRtpPacket(consumer, packet, cb);
-#endif
-		}
-		else
-		{
-			SendRtpPacket(consumer, packet);
+			return;
 		}
 
-		this->sendRtpTransmission.Update(packet);
+		SendConsumerRtpPacket(consumer, packet, /*retransmission*/ false);
 	}
 
-	inline void Transport::OnConsumerRetransmitRtpPacket(RTC::Consumer* consumer, RTC::RtpPacket* packet)
+	inline void Transport::OnConsumerRetransmitRtpPackets(
+	  RTC::Consumer* consumer, RTC::RtpPacket** packets, size_t count)
 	{
 		MS_TRACE();
 
-		// Update abs-send-time if present.
-		packet->UpdateAbsSendTime(DepLibUV::GetTimeMs());
+		const bool paced = consumer->GetKind() == RTC::Media::Kind::VIDEO;
 
-		// Update transport wide sequence number if present.
-		// clang-format off
-		if (
-			this->tccClient &&
-			this->tccClient->GetBweType() == RTC::BweType::TRANSPORT_CC &&
-			packet->UpdateTransportWideCc01(this->transportWideCcSeq + 1)
-		)
-		// clang-format on
+		// Packets not held by the Pacer (or the worker egress scheduler) are
+		// encrypted one after another straight into the egress queue of the
+		// socket, so they all leave in the same sendmmsg() batch.
+		for (size_t idx{ 0u }; idx < count; ++idx)
 		{
-			this->transportWideCcSeq++;
-
-			auto* tccClient = this->tccClient;
-			webrtc::RtpPacketSendInfo packetInfo;
-
-			packetInfo.ssrc                      = packet->GetSsrc();
-			packetInfo.transport_sequence_number = this->transportWideCcSeq;
-			packetInfo.has_rtp_sequence_number   = true;
-			packetInfo.rtp_sequence_number       = packet->GetSequenceNumber();
-			packetInfo.length                    = packet->GetSize();
-			packetInfo.pacing_info               = this->tccClient->GetPacingInfo();
-
-			// Indicate the pacer (and prober) that a packet is to be sent.
-			this->tccClient->InsertPacket(packetInfo);
-
-#ifdef ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
-			auto* senderBwe = this->senderBwe;
-			RTC::SenderBandwidthEstimator::SentInfo sentInfo;
+			auto* packet = packets[idx];
 
-			sentInfo.wideSeq     = this->transportWideCcSeq;
-			sentInfo.size        = packet->GetSize();
-			sentInfo.sendingAtMs = DepLibUV::GetTimeMs();
+			if (paced && QueueConsumerRtpPacket(consumer, packet, /*retransmission*/ true))
+				continue;
 
-			auto* cb = new onSendCallback(
-			  [tccClient, &packetInfo, senderBwe, &sentInfo](bool sent)
-			  {
-				  if (sent)
-				  {
-					  tccClient->PacketSent(packetInfo, DepLibUV::GetTimeMsInt64());
-
-					  sentInfo.sentAtMs = DepLibUV::GetTimeMs();
-
-					  senderBwe->RtpPacketSent(sentInfo);
-				  }
-			  });
-
-			SendRtpPacket(consumer, packet, cb);
-#else
-			const auto* cb = new onSendCallback(
-			  [tccClient, &packetInfo](bool sent)
-			  {
-				  if (sent)
-					  tccClient->PacketSent(packetInfo, DepLibUV::GetTimeMsInt64());
-			  });
-
-			SendRtpPacket(consumer, packet, cb);
-#endif
-		}
-		else
-		{
-			SendRtpPacket(consumer, packet);
+			SendConsumerRtpPacket(consumer, packet, /*retransmission*/ true);
 		}
-
-		this->sendRtxTransmission.Update(packet);
 	}
 
 	inline void Transport::OnConsumerKeyFrameRequested(RTC::Consumer* consumer, uint32_t mappedSsrc)
@@ -2737,8 +3606,7 @@ namespace RTC
 
 		MS_ASSERT(this->tccClient, "no TransportCongestionClient");
 
-		DistributeAvailableOutgoingBitrate();
-		ComputeOutgoingDesiredBitrate();
+		MayDistributeAvailableOutgoingBitrate();
 	}
 
 	inline void Transport::OnConsumerNeedZeroBitrate(RTC::Consumer* /*consumer*/)
@@ -2747,10 +3615,8 @@ namespace RTC
 
 		MS_ASSERT(this->tccClient, "no TransportCongestionClient");
 
-		DistributeAvailableOutgoingBitrate();
-
 		// This may be the latest active Consumer with BWE. If so we have to stop probation.
-		ComputeOutgoingDesiredBitrate(/*forceBitrate*/ true);
+		MayDistributeAvailableOutgoingBitrate(/*forceBitrate*/ true);
 	}
 
 	inline void Transport::OnConsumerProducerClosed(RTC::Consumer* consumer)
@@ -2759,6 +3625,14 @@ namespace RTC
 
 		// Remove it from the maps.
 		this->mapConsumers.erase(consumer->id);
+		this->consumerHandles.Remove(consumer->handle);
+		this->bitrateConsumersDirty = true;
+
+		// Drop its packets waiting to be paced.
+		if (this->pacer)
+			this->pacer->RemoveConsumer(consumer);
+		else
+			RTC::EgressScheduler::RemoveConsumer(consumer);
 
 		for (auto ssrc : consumer->GetMediaSsrcs())
 		{
@@ -2787,6 +3661,20 @@ namespace RTC
 			ComputeOutgoingDesiredBitrate(/*forceBitrate*/ true);
 	}
 
+	inline void Transport::OnConsumerActiveChanged(RTC::Consumer* consumer)
+	{
+		MS_TRACE();
+
+		this->listener->OnTransportConsumerActiveChanged(this, consumer);
+	}
+
+	inline void Transport::OnConsumerPreferredLayersChanged(RTC::Consumer* consumer)
+	{
+		MS_TRACE();
+
+		this->listener->OnTransportConsumerPreferredLayersChanged(this, consumer);
+	}
+
 	inline void Transport::OnDataProducerMessageReceived(
 	  RTC::DataProducer* dataProducer, uint32_t ppid, const uint8_t* msg, size_t len)
 	{
@@ -2916,8 +3804,17 @@ namespace RTC
 		if (this->destroying)
 			return;
 
-		if (this->sctpAssociation)
-			SendSctpData(data, len);
+		if (!this->sctpAssociation)
+			return;
+
+		// Pace it along with the media if a share of the bitrate was given for it.
+		if (this->pacer && this->pacer->QueueSctpPacket(data, len))
+			return;
+
+		if (this->sctpBitrateShare > 0)
+			this->sctpSendTransmission.Update(len, DepLibUV::GetTimeMs());
+
+		SendSctpData(data, len);
 	}
 
 	inline void Transport::OnSctpAssociationMessageReceived(
@@ -2964,6 +3861,26 @@ namespace RTC
 		}
 	}
 
+	inline bool Transport::OnSctpAssociationSendBufferFull(
+	  RTC::SctpAssociation* /*sctpAssociation*/,
+	  const std::string& dataConsumerId,
+	  uint32_t ppid,
+	  const uint8_t* msg,
+	  size_t len)
+	{
+		MS_TRACE();
+
+		auto it = this->mapDataConsumers.find(dataConsumerId);
+
+		// The DataConsumer may have been closed meanwhile.
+		if (it == this->mapDataConsumers.end())
+			return false;
+
+		auto* dataConsumer = it->second;
+
+		return dataConsumer->SctpSendBufferFull(ppid, msg, len);
+	}
+
 	inline void Transport::OnTransportCongestionControlClientBitrates(
 	  RTC::TransportCongestionControlClient* /*tccClient*/,
 	  RTC::TransportCongestionControlClient::Bitrates& bitrates)
@@ -2972,9 +3889,45 @@ namespace RTC
 
 		MS_DEBUG_DEV("outgoing available bitrate:%" PRIu32, bitrates.availableBitrate);
 
-		DistributeAvailableOutgoingBitrate();
+		MS_TRACEPOINT(
+		  bwe_update, this->id.c_str(), bitrates.availableBitrate, bitrates.desiredBitrate);
+
+		// Keep the last estimate for the next Transports to the remote endpoint.
+		if (!this->bweCacheKey.empty() && bitrates.availableBitrate > 0u)
+			RTC::BweCache::Set(this->bweCacheKey, bitrates.availableBitrate);
+
+		auto nowMs = DepLibUV::GetTimeMs();
+
+		// Skip the distribution if the available bitrate did not change much and
+		// no Consumer is waiting for it, unless it's been too long since the last
+		// one (Consumers may upgrade layers after some time).
+		// clang-format off
+		if (
+			!this->bitrateConsumersDirty &&
+			!this->bitrateDistributionTimer->IsActive() &&
+			nowMs - this->lastBitrateDistributionAtMs < BitrateDistributionMaxIntervalMs &&
+			bitrates.availableBitrate >=
+				this->lastDistributedAvailableBitrate * (1 - BitrateDistributionHysteresisFactor) &&
+			bitrates.availableBitrate <=
+				this->lastDistributedAvailableBitrate * (1 + BitrateDistributionHysteresisFactor)
+		)
+		// clang-format on
+		{
+			MS_DEBUG_DEV(
+			  "available bitrate within hysteresis, skipping distribution [now:%" PRIu32
+			  ", distributed:%" PRIu32 "]",
+			  bitrates.availableBitrate,
+			  this->lastDistributedAvailableBitrate);
+		}
+		else
+		{
+			DistributeAvailableOutgoingBitrate();
+		}
+
 		ComputeOutgoingDesiredBitrate();
 
+		this->pacer->SetAvailableBitrate(bitrates.availableBitrate);
+
 		// May emit 'trace' event.
 		EmitTraceEventBweType(bitrates);
 	}
@@ -2986,8 +3939,12 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
+
+		const uint64_t nowMs = DepLibUV::GetTimeMs();
+
 		// Update abs-send-time if present.
-		packet->UpdateAbsSendTime(DepLibUV::GetTimeMs());
+		packet->UpdateAbsSendTime(nowMs);
 
 		// Update transport wide sequence number if present.
 		// clang-format off
@@ -3014,45 +3971,22 @@ namespace RTC
 			// Indicate the pacer (and prober) that a packet is to be sent.
 			this->tccClient->InsertPacket(packetInfo);
 
-#ifdef ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
-			auto* senderBwe = this->senderBwe;
-			RTC::SenderBandwidthEstimator::SentInfo sentInfo;
-
-			sentInfo.wideSeq     = this->transportWideCcSeq;
-			sentInfo.size        = packet->GetSize();
-			sentInfo.isProbation = true;
-			sentInfo.sendingAtMs = DepLibUV::GetTimeMs();
-
-			auto* cb = new onSendCallback(
-			  [tccClient, &packetInfo, senderBwe, &sentInfo](bool sent)
-			  {
-				  if (sent)
-				  {
-					  tccClient->PacketSent(packetInfo, DepLibUV::GetTimeMsInt64());
-
-					  sentInfo.sentAtMs = DepLibUV::GetTimeMs();
-
-					  senderBwe->RtpPacketSent(sentInfo);
-				  }
-			  });
-
-			SendRtpPacket(nullptr, packet, cb);
-#else
-			const auto* cb = new onSendCallback(
+			onSendCallback cb(
 			  [tccClient, &packetInfo](bool sent)
 			  {
 				  if (sent)
-					  tccClient->PacketSent(packetInfo, DepLibUV::GetTimeMsInt64());
+					  tccClient->PacketSent(packetInfo, DepLibUV::GetHighResTimeMsInt64());
 			  });
 
-			SendRtpPacket(nullptr, packet, cb);
-#endif
+			MayCaptureRtpPacket(RTC::PacketCapture::Direction::OUT, packet);
+			SendRtpPacket(nullptr, packet, &cb);
 		}
 		else
 		{
 			// May emit 'trace' event.
 			EmitTraceEventProbationType(packet);
 
+			MayCaptureRtpPacket(RTC::PacketCapture::Direction::OUT, packet);
 			SendRtpPacket(nullptr, packet);
 		}
 
@@ -3066,6 +4000,30 @@ namespace RTC
 		  this->sendProbationTransmission.GetBitrate(DepLibUV::GetTimeMs()));
 	}
 
+	inline RTC::RtpPacket* Transport::OnTransportCongestionControlClientGeneratePadding(
+	  RTC::TransportCongestionControlClient* /*tccClient*/, size_t size)
+	{
+		MS_TRACE();
+
+		for (auto& kv : this->mapConsumers)
+		{
+			auto* consumer = kv.second;
+
+			if (consumer->GetKind() != RTC::Media::Kind::VIDEO || !consumer->IsActive())
+				continue;
+
+			for (auto* rtpStream : consumer->GetRtpStreams())
+			{
+				auto* packet = rtpStream->GetRtxPaddingPacket(size);
+
+				if (packet)
+					return packet;
+			}
+		}
+
+		return nullptr;
+	}
+
 	inline void Transport::OnTransportCongestionControlServerSendRtcpPacket(
 	  RTC::TransportCongestionControlServer* /*tccServer*/, RTC::RTCP::Packet* packet)
 	{
@@ -3073,70 +4031,99 @@ namespace RTC
 
 		packet->Serialize(RTC::RTCP::Buffer);
 
-		SendRtcpPacket(packet);
+		QueueRtcpFeedbackPacket(packet);
 	}
 
-#ifdef ENABLE_RTC_SENDER_BANDWIDTH_ESTIMATOR
-	inline void Transport::OnSenderBandwidthEstimatorAvailableBitrate(
-	  RTC::SenderBandwidthEstimator* /*senderBwe*/,
-	  uint32_t availableBitrate,
-	  uint32_t previousAvailableBitrate)
+	inline void Transport::OnPacerSendRtpPacket(
+	  RTC::Pacer* /*pacer*/,
+	  RTC::Consumer* consumer,
+	  RTC::RtpPacket* packet,
+	  bool retransmission,
+	  uint64_t queuedAtNs)
 	{
 		MS_TRACE();
 
-		MS_DEBUG_DEV(
-		  "outgoing available bitrate [now:%" PRIu32 ", before:%" PRIu32 "]",
-		  availableBitrate,
-		  previousAvailableBitrate);
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
 
-		// TODO: Uncomment once just SenderBandwidthEstimator is used.
-		// DistributeAvailableOutgoingBitrate();
-		// ComputeOutgoingDesiredBitrate();
+		SendConsumerRtpPacket(consumer, packet, retransmission, queuedAtNs);
 	}
-#endif
 
-	inline void Transport::OnTimer(Timer* timer)
+	inline void Transport::OnPacerSendSctpData(RTC::Pacer* /*pacer*/, const uint8_t* data, size_t len)
 	{
 		MS_TRACE();
 
-		// RTCP timer.
-		if (timer == this->rtcpTimer)
-		{
-			auto interval  = static_cast<uint64_t>(RTC::RTCP::MaxVideoIntervalMs);
-			uint64_t nowMs = DepLibUV::GetTimeMs();
+		if (this->destroying || !this->sctpAssociation)
+			return;
 
-			SendRtcp(nowMs);
+		this->sctpSendTransmission.Update(len, DepLibUV::GetTimeMs());
 
-			// Recalculate next RTCP interval.
-			if (!this->mapConsumers.empty())
-			{
-				// Transmission rate in kbps.
-				uint32_t rate{ 0 };
+		SendSctpData(data, len);
+	}
 
-				// Get the RTP sending rate.
-				for (auto& kv : this->mapConsumers)
-				{
-					auto* consumer = kv.second;
+	inline void Transport::OnEgressSchedulerSendRtpPacket(
+	  RTC::Consumer* consumer, RTC::RtpPacket* packet, bool retransmission, uint64_t queuedAtNs)
+	{
+		MS_TRACE();
 
-					rate += consumer->GetTransmissionRate(nowMs) / 1000;
-				}
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
+
+		SendConsumerRtpPacket(consumer, packet, retransmission, queuedAtNs);
+	}
+
+	inline void Transport::OnRtcpSchedulerSendRtcp(uint64_t nowMs)
+	{
+		MS_TRACE();
+
+		auto interval = static_cast<uint64_t>(RTC::RTCP::MaxVideoIntervalMs);
 
-				// Calculate bandwidth: 360 / transmission bandwidth in kbit/s.
-				if (rate != 0u)
-					interval = 360000 / rate;
+		SendRtcp(nowMs);
 
-				if (interval > RTC::RTCP::MaxVideoIntervalMs)
-					interval = RTC::RTCP::MaxVideoIntervalMs;
+		// Recalculate next RTCP interval.
+		if (!this->mapConsumers.empty())
+		{
+			// Transmission rate in kbps.
+			uint32_t rate{ 0 };
+
+			// Get the RTP sending rate.
+			for (auto& kv : this->mapConsumers)
+			{
+				auto* consumer = kv.second;
+
+				rate += consumer->GetTransmissionRate(nowMs) / 1000;
 			}
 
-			/*
-			 * The interval between RTCP packets is varied randomly over the range
-			 * [0.5,1.5] times the calculated interval to avoid unintended synchronization
-			 * of all participants.
-			 */
-			interval *= static_cast<float>(Utils::Crypto::GetRandomUInt(5, 15)) / 10;
+			// Calculate bandwidth: 360 / transmission bandwidth in kbit/s.
+			if (rate != 0u)
+				interval = 360000 / rate;
+
+			if (interval > RTC::RTCP::MaxVideoIntervalMs)
+				interval = RTC::RTCP::MaxVideoIntervalMs;
+		}
+
+		/*
+		 * The interval between RTCP packets is varied randomly over the range
+		 * [0.5,1.5] times the calculated interval to avoid unintended synchronization
+		 * of all participants.
+		 */
+		interval *= static_cast<float>(Utils::Crypto::GetRandomUInt(5, 15)) / 10;
+
+		RTC::RtcpScheduler::Schedule(this, interval);
+	}
+
+	inline void Transport::OnTimer(Timer* timer)
+	{
+		MS_TRACE();
 
-			this->rtcpTimer->Start(interval);
+		// Bitrate distribution timer.
+		if (timer == this->bitrateDistributionTimer)
+		{
+			DistributeAvailableOutgoingBitrate();
+			ComputeOutgoingDesiredBitrate();
+		}
+		// RTCP feedback timer.
+		else if (timer == this->rtcpFeedbackTimer)
+		{
+			SendRtcpFeedbackPackets();
 		}
 	}
 } // namespace RTC
@@ -0,0 +1,125 @@
+#define MS_CLASS "RTC::TransportArena"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/TransportArena.hpp"
+#include "Logger.hpp"
+#include <new> // ::operator new()
+
+namespace RTC
+{
+	/* Static. */
+
+	static inline size_t getSizeClass(size_t size)
+	{
+		return (size - 1) / TransportArena::BlockSizeStep;
+	}
+
+	/* Class variables. */
+
+	thread_local TransportArena* TransportArena::current{ nullptr };
+
+	/* Class methods. */
+
+	void* TransportArena::Allocate(size_t size)
+	{
+		const size_t blockSize = size + HeaderSize;
+		auto* arena            = TransportArena::current;
+		uint8_t* block;
+
+		if (arena && blockSize <= BlockSizeStep * NumSizeClasses)
+		{
+			block = arena->AllocateBlock(getSizeClass(blockSize));
+		}
+		else
+		{
+			block = static_cast<uint8_t*>(::operator new(blockSize));
+			arena = nullptr;
+		}
+
+		*reinterpret_cast<TransportArena**>(block) = arena;
+
+		return static_cast<void*>(block + HeaderSize);
+	}
+
+	void TransportArena::Deallocate(void* ptr, size_t size)
+	{
+		if (!ptr)
+			return;
+
+		auto* block = static_cast<uint8_t*>(ptr) - HeaderSize;
+		auto* arena = *reinterpret_cast<TransportArena**>(block);
+
+		if (arena)
+			arena->DeallocateBlock(block, getSizeClass(size + HeaderSize));
+		else
+			::operator delete(static_cast<void*>(block));
+	}
+
+	/* Instance methods. */
+
+	TransportArena::~TransportArena()
+	{
+		MS_TRACE();
+
+		if (this->usedBytes != 0u)
+			MS_WARN_DEV("blocks not freed before the arena [bytes:%zu]", this->usedBytes);
+
+		for (auto* chunk : this->chunks)
+		{
+			::operator delete(static_cast<void*>(chunk));
+		}
+		this->chunks.clear();
+	}
+
+	void TransportArena::FillJson(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		// Add reservedBytes.
+		jsonObject["reservedBytes"] = GetReservedBytes();
+
+		// Add usedBytes.
+		jsonObject["usedBytes"] = this->usedBytes;
+	}
+
+	uint8_t* TransportArena::AllocateBlock(size_t sizeClass)
+	{
+		const size_t blockSize = (sizeClass + 1) * BlockSizeStep;
+		auto* freeBlock        = this->freeLists[sizeClass];
+
+		this->usedBytes += blockSize;
+
+		if (freeBlock)
+		{
+			this->freeLists[sizeClass] = freeBlock->next;
+
+			return reinterpret_cast<uint8_t*>(freeBlock);
+		}
+
+		// The tail of the current chunk is wasted if it does not fit the block.
+		if (this->available < blockSize)
+		{
+			this->cursor    = static_cast<uint8_t*>(::operator new(ChunkSize));
+			this->available = ChunkSize;
+
+			this->chunks.push_back(this->cursor);
+		}
+
+		auto* block = this->cursor;
+
+		this->cursor += blockSize;
+		this->available -= blockSize;
+
+		return block;
+	}
+
+	void TransportArena::DeallocateBlock(uint8_t* block, size_t sizeClass)
+	{
+		auto* freeBlock = reinterpret_cast<FreeBlock*>(block);
+
+		freeBlock->next            = this->freeLists[sizeClass];
+		this->freeLists[sizeClass] = freeBlock;
+
+		this->usedBytes -= (sizeClass + 1) * BlockSizeStep;
+	}
+} // namespace RTC
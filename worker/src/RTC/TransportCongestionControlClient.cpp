@@ -3,8 +3,11 @@
 
 #include "RTC/TransportCongestionControlClient.hpp"
 #include "DepLibUV.hpp"
+#include "DepLibWebRTC.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Metrics.hpp"
+#include "Settings.hpp"
 #include <libwebrtc/api/transport/network_types.h> // webrtc::TargetRateConstraints
 #include <limits>
 
@@ -18,6 +21,14 @@ namespace RTC
 	static constexpr float MaxPaddingBitrateFactor{ 0.85f };
 	static constexpr uint64_t AvailableBitrateEventInterval{ 1000u }; // In ms.
 	static constexpr size_t PacketLossHistogramLength{ 24 };
+	// Time without media to send after which the libwebrtc controller is
+	// destroyed.
+	static constexpr uint64_t ControllerIdleTimeout{ 60000u }; // In ms.
+
+	/* Class variables. */
+
+	thread_local absl::flat_hash_set<TransportCongestionControlClient*>
+	  TransportCongestionControlClient::probingClients;
 
 	/* Instance methods. */
 
@@ -32,6 +43,19 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		// The native estimator just handles transport-cc feedback.
+		if (
+		  Settings::configuration.nativeBandwidthEstimator &&
+		  this->bweType == RTC::BweType::TRANSPORT_CC)
+		{
+			this->senderBwe = new RTC::SenderBandwidthEstimator(this, this->initialAvailableBitrate);
+
+			return;
+		}
+
+		// libwebrtc is initialized on first use.
+		DepLibWebRTC::ClassInit();
+
 		webrtc::GoogCcFactoryConfig config;
 
 		// Provide RTCP feedback as well as Receiver Reports.
@@ -48,22 +72,53 @@ namespace RTC
 		this->controllerFactory = nullptr;
 
 		DestroyController();
+
+		delete this->senderBwe;
+		this->senderBwe = nullptr;
+	}
+
+	void TransportCongestionControlClient::MayInitializeController()
+	{
+		MS_TRACE();
+
+		if (this->rtpTransportControllerSend != nullptr || this->senderBwe || !this->connected)
+		{
+			return;
+		}
+
+		MS_DEBUG_TAG(bwe, "creating libwebrtc transport controller");
+
+		this->lastDemandAtMs = DepLibUV::GetTimeMs();
+
+		InitializeController();
+
+		this->rtpTransportControllerSend->OnNetworkAvailability(true);
+
+		// Apply the bitrate limits set while there was no controller.
+		if (this->bitrates.maxBitrate > 0u)
+		{
+			ApplyBitrateUpdates();
+		}
 	}
 
 	void TransportCongestionControlClient::InitializeController()
 	{
 		MS_ASSERT(this->rtpTransportControllerSend == nullptr, "transport controller already initialized");
 
+		// Restart warm with the estimate of the previous controller, if any.
+		if (this->bitrates.availableBitrate > 0u)
+			this->controllerStartBitrate = std::max<uint32_t>(this->bitrates.availableBitrate, MinBitrate);
+		else
+			this->controllerStartBitrate = this->initialAvailableBitrate;
+
 		webrtc::BitrateConstraints bitrateConfig;
-		bitrateConfig.start_bitrate_bps = static_cast<int>(this->initialAvailableBitrate);
+		bitrateConfig.start_bitrate_bps = static_cast<int>(this->controllerStartBitrate);
 
 		this->rtpTransportControllerSend =
 		  new webrtc::RtpTransportControllerSend(this, nullptr, this->controllerFactory, bitrateConfig);
 
 		this->rtpTransportControllerSend->RegisterTargetTransferRateObserver(this);
 
-		this->probationGenerator = new RTC::RtpProbationGenerator();
-
 		// This makes sure that periodic probing is used when the application is send
 		// less bitrate than needed to measure the bandwidth estimation.  (f.e. when
 		// videos are muted or using screensharing with still images)
@@ -86,8 +141,7 @@ namespace RTC
 		delete this->rtpTransportControllerSend;
 		this->rtpTransportControllerSend = nullptr;
 
-		delete this->probationGenerator;
-		this->probationGenerator = nullptr;
+		TransportCongestionControlClient::probingClients.erase(this);
 
 		delete this->processTimer;
 		this->processTimer = nullptr;
@@ -97,9 +151,26 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		this->connected = true;
+
+		if (this->senderBwe)
+		{
+			this->senderBwe->TransportConnected();
+
+			this->bitrates.availableBitrate = this->senderBwe->GetAvailableBitrate();
+
+			return;
+		}
+
+		// Otherwise the controller is created once there is media to send.
 		if (this->rtpTransportControllerSend == nullptr)
 		{
-			InitializeController();
+			if (this->bitrates.desiredBitrate > 0u)
+			{
+				MayInitializeController();
+			}
+
+			return;
 		}
 
 		this->rtpTransportControllerSend->OnNetworkAvailability(true);
@@ -111,10 +182,25 @@ namespace RTC
 
 		auto nowMs = DepLibUV::GetTimeMsInt64();
 
+		this->connected = false;
+
 		this->bitrates.desiredBitrate          = 0u;
 		this->bitrates.effectiveDesiredBitrate = 0u;
 
 		this->desiredBitrateTrend.ForceUpdate(0u, nowMs);
+
+		if (this->senderBwe)
+		{
+			this->senderBwe->TransportDisconnected();
+
+			return;
+		}
+
+		if (this->rtpTransportControllerSend == nullptr)
+		{
+			return;
+		}
+
 		this->rtpTransportControllerSend->OnNetworkAvailability(false);
 	}
 
@@ -122,9 +208,18 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		Metrics::StageScope metricsScope(Metrics::Stage::TRANSPORT_CONGESTION_CONTROL_CLIENT);
+
+		this->lastDemandAtMs = DepLibUV::GetTimeMs();
+
 		if (this->rtpTransportControllerSend == nullptr)
 		{
-			return;
+			MayInitializeController();
+
+			if (this->rtpTransportControllerSend == nullptr)
+			{
+				return;
+			}
 		}
 
 		this->rtpTransportControllerSend->packet_sender()->InsertPacket(packetInfo.length);
@@ -147,6 +242,23 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		Metrics::StageScope metricsScope(Metrics::Stage::TRANSPORT_CONGESTION_CONTROL_CLIENT);
+
+		if (this->senderBwe)
+		{
+			RTC::SenderBandwidthEstimator::SentInfo sentInfo;
+
+			sentInfo.sentAtMs    = static_cast<uint64_t>(nowMs);
+			sentInfo.size        = static_cast<uint32_t>(packetInfo.length);
+			sentInfo.wideSeq     = packetInfo.transport_sequence_number;
+			sentInfo.isProbation = packetInfo.pacing_info.probe_cluster_id !=
+			                       webrtc::PacedPacketInfo::kNotAProbe;
+
+			this->senderBwe->RtpPacketSent(sentInfo);
+
+			return;
+		}
+
 		if (this->rtpTransportControllerSend == nullptr)
 		{
 			return;
@@ -174,6 +286,15 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		Metrics::StageScope metricsScope(Metrics::Stage::TRANSPORT_CONGESTION_CONTROL_CLIENT);
+
+		if (this->senderBwe)
+		{
+			this->senderBwe->UpdateRtt(rtt);
+
+			return;
+		}
+
 		webrtc::ReportBlockList reportBlockList;
 
 		for (auto it = packet->Begin(); it != packet->End(); ++it)
@@ -205,15 +326,20 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		Metrics::StageScope metricsScope(Metrics::Stage::TRANSPORT_CONGESTION_CONTROL_CLIENT);
+
 		// Update packet loss history.
 		size_t expected_packets = feedback->GetPacketStatusCount();
-		size_t lost_packets     = 0;
-		for (const auto& result : feedback->GetPacketResults())
+		size_t lost_packets     = expected_packets - feedback->GetReceivedStatusCount();
+
+		this->UpdatePacketLoss(static_cast<double>(lost_packets) / expected_packets);
+
+		if (this->senderBwe)
 		{
-			if (!result.received)
-				lost_packets += 1;
+			this->senderBwe->ReceiveRtcpTransportFeedback(feedback, DepLibUV::GetTimeMs());
+
+			return;
 		}
-		this->UpdatePacketLoss(static_cast<double>(lost_packets) / expected_packets);
 
 		if (this->rtpTransportControllerSend == nullptr)
 		{
@@ -223,6 +349,64 @@ namespace RTC
 		this->rtpTransportControllerSend->OnTransportFeedback(*feedback);
 	}
 
+	void TransportCongestionControlClient::ReceiveRtcpEcnFeedback(
+	  RTC::RTCP::FeedbackRtpEcnPacket* feedback)
+	{
+		MS_TRACE();
+
+		Metrics::StageScope metricsScope(Metrics::Stage::TRANSPORT_CONGESTION_CONTROL_CLIENT);
+
+		int64_t cePacketsDelta{ 0 };
+		int64_t packetsDelta{ 0 };
+
+		for (auto it = feedback->Begin(); it != feedback->End(); ++it)
+		{
+			auto* item = *it;
+			auto result =
+			  this->ecnCounters.try_emplace(feedback->GetMediaSsrc(), EcnCounters());
+			auto& counters = result.first->second;
+
+			// Deltas can only be computed from previous counters. Subtractions are
+			// done in the counter width so wrapped counters are handled.
+			if (!result.second)
+			{
+				const uint32_t ect0Delta   = item->GetEct0Counter() - counters.ect0;
+				const uint32_t ect1Delta   = item->GetEct1Counter() - counters.ect1;
+				const uint16_t ceDelta     = item->GetEcnCeCounter() - counters.ce;
+				const uint16_t notEctDelta = item->GetNotEctCounter() - counters.notEct;
+
+				cePacketsDelta += ceDelta;
+				packetsDelta += int64_t{ ect0Delta } + ect1Delta + ceDelta + notEctDelta;
+			}
+
+			counters.ect0   = item->GetEct0Counter();
+			counters.ect1   = item->GetEct1Counter();
+			counters.ce     = item->GetEcnCeCounter();
+			counters.notEct = item->GetNotEctCounter();
+		}
+
+		if (packetsDelta == 0)
+		{
+			return;
+		}
+
+		this->ecnCePackets += cePacketsDelta;
+
+		// The native sender side estimator does not react to CE marks.
+		if (this->senderBwe)
+		{
+			return;
+		}
+
+		if (this->rtpTransportControllerSend == nullptr)
+		{
+			return;
+		}
+
+		this->rtpTransportControllerSend->OnReceivedEcnFeedback(
+		  cePacketsDelta, packetsDelta, DepLibUV::GetTimeMsInt64());
+	}
+
 	void TransportCongestionControlClient::UpdatePacketLoss(double packetLoss)
 	{
 		// Add the score into the histogram.
@@ -276,6 +460,78 @@ namespace RTC
 		}
 	}
 
+	void TransportCongestionControlClient::SetInitialAvailableBitrate(uint32_t bitrate)
+	{
+		MS_TRACE();
+
+		// The native estimator is created with the initial bitrate.
+		// clang-format off
+		if (
+			this->senderBwe ||
+			this->rtpTransportControllerSend != nullptr ||
+			this->bitrates.availableBitrate > 0u
+		)
+		// clang-format on
+		{
+			return;
+		}
+
+		this->initialAvailableBitrate = std::max<uint32_t>(bitrate, MinBitrate);
+
+		if (this->maxOutgoingBitrate > 0u)
+		{
+			this->initialAvailableBitrate =
+			  std::min<uint32_t>(this->initialAvailableBitrate, this->maxOutgoingBitrate);
+		}
+
+		MS_DEBUG_TAG(bwe, "initial available bitrate set to %" PRIu32, this->initialAvailableBitrate);
+	}
+
+	void TransportCongestionControlClient::PathChanged(uint32_t startBitrate)
+	{
+		MS_TRACE();
+
+		auto previousAvailableBitrate = this->bitrates.availableBitrate;
+
+		if (startBitrate == 0u)
+			startBitrate = this->initialAvailableBitrate;
+
+		startBitrate = std::max<uint32_t>(startBitrate, MinBitrate);
+
+		if (this->maxOutgoingBitrate > 0u)
+			startBitrate = std::min<uint32_t>(startBitrate, this->maxOutgoingBitrate);
+
+		MS_DEBUG_TAG(
+		  bwe, "network path changed, restarting estimation [bitrate:%" PRIu32 "]", startBitrate);
+
+		// Losses and ECN marks of the old path do not apply to the new one.
+		this->packetLossHistory.clear();
+		this->packetLoss = 0;
+		this->ecnCounters.clear();
+
+		if (this->senderBwe)
+		{
+			this->senderBwe->PathChanged(startBitrate);
+
+			this->bitrates.availableBitrate = this->senderBwe->GetAvailableBitrate();
+		}
+		else
+		{
+			// The next controller starts from it.
+			this->bitrates.availableBitrate = startBitrate;
+
+			// A new controller drops the feedback state, probes and pacing budget of
+			// the old path instead of waiting for them to time out.
+			if (this->rtpTransportControllerSend != nullptr)
+			{
+				DestroyController();
+				MayInitializeController();
+			}
+		}
+
+		MayEmitAvailableBitrateEvent(previousAvailableBitrate);
+	}
+
 	void TransportCongestionControlClient::SetDesiredBitrate(uint32_t desiredBitrate, bool force)
 	{
 		MS_TRACE();
@@ -295,6 +551,13 @@ namespace RTC
 		// more stable values.
 		this->bitrates.startBitrate = std::max<uint32_t>(MinBitrate, this->bitrates.availableBitrate);
 
+		if (desiredBitrate > 0u)
+		{
+			this->lastDemandAtMs = DepLibUV::GetTimeMs();
+
+			MayInitializeController();
+		}
+
 		ApplyBitrateUpdates();
 	}
 
@@ -344,6 +607,13 @@ namespace RTC
 		  this->bitrates.maxBitrate,
 		  this->bitrates.maxPaddingBitrate);
 
+		if (this->senderBwe)
+		{
+			this->senderBwe->SetMaxBitrate(this->bitrates.maxBitrate);
+
+			return;
+		}
+
 		if (this->rtpTransportControllerSend == nullptr)
 		{
 			return;
@@ -453,13 +723,13 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		// NOTE: The same value as 'this->initialAvailableBitrate' is received periodically
-		// regardless of the real available bitrate. Skip such value except for the first time
-		// this event is called.
+		// NOTE: The start bitrate of the controller is received periodically regardless
+		// of the real available bitrate. Skip such value except for the first time this
+		// event is called.
 		// clang-format off
 		if (
 			this->availableBitrateEventCalled &&
-			targetTransferRate.target_rate.bps() == this->initialAvailableBitrate
+			targetTransferRate.target_rate.bps() == this->controllerStartBitrate
 		)
 		// clang-format on
 		{
@@ -493,23 +763,89 @@ namespace RTC
 	RTC::RtpPacket* TransportCongestionControlClient::GeneratePadding(size_t size)
 	{
 		MS_TRACE();
-		MS_ASSERT(this->probationGenerator, "probation generator not initialized")
 
-		return this->probationGenerator->GetNextPacket(size);
+		// Prefer RTX of recently sent media (as libwebrtc does) so probe bytes
+		// carry useful data.
+		auto* packet = this->listener->OnTransportCongestionControlClientGeneratePadding(this, size);
+
+		if (packet)
+			return packet;
+
+		return RTC::RtpProbationGenerator::GetNextPacket(size);
+	}
+
+	// Called from PacedSender before sending probation packets.
+	bool TransportCongestionControlClient::MayProbe()
+	{
+		MS_TRACE();
+
+		const auto maxProbingTransports = Settings::configuration.maxProbingTransports;
+
+		if (maxProbingTransports == 0u)
+			return true;
+
+		auto& probingClients = TransportCongestionControlClient::probingClients;
+
+		if (probingClients.find(this) != probingClients.end())
+			return true;
+
+		// Defer probation until another Transport is done with it.
+		if (probingClients.size() >= maxProbingTransports)
+		{
+			MS_DEBUG_DEV("too many transports probing, deferring probation");
+
+			return false;
+		}
+
+		probingClients.insert(this);
+
+		return true;
+	}
+
+	inline void TransportCongestionControlClient::OnSenderBandwidthEstimatorAvailableBitrate(
+	  RTC::SenderBandwidthEstimator* /*senderBwe*/,
+	  uint32_t availableBitrate,
+	  uint32_t previousAvailableBitrate)
+	{
+		MS_TRACE();
+
+		this->bitrates.availableBitrate = availableBitrate;
+
+		MayEmitAvailableBitrateEvent(previousAvailableBitrate);
 	}
 
 	void TransportCongestionControlClient::OnTimer(Timer* timer)
 	{
 		MS_TRACE();
 
+		Metrics::StageScope metricsScope(Metrics::Stage::TRANSPORT_CONGESTION_CONTROL_CLIENT);
+
 		if (timer == this->processTimer)
 		{
+			// Free the controller if there is nothing to send for long. Its estimate
+			// is kept in 'this->bitrates.availableBitrate' for the next one.
+			if (
+			  this->bitrates.desiredBitrate == 0u &&
+			  DepLibUV::GetTimeMs() - this->lastDemandAtMs >= ControllerIdleTimeout)
+			{
+				MS_DEBUG_TAG(bwe, "destroying idle libwebrtc transport controller");
+
+				// NOTE: This deletes the timer so return now.
+				DestroyController();
+
+				return;
+			}
+
 			// Time to call RtpTransportControllerSend::Process().
 			this->rtpTransportControllerSend->Process();
 
 			// Time to call PacedSender::Process().
 			this->rtpTransportControllerSend->packet_sender()->Process();
 
+			// Let others probe once done with it.
+			if (!this->rtpTransportControllerSend->packet_sender()->IsProbing())
+				TransportCongestionControlClient::probingClients.erase(this);
+
 			/* clang-format off */
 			this->processTimer->Start(std::min<uint64_t>(
 				// Depends on probation being done and WebRTC-Pacer-MinPacketLimitMs field trial.
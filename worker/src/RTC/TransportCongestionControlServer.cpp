@@ -3,8 +3,11 @@
 
 #include "RTC/TransportCongestionControlServer.hpp"
 #include "DepLibUV.hpp"
+#include "DepLibWebRTC.hpp"
 #include "Logger.hpp"
+#include "Settings.hpp"
 #include "RTC/RTCP/FeedbackPsRemb.hpp"
+#include "RTC/SeqManager.hpp"
 #include <iterator> // std::ostream_iterator
 #include <sstream>  // std::ostringstream
 
@@ -16,6 +19,7 @@ namespace RTC
 	static constexpr uint64_t LimitationRembInterval{ 1500u };         // In ms.
 	static constexpr uint8_t UnlimitedRembNumPackets{ 4u };
 	static constexpr size_t PacketLossHistogramLength{ 24 };
+	static constexpr uint64_t EcnFeedbackSendInterval{ 100u }; // In ms.
 
 	/* Instance methods. */
 
@@ -27,6 +31,9 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		// libwebrtc is initialized on first use.
+		DepLibWebRTC::ClassInit();
+
 		switch (this->bweType)
 		{
 			case RTC::BweType::TRANSPORT_CC:
@@ -45,7 +52,8 @@ namespace RTC
 
 			case RTC::BweType::REMB:
 			{
-				this->rembServer = new webrtc::RemoteBitrateEstimatorAbsSendTime(this);
+				this->rembServer   = new webrtc::RemoteBitrateEstimatorAbsSendTime(this);
+				this->rembSampling = std::max<uint8_t>(Settings::configuration.rembSampling, 1u);
 
 				break;
 			}
@@ -92,8 +100,14 @@ namespace RTC
 			{
 				this->transportCcFeedbackSendPeriodicTimer->Stop();
 
-				// Create a new feedback packet.
-				this->transportCcFeedbackPacket.reset(new RTC::RTCP::FeedbackRtpTransportPacket(0u, 0u));
+				// Discard pending records.
+				this->transportCcRingCount = 0u;
+
+				// Reset the feedback packet.
+				this->transportCcFeedbackPacket->Reset();
+				this->transportCcFeedbackPacket->SetSenderSsrc(0u);
+				this->transportCcFeedbackPacket->SetMediaSsrc(0u);
+				this->transportCcFeedbackPacket->SetFeedbackPacketCount(0u);
 
 				break;
 			}
@@ -122,61 +136,25 @@ namespace RTC
 				if (!packet->ReadTransportWideCc01(wideSeqNumber))
 					break;
 
-				// Update the RTCP media SSRC of the ongoing Transport-CC Feedback packet.
-				this->transportCcFeedbackSenderSsrc = 0u;
-				this->transportCcFeedbackMediaSsrc  = packet->GetSsrc();
-
-				this->transportCcFeedbackPacket->SetSenderSsrc(0u);
-				this->transportCcFeedbackPacket->SetMediaSsrc(this->transportCcFeedbackMediaSsrc);
-
-				// Provide the feedback packet with the RTP packet info. If it fails,
-				// send current feedback and add the packet info to a new one.
-				auto result =
-				  this->transportCcFeedbackPacket->AddPacket(wideSeqNumber, nowMs, this->maxRtcpPacketLen);
-
-				switch (result)
-				{
-					case RTC::RTCP::FeedbackRtpTransportPacket::AddPacketResult::SUCCESS:
-					{
-						// If the feedback packet is full, send it now.
-						if (this->transportCcFeedbackPacket->IsFull())
-						{
-							MS_DEBUG_DEV("transport-cc feedback packet is full, sending feedback now");
-
-							SendTransportCcFeedback();
-						}
-
-						break;
-					}
-
-					case RTC::RTCP::FeedbackRtpTransportPacket::AddPacketResult::MAX_SIZE_EXCEEDED:
-					{
-						// Send ongoing feedback packet and add the new packet info to the
-						// regenerated one.
-						SendTransportCcFeedback();
+				// Just record the packet. Records are added to the feedback packet
+				// when the ring is full or when the feedback is about to be sent.
+				if (this->transportCcRingCount == TransportCcRingSize)
+					DrainTransportCcRing();
 
-						this->transportCcFeedbackPacket->AddPacket(wideSeqNumber, nowMs, this->maxRtcpPacketLen);
+				if (this->transportCcRingCount == 0u)
+					this->transportCcRingBaseMs = nowMs;
+				// Kernel receive times of packets read from different sockets may
+				// not be in order.
+				else if (nowMs < this->transportCcRingBaseMs)
+					nowMs = this->transportCcRingBaseMs;
 
-						break;
-					}
-
-					case RTC::RTCP::FeedbackRtpTransportPacket::AddPacketResult::FATAL:
-					{
-						// Create a new feedback packet.
-						this->transportCcFeedbackPacket.reset(new RTC::RTCP::FeedbackRtpTransportPacket(
-						  this->transportCcFeedbackSenderSsrc, this->transportCcFeedbackMediaSsrc));
+				auto& record = this->transportCcRing[this->transportCcRingCount++];
 
-						// Use current packet count.
-						// NOTE: Do not increment it since the previous ongoing feedback
-						// packet was not sent.
-						this->transportCcFeedbackPacket->SetFeedbackPacketCount(
-						  this->transportCcFeedbackPacketCount);
+				record.receivedAtOffsetMs = static_cast<uint32_t>(nowMs - this->transportCcRingBaseMs);
+				record.wideSeqNumber      = wideSeqNumber;
 
-						break;
-					}
-				}
-
-				MaySendLimitationRembFeedback();
+				// Update the RTCP media SSRC of the ongoing Transport-CC Feedback packet.
+				this->transportCcFeedbackMediaSsrc = packet->GetSsrc();
 
 				break;
 			}
@@ -188,18 +166,82 @@ namespace RTC
 				if (!packet->ReadAbsSendTime(absSendTime))
 					break;
 
+				// Sub-sample if requested. The sampled packet accounts for the
+				// payload of the skipped ones so the incoming bitrate estimation is
+				// kept.
+				if (++this->rembSamplingCounter < this->rembSampling)
+					break;
+
+				this->rembSamplingCounter = 0u;
+
 				// NOTE: nowMs is uint64_t but we need to "convert" it to int64_t before
 				// we give it to libwebrtc lib (althought this is implicit in the
 				// conversion so it would be converted within the method call).
 				auto nowMsInt64 = static_cast<int64_t>(nowMs);
 
-				this->rembServer->IncomingPacket(nowMsInt64, packet->GetPayloadLength(), *packet, absSendTime);
+				this->rembServer->IncomingPacket(
+				  nowMsInt64, packet->GetPayloadLength() * this->rembSampling, *packet, absSendTime);
 
 				break;
 			}
 		}
 	}
 
+	void TransportCongestionControlServer::IncomingEcn(
+	  uint64_t nowMs, const RTC::RtpPacket* packet, uint8_t ecn)
+	{
+		MS_TRACE();
+
+		const uint16_t seq = packet->GetSequenceNumber();
+
+		if (!this->ecnStarted)
+		{
+			this->ecnStarted            = true;
+			this->ecnMediaSsrc          = packet->GetSsrc();
+			this->ecnExtendedHighestSeq = seq;
+		}
+		// clang-format off
+		else if (
+			packet->GetSsrc() == this->ecnMediaSsrc &&
+			RTC::SeqManager<uint16_t>::IsSeqHigherThan(
+				seq, static_cast<uint16_t>(this->ecnExtendedHighestSeq))
+		)
+		// clang-format on
+		{
+			// Sequence number wrapped around.
+			if (seq < static_cast<uint16_t>(this->ecnExtendedHighestSeq))
+				this->ecnExtendedHighestSeq += 1u << 16;
+
+			this->ecnExtendedHighestSeq = (this->ecnExtendedHighestSeq & 0xFFFF0000) | seq;
+		}
+
+		switch (ecn)
+		{
+			case 0x00:
+				++this->ecnNotEctCounter;
+				break;
+			case 0x01:
+				++this->ecnEct1Counter;
+				break;
+			case 0x02:
+				++this->ecnEct0Counter;
+				break;
+			default:
+				++this->ecnCeCounter;
+		}
+
+		// Nothing to report if the sender does not use ECN.
+		if (this->ecnEct0Counter == 0u && this->ecnEct1Counter == 0u && this->ecnCeCounter == 0u)
+			return;
+
+		if (nowMs - this->ecnFeedbackSentAtMs >= EcnFeedbackSendInterval)
+		{
+			SendEcnFeedback();
+
+			this->ecnFeedbackSentAtMs = nowMs;
+		}
+	}
+
 	void TransportCongestionControlServer::SetMaxIncomingBitrate(uint32_t bitrate)
 	{
 		MS_TRACE();
@@ -217,6 +259,71 @@ namespace RTC
 		}
 	}
 
+	void TransportCongestionControlServer::DrainTransportCcRing()
+	{
+		MS_TRACE();
+
+		if (this->transportCcRingCount == 0u)
+			return;
+
+		this->transportCcFeedbackSenderSsrc = 0u;
+
+		this->transportCcFeedbackPacket->SetSenderSsrc(0u);
+		this->transportCcFeedbackPacket->SetMediaSsrc(this->transportCcFeedbackMediaSsrc);
+
+		for (size_t idx{ 0u }; idx < this->transportCcRingCount; ++idx)
+		{
+			const auto& record          = this->transportCcRing[idx];
+			const uint64_t receivedAtMs = this->transportCcRingBaseMs + record.receivedAtOffsetMs;
+
+			// Provide the feedback packet with the RTP packet info. If it fails,
+			// send current feedback and add the packet info to a new one.
+			auto result = this->transportCcFeedbackPacket->AddPacket(
+			  record.wideSeqNumber, receivedAtMs, this->maxRtcpPacketLen);
+
+			switch (result)
+			{
+				case RTC::RTCP::FeedbackRtpTransportPacket::AddPacketResult::SUCCESS:
+				{
+					// If the feedback packet is full, send it now.
+					if (this->transportCcFeedbackPacket->IsFull())
+					{
+						MS_DEBUG_DEV("transport-cc feedback packet is full, sending feedback now");
+
+						SendTransportCcFeedback();
+					}
+
+					break;
+				}
+
+				case RTC::RTCP::FeedbackRtpTransportPacket::AddPacketResult::MAX_SIZE_EXCEEDED:
+				{
+					// Send ongoing feedback packet and add the new packet info to the
+					// regenerated one.
+					SendTransportCcFeedback();
+
+					this->transportCcFeedbackPacket->AddPacket(
+					  record.wideSeqNumber, receivedAtMs, this->maxRtcpPacketLen);
+
+					break;
+				}
+
+				case RTC::RTCP::FeedbackRtpTransportPacket::AddPacketResult::FATAL:
+				{
+					// Reset the feedback packet.
+					// NOTE: Keep its packet count since it was not sent.
+					this->transportCcFeedbackPacket->Reset();
+
+					break;
+				}
+			}
+		}
+
+		this->transportCcRingCount = 0u;
+
+		MaySendLimitationRembFeedback();
+	}
+
 	inline void TransportCongestionControlServer::SendTransportCcFeedback()
 	{
 		MS_TRACE();
@@ -233,18 +340,14 @@ namespace RTC
 
 		// Update packet loss history.
 		size_t expected_packets = this->transportCcFeedbackPacket->GetPacketStatusCount();
-		size_t lost_packets     = 0;
-		for (const auto& result : this->transportCcFeedbackPacket->GetPacketResults())
-		{
-			if (!result.received)
-				lost_packets += 1;
-		}
+		size_t received_packets = this->transportCcFeedbackPacket->GetReceivedStatusCount();
+		size_t lost_packets     = expected_packets - received_packets;
 
 		this->UpdatePacketLoss(static_cast<double>(lost_packets) / expected_packets);
 
-		// Create a new feedback packet.
-		this->transportCcFeedbackPacket.reset(new RTC::RTCP::FeedbackRtpTransportPacket(
-		  this->transportCcFeedbackSenderSsrc, this->transportCcFeedbackMediaSsrc));
+		// Reset the feedback packet so it is reused (its chunks and deltas are
+		// stored in fixed buffers).
+		this->transportCcFeedbackPacket->Reset();
 
 		// Increment packet count.
 		this->transportCcFeedbackPacket->SetFeedbackPacketCount(++this->transportCcFeedbackPacketCount);
@@ -257,6 +360,28 @@ namespace RTC
 		}
 	}
 
+	inline void TransportCongestionControlServer::SendEcnFeedback()
+	{
+		MS_TRACE();
+
+		RTC::RTCP::FeedbackRtpEcnPacket packet(0u, this->ecnMediaSsrc);
+
+		// NOTE: The 16 bits counters wrap around (RFC 6679 section 5.1).
+		auto* item = new RTC::RTCP::FeedbackRtpEcnItem(
+		  this->ecnExtendedHighestSeq,
+		  this->ecnEct0Counter,
+		  this->ecnEct1Counter,
+		  static_cast<uint16_t>(this->ecnCeCounter),
+		  static_cast<uint16_t>(this->ecnNotEctCounter),
+		  /*lostPackets*/ 0u,
+		  /*duplicatedPackets*/ 0u);
+
+		packet.AddItem(item);
+
+		// Notify the listener.
+		this->listener->OnTransportCongestionControlServerSendRtcpPacket(this, &packet);
+	}
+
 	inline void TransportCongestionControlServer::MaySendLimitationRembFeedback()
 	{
 		MS_TRACE();
@@ -366,6 +491,9 @@ namespace RTC
 		MS_TRACE();
 
 		if (timer == this->transportCcFeedbackSendPeriodicTimer)
+		{
+			DrainTransportCcRing();
 			SendTransportCcFeedback();
+		}
 	}
 } // namespace RTC
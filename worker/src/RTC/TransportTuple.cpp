@@ -4,10 +4,44 @@
 #include "RTC/TransportTuple.hpp"
 #include "Logger.hpp"
 #include "Utils.hpp"
+#include <absl/hash/hash.h>
+#include <cstring> // std::memcpy()
 #include <string>
 
 namespace RTC
 {
+	/* Static. */
+
+	// Writes the IP of the given address into ip (16 bytes, IPv4 ones as
+	// IPv4-mapped IPv6) and its port into port (2 bytes, in network order).
+	static void PackAddress(const struct sockaddr* addr, uint8_t* ip, uint8_t* port)
+	{
+		switch (addr->sa_family)
+		{
+			case AF_INET:
+			{
+				const auto* addrIn = reinterpret_cast<const struct sockaddr_in*>(addr);
+
+				ip[10] = 0xFF;
+				ip[11] = 0xFF;
+				std::memcpy(ip + 12, std::addressof(addrIn->sin_addr), 4);
+				std::memcpy(port, std::addressof(addrIn->sin_port), 2);
+
+				break;
+			}
+
+			case AF_INET6:
+			{
+				const auto* addrIn6 = reinterpret_cast<const struct sockaddr_in6*>(addr);
+
+				std::memcpy(ip, std::addressof(addrIn6->sin6_addr), 16);
+				std::memcpy(port, std::addressof(addrIn6->sin6_port), 2);
+
+				break;
+			}
+		}
+	}
+
 	/* Instance methods. */
 
 	void TransportTuple::FillJson(json& jsonObject) const
@@ -83,4 +117,18 @@ namespace RTC
 
 		MS_DUMP("</TransportTuple>");
 	}
+
+	void TransportTuple::GenerateKey()
+	{
+		MS_TRACE();
+
+		auto* data = reinterpret_cast<uint8_t*>(this->key.words.data());
+
+		PackAddress(GetLocalAddress(), data, data + 32);
+		PackAddress(GetRemoteAddress(), data + 16, data + 34);
+
+		data[36] = static_cast<uint8_t>(this->protocol);
+
+		this->key.hash = absl::Hash<std::array<uint64_t, 5>>{}(this->key.words);
+	}
 } // namespace RTC
@@ -0,0 +1,544 @@
+#define MS_CLASS "RTC::TurnSession"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/TurnSession.hpp"
+#include "Logger.hpp"
+#include "Utils.hpp"
+#include <cstring> // std::memcpy()
+
+namespace RTC
+{
+	/* Static. */
+
+	// Methods.
+	static constexpr uint16_t Binding{ 0x0001 };
+	static constexpr uint16_t Allocate{ 0x0003 };
+	static constexpr uint16_t Refresh{ 0x0004 };
+	static constexpr uint16_t Send{ 0x0006 };
+	static constexpr uint16_t Data{ 0x0007 };
+	static constexpr uint16_t CreatePermission{ 0x0008 };
+	static constexpr uint16_t ChannelBind{ 0x0009 };
+	// Classes.
+	static constexpr uint16_t ClassMask{ 0x0110 };
+	static constexpr uint16_t Request{ 0x0000 };
+	static constexpr uint16_t Indication{ 0x0010 };
+	static constexpr uint16_t SuccessResponse{ 0x0100 };
+	static constexpr uint16_t ErrorResponse{ 0x0110 };
+	// Attributes.
+	static constexpr uint16_t ErrorCodeAttr{ 0x0009 };
+	static constexpr uint16_t ChannelNumberAttr{ 0x000C };
+	static constexpr uint16_t LifetimeAttr{ 0x000D };
+	static constexpr uint16_t XorPeerAddressAttr{ 0x0012 };
+	static constexpr uint16_t DataAttr{ 0x0013 };
+	static constexpr uint16_t XorRelayedAddressAttr{ 0x0016 };
+	static constexpr uint16_t RequestedTransportAttr{ 0x0019 };
+	static constexpr uint16_t XorMappedAddressAttr{ 0x0020 };
+	// Others.
+	static constexpr size_t HeaderSize{ 20u };
+	static constexpr uint8_t MagicCookie[] = { 0x21, 0x12, 0xA4, 0x42 };
+	static constexpr uint8_t ProtocolUdp{ 17u };
+	static constexpr uint16_t MinChannel{ 0x4000 };
+	static constexpr uint16_t MaxChannel{ 0x4FFF };
+
+	static size_t writeHeader(uint8_t* buffer, uint16_t type, const uint8_t* transactionId)
+	{
+		Utils::Byte::Set2Bytes(buffer, 0, type);
+		Utils::Byte::Set2Bytes(buffer, 2, 0u);
+		std::memcpy(buffer + 4, MagicCookie, 4);
+		std::memcpy(buffer + 8, transactionId, 12);
+
+		return HeaderSize;
+	}
+
+	static size_t writeUint32(uint8_t* buffer, uint16_t type, uint32_t value)
+	{
+		Utils::Byte::Set2Bytes(buffer, 0, type);
+		Utils::Byte::Set2Bytes(buffer, 2, 4u);
+		Utils::Byte::Set4Bytes(buffer, 4, value);
+
+		return 8u;
+	}
+
+	static size_t writeErrorCode(uint8_t* buffer, uint16_t errorCode)
+	{
+		Utils::Byte::Set2Bytes(buffer, 0, ErrorCodeAttr);
+		Utils::Byte::Set2Bytes(buffer, 2, 4u);
+		Utils::Byte::Set2Bytes(buffer, 4, 0u);
+		buffer[6] = static_cast<uint8_t>(errorCode / 100);
+		buffer[7] = static_cast<uint8_t>(errorCode % 100);
+
+		return 8u;
+	}
+
+	// XORs the port (with the magic cookie) and the address (with the magic
+	// cookie followed by the transaction ID) of a XOR address attribute value.
+	static void xorAddress(uint8_t* value, size_t len, const uint8_t* transactionId)
+	{
+		value[2] ^= MagicCookie[0];
+		value[3] ^= MagicCookie[1];
+
+		for (size_t i{ 4u }; i < len; ++i)
+		{
+			value[i] ^= i < 8u ? MagicCookie[i - 4] : transactionId[i - 8];
+		}
+	}
+
+	static size_t writeXorAddress(
+	  uint8_t* buffer, uint16_t type, const struct sockaddr* addr, const uint8_t* transactionId)
+	{
+		uint8_t* value = buffer + 4;
+		size_t len;
+
+		value[0] = 0;
+
+		switch (addr->sa_family)
+		{
+			case AF_INET:
+			{
+				const auto* addr4 = reinterpret_cast<const struct sockaddr_in*>(addr);
+
+				value[1] = 0x01;
+				std::memcpy(value + 2, &addr4->sin_port, 2);
+				std::memcpy(value + 4, &addr4->sin_addr.s_addr, 4);
+				len = 8u;
+
+				break;
+			}
+
+			case AF_INET6:
+			{
+				const auto* addr6 = reinterpret_cast<const struct sockaddr_in6*>(addr);
+
+				value[1] = 0x02;
+				std::memcpy(value + 2, &addr6->sin6_port, 2);
+				std::memcpy(value + 4, addr6->sin6_addr.s6_addr, 16);
+				len = 20u;
+
+				break;
+			}
+
+			default:
+			{
+				return 0u;
+			}
+		}
+
+		xorAddress(value, len, transactionId);
+
+		Utils::Byte::Set2Bytes(buffer, 0, type);
+		Utils::Byte::Set2Bytes(buffer, 2, static_cast<uint16_t>(len));
+
+		return 4u + len;
+	}
+
+	static bool readXorAddress(
+	  const uint8_t* value, size_t len, const uint8_t* transactionId, struct sockaddr_storage& addr)
+	{
+		uint8_t copy[20];
+
+		if ((len != 8u || value[1] != 0x01) && (len != 20u || value[1] != 0x02))
+			return false;
+
+		std::memcpy(copy, value, len);
+		xorAddress(copy, len, transactionId);
+		std::memset(&addr, 0, sizeof(addr));
+
+		if (len == 8u)
+		{
+			auto* addr4 = reinterpret_cast<struct sockaddr_in*>(&addr);
+
+			addr4->sin_family = AF_INET;
+			std::memcpy(&addr4->sin_port, copy + 2, 2);
+			std::memcpy(&addr4->sin_addr.s_addr, copy + 4, 4);
+		}
+		else
+		{
+			auto* addr6 = reinterpret_cast<struct sockaddr_in6*>(&addr);
+
+			addr6->sin6_family = AF_INET6;
+			std::memcpy(&addr6->sin6_port, copy + 2, 2);
+			std::memcpy(addr6->sin6_addr.s6_addr, copy + 4, 16);
+		}
+
+		return true;
+	}
+
+	/* Class methods. */
+
+	size_t TurnSession::GetMessageSize(const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		if (len < 4u)
+			return 0u;
+
+		const size_t msgLen = Utils::Byte::Get2Bytes(data, 2);
+
+		// ChannelData messages are padded over TCP.
+		if (IsChannelData(data))
+			return 4u + msgLen + GetPaddingSize(msgLen);
+		else if (data[0] < 0x40)
+			return HeaderSize + msgLen;
+		else
+			return 0u;
+	}
+
+	/* Instance methods. */
+
+	TurnSession::TurnSession(const struct sockaddr* clientAddr, const struct sockaddr* relayedAddr)
+	  : clientAddr(Utils::IP::CopyAddress(clientAddr)), relayedAddr(Utils::IP::CopyAddress(relayedAddr))
+	{
+		MS_TRACE();
+	}
+
+	size_t TurnSession::ProcessMessage(
+	  const uint8_t* msg, size_t len, uint8_t* response, const uint8_t*& data, size_t& dataLen)
+	{
+		MS_TRACE();
+
+		data    = nullptr;
+		dataLen = 0u;
+
+		if (len < HeaderSize)
+			return 0u;
+
+		const uint16_t type          = Utils::Byte::Get2Bytes(msg, 0);
+		const uint16_t klass         = type & ClassMask;
+		const uint16_t method        = type & ~ClassMask;
+		const uint8_t* transactionId = msg + 8;
+		struct sockaddr_storage peerAddr;
+		bool hasPeerAddr{ false };
+		const uint8_t* dataValue{ nullptr };
+		size_t dataValueLen{ 0u };
+		uint16_t channel{ 0u };
+		bool hasLifetime{ false };
+		uint32_t lifetime{ 0u };
+		bool hasRequestedTransport{ false };
+		uint8_t requestedTransport{ 0u };
+		size_t pos{ HeaderSize };
+
+		while (pos + 4u <= len)
+		{
+			const uint16_t attrType = Utils::Byte::Get2Bytes(msg, pos);
+			const size_t attrLen    = Utils::Byte::Get2Bytes(msg, pos + 2);
+			const uint8_t* value    = msg + pos + 4;
+
+			if (pos + 4u + attrLen > len)
+			{
+				MS_WARN_DEV("not enough space for the announced attribute value");
+
+				return 0u;
+			}
+
+			switch (attrType)
+			{
+				case XorPeerAddressAttr:
+				{
+					// Just the first one is used.
+					if (!hasPeerAddr)
+						hasPeerAddr = readXorAddress(value, attrLen, transactionId, peerAddr);
+
+					break;
+				}
+
+				case DataAttr:
+				{
+					dataValue    = value;
+					dataValueLen = attrLen;
+
+					break;
+				}
+
+				case ChannelNumberAttr:
+				{
+					if (attrLen == 4u)
+						channel = Utils::Byte::Get2Bytes(value, 0);
+
+					break;
+				}
+
+				case LifetimeAttr:
+				{
+					if (attrLen == 4u)
+					{
+						hasLifetime = true;
+						lifetime    = Utils::Byte::Get4Bytes(value, 0);
+					}
+
+					break;
+				}
+
+				case RequestedTransportAttr:
+				{
+					if (attrLen == 4u)
+					{
+						hasRequestedTransport = true;
+						requestedTransport    = value[0];
+					}
+
+					break;
+				}
+
+				default:;
+			}
+
+			pos += 4u + attrLen + GetPaddingSize(attrLen);
+		}
+
+		// Data to be sent to the peer (the worker).
+		if (klass == Indication)
+		{
+			if (method == Send && this->allocated && hasPeerAddr && dataValue)
+			{
+				uint16_t peerChannel{ 0u };
+
+				for (const auto& kv : this->channels)
+				{
+					if (Utils::IP::CompareAddresses(
+					      reinterpret_cast<const struct sockaddr*>(&kv.second),
+					      reinterpret_cast<const struct sockaddr*>(&peerAddr)))
+					{
+						peerChannel = kv.first;
+
+						break;
+					}
+				}
+
+				SetPeer(peerAddr, peerChannel);
+
+				data    = dataValue;
+				dataLen = dataValueLen;
+			}
+
+			return 0u;
+		}
+
+		// Ignore responses.
+		if (klass != Request)
+			return 0u;
+
+		uint16_t errorCode{ 0u };
+
+		pos = writeHeader(response, method | SuccessResponse, transactionId);
+
+		switch (method)
+		{
+			case Binding:
+			{
+				pos += writeXorAddress(
+				  response + pos,
+				  XorMappedAddressAttr,
+				  reinterpret_cast<const struct sockaddr*>(&this->clientAddr),
+				  transactionId);
+
+				break;
+			}
+
+			case Allocate:
+			{
+				// Allocation mismatch.
+				if (this->allocated)
+				{
+					errorCode = 437;
+
+					break;
+				}
+				else if (!hasRequestedTransport)
+				{
+					errorCode = 400;
+
+					break;
+				}
+				// Unsupported transport protocol.
+				else if (requestedTransport != ProtocolUdp)
+				{
+					errorCode = 442;
+
+					break;
+				}
+
+				this->allocated = true;
+
+				MS_DEBUG_DEV("allocation created");
+
+				pos += writeXorAddress(
+				  response + pos,
+				  XorRelayedAddressAttr,
+				  reinterpret_cast<const struct sockaddr*>(&this->relayedAddr),
+				  transactionId);
+				pos += writeUint32(response + pos, LifetimeAttr, Lifetime);
+				pos += writeXorAddress(
+				  response + pos,
+				  XorMappedAddressAttr,
+				  reinterpret_cast<const struct sockaddr*>(&this->clientAddr),
+				  transactionId);
+
+				break;
+			}
+
+			case Refresh:
+			{
+				if (!this->allocated)
+				{
+					errorCode = 437;
+
+					break;
+				}
+
+				if (hasLifetime && lifetime == 0u)
+				{
+					this->released = true;
+
+					MS_DEBUG_DEV("allocation released");
+				}
+
+				pos += writeUint32(response + pos, LifetimeAttr, this->released ? 0u : Lifetime);
+
+				break;
+			}
+
+			case CreatePermission:
+			{
+				if (!this->allocated)
+					errorCode = 437;
+				else if (!hasPeerAddr)
+					errorCode = 400;
+
+				break;
+			}
+
+			case ChannelBind:
+			{
+				if (!this->allocated)
+				{
+					errorCode = 437;
+
+					break;
+				}
+				else if (!hasPeerAddr || channel < MinChannel || channel > MaxChannel)
+				{
+					errorCode = 400;
+
+					break;
+				}
+
+				// A channel cannot be bound to another peer and vice versa.
+				for (const auto& kv : this->channels)
+				{
+					const bool samePeer = Utils::IP::CompareAddresses(
+					  reinterpret_cast<const struct sockaddr*>(&kv.second),
+					  reinterpret_cast<const struct sockaddr*>(&peerAddr));
+
+					if ((kv.first == channel) != samePeer)
+					{
+						errorCode = 400;
+
+						break;
+					}
+				}
+
+				if (errorCode == 0u)
+					this->channels[channel] = peerAddr;
+
+				break;
+			}
+
+			default:
+			{
+				MS_WARN_DEV("unsupported request [method:%" PRIu16 "]", method);
+
+				errorCode = 400;
+			}
+		}
+
+		if (errorCode != 0u)
+		{
+			pos = writeHeader(response, method | ErrorResponse, transactionId);
+			pos += writeErrorCode(response + pos, errorCode);
+		}
+
+		Utils::Byte::Set2Bytes(response, 2, static_cast<uint16_t>(pos - HeaderSize));
+
+		return pos;
+	}
+
+	const uint8_t* TurnSession::ProcessChannelData(const uint8_t* msg, size_t len, size_t& dataLen)
+	{
+		MS_TRACE();
+
+		if (len < 4u)
+			return nullptr;
+
+		const uint16_t channel = Utils::Byte::Get2Bytes(msg, 0);
+		const size_t msgLen    = Utils::Byte::Get2Bytes(msg, 2);
+
+		if (4u + msgLen > len)
+			return nullptr;
+
+		auto it = this->channels.find(channel);
+
+		if (it == this->channels.end())
+		{
+			MS_WARN_DEV("data received in unbound channel [channel:%" PRIu16 "]", channel);
+
+			return nullptr;
+		}
+
+		SetPeer(it->second, channel);
+
+		dataLen = msgLen;
+
+		return msg + 4;
+	}
+
+	size_t TurnSession::FillDataHeader(uint8_t* header, size_t dataLen) const
+	{
+		MS_TRACE();
+
+		if (!this->hasPeer)
+			return 0u;
+
+		if (this->peerChannel != 0u)
+		{
+			Utils::Byte::Set2Bytes(header, 0, this->peerChannel);
+			Utils::Byte::Set2Bytes(header, 2, static_cast<uint16_t>(dataLen));
+
+			return 4u;
+		}
+
+		// Otherwise use a Data indication.
+		uint8_t transactionId[12];
+
+		for (auto& byte : transactionId)
+		{
+			byte = static_cast<uint8_t>(Utils::Crypto::GetRandomUInt(0u, 255u));
+		}
+
+		size_t pos = writeHeader(header, Data | Indication, transactionId);
+
+		pos += writeXorAddress(
+		  header + pos,
+		  XorPeerAddressAttr,
+		  reinterpret_cast<const struct sockaddr*>(&this->peerAddr),
+		  transactionId);
+
+		Utils::Byte::Set2Bytes(header, pos, DataAttr);
+		Utils::Byte::Set2Bytes(header, pos + 2, static_cast<uint16_t>(dataLen));
+
+		pos += 4u;
+
+		Utils::Byte::Set2Bytes(
+		  header, 2, static_cast<uint16_t>(pos - HeaderSize + dataLen + GetPaddingSize(dataLen)));
+
+		return pos;
+	}
+
+	void TurnSession::SetPeer(const struct sockaddr_storage& peerAddr, uint16_t channel)
+	{
+		MS_TRACE();
+
+		this->peerAddr    = peerAddr;
+		this->hasPeer     = true;
+		this->peerChannel = channel;
+	}
+} // namespace RTC
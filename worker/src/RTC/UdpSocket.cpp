@@ -26,6 +26,21 @@ namespace RTC
 		MS_TRACE();
 	}
 
+	UdpSocket::UdpSocket(
+	  Listener* listener,
+	  std::string& ip,
+	  uint16_t port,
+	  const struct sockaddr* remoteAddr,
+	  bool reusePort)
+	  : // This may throw.
+	    ::UdpSocketHandler::UdpSocketHandler(
+	      reusePort ? PortManager::BindUdpReusePort(ip, port, remoteAddr)
+	                : PortManager::BindUdp(ip, port)),
+	    listener(listener), fixedPort(true)
+	{
+		MS_TRACE();
+	}
+
 	UdpSocket::~UdpSocket()
 	{
 		MS_TRACE();
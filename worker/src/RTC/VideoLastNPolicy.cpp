@@ -0,0 +1,140 @@
+#define MS_CLASS "RTC::VideoLastNPolicy"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/VideoLastNPolicy.hpp"
+#include "Logger.hpp"
+#include <algorithm> // std::find_if(), std::remove(), std::rotate()
+#include <utility>   // std::move()
+
+namespace RTC
+{
+	/* Instance methods. */
+
+	VideoLastNPolicy::VideoLastNPolicy(Listener* listener, size_t lastN)
+	  : listener(listener), lastN(lastN)
+	{
+		MS_TRACE();
+	}
+
+	void VideoLastNPolicy::AddSpeaker(
+	  RTC::Producer* audioProducer, const std::vector<RTC::Producer*>& videoProducers)
+	{
+		MS_TRACE();
+
+		Speaker speaker;
+
+		speaker.audioProducer  = audioProducer;
+		speaker.videoProducers = videoProducers;
+
+		// New speakers go last.
+		this->speakers.push_back(std::move(speaker));
+
+		ApplySelection();
+	}
+
+	void VideoLastNPolicy::RemoveSpeaker(RTC::Producer* audioProducer)
+	{
+		MS_TRACE();
+
+		auto it = std::find_if(
+		  this->speakers.begin(),
+		  this->speakers.end(),
+		  [audioProducer](const Speaker& speaker) { return speaker.audioProducer == audioProducer; });
+
+		if (it == this->speakers.end())
+			return;
+
+		// Leave its video Producers selected.
+		SetSelected(*it, true);
+
+		this->speakers.erase(it);
+
+		ApplySelection();
+	}
+
+	void VideoLastNPolicy::RemoveVideoProducer(RTC::Producer* videoProducer)
+	{
+		MS_TRACE();
+
+		for (auto& speaker : this->speakers)
+		{
+			auto& videoProducers = speaker.videoProducers;
+
+			videoProducers.erase(
+			  std::remove(videoProducers.begin(), videoProducers.end(), videoProducer),
+			  videoProducers.end());
+		}
+	}
+
+	void VideoLastNPolicy::DominantSpeakerChanged(RTC::Producer* audioProducer)
+	{
+		MS_TRACE();
+
+		auto it = std::find_if(
+		  this->speakers.begin(),
+		  this->speakers.end(),
+		  [audioProducer](const Speaker& speaker) { return speaker.audioProducer == audioProducer; });
+
+		if (it == this->speakers.end())
+			return;
+
+		// Move it to the front.
+		std::rotate(this->speakers.begin(), it, it + 1);
+
+		ApplySelection();
+	}
+
+	bool VideoLastNPolicy::IsSelected(const RTC::Producer* audioProducer) const
+	{
+		MS_TRACE();
+
+		auto it = std::find_if(
+		  this->speakers.begin(),
+		  this->speakers.end(),
+		  [audioProducer](const Speaker& speaker) { return speaker.audioProducer == audioProducer; });
+
+		return it != this->speakers.end() && it->selected;
+	}
+
+	void VideoLastNPolicy::Close()
+	{
+		MS_TRACE();
+
+		for (auto& speaker : this->speakers)
+		{
+			SetSelected(speaker, true);
+		}
+
+		this->speakers.clear();
+	}
+
+	void VideoLastNPolicy::ApplySelection()
+	{
+		MS_TRACE();
+
+		for (size_t idx{ 0u }; idx < this->speakers.size(); ++idx)
+		{
+			SetSelected(this->speakers[idx], idx < this->lastN);
+		}
+	}
+
+	void VideoLastNPolicy::SetSelected(Speaker& speaker, bool selected)
+	{
+		MS_TRACE();
+
+		if (speaker.selected == selected)
+			return;
+
+		speaker.selected = selected;
+
+		MS_DEBUG_DEV(
+		  "speaker %s [videoProducers:%zu]",
+		  selected ? "selected" : "unselected",
+		  speaker.videoProducers.size());
+
+		for (auto* videoProducer : speaker.videoProducers)
+		{
+			this->listener->OnVideoLastNPolicyProducerSelected(this, videoProducer, selected);
+		}
+	}
+} // namespace RTC
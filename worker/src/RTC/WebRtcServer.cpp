@@ -0,0 +1,630 @@
+#define MS_CLASS "RTC::WebRtcServer"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "RTC/WebRtcServer.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "Utils.hpp"
+#include <cmath> // std::pow()
+
+namespace RTC
+{
+	/* Static. */
+
+	static constexpr uint16_t IceCandidateDefaultLocalPriority{ 10000 };
+	// We just provide "host" candidates so type preference is fixed.
+	static constexpr uint16_t IceTypePreference{ 64 };
+	// We do not support non rtcp-mux so component is always 1.
+	static constexpr uint16_t IceComponent{ 1 };
+	// Max number of listenInfos (same limit as WebRtcTransport listenIps).
+	static constexpr size_t MaxListenInfos{ 8 };
+	// Chars of ICE usernameFragments, the one at reusePortIndex is the prefix.
+	static constexpr char ReusePortIceUsernameFragmentPrefixes[]{
+		"0123456789abcdefghijklmnopqrstuvwxyz"
+	};
+	static constexpr size_t MaxReusePortIndex{ sizeof(ReusePortIceUsernameFragmentPrefixes) - 2 };
+
+	static inline uint32_t generateIceCandidatePriority(uint16_t localPreference)
+	{
+		MS_TRACE();
+
+		return std::pow(2, 24) * IceTypePreference + std::pow(2, 8) * localPreference +
+		       std::pow(2, 0) * (256 - IceComponent);
+	}
+
+	/* Instance methods. */
+
+	WebRtcServer::WebRtcServer(const std::string& id, json& data) : id(id)
+	{
+		MS_TRACE();
+
+		auto jsonListenInfosIt = data.find("listenInfos");
+
+		if (jsonListenInfosIt == data.end())
+			MS_THROW_TYPE_ERROR("missing listenInfos");
+		else if (!jsonListenInfosIt->is_array())
+			MS_THROW_TYPE_ERROR("wrong listenInfos (not an array)");
+		else if (jsonListenInfosIt->empty())
+			MS_THROW_TYPE_ERROR("wrong listenInfos (empty array)");
+		else if (jsonListenInfosIt->size() > MaxListenInfos)
+			MS_THROW_TYPE_ERROR("wrong listenInfos (too many entries)");
+
+		auto jsonReusePortIndexIt = data.find("reusePortIndex");
+
+		if (jsonReusePortIndexIt != data.end())
+		{
+			// clang-format off
+			if (
+				!jsonReusePortIndexIt->is_number_unsigned() ||
+				jsonReusePortIndexIt->get<size_t>() > MaxReusePortIndex
+			)
+			// clang-format on
+			{
+				MS_THROW_TYPE_ERROR("wrong reusePortIndex (not a number from 0 to %zu)", MaxReusePortIndex);
+			}
+
+			this->reusePortIndex = jsonReusePortIndexIt->get<int8_t>();
+			this->iceUsernameFragmentPrefix.assign(
+			  1, ReusePortIceUsernameFragmentPrefixes[this->reusePortIndex]);
+		}
+
+		try
+		{
+			this->udpSocketOrTcpServers.reserve(jsonListenInfosIt->size());
+
+			for (auto& jsonListenInfo : *jsonListenInfosIt)
+			{
+				if (!jsonListenInfo.is_object())
+					MS_THROW_TYPE_ERROR("wrong listenInfo (not an object)");
+
+				auto jsonProtocolIt = jsonListenInfo.find("protocol");
+
+				if (jsonProtocolIt == jsonListenInfo.end())
+					MS_THROW_TYPE_ERROR("missing listenInfo.protocol");
+				else if (!jsonProtocolIt->is_string())
+					MS_THROW_TYPE_ERROR("wrong listenInfo.protocol (not an string)");
+
+				std::string protocol = jsonProtocolIt->get<std::string>();
+
+				if (protocol != "udp" && protocol != "tcp")
+					MS_THROW_TYPE_ERROR("invalid listenInfo.protocol (must be 'udp' or 'tcp')");
+
+				auto jsonIpIt = jsonListenInfo.find("ip");
+
+				if (jsonIpIt == jsonListenInfo.end())
+					MS_THROW_TYPE_ERROR("missing listenInfo.ip");
+				else if (!jsonIpIt->is_string())
+					MS_THROW_TYPE_ERROR("wrong listenInfo.ip (not an string)");
+
+				std::string ip = jsonIpIt->get<std::string>();
+
+				// This may throw.
+				Utils::IP::NormalizeIp(ip);
+
+				std::string announcedIp;
+				auto jsonAnnouncedIpIt = jsonListenInfo.find("announcedIp");
+
+				if (jsonAnnouncedIpIt != jsonListenInfo.end())
+				{
+					if (!jsonAnnouncedIpIt->is_string())
+						MS_THROW_TYPE_ERROR("wrong listenInfo.announcedIp (not an string)");
+
+					announcedIp = jsonAnnouncedIpIt->get<std::string>();
+				}
+
+				uint16_t port{ 0 };
+				auto jsonPortIt = jsonListenInfo.find("port");
+
+				if (jsonPortIt != jsonListenInfo.end())
+				{
+					if (!(jsonPortIt->is_number() && Utils::Json::IsPositiveInteger(*jsonPortIt)))
+						MS_THROW_TYPE_ERROR("wrong listenInfo.port (not a positive number)");
+
+					port = jsonPortIt->get<uint16_t>();
+				}
+
+				if (protocol == "udp")
+				{
+					// This may throw.
+					RTC::UdpSocket* udpSocket;
+
+					if (this->reusePortIndex >= 0)
+					{
+						if (port == 0)
+							MS_THROW_TYPE_ERROR("reusePortIndex requires listenInfo.port in udp entries");
+
+						udpSocket = new RTC::UdpSocket(this, ip, port, nullptr, true);
+					}
+					else if (port != 0)
+					{
+						udpSocket = new RTC::UdpSocket(this, ip, port);
+					}
+					else
+					{
+						udpSocket = new RTC::UdpSocket(this, ip);
+					}
+
+					this->udpSocketOrTcpServers.emplace_back(udpSocket, nullptr, announcedIp);
+				}
+				else
+				{
+					// This may throw.
+					RTC::TcpServer* tcpServer;
+
+					if (port != 0)
+						tcpServer = new RTC::TcpServer(this, this, ip, port);
+					else
+						tcpServer = new RTC::TcpServer(this, this, ip);
+
+					this->udpSocketOrTcpServers.emplace_back(nullptr, tcpServer, announcedIp);
+				}
+			}
+		}
+		catch (const MediaSoupError& error)
+		{
+			// Must delete everything since the destructor won't be called.
+
+			for (auto& item : this->udpSocketOrTcpServers)
+			{
+				delete item.udpSocket;
+				delete item.tcpServer;
+			}
+			this->udpSocketOrTcpServers.clear();
+
+			throw;
+		}
+	}
+
+	WebRtcServer::~WebRtcServer()
+	{
+		MS_TRACE();
+
+		// NOTE: We need to close WebRtcTransports first since they may need to
+		// send DTLS alerts over the UDP sockets and TCP connections owned by us.
+		// Move the set out so the callbacks fired by the closing WebRtcTransports
+		// do not modify the container being iterated.
+		auto webRtcTransports = std::move(this->webRtcTransports);
+
+		this->webRtcTransports.clear();
+
+		for (auto* webRtcTransport : webRtcTransports)
+		{
+			// NOTE: The parent Router will close (and delete) the WebRtcTransport.
+			webRtcTransport->ListenServerClosed();
+		}
+
+		this->mapLocalIceUsernameFragmentWebRtcTransport.clear();
+		this->mapTupleWebRtcTransport.clear();
+
+		for (auto& kv : this->mapTupleConnectedUdpSocket)
+		{
+			auto* connectedUdpSocket = kv.second;
+
+			delete connectedUdpSocket;
+		}
+		this->mapTupleConnectedUdpSocket.clear();
+		this->mapConnectedUdpSocketUdpSocket.clear();
+
+		for (auto& item : this->udpSocketOrTcpServers)
+		{
+			delete item.udpSocket;
+			delete item.tcpServer;
+		}
+		this->udpSocketOrTcpServers.clear();
+	}
+
+	void WebRtcServer::FillJson(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		// Add id.
+		jsonObject["id"] = this->id;
+
+		// Add udpSockets and tcpServers.
+		jsonObject["udpSockets"] = json::array();
+		auto jsonUdpSocketsIt    = jsonObject.find("udpSockets");
+		jsonObject["tcpServers"] = json::array();
+		auto jsonTcpServersIt    = jsonObject.find("tcpServers");
+
+		for (const auto& item : this->udpSocketOrTcpServers)
+		{
+			if (item.udpSocket)
+			{
+				jsonUdpSocketsIt->emplace_back(json::value_t::object);
+
+				auto& jsonEntry = (*jsonUdpSocketsIt)[jsonUdpSocketsIt->size() - 1];
+
+				jsonEntry["ip"]   = item.udpSocket->GetLocalIp();
+				jsonEntry["port"] = item.udpSocket->GetLocalPort();
+			}
+			else if (item.tcpServer)
+			{
+				jsonTcpServersIt->emplace_back(json::value_t::object);
+
+				auto& jsonEntry = (*jsonTcpServersIt)[jsonTcpServersIt->size() - 1];
+
+				jsonEntry["ip"]   = item.tcpServer->GetLocalIp();
+				jsonEntry["port"] = item.tcpServer->GetLocalPort();
+			}
+		}
+
+		// Add reusePortIndex.
+		if (this->reusePortIndex >= 0)
+		{
+			jsonObject["reusePortIndex"]      = this->reusePortIndex;
+			jsonObject["connectedUdpSockets"] = this->mapTupleConnectedUdpSocket.size();
+		}
+
+		// Add webRtcTransportIds.
+		jsonObject["webRtcTransportIds"] = json::array();
+		auto jsonWebRtcTransportIdsIt    = jsonObject.find("webRtcTransportIds");
+
+		for (auto* webRtcTransport : this->webRtcTransports)
+		{
+			jsonWebRtcTransportIdsIt->emplace_back(webRtcTransport->id);
+		}
+
+		// Add localIceUsernameFragments.
+		jsonObject["localIceUsernameFragments"] = json::array();
+		auto jsonLocalIceUsernameFragmentsIt    = jsonObject.find("localIceUsernameFragments");
+
+		for (const auto& kv : this->mapLocalIceUsernameFragmentWebRtcTransport)
+		{
+			const auto& localIceUsernameFragment = kv.first;
+			auto* webRtcTransport                = kv.second;
+
+			jsonLocalIceUsernameFragmentsIt->emplace_back(json::value_t::object);
+
+			auto& jsonEntry =
+			  (*jsonLocalIceUsernameFragmentsIt)[jsonLocalIceUsernameFragmentsIt->size() - 1];
+
+			jsonEntry["localIceUsernameFragment"] = localIceUsernameFragment;
+			jsonEntry["webRtcTransportId"]        = webRtcTransport->id;
+		}
+
+		// Add tupleHashes.
+		jsonObject["tupleHashes"] = json::array();
+		auto jsonTupleHashesIt    = jsonObject.find("tupleHashes");
+
+		for (const auto& kv : this->mapTupleWebRtcTransport)
+		{
+			const auto& tupleKey  = kv.first;
+			auto* webRtcTransport = kv.second;
+
+			jsonTupleHashesIt->emplace_back(json::value_t::object);
+
+			auto& jsonEntry = (*jsonTupleHashesIt)[jsonTupleHashesIt->size() - 1];
+
+			jsonEntry["tupleHash"]         = tupleKey.hash;
+			jsonEntry["webRtcTransportId"] = webRtcTransport->id;
+		}
+	}
+
+	void WebRtcServer::HandleRequest(Channel::ChannelRequest* request)
+	{
+		MS_TRACE();
+
+		switch (request->methodId)
+		{
+			case Channel::ChannelRequest::MethodId::WEBRTC_SERVER_DUMP:
+			{
+				json data = json::object();
+
+				FillJson(data);
+
+				request->Accept(data);
+
+				break;
+			}
+
+			default:
+			{
+				MS_THROW_ERROR("unknown method '%s'", request->method.c_str());
+			}
+		}
+	}
+
+	std::vector<RTC::IceCandidate> WebRtcServer::GetIceCandidates(
+	  bool enableUdp, bool enableTcp, bool preferUdp, bool preferTcp)
+	{
+		MS_TRACE();
+
+		std::vector<RTC::IceCandidate> iceCandidates;
+		uint16_t iceLocalPreferenceDecrement{ 0 };
+
+		for (auto& item : this->udpSocketOrTcpServers)
+		{
+			if (item.udpSocket && enableUdp)
+			{
+				uint16_t iceLocalPreference = IceCandidateDefaultLocalPriority - iceLocalPreferenceDecrement;
+
+				if (preferUdp)
+					iceLocalPreference += 1000;
+
+				uint32_t icePriority = generateIceCandidatePriority(iceLocalPreference);
+
+				if (item.announcedIp.empty())
+					iceCandidates.emplace_back(item.udpSocket, icePriority);
+				else
+					iceCandidates.emplace_back(item.udpSocket, icePriority, item.announcedIp);
+			}
+			else if (item.tcpServer && enableTcp)
+			{
+				uint16_t iceLocalPreference = IceCandidateDefaultLocalPriority - iceLocalPreferenceDecrement;
+
+				if (preferTcp)
+					iceLocalPreference += 1000;
+
+				uint32_t icePriority = generateIceCandidatePriority(iceLocalPreference);
+
+				if (item.announcedIp.empty())
+					iceCandidates.emplace_back(item.tcpServer, icePriority);
+				else
+					iceCandidates.emplace_back(item.tcpServer, icePriority, item.announcedIp);
+			}
+
+			// Decrement initial ICE local preference for next IP.
+			iceLocalPreferenceDecrement += 100;
+		}
+
+		return iceCandidates;
+	}
+
+	inline std::string WebRtcServer::GetLocalIceUsernameFragmentFromReceivedStunPacket(
+	  RTC::StunPacket* packet) const
+	{
+		MS_TRACE();
+
+		// Here we inspect the USERNAME attribute of a received STUN request and
+		// extract its remote usernameFragment (the one given to our IceServer as
+		// local usernameFragment) which is the first value in the attribute value
+		// before the ":" symbol.
+
+		const auto& username = packet->GetUsername();
+		const size_t colonPos = username.find(':');
+
+		// If no colon is found just return the whole USERNAME attribute value.
+		if (colonPos == std::string::npos)
+			return username;
+
+		return username.substr(0, colonPos);
+	}
+
+	inline void WebRtcServer::OnPacketReceived(
+	  RTC::TransportTuple* tuple, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		if (RTC::StunPacket::IsStun(data, len))
+			OnStunDataReceived(tuple, data, len);
+		else
+			OnNonStunDataReceived(tuple, data, len);
+	}
+
+	inline void WebRtcServer::OnStunDataReceived(
+	  RTC::TransportTuple* tuple, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		RTC::StunPacket* packet = RTC::StunPacket::Parse(data, len);
+
+		if (!packet)
+		{
+			MS_WARN_DEV("ignoring wrong STUN packet received");
+
+			return;
+		}
+
+		// First try to match the local ICE username fragment.
+		auto key = GetLocalIceUsernameFragmentFromReceivedStunPacket(packet);
+		auto it  = this->mapLocalIceUsernameFragmentWebRtcTransport.find(key);
+
+		if (it != this->mapLocalIceUsernameFragmentWebRtcTransport.end())
+		{
+			auto* webRtcTransport = it->second;
+
+			webRtcTransport->ProcessStunPacketFromWebRtcServer(tuple, packet);
+
+			delete packet;
+
+			return;
+		}
+
+		// Otherwise try doing lookup in the tuples table (STUN packets without
+		// USERNAME are handled this way).
+		auto it2 = this->mapTupleWebRtcTransport.find(tuple->key);
+
+		if (it2 == this->mapTupleWebRtcTransport.end())
+		{
+			MS_WARN_TAG(ice, "ignoring received STUN packet with unknown remote ICE usernameFragment");
+
+			delete packet;
+
+			return;
+		}
+
+		auto* webRtcTransport = it2->second;
+
+		webRtcTransport->ProcessStunPacketFromWebRtcServer(tuple, packet);
+
+		delete packet;
+	}
+
+	inline void WebRtcServer::OnNonStunDataReceived(
+	  RTC::TransportTuple* tuple, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		auto it = this->mapTupleWebRtcTransport.find(tuple->key);
+
+		if (it == this->mapTupleWebRtcTransport.end())
+		{
+			MS_WARN_DEV("ignoring received non STUN data from unknown tuple");
+
+			return;
+		}
+
+		auto* webRtcTransport = it->second;
+
+		webRtcTransport->ProcessNonStunPacketFromWebRtcServer(tuple, data, len);
+	}
+
+	inline void WebRtcServer::OnWebRtcTransportCreated(RTC::WebRtcTransport* webRtcTransport)
+	{
+		MS_TRACE();
+
+		MS_ASSERT(
+		  this->webRtcTransports.find(webRtcTransport) == this->webRtcTransports.end(),
+		  "WebRtcTransport already handled");
+
+		this->webRtcTransports.insert(webRtcTransport);
+	}
+
+	inline void WebRtcServer::OnWebRtcTransportClosed(RTC::WebRtcTransport* webRtcTransport)
+	{
+		MS_TRACE();
+
+		// NOTE: It may not be present if we are being destroyed.
+		this->webRtcTransports.erase(webRtcTransport);
+	}
+
+	inline void WebRtcServer::OnWebRtcTransportLocalIceUsernameFragmentAdded(
+	  RTC::WebRtcTransport* webRtcTransport, const std::string& usernameFragment)
+	{
+		MS_TRACE();
+
+		if (
+		  this->mapLocalIceUsernameFragmentWebRtcTransport.find(usernameFragment) !=
+		  this->mapLocalIceUsernameFragmentWebRtcTransport.end())
+		{
+			MS_WARN_TAG(
+			  ice,
+			  "ignoring local ICE usernameFragment already handled by another WebRtcTransport [usernameFragment:%s]",
+			  usernameFragment.c_str());
+
+			return;
+		}
+
+		this->mapLocalIceUsernameFragmentWebRtcTransport[usernameFragment] = webRtcTransport;
+	}
+
+	inline void WebRtcServer::OnWebRtcTransportLocalIceUsernameFragmentRemoved(
+	  RTC::WebRtcTransport* webRtcTransport, const std::string& usernameFragment)
+	{
+		MS_TRACE();
+
+		auto it = this->mapLocalIceUsernameFragmentWebRtcTransport.find(usernameFragment);
+
+		// NOTE: Only remove it if it belongs to this WebRtcTransport.
+		if (it != this->mapLocalIceUsernameFragmentWebRtcTransport.end() && it->second == webRtcTransport)
+			this->mapLocalIceUsernameFragmentWebRtcTransport.erase(it);
+	}
+
+	inline void WebRtcServer::OnWebRtcTransportTransportTupleAdded(
+	  RTC::WebRtcTransport* webRtcTransport, RTC::TransportTuple* tuple)
+	{
+		MS_TRACE();
+
+		if (this->mapTupleWebRtcTransport.find(tuple->key) != this->mapTupleWebRtcTransport.end())
+		{
+			MS_WARN_TAG(ice, "ignoring tuple already handled by another WebRtcTransport");
+
+			return;
+		}
+
+		this->mapTupleWebRtcTransport[tuple->key] = webRtcTransport;
+
+		// Packets of the tuple must reach this worker without going through the
+		// reuseport steering program, so connect a socket to it (the kernel
+		// prefers connected sockets).
+		if (this->reusePortIndex >= 0 && tuple->GetProtocol() == RTC::TransportTuple::Protocol::UDP)
+		{
+			auto* udpSocket = tuple->GetUdpSocket();
+			auto localIp    = udpSocket->GetLocalIp();
+
+			try
+			{
+				auto* connectedUdpSocket = new RTC::UdpSocket(
+				  this, localIp, udpSocket->GetLocalPort(), tuple->GetRemoteAddress(), true);
+
+				this->mapTupleConnectedUdpSocket[tuple->key]            = connectedUdpSocket;
+				this->mapConnectedUdpSocketUdpSocket[connectedUdpSocket] = udpSocket;
+			}
+			catch (const MediaSoupError& error)
+			{
+				MS_WARN_TAG(ice, "could not connect a UDP socket to the tuple: %s", error.what());
+			}
+		}
+	}
+
+	inline void WebRtcServer::OnWebRtcTransportTransportTupleRemoved(
+	  RTC::WebRtcTransport* webRtcTransport, RTC::TransportTuple* tuple)
+	{
+		MS_TRACE();
+
+		auto it = this->mapTupleWebRtcTransport.find(tuple->key);
+
+		// NOTE: Only remove it if it belongs to this WebRtcTransport.
+		if (it == this->mapTupleWebRtcTransport.end() || it->second != webRtcTransport)
+			return;
+
+		this->mapTupleWebRtcTransport.erase(it);
+
+		auto it2 = this->mapTupleConnectedUdpSocket.find(tuple->key);
+
+		if (it2 != this->mapTupleConnectedUdpSocket.end())
+		{
+			auto* connectedUdpSocket = it2->second;
+
+			this->mapTupleConnectedUdpSocket.erase(it2);
+			this->mapConnectedUdpSocketUdpSocket.erase(connectedUdpSocket);
+
+			delete connectedUdpSocket;
+		}
+	}
+
+	inline void WebRtcServer::OnUdpSocketPacketReceived(
+	  RTC::UdpSocket* socket, const uint8_t* data, size_t len, const struct sockaddr* remoteAddr)
+	{
+		MS_TRACE();
+
+		// Packets received by a connected UDP socket belong to the tuple of the
+		// listening one.
+		auto it = this->mapConnectedUdpSocketUdpSocket.find(socket);
+
+		if (it != this->mapConnectedUdpSocketUdpSocket.end())
+			socket = it->second;
+
+		RTC::TransportTuple tuple(socket, remoteAddr);
+
+		OnPacketReceived(&tuple, data, len);
+	}
+
+	inline void WebRtcServer::OnRtcTcpConnectionClosed(
+	  RTC::TcpServer* /*tcpServer*/, RTC::TcpConnection* connection)
+	{
+		MS_TRACE();
+
+		RTC::TransportTuple tuple(connection);
+
+		auto it = this->mapTupleWebRtcTransport.find(tuple.key);
+
+		if (it == this->mapTupleWebRtcTransport.end())
+			return;
+
+		auto* webRtcTransport = it->second;
+
+		// NOTE: This will fire OnWebRtcTransportTransportTupleRemoved().
+		webRtcTransport->RemoveTuple(&tuple);
+	}
+
+	inline void WebRtcServer::OnTcpConnectionPacketReceived(
+	  RTC::TcpConnection* connection, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		RTC::TransportTuple tuple(connection);
+
+		OnPacketReceived(&tuple, data, len);
+	}
+} // namespace RTC
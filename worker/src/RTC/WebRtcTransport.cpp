@@ -2,10 +2,12 @@
 // #define MS_LOG_DEV_LEVEL 3
 
 #include "RTC/WebRtcTransport.hpp"
+#include "DepLibUV.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
 #include "Utils.hpp"
 #include "Channel/ChannelNotifier.hpp"
+#include "RTC/JoinLatency.hpp"
 #include <cmath> // std::pow()
 
 namespace RTC
@@ -33,6 +35,8 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		this->createdAtMs = DepLibUV::GetTimeMs();
+
 		bool enableUdp{ true };
 		auto jsonEnableUdpIt = data.find("enableUdp");
 
@@ -197,9 +201,11 @@ namespace RTC
 				iceLocalPreferenceDecrement += 100;
 			}
 
+			RTC::TransportArena::Scope arenaScope(this->arena);
+
 			// Create a ICE server.
 			this->iceServer = new RTC::IceServer(
-			  this, Utils::Crypto::GetRandomString(16), Utils::Crypto::GetRandomString(32));
+			  this, GenerateIceUsernameFragment(), Utils::Crypto::GetRandomString(32));
 
 			// Create a DTLS transport.
 			this->dtlsTransport = new RTC::DtlsTransport(this);
@@ -236,6 +242,57 @@ namespace RTC
 		}
 	}
 
+	/**
+	 * This constructor is used when the WebRtcTransport uses a WebRtcServer.
+	 */
+	WebRtcTransport::WebRtcTransport(
+	  const std::string& id,
+	  RTC::Transport::Listener* listener,
+	  WebRtcTransportListener* webRtcTransportListener,
+	  std::vector<RTC::IceCandidate>& iceCandidates,
+	  const std::string& iceUsernameFragmentPrefix,
+	  json& data)
+	  : RTC::Transport::Transport(id, listener, data),
+	    webRtcTransportListener(webRtcTransportListener), iceCandidates(iceCandidates),
+	    iceUsernameFragmentPrefix(iceUsernameFragmentPrefix)
+	{
+		MS_TRACE();
+
+		this->createdAtMs = DepLibUV::GetTimeMs();
+
+		try
+		{
+			if (iceCandidates.empty())
+				MS_THROW_TYPE_ERROR("empty iceCandidates");
+
+			RTC::TransportArena::Scope arenaScope(this->arena);
+
+			// Create a ICE server.
+			this->iceServer = new RTC::IceServer(
+			  this, GenerateIceUsernameFragment(), Utils::Crypto::GetRandomString(32));
+
+			// Create a DTLS transport.
+			this->dtlsTransport = new RTC::DtlsTransport(this);
+
+			// Notify the webRtcTransportListener.
+			this->webRtcTransportListener->OnWebRtcTransportCreated(this);
+		}
+		catch (const MediaSoupError& error)
+		{
+			// Must delete everything since the destructor won't be called.
+
+			delete this->dtlsTransport;
+			this->dtlsTransport = nullptr;
+
+			delete this->iceServer;
+			this->iceServer = nullptr;
+
+			this->iceCandidates.clear();
+
+			throw;
+		}
+	}
+
 	WebRtcTransport::~WebRtcTransport()
 	{
 		MS_TRACE();
@@ -245,9 +302,14 @@ namespace RTC
 		delete this->dtlsTransport;
 		this->dtlsTransport = nullptr;
 
+		// Deleting the IceServer notifies the removal of its usernameFragments and
+		// tuples, so it must happen before notifying the webRtcTransportListener.
 		delete this->iceServer;
 		this->iceServer = nullptr;
 
+		if (this->webRtcTransportListener)
+			this->webRtcTransportListener->OnWebRtcTransportClosed(this);
+
 		for (auto& kv : this->udpSockets)
 		{
 			auto* udpSocket = kv.first;
@@ -266,6 +328,9 @@ namespace RTC
 
 		this->iceCandidates.clear();
 
+		RTC::SrtpEncryptPool::RemoveListener(this);
+		RTC::SrtpDecryptPool::RemoveListener(this);
+
 		delete this->srtpSendSession;
 		this->srtpSendSession = nullptr;
 
@@ -417,12 +482,28 @@ namespace RTC
 				break;
 		}
 
-		if (this->iceServer->GetSelectedTuple())
+		auto* selectedTuple = this->iceServer->GetSelectedTuple();
+
+		if (selectedTuple)
 		{
 			// Add iceSelectedTuple.
-			this->iceServer->GetSelectedTuple()->FillJson(jsonObject["iceSelectedTuple"]);
+			selectedTuple->FillJson(jsonObject["iceSelectedTuple"]);
+
+			// Add udpSocket.
+			if (selectedTuple->GetProtocol() == RTC::TransportTuple::Protocol::UDP)
+				selectedTuple->GetUdpSocket()->FillJsonStats(jsonObject["udpSocket"]);
+
+			// Add tcpConnection.
+			if (selectedTuple->GetProtocol() == RTC::TransportTuple::Protocol::TCP)
+				selectedTuple->GetTcpConnection()->FillJsonStats(jsonObject["tcpConnection"]);
 		}
 
+		// Add iceTupleCount.
+		jsonObject["iceTupleCount"] = this->iceServer->GetTupleCount();
+
+		// Add ingressDrops.
+		this->ingressPolicer.FillJson(jsonObject["ingressDrops"]);
+
 		// Add dtlsState.
 		switch (this->dtlsTransport->GetState())
 		{
@@ -442,6 +523,71 @@ namespace RTC
 				jsonObject["dtlsState"] = "closed";
 				break;
 		}
+
+		// Add joinLatency (durations of the phases done so far).
+		if (this->iceBindingAtMs != 0u)
+		{
+			auto& jsonJoinLatency = jsonObject["joinLatency"];
+
+			jsonJoinLatency["iceBindingMs"] = this->iceBindingAtMs - this->createdAtMs;
+
+			if (this->iceConnectedAtMs != 0u)
+				jsonJoinLatency["iceConnectMs"] = this->iceConnectedAtMs - this->iceBindingAtMs;
+
+			if (this->dtlsConnectedAtMs != 0u)
+				jsonJoinLatency["dtlsConnectMs"] = this->dtlsConnectedAtMs - this->iceConnectedAtMs;
+		}
+	}
+
+	void WebRtcTransport::FillJsonState(json& jsonObject) const
+	{
+		MS_TRACE();
+
+		// Call the parent method.
+		RTC::Transport::FillJsonState(jsonObject);
+
+		if (!this->srtpSendSession || !this->srtpRecvSession)
+			return;
+
+		// Add srtpState.
+		jsonObject["srtpState"] = json::object();
+		auto jsonSrtpStateIt    = jsonObject.find("srtpState");
+
+		switch (this->srtpCryptoSuite)
+		{
+			case RTC::SrtpSession::CryptoSuite::AEAD_AES_256_GCM:
+			{
+				(*jsonSrtpStateIt)["cryptoSuite"] = "AEAD_AES_256_GCM";
+
+				break;
+			}
+
+			case RTC::SrtpSession::CryptoSuite::AEAD_AES_128_GCM:
+			{
+				(*jsonSrtpStateIt)["cryptoSuite"] = "AEAD_AES_128_GCM";
+
+				break;
+			}
+
+			case RTC::SrtpSession::CryptoSuite::AES_CM_128_HMAC_SHA1_80:
+			{
+				(*jsonSrtpStateIt)["cryptoSuite"] = "AES_CM_128_HMAC_SHA1_80";
+
+				break;
+			}
+
+			case RTC::SrtpSession::CryptoSuite::AES_CM_128_HMAC_SHA1_32:
+			{
+				(*jsonSrtpStateIt)["cryptoSuite"] = "AES_CM_128_HMAC_SHA1_32";
+
+				break;
+			}
+
+			default:;
+		}
+
+		(*jsonSrtpStateIt)["localKeyBase64"]  = this->srtpLocalKeyBase64;
+		(*jsonSrtpStateIt)["remoteKeyBase64"] = this->srtpRemoteKeyBase64;
 	}
 
 	void WebRtcTransport::HandleRequest(Channel::ChannelRequest* request)
@@ -582,7 +728,7 @@ namespace RTC
 
 			case Channel::ChannelRequest::MethodId::TRANSPORT_RESTART_ICE:
 			{
-				std::string usernameFragment = Utils::Crypto::GetRandomString(16);
+				std::string usernameFragment = GenerateIceUsernameFragment();
 				std::string password         = Utils::Crypto::GetRandomString(32);
 
 				this->iceServer->RestartIce(usernameFragment, password);
@@ -621,6 +767,14 @@ namespace RTC
 		RTC::Transport::HandleNotification(notification);
 	}
 
+	inline std::string WebRtcTransport::GenerateIceUsernameFragment() const
+	{
+		MS_TRACE();
+
+		return this->iceUsernameFragmentPrefix +
+		       Utils::Crypto::GetRandomString(16 - this->iceUsernameFragmentPrefix.size());
+	}
+
 	inline bool WebRtcTransport::IsConnected() const
 	{
 		MS_TRACE();
@@ -636,6 +790,42 @@ namespace RTC
 		// clang-format on
 	}
 
+	inline void WebRtcTransport::MayRecordIceBinding(const RTC::StunPacket* packet)
+	{
+		MS_TRACE();
+
+		// Just the first ICE Binding request.
+		// clang-format off
+		if (
+			this->iceBindingAtMs != 0u ||
+			packet->GetMethod() != RTC::StunPacket::Method::BINDING ||
+			packet->GetClass() != RTC::StunPacket::Class::REQUEST
+		)
+		// clang-format on
+		{
+			return;
+		}
+
+		this->iceBindingAtMs = DepLibUV::GetTimeMs();
+
+		RTC::JoinLatency::Record(
+		  RTC::JoinLatency::Phase::ICE_BINDING, this->iceBindingAtMs - this->createdAtMs);
+	}
+
+	inline void WebRtcTransport::MayRecordIceConnected()
+	{
+		MS_TRACE();
+
+		// Just the first time (not after an ICE disconnection or restart).
+		if (this->iceConnectedAtMs != 0u)
+			return;
+
+		this->iceConnectedAtMs = DepLibUV::GetTimeMs();
+
+		RTC::JoinLatency::Record(
+		  RTC::JoinLatency::Phase::ICE_CONNECT, this->iceConnectedAtMs - this->iceBindingAtMs);
+	}
+
 	void WebRtcTransport::MayRunDtlsTransport()
 	{
 		MS_TRACE();
@@ -727,10 +917,7 @@ namespace RTC
 		if (!IsConnected())
 		{
 			if (cb)
-			{
 				(*cb)(false);
-				delete cb;
-			}
 
 			return;
 		}
@@ -741,31 +928,67 @@ namespace RTC
 			MS_WARN_DEV("ignoring RTP packet due to non sending SRTP session");
 
 			if (cb)
-			{
 				(*cb)(false);
-				delete cb;
+
+			return;
+		}
+
+		// Let the SRTP encrypt pool (if enabled) encrypt and send it.
+		// clang-format off
+		if (
+			RTC::SrtpEncryptPool::IsEnabled() &&
+			RTC::SrtpEncryptPool::EncryptRtp(
+				this, this->srtpSendSession, packet->GetData(), packet->GetSize())
+		)
+		// clang-format on
+		{
+			// The packet is owned by the pool now, so consider it sent.
+			if (cb)
+				(*cb)(true);
+
+			return;
+		}
+
+		auto* tuple = this->iceServer->GetSelectedTuple();
+		auto intLen = static_cast<int>(packet->GetSize());
+
+		// If possible, encrypt the packet straight into the egress buffer of the
+		// socket so it's not copied again.
+		auto* buffer = tuple->GetSendBuffer(packet->GetSize() + RTC::SrtpSession::MaxTrailerSize);
+
+		if (buffer)
+		{
+			if (!this->srtpSendSession->EncryptRtp(packet->GetData(), &intLen, buffer))
+			{
+				if (cb)
+					(*cb)(false);
+
+				return;
 			}
 
+			auto len = static_cast<size_t>(intLen);
+
+			tuple->SendBuffer(len, cb);
+
+			// Increase send transmission.
+			RTC::Transport::DataSent(len);
+
 			return;
 		}
 
 		const uint8_t* data = packet->GetData();
-		auto intLen         = static_cast<int>(packet->GetSize());
 
 		if (!this->srtpSendSession->EncryptRtp(&data, &intLen))
 		{
 			if (cb)
-			{
 				(*cb)(false);
-				delete cb;
-			}
 
 			return;
 		}
 
 		auto len = static_cast<size_t>(intLen);
 
-		this->iceServer->GetSelectedTuple()->Send(data, len, cb);
+		tuple->Send(data, len, cb);
 
 		// Increase send transmission.
 		RTC::Transport::DataSent(len);
@@ -858,6 +1081,9 @@ namespace RTC
 
 		if (this->srtpRecvSession)
 		{
+			// Pool threads may be decrypting packets of this stream.
+			RTC::SrtpDecryptPool::Flush(this);
+
 			this->srtpRecvSession->RemoveStream(ssrc);
 		}
 	}
@@ -868,10 +1094,66 @@ namespace RTC
 
 		if (this->srtpSendSession)
 		{
+			// Pool threads may be encrypting packets of this stream.
+			RTC::SrtpEncryptPool::Flush(this);
+
 			this->srtpSendSession->RemoveStream(ssrc);
 		}
 	}
 
+	void WebRtcTransport::ProcessStunPacketFromWebRtcServer(
+	  RTC::TransportTuple* tuple, RTC::StunPacket* packet)
+	{
+		MS_TRACE();
+
+		// Increase receive transmission.
+		RTC::Transport::DataReceived(packet->GetSize());
+
+		const uint64_t nowMs = DepLibUV::GetTimeMs();
+
+		if (!this->ingressPolicer.Police(tuple, packet->GetSize(), nowMs))
+			return;
+
+		// Limit STUN packets to authenticate from tuples not validated yet.
+		// clang-format off
+		if (
+			!this->iceServer->IsValidTuple(tuple) &&
+			!this->ingressPolicer.PoliceUnknownTupleStun(tuple, packet->GetSize(), nowMs)
+		)
+		// clang-format on
+		{
+			MS_DEBUG_DEV("ignoring STUN packet exceeding the rate of an invalid tuple");
+
+			return;
+		}
+
+		MayRecordIceBinding(packet);
+
+		// Pass it to the IceServer.
+		this->iceServer->ProcessStunPacket(packet, tuple);
+	}
+
+	void WebRtcTransport::ProcessNonStunPacketFromWebRtcServer(
+	  RTC::TransportTuple* tuple, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		// Increase receive transmission.
+		RTC::Transport::DataReceived(len);
+
+		if (!this->ingressPolicer.Police(tuple, len, DepLibUV::GetTimeMs()))
+			return;
+
+		OnNonStunPacketReceived(tuple, RTC::PacketClassifier::Classify(data, len), data, len);
+	}
+
+	void WebRtcTransport::RemoveTuple(RTC::TransportTuple* tuple)
+	{
+		MS_TRACE();
+
+		this->iceServer->RemoveTuple(tuple);
+	}
+
 	inline void WebRtcTransport::OnPacketReceived(
 	  RTC::TransportTuple* tuple, const uint8_t* data, size_t len)
 	{
@@ -880,29 +1162,81 @@ namespace RTC
 		// Increase receive transmission.
 		RTC::Transport::DataReceived(len);
 
+		const uint64_t nowMs = DepLibUV::GetTimeMs();
+
+		// Police it before parsing it.
+		if (!this->ingressPolicer.Police(tuple, len, nowMs))
+			return;
+
+		auto type = RTC::PacketClassifier::Classify(data, len);
+
 		// Check if it's STUN.
-		if (RTC::StunPacket::IsStun(data, len))
+		if (type == RTC::PacketClassifier::Type::STUN)
 		{
+			// Limit STUN packets to parse and authenticate from tuples not
+			// validated yet.
+			// clang-format off
+			if (
+				!this->iceServer->IsValidTuple(tuple) &&
+				!this->ingressPolicer.PoliceUnknownTupleStun(tuple, len, nowMs)
+			)
+			// clang-format on
+			{
+				MS_DEBUG_DEV("ignoring STUN packet exceeding the rate of an invalid tuple");
+
+				return;
+			}
+
 			OnStunDataReceived(tuple, data, len);
 		}
-		// Check if it's RTCP.
-		else if (RTC::RTCP::Packet::IsRtcp(data, len))
-		{
-			OnRtcpDataReceived(tuple, data, len);
-		}
-		// Check if it's RTP.
-		else if (RTC::RtpPacket::IsRtp(data, len))
+		else
 		{
-			OnRtpDataReceived(tuple, data, len);
+			OnNonStunPacketReceived(tuple, type, data, len);
 		}
-		// Check if it's DTLS.
-		else if (RTC::DtlsTransport::IsDtls(data, len))
+	}
+
+	inline void WebRtcTransport::OnNonStunPacketReceived(
+	  RTC::TransportTuple* tuple, RTC::PacketClassifier::Type type, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		// Ensure it comes from a valid tuple before decrypting it.
+		if (!this->iceServer->IsValidTuple(tuple))
 		{
-			OnDtlsDataReceived(tuple, data, len);
+			MS_DEBUG_DEV("ignoring packet coming from an invalid tuple");
+
+			this->ingressPolicer.Drop(RTC::IngressPolicer::DropReason::UNKNOWN_TUPLE, len);
+
+			return;
 		}
-		else
+
+		switch (type)
 		{
-			MS_WARN_DEV("ignoring received packet of unknown type");
+			case RTC::PacketClassifier::Type::RTCP:
+			{
+				OnRtcpDataReceived(tuple, data, len);
+
+				break;
+			}
+
+			case RTC::PacketClassifier::Type::RTP:
+			{
+				OnRtpDataReceived(tuple, data, len);
+
+				break;
+			}
+
+			case RTC::PacketClassifier::Type::DTLS:
+			{
+				OnDtlsDataReceived(tuple, data, len);
+
+				break;
+			}
+
+			default:
+			{
+				MS_WARN_DEV("ignoring received packet of unknown type");
+			}
 		}
 	}
 
@@ -920,6 +1254,8 @@ namespace RTC
 			return;
 		}
 
+		MayRecordIceBinding(packet);
+
 		// Pass it to the IceServer.
 		this->iceServer->ProcessStunPacket(packet, tuple);
 
@@ -931,14 +1267,6 @@ namespace RTC
 	{
 		MS_TRACE();
 
-		// Ensure it comes from a valid tuple.
-		if (!this->iceServer->IsValidTuple(tuple))
-		{
-			MS_WARN_TAG(dtls, "ignoring DTLS data coming from an invalid tuple");
-
-			return;
-		}
-
 		// Trick for clients performing aggressive ICE regardless we are ICE-Lite.
 		this->iceServer->ForceSelectedTuple(tuple);
 
@@ -964,6 +1292,8 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
+
 		// Ensure DTLS is connected.
 		if (this->dtlsTransport->GetState() != RTC::DtlsTransport::DtlsState::CONNECTED)
 		{
@@ -980,14 +1310,19 @@ namespace RTC
 			return;
 		}
 
-		// Ensure it comes from a valid tuple.
-		if (!this->iceServer->IsValidTuple(tuple))
+		// clang-format off
+		if (
+			RTC::SrtpDecryptPool::IsEnabled() &&
+			RTC::SrtpDecryptPool::DecryptSrtp(this, this->srtpRecvSession, tuple, data, len)
+		)
+		// clang-format on
 		{
-			MS_WARN_TAG(rtp, "ignoring RTP packet coming from an invalid tuple");
-
 			return;
 		}
 
+		// Pool threads may be decrypting previous packets.
+		RTC::SrtpDecryptPool::Flush(this);
+
 		// Decrypt the SRTP packet.
 		auto intLen = static_cast<int>(len);
 
@@ -1014,7 +1349,15 @@ namespace RTC
 			return;
 		}
 
-		RTC::RtpPacket* packet = RTC::RtpPacket::Parse(data, static_cast<size_t>(intLen));
+		OnDecryptedRtpDataReceived(tuple, data, static_cast<size_t>(intLen));
+	}
+
+	inline void WebRtcTransport::OnDecryptedRtpDataReceived(
+	  const RTC::TransportTuple* tuple, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		RTC::RtpPacket* packet = RTC::RtpPacket::Parse(data, len);
 
 		if (!packet)
 		{
@@ -1035,6 +1378,8 @@ namespace RTC
 	{
 		MS_TRACE();
 
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
+
 		// Ensure DTLS is connected.
 		if (this->dtlsTransport->GetState() != RTC::DtlsTransport::DtlsState::CONNECTED)
 		{
@@ -1051,21 +1396,41 @@ namespace RTC
 			return;
 		}
 
-		// Ensure it comes from a valid tuple.
-		if (!this->iceServer->IsValidTuple(tuple))
+		// NOTE: SRTCP packets go through the pool too since they are decrypted
+		// with the same SRTP session.
+		// clang-format off
+		if (
+			RTC::SrtpDecryptPool::IsEnabled() &&
+			RTC::SrtpDecryptPool::DecryptSrtcp(this, this->srtpRecvSession, tuple, data, len)
+		)
+		// clang-format on
 		{
-			MS_WARN_TAG(rtcp, "ignoring RTCP packet coming from an invalid tuple");
-
 			return;
 		}
 
+		// Pool threads may be decrypting previous packets.
+		RTC::SrtpDecryptPool::Flush(this);
+
 		// Decrypt the SRTCP packet.
 		auto intLen = static_cast<int>(len);
 
 		if (!this->srtpRecvSession->DecryptSrtcp(const_cast<uint8_t*>(data), &intLen))
 			return;
 
-		RTC::RTCP::Packet* packet = RTC::RTCP::Packet::Parse(data, static_cast<size_t>(intLen));
+		OnDecryptedRtcpDataReceived(tuple, data, static_cast<size_t>(intLen));
+	}
+
+	inline void WebRtcTransport::OnDecryptedRtcpDataReceived(
+	  const RTC::TransportTuple* tuple, const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		MayCaptureRtcpPacket(RTC::PacketCapture::Direction::IN, data, len);
+
+		// Parsed RTCP objects are released all together after being handled.
+		RTC::RTCP::Arena::Scope arenaScope;
+
+		RTC::RTCP::Packet* packet = RTC::RTCP::Packet::Parse(data, len);
 
 		if (!packet)
 		{
@@ -1074,6 +1439,11 @@ namespace RTC
 			return;
 		}
 
+		// As with RTP, authenticated RTCP from another valid tuple means that the
+		// remote endpoint switched to it (f.e. a receive only endpoint after a
+		// network handover).
+		this->iceServer->ForceSelectedTuple(tuple);
+
 		// Pass the packet to the parent transport.
 		RTC::Transport::ReceiveRtcpPacket(packet);
 	}
@@ -1120,8 +1490,50 @@ namespace RTC
 		RTC::Transport::DataSent(packet->GetSize());
 	}
 
+	inline void WebRtcTransport::OnIceServerLocalUsernameFragmentAdded(
+	  const RTC::IceServer* /*iceServer*/, const std::string& usernameFragment)
+	{
+		MS_TRACE();
+
+		if (this->webRtcTransportListener)
+		{
+			this->webRtcTransportListener->OnWebRtcTransportLocalIceUsernameFragmentAdded(
+			  this, usernameFragment);
+		}
+	}
+
+	inline void WebRtcTransport::OnIceServerLocalUsernameFragmentRemoved(
+	  const RTC::IceServer* /*iceServer*/, const std::string& usernameFragment)
+	{
+		MS_TRACE();
+
+		if (this->webRtcTransportListener)
+		{
+			this->webRtcTransportListener->OnWebRtcTransportLocalIceUsernameFragmentRemoved(
+			  this, usernameFragment);
+		}
+	}
+
+	inline void WebRtcTransport::OnIceServerTupleAdded(
+	  const RTC::IceServer* /*iceServer*/, RTC::TransportTuple* tuple)
+	{
+		MS_TRACE();
+
+		if (this->webRtcTransportListener)
+			this->webRtcTransportListener->OnWebRtcTransportTransportTupleAdded(this, tuple);
+	}
+
+	inline void WebRtcTransport::OnIceServerTupleRemoved(
+	  const RTC::IceServer* /*iceServer*/, RTC::TransportTuple* tuple)
+	{
+		MS_TRACE();
+
+		if (this->webRtcTransportListener)
+			this->webRtcTransportListener->OnWebRtcTransportTransportTupleRemoved(this, tuple);
+	}
+
 	inline void WebRtcTransport::OnIceServerSelectedTuple(
-	  const RTC::IceServer* /*iceServer*/, RTC::TransportTuple* /*tuple*/)
+	  const RTC::IceServer* /*iceServer*/, RTC::TransportTuple* tuple)
 	{
 		MS_TRACE();
 
@@ -1134,6 +1546,15 @@ namespace RTC
 
 		MS_DEBUG_TAG(ice, "ICE selected tuple");
 
+		// Start the outgoing bandwidth estimation from the last one of the remote
+		// endpoint. If already connected the remote endpoint moved to another
+		// path (f.e. from Wi-Fi to a mobile network), so don't wait for the
+		// estimation of the old path to collapse.
+		if (IsConnected())
+			RTC::Transport::PathChanged(tuple->GetRemoteAddress());
+		else
+			SetBweCacheKey(tuple->GetRemoteAddress());
+
 		// Notify the Node WebRtcTransport.
 		json data = json::object();
 
@@ -1155,6 +1576,8 @@ namespace RTC
 
 		Channel::ChannelNotifier::Emit(this->id, "icestatechange", data);
 
+		MayRecordIceConnected();
+
 		// If ready, run the DTLS handler.
 		MayRunDtlsTransport();
 
@@ -1178,6 +1601,8 @@ namespace RTC
 
 		Channel::ChannelNotifier::Emit(this->id, "icestatechange", data);
 
+		MayRecordIceConnected();
+
 		// If ready, run the DTLS handler.
 		MayRunDtlsTransport();
 
@@ -1235,13 +1660,29 @@ namespace RTC
 
 		MS_DEBUG_TAG(dtls, "DTLS connected");
 
+		// Just the first time (not after a DTLS restart).
+		if (this->dtlsConnectedAtMs == 0u)
+		{
+			this->dtlsConnectedAtMs = DepLibUV::GetTimeMs();
+
+			RTC::JoinLatency::Record(
+			  RTC::JoinLatency::Phase::DTLS_CONNECT, this->dtlsConnectedAtMs - this->iceConnectedAtMs);
+		}
+
 		// Close it if it was already set and update it.
+		RTC::SrtpEncryptPool::RemoveListener(this);
+		RTC::SrtpDecryptPool::RemoveListener(this);
+
 		delete this->srtpSendSession;
 		this->srtpSendSession = nullptr;
 
 		delete this->srtpRecvSession;
 		this->srtpRecvSession = nullptr;
 
+		this->srtpCryptoSuite     = srtpCryptoSuite;
+		this->srtpLocalKeyBase64  = Utils::String::Base64Encode(srtpLocalKey, srtpLocalKeyLen);
+		this->srtpRemoteKeyBase64 = Utils::String::Base64Encode(srtpRemoteKey, srtpRemoteKeyLen);
+
 		try
 		{
 			this->srtpSendSession = new RTC::SrtpSession(
@@ -1272,6 +1713,8 @@ namespace RTC
 		{
 			MS_ERROR("error creating SRTP receiving session: %s", error.what());
 
+			RTC::SrtpEncryptPool::RemoveListener(this);
+
 			delete this->srtpSendSession;
 			this->srtpSendSession = nullptr;
 		}
@@ -1334,4 +1777,58 @@ namespace RTC
 		// Pass it to the parent transport.
 		RTC::Transport::ReceiveSctpData(data, len);
 	}
+
+	inline void WebRtcTransport::OnSrtpEncryptPoolRtpPacketEncrypted(const uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
+
+		// The transport may have been disconnected in the meanwhile.
+		if (!IsConnected())
+			return;
+
+		auto* tuple = this->iceServer->GetSelectedTuple();
+
+		tuple->Send(data, len);
+
+		// Increase send transmission.
+		RTC::Transport::DataSent(len);
+	}
+
+	inline void WebRtcTransport::OnSrtpDecryptPoolRtpPacketDecrypted(
+	  const RTC::TransportTuple* tuple, uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
+
+		// The tuple may have been removed in the meanwhile.
+		if (!this->iceServer->IsValidTuple(tuple))
+		{
+			MS_DEBUG_DEV("ignoring decrypted RTP packet coming from a removed tuple");
+
+			return;
+		}
+
+		OnDecryptedRtpDataReceived(tuple, data, len);
+	}
+
+	inline void WebRtcTransport::OnSrtpDecryptPoolRtcpPacketDecrypted(
+	  const RTC::TransportTuple* tuple, uint8_t* data, size_t len)
+	{
+		MS_TRACE();
+
+		RTC::CpuUsage::Scope cpuScope(std::addressof(this->cpuUsage));
+
+		// The tuple may have been removed in the meanwhile.
+		if (!this->iceServer->IsValidTuple(tuple))
+		{
+			MS_DEBUG_DEV("ignoring decrypted RTCP packet coming from a removed tuple");
+
+			return;
+		}
+
+		OnDecryptedRtcpDataReceived(tuple, data, len);
+	}
 } // namespace RTC
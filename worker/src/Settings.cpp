@@ -5,6 +5,10 @@
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
 #include "Utils.hpp"
+#include "RTC/DtlsHandshakePool.hpp"
+#include "RTC/SrtpDecryptPool.hpp"
+#include "RTC/SrtpEncryptPool.hpp"
+#include "handles/UdpSocketHandler.hpp"
 #include <cctype>   // isprint()
 #include <iterator> // std::ostream_iterator
 #include <mutex>
@@ -18,6 +22,12 @@ extern "C"
 /* Static. */
 
 static std::mutex globalSyncMutex;
+static constexpr uint32_t MaxNotificationBatchInterval{ 5000u };
+static constexpr uint32_t MaxRembSampling{ 16u };
+static constexpr int32_t MaxRealtimePriority{ 99 };
+static constexpr int32_t MinNiceness{ -20 };
+static constexpr int32_t MaxNiceness{ 19 };
+static constexpr int64_t MaxUdpBufferSize{ 1024 * 1024 * 1024 };
 
 /* Class variables. */
 
@@ -52,12 +62,49 @@ void Settings::SetConfiguration(int argc, char* argv[])
 	// clang-format off
 	struct option options[] =
 	{
-		{ "logLevel",            optional_argument, nullptr, 'l' },
-		{ "logTags",             optional_argument, nullptr, 't' },
-		{ "rtcMinPort",          optional_argument, nullptr, 'm' },
-		{ "rtcMaxPort",          optional_argument, nullptr, 'M' },
-		{ "dtlsCertificateFile", optional_argument, nullptr, 'c' },
-		{ "dtlsPrivateKeyFile",  optional_argument, nullptr, 'p' },
+		{ "logLevel",                optional_argument, nullptr, 'l' },
+		{ "logTags",                 optional_argument, nullptr, 't' },
+		{ "rtcMinPort",              optional_argument, nullptr, 'm' },
+		{ "rtcMaxPort",              optional_argument, nullptr, 'M' },
+		{ "dtlsCertificateFile",     optional_argument, nullptr, 'c' },
+		{ "dtlsPrivateKeyFile",      optional_argument, nullptr, 'p' },
+		{ "dtlsCertificateCacheDir", optional_argument, nullptr, 'C' },
+		{ "channelMessageFormat",    optional_argument, nullptr, 'f' },
+		{ "cpuAffinity",             optional_argument, nullptr, 'a' },
+		{ "srtpEncryptThreads",      optional_argument, nullptr, 'e' },
+		{ "srtpDecryptThreads",      optional_argument, nullptr, 'g' },
+		{ "dtlsHandshakeThreads",    optional_argument, nullptr, 'd' },
+		{ "dtlsSessionResumption",   optional_argument, nullptr, 'S' },
+		{ "dtlsEcdsaOnly",           optional_argument, nullptr, 'D' },
+		{ "dtls13",                  optional_argument, nullptr, 'J' },
+		{ "statsFile",               optional_argument, nullptr, 's' },
+		{ "notificationBatchInterval", optional_argument, nullptr, 'b' },
+		{ "forwardingLatency",       optional_argument, nullptr, 'L' },
+		{ "overloadProtection",      optional_argument, nullptr, 'o' },
+		{ "rembSampling",            optional_argument, nullptr, 'r' },
+		{ "maxProbingTransports",    optional_argument, nullptr, 'P' },
+		{ "maxKeyFrameRequestsPerTransport", optional_argument, nullptr, 'K' },
+		{ "maxKeyFrameRequestsPerRouter", optional_argument, nullptr, 'Q' },
+		{ "helperCpuAffinity",       optional_argument, nullptr, 'H' },
+		{ "numaLocalMemory",         optional_argument, nullptr, 'N' },
+		{ "transportArenas",         optional_argument, nullptr, 'A' },
+		{ "trustFrameMarking",       optional_argument, nullptr, 'k' },
+		{ "nativeBandwidthEstimator", optional_argument, nullptr, 'E' },
+		{ "nativeSctp",              optional_argument, nullptr, 'I' },
+		{ "realtimePriority",        optional_argument, nullptr, 'R' },
+		{ "niceness",                optional_argument, nullptr, 'n' },
+		{ "packetIo",                optional_argument, nullptr, 'i' },
+		{ "logRateLimit",            optional_argument, nullptr, 'T' },
+		{ "logFile",                 optional_argument, nullptr, 'F' },
+		{ "socketPoolSize",          optional_argument, nullptr, 'u' },
+		{ "udpRecvBufferSize",       optional_argument, nullptr, 'v' },
+		{ "udpSendBufferSize",       optional_argument, nullptr, 'w' },
+		{ "kernelRecvTimestamps",    optional_argument, nullptr, 'x' },
+		{ "ecn",                     optional_argument, nullptr, 'y' },
+		{ "turnOverTcp",             optional_argument, nullptr, 'z' },
+		{ "egressBitrate",           optional_argument, nullptr, 'G' },
+		{ "egressBurstMs",           optional_argument, nullptr, 'B' },
+		{ "busyPollUs",              optional_argument, nullptr, 'O' },
 		{ nullptr, 0, nullptr, 0 }
 	};
 	// clang-format on
@@ -138,6 +185,677 @@ void Settings::SetConfiguration(int argc, char* argv[])
 				break;
 			}
 
+			case 'C':
+			{
+				stringValue                                     = std::string(optarg);
+				Settings::configuration.dtlsCertificateCacheDir = stringValue;
+
+				break;
+			}
+
+			case 'f':
+			{
+				stringValue = std::string(optarg);
+
+				if (!Channel::ChannelMessage::GetFormat(
+				      stringValue, Settings::configuration.channelMessageFormat))
+				{
+					MS_THROW_TYPE_ERROR("invalid channelMessageFormat '%s'", stringValue.c_str());
+				}
+
+				break;
+			}
+
+			case 'a':
+			{
+				try
+				{
+					Settings::configuration.cpuAffinity = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (Settings::configuration.cpuAffinity < 0)
+					MS_THROW_TYPE_ERROR("invalid cpuAffinity (negative number)");
+
+				break;
+			}
+
+			case 'e':
+			{
+				int32_t srtpEncryptThreads;
+
+				try
+				{
+					srtpEncryptThreads = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (srtpEncryptThreads < 0)
+				{
+					MS_THROW_TYPE_ERROR("invalid srtpEncryptThreads (negative number)");
+				}
+				else if (srtpEncryptThreads > static_cast<int32_t>(RTC::SrtpEncryptPool::MaxThreads))
+				{
+					MS_THROW_TYPE_ERROR(
+					  "invalid srtpEncryptThreads (greater than %zu)", RTC::SrtpEncryptPool::MaxThreads);
+				}
+
+				Settings::configuration.srtpEncryptThreads = static_cast<uint8_t>(srtpEncryptThreads);
+
+				break;
+			}
+
+			case 'g':
+			{
+				int32_t srtpDecryptThreads;
+
+				try
+				{
+					srtpDecryptThreads = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (srtpDecryptThreads < 0)
+				{
+					MS_THROW_TYPE_ERROR("invalid srtpDecryptThreads (negative number)");
+				}
+				else if (srtpDecryptThreads > static_cast<int32_t>(RTC::SrtpDecryptPool::MaxThreads))
+				{
+					MS_THROW_TYPE_ERROR(
+					  "invalid srtpDecryptThreads (greater than %zu)", RTC::SrtpDecryptPool::MaxThreads);
+				}
+
+				Settings::configuration.srtpDecryptThreads = static_cast<uint8_t>(srtpDecryptThreads);
+
+				break;
+			}
+
+			case 'd':
+			{
+				int32_t dtlsHandshakeThreads;
+
+				try
+				{
+					dtlsHandshakeThreads = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (dtlsHandshakeThreads < 0)
+				{
+					MS_THROW_TYPE_ERROR("invalid dtlsHandshakeThreads (negative number)");
+				}
+				else if (dtlsHandshakeThreads > static_cast<int32_t>(RTC::DtlsHandshakePool::MaxThreads))
+				{
+					MS_THROW_TYPE_ERROR(
+					  "invalid dtlsHandshakeThreads (greater than %zu)", RTC::DtlsHandshakePool::MaxThreads);
+				}
+
+				Settings::configuration.dtlsHandshakeThreads = static_cast<uint8_t>(dtlsHandshakeThreads);
+
+				break;
+			}
+
+			case 'S':
+			{
+				stringValue = std::string(optarg);
+
+				if (stringValue == "true")
+					Settings::configuration.dtlsSessionResumption = true;
+				else if (stringValue == "false")
+					Settings::configuration.dtlsSessionResumption = false;
+				else
+					MS_THROW_TYPE_ERROR("invalid dtlsSessionResumption (not true or false)");
+
+				break;
+			}
+
+			case 'D':
+			{
+				stringValue = std::string(optarg);
+
+				if (stringValue == "true")
+					Settings::configuration.dtlsEcdsaOnly = true;
+				else if (stringValue == "false")
+					Settings::configuration.dtlsEcdsaOnly = false;
+				else
+					MS_THROW_TYPE_ERROR("invalid dtlsEcdsaOnly (not true or false)");
+
+				break;
+			}
+
+			case 'J':
+			{
+				stringValue = optarg ? std::string(optarg) : "true";
+
+				if (stringValue == "true")
+					Settings::configuration.dtls13 = true;
+				else if (stringValue == "false")
+					Settings::configuration.dtls13 = false;
+				else
+					MS_THROW_TYPE_ERROR("invalid dtls13 (not true or false)");
+
+				break;
+			}
+
+			case 's':
+			{
+				stringValue                       = std::string(optarg);
+				Settings::configuration.statsFile = stringValue;
+
+				break;
+			}
+
+			case 'b':
+			{
+				int32_t notificationBatchInterval;
+
+				try
+				{
+					notificationBatchInterval = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (notificationBatchInterval < 0)
+				{
+					MS_THROW_TYPE_ERROR("invalid notificationBatchInterval (negative number)");
+				}
+				else if (notificationBatchInterval > static_cast<int32_t>(MaxNotificationBatchInterval))
+				{
+					MS_THROW_TYPE_ERROR(
+					  "invalid notificationBatchInterval (greater than %" PRIu32 ")",
+					  MaxNotificationBatchInterval);
+				}
+
+				Settings::configuration.notificationBatchInterval =
+				  static_cast<uint32_t>(notificationBatchInterval);
+
+				break;
+			}
+
+			// Given with no value it means true.
+			case 'L':
+			{
+				stringValue = optarg ? std::string(optarg) : "true";
+
+				if (stringValue == "true")
+					Settings::configuration.forwardingLatency = true;
+				else if (stringValue == "false")
+					Settings::configuration.forwardingLatency = false;
+				else
+					MS_THROW_TYPE_ERROR("invalid forwardingLatency (not true or false)");
+
+				break;
+			}
+
+			// Given with no value it means true.
+			case 'o':
+			{
+				stringValue = optarg ? std::string(optarg) : "true";
+
+				if (stringValue == "true")
+					Settings::configuration.overloadProtection = true;
+				else if (stringValue == "false")
+					Settings::configuration.overloadProtection = false;
+				else
+					MS_THROW_TYPE_ERROR("invalid overloadProtection (not true or false)");
+
+				break;
+			}
+
+			case 'r':
+			{
+				int32_t rembSampling;
+
+				try
+				{
+					rembSampling = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (rembSampling < 1)
+				{
+					MS_THROW_TYPE_ERROR("invalid rembSampling (lower than 1)");
+				}
+				else if (rembSampling > static_cast<int32_t>(MaxRembSampling))
+				{
+					MS_THROW_TYPE_ERROR("invalid rembSampling (greater than %" PRIu32 ")", MaxRembSampling);
+				}
+
+				Settings::configuration.rembSampling = static_cast<uint8_t>(rembSampling);
+
+				break;
+			}
+
+			case 'P':
+			{
+				int32_t maxProbingTransports;
+
+				try
+				{
+					maxProbingTransports = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (maxProbingTransports < 0)
+					MS_THROW_TYPE_ERROR("invalid maxProbingTransports (negative number)");
+
+				Settings::configuration.maxProbingTransports = static_cast<uint32_t>(maxProbingTransports);
+
+				break;
+			}
+
+			case 'K':
+			{
+				int32_t maxKeyFrameRequestsPerTransport;
+
+				try
+				{
+					maxKeyFrameRequestsPerTransport = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (maxKeyFrameRequestsPerTransport < 0)
+					MS_THROW_TYPE_ERROR("invalid maxKeyFrameRequestsPerTransport (negative number)");
+
+				Settings::configuration.maxKeyFrameRequestsPerTransport =
+				  static_cast<uint32_t>(maxKeyFrameRequestsPerTransport);
+
+				break;
+			}
+
+			case 'Q':
+			{
+				int32_t maxKeyFrameRequestsPerRouter;
+
+				try
+				{
+					maxKeyFrameRequestsPerRouter = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (maxKeyFrameRequestsPerRouter < 0)
+					MS_THROW_TYPE_ERROR("invalid maxKeyFrameRequestsPerRouter (negative number)");
+
+				Settings::configuration.maxKeyFrameRequestsPerRouter =
+				  static_cast<uint32_t>(maxKeyFrameRequestsPerRouter);
+
+				break;
+			}
+
+			// Comma separated list of CPUs.
+			case 'H':
+			{
+				std::istringstream cpusStream(optarg);
+				std::string cpu;
+
+				Settings::configuration.helperCpuAffinity.clear();
+
+				while (std::getline(cpusStream, cpu, ','))
+				{
+					int32_t helperCpu;
+
+					try
+					{
+						helperCpu = static_cast<int32_t>(std::stoi(cpu));
+					}
+					catch (const std::exception& error)
+					{
+						MS_THROW_TYPE_ERROR("%s", error.what());
+					}
+
+					if (helperCpu < 0)
+						MS_THROW_TYPE_ERROR("invalid helperCpuAffinity (negative number)");
+
+					Settings::configuration.helperCpuAffinity.push_back(helperCpu);
+				}
+
+				break;
+			}
+
+			// Given with no value it means true.
+			case 'N':
+			{
+				stringValue = optarg ? std::string(optarg) : "true";
+
+				if (stringValue == "true")
+					Settings::configuration.numaLocalMemory = true;
+				else if (stringValue == "false")
+					Settings::configuration.numaLocalMemory = false;
+				else
+					MS_THROW_TYPE_ERROR("invalid numaLocalMemory (not true or false)");
+
+				break;
+			}
+
+			case 'A':
+			{
+				stringValue = optarg ? std::string(optarg) : "true";
+
+				if (stringValue == "true")
+					Settings::configuration.transportArenas = true;
+				else if (stringValue == "false")
+					Settings::configuration.transportArenas = false;
+				else
+					MS_THROW_TYPE_ERROR("invalid transportArenas (not true or false)");
+
+				break;
+			}
+
+			case 'k':
+			{
+				stringValue = optarg ? std::string(optarg) : "true";
+
+				if (stringValue == "true")
+					Settings::configuration.trustFrameMarking = true;
+				else if (stringValue == "false")
+					Settings::configuration.trustFrameMarking = false;
+				else
+					MS_THROW_TYPE_ERROR("invalid trustFrameMarking (not true or false)");
+
+				break;
+			}
+
+			case 'E':
+			{
+				stringValue = optarg ? std::string(optarg) : "true";
+
+				if (stringValue == "true")
+					Settings::configuration.nativeBandwidthEstimator = true;
+				else if (stringValue == "false")
+					Settings::configuration.nativeBandwidthEstimator = false;
+				else
+					MS_THROW_TYPE_ERROR("invalid nativeBandwidthEstimator (not true or false)");
+
+				break;
+			}
+
+			case 'I':
+			{
+				stringValue = optarg ? std::string(optarg) : "true";
+
+				if (stringValue == "true")
+					Settings::configuration.nativeSctp = true;
+				else if (stringValue == "false")
+					Settings::configuration.nativeSctp = false;
+				else
+					MS_THROW_TYPE_ERROR("invalid nativeSctp (not true or false)");
+
+				break;
+			}
+
+			case 'R':
+			{
+				int32_t realtimePriority;
+
+				try
+				{
+					realtimePriority = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (realtimePriority < 0 || realtimePriority > MaxRealtimePriority)
+				{
+					MS_THROW_TYPE_ERROR(
+					  "invalid realtimePriority (not between 0 and %" PRIi32 ")", MaxRealtimePriority);
+				}
+
+				Settings::configuration.realtimePriority = static_cast<uint8_t>(realtimePriority);
+
+				break;
+			}
+
+			case 'n':
+			{
+				int32_t niceness;
+
+				try
+				{
+					niceness = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (niceness < MinNiceness || niceness > MaxNiceness)
+				{
+					MS_THROW_TYPE_ERROR(
+					  "invalid niceness (not between %" PRIi32 " and %" PRIi32 ")", MinNiceness, MaxNiceness);
+				}
+
+				Settings::configuration.niceness = static_cast<int8_t>(niceness);
+
+				break;
+			}
+
+			case 'i':
+			{
+				stringValue = std::string(optarg);
+
+				// clang-format off
+				if (
+					stringValue != "libuv" &&
+					stringValue != "io_uring" &&
+					stringValue != "io_uring_sqpoll"
+				)
+				// clang-format on
+				{
+					MS_THROW_TYPE_ERROR("invalid packetIo (not libuv, io_uring or io_uring_sqpoll)");
+				}
+
+				Settings::configuration.packetIo = stringValue;
+
+				break;
+			}
+
+			case 'T':
+			{
+				int32_t logRateLimit;
+
+				try
+				{
+					logRateLimit = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (logRateLimit < 0)
+					MS_THROW_TYPE_ERROR("invalid logRateLimit (negative number)");
+
+				Settings::configuration.logRateLimit = static_cast<uint32_t>(logRateLimit);
+
+				break;
+			}
+
+			case 'F':
+			{
+				stringValue                     = std::string(optarg);
+				Settings::configuration.logFile = stringValue;
+
+				break;
+			}
+
+			case 'u':
+			{
+				int32_t socketPoolSize;
+
+				try
+				{
+					socketPoolSize = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (socketPoolSize < 0)
+					MS_THROW_TYPE_ERROR("invalid socketPoolSize (negative number)");
+
+				Settings::configuration.socketPoolSize = static_cast<uint32_t>(socketPoolSize);
+
+				break;
+			}
+
+			case 'v':
+			case 'w':
+			{
+				const char* name = c == 'v' ? "udpRecvBufferSize" : "udpSendBufferSize";
+				int64_t bufferSize;
+
+				try
+				{
+					bufferSize = static_cast<int64_t>(std::stoll(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (c == 'v')
+					Settings::configuration.udpRecvBufferSize = Settings::GetUdpBufferSize(name, bufferSize);
+				else
+					Settings::configuration.udpSendBufferSize = Settings::GetUdpBufferSize(name, bufferSize);
+
+				break;
+			}
+
+			case 'x':
+			{
+				stringValue = std::string(optarg);
+
+				if (stringValue == "true")
+					Settings::configuration.kernelRecvTimestamps = true;
+				else if (stringValue == "false")
+					Settings::configuration.kernelRecvTimestamps = false;
+				else
+					MS_THROW_TYPE_ERROR("invalid kernelRecvTimestamps (not true or false)");
+
+				break;
+			}
+
+			case 'y':
+			{
+				stringValue = std::string(optarg);
+
+				if (stringValue == "true")
+					Settings::configuration.ecn = true;
+				else if (stringValue == "false")
+					Settings::configuration.ecn = false;
+				else
+					MS_THROW_TYPE_ERROR("invalid ecn (not true or false)");
+
+				break;
+			}
+
+			case 'z':
+			{
+				stringValue = std::string(optarg);
+
+				if (stringValue == "true")
+					Settings::configuration.turnOverTcp = true;
+				else if (stringValue == "false")
+					Settings::configuration.turnOverTcp = false;
+				else
+					MS_THROW_TYPE_ERROR("invalid turnOverTcp (not true or false)");
+
+				break;
+			}
+
+			case 'G':
+			{
+				int64_t egressBitrate;
+
+				try
+				{
+					egressBitrate = static_cast<int64_t>(std::stoll(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (egressBitrate < 0 || egressBitrate > UINT32_MAX)
+					MS_THROW_TYPE_ERROR("invalid egressBitrate (out of range)");
+
+				Settings::configuration.egressBitrate = static_cast<uint32_t>(egressBitrate);
+
+				break;
+			}
+
+			case 'B':
+			{
+				int32_t egressBurstMs;
+
+				try
+				{
+					egressBurstMs = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (egressBurstMs <= 0)
+					MS_THROW_TYPE_ERROR("invalid egressBurstMs (not a positive number)");
+
+				Settings::configuration.egressBurstMs = static_cast<uint32_t>(egressBurstMs);
+
+				break;
+			}
+
+			case 'O':
+			{
+				int32_t busyPollUs;
+
+				try
+				{
+					busyPollUs = static_cast<int32_t>(std::stoi(optarg));
+				}
+				catch (const std::exception& error)
+				{
+					MS_THROW_TYPE_ERROR("%s", error.what());
+				}
+
+				if (busyPollUs < 0)
+					MS_THROW_TYPE_ERROR("invalid busyPollUs (negative number)");
+
+				Settings::configuration.busyPollUs = static_cast<uint32_t>(busyPollUs);
+
+				break;
+			}
+
 			// Invalid option.
 			case '?':
 			{
@@ -173,6 +891,9 @@ void Settings::SetConfiguration(int argc, char* argv[])
 
 	// Set DTLS certificate files (if provided),
 	Settings::SetDtlsCertificateAndPrivateKeyFiles();
+
+	// Set DTLS certificate cache directory (if provided).
+	Settings::SetDtlsCertificateCacheDir();
 }
 
 void Settings::PrintConfiguration()
@@ -225,6 +946,174 @@ void Settings::PrintConfiguration()
 	MS_DEBUG_TAG(info, "  logTags             : %s", logTagsStream.str().c_str());
 	MS_DEBUG_TAG(info, "  rtcMinPort          : %" PRIu16, Settings::configuration.rtcMinPort);
 	MS_DEBUG_TAG(info, "  rtcMaxPort          : %" PRIu16, Settings::configuration.rtcMaxPort);
+	MS_DEBUG_TAG(
+	  info,
+	  "  channelMessageFormat: %s",
+	  Channel::ChannelMessage::GetFormatName(Settings::configuration.channelMessageFormat).c_str());
+	if (Settings::configuration.cpuAffinity >= 0)
+	{
+		MS_DEBUG_TAG(info, "  cpuAffinity         : %" PRIi32, Settings::configuration.cpuAffinity);
+	}
+	if (!Settings::configuration.helperCpuAffinity.empty())
+	{
+		std::ostringstream helperCpusStream;
+
+		std::copy(
+		  Settings::configuration.helperCpuAffinity.begin(),
+		  Settings::configuration.helperCpuAffinity.end() - 1,
+		  std::ostream_iterator<int32_t>(helperCpusStream, ","));
+		helperCpusStream << Settings::configuration.helperCpuAffinity.back();
+
+		MS_DEBUG_TAG(info, "  helperCpuAffinity   : %s", helperCpusStream.str().c_str());
+	}
+	if (Settings::configuration.numaLocalMemory)
+	{
+		MS_DEBUG_TAG(info, "  numaLocalMemory     : enabled");
+	}
+	if (Settings::configuration.transportArenas)
+	{
+		MS_DEBUG_TAG(info, "  transportArenas     : enabled");
+	}
+	if (Settings::configuration.trustFrameMarking)
+	{
+		MS_DEBUG_TAG(info, "  trustFrameMarking   : enabled");
+	}
+	if (Settings::configuration.nativeBandwidthEstimator)
+	{
+		MS_DEBUG_TAG(info, "  nativeBandwidthEstimator : enabled");
+	}
+	if (Settings::configuration.nativeSctp)
+	{
+		MS_DEBUG_TAG(info, "  nativeSctp          : enabled");
+	}
+	if (Settings::configuration.realtimePriority > 0u)
+	{
+		MS_DEBUG_TAG(
+		  info, "  realtimePriority    : %" PRIu8, Settings::configuration.realtimePriority);
+	}
+	if (Settings::configuration.niceness != 0)
+	{
+		MS_DEBUG_TAG(info, "  niceness            : %" PRIi8, Settings::configuration.niceness);
+	}
+	if (Settings::configuration.packetIo != "libuv")
+	{
+		MS_DEBUG_TAG(info, "  packetIo            : %s", Settings::configuration.packetIo.c_str());
+	}
+	if (Settings::configuration.srtpEncryptThreads > 0u)
+	{
+		MS_DEBUG_TAG(
+		  info, "  srtpEncryptThreads  : %" PRIu8, Settings::configuration.srtpEncryptThreads);
+	}
+	if (Settings::configuration.srtpDecryptThreads > 0u)
+	{
+		MS_DEBUG_TAG(
+		  info, "  srtpDecryptThreads  : %" PRIu8, Settings::configuration.srtpDecryptThreads);
+	}
+	if (Settings::configuration.dtlsHandshakeThreads > 0u)
+	{
+		MS_DEBUG_TAG(
+		  info, "  dtlsHandshakeThreads: %" PRIu8, Settings::configuration.dtlsHandshakeThreads);
+	}
+	if (Settings::configuration.dtlsSessionResumption)
+	{
+		MS_DEBUG_TAG(info, "  dtlsSessionResumption: enabled");
+	}
+	if (Settings::configuration.dtlsEcdsaOnly)
+	{
+		MS_DEBUG_TAG(info, "  dtlsEcdsaOnly       : enabled");
+	}
+	if (Settings::configuration.dtls13)
+	{
+		MS_DEBUG_TAG(info, "  dtls13              : enabled");
+	}
+	if (Settings::configuration.logRateLimit > 0u)
+	{
+		MS_DEBUG_TAG(info, "  logRateLimit        : %" PRIu32, Settings::configuration.logRateLimit);
+	}
+	if (Settings::configuration.socketPoolSize > 0u)
+	{
+		MS_DEBUG_TAG(info, "  socketPoolSize      : %" PRIu32, Settings::configuration.socketPoolSize);
+	}
+	if (Settings::configuration.udpRecvBufferSize > 0u)
+	{
+		MS_DEBUG_TAG(
+		  info, "  udpRecvBufferSize   : %" PRIu32, Settings::configuration.udpRecvBufferSize);
+	}
+	if (Settings::configuration.udpSendBufferSize > 0u)
+	{
+		MS_DEBUG_TAG(
+		  info, "  udpSendBufferSize   : %" PRIu32, Settings::configuration.udpSendBufferSize);
+	}
+	if (Settings::configuration.kernelRecvTimestamps)
+	{
+		MS_DEBUG_TAG(info, "  kernelRecvTimestamps: enabled");
+	}
+	if (Settings::configuration.ecn)
+	{
+		MS_DEBUG_TAG(info, "  ecn                 : enabled");
+	}
+	if (Settings::configuration.turnOverTcp)
+	{
+		MS_DEBUG_TAG(info, "  turnOverTcp         : enabled");
+	}
+	if (Settings::configuration.egressBitrate > 0u)
+	{
+		MS_DEBUG_TAG(
+		  info,
+		  "  egressBitrate       : %" PRIu32 " (burst: %" PRIu32 " ms)",
+		  Settings::configuration.egressBitrate,
+		  Settings::configuration.egressBurstMs);
+	}
+	if (Settings::configuration.busyPollUs > 0u)
+	{
+		MS_DEBUG_TAG(info, "  busyPollUs          : %" PRIu32, Settings::configuration.busyPollUs);
+	}
+	if (!Settings::configuration.logFile.empty())
+	{
+		MS_DEBUG_TAG(info, "  logFile             : %s", Settings::configuration.logFile.c_str());
+	}
+	if (!Settings::configuration.statsFile.empty())
+	{
+		MS_DEBUG_TAG(info, "  statsFile           : %s", Settings::configuration.statsFile.c_str());
+	}
+	if (Settings::configuration.notificationBatchInterval > 0u)
+	{
+		MS_DEBUG_TAG(
+		  info,
+		  "  notificationBatchInterval: %" PRIu32,
+		  Settings::configuration.notificationBatchInterval);
+	}
+	if (Settings::configuration.forwardingLatency)
+	{
+		MS_DEBUG_TAG(info, "  forwardingLatency   : enabled");
+	}
+	if (Settings::configuration.overloadProtection)
+	{
+		MS_DEBUG_TAG(info, "  overloadProtection  : enabled");
+	}
+	if (Settings::configuration.rembSampling > 1u)
+	{
+		MS_DEBUG_TAG(info, "  rembSampling        : %" PRIu8, Settings::configuration.rembSampling);
+	}
+	if (Settings::configuration.maxProbingTransports > 0u)
+	{
+		MS_DEBUG_TAG(
+		  info, "  maxProbingTransports: %" PRIu32, Settings::configuration.maxProbingTransports);
+	}
+	if (Settings::configuration.maxKeyFrameRequestsPerTransport > 0u)
+	{
+		MS_DEBUG_TAG(
+		  info,
+		  "  maxKeyFrameRequestsPerTransport: %" PRIu32,
+		  Settings::configuration.maxKeyFrameRequestsPerTransport);
+	}
+	if (Settings::configuration.maxKeyFrameRequestsPerRouter > 0u)
+	{
+		MS_DEBUG_TAG(
+		  info,
+		  "  maxKeyFrameRequestsPerRouter: %" PRIu32,
+		  Settings::configuration.maxKeyFrameRequestsPerRouter);
+	}
 	if (!Settings::configuration.dtlsCertificateFile.empty())
 	{
 		MS_DEBUG_TAG(
@@ -232,6 +1121,13 @@ void Settings::PrintConfiguration()
 		MS_DEBUG_TAG(
 		  info, "  dtlsPrivateKeyFile  : %s", Settings::configuration.dtlsPrivateKeyFile.c_str());
 	}
+	else if (!Settings::configuration.dtlsCertificateCacheDir.empty())
+	{
+		MS_DEBUG_TAG(
+		  info,
+		  "  dtlsCertificateCacheDir: %s",
+		  Settings::configuration.dtlsCertificateCacheDir.c_str());
+	}
 
 	MS_DEBUG_TAG(info, "</configuration>");
 }
@@ -244,8 +1140,11 @@ void Settings::HandleRequest(Channel::ChannelRequest* request)
 	{
 		case Channel::ChannelRequest::MethodId::WORKER_UPDATE_SETTINGS:
 		{
-			auto jsonLogLevelIt = request->data.find("logLevel");
-			auto jsonLogTagsIt  = request->data.find("logTags");
+			auto jsonLogLevelIt          = request->data.find("logLevel");
+			auto jsonLogTagsIt           = request->data.find("logTags");
+			auto jsonUdpRecvBufferSizeIt = request->data.find("udpRecvBufferSize");
+			auto jsonUdpSendBufferSizeIt = request->data.find("udpSendBufferSize");
+			bool udpBufferSizesUpdated{ false };
 
 			// Update logLevel if requested.
 			if (jsonLogLevelIt != request->data.end() && jsonLogLevelIt->is_string())
@@ -270,6 +1169,40 @@ void Settings::HandleRequest(Channel::ChannelRequest* request)
 				Settings::SetLogTags(logTags);
 			}
 
+			// Update udpRecvBufferSize if requested.
+			// clang-format off
+			if (
+				jsonUdpRecvBufferSizeIt != request->data.end() &&
+				Utils::Json::IsPositiveInteger(*jsonUdpRecvBufferSizeIt)
+			)
+			// clang-format on
+			{
+				// This may throw.
+				Settings::configuration.udpRecvBufferSize = Settings::GetUdpBufferSize(
+				  "udpRecvBufferSize", jsonUdpRecvBufferSizeIt->get<int64_t>());
+
+				udpBufferSizesUpdated = true;
+			}
+
+			// Update udpSendBufferSize if requested.
+			// clang-format off
+			if (
+				jsonUdpSendBufferSizeIt != request->data.end() &&
+				Utils::Json::IsPositiveInteger(*jsonUdpSendBufferSizeIt)
+			)
+			// clang-format on
+			{
+				// This may throw.
+				Settings::configuration.udpSendBufferSize = Settings::GetUdpBufferSize(
+				  "udpSendBufferSize", jsonUdpSendBufferSizeIt->get<int64_t>());
+
+				udpBufferSizesUpdated = true;
+			}
+
+			// Apply them to the open UDP sockets.
+			if (udpBufferSizesUpdated)
+				UdpSocketHandler::ApplyBufferSizes();
+
 			// Print the new effective configuration.
 			Settings::PrintConfiguration();
 
@@ -285,6 +1218,16 @@ void Settings::HandleRequest(Channel::ChannelRequest* request)
 	}
 }
 
+uint32_t Settings::GetUdpBufferSize(const char* name, int64_t value)
+{
+	MS_TRACE();
+
+	if (value < 0 || value > MaxUdpBufferSize)
+		MS_THROW_TYPE_ERROR("invalid %s (out of range)", name);
+
+	return static_cast<uint32_t>(value);
+}
+
 void Settings::SetLogLevel(std::string& level)
 {
 	MS_TRACE();
@@ -382,3 +1325,20 @@ void Settings::SetDtlsCertificateAndPrivateKeyFiles()
 		MS_THROW_TYPE_ERROR("dtlsPrivateKeyFile: %s", error.what());
 	}
 }
+
+void Settings::SetDtlsCertificateCacheDir()
+{
+	MS_TRACE();
+
+	if (Settings::configuration.dtlsCertificateCacheDir.empty())
+		return;
+
+	try
+	{
+		Utils::File::CheckDirectory(Settings::configuration.dtlsCertificateCacheDir.c_str());
+	}
+	catch (const MediaSoupError& error)
+	{
+		MS_THROW_TYPE_ERROR("dtlsCertificateCacheDir: %s", error.what());
+	}
+}
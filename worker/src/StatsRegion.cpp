@@ -0,0 +1,127 @@
+#define MS_CLASS "StatsRegion"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "StatsRegion.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include <algorithm> // std::min()
+#include <cerrno>
+#include <cstring> // std::memset(), std::memcpy(), std::strerror()
+#ifndef _WIN32
+#include <fcntl.h>    // open()
+#include <sys/mman.h> // mmap(), munmap()
+#include <unistd.h>   // ftruncate(), close(), unlink()
+#endif
+
+/* Instance methods. */
+
+StatsRegion::StatsRegion(const std::string& path) : path(path)
+{
+	MS_TRACE();
+
+#ifdef _WIN32
+	MS_THROW_ERROR("statsFile is not supported on Windows");
+#else
+	this->size = sizeof(Header) + (sizeof(Record) * MaxRecords);
+	this->fd   = open(this->path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+	if (this->fd == -1)
+		MS_THROW_ERROR("open() failed for '%s': %s", this->path.c_str(), std::strerror(errno));
+
+	if (ftruncate(this->fd, static_cast<off_t>(this->size)) != 0)
+	{
+		auto error = errno;
+
+		close(this->fd);
+
+		MS_THROW_ERROR("ftruncate() failed for '%s': %s", this->path.c_str(), std::strerror(error));
+	}
+
+	void* data = mmap(nullptr, this->size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+
+	if (data == MAP_FAILED)
+	{
+		auto error = errno;
+
+		close(this->fd);
+
+		MS_THROW_ERROR("mmap() failed for '%s': %s", this->path.c_str(), std::strerror(error));
+	}
+
+	this->header  = reinterpret_cast<Header*>(data);
+	this->records = reinterpret_cast<Record*>(static_cast<uint8_t*>(data) + sizeof(Header));
+
+	std::memcpy(this->header->magic, "MSSTATS", sizeof(this->header->magic));
+	this->header->version    = Version;
+	this->header->headerSize = sizeof(Header);
+	this->header->recordSize = sizeof(Record);
+	this->header->maxRecords = MaxRecords;
+	this->header->sequence.store(0u, std::memory_order_release);
+#endif
+}
+
+StatsRegion::~StatsRegion()
+{
+	MS_TRACE();
+
+#ifndef _WIN32
+	munmap(this->header, this->size);
+	close(this->fd);
+
+	// Stats of a closed Worker must not be read.
+	unlink(this->path.c_str());
+#endif
+}
+
+void StatsRegion::BeginUpdate()
+{
+	MS_TRACE();
+
+	this->recordCount = 0u;
+	this->truncated   = false;
+
+	// Odd sequence while records are written.
+	this->header->sequence.fetch_add(1u, std::memory_order_relaxed);
+
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+StatsRegion::Record* StatsRegion::AddRecord(
+  RecordType type, const std::string& id, const std::string& transportId)
+{
+	MS_TRACE();
+
+	if (this->recordCount == MaxRecords)
+	{
+		this->truncated = true;
+
+		return nullptr;
+	}
+
+	auto* record = &this->records[this->recordCount++];
+
+	std::memset(record, 0, sizeof(Record));
+
+	record->type = type;
+	std::memcpy(record->id, id.c_str(), std::min(id.size(), sizeof(record->id) - 1));
+	std::memcpy(
+	  record->transportId,
+	  transportId.c_str(),
+	  std::min(transportId.size(), sizeof(record->transportId) - 1));
+
+	return record;
+}
+
+void StatsRegion::EndUpdate(uint64_t nowMs)
+{
+	MS_TRACE();
+
+	this->header->recordCount = this->recordCount;
+	this->header->truncated   = this->truncated ? 1u : 0u;
+	this->header->updatedAt   = nowMs;
+
+	// Even sequence once records are written.
+	this->header->sequence.fetch_add(1u, std::memory_order_release);
+
+	MS_DEBUG_DEV("stats file updated [records:%" PRIu32 "]", this->recordCount);
+}
@@ -0,0 +1,214 @@
+#define MS_CLASS "ThreadPlacement"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "ThreadPlacement.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "Settings.hpp"
+#include <cerrno>
+#include <cstring> // std::strerror()
+#ifdef __linux__
+#include <linux/mempolicy.h> // MPOL_LOCAL
+#include <pthread.h>         // pthread_setaffinity_np(), pthread_setschedparam()
+#include <sched.h>           // cpu_set_t, CPU_SET(), sched_getcpu()
+#include <sys/resource.h>    // setpriority()
+#include <sys/syscall.h>     // SYS_gettid, SYS_getcpu, SYS_set_mempolicy
+#include <unistd.h>          // syscall()
+#endif
+
+/* Static. */
+
+#ifdef __linux__
+static void setCpuAffinity(pthread_t thread, int32_t cpu)
+{
+	cpu_set_t cpuSet;
+
+	CPU_ZERO(&cpuSet);
+	CPU_SET(cpu, &cpuSet);
+
+	const int err = pthread_setaffinity_np(thread, sizeof(cpuSet), &cpuSet);
+
+	if (err != 0)
+	{
+		MS_THROW_ERROR(
+		  "pthread_setaffinity_np() failed for CPU %" PRIi32 ": %s", cpu, std::strerror(err));
+	}
+}
+#endif
+
+/* Class variables. */
+
+thread_local std::vector<int32_t> ThreadPlacement::helperCpus;
+
+/* Class methods. */
+
+void ThreadPlacement::ApplyToWorkerThread()
+{
+	MS_TRACE();
+
+	const auto& configuration = Settings::configuration;
+
+#ifdef __linux__
+	// Pin it first so memory allocated from now on is local to its NUMA node.
+	if (configuration.cpuAffinity >= 0)
+		setCpuAffinity(pthread_self(), configuration.cpuAffinity);
+
+	if (configuration.numaLocalMemory)
+	{
+		if (syscall(SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0) != 0)
+			MS_THROW_ERROR("set_mempolicy() failed: %s", std::strerror(errno));
+	}
+
+	if (configuration.realtimePriority > 0u)
+	{
+		struct sched_param param; // NOLINT(cppcoreguidelines-pro-type-member-init)
+
+		param.sched_priority = configuration.realtimePriority;
+
+		const int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+
+		if (err != 0)
+		{
+			MS_THROW_ERROR(
+			  "pthread_setschedparam() failed for SCHED_FIFO priority %" PRIu8 ": %s",
+			  configuration.realtimePriority,
+			  std::strerror(err));
+		}
+	}
+
+	// In Linux the nice value of a thread is set by giving its tid.
+	if (configuration.niceness != 0)
+	{
+		const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+
+		if (setpriority(PRIO_PROCESS, tid, configuration.niceness) != 0)
+		{
+			MS_THROW_ERROR(
+			  "setpriority() failed for niceness %" PRIi8 ": %s",
+			  configuration.niceness,
+			  std::strerror(errno));
+		}
+	}
+#else
+	// clang-format off
+	if (
+		configuration.cpuAffinity >= 0 ||
+		configuration.numaLocalMemory ||
+		configuration.realtimePriority > 0u ||
+		configuration.niceness != 0
+	)
+	// clang-format on
+	{
+		MS_WARN_TAG(info, "thread placement not supported in this platform, ignoring it");
+	}
+#endif
+}
+
+void ThreadPlacement::ApplyToHelperThread(std::thread& thread)
+{
+	MS_TRACE();
+
+	const auto& helperCpuAffinity = Settings::configuration.helperCpuAffinity;
+
+	if (helperCpuAffinity.empty())
+		return;
+
+	const int32_t cpu =
+	  helperCpuAffinity[ThreadPlacement::helperCpus.size() % helperCpuAffinity.size()];
+
+#ifdef __linux__
+	setCpuAffinity(thread.native_handle(), cpu);
+
+	ThreadPlacement::helperCpus.push_back(cpu);
+#else
+	(void)thread;
+
+	MS_WARN_TAG(
+	  info, "CPU affinity not supported in this platform, ignoring it [cpu:%" PRIi32 "]", cpu);
+#endif
+}
+
+void ThreadPlacement::FillJson(json& jsonObject)
+{
+	MS_TRACE();
+
+	jsonObject = json::object();
+
+#ifdef __linux__
+	unsigned int cpu{ 0u };
+	unsigned int numaNode{ 0u };
+
+	if (syscall(SYS_getcpu, &cpu, &numaNode, nullptr) == 0)
+	{
+		jsonObject["cpu"]      = cpu;
+		jsonObject["numaNode"] = numaNode;
+	}
+
+	// Add cpuAffinity.
+	cpu_set_t cpuSet;
+
+	CPU_ZERO(&cpuSet);
+
+	if (pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0)
+	{
+		jsonObject["cpuAffinity"] = json::array();
+		auto jsonCpuAffinityIt    = jsonObject.find("cpuAffinity");
+
+		for (int i{ 0 }; i < CPU_SETSIZE; ++i)
+		{
+			if (CPU_ISSET(i, &cpuSet))
+				jsonCpuAffinityIt->emplace_back(i);
+		}
+	}
+
+	// Add helperCpuAffinity.
+	jsonObject["helperCpuAffinity"] = ThreadPlacement::helperCpus;
+
+	// Add numaLocalMemory.
+	int mode{ MPOL_DEFAULT };
+
+	if (syscall(SYS_get_mempolicy, &mode, nullptr, 0, nullptr, 0) == 0)
+		jsonObject["numaLocalMemory"] = mode == MPOL_LOCAL;
+
+	// Add schedPolicy and schedPriority.
+	int policy;
+	struct sched_param param; // NOLINT(cppcoreguidelines-pro-type-member-init)
+
+	if (pthread_getschedparam(pthread_self(), &policy, &param) == 0)
+	{
+		switch (policy)
+		{
+			case SCHED_FIFO:
+			{
+				jsonObject["schedPolicy"] = "fifo";
+
+				break;
+			}
+
+			case SCHED_RR:
+			{
+				jsonObject["schedPolicy"] = "rr";
+
+				break;
+			}
+
+			default:
+			{
+				jsonObject["schedPolicy"] = "other";
+			}
+		}
+
+		jsonObject["schedPriority"] = param.sched_priority;
+	}
+
+	// Add niceness (-1 is a valid value so errno must be checked).
+	const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+
+	errno = 0;
+
+	const int niceness = getpriority(PRIO_PROCESS, tid);
+
+	if (errno == 0)
+		jsonObject["niceness"] = niceness;
+#endif
+}
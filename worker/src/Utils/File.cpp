@@ -10,8 +10,9 @@
 #include <io.h>
 #define __S_ISTYPE(mode, mask) (((mode)&_S_IFMT) == (mask))
 #define S_ISREG(mode) __S_ISTYPE((mode), _S_IFREG)
+#define S_ISDIR(mode) __S_ISTYPE((mode), _S_IFDIR)
 #else
-#include <unistd.h> // access(), R_OK
+#include <unistd.h> // access(), R_OK, W_OK
 #endif
 
 namespace Utils
@@ -39,4 +40,28 @@ namespace Utils
 		if (err != 0)
 			MS_THROW_ERROR("cannot read file '%s': %s", file, std::strerror(errno));
 	}
+
+	void Utils::File::CheckDirectory(const char* dir)
+	{
+		MS_TRACE();
+
+		struct stat dirStat; // NOLINT(cppcoreguidelines-pro-type-member-init)
+		int err;
+
+		// Ensure the given directory exists.
+		err = stat(dir, &dirStat);
+
+		if (err != 0)
+			MS_THROW_ERROR("cannot read directory '%s': %s", dir, std::strerror(errno));
+
+		// Ensure it is a directory.
+		if (!S_ISDIR(dirStat.st_mode))
+			MS_THROW_ERROR("'%s' is not a directory", dir);
+
+		// Ensure it is readable and writable.
+		err = access(dir, R_OK | W_OK);
+
+		if (err != 0)
+			MS_THROW_ERROR("cannot write into directory '%s': %s", dir, std::strerror(errno));
+	}
 } // namespace Utils
@@ -2,16 +2,37 @@
 // #define MS_LOG_DEV_LEVEL 3
 
 #include "Worker.hpp"
+#include "Allocator.hpp"
 #include "DepLibUV.hpp"
 #include "DepUsrSCTP.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Metrics.hpp"
 #include "Settings.hpp"
+#include "ThreadPlacement.hpp"
+#include "Tracepoints.hpp"
+#include "Utils.hpp"
 #include "Channel/ChannelNotifier.hpp"
+#include "PayloadChannel/PayloadChannelNotifier.hpp"
+#include "RTC/DtlsTransport.hpp"
+#include "RTC/JoinLatency.hpp"
+#include "RTC/ObjectPool.hpp"
+#include "RTC/PortManager.hpp"
+#include "RTC/SrtpSession.hpp"
+#include "handles/IoUring.hpp"
+#include "handles/UdpSocketHandler.hpp"
+
+/* Static. */
+
+static constexpr uint64_t StatsRegionUpdateIntervalMs{ 1000u };
+static constexpr uint64_t MinStateStreamIntervalMs{ 100u };
 
 /* Instance methods. */
 
-Worker::Worker(::Channel::ChannelSocket* channel, PayloadChannel::PayloadChannelSocket* payloadChannel)
+Worker::Worker(
+  ::Channel::ChannelSocket* channel,
+  PayloadChannel::PayloadChannelSocket* payloadChannel,
+  json& startupTimes)
   : channel(channel), payloadChannel(payloadChannel)
 {
 	MS_TRACE();
@@ -22,6 +43,31 @@ Worker::Worker(::Channel::ChannelSocket* channel, PayloadChannel::PayloadChannel
 	// Set us as PayloadChannel's listener.
 	this->payloadChannel->SetListener(this);
 
+	// Create the stats file if requested.
+	if (!Settings::configuration.statsFile.empty())
+	{
+		this->statsRegion      = new StatsRegion(Settings::configuration.statsFile);
+		this->statsRegionTimer = new Timer(this);
+
+		this->statsRegionTimer->Start(StatsRegionUpdateIntervalMs, StatsRegionUpdateIntervalMs);
+	}
+
+	// Batch notifications if requested.
+	if (Settings::configuration.notificationBatchInterval > 0u)
+	{
+		this->notificationBatchTimer = new Timer(this);
+
+		Channel::ChannelNotifier::EnableBatching();
+
+		this->notificationBatchTimer->Start(
+		  Settings::configuration.notificationBatchInterval,
+		  Settings::configuration.notificationBatchInterval);
+	}
+
+	// Shed load when overloaded if requested.
+	if (Settings::configuration.overloadProtection)
+		this->overloadController = new OverloadController(this);
+
 	// Set the signals handler.
 	this->signalsHandler = new SignalsHandler(this);
 
@@ -37,10 +83,14 @@ Worker::Worker(::Channel::ChannelSocket* channel, PayloadChannel::PayloadChannel
 	DepUsrSCTP::CreateChecker();
 
 	// Tell the Node process that we are running.
-	Channel::ChannelNotifier::Emit(Logger::pid, "running");
+	json data = json::object();
+
+	data["startupTimes"] = startupTimes;
+
+	Channel::ChannelNotifier::Emit(Logger::pid, "running", data);
 
 	MS_DEBUG_DEV("starting libuv loop");
-	DepLibUV::RunLoop();
+	DepLibUV::RunLoop(Settings::configuration.busyPollUs);
 	MS_DEBUG_DEV("libuv loop ended");
 }
 
@@ -64,6 +114,22 @@ void Worker::Close()
 	// Delete the SignalsHandler.
 	delete this->signalsHandler;
 
+	// Delete the stats file.
+	delete this->statsRegionTimer;
+	delete this->statsRegion;
+
+	// Stop the state stream.
+	delete this->stateStreamTimer;
+
+	// Send pending notifications.
+	delete this->notificationBatchTimer;
+
+	if (Settings::configuration.notificationBatchInterval > 0u)
+		Channel::ChannelNotifier::FlushBatch();
+
+	// Delete the OverloadController.
+	delete this->overloadController;
+
 	// Delete all Routers.
 	for (auto& kv : this->mapRouters)
 	{
@@ -72,10 +138,24 @@ void Worker::Close()
 		delete router;
 	}
 	this->mapRouters.clear();
+	this->routerHandles.Clear();
+
+	// Delete all WebRtcServers (after Routers so their WebRtcTransports, if
+	// any, are already closed).
+	for (auto& kv : this->mapWebRtcServers)
+	{
+		auto* webRtcServer = kv.second;
+
+		delete webRtcServer;
+	}
+	this->mapWebRtcServers.clear();
 
 	// Close the Checker instance in DepUsrSCTP.
 	DepUsrSCTP::CloseChecker();
 
+	// Close the sockets pooled by the PortManager.
+	RTC::PortManager::ClosePools();
+
 	// Close the Channel.
 	this->channel->Close();
 
@@ -100,6 +180,63 @@ void Worker::FillJson(json& jsonObject) const
 
 		jsonRouterIdsIt->emplace_back(routerId);
 	}
+
+	// Add webRtcServerIds.
+	jsonObject["webRtcServerIds"] = json::array();
+	auto jsonWebRtcServerIdsIt    = jsonObject.find("webRtcServerIds");
+
+	for (auto& kv : this->mapWebRtcServers)
+	{
+		auto& webRtcServerId = kv.first;
+
+		jsonWebRtcServerIdsIt->emplace_back(webRtcServerId);
+	}
+
+	// Add placement.
+	ThreadPlacement::FillJson(jsonObject["placement"]);
+
+	// Add packetIo.
+	IoUring::FillJson(jsonObject["packetIo"]);
+
+	// Add udpRecvBatching.
+	jsonObject["udpRecvBatching"] = json::object();
+	auto jsonUdpRecvBatchingIt    = jsonObject.find("udpRecvBatching");
+	auto recvBatches              = UdpSocketHandler::GetRecvBatches();
+	auto recvBatchedDatagrams     = UdpSocketHandler::GetRecvBatchedDatagrams();
+
+	(*jsonUdpRecvBatchingIt)["batches"]   = recvBatches;
+	(*jsonUdpRecvBatchingIt)["datagrams"] = recvBatchedDatagrams;
+	(*jsonUdpRecvBatchingIt)["averageBatchSize"] =
+	  recvBatches != 0u ? static_cast<double>(recvBatchedDatagrams) / recvBatches : 0.0;
+
+	// Add udpSendBatching.
+	jsonObject["udpSendBatching"] = json::object();
+	auto jsonUdpSendBatchingIt    = jsonObject.find("udpSendBatching");
+	auto sendBatches              = UdpSocketHandler::GetSendBatches();
+	auto sendBatchedDatagrams     = UdpSocketHandler::GetSendBatchedDatagrams();
+
+	(*jsonUdpSendBatchingIt)["batches"]   = sendBatches;
+	(*jsonUdpSendBatchingIt)["datagrams"] = sendBatchedDatagrams;
+	(*jsonUdpSendBatchingIt)["averageBatchSize"] =
+	  sendBatches != 0u ? static_cast<double>(sendBatchedDatagrams) / sendBatches : 0.0;
+
+	// Add objectPool.
+	RTC::ObjectPool::FillJson(jsonObject["objectPool"]);
+
+#ifdef MS_ALLOCATION_STATS
+	// Add allocations.
+	Metrics::FillJsonAllocations(jsonObject["allocations"]);
+#endif
+
+	// Add dtlsHandshakes.
+	RTC::DtlsTransport::FillJsonHandshakes(jsonObject["dtlsHandshakes"]);
+
+	// Add joinLatency.
+	RTC::JoinLatency::FillJson(jsonObject["joinLatency"]);
+
+	// Add overload.
+	if (this->overloadController)
+		this->overloadController->FillJson(jsonObject["overload"]);
 }
 
 void Worker::FillJsonResourceUsage(json& jsonObject) const
@@ -163,6 +300,48 @@ void Worker::FillJsonResourceUsage(json& jsonObject) const
 
 	// Add ru_nivcsw (uint64_t, involuntary context switches).
 	jsonObject["ru_nivcsw"] = uvRusage.ru_nivcsw;
+
+	// Add loopLag and stages.
+	Metrics::FillJson(jsonObject);
+
+	// Add routerMemoryUsage.
+	size_t routerMemoryUsage{ 0u };
+
+	for (const auto& kv : this->mapRouters)
+	{
+		auto* router = kv.second;
+
+		routerMemoryUsage += router->GetMemoryUsage();
+	}
+
+	jsonObject["routerMemoryUsage"] = routerMemoryUsage;
+
+	// Add srtpSessions.
+	RTC::SrtpSession::FillJsonUsage(jsonObject["srtpSessions"]);
+
+	// Add ports.
+	RTC::PortManager::FillJsonUsage(jsonObject["ports"]);
+
+	// Add allocator.
+	Allocator::FillJson(jsonObject["allocator"]);
+}
+
+void Worker::UpdateStatsRegion()
+{
+	MS_TRACE();
+
+	auto nowMs = DepLibUV::GetTimeMs();
+
+	this->statsRegion->BeginUpdate();
+
+	for (auto& kv : this->mapRouters)
+	{
+		auto* router = kv.second;
+
+		router->FillStatsRecords(this->statsRegion, nowMs);
+	}
+
+	this->statsRegion->EndUpdate(nowMs);
 }
 
 void Worker::SetNewRouterIdFromInternal(json& internal, std::string& routerId) const
@@ -184,6 +363,17 @@ RTC::Router* Worker::GetRouterFromInternal(json& internal) const
 {
 	MS_TRACE();
 
+	// Numeric handle given at creation, if any.
+	auto jsonRouterHandleIt = internal.find("routerHandle");
+
+	if (jsonRouterHandleIt != internal.end() && jsonRouterHandleIt->is_number_unsigned())
+	{
+		auto* router = this->routerHandles.Get(jsonRouterHandleIt->get<uint32_t>());
+
+		if (router)
+			return router;
+	}
+
 	auto jsonRouterIdIt = internal.find("routerId");
 
 	if (jsonRouterIdIt == internal.end() || !jsonRouterIdIt->is_string())
@@ -199,6 +389,70 @@ RTC::Router* Worker::GetRouterFromInternal(json& internal) const
 	return router;
 }
 
+void Worker::SetNewWebRtcServerIdFromInternal(json& internal, std::string& webRtcServerId) const
+{
+	MS_TRACE();
+
+	auto jsonWebRtcServerIdIt = internal.find("webRtcServerId");
+
+	if (jsonWebRtcServerIdIt == internal.end() || !jsonWebRtcServerIdIt->is_string())
+		MS_THROW_ERROR("missing internal.webRtcServerId");
+
+	webRtcServerId.assign(jsonWebRtcServerIdIt->get<std::string>());
+
+	if (this->mapWebRtcServers.find(webRtcServerId) != this->mapWebRtcServers.end())
+		MS_THROW_ERROR("a WebRtcServer with same webRtcServerId already exists");
+}
+
+RTC::WebRtcServer* Worker::GetWebRtcServerFromInternal(json& internal) const
+{
+	MS_TRACE();
+
+	auto jsonWebRtcServerIdIt = internal.find("webRtcServerId");
+
+	if (jsonWebRtcServerIdIt == internal.end() || !jsonWebRtcServerIdIt->is_string())
+		MS_THROW_ERROR("missing internal.webRtcServerId");
+
+	auto it = this->mapWebRtcServers.find(jsonWebRtcServerIdIt->get<std::string>());
+
+	if (it == this->mapWebRtcServers.end())
+		MS_THROW_ERROR("WebRtcServer not found");
+
+	RTC::WebRtcServer* webRtcServer = it->second;
+
+	return webRtcServer;
+}
+
+/*
+ * Emits the state of every Router as a "state" PayloadChannel notification
+ * whose payload is the state encoded as CBOR. A Router per notification keeps
+ * them below the PayloadChannel message size limit. All the notifications of
+ * a round share the same seq.
+ */
+void Worker::EmitState()
+{
+	MS_TRACE();
+
+	++this->stateSeq;
+
+	for (const auto& kv : this->mapRouters)
+	{
+		const auto* router = kv.second;
+		json jsonState     = json::object();
+
+		router->FillJsonState(jsonState);
+
+		const std::vector<uint8_t> payload = json::to_cbor(jsonState);
+		json data                          = json::object();
+
+		data["routerId"] = kv.first;
+		data["seq"]      = this->stateSeq;
+
+		PayloadChannel::PayloadChannelNotifier::Emit(
+		  std::to_string(Logger::pid), "state", data, payload.data(), payload.size());
+	}
+}
+
 inline void Worker::OnChannelRequest(Channel::ChannelSocket* /*channel*/, Channel::ChannelRequest* request)
 {
 	MS_TRACE();
@@ -206,6 +460,8 @@ inline void Worker::OnChannelRequest(Channel::ChannelSocket* /*channel*/, Channe
 	MS_DEBUG_DEV(
 	  "Channel request received [method:%s, id:%" PRIu32 "]", request->method.c_str(), request->id);
 
+	MS_TRACEPOINT(channel_request, request->method.c_str(), request->id);
+
 	switch (request->methodId)
 	{
 		case Channel::ChannelRequest::MethodId::WORKER_CLOSE:
@@ -262,14 +518,132 @@ inline void Worker::OnChannelRequest(Channel::ChannelSocket* /*channel*/, Channe
 				MS_THROW_ERROR("%s [method:%s]", error.what(), request->method.c_str());
 			}
 
-			auto* router = new RTC::Router(routerId);
+			auto* router = new RTC::Router(this, routerId, request->data);
 
 			this->mapRouters[routerId] = router;
+			router->handle             = this->routerHandles.Add(router);
 
 			MS_DEBUG_DEV("Router created [routerId:%s]", routerId.c_str());
 
+			json data = json::object();
+
+			data["handle"] = router->handle;
+
+			request->Accept(data);
+
+			break;
+		}
+
+		case Channel::ChannelRequest::MethodId::WORKER_CREATE_WEBRTC_SERVER:
+		{
+			try
+			{
+				std::string webRtcServerId;
+
+				SetNewWebRtcServerIdFromInternal(request->internal, webRtcServerId);
+
+				auto* webRtcServer = new RTC::WebRtcServer(webRtcServerId, request->data);
+
+				this->mapWebRtcServers[webRtcServerId] = webRtcServer;
+
+				MS_DEBUG_DEV("WebRtcServer created [webRtcServerId:%s]", webRtcServerId.c_str());
+
+				request->Accept();
+			}
+			catch (const MediaSoupTypeError& error)
+			{
+				MS_THROW_TYPE_ERROR("%s [method:%s]", error.what(), request->method.c_str());
+			}
+			catch (const MediaSoupError& error)
+			{
+				MS_THROW_ERROR("%s [method:%s]", error.what(), request->method.c_str());
+			}
+
+			break;
+		}
+
+		case Channel::ChannelRequest::MethodId::WORKER_ENABLE_STATE_STREAM:
+		{
+			auto jsonIntervalIt = request->data.find("interval");
+
+			// clang-format off
+			if (
+				jsonIntervalIt == request->data.end() ||
+				!Utils::Json::IsPositiveInteger(*jsonIntervalIt)
+			)
+			// clang-format on
+			{
+				MS_THROW_TYPE_ERROR("missing interval");
+			}
+
+			auto interval = jsonIntervalIt->get<uint64_t>();
+
+			// Disable it.
+			if (interval == 0u)
+			{
+				delete this->stateStreamTimer;
+				this->stateStreamTimer = nullptr;
+
+				request->Accept();
+
+				break;
+			}
+
+			if (interval < MinStateStreamIntervalMs)
+				MS_THROW_TYPE_ERROR("interval must be at least %" PRIu64 " ms", MinStateStreamIntervalMs);
+
+			if (!this->stateStreamTimer)
+				this->stateStreamTimer = new Timer(this);
+
+			this->stateStreamTimer->Start(interval, interval);
+
 			request->Accept();
 
+			// Start with a full state so the receiver does not wait an interval.
+			EmitState();
+
+			break;
+		}
+
+		case Channel::ChannelRequest::MethodId::WEBRTC_SERVER_CLOSE:
+		{
+			RTC::WebRtcServer* webRtcServer{ nullptr };
+
+			try
+			{
+				webRtcServer = GetWebRtcServerFromInternal(request->internal);
+			}
+			catch (const MediaSoupError& error)
+			{
+				MS_THROW_ERROR("%s [method:%s]", error.what(), request->method.c_str());
+			}
+
+			// Remove it from the map.
+			this->mapWebRtcServers.erase(webRtcServer->id);
+
+			MS_DEBUG_DEV("WebRtcServer closed [id:%s]", webRtcServer->id.c_str());
+
+			// Delete it.
+			delete webRtcServer;
+
+			request->Accept();
+
+			break;
+		}
+
+		case Channel::ChannelRequest::MethodId::WEBRTC_SERVER_DUMP:
+		{
+			try
+			{
+				RTC::WebRtcServer* webRtcServer = GetWebRtcServerFromInternal(request->internal);
+
+				webRtcServer->HandleRequest(request);
+			}
+			catch (const MediaSoupError& error)
+			{
+				MS_THROW_ERROR("%s [method:%s]", error.what(), request->method.c_str());
+			}
+
 			break;
 		}
 
@@ -288,6 +662,7 @@ inline void Worker::OnChannelRequest(Channel::ChannelSocket* /*channel*/, Channe
 
 			// Remove it from the map and delete it.
 			this->mapRouters.erase(router->id);
+			this->routerHandles.Remove(router->handle);
 			delete router;
 
 			MS_DEBUG_DEV("Router closed [id:%s]", router->id.c_str());
@@ -437,3 +812,53 @@ inline void Worker::OnSignal(SignalsHandler* /*signalsHandler*/, int signum)
 		}
 	}
 }
+
+inline RTC::WebRtcServer* Worker::OnRouterNeedWebRtcServer(
+  RTC::Router* /*router*/, std::string& webRtcServerId)
+{
+	MS_TRACE();
+
+	RTC::WebRtcServer* webRtcServer{ nullptr };
+
+	auto it = this->mapWebRtcServers.find(webRtcServerId);
+
+	if (it != this->mapWebRtcServers.end())
+		webRtcServer = it->second;
+
+	return webRtcServer;
+}
+
+inline void Worker::OnTimer(Timer* timer)
+{
+	MS_TRACE();
+
+	if (timer == this->statsRegionTimer)
+		UpdateStatsRegion();
+	else if (timer == this->notificationBatchTimer)
+		Channel::ChannelNotifier::FlushBatch();
+	else if (timer == this->stateStreamTimer)
+		EmitState();
+}
+
+inline void Worker::OnOverloadControllerLevelChange(
+  OverloadController* overloadController,
+  OverloadController::Level level,
+  OverloadController::Level previousLevel)
+{
+	MS_TRACE();
+
+	for (auto& kv : this->mapRouters)
+	{
+		auto* router = kv.second;
+
+		router->SetOverloadLevel(level);
+	}
+
+	json data = json::object();
+
+	overloadController->FillJson(data);
+
+	data["previousLevel"] = OverloadController::GetLevelString(previousLevel);
+
+	Channel::ChannelNotifier::Emit(std::to_string(Logger::pid), "overload", data);
+}
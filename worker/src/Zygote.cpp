@@ -0,0 +1,283 @@
+#define MS_CLASS "Zygote"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "Zygote.hpp"
+#include "DepLibSRTP.hpp"
+#include "DepOpenSSL.hpp"
+#include "Logger.hpp"
+#include "Utils.hpp"
+#include "lib.hpp"
+#include "RTC/DtlsTransport.hpp"
+#include <cerrno>
+#include <cstdlib> // std::_Exit()
+#include <cstring> // std::strerror(), std::memcpy()
+#ifndef _WIN32
+#include <csignal>      // std::signal()
+#include <sys/socket.h> // socket(), bind(), listen(), accept(), recvmsg()
+#include <sys/un.h>     // sockaddr_un
+#include <unistd.h>     // fork(), close(), unlink(), write()
+#endif
+
+/* Static. */
+
+#ifndef _WIN32
+static void closeFds(const std::vector<int>& fds)
+{
+	for (const int fd : fds)
+	{
+		close(fd);
+	}
+}
+
+static void reply(int connFd, pid_t pid)
+{
+	const std::string line = std::to_string(pid) + "\n";
+
+	// Nothing to do if the client is gone.
+	while (write(connFd, line.data(), line.size()) < 0 && errno == EINTR)
+	{
+	}
+}
+#endif
+
+/* Class methods. */
+
+int Zygote::Run(const char* socketPath, const std::string& version)
+{
+	// NOTE: No logging but to stderr here since there is no Channel yet.
+
+#ifdef _WIN32
+	MS_ERROR_STD("zygote mode is not supported on Windows");
+
+	return 1;
+#else
+	struct sockaddr_un addr
+	{
+	};
+
+	if (std::strlen(socketPath) >= sizeof(addr.sun_path))
+	{
+		MS_ERROR_STD("zygote socket path too long [path:%s]", socketPath);
+
+		return 1;
+	}
+
+	addr.sun_family = AF_UNIX;
+	std::strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path) - 1);
+
+	const int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if (listenFd == -1)
+	{
+		MS_ERROR_STD("socket() failed: %s", std::strerror(errno));
+
+		return 1;
+	}
+
+	// A stale socket file from a previous zygote would make bind() fail.
+	unlink(socketPath);
+
+	if (
+	  bind(listenFd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1 ||
+	  listen(listenFd, SOMAXCONN) == -1)
+	{
+		MS_ERROR_STD("bind() or listen() failed [path:%s]: %s", socketPath, std::strerror(errno));
+
+		close(listenFd);
+
+		return 1;
+	}
+
+	try
+	{
+		Zygote::WarmUp();
+	}
+	catch (const std::exception& error)
+	{
+		MS_ERROR_STD("warm up failed: %s", error.what());
+
+		close(listenFd);
+		unlink(socketPath);
+
+		return 1;
+	}
+
+	// Let the kernel reap the workers.
+	std::signal(SIGCHLD, SIG_IGN);
+
+	while (true)
+	{
+		const int connFd = accept(listenFd, nullptr, nullptr);
+
+		if (connFd == -1)
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+
+			MS_ERROR_STD("accept() failed: %s", std::strerror(errno));
+
+			break;
+		}
+
+		Zygote::HandleConnection(listenFd, connFd, version);
+
+		close(connFd);
+	}
+
+	close(listenFd);
+	unlink(socketPath);
+
+	return 1;
+#endif
+}
+
+std::vector<std::string> Zygote::ParseArgs(const uint8_t* data, size_t len)
+{
+	std::vector<std::string> args;
+	size_t start{ 0u };
+
+	for (size_t idx{ 0u }; idx < len; ++idx)
+	{
+		if (data[idx] != '\0')
+			continue;
+
+		args.emplace_back(reinterpret_cast<const char*>(data) + start, idx - start);
+
+		start = idx + 1;
+	}
+
+	// Ignore a last argument not terminated by '\0'.
+
+	return args;
+}
+
+void Zygote::WarmUp()
+{
+	// Same as the beginning of mediasoup_worker_run() with default settings.
+	// DepLibSRTP is not destroyed so workers find it initialized, and the DTLS
+	// certificate stays in the process wide cache of DtlsTransport.
+	DepOpenSSL::ClassInit();
+	DepLibSRTP::ClassInit();
+	Utils::Crypto::ClassInit();
+	RTC::DtlsTransport::ClassInit();
+
+	// These are thread local and each worker creates its own.
+	RTC::DtlsTransport::ClassDestroy();
+	Utils::Crypto::ClassDestroy();
+}
+
+void Zygote::HandleConnection(int listenFd, int connFd, const std::string& version)
+{
+#ifndef _WIN32
+	std::vector<uint8_t> argsBuffer(Zygote::MaxArgsLength);
+	alignas(struct cmsghdr) uint8_t controlBuffer[CMSG_SPACE(sizeof(int) * Zygote::NumChannelFds)];
+	struct iovec iov
+	{
+	};
+	struct msghdr msg
+	{
+	};
+
+	iov.iov_base       = argsBuffer.data();
+	iov.iov_len        = argsBuffer.size();
+	msg.msg_iov        = &iov;
+	msg.msg_iovlen     = 1;
+	msg.msg_control    = controlBuffer;
+	msg.msg_controllen = sizeof(controlBuffer);
+
+	ssize_t len;
+
+	do
+	{
+		len = recvmsg(connFd, &msg, 0);
+	} while (len == -1 && errno == EINTR);
+
+	if (len <= 0)
+	{
+		reply(connFd, 0);
+
+		return;
+	}
+
+	std::vector<int> fds;
+
+	for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg))
+	{
+		if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+			continue;
+
+		fds.resize((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+
+		std::memcpy(fds.data(), CMSG_DATA(cmsg), fds.size() * sizeof(int));
+
+		break;
+	}
+
+	if (fds.size() != Zygote::NumChannelFds || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0)
+	{
+		MS_ERROR_STD("invalid request, expected %zu fds and no truncation", Zygote::NumChannelFds);
+
+		closeFds(fds);
+		reply(connFd, 0);
+
+		return;
+	}
+
+	const pid_t pid = fork();
+
+	if (pid == -1)
+	{
+		MS_ERROR_STD("fork() failed: %s", std::strerror(errno));
+
+		closeFds(fds);
+		reply(connFd, 0);
+
+		return;
+	}
+
+	// Worker process.
+	if (pid == 0)
+	{
+		close(listenFd);
+		close(connFd);
+
+		std::signal(SIGCHLD, SIG_DFL);
+
+		auto args = Zygote::ParseArgs(argsBuffer.data(), static_cast<size_t>(len));
+		std::vector<char*> argv;
+
+		argv.reserve(args.size() + 2);
+		argv.push_back(const_cast<char*>("mediasoup-worker"));
+
+		for (auto& arg : args)
+		{
+			argv.push_back(arg.data());
+		}
+
+		argv.push_back(nullptr);
+
+		auto statusCode = mediasoup_worker_run(
+		  static_cast<int>(argv.size() - 1),
+		  argv.data(),
+		  version.c_str(),
+		  fds[0],
+		  fds[1],
+		  fds[2],
+		  fds[3],
+		  nullptr,
+		  nullptr,
+		  nullptr,
+		  nullptr,
+		  nullptr,
+		  nullptr,
+		  nullptr,
+		  nullptr);
+
+		std::_Exit(statusCode);
+	}
+
+	// The worker owns the channel fds now.
+	closeFds(fds);
+	reply(connFd, pid);
+#endif
+}
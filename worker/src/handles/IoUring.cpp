@@ -0,0 +1,968 @@
+#define MS_CLASS "IoUring"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "handles/IoUring.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include <cerrno>
+#include <cstring> // std::memcpy(), std::memset(), std::strerror()
+#include <ctime>   // struct timespec
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <netinet/in.h>  // struct sockaddr_in6, IP_TOS, IPV6_TCLASS
+#include <sys/mman.h>    // mmap(), munmap()
+#include <sys/socket.h>  // CMSG_FIRSTHDR(), SCM_TIMESTAMPNS
+#include <sys/syscall.h> // __NR_io_uring_setup, __NR_io_uring_enter, __NR_io_uring_register
+#include <unistd.h>      // syscall(), close()
+#endif
+
+/* Static. */
+
+#ifdef __linux__
+// Number of entries of the submission ring.
+static constexpr uint32_t SqEntries{ 256 };
+// Number of entries of the completion ring (every received datagram and every
+// sent message produces one).
+static constexpr uint32_t CqEntries{ 4096 };
+// Time (in ms) the SQPOLL kernel thread keeps polling the submission ring
+// after the last submission before going to sleep.
+static constexpr uint32_t SqPollIdleMs{ 200 };
+// Provided buffers (must be a power of 2). Every buffer holds a struct
+// io_uring_recvmsg_out, the source address and the datagram, so it's sized
+// for a RTP packet of RTC::MtuSize bytes (bigger datagrams are dropped). TCP
+// data is just split into more buffers.
+static constexpr uint32_t NumBuffers{ 1024 };
+static constexpr size_t BufferSize{ 2048 };
+static constexpr uint16_t BufferGroupId{ 0 };
+static constexpr uint64_t RequestTagMask{ 0x3 };
+
+struct Ring
+{
+	void* ringPtr{ MAP_FAILED };
+	size_t ringSize{ 0u };
+	struct io_uring_sqe* sqes{ static_cast<struct io_uring_sqe*>(MAP_FAILED) };
+	size_t sqesSize{ 0u };
+	uint32_t* sqHead{ nullptr };
+	uint32_t* sqTail{ nullptr };
+	uint32_t* sqFlags{ nullptr };
+	uint32_t* sqArray{ nullptr };
+	uint32_t sqMask{ 0u };
+	uint32_t sqEntries{ 0u };
+	uint32_t sqLocalTail{ 0u };
+	uint32_t toSubmit{ 0u };
+	uint32_t* cqHead{ nullptr };
+	uint32_t* cqTail{ nullptr };
+	uint32_t cqMask{ 0u };
+	struct io_uring_cqe* cqes{ nullptr };
+	struct io_uring_buf_ring* bufRing{ static_cast<struct io_uring_buf_ring*>(MAP_FAILED) };
+	uint16_t bufRingTail{ 0u };
+	uint8_t* buffers{ static_cast<uint8_t*>(MAP_FAILED) };
+};
+
+thread_local static Ring ring;
+
+inline static int ioUringSetup(uint32_t entries, struct io_uring_params* params)
+{
+	return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+inline static int ioUringEnter(int fd, uint32_t toSubmit, uint32_t minComplete, uint32_t flags)
+{
+	return static_cast<int>(
+	  syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+inline static int ioUringRegister(int fd, uint32_t opcode, void* arg, uint32_t nrArgs)
+{
+	return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+
+inline static uint64_t makeUserData(void* ptr, IoUring::RequestTag tag)
+{
+	return reinterpret_cast<uint64_t>(ptr) | static_cast<uint64_t>(tag);
+}
+
+inline static uint32_t getFreeSqes()
+{
+	return ring.sqEntries - (ring.sqLocalTail - __atomic_load_n(ring.sqHead, __ATOMIC_ACQUIRE));
+}
+
+inline static uint8_t* getBuffer(uint16_t bufferId)
+{
+	return ring.buffers + (static_cast<size_t>(bufferId) * BufferSize);
+}
+
+// Fills recvInfo with the cmsgs of a received datagram.
+inline static void getRecvInfo(uint8_t* control, size_t controlLen, IoUring::RecvInfo& recvInfo)
+{
+	struct msghdr msg; // NOLINT(cppcoreguidelines-pro-type-member-init)
+
+	std::memset(std::addressof(msg), 0, sizeof(msg));
+
+	msg.msg_control    = control;
+	msg.msg_controllen = controlLen;
+
+	for (auto* cmsg = CMSG_FIRSTHDR(std::addressof(msg)); cmsg;
+	     cmsg       = CMSG_NXTHDR(std::addressof(msg), cmsg))
+	{
+		if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS)
+		{
+			struct timespec ts; // NOLINT(cppcoreguidelines-pro-type-member-init)
+
+			std::memcpy(std::addressof(ts), CMSG_DATA(cmsg), sizeof(ts));
+
+			recvInfo.kernelTimeNs =
+			  (static_cast<uint64_t>(ts.tv_sec) * 1000000000u) + static_cast<uint64_t>(ts.tv_nsec);
+		}
+		else if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_TOS)
+		{
+			recvInfo.tos = *CMSG_DATA(cmsg);
+		}
+		else if (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_TCLASS)
+		{
+			int tclass;
+
+			std::memcpy(std::addressof(tclass), CMSG_DATA(cmsg), sizeof(tclass));
+
+			recvInfo.tos = static_cast<int16_t>(tclass & 0xFF);
+		}
+	}
+}
+
+static void releaseRing(int fd)
+{
+	// NOTE: Closing the ring fd cancels all its requests.
+	if (fd >= 0)
+		close(fd);
+
+	if (ring.ringPtr != MAP_FAILED)
+		munmap(ring.ringPtr, ring.ringSize);
+
+	if (ring.sqes != MAP_FAILED)
+		munmap(ring.sqes, ring.sqesSize);
+
+	if (ring.bufRing != MAP_FAILED)
+		munmap(ring.bufRing, NumBuffers * sizeof(struct io_uring_buf));
+
+	if (ring.buffers != MAP_FAILED)
+		munmap(ring.buffers, NumBuffers * BufferSize);
+
+	ring = Ring();
+}
+#endif
+
+/* Static methods for UV callbacks. */
+
+inline static void onPoll(uv_poll_t* /*handle*/, int /*status*/, int /*events*/)
+{
+	IoUring::OnUvPoll();
+}
+
+inline static void onPrepare(uv_prepare_t* /*handle*/)
+{
+	IoUring::OnUvPrepare();
+}
+
+inline static void onClose(uv_handle_t* handle)
+{
+	delete reinterpret_cast<uv_poll_t*>(handle);
+}
+
+inline static void onClosePrepare(uv_handle_t* handle)
+{
+	delete reinterpret_cast<uv_prepare_t*>(handle);
+}
+
+/* Class variables. */
+
+thread_local int IoUring::ringFd{ -1 };
+thread_local bool IoUring::sqPoll{ false };
+thread_local bool IoUring::gsoDisabled{ false };
+thread_local uv_poll_t* IoUring::uvPollHandle{ nullptr };
+thread_local uv_prepare_t* IoUring::uvPrepareHandle{ nullptr };
+#ifdef __linux__
+thread_local absl::flat_hash_set<IoUring::RecvContext*> IoUring::recvContexts;
+thread_local absl::flat_hash_set<IoUring::SendBatch*> IoUring::sendBatches;
+#endif
+thread_local uint64_t IoUring::submitCalls{ 0u };
+thread_local uint64_t IoUring::recvCompletions{ 0u };
+thread_local uint64_t IoUring::sendCompletions{ 0u };
+thread_local uint64_t IoUring::sendErrors{ 0u };
+thread_local uint64_t IoUring::truncatedDatagrams{ 0u };
+
+/* Class methods. */
+
+void IoUring::ClassInit(bool sqPoll)
+{
+	MS_TRACE();
+
+#ifdef __linux__
+	struct io_uring_params params; // NOLINT(cppcoreguidelines-pro-type-member-init)
+
+	std::memset(std::addressof(params), 0, sizeof(params));
+
+	params.flags      = IORING_SETUP_CQSIZE;
+	params.cq_entries = CqEntries;
+
+	if (sqPoll)
+	{
+		params.flags |= IORING_SETUP_SQPOLL;
+		params.sq_thread_idle = SqPollIdleMs;
+	}
+
+	const int fd = ioUringSetup(SqEntries, std::addressof(params));
+
+	if (fd < 0)
+	{
+		MS_WARN_TAG(
+		  info, "io_uring_setup() failed, using libuv for packet I/O: %s", std::strerror(errno));
+
+		return;
+	}
+
+	if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0u)
+	{
+		releaseRing(fd);
+
+		MS_WARN_TAG(info, "io_uring too old, using libuv for packet I/O");
+
+		return;
+	}
+
+	// Map the submission and completion rings (a single mapping) and the
+	// submission entries.
+	ring.ringSize = std::max(
+	  params.sq_off.array + (params.sq_entries * sizeof(uint32_t)),
+	  params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe)));
+	ring.ringPtr = mmap(
+	  nullptr,
+	  ring.ringSize,
+	  PROT_READ | PROT_WRITE,
+	  MAP_SHARED | MAP_POPULATE,
+	  fd,
+	  IORING_OFF_SQ_RING);
+	ring.sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring.sqes     = static_cast<struct io_uring_sqe*>(mmap(
+	  nullptr,
+	  ring.sqesSize,
+	  PROT_READ | PROT_WRITE,
+	  MAP_SHARED | MAP_POPULATE,
+	  fd,
+	  IORING_OFF_SQES));
+
+	// Provided buffers.
+	ring.bufRing = static_cast<struct io_uring_buf_ring*>(mmap(
+	  nullptr,
+	  NumBuffers * sizeof(struct io_uring_buf),
+	  PROT_READ | PROT_WRITE,
+	  MAP_PRIVATE | MAP_ANONYMOUS,
+	  -1,
+	  0));
+	ring.buffers = static_cast<uint8_t*>(mmap(
+	  nullptr, NumBuffers * BufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+
+	// clang-format off
+	if (
+		ring.ringPtr == MAP_FAILED ||
+		ring.sqes == MAP_FAILED ||
+		ring.bufRing == MAP_FAILED ||
+		ring.buffers == MAP_FAILED
+	)
+	// clang-format on
+	{
+		releaseRing(fd);
+
+		MS_WARN_TAG(info, "mmap() failed, using libuv for packet I/O: %s", std::strerror(errno));
+
+		return;
+	}
+
+	auto* ringPtr = static_cast<uint8_t*>(ring.ringPtr);
+
+	ring.sqHead    = reinterpret_cast<uint32_t*>(ringPtr + params.sq_off.head);
+	ring.sqTail    = reinterpret_cast<uint32_t*>(ringPtr + params.sq_off.tail);
+	ring.sqFlags   = reinterpret_cast<uint32_t*>(ringPtr + params.sq_off.flags);
+	ring.sqArray   = reinterpret_cast<uint32_t*>(ringPtr + params.sq_off.array);
+	ring.sqMask    = *reinterpret_cast<uint32_t*>(ringPtr + params.sq_off.ring_mask);
+	ring.sqEntries = params.sq_entries;
+	ring.cqHead    = reinterpret_cast<uint32_t*>(ringPtr + params.cq_off.head);
+	ring.cqTail    = reinterpret_cast<uint32_t*>(ringPtr + params.cq_off.tail);
+	ring.cqMask    = *reinterpret_cast<uint32_t*>(ringPtr + params.cq_off.ring_mask);
+	ring.cqes      = reinterpret_cast<struct io_uring_cqe*>(ringPtr + params.cq_off.cqes);
+
+	struct io_uring_buf_reg reg; // NOLINT(cppcoreguidelines-pro-type-member-init)
+
+	std::memset(std::addressof(reg), 0, sizeof(reg));
+
+	reg.ring_addr    = reinterpret_cast<uint64_t>(ring.bufRing);
+	reg.ring_entries = NumBuffers;
+	reg.bgid         = BufferGroupId;
+
+	if (ioUringRegister(fd, IORING_REGISTER_PBUF_RING, std::addressof(reg), 1) != 0)
+	{
+		releaseRing(fd);
+
+		MS_WARN_TAG(
+		  info,
+		  "io_uring provided buffer ring registration failed, using libuv for packet I/O: %s",
+		  std::strerror(errno));
+
+		return;
+	}
+
+	IoUring::ringFd = fd;
+	IoUring::sqPoll = sqPoll;
+
+	for (uint32_t bufferId{ 0u }; bufferId < NumBuffers; ++bufferId)
+	{
+		IoUring::RecycleBuffer(static_cast<uint16_t>(bufferId));
+	}
+
+	// Check that multishot recvmsg() is supported (Linux >= 6.0) by arming one
+	// in a socket with nothing to read and canceling it.
+	const int probeFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	RecvContext probeContext;
+	int probeResult{ -EINVAL };
+
+	probeContext.fd = probeFd;
+
+	if (probeFd >= 0 && IoUring::SubmitRecv(std::addressof(probeContext)))
+	{
+		auto* sqe = IoUring::GetSqe();
+
+		if (sqe)
+		{
+			sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+			sqe->fd        = -1;
+			sqe->addr      = makeUserData(std::addressof(probeContext), RequestTag::RECV);
+			sqe->user_data = static_cast<uint64_t>(RequestTag::CANCEL);
+		}
+
+		IoUring::Submit();
+
+		uint32_t numCompletions{ 0u };
+
+		while (numCompletions < 2u)
+		{
+			if (ioUringEnter(fd, 0u, 1u, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+				break;
+
+			uint32_t head       = *ring.cqHead;
+			const uint32_t tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+
+			for (; head != tail; ++head, ++numCompletions)
+			{
+				const auto& cqe = ring.cqes[head & ring.cqMask];
+
+				if ((cqe.user_data & RequestTagMask) == static_cast<uint64_t>(RequestTag::RECV))
+					probeResult = cqe.res;
+			}
+
+			__atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+		}
+	}
+
+	if (probeFd >= 0)
+		close(probeFd);
+
+	if (probeResult != -ECANCELED)
+	{
+		IoUring::ringFd = -1;
+
+		releaseRing(fd);
+
+		MS_WARN_TAG(info, "io_uring multishot recvmsg() not supported, using libuv for packet I/O");
+
+		return;
+	}
+
+	IoUring::uvPollHandle = new uv_poll_t;
+
+	int err = uv_poll_init(DepLibUV::GetLoop(), IoUring::uvPollHandle, fd);
+
+	if (err != 0)
+	{
+		delete IoUring::uvPollHandle;
+		IoUring::uvPollHandle = nullptr;
+
+		IoUring::ClassDestroy();
+
+		MS_WARN_TAG(info, "uv_poll_init() failed, using libuv for packet I/O: %s", uv_strerror(err));
+
+		return;
+	}
+
+	err = uv_poll_start(IoUring::uvPollHandle, UV_READABLE, static_cast<uv_poll_cb>(onPoll));
+
+	if (err != 0)
+	{
+		IoUring::ClassDestroy();
+
+		MS_WARN_TAG(
+		  info, "uv_poll_start() failed, using libuv for packet I/O: %s", uv_strerror(err));
+
+		return;
+	}
+
+	// Do not keep the loop alive.
+	uv_unref(reinterpret_cast<uv_handle_t*>(IoUring::uvPollHandle));
+
+	// Submit the requests queued in the loop iteration. libuv runs prepare
+	// handles in reverse start order, so this runs after the ones of the
+	// sockets (started every time they queue a datagram) flush their queues.
+	IoUring::uvPrepareHandle = new uv_prepare_t;
+
+	err = uv_prepare_init(DepLibUV::GetLoop(), IoUring::uvPrepareHandle);
+
+	if (err != 0)
+	{
+		delete IoUring::uvPrepareHandle;
+		IoUring::uvPrepareHandle = nullptr;
+
+		IoUring::ClassDestroy();
+
+		MS_WARN_TAG(
+		  info, "uv_prepare_init() failed, using libuv for packet I/O: %s", uv_strerror(err));
+
+		return;
+	}
+
+	err = uv_prepare_start(IoUring::uvPrepareHandle, static_cast<uv_prepare_cb>(onPrepare));
+
+	if (err != 0)
+	{
+		IoUring::ClassDestroy();
+
+		MS_WARN_TAG(
+		  info, "uv_prepare_start() failed, using libuv for packet I/O: %s", uv_strerror(err));
+
+		return;
+	}
+
+	uv_unref(reinterpret_cast<uv_handle_t*>(IoUring::uvPrepareHandle));
+
+	MS_DEBUG_TAG(info, "using io_uring for packet I/O [sqPoll:%s]", sqPoll ? "true" : "false");
+#else
+	(void)sqPoll;
+
+	MS_WARN_TAG(info, "io_uring not supported in this platform, using libuv for packet I/O");
+#endif
+}
+
+void IoUring::ClassDestroy()
+{
+	MS_TRACE();
+
+	if (IoUring::uvPollHandle)
+	{
+		uv_close(
+		  reinterpret_cast<uv_handle_t*>(IoUring::uvPollHandle), static_cast<uv_close_cb>(onClose));
+
+		IoUring::uvPollHandle = nullptr;
+	}
+
+	if (IoUring::uvPrepareHandle)
+	{
+		uv_close(
+		  reinterpret_cast<uv_handle_t*>(IoUring::uvPrepareHandle),
+		  static_cast<uv_close_cb>(onClosePrepare));
+
+		IoUring::uvPrepareHandle = nullptr;
+	}
+
+#ifdef __linux__
+	if (!IoUring::IsRunning())
+		return;
+
+	releaseRing(IoUring::ringFd);
+
+	IoUring::ringFd = -1;
+
+	for (auto* recvContext : IoUring::recvContexts)
+	{
+		delete recvContext;
+	}
+	IoUring::recvContexts.clear();
+
+	for (auto* batch : IoUring::sendBatches)
+	{
+		delete batch;
+	}
+	IoUring::sendBatches.clear();
+#endif
+}
+
+void IoUring::FillJson(json& jsonObject)
+{
+	MS_TRACE();
+
+	jsonObject = json::object();
+
+	if (!IoUring::IsRunning())
+	{
+		jsonObject["backend"] = "libuv";
+
+		return;
+	}
+
+	jsonObject["backend"]            = "io_uring";
+	jsonObject["sqPoll"]             = IoUring::sqPoll;
+	jsonObject["gsoDisabled"]        = IoUring::gsoDisabled;
+	jsonObject["submitCalls"]        = IoUring::submitCalls;
+	jsonObject["recvCompletions"]    = IoUring::recvCompletions;
+	jsonObject["sendCompletions"]    = IoUring::sendCompletions;
+	jsonObject["sendErrors"]         = IoUring::sendErrors;
+	jsonObject["truncatedDatagrams"] = IoUring::truncatedDatagrams;
+#ifdef __linux__
+	jsonObject["recvSockets"]        = IoUring::recvContexts.size();
+	jsonObject["pendingSendBatches"] = IoUring::sendBatches.size();
+#endif
+}
+
+#ifdef __linux__
+IoUring::RecvContext* IoUring::StartRecv(int fd, Listener* listener, bool timestamps, bool tos)
+{
+	MS_TRACE();
+
+	if (!IoUring::IsRunning())
+		return nullptr;
+
+	auto* recvContext = new RecvContext();
+
+	recvContext->fd         = fd;
+	recvContext->listener   = listener;
+	recvContext->timestamps = timestamps;
+	recvContext->tos        = tos;
+
+	return IoUring::StartRecv(recvContext);
+}
+
+IoUring::RecvContext* IoUring::StartStreamRecv(int fd, StreamListener* streamListener)
+{
+	MS_TRACE();
+
+	if (!IoUring::IsRunning())
+		return nullptr;
+
+	auto* recvContext = new RecvContext();
+
+	recvContext->fd             = fd;
+	recvContext->streamListener = streamListener;
+
+	return IoUring::StartRecv(recvContext);
+}
+
+void IoUring::StopRecv(RecvContext* recvContext)
+{
+	MS_TRACE();
+
+	// Terminated by EOF or an error, so nothing to cancel.
+	if (!recvContext->armed)
+	{
+		IoUring::recvContexts.erase(recvContext);
+
+		delete recvContext;
+
+		return;
+	}
+
+	// The context is deleted once the request completes.
+	recvContext->listener       = nullptr;
+	recvContext->streamListener = nullptr;
+
+	auto* sqe = IoUring::GetSqe();
+
+	if (!sqe)
+	{
+		MS_ERROR("no io_uring submission entry available to cancel recv");
+
+		return;
+	}
+
+	sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+	sqe->fd        = -1;
+	sqe->addr      = makeUserData(recvContext, RequestTag::RECV);
+	sqe->user_data = static_cast<uint64_t>(RequestTag::CANCEL);
+
+	IoUring::Submit();
+}
+
+bool IoUring::Send(int fd, SendBatch* batch)
+{
+	MS_TRACE();
+
+	if (!IoUring::IsRunning() || batch->msgs.empty())
+		return false;
+
+	if (getFreeSqes() < batch->msgs.size())
+	{
+		IoUring::Submit();
+
+		if (getFreeSqes() < batch->msgs.size())
+			return false;
+	}
+
+	for (auto& msg : batch->msgs)
+	{
+		auto* sqe = IoUring::GetSqe();
+
+		sqe->opcode    = IORING_OP_SENDMSG;
+		sqe->fd        = fd;
+		sqe->addr      = reinterpret_cast<uint64_t>(std::addressof(msg));
+		sqe->len       = 1;
+		sqe->user_data = makeUserData(batch, RequestTag::SEND);
+	}
+
+	batch->pendingMsgs = batch->msgs.size();
+
+	IoUring::sendBatches.insert(batch);
+
+	return true;
+}
+#endif
+
+inline void IoUring::OnUvPoll()
+{
+	MS_TRACE();
+
+#ifdef __linux__
+	if (!IoUring::IsRunning())
+		return;
+
+	IoUring::ProcessCompletions();
+#endif
+}
+
+inline void IoUring::OnUvPrepare()
+{
+	MS_TRACE();
+
+#ifdef __linux__
+	if (!IoUring::IsRunning())
+		return;
+
+	IoUring::Submit();
+#endif
+}
+
+#ifdef __linux__
+struct io_uring_sqe* IoUring::GetSqe()
+{
+	if (getFreeSqes() == 0u)
+	{
+		IoUring::Submit();
+
+		if (getFreeSqes() == 0u)
+			return nullptr;
+	}
+
+	const uint32_t idx = ring.sqLocalTail & ring.sqMask;
+	auto* sqe          = std::addressof(ring.sqes[idx]);
+
+	std::memset(sqe, 0, sizeof(struct io_uring_sqe));
+
+	ring.sqArray[idx] = idx;
+	ring.sqLocalTail++;
+	ring.toSubmit++;
+
+	return sqe;
+}
+
+IoUring::RecvContext* IoUring::StartRecv(RecvContext* recvContext)
+{
+	MS_TRACE();
+
+	if (!IoUring::SubmitRecv(recvContext))
+	{
+		delete recvContext;
+
+		return nullptr;
+	}
+
+	IoUring::recvContexts.insert(recvContext);
+
+	return recvContext;
+}
+
+bool IoUring::SubmitRecv(RecvContext* recvContext)
+{
+	MS_TRACE();
+
+	auto* sqe = IoUring::GetSqe();
+
+	if (!sqe)
+		return false;
+
+	// Stream data is written at the beginning of the buffer.
+	if (recvContext->streamListener)
+	{
+		sqe->opcode = IORING_OP_RECV;
+	}
+	// Room for the source address in every buffer.
+	else
+	{
+		std::memset(std::addressof(recvContext->msg), 0, sizeof(recvContext->msg));
+
+		recvContext->msg.msg_namelen = sizeof(struct sockaddr_in6);
+
+		// And for the SO_TIMESTAMPNS and IP_TOS cmsgs (aligned) after it.
+		if (recvContext->timestamps || recvContext->tos)
+		{
+			recvContext->msg.msg_namelen = CMSG_ALIGN(sizeof(struct sockaddr_in6));
+
+			if (recvContext->timestamps)
+				recvContext->msg.msg_controllen += CMSG_SPACE(sizeof(struct timespec));
+
+			if (recvContext->tos)
+				recvContext->msg.msg_controllen += CMSG_SPACE(sizeof(int));
+		}
+
+		sqe->opcode = IORING_OP_RECVMSG;
+		sqe->addr   = reinterpret_cast<uint64_t>(std::addressof(recvContext->msg));
+		sqe->len    = 1;
+	}
+
+	sqe->fd        = recvContext->fd;
+	sqe->ioprio    = IORING_RECV_MULTISHOT;
+	sqe->flags     = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = BufferGroupId;
+	sqe->user_data = makeUserData(recvContext, RequestTag::RECV);
+
+	recvContext->armed = true;
+
+	IoUring::Submit();
+
+	return true;
+}
+
+void IoUring::DeliverStreamData(RecvContext* recvContext, const uint8_t* data, size_t len)
+{
+	MS_TRACE();
+
+	// The listener may close the socket within the callback.
+	while (len > 0u && recvContext->streamListener)
+	{
+		const size_t consumed = recvContext->streamListener->OnIoUringStreamReceived(data, len);
+
+		if (consumed == 0u)
+			break;
+
+		data += consumed;
+		len -= consumed;
+	}
+}
+
+void IoUring::Submit()
+{
+	if (ring.toSubmit == 0u)
+		return;
+
+	__atomic_store_n(ring.sqTail, ring.sqLocalTail, __ATOMIC_RELEASE);
+
+	// The kernel thread consumes the submission ring by itself. Just wake it up
+	// if it went to sleep.
+	if (IoUring::sqPoll)
+	{
+		ring.toSubmit = 0u;
+
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+		if ((__atomic_load_n(ring.sqFlags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP) != 0u)
+		{
+			ioUringEnter(IoUring::ringFd, 0u, 0u, IORING_ENTER_SQ_WAKEUP);
+
+			IoUring::submitCalls++;
+		}
+
+		return;
+	}
+
+	const int ret = ioUringEnter(IoUring::ringFd, ring.toSubmit, 0u, 0u);
+
+	IoUring::submitCalls++;
+
+	if (ret >= 0)
+	{
+		ring.toSubmit -= static_cast<uint32_t>(std::min(ret, static_cast<int>(ring.toSubmit)));
+	}
+	// Otherwise the entries are submitted next time.
+	else if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+	{
+		MS_ERROR("io_uring_enter() failed: %s", std::strerror(errno));
+	}
+}
+
+void IoUring::RecycleBuffer(uint16_t bufferId)
+{
+	// NOTE: The bufs flexible array member of struct io_uring_buf_ring is not
+	// well laid out when compiled as C++, so entries are indexed by hand. The
+	// tail of the ring overlays the resv field of its first entry, so it must
+	// not be written.
+	auto* bufs = reinterpret_cast<struct io_uring_buf*>(ring.bufRing);
+	auto& buf  = bufs[ring.bufRingTail & (NumBuffers - 1u)];
+
+	buf.addr = reinterpret_cast<uint64_t>(getBuffer(bufferId));
+	buf.len  = BufferSize;
+	buf.bid  = bufferId;
+
+	ring.bufRingTail++;
+
+	__atomic_store_n(std::addressof(ring.bufRing->tail), ring.bufRingTail, __ATOMIC_RELEASE);
+}
+
+void IoUring::ProcessCompletions()
+{
+	MS_TRACE();
+
+	uint32_t head = *ring.cqHead;
+
+	// Completions may be added while listeners are notified.
+	while (head != __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE))
+	{
+		const auto& cqe      = ring.cqes[head & ring.cqMask];
+		const auto userData  = cqe.user_data;
+		const int32_t res    = cqe.res;
+		const uint32_t flags = cqe.flags;
+		auto* ptr            = reinterpret_cast<void*>(userData & ~RequestTagMask);
+
+		// Free the completion entry before notifying.
+		__atomic_store_n(ring.cqHead, ++head, __ATOMIC_RELEASE);
+
+		switch (static_cast<RequestTag>(userData & RequestTagMask))
+		{
+			case RequestTag::RECV:
+			{
+				auto* recvContext    = static_cast<RecvContext*>(ptr);
+				const bool hasBuffer = (flags & IORING_CQE_F_BUFFER) != 0u;
+				const auto bufferId  = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+				const bool isStream  = recvContext->streamListener != nullptr;
+
+				if (isStream)
+				{
+					if (res > 0 && hasBuffer)
+					{
+						IoUring::recvCompletions++;
+
+						IoUring::DeliverStreamData(
+						  recvContext, getBuffer(bufferId), static_cast<size_t>(res));
+					}
+					// Closed by the peer or failed.
+					else if (res == 0 || (res < 0 && res != -ENOBUFS && res != -ECANCELED))
+					{
+						recvContext->streamListener->OnIoUringStreamClosed(res);
+					}
+				}
+				else if (res >= 0 && hasBuffer)
+				{
+					auto* buffer        = getBuffer(bufferId);
+					auto* out           = reinterpret_cast<struct io_uring_recvmsg_out*>(buffer);
+					auto* name          = buffer + sizeof(struct io_uring_recvmsg_out);
+					const size_t offset = sizeof(struct io_uring_recvmsg_out) +
+					                      recvContext->msg.msg_namelen + recvContext->msg.msg_controllen;
+
+					IoUring::recvCompletions++;
+
+					if ((out->flags & MSG_TRUNC) != 0u)
+					{
+						IoUring::truncatedDatagrams++;
+
+						MS_ERROR("received datagram was truncated due to insufficient buffer, ignoring it");
+					}
+					else if (recvContext->listener && static_cast<size_t>(res) >= offset)
+					{
+						IoUring::RecvInfo recvInfo;
+
+						if (out->controllen != 0u)
+							getRecvInfo(name + recvContext->msg.msg_namelen, out->controllen, recvInfo);
+
+						recvContext->listener->OnIoUringDatagramReceived(
+						  buffer + offset,
+						  static_cast<size_t>(res) - offset,
+						  reinterpret_cast<const struct sockaddr*>(name),
+						  recvInfo);
+					}
+				}
+				else if (res < 0 && res != -ENOBUFS && res != -ECANCELED && recvContext->listener)
+				{
+					MS_WARN_DEV("recvmsg() failed: %s", std::strerror(-res));
+				}
+
+				if (hasBuffer)
+					IoUring::RecycleBuffer(bufferId);
+
+				// The request is still armed.
+				if ((flags & IORING_CQE_F_MORE) != 0u)
+					break;
+
+				recvContext->armed = false;
+
+				// Socket closed.
+				if (!recvContext->listener && !recvContext->streamListener)
+				{
+					IoUring::recvContexts.erase(recvContext);
+
+					delete recvContext;
+				}
+				// Terminated because all the provided buffers were in use, arm it again.
+				// clang-format off
+				else if (
+					res == -ENOBUFS ||
+					res > 0 ||
+					(res == 0 && !isStream)
+				)
+				// clang-format on
+				{
+					if (!IoUring::SubmitRecv(recvContext))
+						MS_ERROR("no io_uring submission entry available to arm recv again");
+				}
+				else if (res < 0)
+				{
+					MS_ERROR("recv terminated: %s", std::strerror(-res));
+				}
+
+				break;
+			}
+
+			case RequestTag::SEND:
+			{
+				auto* batch = static_cast<SendBatch*>(ptr);
+
+				IoUring::sendCompletions++;
+
+				if (res < 0)
+				{
+					IoUring::sendErrors++;
+
+					// GSO not supported by the kernel or the NIC. Disable it for next
+					// batches.
+					if ((res == -EIO || res == -EINVAL) && batch->gso && !IoUring::gsoDisabled)
+					{
+						MS_WARN_DEV(
+						  "sendmsg() with UDP_SEGMENT failed, disabling GSO: %s", std::strerror(-res));
+
+						IoUring::gsoDisabled = true;
+					}
+					else
+					{
+						MS_DEBUG_DEV("sendmsg() failed: %s", std::strerror(-res));
+					}
+				}
+
+				if (--batch->pendingMsgs == 0u)
+				{
+					IoUring::sendBatches.erase(batch);
+
+					delete batch;
+				}
+
+				break;
+			}
+
+			case RequestTag::CANCEL:
+			{
+				break;
+			}
+		}
+	}
+}
+#endif
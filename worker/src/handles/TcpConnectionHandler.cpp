@@ -5,8 +5,25 @@
 #include "DepLibUV.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Metrics.hpp"
 #include "Utils.hpp"
-#include <cstring> // std::memcpy()
+#include <algorithm> // std::min()
+#include <cerrno>
+#include <cstring> // std::memcpy(), std::memmove(), std::strerror()
+#ifdef __linux__
+#include <netinet/in.h>  // IPPROTO_TCP
+#include <netinet/tcp.h> // TCP_NOTSENT_LOWAT
+#include <sys/socket.h>  // setsockopt()
+#endif
+
+/* Static. */
+
+// Once this many bytes are queued they are written without waiting for the
+// end of the loop iteration.
+static constexpr size_t WriteBufferFlushSize{ 65536 };
+// Max unsent bytes the kernel accepts, so data waits in the write queue (where
+// stale media can be dropped) instead of in the socket buffer.
+static constexpr int NotSentLowat{ 16384 };
 
 /* Static methods for UV callbacks. */
 
@@ -31,13 +48,31 @@ inline static void onWrite(uv_write_t* req, int status)
 	auto* writeData  = static_cast<TcpConnectionHandler::UvWriteData*>(req->data);
 	auto* handle     = req->handle;
 	auto* connection = static_cast<TcpConnectionHandler*>(handle->data);
-	auto* cb         = writeData->cb;
 
+	// The UvWriteData struct is reused by the connection unless it was closed.
 	if (connection)
-		connection->OnUvWrite(status, cb);
+		connection->OnUvWrite(status);
+	else
+		delete writeData;
+}
 
-	// Delete the UvWriteData struct and the cb.
-	delete writeData;
+inline static void onPrepare(uv_prepare_t* handle)
+{
+	auto* connection = static_cast<TcpConnectionHandler*>(handle->data);
+
+	if (connection)
+		connection->OnUvPrepare();
+}
+
+inline static void onConnect(uv_connect_t* req, int status)
+{
+	auto* connection = static_cast<TcpConnectionHandler*>(req->handle->data);
+
+	delete req;
+
+	// NOTE: If the connection was closed meanwhile, status is UV_ECANCELED.
+	if (connection)
+		connection->OnUvConnect(status);
 }
 
 inline static void onClose(uv_handle_t* handle)
@@ -45,6 +80,11 @@ inline static void onClose(uv_handle_t* handle)
 	delete handle;
 }
 
+inline static void onClosePrepare(uv_handle_t* handle)
+{
+	delete reinterpret_cast<uv_prepare_t*>(handle);
+}
+
 inline static void onShutdown(uv_shutdown_t* req, int /*status*/)
 {
 	auto* handle = req->handle;
@@ -87,19 +127,78 @@ void TcpConnectionHandler::Close()
 
 	int err;
 
+	// Write queued data before closing.
+	if (!this->hasError && !this->isClosedByPeer)
+	{
+		Flush();
+
+		// A write is in progress, so write queued data in a new request (libuv
+		// keeps the order of write requests).
+		if (!this->writeBuffer.empty())
+		{
+			auto* writeData = new UvWriteData();
+
+			writeData->req.data = static_cast<void*>(writeData);
+			writeData->store.swap(this->writeBuffer);
+
+			uv_buf_t buffer =
+			  uv_buf_init(reinterpret_cast<char*>(writeData->store.data()), writeData->store.size());
+
+			err = uv_write(
+			  &writeData->req,
+			  reinterpret_cast<uv_stream_t*>(this->uvHandle),
+			  &buffer,
+			  1,
+			  static_cast<uv_write_cb>(onWrite));
+
+			if (err != 0)
+			{
+				MS_WARN_DEV("uv_write() failed: %s", uv_strerror(err));
+
+				delete writeData;
+			}
+		}
+	}
+
 	this->closed = true;
 
-	// Tell the UV handle that the TcpConnectionHandler has been closed.
+	// Tell the UV handles that the TcpConnectionHandler has been closed.
 	this->uvHandle->data = nullptr;
 
+	if (this->uvPrepareHandle)
+	{
+		this->uvPrepareHandle->data = nullptr;
+
+		uv_close(
+		  reinterpret_cast<uv_handle_t*>(this->uvPrepareHandle),
+		  static_cast<uv_close_cb>(onClosePrepare));
+	}
+
+	// If a write is in progress its UvWriteData struct is deleted once done.
+	if (!this->writing)
+		delete this->uvWriteData;
+
+	this->uvWriteData = nullptr;
+
 	// Don't read more.
-	err = uv_read_stop(reinterpret_cast<uv_stream_t*>(this->uvHandle));
+#ifdef __linux__
+	if (this->ioUringRecvContext)
+	{
+		IoUring::StopRecv(this->ioUringRecvContext);
 
-	if (err != 0)
-		MS_ABORT("uv_read_stop() failed: %s", uv_strerror(err));
+		this->ioUringRecvContext = nullptr;
+	}
+	else
+#endif
+	{
+		err = uv_read_stop(reinterpret_cast<uv_stream_t*>(this->uvHandle));
+
+		if (err != 0)
+			MS_ABORT("uv_read_stop() failed: %s", uv_strerror(err));
+	}
 
 	// If there is no error and the peer didn't close its connection side then close gracefully.
-	if (!this->hasError && !this->isClosedByPeer)
+	if (!this->hasError && !this->isClosedByPeer && !this->connecting)
 	{
 		// Use uv_shutdown() so pending data to be written will be sent to the peer
 		// before closing.
@@ -129,6 +228,28 @@ void TcpConnectionHandler::Dump() const
 	MS_DUMP("</TcpConnectionHandler>");
 }
 
+void TcpConnectionHandler::FillJsonStats(json& jsonObject) const
+{
+	MS_TRACE();
+
+	jsonObject = json::object();
+
+	// Add recvBytes.
+	jsonObject["recvBytes"] = this->recvBytes;
+
+	// Add sentBytes.
+	jsonObject["sentBytes"] = this->sentBytes;
+
+	// Add writeQueueSize.
+	jsonObject["writeQueueSize"] = GetWriteQueueSize();
+
+	// Add droppedMediaPackets.
+	jsonObject["droppedMediaPackets"] = this->droppedMediaPackets;
+
+	// Add droppedMediaBytes.
+	jsonObject["droppedMediaBytes"] = this->droppedMediaBytes;
+}
+
 void TcpConnectionHandler::Setup(
   Listener* listener, struct sockaddr_storage* localAddr, const std::string& localIp, uint16_t localPort)
 {
@@ -145,6 +266,20 @@ void TcpConnectionHandler::Setup(
 		MS_THROW_ERROR("uv_tcp_init() failed: %s", uv_strerror(err));
 	}
 
+	this->uvPrepareHandle       = new uv_prepare_t;
+	this->uvPrepareHandle->data = static_cast<void*>(this);
+
+	err = uv_prepare_init(DepLibUV::GetLoop(), this->uvPrepareHandle);
+
+	// If it fails, written data is not coalesced.
+	if (err != 0)
+	{
+		delete this->uvPrepareHandle;
+		this->uvPrepareHandle = nullptr;
+
+		MS_WARN_DEV("uv_prepare_init() failed: %s", uv_strerror(err));
+	}
+
 	// Set the listener.
 	this->listener = listener;
 
@@ -154,6 +289,29 @@ void TcpConnectionHandler::Setup(
 	this->localPort = localPort;
 }
 
+void TcpConnectionHandler::Connect(Listener* listener, const struct sockaddr* remoteAddr)
+{
+	MS_TRACE();
+
+	// The local address is known once connected.
+	// This may throw.
+	Setup(listener, std::addressof(this->connectLocalAddr), "", 0u);
+
+	auto* req = new uv_connect_t;
+
+	const int err =
+	  uv_tcp_connect(req, this->uvHandle, remoteAddr, static_cast<uv_connect_cb>(onConnect));
+
+	if (err != 0)
+	{
+		delete req;
+
+		MS_THROW_ERROR("uv_tcp_connect() failed: %s", uv_strerror(err));
+	}
+
+	this->connecting = true;
+}
+
 void TcpConnectionHandler::Start()
 {
 	MS_TRACE();
@@ -161,13 +319,25 @@ void TcpConnectionHandler::Start()
 	if (this->closed)
 		return;
 
-	int err = uv_read_start(
-	  reinterpret_cast<uv_stream_t*>(this->uvHandle),
-	  static_cast<uv_alloc_cb>(onAlloc),
-	  static_cast<uv_read_cb>(onRead));
+#ifdef __linux__
+	uv_os_fd_t fd;
 
-	if (err != 0)
-		MS_THROW_ERROR("uv_read_start() failed: %s", uv_strerror(err));
+	if (uv_fileno(reinterpret_cast<uv_handle_t*>(this->uvHandle), &fd) == 0)
+		this->ioUringRecvContext = IoUring::StartStreamRecv(fd, this);
+#endif
+
+	SetSocketOptions();
+
+	if (!this->ioUringRecvContext)
+	{
+		const int err = uv_read_start(
+		  reinterpret_cast<uv_stream_t*>(this->uvHandle),
+		  static_cast<uv_alloc_cb>(onAlloc),
+		  static_cast<uv_read_cb>(onRead));
+
+		if (err != 0)
+			MS_THROW_ERROR("uv_read_start() failed: %s", uv_strerror(err));
+	}
 
 	// Get the peer address.
 	if (!SetPeerAddress())
@@ -179,17 +349,15 @@ void TcpConnectionHandler::Write(
   size_t len1,
   const uint8_t* data2,
   size_t len2,
-  TcpConnectionHandler::onSendCallback* cb)
+  TcpConnectionHandler::onSendCallback* cb,
+  bool isMedia)
 {
 	MS_TRACE();
 
 	if (this->closed)
 	{
 		if (cb)
-		{
 			(*cb)(false);
-			delete cb;
-		}
 
 		return;
 	}
@@ -197,44 +365,143 @@ void TcpConnectionHandler::Write(
 	if (len1 == 0 && len2 == 0)
 	{
 		if (cb)
-		{
 			(*cb)(false);
-			delete cb;
-		}
 
 		return;
 	}
 
-	size_t totalLen = len1 + len2;
-	uv_buf_t buffers[2];
-	int written{ 0 };
+	// First data written in this loop iteration, write it before next poll.
+	// If a write is in progress, it's written once done.
+	if (this->writeBuffer.empty() && !this->writing && this->uvPrepareHandle)
+	{
+		int err = uv_prepare_start(this->uvPrepareHandle, static_cast<uv_prepare_cb>(onPrepare));
+
+		if (err != 0)
+			MS_ABORT("uv_prepare_start() failed: %s", uv_strerror(err));
+	}
+
+	if (isMedia)
+	{
+		this->queuedMedia.push_back(
+		  { this->writeBuffer.size(), len1 + len2, DepLibUV::GetTimeMs() });
+	}
+
+	this->writeBuffer.insert(this->writeBuffer.end(), data1, data1 + len1);
+	this->writeBuffer.insert(this->writeBuffer.end(), data2, data2 + len2);
+
+	// Update sent bytes.
+	this->sentBytes += len1 + len2;
+
+	// NOTE: The data is owned by the connection now, so consider it sent (a
+	// later failure closes the connection in OnUvWrite()).
+	if (cb)
+		(*cb)(true);
+
+	if (this->writeBuffer.size() >= WriteBufferFlushSize || !this->uvPrepareHandle)
+		Flush();
+}
+
+size_t TcpConnectionHandler::GetWriteQueueSize() const
+{
+	MS_TRACE();
+
+	if (this->closed)
+		return 0u;
+
+	return this->writeBuffer.size() +
+	       uv_stream_get_write_queue_size(reinterpret_cast<const uv_stream_t*>(this->uvHandle));
+}
+
+void TcpConnectionHandler::ErrorReceiving()
+{
+	MS_TRACE();
+
+	Close();
+
+	this->listener->OnTcpConnectionClosed(this);
+}
+
+bool TcpConnectionHandler::SetPeerAddress()
+{
+	MS_TRACE();
+
 	int err;
+	int len = sizeof(this->peerAddr);
 
-	// First try uv_try_write(). In case it can not directly write all the given
-	// data then build a uv_req_t and use uv_write().
+	err = uv_tcp_getpeername(this->uvHandle, reinterpret_cast<struct sockaddr*>(&this->peerAddr), &len);
 
-	buffers[0] = uv_buf_init(reinterpret_cast<char*>(const_cast<uint8_t*>(data1)), len1);
-	buffers[1] = uv_buf_init(reinterpret_cast<char*>(const_cast<uint8_t*>(data2)), len2);
-	written    = uv_try_write(reinterpret_cast<uv_stream_t*>(this->uvHandle), buffers, 2);
+	if (err != 0)
+	{
+		MS_ERROR("uv_tcp_getpeername() failed: %s", uv_strerror(err));
 
-	// All the data was written. Done.
-	if (written == static_cast<int>(totalLen))
+		return false;
+	}
+
+	int family;
+
+	Utils::IP::GetAddressInfo(
+	  reinterpret_cast<const struct sockaddr*>(&this->peerAddr), family, this->peerIp, this->peerPort);
+
+	return true;
+}
+
+void TcpConnectionHandler::SetSocketOptions()
+{
+	MS_TRACE();
+
+	// Do not delay RTCP feedback and retransmissions waiting for more data.
+	const int err = uv_tcp_nodelay(this->uvHandle, 1);
+
+	if (err != 0)
+		MS_WARN_DEV("uv_tcp_nodelay() failed: %s", uv_strerror(err));
+
+#if defined(__linux__) && defined(TCP_NOTSENT_LOWAT)
+	uv_os_fd_t fd;
+
+	if (uv_fileno(reinterpret_cast<uv_handle_t*>(this->uvHandle), &fd) == 0)
 	{
-		// Update sent bytes.
-		this->sentBytes += written;
+		const int lowat{ NotSentLowat };
 
-		if (cb)
-		{
-			(*cb)(true);
-			delete cb;
-		}
+		if (setsockopt(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &lowat, sizeof(lowat)) != 0)
+			MS_WARN_DEV("setsockopt(TCP_NOTSENT_LOWAT) failed: %s", std::strerror(errno));
+	}
+#endif
+}
+
+void TcpConnectionHandler::Flush()
+{
+	MS_TRACE();
+
+	// If a write is in progress, queued data is written once done.
+	if (this->writeBuffer.empty() || this->writing)
+		return;
+
+	DropStaleMedia();
+
+	if (this->writeBuffer.empty())
+		return;
+
+	if (this->uvPrepareHandle)
+		uv_prepare_stop(this->uvPrepareHandle);
+
+	// First try uv_try_write(). In case it can not directly write all the queued
+	// data then use uv_write().
+
+	uv_buf_t buffer =
+	  uv_buf_init(reinterpret_cast<char*>(this->writeBuffer.data()), this->writeBuffer.size());
+	int written = uv_try_write(reinterpret_cast<uv_stream_t*>(this->uvHandle), &buffer, 1);
+
+	// All the data was written. Done.
+	if (written == static_cast<int>(this->writeBuffer.size()))
+	{
+		this->writeBuffer.clear();
 
 		return;
 	}
 	// Cannot write any data at first time. Use uv_write().
 	else if (written == UV_EAGAIN || written == UV_ENOSYS)
 	{
-		// Set written to 0 so pendingLen can be properly calculated.
+		// Set written to 0 so pending data can be properly calculated.
 		written = 0;
 	}
 	// Any other error.
@@ -242,37 +509,29 @@ void TcpConnectionHandler::Write(
 	{
 		MS_WARN_DEV("uv_try_write() failed, trying uv_write(): %s", uv_strerror(written));
 
-		// Set written to 0 so pendingLen can be properly calculated.
+		// Set written to 0 so pending data can be properly calculated.
 		written = 0;
 	}
 
-	size_t pendingLen = totalLen - written;
-	auto* writeData   = new UvWriteData(pendingLen);
-
-	writeData->req.data = static_cast<void*>(writeData);
-
-	// If the first buffer was not entirely written then splice it.
-	if (static_cast<size_t>(written) < len1)
-	{
-		std::memcpy(
-		  writeData->store, data1 + static_cast<size_t>(written), len1 - static_cast<size_t>(written));
-		std::memcpy(writeData->store + (len1 - static_cast<size_t>(written)), data2, len2);
-	}
-	// Otherwise just take the pending data in the second buffer.
-	else
+	if (!this->uvWriteData)
 	{
-		std::memcpy(
-		  writeData->store,
-		  data2 + (static_cast<size_t>(written) - len1),
-		  len2 - (static_cast<size_t>(written) - len1));
+		this->uvWriteData           = new UvWriteData();
+		this->uvWriteData->req.data = static_cast<void*>(this->uvWriteData);
 	}
 
-	writeData->cb = cb;
+	// Swap buffers instead of copying the pending data. Both keep their
+	// capacity so no allocation is needed in the steady state.
+	auto& store = this->uvWriteData->store;
+
+	store.swap(this->writeBuffer);
+	this->writeBuffer.clear();
 
-	uv_buf_t buffer = uv_buf_init(reinterpret_cast<char*>(writeData->store), pendingLen);
+	buffer = uv_buf_init(
+	  reinterpret_cast<char*>(store.data() + static_cast<size_t>(written)),
+	  store.size() - static_cast<size_t>(written));
 
-	err = uv_write(
-	  &writeData->req,
+	int err = uv_write(
+	  &this->uvWriteData->req,
 	  reinterpret_cast<uv_stream_t*>(this->uvHandle),
 	  &buffer,
 	  1,
@@ -282,50 +541,60 @@ void TcpConnectionHandler::Write(
 	{
 		MS_WARN_DEV("uv_write() failed: %s", uv_strerror(err));
 
-		if (cb)
-			(*cb)(false);
+		store.clear();
 
-		// Delete the UvWriteData struct (it will delete the store and cb too).
-		delete writeData;
-	}
-	else
-	{
-		// Update sent bytes.
-		this->sentBytes += pendingLen;
+		return;
 	}
+
+	this->writing = true;
 }
 
-void TcpConnectionHandler::ErrorReceiving()
+void TcpConnectionHandler::DropStaleMedia()
 {
 	MS_TRACE();
 
-	Close();
+	if (this->queuedMedia.empty())
+		return;
 
-	this->listener->OnTcpConnectionClosed(this);
-}
+	const uint64_t nowMs = DepLibUV::GetTimeMs();
+	auto* data           = this->writeBuffer.data();
+	// Where data is being read from and copied to.
+	size_t readPos{ 0u };
+	size_t writePos{ 0u };
 
-bool TcpConnectionHandler::SetPeerAddress()
-{
-	MS_TRACE();
+	// Media is queued in order, so stale one is the first one.
+	for (const auto& media : this->queuedMedia)
+	{
+		if (nowMs - media.queuedAtMs < MaxQueuedMediaAge)
+			break;
 
-	int err;
-	int len = sizeof(this->peerAddr);
+		// Keep the data queued before it.
+		const size_t keepLen = media.offset - readPos;
 
-	err = uv_tcp_getpeername(this->uvHandle, reinterpret_cast<struct sockaddr*>(&this->peerAddr), &len);
+		if (writePos != readPos)
+			std::memmove(data + writePos, data + readPos, keepLen);
 
-	if (err != 0)
-	{
-		MS_ERROR("uv_tcp_getpeername() failed: %s", uv_strerror(err));
+		writePos += keepLen;
+		readPos = media.offset + media.len;
 
-		return false;
+		++this->droppedMediaPackets;
+		this->droppedMediaBytes += media.len;
+		this->sentBytes -= media.len;
 	}
 
-	int family;
+	// Data is written right after this so queued media is not tracked anymore.
+	this->queuedMedia.clear();
 
-	Utils::IP::GetAddressInfo(
-	  reinterpret_cast<const struct sockaddr*>(&this->peerAddr), family, this->peerIp, this->peerPort);
+	if (readPos == 0u)
+		return;
 
-	return true;
+	MS_DEBUG_DEV("dropped %zu bytes of stale media", readPos - writePos);
+
+	const size_t keepLen = this->writeBuffer.size() - readPos;
+
+	std::memmove(data + writePos, data + readPos, keepLen);
+
+	this->writeBuffer.resize(writePos + keepLen);
 }
 
 inline void TcpConnectionHandler::OnUvReadAlloc(size_t /*suggestedSize*/, uv_buf_t* buf)
@@ -368,6 +637,9 @@ inline void TcpConnectionHandler::OnUvRead(ssize_t nread, const uv_buf_t* /*buf*
 		// Update the buffer data length.
 		this->bufferDataLen += static_cast<size_t>(nread);
 
+		// Stamp RTP packets parsed from it.
+		Metrics::MarkIngress();
+
 		// Notify the subclass.
 		UserOnTcpConnectionRead();
 	}
@@ -399,29 +671,121 @@ inline void TcpConnectionHandler::OnUvRead(ssize_t nread, const uv_buf_t* /*buf*
 	}
 }
 
-inline void TcpConnectionHandler::OnUvWrite(int status, TcpConnectionHandler::onSendCallback* cb)
+inline void TcpConnectionHandler::OnUvWrite(int status)
 {
 	MS_TRACE();
 
-	// NOTE: Do not delete cb here since it will be delete in onWrite() above.
+	this->writing = false;
+	this->uvWriteData->store.clear();
 
-	if (status == 0)
-	{
-		if (cb)
-			(*cb)(true);
-	}
-	else
+	if (status != 0)
 	{
 		if (status != UV_EPIPE && status != UV_ENOTCONN)
 			this->hasError = true;
 
 		MS_WARN_DEV("write error, closing the connection: %s", uv_strerror(status));
 
-		if (cb)
-			(*cb)(false);
+		Close();
+
+		this->listener->OnTcpConnectionClosed(this);
+	}
+	// Otherwise write data queued meanwhile.
+	else
+	{
+		Flush();
+	}
+}
+
+inline void TcpConnectionHandler::OnUvPrepare()
+{
+	MS_TRACE();
+
+	Flush();
+}
+
+inline void TcpConnectionHandler::OnUvConnect(int status)
+{
+	MS_TRACE();
+
+	this->connecting = false;
+
+	if (status != 0)
+	{
+		MS_WARN_DEV("connection failed: %s", uv_strerror(status));
+
+		this->hasError = true;
+
+		Close();
+
+		this->listener->OnTcpConnectionClosed(this);
+
+		return;
+	}
+
+	int len = sizeof(this->connectLocalAddr);
+	int family;
+
+	const int err = uv_tcp_getsockname(
+	  this->uvHandle, reinterpret_cast<struct sockaddr*>(&this->connectLocalAddr), &len);
+
+	if (err != 0)
+		MS_ABORT("uv_tcp_getsockname() failed: %s", uv_strerror(err));
+
+	Utils::IP::GetAddressInfo(
+	  reinterpret_cast<const struct sockaddr*>(&this->connectLocalAddr),
+	  family,
+	  this->localIp,
+	  this->localPort);
+
+	try
+	{
+		// NOTE: This may throw.
+		Start();
+	}
+	catch (const MediaSoupError& error)
+	{
+		this->hasError = true;
 
 		Close();
 
 		this->listener->OnTcpConnectionClosed(this);
+
+		return;
+	}
+
+	this->listener->OnTcpConnectionConnected(this);
+}
+
+size_t TcpConnectionHandler::OnIoUringStreamReceived(const uint8_t* data, size_t len)
+{
+	MS_TRACE();
+
+	if (!this->buffer)
+		this->buffer = new uint8_t[this->bufferSize];
+
+	// Same as libuv does when OnUvReadAlloc() gives no space.
+	if (this->bufferDataLen >= this->bufferSize)
+	{
+		MS_WARN_DEV("no available space in the buffer");
+
+		OnUvRead(UV_ENOBUFS, nullptr);
+
+		return 0u;
 	}
+
+	const size_t copied = std::min(len, this->bufferSize - this->bufferDataLen);
+
+	std::memcpy(this->buffer + this->bufferDataLen, data, copied);
+
+	// NOTE: This may close (and delete) the connection.
+	OnUvRead(static_cast<ssize_t>(copied), nullptr);
+
+	return copied;
+}
+
+void TcpConnectionHandler::OnIoUringStreamClosed(int error)
+{
+	MS_TRACE();
+
+	OnUvRead(error == 0 ? UV_EOF : error, nullptr);
 }
@@ -2,40 +2,16 @@
 // #define MS_LOG_DEV_LEVEL 3
 
 #include "handles/Timer.hpp"
-#include "DepLibUV.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
 
-/* Static methods for UV callbacks. */
-
-inline static void onTimer(uv_timer_t* handle)
-{
-	static_cast<Timer*>(handle->data)->OnUvTimer();
-}
-
-inline static void onClose(uv_handle_t* handle)
-{
-	delete handle;
-}
-
 /* Instance methods. */
 
 Timer::Timer(Listener* listener) : listener(listener)
 {
 	MS_TRACE();
 
-	this->uvHandle       = new uv_timer_t;
-	this->uvHandle->data = static_cast<void*>(this);
-
-	int err = uv_timer_init(DepLibUV::GetLoop(), this->uvHandle);
-
-	if (err != 0)
-	{
-		delete this->uvHandle;
-		this->uvHandle = nullptr;
-
-		MS_THROW_ERROR("uv_timer_init() failed: %s", uv_strerror(err));
-	}
+	this->wheelNode.timer = this;
 }
 
 Timer::~Timer()
@@ -55,7 +31,7 @@ void Timer::Close()
 
 	this->closed = true;
 
-	uv_close(reinterpret_cast<uv_handle_t*>(this->uvHandle), static_cast<uv_close_cb>(onClose));
+	TimerWheel::Cancel(std::addressof(this->wheelNode));
 }
 
 void Timer::Start(uint64_t timeout, uint64_t repeat)
@@ -68,13 +44,7 @@ void Timer::Start(uint64_t timeout, uint64_t repeat)
 	this->timeout = timeout;
 	this->repeat  = repeat;
 
-	if (uv_is_active(reinterpret_cast<uv_handle_t*>(this->uvHandle)) != 0)
-		Stop();
-
-	int err = uv_timer_start(this->uvHandle, static_cast<uv_timer_cb>(onTimer), timeout, repeat);
-
-	if (err != 0)
-		MS_THROW_ERROR("uv_timer_start() failed: %s", uv_strerror(err));
+	TimerWheel::Arm(std::addressof(this->wheelNode), timeout);
 }
 
 void Timer::Stop()
@@ -84,10 +54,7 @@ void Timer::Stop()
 	if (this->closed)
 		MS_THROW_ERROR("closed");
 
-	int err = uv_timer_stop(this->uvHandle);
-
-	if (err != 0)
-		MS_THROW_ERROR("uv_timer_stop() failed: %s", uv_strerror(err));
+	TimerWheel::Cancel(std::addressof(this->wheelNode));
 }
 
 void Timer::Reset()
@@ -97,17 +64,13 @@ void Timer::Reset()
 	if (this->closed)
 		MS_THROW_ERROR("closed");
 
-	if (uv_is_active(reinterpret_cast<uv_handle_t*>(this->uvHandle)) == 0)
+	if (!IsActive())
 		return;
 
 	if (this->repeat == 0u)
 		return;
 
-	int err =
-	  uv_timer_start(this->uvHandle, static_cast<uv_timer_cb>(onTimer), this->repeat, this->repeat);
-
-	if (err != 0)
-		MS_THROW_ERROR("uv_timer_start() failed: %s", uv_strerror(err));
+	TimerWheel::Arm(std::addressof(this->wheelNode), this->repeat);
 }
 
 void Timer::Restart()
@@ -117,20 +80,18 @@ void Timer::Restart()
 	if (this->closed)
 		MS_THROW_ERROR("closed");
 
-	if (uv_is_active(reinterpret_cast<uv_handle_t*>(this->uvHandle)) != 0)
-		Stop();
-
-	int err =
-	  uv_timer_start(this->uvHandle, static_cast<uv_timer_cb>(onTimer), this->timeout, this->repeat);
-
-	if (err != 0)
-		MS_THROW_ERROR("uv_timer_start() failed: %s", uv_strerror(err));
+	TimerWheel::Arm(std::addressof(this->wheelNode), this->timeout);
 }
 
-inline void Timer::OnUvTimer()
+void Timer::OnTimerWheel()
 {
 	MS_TRACE();
 
+	// Re-arm it before notifying the listener (as libuv does) so the listener
+	// can stop it.
+	if (this->repeat != 0u)
+		TimerWheel::Arm(std::addressof(this->wheelNode), this->repeat);
+
 	// Notify the listener.
 	this->listener->OnTimer(this);
 }
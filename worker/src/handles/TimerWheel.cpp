@@ -0,0 +1,246 @@
+#define MS_CLASS "TimerWheel"
+// #define MS_LOG_DEV_LEVEL 3
+
+#include "handles/TimerWheel.hpp"
+#include "DepLibUV.hpp"
+#include "Logger.hpp"
+#include "MediaSoupErrors.hpp"
+#include "handles/Timer.hpp"
+#include <algorithm> // std::min()
+
+/* Static methods for UV callbacks. */
+
+inline static void onTimer(uv_timer_t* /*handle*/)
+{
+	TimerWheel::OnUvTimer();
+}
+
+inline static void onClose(uv_handle_t* handle)
+{
+	delete handle;
+}
+
+/* Static. */
+
+static inline void initList(TimerWheel::Node* list)
+{
+	list->prev = list;
+	list->next = list;
+}
+
+static inline void append(TimerWheel::Node* list, TimerWheel::Node* node)
+{
+	node->prev       = list->prev;
+	node->next       = list;
+	list->prev->next = node;
+	list->prev       = node;
+}
+
+static inline void unlink(TimerWheel::Node* node)
+{
+	node->prev->next = node->next;
+	node->next->prev = node->prev;
+	node->prev       = nullptr;
+	node->next       = nullptr;
+}
+
+/* Class variables. */
+
+thread_local uv_timer_t* TimerWheel::uvHandle{ nullptr };
+thread_local std::array<TimerWheel::Node, TimerWheel::NumSlots> TimerWheel::slots;
+thread_local TimerWheel::Node TimerWheel::expired;
+thread_local uint64_t TimerWheel::currentTick{ 0u };
+thread_local uint64_t TimerWheel::scheduledAt{ 0u };
+thread_local size_t TimerWheel::numArmed{ 0u };
+thread_local bool TimerWheel::processing{ false };
+
+/* Class methods. */
+
+void TimerWheel::ClassDestroy()
+{
+	MS_TRACE();
+
+	if (!TimerWheel::uvHandle)
+		return;
+
+	uv_close(reinterpret_cast<uv_handle_t*>(TimerWheel::uvHandle), static_cast<uv_close_cb>(onClose));
+
+	TimerWheel::uvHandle = nullptr;
+}
+
+void TimerWheel::Arm(Node* node, uint64_t timeout)
+{
+	// NOTE: No MS_TRACE() here since this is called very often.
+
+	if (!TimerWheel::uvHandle)
+		Init();
+
+	const uint64_t now = uv_now(DepLibUV::GetLoop());
+
+	if (TimerWheel::IsArmed(node))
+	{
+		unlink(node);
+	}
+	else
+	{
+		// If the wheel was idle there is nothing to catch up with, so let timers
+		// with no timeout expire in the current tick.
+		if (TimerWheel::numArmed == 0u && !TimerWheel::processing)
+			TimerWheel::currentTick = now - 1u;
+
+		++TimerWheel::numArmed;
+	}
+
+	// Timers cannot expire in a tick that has already been processed.
+	node->expiresAt = std::max(now + timeout, TimerWheel::currentTick + 1u);
+
+	append(&TimerWheel::slots[node->expiresAt & (NumSlots - 1u)], node);
+
+	// Schedule() will be called once all expired timers are notified.
+	if (TimerWheel::processing)
+		return;
+
+	if (
+	  uv_is_active(reinterpret_cast<uv_handle_t*>(TimerWheel::uvHandle)) == 0 ||
+	  node->expiresAt < TimerWheel::scheduledAt)
+	{
+		TimerWheel::scheduledAt = node->expiresAt;
+
+		const uint64_t delay = node->expiresAt > now ? node->expiresAt - now : 0u;
+		const int err =
+		  uv_timer_start(TimerWheel::uvHandle, static_cast<uv_timer_cb>(onTimer), delay, 0u);
+
+		if (err != 0)
+			MS_THROW_ERROR("uv_timer_start() failed: %s", uv_strerror(err));
+	}
+}
+
+void TimerWheel::Cancel(Node* node)
+{
+	// NOTE: No MS_TRACE() here since this is called very often.
+
+	if (!TimerWheel::IsArmed(node))
+		return;
+
+	unlink(node);
+
+	--TimerWheel::numArmed;
+
+	// Do not keep the loop alive if there are no more timers.
+	if (TimerWheel::numArmed == 0u && !TimerWheel::processing && TimerWheel::uvHandle)
+		uv_timer_stop(TimerWheel::uvHandle);
+}
+
+void TimerWheel::Init()
+{
+	MS_TRACE();
+
+	TimerWheel::uvHandle = new uv_timer_t;
+
+	int err = uv_timer_init(DepLibUV::GetLoop(), TimerWheel::uvHandle);
+
+	if (err != 0)
+	{
+		delete TimerWheel::uvHandle;
+		TimerWheel::uvHandle = nullptr;
+
+		MS_THROW_ERROR("uv_timer_init() failed: %s", uv_strerror(err));
+	}
+
+	// Timers may be left in the lists if a previous uv handle was closed.
+	if (TimerWheel::numArmed != 0u)
+		return;
+
+	for (auto& slot : TimerWheel::slots)
+	{
+		initList(std::addressof(slot));
+	}
+
+	initList(std::addressof(TimerWheel::expired));
+
+	TimerWheel::currentTick = uv_now(DepLibUV::GetLoop());
+}
+
+void TimerWheel::Schedule(uint64_t now)
+{
+	// NOTE: No MS_TRACE() here since this is called very often.
+
+	if (TimerWheel::numArmed == 0u)
+	{
+		uv_timer_stop(TimerWheel::uvHandle);
+
+		return;
+	}
+
+	// Look for the next non empty slot. It may just contain timers for later
+	// wheel turns, in which case the wheel will be rescheduled again.
+	for (uint64_t tick{ TimerWheel::currentTick + 1u }; tick <= TimerWheel::currentTick + NumSlots;
+	     ++tick)
+	{
+		auto* slot = std::addressof(TimerWheel::slots[tick & (NumSlots - 1u)]);
+
+		if (slot->next == slot)
+			continue;
+
+		TimerWheel::scheduledAt = tick;
+
+		const int err = uv_timer_start(
+		  TimerWheel::uvHandle, static_cast<uv_timer_cb>(onTimer), tick > now ? tick - now : 0u, 0u);
+
+		if (err != 0)
+			MS_THROW_ERROR("uv_timer_start() failed: %s", uv_strerror(err));
+
+		return;
+	}
+}
+
+inline void TimerWheel::OnUvTimer()
+{
+	// NOTE: No MS_TRACE() here since this is called very often.
+
+	const uint64_t now = uv_now(DepLibUV::GetLoop());
+	// If more than a wheel turn elapsed, every slot must be checked once.
+	const uint64_t numTicks = std::min(now - TimerWheel::currentTick, uint64_t{ NumSlots });
+
+	// Move expired timers to the expired list so listeners can freely arm and
+	// cancel any timer while they are notified.
+	for (uint64_t i{ 1u }; i <= numTicks; ++i)
+	{
+		auto* slot = std::addressof(TimerWheel::slots[(TimerWheel::currentTick + i) & (NumSlots - 1u)]);
+		auto* node = slot->next;
+
+		while (node != slot)
+		{
+			auto* next = node->next;
+
+			if (node->expiresAt <= now)
+			{
+				unlink(node);
+				append(std::addressof(TimerWheel::expired), node);
+			}
+
+			node = next;
+		}
+	}
+
+	TimerWheel::currentTick = now;
+	TimerWheel::processing  = true;
+
+	auto* expired = std::addressof(TimerWheel::expired);
+
+	while (expired->next != expired)
+	{
+		auto* node = expired->next;
+
+		unlink(node);
+
+		--TimerWheel::numArmed;
+
+		// Notify the Timer.
+		node->timer->OnTimerWheel();
+	}
+
+	TimerWheel::processing = false;
+
+	Schedule(now);
+}
@@ -2,15 +2,61 @@
 // #define MS_LOG_DEV_LEVEL 3
 
 #include "handles/UdpSocketHandler.hpp"
+#include "DepLibUV.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Metrics.hpp"
+#include "Settings.hpp"
 #include "Utils.hpp"
-#include <cstring> // std::memcpy()
+#include <cerrno>  // errno
+#include <cstring> // std::memcpy(), std::memcmp(), std::strerror()
+#include <ctime>   // clock_gettime()
+#ifdef __linux__
+#include <linux/sock_diag.h> // SK_MEMINFO_VARS, SK_MEMINFO_DROPS
+#include <netinet/in.h>      // IP_TOS, IP_RECVTOS, IPV6_TCLASS, IPV6_RECVTCLASS
+#include <netinet/udp.h>     // SOL_UDP, UDP_SEGMENT
+#endif
+
+#if defined(__linux__) && !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
 
 /* Static. */
 
-static constexpr size_t ReadBufferSize{ 65536 };
+// Max size of a single datagram (same as libuv UV__UDP_DGRAM_MAXSIZE).
+static constexpr size_t MaxDatagramSize{ 65536 };
+// Number of datagrams libuv can read in a single recvmmsg() call (libuv caps it
+// to UV__MMSG_MAXWIDTH which is 20).
+static constexpr size_t RecvMmsgMaxDatagrams{ 16 };
+// The read buffer is a slab of RecvMmsgMaxDatagrams slots. When the handle was
+// initialized with UV_UDP_RECVMMSG, libuv splits it into chunks and fills as
+// many as it can in a single syscall. Otherwise it's used for a single datagram.
+static constexpr size_t ReadBufferSize{ MaxDatagramSize * RecvMmsgMaxDatagrams };
 thread_local static uint8_t ReadBuffer[ReadBufferSize];
+// Max number of datagrams queued in the egress queue before it's flushed
+// without waiting for the end of the event loop iteration.
+static constexpr size_t SendMmsgMaxDatagrams{ 64 };
+// Datagrams bigger than this are not queued but directly sent.
+static constexpr size_t SendQueueMaxDatagramSize{ 1500 };
+// Max number of same sized datagrams to the same peer sent as UDP GSO
+// segments of a single message.
+static constexpr size_t GsoMaxSegments{ 16 };
+// Kernel receive timestamps older than this (ns) are ignored since they are
+// due to a step of the system clock.
+static constexpr uint64_t MaxKernelTimeAgeNs{ 1000000000u };
+// ECN-Capable Transport codepoint set in sent datagrams if the ecn setting is
+// enabled.
+static constexpr int EcnEct0{ 0x02 };
+
+/* Class variables. */
+
+thread_local uint64_t UdpSocketHandler::recvBatches{ 0u };
+thread_local uint64_t UdpSocketHandler::recvBatchedDatagrams{ 0u };
+thread_local uint64_t UdpSocketHandler::sendBatches{ 0u };
+thread_local uint64_t UdpSocketHandler::sendBatchedDatagrams{ 0u };
+thread_local std::unordered_set<UdpSocketHandler*> UdpSocketHandler::handlers;
+thread_local uint64_t UdpSocketHandler::recvTimeMs{ 0u };
+thread_local int8_t UdpSocketHandler::recvEcn{ -1 };
 
 /* Static methods for UV callbacks. */
 
@@ -36,20 +82,153 @@ inline static void onSend(uv_udp_send_t* req, int status)
 	auto* sendData = static_cast<UdpSocketHandler::UvSendData*>(req->data);
 	auto* handle   = req->handle;
 	auto* socket   = static_cast<UdpSocketHandler*>(handle->data);
-	auto* cb       = sendData->cb;
 
 	if (socket)
-		socket->OnUvSend(status, cb);
+		socket->OnUvSend(status);
 
-	// Delete the UvSendData struct (it will delete the store and cb too).
+	// Delete the UvSendData struct (it will delete the store too).
 	delete sendData;
 }
 
+inline static void onPrepare(uv_prepare_t* handle)
+{
+	auto* socket = static_cast<UdpSocketHandler*>(handle->data);
+
+	if (socket)
+		socket->OnUvPrepare();
+}
+
 inline static void onClose(uv_handle_t* handle)
 {
 	delete handle;
 }
 
+inline static void onClosePrepare(uv_handle_t* handle)
+{
+	delete reinterpret_cast<uv_prepare_t*>(handle);
+}
+
+#ifdef __linux__
+inline static socklen_t getSockAddrLen(const struct sockaddr* addr)
+{
+	return addr->sa_family == AF_INET6 ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+}
+
+inline static bool isSameSockAddr(const struct sockaddr_storage& a, const struct sockaddr_storage& b)
+{
+	if (a.ss_family != b.ss_family)
+		return false;
+
+	return std::memcmp(
+	         std::addressof(a),
+	         std::addressof(b),
+	         getSockAddrLen(reinterpret_cast<const struct sockaddr*>(std::addressof(a)))) == 0;
+}
+
+inline static void setGsoSegmentSize(struct msghdr& msg, uint8_t* control, size_t segSize)
+{
+	std::memset(control, 0, CMSG_SPACE(sizeof(uint16_t)));
+
+	msg.msg_control    = control;
+	msg.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+
+	auto* cmsg       = CMSG_FIRSTHDR(std::addressof(msg));
+	cmsg->cmsg_level = SOL_UDP;
+	cmsg->cmsg_type  = UDP_SEGMENT;
+	cmsg->cmsg_len   = CMSG_LEN(sizeof(uint16_t));
+
+	auto segSize16 = static_cast<uint16_t>(segSize);
+
+	std::memcpy(CMSG_DATA(cmsg), &segSize16, sizeof(uint16_t));
+}
+
+inline static bool enableKernelTimestamps(int fd)
+{
+	int on{ 1 };
+
+	if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) != 0)
+	{
+		MS_WARN_TAG(info, "setsockopt(SO_TIMESTAMPNS) failed: %s", std::strerror(errno));
+
+		return false;
+	}
+
+	return true;
+}
+
+// Lets the kernel busy poll the device queue for received datagrams.
+inline static void enableBusyPoll(int fd, uint32_t busyPollUs)
+{
+#ifdef SO_BUSY_POLL
+	auto value = static_cast<int>(busyPollUs);
+
+	// NOTE: Values above the net.core.busy_poll sysctl require CAP_NET_ADMIN.
+	if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value)) != 0)
+		MS_WARN_TAG(info, "setsockopt(SO_BUSY_POLL) failed: %s", std::strerror(errno));
+#endif
+}
+
+// Marks sent datagrams as ECN capable and, if recv is true, asks the kernel for
+// the TOS (or traffic class) byte of received ones. Returns whether the latter
+// was enabled.
+inline static bool enableEcn(int fd, bool recv)
+{
+	int domain{ AF_INET };
+	socklen_t domainLen = sizeof(domain);
+	int tos{ EcnEct0 };
+	int on{ 1 };
+
+	getsockopt(fd, SOL_SOCKET, SO_DOMAIN, &domain, &domainLen);
+
+	const int level       = domain == AF_INET6 ? IPPROTO_IPV6 : IPPROTO_IP;
+	const int tosName     = domain == AF_INET6 ? IPV6_TCLASS : IP_TOS;
+	const int recvTosName = domain == AF_INET6 ? IPV6_RECVTCLASS : IP_RECVTOS;
+
+	if (setsockopt(fd, level, tosName, &tos, sizeof(tos)) != 0)
+		MS_WARN_TAG(info, "setsockopt(IP_TOS) failed: %s", std::strerror(errno));
+
+	if (!recv)
+		return false;
+
+	if (setsockopt(fd, level, recvTosName, &on, sizeof(on)) != 0)
+	{
+		MS_WARN_TAG(info, "setsockopt(IP_RECVTOS) failed: %s", std::strerror(errno));
+
+		return false;
+	}
+
+	return true;
+}
+
+// Converts a CLOCK_REALTIME time into the DepLibUV::GetTimeMs() time base.
+inline static uint64_t getMonotonicTimeMs(uint64_t realtimeNs)
+{
+	struct timespec now; // NOLINT(cppcoreguidelines-pro-type-member-init)
+
+	clock_gettime(CLOCK_REALTIME, std::addressof(now));
+
+	const uint64_t nowNs =
+	  (static_cast<uint64_t>(now.tv_sec) * 1000000000u) + static_cast<uint64_t>(now.tv_nsec);
+
+	if (realtimeNs > nowNs || nowNs - realtimeNs > MaxKernelTimeAgeNs)
+		return 0u;
+
+	return (DepLibUV::GetHighResTimeNs() - (nowNs - realtimeNs)) / 1000000u;
+}
+#endif
+
+/* Class methods. */
+
+void UdpSocketHandler::ApplyBufferSizes()
+{
+	MS_TRACE();
+
+	for (auto* handler : UdpSocketHandler::handlers)
+	{
+		handler->SetBufferSizes();
+	}
+}
+
 /* Instance methods. */
 
 // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
@@ -61,23 +240,83 @@ UdpSocketHandler::UdpSocketHandler(uv_udp_t* uvHandle) : uvHandle(uvHandle)
 
 	this->uvHandle->data = static_cast<void*>(this);
 
-	err = uv_udp_recv_start(
-	  this->uvHandle, static_cast<uv_alloc_cb>(onAlloc), static_cast<uv_udp_recv_cb>(onRecv));
+#ifdef __linux__
+	uv_os_fd_t fd;
 
-	if (err != 0)
+	// The egress queue is flushed with sendmmsg() (or io_uring) on the socket
+	// fd. If we cannot get it, datagrams are sent one by one.
+	if (uv_fileno(reinterpret_cast<uv_handle_t*>(this->uvHandle), &fd) == 0)
+		this->fd = static_cast<int>(fd);
+
+	// Read with io_uring if enabled (with kernel receive timestamps if also
+	// enabled).
+	if (this->fd >= 0)
 	{
-		uv_close(reinterpret_cast<uv_handle_t*>(this->uvHandle), static_cast<uv_close_cb>(onClose));
+		bool timestamps{ false };
+		bool tos{ false };
+
+		if (IoUring::IsRunning() && Settings::configuration.kernelRecvTimestamps)
+			timestamps = enableKernelTimestamps(this->fd);
+
+		// CE marks of received datagrams can just be read with io_uring.
+		if (Settings::configuration.ecn)
+			tos = enableEcn(this->fd, IoUring::IsRunning());
 
-		MS_THROW_ERROR("uv_udp_recv_start() failed: %s", uv_strerror(err));
+		if (Settings::configuration.busyPollUs > 0u)
+			enableBusyPoll(this->fd, Settings::configuration.busyPollUs);
+
+		this->ioUringRecvContext = IoUring::StartRecv(this->fd, this, timestamps, tos);
+	}
+#endif
+
+	if (!this->ioUringRecvContext)
+	{
+		err = uv_udp_recv_start(
+		  this->uvHandle, static_cast<uv_alloc_cb>(onAlloc), static_cast<uv_udp_recv_cb>(onRecv));
+
+		if (err != 0)
+		{
+			uv_close(reinterpret_cast<uv_handle_t*>(this->uvHandle), static_cast<uv_close_cb>(onClose));
+
+			MS_THROW_ERROR("uv_udp_recv_start() failed: %s", uv_strerror(err));
+		}
 	}
 
 	// Set local address.
 	if (!SetLocalAddress())
 	{
+#ifdef __linux__
+		if (this->ioUringRecvContext)
+			IoUring::StopRecv(this->ioUringRecvContext);
+#endif
+
 		uv_close(reinterpret_cast<uv_handle_t*>(this->uvHandle), static_cast<uv_close_cb>(onClose));
 
 		MS_THROW_ERROR("error setting local IP and port");
 	}
+
+	SetBufferSizes();
+
+	UdpSocketHandler::handlers.insert(this);
+
+#ifdef __linux__
+	if (this->fd >= 0)
+	{
+		this->uvPrepareHandle       = new uv_prepare_t;
+		this->uvPrepareHandle->data = static_cast<void*>(this);
+
+		err = uv_prepare_init(DepLibUV::GetLoop(), this->uvPrepareHandle);
+
+		if (err != 0)
+		{
+			delete this->uvPrepareHandle;
+			this->uvPrepareHandle = nullptr;
+			this->fd              = -1;
+
+			MS_WARN_DEV("uv_prepare_init() failed, sendmmsg() disabled: %s", uv_strerror(err));
+		}
+	}
+#endif
 }
 
 UdpSocketHandler::~UdpSocketHandler()
@@ -95,16 +334,41 @@ void UdpSocketHandler::Close()
 	if (this->closed)
 		return;
 
+	// Send queued datagrams before closing.
+	FlushSendQueue();
+
 	this->closed = true;
 
+	UdpSocketHandler::handlers.erase(this);
+
 	// Tell the UV handle that the UdpSocketHandler has been closed.
 	this->uvHandle->data = nullptr;
 
+	if (this->uvPrepareHandle)
+	{
+		this->uvPrepareHandle->data = nullptr;
+
+		uv_close(
+		  reinterpret_cast<uv_handle_t*>(this->uvPrepareHandle),
+		  static_cast<uv_close_cb>(onClosePrepare));
+	}
+
 	// Don't read more.
-	int err = uv_udp_recv_stop(this->uvHandle);
+	if (this->ioUringRecvContext)
+	{
+#ifdef __linux__
+		IoUring::StopRecv(this->ioUringRecvContext);
+#endif
 
-	if (err != 0)
-		MS_ABORT("uv_udp_recv_stop() failed: %s", uv_strerror(err));
+		this->ioUringRecvContext = nullptr;
+	}
+	else
+	{
+		int err = uv_udp_recv_stop(this->uvHandle);
+
+		if (err != 0)
+			MS_ABORT("uv_udp_recv_stop() failed: %s", uv_strerror(err));
+	}
 
 	uv_close(reinterpret_cast<uv_handle_t*>(this->uvHandle), static_cast<uv_close_cb>(onClose));
 }
@@ -118,6 +382,51 @@ void UdpSocketHandler::Dump() const
 	MS_DUMP("</UdpSocketHandler>");
 }
 
+void UdpSocketHandler::FillJsonStats(json& jsonObject) const
+{
+	MS_TRACE();
+
+	jsonObject = json::object();
+
+	// Add recvBytes.
+	jsonObject["recvBytes"] = this->recvBytes;
+
+	// Add sentBytes.
+	jsonObject["sentBytes"] = this->sentBytes;
+
+	// Add recvBufferSize and sendBufferSize (as reported by the kernel, which
+	// doubles the requested ones in Linux).
+	int bufferSize{ 0 };
+
+	if (uv_recv_buffer_size(reinterpret_cast<uv_handle_t*>(this->uvHandle), &bufferSize) == 0)
+		jsonObject["recvBufferSize"] = bufferSize;
+
+	bufferSize = 0;
+
+	if (uv_send_buffer_size(reinterpret_cast<uv_handle_t*>(this->uvHandle), &bufferSize) == 0)
+		jsonObject["sendBufferSize"] = bufferSize;
+
+#if defined(__linux__) && defined(SO_MEMINFO)
+	// Add recvDrops (datagrams dropped by the kernel because the receive buffer
+	// was full, Linux >= 4.6).
+	if (this->fd >= 0)
+	{
+		uint32_t memInfo[SK_MEMINFO_VARS];
+		socklen_t memInfoLen = sizeof(memInfo);
+
+		// clang-format off
+		if (
+			getsockopt(this->fd, SOL_SOCKET, SO_MEMINFO, memInfo, &memInfoLen) == 0 &&
+			memInfoLen > SK_MEMINFO_DROPS * sizeof(uint32_t)
+		)
+		// clang-format on
+		{
+			jsonObject["recvDrops"] = memInfo[SK_MEMINFO_DROPS];
+		}
+	}
+#endif
+}
+
 void UdpSocketHandler::Send(
   const uint8_t* data, size_t len, const struct sockaddr* addr, UdpSocketHandler::onSendCallback* cb)
 {
@@ -126,10 +435,7 @@ void UdpSocketHandler::Send(
 	if (this->closed)
 	{
 		if (cb)
-		{
 			(*cb)(false);
-			delete cb;
-		}
 
 		return;
 	}
@@ -137,14 +443,58 @@ void UdpSocketHandler::Send(
 	if (len == 0)
 	{
 		if (cb)
-		{
 			(*cb)(false);
-			delete cb;
-		}
 
 		return;
 	}
 
+	// Queue the datagram so it's sent with sendmmsg() (along with others sent
+	// during this event loop iteration) unless it's too big or the egress queue
+	// is not available.
+	if (this->uvPrepareHandle && len <= SendQueueMaxDatagramSize)
+	{
+		EnqueueSend(data, len, addr, cb);
+
+		return;
+	}
+
+	// Keep ordering with queued datagrams.
+	FlushSendQueue();
+
+	SendNow(data, len, addr, cb);
+}
+
+uint8_t* UdpSocketHandler::GetSendBuffer(size_t len)
+{
+	MS_TRACE();
+
+	if (this->closed || len == 0 || !this->uvPrepareHandle || len > SendQueueMaxDatagramSize)
+		return nullptr;
+
+#ifdef __linux__
+	return ReserveSendQueueBuffer(len);
+#else
+	return nullptr;
+#endif
+}
+
+void UdpSocketHandler::SendBuffer(
+  size_t len, const struct sockaddr* addr, UdpSocketHandler::onSendCallback* cb)
+{
+	MS_TRACE();
+
+	MS_ASSERT(
+	  this->sendQueueBufferLen + len <= this->sendQueueBuffer.size(),
+	  "SendBuffer() called without a previous GetSendBuffer() call");
+
+	CommitSendQueueBuffer(len, addr, cb);
+}
+
+void UdpSocketHandler::SendNow(
+  const uint8_t* data, size_t len, const struct sockaddr* addr, UdpSocketHandler::onSendCallback* cb)
+{
+	MS_TRACE();
+
 	// First try uv_udp_try_send(). In case it can not directly send the datagram
 	// then build a uv_req_t and use uv_udp_send().
 
@@ -158,10 +508,7 @@ void UdpSocketHandler::Send(
 		this->sentBytes += sent;
 
 		if (cb)
-		{
 			(*cb)(true);
-			delete cb;
-		}
 
 		return;
 	}
@@ -173,10 +520,7 @@ void UdpSocketHandler::Send(
 		this->sentBytes += sent;
 
 		if (cb)
-		{
 			(*cb)(false);
-			delete cb;
-		}
 
 		return;
 	}
@@ -190,7 +534,6 @@ void UdpSocketHandler::Send(
 
 	sendData->req.data = static_cast<void*>(sendData);
 	std::memcpy(sendData->store, data, len);
-	sendData->cb = cb;
 
 	buffer = uv_buf_init(reinterpret_cast<char*>(sendData->store), len);
 
@@ -206,14 +549,371 @@ void UdpSocketHandler::Send(
 		if (cb)
 			(*cb)(false);
 
-		// Delete the UvSendData struct (it will delete the store and cb too).
+		// Delete the UvSendData struct (it will delete the store too).
 		delete sendData;
 	}
 	else
 	{
 		// Update sent bytes.
 		this->sentBytes += len;
+
+		// NOTE: The datagram is owned by libuv now, so consider it sent (a later
+		// failure is just logged in OnUvSend()).
+		if (cb)
+			(*cb)(true);
+	}
+}
+
+void UdpSocketHandler::EnqueueSend(
+  const uint8_t* data, size_t len, const struct sockaddr* addr, UdpSocketHandler::onSendCallback* cb)
+{
+	MS_TRACE();
+
+#ifdef __linux__
+	std::memcpy(ReserveSendQueueBuffer(len), data, len);
+
+	CommitSendQueueBuffer(len, addr, cb);
+#else
+	SendNow(data, len, addr, cb);
+#endif
+}
+
+inline uint8_t* UdpSocketHandler::ReserveSendQueueBuffer(size_t len)
+{
+	// NOTE: The buffer never shrinks, so it's just resized (and zero filled)
+	// while its memory is growing.
+	if (this->sendQueueBufferLen + len > this->sendQueueBuffer.size())
+		this->sendQueueBuffer.resize(this->sendQueueBufferLen + len);
+
+	return this->sendQueueBuffer.data() + this->sendQueueBufferLen;
+}
+
+inline void UdpSocketHandler::CommitSendQueueBuffer(
+  size_t len, const struct sockaddr* addr, UdpSocketHandler::onSendCallback* cb)
+{
+#ifdef __linux__
+	SendQueueItem item;
+
+	item.offset     = this->sendQueueBufferLen;
+	item.len        = len;
+	item.queuedAtNs = Metrics::IsIngressTimeEnabled() ? DepLibUV::GetHighResTimeNs() : 0u;
+
+	std::memcpy(std::addressof(item.addr), addr, getSockAddrLen(addr));
+
+	this->sendQueueBufferLen += len;
+	this->sendQueue.push_back(item);
+
+	// First queued datagram in this iteration, flush them before next poll.
+	if (this->sendQueue.size() == 1u)
+	{
+		int err =
+		  uv_prepare_start(this->uvPrepareHandle, static_cast<uv_prepare_cb>(onPrepare));
+
+		if (err != 0)
+			MS_ABORT("uv_prepare_start() failed: %s", uv_strerror(err));
+	}
+
+	// NOTE: The datagram is owned by the egress queue now, so consider it sent.
+	if (cb)
+		(*cb)(true);
+
+	if (this->sendQueue.size() >= SendMmsgMaxDatagrams)
+		FlushSendQueue();
+#else
+	MS_ABORT("egress queue not available");
+#endif
+}
+
+void UdpSocketHandler::FlushSendQueue()
+{
+	MS_TRACE();
+
+	if (this->sendQueue.empty())
+		return;
+
+#ifdef __linux__
+	uv_prepare_stop(this->uvPrepareHandle);
+
+	// Swap the queue so datagrams sent within callbacks are queued again.
+	std::vector<SendQueueItem> items;
+	std::vector<uint8_t> buffer;
+
+	items.swap(this->sendQueue);
+	buffer.swap(this->sendQueueBuffer);
+
+	this->sendQueueBufferLen = 0u;
+
+	size_t numItems = items.size();
+	size_t idx{ 0u };
+
+	// Time spent by datagrams in the egress queue.
+	if (Metrics::IsIngressTimeEnabled())
+	{
+		auto nowNs = DepLibUV::GetHighResTimeNs();
+
+		for (auto& item : items)
+		{
+			Metrics::RecordSendQueueDelay(nowNs - item.queuedAtNs);
+		}
+	}
+
+	// If libuv has pending send requests, let it send these datagrams so
+	// ordering is kept.
+	if (uv_udp_get_send_queue_count(this->uvHandle) != 0u)
+	{
+		// Sent one by one below.
+	}
+	// With io_uring the memory of the queue is handed over to the kernel so
+	// datagrams are not copied.
+	else if (IoUring::IsRunning() && FlushSendQueueIoUring(items, buffer))
+	{
+		idx = numItems;
+	}
+	else
+	{
+		struct mmsghdr msgs[SendMmsgMaxDatagrams];
+		struct iovec iovs[SendMmsgMaxDatagrams];
+		// Control buffers for the UDP_SEGMENT cmsg.
+		alignas(struct cmsghdr) uint8_t controls[SendMmsgMaxDatagrams][CMSG_SPACE(sizeof(uint16_t))];
+		// Index of the first item of each message (plus one extra for the end).
+		size_t msgItems[SendMmsgMaxDatagrams + 1];
+		size_t numMsgs{ 0u };
+
+		std::memset(msgs, 0, sizeof(msgs));
+
+		for (size_t i{ 0u }; i < numItems; ++i)
+		{
+			auto& item = items[i];
+
+			iovs[i].iov_base = buffer.data() + item.offset;
+			iovs[i].iov_len  = item.len;
+		}
+
+		// Group consecutive datagrams into messages. With UDP GSO, consecutive
+		// datagrams to the same peer can be sent as segments of a single message
+		// if all of them have the same size (but the last one, that can be smaller).
+		for (size_t i{ 0u }; i < numItems;)
+		{
+			const size_t j = GetGsoGroupEnd(items, i, this->gsoEnabled);
+			auto& msg      = msgs[numMsgs].msg_hdr;
+
+			msg.msg_name    = std::addressof(items[i].addr);
+			msg.msg_namelen = getSockAddrLen(reinterpret_cast<struct sockaddr*>(msg.msg_name));
+			msg.msg_iov     = std::addressof(iovs[i]);
+			msg.msg_iovlen  = j - i;
+
+			if (j - i > 1)
+				setGsoSegmentSize(msg, controls[numMsgs], items[i].len);
+
+			msgItems[numMsgs++] = i;
+			i                   = j;
+		}
+
+		msgItems[numMsgs] = numItems;
+
+		size_t msgIdx{ 0u };
+
+		while (msgIdx < numMsgs)
+		{
+			int ret = sendmmsg(this->fd, msgs + msgIdx, numMsgs - msgIdx, 0);
+
+			if (ret < 0)
+			{
+				if (errno == EINTR)
+					continue;
+
+				// GSO not supported by the kernel or the NIC. Disable it and let the
+				// remaining datagrams be sent one by one.
+				if ((errno == EIO || errno == EINVAL) && msgs[msgIdx].msg_hdr.msg_iovlen > 1)
+				{
+					MS_WARN_DEV("sendmmsg() with UDP_SEGMENT failed, disabling GSO: %s", std::strerror(errno));
+
+					this->gsoEnabled = false;
+				}
+				// EAGAIN or any other error. Remaining datagrams are sent one by
+				// one (using uv_udp_send() if needed).
+				else if (errno != EAGAIN && errno != EWOULDBLOCK)
+				{
+					MS_WARN_DEV("sendmmsg() failed: %s", std::strerror(errno));
+				}
+
+				break;
+			}
+
+			UdpSocketHandler::sendBatches++;
+
+			for (int m{ 0 }; m < ret; ++m)
+			{
+				for (size_t i = msgItems[msgIdx + m]; i < msgItems[msgIdx + m + 1]; ++i)
+				{
+					auto& item = items[i];
+
+					UdpSocketHandler::sendBatchedDatagrams++;
+
+					// Update sent bytes.
+					this->sentBytes += item.len;
+				}
+			}
+
+			msgIdx += ret;
+		}
+
+		idx = msgItems[msgIdx];
+	}
+
+	// Send the remaining ones (if any) one by one.
+	for (; idx < numItems; ++idx)
+	{
+		auto& item = items[idx];
+
+		SendNow(
+		  buffer.data() + item.offset,
+		  item.len,
+		  reinterpret_cast<const struct sockaddr*>(std::addressof(item.addr)),
+		  nullptr);
+	}
+
+	// Reuse the allocated memory if no datagram was queued meanwhile.
+	if (this->sendQueue.empty())
+	{
+		items.clear();
+		this->sendQueue.swap(items);
+		this->sendQueueBuffer.swap(buffer);
+	}
+#endif
+}
+
+void UdpSocketHandler::SetMulticastTtl(uint8_t ttl)
+{
+	MS_TRACE();
+
+	// NOTE: It sets IPV6_MULTICAST_HOPS in IPv6 sockets.
+	int err = uv_udp_set_multicast_ttl(this->uvHandle, static_cast<int>(ttl));
+
+	if (err != 0)
+		MS_THROW_ERROR("uv_udp_set_multicast_ttl() failed: %s", uv_strerror(err));
+}
+
+void UdpSocketHandler::SetMulticastInterface(const std::string& ip)
+{
+	MS_TRACE();
+
+	int err = uv_udp_set_multicast_interface(this->uvHandle, ip.c_str());
+
+	if (err != 0)
+		MS_THROW_ERROR("uv_udp_set_multicast_interface() failed: %s", uv_strerror(err));
+}
+
+bool UdpSocketHandler::FlushSendQueueIoUring(
+  std::vector<SendQueueItem>& items, std::vector<uint8_t>& buffer)
+{
+	MS_TRACE();
+
+#ifdef __linux__
+	static constexpr size_t ControlSize{ CMSG_SPACE(sizeof(uint16_t)) };
+
+	const size_t numItems = items.size();
+	const bool gsoEnabled = this->gsoEnabled && !IoUring::IsGsoDisabled();
+	// Index of the first item of each message.
+	std::vector<size_t> msgItems;
+
+	for (size_t i{ 0u }; i < numItems; i = GetGsoGroupEnd(items, i, gsoEnabled))
+	{
+		msgItems.push_back(i);
+	}
+
+	const size_t numMsgs = msgItems.size();
+	auto* batch          = new IoUring::SendBatch();
+
+	batch->buffer = std::move(buffer);
+	batch->addrs.resize(numMsgs);
+	batch->iovs.resize(numItems);
+	batch->msgs.resize(numMsgs);
+	batch->controls.resize(numMsgs * ControlSize);
+
+	for (size_t i{ 0u }; i < numItems; ++i)
+	{
+		auto& item = items[i];
+
+		batch->iovs[i].iov_base = batch->buffer.data() + item.offset;
+		batch->iovs[i].iov_len  = item.len;
+	}
+
+	for (size_t m{ 0u }; m < numMsgs; ++m)
+	{
+		const size_t i = msgItems[m];
+		const size_t j = m + 1 < numMsgs ? msgItems[m + 1] : numItems;
+		auto& msg      = batch->msgs[m];
+
+		batch->addrs[m] = items[i].addr;
+
+		msg.msg_name    = std::addressof(batch->addrs[m]);
+		msg.msg_namelen = getSockAddrLen(reinterpret_cast<struct sockaddr*>(msg.msg_name));
+		msg.msg_iov     = std::addressof(batch->iovs[i]);
+		msg.msg_iovlen  = j - i;
+
+		if (j - i > 1)
+		{
+			setGsoSegmentSize(msg, batch->controls.data() + (m * ControlSize), items[i].len);
+
+			batch->gso = true;
+		}
+	}
+
+	// No room in the submission ring, give the memory back.
+	if (!IoUring::Send(this->fd, batch))
+	{
+		buffer = std::move(batch->buffer);
+
+		delete batch;
+
+		return false;
+	}
+
+	UdpSocketHandler::sendBatches++;
+	UdpSocketHandler::sendBatchedDatagrams += numItems;
+
+	// NOTE: A later failure is just logged by IoUring.
+	for (auto& item : items)
+	{
+		this->sentBytes += item.len;
 	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+size_t UdpSocketHandler::GetGsoGroupEnd(
+  const std::vector<SendQueueItem>& items, size_t begin, bool gso)
+{
+	size_t end = begin + 1;
+
+#ifdef __linux__
+	if (!gso)
+		return end;
+
+	const size_t segSize = items[begin].len;
+
+	// clang-format off
+	while (
+		end < items.size() &&
+		end - begin < GsoMaxSegments &&
+		items[end - 1].len == segSize &&
+		items[end].len <= segSize &&
+		isSameSockAddr(items[begin].addr, items[end].addr)
+	)
+	// clang-format on
+	{
+		++end;
+	}
+#else
+	(void)items;
+	(void)gso;
+#endif
+
+	return end;
 }
 
 bool UdpSocketHandler::SetLocalAddress()
@@ -241,13 +941,41 @@ bool UdpSocketHandler::SetLocalAddress()
 	return true;
 }
 
+void UdpSocketHandler::SetBufferSizes()
+{
+	MS_TRACE();
+
+	int err;
+	int bufferSize;
+
+	if (Settings::configuration.udpRecvBufferSize > 0u)
+	{
+		bufferSize = static_cast<int>(Settings::configuration.udpRecvBufferSize);
+
+		err = uv_recv_buffer_size(reinterpret_cast<uv_handle_t*>(this->uvHandle), &bufferSize);
+
+		if (err != 0)
+			MS_WARN_TAG(info, "uv_recv_buffer_size() failed: %s", uv_strerror(err));
+	}
+
+	if (Settings::configuration.udpSendBufferSize > 0u)
+	{
+		bufferSize = static_cast<int>(Settings::configuration.udpSendBufferSize);
+
+		err = uv_send_buffer_size(reinterpret_cast<uv_handle_t*>(this->uvHandle), &bufferSize);
+
+		if (err != 0)
+			MS_WARN_TAG(info, "uv_send_buffer_size() failed: %s", uv_strerror(err));
+	}
+}
+
 inline void UdpSocketHandler::OnUvRecvAlloc(size_t /*suggestedSize*/, uv_buf_t* buf)
 {
 	MS_TRACE();
 
 	// Tell UV to write into the static buffer.
 	buf->base = reinterpret_cast<char*>(ReadBuffer);
-	// Give UV all the buffer space.
+	// Give UV all the buffer space so it can use recvmmsg() if available.
 	buf->len = ReadBufferSize;
 }
 
@@ -256,6 +984,21 @@ inline void UdpSocketHandler::OnUvRecv(
 {
 	MS_TRACE();
 
+	// libuv has finished delivering all the chunks read by recvmmsg() so the
+	// batch is done. It may also have been an empty read.
+	if ((flags & UV_UDP_MMSG_FREE) != 0u)
+	{
+		if (this->currentRecvBatchSize != 0u)
+		{
+			UdpSocketHandler::recvBatches++;
+			UdpSocketHandler::recvBatchedDatagrams += this->currentRecvBatchSize;
+
+			this->currentRecvBatchSize = 0u;
+		}
+
+		return;
+	}
+
 	// NOTE: Ignore if there is nothing to read or if it was an empty datagram.
 	if (nread == 0)
 		return;
@@ -274,6 +1017,21 @@ inline void UdpSocketHandler::OnUvRecv(
 		// Update received bytes.
 		this->recvBytes += nread;
 
+		// Stamp RTP packets parsed from it.
+		Metrics::MarkIngress();
+
+		// Datagram read as part of a recvmmsg() batch.
+		if ((flags & UV_UDP_MMSG_CHUNK) != 0u)
+		{
+			this->currentRecvBatchSize++;
+		}
+		// Datagram read with a single recvmsg() call.
+		else
+		{
+			UdpSocketHandler::recvBatches++;
+			UdpSocketHandler::recvBatchedDatagrams++;
+		}
+
 		// Notify the subclass.
 		UserOnUdpDatagramReceived(reinterpret_cast<uint8_t*>(buf->base), nread, addr);
 	}
@@ -284,24 +1042,51 @@ inline void UdpSocketHandler::OnUvRecv(
 	}
 }
 
-inline void UdpSocketHandler::OnUvSend(int status, UdpSocketHandler::onSendCallback* cb)
+inline void UdpSocketHandler::OnUvPrepare()
 {
 	MS_TRACE();
 
-	// NOTE: Do not delete cb here since it will be delete in onSend() above.
+	FlushSendQueue();
+}
 
-	if (status == 0)
-	{
-		if (cb)
-			(*cb)(true);
-	}
-	else
+inline void UdpSocketHandler::OnIoUringDatagramReceived(
+  const uint8_t* data, size_t len, const struct sockaddr* addr, const IoUring::RecvInfo& recvInfo)
+{
+	MS_TRACE();
+
+	// NOTE: Ignore if it was an empty datagram.
+	if (len == 0)
+		return;
+
+	// Update received bytes.
+	this->recvBytes += len;
+
+	// Stamp RTP packets parsed from it.
+	Metrics::MarkIngress();
+
+#ifdef __linux__
+	if (recvInfo.kernelTimeNs != 0u)
+		UdpSocketHandler::recvTimeMs = getMonotonicTimeMs(recvInfo.kernelTimeNs);
+#endif
+
+	if (recvInfo.tos >= 0)
+		UdpSocketHandler::recvEcn = static_cast<int8_t>(recvInfo.tos & 0x03);
+
+	// Notify the subclass.
+	UserOnUdpDatagramReceived(data, len, addr);
+
+	UdpSocketHandler::recvTimeMs = 0u;
+	UdpSocketHandler::recvEcn    = -1;
+}
+
+inline void UdpSocketHandler::OnUvSend(int status)
+{
+	MS_TRACE();
+
+	if (status != 0)
 	{
 #if MS_LOG_DEV_LEVEL == 3
 		MS_DEBUG_DEV("send error: %s", uv_strerror(status));
 #endif
-
-		if (cb)
-			(*cb)(false);
 	}
 }
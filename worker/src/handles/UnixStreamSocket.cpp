@@ -161,21 +161,70 @@ void UnixStreamSocket::Close()
 	}
 }
 
+void UnixStreamSocket::PauseReading()
+{
+	MS_TRACE_STD();
+
+	if (this->closed || this->role != UnixStreamSocket::Role::CONSUMER || this->readingPaused)
+		return;
+
+	int err = uv_read_stop(reinterpret_cast<uv_stream_t*>(this->uvHandle));
+
+	if (err != 0)
+		MS_ABORT("uv_read_stop() failed: %s", uv_strerror(err));
+
+	this->readingPaused = true;
+}
+
+void UnixStreamSocket::ResumeReading()
+{
+	MS_TRACE_STD();
+
+	if (this->closed || !this->readingPaused)
+		return;
+
+	this->readingPaused = false;
+
+	int err = uv_read_start(
+	  reinterpret_cast<uv_stream_t*>(this->uvHandle),
+	  static_cast<uv_alloc_cb>(onAlloc),
+	  static_cast<uv_read_cb>(onRead));
+
+	if (err != 0)
+		MS_ERROR_STD("uv_read_start() failed: %s", uv_strerror(err));
+}
+
 void UnixStreamSocket::Write(const uint8_t* data, size_t len)
 {
 	MS_TRACE_STD();
 
+	uv_buf_t buffer = uv_buf_init(reinterpret_cast<char*>(const_cast<uint8_t*>(data)), len);
+
+	Write(&buffer, 1);
+}
+
+void UnixStreamSocket::Write(const uv_buf_t* buffers, size_t numBuffers)
+{
+	MS_TRACE_STD();
+
 	if (this->closed)
 		return;
 
+	size_t len{ 0u };
+
+	for (size_t i{ 0u }; i < numBuffers; ++i)
+	{
+		len += buffers[i].len;
+	}
+
 	if (len == 0)
 		return;
 
 	// First try uv_try_write(). In case it can not directly send all the given data
 	// then build a uv_req_t and use uv_write().
 
-	uv_buf_t buffer = uv_buf_init(reinterpret_cast<char*>(const_cast<uint8_t*>(data)), len);
-	int written     = uv_try_write(reinterpret_cast<uv_stream_t*>(this->uvHandle), &buffer, 1);
+	int written = uv_try_write(
+	  reinterpret_cast<uv_stream_t*>(this->uvHandle), buffers, static_cast<unsigned int>(numBuffers));
 
 	// All the data was written. Done.
 	if (written == static_cast<int>(len))
@@ -201,9 +250,30 @@ void UnixStreamSocket::Write(const uint8_t* data, size_t len)
 	auto* writeData   = new UvWriteData(pendingLen);
 
 	writeData->req.data = static_cast<void*>(writeData);
-	std::memcpy(writeData->store, data + written, pendingLen);
 
-	buffer = uv_buf_init(reinterpret_cast<char*>(writeData->store), pendingLen);
+	// Copy the data not written yet (given buffers are not valid after return).
+	size_t skipLen{ static_cast<size_t>(written) };
+	size_t storeLen{ 0u };
+
+	for (size_t i{ 0u }; i < numBuffers; ++i)
+	{
+		const auto& buffer = buffers[i];
+
+		if (skipLen >= buffer.len)
+		{
+			skipLen -= buffer.len;
+
+			continue;
+		}
+
+		std::memcpy(writeData->store + storeLen, buffer.base + skipLen, buffer.len - skipLen);
+
+		storeLen += buffer.len - skipLen;
+
+		skipLen = 0u;
+	}
+
+	uv_buf_t buffer = uv_buf_init(reinterpret_cast<char*>(writeData->store), pendingLen);
 
 	int err = uv_write(
 	  &writeData->req,
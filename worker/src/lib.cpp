@@ -2,6 +2,7 @@
 // #define MS_LOG_DEV_LEVEL 3
 
 #include "common.hpp"
+#include "Allocator.hpp"
 #include "DepLibSRTP.hpp"
 #include "DepLibUV.hpp"
 #include "DepLibWebRTC.hpp"
@@ -9,15 +10,30 @@
 #include "DepUsrSCTP.hpp"
 #include "Logger.hpp"
 #include "MediaSoupErrors.hpp"
+#include "Metrics.hpp"
 #include "Settings.hpp"
+#include "ThreadPlacement.hpp"
 #include "Utils.hpp"
 #include "Worker.hpp"
 #include "Channel/ChannelNotifier.hpp"
 #include "Channel/ChannelSocket.hpp"
 #include "PayloadChannel/PayloadChannelNotifier.hpp"
 #include "PayloadChannel/PayloadChannelSocket.hpp"
+#include "RTC/DtlsHandshakePool.hpp"
 #include "RTC/DtlsTransport.hpp"
+#include "RTC/EgressScheduler.hpp"
+#include "RTC/ObjectPool.hpp"
+#include "RTC/JoinLatency.hpp"
+#include "RTC/KeyFrameRequestScheduler.hpp"
+#include "RTC/NativeSctpAssociation.hpp"
+#include "RTC/RtcpScheduler.hpp"
+#include "RTC/RtpProbationGenerator.hpp"
+#include "RTC/SctpAssociation.hpp"
+#include "RTC/SrtpDecryptPool.hpp"
+#include "RTC/SrtpEncryptPool.hpp"
 #include "RTC/SrtpSession.hpp"
+#include "handles/IoUring.hpp"
+#include "handles/TimerWheel.hpp"
 #include <uv.h>
 #include <absl/container/flat_hash_map.h>
 #include <cerrno>
@@ -48,6 +64,18 @@ extern "C" int mediasoup_worker_run(
 	// Initialize libuv stuff (we need it for the Channel).
 	DepLibUV::ClassInit();
 
+	// Startup time breakdown (in ms) sent with the 'running' notification.
+	json startupTimes = json::object();
+	const uint64_t startedAtNs = DepLibUV::GetHighResTimeNs();
+	uint64_t stepStartedAtNs   = startedAtNs;
+	auto endStep               = [&startupTimes, &stepStartedAtNs](const char* step)
+	{
+		const uint64_t nowNs = DepLibUV::GetHighResTimeNs();
+
+		startupTimes[step] = static_cast<double>(nowNs - stepStartedAtNs) / 1e6;
+		stepStartedAtNs    = nowNs;
+	};
+
 	// Channel socket. If Worker instance runs properly, this socket is closed by
 	// it in its destructor. Otherwise it's closed here by also letting libuv
 	// deallocate its UV handles.
@@ -156,15 +184,19 @@ extern "C" int mediasoup_worker_run(
 	Settings::PrintConfiguration();
 	DepLibUV::PrintVersion();
 
+	endStep("settings");
+
 	try
 	{
 		// Initialize static stuff.
+		// NOTE: usrsctp and libwebrtc are initialized on first use.
+		Allocator::ClassInit();
 		DepOpenSSL::ClassInit();
 		DepLibSRTP::ClassInit();
-		DepUsrSCTP::ClassInit();
-		DepLibWebRTC::ClassInit();
 		Utils::Crypto::ClassInit();
+		endStep("crypto");
 		RTC::DtlsTransport::ClassInit();
+		endStep("dtls");
 		RTC::SrtpSession::ClassInit();
 		Channel::ChannelNotifier::ClassInit(channel.get());
 		PayloadChannel::PayloadChannelNotifier::ClassInit(payloadChannel.get());
@@ -174,15 +206,53 @@ extern "C" int mediasoup_worker_run(
 		IgnoreSignals();
 #endif
 
+		// Pin this worker thread to the given CPU (useful when running several
+		// workers as threads of the same process) and set its scheduling. Do it
+		// before creating helper threads so they inherit the NUMA policy.
+		ThreadPlacement::ApplyToWorkerThread();
+
+		if (!Settings::configuration.logFile.empty())
+			Logger::ClassInitFileSink(Settings::configuration.logFile);
+
+		RTC::SrtpEncryptPool::ClassInit(Settings::configuration.srtpEncryptThreads);
+		RTC::SrtpDecryptPool::ClassInit(Settings::configuration.srtpDecryptThreads);
+		RTC::DtlsHandshakePool::ClassInit(Settings::configuration.dtlsHandshakeThreads);
+		Metrics::ClassInit();
+
+		if (Settings::configuration.packetIo != "libuv")
+			IoUring::ClassInit(Settings::configuration.packetIo == "io_uring_sqpoll");
+
+		if (Settings::configuration.forwardingLatency)
+			Metrics::EnableIngressTime();
+
+		endStep("threads");
+
+		startupTimes["total"] = static_cast<double>(DepLibUV::GetHighResTimeNs() - startedAtNs) / 1e6;
+
 		// Run the Worker.
-		Worker worker(channel.get(), payloadChannel.get());
+		Worker worker(channel.get(), payloadChannel.get(), startupTimes);
 
 		// Free static stuff.
+		Metrics::ClassDestroy();
+		RTC::EgressScheduler::ClassDestroy();
+		RTC::JoinLatency::ClassDestroy();
+		RTC::KeyFrameRequestScheduler::ClassDestroy();
+		RTC::NativeSctpAssociation::ClassDestroy();
+		RTC::RtcpScheduler::ClassDestroy();
+		RTC::RtpProbationGenerator::ClassDestroy();
+		RTC::SctpAssociation::ClassDestroy();
+		RTC::SrtpEncryptPool::ClassDestroy();
+		RTC::SrtpDecryptPool::ClassDestroy();
+		RTC::DtlsHandshakePool::ClassDestroy();
 		DepLibSRTP::ClassDestroy();
 		Utils::Crypto::ClassDestroy();
 		DepLibWebRTC::ClassDestroy();
 		RTC::DtlsTransport::ClassDestroy();
+		RTC::ObjectPool::ClassDestroy();
 		DepUsrSCTP::ClassDestroy();
+		TimerWheel::ClassDestroy();
+		IoUring::ClassDestroy();
+		Logger::ClassDestroy();
 		DepLibUV::ClassDestroy();
 
 #ifdef MS_EXECUTABLE
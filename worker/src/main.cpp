@@ -2,6 +2,7 @@
 // #define MS_LOG_DEV_LEVEL 3
 
 #include "MediaSoupErrors.hpp"
+#include "Zygote.hpp"
 #include "lib.hpp"
 #include <cstdlib> // std::_Exit(), std::genenv()
 #include <string>
@@ -23,6 +24,10 @@ int main(int argc, char* argv[])
 
 	std::string version = std::getenv("MEDIASOUP_VERSION");
 
+	// Zygote mode, workers are forked on request.
+	if (std::getenv("MEDIASOUP_ZYGOTE_SOCKET"))
+		std::_Exit(Zygote::Run(std::getenv("MEDIASOUP_ZYGOTE_SOCKET"), version));
+
 	auto statusCode = mediasoup_worker_run(
 	  argc,
 	  argv,
@@ -0,0 +1,32 @@
+#ifndef MS_TEST_ALLOCATION_COUNTER_HPP
+#define MS_TEST_ALLOCATION_COUNTER_HPP
+
+#include "common.hpp"
+
+/**
+ * Counts the heap allocations done by the current thread since its creation.
+ * The test binary replaces the global operator new to count them, so [perf]
+ * tests can assert that a hot path does no (or a bounded number of) heap
+ * allocations.
+ */
+class AllocationCounter
+{
+public:
+	static size_t GetTotalCount();
+
+public:
+	AllocationCounter() : startCount(GetTotalCount())
+	{
+	}
+
+public:
+	size_t GetCount() const
+	{
+		return GetTotalCount() - this->startCount;
+	}
+
+private:
+	size_t startCount{ 0u };
+};
+
+#endif
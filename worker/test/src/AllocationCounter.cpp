@@ -0,0 +1,41 @@
+#include "AllocationCounter.hpp"
+#include <cstdlib> // std::malloc(), std::free()
+#include <new>     // std::bad_alloc
+
+/* Static. */
+
+thread_local static size_t allocationCount{ 0u };
+
+/* Class methods. */
+
+size_t AllocationCounter::GetTotalCount()
+{
+	return allocationCount;
+}
+
+/*
+ * Replacements of the global allocation functions. The other ones (array and
+ * nothrow variants) call these by default.
+ */
+
+void* operator new(size_t size)
+{
+	++allocationCount;
+
+	auto* ptr = std::malloc(size != 0u ? size : 1u);
+
+	if (!ptr)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept
+{
+	std::free(ptr);
+}
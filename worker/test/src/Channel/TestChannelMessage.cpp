@@ -0,0 +1,84 @@
+#include "common.hpp"
+#include "Settings.hpp"
+#include "Channel/ChannelMessage.hpp"
+#include <catch2/catch.hpp>
+#include <nlohmann/json.hpp>
+
+using namespace Channel;
+using json = nlohmann::json;
+
+SCENARIO("ChannelMessage", "[channel]")
+{
+	// clang-format off
+	json jsonMessage =
+	{
+		{ "targetId", "a2b7c4f1" },
+		{ "event",    "score"    },
+		{ "data",
+			{
+				{ "score",         10                 },
+				{ "producerScore", -1                 },
+				{ "bitrate",       1234567890123u     },
+				{ "rtt",           12.5               },
+				{ "active",        true               },
+				{ "layers",        json::array({ 1, 2, 3 }) }
+			}
+		}
+	};
+	// clang-format on
+
+	SECTION("GetFormat() and GetFormatName() work")
+	{
+		ChannelMessage::Format format;
+
+		REQUIRE(ChannelMessage::GetFormat("json", format));
+		REQUIRE(format == ChannelMessage::Format::JSON);
+		REQUIRE(ChannelMessage::GetFormatName(format) == "json");
+
+		REQUIRE(ChannelMessage::GetFormat("msgpack", format));
+		REQUIRE(format == ChannelMessage::Format::MSGPACK);
+		REQUIRE(ChannelMessage::GetFormatName(format) == "msgpack");
+
+		REQUIRE(!ChannelMessage::GetFormat("flatbuffers", format));
+	}
+
+	SECTION("JSON messages are serialized and parsed")
+	{
+		Settings::configuration.channelMessageFormat = ChannelMessage::Format::JSON;
+
+		size_t len;
+		const auto* data = ChannelMessage::Serialize(jsonMessage, len);
+
+		REQUIRE(data[0] == '{');
+		REQUIRE(ChannelMessage::Parse(data, len) == jsonMessage);
+	}
+
+	SECTION("MessagePack messages are serialized and parsed")
+	{
+		Settings::configuration.channelMessageFormat = ChannelMessage::Format::MSGPACK;
+
+		size_t len;
+		const auto* data = ChannelMessage::Serialize(jsonMessage, len);
+
+		// fixmap with 3 entries.
+		REQUIRE(data[0] == 0x83);
+		REQUIRE(len < jsonMessage.dump().length());
+		REQUIRE(ChannelMessage::Parse(data, len) == jsonMessage);
+
+		// A JSON message is still accepted.
+		auto jsonString = jsonMessage.dump();
+
+		REQUIRE(
+		  ChannelMessage::Parse(reinterpret_cast<const uint8_t*>(jsonString.c_str()), jsonString.length()) ==
+		  jsonMessage);
+
+		Settings::configuration.channelMessageFormat = ChannelMessage::Format::JSON;
+	}
+
+	SECTION("invalid data throws")
+	{
+		uint8_t data[] = { 0x83, 0xa1 };
+
+		REQUIRE_THROWS_AS(ChannelMessage::Parse(data, sizeof(data)), json::parse_error);
+	}
+}
@@ -0,0 +1,94 @@
+#include "common.hpp"
+#include "Channel/ChannelMessage.hpp"
+#include "Channel/ChannelMessageWriter.hpp"
+#include <catch2/catch.hpp>
+#include <nlohmann/json.hpp>
+#include <string>
+
+using namespace Channel;
+using json = nlohmann::json;
+
+SCENARIO("ChannelMessageWriter", "[channel]")
+{
+	// clang-format off
+	json expected =
+	{
+		{ "id",       1234567890u             },
+		{ "accepted", true                    },
+		{ "data",
+			{
+				{ "name",    "quote \" backslash \\ newline \n tab \t bell \x07" },
+				{ "long",    std::string(300, 'x') },
+				{ "score",   -1                    },
+				{ "min",     -1234567890123        },
+				{ "bitrate", 1234567890123u        },
+				{ "rtt",     12.5                  },
+				{ "none",    nullptr               },
+				{ "layers",  json::array({ 1, 200, 70000 }) },
+				{ "empty",   json::object()        },
+				{ "stats",   { { "a", 1 }, { "b", json::array({ "c" }) } } }
+			}
+		}
+	};
+	// clang-format on
+
+	auto write = [](ChannelMessageWriter& writer)
+	{
+		writer.StartObject(3u);
+		writer.Key("id");
+		writer.UInt(1234567890u);
+		writer.Key("accepted");
+		writer.Bool(true);
+		writer.Key("data");
+		writer.StartObject(10u);
+		writer.Key("name");
+		writer.String("quote \" backslash \\ newline \n tab \t bell \x07");
+		writer.Key("long");
+		writer.String(std::string(300, 'x'));
+		writer.Key("score");
+		writer.Int(-1);
+		writer.Key("min");
+		writer.Int(-1234567890123);
+		writer.Key("bitrate");
+		writer.UInt(1234567890123u);
+		writer.Key("rtt");
+		writer.Double(12.5);
+		writer.Key("none");
+		writer.Null();
+		writer.Key("layers");
+		writer.StartArray(3u);
+		writer.UInt(1u);
+		writer.UInt(200u);
+		writer.UInt(70000u);
+		writer.EndArray();
+		writer.Key("empty");
+		writer.StartObject(0u);
+		writer.EndObject();
+		writer.Key("stats");
+		writer.Value({ { "a", 1 }, { "b", json::array({ "c" }) } });
+		writer.EndObject();
+		writer.EndObject();
+	};
+
+	SECTION("JSON output matches the json tree")
+	{
+		ChannelMessageWriter writer(ChannelMessage::Format::JSON);
+
+		write(writer);
+
+		auto parsed = json::parse(writer.GetData(), writer.GetData() + writer.GetLength());
+
+		REQUIRE(parsed == expected);
+	}
+
+	SECTION("MessagePack output matches the json tree")
+	{
+		ChannelMessageWriter writer(ChannelMessage::Format::MSGPACK);
+
+		write(writer);
+
+		auto parsed = json::from_msgpack(writer.GetData(), writer.GetData() + writer.GetLength());
+
+		REQUIRE(parsed == expected);
+	}
+}
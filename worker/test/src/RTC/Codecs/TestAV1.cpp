@@ -0,0 +1,162 @@
+#include "common.hpp"
+#include "RTC/Codecs/AV1.hpp"
+#include <catch2/catch.hpp>
+#include <memory> // std::unique_ptr
+
+using namespace RTC;
+
+SCENARIO("parse AV1 payload descriptor", "[codecs][av1]")
+{
+	// Aggregation header of the first packet of a key frame (N=1).
+	uint8_t keyFramePayload[] = { 0x08, 0x00 };
+	// Aggregation header of any other packet.
+	uint8_t deltaFramePayload[] = { 0x00, 0x00 };
+
+	// clang-format off
+	// Dependency descriptor (start and end of frame, template id 0, frame
+	// number 1) with template dependency structure (template id offset 0, 2
+	// decode targets, templates S0T0, S0T0 and S0T1).
+	uint8_t keyFrameDependencyDescriptor[] =
+	{
+		0xC0, 0x00, 0x01,
+		0x80, 0x01, 0x1C
+	};
+	// clang-format on
+
+	SECTION("parse key frame without dependency descriptor")
+	{
+		std::unique_ptr<Codecs::AV1::PayloadDescriptor> payloadDescriptor(
+		  Codecs::AV1::Parse(keyFramePayload, sizeof(keyFramePayload)));
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(payloadDescriptor->isKeyFrame == true);
+		REQUIRE(payloadDescriptor->hasDependencyDescriptor == false);
+		REQUIRE(payloadDescriptor->hasLayers == false);
+	}
+
+	SECTION("parse template dependency structure")
+	{
+		Codecs::AV1::TemplateStructure templateStructure;
+
+		REQUIRE(Codecs::AV1::ParseTemplateStructure(
+		  keyFrameDependencyDescriptor, sizeof(keyFrameDependencyDescriptor), &templateStructure));
+
+		REQUIRE(templateStructure.present == true);
+		REQUIRE(templateStructure.frameNumber == 1);
+		REQUIRE(templateStructure.templateIdOffset == 0);
+		REQUIRE(templateStructure.templateCount == 3);
+		REQUIRE(templateStructure.maxSpatialId == 0);
+		REQUIRE(templateStructure.maxTemporalId == 1);
+		REQUIRE(templateStructure.temporalIds[0] == 0);
+		REQUIRE(templateStructure.temporalIds[1] == 0);
+		REQUIRE(templateStructure.temporalIds[2] == 1);
+	}
+
+	SECTION("layers come from the cached template dependency structure")
+	{
+		Codecs::AV1::TemplateStructure templateStructure;
+
+		std::unique_ptr<Codecs::AV1::PayloadDescriptor> payloadDescriptor(Codecs::AV1::Parse(
+		  keyFramePayload,
+		  sizeof(keyFramePayload),
+		  keyFrameDependencyDescriptor,
+		  sizeof(keyFrameDependencyDescriptor),
+		  &templateStructure));
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(payloadDescriptor->isKeyFrame == true);
+		REQUIRE(payloadDescriptor->startOfFrame == 1);
+		REQUIRE(payloadDescriptor->endOfFrame == 1);
+		REQUIRE(payloadDescriptor->frameNumber == 1);
+		REQUIRE(payloadDescriptor->hasLayers == true);
+		REQUIRE(payloadDescriptor->spatialLayer == 0);
+		REQUIRE(payloadDescriptor->temporalLayer == 0);
+		REQUIRE(templateStructure.present == true);
+
+		// Frame number 2 using template id 2 (S0T1).
+		uint8_t dependencyDescriptor[] = { 0xC2, 0x00, 0x02 };
+
+		payloadDescriptor.reset(Codecs::AV1::Parse(
+		  deltaFramePayload,
+		  sizeof(deltaFramePayload),
+		  dependencyDescriptor,
+		  sizeof(dependencyDescriptor),
+		  &templateStructure));
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(payloadDescriptor->isKeyFrame == false);
+		REQUIRE(payloadDescriptor->frameNumber == 2);
+		REQUIRE(payloadDescriptor->hasLayers == true);
+		REQUIRE(payloadDescriptor->spatialLayer == 0);
+		REQUIRE(payloadDescriptor->temporalLayer == 1);
+
+		// Unknown template id.
+		dependencyDescriptor[0] = 0xC5;
+
+		payloadDescriptor.reset(Codecs::AV1::Parse(
+		  deltaFramePayload,
+		  sizeof(deltaFramePayload),
+		  dependencyDescriptor,
+		  sizeof(dependencyDescriptor),
+		  &templateStructure));
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(payloadDescriptor->hasLayers == false);
+	}
+
+	SECTION("packets without template dependency structure lack layers")
+	{
+		Codecs::AV1::TemplateStructure templateStructure;
+		uint8_t dependencyDescriptor[] = { 0xC2, 0x00, 0x02 };
+
+		std::unique_ptr<Codecs::AV1::PayloadDescriptor> payloadDescriptor(Codecs::AV1::Parse(
+		  deltaFramePayload,
+		  sizeof(deltaFramePayload),
+		  dependencyDescriptor,
+		  sizeof(dependencyDescriptor),
+		  &templateStructure));
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(payloadDescriptor->hasDependencyDescriptor == true);
+		REQUIRE(payloadDescriptor->hasLayers == false);
+	}
+
+	SECTION("drop temporal layers higher than the target one")
+	{
+		Codecs::AV1::TemplateStructure templateStructure;
+		RTC::Codecs::EncodingContext::Params params;
+
+		params.temporalLayers = 2;
+
+		Codecs::AV1::EncodingContext context(params);
+
+		context.SetTargetTemporalLayer(0);
+		context.SetCurrentTemporalLayer(0);
+
+		Codecs::AV1::PayloadDescriptorHandler keyFrameHandler(Codecs::AV1::Parse(
+		  keyFramePayload,
+		  sizeof(keyFramePayload),
+		  keyFrameDependencyDescriptor,
+		  sizeof(keyFrameDependencyDescriptor),
+		  &templateStructure));
+
+		uint8_t dependencyDescriptor[] = { 0xC2, 0x00, 0x02 };
+
+		Codecs::AV1::PayloadDescriptorHandler deltaFrameHandler(Codecs::AV1::Parse(
+		  deltaFramePayload,
+		  sizeof(deltaFramePayload),
+		  dependencyDescriptor,
+		  sizeof(dependencyDescriptor),
+		  &templateStructure));
+
+		bool marker{ false };
+
+		REQUIRE(keyFrameHandler.Process(&context, keyFramePayload, marker) == true);
+		REQUIRE(deltaFrameHandler.Process(&context, deltaFramePayload, marker) == false);
+
+		context.SetTargetTemporalLayer(1);
+
+		REQUIRE(deltaFrameHandler.Process(&context, deltaFramePayload, marker) == true);
+		REQUIRE(context.GetCurrentTemporalLayer() == 1);
+	}
+}
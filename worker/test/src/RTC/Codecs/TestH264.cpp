@@ -1,4 +1,5 @@
 #include "common.hpp"
+#include "Settings.hpp"
 #include "RTC/Codecs/H264.hpp"
 #include <catch2/catch.hpp>
 #include <cstring> // std::memcmp()
@@ -27,4 +28,43 @@ SCENARIO("parse H264 payload descriptor", "[codecs][h264]")
 
 		delete payloadDescriptor;
 	}
+	SECTION("trusted frame-marking skips payload inspection")
+	{
+		// clang-format off
+		uint8_t buffer[] =
+		{
+			0x07, 0x80, 0x11, 0x00 // SPS.
+		};
+		// clang-format on
+
+		// Start of a frame not flagged as independent.
+		RtpPacket::FrameMarking frameMarking{};
+
+		frameMarking.start = 1;
+
+		std::unique_ptr<Codecs::H264::PayloadDescriptor> payloadDescriptor(
+		  Codecs::H264::Parse(buffer, sizeof(buffer), &frameMarking, 1u));
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(payloadDescriptor->isKeyFrame);
+
+		Settings::configuration.trustFrameMarking = true;
+
+		payloadDescriptor.reset(Codecs::H264::Parse(buffer, sizeof(buffer), &frameMarking, 1u));
+
+		Settings::configuration.trustFrameMarking = false;
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(!payloadDescriptor->isKeyFrame);
+
+		// Without frame-marking the payload is always inspected.
+		Settings::configuration.trustFrameMarking = true;
+
+		payloadDescriptor.reset(Codecs::H264::Parse(buffer, sizeof(buffer)));
+
+		Settings::configuration.trustFrameMarking = false;
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(payloadDescriptor->isKeyFrame);
+	}
 }
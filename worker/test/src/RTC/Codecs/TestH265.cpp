@@ -0,0 +1,128 @@
+#include "common.hpp"
+#include "RTC/Codecs/H265.hpp"
+#include <catch2/catch.hpp>
+#include <memory> // std::unique_ptr
+
+using namespace RTC;
+
+SCENARIO("parse H265 payload descriptor", "[codecs][h265]")
+{
+	SECTION("single NAL unit packets")
+	{
+		// clang-format off
+		uint8_t idr[]   = { 0x26, 0x01, 0xAF, 0x00 }; // IDR_W_RADL, tid 0.
+		uint8_t trail[] = { 0x02, 0x03, 0xAF, 0x00 }; // TRAIL_R, tid 2.
+		uint8_t tsa[]   = { 0x06, 0x02, 0xAF, 0x00 }; // TSA_R, tid 1.
+		uint8_t bad[]   = { 0x02, 0x00, 0xAF, 0x00 }; // Forbidden TID 0.
+		// clang-format on
+
+		std::unique_ptr<Codecs::H265::PayloadDescriptor> payloadDescriptor(
+		  Codecs::H265::Parse(idr, sizeof(idr)));
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(payloadDescriptor->isKeyFrame);
+		REQUIRE(payloadDescriptor->hasTid);
+		REQUIRE(payloadDescriptor->tid == 0);
+		REQUIRE(payloadDescriptor->b == 1);
+
+		payloadDescriptor.reset(Codecs::H265::Parse(trail, sizeof(trail)));
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(!payloadDescriptor->isKeyFrame);
+		REQUIRE(payloadDescriptor->tid == 2);
+		REQUIRE(payloadDescriptor->b == 0);
+
+		payloadDescriptor.reset(Codecs::H265::Parse(tsa, sizeof(tsa)));
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(!payloadDescriptor->isKeyFrame);
+		REQUIRE(payloadDescriptor->tid == 1);
+		REQUIRE(payloadDescriptor->b == 1);
+
+		payloadDescriptor.reset(Codecs::H265::Parse(bad, sizeof(bad)));
+
+		REQUIRE(!payloadDescriptor);
+	}
+
+	SECTION("aggregation and fragmentation packets")
+	{
+		// clang-format off
+		uint8_t ap[] =
+		{
+			0x60, 0x01,             // AP, tid 0.
+			0x00, 0x02, 0x40, 0x01, // VPS.
+			0x00, 0x03, 0x26, 0x01, 0xAF // IDR_W_RADL.
+		};
+		uint8_t fuStart[]  = { 0x62, 0x01, 0x93, 0xAF }; // FU, start of IDR_W_RADL.
+		uint8_t fuMiddle[] = { 0x62, 0x01, 0x13, 0xAF }; // FU, middle of IDR_W_RADL.
+		// clang-format on
+
+		std::unique_ptr<Codecs::H265::PayloadDescriptor> payloadDescriptor(
+		  Codecs::H265::Parse(ap, sizeof(ap)));
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(payloadDescriptor->isKeyFrame);
+		REQUIRE(payloadDescriptor->nalUnitType == 19);
+
+		payloadDescriptor.reset(Codecs::H265::Parse(fuStart, sizeof(fuStart)));
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(payloadDescriptor->isKeyFrame);
+		REQUIRE(payloadDescriptor->nalUnitType == 19);
+
+		payloadDescriptor.reset(Codecs::H265::Parse(fuMiddle, sizeof(fuMiddle)));
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(!payloadDescriptor->isKeyFrame);
+
+		// Truncated AP.
+		ap[7] = 0x10;
+
+		payloadDescriptor.reset(Codecs::H265::Parse(ap, sizeof(ap)));
+
+		REQUIRE(payloadDescriptor);
+		REQUIRE(!payloadDescriptor->isKeyFrame);
+	}
+
+	SECTION("temporal layers are switched up at switching points")
+	{
+		// clang-format off
+		uint8_t base[]  = { 0x02, 0x01, 0xAF, 0x00 }; // TRAIL_R, tid 0.
+		uint8_t trail[] = { 0x02, 0x02, 0xAF, 0x00 }; // TRAIL_R, tid 1.
+		uint8_t tsa[]   = { 0x06, 0x02, 0xAF, 0x00 }; // TSA_R, tid 1.
+		uint8_t top[]   = { 0x06, 0x03, 0xAF, 0x00 }; // TSA_R, tid 2.
+		// clang-format on
+
+		Codecs::EncodingContext::Params params;
+
+		params.temporalLayers = 3;
+
+		Codecs::H265::EncodingContext context(params);
+		bool marker{ false };
+
+		context.SetTargetTemporalLayer(1);
+
+		auto process = [&context, &marker](uint8_t* data, size_t len)
+		{
+			Codecs::H265::PayloadDescriptorHandler handler(Codecs::H265::Parse(data, len));
+
+			return handler.Process(&context, data, marker);
+		};
+
+		REQUIRE(process(base, sizeof(base)));
+		REQUIRE(context.GetCurrentTemporalLayer() == 0);
+
+		// Not a switching point.
+		REQUIRE(!process(trail, sizeof(trail)));
+		REQUIRE(context.GetCurrentTemporalLayer() == 0);
+
+		REQUIRE(process(tsa, sizeof(tsa)));
+		REQUIRE(context.GetCurrentTemporalLayer() == 1);
+
+		REQUIRE(process(trail, sizeof(trail)));
+
+		// Above the target layer.
+		REQUIRE(!process(top, sizeof(top)));
+		REQUIRE(context.GetCurrentTemporalLayer() == 1);
+	}
+}
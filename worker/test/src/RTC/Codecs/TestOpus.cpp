@@ -0,0 +1,46 @@
+#include "common.hpp"
+#include "RTC/Codecs/Opus.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <catch2/catch.hpp>
+#include <memory> // std::unique_ptr
+
+using namespace RTC;
+
+SCENARIO("detect Opus DTX packets", "[codecs][opus]")
+{
+	SECTION("packet with just the TOC byte is DTX")
+	{
+		// clang-format off
+		uint8_t buffer[] =
+		{
+			0x80, 0x6f, 0x00, 0x01,
+			0x00, 0x00, 0x00, 0x05,
+			0x00, 0x00, 0x00, 0x01,
+			0xf8
+		};
+		// clang-format on
+
+		std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer, sizeof(buffer)));
+
+		REQUIRE(packet);
+		REQUIRE(Codecs::Opus::IsDtx(packet.get()));
+	}
+
+	SECTION("packet with audio frames is not DTX")
+	{
+		// clang-format off
+		uint8_t buffer[] =
+		{
+			0x80, 0x6f, 0x00, 0x01,
+			0x00, 0x00, 0x00, 0x05,
+			0x00, 0x00, 0x00, 0x01,
+			0xf8, 0xff, 0xfe, 0x01
+		};
+		// clang-format on
+
+		std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer, sizeof(buffer)));
+
+		REQUIRE(packet);
+		REQUIRE(!Codecs::Opus::IsDtx(packet.get()));
+	}
+}
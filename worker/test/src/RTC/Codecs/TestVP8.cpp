@@ -292,4 +292,160 @@ SCENARIO("process VP8 payload descriptor", "[codecs][vp8]")
 		REQUIRE(forwarded->pictureId == 1);
 		REQUIRE(forwarded->tl0PictureIndex == 1);
 	}
+	SECTION("ProcessPayload() and RestorePayload() behave as RtpPacket ones")
+	{
+		// clang-format off
+		uint8_t buffer1[] =
+		{
+			0x80, 0x60, 0x00, 0x01, // Header.
+			0x00, 0x00, 0x00, 0x01, // Timestamp.
+			0x00, 0x00, 0x00, 0x05, // SSRC.
+			0x90, 0xe0, 0x80, 0x05, // VP8 payload descriptor (pictureId 5).
+			0x03, 0x20, 0xaa, 0xbb  // TL0PICIDX 3, TID 0 and Y. Payload.
+		};
+		// clang-format on
+		uint8_t buffer2[sizeof(buffer1)];
+
+		std::memcpy(buffer2, buffer1, sizeof(buffer1));
+
+		std::unique_ptr<RtpPacket> packet1(RtpPacket::Parse(buffer1, sizeof(buffer1)));
+		std::unique_ptr<RtpPacket> packet2(RtpPacket::Parse(buffer2, sizeof(buffer2)));
+
+		REQUIRE(packet1);
+		REQUIRE(packet2);
+
+		Codecs::VP8::ProcessRtpPacket(packet1.get());
+		Codecs::VP8::ProcessRtpPacket(packet2.get());
+
+		RTC::Codecs::EncodingContext::Params params;
+		params.temporalLayers = 2;
+		Codecs::VP8::EncodingContext context1(params);
+		Codecs::VP8::EncodingContext context2(params);
+
+		context1.SetTargetTemporalLayer(1);
+		context2.SetTargetTemporalLayer(1);
+		context1.SyncRequired();
+		context2.SyncRequired();
+
+		bool marker1{ false };
+		bool marker2{ false };
+
+		REQUIRE(
+		  packet1->ProcessPayload(&context1, marker1) ==
+		  Codecs::VP8::ProcessPayload(packet2.get(), &context2, marker2));
+		REQUIRE(marker1 == marker2);
+		REQUIRE(context1.GetCurrentTemporalLayer() == context2.GetCurrentTemporalLayer());
+		REQUIRE(std::memcmp(buffer1, buffer2, sizeof(buffer1)) == 0);
+
+		packet1->RestorePayload();
+		Codecs::VP8::RestorePayload(packet2.get());
+
+		REQUIRE(std::memcmp(buffer1, buffer2, sizeof(buffer1)) == 0);
+	}
+
+	SECTION("ProcessRtpPacket() classifies the packet")
+	{
+		// clang-format off
+		uint8_t buffer[] =
+		{
+			0x80, 0x60, 0x00, 0x01, // Header.
+			0x00, 0x00, 0x00, 0x01, // Timestamp.
+			0x00, 0x00, 0x00, 0x05, // SSRC.
+			0x90, 0xe0, 0x80, 0x05, // VP8 payload descriptor (pictureId 5).
+			0x03, 0x60, 0xaa, 0xbb  // TL0PICIDX 3, TID 1 and Y. Key frame payload.
+		};
+		// clang-format on
+
+		std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer, sizeof(buffer)));
+
+		REQUIRE(packet);
+		REQUIRE(packet->GetTemporalLayer() == 0);
+		REQUIRE(!packet->IsKeyFrame());
+
+		Codecs::VP8::ProcessRtpPacket(packet.get());
+
+		REQUIRE(packet->GetSpatialLayer() == 0);
+		REQUIRE(packet->GetTemporalLayer() == 1);
+		REQUIRE(packet->IsKeyFrame());
+
+		packet->SetPayloadDescriptorHandler(nullptr);
+
+		REQUIRE(packet->GetTemporalLayer() == 0);
+		REQUIRE(!packet->IsKeyFrame());
+	}
+
+	SECTION("payload is just rewritten (and restored) if values change")
+	{
+		// clang-format off
+		uint8_t originalBuffer[] =
+		{
+			0x80, 0x60, 0x00, 0x01, // Header.
+			0x00, 0x00, 0x00, 0x01, // Timestamp.
+			0x00, 0x00, 0x00, 0x05, // SSRC.
+			0x90, 0xe0, 0x05, 0x03, // VP8 payload descriptor (one byte pictureId 5, TL0PICIDX 3).
+			0x20, 0xaa, 0xbb, 0x00  // TID 0 and Y. Payload.
+		};
+		// clang-format on
+		uint8_t buffer[sizeof(originalBuffer) + 1];
+
+		std::memcpy(buffer, originalBuffer, sizeof(originalBuffer));
+
+		std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer, sizeof(originalBuffer)));
+
+		REQUIRE(packet);
+
+		Codecs::VP8::ProcessRtpPacket(packet.get());
+
+		// pictureId was expanded to two bytes so TL0PICIDX moved one byte.
+		const auto* payloadDescriptorHandler = packet->GetPayloadDescriptorHandler();
+
+		REQUIRE(payloadDescriptorHandler);
+
+		auto* payload = packet->GetPayload();
+
+		REQUIRE(payload[2] == 0x80);
+		REQUIRE(payload[3] == 0x05);
+		REQUIRE(payload[4] == 0x03);
+
+		uint8_t processedPayload[8];
+
+		std::memcpy(processedPayload, payload, sizeof(processedPayload));
+
+		RTC::Codecs::EncodingContext::Params params;
+		params.temporalLayers = 2;
+		Codecs::VP8::EncodingContext context(params);
+		bool marker{ false };
+
+		context.SetTargetTemporalLayer(1);
+
+		// Values do not change since nothing was forwarded before.
+		REQUIRE(Codecs::VP8::ProcessPayload(packet.get(), &context, marker));
+		REQUIRE(std::memcmp(payload, processedPayload, sizeof(processedPayload)) == 0);
+
+		Codecs::VP8::RestorePayload(packet.get());
+
+		REQUIRE(std::memcmp(payload, processedPayload, sizeof(processedPayload)) == 0);
+
+		// Another context forwarding different values.
+		Codecs::VP8::EncodingContext context2(params);
+
+		uint16_t pictureId;
+		uint8_t tl0PictureIndex;
+
+		context2.SetTargetTemporalLayer(1);
+		// Forwarded pictureId 1000 and TL0PICIDX 100 from another stream.
+		context2.pictureIdManager.Input(1000, pictureId);
+		context2.tl0PictureIndexManager.Input(100, tl0PictureIndex);
+		context2.pictureIdManager.Sync(4);
+		context2.tl0PictureIndexManager.Sync(2);
+
+		REQUIRE(Codecs::VP8::ProcessPayload(packet.get(), &context2, marker));
+		REQUIRE(payload[2] == (0x80 | (1001 >> 8)));
+		REQUIRE(payload[3] == (1001 & 0xFF));
+		REQUIRE(payload[4] == 101);
+
+		Codecs::VP8::RestorePayload(packet.get());
+
+		REQUIRE(std::memcmp(payload, processedPayload, sizeof(processedPayload)) == 0);
+	}
 }
@@ -0,0 +1,108 @@
+#include "common.hpp"
+#include "RTC/Codecs/VP9.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+bool ProcessPacket(
+  Codecs::VP9::EncodingContext& context,
+  uint8_t pictureId,
+  uint8_t slIndex,
+  bool interPicturePredicted,
+  bool interLayerDependency)
+{
+	/** VP9 Payload Descriptor (non flexible mode)
+	 *
+	 * 1 = I bit: Picture ID present
+	 * P bit: Inter-picture predicted layer frame
+	 * 1 = L bit: Layer indices present
+	 * 0 = F bit: Flexible mode
+	 * 1 = B bit: Start of a layer frame
+	 * 1 = E bit: End of a layer frame
+	 * 0 = V bit: Scalability structure not present
+	 * 0 = Z bit: Not a reference for upper spatial layers
+	 * 0MMM MMMM = Picture Id (one byte)
+	 * TID:0 U:0 SID D = Layer indices
+	 * 0000 0000 = TL0PICIDX: 0
+	 */
+
+	// clang-format off
+	uint8_t buffer[] =
+	{
+		0xac, 0x00, 0x00, 0x00
+	};
+	// clang-format on
+
+	if (interPicturePredicted)
+		buffer[0] |= 0x40;
+
+	buffer[1] = pictureId & 0x7f;
+	buffer[2] = slIndex << 1;
+
+	if (interLayerDependency)
+		buffer[2] |= 0x01;
+
+	auto* payloadDescriptor = Codecs::VP9::Parse(buffer, sizeof(buffer));
+
+	REQUIRE(payloadDescriptor);
+
+	std::unique_ptr<Codecs::VP9::PayloadDescriptorHandler> payloadDescriptorHandler(
+	  new Codecs::VP9::PayloadDescriptorHandler(payloadDescriptor));
+	bool marker{ false };
+
+	return payloadDescriptorHandler->Process(&context, buffer, marker);
+}
+
+SCENARIO("process VP9 payload descriptor", "[codecs][vp9]")
+{
+	SECTION("upgrade spatial layer on a switch point without keyframe (K-SVC)")
+	{
+		RTC::Codecs::EncodingContext::Params params;
+		params.spatialLayers  = 2;
+		params.temporalLayers = 1;
+		params.ksvc           = true;
+		Codecs::VP9::EncodingContext context(params);
+
+		context.SetCurrentSpatialLayer(0);
+		context.SetCurrentTemporalLayer(0);
+		context.SetTargetSpatialLayer(1);
+		context.SetTargetTemporalLayer(0);
+
+		// Picture 1: upper layer frame predicted from previous upper layer frames.
+		REQUIRE(ProcessPacket(context, 1, 0, true, false));
+		REQUIRE_FALSE(ProcessPacket(context, 1, 1, true, false));
+		REQUIRE(context.GetCurrentSpatialLayer() == 0);
+
+		// Picture 2: upper layer frame just predicted from the lower layer one.
+		REQUIRE(ProcessPacket(context, 2, 0, true, false));
+		REQUIRE(ProcessPacket(context, 2, 1, false, true));
+		REQUIRE(context.GetCurrentSpatialLayer() == 1);
+
+		// Picture 3: lower layer is not needed anymore.
+		REQUIRE_FALSE(ProcessPacket(context, 3, 0, true, false));
+		REQUIRE(ProcessPacket(context, 3, 1, true, false));
+		REQUIRE(context.GetCurrentSpatialLayer() == 1);
+	}
+
+	SECTION("do not upgrade spatial layer more than one layer without keyframe")
+	{
+		RTC::Codecs::EncodingContext::Params params;
+		params.spatialLayers  = 3;
+		params.temporalLayers = 1;
+		Codecs::VP9::EncodingContext context(params);
+
+		context.SetCurrentSpatialLayer(0);
+		context.SetCurrentTemporalLayer(0);
+		context.SetTargetSpatialLayer(2);
+		context.SetTargetTemporalLayer(0);
+
+		REQUIRE(ProcessPacket(context, 1, 0, true, false));
+		REQUIRE_FALSE(ProcessPacket(context, 1, 2, false, true));
+		REQUIRE(context.GetCurrentSpatialLayer() == 0);
+
+		REQUIRE(ProcessPacket(context, 2, 0, true, false));
+		REQUIRE(ProcessPacket(context, 2, 1, false, true));
+		REQUIRE(ProcessPacket(context, 2, 2, false, true));
+		REQUIRE(context.GetCurrentSpatialLayer() == 2);
+	}
+}
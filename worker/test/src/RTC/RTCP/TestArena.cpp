@@ -0,0 +1,110 @@
+#include "common.hpp"
+#include "RTC/RTCP/Arena.hpp"
+#include "RTC/RTCP/Packet.hpp"
+#include "RTC/RTCP/ReceiverReport.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC::RTCP;
+
+SCENARIO("RTCP arena", "[rtcp][arena]")
+{
+	// clang-format off
+	uint8_t buffer[] =
+	{
+		0x81, 0xc9, 0x00, 0x07, // Type: 201 (Receiver Report), Count: 1, Length: 7
+		0x5d, 0x93, 0x15, 0x34, // Sender SSRC: 0x5d931534
+		// Receiver Report
+		0x01, 0x93, 0x2d, 0xb4, // SSRC. 0x01932db4
+		0x00, 0x00, 0x00, 0x01, // Fraction lost: 0, Total lost: 1
+		0x00, 0x00, 0x00, 0x00, // Extended highest sequence number: 0
+		0x00, 0x00, 0x00, 0x00, // Jitter: 0
+		0x00, 0x00, 0x00, 0x00, // Last SR: 0
+		0x00, 0x00, 0x00, 0x05  // DLSR: 0
+	};
+	// clang-format on
+
+	SECTION("parsed packets are allocated in the heap if no scope is open")
+	{
+		Packet* packet = Packet::Parse(buffer, sizeof(buffer));
+
+		REQUIRE(packet);
+		REQUIRE(!Arena::Contains(packet));
+		REQUIRE(Arena::GetUsedBytes() == 0);
+
+		delete packet;
+	}
+
+	SECTION("parsed packets are allocated in the arena and released with the scope")
+	{
+		{
+			Arena::Scope scope;
+
+			Packet* packet = Packet::Parse(buffer, sizeof(buffer));
+
+			REQUIRE(packet);
+			REQUIRE(Arena::Contains(packet));
+
+			auto* rr = static_cast<ReceiverReportPacket*>(packet);
+
+			REQUIRE(Arena::Contains(*rr->Begin()));
+			REQUIRE((*rr->Begin())->GetSsrc() == 0x01932db4);
+			REQUIRE(Arena::GetUsedBytes() >= sizeof(ReceiverReportPacket) + sizeof(ReceiverReport));
+
+			// Objects allocated outside the parsing go to the heap.
+			auto* report = new ReceiverReport();
+
+			REQUIRE(!Arena::Contains(report));
+
+			delete report;
+			delete packet;
+		}
+
+		REQUIRE(Arena::GetUsedBytes() == 0);
+	}
+
+	SECTION("nested scopes release only their own objects")
+	{
+		Arena::Scope scope;
+
+		Packet* packet = Packet::Parse(buffer, sizeof(buffer));
+		auto usedBytes = Arena::GetUsedBytes();
+
+		{
+			Arena::Scope nestedScope;
+			Arena::AllocationScope allocationScope;
+
+			auto* report = new ReceiverReport();
+
+			REQUIRE(Arena::Contains(report));
+			REQUIRE(Arena::GetUsedBytes() > usedBytes);
+
+			delete report;
+		}
+
+		REQUIRE(Arena::GetUsedBytes() == usedBytes);
+
+		delete packet;
+	}
+
+	SECTION("a scope does not inherit the allocation scope of the outer one")
+	{
+		Arena::Scope scope;
+		Arena::AllocationScope allocationScope;
+
+		{
+			Arena::Scope nestedScope;
+
+			auto* report = new ReceiverReport();
+
+			REQUIRE(!Arena::Contains(report));
+
+			delete report;
+		}
+
+		auto* report = new ReceiverReport();
+
+		REQUIRE(Arena::Contains(report));
+
+		delete report;
+	}
+}
@@ -81,4 +81,29 @@ SCENARIO("RTCP Feeback RTP ECN parsing", "[parser][rtcp][feedback-rtp][ecn]")
 
 		delete packet;
 	}
+
+	SECTION("create FeedbackRtpEcnPacket")
+	{
+		using namespace TestFeedbackRtpEcn;
+
+		FeedbackRtpEcnPacket packet(senderSsrc, mediaSsrc);
+		auto* item = new FeedbackRtpEcnItem(
+		  sequenceNumber,
+		  ect0Counter,
+		  ect1Counter,
+		  ecnCeCounter,
+		  notEctCounter,
+		  lostPackets,
+		  duplicatedPackets);
+
+		packet.AddItem(item);
+
+		verify(&packet);
+
+		uint8_t serialized[sizeof(buffer)] = { 0 };
+
+		packet.Serialize(serialized);
+
+		REQUIRE(std::memcmp(buffer, serialized, sizeof(buffer)) == 0);
+	}
 }
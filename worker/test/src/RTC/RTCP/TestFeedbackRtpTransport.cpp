@@ -453,6 +453,77 @@ SCENARIO("RTCP Feeback RTP transport", "[parser][rtcp][feedback-rtp][transport]"
 		delete packet;
 	}
 
+	SECTION("reset FeedbackRtpTransportPacket and read packet results of the parsed one")
+	{
+		/* clang-format off */
+		std::vector<TestFeedbackRtpTransportInput> inputs =
+		{
+			{ 999, 1000000000, RtcpMtu },  // Pre base.
+			{ 1000, 1000000000, RtcpMtu }, // Base.
+			{ 1001, 1000000100, RtcpMtu },
+			{ 1003, 1000000101, RtcpMtu },
+			{ 1004, 1000000102, RtcpMtu },
+			{ 1020, 1000000110, RtcpMtu },
+			{ 1021, 1000000111, RtcpMtu }
+		};
+		/* clang-format on */
+
+		auto* packet = new FeedbackRtpTransportPacket(senderSsrc, mediaSsrc);
+
+		// Fill it with other packets first and reset it.
+		packet->AddPacket(1, 1000000000, RtcpMtu);
+		packet->AddPacket(5, 1000000010, RtcpMtu);
+		packet->AddPacket(6, 1000000500, RtcpMtu);
+		packet->Finish();
+		packet->Reset();
+
+		REQUIRE(packet->GetPacketStatusCount() == 0);
+		REQUIRE(!packet->IsSerializable());
+
+		for (auto& input : inputs)
+			packet->AddPacket(input.sequenceNumber, input.timestamp, input.maxPacketSize);
+
+		packet->Finish();
+		validate(inputs, packet->GetPacketResults());
+
+		REQUIRE(packet->GetBaseSequenceNumber() == 1000);
+		REQUIRE(packet->GetPacketStatusCount() == 22);
+		REQUIRE(packet->GetReceivedStatusCount() == 6);
+
+		uint8_t buffer[1024];
+		auto len = packet->Serialize(buffer);
+
+		REQUIRE(packet->GetSize() == len);
+
+		auto* packet2 = FeedbackRtpTransportPacket::Parse(buffer, len);
+
+		REQUIRE(packet2);
+		REQUIRE(packet2->GetPacketStatusCount() == 22);
+		REQUIRE(packet2->GetReceivedStatusCount() == 6);
+		REQUIRE(packet2->GetPacketFractionLost() == packet->GetPacketFractionLost());
+
+		FeedbackRtpTransportPacket::PacketResultsReader reader(packet2);
+		FeedbackRtpTransportPacket::PacketResult packetResult;
+		auto packetResults = packet->GetPacketResults();
+		size_t idx{ 0u };
+
+		while (reader.Read(packetResult))
+		{
+			REQUIRE(idx < packetResults.size());
+			REQUIRE(packetResult.sequenceNumber == packetResults[idx].sequenceNumber);
+			REQUIRE(packetResult.received == packetResults[idx].received);
+			REQUIRE(packetResult.delta == packetResults[idx].delta);
+			REQUIRE(packetResult.receivedAtMs == packetResults[idx].receivedAtMs);
+
+			++idx;
+		}
+
+		REQUIRE(idx == 22);
+
+		delete packet2;
+		delete packet;
+	}
+
 	SECTION("parse FeedbackRtpTransportPacket, one bit vector chunk")
 	{
 		// clang-format off
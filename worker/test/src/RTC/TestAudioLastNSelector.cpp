@@ -0,0 +1,98 @@
+#include "common.hpp"
+#include "RTC/AudioLastNSelector.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <catch2/catch.hpp>
+#include <cstring> // std::memcpy()
+#include <memory>  // std::unique_ptr
+
+using namespace RTC;
+
+// Audio packet with the audio level extension (id 1) and the given value.
+static RtpPacket* createPacket(uint8_t* buffer, uint8_t audioLevel)
+{
+	// clang-format off
+	uint8_t data[] =
+	{
+		0x90, 0x6f, 0x00, 0x01,
+		0x00, 0x00, 0x00, 0x05,
+		0x00, 0x00, 0x00, 0x01,
+		0xbe, 0xde, 0x00, 0x01,
+		0x10, audioLevel, 0x00, 0x00,
+		0xf8, 0xff, 0xfe, 0x01
+	};
+	// clang-format on
+
+	std::memcpy(buffer, data, sizeof(data));
+
+	auto* packet = RtpPacket::Parse(buffer, sizeof(data));
+
+	packet->SetSsrcAudioLevelExtensionId(1);
+
+	return packet;
+}
+
+SCENARIO("AudioLastNSelector", "[rtp][audio]")
+{
+	uint8_t buffer1[64];
+	uint8_t buffer2[64];
+	uint8_t buffer3[64];
+
+	// Voice at -20 dBov, voice at -40 dBov and silence.
+	std::unique_ptr<RtpPacket> loudPacket(createPacket(buffer1, 0x80 | 20));
+	std::unique_ptr<RtpPacket> quietPacket(createPacket(buffer2, 0x80 | 40));
+	std::unique_ptr<RtpPacket> silentPacket(createPacket(buffer3, 127));
+
+	// Producers are just used as keys.
+	int producers[3];
+	const auto* producer1 = reinterpret_cast<const Producer*>(&producers[0]);
+	const auto* producer2 = reinterpret_cast<const Producer*>(&producers[1]);
+	const auto* producer3 = reinterpret_cast<const Producer*>(&producers[2]);
+
+	SECTION("speaking Producers are selected while there is room")
+	{
+		AudioLastNSelector selector(2);
+
+		REQUIRE(selector.ForwardRtpPacket(producer1, quietPacket.get()));
+		REQUIRE(!selector.ForwardRtpPacket(producer2, silentPacket.get()));
+		REQUIRE(selector.ForwardRtpPacket(producer2, loudPacket.get()));
+		REQUIRE(!selector.ForwardRtpPacket(producer3, loudPacket.get()));
+
+		// Selected Producers are forwarded even if silent.
+		REQUIRE(selector.ForwardRtpPacket(producer1, silentPacket.get()));
+	}
+
+	SECTION("Update() selects the loudest Producers")
+	{
+		AudioLastNSelector selector(1);
+
+		REQUIRE(selector.ForwardRtpPacket(producer1, quietPacket.get()));
+		REQUIRE(!selector.ForwardRtpPacket(producer2, loudPacket.get()));
+
+		selector.Update();
+
+		REQUIRE(!selector.ForwardRtpPacket(producer1, quietPacket.get()));
+		REQUIRE(selector.ForwardRtpPacket(producer2, loudPacket.get()));
+	}
+
+	SECTION("removing a selected Producer makes room for others")
+	{
+		AudioLastNSelector selector(1);
+
+		REQUIRE(selector.ForwardRtpPacket(producer1, quietPacket.get()));
+		REQUIRE(!selector.ForwardRtpPacket(producer2, loudPacket.get()));
+
+		selector.RemoveProducer(producer1);
+
+		REQUIRE(selector.ForwardRtpPacket(producer2, loudPacket.get()));
+	}
+
+	SECTION("packets without audio level are forwarded")
+	{
+		AudioLastNSelector selector(1);
+
+		loudPacket->SetSsrcAudioLevelExtensionId(0);
+
+		REQUIRE(selector.ForwardRtpPacket(producer1, quietPacket.get()));
+		REQUIRE(selector.ForwardRtpPacket(producer2, loudPacket.get()));
+	}
+}
@@ -0,0 +1,46 @@
+#include "common.hpp"
+#include "RTC/AudioMixer.hpp"
+#include <catch2/catch.hpp>
+#include <limits>
+
+using namespace RTC;
+
+SCENARIO("AudioMixer", "[rtc][audiomixer]")
+{
+	SECTION("samples are accumulated and clamped to 16 bits")
+	{
+		int32_t mix[AudioMixer::FrameSamples]{};
+		int16_t loud[AudioMixer::FrameSamples];
+		int16_t quiet[AudioMixer::FrameSamples];
+		int16_t samples[AudioMixer::FrameSamples];
+
+		for (size_t i{ 0u }; i < AudioMixer::FrameSamples; ++i)
+		{
+			loud[i]  = (i % 2u == 0u) ? 30000 : -30000;
+			quiet[i] = (i % 2u == 0u) ? 100 : -100;
+		}
+
+		AudioMixer::AccumulateFrame(mix, quiet, AudioMixer::FrameSamples);
+		AudioMixer::AccumulateFrame(mix, quiet, AudioMixer::FrameSamples);
+
+		REQUIRE(mix[0] == 200);
+		REQUIRE(mix[1] == -200);
+
+		AudioMixer::ClampFrame(mix, samples, AudioMixer::FrameSamples);
+
+		REQUIRE(samples[0] == 200);
+		REQUIRE(samples[1] == -200);
+
+		AudioMixer::AccumulateFrame(mix, loud, AudioMixer::FrameSamples);
+		AudioMixer::AccumulateFrame(mix, loud, AudioMixer::FrameSamples);
+
+		REQUIRE(mix[0] == 60200);
+		REQUIRE(mix[1] == -60200);
+
+		AudioMixer::ClampFrame(mix, samples, AudioMixer::FrameSamples);
+
+		REQUIRE(samples[0] == std::numeric_limits<int16_t>::max());
+		REQUIRE(samples[1] == std::numeric_limits<int16_t>::min());
+		REQUIRE(samples[AudioMixer::FrameSamples - 1] == std::numeric_limits<int16_t>::min());
+	}
+}
@@ -0,0 +1,75 @@
+#include "common.hpp"
+#include "DepLibUV.hpp"
+#include "RTC/BweCache.hpp"
+#include <catch2/catch.hpp>
+#include <cstring> // std::memset()
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h> // inet_pton()
+#else
+#include <arpa/inet.h>  // inet_pton()
+#include <netinet/in.h> // sockaddr_in, sockaddr_in6
+#endif
+
+using namespace RTC;
+
+SCENARIO("BweCache", "[bwe]")
+{
+	struct sockaddr_in addr1;
+	struct sockaddr_in addr2;
+	struct sockaddr_in6 addr3;
+	struct sockaddr_in6 addr4;
+
+	std::memset(&addr1, 0, sizeof(addr1));
+	std::memset(&addr2, 0, sizeof(addr2));
+	std::memset(&addr3, 0, sizeof(addr3));
+	std::memset(&addr4, 0, sizeof(addr4));
+
+	addr1.sin_family = AF_INET;
+	inet_pton(AF_INET, "1.2.3.4", &addr1.sin_addr);
+	addr2.sin_family = AF_INET;
+	inet_pton(AF_INET, "1.2.3.5", &addr2.sin_addr);
+	addr3.sin6_family = AF_INET6;
+	inet_pton(AF_INET6, "2001:db8:1:2::1", &addr3.sin6_addr);
+	addr4.sin6_family = AF_INET6;
+	inet_pton(AF_INET6, "2001:db8:1:2::2", &addr4.sin6_addr);
+
+	auto key1 = BweCache::GetKey(reinterpret_cast<const struct sockaddr*>(&addr1));
+	auto key2 = BweCache::GetKey(reinterpret_cast<const struct sockaddr*>(&addr2));
+	auto key3 = BweCache::GetKey(reinterpret_cast<const struct sockaddr*>(&addr3));
+	auto key4 = BweCache::GetKey(reinterpret_cast<const struct sockaddr*>(&addr4));
+
+	BweCache::Clear();
+
+	DepLibUV::SetVirtualTimeNs(1000000000u);
+
+	SECTION("IPv4 addresses and IPv6 /64 prefixes are the keys")
+	{
+		REQUIRE(key1 != key2);
+		REQUIRE(key3 == key4);
+
+		BweCache::Set(key1, 2000000u);
+		BweCache::Set(key3, 3000000u);
+
+		REQUIRE(BweCache::Get(key1) == 2000000u);
+		REQUIRE(BweCache::Get(key2) == 0u);
+		REQUIRE(BweCache::Get(key4) == 3000000u);
+	}
+
+	SECTION("estimates expire")
+	{
+		BweCache::Set(key1, 2000000u);
+
+		DepLibUV::SetVirtualTimeNs(1000000000u + (BweCache::MaxAgeMs * 1000000u));
+
+		REQUIRE(BweCache::Get(key1) == 2000000u);
+
+		DepLibUV::SetVirtualTimeNs(1000000000u + ((BweCache::MaxAgeMs + 1u) * 1000000u));
+
+		REQUIRE(BweCache::Get(key1) == 0u);
+		REQUIRE(BweCache::GetSize() == 0u);
+	}
+
+	DepLibUV::SetVirtualTimeNs(0u);
+	BweCache::Clear();
+}
@@ -0,0 +1,390 @@
+#include "common.hpp"
+#include "DepLibUV.hpp"
+#include "Settings.hpp"
+#include "RTC/RTCP/FeedbackRtpTransport.hpp"
+#include "RTC/TransportCongestionControlClient.hpp"
+#include <catch2/catch.hpp>
+#include <cstdio> // std::printf()
+#include <deque>
+#include <memory> // std::unique_ptr
+#include <random>
+
+using namespace RTC;
+
+namespace
+{
+	// Step of the virtual clock (in ms).
+	constexpr uint64_t TickMs{ 5u };
+	// Virtual time at which every scenario starts (in ms).
+	constexpr uint64_t StartMs{ 1000000u };
+	constexpr size_t PacketSize{ 1200u };
+	constexpr size_t MaxRtcpPacketLen{ 1200u };
+	// As TransportCongestionControlServer does.
+	constexpr uint64_t FeedbackIntervalMs{ 100u };
+	constexpr uint32_t InitialAvailableBitrate{ 600000u };
+	constexpr uint32_t MaxOutgoingBitrate{ 50000000u };
+	// The estimation is considered converged once it reaches this fraction of
+	// the link bitrate.
+	constexpr double ConvergenceFactor{ 0.8 };
+
+	struct LinkParams
+	{
+		uint32_t bitrate{ 0u };
+		uint32_t delayMs{ 0u };
+		uint32_t jitterMs{ 0u };
+		double lossRate{ 0 };
+	};
+
+	struct Scenario
+	{
+		const char* name;
+		LinkParams link;
+		uint64_t durationMs;
+	};
+
+	struct Result
+	{
+		// 0 if the estimation never converged.
+		uint64_t convergenceMs{ 0u };
+		// Received bitrate over the link bitrate during the second half of the
+		// scenario.
+		double utilisation{ 0 };
+		double avgQueueDelayMs{ 0 };
+		uint32_t availableBitrate{ 0u };
+	};
+
+	class TestTransportCongestionControlClientListener
+	  : public TransportCongestionControlClient::Listener
+	{
+	public:
+		void OnTransportCongestionControlClientBitrates(
+		  TransportCongestionControlClient* /*tccClient*/,
+		  TransportCongestionControlClient::Bitrates& /*bitrates*/) override
+		{
+		}
+
+		void OnTransportCongestionControlClientSendRtpPacket(
+		  TransportCongestionControlClient* /*tccClient*/,
+		  RtpPacket* /*packet*/,
+		  const webrtc::PacedPacketInfo& /*pacingInfo*/) override
+		{
+		}
+
+		RtpPacket* OnTransportCongestionControlClientGeneratePadding(
+		  TransportCongestionControlClient* /*tccClient*/, size_t /*size*/) override
+		{
+			return nullptr;
+		}
+	};
+
+	/**
+	 * One way link: packets are serialized at the link bitrate through a drop
+	 * tail queue, then delayed by the propagation delay plus a random jitter
+	 * (without reordering them) and randomly lost. The random generator has a
+	 * fixed seed so every run of a scenario gives the same results.
+	 */
+	class EmulatedLink
+	{
+	public:
+		// Packets that would wait longer in the queue are dropped (in us).
+		static constexpr uint64_t MaxQueueDelayUs{ 300000u };
+
+	public:
+		explicit EmulatedLink(const LinkParams& params) : params(params), random(1234u)
+		{
+		}
+
+	public:
+		// Whether the packet gets to the other side, and when (in us).
+		bool Send(size_t size, uint64_t nowUs, uint64_t& arrivalUs)
+		{
+			const uint64_t startUs      = std::max(nowUs, this->busyUntilUs);
+			const uint64_t queueDelayUs = startUs - nowUs;
+
+			if (queueDelayUs > MaxQueueDelayUs)
+				return false;
+
+			this->busyUntilUs = startUs + (size * 8u * 1000000u / this->params.bitrate);
+			this->numPackets++;
+			this->queueDelayUs += queueDelayUs;
+
+			if (Random() < this->params.lossRate)
+				return false;
+
+			arrivalUs = this->busyUntilUs + (this->params.delayMs * 1000u) +
+			            static_cast<uint64_t>(Random() * this->params.jitterMs * 1000u);
+			arrivalUs = std::max(arrivalUs, this->lastArrivalUs);
+
+			this->lastArrivalUs = arrivalUs;
+
+			return true;
+		}
+		double GetAvgQueueDelayMs() const
+		{
+			if (this->numPackets == 0u)
+				return 0;
+
+			return static_cast<double>(this->queueDelayUs) / this->numPackets / 1000;
+		}
+
+	private:
+		double Random()
+		{
+			// NOTE: std::mt19937 output is the same in every platform, unlike the
+			// one of the std distributions.
+			return static_cast<double>(this->random()) / std::mt19937::max();
+		}
+
+	private:
+		LinkParams params;
+		std::mt19937 random;
+		uint64_t busyUntilUs{ 0u };
+		uint64_t lastArrivalUs{ 0u };
+		uint64_t numPackets{ 0u };
+		uint64_t queueDelayUs{ 0u };
+	};
+
+	struct InFlightPacket
+	{
+		uint64_t arrivalUs;
+		uint16_t wideSeq;
+		size_t size;
+	};
+
+	struct PendingFeedback
+	{
+		uint64_t deliverAtMs;
+		std::unique_ptr<RTCP::FeedbackRtpTransportPacket> packet;
+	};
+
+	// Sends media at the bitrate estimated by a TransportCongestionControlClient
+	// through the emulated link and feeds it with the transport-cc feedback of
+	// the receiver, delayed by the same propagation delay.
+	Result runScenario(const Scenario& scenario, bool nativeBandwidthEstimator)
+	{
+		TestTransportCongestionControlClientListener listener;
+		EmulatedLink link(scenario.link);
+		std::deque<InFlightPacket> inFlightPackets;
+		std::deque<PendingFeedback> pendingFeedbacks;
+		std::unique_ptr<RTCP::FeedbackRtpTransportPacket> feedback;
+		uint16_t latestReceivedWideSeq{ 0u };
+		uint64_t latestReceivedAtMs{ 0u };
+		uint64_t receivedBytes{ 0u };
+		uint16_t wideSeq{ 0u };
+		double sendBudget{ 0 };
+		Result result;
+
+		const uint64_t endMs          = StartMs + scenario.durationMs;
+		const uint64_t measureSinceMs = StartMs + (scenario.durationMs / 2u);
+
+		auto newFeedback = [&]()
+		{
+			feedback = std::make_unique<RTCP::FeedbackRtpTransportPacket>(0u, 0u);
+
+			// The latest received packet is the pre base of the new feedback.
+			if (latestReceivedAtMs != 0u)
+				feedback->AddPacket(latestReceivedWideSeq, latestReceivedAtMs, MaxRtcpPacketLen);
+		};
+
+		auto sendFeedback = [&](uint64_t nowMs)
+		{
+			if (feedback->IsSerializable())
+			{
+				feedback->Finish();
+
+				pendingFeedbacks.push_back({ nowMs + scenario.link.delayMs, std::move(feedback) });
+			}
+
+			newFeedback();
+		};
+
+		DepLibUV::SetVirtualTimeNs(StartMs * 1000000u);
+
+		Settings::configuration.nativeBandwidthEstimator = nativeBandwidthEstimator;
+
+		TransportCongestionControlClient tccClient(
+		  &listener, BweType::TRANSPORT_CC, InitialAvailableBitrate, MaxOutgoingBitrate);
+
+		Settings::configuration.nativeBandwidthEstimator = false;
+
+		tccClient.TransportConnected();
+		// Media to send never limits the estimation.
+		tccClient.SetDesiredBitrate(scenario.link.bitrate * 2u, true);
+
+		newFeedback();
+
+		for (uint64_t nowMs{ StartMs }; nowMs < endMs; nowMs += TickMs)
+		{
+			const uint64_t nowUs = nowMs * 1000u;
+
+			DepLibUV::SetVirtualTimeNs(nowMs * 1000000u);
+
+			// Receiver.
+			while (!inFlightPackets.empty() && inFlightPackets.front().arrivalUs <= nowUs)
+			{
+				const auto& inFlightPacket = inFlightPackets.front();
+				const uint64_t arrivalMs   = inFlightPacket.arrivalUs / 1000u;
+
+				if (nowMs >= measureSinceMs)
+					receivedBytes += inFlightPacket.size;
+
+				auto addResult =
+				  feedback->AddPacket(inFlightPacket.wideSeq, arrivalMs, MaxRtcpPacketLen);
+
+				if (addResult == RTCP::FeedbackRtpTransportPacket::AddPacketResult::MAX_SIZE_EXCEEDED)
+				{
+					sendFeedback(nowMs);
+
+					feedback->AddPacket(inFlightPacket.wideSeq, arrivalMs, MaxRtcpPacketLen);
+				}
+				else if (feedback->IsFull())
+				{
+					sendFeedback(nowMs);
+				}
+
+				latestReceivedWideSeq = inFlightPacket.wideSeq;
+				latestReceivedAtMs    = arrivalMs;
+
+				inFlightPackets.pop_front();
+			}
+
+			if ((nowMs - StartMs) % FeedbackIntervalMs == 0u)
+				sendFeedback(nowMs);
+
+			// Sender.
+			while (!pendingFeedbacks.empty() && pendingFeedbacks.front().deliverAtMs <= nowMs)
+			{
+				tccClient.ReceiveRtcpTransportFeedback(pendingFeedbacks.front().packet.get());
+
+				pendingFeedbacks.pop_front();
+			}
+
+			const uint32_t availableBitrate = tccClient.GetAvailableBitrate();
+
+			if (
+			  result.convergenceMs == 0u &&
+			  availableBitrate >= scenario.link.bitrate * ConvergenceFactor)
+			{
+				result.convergenceMs = nowMs - StartMs;
+			}
+
+			sendBudget += static_cast<double>(availableBitrate) * TickMs / 8000;
+
+			while (sendBudget >= PacketSize)
+			{
+				webrtc::RtpPacketSendInfo packetInfo;
+				uint64_t arrivalUs;
+
+				sendBudget -= PacketSize;
+
+				packetInfo.transport_sequence_number = ++wideSeq;
+				packetInfo.length                    = PacketSize;
+				packetInfo.pacing_info               = tccClient.GetPacingInfo();
+
+				tccClient.InsertPacket(packetInfo);
+				tccClient.PacketSent(packetInfo, static_cast<int64_t>(nowMs));
+
+				if (link.Send(PacketSize, nowUs, arrivalUs))
+					inFlightPackets.push_back({ arrivalUs, wideSeq, PacketSize });
+			}
+		}
+
+		// Back to the real clock.
+		DepLibUV::SetVirtualTimeNs(0u);
+
+		const double linkBytes =
+		  static_cast<double>(scenario.link.bitrate) / 8 * (endMs - measureSinceMs) / 1000;
+
+		result.utilisation      = receivedBytes / linkBytes;
+		result.avgQueueDelayMs  = link.GetAvgQueueDelayMs();
+		result.availableBitrate = tccClient.GetAvailableBitrate();
+
+		std::printf(
+		  "%-24s %-6s convergence:%6" PRIu64 " ms, utilisation:%6.1f %%, queue delay:%6.1f ms,"
+		  " available bitrate:%9" PRIu32 " bps\n",
+		  scenario.name,
+		  nativeBandwidthEstimator ? "native" : "goog",
+		  result.convergenceMs,
+		  result.utilisation * 100,
+		  result.avgQueueDelayMs,
+		  result.availableBitrate);
+
+		return result;
+	}
+} // namespace
+
+// Evaluation of the congestion control over emulated links driven by a virtual
+// clock, so the results are deterministic and a scenario takes much less than
+// its duration. It reports the convergence time and link utilisation of every
+// scenario, so BWE tuning changes can be measured.
+SCENARIO("congestion control over emulated links", "[bwe][perf]")
+{
+	// clang-format off
+	const Scenario scenarios[] =
+	{
+		{ "2 Mbps, 20 ms",               { 2000000u, 20u, 0u,  0    }, 60000u },
+		{ "5 Mbps, 50 ms, 10 ms jitter", { 5000000u, 50u, 10u, 0    }, 60000u },
+		{ "2 Mbps, 30 ms, 2% loss",      { 2000000u, 30u, 0u,  0.02 }, 60000u }
+	};
+	// clang-format on
+
+	for (const bool nativeBandwidthEstimator : { false, true })
+	{
+		for (const auto& scenario : scenarios)
+		{
+			auto result = runScenario(scenario, nativeBandwidthEstimator);
+
+			// Never more than the link carries.
+			REQUIRE(result.utilisation <= 1.0);
+			REQUIRE(result.utilisation >= 0.3);
+
+			// The clean link must be estimated.
+			if (&scenario == &scenarios[0])
+				REQUIRE(result.convergenceMs != 0u);
+		}
+	}
+}
+
+SCENARIO("congestion control network path change", "[bwe]")
+{
+	for (const bool nativeBandwidthEstimator : { false, true })
+	{
+		TestTransportCongestionControlClientListener listener;
+
+		DepLibUV::SetVirtualTimeNs(StartMs * 1000000u);
+
+		Settings::configuration.nativeBandwidthEstimator = nativeBandwidthEstimator;
+
+		TransportCongestionControlClient tccClient(
+		  &listener, BweType::TRANSPORT_CC, InitialAvailableBitrate, MaxOutgoingBitrate);
+
+		Settings::configuration.nativeBandwidthEstimator = false;
+
+		tccClient.TransportConnected();
+		tccClient.SetDesiredBitrate(5000000u, true);
+
+		// Make the libwebrtc controller be created.
+		webrtc::RtpPacketSendInfo packetInfo;
+
+		packetInfo.transport_sequence_number = 1u;
+		packetInfo.length                    = PacketSize;
+		packetInfo.pacing_info               = tccClient.GetPacingInfo();
+
+		tccClient.InsertPacket(packetInfo);
+		tccClient.PacketSent(packetInfo, static_cast<int64_t>(StartMs));
+
+		// Last estimate of the new remote endpoint.
+		tccClient.PathChanged(2000000u);
+
+		REQUIRE(tccClient.GetAvailableBitrate() == 2000000u);
+		REQUIRE(tccClient.GetPacketLoss() == 0);
+
+		// Unknown new remote endpoint.
+		tccClient.PathChanged(0u);
+
+		REQUIRE(tccClient.GetAvailableBitrate() == InitialAvailableBitrate);
+
+		// Back to the real clock.
+		DepLibUV::SetVirtualTimeNs(0u);
+	}
+}
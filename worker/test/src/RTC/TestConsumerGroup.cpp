@@ -0,0 +1,43 @@
+#include "common.hpp"
+#include "RTC/ConsumerGroup.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+SCENARIO("ConsumerGroup", "[rtp][consumer]")
+{
+	SECTION("members get the same output for the same input")
+	{
+		ConsumerGroup group("simple:111");
+		uint16_t output1;
+		uint16_t output2;
+
+		REQUIRE(group.GetKey() == "simple:111");
+
+		REQUIRE(group.Input(1000u, output1));
+		REQUIRE(group.Input(1000u, output2));
+		REQUIRE(output1 == output2);
+
+		REQUIRE(group.Input(1001u, output2));
+		REQUIRE(output2 == static_cast<uint16_t>(output1 + 1u));
+	}
+
+	SECTION("dropped inputs are dropped once for all members")
+	{
+		ConsumerGroup group("simple:ignoreDtx:111");
+		uint16_t output1;
+		uint16_t output2;
+
+		REQUIRE(group.Input(1000u, output1));
+
+		// Every member drops it.
+		group.Drop(1001u);
+		group.Drop(1001u);
+
+		REQUIRE(group.Input(1002u, output2));
+		REQUIRE(output2 == static_cast<uint16_t>(output1 + 1u));
+
+		REQUIRE(group.Input(1002u, output2));
+		REQUIRE(output2 == static_cast<uint16_t>(output1 + 1u));
+	}
+}
@@ -0,0 +1,76 @@
+#include "common.hpp"
+#include "DepLibUV.hpp"
+#include "Settings.hpp"
+#include "RTC/EgressScheduler.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <catch2/catch.hpp>
+#include <memory> // std::unique_ptr
+
+using namespace RTC;
+
+class TestEgressSchedulerListener : public EgressScheduler::Listener
+{
+public:
+	void OnEgressSchedulerSendRtpPacket(
+	  Consumer* /*consumer*/,
+	  RtpPacket* /*packet*/,
+	  bool /*retransmission*/,
+	  uint64_t /*queuedAtNs*/) override
+	{
+		this->sentPackets++;
+	}
+
+public:
+	size_t sentPackets{ 0u };
+};
+
+SCENARIO("EgressScheduler", "[rtp][egressscheduler]")
+{
+	// 600 bytes RTP packet.
+	uint8_t buffer[600]{};
+
+	buffer[0] = 0b10000000;
+	buffer[1] = 0b01100100;
+
+	std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer, sizeof(buffer)));
+
+	REQUIRE(packet);
+
+	TestEgressSchedulerListener listener;
+
+	SECTION("packets are sent right away if disabled")
+	{
+		REQUIRE(!EgressScheduler::IsEnabled());
+		REQUIRE(EgressScheduler::TryConsume(1000000u, DepLibUV::GetTimeMs()));
+		REQUIRE(EgressScheduler::QueuePacket(&listener, nullptr, packet.get(), false) == false);
+		REQUIRE(EgressScheduler::GetQueueSize() == 0);
+	}
+
+	SECTION("packets exceeding the budget are queued")
+	{
+		// 400 kbps with a burst of 20 ms, so the budget is 1000 bytes.
+		Settings::configuration.egressBitrate = 400000u;
+		Settings::configuration.egressBurstMs = 20u;
+
+		REQUIRE(EgressScheduler::QueuePacket(&listener, nullptr, packet.get(), false) == false);
+		REQUIRE(EgressScheduler::QueuePacket(&listener, nullptr, packet.get(), false) == false);
+		REQUIRE(EgressScheduler::GetQueueSize() == 0);
+
+		// No budget left.
+		REQUIRE(EgressScheduler::QueuePacket(&listener, nullptr, packet.get(), false) == true);
+		REQUIRE(EgressScheduler::GetQueueSize() == 1);
+		REQUIRE(!EgressScheduler::TryConsume(100u, DepLibUV::GetTimeMs()));
+
+		// Packets are not sent before the queued ones.
+		REQUIRE(EgressScheduler::QueuePacket(&listener, nullptr, packet.get(), true) == true);
+		REQUIRE(EgressScheduler::GetQueueSize() == 2);
+		REQUIRE(listener.sentPackets == 0);
+
+		EgressScheduler::RemoveListener(&listener);
+
+		REQUIRE(EgressScheduler::GetQueueSize() == 0);
+
+		Settings::configuration.egressBitrate = 0u;
+		EgressScheduler::ClassDestroy();
+	}
+}
@@ -0,0 +1,100 @@
+#include "common.hpp"
+#include "Utils.hpp"
+#include "RTC/FlexFecGenerator.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <catch2/catch.hpp>
+#include <cstring> // std::memcpy()
+#include <memory>  // std::unique_ptr
+
+using namespace RTC;
+
+SCENARIO("FlexFecGenerator", "[rtp][fec]")
+{
+	// clang-format off
+	uint8_t buffer1[] =
+	{
+		0b10000000, 0b01100100, 0x00, 0x01,
+		0x00, 0x00, 0x00, 0x05,
+		0x00, 0x00, 0x00, 0x01,
+		0x11, 0x22, 0x33, 0x44, 0x55
+	};
+	uint8_t buffer2[] =
+	{
+		0b10000000, 0b11100100, 0x00, 0x02,
+		0x00, 0x00, 0x00, 0x05,
+		0x00, 0x00, 0x00, 0x01,
+		0xAA, 0xBB, 0xCC
+	};
+	// clang-format on
+
+	std::unique_ptr<RtpPacket> packet1(RtpPacket::Parse(buffer1, sizeof(buffer1)));
+	std::unique_ptr<RtpPacket> packet2(RtpPacket::Parse(buffer2, sizeof(buffer2)));
+
+	SECTION("no FEC is generated without loss")
+	{
+		FlexFecGenerator fecGenerator(110, 1234, 1);
+
+		fecGenerator.SetFractionLost(0);
+
+		REQUIRE(fecGenerator.GetGroupSize() == 0);
+		REQUIRE(fecGenerator.AddPacket(packet1.get()) == nullptr);
+		REQUIRE(fecGenerator.AddPacket(packet2.get()) == nullptr);
+	}
+
+	SECTION("a lost packet can be recovered from the FEC packet")
+	{
+		FlexFecGenerator fecGenerator(110, 1234, 1);
+
+		// 25% loss.
+		fecGenerator.SetFractionLost(64);
+
+		REQUIRE(fecGenerator.GetGroupSize() == 2);
+		REQUIRE(fecGenerator.AddPacket(packet1.get()) == nullptr);
+
+		auto* fecPacket = fecGenerator.AddPacket(packet2.get());
+
+		REQUIRE(fecPacket);
+		REQUIRE(fecPacket->GetSsrc() == 1234);
+		REQUIRE(fecPacket->GetPayloadType() == 110);
+
+		const uint8_t* fecHeader = fecPacket->GetPayload();
+
+		REQUIRE(fecPacket->GetPayloadLength() == FlexFecGenerator::HeaderSize + 5);
+		// R and F bits.
+		REQUIRE((fecHeader[0] & 0xC0) == 0);
+		// Protected SSRC.
+		REQUIRE(Utils::Byte::Get4Bytes(fecHeader, 12) == 1);
+		// SN base.
+		REQUIRE(Utils::Byte::Get2Bytes(fecHeader, 16) == 1);
+		// k bit and mask (packets 1 and 2).
+		REQUIRE(Utils::Byte::Get2Bytes(fecHeader, 18) == 0xE000);
+
+		// Recover packet 1 from the FEC packet and packet 2.
+		uint8_t recovered[5];
+
+		std::memcpy(recovered, fecHeader + FlexFecGenerator::HeaderSize, sizeof(recovered));
+
+		for (size_t i{ 0u }; i < 3; ++i)
+		{
+			recovered[i] ^= buffer2[12 + i];
+		}
+
+		// Marker and payload type.
+		REQUIRE((fecHeader[1] ^ buffer2[1]) == buffer1[1]);
+		// Length after the fixed header.
+		REQUIRE((Utils::Byte::Get2Bytes(fecHeader, 2) ^ 3) == 5);
+		REQUIRE(std::memcmp(recovered, buffer1 + 12, sizeof(recovered)) == 0);
+	}
+
+	SECTION("a marker bit closes the group")
+	{
+		FlexFecGenerator fecGenerator(110, 1234, 1);
+
+		// 2% loss.
+		fecGenerator.SetFractionLost(5);
+
+		REQUIRE(fecGenerator.GetGroupSize() == 10);
+		REQUIRE(fecGenerator.AddPacket(packet1.get()) == nullptr);
+		REQUIRE(fecGenerator.AddPacket(packet2.get()) != nullptr);
+	}
+}
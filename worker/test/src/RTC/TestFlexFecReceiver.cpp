@@ -0,0 +1,119 @@
+#include "common.hpp"
+#include "RTC/FlexFecGenerator.hpp"
+#include "RTC/FlexFecReceiver.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <catch2/catch.hpp>
+#include <cstring> // std::memcmp()
+#include <memory>  // std::unique_ptr
+
+using namespace RTC;
+
+SCENARIO("FlexFecReceiver", "[rtp][fec]")
+{
+	// clang-format off
+	uint8_t buffer1[] =
+	{
+		0b10000000, 0b01100100, 0x00, 0x01,
+		0x00, 0x00, 0x00, 0x05,
+		0x00, 0x00, 0x00, 0x01,
+		0x11, 0x22, 0x33, 0x44, 0x55
+	};
+	uint8_t buffer2[] =
+	{
+		0b10000000, 0b11100100, 0x00, 0x02,
+		0x00, 0x00, 0x00, 0x05,
+		0x00, 0x00, 0x00, 0x01,
+		0xAA, 0xBB, 0xCC
+	};
+	// clang-format on
+
+	std::unique_ptr<RtpPacket> packet1(RtpPacket::Parse(buffer1, sizeof(buffer1)));
+	std::unique_ptr<RtpPacket> packet2(RtpPacket::Parse(buffer2, sizeof(buffer2)));
+
+	FlexFecGenerator fecGenerator(110, 1234, 1);
+
+	// 25% loss.
+	fecGenerator.SetFractionLost(64);
+
+	REQUIRE(fecGenerator.AddPacket(packet1.get()) == nullptr);
+
+	auto* fecPacket = fecGenerator.AddPacket(packet2.get());
+
+	REQUIRE(fecPacket);
+
+	SECTION("a lost packet is recovered from the FEC packet")
+	{
+		FlexFecReceiver fecReceiver(110, 1234, 1);
+
+		REQUIRE(fecReceiver.AddPacket(packet2.get()));
+
+		auto* recoveredPacket = fecReceiver.ReceiveFecPacket(fecPacket);
+
+		REQUIRE(recoveredPacket);
+		REQUIRE(fecReceiver.IsRecoveredPacket(recoveredPacket));
+		REQUIRE(fecReceiver.GetRecoveredPackets() == 1);
+		REQUIRE(recoveredPacket->GetSsrc() == 1);
+		REQUIRE(recoveredPacket->GetSequenceNumber() == 1);
+		REQUIRE(recoveredPacket->GetTimestamp() == 5);
+		REQUIRE(recoveredPacket->GetPayloadType() == 100);
+		REQUIRE(!recoveredPacket->HasMarker());
+		REQUIRE(recoveredPacket->GetSize() == sizeof(buffer1));
+		REQUIRE(std::memcmp(recoveredPacket->GetData(), buffer1, sizeof(buffer1)) == 0);
+
+		// The original packet arriving late is a duplicate.
+		REQUIRE(!fecReceiver.AddPacket(packet1.get()));
+		REQUIRE(!fecReceiver.IsRecoveredPacket(packet1.get()));
+	}
+
+	SECTION("the last packet of the group is recovered")
+	{
+		FlexFecReceiver fecReceiver(110, 1234, 1);
+
+		REQUIRE(fecReceiver.AddPacket(packet1.get()));
+
+		auto* recoveredPacket = fecReceiver.ReceiveFecPacket(fecPacket);
+
+		REQUIRE(recoveredPacket);
+		REQUIRE(recoveredPacket->GetSequenceNumber() == 2);
+		REQUIRE(recoveredPacket->HasMarker());
+		REQUIRE(std::memcmp(recoveredPacket->GetData(), buffer2, sizeof(buffer2)) == 0);
+	}
+
+	SECTION("nothing is recovered if no packet is lost")
+	{
+		FlexFecReceiver fecReceiver(110, 1234, 1);
+
+		REQUIRE(fecReceiver.AddPacket(packet1.get()));
+		REQUIRE(fecReceiver.AddPacket(packet2.get()));
+		REQUIRE(fecReceiver.ReceiveFecPacket(fecPacket) == nullptr);
+		REQUIRE(fecReceiver.GetRecoveredPackets() == 0);
+	}
+
+	SECTION("nothing is recovered if more than a packet is lost")
+	{
+		FlexFecReceiver fecReceiver(110, 1234, 1);
+
+		// clang-format off
+		uint8_t buffer3[] =
+		{
+			0b10000000, 0b01100100, 0x00, 0x03,
+			0x00, 0x00, 0x00, 0x06,
+			0x00, 0x00, 0x00, 0x01,
+			0x01
+		};
+		// clang-format on
+
+		std::unique_ptr<RtpPacket> packet3(RtpPacket::Parse(buffer3, sizeof(buffer3)));
+
+		REQUIRE(fecReceiver.AddPacket(packet3.get()));
+		REQUIRE(fecReceiver.ReceiveFecPacket(fecPacket) == nullptr);
+	}
+
+	SECTION("FEC packets protecting another stream are ignored")
+	{
+		FlexFecReceiver fecReceiver(110, 1234, 2);
+
+		REQUIRE(fecReceiver.AddPacket(packet2.get()));
+		REQUIRE(fecReceiver.ReceiveFecPacket(fecPacket) == nullptr);
+	}
+}
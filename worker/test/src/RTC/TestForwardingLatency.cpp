@@ -0,0 +1,38 @@
+#include "common.hpp"
+#include "RTC/ForwardingLatency.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+SCENARIO("ForwardingLatency", "[forwardinglatency]")
+{
+	ForwardingLatency forwardingLatency;
+	json jsonObject = json::object();
+
+	SECTION("stages are recorded")
+	{
+		// Routed in 10, paced for 100 and sent in 5.
+		forwardingLatency.Record(1000u, 1010u, 1110u, 1115u);
+		// Not paced.
+		forwardingLatency.Record(2000u, 2010u, 2010u, 2015u);
+
+		forwardingLatency.FillJson(jsonObject);
+
+		REQUIRE(jsonObject["routing"]["count"] == 2u);
+		REQUIRE(jsonObject["routing"]["max"] == 10u);
+		REQUIRE(jsonObject["pacing"]["max"] == 100u);
+		REQUIRE(jsonObject["pacing"]["p50"] == 0u);
+		REQUIRE(jsonObject["send"]["max"] == 5u);
+		REQUIRE(jsonObject["total"]["max"] == 115u);
+		REQUIRE(jsonObject["total"].find("buckets") == jsonObject["total"].end());
+	}
+
+	SECTION("non monotonic times are ignored")
+	{
+		forwardingLatency.Record(1000u, 900u, 1100u, 1200u);
+
+		forwardingLatency.FillJson(jsonObject);
+
+		REQUIRE(jsonObject["total"]["count"] == 0u);
+	}
+}
@@ -0,0 +1,61 @@
+#include "common.hpp"
+#include "RTC/HandleTable.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+SCENARIO("HandleTable", "[rtc][handletable]")
+{
+	int object1{ 1 };
+	int object2{ 2 };
+
+	SECTION("added objects are found by their handle")
+	{
+		HandleTable<int> table;
+
+		auto handle1 = table.Add(&object1);
+		auto handle2 = table.Add(&object2);
+
+		REQUIRE(handle1 != 0u);
+		REQUIRE(handle2 != 0u);
+		REQUIRE(handle1 != handle2);
+		REQUIRE(table.Get(handle1) == &object1);
+		REQUIRE(table.Get(handle2) == &object2);
+		REQUIRE(table.Get(0u) == nullptr);
+		REQUIRE(table.Get(handle2 + 1u) == nullptr);
+	}
+
+	SECTION("the handle of a removed object does not address the next one in its slot")
+	{
+		HandleTable<int> table;
+
+		auto handle1 = table.Add(&object1);
+
+		table.Remove(handle1);
+
+		REQUIRE(table.Get(handle1) == nullptr);
+
+		auto handle2 = table.Add(&object2);
+
+		REQUIRE((handle2 & HandleTable<int>::IndexMask) == (handle1 & HandleTable<int>::IndexMask));
+		REQUIRE(handle2 != handle1);
+		REQUIRE(table.Get(handle1) == nullptr);
+		REQUIRE(table.Get(handle2) == &object2);
+
+		// Removing with a stale handle does nothing.
+		table.Remove(handle1);
+
+		REQUIRE(table.Get(handle2) == &object2);
+	}
+
+	SECTION("Clear() invalidates all handles")
+	{
+		HandleTable<int> table;
+
+		auto handle1 = table.Add(&object1);
+
+		table.Clear();
+
+		REQUIRE(table.Get(handle1) == nullptr);
+	}
+}
@@ -0,0 +1,61 @@
+#include "common.hpp"
+#include "RTC/IngressPolicer.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+SCENARIO("IngressPolicer", "[rtc][ingresspolicer]")
+{
+	SECTION("token bucket allows its burst and refills over time")
+	{
+		// 1000 tokens per second with a burst of 100 ms.
+		IngressPolicer::TokenBucket bucket(1000u, 100u);
+
+		REQUIRE(bucket.TryConsume(60u, 1000u));
+		REQUIRE(bucket.TryConsume(40u, 1000u));
+		REQUIRE(!bucket.TryConsume(1u, 1000u));
+
+		// 10 ms refill 10 tokens.
+		REQUIRE(!bucket.TryConsume(11u, 1010u));
+		REQUIRE(bucket.TryConsume(10u, 1010u));
+
+		// Never more than the burst.
+		REQUIRE(!bucket.TryConsume(101u, 5000u));
+		REQUIRE(bucket.TryConsume(100u, 5000u));
+	}
+
+	SECTION("zero rate token bucket is unlimited")
+	{
+		IngressPolicer::TokenBucket bucket;
+
+		REQUIRE(bucket.TryConsume(1000000u, 0u));
+		REQUIRE(bucket.TryConsume(1000000u, 0u));
+	}
+
+	SECTION("packets over the transport bitrate are dropped and counted")
+	{
+		IngressPolicer policer;
+		json jsonObject;
+
+		// Unlimited by default.
+		REQUIRE(policer.Police(nullptr, 100000u, 1000u));
+
+		// 80000 bps (10000 bytes per second) with a burst of 100 ms.
+		policer.Configure(80000u, 0u, 100u);
+
+		REQUIRE(policer.Police(nullptr, 600u, 1000u));
+		REQUIRE(policer.Police(nullptr, 400u, 1000u));
+		REQUIRE(!policer.Police(nullptr, 200u, 1000u));
+		REQUIRE(policer.Police(nullptr, 200u, 1020u));
+
+		policer.Drop(IngressPolicer::DropReason::UNKNOWN_TUPLE, 50u);
+		policer.FillJson(jsonObject);
+
+		REQUIRE(jsonObject["transportBitrate"]["packets"] == 1u);
+		REQUIRE(jsonObject["transportBitrate"]["bytes"] == 200u);
+		REQUIRE(jsonObject["tupleBitrate"]["packets"] == 0u);
+		REQUIRE(jsonObject["unknownTuple"]["packets"] == 1u);
+		REQUIRE(jsonObject["unknownTuple"]["bytes"] == 50u);
+		REQUIRE(jsonObject["stunRate"]["packets"] == 0u);
+	}
+}
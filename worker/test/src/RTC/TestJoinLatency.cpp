@@ -0,0 +1,38 @@
+#include "common.hpp"
+#include "RTC/JoinLatency.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+SCENARIO("JoinLatency", "[joinlatency]")
+{
+	JoinLatency::ClassDestroy();
+
+	json jsonObject = json::object();
+
+	SECTION("phases are recorded in their histograms")
+	{
+		JoinLatency::Record(JoinLatency::Phase::ICE_BINDING, 40u);
+		JoinLatency::Record(JoinLatency::Phase::DTLS_CONNECT, 120u);
+		JoinLatency::Record(JoinLatency::Phase::DTLS_CONNECT, 80u);
+
+		JoinLatency::FillJson(jsonObject);
+
+		REQUIRE(jsonObject["iceBinding"]["count"] == 1u);
+		REQUIRE(jsonObject["iceBinding"]["max"] == 40u);
+		REQUIRE(jsonObject["iceConnect"]["count"] == 0u);
+		REQUIRE(jsonObject["dtlsConnect"]["count"] == 2u);
+		REQUIRE(jsonObject["dtlsConnect"]["max"] == 120u);
+		REQUIRE(jsonObject["consumerFirstKeyFrame"]["count"] == 0u);
+		REQUIRE(jsonObject["dtlsConnect"].find("buckets") == jsonObject["dtlsConnect"].end());
+	}
+
+	SECTION("all phases are reported before any is recorded")
+	{
+		JoinLatency::FillJson(jsonObject);
+
+		REQUIRE(jsonObject.size() == static_cast<size_t>(JoinLatency::Phase::MAX));
+	}
+
+	JoinLatency::ClassDestroy();
+}
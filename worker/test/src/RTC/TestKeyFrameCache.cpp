@@ -0,0 +1,172 @@
+#include "common.hpp"
+#include "RTC/Codecs/VP8.hpp"
+#include "RTC/KeyFrameCache.hpp"
+#include "RTC/RtpDictionaries.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <catch2/catch.hpp>
+#include <cstring> // std::memcpy()
+#include <memory> // std::unique_ptr
+#include <vector>
+
+using namespace RTC;
+
+SCENARIO("KeyFrameCache", "[rtp][keyframe]")
+{
+	RtpCodecMimeType mimeType;
+
+	mimeType.SetMimeType("video/VP8");
+
+	// Buffers of the created VP8 packets.
+	std::vector<std::unique_ptr<uint8_t[]>> buffers;
+
+	auto createPacket = [&](uint16_t seq, uint32_t timestamp, bool keyFrame) -> RtpPacket*
+	{
+		// clang-format off
+		uint8_t rtpBuffer[] =
+		{
+			0b10000000, 0b01100100, 0, 0,
+			0, 0, 0, 0,
+			0, 0, 0, 1,
+			// VP8 payload descriptor (start of partition 0).
+			0x90, 0x00,
+			// VP8 payload header (P bit).
+			0x01, 0x00
+		};
+		// clang-format on
+
+		if (keyFrame)
+			rtpBuffer[14] = 0x00;
+
+		buffers.emplace_back(new uint8_t[sizeof(rtpBuffer)]);
+
+		auto* buffer = buffers.back().get();
+
+		std::memcpy(buffer, rtpBuffer, sizeof(rtpBuffer));
+
+		auto* packet = RtpPacket::Parse(buffer, sizeof(rtpBuffer));
+
+		packet->SetSequenceNumber(seq);
+		packet->SetTimestamp(timestamp);
+
+		Codecs::VP8::ProcessRtpPacket(packet);
+
+		return packet;
+	};
+
+	auto receivePackets = [&](KeyFrameCache& keyFrameCache, const std::vector<RtpPacket*>& packets)
+	{
+		for (auto* packet : packets)
+		{
+			keyFrameCache.ReceivePacket(packet);
+
+			delete packet;
+		}
+	};
+
+	SECTION("packets before the first key frame are not cached")
+	{
+		KeyFrameCache keyFrameCache(mimeType);
+
+		receivePackets(keyFrameCache, { createPacket(1, 1000, false), createPacket(2, 2000, false) });
+
+		REQUIRE(keyFrameCache.GetPackets().empty());
+	}
+
+	SECTION("key frame and following packets are cached")
+	{
+		KeyFrameCache keyFrameCache(mimeType);
+
+		receivePackets(
+		  keyFrameCache,
+		  { createPacket(1, 1000, false),
+		    createPacket(2, 2000, true),
+		    createPacket(3, 2000, false),
+		    createPacket(4, 3000, false) });
+
+		auto& packets = keyFrameCache.GetPackets();
+
+		REQUIRE(packets.size() == 3);
+		REQUIRE(packets[0]->GetSequenceNumber() == 2);
+		REQUIRE(packets[0]->IsKeyFrame());
+		REQUIRE(packets[1]->GetSequenceNumber() == 3);
+		REQUIRE(packets[2]->GetSequenceNumber() == 4);
+		REQUIRE(packets[2]->GetTimestamp() == 3000);
+	}
+
+	SECTION("new key frame replaces cached packets")
+	{
+		KeyFrameCache keyFrameCache(mimeType);
+
+		receivePackets(
+		  keyFrameCache,
+		  { createPacket(1, 1000, true),
+		    createPacket(2, 2000, false),
+		    createPacket(3, 3000, true),
+		    createPacket(4, 4000, false) });
+
+		auto& packets = keyFrameCache.GetPackets();
+
+		REQUIRE(packets.size() == 2);
+		REQUIRE(packets[0]->GetSequenceNumber() == 3);
+		REQUIRE(packets[1]->GetSequenceNumber() == 4);
+	}
+
+	SECTION("packets older than the key frame are ignored")
+	{
+		KeyFrameCache keyFrameCache(mimeType);
+
+		receivePackets(
+		  keyFrameCache,
+		  { createPacket(10, 2000, true),
+		    createPacket(9, 1000, false),
+		    createPacket(11, 3000, false) });
+
+		auto& packets = keyFrameCache.GetPackets();
+
+		REQUIRE(packets.size() == 2);
+		REQUIRE(packets[0]->GetSequenceNumber() == 10);
+		REQUIRE(packets[1]->GetSequenceNumber() == 11);
+	}
+
+	SECTION("cache is unusable until next key frame once full")
+	{
+		KeyFrameCache keyFrameCache(mimeType);
+		uint16_t seq{ 1u };
+
+		receivePackets(keyFrameCache, { createPacket(seq++, 1000, true) });
+
+		for (size_t i{ 1u }; i <= KeyFrameCache::MaxPackets; ++i)
+		{
+			auto* packet = createPacket(seq++, 1000 + i, false);
+
+			keyFrameCache.ReceivePacket(packet);
+
+			delete packet;
+		}
+
+		REQUIRE(keyFrameCache.GetPackets().empty());
+
+		// A retransmitted packet of the overflowed key frame does not start a new
+		// one.
+		receivePackets(keyFrameCache, { createPacket(1, 1000, true) });
+
+		REQUIRE(keyFrameCache.GetPackets().empty());
+
+		receivePackets(keyFrameCache, { createPacket(seq++, 9000, true) });
+
+		REQUIRE(keyFrameCache.GetPackets().size() == 1);
+	}
+
+	SECTION("Clear() empties the cache")
+	{
+		KeyFrameCache keyFrameCache(mimeType);
+
+		receivePackets(keyFrameCache, { createPacket(1, 1000, true), createPacket(2, 2000, false) });
+
+		REQUIRE(keyFrameCache.GetPackets().size() == 2);
+
+		keyFrameCache.Clear();
+
+		REQUIRE(keyFrameCache.GetPackets().empty());
+	}
+}
@@ -0,0 +1,141 @@
+#include "common.hpp"
+#include "DepLibUV.hpp"
+#include "RTC/KeyFrameRequestManager.hpp"
+#include "RTC/KeyFrameRequestScheduler.hpp"
+#include <catch2/catch.hpp>
+#include <vector>
+
+using namespace RTC;
+
+SCENARIO("KeyFrameRequestScheduler", "[rtp][keyframe]")
+{
+	class TestKeyFrameRequestSchedulerListener : public KeyFrameRequestScheduler::Listener
+	{
+	public:
+		void OnKeyFrameRequestSchedulerRequest(uint32_t ssrc) override
+		{
+			this->requestedSsrcs.push_back(ssrc);
+		}
+
+	public:
+		std::vector<uint32_t> requestedSsrcs;
+	};
+
+	class TestKeyFrameRequestManagerListener : public KeyFrameRequestManager::Listener
+	{
+	public:
+		void OnKeyFrameNeeded(
+		  KeyFrameRequestManager* /*keyFrameRequestManager*/, uint32_t ssrc) override
+		{
+			this->requestedSsrcs.push_back(ssrc);
+		}
+
+	public:
+		std::vector<uint32_t> requestedSsrcs;
+	};
+
+	SECTION("requests over the budget are queued once and spread over time")
+	{
+		TestKeyFrameRequestSchedulerListener listener;
+		// 4 requests per second allow a burst of 1 request.
+		KeyFrameRequestScheduler::Budget budget(4u, nullptr);
+
+		for (uint32_t ssrc{ 1u }; ssrc <= 4u; ++ssrc)
+		{
+			KeyFrameRequestScheduler::Schedule(&budget, &listener, ssrc);
+		}
+
+		// Already queued.
+		KeyFrameRequestScheduler::Schedule(&budget, &listener, 2u);
+
+		REQUIRE(listener.requestedSsrcs == std::vector<uint32_t>{ 1u });
+		REQUIRE(KeyFrameRequestScheduler::GetNumScheduled() == 3u);
+		REQUIRE(KeyFrameRequestScheduler::IsScheduled(&listener, 2u));
+
+		const uint64_t startMs = DepLibUV::GetTimeMs();
+
+		// Must run the loop here to consume the timer before doing the check.
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener.requestedSsrcs == std::vector<uint32_t>{ 1u, 2u, 3u, 4u });
+		REQUIRE(KeyFrameRequestScheduler::GetNumScheduled() == 0u);
+		// 3 requests at 4 per second.
+		REQUIRE(DepLibUV::GetTimeMs() - startMs >= 700u);
+	}
+
+	SECTION("requests within the budget of a Transport consume the budget of the Router")
+	{
+		TestKeyFrameRequestSchedulerListener listener1;
+		TestKeyFrameRequestSchedulerListener listener2;
+		KeyFrameRequestScheduler::Budget routerBudget(4u, nullptr);
+		// No limit for the Transports but the one of the Router.
+		KeyFrameRequestScheduler::Budget transportBudget1(0u, &routerBudget);
+		KeyFrameRequestScheduler::Budget transportBudget2(0u, &routerBudget);
+
+		KeyFrameRequestScheduler::Schedule(&transportBudget1, &listener1, 1111u);
+		KeyFrameRequestScheduler::Schedule(&transportBudget2, &listener2, 2222u);
+		KeyFrameRequestScheduler::Schedule(&transportBudget2, &listener2, 3333u);
+
+		REQUIRE(listener1.requestedSsrcs == std::vector<uint32_t>{ 1111u });
+		REQUIRE(listener2.requestedSsrcs.empty());
+		REQUIRE(KeyFrameRequestScheduler::GetNumScheduled() == 2u);
+
+		KeyFrameRequestScheduler::Unschedule(&listener2, 2222u);
+
+		REQUIRE(!KeyFrameRequestScheduler::IsScheduled(&listener2, 2222u));
+		REQUIRE(KeyFrameRequestScheduler::IsScheduled(&listener2, 3333u));
+
+		// Must run the loop here to consume the timer before doing the check.
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener2.requestedSsrcs == std::vector<uint32_t>{ 3333u });
+	}
+
+	SECTION("unscheduled Listener is not notified")
+	{
+		TestKeyFrameRequestSchedulerListener listener;
+		KeyFrameRequestScheduler::Budget budget(1u, nullptr);
+
+		KeyFrameRequestScheduler::Schedule(&budget, &listener, 1111u);
+		KeyFrameRequestScheduler::Schedule(&budget, &listener, 2222u);
+		KeyFrameRequestScheduler::Schedule(&budget, &listener, 3333u);
+
+		REQUIRE(KeyFrameRequestScheduler::GetNumScheduled() == 2u);
+
+		KeyFrameRequestScheduler::Unschedule(&listener);
+
+		REQUIRE(KeyFrameRequestScheduler::GetNumScheduled() == 0u);
+
+		// Must run the loop here to consume the timer before doing the check.
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener.requestedSsrcs == std::vector<uint32_t>{ 1111u });
+	}
+
+	SECTION("KeyFrameRequestManager drops queued request once key frame is received")
+	{
+		TestKeyFrameRequestManagerListener listener;
+		KeyFrameRequestScheduler::Budget budget(4u, nullptr);
+		KeyFrameRequestManager keyFrameRequestManager(&listener, 0u);
+
+		keyFrameRequestManager.SetKeyFrameRequestBudget(&budget);
+
+		keyFrameRequestManager.KeyFrameNeeded(1111u);
+		keyFrameRequestManager.KeyFrameNeeded(2222u);
+
+		REQUIRE(listener.requestedSsrcs == std::vector<uint32_t>{ 1111u });
+		REQUIRE(KeyFrameRequestScheduler::IsScheduled(&keyFrameRequestManager, 2222u));
+
+		keyFrameRequestManager.KeyFrameReceived(2222u);
+
+		REQUIRE(!KeyFrameRequestScheduler::IsScheduled(&keyFrameRequestManager, 2222u));
+
+		// Must run the loop here to consume the timer before doing the check.
+		DepLibUV::RunLoop();
+
+		// The key frame of 1111 was not received, so it is requested again.
+		REQUIRE(listener.requestedSsrcs == std::vector<uint32_t>{ 1111u, 1111u });
+	}
+
+	KeyFrameRequestScheduler::ClassDestroy();
+}
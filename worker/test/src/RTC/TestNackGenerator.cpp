@@ -72,6 +72,7 @@ class TestNackGeneratorListener : public NackGenerator::Listener
 	void OnNackGeneratorNackRequired(const std::vector<uint16_t>& seqNumbers) override
 	{
 		this->nackRequiredTriggered = true;
+		this->nackRequiredCount++;
 
 		auto it          = seqNumbers.begin();
 		auto firstNacked = *it;
@@ -102,10 +103,16 @@ public:
 		REQUIRE(this->keyFrameRequiredTriggered == this->currentInput.keyFrameRequired);
 	}
 
+	size_t GetNackRequiredCount() const
+	{
+		return this->nackRequiredCount;
+	}
+
 private:
 	TestNackGeneratorInput currentInput{};
 	bool nackRequiredTriggered{ false };
 	bool keyFrameRequiredTriggered{ false };
+	size_t nackRequiredCount{ 0u };
 };
 
 // clang-format off
@@ -282,6 +289,38 @@ SCENARIO("NACK generator", "[rtp][rtcp]")
 		validate(inputs);
 	}
 
+	SECTION("NACK is retried after the RTT until max retries")
+	{
+		TestNackGeneratorListener listener;
+		NackGenerator nackGenerator(&listener, SendNackDelay);
+		TestNackGeneratorInput input1{ 1, false, 0, 0 };
+		TestNackGeneratorInput input2{ 3, false, 2, 1 };
+
+		nackGenerator.UpdateRtt(20u);
+
+		listener.Reset(input1);
+		packet->SetPayloadDescriptorHandler(new TestPayloadDescriptorHandler(false));
+		packet->SetSequenceNumber(input1.seq);
+		nackGenerator.ReceivePacket(packet, /*isRecovered*/ false);
+
+		listener.Reset(input2);
+		packet->SetPayloadDescriptorHandler(new TestPayloadDescriptorHandler(false));
+		packet->SetSequenceNumber(input2.seq);
+		nackGenerator.ReceivePacket(packet, /*isRecovered*/ false);
+
+		REQUIRE(listener.GetNackRequiredCount() == 1u);
+
+		const uint64_t startMs = DepLibUV::GetTimeMs();
+
+		// Must run the loop here to consume the timer before doing the check.
+		DepLibUV::RunLoop();
+
+		// Max retries (10), each one at least 20 ms (the RTT) after the previous.
+		REQUIRE(listener.GetNackRequiredCount() == 10u);
+		REQUIRE(nackGenerator.GetNackListLength() == 0u);
+		REQUIRE(DepLibUV::GetTimeMs() - startMs >= 9u * 20u);
+	}
+
 	// Must run the loop to wait for UV timers and close them.
 	DepLibUV::RunLoop();
 }
@@ -0,0 +1,356 @@
+#include "common.hpp"
+#include "DepLibUV.hpp"
+#include "RTC/NativeSctpAssociation.hpp"
+#include "RTC/SctpPacket.hpp"
+#include <catch2/catch.hpp>
+#include <deque>
+#include <functional>
+#include <vector>
+
+using namespace RTC;
+
+namespace
+{
+	struct Message
+	{
+		uint16_t streamId;
+		uint32_t ppid;
+		std::vector<uint8_t> data;
+	};
+
+	class TestNativeSctpAssociationListener : public NativeSctpAssociation::Listener
+	{
+	public:
+		void OnNativeSctpAssociationConnected(
+		  NativeSctpAssociation* /*nativeSctpAssociation*/) override
+		{
+			this->connected = true;
+		}
+
+		void OnNativeSctpAssociationFailed(NativeSctpAssociation* /*nativeSctpAssociation*/) override
+		{
+			this->failed = true;
+		}
+
+		void OnNativeSctpAssociationClosed(NativeSctpAssociation* /*nativeSctpAssociation*/) override
+		{
+			this->closed = true;
+		}
+
+		// Packets are kept since the buffer they are given in is reused.
+		void OnNativeSctpAssociationSendPacket(
+		  NativeSctpAssociation* /*nativeSctpAssociation*/, const uint8_t* data, size_t len) override
+		{
+			this->packets.emplace_back(data, data + len);
+		}
+
+		void OnNativeSctpAssociationMessageReceived(
+		  NativeSctpAssociation* /*nativeSctpAssociation*/,
+		  uint16_t streamId,
+		  uint32_t ppid,
+		  const uint8_t* msg,
+		  size_t len) override
+		{
+			this->messages.push_back({ streamId, ppid, { msg, msg + len } });
+		}
+
+		void OnNativeSctpAssociationBufferedAmount(
+		  NativeSctpAssociation* /*nativeSctpAssociation*/, size_t bufferedAmount) override
+		{
+			this->bufferedAmount = bufferedAmount;
+		}
+
+		void OnNativeSctpAssociationIncomingStreamReset(
+		  NativeSctpAssociation* /*nativeSctpAssociation*/, uint16_t streamId) override
+		{
+			this->resetStreamIds.push_back(streamId);
+		}
+
+	public:
+		bool connected{ false };
+		bool failed{ false };
+		bool closed{ false };
+		size_t bufferedAmount{ 0u };
+		std::deque<std::vector<uint8_t>> packets;
+		std::vector<Message> messages;
+		std::vector<uint16_t> resetStreamIds;
+	};
+
+	struct Endpoint
+	{
+		Endpoint() : association(&listener, 16u, 16u, 262144u, 262144u)
+		{
+		}
+
+		TestNativeSctpAssociationListener listener;
+		NativeSctpAssociation association;
+	};
+
+	// Returns true if the packet (sent by the given endpoint) must be lost.
+	using DropFn = std::function<bool(const Endpoint& from, const std::vector<uint8_t>& packet)>;
+
+	// Delivers the packets sent by both endpoints until none is sent.
+	void exchange(Endpoint& a, Endpoint& b, const DropFn& drop = nullptr)
+	{
+		while (!a.listener.packets.empty() || !b.listener.packets.empty())
+		{
+			for (auto* from : { &a, &b })
+			{
+				auto* to = from == &a ? &b : &a;
+
+				while (!from->listener.packets.empty())
+				{
+					auto packet = std::move(from->listener.packets.front());
+
+					from->listener.packets.pop_front();
+
+					REQUIRE(
+					  SctpPacket::ReadChecksum(packet.data()) ==
+					  SctpPacket::ComputeChecksum(packet.data(), packet.size()));
+
+					if (drop && drop(*from, packet))
+						continue;
+
+					to->association.ProcessPacket(packet.data(), packet.size());
+				}
+			}
+		}
+	}
+
+	bool hasDataChunk(const std::vector<uint8_t>& packet)
+	{
+		// NOTE: DATA chunks are bundled after the control ones.
+		for (size_t offset{ 12u }; offset + 4u <= packet.size();)
+		{
+			if (packet[offset] == 0u)
+				return true;
+
+			offset += (((packet[offset + 2] << 8) | packet[offset + 3]) + 3u) & ~size_t{ 3u };
+		}
+
+		return false;
+	}
+
+	std::vector<uint8_t> makeMessage(size_t len, uint8_t seed)
+	{
+		std::vector<uint8_t> msg(len);
+
+		for (size_t i{ 0u }; i < len; ++i)
+		{
+			msg[i] = static_cast<uint8_t>(seed + i);
+		}
+
+		return msg;
+	}
+} // namespace
+
+SCENARIO("NativeSctpAssociation", "[sctp]")
+{
+	SECTION("handshake establishes both sides")
+	{
+		Endpoint a;
+		Endpoint b;
+
+		a.association.Connect();
+
+		REQUIRE(a.association.GetState() == NativeSctpAssociation::State::COOKIE_WAIT);
+
+		exchange(a, b);
+
+		REQUIRE(a.association.GetState() == NativeSctpAssociation::State::ESTABLISHED);
+		REQUIRE(b.association.GetState() == NativeSctpAssociation::State::ESTABLISHED);
+		REQUIRE(a.listener.connected);
+		REQUIRE(b.listener.connected);
+		REQUIRE(a.association.GetOs() == 16u);
+		REQUIRE(b.association.GetOs() == 16u);
+	}
+
+	SECTION("simultaneous INITs establish a single association")
+	{
+		Endpoint a;
+		Endpoint b;
+
+		a.association.Connect();
+		b.association.Connect();
+
+		exchange(a, b);
+
+		REQUIRE(a.association.GetState() == NativeSctpAssociation::State::ESTABLISHED);
+		REQUIRE(b.association.GetState() == NativeSctpAssociation::State::ESTABLISHED);
+
+		auto msg = makeMessage(100u, 1u);
+
+		REQUIRE(a.association.SendMessage(1u, 51u, true, 0u, 0u, msg.data(), msg.size()));
+
+		a.association.Flush();
+		exchange(a, b);
+
+		REQUIRE(b.listener.messages.size() == 1u);
+		REQUIRE(b.listener.messages[0].data == msg);
+	}
+
+	SECTION("messages are fragmented, reassembled and acknowledged")
+	{
+		Endpoint a;
+		Endpoint b;
+
+		a.association.Connect();
+		exchange(a, b);
+
+		auto small = makeMessage(10u, 1u);
+		auto large = makeMessage(50000u, 2u);
+
+		REQUIRE(a.association.SendMessage(1u, 51u, true, 0u, 0u, small.data(), small.size()));
+		REQUIRE(a.association.SendMessage(1u, 53u, true, 0u, 0u, large.data(), large.size()));
+		REQUIRE(b.association.SendMessage(2u, 53u, false, 0u, 0u, large.data(), large.size()));
+		REQUIRE(a.listener.bufferedAmount == small.size() + large.size());
+
+		a.association.Flush();
+		b.association.Flush();
+		exchange(a, b);
+
+		REQUIRE(b.listener.messages.size() == 2u);
+		REQUIRE(b.listener.messages[0].streamId == 1u);
+		REQUIRE(b.listener.messages[0].ppid == 51u);
+		REQUIRE(b.listener.messages[0].data == small);
+		REQUIRE(b.listener.messages[1].ppid == 53u);
+		REQUIRE(b.listener.messages[1].data == large);
+		REQUIRE(a.listener.messages.size() == 1u);
+		REQUIRE(a.listener.messages[0].streamId == 2u);
+		REQUIRE(a.listener.messages[0].data == large);
+		REQUIRE(a.listener.bufferedAmount == 0u);
+		REQUIRE(b.listener.bufferedAmount == 0u);
+	}
+
+	SECTION("lost DATA is fast retransmitted and delivered in order")
+	{
+		Endpoint a;
+		Endpoint b;
+
+		a.association.Connect();
+		exchange(a, b);
+
+		std::vector<std::vector<uint8_t>> msgs;
+
+		for (uint8_t i{ 0u }; i < 20u; ++i)
+		{
+			msgs.push_back(makeMessage(1000u, i));
+
+			REQUIRE(
+			  a.association.SendMessage(1u, 53u, true, 0u, 0u, msgs.back().data(), msgs.back().size()));
+		}
+
+		a.association.Flush();
+
+		size_t numDataPackets{ 0u };
+
+		exchange(
+		  a,
+		  b,
+		  [&a, &numDataPackets](const Endpoint& from, const std::vector<uint8_t>& packet)
+		  {
+			  if (&from != &a || !hasDataChunk(packet))
+				  return false;
+
+			  // Lose the second DATA packet.
+			  return ++numDataPackets == 2u;
+		  });
+
+		REQUIRE(b.listener.messages.size() == msgs.size());
+
+		for (size_t i{ 0u }; i < msgs.size(); ++i)
+		{
+			REQUIRE(b.listener.messages[i].data == msgs[i]);
+		}
+
+		REQUIRE(a.listener.bufferedAmount == 0u);
+	}
+
+	SECTION("expired unordered messages are abandoned")
+	{
+		Endpoint a;
+		Endpoint b;
+
+		DepLibUV::SetVirtualTimeNs(1000000000u);
+
+		a.association.Connect();
+		exchange(a, b);
+
+		auto lost = makeMessage(100u, 1u);
+		auto next = makeMessage(100u, 2u);
+
+		REQUIRE(a.association.SendMessage(1u, 53u, false, 100u, 0u, lost.data(), lost.size()));
+
+		a.association.Flush();
+
+		// Lose it.
+		a.listener.packets.clear();
+
+		DepLibUV::SetVirtualTimeNs(1200000000u);
+
+		REQUIRE(a.association.SendMessage(1u, 53u, false, 100u, 0u, next.data(), next.size()));
+
+		a.association.Flush();
+		exchange(a, b);
+
+		DepLibUV::SetVirtualTimeNs(0u);
+
+		REQUIRE(b.listener.messages.size() == 1u);
+		REQUIRE(b.listener.messages[0].data == next);
+		REQUIRE(a.listener.bufferedAmount == 0u);
+	}
+
+	SECTION("outgoing stream reset is notified to the remote")
+	{
+		Endpoint a;
+		Endpoint b;
+
+		a.association.Connect();
+		exchange(a, b);
+
+		auto msg = makeMessage(100u, 1u);
+
+		REQUIRE(a.association.SendMessage(3u, 51u, true, 0u, 0u, msg.data(), msg.size()));
+
+		a.association.ResetOutgoingStream(3u);
+		a.association.Flush();
+		exchange(a, b);
+
+		REQUIRE(b.listener.messages.size() == 1u);
+		REQUIRE(b.listener.resetStreamIds == std::vector<uint16_t>{ 3u });
+
+		// SSN starts again at 0 in the reset stream.
+		REQUIRE(a.association.SendMessage(3u, 51u, true, 0u, 0u, msg.data(), msg.size()));
+
+		a.association.Flush();
+		exchange(a, b);
+
+		REQUIRE(b.listener.messages.size() == 2u);
+	}
+
+	SECTION("outgoing streams are added")
+	{
+		Endpoint a;
+		Endpoint b;
+
+		a.association.Connect();
+		exchange(a, b);
+
+		a.association.AddOutgoingStreams(32u);
+		a.association.Flush();
+		exchange(a, b);
+
+		REQUIRE(a.association.GetOs() == 48u);
+	}
+
+	SECTION("send buffer full")
+	{
+		TestNativeSctpAssociationListener listener;
+		NativeSctpAssociation association(&listener, 16u, 16u, 262144u, 1000u);
+		auto msg = makeMessage(600u, 1u);
+
+		REQUIRE(association.SendMessage(1u, 53u, true, 0u, 0u, msg.data(), msg.size()));
+		REQUIRE(!association.SendMessage(1u, 53u, true, 0u, 0u, msg.data(), msg.size()));
+		REQUIRE(association.GetBufferedAmount() == 600u);
+	}
+}
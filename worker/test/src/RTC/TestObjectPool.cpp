@@ -0,0 +1,82 @@
+#include "common.hpp"
+#include "RTC/ObjectPool.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+SCENARIO("ObjectPool", "[rtc][objectpool]")
+{
+	// clang-format off
+	uint8_t buffer[] =
+	{
+		0b10000000, 0b00000001, 0, 8,
+		0, 0, 0, 4,
+		0, 0, 0, 5
+	};
+	// clang-format on
+
+	SECTION("freed RtpPacket memory is reused by the next RtpPacket")
+	{
+		auto* packet1 = RtpPacket::Parse(buffer, sizeof(buffer));
+
+		REQUIRE(packet1);
+
+		const void* address = packet1;
+
+		delete packet1;
+
+		auto hits   = ObjectPool::GetHits();
+		auto misses = ObjectPool::GetMisses();
+
+		auto* packet2 = RtpPacket::Parse(buffer, sizeof(buffer));
+
+		REQUIRE(packet2);
+		REQUIRE(static_cast<const void*>(packet2) == address);
+		REQUIRE(ObjectPool::GetHits() == hits + 1);
+		REQUIRE(ObjectPool::GetMisses() == misses);
+
+		delete packet2;
+	}
+
+	SECTION("blocks of different size classes are not mixed")
+	{
+		auto misses = ObjectPool::GetMisses();
+
+		void* small = ObjectPool::Allocate(ObjectPool::BlockSizeStep);
+
+		ObjectPool::Deallocate(small, ObjectPool::BlockSizeStep);
+
+		void* big = ObjectPool::Allocate(ObjectPool::BlockSizeStep + 1);
+
+		REQUIRE(big != small);
+
+		ObjectPool::Deallocate(big, ObjectPool::BlockSizeStep + 1);
+
+		auto hits = ObjectPool::GetHits();
+
+		REQUIRE(ObjectPool::Allocate(ObjectPool::BlockSizeStep) == small);
+		REQUIRE(ObjectPool::Allocate(ObjectPool::BlockSizeStep + 1) == big);
+		REQUIRE(ObjectPool::GetHits() == hits + 2);
+		REQUIRE(ObjectPool::GetMisses() <= misses + 2);
+
+		ObjectPool::Deallocate(small, ObjectPool::BlockSizeStep);
+		ObjectPool::Deallocate(big, ObjectPool::BlockSizeStep + 1);
+	}
+
+	SECTION("allocations bigger than the biggest size class are not pooled")
+	{
+		const size_t size = ObjectPool::BlockSizeStep * ObjectPool::NumSizeClasses + 1;
+		auto hits         = ObjectPool::GetHits();
+		auto misses       = ObjectPool::GetMisses();
+
+		void* ptr = ObjectPool::Allocate(size);
+
+		REQUIRE(ptr);
+
+		ObjectPool::Deallocate(ptr, size);
+
+		REQUIRE(ObjectPool::GetHits() == hits);
+		REQUIRE(ObjectPool::GetMisses() == misses);
+	}
+}
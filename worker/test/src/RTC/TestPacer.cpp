@@ -0,0 +1,266 @@
+#include "common.hpp"
+#include "DepLibUV.hpp"
+#include "RTC/Codecs/PayloadDescriptorHandler.hpp"
+#include "RTC/Pacer.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <catch2/catch.hpp>
+#include <memory> // std::unique_ptr
+
+using namespace RTC;
+
+class TestPacerListener : public Pacer::Listener
+{
+public:
+	void OnPacerSendRtpPacket(
+	  Pacer* /*pacer*/,
+	  Consumer* /*consumer*/,
+	  RtpPacket* /*packet*/,
+	  bool /*retransmission*/,
+	  uint64_t /*queuedAtNs*/) override
+	{
+		this->sentPackets++;
+	}
+
+	void OnPacerSendSctpData(Pacer* /*pacer*/, const uint8_t* /*data*/, size_t /*len*/) override
+	{
+		this->sentSctpPackets++;
+	}
+
+public:
+	size_t sentPackets{ 0u };
+	size_t sentSctpPackets{ 0u };
+};
+
+class TestPacerPayloadDescriptorHandler : public Codecs::PayloadDescriptorHandler
+{
+public:
+	TestPacerPayloadDescriptorHandler(uint8_t temporalLayer, bool isKeyFrame)
+	  : temporalLayer(temporalLayer), isKeyFrame(isKeyFrame)
+	{
+	}
+
+public:
+	void Dump() const override
+	{
+	}
+	bool Process(Codecs::EncodingContext* /*context*/, uint8_t* /*data*/, bool& /*marker*/) override
+	{
+		return true;
+	}
+	void Restore(uint8_t* /*data*/) override
+	{
+	}
+	uint8_t GetSpatialLayer() const override
+	{
+		return 0u;
+	}
+	uint8_t GetTemporalLayer() const override
+	{
+		return this->temporalLayer;
+	}
+	bool IsKeyFrame() const override
+	{
+		return this->isKeyFrame;
+	}
+
+private:
+	uint8_t temporalLayer{ 0u };
+	bool isKeyFrame{ false };
+};
+
+// Tags the packet as belonging to the given frame.
+static void setFrame(
+  RtpPacket* packet, uint32_t timestamp, uint8_t temporalLayer, bool isKeyFrame = false)
+{
+	packet->SetTimestamp(timestamp);
+	packet->SetPayloadDescriptorHandler(
+	  new TestPacerPayloadDescriptorHandler(temporalLayer, isKeyFrame));
+}
+
+SCENARIO("Pacer", "[rtp][pacer]")
+{
+	// 600 bytes RTP packet.
+	uint8_t buffer[600]{};
+
+	buffer[0] = 0b10000000;
+	buffer[1] = 0b01100100;
+
+	std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer, sizeof(buffer)));
+
+	REQUIRE(packet);
+
+	TestPacerListener listener;
+
+	// Pacing rate of 200 kbps, so the initial budget (40 ms) is 1000 bytes.
+	uint32_t availableBitrate{ 80000u };
+
+	SECTION("packets are sent right away while there is budget")
+	{
+		Pacer pacer(&listener, availableBitrate);
+
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == false);
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == false);
+		REQUIRE(pacer.GetQueueSize() == 0);
+
+		// No budget left.
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == true);
+		REQUIRE(pacer.GetQueueSize() == 1);
+
+		// Packets are not sent before the queued ones.
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), true) == true);
+		REQUIRE(pacer.GetQueueSize() == 2);
+		REQUIRE(listener.sentPackets == 0);
+	}
+
+	SECTION("RemoveConsumer() drops the queued packets of the Consumer")
+	{
+		Pacer pacer(&listener, availableBitrate);
+
+		pacer.QueuePacket(nullptr, packet.get(), false);
+		pacer.QueuePacket(nullptr, packet.get(), false);
+		pacer.QueuePacket(nullptr, packet.get(), false);
+
+		REQUIRE(pacer.GetQueueSize() == 1);
+
+		pacer.RemoveConsumer(nullptr);
+
+		REQUIRE(pacer.GetQueueSize() == 0);
+	}
+
+	SECTION("Clear() drops all the queued packets")
+	{
+		Pacer pacer(&listener, availableBitrate);
+
+		pacer.QueuePacket(nullptr, packet.get(), false);
+		pacer.QueuePacket(nullptr, packet.get(), false);
+		pacer.QueuePacket(nullptr, packet.get(), false);
+		pacer.QueuePacket(nullptr, packet.get(), false);
+
+		REQUIRE(pacer.GetQueueSize() == 2);
+
+		pacer.Clear();
+
+		REQUIRE(pacer.GetQueueSize() == 0);
+		REQUIRE(listener.sentPackets == 0);
+	}
+
+	SECTION("SCTP packets are not paced if no SCTP bitrate share is given")
+	{
+		Pacer pacer(&listener, availableBitrate);
+
+		for (size_t i{ 0u }; i < 10u; ++i)
+		{
+			REQUIRE(pacer.QueueSctpPacket(buffer, sizeof(buffer)) == false);
+		}
+
+		REQUIRE(pacer.GetSctpQueueSize() == 0);
+	}
+
+	SECTION("SCTP packets are sent within their share and after queued media")
+	{
+		// SCTP budget of 16 kbps (the minimum), so the initial one (40 ms) is 80
+		// bytes.
+		Pacer pacer(&listener, availableBitrate, 0.1f);
+
+		REQUIRE(pacer.QueueSctpPacket(buffer, sizeof(buffer)) == false);
+
+		// No SCTP budget left.
+		REQUIRE(pacer.QueueSctpPacket(buffer, sizeof(buffer)) == true);
+		REQUIRE(pacer.GetSctpQueueSize() == 1);
+
+		// Media is not affected by the SCTP budget.
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == false);
+		REQUIRE(pacer.GetQueueSize() == 0);
+
+		pacer.Clear();
+
+		REQUIRE(pacer.GetSctpQueueSize() == 0);
+		REQUIRE(listener.sentSctpPackets == 0);
+	}
+
+	SECTION("SCTP packets are queued while media is queued")
+	{
+		Pacer pacer(&listener, availableBitrate, 1.0f);
+
+		pacer.QueuePacket(nullptr, packet.get(), false);
+		pacer.QueuePacket(nullptr, packet.get(), false);
+		pacer.QueuePacket(nullptr, packet.get(), false);
+
+		REQUIRE(pacer.GetQueueSize() == 1);
+		REQUIRE(pacer.QueueSctpPacket(buffer, 100u) == true);
+		REQUIRE(pacer.GetSctpQueueSize() == 1);
+	}
+
+	SECTION("non reference frames are dropped when the queue delay is too high")
+	{
+		DepLibUV::SetVirtualTimeNs(1000000000u);
+
+		Pacer pacer(&listener, availableBitrate);
+
+		// Base layer frame, sent right away.
+		setFrame(packet.get(), 1000u, 0u);
+
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == false);
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == false);
+
+		// No budget left.
+		setFrame(packet.get(), 2000u, 1u);
+
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == true);
+		REQUIRE(pacer.GetQueueSize() == 1);
+
+		// A key frame retransmission, never dropped.
+		setFrame(packet.get(), 500u, 1u, true);
+
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), true) == true);
+		REQUIRE(pacer.GetQueueSize() == 2);
+
+		DepLibUV::SetVirtualTimeNs(1100000000u);
+
+		// The non reference frame is dropped once a packet is queued.
+		setFrame(packet.get(), 3000u, 0u);
+
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == true);
+		REQUIRE(pacer.GetQueueSize() == 2);
+		REQUIRE(pacer.GetDroppedPackets() == 1);
+
+		// The rest of the dropped frame and frames of higher layers are dropped.
+		setFrame(packet.get(), 2000u, 1u);
+
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == true);
+
+		setFrame(packet.get(), 4000u, 2u);
+
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == true);
+		REQUIRE(pacer.GetQueueSize() == 2);
+		REQUIRE(pacer.GetDroppedPackets() == 3);
+		REQUIRE(listener.sentPackets == 0);
+
+		DepLibUV::SetVirtualTimeNs(0u);
+	}
+
+	SECTION("partially sent non reference frames are not dropped")
+	{
+		DepLibUV::SetVirtualTimeNs(1000000000u);
+
+		Pacer pacer(&listener, availableBitrate);
+
+		setFrame(packet.get(), 1000u, 1u);
+
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == false);
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == false);
+
+		// No budget left.
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == true);
+
+		DepLibUV::SetVirtualTimeNs(1100000000u);
+
+		setFrame(packet.get(), 2000u, 0u);
+
+		REQUIRE(pacer.QueuePacket(nullptr, packet.get(), false) == true);
+		REQUIRE(pacer.GetQueueSize() == 2);
+		REQUIRE(pacer.GetDroppedPackets() == 0);
+
+		DepLibUV::SetVirtualTimeNs(0u);
+	}
+}
@@ -0,0 +1,149 @@
+#include "common.hpp"
+#include "MediaSoupErrors.hpp"
+#include "Utils.hpp"
+#include "RTC/PacketCapture.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <catch2/catch.hpp>
+#include <cstring> // std::memcmp()
+#include <memory>  // std::unique_ptr
+#include <vector>
+
+using namespace RTC;
+
+SCENARIO("PacketCapture", "[rtp][rtcp][capture]")
+{
+	// pcap file header, record header and IPv4/UDP headers.
+	constexpr size_t FileHeaderSize{ 24u };
+	constexpr size_t RecordSize{ 16u + 20u + 8u };
+
+	// clang-format off
+	uint8_t rtpBuffer[] =
+	{
+		0b10000000, 0b01111011, 0b01010010, 0b00001110,
+		0b01011011, 0b01101011, 0b11001010, 0b10110101,
+		0, 0, 0, 2,
+		0x01, 0x02, 0x03, 0x04
+	};
+	uint8_t rtcpBuffer[] =
+	{
+		0x81, 0xc9, 0x00, 0x01,
+		0x00, 0x00, 0x00, 0x02
+	};
+	// clang-format on
+
+	std::unique_ptr<RtpPacket> packet{ RtpPacket::Parse(rtpBuffer, sizeof(rtpBuffer)) };
+
+	REQUIRE(packet);
+
+	SECTION("captured packets are given in pcap format with synthetic IPv4/UDP headers")
+	{
+		PacketCapture packetCapture(4u, false);
+		std::vector<uint8_t> pcap;
+
+		packetCapture.CaptureRtpPacket(PacketCapture::Direction::IN, packet.get());
+		packetCapture.CaptureRtcpPacket(PacketCapture::Direction::OUT, rtcpBuffer, sizeof(rtcpBuffer));
+		packetCapture.SerializePcap(pcap);
+
+		REQUIRE(packetCapture.GetPacketCount() == 2u);
+		REQUIRE(
+		  pcap.size() ==
+		  FileHeaderSize + RecordSize + sizeof(rtpBuffer) + RecordSize + sizeof(rtcpBuffer));
+
+		uint32_t magic;
+
+		std::memcpy(&magic, pcap.data(), sizeof(magic));
+
+		REQUIRE(magic == 0xa1b2c3d4);
+
+		// Received RTP packet: from 10.0.0.2 to 10.0.0.1, port 5004.
+		const uint8_t* ip = pcap.data() + FileHeaderSize + 16u;
+
+		REQUIRE(ip[0] == 0x45);
+		REQUIRE(ip[9] == 17u);
+		REQUIRE(Utils::Byte::Get2Bytes(ip, 2) == 28u + sizeof(rtpBuffer));
+		REQUIRE(Utils::Byte::Get4Bytes(ip, 12) == 0x0a000002);
+		REQUIRE(Utils::Byte::Get4Bytes(ip, 16) == 0x0a000001);
+		REQUIRE(Utils::Byte::Get2Bytes(ip, 20) == 5004u);
+		REQUIRE(std::memcmp(ip + 28u, rtpBuffer, sizeof(rtpBuffer)) == 0);
+
+		// The IPv4 header checksum is valid.
+		uint32_t sum{ 0u };
+
+		for (size_t i{ 0u }; i < 20u; i += 2u)
+		{
+			sum += Utils::Byte::Get2Bytes(ip, i);
+		}
+
+		REQUIRE(((sum & 0xFFFF) + (sum >> 16)) == 0xFFFF);
+
+		// Sent RTCP packet: from 10.0.0.1 to 10.0.0.2, port 5005.
+		ip += 28u + sizeof(rtpBuffer) + 16u;
+
+		REQUIRE(Utils::Byte::Get4Bytes(ip, 12) == 0x0a000001);
+		REQUIRE(Utils::Byte::Get4Bytes(ip, 16) == 0x0a000002);
+		REQUIRE(Utils::Byte::Get2Bytes(ip, 20) == 5005u);
+		REQUIRE(std::memcmp(ip + 28u, rtcpBuffer, sizeof(rtcpBuffer)) == 0);
+	}
+
+	SECTION("oldest packets are overwritten")
+	{
+		PacketCapture packetCapture(2u, false);
+		std::vector<uint8_t> pcap;
+
+		for (uint8_t i{ 0u }; i < 3u; ++i)
+		{
+			rtcpBuffer[7] = i;
+
+			packetCapture.CaptureRtcpPacket(PacketCapture::Direction::IN, rtcpBuffer, sizeof(rtcpBuffer));
+		}
+
+		packetCapture.SerializePcap(pcap);
+
+		REQUIRE(packetCapture.GetPacketCount() == 2u);
+		REQUIRE(pcap.size() == FileHeaderSize + ((RecordSize + sizeof(rtcpBuffer)) * 2u));
+		REQUIRE(pcap[FileHeaderSize + RecordSize + 7u] == 1u);
+		REQUIRE(pcap[pcap.size() - 1u] == 2u);
+
+		json jsonObject = json::object();
+
+		packetCapture.FillJson(jsonObject);
+
+		REQUIRE(jsonObject["packetCount"] == 2u);
+		REQUIRE(jsonObject["capturedPackets"] == 3u);
+	}
+
+	SECTION("just the RTP header is captured in headers only mode")
+	{
+		PacketCapture packetCapture(4u, true);
+		std::vector<uint8_t> pcap;
+
+		packetCapture.CaptureRtpPacket(PacketCapture::Direction::OUT, packet.get());
+		packetCapture.SerializePcap(pcap);
+
+		REQUIRE(pcap.size() == FileHeaderSize + RecordSize + 12u);
+
+		uint32_t capturedLen;
+		uint32_t len;
+
+		std::memcpy(&capturedLen, pcap.data() + FileHeaderSize + 8u, sizeof(capturedLen));
+		std::memcpy(&len, pcap.data() + FileHeaderSize + 12u, sizeof(len));
+
+		REQUIRE(capturedLen == 28u + 12u);
+		REQUIRE(len == 28u + sizeof(rtpBuffer));
+	}
+
+	SECTION("wrong options throw")
+	{
+		REQUIRE_THROWS_AS(PacketCapture::Create(json{ { "maxPackets", 0u } }), MediaSoupTypeError);
+		REQUIRE_THROWS_AS(PacketCapture::Create(json{ { "headersOnly", "yes" } }), MediaSoupTypeError);
+
+		std::unique_ptr<PacketCapture> packetCapture{ PacketCapture::Create(json::object()) };
+
+		json jsonObject = json::object();
+
+		packetCapture->FillJson(jsonObject);
+
+		REQUIRE(jsonObject["maxPackets"] == PacketCapture::DefaultMaxPackets);
+		REQUIRE(jsonObject["headersOnly"] == false);
+	}
+}
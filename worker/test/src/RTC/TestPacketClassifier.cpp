@@ -0,0 +1,69 @@
+#include "common.hpp"
+#include "RTC/PacketClassifier.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+SCENARIO("PacketClassifier", "[rtp][rtcp]")
+{
+	SECTION("classifies packets by the first byte")
+	{
+		// clang-format off
+		uint8_t stun[] =
+		{
+			0x00, 0x01, 0x00, 0x00, // Binding request.
+			0x21, 0x12, 0xa4, 0x42, // Magic cookie.
+			0x00, 0x00, 0x00, 0x00, // Transaction id.
+			0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00
+		};
+		uint8_t dtls[] =
+		{
+			0x16, 0xfe, 0xfd, 0x00, // Handshake.
+			0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00,
+			0x00
+		};
+		uint8_t rtp[] =
+		{
+			0x80, 0x60, 0x00, 0x01,
+			0x00, 0x00, 0x00, 0x01,
+			0x00, 0x00, 0x00, 0x05
+		};
+		uint8_t rtcp[] =
+		{
+			0x80, 0xc9, 0x00, 0x01, // Receiver Report.
+			0x00, 0x00, 0x00, 0x05
+		};
+		// clang-format on
+
+		REQUIRE(PacketClassifier::Classify(stun, sizeof(stun)) == PacketClassifier::Type::STUN);
+		REQUIRE(PacketClassifier::Classify(dtls, sizeof(dtls)) == PacketClassifier::Type::DTLS);
+		REQUIRE(PacketClassifier::Classify(rtp, sizeof(rtp)) == PacketClassifier::Type::RTP);
+		REQUIRE(PacketClassifier::Classify(rtcp, sizeof(rtcp)) == PacketClassifier::Type::RTCP);
+	}
+
+	SECTION("rejects invalid packets")
+	{
+		// clang-format off
+		// STUN range but wrong magic cookie.
+		uint8_t stun[] =
+		{
+			0x00, 0x01, 0x00, 0x00,
+			0x21, 0x12, 0xa4, 0x43,
+			0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00
+		};
+		// Too short DTLS record.
+		uint8_t dtls[] = { 0x16, 0xfe, 0xfd, 0x00 };
+		// Out of any range.
+		uint8_t other[] = { 0x50, 0x00, 0x00, 0x00 };
+		// clang-format on
+
+		REQUIRE(PacketClassifier::Classify(stun, sizeof(stun)) == PacketClassifier::Type::UNKNOWN);
+		REQUIRE(PacketClassifier::Classify(dtls, sizeof(dtls)) == PacketClassifier::Type::UNKNOWN);
+		REQUIRE(PacketClassifier::Classify(other, sizeof(other)) == PacketClassifier::Type::UNKNOWN);
+		REQUIRE(PacketClassifier::Classify(other, 0u) == PacketClassifier::Type::UNKNOWN);
+	}
+}
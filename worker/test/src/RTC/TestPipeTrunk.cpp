@@ -0,0 +1,158 @@
+#include "common.hpp"
+#include "RTC/PipeTrunk.hpp"
+#include <catch2/catch.hpp>
+#include <cstring> // std::memset()
+#include <vector>
+
+using namespace RTC;
+
+SCENARIO("PipeTrunk", "[rtp][rtcp][pipe]")
+{
+	class TestPipeTrunkListener : public PipeTrunk::Listener
+	{
+	public:
+		void OnPipeTrunkSendFrame(PipeTrunk* /*pipeTrunk*/, const uint8_t* data, size_t len) override
+		{
+			this->frames.emplace_back(data, data + len);
+		}
+
+		void OnPipeTrunkPacketReceived(PipeTrunk* /*pipeTrunk*/, const uint8_t* data, size_t len) override
+		{
+			this->packets.emplace_back(data, data + len);
+		}
+
+	public:
+		std::vector<std::vector<uint8_t>> frames;
+		std::vector<std::vector<uint8_t>> packets;
+	};
+
+	uint8_t packet1[200];
+	uint8_t packet2[1000];
+	uint8_t packet3[1200];
+
+	std::memset(packet1, 0x81, sizeof(packet1));
+	std::memset(packet2, 0x82, sizeof(packet2));
+	std::memset(packet3, 0x83, sizeof(packet3));
+
+	uint8_t key1[PipeTrunk::KeyLength];
+	uint8_t key2[PipeTrunk::KeyLength];
+
+	std::memset(key1, 0x11, sizeof(key1));
+	std::memset(key2, 0x22, sizeof(key2));
+
+	SECTION("packets are aggregated into frames of up to maxFrameSize")
+	{
+		TestPipeTrunkListener sender;
+		TestPipeTrunkListener receiver;
+		PipeTrunk sendTrunk(&sender, PipeTrunk::MinMaxFrameSize);
+		PipeTrunk recvTrunk(&receiver, PipeTrunk::MinMaxFrameSize);
+
+		REQUIRE(sendTrunk.Send(packet1, sizeof(packet1)));
+		REQUIRE(sendTrunk.Send(packet2, sizeof(packet2)));
+		REQUIRE(sender.frames.empty());
+
+		// Does not fit in the current frame.
+		REQUIRE(sendTrunk.Send(packet3, sizeof(packet3)));
+		REQUIRE(sender.frames.size() == 1);
+
+		sendTrunk.Flush();
+
+		REQUIRE(sender.frames.size() == 2);
+		REQUIRE(sendTrunk.IsEmpty());
+		REQUIRE(sendTrunk.GetSentFrames() == 2);
+		REQUIRE(sendTrunk.GetSentPackets() == 3);
+
+		for (auto& frame : sender.frames)
+		{
+			REQUIRE(frame.size() <= PipeTrunk::MinMaxFrameSize);
+			REQUIRE(PipeTrunk::IsFrame(frame.data(), frame.size()));
+			REQUIRE(recvTrunk.ReceiveFrame(frame.data(), frame.size()));
+		}
+
+		REQUIRE(receiver.packets.size() == 3);
+		REQUIRE(receiver.packets[0] == std::vector<uint8_t>(packet1, packet1 + sizeof(packet1)));
+		REQUIRE(receiver.packets[1] == std::vector<uint8_t>(packet2, packet2 + sizeof(packet2)));
+		REQUIRE(receiver.packets[2] == std::vector<uint8_t>(packet3, packet3 + sizeof(packet3)));
+
+		// Too big to ever fit.
+		std::vector<uint8_t> bigPacket(PipeTrunk::MinMaxFrameSize, 0x80);
+
+		REQUIRE(!sendTrunk.Send(bigPacket.data(), bigPacket.size()));
+	}
+
+	SECTION("frames are encrypted and authenticated")
+	{
+		TestPipeTrunkListener sender;
+		TestPipeTrunkListener receiver;
+		PipeTrunk sendTrunk(&sender, PipeTrunk::DefaultMaxFrameSize);
+		PipeTrunk recvTrunk(&receiver, PipeTrunk::DefaultMaxFrameSize);
+
+		sendTrunk.SetKeys(key1, key2);
+		recvTrunk.SetKeys(key2, key1);
+
+		REQUIRE(sendTrunk.Send(packet1, sizeof(packet1)));
+		REQUIRE(sendTrunk.Send(packet2, sizeof(packet2)));
+
+		sendTrunk.Flush();
+
+		REQUIRE(sender.frames.size() == 1);
+
+		auto frame = sender.frames[0];
+
+		REQUIRE(
+		  frame.size() == PipeTrunk::HeaderSize + 2 * PipeTrunk::RecordHeaderSize + sizeof(packet1) +
+		                    sizeof(packet2) + PipeTrunk::TagSize);
+
+		// Payload is not in clear.
+		REQUIRE(frame[PipeTrunk::HeaderSize + PipeTrunk::RecordHeaderSize] != 0x81);
+
+		// Tampered frame is rejected.
+		auto tampered = frame;
+
+		tampered[PipeTrunk::HeaderSize + 10] ^= 0x01;
+
+		REQUIRE(!recvTrunk.ReceiveFrame(tampered.data(), tampered.size()));
+		REQUIRE(receiver.packets.empty());
+
+		auto received = frame;
+
+		REQUIRE(recvTrunk.ReceiveFrame(received.data(), received.size()));
+		REQUIRE(receiver.packets.size() == 2);
+		REQUIRE(receiver.packets[0] == std::vector<uint8_t>(packet1, packet1 + sizeof(packet1)));
+		REQUIRE(receiver.packets[1] == std::vector<uint8_t>(packet2, packet2 + sizeof(packet2)));
+
+		// Replayed frame is rejected.
+		auto replayed = frame;
+
+		REQUIRE(!recvTrunk.ReceiveFrame(replayed.data(), replayed.size()));
+		REQUIRE(receiver.packets.size() == 2);
+	}
+
+	SECTION("reordered frames within the replay window are accepted")
+	{
+		TestPipeTrunkListener sender;
+		TestPipeTrunkListener receiver;
+		PipeTrunk sendTrunk(&sender, PipeTrunk::DefaultMaxFrameSize);
+		PipeTrunk recvTrunk(&receiver, PipeTrunk::DefaultMaxFrameSize);
+
+		sendTrunk.SetKeys(key1, key2);
+		recvTrunk.SetKeys(key2, key1);
+
+		for (size_t i{ 0u }; i < PipeTrunk::ReplayWindowSize + 2; ++i)
+		{
+			REQUIRE(sendTrunk.Send(packet1, sizeof(packet1)));
+
+			sendTrunk.Flush();
+		}
+
+		auto& frames = sender.frames;
+
+		REQUIRE(recvTrunk.ReceiveFrame(frames[2].data(), frames[2].size()));
+		REQUIRE(recvTrunk.ReceiveFrame(frames[1].data(), frames[1].size()));
+		REQUIRE(recvTrunk.ReceiveFrame(frames.back().data(), frames.back().size()));
+
+		// Out of the replay window.
+		REQUIRE(!recvTrunk.ReceiveFrame(frames[0].data(), frames[0].size()));
+		REQUIRE(receiver.packets.size() == 3);
+	}
+}
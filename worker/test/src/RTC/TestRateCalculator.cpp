@@ -1,4 +1,5 @@
 #include "common.hpp"
+#include "AllocationCounter.hpp"
 #include "DepLibUV.hpp"
 #include "RTC/RateCalculator.hpp"
 #include <catch2/catch.hpp>
@@ -124,4 +125,66 @@ SCENARIO("Bitrate calculator", "[rtp][bitrate]")
 
 		validate(rate, nowMs, input);
 	}
+
+	SECTION("32 bit time wrap")
+	{
+		RateCalculator rate(1000, 8000, 100);
+
+		// Item start times are stored in 32 bits, make them wrap.
+		uint64_t timeBase = 0xFFFFFFFFull - 500u;
+
+		// clang-format off
+		std::vector<data> input =
+		{
+			{ 0,    5, 40 },
+			{ 400,  2, 56 },
+			{ 800,  1, 64 },
+			{ 1200, 1, 32 },
+			{ 1600, 1, 24 }
+		};
+		// clang-format on
+
+		validate(rate, timeBase, input);
+
+		REQUIRE(rate.GetRate(timeBase + 2601) == 0);
+	}
+}
+
+SCENARIO("Bitrate calculator hot path", "[rtp][bitrate][perf]")
+{
+	SECTION("updating and getting the rate does no heap allocation")
+	{
+		RateCalculator rate;
+		uint64_t nowMs = DepLibUV::GetTimeMs();
+
+		// The buffer is allocated by the first update.
+		rate.Update(1000u, nowMs);
+
+		AllocationCounter allocationCounter;
+
+		// Several windows, so old items are removed.
+		for (uint64_t offset{ 0u }; offset < 5000u; ++offset)
+		{
+			rate.Update(1000u, nowMs + offset);
+			rate.GetRate(nowMs + offset);
+		}
+
+		auto allocations = allocationCounter.GetCount();
+
+		REQUIRE(allocations == 0u);
+	}
+
+	SECTION("the buffer is not allocated until there is data")
+	{
+		RateCalculator rate;
+		uint64_t nowMs = DepLibUV::GetTimeMs();
+
+		REQUIRE(rate.GetRate(nowMs) == 0u);
+		REQUIRE(rate.GetMemoryUsage() == 0u);
+
+		rate.Update(1000u, nowMs);
+
+		REQUIRE(rate.GetMemoryUsage() != 0u);
+		REQUIRE(rate.GetRate(nowMs) == 8000u);
+	}
 }
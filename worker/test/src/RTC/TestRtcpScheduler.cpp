@@ -0,0 +1,122 @@
+#include "common.hpp"
+#include "DepLibUV.hpp"
+#include "RTC/RtcpScheduler.hpp"
+#include <catch2/catch.hpp>
+#include <vector>
+
+using namespace RTC;
+
+SCENARIO("RtcpScheduler", "[rtcp][scheduler]")
+{
+	class TestRtcpSchedulerListener : public RtcpScheduler::Listener
+	{
+	public:
+		void OnRtcpSchedulerSendRtcp(uint64_t nowMs) override
+		{
+			this->sendTimes.push_back(nowMs);
+
+			if (this->other)
+				RtcpScheduler::Unschedule(this->other);
+
+			if (this->sendTimes.size() < this->numRounds)
+				RtcpScheduler::Schedule(this, this->intervalMs);
+		}
+
+	public:
+		std::vector<uint64_t> sendTimes;
+		size_t numRounds{ 1u };
+		uint64_t intervalMs{ 0u };
+		TestRtcpSchedulerListener* other{ nullptr };
+	};
+
+	SECTION("listeners due in the same slot are notified in the same pass")
+	{
+		TestRtcpSchedulerListener listener1;
+		TestRtcpSchedulerListener listener2;
+		TestRtcpSchedulerListener listener3;
+		const uint64_t numPasses = RtcpScheduler::GetNumPasses();
+
+		// Make sure all of them fall in the same slot.
+		RtcpScheduler::Schedule(&listener1, RtcpScheduler::SlotMs);
+		RtcpScheduler::Schedule(&listener2, RtcpScheduler::SlotMs);
+		RtcpScheduler::Schedule(&listener3, RtcpScheduler::SlotMs);
+
+		REQUIRE(RtcpScheduler::GetNumScheduled() == 3u);
+
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener1.sendTimes.size() == 1u);
+		REQUIRE(listener2.sendTimes.size() == 1u);
+		REQUIRE(listener3.sendTimes.size() == 1u);
+		REQUIRE(listener1.sendTimes[0] == listener2.sendTimes[0]);
+		REQUIRE(listener1.sendTimes[0] == listener3.sendTimes[0]);
+		REQUIRE(RtcpScheduler::GetNumPasses() == numPasses + 1u);
+		REQUIRE(RtcpScheduler::GetNumScheduled() == 0u);
+	}
+
+	SECTION("listener rescheduling itself is notified in later slots")
+	{
+		TestRtcpSchedulerListener listener;
+
+		listener.numRounds  = 3u;
+		listener.intervalMs = 0u;
+
+		RtcpScheduler::Schedule(&listener, 0u);
+
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener.sendTimes.size() == 3u);
+		REQUIRE(listener.sendTimes[1] > listener.sendTimes[0]);
+		REQUIRE(listener.sendTimes[2] > listener.sendTimes[1]);
+	}
+
+	SECTION("unscheduled listener is not notified")
+	{
+		TestRtcpSchedulerListener listener1;
+		TestRtcpSchedulerListener listener2;
+
+		RtcpScheduler::Schedule(&listener1, 10u);
+		RtcpScheduler::Schedule(&listener2, 10u);
+		RtcpScheduler::Unschedule(&listener2);
+
+		REQUIRE(RtcpScheduler::IsScheduled(&listener1));
+		REQUIRE(!RtcpScheduler::IsScheduled(&listener2));
+
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener1.sendTimes.size() == 1u);
+		REQUIRE(listener2.sendTimes.empty());
+	}
+
+	SECTION("listener unscheduled by another one in the same pass is not notified")
+	{
+		TestRtcpSchedulerListener listener1;
+		TestRtcpSchedulerListener listener2;
+
+		listener1.other = &listener2;
+		listener2.other = &listener1;
+
+		RtcpScheduler::Schedule(&listener1, 10u);
+		RtcpScheduler::Schedule(&listener2, 10u);
+
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener1.sendTimes.size() + listener2.sendTimes.size() == 1u);
+		REQUIRE(RtcpScheduler::GetNumScheduled() == 0u);
+	}
+
+	SECTION("rescheduling moves the listener to the new slot")
+	{
+		TestRtcpSchedulerListener listener;
+
+		RtcpScheduler::Schedule(&listener, 5000u);
+		RtcpScheduler::Schedule(&listener, 10u);
+
+		REQUIRE(RtcpScheduler::GetNumScheduled() == 1u);
+
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener.sendTimes.size() == 1u);
+		REQUIRE(RtcpScheduler::GetNumScheduled() == 0u);
+	}
+}
@@ -0,0 +1,65 @@
+#include "common.hpp"
+#include "RTC/RtpHeaderTemplate.hpp"
+#include "RTC/RtpPacket.hpp"
+#include <catch2/catch.hpp>
+#include <cstring> // std::memcmp()
+#include <memory>  // std::unique_ptr
+
+using namespace RTC;
+
+SCENARIO("RtpHeaderTemplate", "[rtp]")
+{
+	// clang-format off
+	uint8_t buffer[] =
+	{
+		0x80, 0xe0, 0x12, 0x34, // Marker, PT 96, seq 0x1234.
+		0x00, 0x00, 0x10, 0x00, // Timestamp 4096.
+		0x00, 0x00, 0x00, 0x05, // SSRC 5.
+		0x01, 0x02, 0x03, 0x04  // Payload.
+	};
+	// clang-format on
+
+	uint8_t original[sizeof(buffer)];
+
+	std::memcpy(original, buffer, sizeof(buffer));
+
+	std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer, sizeof(buffer)));
+
+	REQUIRE(packet);
+
+	RtpHeaderTemplate headerTemplate;
+	RtpHeaderTemplate::SavedHeader savedHeader;
+
+	headerTemplate.SetSsrc(1234567890u);
+
+	SECTION("rewrites SSRC and seq and restores the original header")
+	{
+		headerTemplate.Apply(packet.get(), 2000u, savedHeader);
+
+		REQUIRE(packet->GetSsrc() == 1234567890u);
+		REQUIRE(packet->GetSequenceNumber() == 2000u);
+		REQUIRE(packet->GetTimestamp() == 4096u);
+		REQUIRE(packet->GetPayloadType() == 96u);
+		REQUIRE(packet->HasMarker() == true);
+
+		packet->SetMarker(false);
+
+		RtpHeaderTemplate::Restore(packet.get(), savedHeader);
+
+		REQUIRE(std::memcmp(buffer, original, sizeof(buffer)) == 0);
+	}
+
+	SECTION("rewrites SSRC, seq and timestamp and restores the original header")
+	{
+		headerTemplate.Apply(packet.get(), 2000u, 8000u, savedHeader);
+
+		REQUIRE(packet->GetSsrc() == 1234567890u);
+		REQUIRE(packet->GetSequenceNumber() == 2000u);
+		REQUIRE(packet->GetTimestamp() == 8000u);
+		REQUIRE(packet->GetPayloadLength() == 4u);
+
+		RtpHeaderTemplate::Restore(packet.get(), savedHeader);
+
+		REQUIRE(std::memcmp(buffer, original, sizeof(buffer)) == 0);
+	}
+}
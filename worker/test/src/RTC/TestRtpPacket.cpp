@@ -1,8 +1,11 @@
 #include "common.hpp"
+#include "AllocationCounter.hpp"
 #include "helpers.hpp"
+#include "RTC/ObjectPool.hpp"
 #include "RTC/RtpPacket.hpp"
 #include <catch2/catch.hpp>
 #include <cstring> // std::memset()
+#include <memory>  // std::unique_ptr
 #include <string>
 #include <vector>
 
@@ -339,10 +342,16 @@ SCENARIO("parse RTP packets", "[parser][rtp]")
 		REQUIRE(packet->HasOneByteExtensions() == false);
 		REQUIRE(packet->HasTwoBytesExtensions());
 
+		packet->SetIngressTime(1234u);
+		packet->SetArrivalTime(5678u);
+
 		static uint8_t RtxBuffer[MtuSize];
 
 		auto rtxPacket = packet->Clone(RtxBuffer);
 
+		REQUIRE(rtxPacket->GetIngressTime() == 1234u);
+		REQUIRE(rtxPacket->GetArrivalTime() == 5678u);
+
 		delete packet;
 
 		std::memset(buffer, '0', sizeof(buffer));
@@ -359,6 +368,7 @@ SCENARIO("parse RTP packets", "[parser][rtp]")
 		REQUIRE(rtxPacket->GetHeaderExtensionLength() == 12);
 		REQUIRE(rtxPacket->HasOneByteExtensions() == false);
 		REQUIRE(rtxPacket->HasTwoBytesExtensions());
+		REQUIRE(rtxPacket->GetIngressTime() == 1234u);
 
 		rtxPacket->RtxDecode(1, 5);
 
@@ -376,6 +386,66 @@ SCENARIO("parse RTP packets", "[parser][rtp]")
 		delete rtxPacket;
 	}
 
+	SECTION("rtx clone is the same as clone and rtx encoding")
+	{
+		// clang-format off
+		uint8_t buffer[] =
+		{
+			0b10110000, 0b00000001, 0, 8,
+			0, 0, 0, 4,
+			0, 0, 0, 5,
+			0b00010000, 0, 0, 3, // Header Extension
+			1, 0, 2, 1,
+			0xFF, 0, 3, 4,
+			0xFF, 0xFF, 0xFF, 0xFF,
+			0x11, 0x22, 0x33, 0x44, // Payload
+			0x00, 0x00, 0x00, 0x04  // Padding (4 bytes)
+		};
+		// clang-format on
+
+		RtpPacket* packet = RtpPacket::Parse(buffer, sizeof(buffer));
+
+		if (!packet)
+			FAIL("not a RTP packet");
+
+		REQUIRE(packet->GetPayloadLength() == 4);
+		REQUIRE(packet->GetPayloadPadding() == 4);
+
+		static uint8_t RtxBuffer1[MtuSize];
+		static uint8_t RtxBuffer2[MtuSize];
+
+		auto* rtxPacket1 = packet->Clone(RtxBuffer1);
+
+		rtxPacket1->RtxEncode(102, 6, 80);
+
+		auto* rtxPacket2 = packet->RtxClone(RtxBuffer2, 102, 6, 80);
+
+		REQUIRE(rtxPacket2->GetPayloadType() == 102);
+		REQUIRE(rtxPacket2->GetSsrc() == 6);
+		REQUIRE(rtxPacket2->GetSequenceNumber() == 80);
+		REQUIRE(rtxPacket2->GetPayloadLength() == 6);
+		REQUIRE(rtxPacket2->GetPayloadPadding() == 0);
+		REQUIRE(rtxPacket2->GetHeaderExtensionLength() == 12);
+		REQUIRE(rtxPacket2->GetSize() == rtxPacket1->GetSize());
+		REQUIRE(std::memcmp(rtxPacket2->GetData(), rtxPacket1->GetData(), rtxPacket1->GetSize()) == 0);
+
+		// The original packet is untouched.
+		REQUIRE(packet->GetPayloadType() == 1);
+		REQUIRE(packet->GetSequenceNumber() == 8);
+		REQUIRE(packet->GetPayloadLength() == 4);
+		REQUIRE(packet->GetPayloadPadding() == 4);
+
+		rtxPacket2->RtxDecode(1, 5);
+
+		REQUIRE(rtxPacket2->GetSequenceNumber() == 8);
+		REQUIRE(rtxPacket2->GetPayloadLength() == 4);
+		REQUIRE(rtxPacket2->GetPayload()[0] == 0x11);
+
+		delete rtxPacket1;
+		delete rtxPacket2;
+		delete packet;
+	}
+
 	SECTION("create RtpPacket and apply payload shift to it")
 	{
 		// clang-format off
@@ -796,6 +866,148 @@ SCENARIO("parse RTP packets", "[parser][rtp]")
 		delete packet;
 	}
 
+	SECTION("update MID and Transport-Wide-CC-01 extensions")
+	{
+		// clang-format off
+		uint8_t buffer[] =
+		{
+			0b10000000, 0b00000001, 0, 8,
+			0, 0, 0, 4,
+			0, 0, 0, 5,
+			0x11, 0x22, 0x33, 0x44, // Payload
+			// Extra buffer
+			0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00
+		};
+		uint8_t buffer2[64];
+		// clang-format on
+
+		RtpPacket* packet = RtpPacket::Parse(buffer, 16);
+		std::vector<RTC::RtpPacket::GenericExtension> extensions;
+		uint8_t midValue[RTC::MidMaxLength] = { 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h' };
+		uint8_t wideSeqNumberValue[] = { 0x00, 0x00 };
+		std::string mid;
+		uint16_t wideSeqNumber;
+
+		if (!packet)
+			FAIL("not a RTP packet");
+
+		extensions.emplace_back(1, RTC::MidMaxLength, midValue);
+		extensions.emplace_back(2, 2, wideSeqNumberValue);
+
+		packet->SetExtensions(1, extensions);
+		packet->SetMidExtensionId(1);
+		packet->SetTransportWideCc01ExtensionId(2);
+
+		REQUIRE(packet->ReadMid(mid) == true);
+		REQUIRE(mid == "abcdefgh");
+		REQUIRE(packet->UpdateMid("xy") == true);
+		REQUIRE(packet->ReadMid(mid) == true);
+		REQUIRE(mid == "xy");
+
+		absl::string_view midView;
+
+		REQUIRE(packet->ReadMid(midView) == true);
+		REQUIRE(midView == "xy");
+		REQUIRE(reinterpret_cast<const uint8_t*>(midView.data()) == packet->GetHeaderExtensionValue() + 1);
+		// One-Byte extension element header with the new length.
+		REQUIRE(packet->GetHeaderExtensionValue()[0] == 0x11);
+		REQUIRE(packet->UpdateTransportWideCc01(1234) == true);
+		REQUIRE(packet->ReadTransportWideCc01(wideSeqNumber) == true);
+		REQUIRE(wideSeqNumber == 1234);
+		REQUIRE(packet->UpdateMid("too long mid value") == false);
+
+		// Extensions of the cloned packet are parsed from the updated packet.
+		auto* clonedPacket = packet->Clone(buffer2);
+
+		REQUIRE(clonedPacket->ReadMid(mid) == true);
+		REQUIRE(mid == "xy");
+		REQUIRE(clonedPacket->ReadTransportWideCc01(wideSeqNumber) == true);
+		REQUIRE(wideSeqNumber == 1234);
+
+		delete clonedPacket;
+		delete packet;
+	}
+
+	SECTION("map One-Byte extension ids in place")
+	{
+		// clang-format off
+		uint8_t buffer[] =
+		{
+			0b10010000, 0b00000001, 0, 8,
+			0, 0, 0, 4,
+			0, 0, 0, 5,
+			0xBE, 0xDE, 0, 3, // Header Extension
+			0b00110000, 'a', 0, 0, // MID (id 3) "a" and 2 padding bytes
+			0b01010001, 0x12, 0x34, // Transport-Wide-CC-01 (id 5)
+			0b10000010, 0xAA, 0xBB, 0xCC, // abs-send-time (id 8)
+			0
+		};
+		// clang-format on
+
+		RtpPacket* packet = RtpPacket::Parse(buffer, sizeof(buffer));
+
+		if (!packet)
+			FAIL("not a RTP packet");
+
+		uint8_t extenLen;
+
+		REQUIRE(packet->GetExtensionAvailableLength(3) == 3);
+		REQUIRE(packet->GetExtensionAvailableLength(5) == 2);
+		REQUIRE(packet->GetExtensionAvailableLength(8) == 4);
+		REQUIRE(packet->GetExtensionAvailableLength(4) == 0);
+
+		std::array<uint8_t, 15> ids{};
+
+		// Not all extensions are mapped.
+		ids[3] = 1;
+		ids[5] = 5;
+
+		REQUIRE(packet->MapOneByteExtensionIds(ids) == false);
+		REQUIRE(packet->GetExtension(3, extenLen));
+
+		ids[8] = 4;
+
+		REQUIRE(packet->MapOneByteExtensionIds(ids) == true);
+		REQUIRE(!packet->GetExtension(3, extenLen));
+		REQUIRE(!packet->GetExtension(8, extenLen));
+
+		packet->SetMidExtensionId(1);
+		packet->SetTransportWideCc01ExtensionId(5);
+		packet->SetAbsSendTimeExtensionId(4);
+
+		std::string mid;
+		uint16_t wideSeqNumber;
+		uint32_t absSendTime;
+
+		REQUIRE(packet->ReadMid(mid) == true);
+		REQUIRE(mid == "a");
+		REQUIRE(packet->ReadTransportWideCc01(wideSeqNumber) == true);
+		REQUIRE(wideSeqNumber == 0x1234);
+		REQUIRE(packet->ReadAbsSendTime(absSendTime) == true);
+		REQUIRE(absSendTime == 0xAABBCC);
+		REQUIRE(packet->UpdateMid("xyz") == true);
+		REQUIRE(packet->ReadMid(mid) == true);
+		REQUIRE(mid == "xyz");
+
+		// Ids are rewritten in the buffer.
+		auto* reparsedPacket = RtpPacket::Parse(buffer, sizeof(buffer));
+
+		REQUIRE(reparsedPacket);
+		REQUIRE(reparsedPacket->GetExtension(1, extenLen));
+		REQUIRE(extenLen == 3);
+		REQUIRE(reparsedPacket->GetExtension(5, extenLen));
+		REQUIRE(extenLen == 2);
+		REQUIRE(reparsedPacket->GetExtension(4, extenLen));
+		REQUIRE(extenLen == 3);
+
+		delete reparsedPacket;
+		delete packet;
+	}
+
 	SECTION("read frame-marking extension")
 	{
 		// clang-format off
@@ -846,3 +1058,60 @@ SCENARIO("parse RTP packets", "[parser][rtp]")
 		delete packet;
 	}
 }
+
+SCENARIO("RtpPacket hot path", "[rtp][perf]")
+{
+	// clang-format off
+	uint8_t rtpBuffer[] =
+	{
+		0b10000000, 0b01111011, 0b01010010, 0b00001110,
+		0b01011011, 0b01101011, 0b11001010, 0b10110101,
+		0, 0, 0, 2,
+		0x01, 0x02, 0x03, 0x04
+	};
+	// clang-format on
+
+	SECTION("parsing and deleting packets does no heap allocation once the pool is warm")
+	{
+		// Warm the pool.
+		delete RtpPacket::Parse(rtpBuffer, sizeof(rtpBuffer));
+
+		auto hits   = ObjectPool::GetHits();
+		auto misses = ObjectPool::GetMisses();
+
+		AllocationCounter allocationCounter;
+
+		for (uint16_t seq{ 0u }; seq < 1000u; ++seq)
+		{
+			auto* packet = RtpPacket::Parse(rtpBuffer, sizeof(rtpBuffer));
+
+			packet->SetSequenceNumber(seq);
+
+			delete packet;
+		}
+
+		auto allocations = allocationCounter.GetCount();
+
+		REQUIRE(allocations == 0u);
+		REQUIRE(ObjectPool::GetHits() == hits + 1000u);
+		REQUIRE(ObjectPool::GetMisses() == misses);
+	}
+
+	SECTION("a shared clone is a single heap allocation no matter how many times it's taken")
+	{
+		std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(rtpBuffer, sizeof(rtpBuffer)));
+
+		// Warm the pool for the clone.
+		delete packet->Clone(buffer2);
+
+		AllocationCounter allocationCounter;
+
+		auto sharedClone1 = packet->GetSharedClone();
+		auto sharedClone2 = packet->GetSharedClone();
+
+		auto allocations = allocationCounter.GetCount();
+
+		REQUIRE(allocations == 1u);
+		REQUIRE(sharedClone1 == sharedClone2);
+	}
+}
@@ -0,0 +1,91 @@
+#include "common.hpp"
+#include "Utils.hpp"
+#include "RTC/RtpRecorder.hpp"
+#include <catch2/catch.hpp>
+#include <cstdio> // std::remove()
+#include <fstream>
+#include <iterator> // std::istreambuf_iterator
+#include <string>
+#include <vector>
+
+using namespace RTC;
+
+#ifndef _WIN32
+SCENARIO("RtpRecorder", "[rtp][recorder]")
+{
+	std::string path{ "/tmp/mediasoup-worker-test-rtpdump" };
+	std::string fileHeaderLine{ "#!rtpplay1.0 0.0.0.0/0\n" };
+
+	auto readFile = [&path]()
+	{
+		std::ifstream file(path, std::ios::binary);
+
+		return std::vector<uint8_t>(
+		  (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	};
+
+	// clang-format off
+	uint8_t rtpBuffer[] =
+	{
+		0b10000000, 0b01111011, 0b01010010, 0b00001110,
+		0b01011011, 0b01101011, 0b11001010, 0b10110101,
+		0, 0, 0, 2,
+		0x01, 0x02, 0x03, 0x04
+	};
+	uint8_t rtcpBuffer[] =
+	{
+		0x81, 0xc9, 0x00, 0x01,
+		0x00, 0x00, 0x00, 0x02
+	};
+	// clang-format on
+
+	std::remove(path.c_str());
+
+	SECTION("packets are written in rtpdump format once the recorder is destroyed")
+	{
+		{
+			RtpRecorder rtpRecorder(path);
+
+			REQUIRE(rtpRecorder.Record(rtpBuffer, sizeof(rtpBuffer), false));
+			REQUIRE(rtpRecorder.Record(rtcpBuffer, sizeof(rtcpBuffer), true));
+		}
+
+		auto content = readFile();
+		size_t pos   = fileHeaderLine.size() + 16u;
+
+		REQUIRE(content.size() == pos + 8u + sizeof(rtpBuffer) + 8u + sizeof(rtcpBuffer));
+		REQUIRE(
+		  std::string(content.begin(), content.begin() + fileHeaderLine.size()) == fileHeaderLine);
+
+		// RTP packet with its length.
+		REQUIRE(Utils::Byte::Get2Bytes(content.data(), pos) == 8u + sizeof(rtpBuffer));
+		REQUIRE(Utils::Byte::Get2Bytes(content.data(), pos + 2) == sizeof(rtpBuffer));
+		REQUIRE(content[pos + 8u] == rtpBuffer[0]);
+
+		pos += 8u + sizeof(rtpBuffer);
+
+		// RTCP packet with 0 as RTP length.
+		REQUIRE(Utils::Byte::Get2Bytes(content.data(), pos) == 8u + sizeof(rtcpBuffer));
+		REQUIRE(Utils::Byte::Get2Bytes(content.data(), pos + 2) == 0u);
+		REQUIRE(content[pos + 9u] == rtcpBuffer[1]);
+	}
+
+	SECTION("packets bigger than the MTU are dropped")
+	{
+		std::vector<uint8_t> bigPacket(RTC::MtuSize + 1u, 0u);
+
+		RtpRecorder rtpRecorder(path);
+
+		REQUIRE(!rtpRecorder.Record(bigPacket.data(), bigPacket.size(), false));
+
+		json jsonObject = json::object();
+
+		rtpRecorder.FillJsonStats(jsonObject);
+
+		REQUIRE(jsonObject["packets"] == 0u);
+		REQUIRE(jsonObject["droppedPackets"] == 1u);
+	}
+
+	std::remove(path.c_str());
+}
+#endif
@@ -0,0 +1,142 @@
+#include "common.hpp"
+#include "DepLibUV.hpp"
+#include "RTC/RtpPacket.hpp"
+#include "RTC/RtpReorderBuffer.hpp"
+#include <catch2/catch.hpp>
+#include <cstring> // std::memcpy()
+#include <memory>  // std::unique_ptr
+#include <vector>
+
+using namespace RTC;
+
+SCENARIO("RtpReorderBuffer", "[rtp][reorder]")
+{
+	class TestRtpReorderBufferListener : public RtpReorderBuffer::Listener
+	{
+	public:
+		void OnRtpReorderBufferPacket(
+		  RtpReorderBuffer* /*rtpReorderBuffer*/, RtpPacket* packet) override
+		{
+			this->processedSeqs.push_back(packet->GetSequenceNumber());
+		}
+
+	public:
+		std::vector<uint16_t> processedSeqs;
+	};
+
+	// clang-format off
+	uint8_t rtpBuffer[] =
+	{
+		0b10000000, 0b01100100, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 1,
+		0x01, 0x02, 0x03, 0x04
+	};
+	// clang-format on
+
+	TestRtpReorderBufferListener listener;
+
+	// Provides the buffer with a packet as the Producer does, and processes it
+	// if not held.
+	auto receivePacket = [&](RtpReorderBuffer& rtpReorderBuffer, uint16_t seq)
+	{
+		uint8_t buffer[sizeof(rtpBuffer)];
+
+		std::memcpy(buffer, rtpBuffer, sizeof(rtpBuffer));
+
+		// The packet is deleted after this, as the Transport does.
+		std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer, sizeof(buffer)));
+
+		packet->SetSequenceNumber(seq);
+
+		if (rtpReorderBuffer.Insert(packet.get()))
+			return;
+
+		listener.processedSeqs.push_back(seq);
+
+		rtpReorderBuffer.Drain();
+	};
+
+	SECTION("reordered packets are processed in order")
+	{
+		RtpReorderBuffer rtpReorderBuffer(&listener, 20u, true, 0u);
+
+		receivePacket(rtpReorderBuffer, 1000);
+		receivePacket(rtpReorderBuffer, 1003);
+		receivePacket(rtpReorderBuffer, 1002);
+
+		REQUIRE(rtpReorderBuffer.GetNumHeldPackets() == 2u);
+
+		receivePacket(rtpReorderBuffer, 1001);
+
+		REQUIRE(listener.processedSeqs == std::vector<uint16_t>{ 1000, 1001, 1002, 1003 });
+		REQUIRE(rtpReorderBuffer.GetNumHeldPackets() == 0u);
+
+		json jsonObject = json::object();
+
+		rtpReorderBuffer.FillJson(jsonObject);
+
+		REQUIRE(jsonObject["reorderedPackets"] == 1u);
+		REQUIRE(jsonObject["nacksAvoided"] == 1u);
+		REQUIRE(jsonObject["skippedPackets"] == 0u);
+	}
+
+	SECTION("old, duplicated and far ahead packets are not held")
+	{
+		RtpReorderBuffer rtpReorderBuffer(&listener, 20u, false, 0u);
+
+		receivePacket(rtpReorderBuffer, 65535);
+		receivePacket(rtpReorderBuffer, 0);
+		receivePacket(rtpReorderBuffer, 65534);
+		receivePacket(rtpReorderBuffer, 0);
+		receivePacket(rtpReorderBuffer, 2);
+		receivePacket(rtpReorderBuffer, 2);
+
+		REQUIRE(listener.processedSeqs == std::vector<uint16_t>{ 65535, 0, 65534, 0 });
+		REQUIRE(rtpReorderBuffer.GetNumHeldPackets() == 1u);
+
+		// Too far ahead, so the held packet is released first.
+		receivePacket(rtpReorderBuffer, 2 + RtpReorderBuffer::MaxPackets);
+
+		REQUIRE(
+		  listener.processedSeqs ==
+		  std::vector<uint16_t>{ 65535, 0, 65534, 0, 2, 2 + RtpReorderBuffer::MaxPackets });
+		REQUIRE(rtpReorderBuffer.GetNumHeldPackets() == 0u);
+
+		json jsonObject = json::object();
+
+		rtpReorderBuffer.FillJson(jsonObject);
+
+		REQUIRE(jsonObject["reorderedPackets"] == 0u);
+		REQUIRE(jsonObject["skippedPackets"] == RtpReorderBuffer::MaxPackets);
+	}
+
+	SECTION("held packets are released once the delay expires")
+	{
+		RtpReorderBuffer rtpReorderBuffer(&listener, 20u, true, 10u);
+
+		receivePacket(rtpReorderBuffer, 1000);
+		receivePacket(rtpReorderBuffer, 1002);
+		receivePacket(rtpReorderBuffer, 1005);
+
+		REQUIRE(listener.processedSeqs == std::vector<uint16_t>{ 1000 });
+
+		// Must run the loop here to consume the timer before doing the check.
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener.processedSeqs == std::vector<uint16_t>{ 1000, 1002, 1005 });
+
+		// Given up packets are not held anymore.
+		receivePacket(rtpReorderBuffer, 1003);
+		receivePacket(rtpReorderBuffer, 1006);
+
+		REQUIRE(listener.processedSeqs == std::vector<uint16_t>{ 1000, 1002, 1005, 1003, 1006 });
+
+		json jsonObject = json::object();
+
+		rtpReorderBuffer.FillJson(jsonObject);
+
+		REQUIRE(jsonObject["reorderedPackets"] == 0u);
+		REQUIRE(jsonObject["skippedPackets"] == 3u);
+	}
+}
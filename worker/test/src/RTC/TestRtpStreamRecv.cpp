@@ -1,9 +1,11 @@
 #include "common.hpp"
 #include "DepLibUV.hpp"
+#include "Utils.hpp"
 #include "RTC/RtpPacket.hpp"
 #include "RTC/RtpStream.hpp"
 #include "RTC/RtpStreamRecv.hpp"
 #include <catch2/catch.hpp>
+#include <memory> // std::unique_ptr
 #include <vector>
 
 using namespace RTC;
@@ -208,3 +210,196 @@ SCENARIO("receive RTP packets and trigger NACK", "[rtp][rtpstream]")
 
 	delete packet;
 }
+
+SCENARIO("RtpStreamRecv layer bitrates", "[rtp][rtpstream]")
+{
+	// clang-format off
+	uint8_t buffer[] =
+	{
+		0b10000000, 0b00000001, 0, 1,
+		0, 0, 0, 4,
+		0, 0, 0, 5,
+		0, 0, 0, 0
+	};
+	// clang-format on
+
+	std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer, sizeof(buffer)));
+
+	if (!packet)
+		FAIL("not a RTP packet");
+
+	SECTION("accumulated layer bitrates")
+	{
+		// Packets without payload descriptor belong to layer 0:0.
+		RtpStreamRecv::TransmissionCounter counter(2u, 2u, 1000u);
+		auto nowMs = DepLibUV::GetTimeMs();
+
+		counter.Update(packet.get(), nowMs);
+
+		auto bitrate = counter.GetBitrate(nowMs);
+
+		REQUIRE(bitrate > 0u);
+		REQUIRE(counter.GetBitrate(nowMs, 0u, 0u) == bitrate);
+		REQUIRE(counter.GetBitrate(nowMs, 0u, 1u) == 0u);
+		REQUIRE(counter.GetBitrate(nowMs, 1u, 0u) == 0u);
+		REQUIRE(counter.GetLayerBitrate(nowMs, 0u, 0u) == bitrate);
+		REQUIRE(counter.GetLayerBitrate(nowMs, 1u, 1u) == 0u);
+		REQUIRE(counter.GetSpatialLayerBitrate(nowMs, 0u) == bitrate);
+		REQUIRE(counter.GetSpatialLayerBitrate(nowMs, 1u) == 0u);
+	}
+
+	SECTION("bitrate of the packets within the window")
+	{
+		RtpStreamRecv::TransmissionCounter counter(1u, 1u, 1000u);
+		auto nowMs = DepLibUV::GetTimeMs();
+
+		counter.Update(packet.get(), nowMs);
+		counter.Update(packet.get(), nowMs + 500u);
+
+		REQUIRE(counter.GetPacketCount() == 2u);
+		REQUIRE(counter.GetBytes() == 2u * packet->GetSize());
+		// Bytes of both packets over the 1 second window.
+		REQUIRE(counter.GetBitrate(nowMs + 500u) == 2u * packet->GetSize() * 8u);
+		// Just the second packet.
+		REQUIRE(counter.GetBitrate(nowMs + 1200u) == packet->GetSize() * 8u);
+		// None of them.
+		REQUIRE(counter.GetBitrate(nowMs + 2000u) == 0u);
+		REQUIRE(counter.GetPacketCount() == 2u);
+	}
+}
+
+SCENARIO("RtpStream scores", "[rtp][rtpstream]")
+{
+	SECTION("scores of a batch of samples")
+	{
+		// packets, lost, repaired, retransmitted.
+		std::vector<RtpStream::ScoreSample> samples = {
+			{ 100u, 0u, 0u, 0u },   { 100u, 100u, 0u, 0u }, { 100u, 10u, 0u, 0u },
+			{ 100u, 10u, 10u, 10u }, { 100u, 50u, 0u, 0u },  { 100u, 20u, 10u, 20u },
+		};
+		std::vector<uint8_t> scores(samples.size());
+
+		RtpStream::ComputeScores(samples.data(), scores.data(), samples.size());
+
+		REQUIRE(scores[0] == 10u);
+		REQUIRE(scores[1] == 0u);
+		// 0.9 ^ 4 * 10 = 6.56.
+		REQUIRE(scores[2] == 7u);
+		// Repaired packets compensate part of the lost ones.
+		REQUIRE(scores[3] == 9u);
+		// 0.5 ^ 4 * 10 = 0.625.
+		REQUIRE(scores[4] == 1u);
+		REQUIRE(scores[5] == 5u);
+	}
+}
+
+SCENARIO("RtpStreamRecv capture latency", "[rtp][rtpstream]")
+{
+	class RtpStreamRecvListener : public RtpStreamRecv::Listener
+	{
+	public:
+		void OnRtpStreamScore(RtpStream* /*rtpStream*/, uint8_t /*score*/, uint8_t /*previousScore*/) override
+		{
+		}
+
+		void OnRtpStreamSendRtcpPacket(RtpStreamRecv* /*rtpStream*/, RTCP::Packet* /*packet*/) override
+		{
+		}
+
+		void OnRtpStreamNeedWorstRemoteFractionLost(
+		  RTC::RtpStreamRecv* /*rtpStream*/, uint8_t& /*worstRemoteFractionLost*/) override
+		{
+		}
+	};
+
+	// clang-format off
+	uint8_t buffer[] =
+	{
+		0b10010000, 0b00000001, 0, 1,
+		0, 0, 0, 4,
+		0, 0, 0, 5,
+		0xBE, 0xDE, 0, 5, // Header Extension
+		0x1F, 0, 0, 0, // abs-capture-time (16 bytes)
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0, // (3 bytes of padding)
+		1, 2, 3, 4
+	};
+	// clang-format on
+
+	// Captured at 1000 seconds (NTP) in the clock of the sender, whose capture
+	// clock offset is 0.5 seconds.
+	Utils::Byte::Set8Bytes(buffer, 17, uint64_t{ 1000u } << 32);
+	Utils::Byte::Set8Bytes(buffer, 25, uint64_t{ 1u } << 31);
+
+	std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(buffer, sizeof(buffer)));
+
+	if (!packet)
+		FAIL("not a RTP packet");
+
+	packet->SetAbsCaptureTimeExtensionId(1);
+
+	RtpStream::Params params;
+
+	params.ssrc             = packet->GetSsrc();
+	params.clockRate        = 90000;
+	params.mimeType.type    = RtpCodecMimeType::Type::VIDEO;
+	params.mimeType.subtype = RtpCodecMimeType::Subtype::VP8;
+
+	RTCP::SenderReport report;
+
+	report.SetSsrc(params.ssrc);
+	report.SetNtpSec(1000u);
+	report.SetNtpFrac(0u);
+
+	uint64_t absCaptureTimestamp;
+	int64_t estimatedCaptureClockOffset;
+
+	DepLibUV::SetVirtualTimeNs(10000000000u);
+
+	SECTION("latency is measured with the Sender Report clock mapping")
+	{
+		RtpStreamRecvListener listener;
+		RtpStreamRecv rtpStream(&listener, params, SendNackDelay);
+		json jsonObject = json::object();
+
+		// Sender Report received at 10000 ms (worker clock).
+		rtpStream.ReceiveRtcpSenderReport(std::addressof(report));
+
+		DepLibUV::SetVirtualTimeNs(10580000000u);
+
+		rtpStream.ReceivePacket(packet.get());
+		rtpStream.FillJsonStats(jsonObject);
+
+		REQUIRE(jsonObject["captureLatency"]["count"] == 1u);
+		REQUIRE(jsonObject["captureLatency"]["max"] == 80u);
+
+		// The capture time refers to the worker clock (10500 ms) now.
+		REQUIRE(packet->ReadAbsCaptureTime(absCaptureTimestamp, estimatedCaptureClockOffset));
+		REQUIRE(absCaptureTimestamp == ((uint64_t{ 10u } << 32) | (uint64_t{ 1u } << 31)));
+		REQUIRE(estimatedCaptureClockOffset == 0);
+	}
+
+	SECTION("nothing is measured without Sender Report")
+	{
+		RtpStreamRecvListener listener;
+		RtpStreamRecv rtpStream(&listener, params, SendNackDelay);
+		json jsonObject = json::object();
+
+		rtpStream.ReceivePacket(packet.get());
+		rtpStream.FillJsonStats(jsonObject);
+
+		REQUIRE(jsonObject.find("captureLatency") == jsonObject.end());
+
+		// The extension is untouched.
+		REQUIRE(packet->ReadAbsCaptureTime(absCaptureTimestamp, estimatedCaptureClockOffset));
+		REQUIRE(absCaptureTimestamp == (uint64_t{ 1000u } << 32));
+		REQUIRE(estimatedCaptureClockOffset == (int64_t{ 1 } << 31));
+	}
+
+	DepLibUV::SetVirtualTimeNs(0u);
+
+	// Must run the loop to wait for UV timers and close them.
+	DepLibUV::RunLoop();
+}
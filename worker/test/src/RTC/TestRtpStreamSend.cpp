@@ -1,9 +1,12 @@
 #include "common.hpp"
+#include "AllocationCounter.hpp"
+#include "Utils.hpp"
 #include "RTC/RTCP/FeedbackRtpNack.hpp"
 #include "RTC/RtpPacket.hpp"
 #include "RTC/RtpStream.hpp"
 #include "RTC/RtpStreamSend.hpp"
 #include <catch2/catch.hpp>
+#include <memory> // std::unique_ptr
 #include <vector>
 
 using namespace RTC;
@@ -17,13 +20,20 @@ SCENARIO("NACK and RTP packets retransmission", "[rtp][rtcp]")
 		{
 		}
 
-		void OnRtpStreamRetransmitRtpPacket(RtpStreamSend* /*rtpStream*/, RtpPacket* packet) override
+		void OnRtpStreamRetransmitRtpPackets(
+		  RtpStreamSend* /*rtpStream*/, RtpPacket** packets, size_t count) override
+		{
+			this->retransmittedPackets.insert(this->retransmittedPackets.end(), packets, packets + count);
+			this->retransmissionBatches++;
+		}
+
+		void OnRtpStreamSendFecPacket(RtpStreamSend* /*rtpStream*/, RtpPacket* /*packet*/) override
 		{
-			this->retransmittedPackets.push_back(packet);
 		}
 
 	public:
 		std::vector<RtpPacket*> retransmittedPackets;
+		size_t retransmissionBatches{ 0u };
 	};
 
 	TestRtpStreamListener testRtpStreamListener;
@@ -150,4 +160,573 @@ SCENARIO("NACK and RTP packets retransmission", "[rtp][rtcp]")
 		delete packet5;
 		delete stream;
 	}
+
+	SECTION("streams sending the same packet share its storage")
+	{
+		// clang-format off
+		uint8_t rtpBuffer[] =
+		{
+			0b10000000, 0b01111011, 0b01010010, 0b00001110,
+			0b01011011, 0b01101011, 0b11001010, 0b10110101,
+			0, 0, 0, 2,
+			0x11, 0x22, 0x33, 0x44
+		};
+		// clang-format on
+
+		// packet [pt:123, seq:21006, timestamp:1533790901, ssrc:2]
+		RtpPacket* packet = RtpPacket::Parse(rtpBuffer, sizeof(rtpBuffer));
+
+		REQUIRE(packet);
+
+		RtpStream::Params params1;
+
+		params1.ssrc      = 1111;
+		params1.clockRate = 90000;
+		params1.useNack   = true;
+
+		RtpStream::Params params2;
+
+		params2.ssrc      = 2222;
+		params2.clockRate = 90000;
+		params2.useNack   = true;
+
+		RtpStreamSend* stream1 = new RtpStreamSend(&testRtpStreamListener, params1, 4);
+		RtpStreamSend* stream2 = new RtpStreamSend(&testRtpStreamListener, params2, 4);
+
+		// Send the packet with different values in each stream (as Consumers do).
+		packet->SetSsrc(1111);
+		packet->SetSequenceNumber(1000);
+		stream1->ReceivePacket(packet);
+
+		packet->SetSsrc(2222);
+		packet->SetSequenceNumber(2000);
+		packet->GetPayload()[0] = 0x99;
+		stream2->ReceivePacket(packet);
+
+		auto sharedClone = packet->GetSharedClone();
+
+		// The packet was cloned just once.
+		REQUIRE(sharedClone.use_count() == 4);
+
+		RTCP::FeedbackRtpNackPacket nackPacket1(0, params1.ssrc);
+
+		nackPacket1.AddItem(new RTCP::FeedbackRtpNackItem(1000, 0b0000000000000000));
+		stream1->ReceiveNack(&nackPacket1);
+
+		REQUIRE(testRtpStreamListener.retransmittedPackets.size() == 1);
+
+		auto* rtxPacket1 = testRtpStreamListener.retransmittedPackets[0];
+
+		// Without RTX the stored packet itself is retransmitted.
+		REQUIRE(rtxPacket1 == sharedClone.get());
+		REQUIRE(rtxPacket1->GetSsrc() == 1111);
+		REQUIRE(rtxPacket1->GetSequenceNumber() == 1000);
+		REQUIRE(rtxPacket1->GetTimestamp() == 1533790901);
+		REQUIRE(rtxPacket1->GetPayload()[0] == 0x11);
+
+		testRtpStreamListener.retransmittedPackets.clear();
+
+		RTCP::FeedbackRtpNackPacket nackPacket2(0, params2.ssrc);
+
+		nackPacket2.AddItem(new RTCP::FeedbackRtpNackItem(2000, 0b0000000000000000));
+		stream2->ReceiveNack(&nackPacket2);
+
+		REQUIRE(testRtpStreamListener.retransmittedPackets.size() == 1);
+
+		auto* rtxPacket2 = testRtpStreamListener.retransmittedPackets[0];
+
+		REQUIRE(rtxPacket2 == sharedClone.get());
+		REQUIRE(rtxPacket2->GetSsrc() == 2222);
+		REQUIRE(rtxPacket2->GetSequenceNumber() == 2000);
+		REQUIRE(rtxPacket2->GetTimestamp() == 1533790901);
+		REQUIRE(rtxPacket2->GetPayload()[0] == 0x99);
+
+		testRtpStreamListener.retransmittedPackets.clear();
+
+		// Clean stuff.
+		delete stream1;
+		delete stream2;
+
+		REQUIRE(sharedClone.use_count() == 2);
+
+		delete packet;
+
+		REQUIRE(sharedClone.use_count() == 1);
+	}
+
+	SECTION("storage limit drops stored packets")
+	{
+		// clang-format off
+		uint8_t rtpBuffer[] =
+		{
+			0b10000000, 0b01111011, 0b01010010, 0b00001110,
+			0b01011011, 0b01101011, 0b11001010, 0b10110101,
+			0, 0, 0, 2
+		};
+		// clang-format on
+
+		// packet [pt:123, seq:21006, timestamp:1533790901, ssrc:2]
+		RtpPacket* packet = RtpPacket::Parse(rtpBuffer, sizeof(rtpBuffer));
+
+		REQUIRE(packet);
+
+		RtpStream::Params params;
+
+		params.ssrc      = packet->GetSsrc();
+		params.clockRate = 90000;
+		params.useNack   = true;
+
+		RtpStreamSend* stream = new RtpStreamSend(&testRtpStreamListener, params, 4);
+
+		auto emptyMemoryUsage = stream->GetMemoryUsage();
+
+		for (uint16_t seq{ 1000u }; seq < 1004u; ++seq)
+		{
+			packet->SetSequenceNumber(seq);
+			packet->SetTimestamp(1533790901 + seq);
+			stream->ReceivePacket(packet);
+		}
+
+		auto fullMemoryUsage = stream->GetMemoryUsage();
+
+		REQUIRE(fullMemoryUsage > emptyMemoryUsage);
+
+		// There are more stored packets than the limit, so the oldest ones are
+		// dropped.
+		stream->SetStorageLimit(2);
+
+		REQUIRE(stream->GetMemoryUsage() < fullMemoryUsage);
+		REQUIRE(stream->GetMemoryUsage() > emptyMemoryUsage);
+
+		for (uint16_t seq{ 1004u }; seq < 1007u; ++seq)
+		{
+			packet->SetSequenceNumber(seq);
+			packet->SetTimestamp(1533790901 + seq);
+			stream->ReceivePacket(packet);
+		}
+
+		RTCP::FeedbackRtpNackPacket nackPacket(0, params.ssrc);
+
+		nackPacket.AddItem(new RTCP::FeedbackRtpNackItem(1000, 0b0000000000111111));
+		stream->ReceiveNack(&nackPacket);
+
+		// Just the last 2 packets are stored.
+		REQUIRE(testRtpStreamListener.retransmittedPackets.size() == 2);
+		REQUIRE(testRtpStreamListener.retransmittedPackets[0]->GetSequenceNumber() == 1005);
+		REQUIRE(testRtpStreamListener.retransmittedPackets[1]->GetSequenceNumber() == 1006);
+
+		testRtpStreamListener.retransmittedPackets.clear();
+
+		// Clean stuff.
+		delete stream;
+		delete packet;
+	}
+
+	SECTION("packets too far from the newest one are dropped")
+	{
+		// clang-format off
+		uint8_t rtpBuffer[] =
+		{
+			0b10000000, 0b01111011, 0b01010010, 0b00001110,
+			0b01011011, 0b01101011, 0b11001010, 0b10110101,
+			0, 0, 0, 2
+		};
+		// clang-format on
+
+		// packet [pt:123, seq:21006, timestamp:1533790901, ssrc:2]
+		RtpPacket* packet = RtpPacket::Parse(rtpBuffer, sizeof(rtpBuffer));
+
+		REQUIRE(packet);
+
+		RtpStream::Params params;
+
+		params.ssrc      = packet->GetSsrc();
+		params.clockRate = 90000;
+		params.useNack   = true;
+
+		// Packets are indexed by seq modulo 8.
+		RtpStreamSend* stream = new RtpStreamSend(&testRtpStreamListener, params, 4);
+
+		packet->SetSequenceNumber(1000);
+		stream->ReceivePacket(packet);
+
+		packet->SetSequenceNumber(1020);
+		stream->ReceivePacket(packet);
+
+		// Older than the stored one and too far from it.
+		packet->SetSequenceNumber(1010);
+		stream->ReceivePacket(packet);
+
+		RTCP::FeedbackRtpNackPacket nackPacket(0, params.ssrc);
+
+		nackPacket.AddItem(new RTCP::FeedbackRtpNackItem(1000, 0b0000000000000000));
+		nackPacket.AddItem(new RTCP::FeedbackRtpNackItem(1010, 0b0000001000000000));
+		stream->ReceiveNack(&nackPacket);
+
+		REQUIRE(testRtpStreamListener.retransmittedPackets.size() == 1);
+		REQUIRE(testRtpStreamListener.retransmittedPackets[0]->GetSequenceNumber() == 1020);
+
+		testRtpStreamListener.retransmittedPackets.clear();
+
+		// Clean stuff.
+		delete stream;
+		delete packet;
+	}
+
+	SECTION("packets requested by all the NACK items are retransmitted in batches")
+	{
+		// clang-format off
+		uint8_t rtpBuffer[] =
+		{
+			0b10000000, 0b01111011, 0b01010010, 0b00001110,
+			0b01011011, 0b01101011, 0b11001010, 0b10110101,
+			0, 0, 0, 2
+		};
+		// clang-format on
+
+		// packet [pt:123, seq:21006, timestamp:1533790901, ssrc:2]
+		RtpPacket* packet = RtpPacket::Parse(rtpBuffer, sizeof(rtpBuffer));
+
+		REQUIRE(packet);
+
+		RtpStream::Params params;
+
+		params.ssrc      = packet->GetSsrc();
+		params.clockRate = 90000;
+		params.useNack   = true;
+
+		RtpStreamSend* stream = new RtpStreamSend(&testRtpStreamListener, params, 256);
+
+		for (uint16_t seq{ 1000u }; seq < 1200u; ++seq)
+		{
+			packet->SetSequenceNumber(seq);
+			stream->ReceivePacket(packet);
+		}
+
+		// 4 items requesting 17 packets each fit into a single batch.
+		RTCP::FeedbackRtpNackPacket nackPacket1(0, params.ssrc);
+
+		nackPacket1.AddItem(new RTCP::FeedbackRtpNackItem(1000, 0b1111111111111111));
+		nackPacket1.AddItem(new RTCP::FeedbackRtpNackItem(1017, 0b1111111111111111));
+		nackPacket1.AddItem(new RTCP::FeedbackRtpNackItem(1034, 0b1111111111111111));
+		nackPacket1.AddItem(new RTCP::FeedbackRtpNackItem(1051, 0b1111111111111111));
+		stream->ReceiveNack(&nackPacket1);
+
+		REQUIRE(testRtpStreamListener.retransmissionBatches == 1);
+		REQUIRE(testRtpStreamListener.retransmittedPackets.size() == 68);
+
+		for (size_t idx{ 0u }; idx < 68; ++idx)
+		{
+			REQUIRE(testRtpStreamListener.retransmittedPackets[idx]->GetSequenceNumber() == 1000 + idx);
+		}
+
+		testRtpStreamListener.retransmittedPackets.clear();
+		testRtpStreamListener.retransmissionBatches = 0;
+
+		// A fifth item goes into another batch.
+		RTCP::FeedbackRtpNackPacket nackPacket2(0, params.ssrc);
+
+		nackPacket2.AddItem(new RTCP::FeedbackRtpNackItem(1068, 0b1111111111111111));
+		nackPacket2.AddItem(new RTCP::FeedbackRtpNackItem(1085, 0b1111111111111111));
+		nackPacket2.AddItem(new RTCP::FeedbackRtpNackItem(1102, 0b1111111111111111));
+		nackPacket2.AddItem(new RTCP::FeedbackRtpNackItem(1119, 0b1111111111111111));
+		nackPacket2.AddItem(new RTCP::FeedbackRtpNackItem(1136, 0b0000000000000000));
+		stream->ReceiveNack(&nackPacket2);
+
+		REQUIRE(testRtpStreamListener.retransmissionBatches == 2);
+		REQUIRE(testRtpStreamListener.retransmittedPackets.size() == 69);
+		// Packets of the last batch are still valid.
+		REQUIRE(testRtpStreamListener.retransmittedPackets[68]->GetSequenceNumber() == 1136);
+
+		testRtpStreamListener.retransmittedPackets.clear();
+
+		// Clean stuff.
+		delete stream;
+		delete packet;
+	}
+
+	SECTION("RTX padding packets are taken from the stored ones")
+	{
+		// clang-format off
+		uint8_t rtpBuffer[] =
+		{
+			0b10000000, 0b01111011, 0b01010010, 0b00001110,
+			0b01011011, 0b01101011, 0b11001010, 0b10110101,
+			0, 0, 0, 2
+		};
+		// clang-format on
+
+		// packet [pt:123, seq:21006, timestamp:1533790901, ssrc:2]
+		RtpPacket* packet = RtpPacket::Parse(rtpBuffer, sizeof(rtpBuffer));
+
+		REQUIRE(packet);
+
+		RtpStream::Params params;
+
+		params.ssrc      = packet->GetSsrc();
+		params.clockRate = 90000;
+		params.useNack   = true;
+		params.mimeType.SetMimeType("video/VP8");
+
+		RtpStreamSend* stream = new RtpStreamSend(&testRtpStreamListener, params, 256);
+
+		// No stored packets.
+		stream->SetRtx(96, 1234);
+
+		REQUIRE(stream->GetRtxPaddingPacket(1000) == nullptr);
+
+		packet->SetSequenceNumber(1000);
+		stream->ReceivePacket(packet);
+		packet->SetSequenceNumber(1001);
+		stream->ReceivePacket(packet);
+
+		// All stored packets have the same size so the newest one is taken.
+		auto* paddingPacket1 = stream->GetRtxPaddingPacket(1000);
+
+		REQUIRE(paddingPacket1);
+		REQUIRE(paddingPacket1->GetSsrc() == 1234);
+		REQUIRE(paddingPacket1->GetPayloadType() == 96);
+		REQUIRE(paddingPacket1->GetPayloadLength() == 2);
+		REQUIRE(Utils::Byte::Get2Bytes(paddingPacket1->GetPayload(), 0) == 1001);
+
+		auto rtxSeq = paddingPacket1->GetSequenceNumber();
+
+		// RTX seq is incremented on every padding packet.
+		auto* paddingPacket2 = stream->GetRtxPaddingPacket(1000);
+
+		REQUIRE(paddingPacket2);
+		REQUIRE(paddingPacket2->GetSequenceNumber() == static_cast<uint16_t>(rtxSeq + 1));
+
+		// Stored packets are not marked as retransmitted.
+		REQUIRE(testRtpStreamListener.retransmittedPackets.empty());
+
+		// Clean stuff.
+		delete stream;
+		delete packet;
+	}
+}
+
+SCENARIO("RTCP Sender Reports and SDES of RtpStreamSend", "[rtp][rtcp]")
+{
+	class TestRtpStreamListener : public RtpStreamSend::Listener
+	{
+	public:
+		void OnRtpStreamScore(RtpStream* /*rtpStream*/, uint8_t /*score*/, uint8_t /*previousScore*/) override
+		{
+		}
+
+		void OnRtpStreamRetransmitRtpPackets(
+		  RtpStreamSend* /*rtpStream*/, RtpPacket** /*packets*/, size_t /*count*/) override
+		{
+		}
+
+		void OnRtpStreamSendFecPacket(RtpStreamSend* /*rtpStream*/, RtpPacket* /*packet*/) override
+		{
+		}
+	};
+
+	TestRtpStreamListener testRtpStreamListener;
+
+	// clang-format off
+	uint8_t rtpBuffer[] =
+	{
+		0b10000000, 0b01111011, 0b01010010, 0b00001110,
+		0b01011011, 0b01101011, 0b11001010, 0b10110101,
+		0, 0, 0, 2
+	};
+	// clang-format on
+
+	SECTION("no Sender Report is generated for idle streams")
+	{
+		// packet [pt:123, seq:21006, timestamp:1533790901, ssrc:2]
+		RtpPacket* packet = RtpPacket::Parse(rtpBuffer, sizeof(rtpBuffer));
+
+		REQUIRE(packet);
+
+		RtpStream::Params params;
+
+		params.ssrc      = packet->GetSsrc();
+		params.clockRate = 90000;
+
+		RtpStreamSend* stream = new RtpStreamSend(&testRtpStreamListener, params, 0);
+
+		// Nothing sent yet.
+		REQUIRE(!stream->HasSentSinceLastSenderReport());
+		REQUIRE(!stream->GetRtcpSenderReport(1000u));
+
+		stream->ReceivePacket(packet);
+
+		REQUIRE(stream->HasSentSinceLastSenderReport());
+
+		auto* report = stream->GetRtcpSenderReport(1000u);
+
+		REQUIRE(report);
+		REQUIRE(report->GetPacketCount() == 1u);
+
+		delete report;
+
+		// Nothing sent since the last Sender Report.
+		REQUIRE(!stream->HasSentSinceLastSenderReport());
+		REQUIRE(!stream->GetRtcpSenderReport(2000u));
+
+		packet->SetSequenceNumber(21007);
+		stream->ReceivePacket(packet);
+
+		report = stream->GetRtcpSenderReport(3000u);
+
+		REQUIRE(report);
+		REQUIRE(report->GetPacketCount() == 2u);
+
+		delete report;
+
+		// Clean stuff.
+		delete stream;
+		delete packet;
+	}
+
+	SECTION("SDES chunk is sent from time to time with reduced-size RTCP")
+	{
+		RtpStream::Params params;
+
+		params.ssrc            = 2u;
+		params.clockRate       = 90000;
+		params.cname           = "qwerty";
+		params.rtcpReducedSize = true;
+
+		RtpStreamSend* stream = new RtpStreamSend(&testRtpStreamListener, params, 0);
+
+		auto* sdesChunk = stream->GetRtcpSdesChunk(1000u);
+
+		REQUIRE(sdesChunk);
+		REQUIRE(sdesChunk->GetSsrc() == 2u);
+
+		delete sdesChunk;
+
+		REQUIRE(!stream->GetRtcpSdesChunk(2000u));
+		REQUIRE(!stream->GetRtcpSdesChunk(1000u + RTCP::MaxReducedSizeSdesIntervalMs - 1u));
+
+		sdesChunk = stream->GetRtcpSdesChunk(1000u + RTCP::MaxReducedSizeSdesIntervalMs);
+
+		REQUIRE(sdesChunk);
+
+		delete sdesChunk;
+
+		// Without reduced-size RTCP it is always sent.
+		params.rtcpReducedSize = false;
+
+		RtpStreamSend* stream2 = new RtpStreamSend(&testRtpStreamListener, params, 0);
+
+		sdesChunk = stream2->GetRtcpSdesChunk(1000u);
+
+		REQUIRE(sdesChunk);
+
+		delete sdesChunk;
+
+		sdesChunk = stream2->GetRtcpSdesChunk(1001u);
+
+		REQUIRE(sdesChunk);
+
+		delete sdesChunk;
+
+		// Clean stuff.
+		delete stream;
+		delete stream2;
+	}
+}
+
+SCENARIO("RtpStreamSend hot path", "[rtp][perf]")
+{
+	class TestRtpStreamListener : public RtpStreamSend::Listener
+	{
+	public:
+		void OnRtpStreamScore(RtpStream* /*rtpStream*/, uint8_t /*score*/, uint8_t /*previousScore*/) override
+		{
+		}
+
+		void OnRtpStreamRetransmitRtpPackets(
+		  RtpStreamSend* /*rtpStream*/, RtpPacket** /*packets*/, size_t /*count*/) override
+		{
+		}
+
+		void OnRtpStreamSendFecPacket(RtpStreamSend* /*rtpStream*/, RtpPacket* /*packet*/) override
+		{
+		}
+	};
+
+	// clang-format off
+	uint8_t rtpBuffer[] =
+	{
+		0b10000000, 0b01111011, 0b01010010, 0b00001110,
+		0b01011011, 0b01101011, 0b11001010, 0b10110101,
+		0, 0, 0, 2,
+		0x01, 0x02, 0x03, 0x04
+	};
+	// clang-format on
+
+	TestRtpStreamListener testRtpStreamListener;
+	RtpStream::Params params;
+
+	params.ssrc      = 2;
+	params.clockRate = 90000;
+	params.useNack   = true;
+
+	// Receives a new packet (as the Transport provides it) in the given streams.
+	auto receivePacket = [&](const std::vector<RtpStreamSend*>& streams, uint16_t seq)
+	{
+		std::unique_ptr<RtpPacket> packet(RtpPacket::Parse(rtpBuffer, sizeof(rtpBuffer)));
+
+		packet->SetSequenceNumber(seq);
+		packet->SetTimestamp(seq * 3000u);
+
+		for (auto* stream : streams)
+		{
+			stream->ReceivePacket(packet.get());
+		}
+	};
+
+	SECTION("receiving packets without retransmission buffer does no heap allocation")
+	{
+		RtpStreamSend stream(&testRtpStreamListener, params, 0u);
+		std::vector<RtpStreamSend*> streams{ &stream };
+
+		// Warm the stream and the pool.
+		receivePacket(streams, 1000u);
+
+		AllocationCounter allocationCounter;
+
+		for (uint16_t seq{ 1001u }; seq < 2000u; ++seq)
+		{
+			receivePacket(streams, seq);
+		}
+
+		auto allocations = allocationCounter.GetCount();
+
+		REQUIRE(allocations == 0u);
+	}
+
+	SECTION("packets stored by several streams are allocated once in steady state")
+	{
+		RtpStreamSend stream1(&testRtpStreamListener, params, 100u);
+		RtpStreamSend stream2(&testRtpStreamListener, params, 100u);
+		RtpStreamSend stream3(&testRtpStreamListener, params, 100u);
+		std::vector<RtpStreamSend*> streams{ &stream1, &stream2, &stream3 };
+
+		// Fill the buffers so their storage items are allocated.
+		for (uint16_t seq{ 1000u }; seq < 1200u; ++seq)
+		{
+			receivePacket(streams, seq);
+		}
+
+		AllocationCounter allocationCounter;
+
+		for (uint16_t seq{ 1200u }; seq < 2200u; ++seq)
+		{
+			receivePacket(streams, seq);
+		}
+
+		auto allocations = allocationCounter.GetCount();
+
+		// Just the shared clone of each packet.
+		REQUIRE(allocations == 1000u);
+	}
 }
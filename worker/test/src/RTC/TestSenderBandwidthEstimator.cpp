@@ -0,0 +1,210 @@
+#include "common.hpp"
+#include "RTC/RTCP/FeedbackRtpTransport.hpp"
+#include "RTC/SenderBandwidthEstimator.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm> // std::max()
+#include <deque>
+
+using namespace RTC;
+
+namespace
+{
+	class TestSenderBandwidthEstimatorListener : public SenderBandwidthEstimator::Listener
+	{
+	public:
+		void OnSenderBandwidthEstimatorAvailableBitrate(
+		  SenderBandwidthEstimator* /*senderBwe*/,
+		  uint32_t availableBitrate,
+		  uint32_t /*previousAvailableBitrate*/) override
+		{
+			this->availableBitrate = availableBitrate;
+		}
+
+	public:
+		uint32_t availableBitrate{ 0u };
+	};
+
+	/**
+	 * Sends packets at the estimated bitrate (up to maxSendBitrate) through a
+	 * bottleneck link with a FIFO queue, and gives the estimator a transport-cc
+	 * feedback of the arrived packets every 100 ms.
+	 */
+	class Simulation
+	{
+	private:
+		struct InFlightPacket
+		{
+			uint16_t wideSeq{ 0u };
+			uint64_t arrivalAtMs{ 0u };
+			bool lost{ false };
+		};
+
+	public:
+		static constexpr uint32_t PacketSize{ 1200u };
+		static constexpr uint64_t FeedbackIntervalMs{ 100u };
+		static constexpr uint64_t PropagationDelayMs{ 20u };
+
+	public:
+		explicit Simulation(SenderBandwidthEstimator& senderBwe) : senderBwe(senderBwe)
+		{
+		}
+
+	public:
+		// Drops one of each lossInterval packets if not 0.
+		void Run(
+		  uint64_t durationMs, uint32_t linkCapacity, uint32_t maxSendBitrate, size_t lossInterval = 0u)
+		{
+			for (uint64_t endMs = this->nowMs + durationMs; this->nowMs < endMs; ++this->nowMs)
+			{
+				const auto sendBitrate = std::min(this->senderBwe.GetAvailableBitrate(), maxSendBitrate);
+
+				this->budget += sendBitrate / 1000.0;
+
+				while (this->budget >= PacketSize * 8)
+				{
+					this->budget -= PacketSize * 8;
+
+					Send(linkCapacity, lossInterval);
+				}
+
+				if (this->nowMs % FeedbackIntervalMs == 0u)
+					SendFeedback();
+			}
+		}
+
+	private:
+		void Send(uint32_t linkCapacity, size_t lossInterval)
+		{
+			SenderBandwidthEstimator::SentInfo sentInfo;
+
+			sentInfo.sentAtMs = this->nowMs;
+			sentInfo.size     = PacketSize;
+			sentInfo.wideSeq  = ++this->wideSeq;
+
+			this->senderBwe.RtpPacketSent(sentInfo);
+
+			const double transmissionUs = PacketSize * 8 * 1000000.0 / linkCapacity;
+
+			this->linkFreeAtUs = std::max(this->linkFreeAtUs, this->nowMs * 1000.0) + transmissionUs;
+
+			InFlightPacket packet;
+
+			packet.wideSeq     = sentInfo.wideSeq;
+			packet.arrivalAtMs = static_cast<uint64_t>(this->linkFreeAtUs / 1000) + PropagationDelayMs;
+			packet.lost        = lossInterval != 0u && this->wideSeq % lossInterval == 0u;
+
+			this->inFlightPackets.push_back(packet);
+		}
+
+		void SendFeedback()
+		{
+			RTCP::FeedbackRtpTransportPacket feedback(0u, 0u);
+			bool empty{ true };
+
+			while (!this->inFlightPackets.empty())
+			{
+				const auto& packet = this->inFlightPackets.front();
+
+				if (packet.arrivalAtMs > this->nowMs)
+					break;
+
+				// The first added packet just sets the base of the feedback.
+				if (empty)
+				{
+					feedback.AddPacket(
+					  static_cast<uint16_t>(packet.wideSeq - 1u), packet.arrivalAtMs, 1500u);
+
+					empty = false;
+				}
+
+				if (!packet.lost)
+					feedback.AddPacket(packet.wideSeq, packet.arrivalAtMs, 1500u);
+
+				this->inFlightPackets.pop_front();
+			}
+
+			if (empty)
+				return;
+
+			feedback.Finish();
+
+			this->senderBwe.ReceiveRtcpTransportFeedback(&feedback, this->nowMs);
+		}
+
+	private:
+		SenderBandwidthEstimator& senderBwe;
+		uint64_t nowMs{ 1000u };
+		uint16_t wideSeq{ 0u };
+		double budget{ 0 };
+		double linkFreeAtUs{ 0 };
+		std::deque<InFlightPacket> inFlightPackets;
+	};
+} // namespace
+
+SCENARIO("SenderBandwidthEstimator", "[rtc][bwe]")
+{
+	TestSenderBandwidthEstimatorListener listener;
+	SenderBandwidthEstimator senderBwe(&listener, 300000u);
+	Simulation simulation(senderBwe);
+
+	senderBwe.TransportConnected();
+
+	REQUIRE(senderBwe.GetAvailableBitrate() == 300000u);
+
+	SECTION("estimate converges to the link capacity and follows it down")
+	{
+		simulation.Run(30000u, 1000000u, 10000000u);
+
+		REQUIRE(listener.availableBitrate == senderBwe.GetAvailableBitrate());
+		REQUIRE(senderBwe.GetAvailableBitrate() >= 700000u);
+		REQUIRE(senderBwe.GetAvailableBitrate() <= 1200000u);
+		REQUIRE(!senderBwe.IsInAlr());
+
+		simulation.Run(10000u, 500000u, 10000000u);
+
+		REQUIRE(senderBwe.GetAvailableBitrate() >= 300000u);
+		REQUIRE(senderBwe.GetAvailableBitrate() <= 650000u);
+	}
+
+	SECTION("estimate decreases on high packet loss")
+	{
+		simulation.Run(5000u, 10000000u, 10000000u);
+
+		const auto availableBitrate = senderBwe.GetAvailableBitrate();
+
+		// Drop 1 of each 4 packets.
+		simulation.Run(5000u, 10000000u, 10000000u, 4u);
+
+		REQUIRE(senderBwe.GetPacketLoss() > 0.1);
+		REQUIRE(senderBwe.GetAvailableBitrate() < availableBitrate / 2);
+	}
+
+	SECTION("estimate does not increase while application limited")
+	{
+		simulation.Run(10000u, 10000000u, 100000u);
+
+		REQUIRE(senderBwe.IsInAlr());
+		// It may increase a bit until the send bitrate is known.
+		REQUIRE(senderBwe.GetAvailableBitrate() <= 330000u);
+	}
+
+	SECTION("estimate is capped by the max bitrate")
+	{
+		senderBwe.SetMaxBitrate(400000u);
+
+		simulation.Run(10000u, 10000000u, 10000000u);
+
+		REQUIRE(senderBwe.GetAvailableBitrate() == 400000u);
+	}
+
+	SECTION("nothing is estimated once disconnected")
+	{
+		senderBwe.TransportDisconnected();
+
+		REQUIRE(senderBwe.GetAvailableBitrate() == 0u);
+
+		simulation.Run(1000u, 1000000u, 10000000u);
+
+		REQUIRE(senderBwe.GetAvailableBitrate() == 0u);
+	}
+}
@@ -1,4 +1,5 @@
 #include "common.hpp"
+#include "AllocationCounter.hpp"
 #include "RTC/SeqManager.hpp"
 #include <catch2/catch.hpp>
 #include <string>
@@ -424,4 +425,82 @@ SCENARIO("SeqManager", "[rtc]")
 		SeqManager<uint16_t> seqManager;
 		validate(seqManager, inputs);
 	}
+
+	SECTION("drop every other input for several wraps")
+	{
+		SeqManager<uint16_t> seqManager;
+		uint16_t input{ 0u };
+		uint16_t output;
+		uint16_t expected{ 0u };
+
+		REQUIRE(seqManager.Input(input, output));
+		REQUIRE(output == expected);
+
+		for (size_t i{ 0u }; i < 200000u; ++i)
+		{
+			seqManager.Drop(++input);
+
+			REQUIRE(seqManager.Input(++input, output));
+			REQUIRE(output == ++expected);
+
+			// Input received after the next one, and dropped input received again.
+			if (i % 1000u == 0u)
+			{
+				REQUIRE(seqManager.Input(input + 2, output));
+				REQUIRE(output == static_cast<uint16_t>(expected + 2u));
+				REQUIRE(seqManager.Input(input + 1, output));
+				REQUIRE(output == static_cast<uint16_t>(expected + 1u));
+				REQUIRE(!seqManager.Input(input - 1, output));
+
+				input += 2;
+				expected += 2;
+			}
+		}
+	}
+
+	SECTION("sync continues the output of another SeqManager")
+	{
+		SeqManager<uint16_t> seqManager1;
+		SeqManager<uint16_t> seqManager2;
+		uint16_t output;
+
+		REQUIRE(seqManager1.Input(65000, output));
+		REQUIRE(seqManager1.Input(65001, output));
+		REQUIRE(output == 65001);
+
+		seqManager2.SetMaxOutput(seqManager1.GetMaxOutput());
+		seqManager2.Sync(1000 - 1);
+
+		REQUIRE(seqManager2.Input(1000, output));
+		REQUIRE(output == 65002);
+		REQUIRE(seqManager2.Input(1001, output));
+		REQUIRE(output == 65003);
+	}
+}
+
+SCENARIO("SeqManager hot path", "[rtc][perf]")
+{
+	SECTION("input and drop do no heap allocation once the first drop is tracked")
+	{
+		SeqManager<uint16_t> seqManager;
+		uint16_t output;
+
+		seqManager.Input(0u, output);
+		seqManager.Drop(1u);
+
+		AllocationCounter allocationCounter;
+
+		// Wrap the sequence number around, dropping one input out of ten.
+		for (uint32_t input{ 2u }; input < 70000u; ++input)
+		{
+			if (input % 10u == 0u)
+				seqManager.Drop(static_cast<uint16_t>(input));
+			else
+				seqManager.Input(static_cast<uint16_t>(input), output);
+		}
+
+		auto allocations = allocationCounter.GetCount();
+
+		REQUIRE(allocations == 0u);
+	}
 }
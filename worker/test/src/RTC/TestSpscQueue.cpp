@@ -0,0 +1,106 @@
+#include "common.hpp"
+#include "RTC/SpscQueue.hpp"
+#include <catch2/catch.hpp>
+#include <thread>
+
+using namespace RTC;
+
+SCENARIO("SpscQueue", "[rtc][spscqueue]")
+{
+	SECTION("capacity is rounded up to a power of 2")
+	{
+		SpscQueue<uint32_t> queue(5u);
+
+		REQUIRE(queue.GetCapacity() == 8u);
+		REQUIRE(queue.GetSize() == 0u);
+	}
+
+	SECTION("items are popped in order and full queue rejects new ones")
+	{
+		SpscQueue<uint32_t> queue(4u);
+
+		REQUIRE(queue.Front() == nullptr);
+
+		for (uint32_t i{ 0u }; i < 4u; ++i)
+		{
+			auto* item = queue.Reserve();
+
+			REQUIRE(item != nullptr);
+
+			*item = i;
+
+			queue.Commit();
+		}
+
+		REQUIRE(queue.GetSize() == 4u);
+		REQUIRE(queue.Reserve() == nullptr);
+
+		for (uint32_t i{ 0u }; i < 4u; ++i)
+		{
+			auto* item = queue.Front();
+
+			REQUIRE(item != nullptr);
+			REQUIRE(*item == i);
+
+			queue.Pop();
+		}
+
+		REQUIRE(queue.Front() == nullptr);
+		REQUIRE(queue.GetSize() == 0u);
+		REQUIRE(queue.Reserve() != nullptr);
+	}
+
+	SECTION("items cross threads in order")
+	{
+		static constexpr uint32_t NumItems{ 100000u };
+
+		SpscQueue<uint32_t> queue(64u);
+
+		std::thread producer(
+		  [&queue]()
+		  {
+			  for (uint32_t i{ 0u }; i < NumItems;)
+			  {
+				  auto* item = queue.Reserve();
+
+				  if (!item)
+				  {
+					  std::this_thread::yield();
+
+					  continue;
+				  }
+
+				  *item = i++;
+
+				  queue.Commit();
+			  }
+		  });
+
+		uint32_t expected{ 0u };
+		bool inOrder{ true };
+
+		while (expected < NumItems)
+		{
+			auto* item = queue.Front();
+
+			if (!item)
+			{
+				std::this_thread::yield();
+
+				continue;
+			}
+
+			if (*item != expected)
+				inOrder = false;
+
+			++expected;
+
+			queue.Pop();
+		}
+
+		producer.join();
+
+		REQUIRE(inOrder);
+		REQUIRE(queue.GetSize() == 0u);
+	}
+}
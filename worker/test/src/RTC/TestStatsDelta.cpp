@@ -0,0 +1,69 @@
+#include "common.hpp"
+#include "RTC/StatsDelta.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+static json createStats(uint64_t packetCount, uint32_t score)
+{
+	json stats = json::array();
+
+	stats.push_back(
+	  { { "type", "inbound-rtp" }, { "ssrc", 1111 }, { "packetCount", packetCount }, { "score", score } });
+
+	return stats;
+}
+
+SCENARIO("StatsDelta", "[stats]")
+{
+	StatsDelta statsDelta;
+	json jsonObject = json::object();
+	json stats      = createStats(100u, 10u);
+
+	statsDelta.FillJson(jsonObject, stats, 0u);
+
+	REQUIRE(jsonObject["full"] == true);
+	REQUIRE(jsonObject["cursor"] == 1u);
+	REQUIRE(jsonObject["stats"][0]["packetCount"] == 100u);
+	REQUIRE(jsonObject["stats"][0]["score"] == 10u);
+
+	SECTION("just changed fields are given if cursor matches")
+	{
+		json jsonDelta = json::object();
+
+		stats = createStats(150u, 10u);
+		statsDelta.FillJson(jsonDelta, stats, 1u);
+
+		REQUIRE(jsonDelta["full"] == false);
+		REQUIRE(jsonDelta["cursor"] == 2u);
+		REQUIRE(jsonDelta["stats"].size() == 1u);
+		REQUIRE(jsonDelta["stats"][0]["type"] == "inbound-rtp");
+		REQUIRE(jsonDelta["stats"][0]["ssrc"] == 1111);
+		REQUIRE(jsonDelta["stats"][0]["packetCount"] == 150u);
+		REQUIRE(jsonDelta["stats"][0].find("score") == jsonDelta["stats"][0].end());
+	}
+
+	SECTION("full stats are given if cursor does not match")
+	{
+		json jsonDelta = json::object();
+
+		stats = createStats(150u, 10u);
+		statsDelta.FillJson(jsonDelta, stats, 5u);
+
+		REQUIRE(jsonDelta["full"] == true);
+		REQUIRE(jsonDelta["cursor"] == 2u);
+		REQUIRE(jsonDelta["stats"][0]["score"] == 10u);
+	}
+
+	SECTION("full stats are given if the number of entries changed")
+	{
+		json jsonDelta = json::object();
+
+		stats = createStats(150u, 10u);
+		stats.push_back({ { "type", "outbound-rtp" }, { "ssrc", 2222 } });
+		statsDelta.FillJson(jsonDelta, stats, 1u);
+
+		REQUIRE(jsonDelta["full"] == true);
+		REQUIRE(jsonDelta["stats"].size() == 2u);
+	}
+}
@@ -0,0 +1,62 @@
+#include "common.hpp"
+#include "MediaSoupErrors.hpp"
+#include "RTC/TraceEventSampler.hpp"
+#include <catch2/catch.hpp>
+#include <memory> // std::unique_ptr
+
+using namespace RTC;
+
+SCENARIO("TraceEventSampler", "[trace]")
+{
+	SECTION("default options do not need a sampler")
+	{
+		REQUIRE(TraceEventSampler::Create("id", json::object()) == nullptr);
+		REQUIRE(TraceEventSampler::Create("id", { { "mode", "event" } }) == nullptr);
+	}
+
+	SECTION("invalid options throw")
+	{
+		REQUIRE_THROWS_AS(TraceEventSampler::Create("id", { { "mode", "foo" } }), MediaSoupTypeError);
+		REQUIRE_THROWS_AS(TraceEventSampler::Create("id", { { "sampleRate", 0 } }), MediaSoupTypeError);
+		REQUIRE_THROWS_AS(
+		  TraceEventSampler::Create("id", { { "mode", "buffer" }, { "bufferSize", 100000 } }),
+		  MediaSoupTypeError);
+	}
+
+	SECTION("1 in N per packet events are sampled")
+	{
+		std::unique_ptr<TraceEventSampler> sampler(
+		  TraceEventSampler::Create("id", { { "sampleRate", 3 } }));
+
+		REQUIRE(sampler);
+		REQUIRE(sampler->Sample("rtp", true) == true);
+		REQUIRE(sampler->Sample("rtp", true) == false);
+		REQUIRE(sampler->Sample("rtp", true) == false);
+		REQUIRE(sampler->Sample("rtp", true) == true);
+		// Other events are not sampled.
+		REQUIRE(sampler->Sample("pli") == true);
+		REQUIRE(sampler->Sample("pli") == true);
+	}
+
+	SECTION("buffer mode keeps the last events")
+	{
+		std::unique_ptr<TraceEventSampler> sampler(
+		  TraceEventSampler::Create("id", { { "mode", "buffer" }, { "bufferSize", 2 } }));
+
+		for (int idx{ 1 }; idx <= 3; ++idx)
+		{
+			json data = { { "type", "nack" }, { "timestamp", idx } };
+
+			sampler->Emit(data);
+		}
+
+		json jsonObject = json::object();
+
+		sampler->FillJson(jsonObject);
+
+		REQUIRE(jsonObject["traceEventMode"] == "buffer");
+		REQUIRE(jsonObject["traceEvents"].size() == 2);
+		REQUIRE(jsonObject["traceEvents"][0]["timestamp"] == 2);
+		REQUIRE(jsonObject["traceEvents"][1]["timestamp"] == 3);
+	}
+}
@@ -0,0 +1,111 @@
+#include "common.hpp"
+#include "RTC/TransportArena.hpp"
+#include <catch2/catch.hpp>
+
+using namespace RTC;
+
+namespace
+{
+	struct Object : public TransportArena::Allocated
+	{
+		uint8_t payload[200];
+	};
+
+	struct BigObject : public TransportArena::Allocated
+	{
+		uint8_t payload[TransportArena::BlockSizeStep * TransportArena::NumSizeClasses];
+	};
+} // namespace
+
+SCENARIO("TransportArena", "[rtc][transportarena]")
+{
+	SECTION("objects are allocated in the arena of the current Scope")
+	{
+		TransportArena arena;
+		Object* object1;
+		Object* object2;
+
+		{
+			TransportArena::Scope scope(std::addressof(arena));
+
+			object1 = new Object();
+			object2 = new Object();
+		}
+
+		REQUIRE(arena.GetReservedBytes() == TransportArena::ChunkSize);
+		REQUIRE(arena.GetUsedBytes() == 2 * 256u);
+
+		// Consecutive blocks of the same chunk.
+		REQUIRE(
+		  reinterpret_cast<uint8_t*>(object2) - reinterpret_cast<uint8_t*>(object1) == 256);
+
+		// Freed out of the Scope.
+		delete object1;
+		delete object2;
+
+		REQUIRE(arena.GetUsedBytes() == 0u);
+	}
+
+	SECTION("freed blocks are reused")
+	{
+		TransportArena arena;
+		TransportArena::Scope scope(std::addressof(arena));
+
+		auto* object1       = new Object();
+		const void* address = object1;
+
+		delete object1;
+
+		auto* object2 = new Object();
+
+		REQUIRE(static_cast<const void*>(object2) == address);
+		REQUIRE(arena.GetReservedBytes() == TransportArena::ChunkSize);
+
+		delete object2;
+	}
+
+	SECTION("objects out of a Scope or too big go to the heap")
+	{
+		TransportArena arena;
+
+		auto* object = new Object();
+
+		REQUIRE(arena.GetUsedBytes() == 0u);
+
+		{
+			TransportArena::Scope scope(std::addressof(arena));
+
+			auto* bigObject = new BigObject();
+
+			REQUIRE(arena.GetUsedBytes() == 0u);
+
+			// Freed in the Scope of an arena, but it is not its owner.
+			delete object;
+			delete bigObject;
+		}
+
+		REQUIRE(arena.GetReservedBytes() == 0u);
+	}
+
+	SECTION("Scopes nest")
+	{
+		TransportArena arena1;
+		TransportArena arena2;
+		Object* object;
+
+		{
+			TransportArena::Scope scope1(std::addressof(arena1));
+
+			{
+				TransportArena::Scope scope2(std::addressof(arena2));
+			}
+
+			object = new Object();
+		}
+
+		REQUIRE(arena1.GetUsedBytes() == 256u);
+		REQUIRE(arena2.GetUsedBytes() == 0u);
+
+		delete object;
+	}
+}
@@ -0,0 +1,220 @@
+#include "common.hpp"
+#include "Utils.hpp"
+#include "RTC/TurnSession.hpp"
+#include <catch2/catch.hpp>
+#include <arpa/inet.h> // inet_pton()
+#include <cstring>     // std::memcpy()
+#include <vector>
+
+using namespace RTC;
+
+SCENARIO("TurnSession", "[rtc][turn]")
+{
+	struct sockaddr_in clientAddr
+	{
+	};
+	struct sockaddr_in relayedAddr
+	{
+	};
+
+	clientAddr.sin_family = AF_INET;
+	clientAddr.sin_port   = htons(40000);
+	inet_pton(AF_INET, "10.0.0.1", &clientAddr.sin_addr);
+
+	relayedAddr.sin_family = AF_INET;
+	relayedAddr.sin_port   = htons(443);
+	inet_pton(AF_INET, "10.0.0.2", &relayedAddr.sin_addr);
+
+	TurnSession turnSession(
+	  reinterpret_cast<const struct sockaddr*>(&clientAddr),
+	  reinterpret_cast<const struct sockaddr*>(&relayedAddr));
+
+	// clang-format off
+	// XOR-PEER-ADDRESS attribute with 1.2.3.4:5000.
+	const std::vector<uint8_t> xorPeerAddress =
+	{
+		0x00, 0x12, 0x00, 0x08,
+		0x00, 0x01, 0x32, 0x9A,
+		0x20, 0x10, 0xA7, 0x46
+	};
+	// REQUESTED-TRANSPORT attribute with UDP.
+	const std::vector<uint8_t> requestedTransport =
+	{
+		0x00, 0x19, 0x00, 0x04,
+		0x11, 0x00, 0x00, 0x00
+	};
+	// CHANNEL-NUMBER attribute with 0x4000.
+	const std::vector<uint8_t> channelNumber =
+	{
+		0x00, 0x0C, 0x00, 0x04,
+		0x40, 0x00, 0x00, 0x00
+	};
+	// LIFETIME attribute with 0.
+	const std::vector<uint8_t> lifetimeZero =
+	{
+		0x00, 0x0D, 0x00, 0x04,
+		0x00, 0x00, 0x00, 0x00
+	};
+	// DATA attribute with 4 bytes.
+	const std::vector<uint8_t> dataAttr =
+	{
+		0x00, 0x13, 0x00, 0x04,
+		0xAA, 0xBB, 0xCC, 0xDD
+	};
+	// clang-format on
+
+	uint8_t response[256];
+	const uint8_t* data{ nullptr };
+	size_t dataLen{ 0u };
+
+	auto buildMessage = [](uint16_t type, const std::vector<std::vector<uint8_t>>& attributes)
+	{
+		std::vector<uint8_t> msg(20u, 0u);
+
+		Utils::Byte::Set2Bytes(msg.data(), 0, type);
+		msg[4] = 0x21;
+		msg[5] = 0x12;
+		msg[6] = 0xA4;
+		msg[7] = 0x42;
+
+		for (size_t i{ 8u }; i < 20u; ++i)
+		{
+			msg[i] = static_cast<uint8_t>(i);
+		}
+
+		for (const auto& attribute : attributes)
+		{
+			msg.insert(msg.end(), attribute.begin(), attribute.end());
+		}
+
+		Utils::Byte::Set2Bytes(msg.data(), 2, static_cast<uint16_t>(msg.size() - 20u));
+
+		return msg;
+	};
+
+	auto process = [&](const std::vector<uint8_t>& msg)
+	{
+		return turnSession.ProcessMessage(msg.data(), msg.size(), response, data, dataLen);
+	};
+
+	auto allocate = [&]()
+	{
+		auto msg = buildMessage(0x0003, { requestedTransport });
+
+		REQUIRE(TurnSession::IsTurn(msg.data(), msg.size()));
+		REQUIRE(TurnSession::GetMessageSize(msg.data(), msg.size()) == msg.size());
+		REQUIRE(process(msg) != 0u);
+		REQUIRE(Utils::Byte::Get2Bytes(response, 0) == 0x0103);
+	};
+
+	SECTION("RFC 4571 frames are not TURN messages")
+	{
+		// clang-format off
+		uint8_t frame[] =
+		{
+			0x00, 0x14, 0x00, 0x01, 0x00, 0x00, 0x21, 0x12, 0xA4, 0x42
+		};
+		// clang-format on
+
+		REQUIRE(!TurnSession::IsTurn(frame, sizeof(frame)));
+	}
+
+	SECTION("allocation is created just once and for UDP")
+	{
+		REQUIRE(process(buildMessage(0x0003, {})) == 28u);
+		// Error response with 400.
+		REQUIRE(Utils::Byte::Get2Bytes(response, 0) == 0x0113);
+		REQUIRE(response[26] == 4);
+		REQUIRE(response[27] == 0);
+
+		allocate();
+
+		// XOR-RELAYED-ADDRESS attribute with the relayed address.
+		REQUIRE(Utils::Byte::Get2Bytes(response, 20) == 0x0016);
+		REQUIRE((Utils::Byte::Get2Bytes(response, 26) ^ 0x2112) == 443);
+
+		REQUIRE(process(buildMessage(0x0003, { requestedTransport })) == 28u);
+		// Error response with 437.
+		REQUIRE(Utils::Byte::Get2Bytes(response, 0) == 0x0113);
+		REQUIRE(response[26] == 4);
+		REQUIRE(response[27] == 37);
+	}
+
+	SECTION("data is exchanged with Send and Data indications")
+	{
+		uint8_t header[TurnSession::MaxDataHeaderSize];
+
+		// Data sent before the allocation is ignored.
+		REQUIRE(process(buildMessage(0x0016, { xorPeerAddress, dataAttr })) == 0u);
+		REQUIRE(!data);
+
+		allocate();
+
+		// The peer is unknown yet.
+		REQUIRE(turnSession.FillDataHeader(header, 4u) == 0u);
+
+		REQUIRE(process(buildMessage(0x0016, { xorPeerAddress, dataAttr })) == 0u);
+		REQUIRE(dataLen == 4u);
+		REQUIRE(data[0] == 0xAA);
+		REQUIRE(data[3] == 0xDD);
+
+		REQUIRE(turnSession.FillDataHeader(header, 4u) == 36u);
+		// Data indication with length of XOR-PEER-ADDRESS and DATA attributes.
+		REQUIRE(Utils::Byte::Get2Bytes(header, 0) == 0x0017);
+		REQUIRE(Utils::Byte::Get2Bytes(header, 2) == 20u);
+		REQUIRE(Utils::Byte::Get2Bytes(header, 20) == 0x0012);
+		REQUIRE(Utils::Byte::Get2Bytes(header, 32) == 0x0013);
+		REQUIRE(Utils::Byte::Get2Bytes(header, 34) == 4u);
+	}
+
+	SECTION("data is exchanged over a bound channel")
+	{
+		uint8_t header[TurnSession::MaxDataHeaderSize];
+
+		// clang-format off
+		uint8_t channelData[] =
+		{
+			0x40, 0x00, 0x00, 0x03,
+			0x01, 0x02, 0x03, 0x00
+		};
+		// clang-format on
+
+		allocate();
+
+		REQUIRE(TurnSession::IsChannelData(channelData));
+		REQUIRE(TurnSession::GetMessageSize(channelData, sizeof(channelData)) == 8u);
+
+		// Not bound yet.
+		REQUIRE(!turnSession.ProcessChannelData(channelData, sizeof(channelData), dataLen));
+
+		process(buildMessage(0x0009, { channelNumber, xorPeerAddress }));
+
+		REQUIRE(Utils::Byte::Get2Bytes(response, 0) == 0x0109);
+
+		data = turnSession.ProcessChannelData(channelData, sizeof(channelData), dataLen);
+
+		REQUIRE(data);
+		REQUIRE(dataLen == 3u);
+		REQUIRE(data[0] == 0x01);
+
+		REQUIRE(turnSession.FillDataHeader(header, 5u) == 4u);
+		REQUIRE(Utils::Byte::Get2Bytes(header, 0) == 0x4000);
+		REQUIRE(Utils::Byte::Get2Bytes(header, 2) == 5u);
+		REQUIRE(TurnSession::GetPaddingSize(5u) == 3u);
+	}
+
+	SECTION("allocation is released with a zero lifetime refresh")
+	{
+		allocate();
+
+		process(buildMessage(0x0004, {}));
+
+		REQUIRE(Utils::Byte::Get2Bytes(response, 0) == 0x0104);
+		REQUIRE(!turnSession.IsReleased());
+
+		process(buildMessage(0x0004, { lifetimeZero }));
+
+		REQUIRE(Utils::Byte::Get2Bytes(response, 0) == 0x0104);
+		REQUIRE(turnSession.IsReleased());
+	}
+}
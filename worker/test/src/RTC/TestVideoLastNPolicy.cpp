@@ -0,0 +1,76 @@
+#include "common.hpp"
+#include "RTC/VideoLastNPolicy.hpp"
+#include <catch2/catch.hpp>
+#include <map>
+
+using namespace RTC;
+
+class TestVideoLastNPolicyListener : public VideoLastNPolicy::Listener
+{
+public:
+	void OnVideoLastNPolicyProducerSelected(
+	  VideoLastNPolicy* /*policy*/, Producer* videoProducer, bool selected) override
+	{
+		this->selected[videoProducer] = selected;
+	}
+
+public:
+	std::map<Producer*, bool> selected;
+};
+
+SCENARIO("VideoLastNPolicy", "[rtp][lastn]")
+{
+	// Producers are just used as keys.
+	int producers[6];
+	auto* audioProducer1 = reinterpret_cast<Producer*>(&producers[0]);
+	auto* audioProducer2 = reinterpret_cast<Producer*>(&producers[1]);
+	auto* audioProducer3 = reinterpret_cast<Producer*>(&producers[2]);
+	auto* videoProducer1 = reinterpret_cast<Producer*>(&producers[3]);
+	auto* videoProducer2 = reinterpret_cast<Producer*>(&producers[4]);
+	auto* videoProducer3 = reinterpret_cast<Producer*>(&producers[5]);
+
+	TestVideoLastNPolicyListener listener;
+	VideoLastNPolicy policy(&listener, 2);
+
+	policy.AddSpeaker(audioProducer1, { videoProducer1 });
+	policy.AddSpeaker(audioProducer2, { videoProducer2 });
+	policy.AddSpeaker(audioProducer3, { videoProducer3 });
+
+	SECTION("speakers beyond N are unselected")
+	{
+		REQUIRE(policy.IsSelected(audioProducer1));
+		REQUIRE(policy.IsSelected(audioProducer2));
+		REQUIRE(!policy.IsSelected(audioProducer3));
+		REQUIRE(listener.selected.size() == 1);
+		REQUIRE(listener.selected[videoProducer3] == false);
+	}
+
+	SECTION("dominant speaker is selected")
+	{
+		policy.DominantSpeakerChanged(audioProducer3);
+
+		REQUIRE(policy.IsSelected(audioProducer3));
+		REQUIRE(policy.IsSelected(audioProducer1));
+		REQUIRE(!policy.IsSelected(audioProducer2));
+		REQUIRE(listener.selected[videoProducer3] == true);
+		REQUIRE(listener.selected[videoProducer2] == false);
+	}
+
+	SECTION("removing a speaker selects the next one")
+	{
+		policy.RemoveSpeaker(audioProducer1);
+
+		REQUIRE(policy.IsSelected(audioProducer3));
+		REQUIRE(listener.selected[videoProducer3] == true);
+	}
+
+	SECTION("Close() selects every video Producer")
+	{
+		policy.DominantSpeakerChanged(audioProducer3);
+		policy.Close();
+
+		REQUIRE(listener.selected[videoProducer2] == true);
+		REQUIRE(listener.selected[videoProducer3] == true);
+		REQUIRE(!policy.IsSelected(audioProducer1));
+	}
+}
@@ -0,0 +1,77 @@
+#include "common.hpp"
+#include "DepLibUV.hpp"
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <thread>
+
+struct TimeReads
+{
+	uint64_t firstNs{ 0u };
+	uint64_t secondNs{ 0u };
+	uint64_t firstHighResNs{ 0u };
+	uint64_t secondHighResNs{ 0u };
+};
+
+static void onTimer(uv_timer_t* handle)
+{
+	auto* reads = static_cast<TimeReads*>(handle->data);
+
+	reads->firstNs        = DepLibUV::GetTimeNs();
+	reads->firstHighResNs = DepLibUV::GetHighResTimeNs();
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+	reads->secondNs        = DepLibUV::GetTimeNs();
+	reads->secondHighResNs = DepLibUV::GetHighResTimeNs();
+
+	uv_close(reinterpret_cast<uv_handle_t*>(handle), nullptr);
+}
+
+SCENARIO("DepLibUV time", "[deplibuv]")
+{
+	SECTION("time is not cached out of the loop")
+	{
+		auto firstNs = DepLibUV::GetTimeNs();
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+		REQUIRE(DepLibUV::GetTimeNs() > firstNs);
+	}
+
+	SECTION("time is cached within a loop iteration")
+	{
+		TimeReads reads;
+		uv_timer_t timer;
+
+		timer.data = static_cast<void*>(&reads);
+
+		uv_timer_init(DepLibUV::GetLoop(), &timer);
+		uv_timer_start(&timer, onTimer, 0u, 0u);
+
+		DepLibUV::RunLoop();
+
+		REQUIRE(reads.secondNs == reads.firstNs);
+		REQUIRE(reads.secondHighResNs > reads.firstHighResNs);
+		REQUIRE(reads.secondHighResNs - reads.firstHighResNs >= 2000000u);
+
+		// Not cached anymore once the loop ends.
+		REQUIRE(DepLibUV::GetTimeNs() > reads.secondNs);
+	}
+
+	SECTION("virtual time")
+	{
+		DepLibUV::SetVirtualTimeNs(5000000000u);
+
+		REQUIRE(DepLibUV::GetTimeNs() == 5000000000u);
+		REQUIRE(DepLibUV::GetTimeMs() == 5000u);
+
+		DepLibUV::SetVirtualTimeNs(5001000000u);
+
+		REQUIRE(DepLibUV::GetTimeMs() == 5001u);
+
+		// Back to the real clock.
+		DepLibUV::SetVirtualTimeNs(0u);
+
+		REQUIRE(DepLibUV::GetTimeNs() != 5001000000u);
+	}
+}
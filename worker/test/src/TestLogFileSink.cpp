@@ -0,0 +1,123 @@
+#include "common.hpp"
+#include "LogFileSink.hpp"
+#include <catch2/catch.hpp>
+#include <cstdio> // std::remove()
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+SCENARIO("LogFileSink", "[log]")
+{
+	std::string path{ "/tmp/mediasoup-worker-test-log" };
+
+	auto readLines = [&path]()
+	{
+		std::vector<std::string> lines;
+		std::ifstream file(path);
+		std::string line;
+
+		while (std::getline(file, line))
+		{
+			lines.push_back(line);
+		}
+
+		return lines;
+	};
+
+	std::remove(path.c_str());
+
+	SECTION("lines are written in order once the sink is destroyed")
+	{
+		{
+			LogFileSink logFileSink(path);
+
+			REQUIRE(logFileSink.Push("D line 1", 8));
+			REQUIRE(logFileSink.Push("W line 2", 8));
+			REQUIRE(logFileSink.Push("E line 3 ignored", 8));
+		}
+
+		auto lines = readLines();
+
+		REQUIRE(lines.size() == 3);
+		REQUIRE(lines[0] == "D line 1");
+		REQUIRE(lines[1] == "W line 2");
+		REQUIRE(lines[2] == "E line 3");
+	}
+
+	SECTION("long lines are truncated")
+	{
+		std::string longLine(LogFileSink::SlotSize + 100, 'x');
+
+		{
+			LogFileSink logFileSink(path);
+
+			REQUIRE(logFileSink.Push(longLine.c_str(), longLine.size()));
+		}
+
+		auto lines = readLines();
+
+		REQUIRE(lines.size() == 1);
+		REQUIRE(lines[0] == longLine.substr(0, LogFileSink::SlotSize));
+	}
+
+	SECTION("lines pushed by several threads are not lost nor mixed")
+	{
+		static constexpr size_t NumThreads{ 4u };
+		static constexpr size_t NumLines{ 2000u };
+
+		uint64_t droppedLines;
+
+		{
+			LogFileSink logFileSink(path);
+			std::vector<std::thread> threads;
+
+			for (size_t threadIdx{ 0u }; threadIdx < NumThreads; ++threadIdx)
+			{
+				threads.emplace_back(
+				  [&logFileSink, threadIdx]()
+				  {
+					  for (size_t lineIdx{ 0u }; lineIdx < NumLines; ++lineIdx)
+					  {
+						  auto line = std::to_string(threadIdx) + ":" + std::to_string(lineIdx);
+
+						  logFileSink.Push(line.c_str(), line.size());
+					  }
+				  });
+			}
+
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			droppedLines = logFileSink.GetDroppedLines();
+		}
+
+		auto lines = readLines();
+
+		REQUIRE(lines.size() + droppedLines == NumThreads * NumLines);
+
+		// Lines of every thread keep their order.
+		std::vector<int64_t> lastLineIdxs(NumThreads, -1);
+
+		for (const auto& line : lines)
+		{
+			auto separatorPos = line.find(':');
+
+			REQUIRE(separatorPos != std::string::npos);
+
+			auto threadIdx = std::stoul(line.substr(0, separatorPos));
+			auto lineIdx   = std::stol(line.substr(separatorPos + 1));
+
+			REQUIRE(threadIdx < NumThreads);
+			REQUIRE(lineIdx > lastLineIdxs[threadIdx]);
+
+			lastLineIdxs[threadIdx] = lineIdx;
+		}
+	}
+
+	std::remove(path.c_str());
+}
+#endif
@@ -0,0 +1,70 @@
+#include "common.hpp"
+#include "Metrics.hpp"
+#include <catch2/catch.hpp>
+
+SCENARIO("Metrics", "[metrics]")
+{
+	SECTION("small values have their own bucket")
+	{
+		for (uint64_t value{ 0u }; value < Metrics::Histogram::LinearBucketCount; ++value)
+		{
+			auto index = Metrics::Histogram::GetBucketIndex(value);
+
+			REQUIRE(index == value);
+			REQUIRE(Metrics::Histogram::GetBucketLowerBound(index) == value);
+		}
+	}
+
+	SECTION("big values fall into the bucket of their lower bound")
+	{
+		// clang-format off
+		uint64_t values[] =
+		{
+			16u, 17u, 18u, 31u, 32u, 100u, 1000u, 123456789u, 0xFFFFFFFFFFFFFFFF
+		};
+		// clang-format on
+
+		for (auto value : values)
+		{
+			auto index      = Metrics::Histogram::GetBucketIndex(value);
+			auto lowerBound = Metrics::Histogram::GetBucketLowerBound(index);
+
+			REQUIRE(index < Metrics::Histogram::BucketCount);
+			REQUIRE(lowerBound <= value);
+			// Relative error below 12.5%.
+			REQUIRE(value - lowerBound <= lowerBound / 8);
+			REQUIRE(Metrics::Histogram::GetBucketIndex(lowerBound) == index);
+		}
+
+		REQUIRE(Metrics::Histogram::GetBucketIndex(0xFFFFFFFFFFFFFFFF) == Metrics::Histogram::BucketCount - 1);
+	}
+
+	SECTION("percentiles")
+	{
+		Metrics::Histogram histogram;
+
+		REQUIRE(histogram.GetPercentile(50) == 0);
+
+		for (uint64_t value{ 1u }; value <= 100u; ++value)
+		{
+			histogram.Record(value);
+		}
+
+		REQUIRE(histogram.GetCount() == 100);
+		REQUIRE(histogram.GetMax() == 100);
+		// 50 is in the [48, 52) bucket.
+		REQUIRE(histogram.GetPercentile(50) == 48);
+		// 99 and 100 are in the [96, 104) bucket.
+		REQUIRE(histogram.GetPercentile(99) == 96);
+		REQUIRE(histogram.GetPercentile(100) == 96);
+
+		json jsonObject = json::object();
+
+		histogram.FillJson(jsonObject, 2.0);
+
+		REQUIRE(jsonObject["count"] == 100);
+		REQUIRE(jsonObject["max"] == 200);
+		REQUIRE(jsonObject["p50"] == 96);
+		REQUIRE(jsonObject["mean"] == Approx(101.0));
+	}
+}
@@ -0,0 +1,113 @@
+#include "common.hpp"
+#include "OverloadController.hpp"
+#include <catch2/catch.hpp>
+#include <vector>
+
+using Level = OverloadController::Level;
+
+class TestOverloadControllerListener : public OverloadController::Listener
+{
+public:
+	void OnOverloadControllerLevelChange(
+	  OverloadController* /*overloadController*/, Level level, Level /*previousLevel*/) override
+	{
+		this->levels.push_back(level);
+	}
+
+public:
+	std::vector<Level> levels;
+};
+
+SCENARIO("OverloadController", "[overload]")
+{
+	TestOverloadControllerListener listener;
+
+	SECTION("level is raised one step per overloaded period")
+	{
+		OverloadController overloadController(&listener);
+
+		REQUIRE(OverloadController::GetLevel() == Level::NONE);
+		REQUIRE(!OverloadController::ShedNack());
+
+		overloadController.Update(0.9, 0u);
+
+		REQUIRE(OverloadController::GetLevel() == Level::DROP_RTX);
+		REQUIRE(OverloadController::ShedNack());
+
+		// High loop lag is enough.
+		overloadController.Update(0.1, 80u);
+		overloadController.Update(0.9, 0u);
+		overloadController.Update(0.9, 0u);
+		overloadController.Update(0.9, 0u);
+
+		REQUIRE(OverloadController::GetLevel() == Level::PAUSE_CONSUMERS);
+		REQUIRE(
+		  listener.levels == std::vector<Level>{ Level::DROP_RTX,
+		                                         Level::DROP_TEMPORAL_LAYERS,
+		                                         Level::DROP_SPATIAL_LAYERS,
+		                                         Level::PAUSE_CONSUMERS });
+	}
+
+	SECTION("level is lowered after several periods with low load")
+	{
+		OverloadController overloadController(&listener);
+
+		overloadController.Update(0.9, 0u);
+		overloadController.Update(0.9, 0u);
+
+		REQUIRE(OverloadController::GetLevel() == Level::DROP_TEMPORAL_LAYERS);
+
+		for (int i{ 0 }; i < 4; ++i)
+		{
+			overloadController.Update(0.3, 5u);
+		}
+
+		REQUIRE(OverloadController::GetLevel() == Level::DROP_TEMPORAL_LAYERS);
+
+		// A period that is neither high nor low restarts the count.
+		overloadController.Update(0.7, 5u);
+
+		for (int i{ 0 }; i < 4; ++i)
+		{
+			overloadController.Update(0.3, 5u);
+		}
+
+		REQUIRE(OverloadController::GetLevel() == Level::DROP_TEMPORAL_LAYERS);
+
+		overloadController.Update(0.3, 5u);
+
+		REQUIRE(OverloadController::GetLevel() == Level::DROP_RTX);
+	}
+
+	SECTION("level is reset when destroyed")
+	{
+		{
+			OverloadController overloadController(&listener);
+
+			overloadController.Update(0.9, 0u);
+		}
+
+		REQUIRE(OverloadController::GetLevel() == Level::NONE);
+	}
+
+	SECTION("max layers")
+	{
+		int16_t maxSpatialLayer;
+		int16_t maxTemporalLayer;
+
+		OverloadController::GetMaxLayers(Level::DROP_RTX, maxSpatialLayer, maxTemporalLayer);
+
+		REQUIRE(maxSpatialLayer == -1);
+		REQUIRE(maxTemporalLayer == -1);
+
+		OverloadController::GetMaxLayers(Level::DROP_TEMPORAL_LAYERS, maxSpatialLayer, maxTemporalLayer);
+
+		REQUIRE(maxSpatialLayer == -1);
+		REQUIRE(maxTemporalLayer == 1);
+
+		OverloadController::GetMaxLayers(Level::PAUSE_CONSUMERS, maxSpatialLayer, maxTemporalLayer);
+
+		REQUIRE(maxSpatialLayer == 0);
+		REQUIRE(maxTemporalLayer == 1);
+	}
+}
@@ -0,0 +1,84 @@
+#include "common.hpp"
+#include "StatsRegion.hpp"
+#include <catch2/catch.hpp>
+#include <cstdio>  // std::fopen(), std::fread(), std::fclose()
+#include <cstring> // std::strcmp()
+#include <vector>
+
+#ifndef _WIN32
+SCENARIO("StatsRegion", "[stats]")
+{
+	std::string path{ "/tmp/mediasoup-worker-test-stats" };
+
+	auto read = [&path]()
+	{
+		std::vector<uint8_t> data(sizeof(StatsRegion::Header) + (sizeof(StatsRegion::Record) * 2));
+		auto* file = std::fopen(path.c_str(), "rb");
+
+		REQUIRE(file);
+		REQUIRE(std::fread(data.data(), 1, data.size(), file) == data.size());
+
+		std::fclose(file);
+
+		return data;
+	};
+
+	SECTION("records are written between even sequence numbers")
+	{
+		StatsRegion statsRegion(path);
+
+		auto data    = read();
+		auto* header = reinterpret_cast<StatsRegion::Header*>(data.data());
+
+		REQUIRE(std::strcmp(header->magic, "MSSTATS") == 0);
+		REQUIRE(header->version == StatsRegion::Version);
+		REQUIRE(header->recordSize == sizeof(StatsRegion::Record));
+		REQUIRE(header->maxRecords == StatsRegion::MaxRecords);
+		REQUIRE(header->sequence.load() == 0);
+		REQUIRE(header->recordCount == 0);
+
+		statsRegion.BeginUpdate();
+
+		auto* record =
+		  statsRegion.AddRecord(StatsRegion::RecordType::PRODUCER_STREAM, "producer1", "transport1");
+
+		REQUIRE(record);
+
+		record->ssrc        = 1234;
+		record->packetCount = 100;
+
+		data   = read();
+		header = reinterpret_cast<StatsRegion::Header*>(data.data());
+
+		// Being written.
+		REQUIRE(header->sequence.load() == 1);
+
+		statsRegion.EndUpdate(5000);
+
+		data   = read();
+		header = reinterpret_cast<StatsRegion::Header*>(data.data());
+
+		auto* readRecord =
+		  reinterpret_cast<StatsRegion::Record*>(data.data() + sizeof(StatsRegion::Header));
+
+		REQUIRE(header->sequence.load() == 2);
+		REQUIRE(header->recordCount == 1);
+		REQUIRE(header->truncated == 0);
+		REQUIRE(header->updatedAt == 5000);
+		REQUIRE(readRecord->type == StatsRegion::RecordType::PRODUCER_STREAM);
+		REQUIRE(std::strcmp(readRecord->id, "producer1") == 0);
+		REQUIRE(std::strcmp(readRecord->transportId, "transport1") == 0);
+		REQUIRE(readRecord->ssrc == 1234);
+		REQUIRE(readRecord->packetCount == 100);
+	}
+
+	SECTION("the file is removed when closed")
+	{
+		{
+			StatsRegion statsRegion(path);
+		}
+
+		REQUIRE(std::fopen(path.c_str(), "rb") == nullptr);
+	}
+}
+#endif
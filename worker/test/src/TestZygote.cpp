@@ -0,0 +1,35 @@
+#include "common.hpp"
+#include "Zygote.hpp"
+#include <catch2/catch.hpp>
+#include <cstring> // std::memcpy()
+
+SCENARIO("Zygote", "[zygote]")
+{
+	SECTION("ParseArgs() splits '\\0' terminated arguments")
+	{
+		const char args[] = "--logLevel=debug\0--rtcMinPort=40000\0\0";
+		uint8_t data[sizeof(args) - 1];
+
+		std::memcpy(data, args, sizeof(data));
+
+		auto parsed = Zygote::ParseArgs(data, sizeof(data));
+
+		REQUIRE(parsed.size() == 3);
+		REQUIRE(parsed[0] == "--logLevel=debug");
+		REQUIRE(parsed[1] == "--rtcMinPort=40000");
+		REQUIRE(parsed[2].empty());
+	}
+
+	SECTION("ParseArgs() ignores a last argument not terminated by '\\0'")
+	{
+		const char args[] = "--logLevel=debug\0--rtcMin";
+		uint8_t data[sizeof(args) - 1];
+
+		std::memcpy(data, args, sizeof(data));
+
+		auto parsed = Zygote::ParseArgs(data, sizeof(data));
+
+		REQUIRE(parsed.size() == 1);
+		REQUIRE(parsed[0] == "--logLevel=debug");
+	}
+}
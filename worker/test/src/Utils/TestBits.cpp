@@ -20,3 +20,24 @@ SCENARIO("Utils::Bits::CountSetBits()")
 	mask = 0b1111111111111111;
 	REQUIRE(Utils::Bits::CountSetBits(mask) == 16);
 }
+
+SCENARIO("Utils::Bits::CountSetBits() with 64 bits masks")
+{
+	uint64_t mask;
+
+	mask = 0u;
+	REQUIRE(Utils::Bits::CountSetBits(mask) == 0);
+
+	mask = 0x8000000000000001;
+	REQUIRE(Utils::Bits::CountSetBits(mask) == 2);
+
+	mask = 0xFFFFFFFFFFFFFFFF;
+	REQUIRE(Utils::Bits::CountSetBits(mask) == 64);
+}
+
+SCENARIO("Utils::Bits::CountTrailingZeros()")
+{
+	REQUIRE(Utils::Bits::CountTrailingZeros(0x0000000000000001) == 0);
+	REQUIRE(Utils::Bits::CountTrailingZeros(0x0000000000000030) == 4);
+	REQUIRE(Utils::Bits::CountTrailingZeros(0x8000000000000000) == 63);
+}
@@ -0,0 +1,104 @@
+#include "common.hpp"
+#include "Utils.hpp"
+#include <catch2/catch.hpp>
+#include <cstring> // std::memcmp(), std::strlen()
+
+using namespace Utils;
+
+SCENARIO("Crypto::GetCRC32c()")
+{
+	const auto* data = reinterpret_cast<const uint8_t*>("123456789");
+	size_t len       = std::strlen("123456789");
+
+	// Check value from RFC 3720 (iSCSI) test vectors.
+	REQUIRE(Crypto::GetCRC32c(data, len) == 0xE3069283);
+	REQUIRE(Crypto::GetCRC32c(data, 0) == 0u);
+
+	// Computed in chunks.
+	auto crc = Crypto::GetCRC32c(data, 4);
+
+	REQUIRE(Crypto::GetCRC32c(data + 4, len - 4, crc) == 0xE3069283);
+
+	// 32 bytes of zeroes (RFC 3720 B.4).
+	uint8_t zeroes[32]{};
+
+	REQUIRE(Crypto::GetCRC32c(zeroes, sizeof(zeroes)) == 0x8A9136AA);
+
+	// Long unaligned buffer must match the bytewise result.
+	uint8_t buffer[1001];
+
+	for (size_t i{ 0u }; i < sizeof(buffer); ++i)
+	{
+		buffer[i] = static_cast<uint8_t>(i * 7);
+	}
+
+	crc = 0u;
+
+	for (size_t i{ 1u }; i < sizeof(buffer); ++i)
+	{
+		crc = Crypto::GetCRC32c(buffer + i, 1, crc);
+	}
+
+	REQUIRE(Crypto::GetCRC32c(buffer + 1, sizeof(buffer) - 1) == crc);
+}
+
+SCENARIO("Crypto::GetCRC32()")
+{
+	const auto* data = reinterpret_cast<const uint8_t*>("123456789");
+	size_t len       = std::strlen("123456789");
+
+	// Check value of CRC-32/ISO-HDLC.
+	REQUIRE(Crypto::GetCRC32(data, len) == 0xCBF43926);
+	REQUIRE(Crypto::GetCRC32(data, 0) == 0u);
+
+	// Unaligned buffers of any length must match the bytewise result.
+	uint8_t buffer[1001];
+
+	for (size_t i{ 0u }; i < sizeof(buffer); ++i)
+	{
+		buffer[i] = static_cast<uint8_t>(i * 7);
+	}
+
+	for (size_t offset{ 0u }; offset < 8u; ++offset)
+	{
+		for (size_t size{ 0u }; size < 100u; ++size)
+		{
+			uint32_t crc{ 0xFFFFFFFF };
+
+			for (size_t i{ 0u }; i < size; ++i)
+			{
+				crc ^= buffer[offset + i];
+
+				for (int bit{ 0 }; bit < 8; ++bit)
+				{
+					crc = (crc & 1u) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+				}
+			}
+
+			REQUIRE(Crypto::GetCRC32(buffer + offset, size) == (crc ^ 0xFFFFFFFF));
+		}
+	}
+}
+
+SCENARIO("Crypto::HmacSha1")
+{
+	// RFC 2202 test case 2.
+	const auto* data = reinterpret_cast<const uint8_t*>("what do ya want for nothing?");
+	size_t len       = std::strlen("what do ya want for nothing?");
+	// clang-format off
+	uint8_t expected[] =
+	{
+		0xEF, 0xFC, 0xDF, 0x6A, 0xE5, 0xEB, 0x2F, 0xA2, 0xD2, 0x74,
+		0x16, 0xD5, 0xF1, 0x84, 0xDF, 0x9C, 0x25, 0x9A, 0x7C, 0x79
+	};
+	// clang-format on
+
+	Crypto::HmacSha1 hmacSha1("Jefe");
+
+	REQUIRE(hmacSha1.GetKey() == "Jefe");
+
+	// The padded key states are reused for every message.
+	REQUIRE(std::memcmp(hmacSha1.Compute(data, len), expected, sizeof(expected)) == 0);
+	REQUIRE(std::memcmp(hmacSha1.Compute(data, len), expected, sizeof(expected)) == 0);
+	REQUIRE(std::memcmp(Crypto::GetHmacSha1("Jefe", data, len), expected, sizeof(expected)) == 0);
+}
@@ -5,8 +5,9 @@
 #include <cstring> // std::memset()
 #ifdef _WIN32
 #include <winsock2.h>
+#include <ws2tcpip.h> // inet_pton()
 #else
-#include <arpa/inet.h>  // htonl(), htons(), ntohl(), ntohs()
+#include <arpa/inet.h>  // htonl(), htons(), ntohl(), ntohs(), inet_pton()
 #include <netinet/in.h> // sockaddr_in, sockaddr_in6
 #include <sys/socket.h> // struct sockaddr, struct sockaddr_storage, AF_INET, AF_INET6
 #endif
@@ -137,3 +138,35 @@ SCENARIO("Utils::IP::GetAddressInfo()")
 	REQUIRE(ip == "82.99.219.114");
 	REQUIRE(port == 10251);
 }
+
+SCENARIO("Utils::IP::IsMulticast()")
+{
+	struct sockaddr_storage addrStorage;
+
+	auto* sin  = reinterpret_cast<struct sockaddr_in*>(&addrStorage);
+	auto* sin6 = reinterpret_cast<struct sockaddr_in6*>(&addrStorage);
+	auto* addr = reinterpret_cast<const struct sockaddr*>(&addrStorage);
+
+	std::memset(&addrStorage, 0, sizeof(addrStorage));
+
+	sin->sin_family      = AF_INET;
+	sin->sin_addr.s_addr = inet_addr("239.1.2.3");
+
+	REQUIRE(IP::IsMulticast(addr));
+
+	sin->sin_addr.s_addr = inet_addr("82.99.219.114");
+
+	REQUIRE(!IP::IsMulticast(addr));
+
+	std::memset(&addrStorage, 0, sizeof(addrStorage));
+
+	sin6->sin6_family = AF_INET6;
+
+	inet_pton(AF_INET6, "ff02::1234", &sin6->sin6_addr);
+
+	REQUIRE(IP::IsMulticast(addr));
+
+	inet_pton(AF_INET6, "2001:db8::1", &sin6->sin6_addr);
+
+	REQUIRE(!IP::IsMulticast(addr));
+}
@@ -0,0 +1,134 @@
+#include "common.hpp"
+#include "DepLibUV.hpp"
+#include "handles/Timer.hpp"
+#include "handles/TimerWheel.hpp"
+#include <catch2/catch.hpp>
+#include <vector>
+
+SCENARIO("TimerWheel", "[timer]")
+{
+	class TestTimerListener : public Timer::Listener
+	{
+	public:
+		void OnTimer(Timer* timer) override
+		{
+			this->fired.push_back(timer);
+
+			if (timer == this->stopTimer && ++this->numStopTimerFired == 3u)
+				timer->Stop();
+
+			if (timer == this->cancellerTimer && this->cancelledTimer)
+				this->cancelledTimer->Stop();
+		}
+
+	public:
+		std::vector<Timer*> fired;
+		Timer* stopTimer{ nullptr };
+		size_t numStopTimerFired{ 0u };
+		Timer* cancellerTimer{ nullptr };
+		Timer* cancelledTimer{ nullptr };
+	};
+
+	SECTION("timers fire in expiration order")
+	{
+		TestTimerListener listener;
+		Timer timer1(&listener);
+		Timer timer2(&listener);
+		Timer timer3(&listener);
+
+		timer1.Start(30u);
+		timer2.Start(10u);
+		timer3.Start(20u);
+
+		REQUIRE(timer1.IsActive());
+		REQUIRE(TimerWheel::GetNumArmed() == 3u);
+
+		// Must run the loop here to consume the timers before doing the checks.
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener.fired == std::vector<Timer*>({ &timer2, &timer3, &timer1 }));
+		REQUIRE(!timer1.IsActive());
+		REQUIRE(TimerWheel::GetNumArmed() == 0u);
+	}
+
+	SECTION("stopped and closed timers do not fire")
+	{
+		TestTimerListener listener;
+		Timer timer1(&listener);
+		Timer timer2(&listener);
+		Timer timer3(&listener);
+
+		timer1.Start(10u);
+		timer2.Start(10u);
+		timer3.Start(5000u);
+		timer1.Stop();
+		timer3.Close();
+
+		REQUIRE(!timer1.IsActive());
+		REQUIRE(!timer3.IsActive());
+
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener.fired == std::vector<Timer*>({ &timer2 }));
+	}
+
+	SECTION("timer expiring after many wheel turns fires")
+	{
+		TestTimerListener listener;
+		Timer timer(&listener);
+
+		timer.Start(TimerWheel::NumSlots + 10u);
+
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener.fired == std::vector<Timer*>({ &timer }));
+	}
+
+	SECTION("repeating timer fires until stopped by the listener")
+	{
+		TestTimerListener listener;
+		Timer timer(&listener);
+
+		listener.stopTimer = &timer;
+
+		timer.Start(5u, 5u);
+
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener.fired.size() == 3u);
+		REQUIRE(!timer.IsActive());
+	}
+
+	SECTION("restarted timer fires once")
+	{
+		TestTimerListener listener;
+		Timer timer(&listener);
+
+		timer.Start(5u);
+		timer.Restart();
+		timer.Start(10u);
+
+		REQUIRE(TimerWheel::GetNumArmed() == 1u);
+
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener.fired == std::vector<Timer*>({ &timer }));
+	}
+
+	SECTION("listener can stop a timer that expired at the same time")
+	{
+		TestTimerListener listener;
+		Timer timer1(&listener);
+		Timer timer2(&listener);
+
+		timer1.Start(10u);
+		timer2.Start(10u);
+
+		listener.cancellerTimer = &timer1;
+		listener.cancelledTimer = &timer2;
+
+		DepLibUV::RunLoop();
+
+		REQUIRE(listener.fired == std::vector<Timer*>({ &timer1 }));
+	}
+}
@@ -8,6 +8,7 @@
 #include "LogLevel.hpp"
 #include "Settings.hpp"
 #include "Utils.hpp"
+#include "handles/TimerWheel.hpp"
 #include <catch2/catch.hpp>
 #include <cstdlib> // std::getenv()
 
@@ -43,6 +44,7 @@ int main(int argc, char* argv[])
 	Utils::Crypto::ClassDestroy();
 	DepLibWebRTC::ClassDestroy();
 	DepUsrSCTP::ClassDestroy();
+	TimerWheel::ClassDestroy();
 	DepLibUV::ClassDestroy();
 
 	return status;